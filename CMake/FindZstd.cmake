@@ -0,0 +1,17 @@
+# - Try to find zstd
+# Once done this will define
+#
+#  ZSTD_FOUND - system has zstd
+#  ZSTD_INCLUDE_DIRS - the zstd include directory
+#  ZSTD_LIBRARIES - Link these to use zstd
+#
+
+find_path (ZSTD_INCLUDE_DIRS NAMES zstd.h)
+find_library (ZSTD_LIBRARIES NAMES zstd)
+include (FindPackageHandleStandardArgs)
+
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(Zstd DEFAULT_MSG
+  ZSTD_LIBRARIES
+  ZSTD_INCLUDE_DIRS)
+
+mark_as_advanced(ZSTD_INCLUDE_DIRS ZSTD_LIBRARIES)
@@ -96,6 +96,13 @@ The full list of options mlpack allows:
        (default ON)
  - TEST_VERBOSE=(ON/OFF): run test cases in \c mlpack_test with verbose output
        (default OFF)
+ - BUILD_BENCHMARKS=(ON/OFF): compile the \c mlpack_benchmarks program, which
+       times tree building and search, k-means, neural network training, EM,
+       data loading and the optimizers, and writes the results as JSON
+       (default OFF)
+ - USE_NVBLAS=(ON/OFF): link against NVBLAS, so that large matrix products
+       run on the GPU with cuBLAS; NVBLAS reads the host BLAS to use for the
+       other calls from \c nvblas.conf (default OFF)
 
 Each option can be specified to CMake with the '-D' flag.  Other tools can also
 be used to configure CMake, but those are not documented here.
@@ -253,12 +253,21 @@ the mlpack::data::DatasetInfo documentation.
 @section formatmodels Loading and saving models
 
 Using \c boost::serialization, mlpack is able to load and save machine learning
-models with ease.  These models can currently be saved in three formats:
+models with ease.  These models can currently be saved in four formats:
 
+ - mlpack binary model (.mlmodel); this is not human-readable, but it is small
+   and the fastest to load
  - binary (.bin); this is not human-readable, but it is small
  - text (.txt); this is sort of human-readable and relatively small
  - xml (.xml); this is human-readable but very verbose and large
 
+Large models, such as nearest neighbor search models with their trees and
+datasets, can take a long time to load from .xml files; the .mlmodel format
+stores the matrices of the model as raw blocks, so it should be preferred for
+them.  In C++, a .mlmodel file can also be memory-mapped with
+mlpack::data::MappedModel, in which case the matrices of the model are not read
+at all until they are used.
+
 The type of file to save is determined by the given file extension, as with the
 other loading and saving functionality in mlpack.  Below is an example where a
 dataset stored as TSV and labels stored as ASCII text are used to train a
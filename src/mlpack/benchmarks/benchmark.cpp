@@ -0,0 +1,40 @@
+/**
+ * @file benchmark.cpp
+ *
+ * Implementation of the utilities of the benchmark harness.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "benchmark.hpp"
+
+namespace mlpack {
+namespace benchmark {
+
+arma::mat ClusteredDataset(const size_t dimensionality,
+                           const size_t points,
+                           const size_t clusters,
+                           arma::Row<size_t>* labels)
+{
+  // The centers are spread out enough that the clusters overlap a little.
+  const arma::mat centers = 5.0 * arma::randn<arma::mat>(dimensionality,
+      clusters);
+
+  arma::mat dataset = arma::randn<arma::mat>(dimensionality, points);
+  if (labels)
+    labels->set_size(points);
+
+  for (size_t i = 0; i < points; ++i)
+  {
+    dataset.col(i) += centers.col(i % clusters);
+    if (labels)
+      (*labels)[i] = i % clusters;
+  }
+
+  return dataset;
+}
+
+} // namespace benchmark
+} // namespace mlpack
@@ -0,0 +1,170 @@
+/**
+ * @file benchmark.hpp
+ *
+ * A small harness for timing mlpack components.  Benchmarks are registered
+ * with the MLPACK_BENCHMARK() macro and run by the mlpack_benchmarks program,
+ * which writes the results as JSON.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BENCHMARKS_BENCHMARK_HPP
+#define MLPACK_BENCHMARKS_BENCHMARK_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <chrono>
+#include <functional>
+
+namespace mlpack {
+namespace benchmark {
+
+/**
+ * The state of one run of a benchmark.  A benchmark prepares its data, and then
+ * passes the code to time to Measure().
+ */
+class BenchmarkState
+{
+ public:
+  /**
+   * Create the state of a run.
+   *
+   * @param repetitions Number of timed runs of the measured code.
+   * @param scale Factor applied to the problem sizes of the benchmarks.
+   */
+  BenchmarkState(const size_t repetitions, const double scale) :
+      repetitions(repetitions),
+      scale(scale)
+  { /* Nothing to do. */ }
+
+  /**
+   * Run the given function once without timing it, so that lazily-initialized
+   * state is set up and caches are warm, and then time it the given number of
+   * times.
+   *
+   * @param function Code to time.
+   */
+  template<typename FunctionType>
+  void Measure(FunctionType&& function)
+  {
+    function();
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+      const std::chrono::high_resolution_clock::time_point start =
+          std::chrono::high_resolution_clock::now();
+      function();
+      const std::chrono::high_resolution_clock::time_point end =
+          std::chrono::high_resolution_clock::now();
+
+      times.push_back(std::chrono::duration<double>(end - start).count());
+    }
+  }
+
+  //! Scale the given problem size by the --scale parameter (at least 1).
+  size_t Size(const size_t size) const
+  {
+    return std::max((size_t) 1, (size_t) (scale * size));
+  }
+
+  //! Get the times of the timed runs, in seconds.
+  const std::vector<double>& Times() const { return times; }
+
+ private:
+  //! Number of timed runs.
+  size_t repetitions;
+  //! Factor applied to the problem sizes.
+  double scale;
+  //! The times of the timed runs, in seconds.
+  std::vector<double> times;
+};
+
+//! The type of a benchmark.
+typedef std::function<void(BenchmarkState&)> BenchmarkFunction;
+
+/**
+ * The list of all registered benchmarks, in the order they were registered.
+ */
+class BenchmarkRegistry
+{
+ public:
+  //! Get the registry.
+  static BenchmarkRegistry& Get()
+  {
+    static BenchmarkRegistry registry;
+    return registry;
+  }
+
+  //! Register the given benchmark.
+  void Add(const std::string& name, BenchmarkFunction function)
+  {
+    benchmarks.push_back(std::make_pair(name, std::move(function)));
+  }
+
+  //! Get all the registered benchmarks.
+  const std::vector<std::pair<std::string, BenchmarkFunction>>&
+  Benchmarks() const { return benchmarks; }
+
+ private:
+  //! The registered benchmarks.
+  std::vector<std::pair<std::string, BenchmarkFunction>> benchmarks;
+};
+
+//! Registers a benchmark when it is constructed; used by MLPACK_BENCHMARK().
+struct BenchmarkRegistrar
+{
+  BenchmarkRegistrar(const std::string& name, BenchmarkFunction function)
+  {
+    BenchmarkRegistry::Get().Add(name, std::move(function));
+  }
+};
+
+/**
+ * Generate a dataset of points drawn from a mixture of spherical Gaussians.
+ * The points are drawn with Armadillo's random number generator, so the
+ * dataset is the same every time for the same seed.
+ *
+ * @param dimensionality Dimensionality of the points.
+ * @param points Number of points.
+ * @param clusters Number of Gaussians.
+ * @param labels If given, the index of the Gaussian of each point.
+ */
+arma::mat ClusteredDataset(const size_t dimensionality,
+                           const size_t points,
+                           const size_t clusters,
+                           arma::Row<size_t>* labels = NULL);
+
+} // namespace benchmark
+} // namespace mlpack
+
+#define MLPACK_BENCHMARK_CONCAT_IMPL(a, b) a ## b
+#define MLPACK_BENCHMARK_CONCAT(a, b) MLPACK_BENCHMARK_CONCAT_IMPL(a, b)
+
+/**
+ * Register the given function (or function object) as a benchmark with the
+ * given name.  Names are of the form "component/variant/operation", so that a
+ * group of benchmarks can be selected with --filter.
+ */
+#define MLPACK_REGISTER_BENCHMARK(NAME, FUNCTION) \
+    static ::mlpack::benchmark::BenchmarkRegistrar \
+        MLPACK_BENCHMARK_CONCAT(benchmarkRegistrar, __COUNTER__)(NAME, \
+        FUNCTION)
+
+/**
+ * Define and register a benchmark with the given name.  This is used like
+ * BOOST_AUTO_TEST_CASE():
+ *
+ * @code
+ * MLPACK_BENCHMARK(SomeBenchmark, "component/operation")
+ * {
+ *   arma::mat data = ClusteredDataset(10, state.Size(10000), 5);
+ *   state.Measure([&]() { ... });
+ * }
+ * @endcode
+ */
+#define MLPACK_BENCHMARK(FUNCTION, NAME) \
+    static void FUNCTION(::mlpack::benchmark::BenchmarkState& state); \
+    MLPACK_REGISTER_BENCHMARK(NAME, FUNCTION); \
+    static void FUNCTION(::mlpack::benchmark::BenchmarkState& state)
+
+#endif
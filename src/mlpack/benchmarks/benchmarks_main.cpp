@@ -0,0 +1,193 @@
+/**
+ * @file benchmarks_main.cpp
+ *
+ * Executable that runs the registered benchmarks and writes their timings as
+ * JSON.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/version.hpp>
+
+#include "benchmark.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+using namespace std;
+
+PROGRAM_INFO("mlpack benchmarks", "This program times the construction and "
+    "search of every tree type of neighbor search, every Lloyd step type of "
+    "k-means, a training step of a feedforward network, EM fitting of a GMM, "
+    "loading of CSV and binary data, and several optimizers.  The datasets are "
+    "generated from the given random seed, so they are the same for every run."
+    "\n\n"
+    "Each benchmark is run once to warm up, and then timed --repetitions (-r) "
+    "times, for each number of threads in the comma-separated list given with "
+    "--thread_counts (-T).  Benchmarks are selected with --filter (-f), which "
+    "keeps the benchmarks whose name contains the given string; --list (-l) "
+    "prints the names of all benchmarks.  The problem sizes can be scaled with "
+    "--scale (-S)."
+    "\n\n"
+    "The results are written as JSON to the file given with --output_file (-o),"
+    " or to standard output, with the minimum, mean and maximum time of each "
+    "benchmark and number of threads.");
+
+PARAM_STRING_IN("filter", "Only run the benchmarks whose name contains this "
+    "string.", "f", "");
+PARAM_FLAG("list", "Print the names of the benchmarks and exit.", "l");
+PARAM_INT_IN("repetitions", "Number of timed runs of each benchmark.", "r", 5);
+PARAM_STRING_IN("thread_counts", "Comma-separated list of numbers of threads "
+    "to run each benchmark with (the default is the number of OpenMP threads).",
+    "T", "");
+PARAM_DOUBLE_IN("scale", "Factor applied to the problem size of every "
+    "benchmark.", "S", 1.0);
+PARAM_INT_IN("seed", "Random seed used to generate the datasets.", "s", 42);
+PARAM_STRING_IN("output_file", "File to write the JSON results to (standard "
+    "output if not given).", "o", "");
+
+//! Write the given string as a JSON string.
+void WriteJSONString(ostream& stream, const string& value)
+{
+  stream << '"';
+  for (size_t i = 0; i < value.size(); ++i)
+  {
+    if (value[i] == '"' || value[i] == '\\')
+      stream << '\\';
+    stream << value[i];
+  }
+  stream << '"';
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  const vector<pair<string, BenchmarkFunction>>& benchmarks =
+      BenchmarkRegistry::Get().Benchmarks();
+
+  if (CLI::HasParam("list"))
+  {
+    for (size_t i = 0; i < benchmarks.size(); ++i)
+      cout << benchmarks[i].first << endl;
+    return 0;
+  }
+
+  const int repetitions = CLI::GetParam<int>("repetitions");
+  if (repetitions <= 0)
+    Log::Fatal << "--repetitions (-r) must be positive!" << endl;
+
+  const double scale = CLI::GetParam<double>("scale");
+  if (scale <= 0.0)
+    Log::Fatal << "--scale (-S) must be positive!" << endl;
+
+  // Parse the list of thread counts.
+  vector<int> threads;
+  stringstream threadList(CLI::GetParam<string>("thread_counts"));
+  string token;
+  while (getline(threadList, token, ','))
+  {
+    const int count = atoi(token.c_str());
+    if (count <= 0)
+      Log::Fatal << "Invalid number of threads '" << token << "' in "
+          << "--thread_counts (-T)!" << endl;
+    threads.push_back(count);
+  }
+
+#ifdef HAS_OPENMP
+  const int defaultThreads = omp_get_max_threads();
+#else
+  const int defaultThreads = 1;
+  for (size_t i = 0; i < threads.size(); ++i)
+  {
+    if (threads[i] != 1)
+    {
+      Log::Warn << "mlpack was compiled without OpenMP; all benchmarks will "
+          << "run with 1 thread." << endl;
+      threads.clear();
+      break;
+    }
+  }
+#endif
+  if (threads.empty())
+    threads.push_back(defaultThreads);
+
+  const string filter = CLI::GetParam<string>("filter");
+  const size_t seed = (size_t) CLI::GetParam<int>("seed");
+
+  ofstream outputFile;
+  if (CLI::GetParam<string>("output_file") != "")
+  {
+    outputFile.open(CLI::GetParam<string>("output_file").c_str());
+    if (!outputFile.is_open())
+      Log::Fatal << "Unable to open output file '"
+          << CLI::GetParam<string>("output_file") << "'!" << endl;
+  }
+  ostream& output = outputFile.is_open() ? outputFile : cout;
+
+  output << setprecision(9);
+  output << "{\n  \"version\": ";
+  WriteJSONString(output, util::GetVersion());
+  output << ",\n  \"seed\": " << seed << ",\n  \"scale\": " << scale
+      << ",\n  \"benchmarks\": [";
+
+  bool first = true;
+  for (size_t i = 0; i < benchmarks.size(); ++i)
+  {
+    if (benchmarks[i].first.find(filter) == string::npos)
+      continue;
+
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+      Log::Info << "Running " << benchmarks[i].first << " with " << threads[t]
+          << " thread(s)." << endl;
+
+#ifdef HAS_OPENMP
+      omp_set_num_threads(threads[t]);
+#endif
+      // Every run sees the same datasets.
+      math::RandomSeed(seed);
+
+      BenchmarkState state((size_t) repetitions, scale);
+      benchmarks[i].second(state);
+
+      const vector<double>& times = state.Times();
+      if (times.empty())
+      {
+        Log::Warn << "Benchmark " << benchmarks[i].first << " did not measure "
+            << "anything." << endl;
+        continue;
+      }
+
+      const double total = accumulate(times.begin(), times.end(), 0.0);
+
+      output << (first ? "\n" : ",\n") << "    {\n      \"name\": ";
+      WriteJSONString(output, benchmarks[i].first);
+      output << ",\n      \"threads\": " << threads[t]
+          << ",\n      \"repetitions\": " << times.size()
+          << ",\n      \"min_seconds\": "
+          << *min_element(times.begin(), times.end())
+          << ",\n      \"mean_seconds\": " << total / times.size()
+          << ",\n      \"max_seconds\": "
+          << *max_element(times.begin(), times.end())
+          << "\n    }";
+      first = false;
+    }
+  }
+
+  output << "\n  ]\n}\n";
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(defaultThreads);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file emfit_benchmark.cpp
+ *
+ * Benchmark of the EM fitting of a Gaussian mixture model.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/gmm/em_fit.hpp>
+
+#include "benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+using namespace mlpack::distribution;
+using namespace mlpack::gmm;
+
+/**
+ * Time 20 EM iterations, starting from the same model every time so that the
+ * initial k-means clustering is not part of the time.
+ */
+MLPACK_BENCHMARK(EMFitBenchmark, "gmm/emfit")
+{
+  const size_t gaussians = 5;
+  const arma::mat dataset = ClusteredDataset(10, state.Size(20000), gaussians);
+
+  std::vector<GaussianDistribution> initialDists;
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    initialDists.push_back(GaussianDistribution(dataset.col(i),
+        arma::eye<arma::mat>(dataset.n_rows, dataset.n_rows)));
+  }
+  const arma::vec initialWeights = arma::ones<arma::vec>(gaussians) /
+      gaussians;
+
+  // A negative tolerance means that all the iterations are run.
+  EMFit<> fitter(20, -1.0);
+  std::vector<GaussianDistribution> dists;
+  arma::vec weights;
+  state.Measure([&]()
+  {
+    dists = initialDists;
+    weights = initialWeights;
+    fitter.Estimate(dataset, dists, weights, true);
+  });
+}
@@ -0,0 +1,51 @@
+/**
+ * @file ffn_benchmark.cpp
+ *
+ * Benchmark of the training of a feedforward network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#include <mlpack/methods/ann/layer/layer.hpp>
+#include <mlpack/methods/ann/ffn.hpp>
+
+#include "benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::ann;
+using namespace mlpack::benchmark;
+using namespace mlpack::optimization;
+
+/**
+ * Time one epoch of mini-batch SGD on a network with one hidden layer.
+ */
+MLPACK_BENCHMARK(FFNTrainEpochBenchmark, "ffn/train_epoch")
+{
+  const size_t classes = 10;
+  const size_t points = state.Size(10000);
+  const size_t batchSize = 100;
+
+  arma::Row<size_t> labels;
+  const arma::mat dataset = ClusteredDataset(100, points, classes, &labels);
+  const arma::mat responses = arma::conv_to<arma::mat>::from(labels) + 1;
+
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<Linear<>>(dataset.n_rows, 128);
+  model.Add<SigmoidLayer<>>();
+  model.Add<Linear<>>(128, classes);
+  model.Add<LogSoftMax<>>();
+
+  // Mini-batch SGD processes one batch less than the maximum number of
+  // iterations.
+  MiniBatchSGD<decltype(model)> sgd(model, batchSize, 0.01,
+      (points + batchSize - 1) / batchSize + 1, -1, false);
+
+  state.Measure([&]()
+  {
+    model.Train(dataset, responses, sgd);
+  });
+}
@@ -0,0 +1,55 @@
+/**
+ * @file kmeans_benchmark.cpp
+ *
+ * Benchmarks of k-means clustering with every Lloyd step type.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/kmeans/kmeans.hpp>
+#include <mlpack/methods/kmeans/elkan_kmeans.hpp>
+#include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
+#include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
+
+#include "benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+using namespace mlpack::kmeans;
+
+/**
+ * Time 10 Lloyd iterations with the given step type, starting from the same
+ * centroids every time.
+ */
+template<template<class, class> class LloydStepType>
+void KMeansBenchmark(BenchmarkState& state)
+{
+  const size_t clusters = 20;
+  const arma::mat dataset = ClusteredDataset(10, state.Size(50000), clusters);
+  const arma::mat initialCentroids = dataset.cols(0, clusters - 1);
+
+  KMeans<metric::EuclideanDistance, SampleInitialization, MaxVarianceNewCluster,
+      LloydStepType> kmeans(10);
+
+  arma::mat centroids;
+  state.Measure([&]()
+  {
+    centroids = initialCentroids;
+    kmeans.Cluster(dataset, clusters, centroids, true);
+  });
+}
+
+// The names are the values of --algorithm of mlpack_kmeans.
+MLPACK_REGISTER_BENCHMARK("kmeans/naive", KMeansBenchmark<NaiveKMeans>);
+MLPACK_REGISTER_BENCHMARK("kmeans/elkan", KMeansBenchmark<ElkanKMeans>);
+MLPACK_REGISTER_BENCHMARK("kmeans/hamerly", KMeansBenchmark<HamerlyKMeans>);
+MLPACK_REGISTER_BENCHMARK("kmeans/pelleg-moore",
+    KMeansBenchmark<PellegMooreKMeans>);
+MLPACK_REGISTER_BENCHMARK("kmeans/dualtree",
+    KMeansBenchmark<DefaultDualTreeKMeans>);
+MLPACK_REGISTER_BENCHMARK("kmeans/dualtree-covertree",
+    KMeansBenchmark<CoverTreeDualTreeKMeans>);
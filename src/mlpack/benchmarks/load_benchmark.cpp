@@ -0,0 +1,50 @@
+/**
+ * @file load_benchmark.cpp
+ *
+ * Benchmarks of data::Load() for text and binary files.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+
+#include "benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+
+/**
+ * Time loading a dataset from a file of the format given by the extension.  The
+ * file is written in the working directory and removed afterwards.
+ */
+void LoadBenchmark(BenchmarkState& state, const std::string& extension)
+{
+  const std::string filename = "mlpack_benchmark_load." + extension;
+  const arma::mat dataset = ClusteredDataset(20, state.Size(100000), 10);
+  if (!data::Save(filename, dataset))
+  {
+    Log::Warn << "Cannot write '" << filename << "'; skipping benchmark."
+        << std::endl;
+    return;
+  }
+
+  arma::mat loaded;
+  state.Measure([&]()
+  {
+    data::Load(filename, loaded, true);
+  });
+
+  std::remove(filename.c_str());
+}
+
+MLPACK_BENCHMARK(LoadCSVBenchmark, "load/csv")
+{
+  LoadBenchmark(state, "csv");
+}
+
+MLPACK_BENCHMARK(LoadBinaryBenchmark, "load/arma_binary")
+{
+  LoadBenchmark(state, "bin");
+}
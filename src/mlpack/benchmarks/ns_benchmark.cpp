@@ -0,0 +1,147 @@
+/**
+ * @file ns_benchmark.cpp
+ *
+ * Benchmarks of tree building and k-nearest-neighbor search for every tree type
+ * supported by NSModel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/ns_model.hpp>
+
+#include "benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+using namespace mlpack::neighbor;
+
+typedef NSModel<NearestNeighborSort> KNNModel;
+
+/**
+ * Time building the reference tree of the given type.  The time includes a copy
+ * of the dataset, since the model takes ownership of it.
+ */
+template<KNNModel::TreeTypes TreeType>
+void KNNBuildBenchmark(BenchmarkState& state)
+{
+  const arma::mat dataset = ClusteredDataset(5, state.Size(20000), 10);
+
+  state.Measure([&]()
+  {
+    KNNModel knn(TreeType);
+    arma::mat referenceSet(dataset);
+    knn.BuildModel(std::move(referenceSet), 20, DUAL_TREE_MODE);
+  });
+}
+
+/**
+ * Time dual-tree monochromatic 5-nearest-neighbor search with the given tree
+ * type.
+ */
+template<KNNModel::TreeTypes TreeType>
+void KNNSearchBenchmark(BenchmarkState& state)
+{
+  arma::mat dataset = ClusteredDataset(5, state.Size(20000), 10);
+
+  KNNModel knn(TreeType);
+  knn.BuildModel(std::move(dataset), 20, DUAL_TREE_MODE);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  state.Measure([&]()
+  {
+    knn.Search(5, neighbors, distances);
+  });
+}
+
+/**
+ * Time single-tree monochromatic 1-nearest-neighbor search with the given tree
+ * type and traversal (depth-first or best-first).
+ */
+template<KNNModel::TreeTypes TreeType, NeighborSearchMode SearchMode>
+void KNNSingleTreeSearchBenchmark(BenchmarkState& state)
+{
+  arma::mat dataset = ClusteredDataset(5, state.Size(20000), 10);
+
+  KNNModel knn(TreeType);
+  knn.BuildModel(std::move(dataset), 20, SearchMode);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  state.Measure([&]()
+  {
+    knn.Search(1, neighbors, distances);
+  });
+}
+
+typedef tree::StandardCoverTree<metric::EuclideanDistance,
+    NeighborSearchStat<NearestNeighborSort>, arma::mat> CoverTreeType;
+
+/**
+ * Time dual-tree monochromatic 5-nearest-neighbor search with cover trees and
+ * the given dual-tree traverser.
+ */
+template<template<typename RuleType> class TraverserType>
+void KNNCoverTraverserBenchmark(BenchmarkState& state)
+{
+  arma::mat dataset = ClusteredDataset(5, state.Size(20000), 10);
+
+  NeighborSearch<NearestNeighborSort, metric::EuclideanDistance, arma::mat,
+      tree::StandardCoverTree, TraverserType> knn(std::move(dataset));
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  state.Measure([&]()
+  {
+    knn.Search(5, neighbors, distances);
+  });
+}
+
+// The cover tree traverser with map reference sets against the one with flat
+// reference sets.
+MLPACK_REGISTER_BENCHMARK("knn/cover/map_dual_tree_traverser",
+    KNNCoverTraverserBenchmark<CoverTreeType::DualTreeTraverser>);
+MLPACK_REGISTER_BENCHMARK("knn/cover/flat_dual_tree_traverser",
+    KNNCoverTraverserBenchmark<CoverTreeType::FlatDualTreeTraverser>);
+
+#define MLPACK_KNN_SINGLE_TREE_BENCHMARKS(TREE_TYPE, NAME) \
+    MLPACK_REGISTER_BENCHMARK("knn/" NAME "/depth_first_search", \
+        (KNNSingleTreeSearchBenchmark<KNNModel::TREE_TYPE, \
+        SINGLE_TREE_MODE>)); \
+    MLPACK_REGISTER_BENCHMARK("knn/" NAME "/best_first_search", \
+        (KNNSingleTreeSearchBenchmark<KNNModel::TREE_TYPE, \
+        BEST_FIRST_SINGLE_TREE_MODE>))
+
+// Depth-first against best-first traversal, for each family of trees.
+MLPACK_KNN_SINGLE_TREE_BENCHMARKS(KD_TREE, "kd");
+MLPACK_KNN_SINGLE_TREE_BENCHMARKS(COVER_TREE, "cover");
+MLPACK_KNN_SINGLE_TREE_BENCHMARKS(R_TREE, "r");
+MLPACK_KNN_SINGLE_TREE_BENCHMARKS(SPILL_TREE, "spill");
+MLPACK_KNN_SINGLE_TREE_BENCHMARKS(OCTREE, "oct");
+
+#define MLPACK_KNN_BENCHMARKS(TREE_TYPE, NAME) \
+    MLPACK_REGISTER_BENCHMARK("knn/" NAME "/build", \
+        KNNBuildBenchmark<KNNModel::TREE_TYPE>); \
+    MLPACK_REGISTER_BENCHMARK("knn/" NAME "/search", \
+        KNNSearchBenchmark<KNNModel::TREE_TYPE>)
+
+// The names are the values of --tree_type of mlpack_knn.
+MLPACK_KNN_BENCHMARKS(KD_TREE, "kd");
+MLPACK_KNN_BENCHMARKS(COVER_TREE, "cover");
+MLPACK_KNN_BENCHMARKS(R_TREE, "r");
+MLPACK_KNN_BENCHMARKS(R_STAR_TREE, "r-star");
+MLPACK_KNN_BENCHMARKS(BALL_TREE, "ball");
+MLPACK_KNN_BENCHMARKS(X_TREE, "x");
+MLPACK_KNN_BENCHMARKS(HILBERT_R_TREE, "hilbert-r");
+MLPACK_KNN_BENCHMARKS(R_PLUS_TREE, "r-plus");
+MLPACK_KNN_BENCHMARKS(R_PLUS_PLUS_TREE, "r-plus-plus");
+MLPACK_KNN_BENCHMARKS(VP_TREE, "vp");
+MLPACK_KNN_BENCHMARKS(RP_TREE, "rp");
+MLPACK_KNN_BENCHMARKS(MAX_RP_TREE, "max-rp");
+MLPACK_KNN_BENCHMARKS(SPILL_TREE, "spill");
+MLPACK_KNN_BENCHMARKS(UB_TREE, "ub");
+MLPACK_KNN_BENCHMARKS(OCTREE, "oct");
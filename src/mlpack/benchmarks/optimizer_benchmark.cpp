@@ -0,0 +1,101 @@
+/**
+ * @file optimizer_benchmark.cpp
+ *
+ * Benchmarks of several optimizers on the logistic regression objective.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/adam/adam.hpp>
+#include <mlpack/core/optimizers/gradient_descent/gradient_descent.hpp>
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression_function.hpp>
+
+#include "benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+using namespace mlpack::optimization;
+using namespace mlpack::regression;
+
+typedef LogisticRegressionFunction<> FunctionType;
+
+/**
+ * Time the optimization of the logistic regression objective on a two-class
+ * dataset, with the optimizer returned by the given builder.  Every run starts
+ * from the same point and runs for a fixed budget, since the tolerance is
+ * negative.
+ */
+template<typename OptimizerBuilder>
+void OptimizerBenchmark(BenchmarkState& state, OptimizerBuilder builder)
+{
+  arma::Row<size_t> labels;
+  const arma::mat dataset = ClusteredDataset(50, state.Size(20000), 2,
+      &labels);
+  FunctionType function(dataset, labels, 0.001);
+
+  auto optimizer = builder(function, dataset.n_cols);
+  arma::mat coordinates;
+  state.Measure([&]()
+  {
+    coordinates = function.GetInitialPoint();
+    optimizer.Optimize(coordinates);
+  });
+}
+
+MLPACK_BENCHMARK(SGDBenchmark, "optimizer/sgd")
+{
+  OptimizerBenchmark(state, [](FunctionType& f, const size_t points)
+  {
+    return StandardSGD<FunctionType>(f, 0.01, 5 * points, -1.0, false);
+  });
+}
+
+MLPACK_BENCHMARK(MiniBatchSGDBenchmark, "optimizer/minibatch_sgd")
+{
+  OptimizerBenchmark(state, [](FunctionType& f, const size_t points)
+  {
+    return MiniBatchSGD<FunctionType>(f, 100, 0.01, 5 * points / 100, -1.0,
+        false);
+  });
+}
+
+MLPACK_BENCHMARK(AdamBenchmark, "optimizer/adam")
+{
+  OptimizerBenchmark(state, [](FunctionType& f, const size_t points)
+  {
+    return Adam<FunctionType>(f, 0.001, 0.9, 0.999, 1e-8, 5 * points, -1.0,
+        false);
+  });
+}
+
+MLPACK_BENCHMARK(RMSPropBenchmark, "optimizer/rmsprop")
+{
+  OptimizerBenchmark(state, [](FunctionType& f, const size_t points)
+  {
+    return RMSProp<FunctionType>(f, 0.01, 0.99, 1e-8, 5 * points, -1.0,
+        false);
+  });
+}
+
+MLPACK_BENCHMARK(GradientDescentBenchmark, "optimizer/gradient_descent")
+{
+  OptimizerBenchmark(state, [](FunctionType& f, const size_t /* points */)
+  {
+    return GradientDescent<FunctionType>(f, 0.01, 100, -1.0);
+  });
+}
+
+MLPACK_BENCHMARK(LBFGSBenchmark, "optimizer/lbfgs")
+{
+  OptimizerBenchmark(state, [](FunctionType& f, const size_t /* points */)
+  {
+    return L_BFGS<FunctionType>(f, 10, 100);
+  });
+}
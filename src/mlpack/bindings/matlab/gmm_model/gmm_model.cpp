@@ -0,0 +1,165 @@
+/**
+ * @file gmm_model.cpp
+ *
+ * MEX function for the MATLAB GMM model binding.  A trained GMM is kept alive
+ * as a handle, so that it can be used to compute probabilities of and to
+ * classify many sets of points.  The points and the results are passed without
+ * copies.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mex.h"
+#include "../mex_util.hpp"
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/gmm/gmm.hpp>
+
+using namespace mlpack;
+using namespace mlpack::gmm;
+using namespace mlpack::matlab;
+
+// Get the points argument, and check its dimensionality against the model.
+static arma::mat PointsFromMx(const GMM& gmm, const mxArray* array)
+{
+  arma::mat points = MatrixFromMx(array, "The points");
+  if (points.n_rows != gmm.Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "The points have " << points.n_rows << " dimensions, but the model "
+        << "has " << gmm.Dimensionality() << ".";
+    mexErrMsgTxt(oss.str().c_str());
+  }
+
+  return points;
+}
+
+// [handle, logLikelihood] = gmm_model_mex('train', points, gaussians, trials,
+//     seed)
+static void Train(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs != 5)
+    mexErrMsgTxt("Expecting five inputs for 'train'.");
+  if (nlhs < 1 || nlhs > 2)
+    mexErrMsgTxt("One or two outputs required.");
+
+  const int gaussians = (int) mxGetScalar(prhs[2]);
+  if (gaussians <= 0)
+  {
+    std::stringstream ss;
+    ss << "Invalid number of Gaussians (" << gaussians << "); must "
+        "be greater than or equal to 1." << std::endl;
+    mexErrMsgTxt(ss.str().c_str());
+  }
+
+  const int trials = (int) mxGetScalar(prhs[3]);
+  if (trials <= 0)
+    mexErrMsgTxt("Invalid number of trials; must be greater than 0.");
+
+  const size_t seed = (size_t) mxGetScalar(prhs[4]);
+  if (seed != 0)
+    math::RandomSeed(seed);
+  else
+    math::RandomSeed((size_t) std::time(NULL));
+
+  // Training only reads the points, so they are not copied.
+  const arma::mat points = MatrixFromMx(prhs[1], "The points");
+
+  GMM* gmm = new GMM(size_t(gaussians), points.n_rows);
+  double logLikelihood;
+  try
+  {
+    logLikelihood = gmm->Train(points, size_t(trials));
+  }
+  catch (std::exception& e)
+  {
+    delete gmm;
+    mexErrMsgTxt(e.what());
+  }
+
+  plhs[0] = ModelHandles<GMM>::Create(gmm);
+  if (nlhs == 2)
+    plhs[1] = mxCreateDoubleScalar(logLikelihood);
+}
+
+// probabilities = gmm_model_mex('probability', handle, points)
+// logProbabilities = gmm_model_mex('log_probability', handle, points)
+static void Probability(int nlhs,
+                        mxArray* plhs[],
+                        int nrhs,
+                        const mxArray* prhs[],
+                        const bool log)
+{
+  if (nrhs != 3)
+    mexErrMsgTxt("Expecting three inputs.");
+  if (nlhs != 1)
+    mexErrMsgTxt("Output required.");
+
+  const GMM& gmm = ModelHandles<GMM>::Get(prhs[1]);
+  const arma::mat points = PointsFromMx(gmm, prhs[2]);
+
+  // The probabilities are written directly to the returned row.
+  arma::mat out = CreateMxMatrix(plhs[0], 1, points.n_cols);
+  arma::vec probabilities(out.memptr(), points.n_cols, false, true);
+  if (log)
+    gmm.LogProbability(points, probabilities);
+  else
+    gmm.Probability(points, probabilities);
+
+  FinishMxMatrix(plhs[0], probabilities);
+}
+
+// labels = gmm_model_mex('classify', handle, points)
+static void Classify(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs != 3)
+    mexErrMsgTxt("Expecting three inputs for 'classify'.");
+  if (nlhs != 1)
+    mexErrMsgTxt("Output required.");
+
+  const GMM& gmm = ModelHandles<GMM>::Get(prhs[1]);
+  const arma::mat points = PointsFromMx(gmm, prhs[2]);
+
+  // The labels are written directly to the returned row, if size_t allows.
+  arma::Mat<size_t> out = CreateMxIndices(plhs[0], 1, points.n_cols);
+  arma::Row<size_t> labels(out.memptr(), points.n_cols, false, true);
+  gmm.Classify(points, labels);
+
+  FinishMxIndices(plhs[0], labels);
+}
+
+void mexFunction(int nlhs, mxArray *plhs[],
+                 int nrhs, const mxArray *prhs[])
+{
+  const std::string command = CommandFromMx(nrhs, prhs);
+
+  if (command == "train")
+  {
+    Train(nlhs, plhs, nrhs, prhs);
+  }
+  else if (command == "probability")
+  {
+    Probability(nlhs, plhs, nrhs, prhs, false);
+  }
+  else if (command == "log_probability")
+  {
+    Probability(nlhs, plhs, nrhs, prhs, true);
+  }
+  else if (command == "classify")
+  {
+    Classify(nlhs, plhs, nrhs, prhs);
+  }
+  else if (command == "free")
+  {
+    if (nrhs != 2)
+      mexErrMsgTxt("Expecting two inputs for 'free'.");
+    ModelHandles<GMM>::Free(prhs[1]);
+  }
+  else
+  {
+    mexErrMsgTxt("Unknown command; must be 'train', 'probability', "
+        "'log_probability', 'classify' or 'free'.");
+  }
+}
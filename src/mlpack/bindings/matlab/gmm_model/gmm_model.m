@@ -0,0 +1,71 @@
+classdef gmm_model < handle
+%Gaussian Mixture Model (GMM)
+%
+%  This trains a Gaussian mixture model with the EM algorithm and keeps it in
+%  memory, so that it can then be used to compute the probabilities of and to
+%  classify any number of sets of points.  The model is freed when the object
+%  is cleared.
+%
+%  As in mlpack, each column of the matrices of points is a point.  Because of
+%  this, the points are not copied, and the results are returned without
+%  copies.
+%
+%Parameters:
+% dataPoints- (required) Matrix containing the data on which the model will be
+%             fit, one point per column.
+% gaussians - (optional) Number of gaussians in the GMM. Default value is 1.
+% trials    - (optional) Number of trials of EM; the best fit is kept. Default
+%             value is 1.
+% seed      - (optional) Random seed.  If 0, 'std::time(NULL)' is used.
+%             Default value is 0.
+%
+% Examples:
+% model = gmm_model(dataPoints, 'gaussians', 3);
+% p = model.probability(points);    % A row with the density of each point.
+% l = model.log_probability(points);
+% labels = model.classify(points);  % The (1-based) component of each point.
+
+  properties (Access = private)
+    handle % The handle to the model in the mex file.
+  end
+
+  properties (SetAccess = private)
+    logLikelihood % The log-likelihood of the training data.
+  end
+
+  methods
+    function this = gmm_model(dataPoints, varargin)
+      % a parser for the inputs
+      p = inputParser;
+      p.addParamValue('gaussians', 1, @isscalar);
+      p.addParamValue('trials', 1, @isscalar);
+      p.addParamValue('seed', 0, @isscalar);
+
+      % parsing the varargin options
+      p.parse(varargin{:});
+      parsed = p.Results;
+
+      % interfacing with mlpack
+      [this.handle this.logLikelihood] = gmm_model_mex('train', dataPoints, ...
+          parsed.gaussians, parsed.trials, parsed.seed);
+    end
+
+    function probabilities = probability(this, points)
+      probabilities = gmm_model_mex('probability', this.handle, points);
+    end
+
+    function logProbabilities = log_probability(this, points)
+      logProbabilities = gmm_model_mex('log_probability', this.handle, points);
+    end
+
+    function labels = classify(this, points)
+      labels = gmm_model_mex('classify', this.handle, points);
+    end
+
+    function delete(this)
+      if ~isempty(this.handle)
+        gmm_model_mex('free', this.handle);
+      end
+    end
+  end
+end
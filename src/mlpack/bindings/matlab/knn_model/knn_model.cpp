@@ -0,0 +1,211 @@
+/**
+ * @file knn_model.cpp
+ *
+ * MEX function for the MATLAB k-nearest-neighbor model binding.  The model,
+ * with its reference tree, is built once and kept alive as a handle, so that
+ * many query sets can be searched without rebuilding the tree.  The query
+ * points and the results are passed without copies where possible.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mex.h"
+#include "../mex_util.hpp"
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/ns_model.hpp>
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+using namespace mlpack::matlab;
+
+typedef NSModel<NearestNeighborSort> KNNModel;
+
+// Convert the name of a tree type to the KNNModel type.
+static KNNModel::TreeTypes TreeTypeFromString(const std::string& name)
+{
+  if (name == "kd")
+    return KNNModel::KD_TREE;
+  else if (name == "cover")
+    return KNNModel::COVER_TREE;
+  else if (name == "r")
+    return KNNModel::R_TREE;
+  else if (name == "r-star")
+    return KNNModel::R_STAR_TREE;
+  else if (name == "ball")
+    return KNNModel::BALL_TREE;
+  else if (name == "x")
+    return KNNModel::X_TREE;
+  else if (name == "hilbert-r")
+    return KNNModel::HILBERT_R_TREE;
+  else if (name == "r-plus")
+    return KNNModel::R_PLUS_TREE;
+  else if (name == "r-plus-plus")
+    return KNNModel::R_PLUS_PLUS_TREE;
+  else if (name == "vp")
+    return KNNModel::VP_TREE;
+  else if (name == "rp")
+    return KNNModel::RP_TREE;
+  else if (name == "max-rp")
+    return KNNModel::MAX_RP_TREE;
+  else if (name == "ub")
+    return KNNModel::UB_TREE;
+  else if (name == "oct")
+    return KNNModel::OCTREE;
+
+  mexErrMsgTxt("Unknown tree type; must be 'kd', 'cover', 'r', 'r-star', "
+      "'ball', 'x', 'hilbert-r', 'r-plus', 'r-plus-plus', 'vp', 'rp', "
+      "'max-rp', 'ub' or 'oct'.");
+  return KNNModel::KD_TREE;
+}
+
+// Convert the name of a search mode to the NeighborSearchMode.
+static NeighborSearchMode SearchModeFromString(const std::string& name)
+{
+  if (name == "naive")
+    return NAIVE_MODE;
+  else if (name == "single")
+    return SINGLE_TREE_MODE;
+  else if (name == "dual")
+    return DUAL_TREE_MODE;
+  else if (name == "greedy")
+    return GREEDY_SINGLE_TREE_MODE;
+
+  mexErrMsgTxt("Unknown search mode; must be 'naive', 'single', 'dual' or "
+      "'greedy'.");
+  return DUAL_TREE_MODE;
+}
+
+// Get a string argument.
+static std::string StringFromMx(const mxArray* array, const char* name)
+{
+  if (!mxIsChar(array))
+  {
+    std::ostringstream oss;
+    oss << name << " must be a string.";
+    mexErrMsgTxt(oss.str().c_str());
+  }
+
+  char* str = mxArrayToString(array);
+  std::string result(str);
+  mxFree(str);
+  return result;
+}
+
+// handle = knn_model_mex('build', referencePoints, leafSize, treeType, mode,
+//     epsilon)
+static void Build(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs != 6)
+    mexErrMsgTxt("Expecting six inputs for 'build'.");
+  if (nlhs != 1)
+    mexErrMsgTxt("Output required.");
+
+  const int leafSize = (int) mxGetScalar(prhs[2]);
+  if (leafSize <= 0)
+    mexErrMsgTxt("Invalid leaf size; must be greater than 0.");
+
+  const double epsilon = mxGetScalar(prhs[5]);
+  if (epsilon < 0)
+    mexErrMsgTxt("Invalid epsilon; must be at least 0.");
+
+  const KNNModel::TreeTypes treeType = TreeTypeFromString(
+      StringFromMx(prhs[3], "The tree type"));
+  const NeighborSearchMode mode = SearchModeFromString(StringFromMx(prhs[4],
+      "The search mode"));
+
+  // The model outlives the call and the tree reorders its points, so this is
+  // the one place where the points are copied.
+  const arma::mat points = MatrixFromMx(prhs[1], "The reference points");
+  arma::mat referenceSet(points);
+  KNNModel* model = new KNNModel(treeType);
+  try
+  {
+    model->BuildModel(std::move(referenceSet), size_t(leafSize), mode,
+        epsilon);
+  }
+  catch (std::exception& e)
+  {
+    delete model;
+    mexErrMsgTxt(e.what());
+  }
+
+  plhs[0] = ModelHandles<KNNModel>::Create(model);
+}
+
+// [distances, neighbors] = knn_model_mex('search', handle, queryPoints, k)
+static void Search(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs != 4)
+    mexErrMsgTxt("Expecting four inputs for 'search'.");
+  if (nlhs != 2)
+    mexErrMsgTxt("Two outputs required.");
+
+  KNNModel& model = ModelHandles<KNNModel>::Get(prhs[1]);
+
+  const int k = (int) mxGetScalar(prhs[3]);
+  if (k <= 0)
+    mexErrMsgTxt("Invalid k; must be greater than 0.");
+
+  // An empty query set means that the reference set is searched.
+  const bool monochromatic = mxIsEmpty(prhs[2]);
+  const size_t numQueries = monochromatic ? model.Dataset().n_cols :
+      mxGetN(prhs[2]);
+
+  // The results are written directly to the returned arrays.
+  arma::mat distances = CreateMxMatrix(plhs[0], k, numQueries);
+  arma::Mat<size_t> neighbors = CreateMxIndices(plhs[1], k, numQueries);
+
+  try
+  {
+    if (monochromatic)
+    {
+      model.Search(size_t(k), neighbors, distances);
+    }
+    else
+    {
+      // Only dual-tree search builds a tree on the query points, which would
+      // reorder them; the other modes read the MATLAB array directly.
+      arma::mat querySet = MatrixFromMx(prhs[2], "The query points");
+      if (model.SearchMode() == DUAL_TREE_MODE)
+        model.Search(arma::mat(querySet), size_t(k), neighbors, distances);
+      else
+        model.Search(std::move(querySet), size_t(k), neighbors, distances);
+    }
+  }
+  catch (std::exception& e)
+  {
+    mexErrMsgTxt(e.what());
+  }
+
+  FinishMxMatrix(plhs[0], distances);
+  FinishMxIndices(plhs[1], neighbors);
+}
+
+void mexFunction(int nlhs, mxArray *plhs[],
+                 int nrhs, const mxArray *prhs[])
+{
+  const std::string command = CommandFromMx(nrhs, prhs);
+
+  if (command == "build")
+  {
+    Build(nlhs, plhs, nrhs, prhs);
+  }
+  else if (command == "search")
+  {
+    Search(nlhs, plhs, nrhs, prhs);
+  }
+  else if (command == "free")
+  {
+    if (nrhs != 2)
+      mexErrMsgTxt("Expecting two inputs for 'free'.");
+    ModelHandles<KNNModel>::Free(prhs[1]);
+  }
+  else
+  {
+    mexErrMsgTxt("Unknown command; must be 'build', 'search' or 'free'.");
+  }
+}
@@ -0,0 +1,67 @@
+classdef knn_model < handle
+%K-Nearest-Neighbor Model
+%
+%  A k-nearest-neighbor model holds a reference set and its tree in memory, so
+%  that the nearest neighbors of many query sets can be found without building
+%  the tree again.  The model is freed when the object is cleared.
+%
+%  As in mlpack, each column of the reference and query matrices is a point.
+%  Because of this, no copy of the query points is made when searching (except
+%  for dual-tree search, which builds a tree on the query points), and the
+%  results are returned without copies.
+%
+%  Column j of the returned neighbors holds the (1-based) indices of the
+%  nearest neighbors of query point j, in order, and column j of the returned
+%  distances holds the distances to them.
+%
+% Parameters:
+% referencePoints - (required) Matrix of reference points, one point per
+%                   column.
+% leafSize        - (optional) Leaf size of the tree.  Default value is 20.
+% treeType        - (optional) Type of tree: 'kd', 'cover', 'r', 'r-star',
+%                   'ball', 'x', 'hilbert-r', 'r-plus', 'r-plus-plus', 'vp',
+%                   'rp', 'max-rp', 'ub' or 'oct'.  Default value is 'kd'.
+% mode            - (optional) Search mode: 'naive', 'single', 'dual' or
+%                   'greedy'.  Default value is 'dual'.
+% epsilon         - (optional) Relative error for approximate search.  Default
+%                   value is 0.
+%
+% Examples:
+% model = knn_model(referencePoints, 'treeType', 'cover');
+% [distances neighbors] = model.search(queryPoints, 5);
+% [distances neighbors] = model.search([], 5); % Search the reference set.
+
+  properties (Access = private)
+    handle % The handle to the model in the mex file.
+  end
+
+  methods
+    function this = knn_model(referencePoints, varargin)
+      % a parser for the inputs
+      p = inputParser;
+      p.addParamValue('leafSize', 20, @isscalar);
+      p.addParamValue('treeType', 'kd', @ischar);
+      p.addParamValue('mode', 'dual', @ischar);
+      p.addParamValue('epsilon', 0, @isscalar);
+
+      % parsing the varargin options
+      p.parse(varargin{:});
+      parsed = p.Results;
+
+      % interfacing with mlpack
+      this.handle = knn_model_mex('build', referencePoints, parsed.leafSize, ...
+          parsed.treeType, parsed.mode, parsed.epsilon);
+    end
+
+    function [distances neighbors] = search(this, queryPoints, k)
+      [distances neighbors] = knn_model_mex('search', this.handle, ...
+          queryPoints, k);
+    end
+
+    function delete(this)
+      if ~isempty(this.handle)
+        knn_model_mex('free', this.handle);
+      end
+    end
+  end
+end
@@ -0,0 +1,199 @@
+/**
+ * @file mex_util.hpp
+ *
+ * Utilities shared by the MATLAB bindings: Armadillo objects that use the
+ * memory of MATLAB arrays directly, and handles that keep mlpack models alive
+ * between calls to a MEX function.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BINDINGS_MATLAB_MEX_UTIL_HPP
+#define MLPACK_BINDINGS_MATLAB_MEX_UTIL_HPP
+
+#include "mex.h"
+
+#include <mlpack/core.hpp>
+#include <set>
+
+namespace mlpack {
+namespace matlab {
+
+/**
+ * Return a matrix that uses the memory of the given real double MATLAB array,
+ * without copying it.  Each column of the array is a point, as in the rest of
+ * mlpack.  MATLAB arrays must not be modified by a MEX function, so the matrix
+ * must only be read, and it must not be passed as an rvalue to anything that
+ * reorders or overwrites its argument (like the construction of a tree).
+ */
+inline arma::mat MatrixFromMx(const mxArray* array, const char* name)
+{
+  if (!mxIsDouble(array) || mxIsComplex(array) || mxIsSparse(array))
+  {
+    std::ostringstream oss;
+    oss << name << " must be a full, real matrix of doubles.";
+    mexErrMsgTxt(oss.str().c_str());
+  }
+
+  return arma::mat(mxGetPr(array), mxGetM(array), mxGetN(array), false, true);
+}
+
+/**
+ * Create a real double MATLAB array with the given size, and return a matrix
+ * that uses its memory.  The results of a method can be written to the matrix
+ * directly, and the array can then be returned to MATLAB without a copy.
+ */
+inline arma::mat CreateMxMatrix(mxArray*& array,
+                                const size_t rows,
+                                const size_t cols)
+{
+  array = mxCreateDoubleMatrix(rows, cols, mxREAL);
+  return arma::mat(mxGetPr(array), rows, cols, false, true);
+}
+
+/**
+ * Create a uint64 MATLAB array with the given size, for indices.  If size_t is
+ * 64 bits, the returned matrix uses the memory of the array; otherwise it has
+ * its own memory, and must be given to FinishMxIndices() once it is filled.
+ */
+inline arma::Mat<size_t> CreateMxIndices(mxArray*& array,
+                                         const size_t rows,
+                                         const size_t cols)
+{
+  array = mxCreateNumericMatrix(rows, cols, mxUINT64_CLASS, mxREAL);
+  if (sizeof(size_t) != sizeof(uint64_T))
+    return arma::Mat<size_t>(rows, cols);
+
+  return arma::Mat<size_t>((size_t*) mxGetData(array), rows, cols, false,
+      true);
+}
+
+/**
+ * Make sure that the given results, created with CreateMxMatrix(), are in the
+ * memory of the MATLAB array.  A method may replace the memory of its output
+ * (for instance if it moves a temporary result into it); then the results are
+ * copied.
+ */
+inline void FinishMxMatrix(mxArray* array, const arma::mat& matrix)
+{
+  if (matrix.memptr() != mxGetPr(array))
+    std::copy(matrix.begin(), matrix.end(), mxGetPr(array));
+}
+
+/**
+ * Make sure that the given indices, created with CreateMxIndices(), are in the
+ * memory of the MATLAB array, and add one to each of them, since MATLAB indices
+ * start at one.
+ */
+inline void FinishMxIndices(mxArray* array, const arma::Mat<size_t>& indices)
+{
+  uint64_T* out = (uint64_T*) mxGetData(array);
+  if ((void*) indices.memptr() != (void*) out)
+  {
+    for (size_t i = 0; i < indices.n_elem; ++i)
+      out[i] = (uint64_T) indices[i] + 1;
+  }
+  else
+  {
+    for (size_t i = 0; i < indices.n_elem; ++i)
+      ++out[i];
+  }
+}
+
+/**
+ * Get the string command given as the first argument of a MEX function.
+ */
+inline std::string CommandFromMx(int nrhs, const mxArray* prhs[])
+{
+  if (nrhs < 1 || !mxIsChar(prhs[0]))
+    mexErrMsgTxt("The first input must be a command string.");
+
+  char* command = mxArrayToString(prhs[0]);
+  std::string result(command);
+  mxFree(command);
+  return result;
+}
+
+/**
+ * Handles to models of type ModelType that live between the calls to a MEX
+ * function.  A handle is returned to MATLAB as a uint64 scalar.  Each handle is
+ * checked against the set of live handles before it is used, so a handle that
+ * was freed, or that did not come from this MEX file, gives an error instead
+ * of a crash.  The MEX file is locked while any model is alive, so that
+ * MATLAB's "clear mex" does not unload it, and any remaining models are
+ * deleted when MATLAB exits.
+ */
+template<typename ModelType>
+class ModelHandles
+{
+ public:
+  //! Take ownership of the given model and return a new handle to it.
+  static mxArray* Create(ModelType* model)
+  {
+    if (Models().empty())
+      mexAtExit(&ModelHandles::FreeAll);
+
+    Models().insert(model);
+    mexLock();
+
+    mxArray* handle = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *((uint64_T*) mxGetData(handle)) = (uint64_T) (uintptr_t) model;
+    return handle;
+  }
+
+  //! Get the model the given handle refers to.
+  static ModelType& Get(const mxArray* handle)
+  {
+    return *Find(handle);
+  }
+
+  //! Delete the model the given handle refers to.
+  static void Free(const mxArray* handle)
+  {
+    ModelType* model = Find(handle);
+    Models().erase(model);
+    delete model;
+    mexUnlock();
+  }
+
+ private:
+  //! Find the live model for the given handle.
+  static ModelType* Find(const mxArray* handle)
+  {
+    if (!mxIsUint64(handle) || mxIsComplex(handle) ||
+        mxGetNumberOfElements(handle) != 1)
+      mexErrMsgTxt("The model handle must be a uint64 scalar.");
+
+    ModelType* model = (ModelType*) (uintptr_t)
+        *((const uint64_T*) mxGetData(handle));
+    if (Models().count(model) == 0)
+      mexErrMsgTxt("The model handle is not valid; was the model freed?");
+
+    return model;
+  }
+
+  //! Delete all the models that are still alive.
+  static void FreeAll()
+  {
+    for (ModelType* model : Models())
+    {
+      delete model;
+      mexUnlock();
+    }
+    Models().clear();
+  }
+
+  //! The set of live models.
+  static std::set<ModelType*>& Models()
+  {
+    static std::set<ModelType*> models;
+    return models;
+  }
+};
+
+} // namespace matlab
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,153 @@
+/**
+ * @file buffer_util.cpp
+ *
+ * Implementation of the Python type that exports the memory of the results of
+ * the Python bindings.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "buffer_util.hpp"
+
+namespace mlpack {
+namespace python {
+
+/**
+ * A Python object that owns an Armadillo matrix of doubles or of indices, and
+ * exports its memory through the buffer protocol.
+ */
+struct ResultObject
+{
+  PyObject_HEAD
+  //! The matrix of doubles, if this holds doubles.
+  arma::mat* values;
+  //! The matrix of indices, if this holds indices.
+  arma::Mat<size_t>* indices;
+  //! Whether the result is exported with one dimension.
+  bool row;
+  //! The exported shape.
+  Py_ssize_t shape[2];
+  //! The exported strides.
+  Py_ssize_t strides[2];
+};
+
+//! Get the buffer format of the given element type.
+template<typename eT>
+static const char* BufferFormat();
+
+template<>
+const char* BufferFormat<double>() { return "d"; }
+
+template<>
+const char* BufferFormat<size_t>()
+{
+  if (sizeof(size_t) == sizeof(unsigned long long))
+    return "Q";
+  else if (sizeof(size_t) == sizeof(unsigned long))
+    return "L";
+  return "I";
+}
+
+//! Fill the buffer view of the given matrix.
+template<typename eT>
+static int GetMatrixBuffer(ResultObject* self,
+                           arma::Mat<eT>& matrix,
+                           Py_buffer* view,
+                           int flags)
+{
+  if (self->row)
+  {
+    self->shape[0] = (Py_ssize_t) matrix.n_elem;
+    self->strides[0] = (Py_ssize_t) sizeof(eT);
+  }
+  else
+  {
+    self->shape[0] = (Py_ssize_t) matrix.n_cols;
+    self->shape[1] = (Py_ssize_t) matrix.n_rows;
+    self->strides[0] = (Py_ssize_t) (matrix.n_rows * sizeof(eT));
+    self->strides[1] = (Py_ssize_t) sizeof(eT);
+  }
+
+  view->obj = (PyObject*) self;
+  Py_INCREF(self);
+  view->buf = matrix.memptr();
+  view->len = (Py_ssize_t) (matrix.n_elem * sizeof(eT));
+  view->readonly = 0;
+  view->itemsize = (Py_ssize_t) sizeof(eT);
+  view->format = (flags & PyBUF_FORMAT) ? (char*) BufferFormat<eT>() : NULL;
+  view->ndim = self->row ? 1 : 2;
+  view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides :
+      NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
+//! Export the buffer of a ResultObject.
+static int ResultGetBuffer(PyObject* object, Py_buffer* view, int flags)
+{
+  ResultObject* self = (ResultObject*) object;
+  if (self->values)
+    return GetMatrixBuffer(self, *self->values, view, flags);
+  return GetMatrixBuffer(self, *self->indices, view, flags);
+}
+
+//! Delete a ResultObject.
+static void ResultDealloc(PyObject* object)
+{
+  ResultObject* self = (ResultObject*) object;
+  delete self->values;
+  delete self->indices;
+  Py_TYPE(object)->tp_free(object);
+}
+
+//! The buffer functions of ResultObject.
+static PyBufferProcs resultBufferProcs = { &ResultGetBuffer, NULL };
+
+//! The Python type of ResultObject.
+static PyTypeObject resultType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "mlpack._mlpack.Result",                 // tp_name
+  sizeof(ResultObject),                    // tp_basicsize
+  0,                                       // tp_itemsize
+  &ResultDealloc,                          // tp_dealloc
+};
+
+bool ReadyResultType()
+{
+  resultType.tp_flags = Py_TPFLAGS_DEFAULT;
+  resultType.tp_doc = "The memory of an array of results, for numpy.asarray().";
+  resultType.tp_as_buffer = &resultBufferProcs;
+  return (PyType_Ready(&resultType) == 0);
+}
+
+PyObject* ToResult(arma::mat&& values, const bool row)
+{
+  ResultObject* result = PyObject_New(ResultObject, &resultType);
+  if (result == NULL)
+    return NULL;
+
+  // Moving the matrix takes its memory.
+  result->values = new arma::mat(std::move(values));
+  result->indices = NULL;
+  result->row = row;
+  return (PyObject*) result;
+}
+
+PyObject* ToResult(arma::Mat<size_t>&& indices, const bool row)
+{
+  ResultObject* result = PyObject_New(ResultObject, &resultType);
+  if (result == NULL)
+    return NULL;
+
+  result->values = NULL;
+  result->indices = new arma::Mat<size_t>(std::move(indices));
+  result->row = row;
+  return (PyObject*) result;
+}
+
+} // namespace python
+} // namespace mlpack
@@ -0,0 +1,145 @@
+/**
+ * @file buffer_util.hpp
+ *
+ * Utilities shared by the Python bindings to pass matrices between Python and
+ * Armadillo through the buffer protocol, so that NumPy arrays are used without
+ * copies in both directions.
+ *
+ * A C-contiguous NumPy array of shape (n, d) holds n points of d dimensions,
+ * one per row, and has the same memory layout as a d x n column-major
+ * Armadillo matrix holding one point per column, as mlpack expects.  So inputs
+ * are wrapped as Armadillo matrices over the memory of the array, and results
+ * are returned as objects that export the memory of the Armadillo matrix, which
+ * numpy.asarray() wraps without a copy.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BINDINGS_PYTHON_BUFFER_UTIL_HPP
+#define MLPACK_BINDINGS_PYTHON_BUFFER_UTIL_HPP
+
+// Python.h must be included before any standard header.
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <mlpack/core.hpp>
+#include <memory>
+
+namespace mlpack {
+namespace python {
+
+/**
+ * An Armadillo matrix over the memory of a Python object that exports a
+ * C-contiguous buffer of doubles with one or two dimensions.  The buffer is
+ * held until the BufferMatrix is destroyed.  A one-dimensional buffer of
+ * length n holds n points of one dimension.  The matrix must only be read, and
+ * must not be passed as an rvalue to anything that reorders or overwrites its
+ * argument (like the construction of a tree).
+ */
+class BufferMatrix
+{
+ public:
+  //! Create an empty BufferMatrix.
+  BufferMatrix() : acquired(false) { }
+
+  //! Release the buffer, if it is held.
+  ~BufferMatrix()
+  {
+    if (acquired)
+      PyBuffer_Release(&view);
+  }
+
+  /**
+   * Get the buffer of the given object.  If the object does not export a
+   * suitable buffer, false is returned and a Python exception is set.
+   *
+   * @param object Object to get the buffer of.
+   * @param name Name of the argument, for error messages.
+   */
+  bool Acquire(PyObject* object, const char* name)
+  {
+    if (PyObject_GetBuffer(object, &view, PyBUF_C_CONTIGUOUS |
+        PyBUF_FORMAT) != 0)
+    {
+      PyErr_Format(PyExc_TypeError, "%s must be a C-contiguous array of "
+          "doubles", name);
+      return false;
+    }
+    acquired = true;
+
+    if (!IsDoubleFormat(view.format) || (view.ndim != 1 && view.ndim != 2))
+    {
+      PyErr_Format(PyExc_TypeError, "%s must be a one or two-dimensional "
+          "array of doubles (numpy.float64)", name);
+      return false;
+    }
+
+    const size_t points = (size_t) view.shape[0];
+    const size_t dimensions = (view.ndim == 2) ? (size_t) view.shape[1] : 1;
+    matrix.reset(new arma::mat((double*) view.buf, dimensions, points, false,
+        true));
+    return true;
+  }
+
+  //! Get the matrix.
+  const arma::mat& Matrix() const { return *matrix; }
+
+ private:
+  //! Return whether the given buffer format is that of native doubles.
+  static bool IsDoubleFormat(const char* format)
+  {
+    if (format == NULL)
+      return false;
+
+    const std::string f(format);
+    if (f == "d" || f == "@d" || f == "=d")
+      return true;
+
+    const uint16_t one = 1;
+    const bool littleEndian = (*((const uint8_t*) &one) == 1);
+    return (f == (littleEndian ? "<d" : ">d"));
+  }
+
+  //! The buffer of the object.
+  Py_buffer view;
+  //! Whether the buffer is held.
+  bool acquired;
+  //! The matrix over the memory of the buffer.
+  std::unique_ptr<arma::mat> matrix;
+};
+
+/**
+ * Prepare the Python type of the results; call this once, when the module is
+ * initialized.  A Python exception is set if it fails.
+ */
+bool ReadyResultType();
+
+/**
+ * Create a Python object that takes the memory of the given results, without a
+ * copy, and exports it through the buffer protocol.  A matrix with n columns of
+ * d elements is exported as a C-contiguous array of shape (n, d), or of shape
+ * (n,) if row is true.
+ */
+PyObject* ToResult(arma::mat&& values, const bool row = false);
+
+//! Create a Python object that takes the memory of the given indices.
+PyObject* ToResult(arma::Mat<size_t>&& indices, const bool row = false);
+
+/**
+ * Set a Python exception for the given C++ exception: invalid arguments become
+ * ValueErrors, and everything else (including Log::Fatal) a RuntimeError.
+ */
+inline void SetError(const std::exception& e)
+{
+  if (dynamic_cast<const std::invalid_argument*>(&e))
+    PyErr_SetString(PyExc_ValueError, e.what());
+  else
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+}
+
+} // namespace python
+} // namespace mlpack
+
+#endif
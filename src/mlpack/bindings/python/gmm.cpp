@@ -0,0 +1,246 @@
+/**
+ * @file gmm.cpp
+ *
+ * The GMM type of the Python bindings: a Gaussian mixture model trained once
+ * and kept in memory, to compute the probabilities of and to classify any
+ * number of sets of points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "buffer_util.hpp"
+#include "types.hpp"
+
+#include <mlpack/methods/gmm/gmm.hpp>
+
+using namespace mlpack;
+using namespace mlpack::gmm;
+
+namespace mlpack {
+namespace python {
+
+//! A Python object holding a GMM.
+struct GMMObject
+{
+  PyObject_HEAD
+  //! The model, or NULL if it has not been trained.
+  GMM* model;
+  //! The log-likelihood of the training points.
+  double logLikelihood;
+};
+
+static int GMMInit(PyObject* object, PyObject* args, PyObject* kwargs)
+{
+  GMMObject* self = (GMMObject*) object;
+
+  static const char* keywords[] = { "data", "gaussians", "trials", "seed",
+      NULL };
+  PyObject* data;
+  Py_ssize_t gaussians = 1;
+  Py_ssize_t trials = 1;
+  unsigned long long seed = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nnK", (char**) keywords,
+      &data, &gaussians, &trials, &seed))
+    return -1;
+
+  if (gaussians <= 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "gaussians must be greater than 0");
+    return -1;
+  }
+  if (trials <= 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "trials must be greater than 0");
+    return -1;
+  }
+
+  // Training only reads the points, so they are not copied.
+  BufferMatrix points;
+  if (!points.Acquire(data, "data"))
+    return -1;
+
+  if (seed != 0)
+    math::RandomSeed((size_t) seed);
+  else
+    math::RandomSeed((size_t) std::time(NULL));
+
+  try
+  {
+    GMM* model = new GMM(size_t(gaussians), points.Matrix().n_rows);
+    try
+    {
+      self->logLikelihood = model->Train(points.Matrix(), size_t(trials));
+    }
+    catch (...)
+    {
+      delete model;
+      throw;
+    }
+
+    delete self->model;
+    self->model = model;
+  }
+  catch (std::exception& e)
+  {
+    SetError(e);
+    return -1;
+  }
+
+  return 0;
+}
+
+//! Get the points argument, and check its dimensionality against the model.
+static bool PointsFromArgs(GMMObject* self,
+                           PyObject* args,
+                           BufferMatrix& points)
+{
+  if (self->model == NULL)
+  {
+    PyErr_SetString(PyExc_RuntimeError, "the model has not been trained");
+    return false;
+  }
+
+  PyObject* object;
+  if (!PyArg_ParseTuple(args, "O", &object) ||
+      !points.Acquire(object, "points"))
+    return false;
+
+  if (points.Matrix().n_rows != self->model->Dimensionality())
+  {
+    PyErr_Format(PyExc_ValueError, "the points have %zu dimensions, but the "
+        "model has %zu", (size_t) points.Matrix().n_rows,
+        (size_t) self->model->Dimensionality());
+    return false;
+  }
+
+  return true;
+}
+
+//! Compute the probabilities or log probabilities of the points.
+static PyObject* ComputeProbability(GMMObject* self,
+                                    PyObject* args,
+                                    const bool log)
+{
+  BufferMatrix points;
+  if (!PointsFromArgs(self, args, points))
+    return NULL;
+
+  arma::vec probabilities;
+  try
+  {
+    if (log)
+      self->model->LogProbability(points.Matrix(), probabilities);
+    else
+      self->model->Probability(points.Matrix(), probabilities);
+  }
+  catch (std::exception& e)
+  {
+    SetError(e);
+    return NULL;
+  }
+
+  return ToResult(std::move(probabilities), true);
+}
+
+static PyObject* GMMProbability(PyObject* object, PyObject* args)
+{
+  return ComputeProbability((GMMObject*) object, args, false);
+}
+
+static PyObject* GMMLogProbability(PyObject* object, PyObject* args)
+{
+  return ComputeProbability((GMMObject*) object, args, true);
+}
+
+static PyObject* GMMClassify(PyObject* object, PyObject* args)
+{
+  GMMObject* self = (GMMObject*) object;
+  BufferMatrix points;
+  if (!PointsFromArgs(self, args, points))
+    return NULL;
+
+  arma::Row<size_t> labels;
+  try
+  {
+    self->model->Classify(points.Matrix(), labels);
+  }
+  catch (std::exception& e)
+  {
+    SetError(e);
+    return NULL;
+  }
+
+  return ToResult(std::move(labels), true);
+}
+
+static PyObject* GMMGetLogLikelihood(PyObject* object, void* /* closure */)
+{
+  return PyFloat_FromDouble(((GMMObject*) object)->logLikelihood);
+}
+
+static void GMMDealloc(PyObject* object)
+{
+  GMMObject* self = (GMMObject*) object;
+  delete self->model;
+  Py_TYPE(object)->tp_free(object);
+}
+
+static PyObject* GMMNew(PyTypeObject* type, PyObject* /* args */,
+                        PyObject* /* kwargs */)
+{
+  GMMObject* self = (GMMObject*) type->tp_alloc(type, 0);
+  if (self != NULL)
+  {
+    self->model = NULL;
+    self->logLikelihood = 0.0;
+  }
+  return (PyObject*) self;
+}
+
+static PyMethodDef gmmMethods[] = {
+  { "probability", &GMMProbability, METH_VARARGS,
+    "probability(points) -> densities\n\n"
+    "Compute the density of the model at each point." },
+  { "log_probability", &GMMLogProbability, METH_VARARGS,
+    "log_probability(points) -> log densities\n\n"
+    "Compute the log density of the model at each point." },
+  { "classify", &GMMClassify, METH_VARARGS,
+    "classify(points) -> labels\n\n"
+    "Find the most probable component of each point." },
+  { NULL, NULL, 0, NULL }
+};
+
+static PyGetSetDef gmmGetSet[] = {
+  { (char*) "log_likelihood", &GMMGetLogLikelihood, NULL,
+    (char*) "The log-likelihood of the training points.", NULL },
+  { NULL, NULL, NULL, NULL, NULL }
+};
+
+static PyTypeObject gmmType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "mlpack._mlpack.GMM",                    // tp_name
+  sizeof(GMMObject),                       // tp_basicsize
+  0,                                       // tp_itemsize
+  &GMMDealloc,                             // tp_dealloc
+};
+
+bool AddGMMType(PyObject* module)
+{
+  gmmType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+  gmmType.tp_doc = "GMM(data, gaussians=1, trials=1, seed=0)\n\nA Gaussian "
+      "mixture model trained with EM on the given points, one point per row.";
+  gmmType.tp_methods = gmmMethods;
+  gmmType.tp_getset = gmmGetSet;
+  gmmType.tp_init = &GMMInit;
+  gmmType.tp_new = &GMMNew;
+  if (PyType_Ready(&gmmType) != 0)
+    return false;
+
+  Py_INCREF(&gmmType);
+  return (PyModule_AddObject(module, "GMM", (PyObject*) &gmmType) == 0);
+}
+
+} // namespace python
+} // namespace mlpack
@@ -0,0 +1,216 @@
+/**
+ * @file hmm.cpp
+ *
+ * The HMM type of the Python bindings: a hidden Markov model, as saved by
+ * mlpack_hmm_train, loaded once and kept in memory to decode and evaluate any
+ * number of sequences.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "buffer_util.hpp"
+#include "types.hpp"
+
+#include <mlpack/methods/hmm/hmm.hpp>
+#include <mlpack/methods/hmm/hmm_model.hpp>
+
+using namespace mlpack;
+using namespace mlpack::hmm;
+
+namespace mlpack {
+namespace python {
+
+//! A Python object holding an HMMModel.
+struct HMMObject
+{
+  PyObject_HEAD
+  //! The model, or NULL if it has not been loaded.
+  HMMModel* model;
+};
+
+//! The sequence to run an action on, and its results.
+struct SequenceInfo
+{
+  //! The observations.
+  const arma::mat* sequence;
+  //! The most probable state sequence, for Decode.
+  arma::Row<size_t> states;
+  //! The log-likelihood.
+  double logLikelihood;
+};
+
+//! Check the dimensionality of the sequence against the HMM.
+template<typename HMMType>
+static void CheckDimensionality(const HMMType& hmm, const arma::mat& sequence)
+{
+  if (sequence.n_rows != hmm.Emission()[0].Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "the observations have " << sequence.n_rows << " dimensions, but "
+        << "the HMM has " << hmm.Emission()[0].Dimensionality();
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+//! Find the most probable state sequence with the Viterbi algorithm.
+struct Decode
+{
+  template<typename HMMType>
+  static void Apply(HMMType& hmm, SequenceInfo* info)
+  {
+    CheckDimensionality(hmm, *info->sequence);
+    info->logLikelihood = hmm.Predict(*info->sequence, info->states);
+  }
+};
+
+//! Compute the log-likelihood of the sequence.
+struct Evaluate
+{
+  template<typename HMMType>
+  static void Apply(HMMType& hmm, SequenceInfo* info)
+  {
+    CheckDimensionality(hmm, *info->sequence);
+    info->logLikelihood = hmm.LogLikelihood(*info->sequence);
+  }
+};
+
+static int HMMInit(PyObject* object, PyObject* args, PyObject* kwargs)
+{
+  HMMObject* self = (HMMObject*) object;
+
+  static const char* keywords[] = { "filename", NULL };
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**) keywords,
+      &filename))
+    return -1;
+
+  try
+  {
+    HMMModel* model = new HMMModel();
+    if (!data::Load(filename, "model", *model, false))
+    {
+      delete model;
+      PyErr_Format(PyExc_IOError, "could not load an HMM from '%s'",
+          filename);
+      return -1;
+    }
+
+    delete self->model;
+    self->model = model;
+  }
+  catch (std::exception& e)
+  {
+    SetError(e);
+    return -1;
+  }
+
+  return 0;
+}
+
+//! Run the given action on the sequence given in the arguments.
+template<typename ActionType>
+static bool RunAction(HMMObject* self, PyObject* args, SequenceInfo& info)
+{
+  if (self->model == NULL)
+  {
+    PyErr_SetString(PyExc_RuntimeError, "the model has not been loaded");
+    return false;
+  }
+
+  PyObject* object;
+  BufferMatrix sequence;
+  if (!PyArg_ParseTuple(args, "O", &object) ||
+      !sequence.Acquire(object, "sequence"))
+    return false;
+
+  info.sequence = &sequence.Matrix();
+  try
+  {
+    self->model->PerformAction<ActionType, SequenceInfo>(&info);
+  }
+  catch (std::exception& e)
+  {
+    SetError(e);
+    return false;
+  }
+
+  return true;
+}
+
+static PyObject* HMMPredict(PyObject* object, PyObject* args)
+{
+  SequenceInfo info;
+  if (!RunAction<Decode>((HMMObject*) object, args, info))
+    return NULL;
+
+  PyObject* states = ToResult(std::move(info.states), true);
+  if (states == NULL)
+    return NULL;
+
+  // "N" passes the reference to the states to the tuple.
+  return Py_BuildValue("(Nd)", states, info.logLikelihood);
+}
+
+static PyObject* HMMLogLikelihood(PyObject* object, PyObject* args)
+{
+  SequenceInfo info;
+  if (!RunAction<Evaluate>((HMMObject*) object, args, info))
+    return NULL;
+
+  return PyFloat_FromDouble(info.logLikelihood);
+}
+
+static void HMMDealloc(PyObject* object)
+{
+  HMMObject* self = (HMMObject*) object;
+  delete self->model;
+  Py_TYPE(object)->tp_free(object);
+}
+
+static PyObject* HMMNew(PyTypeObject* type, PyObject* /* args */,
+                        PyObject* /* kwargs */)
+{
+  HMMObject* self = (HMMObject*) type->tp_alloc(type, 0);
+  if (self != NULL)
+    self->model = NULL;
+  return (PyObject*) self;
+}
+
+static PyMethodDef hmmMethods[] = {
+  { "predict", &HMMPredict, METH_VARARGS,
+    "predict(sequence) -> (states, log_likelihood)\n\n"
+    "Find the most probable state sequence of the observations, one per row, "
+    "with the Viterbi algorithm, and its log-likelihood." },
+  { "log_likelihood", &HMMLogLikelihood, METH_VARARGS,
+    "log_likelihood(sequence) -> log_likelihood\n\n"
+    "Compute the log-likelihood of the observations, one per row." },
+  { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject hmmType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "mlpack._mlpack.HMM",                    // tp_name
+  sizeof(HMMObject),                       // tp_basicsize
+  0,                                       // tp_itemsize
+  &HMMDealloc,                             // tp_dealloc
+};
+
+bool AddHMMType(PyObject* module)
+{
+  hmmType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+  hmmType.tp_doc = "HMM(filename)\n\nA hidden Markov model, loaded from a "
+      "model file saved by mlpack_hmm_train.";
+  hmmType.tp_methods = hmmMethods;
+  hmmType.tp_init = &HMMInit;
+  hmmType.tp_new = &HMMNew;
+  if (PyType_Ready(&hmmType) != 0)
+    return false;
+
+  Py_INCREF(&hmmType);
+  return (PyModule_AddObject(module, "HMM", (PyObject*) &hmmType) == 0);
+}
+
+} // namespace python
+} // namespace mlpack
@@ -0,0 +1,75 @@
+/**
+ * @file kmeans.cpp
+ *
+ * The kmeans() function of the Python bindings.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "buffer_util.hpp"
+#include "types.hpp"
+
+#include <mlpack/methods/kmeans/kmeans.hpp>
+
+using namespace mlpack;
+using namespace mlpack::kmeans;
+
+namespace mlpack {
+namespace python {
+
+PyObject* KMeansFunction(PyObject* /* self */, PyObject* args, PyObject* kwargs)
+{
+  static const char* keywords[] = { "data", "clusters", "max_iterations",
+      NULL };
+  PyObject* data;
+  Py_ssize_t clusters;
+  Py_ssize_t maxIterations = 1000;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On|n", (char**) keywords,
+      &data, &clusters, &maxIterations))
+    return NULL;
+
+  if (clusters <= 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "clusters must be greater than 0");
+    return NULL;
+  }
+  if (maxIterations < 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "max_iterations must be at least 0");
+    return NULL;
+  }
+
+  // Clustering only reads the points, so they are not copied.
+  BufferMatrix points;
+  if (!points.Acquire(data, "data"))
+    return NULL;
+
+  arma::Row<size_t> assignments;
+  arma::mat centroids;
+  try
+  {
+    KMeans<> k(size_t(maxIterations));
+    k.Cluster(points.Matrix(), size_t(clusters), assignments, centroids);
+  }
+  catch (std::exception& e)
+  {
+    SetError(e);
+    return NULL;
+  }
+
+  PyObject* assignmentsResult = ToResult(std::move(assignments), true);
+  PyObject* centroidsResult = ToResult(std::move(centroids));
+  if (assignmentsResult == NULL || centroidsResult == NULL)
+  {
+    Py_XDECREF(assignmentsResult);
+    Py_XDECREF(centroidsResult);
+    return NULL;
+  }
+
+  return Py_BuildValue("(NN)", assignmentsResult, centroidsResult);
+}
+
+} // namespace python
+} // namespace mlpack
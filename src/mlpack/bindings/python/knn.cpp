@@ -0,0 +1,281 @@
+/**
+ * @file knn.cpp
+ *
+ * The KNN type of the Python bindings: a k-nearest-neighbor model whose
+ * reference tree is built once and kept in memory, so that many query sets can
+ * be searched without rebuilding it.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "buffer_util.hpp"
+#include "types.hpp"
+
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/ns_model.hpp>
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+namespace mlpack {
+namespace python {
+
+typedef NSModel<NearestNeighborSort> KNNModel;
+
+//! A Python object holding a KNNModel.
+struct KNNObject
+{
+  PyObject_HEAD
+  //! The model, or NULL if it has not been built.
+  KNNModel* model;
+};
+
+//! Convert the name of a tree type to the KNNModel type.
+static bool TreeTypeFromString(const std::string& name,
+                               KNNModel::TreeTypes& type)
+{
+  static const std::map<std::string, KNNModel::TreeTypes> types = {
+    { "kd", KNNModel::KD_TREE },
+    { "cover", KNNModel::COVER_TREE },
+    { "r", KNNModel::R_TREE },
+    { "r-star", KNNModel::R_STAR_TREE },
+    { "ball", KNNModel::BALL_TREE },
+    { "x", KNNModel::X_TREE },
+    { "hilbert-r", KNNModel::HILBERT_R_TREE },
+    { "r-plus", KNNModel::R_PLUS_TREE },
+    { "r-plus-plus", KNNModel::R_PLUS_PLUS_TREE },
+    { "vp", KNNModel::VP_TREE },
+    { "rp", KNNModel::RP_TREE },
+    { "max-rp", KNNModel::MAX_RP_TREE },
+    { "ub", KNNModel::UB_TREE },
+    { "oct", KNNModel::OCTREE }
+  };
+
+  std::map<std::string, KNNModel::TreeTypes>::const_iterator it =
+      types.find(name);
+  if (it == types.end())
+  {
+    PyErr_Format(PyExc_ValueError, "unknown tree type '%s'; must be 'kd', "
+        "'cover', 'r', 'r-star', 'ball', 'x', 'hilbert-r', 'r-plus', "
+        "'r-plus-plus', 'vp', 'rp', 'max-rp', 'ub' or 'oct'", name.c_str());
+    return false;
+  }
+
+  type = it->second;
+  return true;
+}
+
+//! Convert the name of a search mode to the NeighborSearchMode.
+static bool SearchModeFromString(const std::string& name,
+                                 NeighborSearchMode& mode)
+{
+  if (name == "naive")
+    mode = NAIVE_MODE;
+  else if (name == "single")
+    mode = SINGLE_TREE_MODE;
+  else if (name == "dual")
+    mode = DUAL_TREE_MODE;
+  else if (name == "greedy")
+    mode = GREEDY_SINGLE_TREE_MODE;
+  else
+  {
+    PyErr_Format(PyExc_ValueError, "unknown search mode '%s'; must be "
+        "'naive', 'single', 'dual' or 'greedy'", name.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+static int KNNInit(PyObject* object, PyObject* args, PyObject* kwargs)
+{
+  KNNObject* self = (KNNObject*) object;
+
+  static const char* keywords[] = { "reference", "leaf_size", "tree_type",
+      "mode", "epsilon", NULL };
+  PyObject* reference;
+  Py_ssize_t leafSize = 20;
+  const char* treeTypeName = "kd";
+  const char* modeName = "dual";
+  double epsilon = 0.0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nssd", (char**) keywords,
+      &reference, &leafSize, &treeTypeName, &modeName, &epsilon))
+    return -1;
+
+  if (leafSize <= 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "leaf_size must be greater than 0");
+    return -1;
+  }
+  if (epsilon < 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "epsilon must be at least 0");
+    return -1;
+  }
+
+  KNNModel::TreeTypes treeType;
+  NeighborSearchMode mode;
+  if (!TreeTypeFromString(treeTypeName, treeType) ||
+      !SearchModeFromString(modeName, mode))
+    return -1;
+
+  BufferMatrix points;
+  if (!points.Acquire(reference, "reference"))
+    return -1;
+
+  try
+  {
+    // The model outlives the call and the tree reorders its points, so this
+    // is the one place where the points are copied.
+    arma::mat referenceSet(points.Matrix());
+    KNNModel* model = new KNNModel(treeType);
+    try
+    {
+      model->BuildModel(std::move(referenceSet), size_t(leafSize), mode,
+          epsilon);
+    }
+    catch (...)
+    {
+      delete model;
+      throw;
+    }
+
+    delete self->model;
+    self->model = model;
+  }
+  catch (std::exception& e)
+  {
+    SetError(e);
+    return -1;
+  }
+
+  return 0;
+}
+
+static PyObject* KNNSearch(PyObject* object, PyObject* args, PyObject* kwargs)
+{
+  KNNObject* self = (KNNObject*) object;
+  if (self->model == NULL)
+  {
+    PyErr_SetString(PyExc_RuntimeError, "the model has not been built");
+    return NULL;
+  }
+
+  static const char* keywords[] = { "query", "k", NULL };
+  PyObject* query;
+  Py_ssize_t k;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", (char**) keywords,
+      &query, &k))
+    return NULL;
+
+  if (k <= 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "k must be greater than 0");
+    return NULL;
+  }
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  try
+  {
+    if (query == Py_None)
+    {
+      // Search the reference set.
+      self->model->Search(size_t(k), neighbors, distances);
+    }
+    else
+    {
+      BufferMatrix points;
+      if (!points.Acquire(query, "query"))
+        return NULL;
+
+      // Only dual-tree search builds a tree on the query points, which would
+      // reorder them; the other modes read the buffer directly.
+      if (self->model->SearchMode() == DUAL_TREE_MODE)
+      {
+        self->model->Search(arma::mat(points.Matrix()), size_t(k), neighbors,
+            distances);
+      }
+      else
+      {
+        arma::mat querySet((double*) points.Matrix().memptr(),
+            points.Matrix().n_rows, points.Matrix().n_cols, false, true);
+        self->model->Search(std::move(querySet), size_t(k), neighbors,
+            distances);
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    SetError(e);
+    return NULL;
+  }
+
+  PyObject* distancesResult = ToResult(std::move(distances));
+  PyObject* neighborsResult = ToResult(std::move(neighbors));
+  if (distancesResult == NULL || neighborsResult == NULL)
+  {
+    Py_XDECREF(distancesResult);
+    Py_XDECREF(neighborsResult);
+    return NULL;
+  }
+
+  PyObject* result = PyTuple_Pack(2, distancesResult, neighborsResult);
+  Py_DECREF(distancesResult);
+  Py_DECREF(neighborsResult);
+  return result;
+}
+
+static void KNNDealloc(PyObject* object)
+{
+  KNNObject* self = (KNNObject*) object;
+  delete self->model;
+  Py_TYPE(object)->tp_free(object);
+}
+
+static PyObject* KNNNew(PyTypeObject* type, PyObject* /* args */,
+                        PyObject* /* kwargs */)
+{
+  KNNObject* self = (KNNObject*) type->tp_alloc(type, 0);
+  if (self != NULL)
+    self->model = NULL;
+  return (PyObject*) self;
+}
+
+static PyMethodDef knnMethods[] = {
+  { "search", (PyCFunction) (void*) &KNNSearch, METH_VARARGS | METH_KEYWORDS,
+    "search(query, k) -> (distances, neighbors)\n\n"
+    "Find the k nearest neighbors of each query point (or of each reference "
+    "point, if query is None).  Row i of the results holds the distances to "
+    "and the indices of the neighbors of point i." },
+  { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject knnType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "mlpack._mlpack.KNN",                    // tp_name
+  sizeof(KNNObject),                       // tp_basicsize
+  0,                                       // tp_itemsize
+  &KNNDealloc,                             // tp_dealloc
+};
+
+bool AddKNNType(PyObject* module)
+{
+  knnType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+  knnType.tp_doc = "KNN(reference, leaf_size=20, tree_type='kd', mode='dual', "
+      "epsilon=0)\n\nA k-nearest-neighbor model over the given reference "
+      "points, one point per row, with its tree built once.";
+  knnType.tp_methods = knnMethods;
+  knnType.tp_init = &KNNInit;
+  knnType.tp_new = &KNNNew;
+  if (PyType_Ready(&knnType) != 0)
+    return false;
+
+  Py_INCREF(&knnType);
+  return (PyModule_AddObject(module, "KNN", (PyObject*) &knnType) == 0);
+}
+
+} // namespace python
+} // namespace mlpack
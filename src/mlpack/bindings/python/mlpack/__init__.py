@@ -0,0 +1,118 @@
+"""
+mlpack: a scalable C++ machine learning library, in Python.
+
+The models are kept in memory between calls, and NumPy arrays are passed to
+and from mlpack without copies: a C-contiguous float64 array of shape (n, d),
+holding n points of d dimensions, has the same memory layout as the d x n
+column-major matrices mlpack uses.  Other arrays are converted (and so copied)
+first.  An array that holds one point per column can be given with
+columns=True; if it is Fortran-ordered, like the matrices of mlpack, that is
+not copied either.
+
+mlpack is free software; you may redistribute it and/or modify it under the
+terms of the 3-clause BSD license.  You should have received a copy of the
+3-clause BSD license along with mlpack.  If not, see
+http://www.opensource.org/licenses/BSD-3-Clause for more information.
+"""
+import numpy as np
+
+from . import _mlpack
+
+
+def _points(x, columns=False):
+    """Return the given points as a C-contiguous float64 array with one point
+    per row, copying them only if necessary."""
+    x = np.asarray(x, dtype=np.float64)
+    if columns:
+        x = x.T
+    return np.ascontiguousarray(x)
+
+
+class KNN(object):
+    """A k-nearest-neighbor model.  The tree on the reference points is built
+    once, and then used for every search.
+
+    reference: the reference points, one point per row.
+    leaf_size: the leaf size of the tree.
+    tree_type: 'kd', 'cover', 'r', 'r-star', 'ball', 'x', 'hilbert-r',
+        'r-plus', 'r-plus-plus', 'vp', 'rp', 'max-rp', 'ub' or 'oct'.
+    mode: 'naive', 'single', 'dual' or 'greedy'.
+    epsilon: the relative error allowed, for approximate search.
+    columns: whether the points are given one per column.
+    """
+
+    def __init__(self, reference, leaf_size=20, tree_type='kd', mode='dual',
+                 epsilon=0.0, columns=False):
+        self._model = _mlpack.KNN(_points(reference, columns), leaf_size,
+                                  tree_type, mode, epsilon)
+
+    def search(self, query=None, k=1, columns=False):
+        """Find the k nearest neighbors of each query point, or of each
+        reference point if query is None.  Row i of the returned distances
+        and neighbors holds the distances to and the indices of the neighbors
+        of point i, nearest first."""
+        if query is not None:
+            query = _points(query, columns)
+        distances, neighbors = self._model.search(query, k)
+        return np.asarray(distances), np.asarray(neighbors)
+
+
+class GMM(object):
+    """A Gaussian mixture model, trained with EM.
+
+    data: the points to train on, one point per row.
+    gaussians: the number of components.
+    trials: the number of times to run EM; the best fit is kept.
+    seed: the random seed, or 0 to use the time.
+    columns: whether the points are given one per column.
+    """
+
+    def __init__(self, data, gaussians=1, trials=1, seed=0, columns=False):
+        self._model = _mlpack.GMM(_points(data, columns), gaussians, trials,
+                                  seed)
+
+    @property
+    def log_likelihood(self):
+        """The log-likelihood of the training points."""
+        return self._model.log_likelihood
+
+    def probability(self, points, columns=False):
+        """Compute the density of the model at each point."""
+        return np.asarray(self._model.probability(_points(points, columns)))
+
+    def log_probability(self, points, columns=False):
+        """Compute the log density of the model at each point."""
+        return np.asarray(self._model.log_probability(_points(points,
+                                                              columns)))
+
+    def classify(self, points, columns=False):
+        """Find the most probable component of each point."""
+        return np.asarray(self._model.classify(_points(points, columns)))
+
+
+class HMM(object):
+    """A hidden Markov model, loaded from a model file saved by
+    mlpack_hmm_train."""
+
+    def __init__(self, filename):
+        self._model = _mlpack.HMM(filename)
+
+    def predict(self, sequence, columns=False):
+        """Find the most probable state sequence of the observations, one per
+        row, with the Viterbi algorithm.  Returns the states and their
+        log-likelihood."""
+        states, log_likelihood = self._model.predict(_points(sequence,
+                                                             columns))
+        return np.asarray(states), log_likelihood
+
+    def log_likelihood(self, sequence, columns=False):
+        """Compute the log-likelihood of the observations, one per row."""
+        return self._model.log_likelihood(_points(sequence, columns))
+
+
+def kmeans(data, clusters, max_iterations=1000, columns=False):
+    """Cluster the given points, one per row, with k-means.  Returns the
+    cluster of each point and the centroids, one per row."""
+    assignments, centroids = _mlpack.kmeans(_points(data, columns), clusters,
+                                            max_iterations)
+    return np.asarray(assignments), np.asarray(centroids)
@@ -0,0 +1,47 @@
+/**
+ * @file module.cpp
+ *
+ * Definition of the _mlpack Python extension module.  The mlpack Python
+ * package wraps it to convert the arguments and results to NumPy arrays.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "buffer_util.hpp"
+#include "types.hpp"
+
+using namespace mlpack::python;
+
+static PyMethodDef moduleMethods[] = {
+  { "kmeans", (PyCFunction) (void*) &KMeansFunction,
+    METH_VARARGS | METH_KEYWORDS,
+    "kmeans(data, clusters, max_iterations=1000) -> (assignments, centroids)"
+    "\n\nCluster the given points, one point per row, with k-means." },
+  { NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef moduleDef = {
+  PyModuleDef_HEAD_INIT,
+  "_mlpack",                               // m_name
+  "The mlpack extension module; use the mlpack package instead.", // m_doc
+  -1,                                      // m_size
+  moduleMethods                            // m_methods
+};
+
+PyMODINIT_FUNC PyInit__mlpack()
+{
+  PyObject* module = PyModule_Create(&moduleDef);
+  if (module == NULL)
+    return NULL;
+
+  if (!ReadyResultType() || !AddKNNType(module) || !AddGMMType(module) ||
+      !AddHMMType(module))
+  {
+    Py_DECREF(module);
+    return NULL;
+  }
+
+  return module;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file types.hpp
+ *
+ * The types and functions of the _mlpack Python module, each added to the
+ * module when it is initialized.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BINDINGS_PYTHON_TYPES_HPP
+#define MLPACK_BINDINGS_PYTHON_TYPES_HPP
+
+#include "buffer_util.hpp"
+
+namespace mlpack {
+namespace python {
+
+//! Add the KNN type to the module; a Python exception is set on failure.
+bool AddKNNType(PyObject* module);
+
+//! Add the GMM type to the module; a Python exception is set on failure.
+bool AddGMMType(PyObject* module);
+
+//! Add the HMM type to the module; a Python exception is set on failure.
+bool AddHMMType(PyObject* module);
+
+//! kmeans(data, clusters, max_iterations=1000) -> (assignments, centroids)
+PyObject* KMeansFunction(PyObject* self, PyObject* args, PyObject* kwargs);
+
+} // namespace python
+} // namespace mlpack
+
+#endif
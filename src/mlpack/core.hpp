@@ -70,6 +70,7 @@
  * - mlpack_hmm_loglik
  * - mlpack_hmm_viterbi
  * - mlpack_hmm_generate
+ * - mlpack_hnsw
  * - mlpack_hoeffding_tree
  * - mlpack_kernel_pca
  * - mlpack_kfn
@@ -86,7 +87,9 @@
  * - mlpack_nca
  * - mlpack_pca
  * - mlpack_perceptron
+ * - mlpack_pq_knn
  * - mlpack_radical
+ * - mlpack_random_forest
  * - mlpack_range_search
  * - mlpack_softmax_regression
  * - mlpack_sparse_coding
@@ -130,6 +133,7 @@
  *  - Neighborhood Components Analysis (NCA) - mlpack::nca::NCA
  *  - Principal Components Analysis (PCA) - mlpack::pca::PCA
  *  - RADICAL (ICA) - mlpack::radical::Radical
+ *  - Random Forests - mlpack::tree::RandomForest
  *  - Simple Least-Squares Linear Regression -
  *        mlpack::regression::LinearRegression
  *  - Sparse Coding - mlpack::sparse_coding::SparseCoding
@@ -231,6 +235,7 @@
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/deprecated.hpp>
+#include <mlpack/core/util/execution.hpp>
 #include <mlpack/core/data/load.hpp>
 #include <mlpack/core/data/save.hpp>
 #include <mlpack/core/data/normalize_labels.hpp>
@@ -242,6 +247,7 @@
 #include <mlpack/core/math/round.hpp>
 #include <mlpack/core/dists/discrete_distribution.hpp>
 #include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
 #include <mlpack/core/dists/laplace_distribution.hpp>
 #include <mlpack/core/dists/gamma_distribution.hpp>
 
@@ -262,6 +268,7 @@
 #include <mlpack/core/kernels/pspectrum_string_kernel.hpp>
 #include <mlpack/core/kernels/spherical_kernel.hpp>
 #include <mlpack/core/kernels/triangular_kernel.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 
 // Use OpenMP if compiled with -DHAS_OPENMP.
 #ifdef HAS_OPENMP
@@ -25,6 +25,19 @@ void Mat<eT>::serialize(Archive& ar, const unsigned int /* version */)
   ar & make_nvp("n_elem", access::rw(n_elem));
   ar & make_nvp("vec_state", access::rw(vec_state));
 
+  // In mlpack binary model files, the elements of large matrices are stored as
+  // aligned blocks (see mlpack/core/data/block_serialization.hpp).
+  typedef mlpack::data::details::BlockSerializationContext BlockContext;
+  BlockContext* context = BlockContext::Current();
+  const bool block = (context != NULL) && (context->Archive() == &ar) &&
+      (n_elem * sizeof(eT) >= BlockContext::MinimumBlockSize);
+  if (block)
+  {
+    char padding[BlockContext::Alignment] = { 0 };
+    const size_t paddingSize = context->Padding();
+    ar & make_array(padding, paddingSize);
+  }
+
   // mem_state will always be 0 on load, so we don't need to save it.
   if (Archive::is_loading::value)
   {
@@ -34,6 +47,16 @@ void Mat<eT>::serialize(Archive& ar, const unsigned int /* version */)
       memory::release(access::rw(mem));
     }
 
+    // If the file is memory-mapped, use the elements in place; the matrix does
+    // not own them, so it allocates new memory if it is ever resized.
+    char* mapped = block ? context->Map(n_elem * sizeof(eT)) : NULL;
+    if (mapped != NULL)
+    {
+      access::rw(mem) = reinterpret_cast<eT*>(mapped);
+      access::rw(mem_state) = 1;
+      return;
+    }
+
     access::rw(mem_state) = 0;
 
     // We also need to allocate the memory we're using.
@@ -49,6 +49,9 @@
 #include <boost/serialization/nvp.hpp>
 #include <boost/serialization/array.hpp>
 
+// The hook that Mat::serialize() uses for mlpack binary model files.
+#include <mlpack/core/data/block_serialization.hpp>
+
 #include <armadillo>
 
 namespace arma {
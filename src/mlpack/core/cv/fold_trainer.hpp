@@ -0,0 +1,99 @@
+/**
+ * @file fold_trainer.hpp
+ *
+ * The policy that trains the models of the folds of a cross-validation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_FOLD_TRAINER_HPP
+#define MLPACK_CORE_CV_FOLD_TRAINER_HPP
+
+#include <mlpack/core.hpp>
+
+#include <exception>
+#include <memory>
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * FoldTrainer trains the model of every fold of a cross-validation (like
+ * KFoldCV) on the training set of the fold.  By default, each model is built
+ * independently with the constructor
+ *
+ * @code
+ * MLAlgorithm(trainingData, trainingResponses, args...)
+ * @endcode
+ *
+ * and the folds are trained in parallel if OpenMP is available.  Models whose
+ * training reduces to mergeable sufficient statistics can specialize this
+ * class, so that the statistics of each fold are computed once and then shared
+ * by the models of all the other folds; see LinearRegression and
+ * NaiveBayesClassifier.
+ *
+ * The cross-validation type must provide K(), the number of folds, and
+ * Fold(i, data, responses) and TrainingSet(i, data, responses), which make data
+ * and responses aliases of the points of fold i and of its training set, along
+ * with the typedefs DatasetType and ResponsesType.
+ *
+ * @tparam MLAlgorithm The model type.
+ */
+template<typename MLAlgorithm>
+class FoldTrainer
+{
+ public:
+  /**
+   * Train the model of every fold.
+   *
+   * @param cv The cross-validation to train the models of.
+   * @param models Vector of cv.K() models to fill.
+   * @param args Additional arguments of the constructor of MLAlgorithm.
+   */
+  template<typename CVType, typename... MLAlgorithmArgs>
+  static void Train(const CVType& cv,
+                    std::vector<std::unique_ptr<MLAlgorithm>>& models,
+                    const MLAlgorithmArgs&... args)
+  {
+    // Exceptions cannot leave the parallel region, so the first one is
+    // rethrown after it.
+    std::exception_ptr error;
+
+  #ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) cv.K(); ++i)
+  #else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < cv.K(); ++i)
+  #endif
+    {
+      try
+      {
+        typename CVType::DatasetType data;
+        typename CVType::ResponsesType responses;
+        cv.TrainingSet(i, data, responses);
+        models[i].reset(new MLAlgorithm(data, responses, args...));
+      }
+      catch (...)
+      {
+        #pragma omp critical
+        {
+          if (!error)
+            error = std::current_exception();
+        }
+      }
+    }
+
+    if (error)
+      std::rethrow_exception(error);
+  }
+};
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file hyper_parameter_tuner.hpp
+ *
+ * Grid search of the hyper-parameters of a model with k-fold cross-validation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_HYPER_PARAMETER_TUNER_HPP
+#define MLPACK_CORE_CV_HYPER_PARAMETER_TUNER_HPP
+
+#include <mlpack/core.hpp>
+
+#include <tuple>
+
+#include "k_fold_cv.hpp"
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * HyperParameterTuner finds the hyper-parameters of a model that give the best
+ * value of a metric under k-fold cross-validation, by evaluating every point of
+ * a grid of candidate values.  The points of the grid are evaluated in parallel
+ * if OpenMP is available, and all of them share the same folds, which are set
+ * up once.  Ties are broken in favor of the point that comes first, with the
+ * first hyper-parameter varying fastest, so the result does not depend on the
+ * number of threads.
+ *
+ * @code
+ * extern arma::mat data;
+ * extern arma::rowvec responses;
+ *
+ * HyperParameterTuner<LinearRegression, MSE, arma::mat, arma::rowvec>
+ *     tuner(5, data, responses);
+ * double lambda;
+ * bool intercept;
+ * std::tie(lambda, intercept) = tuner.Optimize(
+ *     std::vector<double>({ 0.0, 0.1, 1.0 }),
+ *     std::vector<bool>({ true, false }));
+ * LinearRegression& model = tuner.BestModel();
+ * @endcode
+ *
+ * @tparam MLAlgorithm The model type.
+ * @tparam Metric A metric like Accuracy or MSE; its NeedsMinimization member
+ *     decides whether the lowest or the highest value is the best.
+ * @tparam MatType The type of the dataset.
+ * @tparam PredictionsType The type of the responses.
+ */
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType = arma::mat,
+         typename PredictionsType = arma::Row<size_t>>
+class HyperParameterTuner
+{
+ public:
+  /**
+   * Prepare the search on the given dataset.  A std::invalid_argument is thrown
+   * under the same conditions as in the constructor of KFoldCV.
+   *
+   * @param k Number of folds of the cross-validation.
+   * @param xs Dataset, one point per column.
+   * @param ys Responses of the points.
+   * @param shuffle Whether to shuffle the points before splitting them into
+   *     folds.
+   */
+  HyperParameterTuner(const size_t k,
+                      const MatType& xs,
+                      const PredictionsType& ys,
+                      const bool shuffle = true);
+
+  /**
+   * Evaluate every combination of the given candidate values of the
+   * hyper-parameters (the arguments of the constructor of MLAlgorithm after the
+   * data and the responses, in order), and return the best one.  A model is
+   * then trained with it on the whole dataset; see BestModel().  A
+   * std::invalid_argument is thrown if a grid is empty.
+   *
+   * @param grids Candidate values of each hyper-parameter.
+   */
+  template<typename... Ts>
+  std::tuple<Ts...> Optimize(const std::vector<Ts>&... grids);
+
+  //! Get the value of the metric for the best hyper-parameters.
+  double BestObjective() const { return bestObjective; }
+
+  //! Get the model trained on the whole dataset with the best
+  //! hyper-parameters.  Only valid after Optimize() has been called.
+  MLAlgorithm& BestModel() { return *bestModel; }
+
+ private:
+  //! The cross-validation used to evaluate the points.
+  KFoldCV<MLAlgorithm, Metric, MatType, PredictionsType> cv;
+  //! The value of the metric for the best point.
+  double bestObjective;
+  //! The model trained with the best point.
+  std::unique_ptr<MLAlgorithm> bestModel;
+};
+
+} // namespace cv
+} // namespace mlpack
+
+// Include implementation.
+#include "hyper_parameter_tuner_impl.hpp"
+
+#endif
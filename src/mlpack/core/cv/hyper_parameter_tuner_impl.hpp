@@ -0,0 +1,182 @@
+/**
+ * @file hyper_parameter_tuner_impl.hpp
+ *
+ * The implementation of HyperParameterTuner.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_HYPER_PARAMETER_TUNER_IMPL_HPP
+#define MLPACK_CORE_CV_HYPER_PARAMETER_TUNER_IMPL_HPP
+
+namespace mlpack {
+namespace cv {
+
+namespace details {
+
+//! A compile-time sequence of indices, used to unpack a tuple of
+//! hyper-parameters into arguments (std::index_sequence requires C++14).
+template<size_t... I>
+struct IndexSequence { };
+
+//! Build IndexSequence<0, ..., N - 1>.
+template<size_t N, size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> { };
+
+template<size_t... I>
+struct MakeIndexSequence<0, I...>
+{
+  typedef IndexSequence<I...> Type;
+};
+
+//! Get the point of the grid with the given index of each hyper-parameter.
+template<size_t... I, typename... Ts>
+std::tuple<Ts...> MakePoint(const std::vector<size_t>& indices,
+                            IndexSequence<I...> /* sequence */,
+                            const std::vector<Ts>&... grids)
+{
+  return std::tuple<Ts...>(grids[indices[I]]...);
+}
+
+//! Evaluate the given point of the grid with the given cross-validation.
+template<typename CVType, size_t... I, typename... Ts>
+double EvaluatePoint(const CVType& cv,
+                     const std::tuple<Ts...>& point,
+                     IndexSequence<I...> /* sequence */)
+{
+  return cv.Evaluate(std::get<I>(point)...);
+}
+
+//! Train a model with the given point of the grid.
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         size_t... I,
+         typename... Ts>
+MLAlgorithm* TrainPoint(const MatType& data,
+                        const PredictionsType& responses,
+                        const std::tuple<Ts...>& point,
+                        IndexSequence<I...> /* sequence */)
+{
+  return new MLAlgorithm(data, responses, std::get<I>(point)...);
+}
+
+} // namespace details
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType>
+HyperParameterTuner<MLAlgorithm, Metric, MatType, PredictionsType>::
+HyperParameterTuner(const size_t k,
+                    const MatType& xs,
+                    const PredictionsType& ys,
+                    const bool shuffle) :
+    cv(k, xs, ys, shuffle),
+    bestObjective(0.0)
+{
+  // Nothing to do.
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType>
+template<typename... Ts>
+std::tuple<Ts...>
+HyperParameterTuner<MLAlgorithm, Metric, MatType, PredictionsType>::Optimize(
+    const std::vector<Ts>&... grids)
+{
+  typedef typename details::MakeIndexSequence<sizeof...(Ts)>::Type Sequence;
+
+  const std::vector<size_t> sizes = { grids.size()... };
+  size_t numPoints = 1;
+  for (size_t j = 0; j < sizes.size(); ++j)
+  {
+    if (sizes[j] == 0)
+      throw std::invalid_argument("HyperParameterTuner::Optimize(): the grid "
+          "of a hyper-parameter is empty");
+    numPoints *= sizes[j];
+  }
+
+  // Get the indices of each hyper-parameter for the given point of the grid;
+  // the first hyper-parameter varies fastest.
+  auto indicesOf = [&sizes](size_t point) -> std::vector<size_t>
+  {
+    std::vector<size_t> indices(sizes.size());
+    for (size_t j = 0; j < sizes.size(); ++j)
+    {
+      indices[j] = point % sizes[j];
+      point /= sizes[j];
+    }
+    return indices;
+  };
+
+  #ifdef HAS_OPENMP
+    const size_t numThreads = omp_get_max_threads();
+  #else
+    const size_t numThreads = 1;
+  #endif
+
+  // With fewer points than threads, the folds of each point are trained in
+  // parallel instead.
+  arma::vec objectives(numPoints);
+  std::exception_ptr error;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic) if(numPoints >= numThreads)
+  for (intmax_t p = 0; p < (intmax_t) numPoints; ++p)
+#else
+  #pragma omp parallel for schedule(dynamic) if(numPoints >= numThreads)
+  for (size_t p = 0; p < numPoints; ++p)
+#endif
+  {
+    try
+    {
+      const std::tuple<Ts...> point = details::MakePoint(indicesOf(p),
+          Sequence(), grids...);
+      objectives[p] = details::EvaluatePoint(cv, point, Sequence());
+    }
+    catch (...)
+    {
+      #pragma omp critical
+      {
+        if (!error)
+          error = std::current_exception();
+      }
+    }
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+
+  // Scan the objectives in order, so that ties go to the first point.
+  size_t best = 0;
+  for (size_t p = 1; p < numPoints; ++p)
+  {
+    if (Metric::NeedsMinimization ? (objectives[p] < objectives[best]) :
+        (objectives[p] > objectives[best]))
+      best = p;
+  }
+
+  bestObjective = objectives[best];
+  const std::tuple<Ts...> bestPoint = details::MakePoint(indicesOf(best),
+      Sequence(), grids...);
+
+  MatType data;
+  PredictionsType responses;
+  cv.Dataset(data, responses);
+  bestModel.reset(details::TrainPoint<MLAlgorithm>(data, responses, bestPoint,
+      Sequence()));
+
+  return bestPoint;
+}
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
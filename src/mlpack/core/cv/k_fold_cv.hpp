@@ -0,0 +1,139 @@
+/**
+ * @file k_fold_cv.hpp
+ *
+ * k-fold cross-validation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_K_FOLD_CV_HPP
+#define MLPACK_CORE_CV_K_FOLD_CV_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/data/split_data.hpp>
+
+#include "fold_trainer.hpp"
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * Evaluate a model with k-fold cross-validation: the dataset is split into k
+ * folds of (almost) equal size, and for each fold, a model is trained on the
+ * other k - 1 folds and evaluated with the given metric on the fold.  The
+ * result is the average of the k evaluations.
+ *
+ * The dataset is copied once, optionally shuffled, into a buffer that holds
+ * the points followed by the first k - 1 folds again, so that the training set
+ * of every fold is a contiguous range of columns.  The models are then given
+ * aliases of the buffer, and no fold is ever copied.  The folds are trained and
+ * evaluated in parallel if OpenMP is available, and FoldTrainer may be
+ * specialized to share computation between the folds.
+ *
+ * @code
+ * extern arma::mat data;
+ * extern arma::Row<size_t> labels;
+ *
+ * KFoldCV<NaiveBayesClassifier<>, Accuracy> cv(10, data, labels);
+ * const double accuracy = cv.Evaluate(numClasses);
+ * @endcode
+ *
+ * @tparam MLAlgorithm The model type.
+ * @tparam Metric A metric like Accuracy or MSE, with a static Evaluate(model,
+ *     data, responses) function.
+ * @tparam MatType The type of the dataset (a dense matrix).
+ * @tparam PredictionsType The type of the responses (a row vector of labels or
+ *     values, or a matrix of responses).
+ */
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType = arma::mat,
+         typename PredictionsType = arma::Row<size_t>>
+class KFoldCV
+{
+ public:
+  //! The type of the dataset.
+  typedef MatType DatasetType;
+  //! The type of the responses.
+  typedef PredictionsType ResponsesType;
+
+  /**
+   * Prepare k-fold cross-validation on the given dataset.  A
+   * std::invalid_argument is thrown if k is less than 2 or greater than the
+   * number of points, or if the number of responses does not match the number
+   * of points.
+   *
+   * @param k Number of folds.
+   * @param xs Dataset, one point per column.
+   * @param ys Responses of the points (one column per point).
+   * @param shuffle Whether to shuffle the points before splitting them into
+   *     folds.
+   */
+  KFoldCV(const size_t k,
+          const MatType& xs,
+          const PredictionsType& ys,
+          const bool shuffle = true);
+
+  /**
+   * Run the cross-validation: train a model for every fold with the given
+   * arguments (after the data and responses) of its constructor, and return
+   * the average value of the metric on the folds.
+   *
+   * @param args Additional arguments of the constructor of MLAlgorithm.
+   */
+  template<typename... MLAlgorithmArgs>
+  double Evaluate(const MLAlgorithmArgs&... args) const;
+
+  //! Get the number of folds.
+  size_t K() const { return k; }
+
+  /**
+   * Make the given matrices aliases of the points of fold i and of their
+   * responses.
+   */
+  void Fold(const size_t i, MatType& data, PredictionsType& responses) const;
+
+  /**
+   * Make the given matrices aliases of the training set of fold i (the points
+   * of all the other folds) and of its responses.
+   */
+  void TrainingSet(const size_t i,
+                   MatType& data,
+                   PredictionsType& responses) const;
+
+  /**
+   * Make the given matrices aliases of the whole (possibly shuffled) dataset
+   * and of its responses.
+   */
+  void Dataset(MatType& data, PredictionsType& responses) const;
+
+ private:
+  //! The number of folds.
+  size_t k;
+  //! The number of points.
+  size_t numPoints;
+  //! The points, followed by the first k - 1 folds again.
+  MatType xs;
+  //! The responses of the points in xs.
+  PredictionsType ys;
+
+  //! Get the index of the first point of fold i.
+  size_t FoldBegin(const size_t i) const { return i * numPoints / k; }
+
+  //! Make data and responses aliases of count points from the given column of
+  //! the buffer.
+  void Alias(const size_t begin,
+             const size_t count,
+             MatType& data,
+             PredictionsType& responses) const;
+};
+
+} // namespace cv
+} // namespace mlpack
+
+// Include implementation.
+#include "k_fold_cv_impl.hpp"
+
+#endif
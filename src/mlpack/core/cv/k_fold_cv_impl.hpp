@@ -0,0 +1,191 @@
+/**
+ * @file k_fold_cv_impl.hpp
+ *
+ * The implementation of k-fold cross-validation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_K_FOLD_CV_IMPL_HPP
+#define MLPACK_CORE_CV_K_FOLD_CV_IMPL_HPP
+
+namespace mlpack {
+namespace cv {
+
+namespace details {
+
+//! Make a row of responses an alias of count elements of another, from the
+//! given one.
+template<typename U>
+void AliasResponses(const arma::Row<U>& source,
+                    const size_t begin,
+                    const size_t count,
+                    arma::Row<U>& responses)
+{
+  data::details::MakeAlias(responses, const_cast<U*>(source.memptr()) + begin,
+      count);
+}
+
+//! Make a matrix of responses an alias of count columns of another, from the
+//! given one.
+template<typename T>
+void AliasResponses(const arma::Mat<T>& source,
+                    const size_t begin,
+                    const size_t count,
+                    arma::Mat<T>& responses)
+{
+  data::details::MakeAlias(responses, const_cast<T*>(source.colptr(begin)),
+      source.n_rows, count);
+}
+
+} // namespace details
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType>
+KFoldCV<MLAlgorithm, Metric, MatType, PredictionsType>::KFoldCV(
+    const size_t k,
+    const MatType& xs,
+    const PredictionsType& ys,
+    const bool shuffle) :
+    k(k),
+    numPoints(xs.n_cols)
+{
+  if (k < 2)
+    throw std::invalid_argument("KFoldCV: k should be at least 2");
+
+  if (k > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "KFoldCV: k (" << k << ") is greater than the number of points ("
+        << numPoints << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (ys.n_cols != numPoints)
+  {
+    std::ostringstream oss;
+    oss << "KFoldCV: the number of responses (" << ys.n_cols << ") does not "
+        << "match the number of points (" << numPoints << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The training set of fold i is folds i + 1, ..., k - 1, 0, ..., i - 1, so
+  // repeating the first k - 1 folds after the points makes it contiguous.
+  arma::uvec order = arma::linspace<arma::uvec>(0, numPoints - 1, numPoints);
+  if (shuffle)
+    order = arma::shuffle(order);
+
+  const size_t extra = FoldBegin(k - 1);
+  const arma::uvec columns = arma::join_cols(order, order.head(extra));
+  this->xs = xs.cols(columns);
+  this->ys = ys.cols(columns);
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType>
+template<typename... MLAlgorithmArgs>
+double KFoldCV<MLAlgorithm, Metric, MatType, PredictionsType>::Evaluate(
+    const MLAlgorithmArgs&... args) const
+{
+  std::vector<std::unique_ptr<MLAlgorithm>> models(k);
+  FoldTrainer<MLAlgorithm>::Train(*this, models, args...);
+
+  arma::vec evaluations(k);
+  std::exception_ptr error;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t i = 0; i < (intmax_t) k; ++i)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < k; ++i)
+#endif
+  {
+    try
+    {
+      MatType data;
+      PredictionsType responses;
+      Fold(i, data, responses);
+      evaluations[i] = Metric::Evaluate(*models[i], data, responses);
+    }
+    catch (...)
+    {
+      #pragma omp critical
+      {
+        if (!error)
+          error = std::current_exception();
+      }
+    }
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+
+  return arma::mean(evaluations);
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType>
+void KFoldCV<MLAlgorithm, Metric, MatType, PredictionsType>::Fold(
+    const size_t i,
+    MatType& data,
+    PredictionsType& responses) const
+{
+  const size_t begin = FoldBegin(i);
+  Alias(begin, FoldBegin(i + 1) - begin, data, responses);
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType>
+void KFoldCV<MLAlgorithm, Metric, MatType, PredictionsType>::TrainingSet(
+    const size_t i,
+    MatType& data,
+    PredictionsType& responses) const
+{
+  const size_t begin = FoldBegin(i + 1);
+  Alias(begin, FoldBegin(i) + numPoints - begin, data, responses);
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType>
+void KFoldCV<MLAlgorithm, Metric, MatType, PredictionsType>::Dataset(
+    MatType& data,
+    PredictionsType& responses) const
+{
+  Alias(0, numPoints, data, responses);
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType>
+void KFoldCV<MLAlgorithm, Metric, MatType, PredictionsType>::Alias(
+    const size_t begin,
+    const size_t count,
+    MatType& data,
+    PredictionsType& responses) const
+{
+  data::details::MakeAlias(data,
+      const_cast<typename MatType::elem_type*>(xs.colptr(begin)), xs.n_rows,
+      count);
+  details::AliasResponses(ys, begin, count, responses);
+}
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
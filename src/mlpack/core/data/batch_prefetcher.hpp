@@ -0,0 +1,152 @@
+/**
+ * @file batch_prefetcher.hpp
+ *
+ * Definition of BatchPrefetcher, which reads mini-batches from a batch source
+ * in a background thread.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_PREFETCHER_HPP
+#define MLPACK_CORE_DATA_BATCH_PREFETCHER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+#include "batch_source.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * BatchPrefetcher reads the mini-batches of one pass over a dataset (an epoch)
+ * from a batch source (see batch_source.hpp) in a background thread, while the
+ * caller trains on the previous mini-batches.  The background thread loads one
+ * shard at a time, splits it into mini-batches and keeps up to bufferSize of
+ * them ready, so with the default of two the next mini-batch is read while the
+ * current one is used (double buffering), and the optimizer only waits when
+ * reading a mini-batch takes longer than training on one.
+ *
+ * If shuffling is enabled, the order of the shards and the order of the points
+ * inside each shard are shuffled at each epoch.  The random numbers are drawn
+ * from mlpack::math::RandGen() when the epoch starts, so the batches are
+ * reproducible after mlpack::math::RandomSeed().
+ *
+ * The last mini-batch of each shard may be smaller than the batch size.
+ * Exceptions thrown by the batch source are rethrown by Next().
+ *
+ * @code
+ * data::MappedBatchSource<double> source("predictors.mlbin",
+ *     "responses.mlbin");
+ * data::BatchPrefetcher<data::MappedBatchSource<double>> batches(source, 32);
+ *
+ * batches.Reset();
+ * arma::mat predictors, responses;
+ * while (batches.Next(predictors, responses))
+ * {
+ *   // Train on the mini-batch.
+ * }
+ * @endcode
+ *
+ * @tparam SourceType Type of the batch source.
+ * @tparam MatType Type of the data matrices.
+ */
+template<typename SourceType, typename MatType = arma::mat>
+class BatchPrefetcher
+{
+ public:
+  /**
+   * Create the prefetcher for the given batch source; no data is read until
+   * Reset() is called.  The source must outlive the prefetcher.
+   *
+   * @param source Source of the shards.
+   * @param batchSize Number of points in each mini-batch.
+   * @param shuffle Whether to shuffle the shards and the points at each epoch.
+   * @param bufferSize Number of mini-batches to read ahead.
+   */
+  BatchPrefetcher(SourceType& source,
+                  const size_t batchSize,
+                  const bool shuffle = true,
+                  const size_t bufferSize = 2);
+
+  //! Stop the background thread.
+  ~BatchPrefetcher();
+
+  //! Prefetchers cannot be copied.
+  BatchPrefetcher(const BatchPrefetcher&) = delete;
+  //! Prefetchers cannot be copied.
+  BatchPrefetcher& operator=(const BatchPrefetcher&) = delete;
+
+  /**
+   * Start a new epoch: stop reading the current epoch (if any), and start
+   * reading the mini-batches of the next one in the background thread.
+   */
+  void Reset();
+
+  /**
+   * Get the next mini-batch of the epoch, waiting for the background thread if
+   * it isn't ready.  Return false (leaving the matrices untouched) when the
+   * epoch is over.
+   *
+   * @param predictors Matrix to store the predictors of the mini-batch in.
+   * @param responses Matrix to store the responses of the mini-batch in.
+   * @return Whether a mini-batch was returned.
+   */
+  bool Next(MatType& predictors, MatType& responses);
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Get whether the data is shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Get the number of mini-batches that are read ahead.
+  size_t BufferSize() const { return bufferSize; }
+
+ private:
+  //! Read the mini-batches of the given shards (the background thread).
+  void Produce(const std::vector<size_t> shardOrder, const uint64_t seed);
+
+  //! Stop the background thread and drop the read mini-batches.
+  void Stop();
+
+  //! The source of the shards.
+  SourceType& source;
+  //! The number of points in each mini-batch.
+  size_t batchSize;
+  //! Whether to shuffle the shards and the points.
+  bool shuffle;
+  //! The number of mini-batches to read ahead.
+  size_t bufferSize;
+
+  //! The background thread.
+  std::thread thread;
+  //! Protects all the members below.
+  std::mutex mutex;
+  //! Signaled when a mini-batch is added, or when the epoch is over.
+  std::condition_variable batchReady;
+  //! Signaled when a mini-batch is taken, or when the thread must stop.
+  std::condition_variable slotFree;
+  //! The mini-batches that were read (predictors and responses).
+  std::deque<std::pair<MatType, MatType>> batches;
+  //! Whether the background thread has read the whole epoch.
+  bool done;
+  //! Whether the background thread must stop.
+  bool stop;
+  //! The exception thrown in the background thread, if any.
+  std::exception_ptr error;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "batch_prefetcher_impl.hpp"
+
+#endif
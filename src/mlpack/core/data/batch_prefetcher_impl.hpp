@@ -0,0 +1,187 @@
+/**
+ * @file batch_prefetcher_impl.hpp
+ *
+ * Implementation of BatchPrefetcher.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_PREFETCHER_IMPL_HPP
+#define MLPACK_CORE_DATA_BATCH_PREFETCHER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "batch_prefetcher.hpp"
+
+namespace mlpack {
+namespace data {
+
+template<typename SourceType, typename MatType>
+BatchPrefetcher<SourceType, MatType>::BatchPrefetcher(
+    SourceType& source,
+    const size_t batchSize,
+    const bool shuffle,
+    const size_t bufferSize) :
+    source(source),
+    batchSize(batchSize),
+    shuffle(shuffle),
+    bufferSize(bufferSize),
+    done(true),
+    stop(false)
+{
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("BatchPrefetcher: the batch size must be "
+        "positive");
+  }
+
+  if (bufferSize == 0)
+  {
+    throw std::invalid_argument("BatchPrefetcher: the buffer size must be "
+        "positive");
+  }
+}
+
+template<typename SourceType, typename MatType>
+BatchPrefetcher<SourceType, MatType>::~BatchPrefetcher()
+{
+  Stop();
+}
+
+template<typename SourceType, typename MatType>
+void BatchPrefetcher<SourceType, MatType>::Reset()
+{
+  Stop();
+
+  // Draw the random numbers of the epoch here, so that they come from the
+  // generator of the calling thread.
+  std::vector<size_t> shardOrder(source.NumShards());
+  for (size_t i = 0; i < shardOrder.size(); ++i)
+    shardOrder[i] = i;
+
+  uint64_t seed = 0;
+  if (shuffle)
+  {
+    std::shuffle(shardOrder.begin(), shardOrder.end(), math::RandGen());
+    seed = math::RandGen()();
+  }
+
+  done = false;
+  stop = false;
+  error = nullptr;
+  thread = std::thread(&BatchPrefetcher::Produce, this, std::move(shardOrder),
+      seed);
+}
+
+template<typename SourceType, typename MatType>
+bool BatchPrefetcher<SourceType, MatType>::Next(MatType& predictors,
+                                                MatType& responses)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  batchReady.wait(lock, [this] { return !batches.empty() || done; });
+
+  if (batches.empty())
+  {
+    if (error)
+    {
+      std::exception_ptr e = error;
+      error = nullptr;
+      std::rethrow_exception(e);
+    }
+
+    return false;
+  }
+
+  predictors = std::move(batches.front().first);
+  responses = std::move(batches.front().second);
+  batches.pop_front();
+  lock.unlock();
+
+  slotFree.notify_one();
+  return true;
+}
+
+template<typename SourceType, typename MatType>
+void BatchPrefetcher<SourceType, MatType>::Produce(
+    const std::vector<size_t> shardOrder, const uint64_t seed)
+{
+  math::Xoshiro256 generator(seed);
+
+  try
+  {
+    MatType shardPredictors, shardResponses;
+    for (size_t s = 0; s < shardOrder.size(); ++s)
+    {
+      source.LoadShard(shardOrder[s], shardPredictors, shardResponses);
+      if (shardPredictors.n_cols != shardResponses.n_cols)
+      {
+        throw std::runtime_error("BatchPrefetcher: the predictors and "
+            "responses of a shard have different numbers of points");
+      }
+
+      if (shuffle)
+      {
+        arma::uvec order(shardPredictors.n_cols);
+        for (size_t i = 0; i < order.n_elem; ++i)
+          order[i] = i;
+        std::shuffle(order.begin(), order.end(), generator);
+
+        shardPredictors = shardPredictors.cols(order);
+        shardResponses = shardResponses.cols(order);
+      }
+
+      for (size_t begin = 0; begin < shardPredictors.n_cols;
+          begin += batchSize)
+      {
+        const size_t end = std::min(begin + batchSize,
+            (size_t) shardPredictors.n_cols) - 1;
+        MatType batchPredictors = shardPredictors.cols(begin, end);
+        MatType batchResponses = shardResponses.cols(begin, end);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        slotFree.wait(lock, [this] {
+            return batches.size() < bufferSize || stop; });
+        if (stop)
+          return;
+
+        batches.emplace_back(std::move(batchPredictors),
+            std::move(batchResponses));
+        lock.unlock();
+        batchReady.notify_one();
+      }
+    }
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    error = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  batchReady.notify_one();
+}
+
+template<typename SourceType, typename MatType>
+void BatchPrefetcher<SourceType, MatType>::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  slotFree.notify_one();
+
+  if (thread.joinable())
+    thread.join();
+
+  batches.clear();
+  done = true;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * @file batch_source.hpp
+ *
+ * Sources of training data for data::BatchPrefetcher.  A batch source splits a
+ * dataset into shards (contiguous blocks of points) that can be loaded one at a
+ * time, so that the whole dataset never has to be held in memory.
+ *
+ * Every batch source must implement the following functions:
+ *
+ *   // Return the number of shards.
+ *   size_t NumShards() const;
+ *
+ *   // Load the predictors and responses of the given shard (one point per
+ *   // column), and throw a std::runtime_error on failure.
+ *   void LoadShard(const size_t shard, MatType& predictors,
+ *                  MatType& responses);
+ *
+ * LoadShard() is called from the background thread of the prefetcher, one
+ * call at a time.  A source of unlabeled data (for instance for
+ * svd::RandomizedSVD) returns responses with zero rows.  HDF5 datasets are
+ * read one hyperslab at a time by HDF5BatchSource (see hdf5_chunked.hpp).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_SOURCE_HPP
+#define MLPACK_CORE_DATA_BATCH_SOURCE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "load.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A batch source over predictors and responses that are already available as
+ * matrices, for instance matrices backed by a MappedMatrix.  The shards are
+ * blocks of shardSize consecutive points, which are copied out of the matrices
+ * when they are loaded; for a memory-mapped matrix, the pages of the shard are
+ * read from disk at that time, in the prefetcher's background thread.  The
+ * matrices must outlive the batch source.
+ *
+ * @tparam MatType Type of the data matrices.
+ */
+template<typename MatType = arma::mat>
+class MatrixBatchSource
+{
+ public:
+  /**
+   * Create the batch source over the given predictors and responses, which
+   * must have the same number of columns.
+   *
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param shardSize Number of points in each shard.
+   */
+  MatrixBatchSource(const MatType& predictors,
+                    const MatType& responses,
+                    const size_t shardSize = 65536) :
+      predictors(predictors),
+      responses(responses),
+      shardSize(shardSize)
+  {
+    if (predictors.n_cols != responses.n_cols)
+    {
+      throw std::invalid_argument("MatrixBatchSource: the predictors and "
+          "responses must have the same number of points");
+    }
+
+    if (shardSize == 0)
+    {
+      throw std::invalid_argument("MatrixBatchSource: the shard size must be "
+          "positive");
+    }
+  }
+
+  //! Return the number of shards.
+  size_t NumShards() const
+  {
+    return (predictors.n_cols + shardSize - 1) / shardSize;
+  }
+
+  //! Copy the points of the given shard.
+  void LoadShard(const size_t shard, MatType& shardPredictors,
+                 MatType& shardResponses)
+  {
+    const size_t begin = shard * shardSize;
+    const size_t end = std::min(begin + shardSize, (size_t) predictors.n_cols);
+    shardPredictors = predictors.cols(begin, end - 1);
+    shardResponses = responses.cols(begin, end - 1);
+  }
+
+  //! Get the number of points in each shard.
+  size_t ShardSize() const { return shardSize; }
+
+ private:
+  //! The predictors.
+  const MatType& predictors;
+  //! The responses.
+  const MatType& responses;
+  //! The number of points in each shard.
+  size_t shardSize;
+};
+
+/**
+ * A batch source that memory-maps a predictors file and a responses file in
+ * mlpack's binary format (.mlbin; see MappedMatrix), and copies the shards out
+ * of the mappings, so only the pages of the shards that are loaded are read
+ * from disk.  The files are stored with one point per column, as they are
+ * written by data::Save().
+ *
+ * @tparam eT Element type of the files (and of the loaded matrices).
+ */
+template<typename eT = double>
+class MappedBatchSource
+{
+ public:
+  /**
+   * Map the given predictors file, for unlabeled data; the shards have
+   * responses with zero rows.  A std::runtime_error is thrown if the file
+   * can't be mapped.
+   *
+   * @param predictorsFile .mlbin file holding the predictors.
+   * @param shardSize Number of points in each shard.
+   */
+  MappedBatchSource(const std::string& predictorsFile,
+                    const size_t shardSize = 65536)
+  {
+    predictors.Map(predictorsFile);
+    noResponses.set_size(0, predictors.Matrix().n_cols);
+    source.reset(new MatrixBatchSource<arma::Mat<eT>>(predictors.Matrix(),
+        noResponses, shardSize));
+  }
+
+  /**
+   * Map the given predictors and responses files.  A std::runtime_error is
+   * thrown if a file can't be mapped, and a std::invalid_argument if the files
+   * hold different numbers of points.
+   *
+   * @param predictorsFile .mlbin file holding the predictors.
+   * @param responsesFile .mlbin file holding the responses.
+   * @param shardSize Number of points in each shard.
+   */
+  MappedBatchSource(const std::string& predictorsFile,
+                    const std::string& responsesFile,
+                    const size_t shardSize = 65536)
+  {
+    predictors.Map(predictorsFile);
+    responses.Map(responsesFile);
+    source.reset(new MatrixBatchSource<arma::Mat<eT>>(predictors.Matrix(),
+        responses.Matrix(), shardSize));
+  }
+
+  //! Return the number of shards.
+  size_t NumShards() const { return source->NumShards(); }
+
+  //! Copy the points of the given shard out of the mappings.
+  void LoadShard(const size_t shard, arma::Mat<eT>& shardPredictors,
+                 arma::Mat<eT>& shardResponses)
+  {
+    source->LoadShard(shard, shardPredictors, shardResponses);
+  }
+
+  //! Get the mapped predictors.
+  const arma::Mat<eT>& Predictors() const { return predictors.Matrix(); }
+  //! Get the mapped responses (with zero rows if there are none).
+  const arma::Mat<eT>& Responses() const
+  {
+    return responses.IsMapped() ? responses.Matrix() : noResponses;
+  }
+
+ private:
+  //! The mapped predictors.
+  MappedMatrix<eT> predictors;
+  //! The mapped responses.
+  MappedMatrix<eT> responses;
+  //! The responses with zero rows, if there is no responses file.
+  arma::Mat<eT> noResponses;
+  //! The source over the mapped matrices.
+  std::unique_ptr<MatrixBatchSource<arma::Mat<eT>>> source;
+};
+
+/**
+ * A batch source over a set of CSV (or any other format data::Load() reads)
+ * files, each of which is one shard.  Every file holds one point per line; the
+ * last responseRows values of each line are the responses, and the other
+ * values are the predictors (if responseRows is 0, the shards have responses
+ * with zero rows).  Only one shard is held in memory at a time.
+ *
+ * @tparam MatType Type of the loaded matrices.
+ */
+template<typename MatType = arma::mat>
+class CSVShardBatchSource
+{
+ public:
+  /**
+   * Create the batch source over the given files.
+   *
+   * @param files Names of the shard files.
+   * @param responseRows Number of response values at the end of each line.
+   */
+  CSVShardBatchSource(const std::vector<std::string>& files,
+                      const size_t responseRows = 1) :
+      files(files),
+      responseRows(responseRows)
+  { /* Nothing to do. */ }
+
+  //! Return the number of shards.
+  size_t NumShards() const { return files.size(); }
+
+  //! Load the given shard file.
+  void LoadShard(const size_t shard, MatType& shardPredictors,
+                 MatType& shardResponses)
+  {
+    MatType shardData;
+    if (!Load(files[shard], shardData, false, true))
+    {
+      throw std::runtime_error("CSVShardBatchSource: cannot load '" +
+          files[shard] + "'");
+    }
+
+    if (shardData.n_rows <= responseRows)
+    {
+      throw std::runtime_error("CSVShardBatchSource: '" + files[shard] +
+          "' has no predictor values");
+    }
+
+    const size_t predictorRows = shardData.n_rows - responseRows;
+    if (responseRows == 0)
+    {
+      shardResponses.set_size(0, shardData.n_cols);
+      shardPredictors = std::move(shardData);
+      return;
+    }
+
+    shardPredictors = shardData.rows(0, predictorRows - 1);
+    shardResponses = shardData.rows(predictorRows, shardData.n_rows - 1);
+  }
+
+  //! Get the shard files.
+  const std::vector<std::string>& Files() const { return files; }
+
+ private:
+  //! The shard files.
+  std::vector<std::string> files;
+  //! The number of response values at the end of each line.
+  size_t responseRows;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 #define MLPACK_CORE_DATA_BINARIZE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/execution.hpp>
 
 namespace mlpack {
 namespace data {
@@ -44,13 +45,13 @@ void Binarize(const arma::Mat<T>& input,
 {
   output.copy_size(input);
 
-  const int totalElems = static_cast<int>(input.n_elem);
   const T *inPtr = input.memptr();
   T *outPtr = output.memptr();
 
-  #pragma omp parallel for
-  for (int i = 0; i < totalElems; ++i)
+  util::Execution::ParallelFor(input.n_elem, [&](const size_t i)
+  {
     outPtr[i] = inPtr[i] > threshold;
+  }, 4096);
 }
 
 /**
@@ -81,11 +82,11 @@ void Binarize(const arma::Mat<T>& input,
               const size_t dimension)
 {
   output = input;
-  const int totalCols = static_cast<int>(input.n_cols);
 
-  #pragma omp parallel for
-  for (int i = 0; i < totalCols; ++i)
+  util::Execution::ParallelFor(input.n_cols, [&](const size_t i)
+  {
     output(dimension, i) = input(dimension, i) > threshold;
+  }, 4096);
 }
 
 } // namespace data
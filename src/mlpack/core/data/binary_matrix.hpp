@@ -0,0 +1,170 @@
+/**
+ * @file binary_matrix.hpp
+ *
+ * Support for mlpack's native binary matrix format (.mlbin).  A file in this
+ * format holds a fixed-size header (giving the number of rows and columns and
+ * the element type), the serialized DatasetMapper of the matrix, and then the
+ * raw elements of the matrix in column-major order, starting at an aligned
+ * offset.  Because the elements are stored exactly as Armadillo holds them in
+ * memory, a file can be memory-mapped read-only and used directly as an
+ * arma::Mat without any copy; see MappedMatrix.
+ *
+ * Elements are stored in the byte order of the host that wrote the file.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BINARY_MATRIX_HPP
+#define MLPACK_CORE_DATA_BINARY_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "dataset_mapper.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The header at the start of every .mlbin file.  The serialized DatasetMapper
+ * (infoSize bytes) follows right after the header, and the matrix elements
+ * start at dataOffset, which is a multiple of 64 bytes.
+ */
+struct BinaryMatrixHeader
+{
+  //! Magic string identifying the format.
+  char magic[8];
+  //! Version of the format.
+  uint32_t version;
+  //! Kind of the element type: 'i' (signed), 'u' (unsigned) or 'f' (float).
+  uint8_t elemKind;
+  //! Size of each element, in bytes.
+  uint8_t elemSize;
+  //! Unused; always zero.
+  uint16_t reserved;
+  //! Number of rows of the matrix.
+  uint64_t rows;
+  //! Number of columns of the matrix.
+  uint64_t cols;
+  //! Size of the serialized DatasetMapper, in bytes (0 if none was stored).
+  uint64_t infoSize;
+  //! Offset of the first matrix element from the start of the file.
+  uint64_t dataOffset;
+};
+
+/**
+ * Save the given matrix (and, optionally, its DatasetMapper) to the given
+ * stream in the .mlbin format.  The matrix is stored as it is held in memory;
+ * it is not transposed.  A std::runtime_error is thrown on failure.
+ *
+ * @param stream Stream to write to.
+ * @param matrix Matrix to save.
+ * @param info DatasetMapper to save (may be NULL).
+ */
+template<typename eT, typename PolicyType>
+void SaveBinaryMatrix(std::ostream& stream,
+                      const arma::Mat<eT>& matrix,
+                      const DatasetMapper<PolicyType>* info);
+
+//! Save the given matrix to the given stream in the .mlbin format, without a
+//! DatasetMapper.
+template<typename eT>
+void SaveBinaryMatrix(std::ostream& stream, const arma::Mat<eT>& matrix);
+
+/**
+ * Load a matrix (and, optionally, its DatasetMapper) from the given stream in
+ * the .mlbin format into memory owned by the given matrix.  If the element type
+ * of the file is different than eT, the elements are converted.  If the file
+ * holds no DatasetMapper and info is not NULL, info is set to a DatasetMapper
+ * with all dimensions numeric.  A std::runtime_error is thrown on failure.
+ *
+ * @param stream Stream to read from.
+ * @param matrix Matrix to load into.
+ * @param info DatasetMapper to load into (may be NULL).
+ */
+template<typename eT, typename PolicyType>
+void LoadBinaryMatrix(std::istream& stream,
+                      arma::Mat<eT>& matrix,
+                      DatasetMapper<PolicyType>* info);
+
+//! Load a matrix from the given stream in the .mlbin format, ignoring any
+//! stored DatasetMapper.
+template<typename eT>
+void LoadBinaryMatrix(std::istream& stream, arma::Mat<eT>& matrix);
+
+/**
+ * A read-only matrix backed by a memory-mapped .mlbin file.  The matrix returned
+ * by Matrix() points directly at the mapped file, so no elements are copied
+ * when the file is loaded, the operating system only reads the pages that are
+ * actually used, and several processes that map the same file share the same
+ * physical memory.  The matrix must not be modified, and it is only valid as
+ * long as the MappedMatrix object exists.
+ *
+ * Use data::Load() to map a file:
+ *
+ * @code
+ * data::MappedMatrix<double> mapped;
+ * data::Load("dataset.mlbin", mapped, true);
+ * const arma::mat& dataset = mapped.Matrix();
+ * @endcode
+ *
+ * On systems without mmap() (i.e. Windows) the file is read into memory
+ * instead.
+ *
+ * @tparam eT Element type; this must be the element type stored in the file.
+ */
+template<typename eT>
+class MappedMatrix
+{
+ public:
+  //! Create an empty MappedMatrix.
+  MappedMatrix();
+
+  //! Release the mapping.
+  ~MappedMatrix();
+
+  //! Mappings cannot be copied.
+  MappedMatrix(const MappedMatrix&) = delete;
+  //! Mappings cannot be copied.
+  MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+  /**
+   * Map the given .mlbin file, releasing any previous mapping.  A
+   * std::runtime_error is thrown on failure.
+   *
+   * @param filename Name of the file to map.
+   */
+  void Map(const std::string& filename);
+
+  //! Release the mapping (if any); the matrix becomes empty.
+  void Unmap();
+
+  //! Get the mapped matrix.
+  const arma::Mat<eT>& Matrix() const { return *matrix; }
+
+  //! Get the DatasetMapper stored with the matrix.
+  const DatasetInfo& Info() const { return info; }
+
+  //! Return whether or not the matrix is memory-mapped (false if it was read
+  //! into memory, or if nothing is loaded).
+  bool IsMapped() const { return mapping != NULL; }
+
+ private:
+  //! The matrix (either an alias of the mapping or owning its memory).
+  arma::Mat<eT>* matrix;
+  //! Dataset information stored with the matrix.
+  DatasetInfo info;
+  //! Start of the mapping, or NULL if no file is mapped.
+  void* mapping;
+  //! Length of the mapping, in bytes.
+  size_t mappingSize;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "binary_matrix_impl.hpp"
+
+#endif
@@ -0,0 +1,321 @@
+/**
+ * @file binary_matrix_impl.hpp
+ *
+ * Implementation of the .mlbin matrix format and of MappedMatrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BINARY_MATRIX_IMPL_HPP
+#define MLPACK_CORE_DATA_BINARY_MATRIX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "binary_matrix.hpp"
+
+#include <cstring>
+#include <sstream>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "serialization_shim.hpp"
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace mlpack {
+namespace data {
+
+namespace details {
+
+//! Magic string at the start of every .mlbin file.
+static const char binaryMatrixMagic[8] = { 'M', 'L', 'P', 'A', 'C', 'K',
+    'B', 'M' };
+
+//! Current version of the .mlbin format.
+static const uint32_t binaryMatrixVersion = 1;
+
+//! Get the kind of the given element type ('i', 'u' or 'f').
+template<typename eT>
+inline uint8_t BinaryElementKind()
+{
+  if (std::is_floating_point<eT>::value)
+    return 'f';
+  else if (std::is_signed<eT>::value)
+    return 'i';
+  else
+    return 'u';
+}
+
+//! Throw an exception if the given header is not a valid .mlbin header.
+inline void CheckBinaryMatrixHeader(const BinaryMatrixHeader& header)
+{
+  if (std::memcmp(header.magic, binaryMatrixMagic, 8) != 0)
+    throw std::runtime_error("not an mlpack binary matrix file");
+
+  if (header.version != binaryMatrixVersion)
+  {
+    std::ostringstream oss;
+    oss << "unsupported mlpack binary matrix version " << header.version;
+    throw std::runtime_error(oss.str());
+  }
+}
+
+//! Deserialize a DatasetMapper from the given buffer, or, if the buffer is
+//! empty, create an all-numeric DatasetMapper with the given dimensionality.
+template<typename PolicyType>
+void LoadBinaryMatrixInfo(const std::string& buffer,
+                          const size_t dimensionality,
+                          DatasetMapper<PolicyType>& info)
+{
+  if (buffer.empty())
+  {
+    info = DatasetMapper<PolicyType>(dimensionality);
+    return;
+  }
+
+  std::istringstream iss(buffer);
+  boost::archive::binary_iarchive ar(iss);
+  ar >> CreateNVP(info, "info");
+}
+
+//! Read the elements of a matrix that are stored with type FileType, and
+//! convert them to eT.
+template<typename FileType, typename eT>
+void ReadConvertedMatrix(std::istream& stream,
+                         const BinaryMatrixHeader& header,
+                         arma::Mat<eT>& matrix)
+{
+  arma::Mat<FileType> fileMatrix(header.rows, header.cols);
+  stream.read(reinterpret_cast<char*>(fileMatrix.memptr()),
+      fileMatrix.n_elem * sizeof(FileType));
+  if (!stream)
+    throw std::runtime_error("unexpected end of mlpack binary matrix file");
+
+  matrix = arma::conv_to<arma::Mat<eT>>::from(fileMatrix);
+}
+
+} // namespace details
+
+template<typename eT, typename PolicyType>
+void SaveBinaryMatrix(std::ostream& stream,
+                      const arma::Mat<eT>& matrix,
+                      const DatasetMapper<PolicyType>* info)
+{
+  std::string infoBuffer;
+  if (info)
+  {
+    std::ostringstream oss;
+    {
+      boost::archive::binary_oarchive ar(oss);
+      ar << CreateNVP(const_cast<DatasetMapper<PolicyType>&>(*info), "info");
+    }
+    infoBuffer = oss.str();
+  }
+
+  BinaryMatrixHeader header;
+  std::memcpy(header.magic, details::binaryMatrixMagic, 8);
+  header.version = details::binaryMatrixVersion;
+  header.elemKind = details::BinaryElementKind<eT>();
+  header.elemSize = sizeof(eT);
+  header.reserved = 0;
+  header.rows = matrix.n_rows;
+  header.cols = matrix.n_cols;
+  header.infoSize = infoBuffer.size();
+
+  // Align the elements to 64 bytes, so that a mapped matrix is as well-aligned
+  // as one allocated by Armadillo.
+  const uint64_t infoEnd = sizeof(BinaryMatrixHeader) + header.infoSize;
+  header.dataOffset = ((infoEnd + 63) / 64) * 64;
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.write(infoBuffer.data(), infoBuffer.size());
+  const std::string padding(header.dataOffset - infoEnd, '\0');
+  stream.write(padding.data(), padding.size());
+  stream.write(reinterpret_cast<const char*>(matrix.memptr()),
+      matrix.n_elem * sizeof(eT));
+
+  if (!stream)
+    throw std::runtime_error("error writing mlpack binary matrix");
+}
+
+template<typename eT>
+void SaveBinaryMatrix(std::ostream& stream, const arma::Mat<eT>& matrix)
+{
+  SaveBinaryMatrix(stream, matrix, (const DatasetInfo*) NULL);
+}
+
+template<typename eT, typename PolicyType>
+void LoadBinaryMatrix(std::istream& stream,
+                      arma::Mat<eT>& matrix,
+                      DatasetMapper<PolicyType>* info)
+{
+  const std::streampos start = stream.tellg();
+
+  BinaryMatrixHeader header;
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!stream)
+    throw std::runtime_error("unexpected end of mlpack binary matrix file");
+  details::CheckBinaryMatrixHeader(header);
+
+  if (info)
+  {
+    std::string infoBuffer(header.infoSize, '\0');
+    stream.read(&infoBuffer[0], header.infoSize);
+    if (!stream)
+      throw std::runtime_error("unexpected end of mlpack binary matrix file");
+
+    details::LoadBinaryMatrixInfo(infoBuffer, header.rows, *info);
+  }
+
+  stream.seekg(start + std::streamoff(header.dataOffset));
+
+  if (header.elemKind == details::BinaryElementKind<eT>() &&
+      header.elemSize == sizeof(eT))
+  {
+    // No conversion is necessary.
+    matrix.set_size(header.rows, header.cols);
+    stream.read(reinterpret_cast<char*>(matrix.memptr()),
+        matrix.n_elem * sizeof(eT));
+    if (!stream)
+      throw std::runtime_error("unexpected end of mlpack binary matrix file");
+  }
+  else if (header.elemKind == 'f' && header.elemSize == 4)
+    details::ReadConvertedMatrix<float>(stream, header, matrix);
+  else if (header.elemKind == 'f' && header.elemSize == 8)
+    details::ReadConvertedMatrix<double>(stream, header, matrix);
+  else if (header.elemKind == 'i' && header.elemSize == 4)
+    details::ReadConvertedMatrix<arma::s32>(stream, header, matrix);
+  else if (header.elemKind == 'i' && header.elemSize == 8)
+    details::ReadConvertedMatrix<arma::s64>(stream, header, matrix);
+  else if (header.elemKind == 'u' && header.elemSize == 4)
+    details::ReadConvertedMatrix<arma::u32>(stream, header, matrix);
+  else if (header.elemKind == 'u' && header.elemSize == 8)
+    details::ReadConvertedMatrix<arma::u64>(stream, header, matrix);
+  else
+    throw std::runtime_error("unknown element type in mlpack binary matrix "
+        "file");
+}
+
+template<typename eT>
+void LoadBinaryMatrix(std::istream& stream, arma::Mat<eT>& matrix)
+{
+  LoadBinaryMatrix(stream, matrix, (DatasetInfo*) NULL);
+}
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix() :
+    matrix(new arma::Mat<eT>()),
+    mapping(NULL),
+    mappingSize(0)
+{
+  // Nothing to do.
+}
+
+template<typename eT>
+MappedMatrix<eT>::~MappedMatrix()
+{
+  Unmap();
+  delete matrix;
+}
+
+template<typename eT>
+void MappedMatrix<eT>::Unmap()
+{
+  // The matrix must go away before the memory it points to.
+  delete matrix;
+  matrix = new arma::Mat<eT>();
+  info = DatasetInfo();
+
+#ifndef _WIN32
+  if (mapping)
+    munmap(mapping, mappingSize);
+#endif
+
+  mapping = NULL;
+  mappingSize = 0;
+}
+
+template<typename eT>
+void MappedMatrix<eT>::Map(const std::string& filename)
+{
+  Unmap();
+
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    throw std::runtime_error("cannot get size of file '" + filename + "'");
+  }
+
+  const size_t fileSize = fileStat.st_size;
+  if (fileSize < sizeof(BinaryMatrixHeader))
+  {
+    close(fd);
+    throw std::runtime_error("unexpected end of mlpack binary matrix file");
+  }
+
+  void* base = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // The mapping stays valid after the descriptor is closed.
+  if (base == MAP_FAILED)
+    throw std::runtime_error("cannot map file '" + filename + "'");
+
+  mapping = base;
+  mappingSize = fileSize;
+
+  try
+  {
+    const char* bytes = static_cast<const char*>(base);
+
+    BinaryMatrixHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    details::CheckBinaryMatrixHeader(header);
+
+    if (header.elemKind != details::BinaryElementKind<eT>() ||
+        header.elemSize != sizeof(eT))
+      throw std::runtime_error("element type of mlpack binary matrix file "
+          "does not match the requested type; load it into an arma::Mat to "
+          "convert it");
+
+    if (sizeof(BinaryMatrixHeader) + header.infoSize > fileSize ||
+        header.dataOffset + header.rows * header.cols * sizeof(eT) > fileSize)
+      throw std::runtime_error("unexpected end of mlpack binary matrix file");
+
+    details::LoadBinaryMatrixInfo(std::string(bytes +
+        sizeof(BinaryMatrixHeader), header.infoSize), header.rows, info);
+
+    // Alias the mapped elements.  The memory is read-only, which is why the
+    // matrix is only ever exposed as const.
+    delete matrix;
+    matrix = new arma::Mat<eT>(reinterpret_cast<eT*>(const_cast<char*>(bytes +
+        header.dataOffset)), header.rows, header.cols, false, true);
+  }
+  catch (...)
+  {
+    Unmap();
+    throw;
+  }
+#else
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  LoadBinaryMatrix(stream, *matrix, &info);
+#endif
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
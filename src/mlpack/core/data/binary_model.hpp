@@ -0,0 +1,142 @@
+/**
+ * @file binary_model.hpp
+ *
+ * Support for mlpack's native binary model format (.mlmodel).  A file in this
+ * format holds a fixed-size header (giving the version of the format), and then
+ * the model serialized with a boost::serialization binary archive, in which the
+ * elements of every large matrix are stored as one raw block that starts at an
+ * aligned offset of the file.  Loading such a file is therefore mostly a matter
+ * of copying blocks, and a file can be memory-mapped so that the matrices of
+ * the model point directly at the mapped blocks; see MappedModel.
+ *
+ * Like the binary format (.bin), files are specific to the byte order and the
+ * word size of the host that wrote them.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BINARY_MODEL_HPP
+#define MLPACK_CORE_DATA_BINARY_MODEL_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The header at the start of every .mlmodel file.  The binary archive holding
+ * the model follows right after it.
+ */
+struct BinaryModelHeader
+{
+  //! Magic string identifying the format.
+  char magic[8];
+  //! Version of the format.
+  uint32_t version;
+  //! Alignment of the blocks of matrix elements, in bytes.
+  uint32_t alignment;
+};
+
+/**
+ * Save the given model to the given stream in the .mlmodel format.  The stream
+ * must be positioned at the start of the file, since the blocks are aligned
+ * relative to it.  A boost::archive::archive_exception or a std::runtime_error
+ * is thrown on failure.
+ *
+ * @param stream Stream to write to.
+ * @param name Name of the model; the same name must be used to load it.
+ * @param t Model to save.
+ */
+template<typename T>
+void SaveBinaryModel(std::ostream& stream, const std::string& name, T& t);
+
+/**
+ * Load a model from the given stream in the .mlmodel format.  The stream must
+ * be positioned at the start of the file.  A boost::archive::archive_exception
+ * or a std::runtime_error is thrown on failure.
+ *
+ * @param stream Stream to read from.
+ * @param name Name the model was saved with.
+ * @param t Model to load into.
+ */
+template<typename T>
+void LoadBinaryModel(std::istream& stream, const std::string& name, T& t);
+
+/**
+ * A model loaded from a memory-mapped .mlmodel file.  The model is deserialized
+ * as usual, except that its large matrices (for instance the dataset held by a
+ * kNN model and its tree) point directly at the mapped file, so their elements
+ * are neither read nor copied: the operating system only reads the pages that
+ * are actually used, and several processes that map the same file share the
+ * same physical memory.  The file is mapped privately, so the model may be
+ * modified without changing the file.  The model is only valid as long as the
+ * MappedModel object exists.
+ *
+ * Use data::Load() to map a file:
+ *
+ * @code
+ * data::MappedModel<KNNModel> mapped;
+ * data::Load("knn.mlmodel", "model", mapped, true);
+ * mapped.Model().Search(...);
+ * @endcode
+ *
+ * On systems without mmap() (i.e. Windows) the file is read into memory
+ * instead.
+ *
+ * @tparam T Type of the model.
+ */
+template<typename T>
+class MappedModel
+{
+ public:
+  //! Create an empty MappedModel; the model is default-constructed.
+  MappedModel();
+
+  //! Release the mapping.
+  ~MappedModel();
+
+  //! Mappings cannot be copied.
+  MappedModel(const MappedModel&) = delete;
+  //! Mappings cannot be copied.
+  MappedModel& operator=(const MappedModel&) = delete;
+
+  /**
+   * Map the given .mlmodel file and load the model from it, releasing any
+   * previous mapping.  A boost::archive::archive_exception or a
+   * std::runtime_error is thrown on failure.
+   *
+   * @param filename Name of the file to map.
+   * @param name Name the model was saved with.
+   */
+  void Map(const std::string& filename, const std::string& name);
+
+  //! Release the mapping (if any); the model is default-constructed again.
+  void Unmap();
+
+  //! Get the model.
+  const T& Model() const { return *model; }
+  //! Modify the model.
+  T& Model() { return *model; }
+
+  //! Return whether or not the model is memory-mapped (false if it was read
+  //! into memory, or if nothing is loaded).
+  bool IsMapped() const { return mapping != NULL; }
+
+ private:
+  //! The model.
+  T* model;
+  //! Start of the mapping, or NULL if no file is mapped.
+  void* mapping;
+  //! Length of the mapping, in bytes.
+  size_t mappingSize;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "binary_model_impl.hpp"
+
+#endif
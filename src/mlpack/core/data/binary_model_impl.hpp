@@ -0,0 +1,300 @@
+/**
+ * @file binary_model_impl.hpp
+ *
+ * Implementation of the .mlmodel model format and of MappedModel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BINARY_MODEL_IMPL_HPP
+#define MLPACK_CORE_DATA_BINARY_MODEL_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "binary_model.hpp"
+
+#include <cstring>
+#include <sstream>
+#include <streambuf>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "block_serialization.hpp"
+#include "serialization_shim.hpp"
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace mlpack {
+namespace data {
+
+namespace details {
+
+//! Magic string at the start of every .mlmodel file.
+static const char binaryModelMagic[8] = { 'M', 'L', 'P', 'A', 'C', 'K',
+    'M', 'O' };
+
+//! Current version of the .mlmodel format.
+static const uint32_t binaryModelVersion = 1;
+
+//! Throw an exception if the given header is not a valid .mlmodel header.
+inline void CheckBinaryModelHeader(const BinaryModelHeader& header)
+{
+  if (std::memcmp(header.magic, binaryModelMagic, 8) != 0)
+    throw std::runtime_error("not an mlpack binary model file");
+
+  if (header.version != binaryModelVersion)
+  {
+    std::ostringstream oss;
+    oss << "unsupported mlpack binary model version " << header.version;
+    throw std::runtime_error(oss.str());
+  }
+
+  if (header.alignment != BlockSerializationContext::Alignment)
+    throw std::runtime_error("unsupported block alignment in mlpack binary "
+        "model file");
+}
+
+//! Get the number of bytes of padding needed for a block to start at an
+//! aligned offset, if it would otherwise start at the given offset.
+inline size_t BlockPadding(const size_t offset)
+{
+  const size_t alignment = BlockSerializationContext::Alignment;
+  return (alignment - offset % alignment) % alignment;
+}
+
+//! The context of an archive that writes to a stream.
+class OutputBlockContext : public BlockSerializationContext
+{
+ public:
+  OutputBlockContext(const void* archive,
+                     std::ostream& stream,
+                     const std::streampos start) :
+      BlockSerializationContext(archive),
+      stream(stream),
+      start(start)
+  { }
+
+  size_t Padding() { return BlockPadding((size_t) (stream.tellp() - start)); }
+
+  char* Map(const size_t /* bytes */) { return NULL; }
+
+ private:
+  std::ostream& stream;
+  std::streampos start;
+};
+
+//! The context of an archive that reads from a stream.
+class InputBlockContext : public BlockSerializationContext
+{
+ public:
+  InputBlockContext(const void* archive,
+                    std::istream& stream,
+                    const std::streampos start) :
+      BlockSerializationContext(archive),
+      stream(stream),
+      start(start)
+  { }
+
+  size_t Padding() { return BlockPadding((size_t) (stream.tellg() - start)); }
+
+  char* Map(const size_t /* bytes */) { return NULL; }
+
+ private:
+  std::istream& stream;
+  std::streampos start;
+};
+
+/**
+ * A stream buffer that reads from a memory-mapped file, and that can hand out
+ * the address of its next bytes instead of copying them.
+ */
+class MappedStreambuf : public std::streambuf
+{
+ public:
+  MappedStreambuf(char* begin, const size_t size)
+  {
+    setg(begin, begin, begin + size);
+  }
+
+  //! Get the offset of the next byte from the start of the file.
+  size_t Offset() const { return gptr() - eback(); }
+
+  //! Skip the given number of bytes and return their address, or return NULL
+  //! if there are not that many bytes left.
+  char* Skip(const size_t bytes)
+  {
+    if (bytes > size_t(egptr() - gptr()))
+      return NULL;
+
+    char* block = gptr();
+    setg(eback(), block + bytes, egptr());
+    return block;
+  }
+};
+
+//! The context of an archive that reads from a memory-mapped file.
+class MappedBlockContext : public BlockSerializationContext
+{
+ public:
+  MappedBlockContext(const void* archive, MappedStreambuf& buffer) :
+      BlockSerializationContext(archive),
+      buffer(buffer)
+  { }
+
+  size_t Padding() { return BlockPadding(buffer.Offset()); }
+
+  char* Map(const size_t bytes) { return buffer.Skip(bytes); }
+
+ private:
+  MappedStreambuf& buffer;
+};
+
+} // namespace details
+
+template<typename T>
+void SaveBinaryModel(std::ostream& stream, const std::string& name, T& t)
+{
+  const std::streampos start = stream.tellp();
+
+  BinaryModelHeader header;
+  std::memcpy(header.magic, details::binaryModelMagic, 8);
+  header.version = details::binaryModelVersion;
+  header.alignment = details::BlockSerializationContext::Alignment;
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  {
+    boost::archive::binary_oarchive ar(stream);
+    details::OutputBlockContext context(&ar, stream, start);
+    details::BlockSerializationScope scope(context);
+    ar << CreateNVP(t, name);
+  }
+
+  if (!stream)
+    throw std::runtime_error("error writing mlpack binary model");
+}
+
+template<typename T>
+void LoadBinaryModel(std::istream& stream, const std::string& name, T& t)
+{
+  const std::streampos start = stream.tellg();
+
+  BinaryModelHeader header;
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!stream)
+    throw std::runtime_error("unexpected end of mlpack binary model file");
+  details::CheckBinaryModelHeader(header);
+
+  boost::archive::binary_iarchive ar(stream);
+  details::InputBlockContext context(&ar, stream, start);
+  details::BlockSerializationScope scope(context);
+  ar >> CreateNVP(t, name);
+}
+
+template<typename T>
+MappedModel<T>::MappedModel() :
+    model(new T()),
+    mapping(NULL),
+    mappingSize(0)
+{
+  // Nothing to do.
+}
+
+template<typename T>
+MappedModel<T>::~MappedModel()
+{
+  Unmap();
+  delete model;
+}
+
+template<typename T>
+void MappedModel<T>::Unmap()
+{
+  // The model must go away before the memory its matrices point to.
+  delete model;
+  model = new T();
+
+#ifndef _WIN32
+  if (mapping)
+    munmap(mapping, mappingSize);
+#endif
+
+  mapping = NULL;
+  mappingSize = 0;
+}
+
+template<typename T>
+void MappedModel<T>::Map(const std::string& filename, const std::string& name)
+{
+  Unmap();
+
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    throw std::runtime_error("cannot get size of file '" + filename + "'");
+  }
+
+  const size_t fileSize = fileStat.st_size;
+  if (fileSize < sizeof(BinaryModelHeader))
+  {
+    close(fd);
+    throw std::runtime_error("unexpected end of mlpack binary model file");
+  }
+
+  // The mapping is private, so writes to the matrices of the model go to
+  // copies of the pages they touch, and never to the file.
+  void* base = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+      0);
+  close(fd); // The mapping stays valid after the descriptor is closed.
+  if (base == MAP_FAILED)
+    throw std::runtime_error("cannot map file '" + filename + "'");
+
+  mapping = base;
+  mappingSize = fileSize;
+
+  try
+  {
+    char* bytes = static_cast<char*>(base);
+
+    BinaryModelHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    details::CheckBinaryModelHeader(header);
+
+    details::MappedStreambuf buffer(bytes, fileSize);
+    buffer.Skip(sizeof(BinaryModelHeader));
+
+    boost::archive::binary_iarchive ar(buffer);
+    details::MappedBlockContext context(&ar, buffer);
+    details::BlockSerializationScope scope(context);
+    ar >> CreateNVP(*model, name);
+  }
+  catch (...)
+  {
+    Unmap();
+    throw;
+  }
+#else
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  LoadBinaryModel(stream, name, *model);
+#endif
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file block_serialization.hpp
+ *
+ * The hook that lets Mat::serialize() store the elements of large matrices as
+ * aligned blocks in mlpack binary model files (.mlmodel), and point matrices at
+ * those blocks when such a file is memory-mapped.  This is included by
+ * arma_extend.hpp before Armadillo, so it must not depend on anything else in
+ * mlpack.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BLOCK_SERIALIZATION_HPP
+#define MLPACK_CORE_DATA_BLOCK_SERIALIZATION_HPP
+
+#include <cstddef>
+
+namespace mlpack {
+namespace data {
+namespace details {
+
+/**
+ * While a model is saved to or loaded from a .mlmodel file, the archive that
+ * does so is described by a BlockSerializationContext, which is made current
+ * for the calling thread by a BlockSerializationScope.  Matrices serialized
+ * directly by that archive whose elements take at least MinimumBlockSize bytes
+ * are preceded by padding, so that their elements start at an aligned offset of
+ * the file.  When the file is memory-mapped, Map() gives the address of those
+ * elements, and the matrix uses them in place instead of reading them.
+ */
+class BlockSerializationContext
+{
+ public:
+  //! Blocks start at offsets of the file that are multiples of this.
+  static const size_t Alignment = 64;
+  //! Matrices with fewer bytes of elements than this are stored unaligned.
+  static const size_t MinimumBlockSize = 4096;
+
+  //! Create a context for the given archive.
+  BlockSerializationContext(const void* archive) : archive(archive) { }
+
+  virtual ~BlockSerializationContext() { }
+
+  //! Get the archive that this context describes.
+  const void* Archive() const { return archive; }
+
+  //! Get the number of bytes of padding before a block that starts at the
+  //! current position of the archive.
+  virtual size_t Padding() = 0;
+
+  /**
+   * If the file is memory-mapped, return the address of the next given number
+   * of bytes of the file, and skip them.  Otherwise, return NULL (and the bytes
+   * must be read from the archive).
+   */
+  virtual char* Map(const size_t bytes) = 0;
+
+  //! Get the context of the calling thread (NULL if there is none).
+  static BlockSerializationContext*& Current()
+  {
+    static thread_local BlockSerializationContext* current = NULL;
+    return current;
+  }
+
+ private:
+  //! The archive that this context describes.
+  const void* archive;
+};
+
+/**
+ * Make the given context current for the calling thread during the lifetime of
+ * this object.
+ */
+class BlockSerializationScope
+{
+ public:
+  BlockSerializationScope(BlockSerializationContext& context) :
+      previous(BlockSerializationContext::Current())
+  {
+    BlockSerializationContext::Current() = &context;
+  }
+
+  ~BlockSerializationScope()
+  {
+    BlockSerializationContext::Current() = previous;
+  }
+
+ private:
+  //! The context that was current before.
+  BlockSerializationContext* previous;
+};
+
+} // namespace details
+} // namespace data
+} // namespace mlpack
+
+#endif
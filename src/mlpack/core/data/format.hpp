@@ -22,7 +22,9 @@ enum format
   autodetect,
   text,
   xml,
-  binary
+  binary,
+  //! mlpack binary model files (.mlmodel); see binary_model.hpp.
+  binary_model
 };
 
 } // namespace data
@@ -0,0 +1,458 @@
+/**
+ * @file hdf5_chunked.hpp
+ *
+ * Column-block access to HDF5 datasets: a batch source (see batch_source.hpp)
+ * that reads a dataset one hyperslab of points at a time, and a writer that
+ * appends blocks of points to a chunked, compressed dataset.  Neither holds
+ * more than one block in memory, so datasets larger than memory can be read
+ * and written.
+ *
+ * The datasets are laid out like Armadillo's hdf5_binary format, with one point
+ * per row of the dataset (so a point is contiguous in the file, as it is in a
+ * column of a matrix), and the files can be read by data::Load() too.  These
+ * classes are only available if Armadillo was built with HDF5 support.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_HDF5_CHUNKED_HPP
+#define MLPACK_CORE_DATA_HDF5_CHUNKED_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#ifdef ARMA_USE_HDF5
+
+#include <hdf5.h>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A batch source over a two-dimensional HDF5 dataset, whose shards are blocks
+ * of consecutive points that are read as hyperslabs when they are loaded.  The
+ * responses may be given by a second dataset of the same file with the same
+ * number of points; otherwise the shards have responses with zero rows.  If the
+ * dataset is chunked, the shards are aligned to its chunks, so every chunk is
+ * read (and decompressed) once per pass.
+ *
+ * The source can be given to data::BatchPrefetcher (for FFN training) and to
+ * PCA::Apply() and svd::RandomizedSVD, and its shards can be given to
+ * kmeans::StreamingKMeans:
+ *
+ * @code
+ * data::HDF5BatchSource<double> source("features.h5");
+ * size_t shard = 0;
+ * auto batches = [&](arma::mat& batch)
+ * {
+ *   if (shard == source.NumShards())
+ *     return false;
+ *
+ *   arma::mat responses;
+ *   source.LoadShard(shard++, batch, responses);
+ *   return true;
+ * };
+ *
+ * kmeans::StreamingKMeans<> skm;
+ * skm.Cluster(batches, 10, centroids);
+ * @endcode
+ *
+ * @tparam eT Element type of the loaded matrices; the values of the datasets
+ *     are converted to it by HDF5.
+ */
+template<typename eT = double>
+class HDF5BatchSource
+{
+ public:
+  /**
+   * Open the given datasets of the given file.  A std::runtime_error is thrown
+   * if they can't be opened or are not two-dimensional, and a
+   * std::invalid_argument if they hold different numbers of points.
+   *
+   * @param filename Name of the HDF5 file.
+   * @param predictorsDataset Name of the dataset holding the predictors.
+   * @param responsesDataset Name of the dataset holding the responses, or ""
+   *     for unlabeled data.
+   * @param shardSize Number of points in each shard; 0 means 65536 points,
+   *     rounded up to a whole number of chunks.
+   */
+  HDF5BatchSource(const std::string& filename,
+                  const std::string& predictorsDataset = "dataset",
+                  const std::string& responsesDataset = "",
+                  const size_t shardSize = 0) :
+      file(-1),
+      predictors(-1),
+      responses(-1),
+      memType(-1)
+  {
+    // The failures are reported by the exceptions, not by HDF5.
+    H5E_BEGIN_TRY
+    {
+      file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    }
+    H5E_END_TRY;
+    if (file < 0)
+      throw std::runtime_error("HDF5BatchSource: cannot open '" + filename +
+          "'");
+
+    try
+    {
+      memType = arma::hdf5_misc::get_hdf5_type<eT>();
+      size_t chunkPoints;
+      predictors = OpenDataset(predictorsDataset, numPoints, predictorRows,
+          chunkPoints);
+
+      if (responsesDataset != "")
+      {
+        size_t responsePoints, responseChunkPoints;
+        responses = OpenDataset(responsesDataset, responsePoints, responseRows,
+            responseChunkPoints);
+        if (responsePoints != numPoints)
+        {
+          throw std::invalid_argument("HDF5BatchSource: the predictors and "
+              "responses must have the same number of points");
+        }
+      }
+      else
+      {
+        responseRows = 0;
+      }
+
+      if (shardSize != 0)
+        this->shardSize = shardSize;
+      else
+        this->shardSize = ((65536 + chunkPoints - 1) / chunkPoints) *
+            chunkPoints;
+    }
+    catch (...)
+    {
+      Close();
+      throw;
+    }
+  }
+
+  //! Close the file.
+  ~HDF5BatchSource() { Close(); }
+
+  //! Return the number of shards.
+  size_t NumShards() const { return (numPoints + shardSize - 1) / shardSize; }
+
+  //! Read the points of the given shard.
+  void LoadShard(const size_t shard,
+                 arma::Mat<eT>& shardPredictors,
+                 arma::Mat<eT>& shardResponses)
+  {
+    const size_t begin = shard * shardSize;
+    const size_t count = std::min(shardSize, numPoints - begin);
+    ReadBlock(predictors, begin, count, predictorRows, shardPredictors);
+    if (responses >= 0)
+      ReadBlock(responses, begin, count, responseRows, shardResponses);
+    else
+      shardResponses.set_size(0, count);
+  }
+
+  //! Get the number of points.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the dimensionality of the predictors.
+  size_t Dimensionality() const { return predictorRows; }
+  //! Get the number of points in each shard.
+  size_t ShardSize() const { return shardSize; }
+
+ private:
+  // Don't copy an HDF5BatchSource.
+  HDF5BatchSource(const HDF5BatchSource&);
+  HDF5BatchSource& operator=(const HDF5BatchSource&);
+
+  //! Open the given dataset and get its shape and the points in each chunk.
+  hid_t OpenDataset(const std::string& name,
+                    size_t& points,
+                    size_t& rows,
+                    size_t& chunkPoints)
+  {
+    hid_t dataset;
+    H5E_BEGIN_TRY
+    {
+      dataset = H5Dopen(file, name.c_str(), H5P_DEFAULT);
+    }
+    H5E_END_TRY;
+    if (dataset < 0)
+      throw std::runtime_error("HDF5BatchSource: no dataset '" + name + "'");
+
+    const hid_t space = H5Dget_space(dataset);
+    const hid_t plist = H5Dget_create_plist(dataset);
+    hsize_t dims[2], chunkDims[2];
+    const bool valid = (H5Sget_simple_extent_ndims(space) == 2);
+    if (valid)
+      H5Sget_simple_extent_dims(space, dims, NULL);
+    const bool chunked = valid && (H5Pget_layout(plist) == H5D_CHUNKED) &&
+        (H5Pget_chunk(plist, 2, chunkDims) == 2);
+    H5Pclose(plist);
+    H5Sclose(space);
+
+    if (!valid)
+    {
+      H5Dclose(dataset);
+      throw std::runtime_error("HDF5BatchSource: dataset '" + name + "' is "
+          "not two-dimensional");
+    }
+
+    points = dims[0];
+    rows = dims[1];
+    chunkPoints = chunked ? std::max((size_t) chunkDims[0], (size_t) 1) : 1;
+    return dataset;
+  }
+
+  //! Read count points of the given dataset, starting at begin.
+  void ReadBlock(const hid_t dataset,
+                 const size_t begin,
+                 const size_t count,
+                 const size_t rows,
+                 arma::Mat<eT>& block)
+  {
+    block.set_size(rows, count);
+    if (block.n_elem == 0)
+      return;
+
+    const hsize_t offset[2] = { begin, 0 };
+    const hsize_t dims[2] = { count, rows };
+    const hid_t fileSpace = H5Dget_space(dataset);
+    const hid_t memSpace = H5Screate_simple(2, dims, NULL);
+    herr_t status = H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, offset,
+        NULL, dims, NULL);
+    if (status >= 0)
+    {
+      status = H5Dread(dataset, memType, memSpace, fileSpace, H5P_DEFAULT,
+          block.memptr());
+    }
+    H5Sclose(memSpace);
+    H5Sclose(fileSpace);
+
+    if (status < 0)
+      throw std::runtime_error("HDF5BatchSource: cannot read a shard");
+  }
+
+  //! Close the datasets and the file.
+  void Close()
+  {
+    if (responses >= 0)
+      H5Dclose(responses);
+    if (predictors >= 0)
+      H5Dclose(predictors);
+    if (memType >= 0)
+      H5Tclose(memType);
+    if (file >= 0)
+      H5Fclose(file);
+    file = predictors = responses = memType = -1;
+  }
+
+  //! The file.
+  hid_t file;
+  //! The predictors dataset.
+  hid_t predictors;
+  //! The responses dataset, or -1 if there is none.
+  hid_t responses;
+  //! The HDF5 type of eT.
+  hid_t memType;
+  //! The number of points.
+  size_t numPoints;
+  //! The dimensionality of the predictors.
+  size_t predictorRows;
+  //! The dimensionality of the responses.
+  size_t responseRows;
+  //! The number of points in each shard.
+  size_t shardSize;
+};
+
+/**
+ * HDF5ChunkedWriter creates a chunked HDF5 dataset with a fixed number of rows
+ * per point, and appends blocks of points (the columns of a matrix) to it, so
+ * that results can be written as they are computed.  The chunks are compressed
+ * with deflate (zlib) if the HDF5 library has it.
+ *
+ * @code
+ * data::HDF5ChunkedWriter<double> writer("distances.h5", k);
+ * for (size_t i = 0; i < numBlocks; ++i)
+ *   writer.Write(ComputeBlock(i));
+ * writer.Close();
+ * @endcode
+ *
+ * @tparam eT Element type of the written matrices, and of the dataset.
+ */
+template<typename eT = double>
+class HDF5ChunkedWriter
+{
+ public:
+  /**
+   * Create the given file (replacing any existing file) with an empty dataset.
+   * A std::runtime_error is thrown if it can't be created.
+   *
+   * @param filename Name of the HDF5 file.
+   * @param rows Dimensionality of the points; must be positive.
+   * @param chunkPoints Number of points in each chunk; 0 means chunks of about
+   *     1 MiB.
+   * @param compression Deflate level, from 0 (no compression) to 9.
+   * @param datasetName Name of the dataset.
+   */
+  HDF5ChunkedWriter(const std::string& filename,
+                    const size_t rows,
+                    const size_t chunkPoints = 0,
+                    const int compression = 4,
+                    const std::string& datasetName = "dataset") :
+      filename(filename),
+      rows(rows),
+      points(0),
+      file(-1),
+      dataset(-1),
+      type(-1)
+  {
+    if (rows == 0)
+      throw std::invalid_argument("HDF5ChunkedWriter: the points must have at "
+          "least one dimension");
+
+    if (compression < 0 || compression > 9)
+      throw std::invalid_argument("HDF5ChunkedWriter: the compression level "
+          "must be between 0 and 9");
+
+    file = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT,
+        H5P_DEFAULT);
+    if (file < 0)
+      throw std::runtime_error("HDF5ChunkedWriter: cannot create '" +
+          filename + "'");
+
+    type = arma::hdf5_misc::get_hdf5_type<eT>();
+
+    // The number of points grows as blocks are written.
+    const hsize_t dims[2] = { 0, rows };
+    const hsize_t maxDims[2] = { H5S_UNLIMITED, rows };
+    const size_t autoPoints = std::max((size_t) 1,
+        (size_t) (1 << 20) / (rows * sizeof(eT)));
+    const hsize_t chunkDims[2] = { (chunkPoints == 0) ? autoPoints :
+        chunkPoints, rows };
+
+    const hid_t space = H5Screate_simple(2, dims, maxDims);
+    const hid_t plist = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(plist, 2, chunkDims);
+    if (compression > 0 && H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0)
+    {
+      H5Pset_shuffle(plist);
+      H5Pset_deflate(plist, (unsigned) compression);
+    }
+
+    dataset = H5Dcreate(file, datasetName.c_str(), type, space, H5P_DEFAULT,
+        plist, H5P_DEFAULT);
+    H5Pclose(plist);
+    H5Sclose(space);
+
+    if (dataset < 0)
+    {
+      Close();
+      throw std::runtime_error("HDF5ChunkedWriter: cannot create the dataset "
+          "of '" + filename + "'");
+    }
+  }
+
+  //! Close the file, if Close() was not called.
+  ~HDF5ChunkedWriter()
+  {
+    try
+    {
+      Close();
+    }
+    catch (std::exception&)
+    {
+      // Destructors can't throw.
+    }
+  }
+
+  /**
+   * Append the columns of the given block to the dataset.  A
+   * std::invalid_argument is thrown if the block has the wrong number of rows,
+   * and a std::runtime_error if it can't be written.
+   */
+  void Write(const arma::Mat<eT>& block)
+  {
+    if (dataset < 0)
+      throw std::runtime_error("HDF5ChunkedWriter: '" + filename + "' is "
+          "closed");
+    if (block.n_rows != rows)
+      throw std::invalid_argument("HDF5ChunkedWriter: the block has the wrong "
+          "number of rows");
+    if (block.n_cols == 0)
+      return;
+
+    const hsize_t newDims[2] = { points + block.n_cols, rows };
+    const hsize_t offset[2] = { points, 0 };
+    const hsize_t blockDims[2] = { block.n_cols, rows };
+
+    herr_t status = H5Dset_extent(dataset, newDims);
+    if (status >= 0)
+    {
+      const hid_t fileSpace = H5Dget_space(dataset);
+      const hid_t memSpace = H5Screate_simple(2, blockDims, NULL);
+      status = H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, offset, NULL,
+          blockDims, NULL);
+      if (status >= 0)
+      {
+        status = H5Dwrite(dataset, type, memSpace, fileSpace, H5P_DEFAULT,
+            block.memptr());
+      }
+      H5Sclose(memSpace);
+      H5Sclose(fileSpace);
+    }
+
+    if (status < 0)
+      throw std::runtime_error("HDF5ChunkedWriter: cannot write to '" +
+          filename + "'");
+
+    points += block.n_cols;
+  }
+
+  /**
+   * Close the dataset and the file.  A std::runtime_error is thrown if the
+   * file can't be flushed.
+   */
+  void Close()
+  {
+    herr_t status = 0;
+    if (dataset >= 0)
+      status = std::min(status, H5Dclose(dataset));
+    if (type >= 0)
+      H5Tclose(type);
+    if (file >= 0)
+      status = std::min(status, H5Fclose(file));
+    file = dataset = type = -1;
+
+    if (status < 0)
+      throw std::runtime_error("HDF5ChunkedWriter: cannot close '" + filename
+          + "'");
+  }
+
+  //! Get the number of points written.
+  size_t Points() const { return points; }
+
+ private:
+  // Don't copy an HDF5ChunkedWriter.
+  HDF5ChunkedWriter(const HDF5ChunkedWriter&);
+  HDF5ChunkedWriter& operator=(const HDF5ChunkedWriter&);
+
+  //! The name of the file.
+  std::string filename;
+  //! The dimensionality of the points.
+  size_t rows;
+  //! The number of points written.
+  size_t points;
+  //! The file.
+  hid_t file;
+  //! The dataset.
+  hid_t dataset;
+  //! The HDF5 type of eT.
+  hid_t type;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif // ARMA_USE_HDF5
+
+#endif
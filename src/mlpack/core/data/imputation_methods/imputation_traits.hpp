@@ -0,0 +1,36 @@
+/**
+ * @file imputation_traits.hpp
+ *
+ * A class for template metaprogramming traits for imputation strategies.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_IMPUTE_STRATEGIES_IMPUTATION_TRAITS_HPP
+#define MLPACK_CORE_DATA_IMPUTE_STRATEGIES_IMPUTATION_TRAITS_HPP
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A class to obtain compile-time traits about imputation strategies (the
+ * StrategyType of Imputer).  If you are writing your own strategy whose
+ * Impute() does more than replace elements of the dimension it is given, you
+ * should make a template specialization in order to set the values correctly.
+ */
+template<typename StrategyType>
+struct ImputationTraits
+{
+  //! If true, then Impute() only modifies elements of the given dimension (and
+  //! does not change the size of the matrix), so several dimensions of the same
+  //! matrix may be imputed at once, from different threads.  This defaults to
+  //! true.
+  static const bool IndependentDimensions = true;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
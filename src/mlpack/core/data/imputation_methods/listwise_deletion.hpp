@@ -13,6 +13,7 @@
 #define MLPACK_CORE_DATA_IMPUTE_STRATEGIES_LISTWISE_DELETION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "imputation_traits.hpp"
 
 namespace mlpack {
 namespace data {
@@ -68,6 +69,14 @@ class ListwiseDeletion
   }
 }; // class ListwiseDeletion
 
+//! ListwiseDeletion removes whole points, so dimensions cannot be imputed at
+//! once.
+template<typename T>
+struct ImputationTraits<ListwiseDeletion<T>>
+{
+  static const bool IndependentDimensions = false;
+};
+
 } // namespace data
 } // namespace mlpack
 
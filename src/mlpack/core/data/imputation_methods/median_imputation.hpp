@@ -40,49 +40,46 @@ class MedianImputation
               const size_t dimension,
               const bool columnMajor = true)
   {
-    using PairType = std::pair<size_t, size_t>;
-    // dimensions and indexes are saved as pairs inside this vector.
-    std::vector<PairType> targets;
+    // Indices (along the dimension) of the elements to replace.
+    std::vector<size_t> targets;
     // good elements are kept inside this vector.
     std::vector<double> elemsToKeep;
 
-    if (columnMajor)
+    const size_t n = columnMajor ? input.n_cols : input.n_rows;
+    elemsToKeep.reserve(n);
+    for (size_t i = 0; i < n; ++i)
     {
-      for (size_t i = 0; i < input.n_cols; ++i)
-      {
-        if (input(dimension, i) == mappedValue ||
-            std::isnan(input(dimension, i)))
-        {
-          targets.emplace_back(dimension, i);
-        }
-        else
-        {
-          elemsToKeep.push_back(input(dimension, i));
-        }
-      }
+      const T value = columnMajor ? input(dimension, i) : input(i, dimension);
+      if (value == mappedValue || std::isnan(value))
+        targets.push_back(i);
+      else
+        elemsToKeep.push_back(value);
     }
-    else
+
+    if (elemsToKeep.empty())
+      Log::Fatal << "it is impossible to calculate median; no valid elements "
+          << "in the dimension" << std::endl;
+
+    // calculate median.  nth_element() partially sorts the kept elements in
+    // place, which is linear on average; if there is an even number of them,
+    // the other middle element is the largest of the lower half.
+    const size_t middle = elemsToKeep.size() / 2;
+    std::nth_element(elemsToKeep.begin(), elemsToKeep.begin() + middle,
+        elemsToKeep.end());
+    double median = elemsToKeep[middle];
+    if (elemsToKeep.size() % 2 == 0)
     {
-      for (size_t i = 0; i < input.n_rows; ++i)
-      {
-        if (input(i, dimension) == mappedValue ||
-            std::isnan(input(i, dimension)))
-        {
-          targets.emplace_back(i, dimension);
-        }
-        else
-        {
-           elemsToKeep.push_back(input(i, dimension));
-        }
-      }
+      const double lower = *std::max_element(elemsToKeep.begin(),
+          elemsToKeep.begin() + middle);
+      median = (lower + median) / 2;
     }
 
-    // calculate median
-    const double median = arma::median(arma::vec(elemsToKeep));
-
-    for (const PairType& target : targets)
+    for (const size_t target : targets)
     {
-       input(target.first, target.second) = median;
+      if (columnMajor)
+        input(dimension, target) = median;
+      else
+        input(target, dimension) = median;
     }
   }
 }; // class MedianImputation
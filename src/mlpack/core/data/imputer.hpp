@@ -17,6 +17,7 @@
 #include "dataset_mapper.hpp"
 #include "map_policies/missing_policy.hpp"
 #include "map_policies/increment_policy.hpp"
+#include "imputation_methods/imputation_traits.hpp"
 
 namespace mlpack {
 namespace data {
@@ -65,6 +66,71 @@ class Imputer
     strategy.Impute(input, mappedValue, dimension, columnMajor);
   }
 
+  /**
+  * Given an input dataset, replace missing values of each of the given
+  * dimensions with given imputation strategy. This function does not produce
+  * output matrix, but overwrites the result into the input matrix.  If the
+  * strategy only modifies the dimension it is given (see ImputationTraits),
+  * the dimensions are imputed in parallel with OpenMP; otherwise, they are
+  * imputed one after another, in the given order.
+  *
+  * @param input Input dataset to apply imputation.
+  * @param missingValue User defined missing value; it can be anything.
+  * @param dimensions Dimensions to apply the imputation; they must be
+  *     distinct.
+  */
+  void Impute(arma::Mat<T>& input,
+              const std::string& missingValue,
+              const std::vector<size_t>& dimensions)
+  {
+    // The mapper is not safe to use from several threads.
+    std::vector<T> mappedValues(dimensions.size());
+    for (size_t i = 0; i < dimensions.size(); ++i)
+    {
+      mappedValues[i] = static_cast<T>(mapper.UnmapValue(missingValue,
+          dimensions[i]));
+    }
+
+    if (!ImputationTraits<StrategyType>::IndependentDimensions)
+    {
+      for (size_t i = 0; i < dimensions.size(); ++i)
+        strategy.Impute(input, mappedValues[i], dimensions[i], columnMajor);
+      return;
+    }
+
+    // Exceptions (from Log::Fatal, for instance) cannot leave the parallel
+    // region, so the first one is rethrown after it.
+    std::exception_ptr error;
+
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #ifdef _WIN32
+      #pragma omp parallel for
+      for (intmax_t i = 0; i < (intmax_t) dimensions.size(); ++i)
+    #else
+      #pragma omp parallel for
+      for (size_t i = 0; i < dimensions.size(); ++i)
+    #endif
+    {
+      try
+      {
+        strategy.Impute(input, mappedValues[i], dimensions[i], columnMajor);
+      }
+      catch (...)
+      {
+        #pragma omp critical
+        {
+          if (!error)
+            error = std::current_exception();
+        }
+      }
+    }
+
+    if (error)
+      std::rethrow_exception(error);
+  }
+
   //! Get the strategy
   const StrategyType& Strategy() const { return strategy; }
 
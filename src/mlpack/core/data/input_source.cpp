@@ -0,0 +1,216 @@
+/**
+ * @file input_source.cpp
+ *
+ * Implementation of InputSource.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "input_source.hpp"
+#include "extension.hpp"
+
+#ifdef HAS_ZLIB
+  #include <zlib.h>
+#endif
+#ifdef HAS_ZSTD
+  #include <zstd.h>
+#endif
+
+namespace mlpack {
+namespace data {
+
+InputSource::InputSource(const std::string& filename) :
+    filename(filename),
+    compression(""),
+    open(false),
+    file(NULL),
+    gzipFile(NULL),
+    zstdStream(NULL),
+    zstdInputPos(0),
+    zstdInputSize(0),
+    zstdFrameDone(true)
+{
+  if (filename == "-")
+  {
+    file = stdin;
+    open = true;
+    return;
+  }
+
+  const std::string extension = Extension(filename);
+  if (extension == "gz")
+  {
+    compression = "gz";
+#ifdef HAS_ZLIB
+    gzipFile = gzopen(filename.c_str(), "rb");
+    if (gzipFile)
+    {
+      // A larger buffer than the default makes decompression faster.
+      gzbuffer((::gzFile) gzipFile, 1 << 17);
+      open = true;
+    }
+#endif
+    return;
+  }
+
+  if (extension == "zst")
+  {
+    compression = "zst";
+#ifdef HAS_ZSTD
+    file = std::fopen(filename.c_str(), "rb");
+    if (file)
+    {
+      ZSTD_DStream* stream = ZSTD_createDStream();
+      ZSTD_initDStream(stream);
+      zstdStream = stream;
+      zstdInput.resize(ZSTD_DStreamInSize());
+      open = true;
+    }
+#endif
+    return;
+  }
+
+  file = std::fopen(filename.c_str(), "rb");
+  open = (file != NULL);
+}
+
+InputSource::~InputSource()
+{
+#ifdef HAS_ZLIB
+  if (gzipFile)
+    gzclose((::gzFile) gzipFile);
+#endif
+#ifdef HAS_ZSTD
+  if (zstdStream)
+    ZSTD_freeDStream((ZSTD_DStream*) zstdStream);
+#endif
+  if (file && file != stdin)
+    std::fclose(file);
+}
+
+size_t InputSource::Read(char* buffer, const size_t size)
+{
+  if (!open || size == 0)
+    return 0;
+
+#ifdef HAS_ZLIB
+  if (gzipFile)
+  {
+    // gzread() takes an unsigned size.
+    const unsigned int toRead = (unsigned int) std::min(size,
+        (size_t) (1u << 30));
+    const int result = gzread((::gzFile) gzipFile, buffer, toRead);
+    if (result < 0)
+    {
+      int error;
+      std::ostringstream oss;
+      oss << "Cannot decompress '" << filename << "': "
+          << gzerror((::gzFile) gzipFile, &error);
+      throw std::runtime_error(oss.str());
+    }
+
+    return (size_t) result;
+  }
+#endif
+
+  if (zstdStream)
+    return ReadZstd(buffer, size);
+
+  const size_t result = std::fread(buffer, 1, size, file);
+  if (result == 0 && std::ferror(file))
+  {
+    std::ostringstream oss;
+    oss << "Cannot read '" << filename << "'.";
+    throw std::runtime_error(oss.str());
+  }
+
+  return result;
+}
+
+size_t InputSource::ReadZstd(char* buffer, const size_t size)
+{
+#ifdef HAS_ZSTD
+  ZSTD_outBuffer output = { buffer, size, 0 };
+  while (output.pos == 0)
+  {
+    // Get more compressed bytes if zstd used all of them.
+    if (zstdInputPos == zstdInputSize)
+    {
+      zstdInputSize = std::fread(zstdInput.data(), 1, zstdInput.size(),
+          file);
+      zstdInputPos = 0;
+      if (zstdInputSize == 0)
+      {
+        if (std::ferror(file) || !zstdFrameDone)
+        {
+          std::ostringstream oss;
+          oss << "Cannot decompress '" << filename << "': "
+              << (std::ferror(file) ? "read error." : "truncated file.");
+          throw std::runtime_error(oss.str());
+        }
+
+        return 0;
+      }
+    }
+
+    ZSTD_inBuffer input = { zstdInput.data(), zstdInputSize, zstdInputPos };
+    const size_t result = ZSTD_decompressStream((ZSTD_DStream*) zstdStream,
+        &output, &input);
+    if (ZSTD_isError(result))
+    {
+      std::ostringstream oss;
+      oss << "Cannot decompress '" << filename << "': "
+          << ZSTD_getErrorName(result);
+      throw std::runtime_error(oss.str());
+    }
+
+    zstdInputPos = input.pos;
+    // A result of 0 means that a frame is complete; a file may hold several.
+    zstdFrameDone = (result == 0);
+  }
+
+  return output.pos;
+#else
+  (void) buffer;
+  (void) size;
+  return 0;
+#endif
+}
+
+std::string InputSource::ReadAll()
+{
+  std::string result;
+  std::vector<char> buffer(1 << 20);
+  size_t read;
+  while ((read = Read(buffer.data(), buffer.size())) > 0)
+    result.append(buffer.data(), read);
+
+  return result;
+}
+
+bool InputSource::IsStream(const std::string& filename)
+{
+  if (filename == "-")
+    return true;
+
+  const std::string extension = Extension(filename);
+  return (extension == "gz" || extension == "zst");
+}
+
+std::string InputSource::FormatExtension(const std::string& filename)
+{
+  if (filename == "-")
+    return "";
+
+  const std::string extension = Extension(filename);
+  if (extension == "gz" || extension == "zst")
+    return Extension(filename.substr(0, filename.size() - extension.size() -
+        1));
+
+  return extension;
+}
+
+} // namespace data
+} // namespace mlpack
@@ -0,0 +1,116 @@
+/**
+ * @file input_source.hpp
+ *
+ * A sequential source of the bytes of a file, which may be standard input or a
+ * compressed file that is decompressed as it is read.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_INPUT_SOURCE_HPP
+#define MLPACK_CORE_DATA_INPUT_SOURCE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <cstdio>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * An InputSource reads a file from its start to its end, without seeking, so
+ * that files which can't be seeked can be loaded too:
+ *
+ *  - the name "-" means standard input, so that programs can read data from a
+ *    pipe;
+ *  - files whose names end in ".gz" are decompressed with zlib, and files
+ *    whose names end in ".zst" with zstd, as they are read, so they are never
+ *    decompressed to disk.
+ *
+ * Any other file is read as it is.  The format of a compressed file is given by
+ * the extension before the compression extension, so "data.csv.gz" is a
+ * gzipped CSV file.  If mlpack was built without zlib or zstd, opening files
+ * compressed with it fails.
+ */
+class InputSource
+{
+ public:
+  /**
+   * Open the given file.  Use IsOpen() to check whether this succeeded.
+   *
+   * @param filename Name of the file, or "-" for standard input.
+   */
+  InputSource(const std::string& filename);
+
+  //! Close the file.
+  ~InputSource();
+
+  //! Return whether the file was opened.
+  bool IsOpen() const { return open; }
+
+  /**
+   * Read up to the given number of bytes into the buffer, and return the
+   * number of bytes read.  Fewer bytes may be returned than asked for even if
+   * the file has not ended; 0 is returned only at the end of the file.  A
+   * std::runtime_error is thrown if the file can't be read or decompressed.
+   */
+  size_t Read(char* buffer, const size_t size);
+
+  //! Read the rest of the file into a string.
+  std::string ReadAll();
+
+  //! Return whether the file can be opened (and read) again; this is not the
+  //! case for standard input.
+  bool Reopenable() const { return filename != "-"; }
+
+  //! Get the name of the file.
+  const std::string& Filename() const { return filename; }
+
+  /**
+   * Return whether the given file must be read with an InputSource, because it
+   * is standard input or is compressed.
+   */
+  static bool IsStream(const std::string& filename);
+
+  /**
+   * Get the extension that gives the format of the given file: the extension
+   * before the compression extension for compressed files, and an empty string
+   * for standard input.
+   */
+  static std::string FormatExtension(const std::string& filename);
+
+ private:
+  // Don't copy an InputSource.
+  InputSource(const InputSource&);
+  InputSource& operator=(const InputSource&);
+
+  //! Read from a zstd-compressed file.
+  size_t ReadZstd(char* buffer, const size_t size);
+
+  //! The name of the file.
+  std::string filename;
+  //! The compression of the file: "gz", "zst" or "".
+  std::string compression;
+  //! Whether the file was opened.
+  bool open;
+  //! The file, if it is read with the C library (uncompressed or zstd).
+  std::FILE* file;
+  //! The zlib file, if the file is gzipped.
+  void* gzipFile;
+  //! The zstd decompression stream, if the file is zstd-compressed.
+  void* zstdStream;
+  //! The compressed bytes read from the file that zstd has not used yet.
+  std::vector<char> zstdInput;
+  //! The position of the next unused byte of zstdInput.
+  size_t zstdInputPos;
+  //! The number of valid bytes of zstdInput.
+  size_t zstdInputSize;
+  //! Whether the last zstd frame is complete.
+  bool zstdFrameDone;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
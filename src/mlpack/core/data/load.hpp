@@ -20,6 +20,8 @@
 
 #include "format.hpp"
 #include "dataset_mapper.hpp"
+#include "binary_matrix.hpp"
+#include "binary_model.hpp"
 
 namespace mlpack {
 namespace data /** Functions to load and save matrices and models. */ {
@@ -41,6 +43,10 @@ namespace data /** Functions to load and save matrices and models. */ {
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5, denoted by .hdf, .hdf5, .h5, or .he5
  *
+ * In addition, mlpack binary files (denoted by .mlbin; see binary_matrix.hpp)
+ * can be loaded.  These hold the matrix exactly as it is stored in memory, so
+ * they are never transposed, and the element type is converted if necessary.
+ *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
  * filetype as raw_binary, which can have very confusing effects.
@@ -163,12 +169,14 @@ bool Load(const std::string& filename,
  * Loads a matrix from a file, guessing the filetype from the extension and
  * mapping categorical features with a DatasetMapper object.  This will
  * transpose the matrix (unless the transpose parameter is set to false).
- * This particular overload of Load() can only load text-based formats, such as
- * those given below:
+ * This particular overload of Load() can only load the formats given below,
+ * which store the types of the dimensions:
  *
  * - CSV (csv_ascii), denoted by .csv, or optionally .txt
  * - TSV (raw_ascii), denoted by .tsv, .csv, or .txt
  * - ASCII (raw_ascii), denoted by .txt
+ * - ARFF, denoted by .arff
+ * - mlpack binary, denoted by .mlbin (never transposed)
  *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
@@ -233,6 +241,55 @@ extern template bool Load<double, IncrementPolicy>(
     const bool,
     const bool);
 
+/**
+ * Loads a sparse matrix from a file, guessing the filetype from the extension.
+ * This will transpose the matrix at load time (unless the transpose parameter
+ * is set to false), so that each point of the file is a column of the matrix.
+ * The supported types of files are:
+ *
+ *  - coordinate list (coord_ascii), denoted by .txt or .coo: one non-zero
+ *    element per line, given as "row column value" with zero-based indices,
+ *    where a row of the file is a point (before transposition)
+ *  - Armadillo binary (arma_binary), denoted by .bin
+ *  - ARFF, denoted by .arff, usually with sparse lines ("{index value, ...}");
+ *    categorical values are mapped, but the mappings are not returned
+ *
+ * No dense copy of the matrix is ever made.  If the parameter 'fatal' is set to
+ * true, a std::runtime_error exception will be thrown if the matrix does not
+ * load successfully.
+ *
+ * @param filename Name of file to load.
+ * @param matrix Sparse matrix to load contents of file into.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @param transpose If true, transpose the matrix after loading.
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename eT>
+bool Load(const std::string& filename,
+          arma::SpMat<eT>& matrix,
+          const bool fatal = false,
+          const bool transpose = true);
+
+/**
+ * Memory-map an mlpack binary matrix file (.mlbin; see binary_matrix.hpp).  No
+ * elements are copied: the matrix held by the MappedMatrix points directly at
+ * the mapped file, and it stays valid as long as the MappedMatrix exists.  The
+ * element type stored in the file must be eT; to convert the elements, load the
+ * file into an arma::Mat<eT> instead.
+ *
+ * If the parameter 'fatal' is set to true, a std::runtime_error exception will
+ * be thrown if the file cannot be mapped.
+ *
+ * @param filename Name of file to map.
+ * @param matrix MappedMatrix to map the file into.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename eT>
+bool Load(const std::string& filename,
+          MappedMatrix<eT>& matrix,
+          const bool fatal = false);
+
 /**
  * Load a model from a file, guessing the filetype from the extension, or,
  * optionally, loading the specified format.  If automatic extension detection
@@ -245,8 +302,14 @@ extern template bool Load<double, IncrementPolicy>(
  *  - xml, denoted by .xml
  *  - binary, denoted by .bin
  *
+ * In addition, mlpack binary model files (denoted by .mlmodel; see
+ * binary_model.hpp) hold a binary archive in which the elements of large
+ * matrices are stored as aligned blocks.  They are the fastest to load, and
+ * they can be memory-mapped with MappedModel.
+ *
  * The format parameter can take any of the values in the 'format' enum:
- * 'format::autodetect', 'format::text', 'format::xml', and 'format::binary'.
+ * 'format::autodetect', 'format::text', 'format::xml', 'format::binary', and
+ * 'format::binary_model'.
  * The autodetect functionality operates on the file extension (so, "file.txt"
  * would be autodetected as text).
  *
@@ -265,6 +328,27 @@ bool Load(const std::string& filename,
           const bool fatal = false,
           format f = format::autodetect);
 
+/**
+ * Memory-map an mlpack binary model file (.mlmodel; see binary_model.hpp) and
+ * load the model from it.  The large matrices of the model point directly at
+ * the mapped file instead of being read, and the model stays valid as long as
+ * the MappedModel exists.
+ *
+ * If the parameter 'fatal' is set to true, a std::runtime_error exception will
+ * be thrown if the file cannot be loaded.
+ *
+ * @param filename Name of file to map.
+ * @param name Name the model was saved with.
+ * @param model MappedModel to load the model into.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename T>
+bool Load(const std::string& filename,
+          const std::string& name,
+          MappedModel<T>& model,
+          const bool fatal = false);
+
 } // namespace data
 } // namespace mlpack
 
@@ -272,5 +356,9 @@ bool Load(const std::string& filename,
 #include "load_model_impl.hpp"
 // Include implementation of Load() for vectors.
 #include "load_vec_impl.hpp"
+// Include implementation of Load() for memory-mapped matrices.
+#include "load_mapped_impl.hpp"
+// Include implementation of Load() for sparse matrices.
+#include "load_sparse_impl.hpp"
 
 #endif
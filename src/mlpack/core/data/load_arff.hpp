@@ -14,7 +14,6 @@
 
 #include <mlpack/prereqs.hpp>
 #include "dataset_mapper.hpp"
-#include <boost/tokenizer.hpp>
 
 namespace mlpack {
 namespace data {
@@ -44,6 +43,13 @@ void LoadARFF(const std::string& filename, arma::Mat<eT>& matrix);
  * loading the training set is not used, then the test set may be loaded with
  * different mappings---which can cause horrible problems!
  *
+ * String, date and nominal attributes are categorical; the values of nominal
+ * attributes are mapped in the order they are declared.  The @data section may
+ * hold sparse lines ("{index value, ...}"), whose omitted values are zero.  The
+ * file is memory-mapped and its @data section is parsed in parallel, in one
+ * chunk of lines per thread; the tokens of each categorical dimension are
+ * collected per chunk and mapped once each with the DatasetInfo.
+ *
  * @param filename Name of ARFF file to load.
  * @param matrix Matrix to load data into.
  * @param info DatasetInfo object; can be default-constructed or pre-existing
@@ -54,6 +60,23 @@ void LoadARFF(const std::string& filename,
               arma::Mat<eT>& matrix,
               DatasetMapper<PolicyType>& info);
 
+/**
+ * A utility function to load an ARFF dataset into a sparse matrix, with one
+ * point per column, as LoadARFF() does for dense matrices.  This is meant for
+ * sparse ARFF files, whose lines list only their non-zero values, so the
+ * dataset is never held in memory as a dense matrix.  An exception will be
+ * thrown upon failure.
+ *
+ * @param filename Name of ARFF file to load.
+ * @param matrix Sparse matrix to load data into.
+ * @param info DatasetInfo object; can be default-constructed or pre-existing
+ *     from another call to LoadARFF().
+ */
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::SpMat<eT>& matrix,
+              DatasetMapper<PolicyType>& info);
+
 } // namespace data
 } // namespace mlpack
 
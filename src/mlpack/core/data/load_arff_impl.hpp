@@ -14,95 +14,419 @@
 
 // In case it hasn't been included yet.
 #include "load_arff.hpp"
+#include "mapped_file.hpp"
+#include "token_dictionary.hpp"
 
+#include <cstring>
+#include <deque>
 #include <boost/algorithm/string/trim.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace data {
+namespace details {
 
-template<typename eT, typename PolicyType>
-void LoadARFF(const std::string& filename,
-              arma::Mat<eT>& matrix,
-              DatasetMapper<PolicyType>& info)
+//! The attributes of an ARFF file, read from its header.
+struct ARFFHeader
 {
-  // First, open the file.
-  std::ifstream ifs;
-  ifs.open(filename);
-
-  std::string line;
-  size_t dimensionality = 0;
-  std::vector<bool> types;
-  size_t headerLines = 0;
-  while (!ifs.eof())
-  {
-    // Read the next line, then strip whitespace from either side.
-    std::getline(ifs, line, '\n');
-    boost::trim(line);
-    ++headerLines;
+  //! Whether each attribute is categorical (string, nominal or date).
+  std::vector<bool> categorical;
+  //! The values of each nominal attribute, in the order they are declared
+  //! (empty for the other attributes).
+  std::vector<std::vector<std::string>> nominalValues;
+  //! The start of the @data section.
+  const char* dataBegin;
+  //! The line number of the first line of the @data section.
+  size_t dataLine;
+};
 
-    // Is the first character a comment, or is the line empty?
-    if (line[0] == '%' || line.empty())
-      continue; // Ignore this line.
+//! A value of a line of the @data section: its dimension and its token.
+struct ARFFValue
+{
+  //! The dimension of the value.
+  size_t dimension;
+  //! The start of the token.
+  const char* begin;
+  //! The end of the token.
+  const char* end;
+};
 
-    // If the first character is @, we are looking at @relation, @attribute, or
-    // @data.
-    if (line[0] == '@')
-    {
-      typedef boost::tokenizer<boost::escaped_list_separator<char>> Tokenizer;
-      std::string separators = " \t%"; // Split on comments too.
-      boost::escaped_list_separator<char> sep("\\", separators, "{\"");
-      Tokenizer tok(line, sep);
-      Tokenizer::iterator it = tok.begin();
+//! A chunk of lines of the @data section, which is parsed by one thread.
+struct ARFFChunk
+{
+  //! The start of the first line.
+  const char* begin;
+  //! The end of the last line.
+  const char* end;
+  //! The line number of the first line.
+  size_t firstLine;
+  //! The index of the first point (line that is not empty or a comment).
+  size_t firstPoint;
+  //! Unescaped copies of the quoted tokens that hold escape sequences.
+  std::deque<std::string> storage;
+  //! The first error found in the chunk, if any.
+  std::string error;
+};
 
-      // Get the annotation we are looking at.
-      std::string annotation(*it);
-      std::transform(annotation.begin(), annotation.end(), annotation.begin(),
-            ::tolower);
+//! Return whether the character is whitespace inside a line.
+inline bool IsARFFSpace(const char c)
+{
+  return (c == ' ' || c == '\t' || c == '\r');
+}
 
-      if (annotation == "@relation")
-      {
-        // We don't actually have anything to do with the name of the dataset.
-        continue;
-      }
-      else if (annotation == "@attribute")
+/**
+ * Read the token that starts at p (after any whitespace) and ends at a ',' (or
+ * a '}' in sparse lines and lists of nominal values), a '%' or the end of the
+ * line, and return a pointer to the character that ends it.  Surrounding
+ * whitespace and quotes ('...' or "...") are removed, and if a quoted token
+ * holds escape sequences, it is unescaped into the storage.  NULL is returned
+ * if a quote is not closed.
+ */
+inline const char* ReadARFFToken(const char* p,
+                                 const char* end,
+                                 const bool sparse,
+                                 const char*& tokenBegin,
+                                 const char*& tokenEnd,
+                                 std::deque<std::string>& storage)
+{
+  while (p < end && IsARFFSpace(*p))
+    ++p;
+
+  if (p < end && (*p == '"' || *p == '\''))
+  {
+    const char quote = *p++;
+    const char* q = p;
+    bool escaped = false;
+    while (q < end && *q != quote)
+    {
+      if (*q == '\\' && q + 1 < end)
       {
-        ++dimensionality;
-        // We need to mark this dimension with its according type.
-        ++it; // Ignore the dimension name.
-        std::string dimType = *(++it);
-        std::transform(dimType.begin(), dimType.end(), dimType.begin(),
-            ::tolower);
-
-        if (dimType == "numeric" || dimType == "integer" || dimType == "real")
-        {
-          types.push_back(false); // The feature is numeric.
-        }
-        else if (dimType == "string")
-        {
-          types.push_back(true); // The feature is categorical.
-        }
-        else if (dimType[0] == '{')
-        {
-          throw std::logic_error("list of ARFF values not yet supported");
-        }
+        escaped = true;
+        ++q;
       }
-      else if (annotation == "@data")
+      ++q;
+    }
+    if (q == end)
+      return NULL;
+
+    if (!escaped)
+    {
+      tokenBegin = p;
+      tokenEnd = q;
+    }
+    else
+    {
+      std::string token;
+      for (const char* c = p; c < q; ++c)
       {
-        // We are in the data section.  So we can move out of this loop.
-        break;
+        if (*c == '\\')
+          ++c;
+        token.push_back(*c);
       }
-      else
+      storage.push_back(std::move(token));
+      tokenBegin = storage.back().data();
+      tokenEnd = tokenBegin + storage.back().size();
+    }
+
+    p = q + 1;
+    while (p < end && IsARFFSpace(*p))
+      ++p;
+    return p;
+  }
+
+  tokenBegin = p;
+  while (p < end && *p != ',' && *p != '%' && !(sparse && *p == '}'))
+    ++p;
+  tokenEnd = p;
+  while (tokenEnd > tokenBegin && IsARFFSpace(*(tokenEnd - 1)))
+    --tokenEnd;
+  return p;
+}
+
+/**
+ * Split the line [p, end) of the @data section (which is not empty or a
+ * comment) into its values.  Dense lines must hold one value per dimension,
+ * and sparse lines ("{index value, ...}") any number of values; the values
+ * they leave out are zero.  Return NULL on success, or a description of the
+ * error.
+ */
+inline const char* TokenizeARFFLine(const char* p,
+                                    const char* end,
+                                    const size_t dimensionality,
+                                    std::vector<ARFFValue>& values,
+                                    std::deque<std::string>& storage)
+{
+  values.clear();
+  while (p < end && IsARFFSpace(*p))
+    ++p;
+
+  const bool sparse = (*p == '{');
+  if (sparse)
+  {
+    ++p;
+    while (p < end && IsARFFSpace(*p))
+      ++p;
+  }
+
+  // An empty sparse line has no values.
+  bool done = (sparse && p < end && *p == '}');
+  if (done)
+    ++p;
+
+  while (!done)
+  {
+    ARFFValue value;
+    if (sparse)
+    {
+      const char* indexBegin = p;
+      size_t index = 0;
+      while (p < end && *p >= '0' && *p <= '9' && index < dimensionality)
+        index = 10 * index + (*p++ - '0');
+      if (p == indexBegin || index >= dimensionality ||
+          (p < end && !IsARFFSpace(*p)))
+        return "Invalid sparse index";
+      value.dimension = index;
+    }
+    else
+    {
+      if (values.size() == dimensionality)
+        return "Too many values";
+      value.dimension = values.size();
+    }
+
+    p = ReadARFFToken(p, end, sparse, value.begin, value.end, storage);
+    if (p == NULL)
+      return "Unterminated quote";
+    values.push_back(value);
+
+    if (p == end || *p == '%')
+    {
+      if (sparse)
+        return "Unterminated sparse line";
+      break;
+    }
+    else if (*p == '}')
+    {
+      ++p;
+      done = true;
+    }
+    else if (*p == ',')
+    {
+      ++p;
+      if (sparse)
       {
-        throw std::runtime_error("unknown ARFF annotation '" + (*tok.begin()) +
-            "'");
+        while (p < end && IsARFFSpace(*p))
+          ++p;
       }
     }
+    else
+    {
+      return "Unexpected character after quoted value";
+    }
+  }
+
+  // Only a comment may follow a sparse line.
+  while (p < end && IsARFFSpace(*p))
+    ++p;
+  if (p < end && *p != '%')
+    return "Unexpected character after sparse line";
+
+  if (!sparse && values.size() != dimensionality)
+    return "Too few values";
+
+  return NULL;
+}
+
+/**
+ * Convert the token [begin, end) to a number, which it must be exactly.  The
+ * token is copied, so that strtod() stops at its end even if it is at the end
+ * of the mapped file.
+ */
+template<typename eT>
+inline bool ParseARFFNumber(const char* begin, const char* end, eT& value)
+{
+  const size_t length = end - begin;
+  if (length == 0)
+    return false;
+
+  char buffer[64];
+  std::string longToken;
+  const char* token = buffer;
+  if (length < sizeof(buffer))
+  {
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+  }
+  else
+  {
+    longToken.assign(begin, end);
+    token = longToken.c_str();
+  }
+
+  // strtod() also reads "nan" and "inf".
+  char* numberEnd;
+  const double result = std::strtod(token, &numberEnd);
+  if (numberEnd != token + length)
+    return false;
+
+  value = eT(result);
+  return true;
+}
+
+//! Parse an @attribute line of the header, from position pos of the line.
+inline void ParseARFFAttribute(const std::string& line,
+                               const size_t pos,
+                               ARFFHeader& header)
+{
+  const char* p = line.data() + pos;
+  const char* end = line.data() + line.size();
+  while (p < end && IsARFFSpace(*p))
+    ++p;
+
+  // Skip the name of the attribute, which may be quoted.
+  if (p < end && (*p == '"' || *p == '\''))
+  {
+    const char quote = *p++;
+    while (p < end && *p != quote)
+      p += (*p == '\\' && p + 1 < end) ? 2 : 1;
+    if (p == end)
+      throw std::runtime_error("unterminated quote in ARFF attribute '" +
+          line + "'");
+    ++p;
+  }
+  else
+  {
+    while (p < end && !IsARFFSpace(*p) && *p != '{')
+      ++p;
+  }
+
+  while (p < end && IsARFFSpace(*p))
+    ++p;
+  if (p == end || *p == '%')
+    throw std::runtime_error("no type given for ARFF attribute '" + line +
+        "'");
+
+  std::vector<std::string> nominalValues;
+  if (*p == '{')
+  {
+    // A nominal attribute: the values are listed in braces.
+    ++p;
+    std::deque<std::string> storage;
+    while (true)
+    {
+      const char* tokenBegin;
+      const char* tokenEnd;
+      p = ReadARFFToken(p, end, true, tokenBegin, tokenEnd, storage);
+      if (p == NULL || p == end || (*p != ',' && *p != '}'))
+        throw std::runtime_error("invalid list of values in ARFF attribute '"
+            + line + "'");
+
+      nominalValues.push_back(std::string(tokenBegin, tokenEnd));
+      if (*(p++) == '}')
+        break;
+    }
+
+    header.categorical.push_back(true);
+  }
+  else
+  {
+    const char* typeEnd = p;
+    while (typeEnd < end && !IsARFFSpace(*typeEnd) && *typeEnd != '%')
+      ++typeEnd;
+    std::string type(p, typeEnd);
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+
+    if (type == "numeric" || type == "integer" || type == "real")
+    {
+      header.categorical.push_back(false);
+    }
+    else if (type == "string" || type == "date")
+    {
+      // Dates are mapped like strings.
+      header.categorical.push_back(true);
+    }
+    else if (type == "relational")
+    {
+      throw std::logic_error("relational ARFF attributes not supported");
+    }
+    else
+    {
+      throw std::runtime_error("unknown ARFF attribute type '" + type + "'");
+    }
   }
 
-  if (ifs.eof())
-    throw std::runtime_error("no @data section found");
+  header.nominalValues.push_back(std::move(nominalValues));
+}
 
-  // Reset the DatasetInfo object, if needed.
+/**
+ * Parse the header of the ARFF file [data, end), up to the @data line.  A
+ * std::runtime_error is thrown if it is invalid.
+ */
+inline void ParseARFFHeader(const char* data,
+                            const char* end,
+                            ARFFHeader& header)
+{
+  header.categorical.clear();
+  header.nominalValues.clear();
+
+  size_t lineNumber = 0;
+  const char* p = data;
+  while (p < end)
+  {
+    const char* lineEnd = std::find(p, end, '\n');
+    std::string line(p, lineEnd);
+    p = (lineEnd == end) ? end : lineEnd + 1;
+    ++lineNumber;
+
+    // Ignore empty lines and comments, and anything else that isn't an
+    // annotation.
+    boost::trim(line);
+    if (line.empty() || line[0] != '@')
+      continue;
+
+    const size_t keywordEnd = std::min(line.find_first_of(" \t%"),
+        line.size());
+    std::string keyword = line.substr(0, keywordEnd);
+    std::transform(keyword.begin(), keyword.end(), keyword.begin(),
+        ::tolower);
+
+    if (keyword == "@relation")
+    {
+      // We don't actually have anything to do with the name of the dataset.
+      continue;
+    }
+    else if (keyword == "@attribute")
+    {
+      ParseARFFAttribute(line, keywordEnd, header);
+    }
+    else if (keyword == "@data")
+    {
+      header.dataBegin = p;
+      header.dataLine = lineNumber + 1;
+      return;
+    }
+    else
+    {
+      throw std::runtime_error("unknown ARFF annotation '" +
+          line.substr(0, keywordEnd) + "'");
+    }
+  }
+
+  throw std::runtime_error("no @data section found");
+}
+
+/**
+ * Check the given DatasetMapper against the attributes of the header, or reset
+ * it if it is empty, and set the types of its dimensions.  The values of
+ * nominal attributes are mapped in the order they are declared.
+ */
+template<typename eT, typename PolicyType>
+void SetARFFInfo(const ARFFHeader& header, DatasetMapper<PolicyType>& info)
+{
+  const size_t dimensionality = header.categorical.size();
   if (info.Dimensionality() == 0)
   {
     info = DatasetMapper<PolicyType>(dimensionality);
@@ -116,112 +440,337 @@ void LoadARFF(const std::string& filename,
     throw std::invalid_argument(oss.str());
   }
 
-  for (size_t i = 0; i < types.size(); ++i)
+  for (size_t i = 0; i < dimensionality; ++i)
   {
-    if (types[i])
+    if (header.categorical[i])
+    {
       info.Type(i) = Datatype::categorical;
+      for (size_t j = 0; j < header.nominalValues[i].size(); ++j)
+        info.template MapString<eT>(header.nominalValues[i][j], i);
+    }
     else
+    {
       info.Type(i) = Datatype::numeric;
+    }
+  }
+}
+
+/**
+ * Split the @data section of the file (which ends at end) into chunks of
+ * lines, one per OpenMP thread, and count the points of each chunk in
+ * parallel.  Return the number of points.
+ */
+inline size_t SplitARFFData(const ARFFHeader& header,
+                            const char* end,
+                            std::vector<ARFFChunk>& chunks)
+{
+#ifdef HAS_OPENMP
+  const size_t numChunks = omp_get_max_threads();
+#else
+  const size_t numChunks = 1;
+#endif
+  const char* data = header.dataBegin;
+  const size_t size = end - data;
+
+  // The chunks start at the beginning of a line.
+  chunks.clear();
+  chunks.resize(numChunks);
+  chunks[0].begin = data;
+  for (size_t i = 1; i < numChunks; ++i)
+  {
+    const char* guess = std::max(chunks[i - 1].begin,
+        data + (size * i) / numChunks);
+    const char* newline = std::find(guess, end, '\n');
+    chunks[i].begin = (newline == end) ? end : newline + 1;
+    chunks[i - 1].end = chunks[i].begin;
+  }
+  chunks[numChunks - 1].end = end;
+
+  std::vector<size_t> numLines(numChunks, 0), numPoints(numChunks, 0);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) numChunks; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < numChunks; ++i)
+#endif
+  {
+    const char* p = chunks[i].begin;
+    while (p < chunks[i].end)
+    {
+      const char* lineEnd = std::find(p, chunks[i].end, '\n');
+      while (p < lineEnd && IsARFFSpace(*p))
+        ++p;
+      if (p < lineEnd && *p != '%')
+        ++numPoints[i];
+
+      ++numLines[i];
+      if (lineEnd == chunks[i].end)
+        break;
+      p = lineEnd + 1;
+    }
   }
 
-  // We need to find out how many lines of data are in the file.
-  std::streampos pos = ifs.tellg();
-  size_t row = 0;
-  while (!ifs.eof())
+  size_t line = header.dataLine;
+  size_t point = 0;
+  for (size_t i = 0; i < numChunks; ++i)
   {
-    std::getline(ifs, line, '\n');
-    ++row;
+    chunks[i].firstLine = line;
+    chunks[i].firstPoint = point;
+    line += numLines[i];
+    point += numPoints[i];
   }
-  // Uncount the EOF row.
-  --row;
 
-  // Since we've hit the EOF, we have to call clear() so we can seek again.
-  ifs.clear();
-  ifs.seekg(pos);
+  return point;
+}
 
-  // Now, set the size of the matrix.
-  matrix.set_size(dimensionality, row);
+/**
+ * Parse the chunks of the @data section in parallel, and give each value to
+ * store(chunk, point, dimension, value), which may be called from several
+ * threads at once, but for each chunk from only one.  The tokens of each
+ * categorical dimension are given ids local to their chunk in a
+ * TokenDictionary, so they are never copied; the dictionaries are then merged
+ * in the order of the chunks, so each token is mapped where it first occurs in
+ * the file (as the regular parser would), and the mapped values are stored in
+ * parallel.  A std::runtime_error is thrown for the first error in the file.
+ */
+template<typename eT, typename PolicyType, typename StoreType>
+void ParseARFFData(const ARFFHeader& header,
+                   std::vector<ARFFChunk>& chunks,
+                   DatasetMapper<PolicyType>& info,
+                   StoreType& store)
+{
+  const size_t dimensionality = header.categorical.size();
+  const size_t numChunks = chunks.size();
 
-  // Now we are looking at the @data section.
-  row = 0;
-  while (!ifs.eof())
+  // Number the categorical dimensions.
+  std::vector<size_t> categoricalDims;
+  std::vector<size_t> categoricalIndex(dimensionality, size_t(-1));
+  for (size_t d = 0; d < dimensionality; ++d)
   {
-    std::getline(ifs, line, '\n');
-    boost::trim(line);
-    // Each line of the @data section must be a CSV (except sparse data, which
-    // we will handle later).  So now we can tokenize the
-    // CSV and parse it.  The '?' representing a missing value is not allowed,
-    // so if that occurs we throw an exception.  We also throw an exception if
-    // any piece of data does not match its type (categorical or numeric).
-
-    // If the first character is {, it is sparse data, and we can just say this
-    // is not handled for now...
-    if (line[0] == '{')
-      throw std::runtime_error("cannot yet parse sparse ARFF data");
-
-    // Tokenize the line.
-    typedef boost::tokenizer<boost::escaped_list_separator<char>> Tokenizer;
-    boost::escaped_list_separator<char> sep("\\", ",", "\"");
-    Tokenizer tok(line, sep);
-
-    size_t col = 0;
-    std::stringstream token;
-    for (Tokenizer::iterator it = tok.begin(); it != tok.end(); ++it)
-    {
-      // Check that we are not too many columns in.
-      if (col >= matrix.n_rows)
-      {
-        std::stringstream error;
-        error << "Too many columns in line " << (headerLines + row) << ".";
-        throw std::runtime_error(error.str());
-      }
+    if (header.categorical[d])
+    {
+      categoricalIndex[d] = categoricalDims.size();
+      categoricalDims.push_back(d);
+    }
+  }
+  const size_t numCategorical = categoricalDims.size();
 
-      // What should this token be?
-      if (info.Type(col) == Datatype::categorical)
-      {
-        // Strip spaces before mapping.
-        std::string token = *it;
-        boost::trim(token);
-        // We load transposed.
-        matrix(col, row) = info.template MapString<eT>(token, col);
-      }
-      else if (info.Type(col) == Datatype::numeric)
-      {
-        // Attempt to read as numeric.
-        token.clear();
-        token.str(*it);
+  // The categorical values of each chunk, with their local ids.
+  struct CategoricalValue
+  {
+    size_t point;
+    size_t dimension;
+    size_t id;
+  };
+  std::vector<std::vector<TokenDictionary>> dictionaries(numChunks,
+      std::vector<TokenDictionary>(numCategorical));
+  std::vector<std::vector<CategoricalValue>> categoricalValues(numChunks);
 
-        eT val = eT(0);
-        token >> val;
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) numChunks; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < numChunks; ++i)
+#endif
+  {
+    ARFFChunk& chunk = chunks[i];
+    std::vector<ARFFValue> values;
+    values.reserve(dimensionality);
+
+    size_t line = chunk.firstLine;
+    size_t point = chunk.firstPoint;
+    const char* p = chunk.begin;
+    while (p < chunk.end && chunk.error.empty())
+    {
+      const char* lineEnd = std::find(p, chunk.end, '\n');
+      const char* first = p;
+      while (first < lineEnd && IsARFFSpace(*first))
+        ++first;
+
+      if (first < lineEnd && *first != '%')
+      {
+        const char* error = TokenizeARFFLine(first, lineEnd, dimensionality,
+            values, chunk.storage);
+        if (error != NULL)
+        {
+          std::ostringstream oss;
+          oss << error << " in line " << line << ".";
+          chunk.error = oss.str();
+          break;
+        }
 
-        if (token.fail())
+        for (size_t v = 0; v < values.size(); ++v)
         {
-          // Check for NaN or inf.
-          if (!arma::diskio::convert_naninf(val, token.str()))
+          const ARFFValue& value = values[v];
+          const size_t c = categoricalIndex[value.dimension];
+          if (c != size_t(-1))
+          {
+            const CategoricalValue categoricalValue = { point,
+                value.dimension, dictionaries[i][c].Insert(value.begin,
+                value.end - value.begin) };
+            categoricalValues[i].push_back(categoricalValue);
+            continue;
+          }
+
+          eT number;
+          if (!ParseARFFNumber(value.begin, value.end, number))
           {
-            // Okay, it's not NaN or inf.  If it's '?', we issue a specific
-            // error, otherwise we issue a general error.
-            std::stringstream error;
-            std::string tokenStr = token.str();
-            boost::trim(tokenStr);
-            if (tokenStr == "?")
-              error << "Missing values ('?') not supported, ";
+            // If the token is '?', we issue a specific error, otherwise we
+            // issue a general error.
+            const std::string token(value.begin, value.end);
+            std::ostringstream oss;
+            if (token == "?")
+              oss << "Missing values ('?') not supported, ";
             else
-              error << "Parse error ";
-            error << "at line " << (headerLines + row) << " token " << col
-                << ": \"" << tokenStr << "\".";
-            throw std::runtime_error(error.str());
+              oss << "Parse error ";
+            oss << "at line " << line << " token " << value.dimension
+                << ": \"" << token << "\".";
+            chunk.error = oss.str();
+            break;
           }
+
+          store(i, point, value.dimension, number);
         }
 
-        // If we made it to here, we have a value.
-        matrix(col, row) = val; // We load transposed.
+        ++point;
+      }
+
+      ++line;
+      if (lineEnd == chunk.end)
+        break;
+      p = lineEnd + 1;
+    }
+  }
+
+  for (size_t i = 0; i < numChunks; ++i)
+    if (!chunks[i].error.empty())
+      throw std::runtime_error(chunks[i].error);
+
+  // Merge the dictionaries in the order of the chunks, and map each distinct
+  // token once.
+  std::vector<std::vector<std::vector<eT>>> translation(numChunks,
+      std::vector<std::vector<eT>>(numCategorical));
+  for (size_t c = 0; c < numCategorical; ++c)
+  {
+    TokenDictionary global;
+    std::vector<eT> mapped;
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+      const TokenDictionary& local = dictionaries[i][c];
+      std::vector<eT>& values = translation[i][c];
+      values.resize(local.Size());
+      for (size_t id = 0; id < local.Size(); ++id)
+      {
+        const size_t globalId = global.Insert(local.Begin(id),
+            local.Length(id));
+        if (globalId == mapped.size())
+        {
+          mapped.push_back(info.template MapString<eT>(global.Token(globalId),
+              categoricalDims[c]));
+        }
+        values[id] = mapped[globalId];
       }
+    }
+  }
+
+  // Finally, store the mapped values.
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) numChunks; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < numChunks; ++i)
+#endif
+  {
+    for (size_t v = 0; v < categoricalValues[i].size(); ++v)
+    {
+      const CategoricalValue& value = categoricalValues[i][v];
+      store(i, value.point, value.dimension,
+          translation[i][categoricalIndex[value.dimension]][value.id]);
+    }
+  }
+}
+
+} // namespace details
+
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::Mat<eT>& matrix,
+              DatasetMapper<PolicyType>& info)
+{
+  MappedFile file(filename);
+  details::ARFFHeader header;
+  details::ParseARFFHeader(file.Begin(), file.End(), header);
+  details::SetARFFInfo<eT>(header, info);
+
+  std::vector<details::ARFFChunk> chunks;
+  const size_t numPoints = details::SplitARFFData(header, file.End(), chunks);
+
+  // We load transposed.  Sparse lines leave the values they omit at zero.
+  matrix.zeros(header.categorical.size(), numPoints);
+  auto store = [&matrix](const size_t /* chunk */,
+                         const size_t point,
+                         const size_t dimension,
+                         const eT value)
+  {
+    matrix.at(dimension, point) = value;
+  };
+  details::ParseARFFData<eT>(header, chunks, info, store);
+}
+
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::SpMat<eT>& matrix,
+              DatasetMapper<PolicyType>& info)
+{
+  MappedFile file(filename);
+  details::ARFFHeader header;
+  details::ParseARFFHeader(file.Begin(), file.End(), header);
+  details::SetARFFInfo<eT>(header, info);
 
-      ++col;
+  std::vector<details::ARFFChunk> chunks;
+  const size_t numPoints = details::SplitARFFData(header, file.End(), chunks);
+
+  // Each chunk collects the locations and values of its non-zero elements.
+  std::vector<std::vector<arma::uword>> locations(chunks.size());
+  std::vector<std::vector<eT>> values(chunks.size());
+  auto store = [&locations, &values](const size_t chunk,
+                                     const size_t point,
+                                     const size_t dimension,
+                                     const eT value)
+  {
+    if (value != eT(0))
+    {
+      locations[chunk].push_back(dimension);
+      locations[chunk].push_back(point);
+      values[chunk].push_back(value);
     }
-    ++row;
+  };
+  details::ParseARFFData<eT>(header, chunks, info, store);
+
+  size_t nonzero = 0;
+  for (size_t i = 0; i < values.size(); ++i)
+    nonzero += values[i].size();
+
+  arma::umat allLocations(2, nonzero);
+  arma::Col<eT> allValues(nonzero);
+  size_t offset = 0;
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    std::copy(locations[i].begin(), locations[i].end(),
+        allLocations.memptr() + 2 * offset);
+    std::copy(values[i].begin(), values[i].end(), allValues.memptr() +
+        offset);
+    offset += values[i].size();
   }
+
+  // We load transposed.
+  matrix = arma::SpMat<eT>(allLocations, allValues, header.categorical.size(),
+      numPoints);
 }
 
 } // namespace data
@@ -6,13 +6,37 @@ namespace mlpack {
 namespace data {
 
 LoadCSV::LoadCSV(const std::string& file) :
-  extension(Extension(file)),
+  delimiter(','),
+  extension(InputSource::FormatExtension(file)),
   filename(file),
-  inFile(file)
+  inFile(NULL),
+  isOpen(false),
+  sourceIntact(true)
 {
+  if (InputSource::IsStream(file))
+  {
+    // Standard input and compressed files are read with an InputSource.
+    source.reset(new InputSource(file));
+    isOpen = source->IsOpen();
+  }
+  else
+  {
+    isOpen = (fileBuffer.open(file.c_str(), std::ios::in) != NULL);
+    inFile.rdbuf(&fileBuffer);
+  }
+
   // Attempt to open stream.
   CheckOpen();
 
+  // Standard input has no extension, so look at its first line.
+  if (extension.empty() && source)
+    extension = GuessFormat();
+
+  SetRules();
+}
+
+void LoadCSV::SetRules()
+{
   // Set rules.
   if (extension == "csv" || extension == "txt")
   {
@@ -31,24 +55,78 @@ LoadCSV::LoadCSV(const std::string& file) :
     // side.
     delimiterRule = qi::raw[(*qi::char_(" ") >> qi::char_(",") >>
         *qi::char_(" "))];
+    delimiter = ',';
   }
   else if (extension == "txt")
   {
     // This one is a little more difficult, we need to catch any number of
     // spaces more than one.
     delimiterRule = qi::raw[+qi::char_(" ")];
+    delimiter = ' ';
   }
   else // TSV.
   {
     // Catch a tab character, possibly with whitespace on either side.
     delimiterRule = qi::raw[(*qi::char_(" ") >> qi::char_("\t") >>
         *qi::char_(" "))];
+    delimiter = '\t';
+  }
+}
+
+std::string LoadCSV::GuessFormat()
+{
+  // Read (and keep) bytes until the first line is complete.
+  std::vector<char> buffer(1 << 16);
+  size_t lineEnd;
+  while ((lineEnd = consumed.find('\n')) == std::string::npos)
+  {
+    const size_t read = source->Read(buffer.data(), buffer.size());
+    if (read == 0)
+      break;
+    consumed.append(buffer.data(), read);
   }
+
+  const std::string line = consumed.substr(0, lineEnd);
+  if (line.find(',') != std::string::npos)
+    return "csv";
+  else if (line.find('\t') != std::string::npos)
+    return "tsv";
+  else
+    return "txt";
+}
+
+void LoadCSV::ReadSource()
+{
+  if (!source)
+    return;
+
+  // If some bytes were read and dropped, start again from the beginning.
+  if (!sourceIntact)
+  {
+    source.reset(new InputSource(filename));
+    if (!source->IsOpen())
+    {
+      std::ostringstream oss;
+      oss << "Cannot open file '" << filename << "'. " << std::endl;
+      throw std::runtime_error(oss.str());
+    }
+    consumed.clear();
+    sourceIntact = true;
+  }
+
+  consumed += source->ReadAll();
+  source.reset();
+  contentBuffer.str(consumed);
+  consumed.clear();
+  consumed.shrink_to_fit();
+
+  inFile.rdbuf(&contentBuffer);
+  inFile.unsetf(std::ios::skipws);
 }
 
 void LoadCSV::CheckOpen()
 {
-  if (!inFile.is_open())
+  if (!isOpen)
   {
     std::ostringstream oss;
     oss << "Cannot open file '" << filename << "'. " << std::endl;
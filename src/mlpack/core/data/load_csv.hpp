@@ -18,12 +18,18 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/util/log.hpp>
 
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
 #include <set>
 #include <string>
 
 #include "extension.hpp"
 #include "format.hpp"
+#include "input_source.hpp"
 #include "dataset_mapper.hpp"
+#include "token_dictionary.hpp"
 
 namespace mlpack {
 namespace data {
@@ -38,7 +44,9 @@ class LoadCSV
  public:
   /**
    * Construct the LoadCSV object on the given file.  This will construct the
-   * rules necessary for loading and attempt to open the file.
+   * rules necessary for loading and attempt to open the file.  The file may be
+   * standard input ("-") or a compressed file, which is read with an
+   * InputSource; the format of standard input is guessed from its first line.
    */
   LoadCSV(const std::string& file);
 
@@ -58,12 +66,294 @@ class LoadCSV
   {
     CheckOpen();
 
+    // If every token in the file is a number, IncrementPolicy maps nothing and
+    // leaves every dimension numeric, so we can use the fast parser and skip
+    // the DatasetMapper entirely.
+    if (std::is_same<PolicyType, IncrementPolicy>::value &&
+        NumericParse(inout, transpose))
+    {
+      infoSet = DatasetMapper<PolicyType>(inout.n_rows);
+      return;
+    }
+
+    // Otherwise, files with categorical dimensions can still be parsed in
+    // parallel, as long as their tokens are simple.
+    if (std::is_same<PolicyType, IncrementPolicy>::value && transpose &&
+        CategoricalParse(inout, infoSet))
+      return;
+
     if (transpose)
       TransposeParse(inout, infoSet);
     else
       NonTransposeParse(inout, infoSet);
   }
 
+  /**
+   * Attempt to load the file into the given matrix, assuming that every token
+   * in the file is a number.  The whole file is read at once, split into
+   * chunks of lines, and the chunks are parsed in parallel (if OpenMP is
+   * available) straight into the matrix.  Standard input and compressed files
+   * are instead parsed in a single pass as they are read, one block at a time;
+   * see StreamParse().  Only tokens made of digits, signs, decimal points and
+   * exponents are accepted.  If the file contains anything else (including
+   * empty lines or lines with a differing number of tokens), false is returned
+   * and the contents of the matrix are unspecified; the file should then be
+   * loaded with Load() or ArmadilloLoad().
+   *
+   * @param inout Matrix to load into.
+   * @param transpose If true, each line of the file is a column of the matrix
+   *     (default).
+   * @return true if the file was loaded.
+   */
+  template<typename T>
+  bool NumericParse(arma::Mat<T>& inout, const bool transpose = true)
+  {
+    CheckOpen();
+
+    if (source)
+      return StreamParse(inout, transpose);
+
+    std::string buffer;
+    std::vector<const char*> chunkBegin;
+    std::vector<size_t> chunkLine;
+    if (!ReadChunks(buffer, chunkBegin, chunkLine))
+      return false;
+    const size_t numChunks = chunkBegin.size() - 1;
+
+    // Find the number of tokens on each line from the first line.
+    std::vector<T> firstLine;
+    const char* firstEnd = std::find(chunkBegin[0], chunkBegin[numChunks],
+        '\n');
+    if (!ParseNumericLine(chunkBegin[0], firstEnd, firstLine))
+      return false;
+    const size_t dimensionality = firstLine.size();
+
+    const size_t numLines = chunkLine[numChunks];
+    if (transpose)
+      inout.set_size(dimensionality, numLines);
+    else
+      inout.set_size(numLines, dimensionality);
+
+    return ParseNumericChunks(chunkBegin, chunkLine, dimensionality, inout,
+        transpose);
+  }
+
+  /**
+   * Load the file with Armadillo, as CSV data if its delimiter is a comma and
+   * as raw ASCII data otherwise.  The matrix is not transposed: each line of
+   * the file is a row.  This can be used for files that NumericParse() can't
+   * load, including standard input and compressed files, which are then read
+   * into memory first.
+   *
+   * @param inout Matrix to load into.
+   * @return true if the file was loaded.
+   */
+  template<typename T>
+  bool ArmadilloLoad(arma::Mat<T>& inout)
+  {
+    CheckOpen();
+    Rewind();
+    return inout.load(inFile, (delimiter == ',') ? arma::csv_ascii :
+        arma::raw_ascii);
+  }
+
+  /**
+   * Attempt to load the file into the given matrix (transposed, so each line is
+   * a point) in parallel, mapping the dimensions that are not numeric in the
+   * same way as IncrementPolicy does: a dimension is categorical if any of its
+   * tokens is not a number, and then every distinct token of the dimension is
+   * mapped to the next integer, in the order of the lines of the file.
+   *
+   * The file is read at once and split into chunks of lines, as in
+   * NumericParse().  The chunks are parsed in parallel twice: first to find
+   * the categorical dimensions and parse the numeric ones, and then to give the
+   * tokens of each categorical dimension ids in a TokenDictionary of the chunk,
+   * which points into the buffer, so tokens are never copied.  The
+   * dictionaries of the chunks are then merged in the order of the chunks, so
+   * the mappings are the same as the ones the regular parser creates, and
+   * finally the local ids are translated in parallel.
+   *
+   * If the file contains anything the fast tokenizer does not handle (empty
+   * tokens, lines with a differing number of tokens, or characters that end a
+   * token without being a delimiter), false is returned, and the file should be
+   * loaded with the regular parser; the matrix is then unspecified, but the
+   * DatasetMapper is not modified.
+   *
+   * @param inout Matrix to load into.
+   * @param infoSet DatasetMapper to fill with the mappings; it is replaced.
+   * @return true if the file was loaded.
+   */
+  template<typename T, typename PolicyType>
+  bool CategoricalParse(arma::Mat<T>& inout,
+                        DatasetMapper<PolicyType>& infoSet)
+  {
+    CheckOpen();
+
+    std::string buffer;
+    std::vector<const char*> chunkBegin;
+    std::vector<size_t> chunkLine;
+    if (!ReadChunks(buffer, chunkBegin, chunkLine))
+      return false;
+    const size_t numChunks = chunkBegin.size() - 1;
+
+    // Find the number of tokens on each line from the first line.
+    using TokenType = std::pair<const char*, const char*>;
+    std::vector<TokenType> tokens;
+    const char* firstEnd = std::find(chunkBegin[0], chunkBegin[numChunks],
+        '\n');
+    if (!TokenizeLine(chunkBegin[0], firstEnd, tokens))
+      return false;
+    const size_t dimensionality = tokens.size();
+
+    const size_t numLines = chunkLine[numChunks];
+    inout.set_size(dimensionality, numLines);
+
+    // First pass: parse the numbers, and find the dimensions with tokens that
+    // are not numbers.  Once a dimension is known to be categorical in a
+    // chunk, its tokens are not looked at anymore.
+    std::vector<std::vector<char>> chunkCategorical(numChunks,
+        std::vector<char>(dimensionality, 0));
+    bool success = true;
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(static) reduction(&&:success)
+    for (intmax_t i = 0; i < (intmax_t) numChunks; ++i)
+#else
+    #pragma omp parallel for schedule(static) reduction(&&:success)
+    for (size_t i = 0; i < numChunks; ++i)
+#endif
+    {
+      std::vector<TokenType> lineTokens;
+      lineTokens.reserve(dimensionality);
+      std::vector<char>& categorical = chunkCategorical[i];
+
+      size_t line = chunkLine[i];
+      const char* lineBegin = chunkBegin[i];
+      while (success && lineBegin < chunkBegin[i + 1])
+      {
+        const char* lineEnd = std::find(lineBegin, chunkBegin[i + 1], '\n');
+        if (!TokenizeLine(lineBegin, lineEnd, lineTokens) ||
+            lineTokens.size() != dimensionality)
+        {
+          success = false;
+          break;
+        }
+
+        for (size_t d = 0; d < dimensionality; ++d)
+        {
+          if (!categorical[d] && !ReadToken(lineTokens[d].first,
+              lineTokens[d].second, inout(d, line)))
+            categorical[d] = 1;
+        }
+
+        ++line;
+        lineBegin = lineEnd + 1;
+      }
+    }
+
+    if (!success)
+      return false;
+
+    // Collect the categorical dimensions.
+    std::vector<size_t> categoricalDims;
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      for (size_t i = 0; i < numChunks; ++i)
+      {
+        if (chunkCategorical[i][d])
+        {
+          categoricalDims.push_back(d);
+          break;
+        }
+      }
+    }
+    const size_t numCategorical = categoricalDims.size();
+
+    // Second pass: give the tokens of each categorical dimension ids local to
+    // the chunk.
+    std::vector<std::vector<TokenDictionary>> chunkDictionaries(numChunks,
+        std::vector<TokenDictionary>(numCategorical));
+    arma::Mat<size_t> localIds(numCategorical, numLines);
+#ifdef _WIN32
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) numChunks; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numChunks; ++i)
+#endif
+    {
+      std::vector<TokenType> lineTokens;
+      lineTokens.reserve(dimensionality);
+      std::vector<TokenDictionary>& dictionaries = chunkDictionaries[i];
+
+      size_t line = chunkLine[i];
+      const char* lineBegin = chunkBegin[i];
+      while (lineBegin < chunkBegin[i + 1])
+      {
+        const char* lineEnd = std::find(lineBegin, chunkBegin[i + 1], '\n');
+        TokenizeLine(lineBegin, lineEnd, lineTokens);
+        for (size_t c = 0; c < numCategorical; ++c)
+        {
+          const TokenType& token = lineTokens[categoricalDims[c]];
+          localIds(c, line) = dictionaries[c].Insert(token.first,
+              token.second - token.first);
+        }
+
+        ++line;
+        lineBegin = lineEnd + 1;
+      }
+    }
+
+    // Merge the dictionaries in the order of the chunks, so that each token
+    // gets the id of its first occurrence in the file, and fill the mappings.
+    DatasetMapper<PolicyType> info(dimensionality);
+    std::vector<std::vector<std::vector<size_t>>> translation(numChunks,
+        std::vector<std::vector<size_t>>(numCategorical));
+    for (size_t c = 0; c < numCategorical; ++c)
+    {
+      const size_t d = categoricalDims[c];
+      info.Type(d) = Datatype::categorical;
+
+      TokenDictionary global;
+      for (size_t i = 0; i < numChunks; ++i)
+      {
+        const TokenDictionary& local = chunkDictionaries[i][c];
+        std::vector<size_t>& ids = translation[i][c];
+        ids.resize(local.Size());
+        for (size_t id = 0; id < local.Size(); ++id)
+          ids[id] = global.Insert(local.Begin(id), local.Length(id));
+      }
+
+      // Tokens are mapped in the order of their ids, so MapString() gives each
+      // one its id.
+      for (size_t id = 0; id < global.Size(); ++id)
+        info.template MapString<T>(global.Token(id), d);
+    }
+
+    // Finally, store the ids in the matrix.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) numChunks; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numChunks; ++i)
+#endif
+    {
+      for (size_t line = chunkLine[i]; line < chunkLine[i + 1]; ++line)
+      {
+        for (size_t c = 0; c < numCategorical; ++c)
+        {
+          inout(categoricalDims[c], line) =
+              T(translation[i][c][localIds(c, line)]);
+        }
+      }
+    }
+
+    infoSet = std::move(info);
+    return true;
+  }
+
   /**
    * Peek at the file to determine the number of rows and columns in the matrix,
    * assuming a non-transposed matrix.  This will also take a first pass over
@@ -85,8 +375,7 @@ class LoadCSV
     // categorical.
 
     // Reset to the start of the file.
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
+    Rewind();
     rows = 0;
     cols = 0;
 
@@ -99,8 +388,7 @@ class LoadCSV
     info = DatasetMapper<MapPolicy>(rows);
 
     // Now, jump back to the beginning of the file.
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
+    Rewind();
     rows = 0;
 
     while (std::getline(inFile, line))
@@ -160,8 +448,7 @@ class LoadCSV
     // categorical.
 
     // Reset to the start of the file.
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
+    Rewind();
     rows = 0;
     cols = 0;
 
@@ -207,6 +494,494 @@ class LoadCSV
  private:
   using iter_type = boost::iterator_range<std::string::iterator>;
 
+  /**
+   * Read the whole file into the given buffer and split it into chunks of
+   * lines, one per OpenMP thread.  Chunk i holds the lines that start in
+   * [chunkBegin[i], chunkBegin[i + 1]), and its first line is line number
+   * chunkLine[i] of the file; chunkLine.back() is the number of lines.
+   * Return false if the file is empty or cannot be read.
+   */
+  bool ReadChunks(std::string& buffer,
+                  std::vector<const char*>& chunkBegin,
+                  std::vector<size_t>& chunkLine)
+  {
+    // Read the whole file.
+    ReadSource();
+    inFile.clear();
+    inFile.seekg(0, std::ios::end);
+    const std::streamoff fileSize = inFile.tellg();
+    inFile.seekg(0, std::ios::beg);
+    if (fileSize <= 0)
+      return false;
+
+    buffer.assign(fileSize, '\0');
+    inFile.read(&buffer[0], fileSize);
+    if (inFile.gcount() != fileSize)
+      return false;
+
+    SplitChunks(buffer.data(), buffer.data() + buffer.size(), chunkBegin,
+        chunkLine);
+    return true;
+  }
+
+  /**
+   * Split the non-empty text [data, dataEnd) into chunks of lines, one per
+   * OpenMP thread, as described for ReadChunks().
+   */
+  static void SplitChunks(const char* data,
+                          const char* dataEnd,
+                          std::vector<const char*>& chunkBegin,
+                          std::vector<size_t>& chunkLine)
+  {
+#ifdef HAS_OPENMP
+    const size_t numChunks = omp_get_max_threads();
+#else
+    const size_t numChunks = 1;
+#endif
+    const size_t size = dataEnd - data;
+
+    // Split the buffer into chunks that start at the beginning of a line, and
+    // count the lines in each chunk.
+    chunkBegin.assign(numChunks + 1, dataEnd);
+    chunkBegin[0] = data;
+    for (size_t i = 1; i < numChunks; ++i)
+    {
+      const char* guess = std::max(chunkBegin[i - 1],
+          data + (size * i) / numChunks);
+      const char* newline = std::find(guess, dataEnd, '\n');
+      chunkBegin[i] = (newline == dataEnd) ? dataEnd : newline + 1;
+    }
+
+    chunkLine.assign(numChunks + 1, 0);
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+      chunkLine[i + 1] = chunkLine[i] +
+          std::count(chunkBegin[i], chunkBegin[i + 1], '\n');
+    }
+    // The last line may not end with a newline.
+    if (*(dataEnd - 1) != '\n')
+      ++chunkLine[numChunks];
+  }
+
+  /**
+   * Parse the numbers of the given chunks of lines (from SplitChunks()) in
+   * parallel into the given matrix, which must already have the right size:
+   * line i goes to column i if transpose is true, and to row i otherwise.
+   * Return false if a line holds anything other than dimensionality numbers.
+   */
+  template<typename T>
+  bool ParseNumericChunks(const std::vector<const char*>& chunkBegin,
+                          const std::vector<size_t>& chunkLine,
+                          const size_t dimensionality,
+                          arma::Mat<T>& inout,
+                          const bool transpose) const
+  {
+    const size_t numChunks = chunkBegin.size() - 1;
+
+    // Exceptions can't leave the parallel region, and there is no point in
+    // reporting an error here anyway: we just fall back to the regular parser.
+    bool success = true;
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(static) reduction(&&:success)
+    for (intmax_t i = 0; i < (intmax_t) numChunks; ++i)
+#else
+    #pragma omp parallel for schedule(static) reduction(&&:success)
+    for (size_t i = 0; i < numChunks; ++i)
+#endif
+    {
+      std::vector<T> values;
+      values.reserve(dimensionality);
+
+      size_t line = chunkLine[i];
+      const char* lineBegin = chunkBegin[i];
+      while (success && lineBegin < chunkBegin[i + 1])
+      {
+        const char* lineEnd = std::find(lineBegin, chunkBegin[i + 1], '\n');
+        if (!ParseNumericLine(lineBegin, lineEnd, values) ||
+            values.size() != dimensionality)
+        {
+          success = false;
+          break;
+        }
+
+        if (transpose)
+          std::copy(values.begin(), values.end(), inout.colptr(line));
+        else
+          for (size_t d = 0; d < dimensionality; ++d)
+            inout(line, d) = values[d];
+
+        ++line;
+        lineBegin = lineEnd + 1;
+      }
+    }
+
+    return success;
+  }
+
+  /**
+   * Parse the source (standard input or a compressed file) as NumericParse()
+   * does, but in a single pass: the source is read in blocks of about
+   * blockSize bytes that end at the end of a line, each block is parsed in
+   * parallel into its own columns as soon as it is read, and the columns of
+   * the blocks are joined at the end.  So the text of the file is never held in
+   * memory as a whole, and neither decompression nor parsing have to wait for
+   * the whole file.  If the file can't be loaded this way (see NumericParse()),
+   * false is returned, and the source is then read again (or, for standard
+   * input, from the bytes kept while parsing) by the other parsers.
+   */
+  template<typename T>
+  bool StreamParse(arma::Mat<T>& inout,
+                   const bool transpose,
+                   const size_t blockSize = (1 << 22))
+  {
+    // Standard input can't be read again, so keep everything read from it in
+    // case another parser has to be used.  Other sources are just reopened.
+    const bool keep = !source->Reopenable();
+    if (!keep)
+      sourceIntact = false;
+
+    std::vector<arma::Mat<T>> blocks;
+    size_t dimensionality = 0;
+    size_t numLines = 0;
+    std::string block;
+    std::string carry = consumed; // The start of the file, if it was guessed.
+    std::vector<const char*> chunkBegin;
+    std::vector<size_t> chunkLine;
+    bool end = false;
+    while (!end)
+    {
+      // Fill the block with the partial line left from the last block and
+      // then new bytes.
+      block.swap(carry);
+      carry.clear();
+      do
+      {
+        const size_t oldSize = block.size();
+        block.resize(std::max(blockSize, oldSize + (blockSize >> 4)));
+        const size_t read = source->Read(&block[oldSize], block.size() -
+            oldSize);
+        block.resize(oldSize + read);
+        if (read == 0)
+          end = true;
+        else if (keep)
+          consumed.append(block, oldSize, read);
+      } while (!end && block.size() < blockSize);
+
+      // Leave a partial last line for the next block.
+      size_t blockEnd = block.size();
+      if (!end)
+      {
+        const size_t lastNewline = block.rfind('\n');
+        if (lastNewline == std::string::npos)
+        {
+          carry.swap(block);
+          continue;
+        }
+
+        blockEnd = lastNewline + 1;
+        carry.assign(block, blockEnd, std::string::npos);
+      }
+      if (blockEnd == 0)
+        continue;
+
+      const char* data = block.data();
+      SplitChunks(data, data + blockEnd, chunkBegin, chunkLine);
+      if (dimensionality == 0)
+      {
+        // Find the number of tokens on each line from the first line.
+        std::vector<T> firstLine;
+        if (!ParseNumericLine(data, std::find(data, data + blockEnd, '\n'),
+            firstLine))
+          return false;
+        dimensionality = firstLine.size();
+      }
+
+      blocks.push_back(arma::Mat<T>(dimensionality, chunkLine.back()));
+      if (!ParseNumericChunks(chunkBegin, chunkLine, dimensionality,
+          blocks.back(), true))
+        return false;
+      numLines += chunkLine.back();
+    }
+
+    if (numLines == 0)
+      return false;
+
+    // Join the blocks, freeing each one once it is copied.
+    if (transpose)
+      inout.set_size(dimensionality, numLines);
+    else
+      inout.set_size(numLines, dimensionality);
+    size_t line = 0;
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+      if (transpose)
+        inout.cols(line, line + blocks[i].n_cols - 1) = blocks[i];
+      else
+        inout.rows(line, line + blocks[i].n_cols - 1) = blocks[i].t();
+      line += blocks[i].n_cols;
+      blocks[i].reset();
+    }
+
+    consumed.clear();
+    consumed.shrink_to_fit();
+    return true;
+  }
+
+  /**
+   * If the file is read from a source, read all of it into memory (reopening
+   * it first if some of it was read and not kept), so that the stream of the
+   * file can be seeked.
+   */
+  void ReadSource();
+
+  //! Go back to the start of the stream of the file.
+  void Rewind()
+  {
+    ReadSource();
+    inFile.clear();
+    inFile.seekg(0, std::ios::beg);
+  }
+
+  //! Guess the format of the source from its first line, which is kept.
+  std::string GuessFormat();
+
+  //! Set the parsing rules and the delimiter for the extension of the file.
+  void SetRules();
+
+  //! Convert the token [begin, end) to a number with the C library.  Return
+  //! false if the token is not exactly one number in range.
+  static bool ParseNumber(const char* begin, const char* end, float& value)
+  {
+    char* numberEnd;
+    errno = 0;
+    value = std::strtof(begin, &numberEnd);
+    return (numberEnd == end && errno == 0);
+  }
+
+  //! Convert the token [begin, end) to a number with the C library.  Return
+  //! false if the token is not exactly one number in range.
+  static bool ParseNumber(const char* begin, const char* end, double& value)
+  {
+    char* numberEnd;
+    errno = 0;
+    value = std::strtod(begin, &numberEnd);
+    return (numberEnd == end && errno == 0);
+  }
+
+  //! Convert the token [begin, end) to a number with the C library.  Return
+  //! false if the token is not exactly one number in range.
+  static bool ParseNumber(const char* begin,
+                          const char* end,
+                          long double& value)
+  {
+    char* numberEnd;
+    errno = 0;
+    value = std::strtold(begin, &numberEnd);
+    return (numberEnd == end && errno == 0);
+  }
+
+  //! Convert the token [begin, end) to a signed integer.  Return false if the
+  //! token is not exactly one integer in the range of T.
+  template<typename T>
+  static bool ParseNumber(
+      const char* begin,
+      const char* end,
+      T& value,
+      const typename std::enable_if_t<std::is_integral<T>::value &&
+          std::is_signed<T>::value>* = 0)
+  {
+    char* numberEnd;
+    errno = 0;
+    const long long result = std::strtoll(begin, &numberEnd, 10);
+    if (numberEnd != end || errno != 0 ||
+        result < (long long) std::numeric_limits<T>::min() ||
+        result > (long long) std::numeric_limits<T>::max())
+      return false;
+
+    value = (T) result;
+    return true;
+  }
+
+  //! Convert the token [begin, end) to an unsigned integer.  Return false if
+  //! the token is not exactly one non-negative integer in the range of T.
+  template<typename T>
+  static bool ParseNumber(
+      const char* begin,
+      const char* end,
+      T& value,
+      const typename std::enable_if_t<std::is_integral<T>::value &&
+          !std::is_signed<T>::value>* = 0)
+  {
+    // strtoull() would silently negate negative numbers.
+    if (*begin == '-')
+      return false;
+
+    char* numberEnd;
+    errno = 0;
+    const unsigned long long result = std::strtoull(begin, &numberEnd, 10);
+    if (numberEnd != end || errno != 0 ||
+        result > (unsigned long long) std::numeric_limits<T>::max())
+      return false;
+
+    value = (T) result;
+    return true;
+  }
+
+  /**
+   * Parse the numbers of the line [begin, end) (which does not contain the
+   * newline) into the given vector, without allocating memory for each token.
+   * Whitespace around the line is ignored, as in the regular parser.  Return
+   * false if the line holds anything other than numbers separated by the
+   * delimiter of the file.
+   */
+  template<typename T>
+  bool ParseNumericLine(const char* begin,
+                        const char* end,
+                        std::vector<T>& values) const
+  {
+    values.clear();
+
+    // Trim the line.
+    while (begin < end && std::isspace((unsigned char) *begin))
+      ++begin;
+    while (end > begin && std::isspace((unsigned char) *(end - 1)))
+      --end;
+    if (begin == end)
+      return false;
+
+    const char* p = begin;
+    while (true)
+    {
+      // Only accept the characters that can be in a decimal number, so that
+      // things like "nan", "inf" or hexadecimal numbers (which the regular
+      // parser would map as strings) are rejected.
+      const char* tokenEnd = p;
+      while (tokenEnd < end && (std::isdigit((unsigned char) *tokenEnd) ||
+          *tokenEnd == '.' ||
+          *tokenEnd == '-' || *tokenEnd == '+' || *tokenEnd == 'e' ||
+          *tokenEnd == 'E'))
+        ++tokenEnd;
+
+      T value;
+      if (tokenEnd == p || !ParseNumber(p, tokenEnd, value))
+        return false;
+      values.push_back(value);
+
+      p = tokenEnd;
+      if (p == end)
+        return true;
+
+      // Now skip the delimiter.
+      if (delimiter == ' ')
+      {
+        if (*p != ' ')
+          return false;
+        while (p < end && *p == ' ')
+          ++p;
+      }
+      else
+      {
+        while (p < end && *p == ' ')
+          ++p;
+        if (p == end || *p != delimiter)
+          return false;
+        ++p;
+        while (p < end && *p == ' ')
+          ++p;
+      }
+    }
+  }
+
+  /**
+   * Split the line [begin, end) (which does not contain the newline) into its
+   * tokens, as pairs of pointers, in the same way as the regular parser:
+   * whitespace around the line and around the delimiters is ignored.  Return
+   * false if the line is empty, has an empty token, or has a character that
+   * would end a token in the regular parser without being the delimiter of the
+   * file.
+   */
+  bool TokenizeLine(const char* begin,
+                    const char* end,
+                    std::vector<std::pair<const char*, const char*>>& tokens)
+      const
+  {
+    tokens.clear();
+
+    // Trim the line.
+    while (begin < end && std::isspace((unsigned char) *begin))
+      ++begin;
+    while (end > begin && std::isspace((unsigned char) *(end - 1)))
+      --end;
+    if (begin == end)
+      return false;
+
+    // The characters that end a token in the regular parser.
+    const char separator = (delimiter == '\t') ? '\t' : ',';
+
+    const char* p = begin;
+    while (true)
+    {
+      const char* tokenEnd = p;
+      while (tokenEnd < end && *tokenEnd != ' ' && *tokenEnd != separator &&
+          *tokenEnd != '\r')
+        ++tokenEnd;
+
+      if (tokenEnd == p)
+        return false;
+      tokens.push_back(std::make_pair(p, tokenEnd));
+
+      p = tokenEnd;
+      if (p == end)
+        return true;
+
+      // Now skip the delimiter.
+      if (delimiter == ' ')
+      {
+        if (*p != ' ')
+          return false;
+        while (p < end && *p == ' ')
+          ++p;
+      }
+      else
+      {
+        while (p < end && *p == ' ')
+          ++p;
+        if (p == end || *p != delimiter)
+          return false;
+        ++p;
+        while (p < end && *p == ' ')
+          ++p;
+      }
+    }
+  }
+
+  /**
+   * Read the token [begin, end) as a number, and return whether it is one in
+   * the sense of IncrementPolicy (which reads it with a std::stringstream).
+   * Tokens made of the characters of decimal numbers are converted with the C
+   * library; anything else goes through a std::stringstream, as in
+   * IncrementPolicy.
+   */
+  template<typename T>
+  static bool ReadToken(const char* begin, const char* end, T& value)
+  {
+    bool decimal = true;
+    for (const char* p = begin; p < end && decimal; ++p)
+    {
+      decimal = std::isdigit((unsigned char) *p) || *p == '.' || *p == '-' ||
+          *p == '+' || *p == 'e' || *p == 'E';
+    }
+    if (decimal && ParseNumber(begin, end, value))
+      return true;
+
+    std::stringstream token;
+    token.str(std::string(begin, end));
+    token >> value;
+    return !token.fail() && token.eof();
+  }
+
   /**
    * Check whether or not the file has successfully opened; throw an exception
    * if not.
@@ -236,8 +1011,7 @@ class LoadCSV
 
     // Reset file position.
     std::string line;
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
+    Rewind();
 
     auto setCharClass = [&](iter_type const &iter)
     {
@@ -305,8 +1079,7 @@ class LoadCSV
     size_t row = 0;
     size_t col = 0;
     std::string line;
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
+    Rewind();
 
     /**
      * This is the parse rule for strings.  When we get a string we have to pass
@@ -362,12 +1135,29 @@ class LoadCSV
   //! Spirit rule for delimiters (i.e. ',' for CSVs).
   boost::spirit::qi::rule<std::string::iterator, iter_type()> delimiterRule;
 
+  //! Delimiter between tokens used by NumericParse() (' ' matches any number
+  //! of spaces).
+  char delimiter;
+
   //! Extension (type) of file.
   std::string extension;
   //! Name of file.
   std::string filename;
-  //! Opened stream for reading.
-  std::ifstream inFile;
+  //! Buffer of the file, if it is a regular file.
+  std::filebuf fileBuffer;
+  //! Buffer of the contents of the source, once they are read into memory.
+  std::stringbuf contentBuffer;
+  //! Opened stream for reading, over one of the buffers.
+  std::istream inFile;
+  //! Whether the file was opened.
+  bool isOpen;
+  //! The source of the file, if it is standard input or compressed, until its
+  //! contents are read into contentBuffer.
+  std::unique_ptr<InputSource> source;
+  //! The bytes read from the source that were kept.
+  std::string consumed;
+  //! Whether consumed holds all the bytes read from the source.
+  bool sourceIntact;
 };
 
 } // namespace data
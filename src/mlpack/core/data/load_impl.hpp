@@ -16,11 +16,15 @@
 
 #include <exception>
 #include <algorithm>
+#include <iomanip>
+#include <mlpack/core/util/execution.hpp>
 #include <mlpack/core/util/timers.hpp>
 
 #include "load_csv.hpp"
 #include "load.hpp"
 #include "extension.hpp"
+#include "input_source.hpp"
+#include "binary_matrix.hpp"
 
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/tokenizer.hpp>
@@ -66,13 +70,31 @@ void TransposeTokens(std::vector<std::vector<std::string>> const &input,
 template<typename eT>
 bool inline inplace_transpose(arma::Mat<eT>& X)
 {
+  // Vectors are stored the same way either way, so only the size changes, and
+  // square matrices can be transposed in place by swapping elements.
+  if (X.n_rows == 1 || X.n_cols == 1)
+  {
+    X.set_size(X.n_cols, X.n_rows);
+    return false;
+  }
+  else if (X.n_rows == X.n_cols)
+  {
+    arma::inplace_trans(X);
+    return false;
+  }
+
+  // The matrix is only counted by the memory tracker once it is loaded, so
+  // count it here along with its transposed copy.
+  MLPACK_TRACK_ALLOC(2 * MemoryTracker::Bytes(X));
   try
   {
     X = arma::trans(X);
+    MLPACK_TRACK_FREE(2 * MemoryTracker::Bytes(X));
     return false;
   }
   catch (std::bad_alloc&)
   {
+    MLPACK_TRACK_FREE(2 * MemoryTracker::Bytes(X));
 #if (ARMA_VERSION_MAJOR >= 4) || \
     ((ARMA_VERSION_MAJOR == 3) && (ARMA_VERSION_MINOR >= 930))
     arma::inplace_trans(X, "lowmem");
@@ -86,6 +108,131 @@ bool inline inplace_transpose(arma::Mat<eT>& X)
   }
 }
 
+namespace details {
+
+/**
+ * Load an Armadillo binary matrix of element type eT from the given stream,
+ * transposed, without holding the untransposed matrix: the columns of the file
+ * are read a block at a time and written as rows of the matrix.  If the stream
+ * does not hold an Armadillo binary matrix of element type eT, the stream is
+ * rewound and false is returned, so that Armadillo can load the file (and
+ * report any error).
+ */
+template<typename eT>
+bool LoadArmaBinaryTransposed(std::istream& stream, arma::Mat<eT>& matrix)
+{
+  // The header is "ARMA_MAT_BIN_" followed by the kind and size of the element
+  // type, such as "FN008" for double; then the size and the elements follow.
+  std::ostringstream expected;
+  expected << "ARMA_MAT_BIN_" << (std::is_floating_point<eT>::value ? "FN" :
+      (std::is_signed<eT>::value ? "IS" : "IU")) << std::setfill('0')
+      << std::setw(3) << sizeof(eT);
+
+  const std::streampos start = stream.tellg();
+  std::string header;
+  size_t rows = 0, cols = 0;
+  stream >> header >> rows >> cols;
+  if (!stream || header != expected.str() ||
+      !std::is_arithmetic<eT>::value)
+  {
+    stream.clear();
+    stream.seekg(start);
+    return false;
+  }
+  stream.get(); // Skip the newline after the size.
+
+  matrix.set_size(cols, rows);
+  if (matrix.n_elem == 0)
+    return true;
+
+  // Blocks of about a megabyte keep the block well inside the cache while it
+  // is transposed.
+  const size_t blockCols = std::max((size_t) 1,
+      (size_t) (1 << 20) / (rows * sizeof(eT)));
+  arma::Mat<eT> block(rows, std::min(blockCols, cols));
+  for (size_t c = 0; c < cols; c += block.n_cols)
+  {
+    const size_t count = std::min((size_t) block.n_cols, cols - c);
+    const std::streamsize bytes = count * rows * sizeof(eT);
+    stream.read(reinterpret_cast<char*>(block.memptr()), bytes);
+    if (stream.gcount() != bytes)
+    {
+      matrix.reset();
+      stream.clear();
+      stream.seekg(start);
+      return false;
+    }
+
+    matrix.rows(c, c + count - 1) = arma::trans(block.cols(0, count - 1));
+  }
+
+  return true;
+}
+
+/**
+ * Load a matrix from standard input or from a compressed file, which must hold
+ * text (CSV, TSV or numbers separated by spaces).  LoadCSV parses numeric text
+ * in a single pass as it is read; anything else is read into memory and loaded
+ * by Armadillo.  The "loading_data" timer must be running; it is stopped.
+ */
+template<typename eT>
+bool LoadStream(const std::string& filename,
+                arma::Mat<eT>& matrix,
+                const bool fatal,
+                const bool transpose)
+{
+  const std::string extension = InputSource::FormatExtension(filename);
+  std::string error;
+  if (extension != "" && extension != "csv" && extension != "tsv" &&
+      extension != "txt")
+  {
+    error = "only CSV, TSV and text files can be read from standard input or "
+        "compressed files";
+  }
+  else
+  {
+    Log::Info << "Loading '" << filename << "' as text data.  " << std::flush;
+    try
+    {
+      LoadCSV loader(filename);
+      if (!loader.NumericParse(matrix, transpose))
+      {
+        if (!loader.ArmadilloLoad(matrix))
+          error = "the data could not be parsed";
+        else if (transpose)
+          inplace_transpose(matrix);
+      }
+    }
+    catch (std::exception& e)
+    {
+      error = e.what();
+    }
+  }
+
+  if (!error.empty())
+  {
+    Log::Info << std::endl;
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Loading from '" << filename << "' failed: " << error
+          << std::endl;
+    else
+      Log::Warn << "Loading from '" << filename << "' failed: " << error
+          << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
+      << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
+  MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(matrix));
+  util::Execution::Place(matrix);
+  Timer::Stop("loading_data");
+  return true;
+}
+
+} // namespace details
+
 template<typename eT>
 bool Load(const std::string& filename,
           arma::Mat<eT>& matrix,
@@ -94,6 +241,11 @@ bool Load(const std::string& filename,
 {
   Timer::Start("loading_data");
 
+  // Standard input and compressed files can't be seeked, so they are parsed
+  // as they are read.
+  if (InputSource::IsStream(filename))
+    return details::LoadStream(filename, matrix, fatal, transpose);
+
   // Get the extension.
   std::string extension = Extension(filename);
 
@@ -220,6 +372,36 @@ bool Load(const std::string& filename,
       loadType = arma::raw_binary;
     }
   }
+  else if (extension == "mlbin")
+  {
+    // mlpack binary files hold the matrix exactly as it is stored in memory, so
+    // they are never transposed.
+    Log::Info << "Loading '" << filename << "' as mlpack binary formatted "
+        << "data.  " << std::flush;
+    try
+    {
+      LoadBinaryMatrix(stream, matrix);
+    }
+    catch (std::exception& e)
+    {
+      Log::Info << std::endl;
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << "Loading from '" << filename << "' failed: " << e.what()
+            << std::endl;
+      else
+        Log::Warn << "Loading from '" << filename << "' failed: " << e.what()
+            << std::endl;
+
+      return false;
+    }
+
+    Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols << ".\n";
+    MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(matrix));
+    util::Execution::Place(matrix);
+    Timer::Stop("loading_data");
+    return true;
+  }
   else if (extension == "pgm")
   {
     loadType = arma::pgm_binary;
@@ -290,6 +472,44 @@ bool Load(const std::string& filename,
     Log::Info << "Loading '" << filename << "' as " << stringType << ".  "
         << std::flush;
 
+  // Numeric text files can be loaded much faster by our own parser, which also
+  // produces the transposed matrix directly.  If the file turns out to hold
+  // anything unusual, we let Armadillo handle it.
+  if ((loadType == arma::csv_ascii && extension == "csv") ||
+      (loadType == arma::raw_ascii && extension != "csv"))
+  {
+    try
+    {
+      LoadCSV loader(filename);
+      if (loader.NumericParse(matrix, transpose))
+      {
+        Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
+            << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
+        MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(matrix));
+        util::Execution::Place(matrix);
+        Timer::Stop("loading_data");
+        return true;
+      }
+    }
+    catch (std::exception&)
+    {
+      // Fall back to Armadillo, which will report the error.
+    }
+  }
+
+  // Armadillo binary files are written untransposed, so read them straight
+  // into the transposed matrix instead of transposing a second copy.
+  if (loadType == arma::arma_binary && transpose &&
+      details::LoadArmaBinaryTransposed(stream, matrix))
+  {
+    Log::Info << "Size is " << matrix.n_cols << " x " << matrix.n_rows
+        << ".\n";
+    MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(matrix));
+    util::Execution::Place(matrix);
+    Timer::Stop("loading_data");
+    return true;
+  }
+
   // We can't use the stream if the type is HDF5.
   bool success;
   if (loadType != arma::hdf5_binary)
@@ -323,6 +543,8 @@ bool Load(const std::string& filename,
     inplace_transpose(matrix);
   }
 
+  MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(matrix));
+  util::Execution::Place(matrix);
   Timer::Stop("loading_data");
 
   // Finally, return the success indicator.
@@ -340,14 +562,42 @@ bool Load(const std::string& filename,
   // Get the extension and load as necessary.
   Timer::Start("loading_data");
 
-  // Get the extension.
-  std::string extension = Extension(filename);
+  // Get the extension.  Standard input and compressed files are read by
+  // LoadCSV, so their format is given by the extension before the compression
+  // extension (or, for standard input, by the contents).
+  const bool isStream = InputSource::IsStream(filename);
+  std::string extension = InputSource::FormatExtension(filename);
+  if (isStream && extension == "")
+    extension = "csv";
 
   // Catch nonexistent files by opening the stream ourselves.
   std::fstream stream;
-  stream.open(filename.c_str(), std::fstream::in);
+  if (!isStream)
+  {
+#ifdef  _WIN32 // Always open in binary mode on Windows.
+    stream.open(filename.c_str(), std::fstream::in | std::fstream::binary);
+#else
+    stream.open(filename.c_str(), std::fstream::in);
+#endif
+  }
 
-  if (!stream.is_open())
+  if (isStream && extension != "csv" && extension != "tsv" &&
+      extension != "txt")
+  {
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Cannot load '" << filename << "': only CSV, TSV and text "
+          << "files can be read from standard input or compressed files."
+          << std::endl;
+    else
+      Log::Warn << "Cannot load '" << filename << "': only CSV, TSV and text "
+          << "files can be read from standard input or compressed files."
+          << std::endl;
+
+    return false;
+  }
+
+  if (!isStream && !stream.is_open())
   {
     Timer::Stop("loading_data");
     if (fatal)
@@ -401,6 +651,33 @@ bool Load(const std::string& filename,
       return false;
     }
   }
+  else if (extension == "mlbin")
+  {
+    // The matrix is stored exactly as it is held in memory, so it is never
+    // transposed.
+    Log::Info << "Loading '" << filename << "' as mlpack binary dataset.  "
+        << std::flush;
+    try
+    {
+      LoadBinaryMatrix(stream, matrix, &info);
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+
+    Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols << ".\n";
+    MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(matrix));
+    util::Execution::Place(matrix);
+    Timer::Stop("loading_data");
+    return true;
+  }
   else
   {
     // The type is unknown.
@@ -418,6 +695,8 @@ bool Load(const std::string& filename,
   Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
       << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
 
+  MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(matrix));
+  util::Execution::Place(matrix);
   Timer::Stop("loading_data");
 
   return true;
@@ -0,0 +1,114 @@
+/**
+ * @file load_mapped_impl.hpp
+ *
+ * Implementation of the Load() overloads defined in load.hpp that memory-map
+ * an mlpack binary matrix or model file.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LOAD_MAPPED_IMPL_HPP
+#define MLPACK_CORE_DATA_LOAD_MAPPED_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "load.hpp"
+#include "extension.hpp"
+
+#include <mlpack/core/util/timers.hpp>
+
+namespace mlpack {
+namespace data {
+
+// Map an mlpack binary matrix file.
+template<typename eT>
+bool Load(const std::string& filename,
+          MappedMatrix<eT>& matrix,
+          const bool fatal)
+{
+  Timer::Start("loading_data");
+
+  if (Extension(filename) != "mlbin")
+  {
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Cannot map '" << filename << "': only mlpack binary "
+          << "files (.mlbin) can be memory-mapped." << std::endl;
+    else
+      Log::Warn << "Cannot map '" << filename << "': only mlpack binary "
+          << "files (.mlbin) can be memory-mapped; load failed." << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Mapping '" << filename << "' as mlpack binary formatted data.  "
+      << std::flush;
+  try
+  {
+    matrix.Map(filename);
+  }
+  catch (std::exception& e)
+  {
+    Log::Info << std::endl;
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Loading from '" << filename << "' failed: " << e.what()
+          << std::endl;
+    else
+      Log::Warn << "Loading from '" << filename << "' failed: " << e.what()
+          << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Size is " << matrix.Matrix().n_rows << " x "
+      << matrix.Matrix().n_cols << ".\n";
+  Timer::Stop("loading_data");
+
+  return true;
+}
+
+// Map an mlpack binary model file.
+template<typename T>
+bool Load(const std::string& filename,
+          const std::string& name,
+          MappedModel<T>& model,
+          const bool fatal)
+{
+  if (Extension(filename) != "mlmodel")
+  {
+    if (fatal)
+      Log::Fatal << "Cannot map '" << filename << "': only mlpack binary "
+          << "model files (.mlmodel) can be memory-mapped." << std::endl;
+    else
+      Log::Warn << "Cannot map '" << filename << "': only mlpack binary "
+          << "model files (.mlmodel) can be memory-mapped; load failed."
+          << std::endl;
+
+    return false;
+  }
+
+  try
+  {
+    model.Map(filename, name);
+  }
+  catch (std::exception& e)
+  {
+    if (fatal)
+      Log::Fatal << "Loading '" << name << "' from '" << filename
+          << "' failed: " << e.what() << std::endl;
+    else
+      Log::Warn << "Loading '" << name << "' from '" << filename
+          << "' failed: " << e.what() << std::endl;
+
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -29,6 +29,7 @@
 #include <boost/algorithm/string.hpp>
 
 #include "serialization_shim.hpp"
+#include "binary_model.hpp"
 
 namespace mlpack {
 namespace data {
@@ -51,6 +52,8 @@ bool Load(const std::string& filename,
       f = format::binary;
     else if (extension == "txt")
       f = format::text;
+    else if (extension == "mlmodel")
+      f = format::binary_model;
     else
     {
       if (fatal)
@@ -67,7 +70,7 @@ bool Load(const std::string& filename,
   // Now load the given format.
   std::ifstream ifs;
 #ifdef _WIN32 // Open non-text in binary mode on Windows.
-  if (f == format::binary)
+  if (f == format::binary || f == format::binary_model)
     ifs.open(filename, std::ifstream::in | std::ifstream::binary);
   else
     ifs.open(filename, std::ifstream::in);
@@ -104,6 +107,10 @@ bool Load(const std::string& filename,
       boost::archive::binary_iarchive ar(ifs);
       ar >> CreateNVP(t, name);
     }
+    else if (f == format::binary_model)
+    {
+      LoadBinaryModel(ifs, name, t);
+    }
 
     return true;
   }
@@ -116,6 +123,17 @@ bool Load(const std::string& filename,
 
     return false;
   }
+  catch (std::runtime_error& e)
+  {
+    if (fatal)
+      Log::Fatal << "Loading from '" << filename << "' failed: " << e.what()
+          << std::endl;
+    else
+      Log::Warn << "Loading from '" << filename << "' failed: " << e.what()
+          << std::endl;
+
+    return false;
+  }
 }
 
 } // namespace data
@@ -0,0 +1,121 @@
+/**
+ * @file load_sparse_impl.hpp
+ *
+ * Implementation of the Load() overload for sparse matrices.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LOAD_SPARSE_IMPL_HPP
+#define MLPACK_CORE_DATA_LOAD_SPARSE_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "load.hpp"
+#include "extension.hpp"
+#include "load_arff.hpp"
+
+#include <mlpack/core/util/timers.hpp>
+
+namespace mlpack {
+namespace data {
+
+// Load a sparse matrix.
+template<typename eT>
+bool Load(const std::string& filename,
+          arma::SpMat<eT>& matrix,
+          const bool fatal,
+          const bool transpose)
+{
+  Timer::Start("loading_data");
+
+  const std::string extension = Extension(filename);
+
+  if (extension == "arff")
+  {
+    Log::Info << "Loading '" << filename << "' as sparse ARFF dataset.  "
+        << std::flush;
+    try
+    {
+      // The mappings of categorical dimensions are not kept.
+      DatasetInfo info;
+      LoadARFF(filename, matrix, info);
+    }
+    catch (std::exception& e)
+    {
+      Log::Info << std::endl;
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+
+    // ARFF datasets are loaded with one point per column.
+    if (!transpose)
+      matrix = matrix.t();
+
+    Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols << " ("
+        << matrix.n_nonzero << " non-zero elements).\n";
+    Timer::Stop("loading_data");
+    return true;
+  }
+
+  arma::file_type loadType;
+  std::string stringType;
+  if (extension == "txt" || extension == "coo")
+  {
+    loadType = arma::coord_ascii;
+    stringType = "coordinate list data";
+  }
+  else if (extension == "bin")
+  {
+    loadType = arma::arma_binary;
+    stringType = "Armadillo binary formatted data";
+  }
+  else
+  {
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Unable to detect type of '" << filename << "' as a sparse "
+          << "matrix; incorrect extension?" << std::endl;
+    else
+      Log::Warn << "Unable to detect type of '" << filename << "' as a sparse "
+          << "matrix; load failed. Incorrect extension?" << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Loading '" << filename << "' as " << stringType << ".  "
+      << std::flush;
+
+  if (!matrix.load(filename, loadType))
+  {
+    Log::Info << std::endl;
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Loading from '" << filename << "' failed." << std::endl;
+    else
+      Log::Warn << "Loading from '" << filename << "' failed." << std::endl;
+
+    return false;
+  }
+
+  // The points are stored as rows in the file; store them as columns.
+  if (transpose)
+    matrix = matrix.t();
+
+  Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols << " ("
+      << matrix.n_nonzero << " non-zero elements).\n";
+  Timer::Stop("loading_data");
+
+  return true;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
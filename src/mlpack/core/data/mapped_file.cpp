@@ -0,0 +1,80 @@
+/**
+ * @file mapped_file.cpp
+ *
+ * Implementation of MappedFile.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mapped_file.hpp"
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace mlpack {
+namespace data {
+
+MappedFile::MappedFile(const std::string& filename) :
+    data(NULL),
+    size(0),
+    mapped(false)
+{
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    throw std::runtime_error("cannot get size of file '" + filename + "'");
+  }
+
+  size = fileStat.st_size;
+  if (size == 0)
+  {
+    // Empty files can't be mapped.
+    close(fd);
+    data = contents.data();
+    return;
+  }
+
+  void* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping stays valid after the descriptor is closed.
+  if (base == MAP_FAILED)
+    throw std::runtime_error("cannot map file '" + filename + "'");
+
+  // The file is read from start to end.
+  madvise(base, size, MADV_SEQUENTIAL);
+  data = static_cast<const char*>(base);
+  mapped = true;
+#else
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  std::ostringstream oss;
+  oss << stream.rdbuf();
+  contents = oss.str();
+  data = contents.data();
+  size = contents.size();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+  if (mapped)
+    munmap(const_cast<char*>(data), size);
+#endif
+}
+
+} // namespace data
+} // namespace mlpack
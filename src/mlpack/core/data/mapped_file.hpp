@@ -0,0 +1,66 @@
+/**
+ * @file mapped_file.hpp
+ *
+ * A read-only view of the bytes of a file, memory-mapped where possible, for
+ * loaders that parse a whole text file at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_FILE_HPP
+#define MLPACK_CORE_DATA_MAPPED_FILE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * MappedFile maps a file into memory, so that it can be parsed in place
+ * without copying it, and only the pages that are read are loaded.  On systems
+ * without mmap() (i.e. Windows) the file is read into memory instead.  The
+ * bytes are not followed by a terminating null character.
+ */
+class MappedFile
+{
+ public:
+  /**
+   * Map the given file.  A std::runtime_error is thrown if it can't be opened
+   * or mapped.
+   *
+   * @param filename Name of the file to map.
+   */
+  MappedFile(const std::string& filename);
+
+  //! Release the mapping.
+  ~MappedFile();
+
+  //! Mappings cannot be copied.
+  MappedFile(const MappedFile&) = delete;
+  //! Mappings cannot be copied.
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  //! Get the first byte of the file.
+  const char* Begin() const { return data; }
+  //! Get the end of the file (one past the last byte).
+  const char* End() const { return data + size; }
+  //! Get the size of the file, in bytes.
+  size_t Size() const { return size; }
+
+ private:
+  //! The bytes of the file.
+  const char* data;
+  //! The size of the file.
+  size_t size;
+  //! The contents of the file, if it was read rather than mapped.
+  std::string contents;
+  //! Whether data is a mapping that must be released.
+  bool mapped;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -23,7 +23,12 @@ namespace data {
  * Given a set of labels of a particular datatype, convert them to unsigned
  * labels in the range [0, n) where n is the number of different labels.  Also,
  * a reverse mapping from the new label to the old value is stored in the
- * 'mapping' vector.
+ * 'mapping' vector.  The labels are numbered in the order of their first
+ * appearance.
+ *
+ * Label sets with many classes are normalized with a hash map, and large label
+ * sets are normalized in parallel, so the cost is linear in the number of
+ * labels.
  *
  * @param labelsIn Input labels of arbitrary datatype.
  * @param labels Vector that unsigned labels will be stored in.
@@ -16,9 +16,76 @@
 // In case it hasn't been included yet.
 #include "normalize_labels.hpp"
 
+#include <mlpack/core/util/execution.hpp>
+#include <unordered_map>
+
 namespace mlpack {
 namespace data {
 
+namespace details {
+
+/**
+ * Normalize the labels in [begin, end) to local labels in the order of their
+ * first appearance in the range, and store the distinct labels in that order.
+ * A handful of classes is found fastest by linear search over the labels seen
+ * so far; once there are more than a few dozen, the labels are looked up in a
+ * hash map instead, so that many classes do not make normalization quadratic.
+ *
+ * @param labelsIn Input labels of arbitrary datatype.
+ * @param begin First label of the range.
+ * @param end One past the last label of the range.
+ * @param labels Vector that the local labels of the range will be stored in.
+ * @param distinct Vector that the distinct labels will be stored in.
+ */
+template<typename RowType>
+void NormalizeLabelRange(const RowType& labelsIn,
+                         const size_t begin,
+                         const size_t end,
+                         arma::Row<size_t>& labels,
+                         std::vector<typename RowType::elem_type>& distinct)
+{
+  typedef typename RowType::elem_type LabelType;
+  const size_t linearSearchLimit = 32;
+
+  distinct.clear();
+  std::unordered_map<LabelType, size_t> index;
+  bool hashed = false;
+  for (size_t i = begin; i < end; ++i)
+  {
+    const LabelType label = labelsIn[i];
+    size_t j = 0;
+    if (!hashed)
+    {
+      // Is the label already in the list of labels we have seen?
+      while (j < distinct.size() && !(label == distinct[j]))
+        ++j;
+
+      // Do we need to add this new label?
+      if (j == distinct.size())
+      {
+        distinct.push_back(label);
+        if (distinct.size() > linearSearchLimit)
+        {
+          for (size_t k = 0; k < distinct.size(); ++k)
+            index.emplace(distinct[k], k);
+          hashed = true;
+        }
+      }
+    }
+    else
+    {
+      const auto result = index.emplace(label, distinct.size());
+      if (result.second)
+        distinct.push_back(label);
+      j = result.first->second;
+    }
+
+    labels[i] = j;
+  }
+}
+
+} // namespace details
+
 /**
  * Given a set of labels of a particular datatype, convert them to unsigned
  * labels in the range [0, n) where n is the number of different labels.  Also,
@@ -34,37 +101,58 @@ void NormalizeLabels(const RowType& labelsIn,
                      arma::Row<size_t>& labels,
                      arma::Col<eT>& mapping)
 {
-  // Loop over the input labels, and develop the mapping.  We'll first naively
-  // resize the mapping to the maximum possible size, and then when we fill it,
-  // we'll resize it back down to its actual size.
-  mapping.set_size(labelsIn.n_elem);
-  labels.set_size(labelsIn.n_elem);
-  size_t curLabel = 0;
-  for (size_t i = 0; i < labelsIn.n_elem; ++i)
+  typedef typename RowType::elem_type LabelType;
+
+  // Large label sets are split into one chunk per thread, and each chunk is
+  // normalized on its own.
+  const size_t n = labelsIn.n_elem;
+  const size_t minChunkSize = 65536;
+  util::Executor* executor = util::Execution::GetExecutor();
+  const size_t concurrency = executor ? executor->Concurrency() :
+      util::Execution::Threads();
+  const size_t chunks = std::max<size_t>(std::min(n / minChunkSize,
+      concurrency), 1);
+
+  labels.set_size(n);
+  std::vector<std::vector<LabelType> > distinct(chunks);
+  util::Execution::ParallelFor(chunks, [&](const size_t c)
   {
-    bool found = false;
-    for (size_t j = 0; j < curLabel; ++j)
-    {
-      // Is the label already in the list of labels we have seen?
-      if (labelsIn[i] == mapping[j])
-      {
-        labels[i] = j;
-        found = true;
-        break;
-      }
-    }
+    details::NormalizeLabelRange(labelsIn, c * n / chunks,
+        (c + 1) * n / chunks, labels, distinct[c]);
+  });
+
+  if (chunks == 1)
+  {
+    mapping = arma::conv_to<arma::Col<eT> >::from(distinct[0]);
+    return;
+  }
 
-    // Do we need to add this new label?
-    if (!found)
+  // Merge the distinct labels of the chunks in order.  A label first appears
+  // in the first chunk that holds it, and the new labels of each chunk are in
+  // the order of their first appearance, so the mapping is the same as that of
+  // a single pass.
+  std::vector<LabelType> allDistinct;
+  std::unordered_map<LabelType, size_t> index;
+  std::vector<std::vector<size_t> > globalLabels(chunks);
+  for (size_t c = 0; c < chunks; ++c)
+  {
+    globalLabels[c].resize(distinct[c].size());
+    for (size_t j = 0; j < distinct[c].size(); ++j)
     {
-      mapping[curLabel] = labelsIn[i];
-      labels[i] = curLabel;
-      ++curLabel;
+      const auto result = index.emplace(distinct[c][j], allDistinct.size());
+      if (result.second)
+        allDistinct.push_back(distinct[c][j]);
+      globalLabels[c][j] = result.first->second;
     }
   }
 
-  // Resize mapping back down to necessary size.
-  mapping.resize(curLabel);
+  util::Execution::ParallelFor(chunks, [&](const size_t c)
+  {
+    for (size_t i = c * n / chunks; i < (c + 1) * n / chunks; ++i)
+      labels[i] = globalLabels[c][labels[i]];
+  });
+
+  mapping = arma::conv_to<arma::Col<eT> >::from(allDistinct);
 }
 
 /**
@@ -19,6 +19,8 @@
 #include <string>
 
 #include "format.hpp"
+#include "binary_matrix.hpp"
+#include "binary_model.hpp"
 
 namespace mlpack {
 namespace data /** Functions to load and save matrices. */ {
@@ -39,6 +41,11 @@ namespace data /** Functions to load and save matrices. */ {
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5 (hdf5_binary), denoted by .hdf5, .hdf, .h5, or .he5
  *
+ * In addition, the matrix can be saved as an mlpack binary file (denoted by
+ * .mlbin; see binary_matrix.hpp), which can later be memory-mapped with
+ * data::Load().  These files hold the matrix exactly as it is stored in memory,
+ * so the 'transpose' parameter is ignored for them.
+ *
  * If the file extension is not one of those types, an error will be given.  If
  * the 'fatal' parameter is set to true, a std::runtime_error exception will be
  * thrown upon failure.  If the 'transpose' parameter is set to true, the matrix
@@ -58,6 +65,24 @@ bool Save(const std::string& filename,
           const bool fatal = false,
           bool transpose = true);
 
+/**
+ * Saves a matrix and its DatasetMapper to file, guessing the filetype from the
+ * extension.  Only mlpack binary files (.mlbin) can store the DatasetMapper; if
+ * the file has any other extension, a warning is given and the matrix is saved
+ * without it, as by the overload above.  The matrix is not transposed.
+ *
+ * @param filename Name of file to save to.
+ * @param matrix Matrix to save into file.
+ * @param info DatasetMapper to save with the matrix.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @return Boolean value indicating success or failure of save.
+ */
+template<typename eT, typename PolicyType>
+bool Save(const std::string& filename,
+          const arma::Mat<eT>& matrix,
+          const DatasetMapper<PolicyType>& info,
+          const bool fatal = false);
+
 /**
  * Saves a model to file, guessing the filetype from the extension, or,
  * optionally, saving the specified format.  If automatic extension detection is
@@ -70,8 +95,14 @@ bool Save(const std::string& filename,
  *  - xml, denoted by .xml
  *  - binary, denoted by .bin
  *
+ * In addition, mlpack binary model files (denoted by .mlmodel; see
+ * binary_model.hpp) hold a binary archive in which the elements of large
+ * matrices are stored as aligned blocks.  They are the fastest to load, and
+ * they can be memory-mapped with MappedModel.
+ *
  * The format parameter can take any of the values in the 'format' enum:
- * 'format::autodetect', 'format::text', 'format::xml', and 'format::binary'.
+ * 'format::autodetect', 'format::text', 'format::xml', 'format::binary', and
+ * 'format::binary_model'.
  * The autodetect functionality operates on the file extension (so, "file.txt"
  * would be autodetected as text).
  *
@@ -22,6 +22,9 @@
 #include <boost/archive/binary_oarchive.hpp>
 
 #include "serialization_shim.hpp"
+#include "binary_model.hpp"
+#include "hdf5_chunked.hpp"
+#include "text_writer.hpp"
 
 namespace mlpack {
 namespace data {
@@ -105,6 +108,32 @@ bool Save(const std::string& filename,
     saveType = arma::arma_binary;
     stringType = "Armadillo binary formatted data";
   }
+  else if (extension == "mlbin")
+  {
+    // mlpack binary files hold the matrix exactly as it is stored in memory, so
+    // they are never transposed.
+    Log::Info << "Saving mlpack binary formatted data to '" << filename
+        << "'." << std::endl;
+    try
+    {
+      SaveBinaryMatrix(stream, matrix);
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("saving_data");
+      if (fatal)
+        Log::Fatal << "Save to '" << filename << "' failed: " << e.what()
+            << std::endl;
+      else
+        Log::Warn << "Save to '" << filename << "' failed: " << e.what()
+            << std::endl;
+
+      return false;
+    }
+
+    Timer::Stop("saving_data");
+    return true;
+  }
   else if (extension == "pgm")
   {
     saveType = arma::pgm_binary;
@@ -114,6 +143,51 @@ bool Save(const std::string& filename,
            extension == "he5")
   {
 #ifdef ARMA_USE_HDF5
+    // Matrices are written into a chunked, compressed dataset, one point per
+    // row like Armadillo does.  Points that are rows of the matrix are
+    // transposed one block at a time, so the matrix is never copied whole.
+    // HDF5 can't hold a dataset with no rows, so Armadillo saves those.
+    const size_t points = transpose ? matrix.n_cols : matrix.n_rows;
+    const size_t rows = transpose ? matrix.n_rows : matrix.n_cols;
+    if (points > 0 && rows > 0)
+    {
+      stream.close();
+      Log::Info << "Saving HDF5 data to '" << filename << "'." << std::endl;
+      try
+      {
+        HDF5ChunkedWriter<eT> writer(filename, rows);
+        if (transpose)
+        {
+          writer.Write(matrix);
+        }
+        else
+        {
+          const size_t blockSize = 65536;
+          for (size_t begin = 0; begin < points; begin += blockSize)
+          {
+            const size_t end = std::min(begin + blockSize, points) - 1;
+            writer.Write(arma::Mat<eT>(trans(matrix.rows(begin, end))));
+          }
+        }
+        writer.Close();
+      }
+      catch (std::exception& e)
+      {
+        Timer::Stop("saving_data");
+        if (fatal)
+          Log::Fatal << "Save to '" << filename << "' failed: " << e.what()
+              << std::endl;
+        else
+          Log::Warn << "Save to '" << filename << "' failed: " << e.what()
+              << std::endl;
+
+        return false;
+      }
+
+      Timer::Stop("saving_data");
+      return true;
+    }
+
     saveType = arma::hdf5_binary;
     stringType = "HDF5 data";
 #else
@@ -155,6 +229,32 @@ bool Save(const std::string& filename,
   Log::Info << "Saving " << stringType << " to '" << filename << "'."
       << std::endl;
 
+  // Text is formatted by mlpack, in parallel, which is much faster than
+  // formatting it through Armadillo's streams.
+  if (saveType == arma::csv_ascii || saveType == arma::raw_ascii)
+  {
+    try
+    {
+      SaveText(stream, matrix, (saveType == arma::csv_ascii) ? ',' : ' ',
+          transpose);
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("saving_data");
+      if (fatal)
+        Log::Fatal << "Save to '" << filename << "' failed: " << e.what()
+            << std::endl;
+      else
+        Log::Warn << "Save to '" << filename << "' failed: " << e.what()
+            << std::endl;
+
+      return false;
+    }
+
+    Timer::Stop("saving_data");
+    return true;
+  }
+
   // Transpose the matrix.  If we are saving HDF5, Armadillo already transposes
   // this on save, so we don't need to.
   if ((transpose && saveType != arma::hdf5_binary) ||
@@ -201,6 +301,63 @@ bool Save(const std::string& filename,
   return true;
 }
 
+template<typename eT, typename PolicyType>
+bool Save(const std::string& filename,
+          const arma::Mat<eT>& matrix,
+          const DatasetMapper<PolicyType>& info,
+          const bool fatal)
+{
+  if (Extension(filename) != "mlbin")
+  {
+    Log::Warn << "Only mlpack binary files (.mlbin) can store dataset "
+        << "information; saving '" << filename << "' without it." << std::endl;
+    return Save(filename, matrix, fatal, false);
+  }
+
+  Timer::Start("saving_data");
+
+  std::fstream stream;
+#ifdef  _WIN32 // Always open in binary mode on Windows.
+  stream.open(filename.c_str(), std::fstream::out | std::fstream::binary);
+#else
+  stream.open(filename.c_str(), std::fstream::out);
+#endif
+  if (!stream.is_open())
+  {
+    Timer::Stop("saving_data");
+    if (fatal)
+      Log::Fatal << "Cannot open file '" << filename << "' for writing. "
+          << "Save failed." << std::endl;
+    else
+      Log::Warn << "Cannot open file '" << filename << "' for writing; save "
+          << "failed." << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Saving mlpack binary formatted data to '" << filename << "'."
+      << std::endl;
+  try
+  {
+    SaveBinaryMatrix(stream, matrix, &info);
+  }
+  catch (std::exception& e)
+  {
+    Timer::Stop("saving_data");
+    if (fatal)
+      Log::Fatal << "Save to '" << filename << "' failed: " << e.what()
+          << std::endl;
+    else
+      Log::Warn << "Save to '" << filename << "' failed: " << e.what()
+          << std::endl;
+
+    return false;
+  }
+
+  Timer::Stop("saving_data");
+  return true;
+}
+
 //! Save a model to file.
 template<typename T>
 bool Save(const std::string& filename,
@@ -219,14 +376,16 @@ bool Save(const std::string& filename,
       f = format::binary;
     else if (extension == "txt")
       f = format::text;
+    else if (extension == "mlmodel")
+      f = format::binary_model;
     else
     {
       if (fatal)
         Log::Fatal << "Unable to detect type of '" << filename << "'; incorrect"
-            << " extension? (allowed: xml/bin/txt)" << std::endl;
+            << " extension? (allowed: xml/bin/txt/mlmodel)" << std::endl;
       else
         Log::Warn << "Unable to detect type of '" << filename << "'; save "
-            << "failed.  Incorrect extension? (allowed: xml/bin/txt)"
+            << "failed.  Incorrect extension? (allowed: xml/bin/txt/mlmodel)"
             << std::endl;
 
       return false;
@@ -236,7 +395,8 @@ bool Save(const std::string& filename,
   // Open the file to save to.
   std::ofstream ofs;
 #ifdef _WIN32
-  if (f == format::binary) // Open non-text types in binary mode on Windows.
+  // Open non-text types in binary mode on Windows.
+  if (f == format::binary || f == format::binary_model)
     ofs.open(filename, std::ofstream::out | std::ofstream::binary);
   else
     ofs.open(filename, std::ofstream::out);
@@ -273,6 +433,10 @@ bool Save(const std::string& filename,
       boost::archive::binary_oarchive ar(ofs);
       ar << CreateNVP(t, name);
     }
+    else if (f == format::binary_model)
+    {
+      SaveBinaryModel(ofs, name, t);
+    }
 
     return true;
   }
@@ -285,6 +449,17 @@ bool Save(const std::string& filename,
 
     return false;
   }
+  catch (std::runtime_error& e)
+  {
+    if (fatal)
+      Log::Fatal << "Saving to '" << filename << "' failed: " << e.what()
+          << std::endl;
+    else
+      Log::Warn << "Saving to '" << filename << "' failed: " << e.what()
+          << std::endl;
+
+    return false;
+  }
 }
 
 } // namespace data
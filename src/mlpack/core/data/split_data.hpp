@@ -14,9 +14,203 @@
 #define MLPACK_CORE_DATA_SPLIT_DATA_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+#include <fstream>
 
 namespace mlpack {
 namespace data {
+namespace details {
+
+/**
+ * Randomly permute the columns of the given matrix in place, and the elements
+ * of the given labels (if not NULL) in the same way.  A plain Fisher-Yates
+ * shuffle of a large matrix swaps each column with a column anywhere in the
+ * matrix, so nearly every swap misses the cache.  Instead, each column is given
+ * a random bucket, the columns are moved to their buckets in place (as in an
+ * American flag sort), and then the columns of each bucket, which fit in the
+ * cache, are shuffled with Fisher-Yates.  Since the buckets are independent and
+ * uniformly random, every permutation is still equally likely.
+ *
+ * @param data Matrix whose columns to shuffle.
+ * @param labels Labels to permute along with the columns, or NULL.
+ */
+template<typename T, typename U>
+void ShuffleColumns(arma::Mat<T>& data, arma::Row<U>* labels)
+{
+  const size_t n = data.n_cols;
+  if (n < 2)
+    return;
+
+  // Roughly 256kB of columns per bucket.
+  const size_t columnBytes = std::max(data.n_rows * sizeof(T), (size_t) 1);
+  const size_t bucketSize = std::max((size_t) (1 << 18) / columnBytes,
+      (size_t) 1);
+  const size_t numBuckets = std::min(n / bucketSize + 1, (size_t) 1024);
+
+  std::vector<size_t> begin(numBuckets + 1, 0);
+  if (numBuckets > 1)
+  {
+    std::vector<uint32_t> bucket(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+      bucket[i] = (uint32_t) math::RandInt(numBuckets);
+      ++begin[bucket[i] + 1];
+    }
+    for (size_t b = 0; b < numBuckets; ++b)
+      begin[b + 1] += begin[b];
+
+    // Move every column to its bucket.  next[b] is the first column of bucket
+    // b that is not known to belong there yet.
+    std::vector<size_t> next(begin.begin(), begin.end() - 1);
+    for (size_t b = 0; b < numBuckets; ++b)
+    {
+      while (next[b] < begin[b + 1])
+      {
+        const size_t i = next[b];
+        const uint32_t target = bucket[i];
+        if (target == b)
+        {
+          ++next[b];
+          continue;
+        }
+
+        const size_t j = next[target]++;
+        data.swap_cols(i, j);
+        std::swap(bucket[i], bucket[j]);
+        if (labels)
+          std::swap((*labels)[i], (*labels)[j]);
+      }
+    }
+  }
+  else
+  {
+    begin[1] = n;
+  }
+
+  // Shuffle each bucket.
+  for (size_t b = 0; b < numBuckets; ++b)
+  {
+    for (size_t i = begin[b]; i + 1 < begin[b + 1]; ++i)
+    {
+      const size_t j = (size_t) math::RandInt(i, begin[b + 1]);
+      if (j != i)
+      {
+        data.swap_cols(i, j);
+        if (labels)
+          std::swap((*labels)[i], (*labels)[j]);
+      }
+    }
+  }
+}
+
+/**
+ * Make the given matrix an alias of the given memory, without copying it.
+ * (Assigning an alias to a matrix would copy the elements.)
+ */
+template<typename T>
+void MakeAlias(arma::Mat<T>& m, T* memory, const size_t rows,
+               const size_t cols)
+{
+  m.~Mat();
+  new (&m) arma::Mat<T>(memory, rows, cols, false, true);
+}
+
+//! Make the given row an alias of the given memory, without copying it.
+template<typename U>
+void MakeAlias(arma::Row<U>& r, U* memory, const size_t n)
+{
+  r.~Row();
+  new (&r) arma::Row<U>(memory, n, false, true);
+}
+
+/**
+ * Choose the points of a stratified test set: for every class, floor(testRatio
+ * * n_c) of its n_c points are chosen uniformly at random (with selection
+ * sampling, in one pass over the labels).
+ *
+ * @param labels Labels of the points.
+ * @param testRatio Ratio of the points of each class to put in the test set.
+ * @return For each point, whether it belongs to the test set.
+ */
+template<typename U>
+std::vector<char> StratifiedTestMask(const arma::Row<U>& labels,
+                                     const double testRatio)
+{
+  // Count the points of each class.
+  std::map<U, std::pair<size_t, size_t>> classes;
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    ++classes[labels[i]].first;
+
+  // Now, for each class, .first is the number of points left to see and
+  // .second the number of test points left to choose.
+  typename std::map<U, std::pair<size_t, size_t>>::iterator it;
+  for (it = classes.begin(); it != classes.end(); ++it)
+    it->second.second = (size_t) (it->second.first * testRatio);
+
+  std::vector<char> mask(labels.n_elem, 0);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+  {
+    std::pair<size_t, size_t>& remaining = classes[labels[i]];
+    if (math::Random() * remaining.first < remaining.second)
+    {
+      mask[i] = 1;
+      --remaining.second;
+    }
+    --remaining.first;
+  }
+
+  return mask;
+}
+
+/**
+ * Copy the points (lines) of the given text file to the training file or the
+ * test file, in order; blank lines are skipped.  A std::runtime_error is thrown
+ * if a file cannot be opened or written.
+ *
+ * @param isTest Function returning whether the point with the given index goes
+ *     to the test file.
+ * @return The number of points of the input file.
+ */
+template<typename TestFunction>
+size_t SplitLines(const std::string& inputFile,
+                  const std::string& trainFile,
+                  const std::string& testFile,
+                  TestFunction isTest)
+{
+  std::ifstream input(inputFile.c_str());
+  if (!input.is_open())
+    throw std::runtime_error("cannot open file '" + inputFile + "'");
+
+  std::ofstream train(trainFile.c_str());
+  if (!train.is_open())
+    throw std::runtime_error("cannot open file '" + trainFile + "'");
+  std::ofstream test(testFile.c_str());
+  if (!test.is_open())
+    throw std::runtime_error("cannot open file '" + testFile + "'");
+
+  size_t points = 0;
+  std::string line;
+  while (std::getline(input, line))
+  {
+    if (line.find_first_not_of(" \t\r") == std::string::npos)
+      continue;
+
+    std::ofstream& output = isTest(points) ? test : train;
+    output << line << '\n';
+    ++points;
+  }
+
+  train.flush();
+  test.flush();
+  if (input.bad() || !train || !test)
+    throw std::runtime_error("error while splitting '" + inputFile + "'");
+
+  return points;
+}
+
+} // namespace details
+
 /**
  * Given an input dataset and labels, split into a training set and test set.
  * Example usage below.  This overload places the split dataset into the four
@@ -192,6 +386,264 @@ Split(const arma::Mat<T>& input,
                          std::move(testData));
 }
 
+/**
+ * Given an input dataset and labels, split them into a training set and a test
+ * set without copying them.  The columns of the input (and the labels) are
+ * shuffled in place, and then the outputs are made aliases of the input: the
+ * training set is its first columns, and the test set its last columns.  The
+ * outputs are therefore only valid as long as the input exists and is not
+ * resized, and modifying them modifies the input.
+ *
+ * @code
+ * arma::mat input = loadData();
+ * arma::Row<size_t> label = loadLabel();
+ * arma::mat trainData, testData;
+ * arma::Row<size_t> trainLabel, testLabel;
+ * SplitInPlace(input, label, trainData, testData, trainLabel, testLabel, 0.3);
+ * @endcode
+ *
+ * @param input Input dataset to split; its columns are shuffled.
+ * @param inputLabel Input labels to split; they are shuffled with the columns.
+ * @param trainData Matrix to make an alias of the training data.
+ * @param testData Matrix to make an alias of the test data.
+ * @param trainLabel Vector to make an alias of the training labels.
+ * @param testLabel Vector to make an alias of the test labels.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ */
+template<typename T, typename U>
+void SplitInPlace(arma::Mat<T>& input,
+                  arma::Row<U>& inputLabel,
+                  arma::Mat<T>& trainData,
+                  arma::Mat<T>& testData,
+                  arma::Row<U>& trainLabel,
+                  arma::Row<U>& testLabel,
+                  const double testRatio)
+{
+  if (inputLabel.n_elem != input.n_cols)
+    throw std::invalid_argument("SplitInPlace(): the number of labels does not "
+        "match the number of points");
+
+  const size_t testSize = static_cast<size_t>(input.n_cols * testRatio);
+  const size_t trainSize = input.n_cols - testSize;
+
+  details::ShuffleColumns(input, &inputLabel);
+
+  details::MakeAlias(trainData, input.memptr(), input.n_rows, trainSize);
+  details::MakeAlias(testData, input.colptr(0) + trainSize * input.n_rows,
+      input.n_rows, testSize);
+  details::MakeAlias(trainLabel, inputLabel.memptr(), trainSize);
+  details::MakeAlias(testLabel, inputLabel.memptr() + trainSize, testSize);
+}
+
+/**
+ * Given an input dataset, split it into a training set and a test set without
+ * copying it.  The columns of the input are shuffled in place, and then the
+ * outputs are made aliases of its first and last columns, so they are only
+ * valid as long as the input exists and is not resized.
+ *
+ * @param input Input dataset to split; its columns are shuffled.
+ * @param trainData Matrix to make an alias of the training data.
+ * @param testData Matrix to make an alias of the test data.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ */
+template<typename T>
+void SplitInPlace(arma::Mat<T>& input,
+                  arma::Mat<T>& trainData,
+                  arma::Mat<T>& testData,
+                  const double testRatio)
+{
+  const size_t testSize = static_cast<size_t>(input.n_cols * testRatio);
+  const size_t trainSize = input.n_cols - testSize;
+
+  details::ShuffleColumns(input, (arma::Row<size_t>*) NULL);
+
+  details::MakeAlias(trainData, input.memptr(), input.n_rows, trainSize);
+  details::MakeAlias(testData, input.memptr() + trainSize * input.n_rows,
+      input.n_rows, testSize);
+}
+
+/**
+ * Given an input dataset and labels, split them into a stratified training set
+ * and test set without copying them: for every class, floor(testRatio * n_c) of
+ * its n_c points are put in the test set, so the proportions of the classes are
+ * (nearly) the same in both sets.  As with SplitInPlace(), the input is
+ * reordered in place and the outputs are aliases of it.
+ *
+ * @param input Input dataset to split; its columns are reordered.
+ * @param inputLabel Input labels to split; they are reordered with the columns.
+ * @param trainData Matrix to make an alias of the training data.
+ * @param testData Matrix to make an alias of the test data.
+ * @param trainLabel Vector to make an alias of the training labels.
+ * @param testLabel Vector to make an alias of the test labels.
+ * @param testRatio Percentage of each class to use for test set (between 0 and
+ *     1).
+ */
+template<typename T, typename U>
+void StratifiedSplitInPlace(arma::Mat<T>& input,
+                            arma::Row<U>& inputLabel,
+                            arma::Mat<T>& trainData,
+                            arma::Mat<T>& testData,
+                            arma::Row<U>& trainLabel,
+                            arma::Row<U>& testLabel,
+                            const double testRatio)
+{
+  if (inputLabel.n_elem != input.n_cols)
+    throw std::invalid_argument("StratifiedSplitInPlace(): the number of "
+        "labels does not match the number of points");
+
+  std::vector<char> mask = details::StratifiedTestMask(inputLabel, testRatio);
+
+  // Move the test points to the end.
+  size_t trainSize = 0;
+  size_t end = input.n_cols;
+  while (trainSize < end)
+  {
+    if (!mask[trainSize])
+    {
+      ++trainSize;
+      continue;
+    }
+
+    --end;
+    if (mask[end])
+      continue;
+
+    input.swap_cols(trainSize, end);
+    std::swap(inputLabel[trainSize], inputLabel[end]);
+    std::swap(mask[trainSize], mask[end]);
+    ++trainSize;
+  }
+  const size_t testSize = input.n_cols - trainSize;
+
+  details::MakeAlias(trainData, input.memptr(), input.n_rows, trainSize);
+  details::MakeAlias(testData, input.memptr() + trainSize * input.n_rows,
+      input.n_rows, testSize);
+  details::MakeAlias(trainLabel, inputLabel.memptr(), trainSize);
+  details::MakeAlias(testLabel, inputLabel.memptr() + trainSize, testSize);
+
+  // The partition keeps most points in place, so shuffle both sets.
+  details::ShuffleColumns(trainData, &trainLabel);
+  details::ShuffleColumns(testData, &testLabel);
+}
+
+/**
+ * Split a dataset stored in a text file with one point per line (such as a CSV
+ * file) into a training file and a test file, without loading it: the lines
+ * are read one at a time and written to one of the output files.  The file is
+ * read twice (once to count the points).  Unlike Split(), the points keep
+ * their order in the file; floor(testRatio * n) points, chosen uniformly at
+ * random, go to the test file.  A std::runtime_error is thrown if a file cannot
+ * be read or written.
+ *
+ * @param inputFile File holding the dataset.
+ * @param trainFile File to write the training set to.
+ * @param testFile File to write the test set to.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ * @return The number of points in the test set.
+ */
+inline size_t SplitFile(const std::string& inputFile,
+                        const std::string& trainFile,
+                        const std::string& testFile,
+                        const double testRatio)
+{
+  size_t points = 0;
+  {
+    std::ifstream input(inputFile.c_str());
+    if (!input.is_open())
+      throw std::runtime_error("cannot open file '" + inputFile + "'");
+
+    std::string line;
+    while (std::getline(input, line))
+      if (line.find_first_not_of(" \t\r") != std::string::npos)
+        ++points;
+  }
+
+  // Selection sampling: each point is chosen with probability (test points
+  // left to choose) / (points left).
+  const size_t testSize = static_cast<size_t>(points * testRatio);
+  size_t needed = testSize;
+  details::SplitLines(inputFile, trainFile, testFile, [&](const size_t i)
+  {
+    if (math::Random() * (points - i) < needed)
+    {
+      --needed;
+      return true;
+    }
+    return false;
+  });
+
+  return testSize;
+}
+
+/**
+ * Split a dataset stored in a text file with one point per line, and its
+ * labels, into a training set and a test set, without loading the dataset: the
+ * lines are read one at a time and written to the training file or the test
+ * file, and the labels are split in memory.  If stratify is true, for every
+ * class floor(testRatio * n_c) of its n_c points go to the test set; otherwise,
+ * floor(testRatio * n) points are chosen uniformly at random.  The points keep
+ * their order in the file.  A std::runtime_error is thrown if a file cannot be
+ * read or written, or if its number of points is not the number of labels.
+ *
+ * @param inputFile File holding the dataset.
+ * @param inputLabel Labels of the points of the dataset.
+ * @param trainFile File to write the training set to.
+ * @param testFile File to write the test set to.
+ * @param trainLabel Vector to store training labels into.
+ * @param testLabel Vector to store test labels into.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ * @param stratify Whether to keep the proportions of the classes.
+ */
+template<typename U>
+void SplitFile(const std::string& inputFile,
+               const arma::Row<U>& inputLabel,
+               const std::string& trainFile,
+               const std::string& testFile,
+               arma::Row<U>& trainLabel,
+               arma::Row<U>& testLabel,
+               const double testRatio,
+               const bool stratify = false)
+{
+  std::vector<char> mask;
+  if (stratify)
+  {
+    mask = details::StratifiedTestMask(inputLabel, testRatio);
+  }
+  else
+  {
+    mask.assign(inputLabel.n_elem, 0);
+    const size_t testSize = static_cast<size_t>(inputLabel.n_elem * testRatio);
+    size_t needed = testSize;
+    for (size_t i = 0; i < inputLabel.n_elem; ++i)
+    {
+      if (math::Random() * (inputLabel.n_elem - i) < needed)
+      {
+        mask[i] = 1;
+        --needed;
+      }
+    }
+  }
+
+  const size_t points = details::SplitLines(inputFile, trainFile, testFile,
+      [&](const size_t i) { return i < mask.size() && mask[i]; });
+  if (points != inputLabel.n_elem)
+    throw std::runtime_error("'" + inputFile + "' holds " +
+        std::to_string(points) + " points, but " +
+        std::to_string(inputLabel.n_elem) + " labels are given");
+
+  const size_t testSize = std::count(mask.begin(), mask.end(), 1);
+  trainLabel.set_size(inputLabel.n_elem - testSize);
+  testLabel.set_size(testSize);
+  size_t train = 0, test = 0;
+  for (size_t i = 0; i < inputLabel.n_elem; ++i)
+  {
+    if (mask[i])
+      testLabel[test++] = inputLabel[i];
+    else
+      trainLabel[train++] = inputLabel[i];
+  }
+}
+
 } // namespace data
 } // namespace mlpack
 
@@ -0,0 +1,242 @@
+/**
+ * @file text_writer.hpp
+ *
+ * A fast writer of matrices as CSV or whitespace-separated text, used by
+ * data::Save().  Blocks of lines are formatted in parallel into separate
+ * buffers, which are then written to the stream in order, one large write per
+ * block.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_TEXT_WRITER_HPP
+#define MLPACK_CORE_DATA_TEXT_WRITER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/execution.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace mlpack {
+namespace data {
+namespace details {
+
+//! The maximum number of characters FormatValue() writes for one value.
+static const size_t maxValueLength = 32;
+
+/**
+ * Write the decimal digits of the given integer to out, and return a pointer
+ * past the last digit.  Two digits are converted at a time.
+ */
+inline char* FormatUnsigned(unsigned long long value, char* out)
+{
+  static const char digitPairs[] =
+      "00010203040506070809101112131415161718192021222324"
+      "25262728293031323334353637383940414243444546474849"
+      "50515253545556575859606162636465666768697071727374"
+      "75767778798081828384858687888990919293949596979899";
+
+  // Write the digits backwards into a temporary buffer.
+  char buffer[20];
+  char* end = buffer + sizeof(buffer);
+  char* begin = end;
+  while (value >= 100)
+  {
+    const size_t pair = 2 * (value % 100);
+    value /= 100;
+    *--begin = digitPairs[pair + 1];
+    *--begin = digitPairs[pair];
+  }
+  if (value >= 10)
+  {
+    *--begin = digitPairs[2 * value + 1];
+    *--begin = digitPairs[2 * value];
+  }
+  else
+  {
+    *--begin = char('0' + value);
+  }
+
+  std::memcpy(out, begin, end - begin);
+  return out + (end - begin);
+}
+
+//! Format an unsigned integer.
+template<typename eT>
+inline typename std::enable_if<std::is_integral<eT>::value &&
+    std::is_unsigned<eT>::value, char*>::type
+FormatValue(const eT value, char* out)
+{
+  return FormatUnsigned((unsigned long long) value, out);
+}
+
+//! Format a signed integer.
+template<typename eT>
+inline typename std::enable_if<std::is_integral<eT>::value &&
+    std::is_signed<eT>::value, char*>::type
+FormatValue(const eT value, char* out)
+{
+  if (value < 0)
+  {
+    *out++ = '-';
+    // Negate in unsigned arithmetic, so the minimum value doesn't overflow.
+    return FormatUnsigned(0ULL - (unsigned long long) value, out);
+  }
+
+  return FormatUnsigned((unsigned long long) value, out);
+}
+
+/**
+ * Format a floating-point number with the fewest significant digits that read
+ * back to the same value (up to max_digits10), so that saved matrices can be
+ * loaded exactly.  Integral values are formatted as integers, which is both
+ * shorter and much faster; non-finite values are written as "nan", "inf" and
+ * "-inf", as Armadillo writes them.
+ */
+template<typename eT>
+inline typename std::enable_if<std::is_floating_point<eT>::value, char*>::type
+FormatValue(const eT value, char* out)
+{
+  if (value != value)
+  {
+    std::memcpy(out, "nan", 3);
+    return out + 3;
+  }
+  else if (value == std::numeric_limits<eT>::infinity())
+  {
+    std::memcpy(out, "inf", 3);
+    return out + 3;
+  }
+  else if (value == -std::numeric_limits<eT>::infinity())
+  {
+    std::memcpy(out, "-inf", 4);
+    return out + 4;
+  }
+
+  // Every integer below 2^digits is exactly representable (and fits in a long
+  // long below 2^62).
+  const eT exactLimit = std::ldexp(eT(1),
+      std::min(std::numeric_limits<eT>::digits, 62));
+  if (value > -exactLimit && value < exactLimit && value == std::floor(value) &&
+      !(value == 0 && std::signbit(value)))
+  {
+    return FormatValue((long long) value, out);
+  }
+
+  int length = 0;
+  for (int precision = std::numeric_limits<eT>::digits10;
+       precision <= std::numeric_limits<eT>::max_digits10; ++precision)
+  {
+    length = std::snprintf(out, maxValueLength, "%.*g", precision,
+        (double) value);
+    if (precision == std::numeric_limits<eT>::max_digits10 ||
+        (eT) std::strtod(out, NULL) == value)
+      break;
+  }
+
+  return out + length;
+}
+
+//! Format a value of any other type with a stream; this is slow.
+template<typename eT>
+inline typename std::enable_if<!std::is_arithmetic<eT>::value, char*>::type
+FormatValue(const eT& value, char* out)
+{
+  std::ostringstream oss;
+  oss << value;
+  const std::string s = oss.str().substr(0, maxValueLength);
+  std::memcpy(out, s.data(), s.size());
+  return out + s.size();
+}
+
+} // namespace details
+
+/**
+ * Write the given matrix to the stream as text, one line per column (if
+ * transpose is true, which gives the layout mlpack uses, one point per line) or
+ * per row, with the values of each line separated by the given delimiter.  The
+ * lines are split into blocks, which are formatted in parallel and written in
+ * order; only a few blocks per thread are held in memory at a time.  A
+ * std::runtime_error is thrown if the stream can't be written.
+ *
+ * @param stream Stream to write to.
+ * @param matrix Matrix to write.
+ * @param delimiter Character between the values of a line.
+ * @param transpose Whether to write each column (rather than each row) as a
+ *     line.
+ */
+template<typename eT>
+void SaveText(std::ostream& stream,
+              const arma::Mat<eT>& matrix,
+              const char delimiter,
+              const bool transpose)
+{
+  const size_t numLines = transpose ? matrix.n_cols : matrix.n_rows;
+  const size_t lineLength = transpose ? matrix.n_rows : matrix.n_cols;
+  if (numLines == 0 || lineLength == 0)
+    return;
+
+  // Each block holds about 64k values, and each round formats a few blocks per
+  // thread before they are written.
+  const size_t blockLines = std::max((size_t) 1, (size_t) 65536 / lineLength);
+  const size_t numBlocks = (numLines + blockLines - 1) / blockLines;
+  const size_t roundBlocks = 4 * util::Execution::Threads();
+  std::vector<std::string> buffers(std::min(roundBlocks, numBlocks));
+
+  for (size_t roundBegin = 0; roundBegin < numBlocks;
+       roundBegin += roundBlocks)
+  {
+    const size_t roundEnd = std::min(roundBegin + roundBlocks, numBlocks);
+
+    // Tiny workaround: Visual Studio only supports OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t b = (intmax_t) roundBegin; b < (intmax_t) roundEnd; ++b)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = roundBegin; b < roundEnd; ++b)
+#endif
+    {
+      std::string& buffer = buffers[b - roundBegin];
+      const size_t lineBegin = b * blockLines;
+      const size_t lineEnd = std::min(lineBegin + blockLines, numLines);
+
+      // Every value takes at most maxValueLength characters and a separator.
+      buffer.resize((lineEnd - lineBegin) * lineLength *
+          (details::maxValueLength + 1));
+      char* out = &buffer[0];
+      for (size_t line = lineBegin; line < lineEnd; ++line)
+      {
+        for (size_t i = 0; i < lineLength; ++i)
+        {
+          if (i > 0)
+            *out++ = delimiter;
+          out = details::FormatValue(transpose ? matrix.at(i, line) :
+              matrix.at(line, i), out);
+        }
+        *out++ = '\n';
+      }
+      buffer.resize(out - &buffer[0]);
+    }
+
+    for (size_t b = roundBegin; b < roundEnd; ++b)
+    {
+      const std::string& buffer = buffers[b - roundBegin];
+      stream.write(buffer.data(), buffer.size());
+    }
+
+    if (!stream.good())
+      throw std::runtime_error("SaveText(): cannot write to the stream");
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
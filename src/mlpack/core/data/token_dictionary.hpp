@@ -0,0 +1,141 @@
+/**
+ * @file token_dictionary.hpp
+ *
+ * A hash table that assigns consecutive ids to the distinct tokens of a text
+ * buffer, used to map categorical values quickly while loading files.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_TOKEN_DICTIONARY_HPP
+#define MLPACK_CORE_DATA_TOKEN_DICTIONARY_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A dictionary of tokens, which gives each distinct token the next id (0, 1,
+ * 2, ...) the first time it is inserted.  The tokens are not copied: the
+ * dictionary only holds pointers into the buffer they come from, which must
+ * outlive it.  Lookups use open addressing with linear probing, and the tokens
+ * are also kept in a vector indexed by id, so finding the token of an id is a
+ * single access.
+ *
+ * @code
+ * TokenDictionary dictionary;
+ * dictionary.Insert("cat", 3); // Returns 0.
+ * dictionary.Insert("dog", 3); // Returns 1.
+ * dictionary.Insert("cat", 3); // Returns 0.
+ * std::string token = dictionary.Token(1); // "dog".
+ * @endcode
+ */
+class TokenDictionary
+{
+ public:
+  //! Create an empty dictionary.
+  TokenDictionary() : slots(16, 0) { }
+
+  /**
+   * Get the id of the given token, inserting it if it is not in the dictionary
+   * yet.
+   *
+   * @param begin Start of the token.
+   * @param length Length of the token, in bytes.
+   * @return The id of the token.
+   */
+  size_t Insert(const char* begin, const size_t length)
+  {
+    const size_t hash = Hash(begin, length);
+    const size_t mask = slots.size() - 1;
+    size_t slot = hash & mask;
+    while (slots[slot] != 0)
+    {
+      const Entry& entry = entries[slots[slot] - 1];
+      if (entry.hash == hash && entry.length == length &&
+          std::memcmp(entry.begin, begin, length) == 0)
+        return slots[slot] - 1;
+
+      slot = (slot + 1) & mask;
+    }
+
+    const Entry entry = { begin, length, hash };
+    entries.push_back(entry);
+    slots[slot] = entries.size();
+
+    // Keep the table at most half full, so that probe sequences stay short.
+    if (2 * entries.size() > slots.size())
+      Grow();
+
+    return entries.size() - 1;
+  }
+
+  //! Get the number of distinct tokens in the dictionary.
+  size_t Size() const { return entries.size(); }
+
+  //! Get the token with the given id.
+  std::string Token(const size_t id) const
+  {
+    return std::string(entries[id].begin, entries[id].length);
+  }
+
+  //! Get the start of the token with the given id, in its buffer.
+  const char* Begin(const size_t id) const { return entries[id].begin; }
+  //! Get the length of the token with the given id.
+  size_t Length(const size_t id) const { return entries[id].length; }
+
+ private:
+  //! A token of the dictionary.
+  struct Entry
+  {
+    //! Start of the token.
+    const char* begin;
+    //! Length of the token.
+    size_t length;
+    //! Hash of the token.
+    size_t hash;
+  };
+
+  //! FNV-1a hash of the given bytes.
+  static size_t Hash(const char* begin, const size_t length)
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i)
+    {
+      hash ^= (unsigned char) begin[i];
+      hash *= 1099511628211ULL;
+    }
+
+    return (size_t) hash;
+  }
+
+  //! Double the size of the table and reinsert every token.
+  void Grow()
+  {
+    slots.assign(2 * slots.size(), 0);
+    const size_t mask = slots.size() - 1;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+      size_t slot = entries[i].hash & mask;
+      while (slots[slot] != 0)
+        slot = (slot + 1) & mask;
+      slots[slot] = i + 1;
+    }
+  }
+
+  //! The tokens, indexed by id.
+  std::vector<Entry> entries;
+  //! The hash table: one plus the id of the token in each slot, or 0 if the
+  //! slot is empty.  The size is a power of two.
+  std::vector<size_t> slots;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
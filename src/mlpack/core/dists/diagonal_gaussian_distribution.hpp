@@ -0,0 +1,195 @@
+/**
+ * @file diagonal_gaussian_distribution.hpp
+ *
+ * Implementation of the Gaussian distribution with diagonal covariance.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DISTRIBUTIONS_DIAGONAL_GAUSSIAN_DISTRIBUTION_HPP
+#define MLPACK_CORE_DISTRIBUTIONS_DIAGONAL_GAUSSIAN_DISTRIBUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace distribution {
+
+/**
+ * A single multivariate Gaussian distribution with diagonal covariance.  Only
+ * the variances of the dimensions are stored, so the distribution takes O(d)
+ * memory, and the probability of an observation is computed in O(d) time,
+ * instead of the O(d^2) of a GaussianDistribution with a diagonal covariance
+ * matrix.  It can be used as the distribution of EMFit (see DiagonalGMM) and
+ * of HMM.
+ */
+class DiagonalGaussianDistribution
+{
+ private:
+  //! Mean of the distribution.
+  arma::vec mean;
+  //! Diagonal of the covariance of the distribution (the variances).
+  arma::vec covariance;
+  //! Cached inverse of the variances.
+  arma::vec invCov;
+  //! Cached logdet(cov).
+  double logDetCov;
+
+  //! log(2pi)
+  static const constexpr double log2pi = 1.83787706640934533908193770912475883;
+
+ public:
+  /**
+   * Default constructor, which creates a Gaussian with zero dimension.
+   */
+  DiagonalGaussianDistribution() : logDetCov(0) { /* Nothing to do. */ }
+
+  /**
+   * Create a Gaussian distribution with zero mean and identity covariance with
+   * the given dimensionality.
+   */
+  DiagonalGaussianDistribution(const size_t dimension) :
+      mean(arma::zeros<arma::vec>(dimension)),
+      covariance(arma::ones<arma::vec>(dimension)),
+      invCov(arma::ones<arma::vec>(dimension)),
+      logDetCov(0)
+  { /* Nothing to do. */ }
+
+  /**
+   * Create a Gaussian distribution with the given mean and the given diagonal
+   * of the covariance.
+   *
+   * The variances are expected to be positive.
+   */
+  DiagonalGaussianDistribution(const arma::vec& mean,
+                               const arma::vec& covariance);
+
+  //! Return the dimensionality of this distribution.
+  size_t Dimensionality() const { return mean.n_elem; }
+
+  /**
+   * Return the probability of the given observation.
+   */
+  double Probability(const arma::vec& observation) const
+  {
+    return exp(LogProbability(observation));
+  }
+
+  /**
+   * Return the log probability of the given observation.
+   */
+  double LogProbability(const arma::vec& observation) const;
+
+  /**
+   * Calculates the multivariate Gaussian probability density function for each
+   * data point (column) in the given matrix.
+   *
+   * @param x List of observations.
+   * @param probabilities Output probabilities for each input observation.
+   */
+  void Probability(const arma::mat& x, arma::vec& probabilities) const
+  {
+    arma::vec logProbabilities;
+    LogProbability(x, logProbabilities);
+    probabilities = arma::exp(logProbabilities);
+  }
+
+  void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
+
+  /**
+   * Return a randomly generated observation according to the probability
+   * distribution defined by this object.
+   *
+   * @return Random observation from this Gaussian distribution.
+   */
+  arma::vec Random() const;
+
+  /**
+   * Estimate the Gaussian distribution directly from the given observations.
+   *
+   * @param observations List of observations.
+   */
+  void Train(const arma::mat& observations);
+
+  /**
+   * Estimate the Gaussian distribution from the given observations, taking into
+   * account the probability of each observation actually being from this
+   * distribution.
+   */
+  void Train(const arma::mat& observations,
+             const arma::vec& probabilities);
+
+  /**
+   * Return the mean.
+   */
+  const arma::vec& Mean() const { return mean; }
+
+  /**
+   * Return a modifiable copy of the mean.
+   */
+  arma::vec& Mean() { return mean; }
+
+  /**
+   * Return the diagonal of the covariance.
+   */
+  const arma::vec& Covariance() const { return covariance; }
+
+  /**
+   * Set the diagonal of the covariance.
+   */
+  void Covariance(const arma::vec& covariance);
+
+  void Covariance(arma::vec&& covariance);
+
+  /**
+   * Serialize the distribution.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    using data::CreateNVP;
+
+    // We just need to serialize each of the members.
+    ar & CreateNVP(mean, "mean");
+    ar & CreateNVP(covariance, "covariance");
+    ar & CreateNVP(invCov, "invCov");
+    ar & CreateNVP(logDetCov, "logDetCov");
+  }
+
+ private:
+  /**
+   * Cache the inverse of the variances and the log-determinant of the
+   * covariance.
+   */
+  void InvertCovariance();
+};
+
+/**
+ * Calculates the multivariate Gaussian log probability density function for
+ * each data point (column) in the given matrix.
+ *
+ * @param x List of observations.
+ * @param probabilities Output log probabilities for each input observation.
+ */
+inline void DiagonalGaussianDistribution::LogProbability(
+    const arma::mat& x,
+    arma::vec& logProbabilities) const
+{
+  // Column i of 'diffs' is the difference between x.col(i) and the mean.
+  const arma::mat diffs = x.each_col() - mean;
+
+  // The Mahalanobis distances of all the observations are the squared
+  // differences weighted by the inverse variances, which is a single
+  // matrix-vector product.
+  const arma::vec logExponents = -0.5 * (trans(arma::square(diffs)) * invCov);
+
+  const size_t k = x.n_rows;
+
+  logProbabilities = -0.5 * k * log2pi - 0.5 * logDetCov + logExponents;
+}
+
+} // namespace distribution
+} // namespace mlpack
+
+#endif
@@ -49,6 +49,72 @@ arma::vec DiscreteDistribution::Random() const
   return result;
 }
 
+arma::uvec DiscreteDistribution::ObservationIndices(
+    const arma::mat& observations,
+    const size_t dimension) const
+{
+  // Adding 0.5 helps ensure that we cast the floating point to a size_t
+  // correctly.
+  const arma::uvec indices = arma::conv_to<arma::uvec>::from(
+      observations.row(dimension) + 0.5);
+
+  if (indices.n_elem > 0 && indices.max() >= probabilities[dimension].n_elem)
+  {
+    Log::Fatal << "DiscreteDistribution::Probability(): received "
+        << "observation " << indices.max() << "; observation must be in [0, "
+        << probabilities[dimension].n_elem << "] for this distribution."
+        << std::endl;
+  }
+
+  return indices;
+}
+
+/**
+ * Compute the probability of each of the given observations.
+ */
+void DiscreteDistribution::Probability(
+    const arma::mat& observations,
+    arma::vec& observationProbabilities) const
+{
+  // Ensure the observations have the same dimension as the probabilities.
+  if (observations.n_rows != probabilities.size())
+  {
+    Log::Fatal << "DiscreteDistribution::Probability(): observations have "
+        << "incorrect dimension " << observations.n_rows << " but should have "
+        << "dimension " << probabilities.size() << "!" << std::endl;
+  }
+
+  observationProbabilities.ones(observations.n_cols);
+  for (size_t d = 0; d < observations.n_rows; ++d)
+  {
+    observationProbabilities %= probabilities[d].elem(
+        ObservationIndices(observations, d));
+  }
+}
+
+/**
+ * Compute the log probability of each of the given observations.
+ */
+void DiscreteDistribution::LogProbability(
+    const arma::mat& observations,
+    arma::vec& logProbabilities) const
+{
+  // Ensure the observations have the same dimension as the probabilities.
+  if (observations.n_rows != probabilities.size())
+  {
+    Log::Fatal << "DiscreteDistribution::LogProbability(): observations have "
+        << "incorrect dimension " << observations.n_rows << " but should have "
+        << "dimension " << probabilities.size() << "!" << std::endl;
+  }
+
+  logProbabilities.zeros(observations.n_cols);
+  for (size_t d = 0; d < observations.n_rows; ++d)
+  {
+    const arma::vec logTable = arma::log(probabilities[d]);
+    logProbabilities += logTable.elem(ObservationIndices(observations, d));
+  }
+}
+
 /**
  * Estimate the probability distribution directly from the given observations.
  */
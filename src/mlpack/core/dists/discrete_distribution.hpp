@@ -168,6 +168,28 @@ class DiscreteDistribution
     return log(Probability(observation));
   }
 
+  /**
+   * Compute the probability of each of the given observations (one per
+   * column).  The probabilities of each dimension are gathered from its table
+   * for all the observations at once.
+   *
+   * @param observations Observations to compute the probability of.
+   * @param observationProbabilities Output probability of each observation.
+   */
+  void Probability(const arma::mat& observations,
+                   arma::vec& observationProbabilities) const;
+
+  /**
+   * Compute the log probability of each of the given observations (one per
+   * column).  The logs of the tables are gathered, so no product can
+   * underflow.
+   *
+   * @param observations Observations to compute the log probability of.
+   * @param logProbabilities Output log probability of each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation (one-dimensional vector; one
    * observation) according to the probability distribution defined by this
@@ -231,6 +253,13 @@ class DiscreteDistribution
   }
 
  private:
+  /**
+   * Convert the given dimension of the observations to indices into the table
+   * of that dimension, checking that they are within its bounds.
+   */
+  arma::uvec ObservationIndices(const arma::mat& observations,
+                                const size_t dimension) const;
+
   //! The probabilities for each dimension; each arma::vec represents the
   //! probabilities for the observations in each dimension.
   std::vector<arma::vec> probabilities;
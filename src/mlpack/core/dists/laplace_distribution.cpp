@@ -26,6 +26,17 @@ double LaplaceDistribution::LogProbability(const arma::vec& observation) const
   return -log(2. * scale) - arma::norm(observation - mean, 2) / scale;
 }
 
+/**
+ * Return the log probability of each of the given observations.
+ */
+void LaplaceDistribution::LogProbability(const arma::mat& observations,
+                                         arma::vec& logProbabilities) const
+{
+  const arma::mat diffs = observations.each_col() - mean;
+  logProbabilities = -log(2. * scale) -
+      arma::sqrt(arma::sum(arma::square(diffs), 0)).t() / scale;
+}
+
 /**
  * Estimate the Laplace distribution directly from the given observations.
  *
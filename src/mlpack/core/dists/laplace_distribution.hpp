@@ -90,6 +90,31 @@ class LaplaceDistribution
    */
   double LogProbability(const arma::vec& observation) const;
 
+  /**
+   * Compute the probability of each of the given observations (one per
+   * column).
+   *
+   * @param observations Observations to compute the probability of.
+   * @param probabilities Output probability of each observation.
+   */
+  void Probability(const arma::mat& observations,
+                   arma::vec& probabilities) const
+  {
+    arma::vec logProbabilities;
+    LogProbability(observations, logProbabilities);
+    probabilities = arma::exp(logProbabilities);
+  }
+
+  /**
+   * Compute the log probability of each of the given observations (one per
+   * column).
+   *
+   * @param observations Observations to compute the log probability of.
+   * @param logProbabilities Output log probability of each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.  This is inlined for speed.
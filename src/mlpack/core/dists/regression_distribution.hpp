@@ -128,6 +128,26 @@ class RegressionDistribution
     return log(Probability(observation));
   }
 
+  /**
+   * Evaluate the probability density function of each of the given
+   * observations; the regression is predicted for all of them at once.
+   *
+   * @param observations Points to evaluate the probability at.
+   * @param probabilities Output probability of each observation.
+   */
+  void Probability(const arma::mat& observations,
+                   arma::vec& probabilities) const;
+
+  /**
+   * Evaluate the log probability density function of each of the given
+   * observations; the regression is predicted for all of them at once.
+   *
+   * @param observations Points to evaluate the log probability at.
+   * @param logProbabilities Output log probability of each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Calculate y_i for each data point in points.
    *
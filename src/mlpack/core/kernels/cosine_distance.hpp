@@ -41,6 +41,17 @@ class CosineDistance
   template<typename VecTypeA, typename VecTypeB>
   static double Evaluate(const VecTypeA& a, const VecTypeB& b);
 
+  /**
+   * Computes the cosine distance between every column of a and every column of
+   * b with one matrix product; result(i, j) is d(a.col(i), b.col(j)).
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param result Matrix to store the distances in.
+   */
+  static void Evaluate(const arma::mat& a, const arma::mat& b,
+                       arma::mat& result);
+
   //! Serialize the class (there's nothing to save).
   template<typename Archive>
   void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
@@ -56,6 +67,9 @@ class KernelTraits<CosineDistance>
 
   //! The cosine kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+
+  //! The cosine kernel can be evaluated in batches.
+  static const bool HasBatchEvaluate = true;
 };
 
 } // namespace kernel
@@ -32,6 +32,24 @@ double CosineDistance::Evaluate(const VecTypeA& a, const VecTypeB& b)
     return dot(a, b) / denominator;
 }
 
+inline void CosineDistance::Evaluate(const arma::mat& a,
+                                     const arma::mat& b,
+                                     arma::mat& result)
+{
+  // Points with norm zero have cosine similarity zero with every point, like
+  // above.
+  auto inverse = [](const double n) { return (n == 0.0) ? 0.0 : 1.0 / n; };
+  arma::vec aInverseNorms = arma::trans(arma::sqrt(arma::sum(arma::square(a),
+      0)));
+  arma::rowvec bInverseNorms = arma::sqrt(arma::sum(arma::square(b), 0));
+  aInverseNorms.transform(inverse);
+  bInverseNorms.transform(inverse);
+
+  result = a.t() * b;
+  result.each_col() %= aInverseNorms;
+  result.each_row() %= bInverseNorms;
+}
+
 } // namespace kernel
 } // namespace mlpack
 
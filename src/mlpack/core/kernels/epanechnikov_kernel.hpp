@@ -14,6 +14,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/kernels/kernel_traits.hpp>
+#include <mlpack/core/kernels/squared_distances.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -57,6 +58,18 @@ class EpanechnikovKernel
    */
   double Evaluate(const double distance) const;
 
+  /**
+   * Evaluate the Epanechnikov kernel between every column of a and every
+   * column of b, from the squared distances computed with one matrix product;
+   * result(i, j) is K(a.col(i), b.col(j)).
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param result Matrix to store the kernel values in.
+   */
+  void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& result)
+      const;
+
   /**
    * Evaluate the Gradient of Epanechnikov kernel
    * given that the distance between the two
@@ -111,6 +124,10 @@ class KernelTraits<EpanechnikovKernel>
   static const bool IsNormalized = true;
   //! The Epanechnikov kernel includes a squared distance.
   static const bool UsesSquaredDistance = true;
+  //! The Epanechnikov kernel can be evaluated in batches.
+  static const bool HasBatchEvaluate = true;
+  //! The Epanechnikov kernel decreases with the distance.
+  static const bool DecreasesWithDistance = true;
 };
 
 } // namespace kernel
@@ -29,6 +29,16 @@ inline double EpanechnikovKernel::Evaluate(const VecTypeA& a, const VecTypeB& b)
       * inverseBandwidthSquared);
 }
 
+inline void EpanechnikovKernel::Evaluate(const arma::mat& a,
+                                         const arma::mat& b,
+                                         arma::mat& result) const
+{
+  SquaredDistances(a, b, result);
+  const double scale = inverseBandwidthSquared;
+  result.transform([scale](const double d)
+      { return std::max(0.0, 1.0 - d * scale); });
+}
+
 /**
  * Obtains the convolution integral [integral of K(||x-a||) K(||b-x||) dx]
  * for the two vectors.
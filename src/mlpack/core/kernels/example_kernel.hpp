@@ -65,6 +65,13 @@ namespace kernel {
  * not strictly mandatory) that your default constructor still gives a working
  * kernel.
  *
+ * If the kernel values between two sets of points can be computed faster all
+ * at once than one pair at a time (for instance with one matrix product), the
+ * kernel can also implement
+ * `void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& result)`
+ * and set `HasBatchEvaluate` to true in its KernelTraits specialization; then
+ * KernelMatrix() (in kernel_matrix.hpp) will use it.
+ *
  * @note
  * Not all kernels require state.  For instance, the regular dot product needs
  * no parameters.  In that case, no local variables are necessary and
@@ -17,6 +17,7 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/kernels/kernel_traits.hpp>
+#include <mlpack/core/kernels/squared_distances.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -68,6 +69,22 @@ class GaussianKernel
     return exp(gamma * metric::SquaredEuclideanDistance::Evaluate(a, b));
   }
 
+  /**
+   * Evaluate the Gaussian kernel between every column of a and every column of
+   * b; result(i, j) is K(a.col(i), b.col(j)).  The squared distances are
+   * computed from one matrix product (see SquaredDistances()).
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param result Matrix to store the kernel values in.
+   */
+  void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& result)
+      const
+  {
+    SquaredDistances(a, b, result);
+    result = arma::exp(gamma * result);
+  }
+
   /**
    * Evaluation of the Gaussian kernel given the distance between two points.
    *
@@ -171,6 +188,10 @@ class KernelTraits<GaussianKernel>
   static const bool IsNormalized = true;
   //! The Gaussian kernel includes a squared distance.
   static const bool UsesSquaredDistance = true;
+  //! The Gaussian kernel can be evaluated in batches.
+  static const bool HasBatchEvaluate = true;
+  //! The Gaussian kernel decreases with the distance.
+  static const bool DecreasesWithDistance = true;
 };
 
 } // namespace kernel
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_KERNELS_HYPERBOLIC_TANGENT_KERNEL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -62,6 +63,21 @@ class HyperbolicTangentKernel
     return tanh(scale * arma::dot(a, b) + offset);
   }
 
+  /**
+   * Evaluate the hyperbolic tangent kernel between every column of a and every
+   * column of b with one matrix product; result(i, j) is
+   * K(a.col(i), b.col(j)).
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param result Matrix to store the kernel values in.
+   */
+  void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& result)
+      const
+  {
+    result = arma::tanh(scale * (a.t() * b) + offset);
+  }
+
   //! Get scale factor.
   double Scale() const { return scale; }
   //! Modify scale factor.
@@ -85,6 +101,19 @@ class HyperbolicTangentKernel
   double offset;
 };
 
+//! Kernel traits for the hyperbolic tangent kernel.
+template<>
+class KernelTraits<HyperbolicTangentKernel>
+{
+ public:
+  //! The hyperbolic tangent kernel is not normalized.
+  static const bool IsNormalized = false;
+  //! The hyperbolic tangent kernel doesn't include a squared distance.
+  static const bool UsesSquaredDistance = false;
+  //! The hyperbolic tangent kernel can be evaluated in batches.
+  static const bool HasBatchEvaluate = true;
+};
+
 } // namespace kernel
 } // namespace mlpack
 
@@ -0,0 +1,131 @@
+/**
+ * @file kernel_matrix.hpp
+ *
+ * Compute the kernel values between two sets of points.  If the kernel can be
+ * evaluated in batches (KernelTraits<KernelType>::HasBatchEvaluate), its
+ * batched Evaluate() is used, which for the linear, polynomial and Gaussian
+ * kernels is one matrix product and an element-wise transform; otherwise, the
+ * kernel is evaluated one pair of points at a time, in parallel with OpenMP.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+#define MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Compute the kernel between every column of a and every column of b, so that
+ * result(i, j) is K(a.col(i), b.col(j)), with the batched Evaluate() of the
+ * kernel.
+ */
+template<typename KernelType, typename MatType>
+inline void KernelMatrix(
+    KernelType& kernel,
+    const MatType& a,
+    const MatType& b,
+    arma::mat& result,
+    const typename std::enable_if_t<
+        KernelTraits<KernelType>::HasBatchEvaluate &&
+        std::is_same<MatType, arma::mat>::value>* = 0)
+{
+  kernel.Evaluate(a, b, result);
+}
+
+/**
+ * Compute the kernel between every column of a and every column of b, so that
+ * result(i, j) is K(a.col(i), b.col(j)), one pair of points at a time.  The
+ * columns of the result are computed in parallel.
+ */
+template<typename KernelType, typename MatType>
+inline void KernelMatrix(
+    KernelType& kernel,
+    const MatType& a,
+    const MatType& b,
+    arma::mat& result,
+    const typename std::enable_if_t<
+        !(KernelTraits<KernelType>::HasBatchEvaluate &&
+        std::is_same<MatType, arma::mat>::value)>* = 0)
+{
+  result.set_size(a.n_cols, b.n_cols);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t j = 0; j < (intmax_t) b.n_cols; ++j)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t j = 0; j < b.n_cols; ++j)
+#endif
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+      result(i, j) = kernel.Evaluate(a.col(i), b.col(j));
+  }
+}
+
+/**
+ * Compute the kernel matrix of the given points, so that result(i, j) is
+ * K(data.col(i), data.col(j)), with the batched Evaluate() of the kernel.
+ */
+template<typename KernelType, typename MatType>
+inline void KernelMatrix(
+    KernelType& kernel,
+    const MatType& data,
+    arma::mat& result,
+    const typename std::enable_if_t<
+        KernelTraits<KernelType>::HasBatchEvaluate &&
+        std::is_same<MatType, arma::mat>::value>* = 0)
+{
+  kernel.Evaluate(data, data, result);
+}
+
+/**
+ * Compute the kernel matrix of the given points, so that result(i, j) is
+ * K(data.col(i), data.col(j)), one pair of points at a time.  Since the kernel
+ * matrix is symmetric, only its upper triangular part is evaluated (in
+ * parallel), and then copied to the lower triangular part.
+ */
+template<typename KernelType, typename MatType>
+inline void KernelMatrix(
+    KernelType& kernel,
+    const MatType& data,
+    arma::mat& result,
+    const typename std::enable_if_t<
+        !(KernelTraits<KernelType>::HasBatchEvaluate &&
+        std::is_same<MatType, arma::mat>::value)>* = 0)
+{
+  result.set_size(data.n_cols, data.n_cols);
+
+  // The columns hold different numbers of evaluations, so schedule them
+  // dynamically.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t j = 0; j < (intmax_t) data.n_cols; ++j)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t j = 0; j < data.n_cols; ++j)
+#endif
+  {
+    for (size_t i = 0; i <= (size_t) j; ++i)
+      result(i, j) = kernel.Evaluate(data.col(i), data.col(j));
+  }
+
+  result = arma::symmatu(result);
+}
+
+} // namespace kernel
+} // namespace mlpack
+
+#endif
@@ -36,6 +36,22 @@ class KernelTraits
    * If true, then the kernel include a squared distance, ||x - y||^2 .
    */
   static const bool UsesSquaredDistance = false;
+
+  /**
+   * If true, then the kernel has a member
+   * void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& result),
+   * which computes the kernel between every column of a and every column of b
+   * at once (see KernelMatrix()).
+   */
+  static const bool HasBatchEvaluate = false;
+
+  /**
+   * If true, then the kernel is a non-increasing function of the distance
+   * between the points, and has a member double Evaluate(const double distance)
+   * const.  This allows the kernel between the points of two tree nodes to be
+   * bounded with their minimum and maximum distances (see kde::KDE).
+   */
+  static const bool DecreasesWithDistance = false;
 };
 
 } // namespace kernel
@@ -13,6 +13,8 @@
 #define MLPACK_CORE_KERNELS_LAPLACIAN_KERNEL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
+#include <mlpack/core/kernels/squared_distances.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -78,6 +80,22 @@ class LaplacianKernel
     return exp(-t / bandwidth);
   }
 
+  /**
+   * Evaluate the Laplacian kernel between every column of a and every column
+   * of b, from the squared distances computed with one matrix product;
+   * result(i, j) is K(a.col(i), b.col(j)).
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param result Matrix to store the kernel values in.
+   */
+  void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& result)
+      const
+  {
+    SquaredDistances(a, b, result);
+    result = arma::exp(-arma::sqrt(result) / bandwidth);
+  }
+
   /**
    * Evaluation of the gradient of the Laplacian kernel
    * given the distance between two points.
@@ -117,6 +135,10 @@ class KernelTraits<LaplacianKernel>
   static const bool IsNormalized = true;
   //! The Laplacian kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The Laplacian kernel can be evaluated in batches.
+  static const bool HasBatchEvaluate = true;
+  //! The Laplacian kernel decreases with the distance.
+  static const bool DecreasesWithDistance = true;
 };
 
 } // namespace kernel
@@ -15,6 +15,7 @@
 #define MLPACK_CORE_KERNELS_LINEAR_KERNEL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -55,11 +56,38 @@ class LinearKernel
     return arma::dot(a, b);
   }
 
+  /**
+   * Evaluate the linear kernel between every column of a and every column of b
+   * with one matrix product; result(i, j) is K(a.col(i), b.col(j)).
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param result Matrix to store the kernel values in.
+   */
+  static void Evaluate(const arma::mat& a, const arma::mat& b,
+                       arma::mat& result)
+  {
+    result = a.t() * b;
+  }
+
   //! Serialize the kernel (it has no members... do nothing).
   template<typename Archive>
   void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
 };
 
+//! Kernel traits for the linear kernel.
+template<>
+class KernelTraits<LinearKernel>
+{
+ public:
+  //! The linear kernel is not normalized.
+  static const bool IsNormalized = false;
+  //! The linear kernel doesn't include a squared distance.
+  static const bool UsesSquaredDistance = false;
+  //! The linear kernel can be evaluated in batches.
+  static const bool HasBatchEvaluate = true;
+};
+
 } // namespace kernel
 } // namespace mlpack
 
@@ -15,10 +15,41 @@
  */
 #include "pspectrum_string_kernel.hpp"
 
+#include <mlpack/core/util/execution.hpp>
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::kernel;
 
+namespace {
+
+//! Map a character to one of the 36 alphanumeric symbols, or return -1.
+inline int Symbol(const char c)
+{
+  const unsigned char u = (unsigned char) c;
+  if (u >= '0' && u <= '9')
+    return u - '0';
+  if (u >= 'a' && u <= 'z')
+    return 10 + (u - 'a');
+  if (u >= 'A' && u <= 'Z')
+    return 10 + (u - 'A');
+  return -1;
+}
+
+} // anonymous namespace
+
+int PSpectrumStringKernel::Spectrum::operator[](
+    const std::string& substring) const
+{
+  uint64_t id;
+  if (!SubstringID(substring.data(), substring.length(), id))
+    return 0;
+
+  const std::vector<uint64_t>::const_iterator it = std::lower_bound(
+      ids.begin(), ids.end(), id);
+  return (it != ids.end() && *it == id) ? counts[it - ids.begin()] : 0;
+}
+
 /**
  * Initialize the PSpectrumStringKernel with the given string datasets.  For
  * more information on this, see the general class documentation.
@@ -32,8 +63,8 @@ mlpack::kernel::PSpectrumStringKernel::PSpectrumStringKernel(
     datasets(datasets),
     p(p)
 {
-  // We have to assemble the counts of substrings.  This is not a particularly
-  // fast operation, unfortunately, but it only needs to be done once.
+  // We have to assemble the counts of substrings.  This only needs to be done
+  // once, and the strings are independent.
   Log::Info << "Assembling counts of substrings of length " << p << "."
       << std::endl;
 
@@ -48,41 +79,79 @@ mlpack::kernel::PSpectrumStringKernel::PSpectrumStringKernel(
     counts[dataset].resize(set.size());
 
     // Inspect each string in the dataset.
-    for (size_t index = 0; index < set.size(); ++index)
+    util::Execution::ParallelFor(set.size(), [&](const size_t index)
     {
-      // Convenience references.
-      const std::string& str = set[index];
-      std::map<std::string, int>& mapping = counts[dataset][index];
-
-      size_t start = 0;
-      while ((start + p) <= str.length())
-      {
-        string sub = str.substr(start, p);
-
-        // Convert all characters to lowercase.
-        bool invalid = false;
-        for (size_t j = 0; j < p; ++j)
-        {
-          if (!isalnum(sub[j]))
-          {
-            invalid = true;
-            break; // Only consider substrings with alphanumerics.
-          }
-
-          sub[j] = tolower(sub[j]);
-        }
-
-        // Increment position in string.
-        ++start;
-
-        if (!invalid)
-        {
-          // Add to the map.
-          ++mapping[sub];
-        }
-      }
-    }
+      ExtractSpectrum(set[index], p, counts[dataset][index]);
+    }, 16);
   }
 
   Log::Info << "Substring extraction complete." << std::endl;
 }
+
+bool PSpectrumStringKernel::SubstringID(const char* substring,
+                                        const size_t p,
+                                        uint64_t& id)
+{
+  // Each character is a digit from 1 to 36 in base 37, and 37^12 < 2^64, so
+  // substrings of up to 12 characters get distinct IDs, whatever their
+  // length.  Longer substrings are hashed with FNV-1a, followed by the
+  // finalizer of MurmurHash3 to mix the bits.
+  const bool exact = (p <= 12);
+  id = exact ? 0 : 14695981039346656037ULL;
+  for (size_t j = 0; j < p; ++j)
+  {
+    const int symbol = Symbol(substring[j]);
+    if (symbol < 0)
+      return false; // Only consider substrings with alphanumerics.
+
+    if (exact)
+      id = 37 * id + (uint64_t) symbol + 1;
+    else
+      id = (id ^ (uint64_t) symbol) * 1099511628211ULL;
+  }
+
+  if (!exact)
+  {
+    id ^= id >> 33;
+    id *= 0xff51afd7ed558ccdULL;
+    id ^= id >> 33;
+    id *= 0xc4ceb9fe1a85ec53ULL;
+    id ^= id >> 33;
+  }
+
+  return true;
+}
+
+void PSpectrumStringKernel::ExtractSpectrum(const std::string& str,
+                                            const size_t p,
+                                            Spectrum& spectrum)
+{
+  // Collect the IDs of every substring of length p whose characters are all
+  // alphanumeric.
+  std::vector<uint64_t> substringIDs;
+  if (str.length() + 1 > p)
+    substringIDs.reserve(str.length() + 1 - p);
+  for (size_t start = 0; start + p <= str.length(); ++start)
+  {
+    uint64_t id;
+    if (SubstringID(str.data() + start, p, id))
+      substringIDs.push_back(id);
+  }
+
+  // Sort the IDs, and count the number of times each one appears.
+  std::sort(substringIDs.begin(), substringIDs.end());
+  spectrum.IDs().clear();
+  spectrum.Counts().clear();
+  for (size_t i = 0; i < substringIDs.size(); ++i)
+  {
+    if (i > 0 && substringIDs[i] == substringIDs[i - 1])
+    {
+      ++spectrum.Counts().back();
+    }
+    else
+    {
+      spectrum.IDs().push_back(substringIDs[i]);
+      spectrum.Counts().push_back(1);
+    }
+  }
+}
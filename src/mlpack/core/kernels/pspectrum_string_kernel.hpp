@@ -16,7 +16,6 @@
 #ifndef MLPACK_CORE_KERNELS_PSPECTRUM_STRING_KERNEL_HPP
 #define MLPACK_CORE_KERNELS_PSPECTRUM_STRING_KERNEL_HPP
 
-#include <map>
 #include <string>
 #include <vector>
 
@@ -65,9 +64,48 @@ namespace kernel {
 class PSpectrumStringKernel
 {
  public:
+  /**
+   * The p-spectrum of one string: the IDs of its distinct substrings of length
+   * p, in increasing order, and the number of times each of them appears.  The
+   * ID of a substring of at most 12 characters is exact; longer substrings are
+   * identified by a 64-bit hash.  Like a std::map, a Spectrum can be indexed by
+   * substring.
+   */
+  class Spectrum
+  {
+   public:
+    //! Get the number of distinct substrings.
+    size_t size() const { return ids.size(); }
+
+    /**
+     * Get the number of times the given substring appears in the string (0 if
+     * it does not appear).
+     *
+     * @param substring Substring of length p to look up.
+     */
+    int operator[](const std::string& substring) const;
+
+    //! Get the IDs of the substrings.
+    const std::vector<uint64_t>& IDs() const { return ids; }
+    //! Modify the IDs of the substrings.
+    std::vector<uint64_t>& IDs() { return ids; }
+
+    //! Get the number of times each substring appears.
+    const std::vector<int>& Counts() const { return counts; }
+    //! Modify the number of times each substring appears.
+    std::vector<int>& Counts() { return counts; }
+
+   private:
+    //! The sorted IDs of the distinct substrings.
+    std::vector<uint64_t> ids;
+    //! The number of times each substring appears.
+    std::vector<int> counts;
+  };
+
   /**
    * Initialize the PSpectrumStringKernel with the given string datasets.  For
-   * more information on this, see the general class documentation.
+   * more information on this, see the general class documentation.  The
+   * spectra of the strings are extracted in parallel.
    *
    * @param datasets Sets of string data.
    * @param p The length of substrings to search.
@@ -81,7 +119,8 @@ class PSpectrumStringKernel
    * element contains the index of the dataset and the second element contains
    * the index of the string.  Therefore, if [2 3] is passed for a, the string
    * used will be datasets[2][3] (datasets is of type
-   * std::vector<std::vector<std::string> >&).
+   * std::vector<std::vector<std::string> >&).  The evaluation is a merge of
+   * the sorted IDs of the two spectra.
    *
    * @param a Index of string and dataset for first string.
    * @param b Index of string and dataset for second string.
@@ -89,12 +128,10 @@ class PSpectrumStringKernel
   template<typename VecType>
   double Evaluate(const VecType& a, const VecType& b) const;
 
-  //! Access the lists of substrings.
-  const std::vector<std::vector<std::map<std::string, int> > >& Counts() const
-  { return counts; }
-  //! Modify the lists of substrings.
-  std::vector<std::vector<std::map<std::string, int> > >& Counts()
-  { return counts; }
+  //! Access the spectra of the strings.
+  const std::vector<std::vector<Spectrum> >& Counts() const { return counts; }
+  //! Modify the spectra of the strings.
+  std::vector<std::vector<Spectrum> >& Counts() { return counts; }
 
   //! Access the value of p.
   size_t P() const { return p; }
@@ -102,12 +139,25 @@ class PSpectrumStringKernel
   size_t& P() { return p; }
 
  private:
+  /**
+   * Compute the ID of the given substring of length p.  Characters are
+   * compared without case.  If the substring holds a character that is not
+   * alphanumeric, false is returned.
+   */
+  static bool SubstringID(const char* substring,
+                          const size_t p,
+                          uint64_t& id);
+
+  //! Extract the spectrum of the given string.
+  static void ExtractSpectrum(const std::string& str,
+                              const size_t p,
+                              Spectrum& spectrum);
+
   //! The datasets.
   const std::vector<std::vector<std::string> >& datasets;
 
-  //! Mappings of the datasets to counts of substrings.  Such a huge structure
-  //! is not wonderful...
-  std::vector<std::vector<std::map<std::string, int> > > counts;
+  //! The spectra of the strings of each dataset.
+  std::vector<std::vector<Spectrum> > counts;
 
   //! The value of p to use in calculation.
   size_t p;
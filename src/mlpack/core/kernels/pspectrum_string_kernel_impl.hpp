@@ -36,39 +36,32 @@ template<typename VecType>
 double PSpectrumStringKernel::Evaluate(const VecType& a,
                                        const VecType& b) const
 {
-  // Get the map of substrings for the two strings we are interested in.
-  const std::map<std::string, int>& aMap = counts[a[0]][a[1]];
-  const std::map<std::string, int>& bMap = counts[b[0]][b[1]];
+  // Get the spectra of the two strings we are interested in.
+  const Spectrum& aSpectrum = counts[(size_t) a[0]][(size_t) a[1]];
+  const Spectrum& bSpectrum = counts[(size_t) b[0]][(size_t) b[1]];
+  const std::vector<uint64_t>& aIDs = aSpectrum.IDs();
+  const std::vector<uint64_t>& bIDs = bSpectrum.IDs();
 
   double eval = 0;
 
-  // Loop through the two maps (which, when iterated through, are sorted
-  // alphabetically).
-  std::map<std::string, int>::const_iterator aIt = aMap.begin();
-  std::map<std::string, int>::const_iterator bIt = bMap.begin();
-
-  while ((aIt != aMap.end()) && (bIt != bMap.end()))
+  // Both lists of IDs are sorted, so walk through them in lockstep.
+  size_t i = 0;
+  size_t j = 0;
+  while ((i < aIDs.size()) && (j < bIDs.size()))
   {
-    // Compare alphabetically (this is how std::map is ordered).
-    int result = (*aIt).first.compare((*bIt).first);
-
-    if (result == 0) // The same substring.
+    if (aIDs[i] == bIDs[j]) // The same substring.
     {
-      eval += ((*aIt).second * (*bIt).second);
-
-      // Now increment both.
-      ++aIt;
-      ++bIt;
+      eval += (double) aSpectrum.Counts()[i] * bSpectrum.Counts()[j];
+      ++i;
+      ++j;
     }
-    else if (result > 0)
+    else if (aIDs[i] < bIDs[j])
     {
-      // aIt is "ahead" of bIt (alphabetically); so increment bIt to "catch up".
-      ++bIt;
+      ++i;
     }
     else
     {
-      // bIt is "ahead" of aIt (alphabetically); so increment aIt to "catch up".
-      ++aIt;
+      ++j;
     }
   }
 
@@ -0,0 +1,201 @@
+/**
+ * @file random_fourier_features.hpp
+ *
+ * Random Fourier features (Rahimi and Recht, 2007): an explicit, randomized
+ * feature map whose inner products approximate a shift-invariant kernel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_KERNELS_RANDOM_FOURIER_FEATURES_HPP
+#define MLPACK_CORE_KERNELS_RANDOM_FOURIER_FEATURES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/laplacian_kernel.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * 'value' is true if RandomFourierFeatures can approximate the given kernel,
+ * that is, if the kernel is shift-invariant and the distribution of its
+ * frequencies is known.
+ */
+template<typename KernelType>
+struct HasFourierFeatures
+{
+  static const bool value = false;
+};
+
+//! The frequencies of the Gaussian kernel are normally distributed.
+template<>
+struct HasFourierFeatures<GaussianKernel>
+{
+  static const bool value = true;
+};
+
+//! The frequencies of the Laplacian kernel follow a multivariate Cauchy
+//! distribution.
+template<>
+struct HasFourierFeatures<LaplacianKernel>
+{
+  static const bool value = true;
+};
+
+/**
+ * Map points to D random Fourier features,
+ *
+ * @f[
+ * z(x) = \sqrt{2 / D} \cos(W x + b),
+ * @f]
+ *
+ * where the rows of W are drawn from the Fourier transform of the kernel and
+ * the offsets b are uniform in [0, 2 pi), so that z(x)^T z(y) is an unbiased
+ * estimate of K(x, y) whose error shrinks like 1 / sqrt(D).  Mapping a set of
+ * points is a single matrix multiplication with W followed by an elementwise
+ * cosine, so linear methods on the features (PCA, LogisticRegression, linear
+ * SVMs) approximate their kernel versions in time linear in the number of
+ * points, without landmarks or kernel evaluations.
+ *
+ * The GaussianKernel and LaplacianKernel are supported (see
+ * HasFourierFeatures).
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @inproceedings{rahimi2007random,
+ *   title={Random Features for Large-Scale Kernel Machines},
+ *   author={Rahimi, Ali and Recht, Benjamin},
+ *   booktitle={Advances in Neural Information Processing Systems 20},
+ *   pages={1177--1184},
+ *   year={2007}
+ * }
+ * @endcode
+ *
+ * @tparam KernelType Shift-invariant kernel to approximate.
+ */
+template<typename KernelType>
+class RandomFourierFeatures
+{
+  static_assert(HasFourierFeatures<KernelType>::value, "RandomFourierFeatures "
+      "only supports the GaussianKernel and the LaplacianKernel");
+
+ public:
+  /**
+   * Draw the random features for points of the given dimensionality.  The
+   * features are drawn with math::RandGen(), so they depend on the random
+   * seed.
+   *
+   * @param dimensionality Dimensionality of the points.
+   * @param numFeatures Number of features (D).
+   * @param kernel Kernel to approximate.
+   */
+  RandomFourierFeatures(const size_t dimensionality = 0,
+                        const size_t numFeatures = 0,
+                        const KernelType& kernel = KernelType())
+  {
+    SampleFrequencies(kernel, dimensionality, numFeatures);
+
+    offsets.set_size(numFeatures);
+    for (size_t i = 0; i < numFeatures; ++i)
+      offsets[i] = 2.0 * M_PI * math::Random();
+  }
+
+  /**
+   * Map the given points (one per column) to their features (one column of
+   * NumFeatures() features per point).
+   *
+   * @param data Points to map.
+   * @param features Matrix to store the features in.
+   */
+  void Transform(const arma::mat& data, arma::mat& features) const
+  {
+    if (data.n_rows != frequencies.n_cols)
+    {
+      std::ostringstream oss;
+      oss << "RandomFourierFeatures::Transform(): the points have "
+          << data.n_rows << " dimensions, but the features were drawn for "
+          << frequencies.n_cols << " dimensions";
+      throw std::invalid_argument(oss.str());
+    }
+
+    features = frequencies * data;
+
+    const double scale = std::sqrt(2.0 / frequencies.n_rows);
+    const size_t numFeatures = frequencies.n_rows;
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(static)
+    for (intmax_t j = 0; j < (intmax_t) features.n_cols; ++j)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < features.n_cols; ++j)
+#endif
+    {
+      double* column = features.colptr(j);
+      for (size_t i = 0; i < numFeatures; ++i)
+        column[i] = scale * std::cos(column[i] + offsets[i]);
+    }
+  }
+
+  //! Get the number of features.
+  size_t NumFeatures() const { return frequencies.n_rows; }
+
+  //! Get the frequencies (W, one row per feature).
+  const arma::mat& Frequencies() const { return frequencies; }
+  //! Get the offsets (b).
+  const arma::vec& Offsets() const { return offsets; }
+
+  //! Serialize the features.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(frequencies, "frequencies");
+    ar & data::CreateNVP(offsets, "offsets");
+  }
+
+ private:
+  //! The frequencies, one row per feature.
+  arma::mat frequencies;
+  //! The offsets of the features.
+  arma::vec offsets;
+
+  //! The Fourier transform of exp(-||x - y||^2 / (2 mu^2)) is the density of
+  //! N(0, I / mu^2).
+  void SampleFrequencies(const GaussianKernel& kernel,
+                         const size_t dimensionality,
+                         const size_t numFeatures)
+  {
+    frequencies.set_size(numFeatures, dimensionality);
+    for (size_t i = 0; i < frequencies.n_elem; ++i)
+      frequencies[i] = math::RandNormal() / kernel.Bandwidth();
+  }
+
+  //! The Fourier transform of exp(-||x - y|| / mu) is the density of the
+  //! multivariate Cauchy distribution with scale 1 / mu, which is a standard
+  //! normal vector divided by mu times the absolute value of an independent
+  //! standard normal value.
+  void SampleFrequencies(const LaplacianKernel& kernel,
+                         const size_t dimensionality,
+                         const size_t numFeatures)
+  {
+    frequencies.set_size(numFeatures, dimensionality);
+    for (size_t i = 0; i < numFeatures; ++i)
+    {
+      const double scale = 1.0 / (kernel.Bandwidth() *
+          std::abs(math::RandNormal()));
+      for (size_t j = 0; j < dimensionality; ++j)
+        frequencies(i, j) = scale * math::RandNormal();
+    }
+  }
+};
+
+} // namespace kernel
+} // namespace mlpack
+
+#endif
@@ -126,6 +126,11 @@ class KernelTraits<SphericalKernel>
   static const bool IsNormalized = true;
   //! The spherical kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The spherical kernel is a step at the bandwidth, so it is evaluated one
+  //! pair at a time, with exact distances.
+  static const bool HasBatchEvaluate = false;
+  //! The spherical kernel decreases with the distance.
+  static const bool DecreasesWithDistance = true;
 };
 
 } // namespace kernel
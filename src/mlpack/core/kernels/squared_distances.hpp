@@ -0,0 +1,43 @@
+/**
+ * @file squared_distances.hpp
+ *
+ * Compute the squared Euclidean distances between two sets of points with one
+ * matrix product, for the batched Evaluate() of distance-based kernels.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_KERNELS_SQUARED_DISTANCES_HPP
+#define MLPACK_CORE_KERNELS_SQUARED_DISTANCES_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Compute the squared Euclidean distance between every column of a and every
+ * column of b, as ||a_i||^2 + ||b_j||^2 - 2 a_i^T b_j, so that result(i, j) is
+ * the squared distance between a.col(i) and b.col(j).  The cancellation in the
+ * sum can make some distances slightly negative, so they are clamped to zero.
+ *
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param result Matrix to store the squared distances in.
+ */
+inline void SquaredDistances(const arma::mat& a,
+                             const arma::mat& b,
+                             arma::mat& result)
+{
+  result = -2.0 * (a.t() * b);
+  result.each_col() += arma::trans(arma::sum(arma::square(a), 0));
+  result.each_row() += arma::sum(arma::square(b), 0);
+  result.transform([](const double d) { return std::max(d, 0.0); });
+}
+
+} // namespace kernel
+} // namespace mlpack
+
+#endif
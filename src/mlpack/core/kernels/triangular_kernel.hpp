@@ -14,6 +14,8 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
+#include <mlpack/core/kernels/squared_distances.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -63,6 +65,24 @@ class TriangularKernel
     return std::max(0.0, (1 - distance) / bandwidth);
   }
 
+  /**
+   * Evaluate the triangular kernel between every column of a and every column
+   * of b, from the squared distances computed with one matrix product;
+   * result(i, j) is K(a.col(i), b.col(j)).
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param result Matrix to store the kernel values in.
+   */
+  void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& result)
+      const
+  {
+    SquaredDistances(a, b, result);
+    const double h = bandwidth;
+    result.transform([h](const double d)
+        { return std::max(0.0, 1 - std::sqrt(d) / h); });
+  }
+
   /**
    * Evaluate the gradient of triangular kernel
    * given that the distance between the two
@@ -106,6 +126,10 @@ class KernelTraits<TriangularKernel>
   static const bool IsNormalized = true;
   //! The triangular kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The triangular kernel can be evaluated in batches.
+  static const bool HasBatchEvaluate = true;
+  //! The triangular kernel decreases with the distance.
+  static const bool DecreasesWithDistance = true;
 };
 
 } // namespace kernel
@@ -12,6 +12,7 @@
 #include "lin_alg.hpp"
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/math/random.hpp>
+#include <mlpack/core/util/execution.hpp>
 
 using namespace mlpack;
 using namespace math;
@@ -42,12 +43,145 @@ void mlpack::math::VectorPower(arma::vec& vec, const double power)
  */
 void mlpack::math::Center(const arma::mat& x, arma::mat& xCentered)
 {
+  if (&x != &xCentered)
+    xCentered = x;
+
+  Center(xCentered);
+}
+
+/**
+ * Centers a matrix in place, with one pass for the means and one to subtract
+ * them.
+ */
+void mlpack::math::Center(arma::mat& x)
+{
+  if (x.n_cols == 0)
+    return;
+
   // Get the mean of the elements in each row.
-  arma::vec rowMean = arma::sum(x, 1) / x.n_cols;
+  const arma::vec rowMean = arma::sum(x, 1) / x.n_cols;
+
+  util::Execution::ParallelFor(x.n_cols, [&](const size_t i)
+  {
+    x.unsafe_col(i) -= rowMean;
+  }, 256);
+}
+
+/**
+ * Computes the covariance matrix of the columns of x, one block of columns at
+ * a time.
+ */
+void mlpack::math::Covariance(const arma::mat& x,
+                              arma::mat& covariance,
+                              const bool centered,
+                              const bool biased)
+{
+  const size_t n = x.n_cols;
+  const arma::vec rowMean = (centered || n == 0) ?
+      arma::vec(x.n_rows, arma::fill::zeros) : arma::vec(arma::sum(x, 1) / n);
+
+  // The columns are split into one chunk per thread; each chunk accumulates
+  // its own product, one block of columns at a time, and the products are
+  // summed at the end.
+  const size_t blockSize = 1024;
+  const size_t blocks = (n + blockSize - 1) / blockSize;
+  util::Executor* executor = util::Execution::GetExecutor();
+  const size_t concurrency = executor ? executor->Concurrency() :
+      util::Execution::Threads();
+  const size_t chunks = std::max<size_t>(std::min(blocks, concurrency), 1);
+  std::vector<arma::mat> products(chunks);
+
+  util::Execution::ParallelFor(chunks, [&](const size_t c)
+  {
+    arma::mat& product = products[c];
+    product.zeros(x.n_rows, x.n_rows);
+    for (size_t b = c * blocks / chunks; b < (c + 1) * blocks / chunks; ++b)
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(n, begin + blockSize) - 1;
+      if (centered)
+      {
+        product += x.cols(begin, end) * x.cols(begin, end).t();
+      }
+      else
+      {
+        arma::mat block = x.cols(begin, end);
+        block.each_col() -= rowMean;
+        product += block * block.t();
+      }
+    }
+  });
+
+  covariance.zeros(x.n_rows, x.n_rows);
+  for (size_t c = 0; c < chunks; ++c)
+    covariance += products[c];
+
+  const size_t denominator = (biased || n < 2) ? n : n - 1;
+  if (denominator > 0)
+    covariance /= denominator;
+}
+
+/**
+ * Replaces x with transformation * x, one block of columns at a time.
+ */
+void mlpack::math::TransformInPlace(const arma::mat& transformation,
+                                    arma::mat& x)
+{
+  if (transformation.n_rows != transformation.n_cols ||
+      transformation.n_cols != x.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "TransformInPlace(): transformation (" << transformation.n_rows
+        << " x " << transformation.n_cols << ") must be square and match the "
+        << "number of rows of the data (" << x.n_rows << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t blockSize = 256;
+  const size_t blocks = (x.n_cols + blockSize - 1) / blockSize;
+  util::Execution::ParallelFor(blocks, [&](const size_t b)
+  {
+    const size_t begin = b * blockSize;
+    const size_t end = std::min((size_t) x.n_cols, begin + blockSize) - 1;
+    const arma::mat block = transformation * x.cols(begin, end);
+    x.cols(begin, end) = block;
+  });
+}
 
-  xCentered = x - arma::repmat(rowMean, 1, x.n_cols);
+namespace {
+
+//! Compute the SVD whitening matrix of the given covariance matrix.
+void SVDWhiteningMatrix(const arma::mat& covX, arma::mat& whiteningMatrix)
+{
+  arma::mat u, v;
+  arma::vec sVector;
+  svd(u, sVector, v, covX);
+
+  // Scaling the columns of v is the same as multiplying by the diagonal.
+  whiteningMatrix = v;
+  whiteningMatrix.each_row() /= arma::sqrt(sVector).t();
+  whiteningMatrix *= trans(u);
 }
 
+//! Compute the eigendecomposition whitening matrix of the given covariance
+//! matrix.
+void EigWhiteningMatrix(const arma::mat& covX, arma::mat& whiteningMatrix)
+{
+  arma::mat eigenvectors;
+  arma::vec eigenvalues;
+
+  // Get eigenvectors of covariance of input matrix.
+  eig_sym(eigenvalues, eigenvectors, covX);
+
+  // Our whitening matrix is diag(1 / sqrt(eigenvalues)) * eigenvectors^T;
+  // scaling the rows is the same as multiplying by the diagonal.
+  mlpack::math::VectorPower(eigenvalues, -0.5);
+  whiteningMatrix = trans(eigenvectors);
+  whiteningMatrix.each_col() %= eigenvalues;
+}
+
+} // anonymous namespace
+
 /**
  * Whitens a matrix using the singular value decomposition of the covariance
  * matrix. Whitening means the covariance matrix of the result is the identity
@@ -57,20 +191,24 @@ void mlpack::math::WhitenUsingSVD(const arma::mat& x,
                                   arma::mat& xWhitened,
                                   arma::mat& whiteningMatrix)
 {
-  arma::mat covX, u, v, invSMatrix, temp1;
-  arma::vec sVector;
-
-  covX = ccov(x);
-
-  svd(u, sVector, v, covX);
+  arma::mat covX;
+  Covariance(x, covX);
+  SVDWhiteningMatrix(covX, whiteningMatrix);
 
-  size_t d = sVector.n_elem;
-  invSMatrix.zeros(d, d);
-  invSMatrix.diag() = 1 / sqrt(sVector);
+  xWhitened = whiteningMatrix * x;
+}
 
-  whiteningMatrix = v * invSMatrix * trans(u);
+/**
+ * Whitens a matrix in place using the singular value decomposition of the
+ * covariance matrix.
+ */
+void mlpack::math::WhitenUsingSVD(arma::mat& x, arma::mat& whiteningMatrix)
+{
+  arma::mat covX;
+  Covariance(x, covX);
+  SVDWhiteningMatrix(covX, whiteningMatrix);
 
-  xWhitened = whiteningMatrix * x;
+  TransformInPlace(whiteningMatrix, x);
 }
 
 /**
@@ -81,22 +219,26 @@ void mlpack::math::WhitenUsingEig(const arma::mat& x,
                                   arma::mat& xWhitened,
                                   arma::mat& whiteningMatrix)
 {
-  arma::mat diag, eigenvectors;
-  arma::vec eigenvalues;
-
-  // Get eigenvectors of covariance of input matrix.
-  eig_sym(eigenvalues, eigenvectors, ccov(x));
+  arma::mat covX;
+  Covariance(x, covX);
+  EigWhiteningMatrix(covX, whiteningMatrix);
 
-  // Generate diagonal matrix using 1 / sqrt(eigenvalues) for each value.
-  VectorPower(eigenvalues, -0.5);
-  diag.zeros(eigenvalues.n_elem, eigenvalues.n_elem);
-  diag.diag() = eigenvalues;
+  // Now apply the whitening matrix.
+  xWhitened = whiteningMatrix * x;
+}
 
-  // Our whitening matrix is diag(1 / sqrt(eigenvectors)) * eigenvalues.
-  whiteningMatrix = diag * trans(eigenvectors);
+/**
+ * Whitens a matrix in place using the eigendecomposition of the covariance
+ * matrix.
+ */
+void mlpack::math::WhitenUsingEig(arma::mat& x, arma::mat& whiteningMatrix)
+{
+  arma::mat covX;
+  Covariance(x, covX);
+  EigWhiteningMatrix(covX, whiteningMatrix);
 
   // Now apply the whitening matrix.
-  xWhitened = whiteningMatrix * x;
+  TransformInPlace(whiteningMatrix, x);
 }
 
 /**
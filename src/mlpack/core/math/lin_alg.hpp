@@ -36,6 +36,40 @@ void VectorPower(arma::vec& vec, const double power);
  */
 void Center(const arma::mat& x, arma::mat& xCentered);
 
+/**
+ * Centers a matrix in place, with one pass over the data to compute the mean of
+ * each row and one to subtract it.  No copy of the matrix is made.
+ *
+ * @param x Matrix to center.
+ */
+void Center(arma::mat& x);
+
+/**
+ * Computes the covariance matrix of the columns of x, X * X^T / (N - 1) (or
+ * / N if biased is true), with the mean of each row subtracted.  The product
+ * is accumulated over blocks of columns in parallel, so only one block of the
+ * data is ever copied at a time (and none if the data is already centered).
+ *
+ * @param x Input matrix.
+ * @param covariance Matrix to store the covariance in.
+ * @param centered Whether x is known to be centered already.
+ * @param biased Whether to divide by N instead of N - 1.
+ */
+void Covariance(const arma::mat& x,
+                arma::mat& covariance,
+                const bool centered = false,
+                const bool biased = false);
+
+/**
+ * Replaces x with transformation * x, one block of columns at a time, so that
+ * only one block of the result is held in a temporary.  The transformation must
+ * be square.
+ *
+ * @param transformation Square matrix to multiply x by.
+ * @param x Matrix to transform.
+ */
+void TransformInPlace(const arma::mat& transformation, arma::mat& x);
+
 /**
  * Whitens a matrix using the singular value decomposition of the covariance
  * matrix. Whitening means the covariance matrix of the result is the identity
@@ -45,6 +79,13 @@ void WhitenUsingSVD(const arma::mat& x,
                     arma::mat& xWhitened,
                     arma::mat& whiteningMatrix);
 
+/**
+ * Whitens a matrix in place using the singular value decomposition of the
+ * covariance matrix.  The covariance matrix is computed without copying the
+ * data, and the whitening matrix is applied one block of columns at a time.
+ */
+void WhitenUsingSVD(arma::mat& x, arma::mat& whiteningMatrix);
+
 /**
  * Whitens a matrix using the eigendecomposition of the covariance matrix.
  * Whitening means the covariance matrix of the result is the identity matrix.
@@ -53,6 +94,13 @@ void WhitenUsingEig(const arma::mat& x,
                     arma::mat& xWhitened,
                     arma::mat& whiteningMatrix);
 
+/**
+ * Whitens a matrix in place using the eigendecomposition of the covariance
+ * matrix.  The covariance matrix is computed without copying the data, and the
+ * whitening matrix is applied one block of columns at a time.
+ */
+void WhitenUsingEig(arma::mat& x, arma::mat& whiteningMatrix);
+
 /**
  * Overwrites a dimension-N vector to a random vector on the unit sphere in R^N.
  */
@@ -13,8 +13,15 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/mlpack_export.hpp>
+#include <mlpack/core/math/xoshiro256.hpp>
+#include <algorithm>
+#include <atomic>
 #include <random>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace math /** Miscellaneous math routines. */ {
 
@@ -29,6 +36,38 @@ extern MLPACK_EXPORT std::mt19937 randGen;
 extern MLPACK_EXPORT std::uniform_real_distribution<> randUniformDist;
 // Global normal distribution.
 extern MLPACK_EXPORT std::normal_distribution<> randNormalDist;
+// Seed of the thread-local generators.
+extern MLPACK_EXPORT uint64_t randGenSeed;
+// Number of times the thread-local generators have been seeded.
+extern MLPACK_EXPORT std::atomic<size_t> randGenEpoch;
+
+/**
+ * Get the random number generator of the calling thread, which Random(),
+ * RandInt(), RandNormal() and the fill functions use.  Each thread has its own
+ * generator, so there is no contention between threads; the generator of
+ * OpenMP thread k is the generator of the seed advanced by k jumps of 2^128
+ * numbers, so the streams of the threads don't overlap, and the results only
+ * depend on the seed and the thread numbers.  The generators are reseeded on
+ * their next use after a call to RandomSeed().
+ */
+inline Xoshiro256& RandGen()
+{
+  static thread_local Xoshiro256 generator;
+  static thread_local size_t epoch = 0;
+
+  const size_t currentEpoch = randGenEpoch.load(std::memory_order_relaxed);
+  if (epoch != currentEpoch)
+  {
+    generator.Seed(randGenSeed);
+#ifdef HAS_OPENMP
+    for (int i = 0; i < omp_get_thread_num(); ++i)
+      generator.Jump();
+#endif
+    epoch = currentEpoch;
+  }
+
+  return generator;
+}
 
 /**
  * Set the random seed used by the random functions (Random() and RandInt()).
@@ -40,6 +79,8 @@ extern MLPACK_EXPORT std::normal_distribution<> randNormalDist;
 inline void RandomSeed(const size_t seed)
 {
   randGen.seed((uint32_t) seed);
+  randGenSeed = (uint64_t) seed;
+  randGenEpoch.fetch_add(1, std::memory_order_relaxed);
   srand((unsigned int) seed);
 #if ARMA_VERSION_MAJOR > 3 || \
     (ARMA_VERSION_MAJOR == 3 && ARMA_VERSION_MINOR >= 930)
@@ -54,7 +95,7 @@ inline void RandomSeed(const size_t seed)
  */
 inline double Random()
 {
-  return randUniformDist(randGen);
+  return RandGen().Uniform();
 }
 
 /**
@@ -62,7 +103,7 @@ inline double Random()
  */
 inline double Random(const double lo, const double hi)
 {
-  return lo + (hi - lo) * randUniformDist(randGen);
+  return lo + (hi - lo) * RandGen().Uniform();
 }
 
 /**
@@ -70,7 +111,7 @@ inline double Random(const double lo, const double hi)
  */
 inline int RandInt(const int hiExclusive)
 {
-  return (int) std::floor((double) hiExclusive * randUniformDist(randGen));
+  return (int) std::floor((double) hiExclusive * RandGen().Uniform());
 }
 
 /**
@@ -79,7 +120,7 @@ inline int RandInt(const int hiExclusive)
 inline int RandInt(const int lo, const int hiExclusive)
 {
   return lo + (int) std::floor((double) (hiExclusive - lo)
-                               * randUniformDist(randGen));
+                               * RandGen().Uniform());
 }
 
 /**
@@ -87,7 +128,7 @@ inline int RandInt(const int lo, const int hiExclusive)
  */
 inline double RandNormal()
 {
-  return randNormalDist(randGen);
+  return RandGen().Normal();
 }
 
 /**
@@ -99,7 +140,45 @@ inline double RandNormal()
  */
 inline double RandNormal(const double mean, const double variance)
 {
-  return variance * randNormalDist(randGen) + mean;
+  return variance * RandGen().Normal() + mean;
+}
+
+/**
+ * Fill the given matrix with uniform random numbers in [0, 1), using the
+ * generator of the calling thread.
+ *
+ * @param m Matrix to fill (its size is kept).
+ */
+template<typename eT>
+inline void RandomFill(arma::Mat<eT>& m)
+{
+  RandGen().FillUniform(m.memptr(), m.n_elem);
+}
+
+/**
+ * Fill the given matrix with normally distributed random numbers with mean 0
+ * and variance 1, using the generator of the calling thread.
+ *
+ * @param m Matrix to fill (its size is kept).
+ */
+template<typename eT>
+inline void RandNormalFill(arma::Mat<eT>& m)
+{
+  RandGen().FillNormal(m.memptr(), m.n_elem);
+}
+
+/**
+ * Fill the given matrix with Bernoulli random numbers (1 with probability p
+ * and 0 otherwise), using the generator of the calling thread.  This is used
+ * for the masks of the Dropout and DropConnect layers.
+ *
+ * @param m Matrix to fill (its size is kept).
+ * @param p Probability of a 1.
+ */
+template<typename eT>
+inline void RandBernoulliFill(arma::Mat<eT>& m, const double p)
+{
+  RandGen().FillBernoulli(m.memptr(), m.n_elem, p);
 }
 
 /**
@@ -118,7 +197,22 @@ inline void ObtainDistinctSamples(const size_t loInclusive,
 {
   const size_t samplesRangeSize = hiExclusive - loInclusive;
 
-  if (samplesRangeSize > maxNumSamples)
+  if (samplesRangeSize > 8 * maxNumSamples)
+  {
+    // When few samples are taken from a large range, sort the samples instead
+    // of counting them in a buffer the size of the range.  The result is the
+    // same, in the same (ascending) order.
+    distinctSamples.set_size(maxNumSamples);
+    for (size_t i = 0; i < maxNumSamples; i++)
+      distinctSamples[i] = loInclusive +
+          (size_t) math::RandInt(samplesRangeSize);
+
+    std::sort(distinctSamples.begin(), distinctSamples.end());
+    const size_t numDistinct = std::unique(distinctSamples.begin(),
+        distinctSamples.end()) - distinctSamples.begin();
+    distinctSamples.resize(numDistinct);
+  }
+  else if (samplesRangeSize > maxNumSamples)
   {
     arma::Col<size_t> samples;
 
@@ -0,0 +1,225 @@
+/**
+ * @file xoshiro256.hpp
+ *
+ * Definition of the Xoshiro256 random number generator.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_MATH_XOSHIRO256_HPP
+#define MLPACK_CORE_MATH_XOSHIRO256_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace math /** Miscellaneous math routines. */ {
+
+/**
+ * The xoshiro256** random number generator of Blackman and Vigna.  It has a
+ * state of four 64-bit words and a period of 2^256 - 1, each number takes a
+ * handful of shifts, rotations and additions, and Jump() advances the state by
+ * 2^128 numbers, which gives non-overlapping streams for different threads.
+ * The class satisfies the C++ UniformRandomBitGenerator requirements, so it can
+ * be used with the <random> distributions, and it has fast fill functions for
+ * uniform, normal and Bernoulli numbers.
+ *
+ * For more information, see the following paper.
+ *
+ * @code
+ * @article{Blackman2018,
+ *   author = {Blackman, David and Vigna, Sebastiano},
+ *   title = {Scrambled Linear Pseudorandom Number Generators},
+ *   journal = {arXiv preprint arXiv:1805.01407},
+ *   year = {2018}
+ * }
+ * @endcode
+ */
+class Xoshiro256
+{
+ public:
+  //! The type of the generated numbers.
+  typedef uint64_t result_type;
+
+  /**
+   * Create the generator with the given seed.
+   *
+   * @param seed Seed for the generator.
+   */
+  Xoshiro256(const uint64_t seed = 0) { Seed(seed); }
+
+  /**
+   * Seed the generator.  The state is filled by the splitmix64 generator, so
+   * that similar seeds give unrelated states.
+   *
+   * @param seed Seed for the generator.
+   */
+  void Seed(uint64_t seed)
+  {
+    for (size_t i = 0; i < 4; ++i)
+    {
+      uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      state[i] = z ^ (z >> 31);
+    }
+
+    hasSpareNormal = false;
+  }
+
+  //! Get the smallest number the generator returns.
+  static constexpr result_type min() { return 0; }
+  //! Get the largest number the generator returns.
+  static constexpr result_type max() { return ~((result_type) 0); }
+
+  //! Generate a 64-bit random number.
+  result_type operator()()
+  {
+    const uint64_t result = Rotate(state[1] * 5, 7) * 9;
+    const uint64_t t = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = Rotate(state[3], 45);
+
+    return result;
+  }
+
+  /**
+   * Advance the generator by 2^128 numbers.  Calling Jump() k times on
+   * generators with the same seed gives k + 1 non-overlapping streams.
+   */
+  void Jump()
+  {
+    static const uint64_t jump[] = { 0x180EC6D33CFD0ABAULL,
+        0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+
+    uint64_t s[4] = { 0, 0, 0, 0 };
+    for (size_t i = 0; i < 4; ++i)
+    {
+      for (size_t b = 0; b < 64; ++b)
+      {
+        if (jump[i] & (((uint64_t) 1) << b))
+        {
+          s[0] ^= state[0];
+          s[1] ^= state[1];
+          s[2] ^= state[2];
+          s[3] ^= state[3];
+        }
+        (*this)();
+      }
+    }
+
+    std::copy(s, s + 4, state);
+    hasSpareNormal = false;
+  }
+
+  //! Generate a uniform random number in [0, 1).
+  double Uniform()
+  {
+    // The top 53 bits fill the mantissa of the double exactly.
+    return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  //! Generate a normally distributed random number with mean 0 and variance 1.
+  double Normal()
+  {
+    if (hasSpareNormal)
+    {
+      hasSpareNormal = false;
+      return spareNormal;
+    }
+
+    double first;
+    NormalPair(first, spareNormal);
+    hasSpareNormal = true;
+    return first;
+  }
+
+  /**
+   * Fill the given memory with uniform random numbers in [0, 1).
+   *
+   * @param mem Memory to fill.
+   * @param n Number of elements to fill.
+   */
+  template<typename eT>
+  void FillUniform(eT* mem, const size_t n)
+  {
+    for (size_t i = 0; i < n; ++i)
+      mem[i] = (eT) Uniform();
+  }
+
+  /**
+   * Fill the given memory with normally distributed random numbers with mean 0
+   * and variance 1; the numbers are generated in pairs.
+   *
+   * @param mem Memory to fill.
+   * @param n Number of elements to fill.
+   */
+  template<typename eT>
+  void FillNormal(eT* mem, const size_t n)
+  {
+    size_t i = 0;
+    for (; i + 1 < n; i += 2)
+    {
+      double first, second;
+      NormalPair(first, second);
+      mem[i] = (eT) first;
+      mem[i + 1] = (eT) second;
+    }
+
+    if (i < n)
+      mem[i] = (eT) Normal();
+  }
+
+  /**
+   * Fill the given memory with Bernoulli random numbers: 1 with probability p
+   * and 0 otherwise.
+   *
+   * @param mem Memory to fill.
+   * @param n Number of elements to fill.
+   * @param p Probability of a 1.
+   */
+  template<typename eT>
+  void FillBernoulli(eT* mem, const size_t n, const double p)
+  {
+    // Compare the 53-bit integers directly instead of converting them.
+    const uint64_t threshold = (p >= 1.0) ? (((uint64_t) 1) << 53) :
+        (uint64_t) (std::max(p, 0.0) * 9007199254740992.0);
+    for (size_t i = 0; i < n; ++i)
+      mem[i] = (eT) (((*this)() >> 11) < threshold);
+  }
+
+ private:
+  //! Rotate the given word left by k bits.
+  static uint64_t Rotate(const uint64_t x, const int k)
+  {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  //! Generate two independent normal numbers (Box-Muller transform).
+  void NormalPair(double& first, double& second)
+  {
+    // Use 1 - Uniform() to avoid taking the logarithm of 0.
+    const double radius = std::sqrt(-2.0 * std::log(1.0 - Uniform()));
+    const double angle = 2.0 * M_PI * Uniform();
+    first = radius * std::cos(angle);
+    second = radius * std::sin(angle);
+  }
+
+  //! The state of the generator.
+  uint64_t state[4];
+  //! Whether a normal number of the last pair is left.
+  bool hasSpareNormal;
+  //! The normal number left from the last pair.
+  double spareNormal;
+};
+
+} // namespace math
+} // namespace mlpack
+
+#endif
@@ -13,6 +13,8 @@
 #ifndef MLPACK_METHODS_FASTMKS_IP_METRIC_HPP
 #define MLPACK_METHODS_FASTMKS_IP_METRIC_HPP
 
+#include <typeinfo>
+
 namespace mlpack {
 namespace metric {
 
@@ -25,6 +27,16 @@ namespace metric {
  * d(x, y) = \sqrt{ K(x, x) + K(y, y) - 2K(x, y) }.
  * @f]
  *
+ * Each distance evaluation takes three kernel evaluations, but K(x, x) and
+ * K(y, y) only depend on the points.  So, the self-kernels of the points of a
+ * dataset can be cached with CacheSelfKernels(); afterwards, if an argument of
+ * Evaluate() is a whole column of that dataset (like dataset.col(i)), its
+ * self-kernel is looked up from its address, and each distance between points
+ * of the dataset costs a single kernel evaluation.  The CoverTree does this
+ * while it is built and for as long as it exists.  The cache is only valid as
+ * long as the dataset is neither modified nor destroyed, so it must be cleared
+ * with ClearSelfKernels() before that happens.
+ *
  * @tparam KernelType Type of Kernel to use.  This must be a Mercer kernel
  *     (positive definite), otherwise the metric may not be valid.
  */
@@ -38,6 +50,16 @@ class IPMetric
   //! Create the IPMetric with an instantiated kernel.
   IPMetric(KernelType& kernel);
 
+  /**
+   * Copy the given IPMetric.  The kernel is copied if the other metric owns it,
+   * and shared otherwise; the cached self-kernels are not copied, because they
+   * belong to the dataset of the other metric.
+   */
+  IPMetric(const IPMetric& other);
+
+  //! Copy the given IPMetric, like the copy constructor.
+  IPMetric& operator=(const IPMetric& other);
+
   //! Destroy the IPMetric object.
   ~IPMetric();
 
@@ -53,6 +75,26 @@ class IPMetric
   template<typename VecTypeA, typename VecTypeB>
   typename VecTypeA::elem_type Evaluate(const VecTypeA& a, const VecTypeB& b);
 
+  /**
+   * Compute and cache the self-kernel K(x, x) of each point x of the given
+   * dataset, replacing any previous cache.  The dataset must not be modified or
+   * destroyed while the cache is in use.
+   *
+   * @param dataset Dense dataset, one point per column.
+   */
+  template<typename MatType>
+  void CacheSelfKernels(const MatType& dataset);
+
+  //! Forget the cached self-kernels, if any.
+  void ClearSelfKernels();
+
+  //! Return whether the self-kernels of the given dataset are cached.
+  template<typename MatType>
+  bool HasSelfKernels(const MatType& dataset) const;
+
+  //! Get the cached self-kernels (K(x, x) for each point x of the dataset).
+  const arma::vec& SelfKernels() const { return selfKernels; }
+
   //! Get the kernel.
   const KernelType& Kernel() const { return *kernel; }
   //! Modify the kernel.
@@ -67,6 +109,22 @@ class IPMetric
   KernelType* kernel;
   //! If true, we are responsible for deleting the kernel.
   bool kernelOwner;
+
+  //! The cached self-kernels, or an empty vector.
+  arma::vec selfKernels;
+  //! The memory of the dataset of the cached self-kernels.
+  const void* cacheMemory;
+  //! The type of the elements of the dataset of the cached self-kernels.
+  const std::type_info* cacheType;
+  //! The number of rows of the dataset of the cached self-kernels.
+  size_t cacheRows;
+
+  /**
+   * Get the self-kernel of the given point, from the cache if the point is a
+   * column of the cached dataset.
+   */
+  template<typename VecType>
+  double SelfKernel(const VecType& a);
 };
 
 } // namespace metric
@@ -25,7 +25,10 @@ namespace metric {
 template<typename KernelType>
 IPMetric<KernelType>::IPMetric() :
     kernel(new KernelType()),
-    kernelOwner(true)
+    kernelOwner(true),
+    cacheMemory(NULL),
+    cacheType(NULL),
+    cacheRows(0)
 {
   // Nothing to do.
 }
@@ -34,11 +37,43 @@ IPMetric<KernelType>::IPMetric() :
 template<typename KernelType>
 IPMetric<KernelType>::IPMetric(KernelType& kernel) :
     kernel(&kernel),
-    kernelOwner(false)
+    kernelOwner(false),
+    cacheMemory(NULL),
+    cacheType(NULL),
+    cacheRows(0)
 {
   // Nothing to do.
 }
 
+// Copy constructor.
+template<typename KernelType>
+IPMetric<KernelType>::IPMetric(const IPMetric& other) :
+    kernel(other.kernelOwner ? new KernelType(*other.kernel) : other.kernel),
+    kernelOwner(other.kernelOwner),
+    cacheMemory(NULL),
+    cacheType(NULL),
+    cacheRows(0)
+{
+  // Nothing to do.
+}
+
+// Copy assignment operator.
+template<typename KernelType>
+IPMetric<KernelType>& IPMetric<KernelType>::operator=(const IPMetric& other)
+{
+  if (this != &other)
+  {
+    if (kernelOwner)
+      delete kernel;
+
+    kernel = other.kernelOwner ? new KernelType(*other.kernel) : other.kernel;
+    kernelOwner = other.kernelOwner;
+    ClearSelfKernels();
+  }
+
+  return *this;
+}
+
 // Destructor for the IPMetric.
 template<typename KernelType>
 IPMetric<KernelType>::~IPMetric()
@@ -54,9 +89,101 @@ inline typename Vec1Type::elem_type IPMetric<KernelType>::Evaluate(
     const Vec2Type& b)
 {
   // This is the metric induced by the kernel function.
-  // Maybe we can do better by caching some of this?
-  return sqrt(kernel->Evaluate(a, a) + kernel->Evaluate(b, b) -
-      2 * kernel->Evaluate(a, b));
+  return sqrt(SelfKernel(a) + SelfKernel(b) - 2 * kernel->Evaluate(a, b));
+}
+
+template<typename KernelType>
+template<typename MatType>
+void IPMetric<KernelType>::CacheSelfKernels(const MatType& dataset)
+{
+  ClearSelfKernels();
+
+  selfKernels.set_size(dataset.n_cols);
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for if (dataset.n_cols >= 2048)
+  for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+  #pragma omp parallel for if (dataset.n_cols >= 2048)
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
+  {
+    selfKernels[i] = kernel->Evaluate(dataset.col(i), dataset.col(i));
+  }
+
+  // Points without any dimensions can't be told apart by their address.
+  if (dataset.n_rows > 0)
+  {
+    cacheMemory = dataset.memptr();
+    cacheType = &typeid(typename MatType::elem_type);
+    cacheRows = dataset.n_rows;
+  }
+  else
+  {
+    selfKernels.reset();
+  }
+}
+
+template<typename KernelType>
+void IPMetric<KernelType>::ClearSelfKernels()
+{
+  selfKernels.reset();
+  cacheMemory = NULL;
+  cacheType = NULL;
+  cacheRows = 0;
+}
+
+template<typename KernelType>
+template<typename MatType>
+bool IPMetric<KernelType>::HasSelfKernels(const MatType& dataset) const
+{
+  return (cacheMemory != NULL) && (cacheMemory == dataset.memptr()) &&
+      (*cacheType == typeid(typename MatType::elem_type)) &&
+      (cacheRows == dataset.n_rows) && (selfKernels.n_elem == dataset.n_cols);
+}
+
+namespace details {
+
+//! Get the memory of a dense column.
+template<typename eT>
+const eT* ColumnMemory(const arma::Col<eT>& a) { return a.memptr(); }
+
+//! Get the memory of a column of a dense matrix.
+template<typename eT>
+const eT* ColumnMemory(const arma::subview_col<eT>& a) { return a.colmem; }
+
+//! Other vector types (like sparse vectors or expressions) have no memory of
+//! their own to look up.
+template<typename VecType>
+const typename VecType::elem_type* ColumnMemory(const VecType& /* a */)
+{
+  return NULL;
+}
+
+} // namespace details
+
+template<typename KernelType>
+template<typename VecType>
+inline double IPMetric<KernelType>::SelfKernel(const VecType& a)
+{
+  typedef typename VecType::elem_type ElemType;
+
+  if (cacheMemory != NULL && a.n_elem == cacheRows &&
+      *cacheType == typeid(ElemType))
+  {
+    const ElemType* begin = (const ElemType*) cacheMemory;
+    const ElemType* memory = details::ColumnMemory(a);
+    // Only whole columns of the dataset are found in the cache.
+    if (memory != NULL && memory >= begin &&
+        memory < begin + cacheRows * selfKernels.n_elem &&
+        (size_t) (memory - begin) % cacheRows == 0)
+    {
+      return selfKernels[(memory - begin) / cacheRows];
+    }
+  }
+
+  return kernel->Evaluate(a, a);
 }
 
 // Serialize the kernel.
@@ -68,7 +195,10 @@ void IPMetric<KernelType>::Serialize(Archive& ar,
   // If we're loading, we need to allocate space for the kernel, and we will own
   // the kernel.
   if (Archive::is_loading::value)
+  {
     kernelOwner = true;
+    ClearSelfKernels();
+  }
 
   ar & data::CreateNVP(kernel, "kernel");
 }
@@ -26,6 +26,7 @@ typename VecTypeA::elem_type LMetric<Power, TakeRoot>::Evaluate(
     const VecTypeB& b)
 {
   typename VecTypeA::elem_type sum = 0;
+  MLPACK_SIMD_REDUCTION(+:sum)
   for (size_t i = 0; i < a.n_elem; i++)
     sum += std::pow(fabs(a[i] - b[i]), Power);
 
@@ -80,10 +81,6 @@ typename VecTypeA::elem_type LMetric<3, true>::Evaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
-  typename VecTypeA::elem_type sum = 0;
-  for (size_t i = 0; i < a.n_elem; i++)
-    sum += std::pow(fabs(a[i] - b[i]), 3.0);
-
   return std::pow(arma::accu(arma::pow(arma::abs(a - b), 3.0)), 1.0 / 3.0);
 }
 
@@ -32,8 +32,11 @@ namespace metric {
  *
  * Because each evaluation multiplies (x_1 - x_2) by the covariance matrix, it
  * may be much quicker to use an LMetric and simply stretch the actual dataset
- * itself before performing any evaluations.  However, this class is provided
- * for convenience.
+ * itself before performing any evaluations.  Transformation() gives a matrix L
+ * with Q = L^T L, so that d(x, y) = || L x - L y ||; the points can then be
+ * transformed once, and searched with the Euclidean distance (see
+ * NSModel::Transformation() and RSModel::Transformation()).  However, this
+ * class is provided for convenience.
  *
  * Similar to the LMetric class, this offers a template parameter TakeRoot
  * which, when set to false, will instead evaluate the distance
@@ -102,6 +105,18 @@ class MahalanobisDistance
    */
   arma::mat& Covariance() { return covariance; }
 
+  /**
+   * Compute a linear transformation L with Q = L^T L, so that the distance
+   * between x and y is the Euclidean distance between L x and L y (squared, if
+   * TakeRoot is false).  This is the upper-triangular Cholesky factor of Q,
+   * unless Q is only positive semidefinite; then, it is computed from the
+   * eigendecomposition of Q, and negative eigenvalues (from numerical error)
+   * are taken as zero.
+   *
+   * @return The transformation L, of the same size as the covariance matrix.
+   */
+  arma::mat Transformation() const;
+
   //! Serialize the Mahalanobis distance.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int version);
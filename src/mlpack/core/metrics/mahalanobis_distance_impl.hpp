@@ -25,9 +25,8 @@ template<typename VecTypeA, typename VecTypeB>
 double MahalanobisDistance<false>::Evaluate(const VecTypeA& a,
                                             const VecTypeB& b)
 {
-  arma::vec m = (a - b);
-  arma::mat out = trans(m) * covariance * m; // 1x1
-  return out[0];
+  const arma::vec m = (a - b);
+  return arma::dot(m, covariance * m);
 }
 /**
  * Specialization for rooted case.  This requires one extra evaluation of
@@ -42,9 +41,30 @@ double MahalanobisDistance<true>::Evaluate(const VecTypeA& a,
   if (covariance.n_rows == 0)
     covariance = arma::eye<arma::mat>(a.n_elem, a.n_elem);
 
-  arma::vec m = (a - b);
-  arma::mat out = trans(m) * covariance * m; // 1x1;
-  return sqrt(out[0]);
+  const arma::vec m = (a - b);
+  return sqrt(arma::dot(m, covariance * m));
+}
+
+template<bool TakeRoot>
+arma::mat MahalanobisDistance<TakeRoot>::Transformation() const
+{
+  arma::mat transformation;
+  if (arma::chol(transformation, covariance))
+    return transformation;
+
+  // The covariance is not positive definite, so Q = V diag(lambda) V^T gives
+  // L = diag(sqrt(lambda)) V^T.
+  arma::vec eigenvalues;
+  arma::mat eigenvectors;
+  if (!arma::eig_sym(eigenvalues, eigenvectors, covariance))
+  {
+    throw std::runtime_error("MahalanobisDistance::Transformation(): "
+        "eigendecomposition of the covariance matrix failed");
+  }
+
+  eigenvalues = arma::sqrt(arma::clamp(eigenvalues, 0.0, arma::datum::inf));
+  transformation = arma::diagmat(eigenvalues) * eigenvectors.t();
+  return transformation;
 }
 
 // Serialize the Mahalanobis distance.
@@ -14,6 +14,7 @@
 #define MLPACK_CORE_OPTIMIZERS_ADA_DELTA_UPDATE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/elementwise_update.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -55,49 +56,90 @@ class AdaDeltaUpdate
   }
 
   /**
-   * The Initialize method is called by SGD Optimizer method before the start of
-   * the iteration update process. In AdaDelta update policy, the mean squared
-   * and the delta mean squared gradient matrices are initialized to the zeros
-   * matrix with the same size as gradient matrix
-   * (see mlpack::optimization::SGD::Optimizer).
+   * The Policy class holds the state of the update for an iterate of the given
+   * matrix type; SGD creates one before the start of the iteration update
+   * process.
    *
-   * @param rows Number of rows in the gradient matrix.
-   * @param cols Number of columns in the gradient matrix.
+   * @tparam MatType Type of the iterate and the gradient (arma::mat or
+   *     arma::fmat).
    */
-  void Initialize(const size_t rows,
-                  const size_t cols)
+  template<typename MatType>
+  class Policy
   {
-    // Initialize empty matrices for mean sum of squares of parameter gradient.
-    meanSquaredGradient = arma::zeros<arma::mat>(rows, cols);
-    meanSquaredGradientDx = arma::zeros<arma::mat>(rows, cols);
-  }
+   public:
+    /**
+     * Create the state of the AdaDelta update.  The mean squared and the delta
+     * mean squared gradient matrices are initialized to the zeros matrix with
+     * the same size as gradient matrix (see
+     * mlpack::optimization::SGD::Optimize()).
+     *
+     * @param parent Instantiated update policy.
+     * @param rows Number of rows in the gradient matrix.
+     * @param cols Number of columns in the gradient matrix.
+     */
+    Policy(AdaDeltaUpdate& parent, const size_t rows, const size_t cols) :
+        parent(parent),
+        meanSquaredGradient(arma::zeros<MatType>(rows, cols)),
+        meanSquaredGradientDx(arma::zeros<MatType>(rows, cols))
+    {
+      // Nothing to do.
+    }
 
-  /**
-   * Update step for SGD. The AdaDelta update dynamically adapts over time using
-   * only first order information. Additionally, AdaDelta requires no manual
-   * tuning of a learning rate.
-   *
-   * @param iterate Parameters that minimize the function.
-   * @param stepSize Step size to be used for the given iteration.
-   * @param gradient The gradient matrix.
-   */
-  void Update(arma::mat& iterate,
-              const double stepSize,
-              const arma::mat& gradient)
-  {
-    // Accumulate gradient.
-    meanSquaredGradient *= rho;
-    meanSquaredGradient += (1 - rho) * (gradient % gradient);
-    arma::mat dx = arma::sqrt((meanSquaredGradientDx + epsilon) /
-        (meanSquaredGradient + epsilon)) % gradient;
-
-    // Accumulate updates.
-    meanSquaredGradientDx *= rho;
-    meanSquaredGradientDx += (1 - rho) * (dx % dx);
-
-    // Apply update.
-    iterate -= (stepSize * dx);
-  }
+    /**
+     * Update step for SGD. The AdaDelta update dynamically adapts over time
+     * using only first order information. Additionally, AdaDelta requires no
+     * manual tuning of a learning rate.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const MatType& gradient)
+    {
+      typedef typename MatType::elem_type ElemType;
+
+      // Accumulate the gradient, compute the update, accumulate the update and
+      // apply it, in one pass.
+      const ElemType rho = parent.rho;
+      const ElemType epsilon = parent.epsilon;
+      const ElemType step = stepSize;
+      ElemType* iteratePtr = iterate.memptr();
+      ElemType* meanSquaredGradientPtr = meanSquaredGradient.memptr();
+      ElemType* meanSquaredGradientDxPtr = meanSquaredGradientDx.memptr();
+      const ElemType* gradientPtr = gradient.memptr();
+      ElementwiseUpdate(iterate.n_elem, [&](const size_t begin,
+                                            const size_t end)
+      {
+        MLPACK_SIMD
+        for (size_t i = begin; i < end; ++i)
+        {
+          const ElemType g = gradientPtr[i];
+          const ElemType msg = rho * meanSquaredGradientPtr[i] +
+              (1 - rho) * g * g;
+          meanSquaredGradientPtr[i] = msg;
+
+          const ElemType dx = std::sqrt((meanSquaredGradientDxPtr[i] +
+              epsilon) / (msg + epsilon)) * g;
+          meanSquaredGradientDxPtr[i] = rho * meanSquaredGradientDxPtr[i] +
+              (1 - rho) * dx * dx;
+
+          iteratePtr[i] -= step * dx;
+        }
+      });
+    }
+
+   private:
+    // The instantiated update policy.
+    AdaDeltaUpdate& parent;
+
+    // The mean squared gradient matrix.
+    MatType meanSquaredGradient;
+
+    // The delta mean squared gradient matrix.
+    MatType meanSquaredGradientDx;
+  };
 
   //! Get the smoothing parameter.
   double Rho() const { return rho; }
@@ -115,12 +157,6 @@ class AdaDeltaUpdate
 
   // The epsilon value used to initialise the mean squared gradient parameter.
   double epsilon;
-
-  // The mean squared gradient matrix.
-  arma::mat meanSquaredGradient;
-
-  // The delta mean squared gradient matrix.
-  arma::mat meanSquaredGradientDx;
 };
 
 } // namespace optimization
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_OPTIMIZERS_ADA_GRAD_ADA_GRAD_UPDATE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/elementwise_update.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -53,37 +54,97 @@ class AdaGradUpdate
   }
 
   /**
-   * The Initialize method is called by SGD Optimizer method before the start of
-   * the iteration update process. In AdaGrad update policy, squared
-   * gradient matrix is initialized to the zeros matrix with the same size as
-   * gradient matrix (see mlpack::optimization::SGD::Optimizer).
+   * The Policy class holds the state of the update for an iterate of the given
+   * matrix type; SGD creates one before the start of the iteration update
+   * process.
    *
-   * @param rows Number of rows in the gradient matrix.
-   * @param cols Number of columns in the gradient matrix.
+   * @tparam MatType Type of the iterate and the gradient (arma::mat or
+   *     arma::fmat).
    */
-  void Initialize(const size_t rows,
-                  const size_t cols)
+  template<typename MatType>
+  class Policy
   {
-    // Initialize an empty matrix for sum of squares of parameter gradient.
-    squaredGradient = arma::zeros<arma::mat>(rows, cols);
-  }
+   public:
+    /**
+     * Create the state of the AdaGrad update.  The squared gradient matrix is
+     * initialized to the zeros matrix with the same size as gradient matrix
+     * (see mlpack::optimization::SGD::Optimize()).
+     *
+     * @param parent Instantiated update policy.
+     * @param rows Number of rows in the gradient matrix.
+     * @param cols Number of columns in the gradient matrix.
+     */
+    Policy(AdaGradUpdate& parent, const size_t rows, const size_t cols) :
+        parent(parent),
+        squaredGradient(arma::zeros<MatType>(rows, cols))
+    {
+      // Nothing to do.
+    }
 
-  /**
-   * Update step for SGD. The AdaGrad update adapts the learning rate by
-   * performing larger updates for more sparse parameters and smaller updates
-   * for less sparse parameters .
-   *
-   * @param iterate Parameters that minimize the function.
-   * @param stepSize Step size to be used for the given iteration.
-   * @param gradient The gradient matrix.
-   */
-  void Update(arma::mat& iterate,
-              const double stepSize,
-              const arma::mat& gradient)
-  {
-    squaredGradient += (gradient % gradient);
-    iterate -= (stepSize * gradient) / (arma::sqrt(squaredGradient) + epsilon);
-  }
+    /**
+     * Update step for SGD. The AdaGrad update adapts the learning rate by
+     * performing larger updates for more sparse parameters and smaller
+     * updates for less sparse parameters .
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const MatType& gradient)
+    {
+      typedef typename MatType::elem_type ElemType;
+
+      // Accumulate the squared gradient and update the iterate in one pass.
+      const ElemType step = stepSize;
+      const ElemType epsilon = parent.epsilon;
+      ElemType* iteratePtr = iterate.memptr();
+      ElemType* squaredGradientPtr = squaredGradient.memptr();
+      const ElemType* gradientPtr = gradient.memptr();
+      ElementwiseUpdate(iterate.n_elem, [&](const size_t begin,
+                                            const size_t end)
+      {
+        MLPACK_SIMD
+        for (size_t i = begin; i < end; ++i)
+        {
+          const ElemType g = gradientPtr[i];
+          const ElemType s = squaredGradientPtr[i] + g * g;
+          squaredGradientPtr[i] = s;
+          iteratePtr[i] -= step * g / (std::sqrt(s) + epsilon);
+        }
+      });
+    }
+
+    /**
+     * Update step for SGD with a sparse gradient.  The squared gradient only
+     * changes where the gradient is non-zero, and so does the iterate, so only
+     * those entries are visited; the result is the same as the dense update.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The sparse gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const arma::SpMat<typename MatType::elem_type>& gradient)
+    {
+      for (auto it = gradient.begin(); it != gradient.end(); ++it)
+      {
+        const double g = (*it);
+        squaredGradient(it.row(), it.col()) += g * g;
+        iterate(it.row(), it.col()) -= (stepSize * g) /
+            (std::sqrt(squaredGradient(it.row(), it.col())) + parent.epsilon);
+      }
+    }
+
+   private:
+    // The instantiated update policy.
+    AdaGradUpdate& parent;
+
+    // The squared gradient matrix.
+    MatType squaredGradient;
+  };
 
   //! Get the value used to initialise the squared gradient parameter.
   double Epsilon() const { return epsilon; }
@@ -93,9 +154,6 @@ class AdaGradUpdate
  private:
   // The epsilon value used to initialise the squared gradient parameter.
   double epsilon;
-
-  // The squared gradient matrix.
-  arma::mat squaredGradient;
 };
 
 } // namespace optimization
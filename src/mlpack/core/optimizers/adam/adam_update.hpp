@@ -18,6 +18,7 @@
 #define MLPACK_CORE_OPTIMIZERS_ADAM_ADAM_UPDATE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/elementwise_update.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -55,58 +56,139 @@ class AdamUpdate
              const double beta2 = 0.999) :
     epsilon(epsilon),
     beta1(beta1),
-    beta2(beta2),
-    iteration(0)
+    beta2(beta2)
   {
     // Nothing to do.
   }
 
   /**
-   * The Initialize method is called by SGD Optimizer method before the start of
-   * the iteration update process.
+   * The Policy class holds the state of the update for an iterate of the given
+   * matrix type; SGD creates one before the start of the iteration update
+   * process.
    *
-   * @param rows Number of rows in the gradient matrix.
-   * @param cols Number of columns in the gradient matrix.
+   * @tparam MatType Type of the iterate and the gradient (arma::mat or
+   *     arma::fmat).
    */
-  void Initialize(const size_t rows,
-                  const size_t cols)
+  template<typename MatType>
+  class Policy
   {
-    m = arma::zeros<arma::mat>(rows, cols);
-    v = arma::zeros<arma::mat>(rows, cols);
-  }
-
-  /**
-   * Update step for Adam.
-   *
-   * @param iterate Parameters that minimize the function.
-   * @param stepSize Step size to be used for the given iteration.
-   * @param gradient The gradient matrix.
-   */
-  void Update(arma::mat& iterate,
-              const double stepSize,
-              const arma::mat& gradient)
-  {
-    // Increment the iteration counter variable.
-    ++iteration;
-
-    // And update the iterate.
-    m *= beta1;
-    m += (1 - beta1) * gradient;
-
-    v *= beta2;
-    v += (1 - beta2) * (gradient % gradient);
+   public:
+    /**
+     * Create the state of the Adam update.
+     *
+     * @param parent Instantiated update policy.
+     * @param rows Number of rows in the gradient matrix.
+     * @param cols Number of columns in the gradient matrix.
+     */
+    Policy(AdamUpdate& parent, const size_t rows, const size_t cols) :
+        parent(parent),
+        m(arma::zeros<MatType>(rows, cols)),
+        v(arma::zeros<MatType>(rows, cols)),
+        iteration(0)
+    {
+      // Nothing to do.
+    }
 
-    const double biasCorrection1 = 1.0 - std::pow(beta1, iteration);
-    const double biasCorrection2 = 1.0 - std::pow(beta2, iteration);
+    /**
+     * Update step for Adam.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const MatType& gradient)
+    {
+      // Increment the iteration counter variable.
+      ++iteration;
+
+      typedef typename MatType::elem_type ElemType;
+
+      const double biasCorrection1 = 1.0 - std::pow(parent.beta1, iteration);
+      const double biasCorrection2 = 1.0 - std::pow(parent.beta2, iteration);
+
+      /**
+       * It should be noted that the term, m / (arma::sqrt(v) + eps), in the
+       * following expression is an approximation of the following actual term;
+       * m / (arma::sqrt(v) + (arma::sqrt(biasCorrection2) * eps).
+       */
+      const ElemType step = stepSize * std::sqrt(biasCorrection2) /
+          biasCorrection1;
+
+      // Update both moments and the iterate in one pass.
+      const ElemType beta1 = parent.beta1;
+      const ElemType beta2 = parent.beta2;
+      const ElemType epsilon = parent.epsilon;
+      ElemType* iteratePtr = iterate.memptr();
+      ElemType* mPtr = m.memptr();
+      ElemType* vPtr = v.memptr();
+      const ElemType* gradientPtr = gradient.memptr();
+      ElementwiseUpdate(iterate.n_elem, [&](const size_t begin,
+                                            const size_t end)
+      {
+        MLPACK_SIMD
+        for (size_t i = begin; i < end; ++i)
+        {
+          const ElemType g = gradientPtr[i];
+          const ElemType mi = beta1 * mPtr[i] + (1 - beta1) * g;
+          const ElemType vi = beta2 * vPtr[i] + (1 - beta2) * g * g;
+          mPtr[i] = mi;
+          vPtr[i] = vi;
+          iteratePtr[i] -= step * mi / (std::sqrt(vi) + epsilon);
+        }
+      });
+    }
 
     /**
-     * It should be noted that the term, m / (arma::sqrt(v) + eps), in the
-     * following expression is an approximation of the following actual term;
-     * m / (arma::sqrt(v) + (arma::sqrt(biasCorrection2) * eps).
+     * Lazy update step for Adam with a sparse gradient: the moment estimates
+     * and the iterate are only updated where the gradient is non-zero, so the
+     * decay of the moments of the other entries is skipped until their
+     * gradient is non-zero again.  This is not the same as the dense update,
+     * but it costs O(nnz) instead of O(d) per step, and usually works as well
+     * for sparse problems.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The sparse gradient matrix.
      */
-    iterate -= (stepSize * std::sqrt(biasCorrection2) / biasCorrection1) *
-        m / (arma::sqrt(v) + epsilon);
-  }
+    void Update(MatType& iterate,
+                const double stepSize,
+                const arma::SpMat<typename MatType::elem_type>& gradient)
+    {
+      ++iteration;
+
+      const double biasCorrection1 = 1.0 - std::pow(parent.beta1, iteration);
+      const double biasCorrection2 = 1.0 - std::pow(parent.beta2, iteration);
+      const double step = stepSize * std::sqrt(biasCorrection2) /
+          biasCorrection1;
+
+      for (auto it = gradient.begin(); it != gradient.end(); ++it)
+      {
+        const size_t row = it.row();
+        const size_t col = it.col();
+        const double g = (*it);
+
+        m(row, col) = parent.beta1 * m(row, col) + (1 - parent.beta1) * g;
+        v(row, col) = parent.beta2 * v(row, col) + (1 - parent.beta2) * g * g;
+        iterate(row, col) -= step * m(row, col) /
+            (std::sqrt(v(row, col)) + parent.epsilon);
+      }
+    }
+
+   private:
+    // The instantiated update policy.
+    AdamUpdate& parent;
+
+    // The exponential moving average of gradient values.
+    MatType m;
+
+    // The exponential moving average of squared gradient values.
+    MatType v;
+
+    // The number of iterations.
+    double iteration;
+  };
 
   //! Get the value used to initialise the squared gradient parameter.
   double Epsilon() const { return epsilon; }
@@ -132,15 +214,6 @@ class AdamUpdate
 
   // The second moment coefficient.
   double beta2;
-
-  // The exponential moving average of gradient values.
-  arma::mat m;
-
-  // The exponential moving average of squared gradient values.
-  arma::mat v;
-
-  // The number of iterations.
-  double iteration;
 };
 
 } // namespace optimization
@@ -19,6 +19,7 @@
 #define MLPACK_CORE_OPTIMIZERS_ADAM_ADAMAX_UPDATE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/elementwise_update.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -57,53 +58,98 @@ class AdaMaxUpdate
                const double beta2 = 0.999) :
     epsilon(epsilon),
     beta1(beta1),
-    beta2(beta2),
-    iteration(0)
+    beta2(beta2)
   {
     // Nothing to do.
   }
 
   /**
-   * The Initialize method is called by SGD Optimizer method before the start of
-   * the iteration update process.
+   * The Policy class holds the state of the update for an iterate of the given
+   * matrix type; SGD creates one before the start of the iteration update
+   * process.
    *
-   * @param rows Number of rows in the gradient matrix.
-   * @param cols Number of columns in the gradient matrix.
+   * @tparam MatType Type of the iterate and the gradient (arma::mat or
+   *     arma::fmat).
    */
-  void Initialize(const size_t rows,
-                  const size_t cols)
+  template<typename MatType>
+  class Policy
   {
-    m = arma::zeros<arma::mat>(rows, cols);
-    u = arma::zeros<arma::mat>(rows, cols);
-  }
-
-  /**
-   * Update step for Adam.
-   *
-   * @param iterate Parameters that minimize the function.
-   * @param stepSize Step size to be used for the given iteration.
-   * @param gradient The gradient matrix.
-   */
-  void Update(arma::mat& iterate,
-              const double stepSize,
-              const arma::mat& gradient)
-  {
-    // Increment the iteration counter variable.
-    ++iteration;
-
-    // And update the iterate.
-    m *= beta1;
-    m += (1 - beta1) * gradient;
-
-    // Update the exponentially weighted infinity norm.
-    u *= beta2;
-    u = arma::max(u, arma::abs(gradient));
-
-    const double biasCorrection1 = 1.0 - std::pow(beta1, iteration);
-
-    if (biasCorrection1 != 0)
-      iterate -= (stepSize / biasCorrection1 * m / (u + epsilon));
-  }
+   public:
+    /**
+     * Create the state of the AdaMax update.
+     *
+     * @param parent Instantiated update policy.
+     * @param rows Number of rows in the gradient matrix.
+     * @param cols Number of columns in the gradient matrix.
+     */
+    Policy(AdaMaxUpdate& parent, const size_t rows, const size_t cols) :
+        parent(parent),
+        m(arma::zeros<MatType>(rows, cols)),
+        u(arma::zeros<MatType>(rows, cols)),
+        iteration(0)
+    {
+      // Nothing to do.
+    }
+
+    /**
+     * Update step for AdaMax.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const MatType& gradient)
+    {
+      // Increment the iteration counter variable.
+      ++iteration;
+
+      typedef typename MatType::elem_type ElemType;
+
+      const double biasCorrection1 = 1.0 - std::pow(parent.beta1, iteration);
+
+      // Update the moment, the exponentially weighted infinity norm and the
+      // iterate in one pass.  The iterate is left alone if the bias correction
+      // is zero.
+      const ElemType beta1 = parent.beta1;
+      const ElemType beta2 = parent.beta2;
+      const ElemType epsilon = parent.epsilon;
+      const ElemType step = (biasCorrection1 != 0) ?
+          stepSize / biasCorrection1 : 0;
+      ElemType* iteratePtr = iterate.memptr();
+      ElemType* mPtr = m.memptr();
+      ElemType* uPtr = u.memptr();
+      const ElemType* gradientPtr = gradient.memptr();
+      ElementwiseUpdate(iterate.n_elem, [&](const size_t begin,
+                                            const size_t end)
+      {
+        MLPACK_SIMD
+        for (size_t i = begin; i < end; ++i)
+        {
+          const ElemType g = gradientPtr[i];
+          const ElemType mi = beta1 * mPtr[i] + (1 - beta1) * g;
+          const ElemType ui = std::max(beta2 * uPtr[i], std::abs(g));
+          mPtr[i] = mi;
+          uPtr[i] = ui;
+          iteratePtr[i] -= step * mi / (ui + epsilon);
+        }
+      });
+    }
+
+   private:
+    // The instantiated update policy.
+    AdaMaxUpdate& parent;
+
+    // The exponential moving average of gradient values.
+    MatType m;
+
+    // The exponentially weighted infinity norm.
+    MatType u;
+
+    // The number of iterations.
+    double iteration;
+  };
 
   //! Get the value used to initialise the squared gradient parameter.
   double Epsilon() const { return epsilon; }
@@ -129,15 +175,6 @@ class AdaMaxUpdate
 
   // The second moment coefficient.
   double beta2;
-
-  // The exponential moving average of gradient values.
-  arma::mat m;
-
-  // The exponentially weighted infinity norm.
-  arma::mat u;
-
-  // The number of iterations.
-  double iteration;
 };
 
 } // namespace optimization
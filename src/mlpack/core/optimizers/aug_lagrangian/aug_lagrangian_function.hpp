@@ -13,6 +13,7 @@
 #define MLPACK_CORE_OPTIMIZERS_AUG_LAGRANGIAN_AUG_LAGRANGIAN_FUNCTION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/lbfgs/evaluate_with_gradient.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -76,6 +77,19 @@ class AugLagrangianFunction
    */
   void Gradient(const arma::mat& coordinates, arma::mat& gradient) const;
 
+  /**
+   * Evaluate the objective function and the gradient of the Augmented
+   * Lagrangian function.  The objective and gradient of the LagrangianFunction
+   * are computed together if it provides EvaluateWithGradient() (see
+   * HasEvaluateWithGradient), and each constraint is evaluated only once.
+   *
+   * @param coordinates Coordinates to evaluate function and gradient at.
+   * @param gradient Matrix to store gradient into.
+   * @return Objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              arma::mat& gradient) const;
+
   /**
    * Get the initial point of the optimization (supplied by the
    * LagrangianFunction).
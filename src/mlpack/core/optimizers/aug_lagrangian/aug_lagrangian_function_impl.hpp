@@ -92,6 +92,30 @@ void AugLagrangianFunction<LagrangianFunction>::Gradient(
   }
 }
 
+// Evaluate the AugLagrangianFunction and its gradient at the given
+// coordinates.
+template<typename LagrangianFunction>
+double AugLagrangianFunction<LagrangianFunction>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  double objective = optimization::EvaluateWithGradient(function, coordinates,
+      gradient);
+
+  arma::mat constraintGradient; // Temporary for constraint gradients.
+  for (size_t i = 0; i < function.NumConstraints(); ++i)
+  {
+    const double constraint = function.EvaluateConstraint(i, coordinates);
+    objective += (-lambda[i] * constraint) +
+        sigma * std::pow(constraint, 2) / 2;
+
+    function.GradientConstraint(i, coordinates, constraintGradient);
+    gradient += (-lambda[i] + sigma * constraint) * constraintGradient;
+  }
+
+  return objective;
+}
+
 // Get the initial point.
 template<typename LagrangianFunction>
 const arma::mat& AugLagrangianFunction<LagrangianFunction>::GetInitialPoint()
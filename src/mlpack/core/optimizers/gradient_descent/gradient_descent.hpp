@@ -13,6 +13,7 @@
 #define MLPACK_CORE_OPTIMIZERS_GRADIENT_DESCENT_GRADIENT_DESCENT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/lbfgs/evaluate_with_gradient.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -46,6 +47,14 @@ namespace optimization {
  *   void Gradient(const arma::mat& coordinates,
  *                 arma::mat& gradient);
  *
+ * If the class also implements
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               arma::mat& gradient);
+ *
+ * (see HasEvaluateWithGradient), it is used to compute the objective and the
+ * gradient of each iterate in one pass.
+ *
  * @tparam FunctionType Decomposable objective function type to be
  *     minimized.
  */
@@ -35,12 +35,14 @@ template<typename FunctionType>
 double GradientDescent<FunctionType>::Optimize(
     FunctionType& function, arma::mat& iterate)
 {
-  // To keep track of where we are and how things are going.
-  double overallObjective = function.Evaluate(iterate);
+  // To keep track of where we are and how things are going.  The objective
+  // and the gradient are computed together at each iterate, in one pass if the
+  // function provides EvaluateWithGradient().
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  double overallObjective = EvaluateWithGradient(function, iterate, gradient);
   double lastObjective = DBL_MAX;
 
   // Now iterate!
-  arma::mat gradient(iterate.n_rows, iterate.n_cols);
   for (size_t i = 1; i != maxIterations; ++i)
   {
     // Output current objective function.
@@ -65,13 +67,11 @@ double GradientDescent<FunctionType>::Optimize(
     // Reset the counter variables.
     lastObjective = overallObjective;
 
-    function.Gradient(iterate, gradient);
-
-    // And update the iterate.
+    // Update the iterate with the gradient at the last iterate.
     iterate -= stepSize * gradient;
 
-    // Now add that to the overall objective function.
-    overallObjective = function.Evaluate(iterate);
+    // Now compute the objective function and the gradient at the new iterate.
+    overallObjective = EvaluateWithGradient(function, iterate, gradient);
   }
 
   Log::Info << "Gradient Descent: maximum iterations (" << maxIterations
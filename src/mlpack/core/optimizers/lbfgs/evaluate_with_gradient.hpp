@@ -0,0 +1,76 @@
+/**
+ * @file evaluate_with_gradient.hpp
+ *
+ * Helper function for optimizers that need both the objective and the gradient
+ * of a function at the same point.  If the function type provides
+ * EvaluateWithGradient(), which computes both in one pass over the data, that
+ * is used; otherwise, Evaluate() and Gradient() are called separately.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_LBFGS_EVALUATE_WITH_GRADIENT_HPP
+#define MLPACK_CORE_OPTIMIZERS_LBFGS_EVALUATE_WITH_GRADIENT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(EvaluateWithGradient, HasEvaluateWithGradientCheck);
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double EvaluateWithGradient(const arma::mat& coordinates,
+ *     arma::mat& gradient) (const or not), which returns the objective and
+ * stores the gradient at the given coordinates.
+ */
+template<typename FunctionType>
+struct HasEvaluateWithGradient
+{
+  static const bool value =
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&, arma::mat&)>::value ||
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&, arma::mat&) const>::value;
+};
+
+/**
+ * Return the objective and store the gradient of the function at the given
+ * coordinates, using the EvaluateWithGradient() function of the function.
+ */
+template<typename FunctionType>
+inline double EvaluateWithGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    arma::mat& gradient,
+    const typename std::enable_if_t<
+        HasEvaluateWithGradient<FunctionType>::value>* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, gradient);
+}
+
+/**
+ * Return the objective and store the gradient of the function at the given
+ * coordinates, by calling Evaluate() and Gradient().
+ */
+template<typename FunctionType>
+inline double EvaluateWithGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    arma::mat& gradient,
+    const typename std::enable_if_t<
+        !HasEvaluateWithGradient<FunctionType>::value>* = 0)
+{
+  const double objective = function.Evaluate(coordinates);
+  function.Gradient(coordinates, gradient);
+  return objective;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
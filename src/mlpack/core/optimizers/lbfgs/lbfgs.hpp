@@ -15,6 +15,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "evaluate_with_gradient.hpp"
+
 namespace mlpack {
 namespace optimization {
 
@@ -29,6 +31,14 @@ namespace optimization {
  *  - double Evaluate(const arma::mat& coordinates);
  *  - void Gradient(const arma::mat& coordinates, arma::mat& gradient);
  *  - arma::mat& GetInitialPoint();
+ *
+ * If the function also implements
+ *
+ *  - double EvaluateWithGradient(const arma::mat& coordinates,
+ *                                arma::mat& gradient);
+ *
+ * (see HasEvaluateWithGradient), it is used to compute the objective and the
+ * gradient at each point of the line search in a single pass over the data.
  */
 template<typename FunctionType>
 class L_BFGS
@@ -195,6 +205,16 @@ class L_BFGS
    */
   double Evaluate(const arma::mat& iterate);
 
+  /**
+   * Evaluate the function and its gradient at the given iterate point, and
+   * store the result if it is a new minimum.
+   *
+   * @param iterate Point to evaluate the function at.
+   * @param gradient Matrix to store the gradient in.
+   * @return The value of the function.
+   */
+  double EvaluateWithGradient(const arma::mat& iterate, arma::mat& gradient);
+
   /**
    * Calculate the scaling factor, gamma, which is used to scale the Hessian
    * approximation matrix.  See method M3 in Section 4 of Liu and Nocedal
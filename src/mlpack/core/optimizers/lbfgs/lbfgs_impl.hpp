@@ -91,6 +91,28 @@ double L_BFGS<FunctionType>::Evaluate(const arma::mat& iterate)
   return functionValue;
 }
 
+/**
+ * Evaluate the function and its gradient at the given iterate point and store
+ * the result if it is a new minimum.
+ *
+ * @return The value of the function
+ */
+template<typename FunctionType>
+double L_BFGS<FunctionType>::EvaluateWithGradient(const arma::mat& iterate,
+                                                  arma::mat& gradient)
+{
+  const double functionValue = optimization::EvaluateWithGradient(function,
+      iterate, gradient);
+
+  if (functionValue < minPointIterate.second)
+  {
+    minPointIterate.first = iterate;
+    minPointIterate.second = functionValue;
+  }
+
+  return functionValue;
+}
+
 /**
  * Calculate the scaling factor gamma which is used to scale the Hessian
  * approximation matrix.  See method M3 in Section 4 of Liu and Nocedal (1989).
@@ -187,8 +209,7 @@ bool L_BFGS<FunctionType>::LineSearch(double& functionValue,
     // point.
     newIterateTmp = iterate;
     newIterateTmp += stepSize * searchDirection;
-    functionValue = Evaluate(newIterateTmp);
-    function.Gradient(newIterateTmp, gradient);
+    functionValue = EvaluateWithGradient(newIterateTmp, gradient);
     numIterations++;
 
     if (functionValue > initialFunctionValue + stepSize *
@@ -361,29 +382,26 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate)
   // Whether to optimize until convergence.
   bool optimizeUntilConvergence = (maxIterations == 0);
 
-  // The initial function value.
-  double functionValue = Evaluate(iterate);
-  double prevFunctionValue = functionValue;
-
   // The gradient: the current and the old.
   arma::mat gradient;
   arma::mat oldGradient;
   gradient.zeros(iterate.n_rows, iterate.n_cols);
   oldGradient.zeros(iterate.n_rows, iterate.n_cols);
 
+  // The initial function value and gradient.
+  double functionValue = EvaluateWithGradient(iterate, gradient);
+  double prevFunctionValue = functionValue;
+
   // The search direction.
   arma::mat searchDirection;
   searchDirection.zeros(iterate.n_rows, iterate.n_cols);
 
-  // The initial gradient value.
-  function.Gradient(iterate, gradient);
-
   // The main optimization loop.
   for (size_t itNum = 0; optimizeUntilConvergence || (itNum != maxIterations);
        ++itNum)
   {
     Log::Debug << "L-BFGS iteration " << itNum << "; objective " <<
-        function.Evaluate(iterate) << ", gradient norm " <<
+        functionValue << ", gradient norm " <<
         arma::norm(gradient, 2) << ", " <<
         ((prevFunctionValue - functionValue) /
          std::max(std::max(fabs(prevFunctionValue), fabs(functionValue)), 1.0))
@@ -13,7 +13,9 @@
 #define MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/batch_prefetcher.hpp>
 #include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
 #include <mlpack/core/optimizers/minibatch_sgd/decay_policies/no_decay.hpp>
 
 namespace mlpack {
@@ -69,6 +71,18 @@ namespace optimization {
  * function on the first point in the dataset (presumably, the dataset is held
  * internally in the DecomposableFunctionType).
  *
+ * If the class implements batch overloads (see HasBatchEvaluate,
+ * HasBatchGradient and HasBatchEvaluateWithGradient), they are used; with
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               const size_t begin,
+ *                               arma::mat& gradient,
+ *                               const size_t batchSize);
+ *
+ * the objective and the gradient of each mini-batch are computed in one pass.
+ * The objective that is reported for a pass over the mini-batches is the sum
+ * of the objectives of each mini-batch at the iterate before its step.
+ *
  * @tparam DecomposableFunctionType Decomposable objective function type to be
  *     minimized.
  * @tparam update Update policy used during the iterative update process.
@@ -141,6 +155,31 @@ class MiniBatchSGDType
     return Optimize(this->function, iterate);
   }
 
+  /**
+   * Optimize the given function using mini-batch SGD, with the mini-batches
+   * read from the given prefetcher instead of taken from the data held by the
+   * function, so the dataset doesn't have to fit in memory.  Each mini-batch
+   * is handed to the function with
+   *
+   *   void ResetData(MatType predictors, MatType responses);
+   *
+   * and the function is then evaluated on all its points.  One pass over the
+   * prefetcher is an epoch; the maximum number of iterations is the maximum
+   * number of mini-batches, and the tolerance is checked against the sum of
+   * the objectives of the mini-batches of each epoch.  The batch size and the
+   * shuffling are those of the prefetcher.  The starting point must already
+   * have the size of the function parameters.
+   *
+   * @param function Function to optimize.
+   * @param iterate Starting point (will be modified).
+   * @param batches Prefetcher to read the mini-batches from.
+   * @return Sum of the objectives of the mini-batches of the last epoch.
+   */
+  template<typename SourceType, typename MatType>
+  double Optimize(DecomposableFunctionType& function,
+                  arma::mat& iterate,
+                  data::BatchPrefetcher<SourceType, MatType>& batches);
+
   //! Get the instantiated function to be optimized.
   const DecomposableFunctionType& Function() const { return function; }
   //! Modify the instantiated function.
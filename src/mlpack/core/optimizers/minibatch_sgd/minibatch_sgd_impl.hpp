@@ -76,11 +76,11 @@ double MiniBatchSGDType<
   double lastObjective = DBL_MAX;
 
   // Calculate the first objective function.
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
+  overallObjective = EvaluateBatch(function, iterate, 0, numFunctions);
 
   // Initialize the update policy.
-  updatePolicy.Initialize(iterate.n_rows, iterate.n_cols);
+  typename UpdatePolicyType::template Policy<arma::mat> policy(updatePolicy,
+      iterate.n_rows, iterate.n_cols);
 
   // Now iterate!
   arma::mat gradient(iterate.n_rows, iterate.n_cols);
@@ -117,67 +117,95 @@ double MiniBatchSGDType<
         visitationOrder = arma::shuffle(visitationOrder);
     }
 
-    // Evaluate the gradient for this mini-batch.
+    // Evaluate the objective and the gradient for this mini-batch, and add the
+    // objective to the overall objective function.  The last batch may not be
+    // full-size.
     const size_t offset = batchSize * visitationOrder[currentBatch];
-    function.Gradient(iterate, offset, gradient);
-    if (visitationOrder[currentBatch] != numBatches - 1)
-    {
-      for (size_t j = 1; j < batchSize; ++j)
-      {
-        arma::mat funcGradient;
-        function.Gradient(iterate, offset + j, funcGradient);
-        gradient += funcGradient;
-      }
+    const size_t effectiveBatchSize = std::min(batchSize,
+        numFunctions - offset);
+    overallObjective += EvaluateWithGradientBatch(function, iterate, offset,
+        gradient, effectiveBatchSize);
 
-      // Now update the iterate.
-      updatePolicy.Update(iterate, stepSize / batchSize, gradient);
+    // Now update the iterate.
+    policy.Update(iterate, stepSize / effectiveBatchSize, gradient);
 
-      // Add that to the overall objective function.
-      for (size_t j = 0; j < batchSize; ++j)
-        overallObjective += function.Evaluate(iterate, offset + j);
-    }
-    else
+    // Now update the learning rate if requested by the user.
+    decayPolicy.Update(iterate, stepSize, gradient);
+  }
+
+  Log::Info << "Mini-batch SGD: maximum iterations (" << maxIterations << ") "
+      << "reached; terminating optimization." << std::endl;
+
+  // Calculate final objective.
+  return EvaluateBatch(function, iterate, 0, numFunctions);
+}
+
+//! Optimize the function (minimize), reading the mini-batches from disk.
+template<
+    typename DecomposableFunctionType,
+    typename UpdatePolicyType,
+    typename DecayPolicyType
+>
+template<typename SourceType, typename MatType>
+double MiniBatchSGDType<
+    DecomposableFunctionType,
+    UpdatePolicyType,
+    DecayPolicyType
+>::Optimize(DecomposableFunctionType& function,
+            arma::mat& iterate,
+            data::BatchPrefetcher<SourceType, MatType>& batches)
+{
+  // Initialize the update policy.
+  typename UpdatePolicyType::template Policy<arma::mat> policy(updatePolicy,
+      iterate.n_rows, iterate.n_cols);
+
+  size_t iterations = 0;
+  double lastObjective = DBL_MAX;
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  MatType predictors, responses;
+  while (maxIterations == 0 || iterations < maxIterations)
+  {
+    // The prefetcher reads the next mini-batches while we train on this one.
+    double overallObjective = 0;
+    batches.Reset();
+    while ((maxIterations == 0 || iterations < maxIterations) &&
+        batches.Next(predictors, responses))
     {
-      // Handle last batch differently: it's not a full-size batch.
-      const size_t lastBatchSize = numFunctions - offset - 1;
-      for (size_t j = 1; j < lastBatchSize; ++j)
-      {
-        arma::mat funcGradient;
-        function.Gradient(iterate, offset + j, funcGradient);
-        gradient += funcGradient;
-      }
+      const size_t effectiveBatchSize = responses.n_cols;
+      function.ResetData(std::move(predictors), std::move(responses));
+
+      overallObjective += EvaluateWithGradientBatch(function, iterate, 0,
+          gradient, effectiveBatchSize);
+      policy.Update(iterate, stepSize / effectiveBatchSize, gradient);
+      decayPolicy.Update(iterate, stepSize, gradient);
+      ++iterations;
+    }
 
-      // Ensure the last batch size isn't zero, to avoid division by zero before
-      // updating.
-      if (lastBatchSize > 0)
-      {
-        // Now update the iterate.
-        updatePolicy.Update(iterate, stepSize / lastBatchSize, gradient);
-      }
-      else
-      {
-        // Now update the iterate.
-        updatePolicy.Update(iterate, stepSize, gradient);
-      }
+    Log::Info << "Mini-batch SGD: iteration " << iterations << ", objective "
+        << overallObjective << "." << std::endl;
 
-      // Add that to the overall objective function.
-      for (size_t j = 0; j < lastBatchSize; ++j)
-        overallObjective += function.Evaluate(iterate, offset + j);
+    if (std::isnan(overallObjective) || std::isinf(overallObjective))
+    {
+      Log::Warn << "Mini-batch SGD: converged to " << overallObjective
+          << "; terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
     }
 
-    // Now update the learning rate if requested by the user.
-    decayPolicy.Update(iterate, stepSize, gradient);
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "Mini-batch SGD: minimized within tolerance " << tolerance
+          << "; terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    lastObjective = overallObjective;
   }
 
   Log::Info << "Mini-batch SGD: maximum iterations (" << maxIterations << ") "
       << "reached; terminating optimization." << std::endl;
 
-  // Calculate final objective.
-  overallObjective = 0;
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
-
-  return overallObjective;
+  return lastObjective;
 }
 
 } // namespace optimization
@@ -0,0 +1,349 @@
+/**
+ * @file parallel_sgd.hpp
+ *
+ * Data-parallel mini-batch Stochastic Gradient Descent (SGD), with synchronous
+ * and asynchronous (Hogwild) updates.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_HPP
+#define MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+#include <mlpack/core/optimizers/sgd/sparse_function.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(Parameters, HasFunctionParametersCheck);
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * arma::mat& Parameters(), that is, if it is evaluated at its own parameters
+ * (like FFN) instead of at the given coordinates.
+ */
+template<typename FunctionType>
+struct HasFunctionParameters
+{
+  static const bool value =
+    HasFunctionParametersCheck<FunctionType,
+        arma::mat&(FunctionType::*)()>::value;
+};
+
+/**
+ * ParallelSGD is a data-parallel version of mini-batch SGD: the function is
+ * copied into one replica per thread, and the mini-batches are split between
+ * the replicas.  Two modes are available.
+ *
+ * In synchronous mode, every mini-batch is divided into one shard per replica.
+ * Each replica computes the gradient of its shard at the current iterate, the
+ * gradients are summed with a tree reduction (log2(replicas) rounds of
+ * pairwise sums, all pairs of a round in parallel), and the update policy is
+ * applied once to the iterate.  The result is the same as mini-batch SGD with
+ * the same batch size, up to the order of the floating-point sums.
+ *
+ * In asynchronous (Hogwild) mode, each replica processes whole mini-batches and
+ * applies its vanilla SGD step to the shared iterate directly, without any
+ * locking.  This removes all synchronization between the threads, at the cost
+ * of gradients that may be computed at slightly stale parameters; for sparse or
+ * well-conditioned problems this converges like serial SGD (Niu et al., 2011).
+ * The update policy is not used in this mode, since the policies hold state
+ * that can't be shared between threads.
+ *
+ * The DecomposableFunctionType must implement the functions needed by
+ * MiniBatchSGD:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * and, optionally, batch versions of Evaluate() and Gradient() (see
+ * HasBatchEvaluate and HasBatchGradient).
+ *
+ * If the function also implements
+ *
+ *   arma::mat& Parameters();
+ *
+ * it is assumed to be evaluated at its own parameters, as the FFN class is:
+ * the function must then be copy-constructible, each thread works on its own
+ * copy (replica), and the Parameters() of a replica are set to the iterate
+ * before each gradient computation.  Since each replica is a full copy of the
+ * function, functions that hold their data (like FFN) need memory for one copy
+ * of the data per replica.  Otherwise (as for LogisticRegressionFunction or
+ * RegularizedSVDFunction), all the threads share the function, which is
+ * evaluated at the given coordinates, so its Evaluate() and Gradient() must be
+ * safe to call concurrently (const functions usually are).
+ *
+ * In asynchronous mode, if the function implements
+ *
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::sp_mat& gradient);
+ *
+ * (see HasSparseGradient), the gradient of each point is computed as a sparse
+ * matrix and only its non-zero entries are written to the shared iterate, as
+ * in the original Hogwild algorithm; this makes both the updates and the
+ * collisions between threads much rarer for functions like
+ * RegularizedSVDFunction, whose gradients touch two columns of the iterate.
+ *
+ * For more information on Hogwild, see the following paper.
+ *
+ * @code
+ * @inproceedings{Niu2011,
+ *   author = {Niu, Feng and Recht, Benjamin and R{\'e}, Christopher and
+ *       Wright, Stephen J.},
+ *   title = {HOGWILD!: A Lock-Free Approach to Parallelizing Stochastic
+ *       Gradient Descent},
+ *   booktitle = {Advances in Neural Information Processing Systems 24},
+ *   year = {2011}
+ * }
+ * @endcode
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ * @tparam UpdatePolicyType Update policy used in synchronous mode.  By default
+ *     the vanilla update policy (see mlpack::optimization::VanillaUpdate) is
+ *     used.
+ */
+template<
+    typename DecomposableFunctionType,
+    typename UpdatePolicyType = VanillaUpdate
+>
+class ParallelSGD
+{
+ public:
+  /**
+   * Construct the ParallelSGD optimizer with the given function and
+   * parameters.  The maximum number of iterations refers to the maximum number
+   * of mini-batches that are processed.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param batchSize Size of each mini-batch (shared by all the replicas in
+   *     synchronous mode).
+   * @param stepSize Step size for each iteration.
+   * @param maxIterations Maximum number of iterations allowed (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the mini-batch order is shuffled; otherwise, each
+   *     mini-batch is visited in linear order.
+   * @param asynchronous If true, use lock-free asynchronous (Hogwild) updates
+   *     instead of synchronous updates.
+   * @param numReplicas Number of replicas (threads) to use; 0 means one per
+   *     OpenMP thread.
+   * @param updatePolicy Instantiated update policy used to adjust the given
+   *     parameters in synchronous mode.
+   */
+  ParallelSGD(DecomposableFunctionType& function,
+              const size_t batchSize = 256,
+              const double stepSize = 0.01,
+              const size_t maxIterations = 100000,
+              const double tolerance = 1e-5,
+              const bool shuffle = true,
+              const bool asynchronous = false,
+              const size_t numReplicas = 0,
+              const UpdatePolicyType& updatePolicy = UpdatePolicyType());
+
+  /**
+   * Optimize the given function using data-parallel SGD.  The given starting
+   * point will be modified to store the finishing point of the algorithm, and
+   * the final objective value is returned.
+   *
+   * @param function Function to optimize.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(DecomposableFunctionType& function, arma::mat& iterate);
+
+  /**
+   * Optimize the given function using data-parallel SGD.  The given starting
+   * point will be modified to store the finishing point of the algorithm, and
+   * the final objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate)
+  {
+    return Optimize(this->function, iterate);
+  }
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the maximum number of iterations (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  //! Get whether or not asynchronous (Hogwild) updates are used.
+  bool Asynchronous() const { return asynchronous; }
+  //! Modify whether or not asynchronous (Hogwild) updates are used.
+  bool& Asynchronous() { return asynchronous; }
+
+  //! Get the number of replicas (0 means one per OpenMP thread).
+  size_t NumReplicas() const { return numReplicas; }
+  //! Modify the number of replicas (0 means one per OpenMP thread).
+  size_t& NumReplicas() { return numReplicas; }
+
+  //! Get the update policy.
+  UpdatePolicyType UpdatePolicy() const { return updatePolicy; }
+  //! Modify the update policy.
+  UpdatePolicyType& UpdatePolicy() { return updatePolicy; }
+
+ private:
+  //! The state of the update policy.
+  typedef typename UpdatePolicyType::template Policy<arma::mat> PolicyType;
+
+  /**
+   * Process the given mini-batches synchronously, and return the sum of the
+   * objectives of the mini-batches (before their update).
+   */
+  double SynchronousEpoch(std::vector<DecomposableFunctionType*>& workers,
+                          std::vector<arma::mat>& gradients,
+                          const arma::Col<size_t>& visitationOrder,
+                          const size_t numBatches,
+                          const size_t numFunctions,
+                          PolicyType& policy,
+                          arma::mat& iterate);
+
+  /**
+   * Process the given mini-batches asynchronously, and return the sum of the
+   * objectives of the mini-batches (before their update).
+   */
+  double AsynchronousEpoch(std::vector<DecomposableFunctionType*>& workers,
+                           std::vector<arma::mat>& gradients,
+                           const arma::Col<size_t>& visitationOrder,
+                           const size_t numBatches,
+                           const size_t numFunctions,
+                           arma::mat& iterate);
+
+  /**
+   * Sum the given gradients into the first one, with pairwise sums in
+   * log2(gradients.size()) parallel rounds.
+   */
+  static void TreeReduce(std::vector<arma::mat>& gradients);
+
+  //! Create one replica of the function per worker thread, if the function is
+  //! evaluated at its own parameters.
+  template<typename FunctionType>
+  static typename std::enable_if<
+      HasFunctionParameters<FunctionType>::value, void>::type
+  CreateWorkers(FunctionType& function,
+                const size_t workerCount,
+                std::vector<FunctionType>& replicas,
+                std::vector<FunctionType*>& workers);
+
+  //! Share the function between all the worker threads, if it is evaluated at
+  //! the given coordinates.
+  template<typename FunctionType>
+  static typename std::enable_if<
+      !HasFunctionParameters<FunctionType>::value, void>::type
+  CreateWorkers(FunctionType& function,
+                const size_t workerCount,
+                std::vector<FunctionType>& replicas,
+                std::vector<FunctionType*>& workers);
+
+  //! Return the coordinates to evaluate the given replica at: its parameters,
+  //! set to the iterate.
+  template<typename FunctionType>
+  static typename std::enable_if<
+      HasFunctionParameters<FunctionType>::value, const arma::mat&>::type
+  Coordinates(FunctionType& worker, const arma::mat& iterate);
+
+  //! Return the coordinates to evaluate the shared function at: the iterate.
+  template<typename FunctionType>
+  static typename std::enable_if<
+      !HasFunctionParameters<FunctionType>::value, const arma::mat&>::type
+  Coordinates(FunctionType& worker, const arma::mat& iterate);
+
+  //! Apply the lock-free update of the given mini-batch with its dense
+  //! gradient, and return the objective of the mini-batch before the update.
+  template<typename FunctionType>
+  typename std::enable_if<
+      !HasSparseGradient<FunctionType>::value, double>::type
+  AsynchronousUpdate(FunctionType& worker,
+                     const arma::mat& coordinates,
+                     const size_t begin,
+                     const size_t count,
+                     arma::mat& gradient,
+                     arma::mat& iterate) const;
+
+  //! Apply the lock-free updates of the points of the given mini-batch with
+  //! their sparse gradients, and return the objective of the mini-batch
+  //! before the updates.
+  template<typename FunctionType>
+  typename std::enable_if<
+      HasSparseGradient<FunctionType>::value, double>::type
+  AsynchronousUpdate(FunctionType& worker,
+                     const arma::mat& coordinates,
+                     const size_t begin,
+                     const size_t count,
+                     arma::mat& gradient,
+                     arma::mat& iterate) const;
+
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The size of each mini-batch.
+  size_t batchSize;
+
+  //! The step size for each example.
+  double stepSize;
+
+  //! The maximum number of allowed iterations.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled when
+  //! iterating.
+  bool shuffle;
+
+  //! Whether or not asynchronous (Hogwild) updates are used.
+  bool asynchronous;
+
+  //! The number of replicas (0 means one per OpenMP thread).
+  size_t numReplicas;
+
+  //! The update policy used in synchronous mode.
+  UpdatePolicyType updatePolicy;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "parallel_sgd_impl.hpp"
+
+#endif
@@ -0,0 +1,391 @@
+/**
+ * @file parallel_sgd_impl.hpp
+ *
+ * Implementation of data-parallel mini-batch Stochastic Gradient Descent.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_sgd.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::ParallelSGD(
+    DecomposableFunctionType& function,
+    const size_t batchSize,
+    const double stepSize,
+    const size_t maxIterations,
+    const double tolerance,
+    const bool shuffle,
+    const bool asynchronous,
+    const size_t numReplicas,
+    const UpdatePolicyType& updatePolicy) :
+    function(function),
+    batchSize(batchSize),
+    stepSize(stepSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle),
+    asynchronous(asynchronous),
+    numReplicas(numReplicas),
+    updatePolicy(updatePolicy)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+double ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::Optimize(
+    DecomposableFunctionType& function, arma::mat& iterate)
+{
+  // Find the number of functions.
+  const size_t numFunctions = function.NumFunctions();
+  size_t numBatches = numFunctions / batchSize;
+  if (numFunctions % batchSize != 0)
+    ++numBatches; // Capture last few.
+
+  // Batch visitation order.
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (numBatches - 1), numBatches);
+
+  // Set up the functions of the worker threads; each worker gets its own
+  // gradient.
+#ifdef HAS_OPENMP
+  const size_t replicaCount = (numReplicas == 0) ?
+      (size_t) omp_get_max_threads() : numReplicas;
+#else
+  const size_t replicaCount = 1;
+#endif
+  std::vector<DecomposableFunctionType> replicas;
+  std::vector<DecomposableFunctionType*> workers;
+  CreateWorkers(function, replicaCount, replicas, workers);
+  std::vector<arma::mat> gradients(replicaCount);
+
+  // To keep track of where we are and how things are going.
+  size_t iterations = 0;
+  double lastObjective = DBL_MAX;
+
+  // Calculate the first objective function.
+  double overallObjective = EvaluateBatch(function, iterate, 0, numFunctions);
+
+  // Initialize the update policy.
+  PolicyType policy(updatePolicy, iterate.n_rows, iterate.n_cols);
+
+  // Now iterate, one pass over the mini-batches at a time.
+  while (maxIterations == 0 || iterations < maxIterations)
+  {
+    // Output current objective function.
+    Log::Info << "Parallel SGD: iteration " << iterations << ", objective "
+        << overallObjective << "." << std::endl;
+
+    if (std::isnan(overallObjective) || std::isinf(overallObjective))
+    {
+      Log::Warn << "Parallel SGD: converged to " << overallObjective
+          << "; terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "Parallel SGD: minimized within tolerance " << tolerance
+          << "; terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    lastObjective = overallObjective;
+
+    if (shuffle)
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    const size_t epochBatches = (maxIterations == 0) ? numBatches :
+        std::min(numBatches, maxIterations - iterations);
+    if (asynchronous)
+    {
+      overallObjective = AsynchronousEpoch(workers, gradients,
+          visitationOrder, epochBatches, numFunctions, iterate);
+    }
+    else
+    {
+      overallObjective = SynchronousEpoch(workers, gradients,
+          visitationOrder, epochBatches, numFunctions, policy, iterate);
+    }
+
+    iterations += epochBatches;
+  }
+
+  Log::Info << "Parallel SGD: maximum iterations (" << maxIterations << ") "
+      << "reached; terminating optimization." << std::endl;
+
+  // Calculate final objective.
+  return EvaluateBatch(function, iterate, 0, numFunctions);
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+double ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::
+SynchronousEpoch(std::vector<DecomposableFunctionType*>& workers,
+                 std::vector<arma::mat>& gradients,
+                 const arma::Col<size_t>& visitationOrder,
+                 const size_t numBatches,
+                 const size_t numFunctions,
+                 PolicyType& policy,
+                 arma::mat& iterate)
+{
+  const size_t replicaCount = workers.size();
+  std::vector<double> objectives(replicaCount);
+
+  double objective = 0;
+  for (size_t b = 0; b < numBatches; ++b)
+  {
+    // The last batch may not be full-size.
+    const size_t offset = batchSize * visitationOrder[b];
+    const size_t effectiveBatchSize = std::min(batchSize,
+        numFunctions - offset);
+    const size_t shardSize = (effectiveBatchSize + replicaCount - 1) /
+        replicaCount;
+
+    // Each replica computes the gradient of its shard of the mini-batch at the
+    // current iterate.
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(static) num_threads(replicaCount)
+    for (intmax_t r = 0; r < (intmax_t) replicaCount; ++r)
+#else
+    #pragma omp parallel for schedule(static) num_threads(replicaCount)
+    for (size_t r = 0; r < replicaCount; ++r)
+#endif
+    {
+      const size_t shardBegin = r * shardSize;
+      if (shardBegin >= effectiveBatchSize)
+      {
+        gradients[r].zeros(iterate.n_rows, iterate.n_cols);
+        objectives[r] = 0;
+        continue;
+      }
+
+      const size_t shardCount = std::min(shardSize,
+          effectiveBatchSize - shardBegin);
+      DecomposableFunctionType& worker = *workers[r];
+      const arma::mat& coordinates = Coordinates(worker, iterate);
+      objectives[r] = EvaluateWithGradientBatch(worker, coordinates,
+          offset + shardBegin, gradients[r], shardCount);
+    }
+
+    TreeReduce(gradients);
+
+    // Now update the iterate.
+    policy.Update(iterate, stepSize / effectiveBatchSize, gradients[0]);
+
+    for (size_t r = 0; r < replicaCount; ++r)
+      objective += objectives[r];
+  }
+
+  return objective;
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+double ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::
+AsynchronousEpoch(std::vector<DecomposableFunctionType*>& workers,
+                  std::vector<arma::mat>& gradients,
+                  const arma::Col<size_t>& visitationOrder,
+                  const size_t numBatches,
+                  const size_t numFunctions,
+                  arma::mat& iterate)
+{
+  const size_t replicaCount = workers.size();
+
+  // Every thread takes whole mini-batches with its own worker, and updates the
+  // shared iterate without locking.
+  double objective = 0;
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic) num_threads(replicaCount) \
+      reduction(+:objective)
+  for (intmax_t b = 0; b < (intmax_t) numBatches; ++b)
+#else
+  #pragma omp parallel for schedule(dynamic) num_threads(replicaCount) \
+      reduction(+:objective)
+  for (size_t b = 0; b < numBatches; ++b)
+#endif
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    DecomposableFunctionType& worker = *workers[thread];
+
+    // The last batch may not be full-size.
+    const size_t offset = batchSize * visitationOrder[b];
+    const size_t effectiveBatchSize = std::min(batchSize,
+        numFunctions - offset);
+
+    const arma::mat& coordinates = Coordinates(worker, iterate);
+    objective += AsynchronousUpdate(worker, coordinates, offset,
+        effectiveBatchSize, gradients[thread], iterate);
+  }
+
+  return objective;
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+template<typename FunctionType>
+typename std::enable_if<
+    !HasSparseGradient<FunctionType>::value, double>::type
+ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::AsynchronousUpdate(
+    FunctionType& worker,
+    const arma::mat& coordinates,
+    const size_t begin,
+    const size_t count,
+    arma::mat& gradient,
+    arma::mat& iterate) const
+{
+  const double objective = EvaluateWithGradientBatch(worker, coordinates,
+      begin, gradient, count);
+
+  // Perform the vanilla SGD update on the shared iterate.
+  const double step = stepSize / count;
+  double* iterateMem = iterate.memptr();
+  const double* gradientMem = gradient.memptr();
+  for (size_t i = 0; i < iterate.n_elem; ++i)
+    iterateMem[i] -= step * gradientMem[i];
+
+  return objective;
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+template<typename FunctionType>
+typename std::enable_if<
+    HasSparseGradient<FunctionType>::value, double>::type
+ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::AsynchronousUpdate(
+    FunctionType& worker,
+    const arma::mat& coordinates,
+    const size_t begin,
+    const size_t count,
+    arma::mat& gradient,
+    arma::mat& iterate) const
+{
+  const double step = stepSize / count;
+  if (!UseSparseGradient(worker))
+  {
+    // The function would rather use its dense gradient.
+    const double objective = EvaluateWithGradientBatch(worker, coordinates,
+        begin, gradient, count);
+
+    double* iterateMem = iterate.memptr();
+    const double* gradientMem = gradient.memptr();
+    for (size_t i = 0; i < iterate.n_elem; ++i)
+      iterateMem[i] -= step * gradientMem[i];
+
+    return objective;
+  }
+
+  const double objective = EvaluateBatch(worker, coordinates, begin, count);
+
+  // Apply the update of each point as soon as its gradient is known, and only
+  // write the entries it touches.
+  arma::sp_mat sparseGradient;
+  for (size_t i = begin; i < begin + count; ++i)
+  {
+    worker.Gradient(coordinates, i, sparseGradient);
+    for (arma::sp_mat::const_iterator it = sparseGradient.begin();
+        it != sparseGradient.end(); ++it)
+    {
+      iterate(it.row(), it.col()) -= step * (*it);
+    }
+  }
+
+  return objective;
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+void ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::TreeReduce(
+    std::vector<arma::mat>& gradients)
+{
+  const size_t n = gradients.size();
+  for (size_t stride = 1; stride < n; stride *= 2)
+  {
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t r = 0; r < (intmax_t) (n - stride); r += 2 * stride)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t r = 0; r < n - stride; r += 2 * stride)
+#endif
+    {
+      gradients[r] += gradients[r + stride];
+    }
+  }
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+template<typename FunctionType>
+typename std::enable_if<
+    HasFunctionParameters<FunctionType>::value, void>::type
+ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::CreateWorkers(
+    FunctionType& function,
+    const size_t workerCount,
+    std::vector<FunctionType>& replicas,
+    std::vector<FunctionType*>& workers)
+{
+  replicas.reserve(workerCount);
+  for (size_t r = 0; r < workerCount; ++r)
+    replicas.push_back(function);
+
+  workers.resize(workerCount);
+  for (size_t r = 0; r < workerCount; ++r)
+    workers[r] = &replicas[r];
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+template<typename FunctionType>
+typename std::enable_if<
+    !HasFunctionParameters<FunctionType>::value, void>::type
+ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::CreateWorkers(
+    FunctionType& function,
+    const size_t workerCount,
+    std::vector<FunctionType>& /* replicas */,
+    std::vector<FunctionType*>& workers)
+{
+  workers.assign(workerCount, &function);
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+template<typename FunctionType>
+typename std::enable_if<
+    HasFunctionParameters<FunctionType>::value, const arma::mat&>::type
+ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::Coordinates(
+    FunctionType& worker, const arma::mat& iterate)
+{
+  worker.Parameters() = iterate;
+  return worker.Parameters();
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+template<typename FunctionType>
+typename std::enable_if<
+    !HasFunctionParameters<FunctionType>::value, const arma::mat&>::type
+ParallelSGD<DecomposableFunctionType, UpdatePolicyType>::Coordinates(
+    FunctionType& /* worker */, const arma::mat& iterate)
+{
+  return iterate;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -16,6 +16,7 @@
 #define MLPACK_CORE_OPTIMIZERS_RMSPROP_RMSPROP_UPDATE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/elementwise_update.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -60,35 +61,101 @@ class RMSPropUpdate
   }
 
   /**
-   * The Initialize method is called by SGD Optimizer method before the start of
-   * the iteration update process.
+   * The Policy class holds the state of the update for an iterate of the given
+   * matrix type; SGD creates one before the start of the iteration update
+   * process.
    *
-   * @param rows Number of rows in the gradient matrix.
-   * @param cols Number of columns in the gradient matrix.
+   * @tparam MatType Type of the iterate and the gradient (arma::mat or
+   *     arma::fmat).
    */
-  void Initialize(const size_t rows,
-                  const size_t cols)
+  template<typename MatType>
+  class Policy
   {
-    // Leaky sum of squares of parameter gradient.
-    meanSquaredGradient = arma::zeros<arma::mat>(rows, cols);
-  }
+   public:
+    /**
+     * Create the state of the RMSProp update.
+     *
+     * @param parent Instantiated update policy.
+     * @param rows Number of rows in the gradient matrix.
+     * @param cols Number of columns in the gradient matrix.
+     */
+    Policy(RMSPropUpdate& parent, const size_t rows, const size_t cols) :
+        parent(parent),
+        meanSquaredGradient(arma::zeros<MatType>(rows, cols))
+    {
+      // Nothing to do.
+    }
 
-  /**
-   * Update step for RMSProp.
-   *
-   * @param iterate Parameters that minimize the function.
-   * @param stepSize Step size to be used for the given iteration.
-   * @param gradient The gradient matrix.
-   */
-  void Update(arma::mat& iterate,
-              const double stepSize,
-              const arma::mat& gradient)
-  {
-    meanSquaredGradient *= alpha;
-    meanSquaredGradient += (1 - alpha) * (gradient % gradient);
-    iterate -= stepSize * gradient / (arma::sqrt(meanSquaredGradient) +
-        epsilon);
-  }
+    /**
+     * Update step for RMSProp.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const MatType& gradient)
+    {
+      typedef typename MatType::elem_type ElemType;
+
+      // Update the mean squared gradient and the iterate in one pass.
+      const ElemType alpha = parent.alpha;
+      const ElemType epsilon = parent.epsilon;
+      const ElemType step = stepSize;
+      ElemType* iteratePtr = iterate.memptr();
+      ElemType* meanSquaredGradientPtr = meanSquaredGradient.memptr();
+      const ElemType* gradientPtr = gradient.memptr();
+      ElementwiseUpdate(iterate.n_elem, [&](const size_t begin,
+                                            const size_t end)
+      {
+        MLPACK_SIMD
+        for (size_t i = begin; i < end; ++i)
+        {
+          const ElemType g = gradientPtr[i];
+          const ElemType r = alpha * meanSquaredGradientPtr[i] +
+              (1 - alpha) * g * g;
+          meanSquaredGradientPtr[i] = r;
+          iteratePtr[i] -= step * g / (std::sqrt(r) + epsilon);
+        }
+      });
+    }
+
+    /**
+     * Lazy update step for RMSProp with a sparse gradient: the mean squared
+     * gradient and the iterate are only updated where the gradient is
+     * non-zero, so the decay of the mean squared gradient of the other entries
+     * is skipped until their gradient is non-zero again.  This is not the same
+     * as the dense update, but it costs O(nnz) instead of O(d) per step.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The sparse gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const arma::SpMat<typename MatType::elem_type>& gradient)
+    {
+      for (auto it = gradient.begin(); it != gradient.end(); ++it)
+      {
+        const size_t row = it.row();
+        const size_t col = it.col();
+        const double g = (*it);
+
+        meanSquaredGradient(row, col) = parent.alpha *
+            meanSquaredGradient(row, col) + (1 - parent.alpha) * g * g;
+        iterate(row, col) -= stepSize * g /
+            (std::sqrt(meanSquaredGradient(row, col)) + parent.epsilon);
+      }
+    }
+
+   private:
+    // The instantiated update policy.
+    RMSPropUpdate& parent;
+
+    // Leaky sum of squares of parameter gradient.
+    MatType meanSquaredGradient;
+  };
 
   //! Get the value used to initialise the squared gradient parameter.
   double Epsilon() const { return epsilon; }
@@ -106,9 +173,6 @@ class RMSPropUpdate
 
   // The smoothing parameter.
   double alpha;
-
-  // Leaky sum of squares of parameter gradient.
-  arma::mat meanSquaredGradient;
 };
 
 } // namespace optimization
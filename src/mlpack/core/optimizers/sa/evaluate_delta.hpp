@@ -0,0 +1,85 @@
+/**
+ * @file evaluate_delta.hpp
+ *
+ * Helper function for the annealing optimizers, which change one coordinate of
+ * the iterate at a time.  If the function type provides EvaluateDelta(), which
+ * returns the change of the objective for a move of a single coordinate
+ * (usually much cheaper than a full evaluation), that is used; otherwise, the
+ * objective is evaluated again after the move.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SA_EVALUATE_DELTA_HPP
+#define MLPACK_CORE_OPTIMIZERS_SA_EVALUATE_DELTA_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(EvaluateDelta, HasEvaluateDeltaCheck);
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double EvaluateDelta(const arma::mat& coordinates, const size_t index,
+ *     const double value) (const or not), which returns the change of the
+ * objective when coordinates(index) is set to the given value.
+ */
+template<typename FunctionType>
+struct HasEvaluateDelta
+{
+  static const bool value =
+    HasEvaluateDeltaCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&, const size_t,
+                                const double)>::value ||
+    HasEvaluateDeltaCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&, const size_t,
+                                const double) const>::value;
+};
+
+/**
+ * Move coordinate index of the iterate to the given value, and return the
+ * objective after the move, using the EvaluateDelta() function of the function
+ * and the objective before the move.
+ */
+template<typename FunctionType>
+inline double EvaluateMove(
+    FunctionType& function,
+    arma::mat& iterate,
+    const size_t index,
+    const double value,
+    const double energy,
+    const typename std::enable_if_t<
+        HasEvaluateDelta<FunctionType>::value>* = 0)
+{
+  const double delta = function.EvaluateDelta(iterate, index, value);
+  iterate(index) = value;
+  return energy + delta;
+}
+
+/**
+ * Move coordinate index of the iterate to the given value, and return the
+ * objective after the move, by calling Evaluate().
+ */
+template<typename FunctionType>
+inline double EvaluateMove(
+    FunctionType& function,
+    arma::mat& iterate,
+    const size_t index,
+    const double value,
+    const double /* energy */,
+    const typename std::enable_if_t<
+        !HasEvaluateDelta<FunctionType>::value>* = 0)
+{
+  iterate(index) = value;
+  return function.Evaluate(iterate);
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
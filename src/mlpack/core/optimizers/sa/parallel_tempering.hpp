@@ -0,0 +1,226 @@
+/**
+ * @file parallel_tempering.hpp
+ *
+ * Parallel tempering (replica exchange Monte Carlo): several simulated
+ * annealing chains at fixed, different temperatures, which exchange their
+ * states.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SA_PARALLEL_TEMPERING_HPP
+#define MLPACK_CORE_OPTIMIZERS_SA_PARALLEL_TEMPERING_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Parallel tempering runs numChains Metropolis chains, each at its own fixed
+ * temperature, on separate threads.  Every exchangeSweeps sweeps the chains
+ * stop, and the states of neighbouring chains are exchanged with probability
+ *
+ *   min{1, exp((1 / T_i - 1 / T_j) * (E_i - E_j))},
+ *
+ * so that good states found by the hot chains, which move freely between the
+ * basins of the function, drift down to the cold chains, which refine them.
+ * The even pairs are tried after one round and the odd pairs after the next.
+ * By default the temperatures form a geometric ladder between minTemperature
+ * and maxTemperature; they can be changed with Temperatures().
+ *
+ * Each chain moves one coordinate at a time, as SA does, with the same Laplace
+ * moves and feedback move control; the move sizes belong to the temperatures,
+ * so they are not exchanged with the states.
+ *
+ * The optimization stops when the best objective found has improved by less
+ * than tolerance for maxToleranceRounds consecutive rounds, or after
+ * maxIterations rounds.  The best state at the end of any round is returned.
+ *
+ * For ParallelTempering to work, the FunctionType parameter must implement the
+ * following two methods:
+ *
+ *   double Evaluate(const arma::mat& coordinates);
+ *   arma::mat& GetInitialPoint();
+ *
+ * and Evaluate() must be safe to call from several threads at once.  If the
+ * FunctionType also implements
+ *
+ *   double EvaluateDelta(const arma::mat& coordinates, const size_t index,
+ *                        const double value);
+ *
+ * which returns the change of the objective when coordinates(index) is set to
+ * value, it is used to score each move instead of Evaluate() (and must be
+ * thread-safe too).
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @article{earl2005parallel,
+ *   title   = {Parallel tempering: Theory, applications, and new
+ *              perspectives},
+ *   author  = {Earl, David J. and Deem, Michael W.},
+ *   journal = {Physical Chemistry Chemical Physics},
+ *   volume  = {7},
+ *   number  = {23},
+ *   pages   = {3910--3916},
+ *   year    = {2005}
+ * }
+ * @endcode
+ *
+ * @tparam FunctionType Objective function type to be minimized.
+ */
+template<typename FunctionType>
+class ParallelTempering
+{
+ public:
+  /**
+   * Construct the ParallelTempering optimizer with the given function and
+   * parameters.
+   *
+   * @param function Function to be minimized.
+   * @param numChains Number of chains (and temperatures).
+   * @param minTemperature Temperature of the coldest chain.
+   * @param maxTemperature Temperature of the hottest chain.
+   * @param exchangeSweeps Sweeps of each chain between replica exchanges.
+   * @param maxIterations Maximum number of rounds of sweeps and exchanges (0
+   *      indicates no limit).
+   * @param moveCtrlSweep Sweeps per feedback move control.
+   * @param tolerance Improvement of the best objective below which a round
+   *      doesn't count as progress.
+   * @param maxToleranceRounds Maximum consecutive rounds without progress.
+   * @param maxMoveCoef Maximum move size.
+   * @param initMoveCoef Initial move size.
+   * @param gain Proportional control in feedback move control.
+   */
+  ParallelTempering(FunctionType& function,
+                    const size_t numChains = 8,
+                    const double minTemperature = 1.0,
+                    const double maxTemperature = 100.0,
+                    const size_t exchangeSweeps = 1,
+                    const size_t maxIterations = 100000,
+                    const size_t moveCtrlSweep = 100,
+                    const double tolerance = 1e-5,
+                    const size_t maxToleranceRounds = 1000,
+                    const double maxMoveCoef = 20,
+                    const double initMoveCoef = 0.3,
+                    const double gain = 0.3);
+
+  /**
+   * Optimize the given function using parallel tempering.  All chains start at
+   * the given point, which will be modified to store the best point found, and
+   * the objective value of that point is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const FunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  FunctionType& Function() { return function; }
+
+  //! Get the temperatures of the chains, coldest first.
+  const arma::vec& Temperatures() const { return temperatures; }
+  //! Modify the temperatures of the chains, coldest first.
+  arma::vec& Temperatures() { return temperatures; }
+
+  //! Get the sweeps between replica exchanges.
+  size_t ExchangeSweeps() const { return exchangeSweeps; }
+  //! Modify the sweeps between replica exchanges.
+  size_t& ExchangeSweeps() { return exchangeSweeps; }
+
+  //! Get the maximum number of rounds.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of rounds.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get sweeps per move control.
+  size_t MoveCtrlSweep() const { return moveCtrlSweep; }
+  //! Modify sweeps per move control.
+  size_t& MoveCtrlSweep() { return moveCtrlSweep; }
+
+  //! Get the tolerance.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the maximum number of rounds without progress.
+  size_t MaxToleranceRounds() const { return maxToleranceRounds; }
+  //! Modify the maximum number of rounds without progress.
+  size_t& MaxToleranceRounds() { return maxToleranceRounds; }
+
+  //! Get the maximum move size.
+  double MaxMoveCoef() const { return maxMoveCoef; }
+  //! Modify the maximum move size.
+  double& MaxMoveCoef() { return maxMoveCoef; }
+
+  //! Get the initial move size.
+  double InitMoveCoef() const { return initMoveCoef; }
+  //! Modify the initial move size.
+  double& InitMoveCoef() { return initMoveCoef; }
+
+  //! Get the gain.
+  double Gain() const { return gain; }
+  //! Modify the gain.
+  double& Gain() { return gain; }
+
+  //! Get the fraction of accepted exchanges of the last optimization, for
+  //! each pair of neighbouring chains.
+  const arma::vec& ExchangeRates() const { return exchangeRates; }
+
+ private:
+  //! The function to be optimized.
+  FunctionType& function;
+  //! The temperatures of the chains, coldest first.
+  arma::vec temperatures;
+  //! The number of sweeps between replica exchanges.
+  size_t exchangeSweeps;
+  //! The maximum number of rounds.
+  size_t maxIterations;
+  //! The number of sweeps before a MoveControl() call.
+  size_t moveCtrlSweep;
+  //! Tolerance for convergence.
+  double tolerance;
+  //! Number of rounds without progress before the optimization stops.
+  size_t maxToleranceRounds;
+  //! Maximum move size of each parameter.
+  double maxMoveCoef;
+  //! Initial move size of each parameter.
+  double initMoveCoef;
+  //! Proportional control in feedback move control.
+  double gain;
+  //! The fraction of accepted exchanges of each pair of chains.
+  arma::vec exchangeRates;
+
+  /**
+   * Propose a move on element iterate(idx) at the given temperature, accept or
+   * reject it according to the Metropolis criterion, and advance idx; this is
+   * SA::GenerateMove() for one chain.
+   *
+   * @param iterate Current state of the chain.
+   * @param accept Accepted moves of each parameter since the last move control.
+   * @param moveSize Move size of each parameter.
+   * @param temperature Temperature of the chain.
+   * @param energy Current energy of the chain.
+   * @param idx Current parameter to modify.
+   * @param sweepCounter Sweeps since the last move control.
+   */
+  void GenerateMove(arma::mat& iterate,
+                    arma::mat& accept,
+                    arma::mat& moveSize,
+                    const double temperature,
+                    double& energy,
+                    size_t& idx,
+                    size_t& sweepCounter);
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#include "parallel_tempering_impl.hpp"
+
+#endif
@@ -0,0 +1,232 @@
+/**
+ * @file parallel_tempering_impl.hpp
+ *
+ * The implementation of the ParallelTempering optimizer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SA_PARALLEL_TEMPERING_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_SA_PARALLEL_TEMPERING_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_tempering.hpp"
+
+#include "evaluate_delta.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename FunctionType>
+ParallelTempering<FunctionType>::ParallelTempering(
+    FunctionType& function,
+    const size_t numChains,
+    const double minTemperature,
+    const double maxTemperature,
+    const size_t exchangeSweeps,
+    const size_t maxIterations,
+    const size_t moveCtrlSweep,
+    const double tolerance,
+    const size_t maxToleranceRounds,
+    const double maxMoveCoef,
+    const double initMoveCoef,
+    const double gain) :
+    function(function),
+    exchangeSweeps(exchangeSweeps),
+    maxIterations(maxIterations),
+    moveCtrlSweep(moveCtrlSweep),
+    tolerance(tolerance),
+    maxToleranceRounds(maxToleranceRounds),
+    maxMoveCoef(maxMoveCoef),
+    initMoveCoef(initMoveCoef),
+    gain(gain)
+{
+  if (numChains == 0)
+  {
+    throw std::invalid_argument("ParallelTempering: there must be at least one "
+        "chain");
+  }
+
+  if (minTemperature <= 0 || maxTemperature < minTemperature)
+  {
+    throw std::invalid_argument("ParallelTempering: the temperatures must be "
+        "positive, and maxTemperature must not be below minTemperature");
+  }
+
+  // A geometric ladder gives about the same exchange rate to each pair when the
+  // heat capacity of the function is roughly constant.
+  temperatures.set_size(numChains);
+  for (size_t i = 0; i < numChains; ++i)
+  {
+    temperatures[i] = (numChains == 1) ? minTemperature : minTemperature *
+        std::pow(maxTemperature / minTemperature, (double) i /
+        (numChains - 1));
+  }
+}
+
+//! Optimize the function (minimize).
+template<typename FunctionType>
+double ParallelTempering<FunctionType>::Optimize(arma::mat& iterate)
+{
+  const size_t numChains = temperatures.n_elem;
+  if (numChains == 0)
+  {
+    throw std::invalid_argument("ParallelTempering::Optimize(): there are no "
+        "temperatures");
+  }
+
+  // Every chain starts at the given point.
+  const double initialEnergy = function.Evaluate(iterate);
+  std::vector<arma::mat> iterates(numChains, iterate);
+  std::vector<double> energies(numChains, initialEnergy);
+  std::vector<arma::mat> accepts(numChains,
+      arma::zeros<arma::mat>(iterate.n_rows, iterate.n_cols));
+  std::vector<arma::mat> moveSizes(numChains, arma::mat(iterate.n_rows,
+      iterate.n_cols));
+  for (size_t c = 0; c < numChains; ++c)
+    moveSizes[c].fill(initMoveCoef);
+  std::vector<size_t> idxs(numChains, 0);
+  std::vector<size_t> sweepCounters(numChains, 0);
+
+  arma::mat bestIterate(iterate);
+  double bestEnergy = initialEnergy;
+
+  arma::vec exchanges(numChains - 1, arma::fill::zeros);
+  arma::vec attempts(numChains - 1, arma::fill::zeros);
+
+  const size_t movesPerRound = std::max(exchangeSweeps, (size_t) 1) *
+      iterate.n_elem;
+  size_t frozenCount = 0;
+  size_t round = 0;
+  for (; round != maxIterations; ++round)
+  {
+    // Each chain sweeps on its own; they only share the function.
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(static)
+    for (intmax_t c = 0; c < (intmax_t) numChains; ++c)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t c = 0; c < numChains; ++c)
+#endif
+    {
+      for (size_t i = 0; i < movesPerRound; ++i)
+      {
+        GenerateMove(iterates[c], accepts[c], moveSizes[c], temperatures[c],
+            energies[c], idxs[c], sweepCounters[c]);
+      }
+    }
+
+    // Try to exchange the states of the even pairs after even rounds and of
+    // the odd pairs after odd rounds; the swaps only move pointers.
+    for (size_t c = round % 2; c + 1 < numChains; c += 2)
+    {
+      const double exponent = (1.0 / temperatures[c] -
+          1.0 / temperatures[c + 1]) * (energies[c] - energies[c + 1]);
+      ++attempts[c];
+      if (exponent >= 0 || math::Random() < std::exp(exponent))
+      {
+        iterates[c].swap(iterates[c + 1]);
+        std::swap(energies[c], energies[c + 1]);
+        ++exchanges[c];
+      }
+    }
+
+    const size_t best = std::min_element(energies.begin(), energies.end()) -
+        energies.begin();
+    if (energies[best] < bestEnergy - tolerance)
+      frozenCount = 0;
+    else
+      ++frozenCount;
+
+    if (energies[best] < bestEnergy)
+    {
+      bestEnergy = energies[best];
+      bestIterate = iterates[best];
+    }
+
+    // Terminate, if possible.
+    if (frozenCount >= maxToleranceRounds)
+    {
+      Log::Debug << "ParallelTempering: minimized within tolerance "
+          << tolerance << " for " << maxToleranceRounds << " rounds after "
+          << round + 1 << " rounds; terminating optimization." << std::endl;
+      break;
+    }
+  }
+
+  if (round == maxIterations)
+  {
+    Log::Debug << "ParallelTempering: maximum iterations (" << maxIterations
+        << ") reached; terminating optimization." << std::endl;
+  }
+
+  exchangeRates = exchanges / arma::max(attempts, arma::ones<arma::vec>(
+      attempts.n_elem));
+
+  iterate = std::move(bestIterate);
+  return bestEnergy;
+}
+
+template<typename FunctionType>
+void ParallelTempering<FunctionType>::GenerateMove(
+    arma::mat& iterate,
+    arma::mat& accept,
+    arma::mat& moveSize,
+    const double temperature,
+    double& energy,
+    size_t& idx,
+    size_t& sweepCounter)
+{
+  const double prevEnergy = energy;
+  const double prevValue = iterate(idx);
+
+  // Sample from a Laplace distribution with scale parameter moveSize(idx).
+  const double unif = 2.0 * math::Random() - 1.0;
+  const double move = (unif < 0) ? (moveSize(idx) * std::log(1 + unif)) :
+      (-moveSize(idx) * std::log(1 - unif));
+
+  energy = EvaluateMove(function, iterate, idx, prevValue + move, prevEnergy);
+
+  // According to the Metropolis criterion, accept the move with probability
+  // min{1, exp(-(E_new - E_old) / T)}.
+  const double delta = energy - prevEnergy;
+  if (delta <= 0. || std::exp(-delta / temperature) > math::Random())
+  {
+    accept(idx) += 1.;
+  }
+  else // Reject the move; restore previous state.
+  {
+    iterate(idx) = prevValue;
+    energy = prevEnergy;
+  }
+
+  ++idx;
+  if (idx == iterate.n_elem) // Finished with a sweep.
+  {
+    idx = 0;
+    ++sweepCounter;
+  }
+
+  // Do the feedback move control of SA::MoveControl(), with target acceptance
+  // ratio 0.44.
+  if (sweepCounter == moveCtrlSweep)
+  {
+    for (size_t i = 0; i < accept.n_elem; ++i)
+    {
+      moveSize(i) = std::min(std::exp(std::log(moveSize(i)) + gain *
+          (accept(i) / moveCtrlSweep - 0.44)), maxMoveCoef);
+    }
+
+    accept.zeros();
+    sweepCounter = 0;
+  }
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -55,6 +55,14 @@ namespace optimization {
  * which returns the next temperature given current temperature and the value
  * of the function being optimized.
  *
+ * If the FunctionType also implements
+ *
+ *   double EvaluateDelta(const arma::mat& coordinates, const size_t index,
+ *                        const double value);
+ *
+ * which returns the change of the objective when coordinates(index) is set to
+ * value, it is used to score each move instead of Evaluate().
+ *
  * @tparam FunctionType objective function type to be minimized.
  * @tparam CoolingScheduleType type for cooling schedule
  */
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_OPTIMIZERS_SA_SA_IMPL_HPP
 
 #include <mlpack/core/dists/laplace_distribution.hpp>
+#include "evaluate_delta.hpp"
 
 namespace mlpack {
 namespace optimization {
@@ -137,8 +138,7 @@ void SA<FunctionType, CoolingScheduleType>::GenerateMove(
   const double move = (unif < 0) ? (moveSize(idx) * std::log(1 + unif)) :
       (-moveSize(idx) * std::log(1 - unif));
 
-  iterate(idx) += move;
-  energy = function.Evaluate(iterate);
+  energy = EvaluateMove(function, iterate, idx, prevValue + move, prevEnergy);
   // According to the Metropolis criterion, accept the move with probability
   // min{1, exp(-(E_new - E_old) / T)}.
   const double xi = math::Random();
@@ -0,0 +1,232 @@
+/**
+ * @file saga.hpp
+ *
+ * SAGA, an incremental gradient method with variance reduction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SAGA_SAGA_HPP
+#define MLPACK_CORE_OPTIMIZERS_SAGA_SAGA_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
+#include <mlpack/core/optimizers/svrg/full_gradient.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(GradientCoefficient, HasGradientCoefficientCheck);
+HAS_MEM_FUNC(AddScaledPoint, HasAddScaledPointCheck);
+HAS_MEM_FUNC(RegularizationGradient, HasRegularizationGradientCheck);
+
+/**
+ * 'value' is true if the FunctionType class is a linear model whose separable
+ * gradients are a scalar multiple of a fixed vector, plus a regularization
+ * term, that is, if it has the const members
+ *
+ *   double GradientCoefficient(const arma::mat& parameters, const size_t i);
+ *   void AddScaledPoint(const size_t i, const double scale,
+ *                       arma::mat& gradient);
+ *   void RegularizationGradient(const arma::mat& parameters,
+ *                               arma::mat& gradient);
+ *
+ * such that Gradient(parameters, i, g) is
+ * GradientCoefficient(parameters, i) times the vector added by
+ * AddScaledPoint(i, 1.0, g), plus 1 / NumFunctions() times the
+ * RegularizationGradient() of the parameters.
+ */
+template<typename FunctionType>
+struct HasLinearGradient
+{
+  static const bool value =
+    HasGradientCoefficientCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&, const size_t) const>::value &&
+    HasAddScaledPointCheck<FunctionType,
+        void(FunctionType::*)(const size_t,
+                              const double,
+                              arma::mat&) const>::value &&
+    HasRegularizationGradientCheck<FunctionType,
+        void(FunctionType::*)(const arma::mat&, arma::mat&) const>::value;
+};
+
+/**
+ * SAGA minimizes a function that is a sum of n separable functions by keeping
+ * the last gradient computed for each function in a table.  Each step visits
+ * one function j, computes its gradient at the current iterate, and takes
+ *
+ * \f[
+ * w \leftarrow w - \eta \left( \nabla f_j(w) - g_j + \frac{1}{n} \sum_i g_i
+ *     \right),
+ * \f]
+ *
+ * before g_j is replaced by the new gradient.  Like SVRG, the variance of the
+ * steps vanishes at the optimum and the objective converges linearly when it
+ * is strongly convex, but each step evaluates a single gradient and no full
+ * gradient passes are needed; the table is filled in parallel at the starting
+ * point, and the objective used for the termination check is computed in
+ * parallel after each epoch (one pass over the functions).
+ *
+ * The table holds NumFunctions() gradients, which is prohibitive for large
+ * models.  If the function is a linear model (see HasLinearGradient), such as
+ * LogisticRegressionFunction, each gradient is a scalar multiple of its point
+ * plus the regularization gradient, so only one scalar per function is stored
+ * and the regularization gradient is recomputed at each step.
+ *
+ * The DecomposableFunctionType must implement the functions needed by SGD:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * All the threads share the function, so these must be safe to call
+ * concurrently (const functions usually are).  Functions that are evaluated at
+ * their own parameters (see HasFunctionParameters), like FFN, are not
+ * supported.
+ *
+ * For more information, see the following paper.
+ *
+ * @code
+ * @inproceedings{Defazio2014,
+ *   author = {Defazio, Aaron and Bach, Francis and Lacoste-Julien, Simon},
+ *   title = {SAGA: A Fast Incremental Gradient Method With Support for
+ *       Non-Strongly Convex Composite Objectives},
+ *   booktitle = {Advances in Neural Information Processing Systems 27},
+ *   pages = {1646--1654},
+ *   year = {2014}
+ * }
+ * @endcode
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class SAGA
+{
+  static_assert(!HasFunctionParameters<DecomposableFunctionType>::value,
+      "SAGA does not support functions that are evaluated at their own "
+      "parameters");
+
+ public:
+  /**
+   * Construct the SAGA optimizer with the given function and parameters.  One
+   * iteration is one epoch, that is, NumFunctions() steps.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each step.
+   * @param maxIterations Maximum number of epochs allowed (0 means no limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the function order is shuffled; otherwise, each
+   *     function is visited in linear order.
+   */
+  SAGA(DecomposableFunctionType& function,
+       const double stepSize = 0.01,
+       const size_t maxIterations = 100,
+       const double tolerance = 1e-5,
+       const bool shuffle = true);
+
+  /**
+   * Optimize the given function using SAGA.  The given starting point will be
+   * modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param function Function to optimize.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(DecomposableFunctionType& function, arma::mat& iterate);
+
+  /**
+   * Optimize the given function using SAGA.  The given starting point will be
+   * modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate)
+  {
+    return Optimize(this->function, iterate);
+  }
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the maximum number of epochs (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of epochs (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+ private:
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The step size for each step.
+  double stepSize;
+
+  //! The maximum number of epochs.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled when
+  //! iterating.
+  bool shuffle;
+
+  /**
+   * Run the epochs, with a table of one gradient per function.
+   */
+  template<typename FunctionType>
+  double Epochs(FunctionType& function,
+                arma::mat& iterate,
+                const typename std::enable_if_t<
+                    !HasLinearGradient<FunctionType>::value>* = 0);
+
+  /**
+   * Run the epochs, with a table of one gradient coefficient per function.
+   */
+  template<typename FunctionType>
+  double Epochs(FunctionType& function,
+                arma::mat& iterate,
+                const typename std::enable_if_t<
+                    HasLinearGradient<FunctionType>::value>* = 0);
+
+  /**
+   * Output the objective of an epoch and decide whether to stop.  Returns true
+   * if the optimization should terminate.
+   */
+  bool Terminate(const size_t epoch,
+                 const double objective,
+                 double& lastObjective) const;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "saga_impl.hpp"
+
+#endif
@@ -0,0 +1,238 @@
+/**
+ * @file saga_impl.hpp
+ *
+ * Implementation of the SAGA optimizer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SAGA_SAGA_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_SAGA_SAGA_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "saga.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType>
+SAGA<DecomposableFunctionType>::SAGA(DecomposableFunctionType& function,
+                                     const double stepSize,
+                                     const size_t maxIterations,
+                                     const double tolerance,
+                                     const bool shuffle) :
+    function(function),
+    stepSize(stepSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType>
+double SAGA<DecomposableFunctionType>::Optimize(
+    DecomposableFunctionType& function,
+    arma::mat& iterate)
+{
+  return Epochs(function, iterate);
+}
+
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+double SAGA<DecomposableFunctionType>::Epochs(
+    FunctionType& function,
+    arma::mat& iterate,
+    const typename std::enable_if_t<
+        !HasLinearGradient<FunctionType>::value>*)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  // Fill the table with the gradients at the starting point.
+  arma::mat gradients(iterate.n_elem, numFunctions);
+  #pragma omp parallel
+  {
+    arma::mat gradient;
+
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+#ifdef _WIN32
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) numFunctions; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < numFunctions; ++i)
+#endif
+    {
+      function.Gradient(iterate, i, gradient);
+      gradients.col(i) = arma::vectorise(gradient);
+    }
+  }
+  arma::mat average = arma::reshape(arma::mean(gradients, 1), iterate.n_rows,
+      iterate.n_cols);
+
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (numFunctions - 1), numFunctions);
+
+  double lastObjective = DBL_MAX;
+  double objective = FullEvaluate(function, iterate);
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  for (size_t i = 0; i != maxIterations; ++i)
+  {
+    if (Terminate(i, objective, lastObjective))
+      return objective;
+
+    if (shuffle)
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    for (size_t j = 0; j < numFunctions; ++j)
+    {
+      const size_t currentFunction = visitationOrder[j];
+      arma::mat storedGradient(gradients.colptr(currentFunction),
+          iterate.n_rows, iterate.n_cols, false, true);
+
+      // Step with the difference to the stored gradient, then store the new
+      // gradient.
+      function.Gradient(iterate, currentFunction, gradient);
+      gradient -= storedGradient;
+      iterate -= stepSize * (gradient + average);
+      average += gradient / numFunctions;
+      storedGradient += gradient;
+    }
+
+    objective = FullEvaluate(function, iterate);
+  }
+
+  Log::Info << "SAGA: maximum iterations (" << maxIterations << ") reached; "
+      << "terminating optimization." << std::endl;
+
+  return objective;
+}
+
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+double SAGA<DecomposableFunctionType>::Epochs(
+    FunctionType& function,
+    arma::mat& iterate,
+    const typename std::enable_if_t<
+        HasLinearGradient<FunctionType>::value>*)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  // Fill the table with the coefficients at the starting point.  Each thread
+  // accumulates the gradients of its functions; these are summed in thread
+  // order afterwards, so the result only depends on the number of threads.
+  arma::vec coefficients(numFunctions);
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+  std::vector<arma::mat> threadAverages(numThreads);
+
+  #pragma omp parallel
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    threadAverages[thread].zeros(iterate.n_rows, iterate.n_cols);
+
+#ifdef _WIN32
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) numFunctions; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < numFunctions; ++i)
+#endif
+    {
+      coefficients[i] = function.GradientCoefficient(iterate, i);
+      function.AddScaledPoint(i, coefficients[i], threadAverages[thread]);
+    }
+  }
+
+  arma::mat average(iterate.n_rows, iterate.n_cols, arma::fill::zeros);
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    // A thread may not have run, if the runtime gave us fewer threads.
+    if (threadAverages[t].n_elem == 0)
+      continue;
+
+    average += threadAverages[t];
+  }
+  average /= numFunctions;
+
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (numFunctions - 1), numFunctions);
+
+  double lastObjective = DBL_MAX;
+  double objective = FullEvaluate(function, iterate);
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  for (size_t i = 0; i != maxIterations; ++i)
+  {
+    if (Terminate(i, objective, lastObjective))
+      return objective;
+
+    if (shuffle)
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    for (size_t j = 0; j < numFunctions; ++j)
+    {
+      const size_t currentFunction = visitationOrder[j];
+      const double coefficient = function.GradientCoefficient(iterate,
+          currentFunction);
+      const double delta = coefficient - coefficients[currentFunction];
+
+      // The regularization gradient is not stored, so it is taken at the
+      // current iterate.
+      function.RegularizationGradient(iterate, gradient);
+      gradient /= numFunctions;
+      gradient += average;
+      function.AddScaledPoint(currentFunction, delta, gradient);
+      iterate -= stepSize * gradient;
+
+      function.AddScaledPoint(currentFunction, delta / numFunctions, average);
+      coefficients[currentFunction] = coefficient;
+    }
+
+    objective = FullEvaluate(function, iterate);
+  }
+
+  Log::Info << "SAGA: maximum iterations (" << maxIterations << ") reached; "
+      << "terminating optimization." << std::endl;
+
+  return objective;
+}
+
+template<typename DecomposableFunctionType>
+bool SAGA<DecomposableFunctionType>::Terminate(const size_t epoch,
+                                               const double objective,
+                                               double& lastObjective) const
+{
+  Log::Info << "SAGA: iteration " << epoch << ", objective " << objective
+      << "." << std::endl;
+
+  if (std::isnan(objective) || std::isinf(objective))
+  {
+    Log::Warn << "SAGA: converged to " << objective << "; terminating with "
+        << "failure.  Try a smaller step size?" << std::endl;
+    return true;
+  }
+
+  if (std::abs(lastObjective - objective) < tolerance)
+  {
+    Log::Info << "SAGA: minimized within tolerance " << tolerance << "; "
+        << "terminating optimization." << std::endl;
+    return true;
+  }
+
+  lastObjective = objective;
+  return false;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -44,11 +44,62 @@ LRSDPFunction<SDPType>::LRSDPFunction(const size_t numSparseConstraints,
         << "transposed solution." << std::endl;
 }
 
+//! Compute Tr(A * (R R^T)) for a sparse A, without forming R R^T: each
+//! non-zero A(j, k) contributes A(j, k) * dot(R.row(j), R.row(k)).  The columns
+//! of coordinatesT are the rows of R.
+inline double TraceProduct(const arma::sp_mat& a,
+                           const arma::mat& /* coordinates */,
+                           const arma::mat& coordinatesT)
+{
+  double trace = 0.0;
+  for (arma::sp_mat::const_iterator it = a.begin(); it != a.end(); ++it)
+  {
+    trace += (*it) * arma::dot(coordinatesT.col(it.row()),
+        coordinatesT.col(it.col()));
+  }
+
+  return trace;
+}
+
+//! Compute Tr(A * (R R^T)) for a dense A as the sum of (A * R) % R, which
+//! doesn't need the n x n matrix R R^T either.
+inline double TraceProduct(const arma::mat& a,
+                           const arma::mat& coordinates,
+                           const arma::mat& /* coordinatesT */)
+{
+  return arma::accu((a * coordinates) % coordinates);
+}
+
+//! Compute Tr(A_i * (R R^T)) - b_i for each of the given constraints.  The
+//! constraints are independent, so they are computed in parallel.
+template <typename MatrixType>
+inline void ConstraintValues(const std::vector<MatrixType>& ais,
+                             const arma::vec& bis,
+                             const arma::mat& coordinates,
+                             const arma::mat& coordinatesT,
+                             arma::vec& values)
+{
+  values.set_size(ais.size());
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (intmax_t i = 0; i < (intmax_t) ais.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (size_t i = 0; i < ais.size(); ++i)
+#endif
+  {
+    values[i] = TraceProduct(ais[i], coordinates, coordinatesT) - bis[i];
+  }
+}
+
 template <typename SDPType>
 double LRSDPFunction<SDPType>::Evaluate(const arma::mat& coordinates) const
 {
-  const arma::mat rrt = coordinates * trans(coordinates);
-  return accu(SDP().C() % rrt);
+  return TraceProduct(SDP().C(), coordinates, coordinates.t());
 }
 
 template <typename SDPType>
@@ -64,11 +115,15 @@ double LRSDPFunction<SDPType>::EvaluateConstraint(
     const size_t index,
     const arma::mat& coordinates) const
 {
-  const arma::mat rrt = coordinates * trans(coordinates);
   if (index < SDP().NumSparseConstraints())
-    return accu(SDP().SparseA()[index] % rrt) - SDP().SparseB()[index];
+  {
+    return TraceProduct(SDP().SparseA()[index], coordinates,
+        coordinates.t()) - SDP().SparseB()[index];
+  }
+
   const size_t index1 = index - SDP().NumSparseConstraints();
-  return accu(SDP().DenseA()[index1] % rrt) - SDP().DenseB()[index1];
+  return TraceProduct(SDP().DenseA()[index1], coordinates, coordinates.t()) -
+      SDP().DenseB()[index1];
 }
 
 template <typename SDPType>
@@ -82,50 +137,90 @@ void LRSDPFunction<SDPType>::GradientConstraint(
 }
 
 //! Utility function for calculating part of the objective when AugLagrangian is
-//! used with an LRSDPFunction.
-template <typename MatrixType>
+//! used with an LRSDPFunction, from the values of the given constraints.
 static inline void
 UpdateObjective(double& objective,
-                const arma::mat& rrt,
-                const std::vector<MatrixType>& ais,
-                const arma::vec& bis,
+                const arma::vec& constraints,
                 const arma::vec& lambda,
                 const size_t lambdaOffset,
                 const double sigma)
 {
-  for (size_t i = 0; i < ais.size(); ++i)
+  for (size_t i = 0; i < constraints.n_elem; ++i)
   {
-    // Take the trace subtracted by the b_i.
-    const double constraint = accu(ais[i] % rrt) - bis[i];
-    objective -= (lambda[lambdaOffset + i] * constraint);
-    objective += (sigma / 2.) * constraint * constraint;
+    objective -= (lambda[lambdaOffset + i] * constraints[i]);
+    objective += (sigma / 2.) * constraints[i] * constraints[i];
   }
 }
 
-//! Utility function for calculating part of the gradient when AugLagrangian is
-//! used with an LRSDPFunction.
-template <typename MatrixType>
+//! Utility function for calculating -sum_i y'_i A_i for the sparse constraints,
+//! as one sparse matrix built from the non-zeros of all the A_i at once; the
+//! non-zeros of each constraint are filled in parallel.
 static inline void
-UpdateGradient(arma::mat& s,
-               const arma::mat& rrt,
-               const std::vector<MatrixType>& ais,
-               const arma::vec& bis,
-               const arma::vec& lambda,
-               const size_t lambdaOffset,
-               const double sigma)
+SparseGradientTerm(const arma::mat& coordinates,
+                   const std::vector<arma::sp_mat>& ais,
+                   const arma::vec& constraints,
+                   const arma::vec& lambda,
+                   const double sigma,
+                   arma::sp_mat& term)
 {
+  // Find where the non-zeros of each constraint go.
+  std::vector<size_t> offsets(ais.size() + 1, 0);
+  for (size_t i = 0; i < ais.size(); ++i)
+    offsets[i + 1] = offsets[i] + ais[i].n_nonzero;
+
+  arma::umat locations(2, offsets.back());
+  arma::vec values(offsets.back());
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (intmax_t i = 0; i < (intmax_t) ais.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic, 64)
   for (size_t i = 0; i < ais.size(); ++i)
+#endif
   {
-    const double constraint = accu(ais[i] % rrt) - bis[i];
-    const double y = lambda[lambdaOffset + i] - sigma * constraint;
-    s -= y * ais[i];
+    const double y = lambda[i] - sigma * constraints[i];
+    size_t j = offsets[i];
+    for (arma::sp_mat::const_iterator it = ais[i].begin(); it != ais[i].end();
+        ++it, ++j)
+    {
+      locations(0, j) = it.row();
+      locations(1, j) = it.col();
+      values[j] = -y * (*it);
+    }
   }
+
+  // Duplicate locations are summed.
+  term = arma::sp_mat(true, locations, values, coordinates.n_rows,
+      coordinates.n_rows);
+}
+
+//! Compute Tr(A_i * (R R^T)) - b_i for the sparse and the dense constraints of
+//! the SDP, which both the objective and the gradient need.
+template <typename SDPType>
+static inline void
+AllConstraintValues(const LRSDPFunction<SDPType>& function,
+                    const arma::mat& coordinates,
+                    const arma::mat& coordinatesT,
+                    arma::vec& sparseConstraints,
+                    arma::vec& denseConstraints)
+{
+  ConstraintValues(function.SDP().SparseA(), function.SDP().SparseB(),
+      coordinates, coordinatesT, sparseConstraints);
+  ConstraintValues(function.SDP().DenseA(), function.SDP().DenseB(),
+      coordinates, coordinatesT, denseConstraints);
 }
 
 template <typename SDPType>
 static inline double
 EvaluateImpl(const LRSDPFunction<SDPType>& function,
              const arma::mat& coordinates,
+             const arma::mat& coordinatesT,
+             const arma::vec& sparseConstraints,
+             const arma::vec& denseConstraints,
              const arma::vec& lambda,
              const double sigma)
 {
@@ -133,24 +228,17 @@ EvaluateImpl(const LRSDPFunction<SDPType>& function,
   // L(R, y, s) = Tr(C * (R R^T)) -
   //     sum_{i = 1}^{m} (y_i (Tr(A_i * (R R^T)) - b_i)) +
   //     (sigma / 2) * sum_{i = 1}^{m} (Tr(A_i * (R R^T)) - b_i)^2
-
-  // Let's start with the objective: Tr(C * (R R^T)).
-  // Simple, possibly slow solution-- see below for optimization opportunity
-  //
-  // TODO: Note that Tr(C^T * (R R^T)) = Tr( (CR)^T * R ), so
-  // multiplying C*R first, and then taking the trace dot should be more memory
-  // efficient
   //
-  // Similarly for the constraints, taking A*R first should be more efficient
-  const arma::mat rrt = coordinates * trans(coordinates);
-  double objective = accu(function.SDP().C() % rrt);
+  // None of the traces need the n x n matrix R R^T: for sparse matrices, only
+  // the dot products of the rows of R at the non-zeros are needed, and for
+  // dense matrices Tr(A * (R R^T)) is the sum of (A * R) % R.
+  double objective = TraceProduct(function.SDP().C(), coordinates,
+      coordinatesT);
 
   // Now each constraint.
-  UpdateObjective(objective, rrt, function.SDP().SparseA(),
-      function.SDP().SparseB(), lambda, 0, sigma);
-  UpdateObjective(objective, rrt, function.SDP().DenseA(),
-      function.SDP().DenseB(), lambda, function.SDP().NumSparseConstraints(),
-      sigma);
+  UpdateObjective(objective, sparseConstraints, lambda, 0, sigma);
+  UpdateObjective(objective, denseConstraints, lambda,
+      function.SDP().NumSparseConstraints(), sigma);
 
   return objective;
 }
@@ -159,6 +247,8 @@ template <typename SDPType>
 static inline void
 GradientImpl(const LRSDPFunction<SDPType>& function,
              const arma::mat& coordinates,
+             const arma::vec& sparseConstraints,
+             const arma::vec& denseConstraints,
              const arma::vec& lambda,
              const double sigma,
              arma::mat& gradient)
@@ -168,34 +258,76 @@ GradientImpl(const LRSDPFunction<SDPType>& function,
   //   with
   // S' = C - sum_{i = 1}^{m} y'_i A_i
   // y'_i = y_i - sigma * (Trace(A_i * (R R^T)) - b_i)
-  const arma::mat rrt = coordinates * trans(coordinates);
-  arma::mat s(function.SDP().C());
+  //
+  // The sparse constraints are summed into one sparse matrix, and each part of
+  // S' is multiplied by R separately, so S' itself is never formed.
+  arma::sp_mat sparseTerm;
+  SparseGradientTerm(coordinates, function.SDP().SparseA(), sparseConstraints,
+      lambda, sigma, sparseTerm);
+  gradient = function.SDP().C() * coordinates + sparseTerm * coordinates;
 
-  UpdateGradient(
-      s, rrt, function.SDP().SparseA(), function.SDP().SparseB(),
-      lambda, 0, sigma);
-  UpdateGradient(
-      s, rrt, function.SDP().DenseA(), function.SDP().DenseB(),
-      lambda, function.SDP().NumSparseConstraints(), sigma);
+  const std::vector<arma::mat>& denseA = function.SDP().DenseA();
+  if (!denseA.empty())
+  {
+    const size_t offset = function.SDP().NumSparseConstraints();
+    const arma::vec y = lambda.subvec(offset, offset + denseA.size() - 1) -
+        sigma * denseConstraints;
 
-  gradient = 2 * s * coordinates;
+    // Sum the dense constraints into one matrix before multiplying by R, which
+    // is r times cheaper than multiplying each of them.  Every column of the
+    // sum is independent, so they are computed in parallel.
+    const size_t n = coordinates.n_rows;
+    arma::mat denseTerm(n, n);
+
+  #ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for
+    for (intmax_t j = 0; j < (intmax_t) n; ++j)
+  #else
+    #pragma omp parallel for
+    for (size_t j = 0; j < n; ++j)
+  #endif
+    {
+      denseTerm.col(j) = y[0] * denseA[0].col(j);
+      for (size_t i = 1; i < denseA.size(); ++i)
+        denseTerm.col(j) += y[i] * denseA[i].col(j);
+    }
+
+    gradient -= denseTerm * coordinates;
+  }
+
+  gradient *= 2;
 }
 
 // Template specializations for function and gradient evaluation.
 // Note that C++ does not allow partial specialization of class members,
-// so we have to go about this in a somewhat round-about way.
+// so we have to go about this in a somewhat round-about way.  The constraint
+// values are computed once per call, and only once for both the objective and
+// the gradient in EvaluateWithGradient().
 template <>
 inline double AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>>::Evaluate(
     const arma::mat& coordinates) const
 {
-  return EvaluateImpl(function, coordinates, lambda, sigma);
+  const arma::mat coordinatesT = coordinates.t();
+  arma::vec sparseConstraints, denseConstraints;
+  AllConstraintValues(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints);
+  return EvaluateImpl(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints, lambda, sigma);
 }
 
 template <>
 inline double AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::Evaluate(
     const arma::mat& coordinates) const
 {
-  return EvaluateImpl(function, coordinates, lambda, sigma);
+  const arma::mat coordinatesT = coordinates.t();
+  arma::vec sparseConstraints, denseConstraints;
+  AllConstraintValues(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints);
+  return EvaluateImpl(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints, lambda, sigma);
 }
 
 template <>
@@ -203,7 +335,12 @@ inline void AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>>::Gradient(
     const arma::mat& coordinates,
     arma::mat& gradient) const
 {
-  GradientImpl(function, coordinates, lambda, sigma, gradient);
+  const arma::mat coordinatesT = coordinates.t();
+  arma::vec sparseConstraints, denseConstraints;
+  AllConstraintValues(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints);
+  GradientImpl(function, coordinates, sparseConstraints, denseConstraints,
+      lambda, sigma, gradient);
 }
 
 template <>
@@ -211,7 +348,44 @@ inline void AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::Gradient(
     const arma::mat& coordinates,
     arma::mat& gradient) const
 {
-  GradientImpl(function, coordinates, lambda, sigma, gradient);
+  const arma::mat coordinatesT = coordinates.t();
+  arma::vec sparseConstraints, denseConstraints;
+  AllConstraintValues(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints);
+  GradientImpl(function, coordinates, sparseConstraints, denseConstraints,
+      lambda, sigma, gradient);
+}
+
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  const arma::mat coordinatesT = coordinates.t();
+  arma::vec sparseConstraints, denseConstraints;
+  AllConstraintValues(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints);
+  GradientImpl(function, coordinates, sparseConstraints, denseConstraints,
+      lambda, sigma, gradient);
+  return EvaluateImpl(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints, lambda, sigma);
+}
+
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  const arma::mat coordinatesT = coordinates.t();
+  arma::vec sparseConstraints, denseConstraints;
+  AllConstraintValues(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints);
+  GradientImpl(function, coordinates, sparseConstraints, denseConstraints,
+      lambda, sigma, gradient);
+  return EvaluateImpl(function, coordinates, coordinatesT, sparseConstraints,
+      denseConstraints, lambda, sigma);
 }
 
 } // namespace optimization
@@ -135,17 +135,127 @@ Alpha(const arma::mat& A, const arma::mat& dA, double tau)
  *
  *   AX + XA = H
  *
- * where A, H are symmetric matrices.
+ * where A, H are symmetric matrices, given the eigendecomposition
+ * A = Q diag(lambda) Q^T.  As in Lemma 7.2 of [AHO98], the solution is
  *
- * TODO(stephentu): Note this method current uses arma's builtin arma::syl
- * method, which is overkill for this situation. See Lemma 7.2 of [AHO98] for
- * how to solve this Lyapunov equation using an eigenvalue decomposition of A.
+ *   X = Q ((Q^T H Q) ./ (lambda_i + lambda_j)) Q^T
  *
+ * so the decomposition is computed once per iteration and shared by all the
+ * equations with the same A.
+ *
+ * @param X Solution of the equation.
+ * @param Q Eigenvectors of A.
+ * @param lambdaSums Matrix of the sums lambda_i + lambda_j.
+ * @param H Right hand side of the equation.
+ */
+static inline void
+SolveLyapunov(arma::mat& X,
+              const arma::mat& Q,
+              const arma::mat& lambdaSums,
+              const arma::mat& H)
+{
+  X = Q * ((Q.t() * H * Q) / lambdaSums) * Q.t();
+}
+
+/**
+ * Compute G, the solution of the Lyapunov equation
+ *
+ *   ZG + GZ = XA + AX
+ *
+ * for a sparse constraint matrix A, given the eigendecomposition
+ * Z = Q diag(lambda) Q^T and W = Q^T X Q.  The constraints of problems like
+ * MVU only touch a few rows of the matrix, so with S the rows of the non-zeros
+ * of A, the right hand side in the eigenbasis,
+ *
+ *   Q^T (XA + AX) Q = W P + P W,  P = Q_S^T A_SS Q_S,
+ *
+ * is computed from the n x |S| matrix W Q_S^T, and P is never formed.
+ */
+static inline void
+ConstraintLyapunov(arma::mat& G,
+                   const arma::sp_mat& A,
+                   const arma::mat& Q,
+                   const arma::mat& lambdaSums,
+                   const arma::mat& W)
+{
+  // Find the rows of the non-zeros, and the position of each of them in S.
+  std::vector<size_t> position(A.n_rows, A.n_rows);
+  std::vector<arma::uword> rows;
+  for (arma::sp_mat::const_iterator it = A.begin(); it != A.end(); ++it)
+  {
+    if (position[it.row()] == A.n_rows)
+    {
+      position[it.row()] = rows.size();
+      rows.push_back(it.row());
+    }
+  }
+
+  if (rows.empty())
+  {
+    G.zeros(A.n_rows, A.n_cols);
+    return;
+  }
+
+  // A is symmetric, so its non-zero columns are the same as its rows.
+  arma::mat as(rows.size(), rows.size(), arma::fill::zeros);
+  for (arma::sp_mat::const_iterator it = A.begin(); it != A.end(); ++it)
+    as(position[it.row()], position[it.col()]) = (*it);
+
+  const arma::uvec s(rows);
+  const arma::mat qs = Q.rows(s);
+  const arma::mat wp = (W * qs.t()) * (as * qs);
+  G = Q * ((wp + wp.t()) / lambdaSums) * Q.t();
+}
+
+/**
+ * Compute G, the solution of the Lyapunov equation
+ *
+ *   ZG + GZ = XA + AX
+ *
+ * for a dense constraint matrix A, given the eigendecomposition
+ * Z = Q diag(lambda) Q^T and W = Q^T X Q.
  */
 static inline void
-SolveLyapunov(arma::mat& X, const arma::mat& A, const arma::mat& H)
+ConstraintLyapunov(arma::mat& G,
+                   const arma::mat& A,
+                   const arma::mat& Q,
+                   const arma::mat& lambdaSums,
+                   const arma::mat& W)
 {
-  arma::syl(X, A, A, -H);
+  const arma::mat wp = W * (Q.t() * A * Q);
+  G = Q * ((wp + wp.t()) / lambdaSums) * Q.t();
+}
+
+/**
+ * Compute the columns svec(E^(-1) F A_i) of E^(-1) F A^T for the given
+ * constraints (see (2.16) of [AHO98]).  Each column is the solution of an
+ * independent Lyapunov equation, so they are computed in parallel.
+ */
+template <typename MatrixType>
+static inline void
+ConstraintColumns(const std::vector<MatrixType>& ais,
+                  const arma::mat& Q,
+                  const arma::mat& lambdaSums,
+                  const arma::mat& W,
+                  arma::mat& columns)
+{
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t i = 0; i < (intmax_t) ais.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < ais.size(); ++i)
+#endif
+  {
+    arma::mat Gk;
+    arma::vec gk;
+    ConstraintLyapunov(Gk, ais[i], Q, lambdaSums, W);
+    math::Svec(Gk, gk);
+    columns.col(i) = gk;
+  }
 }
 
 /**
@@ -164,11 +274,13 @@ SolveLyapunov(arma::mat& X, const arma::mat& A, const arma::mat& H)
  *     E  = Z sym I
  *     F  = X sym I
  *
+ * and Z = Q diag(lambda) Q^T; lambdaSums holds lambda_i + lambda_j.
  */
 static inline void
 SolveKKTSystem(const arma::sp_mat& Asparse,
                const arma::mat& Adense,
-               const arma::mat& Z,
+               const arma::mat& Q,
+               const arma::mat& lambdaSums,
                const arma::mat& M,
                const arma::mat& F,
                const arma::vec& rp,
@@ -184,11 +296,12 @@ SolveKKTSystem(const arma::sp_mat& Asparse,
   arma::vec Einv_Frd_rc, Einv_Frd_ATdy_rc, dy;
 
   // Note: Whenever a formula calls for E^(-1) v for some v, we solve Lyapunov
-  // equations instead of forming an explicit inverse.
+  // equations with the eigendecomposition of Z instead of forming an explicit
+  // inverse.
 
   // Compute the RHS of (2.12)
   math::Smat(F * rd - rc, Frd_rc_Mat);
-  SolveLyapunov(Einv_Frd_rc_Mat, Z, 2. * Frd_rc_Mat);
+  SolveLyapunov(Einv_Frd_rc_Mat, Q, lambdaSums, 2. * Frd_rc_Mat);
   math::Svec(Einv_Frd_rc_Mat, Einv_Frd_rc);
 
   arma::vec rhs = rp;
@@ -211,7 +324,7 @@ SolveKKTSystem(const arma::sp_mat& Asparse,
   // Compute dx from (2.13)
   math::Smat(F * (rd - Asparse.t() * dysparse - Adense.t() * dydense) - rc,
       Frd_ATdy_rc_Mat);
-  SolveLyapunov(Einv_Frd_ATdy_rc_Mat, Z, 2. * Frd_ATdy_rc_Mat);
+  SolveLyapunov(Einv_Frd_ATdy_rc_Mat, Q, lambdaSums, 2. * Frd_ATdy_rc_Mat);
   math::Svec(Einv_Frd_ATdy_rc_Mat, Einv_Frd_ATdy_rc);
   dsx = -Einv_Frd_ATdy_rc;
 
@@ -277,10 +390,11 @@ PrimalDualSolver<SDPType>::Optimize(arma::mat& X,
   math::Svec(X, sx);
   math::Svec(Z, sz);
 
-  arma::vec rp, rd, rc, gk;
+  arma::vec rp, rd, rc;
 
-  arma::mat Rc, F, Einv_F_AsparseT, Einv_F_AdenseT, Gk,
-            M, DualCheck;
+  arma::mat Rc, F, Einv_F_AsparseT, Einv_F_AdenseT, M, DualCheck, Q,
+            lambdaSums, W;
+  arma::vec lambda;
 
   rp.set_size(sdp.NumConstraints());
 
@@ -310,21 +424,18 @@ PrimalDualSolver<SDPType>::Optimize(arma::mat& X,
 
     math::SymKronId(X, F);
 
+    // All the Lyapunov equations of this iteration are of the form
+    // ZG + GZ = H, so they share the eigendecomposition of Z.
+    if (!arma::eig_sym(lambda, Q, Z))
+      Log::Fatal << "PrimalDualSolver::Optimize(): Could not compute the "
+          << "eigendecomposition of Z." << std::endl;
+    lambdaSums = arma::repmat(lambda, 1, n) + arma::repmat(lambda.t(), n, 1);
+    W = Q.t() * X * Q;
+
     // We compute E^(-1) F A^T by solving Lyapunov equations.
     // See (2.16).
-    for (size_t i = 0; i < sdp.NumSparseConstraints(); i++)
-    {
-      SolveLyapunov(Gk, Z, X * sdp.SparseA()[i] + sdp.SparseA()[i] * X);
-      math::Svec(Gk, gk);
-      Einv_F_AsparseT.col(i) = gk;
-    }
-
-    for (size_t i = 0; i < sdp.NumDenseConstraints(); i++)
-    {
-      SolveLyapunov(Gk, Z, X * sdp.DenseA()[i] + sdp.DenseA()[i] * X);
-      math::Svec(Gk, gk);
-      Einv_F_AdenseT.col(i) = gk;
-    }
+    ConstraintColumns(sdp.SparseA(), Q, lambdaSums, W, Einv_F_AsparseT);
+    ConstraintColumns(sdp.DenseA(), Q, lambdaSums, W, Einv_F_AdenseT);
 
     // Form the M = A E^(-1) F A^T matrix (2.15)
     //
@@ -369,8 +480,8 @@ PrimalDualSolver<SDPType>::Optimize(arma::mat& X,
     // This solves step (1) of Section 7, the "predictor" step.
     Rc = -0.5*(X*Z + Z*X);
     math::Svec(Rc, rc);
-    SolveKKTSystem(Asparse, Adense, Z, M, F, rp, rd, rc, dsx, dysparse, dydense,
-        dsz);
+    SolveKKTSystem(Asparse, Adense, Q, lambdaSums, M, F, rp, rd, rc, dsx,
+        dysparse, dydense, dsz);
     math::Smat(dsx, dX);
     math::Smat(dsz, dZ);
 
@@ -386,8 +497,8 @@ PrimalDualSolver<SDPType>::Optimize(arma::mat& X,
     // Step (3), the "corrector" step.
     Rc = mu*arma::eye<arma::mat>(n, n) - 0.5*(X*Z + Z*X + dX*dZ + dZ*dX);
     math::Svec(Rc, rc);
-    SolveKKTSystem(Asparse, Adense, Z, M, F, rp, rd, rc, dsx, dysparse, dydense,
-        dsz);
+    SolveKKTSystem(Asparse, Adense, Q, lambdaSums, M, F, rp, rd, rc, dsx,
+        dysparse, dydense, dsz);
     math::Smat(dsx, dX);
     math::Smat(dsz, dZ);
     alpha = Alpha(X, dX, tau);
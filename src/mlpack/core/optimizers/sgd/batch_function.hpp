@@ -0,0 +1,269 @@
+/**
+ * @file batch_function.hpp
+ *
+ * Helper functions for stochastic optimizers that evaluate a decomposable
+ * function (or its gradient) on a contiguous block of separable functions.  If
+ * the function type provides batch overloads of Evaluate() and Gradient(),
+ * those are used; otherwise, the single-function overloads are called for each
+ * function in the block and the results are summed.
+ * EvaluateWithGradientBatch() computes both at the same coordinates, with one
+ * pass over the block if the function provides an EvaluateWithGradient()
+ * overload for it.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SGD_BATCH_FUNCTION_HPP
+#define MLPACK_CORE_OPTIMIZERS_SGD_BATCH_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(Evaluate, HasBatchEvaluateCheck);
+HAS_MEM_FUNC(Gradient, HasBatchGradientCheck);
+HAS_MEM_FUNC(EvaluateWithGradient, HasBatchEvaluateWithGradientCheck);
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double Evaluate(const MatType& coordinates, const size_t begin,
+ *     const size_t batchSize) (const or not).
+ */
+template<typename FunctionType, typename MatType = arma::mat>
+struct HasBatchEvaluate
+{
+  static const bool value =
+    HasBatchEvaluateCheck<FunctionType,
+        double(FunctionType::*)(const MatType&,
+                                const size_t,
+                                const size_t)>::value ||
+    HasBatchEvaluateCheck<FunctionType,
+        double(FunctionType::*)(const MatType&,
+                                const size_t,
+                                const size_t) const>::value;
+};
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * void Gradient(const MatType& coordinates, const size_t begin,
+ *     MatType& gradient, const size_t batchSize) (const or not).
+ */
+template<typename FunctionType, typename MatType = arma::mat>
+struct HasBatchGradient
+{
+  static const bool value =
+    HasBatchGradientCheck<FunctionType,
+        void(FunctionType::*)(const MatType&,
+                              const size_t,
+                              MatType&,
+                              const size_t)>::value ||
+    HasBatchGradientCheck<FunctionType,
+        void(FunctionType::*)(const MatType&,
+                              const size_t,
+                              MatType&,
+                              const size_t) const>::value;
+};
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double EvaluateWithGradient(const MatType& coordinates, const size_t begin,
+ *     MatType& gradient, const size_t batchSize) (const or not).
+ */
+template<typename FunctionType, typename MatType = arma::mat>
+struct HasBatchEvaluateWithGradient
+{
+  static const bool value =
+    HasBatchEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const MatType&,
+                                const size_t,
+                                MatType&,
+                                const size_t)>::value ||
+    HasBatchEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const MatType&,
+                                const size_t,
+                                MatType&,
+                                const size_t) const>::value;
+};
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double EvaluateWithGradient(const MatType& coordinates, const size_t i,
+ *     MatType& gradient) (const or not), for one separable function.
+ */
+template<typename FunctionType, typename MatType = arma::mat>
+struct HasSeparableEvaluateWithGradient
+{
+  static const bool value =
+    HasBatchEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const MatType&,
+                                const size_t,
+                                MatType&)>::value ||
+    HasBatchEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const MatType&,
+                                const size_t,
+                                MatType&) const>::value;
+};
+
+/**
+ * Return the sum of the objectives of the separable functions in
+ * [begin, begin + batchSize), using the batch Evaluate() overload of the
+ * function.
+ */
+template<typename FunctionType, typename MatType>
+inline double EvaluateBatch(
+    FunctionType& function,
+    const MatType& coordinates,
+    const size_t begin,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        HasBatchEvaluate<FunctionType, MatType>::value>* = 0)
+{
+  return function.Evaluate(coordinates, begin, batchSize);
+}
+
+/**
+ * Return the sum of the objectives of the separable functions in
+ * [begin, begin + batchSize), by evaluating each function separately.
+ */
+template<typename FunctionType, typename MatType>
+inline double EvaluateBatch(
+    FunctionType& function,
+    const MatType& coordinates,
+    const size_t begin,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        !HasBatchEvaluate<FunctionType, MatType>::value>* = 0)
+{
+  double objective = 0;
+  for (size_t i = begin; i < begin + batchSize; ++i)
+    objective += function.Evaluate(coordinates, i);
+
+  return objective;
+}
+
+/**
+ * Store the sum of the gradients of the separable functions in
+ * [begin, begin + batchSize) in the given gradient matrix, using the batch
+ * Gradient() overload of the function.
+ */
+template<typename FunctionType, typename MatType>
+inline void GradientBatch(
+    FunctionType& function,
+    const MatType& coordinates,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        HasBatchGradient<FunctionType, MatType>::value>* = 0)
+{
+  function.Gradient(coordinates, begin, gradient, batchSize);
+}
+
+/**
+ * Store the sum of the gradients of the separable functions in
+ * [begin, begin + batchSize) in the given gradient matrix, by computing the
+ * gradient of each function separately.
+ */
+template<typename FunctionType, typename MatType>
+inline void GradientBatch(
+    FunctionType& function,
+    const MatType& coordinates,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        !HasBatchGradient<FunctionType, MatType>::value>* = 0)
+{
+  function.Gradient(coordinates, begin, gradient);
+
+  MatType funcGradient;
+  for (size_t i = begin + 1; i < begin + batchSize; ++i)
+  {
+    function.Gradient(coordinates, i, funcGradient);
+    gradient += funcGradient;
+  }
+}
+
+/**
+ * Return the sum of the objectives and store the sum of the gradients of the
+ * separable functions in [begin, begin + batchSize), using the batch
+ * EvaluateWithGradient() overload of the function.
+ */
+template<typename FunctionType, typename MatType>
+inline double EvaluateWithGradientBatch(
+    FunctionType& function,
+    const MatType& coordinates,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        HasBatchEvaluateWithGradient<FunctionType, MatType>::value>* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, begin, gradient,
+      batchSize);
+}
+
+/**
+ * Return the sum of the objectives and store the sum of the gradients of the
+ * separable functions in [begin, begin + batchSize), with the single-function
+ * EvaluateWithGradient() overload of the function, if there are no batch
+ * overloads of Evaluate() and Gradient() to use instead.
+ */
+template<typename FunctionType, typename MatType>
+inline double EvaluateWithGradientBatch(
+    FunctionType& function,
+    const MatType& coordinates,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        !HasBatchEvaluateWithGradient<FunctionType, MatType>::value &&
+        HasSeparableEvaluateWithGradient<FunctionType, MatType>::value &&
+        !(HasBatchEvaluate<FunctionType, MatType>::value &&
+          HasBatchGradient<FunctionType, MatType>::value)>* = 0)
+{
+  double objective = function.EvaluateWithGradient(coordinates, begin,
+      gradient);
+
+  MatType funcGradient;
+  for (size_t i = begin + 1; i < begin + batchSize; ++i)
+  {
+    objective += function.EvaluateWithGradient(coordinates, i, funcGradient);
+    gradient += funcGradient;
+  }
+
+  return objective;
+}
+
+/**
+ * Return the sum of the objectives and store the sum of the gradients of the
+ * separable functions in [begin, begin + batchSize), with EvaluateBatch() and
+ * GradientBatch().
+ */
+template<typename FunctionType, typename MatType>
+inline double EvaluateWithGradientBatch(
+    FunctionType& function,
+    const MatType& coordinates,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        !HasBatchEvaluateWithGradient<FunctionType, MatType>::value &&
+        !(HasSeparableEvaluateWithGradient<FunctionType, MatType>::value &&
+          !(HasBatchEvaluate<FunctionType, MatType>::value &&
+            HasBatchGradient<FunctionType, MatType>::value))>* = 0)
+{
+  const double objective = EvaluateBatch(function, coordinates, begin,
+      batchSize);
+  GradientBatch(function, coordinates, begin, gradient, batchSize);
+  return objective;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -17,6 +17,8 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
 #include <mlpack/core/optimizers/sgd/update_policies/momentum_update.hpp>
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+#include <mlpack/core/optimizers/sgd/sparse_function.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -68,6 +70,33 @@ namespace optimization {
  * objective function on the first point in the dataset (presumably, the dataset
  * is held internally in the DecomposableFunctionType).
  *
+ * If the class also implements
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               const size_t i,
+ *                               arma::mat& gradient);
+ *
+ * it is used to compute the objective and the gradient of each function in one
+ * pass (see EvaluateWithGradientBatch()).  The objective that is reported for
+ * a pass over the functions is the sum of the objectives of each function at
+ * the iterate before its step.
+ *
+ * If the function also implements
+ *
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::sp_mat& gradient);
+ *
+ * and the update policy has a sparse Update() overload (see
+ * HasSparseGradient and HasSparseUpdate), the gradients are computed as sparse
+ * matrices and each step only touches their non-zero entries.  This is the
+ * case for LogisticRegressionFunction on sparse data and for
+ * RegularizedSVDFunction, with the vanilla, AdaGrad and Adam updates.
+ *
+ * The iterate may also be an arma::fmat, in which case the function must
+ * implement Evaluate() and Gradient() for arma::fmat coordinates; the update
+ * policy then holds its state in single precision too.
+ *
  * @tparam DecomposableFunctionType Decomposable objective function type to be
  *     minimized.
  * @tparam UpdatePolicyType update policy used by SGD during the iterative update
@@ -109,21 +138,25 @@ class SGD
    * starting point will be modified to store the finishing point of the
    * algorithm, and the final objective value is returned.
    *
+   * @tparam MatType Type of the iterate (arma::mat or arma::fmat).
    * @param function Function to optimize.
    * @param iterate Starting point (will be modified).
    * @return Objective value of the final point.
    */
-  double Optimize(DecomposableFunctionType& function, arma::mat& iterate);
+  template<typename MatType>
+  double Optimize(DecomposableFunctionType& function, MatType& iterate);
 
   /**
    * Optimize the given function using stochastic gradient descent.  The given
    * starting point will be modified to store the finishing point of the
    * algorithm, and the final objective value is returned.
    *
+   * @tparam MatType Type of the iterate (arma::mat or arma::fmat).
    * @param iterate Starting point (will be modified).
    * @return Objective value of the final point.
    */
-  double Optimize(arma::mat& iterate)
+  template<typename MatType>
+  double Optimize(MatType& iterate)
   {
     return Optimize(this->function, iterate);
   }
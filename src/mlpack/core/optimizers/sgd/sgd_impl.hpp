@@ -41,9 +41,10 @@ SGD<DecomposableFunctionType, UpdatePolicyType>::SGD(
 
 //! Optimize the function (minimize).
 template<typename DecomposableFunctionType, typename UpdatePolicyType>
+template<typename MatType>
 double SGD<DecomposableFunctionType, UpdatePolicyType>::Optimize(
     DecomposableFunctionType& function,
-    arma::mat& iterate)
+    MatType& iterate)
 {
   // Find the number of functions to use.
   const size_t numFunctions = function.NumFunctions();
@@ -62,19 +63,25 @@ double SGD<DecomposableFunctionType, UpdatePolicyType>::Optimize(
   double lastObjective = DBL_MAX;
 
   // Calculate the first objective function.
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
+  overallObjective = EvaluateBatch(function, iterate, 0, numFunctions);
 
-  // Initialize the update policy.
-  updatePolicy.Initialize(iterate.n_rows, iterate.n_cols);
+  // Initialize the update policy for the type of the iterate.
+  typename UpdatePolicyType::template Policy<MatType> policy(updatePolicy,
+      iterate.n_rows, iterate.n_cols);
 
   // Now iterate!
-  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  MatType gradient(iterate.n_rows, iterate.n_cols);
+  arma::sp_mat sparseGradient;
+  TraceSpan epochSpan("sgd_epoch");
   for (size_t i = 1; i != maxIterations; ++i, ++currentFunction)
   {
     // Is this iteration the start of a sequence?
     if ((currentFunction % numFunctions) == 0)
     {
+      // Each pass over the functions is a span of the trace.
+      if (i > 1)
+        epochSpan.Next();
+
       // Output current objective function.
       Log::Info << "SGD: iteration " << i << ", objective " << overallObjective
           << "." << std::endl;
@@ -102,35 +109,20 @@ double SGD<DecomposableFunctionType, UpdatePolicyType>::Optimize(
         visitationOrder = arma::shuffle(visitationOrder);
     }
 
-    // Evaluate the gradient for this iteration.
-    if (shuffle)
-      function.Gradient(iterate, visitationOrder[currentFunction], gradient);
-    else
-      function.Gradient(iterate, currentFunction, gradient);
-
-    // Use the update policy to take a step.
-    updatePolicy.Update(iterate, stepSize, gradient);
-
-    // Now add that to the overall objective function.
-    if (shuffle)
-    {
-      overallObjective += function.Evaluate(iterate,
-          visitationOrder[currentFunction]);
-    }
-    else
-    {
-      overallObjective += function.Evaluate(iterate, currentFunction);
-    }
+    // Evaluate the objective and the gradient for this iteration, use the
+    // update policy to take a step (with a sparse gradient, if possible), and
+    // add the objective to the overall objective function.
+    const size_t currentIndex = shuffle ? visitationOrder[currentFunction] :
+        currentFunction;
+    overallObjective += GradientStep(function, policy, iterate, currentIndex,
+        stepSize, gradient, sparseGradient);
   }
 
   Log::Info << "SGD: maximum iterations (" << maxIterations << ") reached; "
       << "terminating optimization." << std::endl;
 
   // Calculate final objective.
-  overallObjective = 0;
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
-  return overallObjective;
+  return EvaluateBatch(function, iterate, 0, numFunctions);
 }
 
 } // namespace optimization
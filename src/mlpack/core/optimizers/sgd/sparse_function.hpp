@@ -0,0 +1,147 @@
+/**
+ * @file sparse_function.hpp
+ *
+ * Helpers for stochastic optimizers that use sparse gradients.  If a
+ * decomposable function can compute the gradient of one separable function as
+ * an arma::sp_mat, and the update policy can take a step with a sparse
+ * gradient, each step of SGD only touches the non-zero entries of the gradient,
+ * so it costs O(nnz) instead of O(d) for d parameters; otherwise, the dense
+ * Gradient() and Update() are used.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SGD_SPARSE_FUNCTION_HPP
+#define MLPACK_CORE_OPTIMIZERS_SGD_SPARSE_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(Gradient, HasSparseGradientCheck);
+HAS_MEM_FUNC(Update, HasSparseUpdateCheck);
+HAS_MEM_FUNC(UseSparseGradient, HasUseSparseGradientCheck);
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * void Gradient(const arma::mat& coordinates, const size_t i,
+ *     arma::sp_mat& gradient) (const or not), which gives the gradient of one
+ * separable function as a sparse matrix.
+ */
+template<typename FunctionType>
+struct HasSparseGradient
+{
+  static const bool value =
+    HasSparseGradientCheck<FunctionType,
+        void(FunctionType::*)(const arma::mat&,
+                              const size_t,
+                              arma::sp_mat&)>::value ||
+    HasSparseGradientCheck<FunctionType,
+        void(FunctionType::*)(const arma::mat&,
+                              const size_t,
+                              arma::sp_mat&) const>::value;
+};
+
+/**
+ * 'value' is true if the PolicyType class (the Policy class of an update
+ * policy) has a member
+ * void Update(MatType& iterate, const double stepSize,
+ *     const arma::sp_mat& gradient).
+ */
+template<typename PolicyType, typename MatType = arma::mat>
+struct HasSparseUpdate
+{
+  static const bool value =
+    HasSparseUpdateCheck<PolicyType,
+        void(PolicyType::*)(MatType&,
+                            const double,
+                            const arma::sp_mat&)>::value;
+};
+
+/**
+ * Return whether the sparse gradient of the given function should be used; the
+ * function can decide at run time with a member bool UseSparseGradient() const
+ * (like FFN, whose gradient is only sparse if it has modules with a sparse
+ * gradient).  Otherwise, the sparse gradient is always used.
+ */
+template<typename FunctionType>
+inline typename std::enable_if_t<HasUseSparseGradientCheck<FunctionType,
+    bool(FunctionType::*)() const>::value, bool>
+UseSparseGradient(const FunctionType& function)
+{
+  return function.UseSparseGradient();
+}
+
+template<typename FunctionType>
+inline typename std::enable_if_t<!HasUseSparseGradientCheck<FunctionType,
+    bool(FunctionType::*)() const>::value, bool>
+UseSparseGradient(const FunctionType& /* function */)
+{
+  return true;
+}
+
+/**
+ * Compute the gradient of the separable function i as a sparse matrix, and
+ * take a step with it using the given policy, unless UseSparseGradient() is
+ * false for the function; then the dense gradient is used.  The objective of
+ * the function before the step is returned.
+ */
+template<typename FunctionType, typename PolicyType, typename MatType>
+inline double GradientStep(
+    FunctionType& function,
+    PolicyType& policy,
+    MatType& iterate,
+    const size_t i,
+    const double stepSize,
+    MatType& gradient,
+    arma::sp_mat& sparseGradient,
+    const typename std::enable_if_t<HasSparseGradient<FunctionType>::value &&
+        HasSparseUpdate<PolicyType, MatType>::value>* = 0)
+{
+  if (!UseSparseGradient(function))
+  {
+    const double objective = EvaluateWithGradientBatch(function, iterate, i,
+        gradient, 1);
+    policy.Update(iterate, stepSize, gradient);
+    return objective;
+  }
+
+  const double objective = function.Evaluate(iterate, i);
+  function.Gradient(iterate, i, sparseGradient);
+  policy.Update(iterate, stepSize, sparseGradient);
+  return objective;
+}
+
+/**
+ * Compute the gradient of the separable function i as a dense matrix, together
+ * with its objective if the function can (see EvaluateWithGradientBatch()),
+ * and take a step with it using the given policy.  The objective of the
+ * function before the step is returned.
+ */
+template<typename FunctionType, typename PolicyType, typename MatType>
+inline double GradientStep(
+    FunctionType& function,
+    PolicyType& policy,
+    MatType& iterate,
+    const size_t i,
+    const double stepSize,
+    MatType& gradient,
+    arma::sp_mat& /* sparseGradient */,
+    const typename std::enable_if_t<!(HasSparseGradient<FunctionType>::value &&
+        HasSparseUpdate<PolicyType, MatType>::value)>* = 0)
+{
+  const double objective = EvaluateWithGradientBatch(function, iterate, i,
+      gradient, 1);
+  policy.Update(iterate, stepSize, gradient);
+  return objective;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
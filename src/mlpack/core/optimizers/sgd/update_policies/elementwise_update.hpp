@@ -0,0 +1,58 @@
+/**
+ * @file elementwise_update.hpp
+ *
+ * A helper for the update policies whose step works on each parameter on its
+ * own: the step is written as a single loop over a range of the parameters,
+ * which reads the gradient and the state once and writes them once, and large
+ * parameter vectors are split into chunks that are updated in parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SGD_UPDATE_POLICIES_ELEMENTWISE_UPDATE_HPP
+#define MLPACK_CORE_OPTIMIZERS_SGD_UPDATE_POLICIES_ELEMENTWISE_UPDATE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/execution.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Call kernel(begin, end) on consecutive ranges [begin, end) that cover
+ * [0, n).  Vectors of up to 64k elements are a single range; larger ones are
+ * split into ranges of 16k elements, which are distributed over the threads
+ * with util::Execution::ParallelFor() (and run serially inside another
+ * parallel loop, such as the threads of ParallelSGD).
+ *
+ * The kernel should be a single loop over its range, marked with MLPACK_SIMD,
+ * so that every element is read and written once per step; the chain of
+ * Armadillo expressions it replaces makes a pass over memory per expression,
+ * which dominates the cost of the step for large models.
+ *
+ * @param n Number of elements to update.
+ * @param kernel Function that updates the elements of a range.
+ */
+template<typename KernelType>
+inline void ElementwiseUpdate(const size_t n, const KernelType& kernel)
+{
+  const size_t chunkSize = 16384;
+  if (n <= 4 * chunkSize)
+  {
+    kernel(0, n);
+    return;
+  }
+
+  const size_t chunks = (n + chunkSize - 1) / chunkSize;
+  util::Execution::ParallelFor(chunks, [&](const size_t c)
+  {
+    kernel(c * chunkSize, std::min(n, (c + 1) * chunkSize));
+  });
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
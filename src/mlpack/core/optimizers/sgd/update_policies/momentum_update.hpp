@@ -13,6 +13,7 @@
 #define MLPACK_CORE_OPTIMIZERS_SGD_MOMENTUM_UPDATE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/elementwise_update.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -73,43 +74,76 @@ class MomentumUpdate
   { /* Do nothing. */ };
 
   /**
-   * The Initialize method is called by SGD Optimizer method before the start of
-   * the iteration update process.  In the momentum update policy the velocity
-   * matrix is initialized to the zeros matrix with the same size as the
-   * gradient matrix (see mlpack::optimization::SGD::Optimizer )
+   * The Policy class holds the state of the update for an iterate of the given
+   * matrix type; SGD creates one before the start of the iteration update
+   * process.
    *
-   * @param rows Number of rows in the gradient matrix.
-   * @param cols Number of columns in the gradient matrix.
+   * @tparam MatType Type of the iterate and the gradient (arma::mat or
+   *     arma::fmat).
    */
-  void Initialize(const size_t rows,
-                  const size_t cols)
+  template<typename MatType>
+  class Policy
   {
-    // Initialize am empty velocity matrix.
-    velocity = arma::zeros<arma::mat>(rows, cols);
-  }
+   public:
+    /**
+     * Create the state of the momentum update.  The velocity matrix is
+     * initialized to the zeros matrix with the same size as the gradient
+     * matrix (see mlpack::optimization::SGD::Optimize()).
+     *
+     * @param parent Instantiated update policy.
+     * @param rows Number of rows in the gradient matrix.
+     * @param cols Number of columns in the gradient matrix.
+     */
+    Policy(MomentumUpdate& parent, const size_t rows, const size_t cols) :
+        parent(parent),
+        velocity(arma::zeros<MatType>(rows, cols))
+    { /* Do nothing. */ }
 
-  /**
-   * Update step for SGD.  The momentum term makes the convergence faster on the
-   * way as momentum term increases for dimensions pointing in the same and
-   * reduces updates for dimensions whose gradients change directions.
-   *
-   * @param iterate Parameters that minimize the function.
-   * @param stepSize Step size to be used for the given iteration.
-   * @param gradient The gradient matrix.
-   */
-  void Update(arma::mat& iterate,
-              const double stepSize,
-              const arma::mat& gradient)
-  {
-    velocity = momentum * velocity - stepSize * gradient;
-    iterate += velocity;
-  }
+    /**
+     * Update step for SGD.  The momentum term makes the convergence faster on
+     * the way as momentum term increases for dimensions pointing in the same
+     * and reduces updates for dimensions whose gradients change directions.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const MatType& gradient)
+    {
+      typedef typename MatType::elem_type ElemType;
+
+      // velocity = momentum * velocity - stepSize * gradient, and
+      // iterate += velocity, in one pass.
+      const ElemType momentum = parent.momentum;
+      const ElemType step = stepSize;
+      ElemType* iteratePtr = iterate.memptr();
+      ElemType* velocityPtr = velocity.memptr();
+      const ElemType* gradientPtr = gradient.memptr();
+      ElementwiseUpdate(iterate.n_elem, [&](const size_t begin,
+                                            const size_t end)
+      {
+        MLPACK_SIMD
+        for (size_t i = begin; i < end; ++i)
+        {
+          const ElemType v = momentum * velocityPtr[i] - step * gradientPtr[i];
+          velocityPtr[i] = v;
+          iteratePtr[i] += v;
+        }
+      });
+    }
+
+   private:
+    // The instantiated update policy.
+    MomentumUpdate& parent;
+    // The velocity matrix.
+    MatType velocity;
+  };
 
  private:
   // The momentum hyperparamter
   double momentum;
-  // The velocity matrix.
-  arma::mat velocity;
 };
 
 } // namespace optimization
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_OPTIMIZERS_SGD_EMPTY_UPDATE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/elementwise_update.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -32,31 +33,72 @@ class VanillaUpdate
 {
  public:
   /**
-   * The Initialize method is called by SGD Optimizer method before the start of
-   * the iteration update process.  The vanilla update doesn't initialize
-   * anything.
+   * The Policy class holds the state of the update for an iterate of the given
+   * matrix type; SGD creates one before the start of the iteration update
+   * process.  The vanilla update doesn't hold anything.
    *
-   * @param rows Number of rows in the gradient matrix.
-   * @param cols Number of columns in the gradient matrix.
+   * @tparam MatType Type of the iterate and the gradient (arma::mat or
+   *     arma::fmat).
    */
-  void Initialize(const size_t /* rows */, const size_t /* cols */)
-  { /* Do nothing. */ }
-
- /**
-  * Update step for SGD.  The function parameters are updated in the negative
-  * direction of the gradient.
-  *
-  * @param iterate Parameters that minimize the function.
-  * @param stepSize Step size to be used for the given iteration.
-  * @param gradient The gradient matrix.
-  */
-  void Update(arma::mat& iterate,
-              const double stepSize,
-              const arma::mat& gradient)
+  template<typename MatType>
+  class Policy
   {
-    // Perform the vanilla SGD update.
-    iterate -= stepSize * gradient;
-  }
+   public:
+    /**
+     * Create the state of the vanilla update.
+     *
+     * @param parent Instantiated update policy.
+     * @param rows Number of rows in the gradient matrix.
+     * @param cols Number of columns in the gradient matrix.
+     */
+    Policy(VanillaUpdate& /* parent */,
+           const size_t /* rows */,
+           const size_t /* cols */)
+    { /* Do nothing. */ }
+
+    /**
+     * Update step for SGD.  The function parameters are updated in the
+     * negative direction of the gradient.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const MatType& gradient)
+    {
+      typedef typename MatType::elem_type ElemType;
+
+      // Perform the vanilla SGD update.
+      const ElemType step = stepSize;
+      ElemType* iteratePtr = iterate.memptr();
+      const ElemType* gradientPtr = gradient.memptr();
+      ElementwiseUpdate(iterate.n_elem, [&](const size_t begin,
+                                            const size_t end)
+      {
+        MLPACK_SIMD
+        for (size_t i = begin; i < end; ++i)
+          iteratePtr[i] -= step * gradientPtr[i];
+      });
+    }
+
+    /**
+     * Update step for SGD with a sparse gradient; only the entries of the
+     * iterate where the gradient is non-zero are updated.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The sparse gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const arma::SpMat<typename MatType::elem_type>& gradient)
+    {
+      for (auto it = gradient.begin(); it != gradient.end(); ++it)
+        iterate(it.row(), it.col()) -= stepSize * (*it);
+    }
+  };
 };
 
 } // namespace optimization
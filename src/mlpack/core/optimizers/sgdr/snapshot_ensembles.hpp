@@ -14,6 +14,13 @@
 #ifndef MLPACK_CORE_OPTIMIZERS_SGDR_SNAPSHOT_ENSEMBLES_HPP
 #define MLPACK_CORE_OPTIMIZERS_SGDR_SNAPSHOT_ENSEMBLES_HPP
 
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/binary_matrix.hpp>
+
+#include <exception>
+#include <memory>
+#include <thread>
+
 namespace mlpack {
 namespace optimization {
 
@@ -23,6 +30,16 @@ namespace optimization {
  * emulated by increasing the step size while the old step size value of as an
  * initial parameter.
  *
+ * By default every snapshot is kept in memory (see Snapshots()).  For large
+ * models the snapshots can be kept elsewhere instead:
+ *
+ *  - If SnapshotPrefix() is set, each snapshot is written in the background to
+ *    the .mlbin file SnapshotPrefix() + index + ".mlbin" (see SnapshotFiles()),
+ *    so at most one snapshot is held in memory while it is written.  The files
+ *    can be memory-mapped with data::MappedMatrix; they are not removed.
+ *  - If RunningAverage() is set, only the average of the snapshots is kept in
+ *    memory (see Average()), like stochastic weight averaging.
+ *
  * For more information, please refer to:
  *
  * @code
@@ -68,7 +85,9 @@ class SnapshotEnsembles
     nextRestart(epochRestart),
     batchRestart(0),
     epochBatches(numFunctions / (double) batchSize),
-    epoch(0)
+    epoch(0),
+    runningAverage(false),
+    numSnapshots(0)
   {
     snapshotEpochs = 0;
     for (size_t i = 0, er = epochRestart, nr = nextRestart;
@@ -119,7 +138,7 @@ class SnapshotEnsembles
       // Create a new snapshot.
       if (epochRestart >= snapshotEpochs)
       {
-        snapshots.push_back(iterate);
+        AddSnapshot(iterate);
       }
 
       // Update the time for the next restart.
@@ -139,12 +158,109 @@ class SnapshotEnsembles
   //! Modify the restart fraction.
   double& EpochBatches() { return epochBatches; }
 
-  //! Get the snapshots.
+  //! Get the snapshots that are kept in memory.
   std::vector<arma::mat> Snapshots() const { return snapshots; }
-  //! Modify the snapshots.
+  //! Modify the snapshots that are kept in memory.
   std::vector<arma::mat>& Snapshots() { return snapshots; }
 
+  //! Get the prefix of the snapshot files (empty to keep the snapshots in
+  //! memory).
+  const std::string& SnapshotPrefix() const { return snapshotPrefix; }
+  //! Modify the prefix of the snapshot files (empty to keep the snapshots in
+  //! memory).
+  std::string& SnapshotPrefix() { return snapshotPrefix; }
+
+  //! Get whether only the running average of the snapshots is kept.
+  bool RunningAverage() const { return runningAverage; }
+  //! Modify whether only the running average of the snapshots is kept.
+  bool& RunningAverage() { return runningAverage; }
+
+  //! Get the files the snapshots were written to.
+  const std::vector<std::string>& SnapshotFiles() const
+  {
+    return snapshotFiles;
+  }
+
+  //! Get the average of the snapshots (if RunningAverage() is set).
+  const arma::mat& Average() const { return average; }
+
+  //! Get the number of snapshots taken, wherever they are kept.
+  size_t NumSnapshots() const { return numSnapshots; }
+
+  /**
+   * Wait until the last snapshot has been written to its file.  If writing a
+   * snapshot failed, the std::runtime_error is rethrown here.
+   */
+  void Wait()
+  {
+    if (writer && writer->joinable())
+      writer->join();
+    writer.reset();
+
+    if (writerError && *writerError)
+    {
+      const std::exception_ptr error = *writerError;
+      *writerError = std::exception_ptr();
+      std::rethrow_exception(error);
+    }
+  }
+
  private:
+  //! Store a snapshot of the given parameters where the options say.
+  void AddSnapshot(const arma::mat& iterate)
+  {
+    ++numSnapshots;
+    if (runningAverage)
+    {
+      if (numSnapshots == 1)
+        average = iterate;
+      else
+        average += (iterate - average) / (double) numSnapshots;
+    }
+    else if (!snapshotPrefix.empty())
+    {
+      // Only one write is in flight, so at most one copy of the parameters is
+      // held besides the iterate.
+      Wait();
+      writerError = std::make_shared<std::exception_ptr>();
+      snapshotFiles.push_back(snapshotPrefix +
+          std::to_string(snapshotFiles.size()) + ".mlbin");
+
+      std::shared_ptr<std::exception_ptr> error = writerError;
+      const std::string filename = snapshotFiles.back();
+      // The copies of the object share the pending write; the last one to go
+      // waits for it.
+      writer = std::shared_ptr<std::thread>(new std::thread(
+          [error, filename](const arma::mat snapshot)
+          {
+            try
+            {
+              std::ofstream stream(filename, std::ios::binary);
+              if (!stream.is_open())
+              {
+                throw std::runtime_error("SnapshotEnsembles: cannot open '" +
+                    filename + "' for writing");
+              }
+
+              data::SaveBinaryMatrix(stream, snapshot);
+            }
+            catch (...)
+            {
+              *error = std::current_exception();
+            }
+          }, iterate), [](std::thread* thread)
+          {
+            if (thread->joinable())
+              thread->join();
+            delete thread;
+          });
+    }
+    else
+    {
+      snapshots.push_back(iterate);
+    }
+  }
+
   //! Epoch where decay is applied.
   size_t epochRestart;
 
@@ -171,6 +287,27 @@ class SnapshotEnsembles
 
   //! Locally-stored parameter snapshots.
   std::vector<arma::mat> snapshots;
+
+  //! Prefix of the snapshot files (empty to keep the snapshots in memory).
+  std::string snapshotPrefix;
+
+  //! Whether only the running average of the snapshots is kept.
+  bool runningAverage;
+
+  //! The number of snapshots taken.
+  size_t numSnapshots;
+
+  //! The running average of the snapshots.
+  arma::mat average;
+
+  //! The files the snapshots were written to.
+  std::vector<std::string> snapshotFiles;
+
+  //! The thread writing the last snapshot (if any).
+  std::shared_ptr<std::thread> writer;
+
+  //! The error of the last write (if any).
+  std::shared_ptr<std::exception_ptr> writerError;
 };
 
 } // namespace optimization
@@ -159,6 +159,27 @@ class SnapshotSGDR
     return optimizer.DecayPolicy().Snapshots();
   }
 
+  //! Get the prefix of the snapshot files (empty to keep the snapshots in
+  //! memory); see SnapshotEnsembles.
+  const std::string& SnapshotPrefix() const
+  {
+    return optimizer.DecayPolicy().SnapshotPrefix();
+  }
+  //! Modify the prefix of the snapshot files (empty to keep the snapshots in
+  //! memory); see SnapshotEnsembles.
+  std::string& SnapshotPrefix()
+  {
+    return optimizer.DecayPolicy().SnapshotPrefix();
+  }
+
+  //! Get whether only the running average of the snapshots is kept.
+  bool RunningAverage() const
+  {
+    return optimizer.DecayPolicy().RunningAverage();
+  }
+  //! Modify whether only the running average of the snapshots is kept.
+  bool& RunningAverage() { return optimizer.DecayPolicy().RunningAverage(); }
+
  private:
   //! The instantiated function.
   DecomposableFunctionType& function;
@@ -76,13 +76,35 @@ double SnapshotSGDR<DecomposableFunctionType, UpdatePolicyType>::Optimize(
   double overallObjective = optimizer.Optimize(iterate);
 
   // Accumulate snapshots.
+  SnapshotEnsembles& snapshots = optimizer.DecayPolicy();
+  snapshots.Wait();
   if (accumulate)
   {
-    for (size_t i = 0; i < optimizer.DecayPolicy().Snapshots().size(); ++i)
+    size_t numSnapshots = 0;
+    if (snapshots.RunningAverage())
     {
-      iterate += optimizer.DecayPolicy().Snapshots()[i];
+      numSnapshots = snapshots.NumSnapshots();
+      if (numSnapshots > 0)
+        iterate += numSnapshots * snapshots.Average();
     }
-    iterate /= (optimizer.DecayPolicy().Snapshots().size() + 1);
+    else if (!snapshots.SnapshotPrefix().empty())
+    {
+      // Map one snapshot at a time, so only the pages being added are read.
+      numSnapshots = snapshots.SnapshotFiles().size();
+      data::MappedMatrix<double> snapshot;
+      for (size_t i = 0; i < numSnapshots; ++i)
+      {
+        snapshot.Map(snapshots.SnapshotFiles()[i]);
+        iterate += snapshot.Matrix();
+      }
+    }
+    else
+    {
+      numSnapshots = snapshots.Snapshots().size();
+      for (size_t i = 0; i < numSnapshots; ++i)
+        iterate += snapshots.Snapshots()[i];
+    }
+    iterate /= (numSnapshots + 1);
 
     // Calculate final objective.
     overallObjective = 0;
@@ -93,11 +93,13 @@ class SMORMS3
    * be modified to store the finishing point of the algorithm, and the final
    * objective value is returned.
    *
+   * @tparam MatType Type of the iterate (arma::mat or arma::fmat).
    * @param function Function to optimize.
    * @param iterate Starting point (will be modified).
    * @return Objective value of the final point.
    */
-  double Optimize(DecomposableFunctionType& function, arma::mat& iterate)
+  template<typename MatType>
+  double Optimize(DecomposableFunctionType& function, MatType& iterate)
   {
     return optimizer.Optimize(function, iterate);
   }
@@ -107,10 +109,12 @@ class SMORMS3
    * be modified to store the finishing point of the algorithm, and the final
    * objective value is returned.
    *
+   * @tparam MatType Type of the iterate (arma::mat or arma::fmat).
    * @param iterate Starting point (will be modified).
    * @return Objective value of the final point.
    */
-  double Optimize(arma::mat& iterate) { return optimizer.Optimize(iterate); }
+  template<typename MatType>
+  double Optimize(MatType& iterate) { return optimizer.Optimize(iterate); }
 
   //! Get the instantiated function to be optimized.
   const DecomposableFunctionType& Function() const
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_OPTIMIZERS_SMORMS3_SMORMS3_UPDATE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/elementwise_update.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -47,50 +48,79 @@ class SMORMS3Update
   { /* Do nothing. */ }
 
   /**
-   * The Initialize method is called by SGD::Optimize method with UpdatePolicy
-   * SMORMS3Update before the start of the iteration update process.
+   * The Policy class holds the state of the update for an iterate of the given
+   * matrix type; SGD creates one before the start of the iteration update
+   * process.
    *
-   * @param rows Number of rows in the gradient matrix.
-   * @param cols Number of columns in the gradient matrix.
+   * @tparam MatType Type of the iterate and the gradient (arma::mat or
+   *     arma::fmat).
    */
-  void Initialize(const size_t rows,
-                  const size_t cols)
+  template<typename MatType>
+  class Policy
   {
-    // Initialise the parameters mem, g and g2.
-    mem = arma::ones<arma::mat>(rows, cols);
-    g = arma::zeros<arma::mat>(rows, cols);
-    g2 = arma::zeros<arma::mat>(rows, cols);
-  }
-
-  /**
-   * Update step for SMORMS3.
-   *
-   * @param iterate Parameter that minimizes the function.
-   * @param stepSize Step size to be used for the given iteration.
-   * @param gradient The gradient matrix.
-   */
-  void Update(arma::mat& iterate,
-              const double stepSize,
-              const arma::mat& gradient)
-  {
-    // Update the iterate.
-    arma::mat r = 1 / (mem + 1);
-
-    g = (1 - r) % g;
-    g += r % gradient;
-
-    g2 = (1 - r) % g2;
-    g2 += r % (gradient % gradient);
-
-    arma::mat x = (g % g) / (g2 + epsilon);
-
-    x.transform( [stepSize](double &v) { return std::min(v, stepSize); } );
-
-    iterate -= gradient % x / (arma::sqrt(g2) + epsilon);
-
-    mem %= (1 - x);
-    mem += 1;
-  }
+   public:
+    /**
+     * Create the state of the SMORMS3 update.
+     *
+     * @param parent Instantiated update policy.
+     * @param rows Number of rows in the gradient matrix.
+     * @param cols Number of columns in the gradient matrix.
+     */
+    Policy(SMORMS3Update& parent, const size_t rows, const size_t cols) :
+        parent(parent),
+        mem(arma::ones<MatType>(rows, cols)),
+        g(arma::zeros<MatType>(rows, cols)),
+        g2(arma::zeros<MatType>(rows, cols))
+    { /* Do nothing. */ }
+
+    /**
+     * Update step for SMORMS3.
+     *
+     * @param iterate Parameter that minimizes the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const MatType& gradient)
+    {
+      typedef typename MatType::elem_type ElemType;
+
+      // Update the memory, the moments and the iterate in one pass.
+      const ElemType maxStep = stepSize;
+      const ElemType epsilon = parent.epsilon;
+      ElemType* iteratePtr = iterate.memptr();
+      ElemType* memPtr = mem.memptr();
+      ElemType* gPtr = g.memptr();
+      ElemType* g2Ptr = g2.memptr();
+      const ElemType* gradientPtr = gradient.memptr();
+      ElementwiseUpdate(iterate.n_elem, [&](const size_t begin,
+                                            const size_t end)
+      {
+        MLPACK_SIMD
+        for (size_t i = begin; i < end; ++i)
+        {
+          const ElemType grad = gradientPtr[i];
+          const ElemType r = 1 / (memPtr[i] + 1);
+          const ElemType gi = (1 - r) * gPtr[i] + r * grad;
+          const ElemType g2i = (1 - r) * g2Ptr[i] + r * grad * grad;
+          gPtr[i] = gi;
+          g2Ptr[i] = g2i;
+
+          const ElemType x = std::min(gi * gi / (g2i + epsilon), maxStep);
+          iteratePtr[i] -= grad * x / (std::sqrt(g2i) + epsilon);
+          memPtr[i] = memPtr[i] * (1 - x) + 1;
+        }
+      });
+    }
+
+   private:
+    // The instantiated update policy.
+    SMORMS3Update& parent;
+
+    // The parameters mem, g and g2.
+    MatType mem, g, g2;
+  };
 
   //! Get the value used to initialise the mean squared gradient parameter.
   double Epsilon() const { return epsilon; }
@@ -100,9 +130,6 @@ class SMORMS3Update
  private:
   //! The value used to initialise the mean squared gradient parameter.
   double epsilon;
-
-  // The parameters mem, g and g2.
-  arma::mat mem, g, g2;
 };
 
 } // namespace optimization
@@ -0,0 +1,119 @@
+/**
+ * @file full_gradient.hpp
+ *
+ * Helper functions for the variance-reduced optimizers, which evaluate a
+ * decomposable function (and its gradient) on all of its separable functions
+ * in parallel.  The functions are split into one contiguous block per OpenMP
+ * thread, each block is evaluated with EvaluateBatch() or
+ * EvaluateWithGradientBatch(), and the results are summed in block order, so
+ * they only depend on the number of threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SVRG_FULL_GRADIENT_HPP
+#define MLPACK_CORE_OPTIMIZERS_SVRG_FULL_GRADIENT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Return the sum of the objectives of all the separable functions.  The
+ * function is shared by the threads, so its Evaluate() overloads must be safe
+ * to call concurrently.
+ */
+template<typename FunctionType>
+inline double FullEvaluate(FunctionType& function,
+                           const arma::mat& coordinates)
+{
+  const size_t numFunctions = function.NumFunctions();
+#ifdef HAS_OPENMP
+  const size_t numBlocks = std::max(std::min((size_t) omp_get_max_threads(),
+      numFunctions), (size_t) 1);
+#else
+  const size_t numBlocks = 1;
+#endif
+  arma::vec blockObjectives(numBlocks, arma::fill::zeros);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * numFunctions / numBlocks;
+    const size_t end = (b + 1) * numFunctions / numBlocks;
+    if (end > begin)
+    {
+      blockObjectives[b] = EvaluateBatch(function, coordinates, begin,
+          end - begin);
+    }
+  }
+
+  return arma::accu(blockObjectives);
+}
+
+/**
+ * Return the sum of the objectives and store the sum of the gradients of all
+ * the separable functions in the given gradient matrix.  The function is
+ * shared by the threads, so its Evaluate() and Gradient() overloads must be
+ * safe to call concurrently.
+ */
+template<typename FunctionType>
+inline double FullEvaluateWithGradient(FunctionType& function,
+                                       const arma::mat& coordinates,
+                                       arma::mat& gradient)
+{
+  const size_t numFunctions = function.NumFunctions();
+#ifdef HAS_OPENMP
+  const size_t numBlocks = std::max(std::min((size_t) omp_get_max_threads(),
+      numFunctions), (size_t) 1);
+#else
+  const size_t numBlocks = 1;
+#endif
+  arma::vec blockObjectives(numBlocks, arma::fill::zeros);
+  std::vector<arma::mat> blockGradients(numBlocks);
+
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * numFunctions / numBlocks;
+    const size_t end = (b + 1) * numFunctions / numBlocks;
+    if (end > begin)
+    {
+      blockObjectives[b] = EvaluateWithGradientBatch(function, coordinates,
+          begin, blockGradients[b], end - begin);
+    }
+  }
+
+  gradient.zeros(coordinates.n_rows, coordinates.n_cols);
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    // A block may be empty, if there are fewer functions than threads.
+    if (blockGradients[b].n_elem == 0)
+      continue;
+
+    gradient += blockGradients[b];
+  }
+
+  return arma::accu(blockObjectives);
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
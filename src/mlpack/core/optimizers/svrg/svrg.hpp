@@ -0,0 +1,194 @@
+/**
+ * @file svrg.hpp
+ *
+ * Stochastic variance reduced gradient (SVRG).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SVRG_SVRG_HPP
+#define MLPACK_CORE_OPTIMIZERS_SVRG_SVRG_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
+
+#include "full_gradient.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * SVRG minimizes a function that is a sum of n separable functions, like SGD,
+ * but corrects each stochastic gradient with a full gradient that is computed
+ * once per epoch.  At the start of each epoch the iterate is kept as a
+ * snapshot w~ and the full gradient mu = (1 / n) sum_i grad f_i(w~) is
+ * computed; then each step on a mini-batch B takes
+ *
+ * \f[
+ * w \leftarrow w - \eta \left( \frac{1}{|B|} \sum_{i \in B}
+ *     (\nabla f_i(w) - \nabla f_i(\tilde{w})) + \mu \right).
+ * \f]
+ *
+ * The variance of these steps vanishes as the iterate approaches the optimum,
+ * so a constant step size can be used, and the objective converges linearly
+ * when it is strongly convex (for instance, for LogisticRegressionFunction with
+ * L2 regularization); plain SGD needs a decaying step size and converges
+ * sublinearly.  Each step evaluates two mini-batch gradients, and the full
+ * gradient (together with the objective, which is used for the termination
+ * check) is computed in parallel with OpenMP, one block of functions per
+ * thread.
+ *
+ * The DecomposableFunctionType must implement the functions needed by SGD:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * and, optionally, batch versions of Evaluate(), Gradient() and
+ * EvaluateWithGradient() (see HasBatchEvaluate, HasBatchGradient and
+ * HasBatchEvaluateWithGradient).  All the threads share the function, so these
+ * must be safe to call concurrently (const functions usually are).  The
+ * gradients are taken at two different points in each step, so functions that
+ * are evaluated at their own parameters (see HasFunctionParameters), like FFN,
+ * are not supported.
+ *
+ * For more information, see the following paper.
+ *
+ * @code
+ * @inproceedings{Johnson2013,
+ *   author = {Johnson, Rie and Zhang, Tong},
+ *   title = {Accelerating Stochastic Gradient Descent using Predictive
+ *       Variance Reduction},
+ *   booktitle = {Advances in Neural Information Processing Systems 26},
+ *   pages = {315--323},
+ *   year = {2013}
+ * }
+ * @endcode
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class SVRG
+{
+  static_assert(!HasFunctionParameters<DecomposableFunctionType>::value,
+      "SVRG does not support functions that are evaluated at their own "
+      "parameters");
+
+ public:
+  /**
+   * Construct the SVRG optimizer with the given function and parameters.  One
+   * iteration is one epoch: a full gradient computation followed by
+   * innerIterations mini-batch steps.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each mini-batch step.
+   * @param batchSize Number of functions in each mini-batch.
+   * @param maxIterations Maximum number of epochs allowed (0 means no limit).
+   * @param innerIterations Number of mini-batch steps in each epoch (0 means
+   *     one pass over the functions, NumFunctions() / batchSize steps).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the mini-batches are visited in a random order;
+   *     otherwise, they are visited in linear order.
+   */
+  SVRG(DecomposableFunctionType& function,
+       const double stepSize = 0.01,
+       const size_t batchSize = 1,
+       const size_t maxIterations = 100,
+       const size_t innerIterations = 0,
+       const double tolerance = 1e-5,
+       const bool shuffle = true);
+
+  /**
+   * Optimize the given function using SVRG.  The given starting point will be
+   * modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param function Function to optimize.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(DecomposableFunctionType& function, arma::mat& iterate);
+
+  /**
+   * Optimize the given function using SVRG.  The given starting point will be
+   * modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate)
+  {
+    return Optimize(this->function, iterate);
+  }
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the maximum number of epochs (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of epochs (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the number of steps in each epoch (0 indicates one pass).
+  size_t InnerIterations() const { return innerIterations; }
+  //! Modify the number of steps in each epoch (0 indicates one pass).
+  size_t& InnerIterations() { return innerIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the mini-batches are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the mini-batches are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+ private:
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The step size for each mini-batch step.
+  double stepSize;
+
+  //! The number of functions in each mini-batch.
+  size_t batchSize;
+
+  //! The maximum number of epochs.
+  size_t maxIterations;
+
+  //! The number of mini-batch steps in each epoch.
+  size_t innerIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the mini-batches are shuffled.
+  bool shuffle;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "svrg_impl.hpp"
+
+#endif
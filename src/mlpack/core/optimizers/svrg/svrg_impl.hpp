@@ -0,0 +1,118 @@
+/**
+ * @file svrg_impl.hpp
+ *
+ * Implementation of stochastic variance reduced gradient (SVRG).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SVRG_SVRG_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_SVRG_SVRG_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "svrg.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType>
+SVRG<DecomposableFunctionType>::SVRG(DecomposableFunctionType& function,
+                                     const double stepSize,
+                                     const size_t batchSize,
+                                     const size_t maxIterations,
+                                     const size_t innerIterations,
+                                     const double tolerance,
+                                     const bool shuffle) :
+    function(function),
+    stepSize(stepSize),
+    batchSize(batchSize),
+    maxIterations(maxIterations),
+    innerIterations(innerIterations),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType>
+double SVRG<DecomposableFunctionType>::Optimize(
+    DecomposableFunctionType& function,
+    arma::mat& iterate)
+{
+  if (batchSize == 0)
+    throw std::invalid_argument("SVRG::Optimize(): batchSize must be positive");
+
+  // Find the number of functions and of mini-batches.
+  const size_t numFunctions = function.NumFunctions();
+  size_t numBatches = numFunctions / batchSize;
+  if (numFunctions % batchSize != 0)
+    ++numBatches; // Capture last few.
+  const size_t steps = (innerIterations == 0) ? numBatches : innerIterations;
+
+  // Batch visitation order.
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (numBatches - 1), numBatches);
+
+  double lastObjective = DBL_MAX;
+  arma::mat snapshot, fullGradient;
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  arma::mat snapshotGradient(iterate.n_rows, iterate.n_cols);
+  for (size_t i = 0; i != maxIterations; ++i)
+  {
+    // Take the snapshot; the objective at the snapshot comes with its full
+    // gradient.
+    snapshot = iterate;
+    const double objective = FullEvaluateWithGradient(function, snapshot,
+        fullGradient);
+    fullGradient /= numFunctions;
+
+    Log::Info << "SVRG: iteration " << i << ", objective " << objective << "."
+        << std::endl;
+
+    if (std::isnan(objective) || std::isinf(objective))
+    {
+      Log::Warn << "SVRG: converged to " << objective << "; terminating with "
+          << "failure.  Try a smaller step size?" << std::endl;
+      return objective;
+    }
+
+    if (std::abs(lastObjective - objective) < tolerance)
+    {
+      Log::Info << "SVRG: minimized within tolerance " << tolerance << "; "
+          << "terminating optimization." << std::endl;
+      return objective;
+    }
+
+    lastObjective = objective;
+
+    if (shuffle)
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    for (size_t j = 0; j < steps; ++j)
+    {
+      // The last batch may not be full-size.
+      const size_t offset = batchSize * visitationOrder[j % numBatches];
+      const size_t effectiveBatchSize = std::min(batchSize,
+          numFunctions - offset);
+
+      GradientBatch(function, iterate, offset, gradient, effectiveBatchSize);
+      GradientBatch(function, snapshot, offset, snapshotGradient,
+          effectiveBatchSize);
+
+      iterate -= stepSize * ((gradient - snapshotGradient) /
+          effectiveBatchSize + fullGradient);
+    }
+  }
+
+  Log::Info << "SVRG: maximum iterations (" << maxIterations << ") reached; "
+      << "terminating optimization." << std::endl;
+
+  // Calculate final objective.
+  return FullEvaluate(function, iterate);
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
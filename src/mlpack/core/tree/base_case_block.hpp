@@ -0,0 +1,107 @@
+/**
+ * @file base_case_block.hpp
+ *
+ * Support for rules that can evaluate the base cases between a set of query
+ * points and a leaf of reference points all at once.  A traverser calls
+ *
+ * @code
+ * void BaseCaseBlock(const std::vector<size_t>& queryIndices,
+ *                    const size_t referenceBegin,
+ *                    const size_t referenceCount);
+ * @endcode
+ *
+ * instead of calling BaseCase() once for each pair of points, if the rules
+ * provide it; this gives the rules a chance to compute the distances with a
+ * single matrix multiplication (see BlockSquaredDistances()).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BASE_CASE_BLOCK_HPP
+#define MLPACK_CORE_TREE_BASE_CASE_BLOCK_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace tree {
+
+HAS_MEM_FUNC(BaseCaseBlock, HasBaseCaseBlockCheck);
+
+/**
+ * 'value' is true if the RuleType class has a member
+ * void BaseCaseBlock(const std::vector<size_t>& queryIndices,
+ *     const size_t referenceBegin, const size_t referenceCount).
+ */
+template<typename RuleType>
+struct HasBaseCaseBlock
+{
+  static const bool value =
+    HasBaseCaseBlockCheck<RuleType,
+        void(RuleType::*)(const std::vector<size_t>&,
+                          const size_t,
+                          const size_t)>::value;
+};
+
+/**
+ * The smallest dimensionality for which BlockSquaredDistances() is worth using;
+ * below this, the cost of the norms and the matrix multiplication is not
+ * recovered.
+ */
+static const size_t blockDistanceMinDimensionality = 16;
+
+/**
+ * Compute the squared Euclidean distances between the given query points and
+ * the reference points in [referenceBegin, referenceBegin + referenceCount) as
+ * ||q||^2 + ||r||^2 - 2 r^T q, so that most of the work is done by one matrix
+ * multiplication.  These distances are not exact: because of cancellation,
+ * squaredDistances(i, j) may be off by as much as maxErrors(i, j), so they
+ * should only be used to decide which pairs of points can be skipped, and the
+ * distance of the remaining pairs should be computed exactly.
+ *
+ * @param querySet Set of query points.
+ * @param queryIndices Indices of the query points to use.
+ * @param referenceSet Set of reference points.
+ * @param referenceBegin Index of the first reference point to use.
+ * @param referenceCount Number of reference points to use.
+ * @param squaredDistances Matrix to store the distances in; entry (i, j) is
+ *     the distance between reference point i and query point j.
+ * @param maxErrors Matrix to store the maximum error of each distance in.
+ */
+inline void BlockSquaredDistances(const arma::mat& querySet,
+                                  const std::vector<size_t>& queryIndices,
+                                  const arma::mat& referenceSet,
+                                  const size_t referenceBegin,
+                                  const size_t referenceCount,
+                                  arma::mat& squaredDistances,
+                                  arma::mat& maxErrors)
+{
+  arma::uvec indices(queryIndices.size());
+  for (size_t i = 0; i < queryIndices.size(); ++i)
+    indices[i] = queryIndices[i];
+
+  const arma::mat queries = querySet.cols(indices);
+  const arma::mat references = referenceSet.cols(referenceBegin,
+      referenceBegin + referenceCount - 1);
+
+  const arma::rowvec queryNorms = arma::sum(arma::square(queries), 0);
+  const arma::vec referenceNorms =
+      arma::trans(arma::sum(arma::square(references), 0));
+
+  squaredDistances = -2.0 * arma::trans(references) * queries;
+  squaredDistances.each_col() += referenceNorms;
+  squaredDistances.each_row() += queryNorms;
+
+  // The rounding error of each term is a small multiple of the machine epsilon
+  // (times the dimensionality) relative to the norms; this bound is much
+  // looser than that, so it is safe even for very high-dimensional data.
+  maxErrors = 1e-8 * (arma::repmat(referenceNorms, 1, queryIndices.size()) +
+      arma::repmat(queryNorms, referenceCount, 1));
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
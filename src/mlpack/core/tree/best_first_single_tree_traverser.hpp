@@ -0,0 +1,140 @@
+/**
+ * @file best_first_single_tree_traverser.hpp
+ *
+ * A single-tree traverser that visits the reference nodes in order of their
+ * score, and can stop after a given number of leaves or a given time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/tree_traits.hpp>
+
+#include <chrono>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * BestFirstSingleTreeTraverser keeps the unvisited reference nodes of a query
+ * in a priority queue, and always visits the one with the best (lowest) score
+ * next, so the most promising leaves are searched first.  The traversal of a
+ * query can be given a budget: it stops after a number of leaves or after some
+ * time, and the results found so far are then the best available for that
+ * budget.  Without a budget, the traversal is exact (up to the approximation of
+ * the rules).
+ *
+ * This works with any tree type.  For trees whose first point is the centroid,
+ * like the cover tree, the base cases are computed by the rules while scoring,
+ * so they are not computed again for the leaves.  For trees that may hold a
+ * point in several leaves, like spill trees, each point is only evaluated once
+ * for each query point.
+ *
+ * @tparam TreeType The type of the reference tree.
+ * @tparam RuleType The rules, which must implement BaseCase(), Score(),
+ *     Rescore() and BaseCases().
+ */
+template<typename TreeType, typename RuleType>
+class BestFirstSingleTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the best-first single tree traverser with the given rule set
+   * and budget.
+   *
+   * @param rule The rules to traverse the tree with.
+   * @param maxLeaves Maximum number of leaves to visit for each query point (0
+   *     means no limit).
+   * @param timeLimit Maximum time, in seconds, to spend on each query point (0
+   *     means no limit).  The time is checked after each leaf, so at least one
+   *     leaf is always visited.
+   * @param minBaseCases The traversal of a query point is not stopped before
+   *     this many base cases have been computed for it, as counted by the
+   *     BaseCases() method of the rules; for k-nearest-neighbor search, k
+   *     makes sure that k neighbors are always found.
+   */
+  BestFirstSingleTreeTraverser(RuleType& rule,
+                               const size_t maxLeaves = 0,
+                               const double timeLimit = 0.0,
+                               const size_t minBaseCases = 0);
+
+  /**
+   * Traverse the tree with the given point.
+   *
+   * @param queryIndex The index of the point in the query set which is being
+   *     used as the query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryIndex, TreeType& referenceNode);
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+
+  //! Get the number of query points whose traversal was stopped by the budget.
+  size_t NumStopped() const { return numStopped; }
+
+  //! Get the maximum number of leaves visited for each query point.
+  size_t MaxLeaves() const { return maxLeaves; }
+  //! Modify the maximum number of leaves visited for each query point.
+  size_t& MaxLeaves() { return maxLeaves; }
+
+  //! Get the maximum time spent on each query point, in seconds.
+  double TimeLimit() const { return timeLimit; }
+  //! Modify the maximum time spent on each query point, in seconds.
+  double& TimeLimit() { return timeLimit; }
+
+ private:
+  //! A node that is waiting to be visited, with its score.
+  typedef std::pair<double, TreeType*> QueueEntry;
+
+  //! Order the entries of the queue so that the best score is on top.
+  struct QueueEntryCmp
+  {
+    bool operator()(const QueueEntry& a, const QueueEntry& b) const
+    {
+      return a.first > b.first;
+    };
+  };
+
+  //! Reference to the rules with which the tree will be traversed.
+  RuleType& rule;
+
+  //! The maximum number of leaves visited for each query point.
+  size_t maxLeaves;
+  //! The maximum time spent on each query point, in seconds.
+  double timeLimit;
+  //! The number of base cases computed before the budget can stop a query.
+  size_t minBaseCases;
+
+  //! The nodes waiting to be visited, as a heap; the storage is kept between
+  //! query points.
+  std::vector<QueueEntry> queue;
+
+  //! Whether the same point may be found in several nodes.
+  static const bool CheckDuplicates =
+      TreeTraits<TreeType>::HasDuplicatedPoints &&
+      !TreeTraits<TreeType>::FirstPointIsCentroid;
+  //! The number of calls to Traverse() so far.
+  size_t traversals;
+  //! For each reference point, the last call to Traverse() that evaluated it
+  //! (only used if CheckDuplicates is true).
+  std::vector<size_t> lastTraversal;
+
+  //! The number of nodes which have been pruned during traversal.
+  size_t numPrunes;
+  //! The number of query points whose traversal was stopped by the budget.
+  size_t numStopped;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "best_first_single_tree_traverser_impl.hpp"
+
+#endif
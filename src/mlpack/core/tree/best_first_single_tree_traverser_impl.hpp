@@ -0,0 +1,129 @@
+/**
+ * @file best_first_single_tree_traverser_impl.hpp
+ *
+ * Implementation of the best-first single tree traverser.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "best_first_single_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType, typename RuleType>
+BestFirstSingleTreeTraverser<TreeType, RuleType>::BestFirstSingleTreeTraverser(
+    RuleType& rule,
+    const size_t maxLeaves,
+    const double timeLimit,
+    const size_t minBaseCases) :
+    rule(rule),
+    maxLeaves(maxLeaves),
+    timeLimit(timeLimit),
+    minBaseCases(minBaseCases),
+    traversals(0),
+    numPrunes(0),
+    numStopped(0)
+{ /* Nothing to do. */ }
+
+template<typename TreeType, typename RuleType>
+void BestFirstSingleTreeTraverser<TreeType, RuleType>::Traverse(
+    const size_t queryIndex,
+    TreeType& referenceNode)
+{
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point start = (timeLimit > 0.0) ? Clock::now() :
+      Clock::time_point();
+  const size_t startBaseCases = rule.BaseCases();
+
+  ++traversals;
+  if (CheckDuplicates && lastTraversal.size() < referenceNode.Dataset().n_cols)
+    lastTraversal.resize(referenceNode.Dataset().n_cols, 0);
+
+  const double rootScore = rule.Score(queryIndex, referenceNode);
+  if (rootScore == DBL_MAX)
+  {
+    ++numPrunes;
+    return;
+  }
+
+  queue.clear();
+  queue.push_back(QueueEntry(rootScore, &referenceNode));
+
+  size_t leaves = 0;
+  while (!queue.empty())
+  {
+    std::pop_heap(queue.begin(), queue.end(), QueueEntryCmp());
+    const QueueEntry entry = queue.back();
+    queue.pop_back();
+    TreeType& node = *entry.second;
+
+    // The bound of the rules may have improved since the node was scored.
+    if (rule.Rescore(queryIndex, node, entry.first) == DBL_MAX)
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    // The rules have already computed the base case with the centroid while
+    // scoring the node.
+    if (!TreeTraits<TreeType>::FirstPointIsCentroid)
+    {
+      for (size_t i = 0; i < node.NumPoints(); ++i)
+      {
+        const size_t point = node.Point(i);
+        if (CheckDuplicates)
+        {
+          if (lastTraversal[point] == traversals)
+            continue;
+          lastTraversal[point] = traversals;
+        }
+
+        rule.BaseCase(queryIndex, point);
+      }
+    }
+
+    if (node.IsLeaf())
+    {
+      ++leaves;
+      if (queue.empty() || rule.BaseCases() - startBaseCases < minBaseCases)
+        continue;
+
+      const bool outOfLeaves = (maxLeaves > 0 && leaves >= maxLeaves);
+      const bool outOfTime = (timeLimit > 0.0 &&
+          std::chrono::duration<double>(Clock::now() - start).count() >=
+          timeLimit);
+      if (outOfLeaves || outOfTime)
+      {
+        ++numStopped;
+        break;
+      }
+
+      continue;
+    }
+
+    for (size_t i = 0; i < node.NumChildren(); ++i)
+    {
+      const double score = rule.Score(queryIndex, node.Child(i));
+      if (score == DBL_MAX)
+      {
+        ++numPrunes;
+        continue;
+      }
+
+      queue.push_back(QueueEntry(score, &node.Child(i)));
+      std::push_heap(queue.begin(), queue.end(), QueueEntryCmp());
+    }
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -19,6 +19,9 @@
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+template<typename BoundType, typename MatType>
+class UBTreeSplit;
+
 /**
  * A binary space partitioning tree, such as a KD-tree or a ball tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
@@ -88,6 +91,21 @@ class BinarySpaceTree
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
+  //! If the tree has been compacted with Compact(), the block of memory holding
+  //! all of the descendants of this node (NULL otherwise).
+  BinarySpaceTree* arena;
+  //! The number of nodes held in the arena.
+  size_t arenaSize;
+
+  //! Whether the children of large nodes may be built in parallel.  This is
+  //! not the case for UBTreeSplit, which keeps the addresses of the points in
+  //! the splitter, and for HollowBallBound, since the bound of the right child
+  //! depends on the bound of the left child.
+  static const bool ParallelBuild =
+      !std::is_same<Split,
+                    UBTreeSplit<BoundType<MetricType>, MatType>>::value &&
+      !std::is_same<BoundType<MetricType>,
+                    bound::HollowBallBound<MetricType>>::value;
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -310,6 +328,21 @@ class BinarySpaceTree
   //! Return the statistic object for this node.
   StatisticType& Stat() { return stat; }
 
+  /**
+   * Move all of the nodes of the tree into a single contiguous block of memory,
+   * laid out in depth-first pre-order, so that the left child of each node is
+   * stored directly after it.  The tree itself does not change, but the
+   * traversals touch much less scattered memory.  This must be called on the
+   * root of the tree, and it invalidates any pointers or references to nodes
+   * other than the root (including any held by tree statistics).  Copies of a
+   * compacted tree are not compacted, but trees loaded with
+   * boost::serialization always are.
+   */
+  void Compact();
+
+  //! Return whether or not the descendants of this node have been compacted.
+  bool IsCompact() const { return arena != NULL; }
+
   //! Return whether or not this node is a leaf (true if it has no children).
   bool IsLeaf() const;
 
@@ -531,6 +564,34 @@ class BinarySpaceTree
    */
   void UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate);
 
+  /**
+   * Update the bound of the current node. This method is designed for
+   * HRectBound only; the bounds of blocks of a large node are computed in
+   * parallel and then merged.
+   *
+   * @param boundToUpdate The bound to update.
+   */
+  void UpdateBound(bound::HRectBound<MetricType>& boundToUpdate);
+
+  /**
+   * Delete the children of this node (and all of their descendants), whether
+   * they were allocated individually or held in the arena of this node.
+   */
+  void DeleteChildren();
+
+  /**
+   * Append the descendants of this node to the given vector in depth-first
+   * pre-order, so that the left child of each node directly follows it.
+   */
+  void PreOrderDescendants(std::vector<BinarySpaceTree*>& order);
+
+  /**
+   * Serialize this node and, recursively, its children.  This is how trees
+   * were stored before version 1; it is only used to load old files.
+   */
+  template<typename Archive>
+  void SerializeNodes(Archive& ar);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -545,7 +606,9 @@ class BinarySpaceTree
 
  public:
   /**
-   * Serialize the tree.
+   * Serialize the tree.  The nodes are stored as flat arrays in depth-first
+   * pre-order, followed by their bounds and statistics, so that a loaded tree
+   * is allocated at once in the layout of Compact().
    */
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int version);
@@ -554,6 +617,43 @@ class BinarySpaceTree
 } // namespace tree
 } // namespace mlpack
 
+//! Set the serialization version of the BinarySpaceTree class, both for trees
+//! and pointers to trees.  This is what BOOST_TEMPLATE_CLASS_VERSION does, but
+//! that macro can't take a template with more than one parameter.
+namespace boost {
+namespace serialization {
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+struct version<mlpack::data::SecondShim<mlpack::tree::BinarySpaceTree<
+    MetricType, StatisticType, MatType, BoundType, SplitType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+struct version<mlpack::data::PointerShim<mlpack::tree::BinarySpaceTree<
+    MetricType, StatisticType, MatType, BoundType, SplitType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "binary_space_tree_impl.hpp"
 
@@ -15,8 +15,11 @@
 #include "binary_space_tree.hpp"
 
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/execution.hpp>
 #include <mlpack/core/util/log.hpp>
+#include <new>
 #include <queue>
+#include <unordered_map>
 
 namespace mlpack {
 namespace tree {
@@ -40,11 +43,24 @@ BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    arena(NULL),
+    arenaSize(0)
 {
-  // Do the actual splitting of this node.
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
+  // Do the actual splitting of this node.  The children of large nodes are
+  // built as OpenMP tasks, so the splitting starts in a parallel region.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(maxLeafSize, splitter);
+  #pragma omp parallel if (count >= 4096)
+  {
+    #pragma omp single
+    SplitNode(maxLeafSize, splitter);
+  }
+
+  // Now that the points are in their final order, place them on the NUMA
+  // nodes of the threads that traverse them, if requested.
+  util::Execution::Place(*dataset);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -68,16 +84,29 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    arena(NULL),
+    arenaSize(0)
 {
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting.  The children of large nodes are built as
+  // OpenMP tasks, so the splitting starts in a parallel region.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
+  #pragma omp parallel if (count >= 4096)
+  {
+    #pragma omp single
+    SplitNode(oldFromNew, maxLeafSize, splitter);
+  }
+
+  // Now that the points are in their final order, place them on the NUMA
+  // nodes of the threads that traverse them, if requested.
+  util::Execution::Place(*dataset);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -102,16 +131,29 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    arena(NULL),
+    arenaSize(0)
 {
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting.  The children of large nodes are built as
+  // OpenMP tasks, so the splitting starts in a parallel region.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
+  #pragma omp parallel if (count >= 4096)
+  {
+    #pragma omp single
+    SplitNode(oldFromNew, maxLeafSize, splitter);
+  }
+
+  // Now that the points are in their final order, place them on the NUMA
+  // nodes of the threads that traverse them, if requested.
+  util::Execution::Place(*dataset);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -137,11 +179,24 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    arena(NULL),
+    arenaSize(0)
 {
-  // Do the actual splitting of this node.
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
+  // Do the actual splitting of this node.  The children of large nodes are
+  // built as OpenMP tasks, so the splitting starts in a parallel region.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(maxLeafSize, splitter);
+  #pragma omp parallel if (count >= 4096)
+  {
+    #pragma omp single
+    SplitNode(maxLeafSize, splitter);
+  }
+
+  // Now that the points are in their final order, place them on the NUMA
+  // nodes of the threads that traverse them, if requested.
+  util::Execution::Place(*dataset);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -165,16 +220,29 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    arena(NULL),
+    arenaSize(0)
 {
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
   // Initialize oldFromNew correctly.
   oldFromNew.resize(dataset->n_cols);
   for (size_t i = 0; i < dataset->n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting.  The children of large nodes are built as
+  // OpenMP tasks, so the splitting starts in a parallel region.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
+  #pragma omp parallel if (count >= 4096)
+  {
+    #pragma omp single
+    SplitNode(oldFromNew, maxLeafSize, splitter);
+  }
+
+  // Now that the points are in their final order, place them on the NUMA
+  // nodes of the threads that traverse them, if requested.
+  util::Execution::Place(*dataset);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -199,16 +267,29 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    arena(NULL),
+    arenaSize(0)
 {
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(dataset->n_cols);
   for (size_t i = 0; i < dataset->n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting.  The children of large nodes are built as
+  // OpenMP tasks, so the splitting starts in a parallel region.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
+  #pragma omp parallel if (count >= 4096)
+  {
+    #pragma omp single
+    SplitNode(oldFromNew, maxLeafSize, splitter);
+  }
+
+  // Now that the points are in their final order, place them on the NUMA
+  // nodes of the threads that traverse them, if requested.
+  util::Execution::Place(*dataset);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -238,8 +319,12 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset()) // Point to the parent's dataset.
+    dataset(&parent->Dataset()), // Point to the parent's dataset.
+    arena(NULL),
+    arenaSize(0)
 {
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
   // Perform the actual splitting.
   SplitNode(maxLeafSize, splitter);
 
@@ -267,8 +352,12 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    arena(NULL),
+    arenaSize(0)
 {
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
   assert(oldFromNew.size() == dataset->n_cols);
@@ -301,8 +390,12 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset()->n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    arena(NULL),
+    arenaSize(0)
 {
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
   Log::Assert(oldFromNew.size() == dataset->n_cols);
@@ -342,8 +435,12 @@ BinarySpaceTree(
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     // Copy matrix, but only if we are the root.
-    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
+    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    arena(NULL),
+    arenaSize(0)
 {
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
   // Create left and right children (if any).
   if (other.Left())
   {
@@ -400,8 +497,12 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    arena(other.arena),
+    arenaSize(other.arenaSize)
 {
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
+
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
   other.left = NULL;
@@ -412,6 +513,8 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.arena = NULL;
+  other.arenaSize = 0;
 
   // Set new parent.
   if (left)
@@ -455,14 +558,144 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
-  delete left;
-  delete right;
+  // Every constructor records the allocation of the node.
+  MLPACK_TRACK_FREE(sizeof(BinarySpaceTree));
+
+  DeleteChildren();
 
   // If we're the root, delete the matrix.
   if (!parent)
     delete dataset;
 }
 
+/**
+ * Move every descendant of this node into one contiguous block of memory, in
+ * depth-first pre-order.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    Compact()
+{
+  std::vector<BinarySpaceTree*> order;
+  PreOrderDescendants(order);
+
+  if (order.empty())
+    return;
+
+  BinarySpaceTree* newArena = static_cast<BinarySpaceTree*>(
+      ::operator new(order.size() * sizeof(BinarySpaceTree)));
+
+  // Since every node comes after its parent, the parent has already been moved
+  // when we get to a node, and the move constructor of the parent has already
+  // pointed the node's parent link at the new parent.  So we only have to fix
+  // the child link of the parent.
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    BinarySpaceTree* node = new (newArena + i)
+        BinarySpaceTree(std::move(*order[i]));
+
+    if (node->parent->left == order[i])
+      node->parent->left = node;
+    else
+      node->parent->right = node;
+  }
+
+  // The old nodes are now empty, so they can be destroyed without touching the
+  // new nodes.
+  if (arena)
+  {
+    for (size_t i = 0; i < arenaSize; ++i)
+      arena[i].~BinarySpaceTree();
+    ::operator delete(arena);
+  }
+  else
+  {
+    for (size_t i = 0; i < order.size(); ++i)
+      delete order[i];
+  }
+
+  arena = newArena;
+  arenaSize = order.size();
+}
+
+/**
+ * Append the descendants of this node to the given vector, in depth-first
+ * pre-order.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    PreOrderDescendants(std::vector<BinarySpaceTree*>& order)
+{
+  // Pushing the right child first means that the left child of each node
+  // directly follows it.
+  std::vector<BinarySpaceTree*> stack;
+  if (right)
+    stack.push_back(right);
+  if (left)
+    stack.push_back(left);
+  while (!stack.empty())
+  {
+    BinarySpaceTree* node = stack.back();
+    stack.pop_back();
+    order.push_back(node);
+
+    if (node->right)
+      stack.push_back(node->right);
+    if (node->left)
+      stack.push_back(node->left);
+  }
+}
+
+/**
+ * Delete the children of this node, whether they were allocated individually or
+ * live in the arena of this node.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    DeleteChildren()
+{
+  if (arena)
+  {
+    // The nodes in the arena were not allocated individually, so they must not
+    // delete each other.
+    for (size_t i = 0; i < arenaSize; ++i)
+    {
+      arena[i].left = NULL;
+      arena[i].right = NULL;
+    }
+
+    for (size_t i = 0; i < arenaSize; ++i)
+      arena[i].~BinarySpaceTree();
+    ::operator delete(arena);
+
+    arena = NULL;
+    arenaSize = 0;
+  }
+  else
+  {
+    delete left;
+    delete right;
+  }
+
+  left = NULL;
+  right = NULL;
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -783,10 +1016,20 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
+  // The left child of a large node is built in a task, alongside the right
+  // child.  Visual Studio only implements OpenMP 2.0, which has no tasks, so
+  // there the children are built one after the other.
+#ifndef _WIN32
+  #pragma omp task default(shared) \
+      if (ParallelBuild && splitCol - begin >= 4096)
+#endif
   left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
       maxLeafSize);
   right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
       splitter, maxLeafSize);
+#ifndef _WIN32
+  #pragma omp taskwait
+#endif
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -850,10 +1093,20 @@ SplitNode(std::vector<size_t>& oldFromNew,
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
+  // The left child of a large node is built in a task, alongside the right
+  // child.  Visual Studio only implements OpenMP 2.0, which has no tasks, so
+  // there the children are built one after the other.
+#ifndef _WIN32
+  #pragma omp task default(shared) \
+      if (ParallelBuild && splitCol - begin >= 4096)
+#endif
   left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
       splitter, maxLeafSize);
   right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
       oldFromNew, splitter, maxLeafSize);
+#ifndef _WIN32
+  #pragma omp taskwait
+#endif
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -909,6 +1162,48 @@ UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate)
     boundToUpdate |= dataset->cols(begin, begin + count - 1);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+UpdateBound(bound::HRectBound<MetricType>& boundToUpdate)
+{
+  const size_t blockSize = split::parallelSplitBlockSize;
+  if (count < 2 * blockSize)
+  {
+    if (count > 0)
+      boundToUpdate |= dataset->cols(begin, begin + count - 1);
+    return;
+  }
+
+  // Bound blocks of the node in tasks, and merge their bounds.  Visual Studio
+  // only implements OpenMP 2.0, which has no tasks, so there the blocks are
+  // bounded one after the other.
+  const size_t numBlocks = count / blockSize;
+  std::vector<bound::HRectBound<MetricType>> blockBounds(numBlocks,
+      bound::HRectBound<MetricType>(dataset->n_rows));
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+#ifndef _WIN32
+    #pragma omp task default(shared) firstprivate(b)
+#endif
+    {
+      const size_t blockBegin = begin + b * count / numBlocks;
+      const size_t blockEnd = begin + (b + 1) * count / numBlocks;
+      blockBounds[b] |= dataset->cols(blockBegin, blockEnd - 1);
+    }
+  }
+#ifndef _WIN32
+  #pragma omp taskwait
+#endif
+
+  for (size_t b = 0; b < numBlocks; ++b)
+    boundToUpdate |= blockBounds[b];
+}
+
 // Default constructor (private), for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
@@ -926,9 +1221,11 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
-    dataset(NULL)
+    dataset(NULL),
+    arena(NULL),
+    arenaSize(0)
 {
-  // Nothing to do.
+  MLPACK_TRACK_ALLOC(sizeof(BinarySpaceTree));
 }
 
 /**
@@ -942,17 +1239,133 @@ template<typename MetricType,
              class SplitType>
 template<typename Archive>
 void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
-    Serialize(Archive& ar, const unsigned int /* version */)
+    Serialize(Archive& ar, const unsigned int version)
 {
   using data::CreateNVP;
 
+  // Version 0 stored every node separately, with pointers to its children.
+  if (version == 0)
+  {
+    SerializeNodes(ar);
+    return;
+  }
+
   // If we're loading, and we have children, they need to be deleted.
   if (Archive::is_loading::value)
   {
-    if (left)
-      delete left;
-    if (right)
-      delete right;
+    DeleteChildren();
+    if (!parent)
+      delete dataset;
+  }
+
+  ar & CreateNVP(parent, "parent");
+  ar & CreateNVP(dataset, "dataset");
+
+  // The subtree rooted at this node is stored as flat arrays, in the
+  // depth-first pre-order of Compact(), where node 0 is this node.  Each column
+  // of 'structure' holds the begin and count of a node and the indices of its
+  // children (0 if there is no child), and each column of 'distances' holds the
+  // parent distance and the furthest descendant distance of a node.  The bounds
+  // and statistics follow, in the same order.
+  std::vector<BinarySpaceTree*> nodes(1, this);
+  arma::Mat<size_t> structure;
+  arma::Mat<ElemType> distances;
+  if (Archive::is_saving::value)
+  {
+    PreOrderDescendants(nodes);
+
+    std::unordered_map<const BinarySpaceTree*, size_t> indices;
+    for (size_t i = 0; i < nodes.size(); ++i)
+      indices[nodes[i]] = i;
+
+    structure.set_size(4, nodes.size());
+    distances.set_size(2, nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+      structure(0, i) = nodes[i]->begin;
+      structure(1, i) = nodes[i]->count;
+      structure(2, i) = nodes[i]->left ? indices[nodes[i]->left] : 0;
+      structure(3, i) = nodes[i]->right ? indices[nodes[i]->right] : 0;
+      distances(0, i) = nodes[i]->parentDistance;
+      distances(1, i) = nodes[i]->furthestDescendantDistance;
+    }
+  }
+
+  ar & CreateNVP(structure, "structure");
+  ar & CreateNVP(distances, "distances");
+
+  if (Archive::is_loading::value)
+  {
+    if (structure.n_rows != 4 || structure.n_cols == 0 ||
+        distances.n_rows != 2 || distances.n_cols != structure.n_cols)
+      throw std::runtime_error("BinarySpaceTree::Serialize(): invalid tree");
+
+    // All of the descendants are allocated at once, as Compact() would.
+    const size_t numDescendants = structure.n_cols - 1;
+    if (numDescendants > 0)
+    {
+      arena = static_cast<BinarySpaceTree*>(
+          ::operator new(numDescendants * sizeof(BinarySpaceTree)));
+      for (size_t i = 0; i < numDescendants; ++i)
+      {
+        nodes.push_back(new (arena + i) BinarySpaceTree());
+        nodes.back()->dataset = dataset;
+      }
+      arenaSize = numDescendants;
+    }
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+      // In pre-order, children come after their parent.
+      if ((structure(2, i) != 0 && (structure(2, i) <= i ||
+          structure(2, i) >= nodes.size())) ||
+          (structure(3, i) != 0 && (structure(3, i) <= i ||
+          structure(3, i) >= nodes.size())))
+        throw std::runtime_error("BinarySpaceTree::Serialize(): invalid tree");
+
+      nodes[i]->begin = structure(0, i);
+      nodes[i]->count = structure(1, i);
+      nodes[i]->parentDistance = distances(0, i);
+      nodes[i]->furthestDescendantDistance = distances(1, i);
+      if (structure(2, i) != 0)
+      {
+        nodes[i]->left = nodes[structure(2, i)];
+        nodes[i]->left->parent = nodes[i];
+      }
+      if (structure(3, i) != 0)
+      {
+        nodes[i]->right = nodes[structure(3, i)];
+        nodes[i]->right->parent = nodes[i];
+      }
+    }
+  }
+
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    ar & CreateNVP(nodes[i]->bound, "bound");
+    ar & CreateNVP(nodes[i]->stat, "statistic");
+  }
+}
+
+/**
+ * Serialize this node and its children recursively (version 0 of the format).
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename Archive>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    SerializeNodes(Archive& ar)
+{
+  using data::CreateNVP;
+
+  // If we're loading, and we have children, they need to be deleted.
+  if (Archive::is_loading::value)
+  {
+    DeleteChildren();
     if (!parent)
       delete dataset;
   }
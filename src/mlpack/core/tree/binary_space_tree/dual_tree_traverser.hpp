@@ -18,6 +18,8 @@
 #include <mlpack/prereqs.hpp>
 
 #include "binary_space_tree.hpp"
+#include "../base_case_block.hpp"
+#include "../traversal_counters.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -33,6 +35,11 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
                       SplitType>::DualTreeTraverser
 {
  public:
+  //! The type of the counters kept during the traversal (see
+  //! traversal_counters.hpp).
+  typedef typename TraversalCountersTraits<RuleType>::CountersType
+      CountersType;
+
   /**
    * Instantiate the dual-tree traverser with the given rule set.
    */
@@ -68,7 +75,32 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
   //! Modify the number of times a base case was calculated.
   size_t& NumBaseCases() { return numBaseCases; }
 
+  //! Get the counters kept during the traversal.
+  const CountersType& Counters() const { return counters; }
+  //! Modify the counters kept during the traversal.
+  CountersType& Counters() { return counters; }
+
  private:
+  /**
+   * Evaluate the base cases between the points of the two given leaves, one
+   * pair of points at a time.
+   */
+  template<typename Rule = RuleType>
+  void LeafBaseCases(
+      BinarySpaceTree& queryNode,
+      BinarySpaceTree& referenceNode,
+      const typename std::enable_if_t<!HasBaseCaseBlock<Rule>::value>* = 0);
+
+  /**
+   * Evaluate the base cases between the points of the two given leaves with a
+   * single call to the BaseCaseBlock() function of the rules.
+   */
+  template<typename Rule = RuleType>
+  void LeafBaseCases(
+      BinarySpaceTree& queryNode,
+      BinarySpaceTree& referenceNode,
+      const typename std::enable_if_t<HasBaseCaseBlock<Rule>::value>* = 0);
+
   //! Reference to the rules with which the trees will be traversed.
   RuleType& rule;
 
@@ -84,9 +116,16 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
   //! The number of times a base case was calculated.
   size_t numBaseCases;
 
+  //! The counters kept during the traversal.
+  CountersType counters;
+
   //! Traversal information, held in the class so that it isn't continually
   //! being reallocated.
   typename RuleType::TraversalInfoType traversalInfo;
+
+  //! The query points of a leaf that must be compared with a reference leaf,
+  //! held in the class so that it isn't continually being reallocated.
+  std::vector<size_t> queryIndices;
 };
 
 } // namespace tree
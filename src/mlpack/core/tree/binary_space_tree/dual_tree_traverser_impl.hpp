@@ -52,6 +52,7 @@ DualTreeTraverser<RuleType>::Traverse(
 {
   // Increment the visit counter.
   ++numVisited;
+  counters.Enter();
 
   // Store the current traversal info.
   traversalInfo = rule.TraversalInfo();
@@ -59,25 +60,7 @@ DualTreeTraverser<RuleType>::Traverse(
   // If both are leaves, we must evaluate the base case.
   if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
-    // Loop through each of the points in each node.
-    const size_t queryEnd = queryNode.Begin() + queryNode.Count();
-    const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
-    for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
-    {
-      // See if we need to investigate this point (this function should be
-      // implemented for the single-tree recursion too).  Restore the traversal
-      // information first.
-      rule.TraversalInfo() = traversalInfo;
-      const double childScore = rule.Score(query, referenceNode);
-
-      if (childScore == DBL_MAX)
-        continue; // We can't improve this particular point.
-
-      for (size_t ref = referenceNode.Begin(); ref < refEnd; ++ref)
-        rule.BaseCase(query, ref);
-
-      numBaseCases += referenceNode.Count();
-    }
+    LeafBaseCases(queryNode, referenceNode);
   }
   else if (((!queryNode.IsLeaf()) && referenceNode.IsLeaf()) ||
            (queryNode.NumDescendants() > 3 * referenceNode.NumDescendants() &&
@@ -87,21 +70,29 @@ DualTreeTraverser<RuleType>::Traverse(
     // does not matter.
     const double leftScore = rule.Score(*queryNode.Left(), referenceNode);
     ++numScores;
+    counters.Score();
 
     if (leftScore != DBL_MAX)
       Traverse(*queryNode.Left(), referenceNode);
     else
+    {
       ++numPrunes;
+      counters.Prune();
+    }
 
     // Before recursing, we have to set the traversal information correctly.
     rule.TraversalInfo() = traversalInfo;
     const double rightScore = rule.Score(*queryNode.Right(), referenceNode);
     ++numScores;
+    counters.Score();
 
     if (rightScore != DBL_MAX)
       Traverse(*queryNode.Right(), referenceNode);
     else
+    {
       ++numPrunes;
+      counters.Prune();
+    }
   }
   else if (queryNode.IsLeaf() && (!referenceNode.IsLeaf()))
   {
@@ -113,6 +104,7 @@ DualTreeTraverser<RuleType>::Traverse(
     rule.TraversalInfo() = traversalInfo;
     double rightScore = rule.Score(queryNode, *referenceNode.Right());
     numScores += 2;
+    counters.Score(2);
 
     if (leftScore < rightScore)
     {
@@ -123,7 +115,8 @@ DualTreeTraverser<RuleType>::Traverse(
       Traverse(queryNode, *referenceNode.Left());
 
       // Is it still valid to recurse to the right?
-      rightScore = rule.Rescore(queryNode, *referenceNode.Right(), rightScore);
+      rightScore = counters.Rescore(rightScore,
+          rule.Rescore(queryNode, *referenceNode.Right(), rightScore));
 
       if (rightScore != DBL_MAX)
       {
@@ -132,7 +125,10 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(queryNode, *referenceNode.Right());
       }
       else
+      {
         ++numPrunes;
+        counters.Prune();
+      }
     }
     else if (rightScore < leftScore)
     {
@@ -140,7 +136,8 @@ DualTreeTraverser<RuleType>::Traverse(
       Traverse(queryNode, *referenceNode.Right());
 
       // Is it still valid to recurse to the left?
-      leftScore = rule.Rescore(queryNode, *referenceNode.Left(), leftScore);
+      leftScore = counters.Rescore(leftScore,
+          rule.Rescore(queryNode, *referenceNode.Left(), leftScore));
 
       if (leftScore != DBL_MAX)
       {
@@ -149,13 +146,17 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(queryNode, *referenceNode.Left());
       }
       else
+      {
         ++numPrunes;
+        counters.Prune();
+      }
     }
     else // leftScore is equal to rightScore.
     {
       if (leftScore == DBL_MAX)
       {
         numPrunes += 2;
+        counters.Prune(2);
       }
       else
       {
@@ -165,8 +166,8 @@ DualTreeTraverser<RuleType>::Traverse(
         rule.TraversalInfo() = leftInfo;
         Traverse(queryNode, *referenceNode.Left());
 
-        rightScore = rule.Rescore(queryNode, *referenceNode.Right(),
-            rightScore);
+        rightScore = counters.Rescore(rightScore,
+            rule.Rescore(queryNode, *referenceNode.Right(), rightScore));
 
         if (rightScore != DBL_MAX)
         {
@@ -175,7 +176,10 @@ DualTreeTraverser<RuleType>::Traverse(
           Traverse(queryNode, *referenceNode.Right());
         }
         else
+        {
           ++numPrunes;
+          counters.Prune();
+        }
       }
     }
   }
@@ -191,6 +195,7 @@ DualTreeTraverser<RuleType>::Traverse(
     double rightScore = rule.Score(*queryNode.Left(), *referenceNode.Right());
     typename RuleType::TraversalInfoType rightInfo;
     numScores += 2;
+    counters.Score(2);
 
     if (leftScore < rightScore)
     {
@@ -201,8 +206,8 @@ DualTreeTraverser<RuleType>::Traverse(
       Traverse(*queryNode.Left(), *referenceNode.Left());
 
       // Is it still valid to recurse to the right?
-      rightScore = rule.Rescore(*queryNode.Left(), *referenceNode.Right(),
-          rightScore);
+      rightScore = counters.Rescore(rightScore,
+          rule.Rescore(*queryNode.Left(), *referenceNode.Right(), rightScore));
 
       if (rightScore != DBL_MAX)
       {
@@ -211,7 +216,10 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Left(), *referenceNode.Right());
       }
       else
+      {
         ++numPrunes;
+        counters.Prune();
+      }
     }
     else if (rightScore < leftScore)
     {
@@ -219,8 +227,8 @@ DualTreeTraverser<RuleType>::Traverse(
       Traverse(*queryNode.Left(), *referenceNode.Right());
 
       // Is it still valid to recurse to the left?
-      leftScore = rule.Rescore(*queryNode.Left(), *referenceNode.Left(),
-          leftScore);
+      leftScore = counters.Rescore(leftScore,
+          rule.Rescore(*queryNode.Left(), *referenceNode.Left(), leftScore));
 
       if (leftScore != DBL_MAX)
       {
@@ -229,13 +237,17 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Left(), *referenceNode.Left());
       }
       else
+      {
         ++numPrunes;
+        counters.Prune();
+      }
     }
     else
     {
       if (leftScore == DBL_MAX)
       {
         numPrunes += 2;
+        counters.Prune(2);
       }
       else
       {
@@ -246,8 +258,9 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Left(), *referenceNode.Left());
 
         // Is it still valid to recurse to the right?
-        rightScore = rule.Rescore(*queryNode.Left(), *referenceNode.Right(),
-            rightScore);
+        rightScore = counters.Rescore(rightScore,
+            rule.Rescore(*queryNode.Left(), *referenceNode.Right(),
+                rightScore));
 
         if (rightScore != DBL_MAX)
         {
@@ -256,7 +269,10 @@ DualTreeTraverser<RuleType>::Traverse(
           Traverse(*queryNode.Left(), *referenceNode.Right());
         }
         else
+        {
           ++numPrunes;
+          counters.Prune();
+        }
       }
     }
 
@@ -269,6 +285,7 @@ DualTreeTraverser<RuleType>::Traverse(
     rule.TraversalInfo() = traversalInfo;
     rightScore = rule.Score(*queryNode.Right(), *referenceNode.Right());
     numScores += 2;
+    counters.Score(2);
 
     if (leftScore < rightScore)
     {
@@ -279,8 +296,8 @@ DualTreeTraverser<RuleType>::Traverse(
       Traverse(*queryNode.Right(), *referenceNode.Left());
 
       // Is it still valid to recurse to the right?
-      rightScore = rule.Rescore(*queryNode.Right(), *referenceNode.Right(),
-          rightScore);
+      rightScore = counters.Rescore(rightScore,
+          rule.Rescore(*queryNode.Right(), *referenceNode.Right(), rightScore));
 
       if (rightScore != DBL_MAX)
       {
@@ -289,7 +306,10 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Right(), *referenceNode.Right());
       }
       else
+      {
         ++numPrunes;
+        counters.Prune();
+      }
     }
     else if (rightScore < leftScore)
     {
@@ -297,8 +317,8 @@ DualTreeTraverser<RuleType>::Traverse(
       Traverse(*queryNode.Right(), *referenceNode.Right());
 
       // Is it still valid to recurse to the left?
-      leftScore = rule.Rescore(*queryNode.Right(), *referenceNode.Left(),
-          leftScore);
+      leftScore = counters.Rescore(leftScore,
+          rule.Rescore(*queryNode.Right(), *referenceNode.Left(), leftScore));
 
       if (leftScore != DBL_MAX)
       {
@@ -307,13 +327,17 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Right(), *referenceNode.Left());
       }
       else
+      {
         ++numPrunes;
+        counters.Prune();
+      }
     }
     else
     {
       if (leftScore == DBL_MAX)
       {
         numPrunes += 2;
+        counters.Prune(2);
       }
       else
       {
@@ -324,8 +348,9 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Right(), *referenceNode.Left());
 
         // Is it still valid to recurse to the right?
-        rightScore = rule.Rescore(*queryNode.Right(), *referenceNode.Right(),
-            rightScore);
+        rightScore = counters.Rescore(rightScore,
+            rule.Rescore(*queryNode.Right(), *referenceNode.Right(),
+                rightScore));
 
         if (rightScore != DBL_MAX)
         {
@@ -334,10 +359,87 @@ DualTreeTraverser<RuleType>::Traverse(
           Traverse(*queryNode.Right(), *referenceNode.Right());
         }
         else
+        {
           ++numPrunes;
+          counters.Prune();
+        }
       }
     }
   }
+
+  counters.Leave();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType>
+template<typename Rule>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+DualTreeTraverser<RuleType>::LeafBaseCases(
+    BinarySpaceTree& queryNode,
+    BinarySpaceTree& referenceNode,
+    const typename std::enable_if_t<!HasBaseCaseBlock<Rule>::value>*)
+{
+  // Loop through each of the points in each node.
+  const size_t queryEnd = queryNode.Begin() + queryNode.Count();
+  const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
+  for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
+  {
+    // See if we need to investigate this point (this function should be
+    // implemented for the single-tree recursion too).  Restore the traversal
+    // information first.
+    rule.TraversalInfo() = traversalInfo;
+    const double childScore = rule.Score(query, referenceNode);
+
+    if (childScore == DBL_MAX)
+      continue; // We can't improve this particular point.
+
+    for (size_t ref = referenceNode.Begin(); ref < refEnd; ++ref)
+      rule.BaseCase(query, ref);
+
+    numBaseCases += referenceNode.Count();
+    counters.BaseCases(referenceNode.Count());
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType>
+template<typename Rule>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+DualTreeTraverser<RuleType>::LeafBaseCases(
+    BinarySpaceTree& queryNode,
+    BinarySpaceTree& referenceNode,
+    const typename std::enable_if_t<HasBaseCaseBlock<Rule>::value>*)
+{
+  // Find the points of the query node that we need to investigate, exactly as
+  // above, and then hand all of them to the rules at once.
+  queryIndices.clear();
+  const size_t queryEnd = queryNode.Begin() + queryNode.Count();
+  for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
+  {
+    rule.TraversalInfo() = traversalInfo;
+    const double childScore = rule.Score(query, referenceNode);
+
+    if (childScore != DBL_MAX)
+      queryIndices.push_back(query);
+  }
+
+  if (!queryIndices.empty())
+  {
+    rule.BaseCaseBlock(queryIndices, referenceNode.Begin(),
+        referenceNode.Count());
+    numBaseCases += queryIndices.size() * referenceNode.Count();
+    counters.BaseCases(queryIndices.size() * referenceNode.Count());
+  }
 }
 
 } // namespace tree
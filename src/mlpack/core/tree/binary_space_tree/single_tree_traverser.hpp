@@ -17,6 +17,7 @@
 #include <mlpack/prereqs.hpp>
 
 #include "binary_space_tree.hpp"
+#include "../traversal_counters.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -32,6 +33,11 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
                       SplitType>::SingleTreeTraverser
 {
  public:
+  //! The type of the counters kept during the traversal (see
+  //! traversal_counters.hpp).
+  typedef typename TraversalCountersTraits<RuleType>::CountersType
+      CountersType;
+
   /**
    * Instantiate the single tree traverser with the given rule set.
    */
@@ -51,12 +57,20 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
   //! Modify the number of prunes.
   size_t& NumPrunes() { return numPrunes; }
 
+  //! Get the counters kept during the traversal.
+  const CountersType& Counters() const { return counters; }
+  //! Modify the counters kept during the traversal.
+  CountersType& Counters() { return counters; }
+
  private:
   //! Reference to the rules with which the tree will be traversed.
   RuleType& rule;
 
   //! The number of nodes which have been pruned during traversal.
   size_t numPrunes;
+
+  //! The counters kept during the traversal.
+  CountersType counters;
 };
 
 } // namespace tree
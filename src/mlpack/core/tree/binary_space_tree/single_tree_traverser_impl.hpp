@@ -48,18 +48,22 @@ SingleTreeTraverser<RuleType>::Traverse(
     BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>&
         referenceNode)
 {
+  counters.Enter();
+
   // If we are a leaf, run the base case as necessary.
   if (referenceNode.IsLeaf())
   {
     const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
     for (size_t i = referenceNode.Begin(); i < refEnd; ++i)
       rule.BaseCase(queryIndex, i);
+    counters.BaseCases(referenceNode.Count());
   }
   else
   {
     // If either score is DBL_MAX, we do not recurse into that node.
     double leftScore = rule.Score(queryIndex, *referenceNode.Left());
     double rightScore = rule.Score(queryIndex, *referenceNode.Right());
+    counters.Score(2);
 
     if (leftScore < rightScore)
     {
@@ -67,12 +71,16 @@ SingleTreeTraverser<RuleType>::Traverse(
       Traverse(queryIndex, *referenceNode.Left());
 
       // Is it still valid to recurse to the right?
-      rightScore = rule.Rescore(queryIndex, *referenceNode.Right(), rightScore);
+      rightScore = counters.Rescore(rightScore,
+          rule.Rescore(queryIndex, *referenceNode.Right(), rightScore));
 
       if (rightScore != DBL_MAX)
         Traverse(queryIndex, *referenceNode.Right()); // Recurse to the right.
       else
+      {
         ++numPrunes;
+        counters.Prune();
+      }
     }
     else if (rightScore < leftScore)
     {
@@ -80,18 +88,23 @@ SingleTreeTraverser<RuleType>::Traverse(
       Traverse(queryIndex, *referenceNode.Right());
 
       // Is it still valid to recurse to the left?
-      leftScore = rule.Rescore(queryIndex, *referenceNode.Left(), leftScore);
+      leftScore = counters.Rescore(leftScore,
+          rule.Rescore(queryIndex, *referenceNode.Left(), leftScore));
 
       if (leftScore != DBL_MAX)
         Traverse(queryIndex, *referenceNode.Left()); // Recurse to the left.
       else
+      {
         ++numPrunes;
+        counters.Prune();
+      }
     }
     else // leftScore is equal to rightScore.
     {
       if (leftScore == DBL_MAX)
       {
         numPrunes += 2; // Pruned both left and right.
+        counters.Prune(2);
       }
       else
       {
@@ -99,16 +112,21 @@ SingleTreeTraverser<RuleType>::Traverse(
         Traverse(queryIndex, *referenceNode.Left());
 
         // Is it still valid to recurse to the right?
-        rightScore = rule.Rescore(queryIndex, *referenceNode.Right(),
-            rightScore);
+        rightScore = counters.Rescore(rightScore,
+            rule.Rescore(queryIndex, *referenceNode.Right(), rightScore));
 
         if (rightScore != DBL_MAX)
           Traverse(queryIndex, *referenceNode.Right());
         else
+        {
           ++numPrunes;
+          counters.Prune();
+        }
       }
     }
   }
+
+  counters.Leave();
 }
 
 } // namespace tree
@@ -17,6 +17,9 @@
 namespace mlpack {
 namespace tree {
 
+//! Nodes with fewer columns than this are processed by a single thread.
+static const size_t parallelColumns = 4096;
+
 CosineTree::CosineTree(const arma::mat& dataset) :
     dataset(dataset),
     parent(NULL),
@@ -29,11 +32,18 @@ CosineTree::CosineTree(const arma::mat& dataset) :
   l2NormsSquared.zeros(numColumns);
 
   // Set indices and calculate squared norms of the columns.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for if (numColumns >= parallelColumns)
+  for (intmax_t i = 0; i < (intmax_t) numColumns; i++)
+#else
+  #pragma omp parallel for if (numColumns >= parallelColumns)
   for (size_t i = 0; i < numColumns; i++)
+#endif
   {
     indices[i] = i;
-    double l2Norm = arma::norm(dataset.col(i), 2);
-    l2NormsSquared(i) = l2Norm * l2Norm;
+    l2NormsSquared(i) = arma::dot(dataset.col(i), dataset.col(i));
   }
 
   // Frobenius norm of columns in the node.
@@ -91,6 +101,16 @@ CosineTree::CosineTree(const arma::mat& dataset,
   root.BasisVector(tempVector);
   treeQueue.push(&root);
 
+  // The basis vectors of the nodes in the queue are also kept as the first
+  // 'basisSize' columns of 'basis', so that projections onto the whole basis
+  // are matrix products.  The order of the columns does not matter, so the
+  // column of a popped node is filled with the last one, and the storage is
+  // only reallocated when it is full.  'basisNodes' holds the node of each
+  // column.
+  basis.zeros(dataset.n_rows, 16);
+  std::vector<CosineTree*> basisNodes(1, &root);
+  size_t basisSize = 1;
+
   // Initialize Monte Carlo error estimate for comparison.
   double monteCarloError = root.FrobNormSquared();
 
@@ -101,6 +121,16 @@ CosineTree::CosineTree(const arma::mat& dataset,
     currentNode = treeQueue.top();
     treeQueue.pop();
 
+    // Remove the basis vector of the current node from the basis.
+    const size_t column = std::find(basisNodes.begin(),
+        basisNodes.begin() + basisSize, currentNode) - basisNodes.begin();
+    --basisSize;
+    if (column != basisSize)
+    {
+      basis.col(column) = basis.col(basisSize);
+      basisNodes[column] = basisNodes[basisSize];
+    }
+
     // If the priority is 0, we can't improve anything, and we can assume that
     // we've done the best we can.
     if (currentNode->L2Error() == 0.0)
@@ -117,36 +147,50 @@ CosineTree::CosineTree(const arma::mat& dataset,
     // case.
     currentNode->CosineNodeSplit();
 
+    // Make room for the basis vectors of the two children.
+    if (basisSize + 2 > basis.n_cols)
+      basis.resize(basis.n_rows, 2 * basis.n_cols);
+    if (basisSize + 2 > basisNodes.size())
+      basisNodes.resize(basis.n_cols);
+
     // Obtain pointers to the left and right children of the current node.
     CosineTree *currentLeft, *currentRight;
     currentLeft = currentNode->Left();
     currentRight = currentNode->Right();
 
-    // Calculate basis vectors of left and right children.
+    // Calculate basis vectors of left and right children; the right one is
+    // also orthogonal to the left one.
     arma::vec lBasisVector, rBasisVector;
 
-    ModifiedGramSchmidt(treeQueue, currentLeft->Centroid(), lBasisVector);
-    ModifiedGramSchmidt(treeQueue, currentRight->Centroid(), rBasisVector,
-                        &lBasisVector);
+    ModifiedGramSchmidt(arma::mat(basis.memptr(), basis.n_rows, basisSize,
+        false, true), currentLeft->Centroid(), lBasisVector);
+    basis.col(basisSize) = lBasisVector;
+    basisNodes[basisSize++] = currentLeft;
+    ModifiedGramSchmidt(arma::mat(basis.memptr(), basis.n_rows, basisSize,
+        false, true), currentRight->Centroid(), rBasisVector);
+    basis.col(basisSize) = rBasisVector;
+    basisNodes[basisSize++] = currentRight;
 
     // Add basis vectors to their respective nodes.
     currentLeft->BasisVector(lBasisVector);
     currentRight->BasisVector(rBasisVector);
 
-    // Calculate Monte Carlo error estimates for child nodes.
-    MonteCarloError(currentLeft, treeQueue, &lBasisVector, &rBasisVector);
-    MonteCarloError(currentRight, treeQueue, &lBasisVector, &rBasisVector);
+    // Calculate Monte Carlo error estimates for child nodes, and for the root
+    // node once they are in the queue.
+    const arma::mat currentBasis(basis.memptr(), basis.n_rows, basisSize,
+        false, true);
+    MonteCarloError(currentLeft, currentBasis);
+    MonteCarloError(currentRight, currentBasis);
 
     // Push child nodes into the priority queue.
     treeQueue.push(currentLeft);
     treeQueue.push(currentRight);
 
-    // Calculate Monte Carlo error estimate for the root node.
-    monteCarloError = MonteCarloError(&root, treeQueue);
+    monteCarloError = MonteCarloError(&root, currentBasis);
   }
 
-  // Construct the subspace basis from the current priority queue.
-  ConstructBasis(treeQueue);
+  // The subspace basis is made of the basis vectors of the nodes in the queue.
+  basis.resize(basis.n_rows, basisSize);
 }
 
 CosineTree::~CosineTree()
@@ -162,39 +206,47 @@ void CosineTree::ModifiedGramSchmidt(CosineNodeQueue& treeQueue,
                                      arma::vec& newBasisVector,
                                      arma::vec* addBasisVector)
 {
-  // Set new basis vector to centroid.
-  newBasisVector = centroid;
-
-  // Variables for iterating throught the priority queue.
-  CosineTree *currentNode;
-  CosineNodeQueue::const_iterator i = treeQueue.begin();
+  // Gather the current basis, and take the additional basis vector into
+  // account if it is passed.
+  arma::mat currentBasis;
+  QueueBasis(treeQueue, currentBasis, addBasisVector);
+  ModifiedGramSchmidt(currentBasis, centroid, newBasisVector);
+}
 
-  // For every vector in the current basis, remove its projection from the
+void CosineTree::ModifiedGramSchmidt(const arma::mat& currentBasis,
+                                     const arma::vec& centroid,
+                                     arma::vec& newBasisVector)
+{
+  // Remove the projection onto every vector of the current basis from the
   // centroid.
-  for ( ; i != treeQueue.end(); i++)
-  {
-    currentNode = *i;
-
-    double projection = arma::dot(currentNode->BasisVector(), centroid);
-    newBasisVector -= projection * currentNode->BasisVector();
-  }
-
-  // If additional basis vector is passed, take it into account.
-  if (addBasisVector)
-  {
-    double projection = arma::dot(*addBasisVector, centroid);
-    newBasisVector -= *addBasisVector * projection;
-  }
+  newBasisVector = centroid;
+  if (currentBasis.n_cols > 0)
+    newBasisVector -= currentBasis * (currentBasis.t() * centroid);
 
   // Normalize the modified centroid vector.
-  if (arma::norm(newBasisVector, 2))
-    newBasisVector /= arma::norm(newBasisVector, 2);
+  const double norm = arma::norm(newBasisVector, 2);
+  if (norm)
+    newBasisVector /= norm;
 }
 
 double CosineTree::MonteCarloError(CosineTree* node,
                                    CosineNodeQueue& treeQueue,
                                    arma::vec* addBasisVector1,
                                    arma::vec* addBasisVector2)
+{
+  // Gather the current basis; the additional basis vectors are only taken into
+  // account if both are passed.
+  arma::mat currentBasis;
+  if (addBasisVector1 && addBasisVector2)
+    QueueBasis(treeQueue, currentBasis, addBasisVector1, addBasisVector2);
+  else
+    QueueBasis(treeQueue, currentBasis);
+
+  return MonteCarloError(node, currentBasis);
+}
+
+double CosineTree::MonteCarloError(CosineTree* node,
+                                   const arma::mat& currentBasis)
 {
   std::vector<size_t> sampledIndices;
   arma::vec probabilities;
@@ -204,55 +256,20 @@ double CosineTree::MonteCarloError(CosineTree* node,
   size_t numSamples = log(node->NumColumns()) + 1;
   node->ColumnSamplesLS(sampledIndices, probabilities, numSamples);
 
-  // Get pointer to the original dataset.
-  arma::mat dataset = node->GetDataset();
-
-  // Initialize weighted projection magnitudes as zeros.
+  // Calculate the weighted magnitudes of the projections of the samples onto
+  // the current basis, all at once.
   arma::vec weightedMagnitudes;
-  weightedMagnitudes.zeros(numSamples);
-
-  // Set size of projection vector, depending on whether additional basis
-  // vectors are passed.
-  size_t projectionSize;
-  if (addBasisVector1 && addBasisVector2)
-    projectionSize = treeQueue.size() + 2;
+  if (currentBasis.n_cols > 0)
+  {
+    const arma::uvec samples = arma::conv_to<arma::uvec>::from(sampledIndices);
+    const arma::mat projections = currentBasis.t() *
+        node->GetDataset().cols(samples);
+    weightedMagnitudes = arma::sum(arma::square(projections), 0).t() /
+        probabilities;
+  }
   else
-    projectionSize = treeQueue.size();
-
-  // For each sample, calculate the weighted projection onto the current basis.
-  for (size_t i = 0; i < numSamples; i++)
   {
-    // Initialize projection as a vector of zeros.
-    arma::vec projection;
-    projection.zeros(projectionSize);
-
-    CosineTree *currentNode;
-    CosineNodeQueue::const_iterator j = treeQueue.begin();
-
-    size_t k = 0;
-    // Compute the projection of the sampled vector onto the existing subspace.
-    for ( ; j != treeQueue.end(); j++, k++)
-    {
-      currentNode = *j;
-
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                currentNode->BasisVector());
-    }
-    // If two additional vectors are passed, take their projections.
-    if (addBasisVector1 && addBasisVector2)
-    {
-      projection(k++) = arma::dot(dataset.col(sampledIndices[i]),
-                                  *addBasisVector1);
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                *addBasisVector2);
-    }
-
-    // Calculate the Frobenius norm squared of the projected vector.
-    double frobProjection = arma::norm(projection, "frob");
-    double frobProjectionSquared = frobProjection * frobProjection;
-
-    // Calculate the weighted projection magnitude.
-    weightedMagnitudes(i) = frobProjectionSquared / probabilities(i);
+    weightedMagnitudes.zeros(numSamples);
   }
 
   // Compute mean and standard deviation of the weighted samples.
@@ -278,20 +295,29 @@ double CosineTree::MonteCarloError(CosineTree* node,
 
 void CosineTree::ConstructBasis(CosineNodeQueue& treeQueue)
 {
-  // Initialize basis as matrix of zeros.
-  basis.zeros(dataset.n_rows, treeQueue.size());
+  // Transfer basis vectors from the queue to the basis matrix.
+  QueueBasis(treeQueue, basis);
+}
 
-  // Variables for iterating through the priority queue.
-  CosineTree *currentNode;
-  CosineNodeQueue::const_iterator i = treeQueue.begin();
+void CosineTree::QueueBasis(CosineNodeQueue& treeQueue,
+                            arma::mat& currentBasis,
+                            const arma::vec* addBasisVector1,
+                            const arma::vec* addBasisVector2)
+{
+  currentBasis.set_size(dataset.n_rows, treeQueue.size() +
+      (addBasisVector1 ? 1 : 0) + (addBasisVector2 ? 1 : 0));
 
-  // Transfer basis vectors from the queue to the basis matrix.
+  // Transfer basis vectors from the queue to the matrix, followed by the
+  // additional basis vectors.
   size_t j = 0;
+  CosineNodeQueue::const_iterator i = treeQueue.begin();
   for ( ; i != treeQueue.end(); i++, j++)
-  {
-    currentNode = *i;
-    basis.col(j) = currentNode->BasisVector();
-  }
+    currentBasis.col(j) = (*i)->BasisVector();
+
+  if (addBasisVector1)
+    currentBasis.col(j++) = *addBasisVector1;
+  if (addBasisVector2)
+    currentBasis.col(j) = *addBasisVector2;
 }
 
 void CosineTree::CosineNodeSplit()
@@ -340,11 +366,8 @@ void CosineTree::ColumnSamplesLS(std::vector<size_t>& sampledIndices,
   cDistribution.zeros(numColumns + 1);
 
   // Calculate cumulative length-squared distribution for the node.
-  for (size_t i = 0; i < numColumns; i++)
-  {
-    cDistribution(i + 1) = cDistribution(i) +
-        (l2NormsSquared(i) / frobNormSquared);
-  }
+  cDistribution.tail(numColumns) = arma::cumsum(l2NormsSquared /
+      frobNormSquared);
 
   // Initialize sizes of the 'sampledIndices' and 'probabilities' vectors.
   sampledIndices.resize(numSamples);
@@ -376,11 +399,8 @@ size_t CosineTree::ColumnSampleLS()
   cDistribution.zeros(numColumns + 1);
 
   // Calculate cumulative length-squared distribution for the node.
-  for (size_t i = 0; i < numColumns; i++)
-  {
-    cDistribution(i + 1) = cDistribution(i) +
-        (l2NormsSquared(i) / frobNormSquared);
-  }
+  cDistribution.tail(numColumns) = arma::cumsum(l2NormsSquared /
+      frobNormSquared);
 
   // Generate a random value for sampling.
   double randValue = arma::randu();
@@ -423,34 +443,58 @@ void CosineTree::CalculateCosines(arma::vec& cosines)
   // Initialize cosine vector as a vector of zeros.
   cosines.zeros(numColumns);
 
+  // The norms of the columns are already known, so only the dot products with
+  // the splitting point have to be computed.
+  const double splitNorm = std::sqrt(l2NormsSquared(splitPointIndex));
+  if (splitNorm == 0)
+    return;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for if (numColumns >= parallelColumns)
+  for (intmax_t i = 0; i < (intmax_t) numColumns; i++)
+#else
+  #pragma omp parallel for if (numColumns >= parallelColumns)
   for (size_t i = 0; i < numColumns; i++)
+#endif
   {
     // If norm is zero, store cosine value as zero. Else, calculate cosine value
     // between two vectors.
-    if (l2NormsSquared(i) == 0)
-    {
-      cosines(i) = 0;
-    }
-    else
+    if (l2NormsSquared(i) != 0)
     {
-      cosines(i) =
-          std::abs(arma::norm_dot(dataset.col(indices[splitPointIndex]),
-                                  dataset.col(indices[i])));
+      cosines(i) = std::abs(arma::dot(dataset.col(indices[splitPointIndex]),
+          dataset.col(indices[i]))) / (splitNorm *
+          std::sqrt(l2NormsSquared(i)));
     }
   }
 }
 
 void CosineTree::CalculateCentroid()
 {
-  // Initialize centroid as vector of zeros.
-  centroid.zeros(dataset.n_rows);
-
-  // Calculate centroid of columns in the node.
-  for (size_t i = 0; i < numColumns; i++)
+  // Sum blocks of columns in parallel; the partial sums are then added in
+  // order, so the centroid does not depend on the number of threads.
+  const size_t numBlocks = (numColumns + parallelColumns - 1) /
+      parallelColumns;
+  arma::mat sums(dataset.n_rows, numBlocks, arma::fill::zeros);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for if (numBlocks > 1)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; b++)
+#else
+  #pragma omp parallel for if (numBlocks > 1)
+  for (size_t b = 0; b < numBlocks; b++)
+#endif
   {
-    centroid += dataset.col(indices[i]);
+    const size_t end = std::min((size_t) (b + 1) * parallelColumns,
+        numColumns);
+    for (size_t i = b * parallelColumns; i < end; i++)
+      sums.col(b) += dataset.col(indices[i]);
   }
-  centroid /= numColumns;
+
+  centroid = arma::sum(sums, 1) / numColumns;
 }
 
 } // namespace tree
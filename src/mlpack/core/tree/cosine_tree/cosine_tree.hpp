@@ -111,6 +111,27 @@ class CosineTree
    */
   void ConstructBasis(CosineNodeQueue& treeQueue);
 
+  /**
+   * Calculates the orthonormalization of the passed centroid, with respect to
+   * the given basis (one vector per column).
+   *
+   * @param currentBasis Current basis of the subspace.
+   * @param centroid Centroid of the node being added to the basis.
+   * @param newBasisVector Orthonormalized centroid of the node.
+   */
+  void ModifiedGramSchmidt(const arma::mat& currentBasis,
+                           const arma::vec& centroid,
+                           arma::vec& newBasisVector);
+
+  /**
+   * Estimates the squared error of the projection of the input node's matrix
+   * onto the given basis (one vector per column); see the overload above.
+   *
+   * @param node Node for which Monte Carlo estimate is calculated.
+   * @param currentBasis Current basis of the subspace.
+   */
+  double MonteCarloError(CosineTree* node, const arma::mat& currentBasis);
+
   /**
    * This function splits the cosine node into two children based on the cosines
    * of the columns contained in the node, with respect to the sampled splitting
@@ -213,6 +234,15 @@ class CosineTree
   size_t SplitPointIndex() const { return indices[splitPointIndex]; }
 
  private:
+  /**
+   * Store the basis vectors of the nodes in the queue as the columns of the
+   * given matrix, followed by the additional basis vectors, if passed.
+   */
+  void QueueBasis(CosineNodeQueue& treeQueue,
+                  arma::mat& currentBasis,
+                  const arma::vec* addBasisVector1 = NULL,
+                  const arma::vec* addBasisVector2 = NULL);
+
   //! Matrix for which cosine tree is constructed.
   const arma::mat& dataset;
   //! Cumulative probability for Monte Carlo error lower bound.
@@ -15,6 +15,8 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/math/range.hpp>
 
+#include <deque>
+
 #include "../statistic.hpp"
 #include "first_point_is_root.hpp"
 
@@ -263,6 +265,11 @@ class CoverTree
   template<typename RuleType>
   using BreadthFirstDualTreeTraverser = DualTreeTraverser<RuleType>;
 
+  //! A dual-tree cover tree traverser that reuses flat storage for its
+  //! reference sets; see flat_dual_tree_traverser.hpp.
+  template<typename RuleType>
+  class FlatDualTreeTraverser;
+
   //! Get a reference to the dataset.
   const MatType& Dataset() const { return *dataset; }
 
@@ -411,12 +418,26 @@ class CoverTree
   //! Get the center of the node and store it in the given vector.
   void Center(arma::vec& center) const
   {
-    center = arma::vec(dataset->col(point));
+    center = arma::conv_to<arma::vec>::from(dataset->col(point));
   }
 
   //! Get the instantiated metric.
   MetricType& Metric() const { return *metric; }
 
+  /**
+   * Reorder the points of the dataset in place into the depth-first order of
+   * the tree (the order of Descendant()), so that the descendants of every node
+   * are contiguous columns and base cases read the dataset sequentially.  The
+   * points of the nodes are renumbered, and the old index of each point is
+   * stored in oldFromNew.  If the tree does not own its dataset, the dataset is
+   * copied once first.  Only the root of a tree can be reordered; otherwise a
+   * std::invalid_argument is thrown.
+   *
+   * @param oldFromNew Vector which will be filled with the old positions for
+   *     each new point.
+   */
+  void ReorderDataset(std::vector<size_t>& oldFromNew);
+
  private:
   //! Reference to the matrix which this tree is built on.
   const MatType* dataset;
@@ -445,6 +466,75 @@ class CoverTree
   //! The metric used for this tree.
   MetricType* metric;
 
+  /**
+   * A stack of index and distance arrays that is reused while the tree is
+   * built.  Each call to CreateChildren() takes the arrays of the next level of
+   * the recursion and uses them for all of its children, so the arrays are
+   * only allocated when a level is first reached or needs more room.
+   */
+  class BuildBuffers
+  {
+   public:
+    //! Create an empty stack.
+    BuildBuffers() : depth(0) { }
+
+    /**
+     * Get the arrays of the next level, with room for at least the given
+     * number of points.  The contents of the arrays are undefined.  The arrays
+     * of the previous levels stay valid.
+     */
+    void Acquire(const size_t size,
+                 arma::Col<size_t>*& indicesOut,
+                 arma::vec*& distancesOut)
+    {
+      if (depth == indices.size())
+      {
+        indices.emplace_back();
+        distances.emplace_back();
+      }
+
+      if (indices[depth].n_elem < size)
+      {
+        indices[depth].set_size(size);
+        distances[depth].set_size(size);
+      }
+
+      indicesOut = &indices[depth];
+      distancesOut = &distances[depth];
+      ++depth;
+    }
+
+    //! Give back the arrays of the last level.
+    void Release() { --depth; }
+
+   private:
+    //! The index arrays of each level (a deque keeps references valid).
+    std::deque<arma::Col<size_t>> indices;
+    //! The distance arrays of each level.
+    std::deque<arma::vec> distances;
+    //! The number of levels in use.
+    size_t depth;
+  };
+
+  /**
+   * Construct a child cover tree node, reusing the given arrays for the
+   * children.  The other parameters are the same as those of the public child
+   * constructor.
+   */
+  CoverTree(const MatType& dataset,
+            const ElemType base,
+            const size_t pointIndex,
+            const int scale,
+            CoverTree* parent,
+            const ElemType parentDistance,
+            arma::Col<size_t>& indices,
+            arma::vec& distances,
+            size_t nearSetSize,
+            size_t& farSetSize,
+            size_t& usedSetSize,
+            MetricType& metric,
+            BuildBuffers& buffers);
+
   /**
    * Create the children for this node.
    */
@@ -452,13 +542,15 @@ class CoverTree
                       arma::vec& distances,
                       size_t nearSetSize,
                       size_t& farSetSize,
-                      size_t& usedSetSize);
+                      size_t& usedSetSize,
+                      BuildBuffers& buffers);
 
   /**
    * Fill the vector of distances with the distances between the point specified
    * by pointIndex and each point in the indices array.  The distances of the
    * first pointSetSize points in indices are calculated (so, this does not
-   * necessarily need to use all of the points in the arrays).
+   * necessarily need to use all of the points in the arrays).  With OpenMP,
+   * large point sets are processed in parallel.
    *
    * @param pointIndex Point to build the distances for.
    * @param indices List of indices to compute distances for.
@@ -533,6 +625,19 @@ class CoverTree
    */
   void RemoveNewImplicitNodes();
 
+  /**
+   * Append the points of this subtree to oldFromNew in depth-first order, at
+   * the node where each point first appears.
+   */
+  void CollectPoints(std::vector<size_t>& oldFromNew) const;
+
+  /**
+   * Map the point of every node of this subtree to its new index, and make the
+   * nodes use the given dataset.
+   */
+  void RenumberPoints(const std::vector<size_t>& newFromOld,
+                      const MatType* newDataset);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
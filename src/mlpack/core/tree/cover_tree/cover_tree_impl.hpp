@@ -14,13 +14,52 @@
 
 // In case it hasn't already been included.
 #include "cover_tree.hpp"
+#include "../permute_columns.hpp"
 
 #include <queue>
 #include <string>
 
 namespace mlpack {
+
+namespace metric {
+
+// Forward declaration, so that the IPMetric does not need to be included.
+template<typename KernelType>
+class IPMetric;
+
+} // namespace metric
+
 namespace tree {
 
+namespace details {
+
+//! Most metrics have nothing to cache for the dataset of a tree.
+template<typename MetricType, typename MatType>
+void CacheDataset(MetricType& /* metric */, const MatType& /* dataset */) { }
+
+//! The IPMetric caches the self-kernels of the points of the dataset, so that
+//! each distance takes a single kernel evaluation.
+template<typename KernelType, typename eT>
+void CacheDataset(metric::IPMetric<KernelType>& metric,
+                  const arma::Mat<eT>& dataset)
+{
+  metric.CacheSelfKernels(dataset);
+}
+
+//! Forget whatever was cached by CacheDataset() for the given dataset.
+template<typename MetricType, typename MatType>
+void ReleaseDataset(MetricType& /* metric */, const MatType& /* dataset */) { }
+
+template<typename KernelType, typename eT>
+void ReleaseDataset(metric::IPMetric<KernelType>& metric,
+                    const arma::Mat<eT>& dataset)
+{
+  if (metric.HasSelfKernels(dataset))
+    metric.ClearSelfKernels();
+}
+
+} // namespace details
+
 // Create the cover tree.
 template<
     typename MetricType,
@@ -57,6 +96,10 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     return;
   }
 
+  // Let the metric precompute what it can for the points of the dataset; it
+  // stays cached until the tree is destroyed.
+  details::CacheDataset(*this->metric, dataset);
+
   // Kick off the building.  Create the indices array and the distances array.
   arma::Col<size_t> indices = arma::linspace<arma::Col<size_t> >(1,
       dataset.n_cols - 1, dataset.n_cols - 1);
@@ -73,8 +116,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   // Create the children.
   size_t farSetSize = 0;
   size_t usedSetSize = 0;
+  BuildBuffers buffers;
   CreateChildren(indices, distances, dataset.n_cols - 1, farSetSize,
-      usedSetSize);
+      usedSetSize, buffers);
 
   // If we ended up creating only one child, remove the implicit node.
   while (children.size() == 1)
@@ -148,6 +192,10 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     return;
   }
 
+  // Let the metric precompute what it can for the points of the dataset; it
+  // stays cached until the tree is destroyed.
+  details::CacheDataset(*this->metric, dataset);
+
   // Kick off the building.  Create the indices array and the distances array.
   arma::Col<size_t> indices = arma::linspace<arma::Col<size_t> >(1,
       dataset.n_cols - 1, dataset.n_cols - 1);
@@ -164,8 +212,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   // Create the children.
   size_t farSetSize = 0;
   size_t usedSetSize = 0;
+  BuildBuffers buffers;
   CreateChildren(indices, distances, dataset.n_cols - 1, farSetSize,
-      usedSetSize);
+      usedSetSize, buffers);
 
   // If we ended up creating only one child, remove the implicit node.
   while (children.size() == 1)
@@ -241,6 +290,10 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     return;
   }
 
+  // Let the metric precompute what it can for the points of the dataset; it
+  // stays cached until the tree is destroyed.
+  details::CacheDataset(*this->metric, *dataset);
+
   // Kick off the building.  Create the indices array and the distances array.
   arma::Col<size_t> indices = arma::linspace<arma::Col<size_t> >(1,
       dataset->n_cols - 1, dataset->n_cols - 1);
@@ -257,8 +310,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   // Create the children.
   size_t farSetSize = 0;
   size_t usedSetSize = 0;
+  BuildBuffers buffers;
   CreateChildren(indices, distances, dataset->n_cols - 1, farSetSize,
-      usedSetSize);
+      usedSetSize, buffers);
 
   // If we ended up creating only one child, remove the implicit node.
   while (children.size() == 1)
@@ -332,6 +386,10 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     return;
   }
 
+  // Let the metric precompute what it can for the points of the dataset; it
+  // stays cached until the tree is destroyed.
+  details::CacheDataset(*this->metric, *dataset);
+
   // Kick off the building.  Create the indices array and the distances array.
   arma::Col<size_t> indices = arma::linspace<arma::Col<size_t> >(1,
       dataset->n_cols - 1, dataset->n_cols - 1);
@@ -348,8 +406,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   // Create the children.
   size_t farSetSize = 0;
   size_t usedSetSize = 0;
+  BuildBuffers buffers;
   CreateChildren(indices, distances, dataset->n_cols - 1, farSetSize,
-      usedSetSize);
+      usedSetSize, buffers);
 
   // If we ended up creating only one child, remove the implicit node.
   while (children.size() == 1)
@@ -434,7 +493,59 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   }
 
   // Otherwise, create the children.
-  CreateChildren(indices, distances, nearSetSize, farSetSize, usedSetSize);
+  BuildBuffers buffers;
+  CreateChildren(indices, distances, nearSetSize, farSetSize, usedSetSize,
+      buffers);
+
+  // Initialize statistic.
+  stat = StatisticType(*this);
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
+    const MatType& dataset,
+    const ElemType base,
+    const size_t pointIndex,
+    const int scale,
+    CoverTree* parent,
+    const ElemType parentDistance,
+    arma::Col<size_t>& indices,
+    arma::vec& distances,
+    size_t nearSetSize,
+    size_t& farSetSize,
+    size_t& usedSetSize,
+    MetricType& metric,
+    BuildBuffers& buffers) :
+    dataset(&dataset),
+    point(pointIndex),
+    scale(scale),
+    base(base),
+    numDescendants(0),
+    parent(parent),
+    parentDistance(parentDistance),
+    furthestDescendantDistance(0),
+    localMetric(false),
+    localDataset(false),
+    metric(&metric),
+    distanceComps(0)
+{
+  // If the size of the near set is 0, this is a leaf.
+  if (nearSetSize == 0)
+  {
+    this->scale = INT_MIN;
+    numDescendants = 1;
+    stat = StatisticType(*this);
+    return;
+  }
+
+  // Otherwise, create the children.
+  CreateChildren(indices, distances, nearSetSize, farSetSize, usedSetSize,
+      buffers);
 
   // Initialize statistic.
   stat = StatisticType(*this);
@@ -597,6 +708,10 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::~CoverTree()
   for (size_t i = 0; i < children.size(); ++i)
     delete children[i];
 
+  // The metric may have cached something for the dataset of the tree.
+  if (parent == NULL && metric != NULL && dataset != NULL)
+    details::ReleaseDataset(*metric, *dataset);
+
   // Delete the local metric, if necessary.
   if (localMetric)
     delete metric;
@@ -987,7 +1102,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     arma::vec& distances,
     size_t nearSetSize,
     size_t& farSetSize,
-    size_t& usedSetSize)
+    size_t& usedSetSize,
+    BuildBuffers& buffers)
 {
   // Determine the next scale level.  This should be the first level where there
   // are any points in the far set.  So, if we know the maximum distance in the
@@ -1005,7 +1121,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     // This should not modify farSetSize or usedSetSize.
     size_t tempSize = 0;
     children.push_back(new CoverTree(*dataset, base, point, INT_MIN, this, 0,
-        indices, distances, 0, tempSize, usedSetSize, *metric));
+        indices, distances, 0, tempSize, usedSetSize, *metric, buffers));
     distanceComps += children.back()->DistanceComps();
 
     // Every point in the near set should be a leaf.
@@ -1014,7 +1130,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
       // farSetSize and usedSetSize will not be modified.
       children.push_back(new CoverTree(*dataset, base, indices[i],
           INT_MIN, this, distances[i], indices, distances, 0, tempSize,
-          usedSetSize, *metric));
+          usedSetSize, *metric, buffers));
       distanceComps += children.back()->DistanceComps();
       usedSetSize++;
     }
@@ -1046,7 +1162,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
   size_t childUsedSetSize = 0;
   children.push_back(new CoverTree(*dataset, base, point, nextScale, this, 0,
       indices, distances, childNearSetSize, childFarSetSize, childUsedSetSize,
-      *metric));
+      *metric, buffers));
   // Don't double-count the self-child (so, subtract one).
   numDescendants += children[0]->NumDescendants();
 
@@ -1076,7 +1192,16 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
   // Now for each point in the near set, we need to make children.  To save
   // computation later, we'll create an array holding the points in the near
   // set, and then after each run we'll check which of those (if any) were used
-  // and we will remove them.  ...if that's faster.  I think it is.
+  // and we will remove them.  ...if that's faster.  I think it is.  The
+  // arrays of the children are taken from the buffers, and are reused for each
+  // child; the sets only get smaller, so they are large enough for all.
+  arma::Col<size_t>* childIndicesBuffer;
+  arma::vec* childDistancesBuffer;
+  buffers.Acquire(nearSetSize + farSetSize, childIndicesBuffer,
+      childDistancesBuffer);
+  arma::Col<size_t>& childIndices = *childIndicesBuffer;
+  arma::vec& childDistances = *childDistancesBuffer;
+
   while (nearSetSize > 0)
   {
     size_t newPointIndex = nearSetSize - 1;
@@ -1104,7 +1229,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
       size_t childNearSetSize = 0;
       children.push_back(new CoverTree(*dataset, base, indices[0], nextScale,
           this, distances[0], indices, distances, childNearSetSize, farSetSize,
-          usedSetSize, *metric));
+          usedSetSize, *metric, buffers));
       distanceComps += children.back()->DistanceComps();
       numDescendants += children.back()->NumDescendants();
 
@@ -1117,12 +1242,10 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
       break;
     }
 
-    // Create the near and far set indices and distance vectors.  We don't fill
-    // in the self-point, yet.
-    arma::Col<size_t> childIndices(nearSetSize + farSetSize);
+    // Fill the near and far set indices.  We don't fill in the self-point,
+    // yet.
     childIndices.rows(0, (nearSetSize + farSetSize - 2)) = indices.rows(1,
         nearSetSize + farSetSize - 1);
-    arma::vec childDistances(nearSetSize + farSetSize);
 
     // Build distances for the child.
     ComputeDistances(indices[0], childIndices, childDistances, nearSetSize
@@ -1146,7 +1269,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     childUsedSetSize = 1; // Mark self point as used.
     children.push_back(new CoverTree(*dataset, base, indices[0], nextScale,
         this, distances[0], childIndices, childDistances, childNearSetSize,
-        childFarSetSize, childUsedSetSize, *metric));
+        childFarSetSize, childUsedSetSize, *metric, buffers));
     numDescendants += children.back()->NumDescendants();
 
     // Remove any implicit nodes.
@@ -1163,6 +1286,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
         childIndices, childFarSetSize, childUsedSetSize);
   }
 
+  buffers.Release();
+
   // Calculate furthest descendant.
   for (size_t i = (nearSetSize + farSetSize); i < (nearSetSize + farSetSize +
       usedSetSize); ++i)
@@ -1243,7 +1368,20 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
   // For each point, rebuild the distances.  The indices do not need to be
   // modified.
   distanceComps += pointSetSize;
+
+  // Near the root of the tree, the point sets are large and this is most of
+  // the construction time, so the distances are computed in parallel.  Small
+  // point sets are not worth the overhead of a parallel region.
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+#ifdef _WIN32
+  #pragma omp parallel for if (pointSetSize >= 2048)
+  for (intmax_t i = 0; i < (intmax_t) pointSetSize; ++i)
+#else
+  #pragma omp parallel for if (pointSetSize >= 2048)
   for (size_t i = 0; i < pointSetSize; ++i)
+#endif
   {
     distances[i] = metric->Evaluate(dataset->col(pointIndex),
         dataset->col(indices[i]));
@@ -1540,6 +1678,80 @@ inline void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
   }
 }
 
+/**
+ * Reorder the dataset into the depth-first order of the tree.
+ */
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    ReorderDataset(std::vector<size_t>& oldFromNew)
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("CoverTree::ReorderDataset(): only the root "
+        "of a tree can reorder the dataset");
+  }
+
+  oldFromNew.clear();
+  if (dataset->n_cols == 0)
+    return;
+
+  oldFromNew.reserve(dataset->n_cols);
+  CollectPoints(oldFromNew);
+
+  std::vector<size_t> newFromOld(dataset->n_cols);
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    newFromOld[oldFromNew[i]] = i;
+
+  // We can only reorder a dataset we own.
+  if (!localDataset)
+  {
+    dataset = new MatType(*dataset);
+    localDataset = true;
+  }
+
+  PermuteColumns(const_cast<MatType&>(*dataset), oldFromNew);
+  RenumberPoints(newFromOld, dataset);
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    CollectPoints(std::vector<size_t>& oldFromNew) const
+{
+  // A self-child holds the same point as its parent.
+  if (parent == NULL || parent->Point() != point)
+    oldFromNew.push_back(point);
+
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->CollectPoints(oldFromNew);
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    RenumberPoints(const std::vector<size_t>& newFromOld,
+                   const MatType* newDataset)
+{
+  point = newFromOld[point];
+  dataset = newDataset;
+
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->RenumberPoints(newFromOld, newDataset);
+}
+
 /**
  * Default constructor, only for use with boost::serialization.
  */
@@ -0,0 +1,210 @@
+/**
+ * @file flat_dual_tree_traverser.hpp
+ *
+ * A dual-tree traverser for the cover tree that keeps the reference sets of
+ * the traversal in flat, reusable storage instead of maps.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_COVER_TREE_FLAT_DUAL_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_COVER_TREE_FLAT_DUAL_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <deque>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The FlatDualTreeTraverser visits the same nodes in the same order as the
+ * DualTreeTraverser, and calls Score(), Rescore() and BaseCase() of the rules
+ * in the same order, so it gives the same results.  The difference is in how
+ * the set of reference nodes of each query node is stored.  The
+ * DualTreeTraverser builds a std::map from scales to vectors of reference
+ * nodes for every query node it visits; this traverser keeps one reference set
+ * for each depth of the query recursion, where each scale of the reference tree
+ * has a fixed slot.  The reference sets are reused for every query node at the
+ * same depth and for every call to Traverse(), so once they have grown to the
+ * size the traversal needs, nothing is allocated.
+ *
+ * A traverser should only be used by one thread at a time.
+ */
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+class CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    FlatDualTreeTraverser
+{
+ public:
+  /**
+   * Initialize the dual tree traverser with the given rule type.
+   */
+  FlatDualTreeTraverser(RuleType& rule);
+
+  /**
+   * Traverse the two specified trees.
+   *
+   * @param queryNode Root of query tree.
+   * @param referenceNode Root of reference tree.
+   */
+  void Traverse(CoverTree& queryNode, CoverTree& referenceNode);
+
+  //! Get the number of pruned nodes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of pruned nodes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  // These are not counted, as in the DualTreeTraverser.
+  size_t NumVisited() const { return 0; }
+  size_t NumScores() const { return 0; }
+  size_t NumBaseCases() const { return 0; }
+
+ private:
+  //! A reference node in a reference set, with the results of its last score.
+  struct FrontierEntry
+  {
+    //! The node this entry refers to.
+    CoverTree* referenceNode;
+    //! The score of the node.
+    double score;
+    //! The base case.
+    double baseCase;
+    //! The traversal info associated with the call to Score() for this entry.
+    typename RuleType::TraversalInfoType traversalInfo;
+
+    //! Comparison operator, for sorting within a scale.
+    bool operator<(const FrontierEntry& other) const
+    {
+      if (score == other.score)
+        return (baseCase < other.baseCase);
+      else
+        return (score < other.score);
+    }
+  };
+
+  /**
+   * The reference set of a query node.  The entries of scale s are held in
+   * slot (rootScale - s), and the leaves, whose scale is INT_MIN, are held
+   * separately.  Cleared slots keep their memory.  The slots are held in a
+   * deque, so that adding slots does not move the slot being traversed.
+   */
+  struct Frontier
+  {
+    //! The entries of each scale, from the scale of the reference root down.
+    std::deque<std::vector<FrontierEntry> > scales;
+    //! The entries of the leaves.
+    std::vector<FrontierEntry> leaves;
+    //! The slot of the largest scale with entries (scales.size() if none).
+    size_t top;
+
+    //! Create an empty reference set.
+    Frontier() : top(0) { }
+
+    //! Return whether there are no entries.
+    bool Empty() const { return (top == scales.size()) && leaves.empty(); }
+
+    //! Remove all entries.
+    void Clear()
+    {
+      for (size_t i = top; i < scales.size(); ++i)
+        scales[i].clear();
+      leaves.clear();
+      top = scales.size();
+    }
+
+    //! Get the largest scale with entries; the reference set must not be empty.
+    int MaxScale(const int rootScale) const
+    {
+      return (top < scales.size()) ? rootScale - (int) top : INT_MIN;
+    }
+
+    //! Get the entries of the largest scale; the set must not be empty.
+    std::vector<FrontierEntry>& MaxScaleEntries()
+    {
+      return (top < scales.size()) ? scales[top] : leaves;
+    }
+
+    //! Remove the entries of the largest scale; the set must not be empty.
+    void PopMaxScale()
+    {
+      if (top == scales.size())
+      {
+        leaves.clear();
+        return;
+      }
+
+      scales[top].clear();
+      while (top < scales.size() && scales[top].empty())
+        ++top;
+    }
+
+    //! Add an entry of the given scale.
+    void Add(const int scale, const int rootScale, const FrontierEntry& entry)
+    {
+      if (scale == INT_MIN)
+      {
+        leaves.push_back(entry);
+        return;
+      }
+
+      const size_t slot = (size_t) (rootScale - scale);
+      const bool empty = (top == scales.size());
+      while (scales.size() <= slot)
+        scales.emplace_back();
+      if (empty)
+        top = scales.size();
+
+      scales[slot].push_back(entry);
+      top = std::min(top, slot);
+    }
+  };
+
+  /**
+   * Helper function for traversal of the two trees.  The reference set of the
+   * query node is the one at the given depth.
+   */
+  void Traverse(CoverTree& queryNode, const size_t depth);
+
+  /**
+   * Fill the reference set at depth + 1 with the entries of the reference set
+   * at the given depth that cannot be pruned for the given query child.
+   */
+  void PruneFrontier(CoverTree& queryNode, const size_t depth);
+
+  //! Score the entries of one scale for the given query node, and add the ones
+  //! that are not pruned to the given reference set.
+  void PruneScale(CoverTree& queryNode,
+                  std::vector<FrontierEntry>& scaleEntries,
+                  const int scale,
+                  Frontier& childFrontier);
+
+  //! Descend the reference set down to the scale of the query node.
+  void ReferenceRecursion(CoverTree& queryNode, Frontier& frontier);
+
+  //! The instantiated rule set for pruning branches.
+  RuleType& rule;
+
+  //! The number of pruned nodes.
+  size_t numPrunes;
+
+  //! The scale of the reference root of the current traversal.
+  int rootScale;
+
+  //! The reference sets of each depth of the query recursion.
+  std::deque<Frontier> frontiers;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_dual_tree_traverser_impl.hpp"
+
+#endif
@@ -0,0 +1,324 @@
+/**
+ * @file flat_dual_tree_traverser_impl.hpp
+ *
+ * Implementation of the dual-tree traverser for the cover tree with flat
+ * reference sets.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_COVER_TREE_FLAT_DUAL_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_COVER_TREE_FLAT_DUAL_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_dual_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+FlatDualTreeTraverser<RuleType>::FlatDualTreeTraverser(RuleType& rule) :
+    rule(rule),
+    numPrunes(0),
+    rootScale(0)
+{ /* Nothing to do. */ }
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+FlatDualTreeTraverser<RuleType>::Traverse(CoverTree& queryNode,
+                                          CoverTree& referenceNode)
+{
+  // The slots of the reference sets depend on the scale of the reference
+  // root, so they are emptied if it changed since the last traversal.
+  if (frontiers.empty())
+    frontiers.emplace_back();
+  if (referenceNode.Scale() != rootScale)
+  {
+    for (size_t i = 0; i < frontiers.size(); ++i)
+    {
+      frontiers[i].scales.clear();
+      frontiers[i].leaves.clear();
+      frontiers[i].top = 0;
+    }
+    rootScale = referenceNode.Scale();
+  }
+
+  // Start with the reference root node.
+  Frontier& frontier = frontiers[0];
+  frontier.Clear();
+
+  FrontierEntry rootRefEntry;
+  rootRefEntry.referenceNode = &referenceNode;
+
+  // Perform the evaluation between the roots of either tree.
+  rootRefEntry.score = rule.Score(queryNode, referenceNode);
+  rootRefEntry.baseCase = rule.BaseCase(queryNode.Point(),
+      referenceNode.Point());
+  rootRefEntry.traversalInfo = rule.TraversalInfo();
+
+  frontier.Add(referenceNode.Scale(), rootScale, rootRefEntry);
+
+  Traverse(queryNode, 0);
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+FlatDualTreeTraverser<RuleType>::Traverse(CoverTree& queryNode,
+                                          const size_t depth)
+{
+  // The deque never moves its elements, so this reference stays valid when
+  // deeper reference sets are added.
+  Frontier& frontier = frontiers[depth];
+  if (frontier.Empty())
+    return; // Nothing to do!
+
+  // First recurse down the reference nodes as necessary.
+  ReferenceRecursion(queryNode, frontier);
+
+  // Did the reference set get emptied?
+  if (frontier.Empty())
+    return; // Nothing to do!
+
+  // Now, reduce the scale of the query node by recursing, in the same order as
+  // the DualTreeTraverser.  But we can't recurse if the query node is a leaf
+  // node.
+  if ((queryNode.Scale() != INT_MIN) &&
+      (queryNode.Scale() >= frontier.MaxScale(rootScale)))
+  {
+    if (frontiers.size() == depth + 1)
+      frontiers.emplace_back();
+
+    for (size_t i = 1; i < queryNode.NumChildren(); ++i)
+    {
+      PruneFrontier(queryNode.Child(i), depth);
+      Traverse(queryNode.Child(i), depth + 1);
+    }
+    PruneFrontier(queryNode.Child(0), depth);
+    Traverse(queryNode.Child(0), depth + 1);
+  }
+
+  if (queryNode.Scale() != INT_MIN)
+    return; // No need to evaluate base cases at this level.  It's all done.
+
+  // If we have made it this far, all we have is a bunch of base case
+  // evaluations to do.
+  Log::Assert(frontier.MaxScale(rootScale) == INT_MIN);
+  std::vector<FrontierEntry>& pointVector = frontier.leaves;
+
+  for (size_t i = 0; i < pointVector.size(); ++i)
+  {
+    // Get a reference to the frame.
+    const FrontierEntry& frame = pointVector[i];
+
+    CoverTree* refNode = frame.referenceNode;
+
+    // If the point is the same as both parents, then we have already done this
+    // base case.
+    if ((refNode->Point() == refNode->Parent()->Point()) &&
+        (queryNode.Point() == queryNode.Parent()->Point()))
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    // Score the node, to see if we can prune it, after restoring the traversal
+    // info.
+    rule.TraversalInfo() = frame.traversalInfo;
+    double score = rule.Score(queryNode, *refNode);
+
+    if (score == DBL_MAX)
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    // If not, compute the base case.
+    rule.BaseCase(queryNode.Point(), refNode->Point());
+  }
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+FlatDualTreeTraverser<RuleType>::PruneFrontier(CoverTree& queryNode,
+                                               const size_t depth)
+{
+  Frontier& frontier = frontiers[depth];
+  Frontier& childFrontier = frontiers[depth + 1];
+  childFrontier.Clear();
+
+  // The leaves go first, then the scales from the largest down.
+  if (!frontier.leaves.empty())
+    PruneScale(queryNode, frontier.leaves, INT_MIN, childFrontier);
+
+  for (size_t i = frontier.top; i < frontier.scales.size(); ++i)
+  {
+    if (!frontier.scales[i].empty())
+      PruneScale(queryNode, frontier.scales[i], rootScale - (int) i,
+          childFrontier);
+  }
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+FlatDualTreeTraverser<RuleType>::PruneScale(
+    CoverTree& queryNode,
+    std::vector<FrontierEntry>& scaleEntries,
+    const int scale,
+    Frontier& childFrontier)
+{
+  // Before traversing all the points in this scale, sort by score.
+  std::sort(scaleEntries.begin(), scaleEntries.end());
+
+  // Loop over each entry in the vector.
+  for (size_t j = 0; j < scaleEntries.size(); ++j)
+  {
+    const FrontierEntry& frame = scaleEntries[j];
+
+    // First evaluate if we can prune without performing the base case.
+    CoverTree* refNode = frame.referenceNode;
+
+    // Perform the actual scoring, after restoring the traversal info.
+    rule.TraversalInfo() = frame.traversalInfo;
+    double score = rule.Score(queryNode, *refNode);
+
+    if (score == DBL_MAX)
+    {
+      // Pruned.  Move on.
+      ++numPrunes;
+      continue;
+    }
+
+    // If it isn't pruned, we must evaluate the base case.
+    const double baseCase = rule.BaseCase(queryNode.Point(),
+        refNode->Point());
+
+    // Add to the child reference set.
+    FrontierEntry newFrame;
+    newFrame.referenceNode = refNode;
+    newFrame.score = score;
+    newFrame.baseCase = baseCase;
+    newFrame.traversalInfo = rule.TraversalInfo();
+    childFrontier.Add(scale, rootScale, newFrame);
+  }
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+FlatDualTreeTraverser<RuleType>::ReferenceRecursion(CoverTree& queryNode,
+                                                    Frontier& frontier)
+{
+  // First, reduce the maximum scale in the reference set down to the scale of
+  // the query node.
+  while (!frontier.Empty())
+  {
+    const int maxScale = frontier.MaxScale(rootScale);
+
+    // These conditions imitate the jl cover tree, as in the DualTreeTraverser.
+    if (queryNode.Parent() == NULL && maxScale < queryNode.Scale())
+      break;
+    if (queryNode.Parent() != NULL && maxScale <= queryNode.Scale())
+      break;
+    // If the query node's scale is INT_MIN and the reference set's maximum
+    // scale is INT_MIN, don't try to recurse...
+    if ((queryNode.Scale() == INT_MIN) && (maxScale == INT_MIN))
+      break;
+
+    // Get a reference to the current largest scale.  The children have smaller
+    // scales, so adding them does not touch this vector.
+    std::vector<FrontierEntry>& scaleVector = frontier.MaxScaleEntries();
+
+    // Before traversing all the points in this scale, sort by score.
+    std::sort(scaleVector.begin(), scaleVector.end());
+
+    // Now loop over each element.
+    for (size_t i = 0; i < scaleVector.size(); ++i)
+    {
+      // Get a reference to the current element.
+      const FrontierEntry& frame = scaleVector[i];
+
+      CoverTree* refNode = frame.referenceNode;
+
+      // Create the score for the children.
+      double score = rule.Rescore(queryNode, *refNode, frame.score);
+
+      // Now if this childScore is DBL_MAX we can prune all children.  In this
+      // recursion setup pruning is all or nothing for children.
+      if (score == DBL_MAX)
+      {
+        ++numPrunes;
+        continue;
+      }
+
+      // Add the children.
+      for (size_t j = 0; j < refNode->NumChildren(); ++j)
+      {
+        rule.TraversalInfo() = frame.traversalInfo;
+        double childScore = rule.Score(queryNode, refNode->Child(j));
+        if (childScore == DBL_MAX)
+        {
+          ++numPrunes;
+          continue;
+        }
+
+        // It wasn't pruned; evaluate the base case.
+        const double baseCase = rule.BaseCase(queryNode.Point(),
+            refNode->Child(j).Point());
+
+        FrontierEntry newFrame;
+        newFrame.referenceNode = &refNode->Child(j);
+        newFrame.score = childScore;
+        newFrame.baseCase = baseCase;
+        newFrame.traversalInfo = rule.TraversalInfo();
+
+        frontier.Add(newFrame.referenceNode->Scale(), rootScale, newFrame);
+      }
+    }
+
+    // Now clear this scale; its memory is kept for the next query node.
+    frontier.PopMaxScale();
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @file hilbert_order.hpp
+ *
+ * Sort the points of a dataset along the Hilbert curve.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_HILBERT_ORDER_HPP
+#define MLPACK_CORE_TREE_HILBERT_ORDER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "rectangle_tree/discrete_hilbert_value.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Compute the order of the points (columns) of the given dataset along the
+ * Hilbert curve, with the discrete Hilbert values of DiscreteHilbertValue (the
+ * ones the Hilbert R tree uses).  Points that are close along the curve are
+ * close in space, so processing the points in this order (for instance, the
+ * query points of a single-tree search) makes consecutive points touch the same
+ * parts of a tree.  The Hilbert value of each point is computed once, in
+ * parallel if OpenMP is available.
+ *
+ * @param points Dataset to order.
+ * @param order Vector to store the indices of the points into, from the first
+ *     along the curve to the last.
+ */
+template<typename MatType>
+void HilbertOrder(const MatType& points, std::vector<size_t>& order)
+{
+  typedef typename MatType::elem_type ElemType;
+  typedef DiscreteHilbertValue<ElemType> HilbertValueType;
+  typedef typename HilbertValueType::HilbertElemType HilbertElemType;
+
+  std::vector<arma::Col<HilbertElemType>> values(points.n_cols);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) points.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < points.n_cols; ++i)
+#endif
+  {
+    const arma::Col<ElemType> point(points.col(i));
+    values[i] = HilbertValueType::CalculateValue(point);
+  }
+
+  order.resize(points.n_cols);
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(),
+      [&values](const size_t a, const size_t b)
+      {
+        return HilbertValueType::CompareValues(values[a], values[b]) < 0;
+      });
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
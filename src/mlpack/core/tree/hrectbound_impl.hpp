@@ -171,11 +171,11 @@ inline ElemType HRectBound<MetricType, ElemType>::MinDistance(
 
   ElemType sum = 0;
 
-  ElemType lower, higher;
+  MLPACK_SIMD_REDUCTION(+:sum)
   for (size_t d = 0; d < dim; d++)
   {
-    lower = bounds[d].Lo() - point[d];
-    higher = point[d] - bounds[d].Hi();
+    const ElemType lower = bounds[d].Lo() - point[d];
+    const ElemType higher = point[d] - bounds[d].Hi();
 
     // Since only one of 'lower' or 'higher' is negative, if we add each's
     // absolute value to itself and then sum those two, our result is the
@@ -230,11 +230,11 @@ ElemType HRectBound<MetricType, ElemType>::MinDistance(const HRectBound& other)
   const math::RangeType<ElemType>* mbound = bounds;
   const math::RangeType<ElemType>* obound = other.bounds;
 
-  ElemType lower, higher;
+  MLPACK_SIMD_REDUCTION(+:sum)
   for (size_t d = 0; d < dim; d++)
   {
-    lower = obound->Lo() - mbound->Hi();
-    higher = mbound->Lo() - obound->Hi();
+    const ElemType lower = obound[d].Lo() - mbound[d].Hi();
+    const ElemType higher = mbound[d].Lo() - obound[d].Hi();
     // We invoke the following:
     //   x + fabs(x) = max(x * 2, 0)
     //   (x * 2)^2 / 4 = x^2
@@ -252,10 +252,6 @@ ElemType HRectBound<MetricType, ElemType>::MinDistance(const HRectBound& other)
       sum += pow((lower + fabs(lower)) + (higher + fabs(higher)),
           (ElemType) MetricType::Power);
     }
-
-    // Move bound pointers.
-    mbound++;
-    obound++;
   }
 
   // The compiler should optimize out this if statement entirely.
@@ -291,9 +287,10 @@ inline ElemType HRectBound<MetricType, ElemType>::MaxDistance(
 
   Log::Assert(point.n_elem == dim);
 
+  MLPACK_SIMD_REDUCTION(+:sum)
   for (size_t d = 0; d < dim; d++)
   {
-    ElemType v = std::max(fabs(point[d] - bounds[d].Lo()),
+    const ElemType v = std::max(fabs(point[d] - bounds[d].Lo()),
         fabs(bounds[d].Hi() - point[d]));
 
     // The compiler should optimize out this if statement entirely.
@@ -331,10 +328,10 @@ inline ElemType HRectBound<MetricType, ElemType>::MaxDistance(
 
   Log::Assert(dim == other.dim);
 
-  ElemType v;
+  MLPACK_SIMD_REDUCTION(+:sum)
   for (size_t d = 0; d < dim; d++)
   {
-    v = std::max(fabs(other.bounds[d].Hi() - bounds[d].Lo()),
+    const ElemType v = std::max(fabs(other.bounds[d].Hi() - bounds[d].Lo()),
         fabs(bounds[d].Hi() - other.bounds[d].Lo()));
 
     // The compiler should optimize out this if statement entirely.
@@ -373,22 +370,17 @@ HRectBound<MetricType, ElemType>::RangeDistance(
 
   Log::Assert(dim == other.dim);
 
-  ElemType v1, v2, vLo, vHi;
+  MLPACK_SIMD_REDUCTION(+:loSum, hiSum)
   for (size_t d = 0; d < dim; d++)
   {
-    v1 = other.bounds[d].Lo() - bounds[d].Hi();
-    v2 = bounds[d].Lo() - other.bounds[d].Hi();
-    // One of v1 or v2 is negative.
-    if (v1 >= v2)
-    {
-      vHi = -v2; // Make it nonnegative.
-      vLo = (v1 > 0) ? v1 : 0; // Force to be 0 if negative.
-    }
-    else
-    {
-      vHi = -v1; // Make it nonnegative.
-      vLo = (v2 > 0) ? v2 : 0; // Force to be 0 if negative.
-    }
+    const ElemType v1 = other.bounds[d].Lo() - bounds[d].Hi();
+    const ElemType v2 = bounds[d].Lo() - other.bounds[d].Hi();
+    // One of v1 or v2 is negative, so the larger one (forced to be 0 if
+    // negative) is the gap between the bounds, and the negated smaller one is
+    // the largest extent.  This is written without branches so that the loop
+    // can be vectorized.
+    const ElemType vHi = -std::min(v1, v2);
+    const ElemType vLo = std::max(std::max(v1, v2), (ElemType) 0);
 
     // The compiler should optimize out this if statement entirely.
     if (MetricType::Power == 1)
@@ -441,30 +433,17 @@ HRectBound<MetricType, ElemType>::RangeDistance(
 
   Log::Assert(point.n_elem == dim);
 
-  ElemType v1, v2, vLo, vHi;
+  MLPACK_SIMD_REDUCTION(+:loSum, hiSum)
   for (size_t d = 0; d < dim; d++)
   {
-    v1 = bounds[d].Lo() - point[d]; // Negative if point[d] > lo.
-    v2 = point[d] - bounds[d].Hi(); // Negative if point[d] < hi.
-    // One of v1 or v2 (or both) is negative.
-    if (v1 >= 0) // point[d] <= bounds_[d].Lo().
-    {
-      vHi = -v2; // v2 will be larger but must be negated.
-      vLo = v1;
-    }
-    else // point[d] is between lo and hi, or greater than hi.
-    {
-      if (v2 >= 0)
-      {
-        vHi = -v1; // v1 will be larger, but must be negated.
-        vLo = v2;
-      }
-      else
-      {
-        vHi = -std::min(v1, v2); // Both are negative, but we need the larger.
-        vLo = 0;
-      }
-    }
+    const ElemType v1 = bounds[d].Lo() - point[d]; // Negative if point[d] > lo.
+    const ElemType v2 = point[d] - bounds[d].Hi(); // Negative if point[d] < hi.
+    // One of v1 or v2 (or both) is negative.  If one is nonnegative, it is the
+    // distance to the bound; in every case the negated smaller one is the
+    // distance to the far edge.  This is written without branches so that the
+    // loop can be vectorized.
+    const ElemType vHi = -std::min(v1, v2);
+    const ElemType vLo = std::max(std::max(v1, v2), (ElemType) 0);
 
     // The compiler should optimize out this if statement entirely.
     if (MetricType::Power == 1)
@@ -425,6 +425,79 @@ class Octree
                  std::vector<size_t>& oldFromNew,
                  const size_t maxLeafSize);
 
+  /**
+   * Split the root, using the given center and the given maximum width of the
+   * data.  In low dimensions the points are sorted by their Morton codes and
+   * the tree is built from ranges of codes with SplitNodeMorton(); otherwise,
+   * SplitNode() is used.  If oldFromNew is not NULL, it is filled with the old
+   * positions of the points.
+   *
+   * @param center Center of the root.
+   * @param width Maximum width of the data.
+   * @param oldFromNew Mappings from old to new, or NULL.
+   * @param maxLeafSize Maximum number of points allowed in a leaf.
+   */
+  void SplitRoot(const arma::vec& center,
+                 const double width,
+                 std::vector<size_t>* oldFromNew,
+                 const size_t maxLeafSize);
+
+  /**
+   * Split the node, whose points are sorted by the given Morton codes, on the
+   * bits of the codes for the given level of the tree.  Below the last level
+   * held by the codes, SplitNode() is used.
+   *
+   * @param codes Morton codes of all the points of the dataset.
+   * @param level Depth of this node.
+   * @param center Center of the node.
+   * @param width Width of the current node.
+   * @param oldFromNew Mappings from old to new, or NULL.
+   * @param maxLeafSize Maximum number of points allowed in a leaf.
+   */
+  void SplitNodeMorton(const std::vector<uint64_t>& codes,
+                       const size_t level,
+                       const arma::vec& center,
+                       const double width,
+                       std::vector<size_t>* oldFromNew,
+                       const size_t maxLeafSize);
+
+  /**
+   * Construct this node as a child of the given parent, from the points in
+   * columns begin to begin + count - 1, which are sorted by the given Morton
+   * codes; see SplitNodeMorton().
+   */
+  Octree(Octree* parent,
+         const size_t begin,
+         const size_t count,
+         const std::vector<uint64_t>& codes,
+         const size_t level,
+         const arma::vec& center,
+         const double width,
+         std::vector<size_t>* oldFromNew,
+         const size_t maxLeafSize);
+
+  /**
+   * Get the number of levels of the tree held by a Morton code of the given
+   * number of dimensions, or 0 if Morton codes should not be used.
+   */
+  static size_t MortonLevels(const size_t dimensions)
+  {
+    return (dimensions == 0 || dimensions > 16) ? 0 : std::min<size_t>(64 / dimensions, 32);
+  }
+
+  /**
+   * Sort the given Morton codes and the given indices along with them, with a
+   * stable least-significant-digit radix sort of the lowest bits of the codes.
+   * Large arrays are sorted in parallel if OpenMP is available.
+   *
+   * @param codes Morton codes to sort.
+   * @param indices Indices to reorder like the codes.
+   * @param bits Number of (low) bits of the codes to sort on.
+   */
+  static void RadixSort(std::vector<uint64_t>& codes,
+                        arma::uvec& indices,
+                        const size_t bits);
+
   /**
    * This is used for sorting points while splitting.
    */
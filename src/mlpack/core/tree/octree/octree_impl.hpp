@@ -14,6 +14,7 @@
 
 #include "octree.hpp"
 #include <mlpack/core/tree/perform_split.hpp>
+#include <algorithm>
 #include <stack>
 
 namespace mlpack {
@@ -42,7 +43,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, maxLeafSize);
+    SplitRoot(center, maxWidth, NULL, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -84,7 +85,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    SplitRoot(center, maxWidth, &oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -127,7 +128,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    SplitRoot(center, maxWidth, &oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -168,7 +169,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, maxLeafSize);
+    SplitRoot(center, maxWidth, NULL, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -210,7 +211,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    SplitRoot(center, maxWidth, &oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -253,7 +254,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    SplitRoot(center, maxWidth, &oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -340,6 +341,43 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   stat = StatisticType(*this);
 }
 
+//! Construct a child node from a range of sorted Morton codes.
+template<typename MetricType, typename StatisticType, typename MatType>
+Octree<MetricType, StatisticType, MatType>::Octree(
+    Octree* parent,
+    const size_t begin,
+    const size_t count,
+    const std::vector<uint64_t>& codes,
+    const size_t level,
+    const arma::vec& center,
+    const double width,
+    std::vector<size_t>* oldFromNew,
+    const size_t maxLeafSize) :
+    begin(begin),
+    count(count),
+    bound(parent->dataset->n_rows),
+    dataset(parent->dataset),
+    parent(parent)
+{
+  // Calculate empirical center of data.
+  bound |= dataset->cols(begin, begin + count - 1);
+
+  // Now split the node.
+  SplitNodeMorton(codes, level, center, width, oldFromNew, maxLeafSize);
+
+  // Calculate the distance from the empirical center of this node to the
+  // empirical center of the parent.
+  arma::vec trueCenter, parentCenter;
+  bound.Center(trueCenter);
+  parent->Bound().Center(parentCenter);
+  parentDistance = metric.Evaluate(trueCenter, parentCenter);
+
+  furthestDescendantDistance = 0.5 * bound.Diameter();
+
+  // Initialize the statistic.
+  stat = StatisticType(*this);
+}
+
 //! Copy the given tree.
 template<typename MetricType, typename StatisticType, typename MatType>
 Octree<MetricType, StatisticType, MatType>::Octree(const Octree& other) :
@@ -906,6 +944,258 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   }
 }
 
+//! Split the root, with Morton codes in low dimensions.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::SplitRoot(
+    const arma::vec& center,
+    const double width,
+    std::vector<size_t>* oldFromNew,
+    const size_t maxLeafSize)
+{
+  const size_t dims = dataset->n_rows;
+  const size_t levels = MortonLevels(dims);
+  if (count <= maxLeafSize || levels == 0 || width == 0.0)
+  {
+    if (oldFromNew)
+      SplitNode(center, width, *oldFromNew, maxLeafSize);
+    else
+      SplitNode(center, width, maxLeafSize);
+    return;
+  }
+
+  // SplitNode() places the children of a node of width w at its center +/-
+  // w / 2, so the nodes of each level of the tree bisect the cube of side
+  // 2 * width around the center of the root.  Once the coordinates of a point
+  // are quantized to 2^levels cells of that cube, the bits of each cell index
+  // give the side of the point at each level, and interleaving them (the first
+  // level in the highest bits, and dimension d in bit d of each level, like the
+  // index of a child) gives a Morton code.  Sorting the points by their codes
+  // puts the points of every node in a contiguous range, with its children in
+  // the same order as SplitNode() (up to rounding on the splits).
+  std::vector<uint64_t> codes(count);
+  const double cells = std::pow(2.0, (double) levels);
+  const uint64_t maxCell = ((uint64_t) 1 << levels) - 1;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for if (count >= 4096)
+  for (intmax_t i = 0; i < (intmax_t) count; ++i)
+#else
+  #pragma omp parallel for if (count >= 4096)
+  for (size_t i = 0; i < count; ++i)
+#endif
+  {
+    uint64_t code = 0;
+    for (size_t d = 0; d < dims; ++d)
+    {
+      const double position = (((*dataset)(d, i) - center[d]) / width + 1.0) /
+          2.0;
+      const uint64_t cell = std::min((uint64_t) std::max(position * cells,
+          0.0), maxCell);
+      for (size_t l = 0; l < levels; ++l)
+        code |= ((cell >> l) & 1) << (l * dims + d);
+    }
+    codes[i] = code;
+  }
+
+  arma::uvec order = arma::linspace<arma::uvec>(0, count - 1, count);
+  RadixSort(codes, order, levels * dims);
+
+  // Reorder the points once, instead of swapping them at every level.
+  MatType sorted(dims, count);
+#ifdef _WIN32
+  #pragma omp parallel for if (count >= 4096)
+  for (intmax_t i = 0; i < (intmax_t) count; ++i)
+#else
+  #pragma omp parallel for if (count >= 4096)
+  for (size_t i = 0; i < count; ++i)
+#endif
+    sorted.col(i) = dataset->col(order[i]);
+  dataset->swap(sorted);
+
+  // The root constructors fill oldFromNew with the identity.
+  if (oldFromNew)
+  {
+    for (size_t i = 0; i < count; ++i)
+      (*oldFromNew)[i] = order[i];
+  }
+
+  // The children of large nodes are built as OpenMP tasks, so the splitting
+  // starts in a parallel region.
+  #pragma omp parallel if (count >= 4096)
+  {
+    #pragma omp single
+    SplitNodeMorton(codes, 0, center, width, oldFromNew, maxLeafSize);
+  }
+}
+
+//! Split the node on the bits of the Morton codes for its level.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::SplitNodeMorton(
+    const std::vector<uint64_t>& codes,
+    const size_t level,
+    const arma::vec& center,
+    const double width,
+    std::vector<size_t>* oldFromNew,
+    const size_t maxLeafSize)
+{
+  // No need to split if we have fewer than the maximum number of points in this
+  // node.
+  if (count <= maxLeafSize)
+    return;
+
+  const size_t dims = dataset->n_rows;
+  const size_t levels = MortonLevels(dims);
+  if (level == levels)
+  {
+    // The codes can't tell the points of this node apart anymore.
+    if (oldFromNew)
+      SplitNode(center, width, *oldFromNew, maxLeafSize);
+    else
+      SplitNode(center, width, maxLeafSize);
+    return;
+  }
+
+  // The points of a child are the range of codes that share all the bits down
+  // to this level, and the bits of this level are the index of the child.
+  const size_t shift = (levels - 1 - level) * dims;
+  const uint64_t mask = ((uint64_t) 1 << dims) - 1;
+  std::vector<size_t> childBegins, childIndices;
+  size_t i = begin;
+  while (i < begin + count)
+  {
+    const uint64_t prefix = codes[i] >> shift;
+    childBegins.push_back(i);
+    childIndices.push_back(prefix & mask);
+    auto inChild = [prefix, shift](const uint64_t code)
+    {
+      return (code >> shift) == prefix;
+    };
+    i = std::partition_point(codes.begin() + i, codes.begin() + begin + count,
+        inChild) - codes.begin();
+  }
+  childBegins.push_back(begin + count);
+
+  // Create the correct centers.
+  const double childWidth = width / 2.0;
+  arma::mat childCenters(dims, childIndices.size());
+  for (size_t c = 0; c < childIndices.size(); ++c)
+  {
+    for (size_t d = 0; d < dims; ++d)
+    {
+      // Is the dimension "right" (1) or "left" (0)?
+      if (((childIndices[c] >> d) & 1) == 0)
+        childCenters(d, c) = center[d] - childWidth;
+      else
+        childCenters(d, c) = center[d] + childWidth;
+    }
+  }
+
+  // Large children are built as separate tasks.  Visual Studio only implements
+  // OpenMP 2.0, which has no tasks, so there the children are built one after
+  // the other.
+  children.resize(childIndices.size());
+  for (size_t c = 0; c < children.size(); ++c)
+  {
+#ifndef _WIN32
+    #pragma omp task default(shared) firstprivate(c) \
+        if (childBegins[c + 1] - childBegins[c] >= 4096)
+#endif
+    children[c] = new Octree(this, childBegins[c],
+        childBegins[c + 1] - childBegins[c], codes, level + 1,
+        childCenters.col(c), childWidth, oldFromNew, maxLeafSize);
+  }
+#ifndef _WIN32
+  #pragma omp taskwait
+#endif
+}
+
+//! Radix sort of Morton codes and indices.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::RadixSort(
+    std::vector<uint64_t>& codes,
+    arma::uvec& indices,
+    const size_t bits)
+{
+  const size_t n = codes.size();
+  const size_t radix = 256;
+
+  // Each chunk of the arrays is counted and scattered by its own thread.  The
+  // offsets are taken digit by digit and then chunk by chunk, so the sort is
+  // stable.
+  #ifdef HAS_OPENMP
+    const size_t chunks = (n >= 65536) ? omp_get_max_threads() : 1;
+  #else
+    const size_t chunks = 1;
+  #endif
+
+  std::vector<uint64_t> codesBuffer(n);
+  arma::uvec indicesBuffer(n);
+  std::vector<size_t> offsets(chunks * radix);
+  for (size_t shift = 0; shift < bits; shift += 8)
+  {
+    std::fill(offsets.begin(), offsets.end(), 0);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for if (chunks > 1)
+    for (intmax_t c = 0; c < (intmax_t) chunks; ++c)
+#else
+    #pragma omp parallel for if (chunks > 1)
+    for (size_t c = 0; c < chunks; ++c)
+#endif
+    {
+      const size_t chunkEnd = (c + 1) * n / chunks;
+      for (size_t i = c * n / chunks; i < chunkEnd; ++i)
+        ++offsets[c * radix + ((codes[i] >> shift) & (radix - 1))];
+    }
+
+    // Turn the counts into offsets.  If every code has the same digit, this
+    // pass would not move anything.
+    size_t position = 0;
+    bool skip = false;
+    for (size_t digit = 0; digit < radix; ++digit)
+    {
+      const size_t digitBegin = position;
+      for (size_t c = 0; c < chunks; ++c)
+      {
+        const size_t digitCount = offsets[c * radix + digit];
+        offsets[c * radix + digit] = position;
+        position += digitCount;
+      }
+
+      if (position - digitBegin == n)
+        skip = true;
+    }
+
+    if (skip)
+      continue;
+
+#ifdef _WIN32
+    #pragma omp parallel for if (chunks > 1)
+    for (intmax_t c = 0; c < (intmax_t) chunks; ++c)
+#else
+    #pragma omp parallel for if (chunks > 1)
+    for (size_t c = 0; c < chunks; ++c)
+#endif
+    {
+      const size_t chunkEnd = (c + 1) * n / chunks;
+      for (size_t i = c * n / chunks; i < chunkEnd; ++i)
+      {
+        const size_t p = offsets[c * radix + ((codes[i] >> shift) &
+            (radix - 1))]++;
+        codesBuffer[p] = codes[i];
+        indicesBuffer[p] = indices[i];
+      }
+    }
+
+    codes.swap(codesBuffer);
+    indices.swap(indicesBuffer);
+  }
+}
+
 } // namespace tree
 } // namespace mlpack
 
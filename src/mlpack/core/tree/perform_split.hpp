@@ -20,6 +20,17 @@ namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 namespace split {
 
+//! Nodes with at least twice this many points are partitioned in blocks of
+//! about this size by ParallelPerformSplit().
+const size_t parallelSplitBlockSize = 65536;
+
+template<typename MatType, typename SplitType>
+size_t ParallelPerformSplit(MatType& data,
+                            const size_t begin,
+                            const size_t count,
+                            const typename SplitType::SplitInfo& splitInfo,
+                            std::vector<size_t>* oldFromNew);
+
 /**
  * This function implements the default split behavior i.e. it rearranges
  * points according to the split information. The SplitType::AssignToLeftNode()
@@ -38,6 +49,12 @@ size_t PerformSplit(MatType& data,
                     const size_t count,
                     const typename SplitType::SplitInfo& splitInfo)
 {
+  if (count >= 2 * parallelSplitBlockSize)
+  {
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, NULL);
+  }
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -104,6 +121,12 @@ size_t PerformSplit(MatType& data,
                     const typename SplitType::SplitInfo& splitInfo,
                     std::vector<size_t>& oldFromNew)
 {
+  if (count >= 2 * parallelSplitBlockSize)
+  {
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, &oldFromNew);
+  }
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -152,6 +175,135 @@ size_t PerformSplit(MatType& data,
   return left;
 }
 
+/**
+ * Rearrange the points of a large node like PerformSplit(), with OpenMP tasks
+ * if it is called in a parallel region.  Each block of the node is partitioned
+ * on its own, and then the right points that are left of the split column are
+ * swapped with the left points that are right of it.  The blocks only depend
+ * on the size of the node, so the result does not depend on the number of
+ * threads.
+ *
+ * @param data The dataset used by the binary space tree.
+ * @param begin Index of the starting point in the dataset that belongs to
+ *    this node.
+ * @param count Number of points in this node.
+ * @param splitInfo The information about the split.
+ * @param oldFromNew If not NULL, the old positions of the points, which are
+ *    rearranged along with them.
+ */
+template<typename MatType, typename SplitType>
+size_t ParallelPerformSplit(MatType& data,
+                            const size_t begin,
+                            const size_t count,
+                            const typename SplitType::SplitInfo& splitInfo,
+                            std::vector<size_t>* oldFromNew)
+{
+  const size_t numBlocks = count / parallelSplitBlockSize;
+  std::vector<size_t> blockBegins(numBlocks + 1), blockSplits(numBlocks);
+  for (size_t b = 0; b < numBlocks; ++b)
+    blockBegins[b] = begin + b * count / numBlocks;
+  blockBegins[numBlocks] = begin + count;
+
+  // Partition each block.  Visual Studio only implements OpenMP 2.0, which has
+  // no tasks, so there the blocks are partitioned one after the other.
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+#ifndef _WIN32
+    #pragma omp task default(shared) firstprivate(b)
+#endif
+    {
+      const size_t blockCount = blockBegins[b + 1] - blockBegins[b];
+      if (oldFromNew)
+      {
+        blockSplits[b] = PerformSplit<MatType, SplitType>(data, blockBegins[b],
+            blockCount, splitInfo, *oldFromNew);
+      }
+      else
+      {
+        blockSplits[b] = PerformSplit<MatType, SplitType>(data, blockBegins[b],
+            blockCount, splitInfo);
+      }
+    }
+  }
+#ifndef _WIN32
+  #pragma omp taskwait
+#endif
+
+  size_t splitCol = begin;
+  for (size_t b = 0; b < numBlocks; ++b)
+    splitCol += blockSplits[b] - blockBegins[b];
+
+  // Collect the ranges of right points before splitCol and of left points from
+  // splitCol on; both hold the same number of points.
+  std::vector<std::pair<size_t, size_t>> wrongRight, wrongLeft;
+  size_t numWrong = 0;
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t rightEnd = std::min(blockBegins[b + 1], splitCol);
+    if (blockSplits[b] < rightEnd)
+    {
+      wrongRight.push_back(std::make_pair(blockSplits[b], rightEnd));
+      numWrong += rightEnd - blockSplits[b];
+    }
+
+    const size_t leftBegin = std::max(blockBegins[b], splitCol);
+    if (leftBegin < blockSplits[b])
+      wrongLeft.push_back(std::make_pair(leftBegin, blockSplits[b]));
+  }
+
+  if (numWrong == 0)
+    return splitCol;
+
+  // Swap the i-th points of both lists, in as many pieces as there are blocks.
+  for (size_t p = 0; p < numBlocks; ++p)
+  {
+#ifndef _WIN32
+    #pragma omp task default(shared) firstprivate(p)
+#endif
+    {
+      const size_t first = p * numWrong / numBlocks;
+      const size_t last = (p + 1) * numWrong / numBlocks;
+
+      // Find the position of the first point of the piece in both lists.
+      size_t r = 0, rightCol = first;
+      while (rightCol >= wrongRight[r].second - wrongRight[r].first)
+      {
+        rightCol -= wrongRight[r].second - wrongRight[r].first;
+        ++r;
+      }
+      rightCol += wrongRight[r].first;
+
+      size_t l = 0, leftCol = first;
+      while (leftCol >= wrongLeft[l].second - wrongLeft[l].first)
+      {
+        leftCol -= wrongLeft[l].second - wrongLeft[l].first;
+        ++l;
+      }
+      leftCol += wrongLeft[l].first;
+
+      for (size_t i = first; i < last; ++i)
+      {
+        if (rightCol == wrongRight[r].second)
+          rightCol = wrongRight[++r].first;
+        if (leftCol == wrongLeft[l].second)
+          leftCol = wrongLeft[++l].first;
+
+        data.swap_cols(rightCol, leftCol);
+        if (oldFromNew)
+          std::swap((*oldFromNew)[rightCol], (*oldFromNew)[leftCol]);
+
+        ++rightCol;
+        ++leftCol;
+      }
+    }
+  }
+#ifndef _WIN32
+  #pragma omp taskwait
+#endif
+
+  return splitCol;
+}
+
 } // namespace split
 } // namespace tree
 } // namespace mlpack
@@ -0,0 +1,58 @@
+/**
+ * @file permute_columns.hpp
+ *
+ * Reorder the columns of a matrix in place, following the cycles of a
+ * permutation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PERMUTE_COLUMNS_HPP
+#define MLPACK_CORE_TREE_PERMUTE_COLUMNS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Reorder the columns of the given matrix in place, so that column i holds the
+ * column that was at oldFromNew[i].  Each cycle of the permutation is followed
+ * with a buffer of one column, so no copy of the matrix is made.  This is used
+ * by the trees that do not rearrange the dataset while they are built, to store
+ * the points in the order of the tree afterwards.
+ *
+ * @param data Matrix to reorder.
+ * @param oldFromNew Old index of each column (a permutation of the indices of
+ *     the columns).
+ */
+template<typename MatType>
+void PermuteColumns(MatType& data, const std::vector<size_t>& oldFromNew)
+{
+  std::vector<bool> done(data.n_cols, false);
+  arma::Col<typename MatType::elem_type> buffer;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    if (done[i] || oldFromNew[i] == i)
+      continue;
+
+    // Shift the columns of the cycle that starts at column i.
+    buffer = data.col(i);
+    size_t j = i;
+    while (oldFromNew[j] != i)
+    {
+      data.col(j) = data.col(oldFromNew[j]);
+      done[j] = true;
+      j = oldFromNew[j];
+    }
+    data.col(j) = buffer;
+    done[j] = true;
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * @file bulk_load.hpp
+ *
+ * Definition of the BulkLoad tag, which selects the bulk-loading constructors
+ * of RectangleTree, and of the BulkLoadTraits class, which tells whether trees
+ * with a given split policy may be bulk-loaded.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_BULK_LOAD_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_BULK_LOAD_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Pass an instance of this class to the RectangleTree constructor to build the
+ * tree bottom-up with Sort-Tile-Recursive packing instead of inserting the
+ * points one by one:
+ *
+ * @code
+ * RTree<> tree(dataset, BulkLoad());
+ * @endcode
+ */
+struct BulkLoad { };
+
+/**
+ * The BulkLoadTraits class tells whether a RectangleTree with the given split
+ * policy may be bulk-loaded.  A packed tree satisfies the invariants of the
+ * R-tree, but not the stronger invariants of some variants (non-overlapping
+ * children, Hilbert ordering), so split policies must opt in by specializing
+ * this class.
+ */
+template<typename SplitType>
+struct BulkLoadTraits
+{
+  //! If true, the bulk-loading constructors may be used.
+  static const bool SupportsBulkLoad = false;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
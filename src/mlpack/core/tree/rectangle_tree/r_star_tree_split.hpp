@@ -14,6 +14,7 @@
 #define MLPACK_CORE_TREE_RECTANGLE_TREE_R_STAR_TREE_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "bulk_load.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -76,6 +77,13 @@ class RStarTreeSplit
   }
 };
 
+//! Trees built with RStarTreeSplit may be bulk-loaded.
+template<>
+struct BulkLoadTraits<RStarTreeSplit>
+{
+  static const bool SupportsBulkLoad = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -14,6 +14,7 @@
 #define MLPACK_CORE_TREE_RECTANGLE_TREE_R_TREE_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "bulk_load.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -80,6 +81,13 @@ class RTreeSplit
   static void InsertNodeIntoTree(TreeType* destTree, TreeType* srcNode);
 };
 
+//! Trees built with RTreeSplit may be bulk-loaded.
+template<>
+struct BulkLoadTraits<RTreeSplit>
+{
+  static const bool SupportsBulkLoad = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
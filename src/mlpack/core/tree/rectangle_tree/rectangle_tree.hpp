@@ -20,6 +20,7 @@
 #include "r_tree_split.hpp"
 #include "r_tree_descent_heuristic.hpp"
 #include "no_auxiliary_information.hpp"
+#include "bulk_load.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -156,6 +157,55 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a rectangle type tree using the given
+   * dataset, building the tree bottom-up with Sort-Tile-Recursive packing
+   * instead of inserting the points one by one.  The points are sorted and
+   * tiled into as few leaves as possible, and the leaves are then packed into
+   * the nodes of the level above in the same way, until the root is reached.
+   * Each node except the root is filled as evenly as possible up to its
+   * capacity, so nodes are at least half full; with OpenMP, the tiles are
+   * built in parallel.  Points may be inserted and deleted afterwards as
+   * usual.  This is only available for split policies that specialize
+   * BulkLoadTraits (the R tree, the R* tree and the X tree).
+   *
+   * @param data Dataset from which to create the tree.
+   * @param bulkLoad Instance of the BulkLoad tag.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(const MatType& data,
+                const BulkLoad bulkLoad,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
+  /**
+   * Construct this as the root node of a rectangle type tree using the given
+   * dataset, taking ownership of the dataset and building the tree bottom-up
+   * with Sort-Tile-Recursive packing.  See the constructor above.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param bulkLoad Instance of the BulkLoad tag.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(MatType&& data,
+                const BulkLoad bulkLoad,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -297,9 +347,11 @@ class RectangleTree
   RectangleTree* FindByBeginCount(size_t begin, size_t count);
 
   //! Return the bound object for this node.
-  const bound::HRectBound<MetricType>& Bound() const { return bound; }
+  const bound::HRectBound<metric::EuclideanDistance, ElemType>& Bound() const
+  { return bound; }
   //! Modify the bound object for this node.
-  bound::HRectBound<MetricType>& Bound() { return bound; }
+  bound::HRectBound<metric::EuclideanDistance, ElemType>& Bound()
+  { return bound; }
 
   //! Return the statistic object for this node.
   const StatisticType& Stat() const { return stat; }
@@ -350,7 +402,12 @@ class RectangleTree
   MetricType Metric() const { return MetricType(); }
 
   //! Get the centroid of the node and store it in the given vector.
-  void Center(arma::vec& center) { bound.Center(center); }
+  void Center(arma::vec& center)
+  {
+    arma::Col<ElemType> boundCenter;
+    bound.Center(boundCenter);
+    center = arma::conv_to<arma::vec>::from(boundCenter);
+  }
 
   //! Return the number of child nodes.  (One level beneath this one only.)
   size_t NumChildren() const { return numChildren; }
@@ -534,6 +591,20 @@ class RectangleTree
   //! Modify the number of points in this subset.
   size_t& Count() { return count; }
 
+  /**
+   * Reorder the points of the dataset in place into the order of the leaves of
+   * the tree (the order of Descendant()), so that the points of every node are
+   * contiguous columns and base cases read the dataset sequentially.  The
+   * points of the leaves are renumbered, and the old index of each point is
+   * stored in oldFromNew; points inserted later must use the new indices.  Only
+   * the root of a tree can be reordered; otherwise a std::invalid_argument is
+   * thrown.
+   *
+   * @param oldFromNew Vector which will be filled with the old positions for
+   *     each new point.
+   */
+  void ReorderDataset(std::vector<size_t>& oldFromNew);
+
  private:
   /**
    * Splits the current node, recursing up the tree.
@@ -542,6 +613,43 @@ class RectangleTree
    */
   void SplitNode(std::vector<bool>& relevels);
 
+  /**
+   * Build the tree bottom-up on all points of the dataset with
+   * Sort-Tile-Recursive packing.  This node must be empty.
+   */
+  void PackPoints();
+
+  //! Append the points of the leaves of this subtree to oldFromNew, in order.
+  void CollectPoints(std::vector<size_t>& oldFromNew) const;
+
+  //! Map the points of the leaves of this subtree to their new indices.
+  void RenumberPoints(const std::vector<size_t>& newFromOld);
+
+  /**
+   * Reorder the items of the groups [firstGroup, lastGroup) with
+   * Sort-Tile-Recursive tiling, so that each group holds items that are near
+   * each other.  Group g holds the items order[g * numItems / numGroups] to
+   * order[(g + 1) * numItems / numGroups - 1], so group sizes differ by at most
+   * one.  The items are sorted on dimension dim and cut into slabs, which are
+   * tiled recursively on the next dimensions.
+   *
+   * @param centers Matrix holding the coordinates of each item in a column.
+   * @param order Items (columns of centers) to reorder.
+   * @param numItems Total number of items.
+   * @param numGroups Total number of groups.
+   * @param firstGroup First group to tile.
+   * @param lastGroup One past the last group to tile.
+   * @param dim Dimension to sort on.
+   */
+  template<typename CentersType>
+  static void Tile(const CentersType& centers,
+                   std::vector<size_t>& order,
+                   const size_t numItems,
+                   const size_t numGroups,
+                   const size_t firstGroup,
+                   const size_t lastGroup,
+                   const size_t dim);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -595,7 +703,9 @@ class RectangleTree
    *      shrinking.
    * @return true if the bound needed to be changed, false if it did not.
    */
-  bool ShrinkBoundForBound(const bound::HRectBound<MetricType>& changedBound);
+  bool ShrinkBoundForBound(
+      const bound::HRectBound<metric::EuclideanDistance, ElemType>&
+          changedBound);
 
   /**
    * Make an exact copy of this node, pointers and everything.
@@ -14,6 +14,7 @@
 
 // In case it wasn't included already for some reason.
 #include "rectangle_tree.hpp"
+#include "../permute_columns.hpp"
 
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
@@ -101,6 +102,80 @@ RectangleTree(MatType&& data,
     root->InsertPoint(i);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(const MatType& data,
+              const BulkLoad /* bulkLoad */,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(data)),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  static_assert(BulkLoadTraits<SplitType>::SupportsBulkLoad,
+      "RectangleTree: this split policy does not support bulk loading.");
+
+  PackPoints();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(MatType&& data,
+              const BulkLoad /* bulkLoad */,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(std::move(data))),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  static_assert(BulkLoadTraits<SplitType>::SupportsBulkLoad,
+      "RectangleTree: this split policy does not support bulk loading.");
+
+  PackPoints();
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -893,6 +968,258 @@ void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
   }
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::ReorderDataset(
+    std::vector<size_t>& oldFromNew)
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("RectangleTree::ReorderDataset(): only the "
+        "root of a tree can reorder the dataset");
+  }
+
+  oldFromNew.clear();
+  oldFromNew.reserve(dataset->n_cols);
+  CollectPoints(oldFromNew);
+
+  // Points that were deleted from the tree keep their relative order after the
+  // points of the tree.
+  std::vector<size_t> newFromOld(dataset->n_cols, dataset->n_cols);
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    newFromOld[oldFromNew[i]] = i;
+  for (size_t i = 0; i < dataset->n_cols; ++i)
+  {
+    if (newFromOld[i] == dataset->n_cols)
+    {
+      newFromOld[i] = oldFromNew.size();
+      oldFromNew.push_back(i);
+    }
+  }
+
+  // The root always owns its dataset.
+  PermuteColumns(const_cast<MatType&>(*dataset), oldFromNew);
+  RenumberPoints(newFromOld);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::CollectPoints(
+    std::vector<size_t>& oldFromNew) const
+{
+  if (numChildren == 0)
+  {
+    for (size_t i = 0; i < count; ++i)
+      oldFromNew.push_back(points[i]);
+  }
+
+  for (size_t i = 0; i < numChildren; ++i)
+    children[i]->CollectPoints(oldFromNew);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::RenumberPoints(
+    const std::vector<size_t>& newFromOld)
+{
+  if (numChildren == 0)
+  {
+    for (size_t i = 0; i < count; ++i)
+      points[i] = newFromOld[points[i]];
+  }
+
+  for (size_t i = 0; i < numChildren; ++i)
+    children[i]->RenumberPoints(newFromOld);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::PackPoints()
+{
+  const size_t numPoints = dataset->n_cols;
+
+  // If all of the points fit in the root, it is a leaf.
+  if (numPoints <= maxLeafSize)
+  {
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+      points[count++] = i;
+      bound |= dataset->col(i);
+    }
+
+    numDescendants = count;
+    stat = StatisticType(*this);
+    return;
+  }
+
+  // Tile the points into as few leaves as possible.
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+
+  size_t numNodes = (numPoints + maxLeafSize - 1) / maxLeafSize;
+  Tile(*dataset, order, numPoints, numNodes, 0, numNodes, 0);
+
+  std::vector<RectangleTree*> nodes(numNodes);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+#ifdef _WIN32
+  #pragma omp parallel for
+  for (intmax_t g = 0; g < (intmax_t) numNodes; ++g)
+#else
+  #pragma omp parallel for
+  for (size_t g = 0; g < numNodes; ++g)
+#endif
+  {
+    // The parent is set when the level above is built.
+    RectangleTree* node = new RectangleTree(this);
+    for (size_t i = g * numPoints / numNodes;
+         i < (g + 1) * numPoints / numNodes; ++i)
+    {
+      node->points[node->count++] = order[i];
+      node->bound |= dataset->col(order[i]);
+    }
+
+    node->numDescendants = node->count;
+    nodes[g] = node;
+  }
+
+  // Now tile the nodes of each level (by the centers of their bounds) into the
+  // nodes of the level above, until they fit in the root.  The statistic of
+  // each node is built once its children are in place.
+  std::vector<RectangleTree*> parents;
+  arma::Mat<ElemType> centers;
+  arma::Col<ElemType> center;
+  while (nodes.size() > maxNumChildren)
+  {
+    const size_t numChildNodes = nodes.size();
+    numNodes = (numChildNodes + maxNumChildren - 1) / maxNumChildren;
+
+    centers.set_size(bound.Dim(), numChildNodes);
+    order.resize(numChildNodes);
+    for (size_t i = 0; i < numChildNodes; ++i)
+    {
+      nodes[i]->Bound().Center(center);
+      centers.col(i) = center;
+      order[i] = i;
+    }
+
+    Tile(centers, order, numChildNodes, numNodes, 0, numNodes, 0);
+
+    parents.resize(numNodes);
+#ifdef _WIN32
+    #pragma omp parallel for
+    for (intmax_t g = 0; g < (intmax_t) numNodes; ++g)
+#else
+    #pragma omp parallel for
+    for (size_t g = 0; g < numNodes; ++g)
+#endif
+    {
+      RectangleTree* node = new RectangleTree(this);
+      for (size_t i = g * numChildNodes / numNodes;
+           i < (g + 1) * numChildNodes / numNodes; ++i)
+      {
+        RectangleTree* child = nodes[order[i]];
+        child->parent = node;
+        child->stat = StatisticType(*child);
+        node->children[node->numChildren++] = child;
+        node->bound |= child->bound;
+        node->numDescendants += child->numDescendants;
+      }
+
+      parents[g] = node;
+    }
+
+    nodes.swap(parents);
+  }
+
+  // The remaining nodes are the children of the root.
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    nodes[i]->parent = this;
+    nodes[i]->stat = StatisticType(*nodes[i]);
+    children[numChildren++] = nodes[i];
+    bound |= nodes[i]->bound;
+    numDescendants += nodes[i]->numDescendants;
+  }
+
+  stat = StatisticType(*this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename CentersType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::Tile(const CentersType& centers,
+                                                   std::vector<size_t>& order,
+                                                   const size_t numItems,
+                                                   const size_t numGroups,
+                                                   const size_t firstGroup,
+                                                   const size_t lastGroup,
+                                                   const size_t dim)
+{
+  const size_t groups = lastGroup - firstGroup;
+  if (groups <= 1 || dim >= centers.n_rows)
+    return;
+
+  const size_t begin = firstGroup * numItems / numGroups;
+  const size_t end = lastGroup * numItems / numGroups;
+  std::sort(order.begin() + begin, order.begin() + end,
+      [&centers, dim](const size_t a, const size_t b)
+      {
+        return centers(dim, a) < centers(dim, b);
+      });
+
+  // On the last dimension, the sorted items are simply cut into groups.
+  const size_t remainingDims = centers.n_rows - dim;
+  if (remainingDims == 1)
+    return;
+
+  // Otherwise, cut them into slabs of whole groups and tile the slabs on the
+  // next dimension; the slabs of the first dimension are tiled in parallel.
+  const size_t numSlabs = std::min(groups, (size_t) std::ceil(
+      std::pow((double) groups, 1.0 / remainingDims)));
+
+#ifdef _WIN32
+  #pragma omp parallel for if (dim == 0)
+  for (intmax_t s = 0; s < (intmax_t) numSlabs; ++s)
+#else
+  #pragma omp parallel for if (dim == 0)
+  for (size_t s = 0; s < numSlabs; ++s)
+#endif
+  {
+    Tile(centers, order, numItems, numGroups,
+        firstGroup + s * groups / numSlabs,
+        firstGroup + (s + 1) * groups / numSlabs, dim + 1);
+  }
+}
+
 //! Default constructor for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
@@ -1211,7 +1538,8 @@ template<typename MetricType,
          template<typename> class AuxiliaryInformationType>
 bool RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
                    AuxiliaryInformationType>::
-    ShrinkBoundForBound(const bound::HRectBound<MetricType>& /* b */)
+    ShrinkBoundForBound(
+        const bound::HRectBound<metric::EuclideanDistance, ElemType>& /* b */)
 {
   // Using the sum is safe since none of the dimensions can increase.
   ElemType sum = 0;
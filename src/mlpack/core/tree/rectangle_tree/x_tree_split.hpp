@@ -16,6 +16,7 @@
 #define MLPACK_CORE_TREE_RECTANGLE_TREE_X_TREE_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "bulk_load.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -70,6 +71,13 @@ class XTreeSplit
   }
 };
 
+//! Trees built with XTreeSplit may be bulk-loaded.
+template<>
+struct BulkLoadTraits<XTreeSplit>
+{
+  static const bool SupportsBulkLoad = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
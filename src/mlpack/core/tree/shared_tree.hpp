@@ -0,0 +1,184 @@
+/**
+ * @file shared_tree.hpp
+ *
+ * A reference-counted handle to a tree that is built once and then searched,
+ * without being copied, by several search models at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SHARED_TREE_HPP
+#define MLPACK_CORE_TREE_SHARED_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/tree_traits.hpp>
+
+#include <memory>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A SharedTree holds a tree and the permutation of its dataset, both built
+ * once and stored once, and can be given to any number of search models:
+ * NeighborSearch, RangeSearch, KDE and DBSCAN all have constructors (or
+ * Cluster() overloads) that take a SharedTree and use its tree without copying
+ * or rebuilding it.  Copies of a SharedTree share the same tree, which is freed
+ * when the last copy and the last model using it are destroyed.
+ *
+ * The tree is never modified once built, so the models that share it can
+ * search it concurrently from different threads.  This holds because the only
+ * writes that searches make to a reference tree are the distances cached in
+ * the statistics of trees with self-children (cover trees), which can't be
+ * shared, and the bounds of the query tree of a monochromatic dual-tree
+ * nearest neighbor search, which NeighborSearch runs single-tree on a shared
+ * tree instead.
+ *
+ * Different methods use different tree statistics, so the tree type must be
+ * the same for all the models that share it.  NeighborSearchStat holds
+ * everything that RangeSearch needs, and KDE needs no statistic, so a
+ * RangeSearch (and a DBSCAN) or a KDE can share the tree of a NeighborSearch
+ * with their StatisticType parameter:
+ *
+ * @code
+ * typedef NeighborSearch<NearestNeighborSort> KNNType;
+ * typedef RangeSearch<EuclideanDistance, arma::mat, KDTree,
+ *     NeighborSearchStat<NearestNeighborSort>> RangeType;
+ *
+ * SharedTree<KNNType::Tree> tree(std::move(data));
+ * KNNType knn(tree);
+ * RangeType range(tree);
+ * DBSCAN<RangeType> dbscan(0.5, 5);
+ *
+ * knn.Search(queries, 5, neighbors, distances);
+ * tree.MapNeighbors(neighbors);
+ * dbscan.Cluster(tree, assignments);
+ * @endcode
+ *
+ * As with the other constructors that take a tree, the results of the models
+ * that share a tree refer to the reference points in the order of the tree;
+ * MapNeighbors() and MapMonochromatic() map them back to the original order.
+ *
+ * @tparam TreeType Type of the tree to share.
+ */
+template<typename TreeType>
+class SharedTree
+{
+  static_assert(!TreeTraits<TreeType>::HasSelfChildren, "SharedTree: trees "
+      "with self-children cache distances in their statistics during "
+      "searches, so they can't be shared.");
+
+ public:
+  //! The type of the dataset.
+  typedef typename TreeType::Mat MatType;
+
+  /**
+   * Build the tree on a copy of the given dataset.
+   *
+   * @param dataset Dataset to build the tree on.
+   */
+  SharedTree(const MatType& dataset);
+
+  /**
+   * Build the tree on the given dataset, which is taken over.
+   *
+   * @param dataset Dataset to build the tree on.
+   */
+  SharedTree(MatType&& dataset);
+
+  /**
+   * Share the given tree, which is taken over, with the given permutation of
+   * its dataset (empty if the tree does not rearrange its dataset).
+   *
+   * @param tree Tree to share.
+   * @param oldFromNew Original index of each point of the tree's dataset.
+   */
+  SharedTree(TreeType&& tree,
+             std::vector<size_t>&& oldFromNew = std::vector<size_t>());
+
+  //! Get the tree.
+  const TreeType& Tree() const { return *tree; }
+  //! Get the tree, as shared with the models.
+  const std::shared_ptr<const TreeType>& TreePointer() const { return tree; }
+  //! Get the dataset, in the order of the tree.
+  const MatType& Dataset() const { return tree->Dataset(); }
+  //! Get the original index of each point of the dataset (empty if the tree
+  //! does not rearrange its dataset).
+  const std::vector<size_t>& OldFromNew() const { return *oldFromNew; }
+  //! Get the number of handles and models that share the tree.
+  long UseCount() const { return tree.use_count(); }
+
+  /**
+   * Map the indices of reference points in the given results of a search of
+   * the tree back to their original indices.
+   *
+   * @param neighbors Results of NeighborSearch::Search().
+   */
+  void MapNeighbors(arma::Mat<size_t>& neighbors) const;
+
+  /**
+   * Map the indices of reference points in the given results of a search of
+   * the tree back to their original indices.
+   *
+   * @param neighbors Results of RangeSearch::Search().
+   */
+  void MapNeighbors(std::vector<std::vector<size_t>>& neighbors) const;
+
+  /**
+   * Map the results of a monochromatic search of the tree, whose columns are
+   * also in the order of the tree, back to the original order.
+   *
+   * @param neighbors Neighbors of each point.
+   * @param distances Distances of the neighbors of each point.
+   */
+  void MapMonochromatic(arma::Mat<size_t>& neighbors,
+                        arma::mat& distances) const;
+
+  /**
+   * Map the results of a monochromatic range search of the tree, whose
+   * entries are also in the order of the tree, back to the original order.
+   *
+   * @param neighbors Neighbors of each point.
+   * @param distances Distances of the neighbors of each point.
+   */
+  void MapMonochromatic(std::vector<std::vector<size_t>>& neighbors,
+                        std::vector<std::vector<double>>& distances) const;
+
+ private:
+  //! The shared tree.
+  std::shared_ptr<const TreeType> tree;
+  //! The shared permutation of the dataset.
+  std::shared_ptr<const std::vector<size_t>> oldFromNew;
+
+  //! Build a tree that rearranges its dataset.
+  template<typename DataType>
+  static TreeType* BuildTree(
+      DataType&& dataset,
+      std::vector<size_t>& oldFromNew,
+      const typename std::enable_if_t<
+          TreeTraits<TreeType>::RearrangesDataset>* = 0)
+  {
+    return new TreeType(std::forward<DataType>(dataset), oldFromNew);
+  }
+
+  //! Build a tree that does not rearrange its dataset.
+  template<typename DataType>
+  static TreeType* BuildTree(
+      DataType&& dataset,
+      std::vector<size_t>& /* oldFromNew */,
+      const typename std::enable_if_t<
+          !TreeTraits<TreeType>::RearrangesDataset>* = 0)
+  {
+    return new TreeType(std::forward<DataType>(dataset));
+  }
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "shared_tree_impl.hpp"
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file shared_tree_impl.hpp
+ *
+ * Implementation of the SharedTree class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SHARED_TREE_IMPL_HPP
+#define MLPACK_CORE_TREE_SHARED_TREE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "shared_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType>
+SharedTree<TreeType>::SharedTree(const MatType& dataset)
+{
+  std::vector<size_t>* permutation = new std::vector<size_t>();
+  oldFromNew.reset(permutation);
+  tree.reset(BuildTree(dataset, *permutation));
+}
+
+template<typename TreeType>
+SharedTree<TreeType>::SharedTree(MatType&& dataset)
+{
+  std::vector<size_t>* permutation = new std::vector<size_t>();
+  oldFromNew.reset(permutation);
+  tree.reset(BuildTree(std::move(dataset), *permutation));
+}
+
+template<typename TreeType>
+SharedTree<TreeType>::SharedTree(TreeType&& tree,
+                                 std::vector<size_t>&& oldFromNew) :
+    tree(new TreeType(std::move(tree))),
+    oldFromNew(new std::vector<size_t>(std::move(oldFromNew)))
+{
+  if (!this->oldFromNew->empty() &&
+      this->oldFromNew->size() != this->tree->Dataset().n_cols)
+  {
+    std::ostringstream oss;
+    oss << "SharedTree::SharedTree(): the permutation has "
+        << this->oldFromNew->size() << " indices, but the tree has "
+        << this->tree->Dataset().n_cols << " points";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename TreeType>
+void SharedTree<TreeType>::MapNeighbors(arma::Mat<size_t>& neighbors) const
+{
+  if (oldFromNew->empty())
+    return;
+
+  // Missing neighbors (SIZE_MAX, or past the end) are left as they are.
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+    if (neighbors[i] < oldFromNew->size())
+      neighbors[i] = (*oldFromNew)[neighbors[i]];
+}
+
+template<typename TreeType>
+void SharedTree<TreeType>::MapNeighbors(
+    std::vector<std::vector<size_t>>& neighbors) const
+{
+  if (oldFromNew->empty())
+    return;
+
+  for (size_t i = 0; i < neighbors.size(); ++i)
+    for (size_t j = 0; j < neighbors[i].size(); ++j)
+      neighbors[i][j] = (*oldFromNew)[neighbors[i][j]];
+}
+
+template<typename TreeType>
+void SharedTree<TreeType>::MapMonochromatic(arma::Mat<size_t>& neighbors,
+                                            arma::mat& distances) const
+{
+  if (oldFromNew->empty())
+    return;
+
+  MapNeighbors(neighbors);
+  arma::Mat<size_t> mappedNeighbors(neighbors.n_rows, neighbors.n_cols);
+  arma::mat mappedDistances(distances.n_rows, distances.n_cols);
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+  {
+    mappedNeighbors.col((*oldFromNew)[i]) = neighbors.col(i);
+    mappedDistances.col((*oldFromNew)[i]) = distances.col(i);
+  }
+
+  neighbors = std::move(mappedNeighbors);
+  distances = std::move(mappedDistances);
+}
+
+template<typename TreeType>
+void SharedTree<TreeType>::MapMonochromatic(
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances) const
+{
+  if (oldFromNew->empty())
+    return;
+
+  MapNeighbors(neighbors);
+  std::vector<std::vector<size_t>> mappedNeighbors(neighbors.size());
+  std::vector<std::vector<double>> mappedDistances(distances.size());
+  for (size_t i = 0; i < neighbors.size(); ++i)
+  {
+    mappedNeighbors[(*oldFromNew)[i]] = std::move(neighbors[i]);
+    mappedDistances[(*oldFromNew)[i]] = std::move(distances[i]);
+  }
+
+  neighbors = std::move(mappedNeighbors);
+  distances = std::move(mappedDistances);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
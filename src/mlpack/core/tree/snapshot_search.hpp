@@ -0,0 +1,188 @@
+/**
+ * @file snapshot_search.hpp
+ *
+ * A search model on a tree that is updated with Insert() and Delete() while
+ * readers search published snapshots of it, without any lock between them.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SNAPSHOT_SEARCH_HPP
+#define MLPACK_CORE_TREE_SNAPSHOT_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <memory>
+#include <mutex>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * SnapshotSearch keeps a search model (NeighborSearch or RangeSearch) up to
+ * date with a tree that supports InsertPoint() and DeletePoint(), such as the
+ * RectangleTree types, while other threads search it.  Writers change a
+ * working tree that no reader sees; Publish() copies the working tree into a
+ * new snapshot and swaps it in atomically.  A reader calls Read(), which
+ * returns the current snapshot, so it sees a consistent tree for as long as it
+ * holds it, whatever the writers do in the meantime.  The last reader of an
+ * old snapshot frees it, so snapshots are reclaimed without any epoch
+ * bookkeeping by the writers.
+ *
+ * The search rules cache distances in the statistics of the tree they search,
+ * so two threads can't search the same tree at once.  Each snapshot therefore
+ * holds a pool of search models, each with its own copy of the snapshot's
+ * tree: Read() takes an idle model (making one, if all are busy) and the
+ * Reader returns it when it is destroyed.  A snapshot costs one copy of the
+ * tree for each reader that searches it concurrently (plus one for Publish()),
+ * so writes should be published in batches.
+ *
+ * @code
+ * typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+ *     RStarTree> KNNType;
+ * SnapshotSearch<KNNType> index(std::move(data));
+ *
+ * // Any number of reader threads.
+ * SnapshotSearch<KNNType>::Reader reader = index.Read();
+ * reader.Search().Search(queries, k, neighbors, distances);
+ *
+ * // The writer thread.
+ * index.Insert(point);
+ * index.Delete(oldPoint);
+ * index.Publish();
+ * @endcode
+ *
+ * Only the writer calls Insert(), Delete() and Publish(); concurrent writers
+ * are serialized by a lock that readers never take.
+ *
+ * @tparam SearchType Type of search model; it must define the tree type Tree
+ *     and be constructible from a Tree&& (as NeighborSearch and RangeSearch
+ *     are).
+ */
+template<typename SearchType>
+class SnapshotSearch
+{
+ public:
+  //! The type of tree searched by the search models.
+  typedef typename SearchType::Tree Tree;
+
+ private:
+  //! A published version of the tree, with its pool of search models.
+  struct Snapshot
+  {
+    //! Copy the given tree.
+    Snapshot(const Tree& tree, const size_t version) :
+        tree(tree), version(version) { }
+
+    //! The tree of the snapshot, which is only ever copied.
+    const Tree tree;
+    //! The number of Publish() calls before this snapshot.
+    size_t version;
+    //! Lock of the pool of idle search models.
+    std::mutex poolLock;
+    //! The idle search models on copies of the tree.
+    std::vector<std::unique_ptr<SearchType>> pool;
+  };
+
+ public:
+  /**
+   * A handle on a snapshot, with a search model that only this reader uses.
+   * The search model is returned to the snapshot when the reader is
+   * destroyed.
+   */
+  class Reader
+  {
+   public:
+    //! Take a search model from the pool of the given snapshot.
+    Reader(std::shared_ptr<Snapshot> snapshot);
+
+    //! Take over the other reader.
+    Reader(Reader&& other) = default;
+
+    //! Readers are not copyable.
+    Reader(const Reader& other) = delete;
+    //! Readers are not copyable.
+    Reader& operator=(const Reader& other) = delete;
+
+    //! Return the search model to the pool of the snapshot.
+    ~Reader();
+
+    //! Get the search model of this reader.
+    SearchType& Search() { return *search; }
+
+    //! Get the version of the snapshot (the number of Publish() calls before
+    //! it).
+    size_t Version() const { return snapshot->version; }
+
+   private:
+    //! The snapshot.
+    std::shared_ptr<Snapshot> snapshot;
+    //! The search model of this reader.
+    std::unique_ptr<SearchType> search;
+  };
+
+  /**
+   * Build the working tree on the given dataset, and publish it as the first
+   * snapshot.
+   *
+   * @param data Dataset to build the tree on.
+   */
+  SnapshotSearch(typename Tree::Mat data);
+
+  /**
+   * Get a reader of the current snapshot.  This never waits for a writer.
+   */
+  Reader Read() const;
+
+  /**
+   * Add the given point to the working tree; it is seen by readers after the
+   * next Publish().
+   *
+   * @param point Point to insert.
+   * @return The index of the point in the dataset.
+   */
+  size_t Insert(const arma::vec& point);
+
+  /**
+   * Remove the point with the given index from the working tree; readers stop
+   * seeing it after the next Publish().  The point stays in the dataset, so
+   * the indices of the other points don't change.
+   *
+   * @param index Index of the point in the dataset.
+   * @return Whether the point was in the tree.
+   */
+  bool Delete(const size_t index);
+
+  /**
+   * Make the working tree the current snapshot.  Readers that hold the
+   * previous snapshot keep seeing it until they are destroyed.
+   */
+  void Publish();
+
+  //! Get the number of Publish() calls.
+  size_t Version() const;
+
+  //! Get the number of points in the working tree.
+  size_t NumPoints() const;
+
+ private:
+  //! The tree that the writers change.
+  Tree working;
+  //! The number of Publish() calls.
+  size_t version;
+  //! The current snapshot; it is only accessed with std::atomic_load() and
+  //! std::atomic_store().
+  std::shared_ptr<Snapshot> current;
+  //! Lock that serializes the writers.
+  mutable std::mutex writerLock;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "snapshot_search_impl.hpp"
+
+#endif
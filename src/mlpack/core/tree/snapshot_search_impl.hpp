@@ -0,0 +1,121 @@
+/**
+ * @file snapshot_search_impl.hpp
+ *
+ * Implementation of the SnapshotSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SNAPSHOT_SEARCH_IMPL_HPP
+#define MLPACK_CORE_TREE_SNAPSHOT_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "snapshot_search.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename SearchType>
+SnapshotSearch<SearchType>::Reader::Reader(std::shared_ptr<Snapshot> snapshot) :
+    snapshot(std::move(snapshot))
+{
+  {
+    std::lock_guard<std::mutex> lock(this->snapshot->poolLock);
+    if (!this->snapshot->pool.empty())
+    {
+      search = std::move(this->snapshot->pool.back());
+      this->snapshot->pool.pop_back();
+    }
+  }
+
+  // All of the search models are busy, so make one on a new copy of the tree.
+  if (!search)
+    search.reset(new SearchType(Tree(this->snapshot->tree)));
+}
+
+template<typename SearchType>
+SnapshotSearch<SearchType>::Reader::~Reader()
+{
+  // A reader that was moved from has nothing to return.
+  if (!snapshot || !search)
+    return;
+
+  std::lock_guard<std::mutex> lock(snapshot->poolLock);
+  snapshot->pool.push_back(std::move(search));
+}
+
+template<typename SearchType>
+SnapshotSearch<SearchType>::SnapshotSearch(typename Tree::Mat data) :
+    working(std::move(data)),
+    version(0),
+    current(std::make_shared<Snapshot>(working, 0))
+{
+  // Nothing else to do.
+}
+
+template<typename SearchType>
+typename SnapshotSearch<SearchType>::Reader
+SnapshotSearch<SearchType>::Read() const
+{
+  return Reader(std::atomic_load(&current));
+}
+
+template<typename SearchType>
+size_t SnapshotSearch<SearchType>::Insert(const arma::vec& point)
+{
+  std::lock_guard<std::mutex> lock(writerLock);
+  if (point.n_elem != working.Dataset().n_rows)
+  {
+    std::ostringstream oss;
+    oss << "SnapshotSearch::Insert(): point has dimensionality "
+        << point.n_elem << ", but the dataset has dimensionality "
+        << working.Dataset().n_rows;
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t index = working.Dataset().n_cols;
+  working.Dataset().insert_cols(index, point);
+  working.InsertPoint(index);
+  return index;
+}
+
+template<typename SearchType>
+bool SnapshotSearch<SearchType>::Delete(const size_t index)
+{
+  std::lock_guard<std::mutex> lock(writerLock);
+  if (index >= working.Dataset().n_cols)
+    return false;
+
+  return working.DeletePoint(index);
+}
+
+template<typename SearchType>
+void SnapshotSearch<SearchType>::Publish()
+{
+  std::lock_guard<std::mutex> lock(writerLock);
+  std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>(working,
+      version + 1);
+  ++version;
+  std::atomic_store(&current, std::move(snapshot));
+}
+
+template<typename SearchType>
+size_t SnapshotSearch<SearchType>::Version() const
+{
+  std::lock_guard<std::mutex> lock(writerLock);
+  return version;
+}
+
+template<typename SearchType>
+size_t SnapshotSearch<SearchType>::NumPoints() const
+{
+  std::lock_guard<std::mutex> lock(writerLock);
+  return working.NumDescendants();
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -90,9 +90,14 @@ class SpillTree
   //! The number of points of the dataset contained in this node (and its
   //! children).
   size_t count;
-  //! The list of indexes of points contained in this node (non-null for
-  //! leaf nodes).
-  arma::Col<size_t>* pointsIndex;
+  //! The indexes of the points held in the leaves of the tree, in depth-first
+  //! order, so that the descendants of every node are contiguous.  This arena
+  //! is shared by all the nodes and owned by the root.  While the tree is being
+  //! built, each leaf holds its own list of points here instead, and internal
+  //! nodes hold NULL.
+  arma::Col<size_t>* indices;
+  //! The position of the first descendant of this node in indices.
+  size_t begin;
   //! Flag to distinguish overlapping nodes from non-overlapping nodes.
   bool overlappingNode;
   //! Splitting hyperplane represented by this node.
@@ -148,7 +153,8 @@ class SpillTree
   /**
    * Construct this as the root node of a hybrid spill tree using the given
    * dataset.  The dataset will not be modified during the building procedure
-   * (unlike BinarySpaceTree).
+   * (unlike BinarySpaceTree).  The subtrees of large nodes are built in
+   * parallel if OpenMP is available.
    *
    * @param data Dataset to create tree from.
    * @param tau Overlapping size.
@@ -164,7 +170,8 @@ class SpillTree
    * Construct this as the root node of a hybrid spill tree using the given
    * dataset.  This will take ownership of the data matrix; if you don't want
    * this, consider using the constructor that takes a const reference to a
-   * dataset.
+   * dataset.  The subtrees of large nodes are built in parallel if OpenMP is
+   * available.
    *
    * @param data Dataset to create tree from.
    * @param tau Overlapping size.
@@ -452,6 +459,27 @@ class SpillTree
                    const arma::Col<size_t>& points,
                    arma::Col<size_t>& leftPoints,
                    arma::Col<size_t>& rightPoints);
+
+  /**
+   * Move the lists of points of the leaves of a newly built (or loaded) tree
+   * into one arena owned by this node, which must be the root, and make every
+   * node of the tree refer to it.
+   */
+  void CompactIndices();
+
+  /**
+   * Copy the points of the leaves below this node into the given arena,
+   * starting at the given position (which is advanced past them), and free the
+   * lists of points of the leaves.
+   */
+  void GatherIndices(arma::Col<size_t>& arena, size_t& position);
+
+  //! Return whether this node owns indices (that is, whether it is the root or
+  //! a leaf of a tree that is still being built).
+  bool OwnsIndices() const
+  {
+    return indices != (parent ? parent->indices : NULL);
+  }
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -475,6 +503,43 @@ class SpillTree
 } // namespace tree
 } // namespace mlpack
 
+//! Set the serialization version of the SpillTree class, both for trees and
+//! pointers to trees.  Version 1 stores the indexes of the points of all leaves
+//! in one shared arena.
+namespace boost {
+namespace serialization {
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename HyperplaneMetricType> class HyperplaneType,
+         template<typename SplitMetricType, typename SplitMatType>
+             class SplitType>
+struct version<mlpack::data::SecondShim<mlpack::tree::SpillTree<
+    MetricType, StatisticType, MatType, HyperplaneType, SplitType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename HyperplaneMetricType> class HyperplaneType,
+         template<typename SplitMetricType, typename SplitMatType>
+             class SplitType>
+struct version<mlpack::data::PointerShim<mlpack::tree::SpillTree<
+    MetricType, StatisticType, MatType, HyperplaneType, SplitType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "spill_tree_impl.hpp"
 
@@ -35,7 +35,8 @@ SpillTree(
     right(NULL),
     parent(NULL),
     count(0),
-    pointsIndex(NULL),
+    indices(NULL),
+    begin(0),
     overlappingNode(false),
     hyperplane(),
     bound(data.n_rows),
@@ -49,8 +50,16 @@ SpillTree(
     points = arma::linspace<arma::Col<size_t>>(0, dataset->n_cols - 1,
         dataset->n_cols);
 
-  // Do the actual splitting of this node.
-  SplitNode(points, maxLeafSize, tau, rho);
+  // Do the actual splitting of this node.  The subtrees of large nodes are
+  // built as OpenMP tasks, so the splitting starts in a parallel region.
+  #pragma omp parallel if (points.n_elem >= 4096)
+  {
+    #pragma omp single
+    SplitNode(points, maxLeafSize, tau, rho);
+  }
+
+  // Put the points of all the leaves in one arena.
+  CompactIndices();
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -72,7 +81,8 @@ SpillTree(
     right(NULL),
     parent(NULL),
     count(0),
-    pointsIndex(NULL),
+    indices(NULL),
+    begin(0),
     overlappingNode(false),
     hyperplane(),
     bound(data.n_rows),
@@ -86,8 +96,16 @@ SpillTree(
     points = arma::linspace<arma::Col<size_t>>(0, dataset->n_cols - 1,
         dataset->n_cols);
 
-  // Do the actual splitting of this node.
-  SplitNode(points, maxLeafSize, tau, rho);
+  // Do the actual splitting of this node.  The subtrees of large nodes are
+  // built as OpenMP tasks, so the splitting starts in a parallel region.
+  #pragma omp parallel if (points.n_elem >= 4096)
+  {
+    #pragma omp single
+    SplitNode(points, maxLeafSize, tau, rho);
+  }
+
+  // Put the points of all the leaves in one arena.
+  CompactIndices();
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -110,7 +128,8 @@ SpillTree(
     right(NULL),
     parent(parent),
     count(0),
-    pointsIndex(NULL),
+    indices(NULL),
+    begin(0),
     overlappingNode(false),
     hyperplane(),
     bound(parent->Dataset().n_rows),
@@ -140,7 +159,10 @@ SpillTree(const SpillTree& other) :
     right(NULL),
     parent(other.parent),
     count(other.count),
-    pointsIndex(NULL),
+    // Copy the arena of point indexes, but only if we are the root.
+    indices((other.parent == NULL && other.indices) ?
+        new arma::Col<size_t>(*other.indices) : other.indices),
+    begin(other.begin),
     overlappingNode(other.overlappingNode),
     hyperplane(other.hyperplane),
     bound(other.bound),
@@ -166,12 +188,9 @@ SpillTree(const SpillTree& other) :
     right->Parent() = this; // Set parent to this, not other tree.
   }
 
-  // If vector of indexes, copy it.
-  if (other.pointsIndex)
-    pointsIndex = new arma::Col<size_t>(*other.pointsIndex);
-
-  // Propagate matrix, but only if we are the root.
-  if (parent == NULL && localDataset)
+  // Propagate the arena of point indexes and the matrix, but only if we are the
+  // root.
+  if (parent == NULL)
   {
     std::queue<SpillTree*> queue;
     if (left)
@@ -183,7 +202,9 @@ SpillTree(const SpillTree& other) :
       SpillTree* node = queue.front();
       queue.pop();
 
-      node->dataset = dataset;
+      node->indices = indices;
+      if (localDataset)
+        node->dataset = dataset;
       if (node->left)
         queue.push(node->left);
       if (node->right)
@@ -207,7 +228,8 @@ SpillTree(SpillTree&& other) :
     right(other.right),
     parent(other.parent),
     count(other.count),
-    pointsIndex(other.pointsIndex),
+    indices(other.indices),
+    begin(other.begin),
     overlappingNode(other.overlappingNode),
     hyperplane(other.hyperplane),
     bound(std::move(other.bound)),
@@ -223,7 +245,8 @@ SpillTree(SpillTree&& other) :
   other.left = NULL;
   other.right = NULL;
   other.count = 0;
-  other.pointsIndex = NULL;
+  other.indices = NULL;
+  other.begin = 0;
   other.parentDistance = 0.0;
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
@@ -274,7 +297,8 @@ SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
 {
   delete left;
   delete right;
-  delete pointsIndex;
+  if (OwnsIndices())
+    delete indices;
 
   // If we're the root and we own the dataset, delete it.
   if (!parent && localDataset)
@@ -538,8 +562,10 @@ template<typename MetricType,
 inline size_t SpillTree<MetricType, StatisticType, MatType, HyperplaneType,
     SplitType>::Descendant(const size_t index) const
 {
-  if (IsLeaf())
-    return (*pointsIndex)[index];
+  // Once the tree is built, the descendants of every node are contiguous in
+  // the arena.
+  if (indices)
+    return (*indices)[begin + index];
   size_t num = left->NumDescendants();
   if (index < num)
     return left->Descendant(index);
@@ -562,7 +588,7 @@ inline size_t SpillTree<MetricType, StatisticType, MatType, HyperplaneType,
     SplitType>::Point(const size_t index) const
 {
   if (IsLeaf())
-    return (*pointsIndex)[index];
+    return (*indices)[begin + index];
   // This should never happen.
   return (size_t() - 1);
 }
@@ -589,9 +615,9 @@ void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
   // Now, check if we need to split at all.
   if (points.n_elem <= maxLeafSize)
   {
-    pointsIndex = new arma::Col<size_t>();
-    pointsIndex->swap(points);
-    count = pointsIndex->n_elem;
+    indices = new arma::Col<size_t>();
+    indices->swap(points);
+    count = indices->n_elem;
     return; // We can't split this.
   }
 
@@ -601,9 +627,9 @@ void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
   // same, we can't split them.
   if (!split)
   {
-    pointsIndex = new arma::Col<size_t>();
-    pointsIndex->swap(points);
-    count = pointsIndex->n_elem;
+    indices = new arma::Col<size_t>();
+    indices->swap(points);
+    count = indices->n_elem;
     return; // We can't split this.
   }
 
@@ -615,9 +641,18 @@ void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
   arma::Col<size_t>().swap(points);
 
   // Now we will recursively split the children by calling their constructors
-  // (which perform this splitting process).
+  // (which perform this splitting process).  The left child of a large node is
+  // built as a separate task.  Visual Studio only implements OpenMP 2.0, which
+  // has no tasks, so there the children are built one after the other.
+#ifdef _WIN32
+  left = new SpillTree(this, leftPoints, tau, maxLeafSize, rho);
+  right = new SpillTree(this, rightPoints, tau, maxLeafSize, rho);
+#else
+  #pragma omp task default(shared) if (leftPoints.n_elem >= 4096)
   left = new SpillTree(this, leftPoints, tau, maxLeafSize, rho);
   right = new SpillTree(this, rightPoints, tau, maxLeafSize, rho);
+  #pragma omp taskwait
+#endif
 
   // Update count number, to represent the number of descendant points.
   count = left->NumDescendants() + right->NumDescendants();
@@ -710,6 +745,60 @@ bool SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
   return false;
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename HyperplaneMetricType> class HyperplaneType,
+         template<typename SplitMetricType, typename SplitMatType>
+             class SplitType>
+void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
+    CompactIndices()
+{
+  // The count of the root is the total number of points in the leaves.
+  arma::Col<size_t>* arena = new arma::Col<size_t>(count);
+  size_t position = 0;
+  GatherIndices(*arena, position);
+
+  std::queue<SpillTree*> queue;
+  queue.push(this);
+  while (!queue.empty())
+  {
+    SpillTree* node = queue.front();
+    queue.pop();
+
+    node->indices = arena;
+    if (node->left)
+      queue.push(node->left);
+    if (node->right)
+      queue.push(node->right);
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename HyperplaneMetricType> class HyperplaneType,
+         template<typename SplitMetricType, typename SplitMatType>
+             class SplitType>
+void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
+    GatherIndices(arma::Col<size_t>& arena, size_t& position)
+{
+  begin = position;
+  if (IsLeaf())
+  {
+    if (count > 0)
+      arena.subvec(position, position + count - 1) = *indices;
+    position += count;
+
+    delete indices;
+    indices = NULL;
+    return;
+  }
+
+  left->GatherIndices(arena, position);
+  right->GatherIndices(arena, position);
+}
+
 // Default constructor (private), for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
@@ -723,7 +812,8 @@ SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
     right(NULL),
     parent(NULL),
     count(0),
-    pointsIndex(NULL),
+    indices(NULL),
+    begin(0),
     overlappingNode(false),
     stat(*this),
     parentDistance(0),
@@ -745,7 +835,7 @@ template<typename MetricType,
              class SplitType>
 template<typename Archive>
 void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
-    Serialize(Archive& ar, const unsigned int /* version */)
+    Serialize(Archive& ar, const unsigned int version)
 {
   using data::CreateNVP;
 
@@ -758,11 +848,26 @@ void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
       delete right;
     if (!parent && localDataset)
       delete dataset;
+    if (OwnsIndices())
+      delete indices;
+    indices = NULL;
   }
 
   ar & CreateNVP(parent, "parent");
   ar & CreateNVP(count, "count");
-  ar & CreateNVP(pointsIndex, "pointsIndex");
+
+  // Older versions of SpillTree stored a list of points in each leaf; these
+  // are moved into one arena once the whole tree is loaded.
+  if (version == 0)
+  {
+    ar & CreateNVP(indices, "pointsIndex");
+    begin = 0;
+  }
+  else
+  {
+    ar & CreateNVP(begin, "begin");
+    ar & CreateNVP(indices, "indices");
+  }
   ar & CreateNVP(overlappingNode, "overlappingNode");
   ar & CreateNVP(hyperplane, "hyperplane");
   ar & CreateNVP(bound, "bound");
@@ -816,6 +921,9 @@ void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
       rightParent->Right() = NULL;
       delete rightParent;
     }
+
+    if (version == 0 && parent == NULL)
+      CompactIndices();
   }
 }
 
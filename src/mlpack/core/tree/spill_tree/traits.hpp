@@ -40,6 +40,11 @@ class TreeTraits<SpillTree<MetricType, StatisticType, MatType, HyperplaneType,
    */
   static const bool HasOverlappingChildren = true;
 
+  /**
+   * Points in the overlap of two children are held by both of them.
+   */
+  static const bool HasDuplicatedPoints = true;
+
   /**
    * There is no guarantee that the first point in a node is its centroid.
    */
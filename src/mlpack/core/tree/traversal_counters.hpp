@@ -0,0 +1,192 @@
+/**
+ * @file traversal_counters.hpp
+ *
+ * Counters that a traverser can keep while it traverses a tree: the number of
+ * Score() calls, the number of prunes at each depth of the traversal, the
+ * number of base cases, and the number of Rescore() calls (and how many of
+ * those pruned a node that Score() did not prune).
+ *
+ * Which counters a traverser keeps is chosen by the rules it is given: if the
+ * RuleType class has a typedef TraversalCountersType, the traverser holds an
+ * object of that type; otherwise it holds a NoTraversalCounters object, whose
+ * functions do nothing, so that the counters cost nothing.  For instance,
+ *
+ * @code
+ * class CountingRules : public NeighborSearchRules<...>
+ * {
+ *  public:
+ *   typedef tree::TraversalCounters TraversalCountersType;
+ *   ...
+ * };
+ * @endcode
+ *
+ * makes the traversers count, and the counts can then be obtained after the
+ * traversal with the Counters() function of the traverser.  This is useful to
+ * choose the leaf size and the tree type for a given dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_TRAVERSAL_COUNTERS_HPP
+#define MLPACK_CORE_TREE_TRAVERSAL_COUNTERS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <numeric>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Counters that are updated by a traverser.  The depth of a node combination
+ * is the number of recursions that were needed to reach it; the root
+ * combination has depth 0.
+ */
+class TraversalCounters
+{
+ public:
+  //! Create the counters, with all counts set to zero.
+  TraversalCounters() :
+      depth(0),
+      numScores(0),
+      numBaseCases(0),
+      numRescores(0),
+      numRescorePrunes(0)
+  { /* Nothing to do. */ }
+
+  //! Called when the traverser recurses into a node combination.
+  void Enter() { ++depth; }
+  //! Called when the traverser returns from a node combination.
+  void Leave() { --depth; }
+
+  //! Count the given number of calls to Score().
+  void Score(const size_t count = 1) { numScores += count; }
+
+  //! Count the given number of prunes of the children of the current node
+  //! combination.
+  void Prune(const size_t count = 1)
+  {
+    if (prunes.size() <= depth)
+      prunes.resize(depth + 1, 0);
+    prunes[depth] += count;
+  }
+
+  //! Count the given number of base cases.
+  void BaseCases(const size_t count) { numBaseCases += count; }
+
+  /**
+   * Count a call to Rescore(), which changed the score of a node combination
+   * from oldScore to newScore.  newScore is returned.
+   */
+  double Rescore(const double oldScore, const double newScore)
+  {
+    ++numRescores;
+    if (oldScore != DBL_MAX && newScore == DBL_MAX)
+      ++numRescorePrunes;
+    return newScore;
+  }
+
+  //! Set all counts to zero.
+  void Reset()
+  {
+    depth = 0;
+    prunes.clear();
+    numScores = 0;
+    numBaseCases = 0;
+    numRescores = 0;
+    numRescorePrunes = 0;
+  }
+
+  //! Get the number of calls to Score().
+  size_t NumScores() const { return numScores; }
+  //! Get the number of base cases.
+  size_t NumBaseCases() const { return numBaseCases; }
+  //! Get the number of calls to Rescore().
+  size_t NumRescores() const { return numRescores; }
+  //! Get the number of calls to Rescore() that pruned a node combination which
+  //! Score() had not pruned.
+  size_t NumRescorePrunes() const { return numRescorePrunes; }
+
+  //! Get the number of node combinations of the given depth that were pruned.
+  size_t NumPrunes(const size_t depth) const
+  {
+    return (depth < prunes.size()) ? prunes[depth] : 0;
+  }
+
+  //! Get the total number of node combinations that were pruned.
+  size_t NumPrunes() const
+  {
+    return std::accumulate(prunes.begin(), prunes.end(), size_t(0));
+  }
+
+  //! Get the largest depth at which a prune happened, plus one.
+  size_t MaxPruneDepth() const { return prunes.size(); }
+
+ private:
+  //! The depth of the current node combination.
+  size_t depth;
+  //! The number of prunes at each depth.
+  std::vector<size_t> prunes;
+  //! The number of calls to Score().
+  size_t numScores;
+  //! The number of base cases.
+  size_t numBaseCases;
+  //! The number of calls to Rescore().
+  size_t numRescores;
+  //! The number of calls to Rescore() that pruned.
+  size_t numRescorePrunes;
+};
+
+/**
+ * Counters that count nothing.  All of the functions are empty, so a traverser
+ * that holds this class behaves exactly as if it kept no counters.
+ */
+class NoTraversalCounters
+{
+ public:
+  void Enter() { }
+  void Leave() { }
+  void Score(const size_t /* count */ = 1) { }
+  void Prune(const size_t /* count */ = 1) { }
+  void BaseCases(const size_t /* count */) { }
+  double Rescore(const double /* oldScore */, const double newScore)
+  {
+    return newScore;
+  }
+  void Reset() { }
+
+  size_t NumScores() const { return 0; }
+  size_t NumBaseCases() const { return 0; }
+  size_t NumRescores() const { return 0; }
+  size_t NumRescorePrunes() const { return 0; }
+  size_t NumPrunes(const size_t /* depth */) const { return 0; }
+  size_t NumPrunes() const { return 0; }
+  size_t MaxPruneDepth() const { return 0; }
+};
+
+/**
+ * The counters type that a traverser with the given rules should hold:
+ * RuleType::TraversalCountersType if the rules have that typedef, and
+ * NoTraversalCounters otherwise.
+ */
+template<typename RuleType, typename = void>
+struct TraversalCountersTraits
+{
+  typedef NoTraversalCounters CountersType;
+};
+
+//! The specialization for rules that have a TraversalCountersType typedef.
+template<typename RuleType>
+struct TraversalCountersTraits<RuleType,
+    typename std::conditional<true, void,
+        typename RuleType::TraversalCountersType>::type>
+{
+  typedef typename RuleType::TraversalCountersType CountersType;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
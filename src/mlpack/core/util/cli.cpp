@@ -12,12 +12,15 @@
 #include <list>
 #include <boost/program_options.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <fstream>
 #include <iostream>
 
 #include "cli.hpp"
 #include "log.hpp"
+#include "memory_tracker.hpp"
 
 #include "cli_deleter.hpp" // To make sure we can delete the singleton.
+#include "execution.hpp"
 #include "version.hpp"
 
 #include <mlpack/core/data/load.hpp>
@@ -96,6 +99,15 @@ CLI::~CLI()
 
       ++iter;
     }
+  }
+
+  // Print the timers if the user asked for verbose output or for the timers.
+  if ((HasParam("verbose") || HasParam("print_timers")) && !HasParam("help") &&
+      !HasParam("info"))
+  {
+    // --print_timers should print the timers even without --verbose.
+    const bool ignoreInfo = Log::Info.ignoreInput;
+    Log::Info.ignoreInput = false;
 
     Log::Info << "Program timers:" << std::endl;
     std::map<std::string, std::chrono::microseconds>::iterator it;
@@ -106,6 +118,37 @@ CLI::~CLI()
       Log::Info << "  " << i << ": ";
       timer.PrintTimer((*it).first);
     }
+
+#ifdef MLPACK_MEMORY_TRACKING
+    // Memory tracking is compiled in, so print the memory of each timer too.
+    MemoryTracker::Print();
+#endif
+
+    Log::Info.ignoreInput = ignoreInfo;
+  }
+
+  // Write the timers to a JSON file, if the user asked for it.
+  if (HasParam("timers_file") && !HasParam("help") && !HasParam("info"))
+  {
+    const std::string timersFile = GetParam<std::string>("timers_file");
+    std::ofstream stream(timersFile.c_str());
+    if (stream.is_open())
+      timer.PrintJSON(stream);
+    else
+      Log::Warn << "Unable to open file '" << timersFile << "' to save "
+          << "timers." << std::endl;
+  }
+
+  // Write the trace to a file, if the user asked for it.
+  if (HasParam("trace_file") && !HasParam("help") && !HasParam("info"))
+  {
+    const std::string traceFile = GetParam<std::string>("trace_file");
+    std::ofstream stream(traceFile.c_str());
+    if (stream.is_open())
+      timer.PrintTrace(stream);
+    else
+      Log::Warn << "Unable to open file '" << traceFile << "' to save the "
+          << "trace." << std::endl;
   }
 
   // Notify the user if we are debugging, but only if we actually parsed the
@@ -157,6 +200,18 @@ bool CLI::HasParam(const std::string& key)
   return (vmap.count(parameters.at(checkKey).boostName) > 0);
 }
 
+// Get the map of all parameters.
+const std::map<std::string, util::ParamData>& CLI::Parameters()
+{
+  return GetSingleton().parameters;
+}
+
+// Get the map from aliases to parameter names.
+const std::map<char, std::string>& CLI::Aliases()
+{
+  return GetSingleton().aliases;
+}
+
 /**
  * Hyphenate a string or split it onto multiple 80-character lines, with some
  * amount of padding on each line.  This is used for option output.
@@ -371,6 +426,47 @@ void CLI::ParseCommandLine(int argc, char** line)
     else
       param.value = vmap[i->first].value();
   }
+
+  // Record the trace of the program, if it will be written.
+  if (parameters.count("trace_file") && HasParam("trace_file"))
+    Timer::EnableTracing();
+
+  // Apply the thread count, pinning, and NUMA placement options before the
+  // program loads any data.  (They may be missing if the default options were
+  // not added, as in some tests.)
+  const int threads = parameters.count("threads") ?
+      GetParam<int>("threads") : 0;
+  if (threads < 0)
+    Log::Fatal << "Invalid number of threads (" << threads << ") specified "
+        << "with --threads; must be nonnegative!" << std::endl;
+
+  const std::string numaName = parameters.count("numa") ?
+      GetParam<std::string>("numa") : "none";
+  Execution::NUMAPolicy numa = Execution::NUMA_NONE;
+  if (numaName == "first-touch")
+    numa = Execution::NUMA_FIRST_TOUCH;
+  else if (numaName == "interleave")
+    numa = Execution::NUMA_INTERLEAVE;
+  else if (numaName != "none")
+    Log::Fatal << "Invalid NUMA placement '" << numaName << "' specified with "
+        << "--numa; must be 'none', 'first-touch', or 'interleave'."
+        << std::endl;
+
+  // Placement only helps if the threads stay on the NUMA node they touched the
+  // memory from, so it implies spread pinning unless --bind is given.
+  const std::string bindName = (parameters.count("bind") && HasParam("bind")) ?
+      GetParam<std::string>("bind") :
+      (numa == Execution::NUMA_NONE ? "none" : "spread");
+  Execution::BindPolicy bind = Execution::BIND_NONE;
+  if (bindName == "compact")
+    bind = Execution::BIND_COMPACT;
+  else if (bindName == "spread")
+    bind = Execution::BIND_SPREAD;
+  else if (bindName != "none")
+    Log::Fatal << "Invalid thread pinning '" << bindName << "' specified with "
+        << "--bind; must be 'none', 'compact', or 'spread'." << std::endl;
+
+  Execution::Configure((size_t) threads, bind, numa);
 }
 
 /* Prints the descriptions of the current hierarchy. */
@@ -512,3 +608,20 @@ PARAM_STRING_IN("info", "Get help on a specific module or option.", "", "");
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_FLAG("print_timers", "Print the program timers at the end of execution, "
+    "even without --verbose.", "");
+PARAM_STRING_IN("timers_file", "If specified, the program timers are saved to "
+    "this file in JSON format at the end of execution.", "", "");
+PARAM_STRING_IN("trace_file", "If specified, a timeline of the program timers "
+    "and of the iterations of algorithms is saved to this file in the Chrome "
+    "trace event format (for chrome://tracing) at the end of execution.", "",
+    "");
+PARAM_INT_IN("threads", "Number of OpenMP threads to use (if 0, the OpenMP "
+    "default is used).", "", 0);
+PARAM_STRING_IN("bind", "How to pin threads to CPUs: 'none', 'compact' (thread "
+    "i on the i'th available CPU), or 'spread' (threads spread evenly over the "
+    "available CPUs).  The default is 'spread' if --numa is given, and 'none' "
+    "otherwise.", "", "none");
+PARAM_STRING_IN("numa", "How to place loaded datasets and trees on the NUMA "
+    "nodes: 'none', 'first-touch' (each thread holds the block of points it "
+    "processes), or 'interleave' (pages spread over all threads).", "", "none");
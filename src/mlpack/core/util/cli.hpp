@@ -256,6 +256,12 @@ class CLI
    */
   static bool HasParam(const std::string& identifier);
 
+  //! Get the map of all parameters, indexed by name.
+  static const std::map<std::string, util::ParamData>& Parameters();
+
+  //! Get the map from aliases to the names of the parameters.
+  static const std::map<char, std::string>& Aliases();
+
   /**
    * Hyphenate a string or split it onto multiple 80-character lines, with some
    * amount of padding on each line.  This is ued for option output.
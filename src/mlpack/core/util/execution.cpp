@@ -0,0 +1,187 @@
+/**
+ * @file execution.cpp
+ *
+ * Implementation of the execution configuration.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "execution.hpp"
+#include "log.hpp"
+
+#if defined(__linux__) && defined(HAS_OPENMP)
+  #include <sched.h>
+  #define MLPACK_HAS_THREAD_PINNING
+#endif
+
+#if defined(__GNUC__) && defined(__ELF__)
+  // The BLAS libraries that can change their number of threads at run time
+  // are detected through weak symbols, which are NULL if they are not linked.
+  extern "C" void openblas_set_num_threads(int) __attribute__((weak));
+  extern "C" void MKL_Set_Num_Threads(int) __attribute__((weak));
+  #define MLPACK_HAS_WEAK_BLAS_SYMBOLS
+#endif
+
+using namespace mlpack;
+using namespace mlpack::util;
+
+Execution::BindPolicy Execution::bind = Execution::BIND_NONE;
+Execution::NUMAPolicy Execution::numa = Execution::NUMA_NONE;
+Executor* Execution::executor = NULL;
+bool Execution::nested = false;
+thread_local bool Execution::inParallelFor = false;
+
+#ifdef MLPACK_HAS_THREAD_PINNING
+namespace {
+
+//! The CPUs the process may run on, before any thread was pinned.
+const std::vector<int>& AllowedCPUs()
+{
+  static std::vector<int> cpus;
+  if (cpus.empty())
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+      for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        if (CPU_ISSET(cpu, &set))
+          cpus.push_back(cpu);
+    }
+  }
+
+  return cpus;
+}
+
+//! Whether the threads have been pinned.
+bool pinned = false;
+
+} // anonymous namespace
+#endif
+
+namespace {
+
+//! The OpenMP thread count to restore when the executor is removed.
+size_t savedThreads = 0;
+
+} // anonymous namespace
+
+void Execution::Configure(const size_t threads,
+                          const BindPolicy bind,
+                          const NUMAPolicy numa)
+{
+#ifdef HAS_OPENMP
+  if (threads > 0)
+    omp_set_num_threads((int) threads);
+#else
+  if (threads > 1)
+    Log::Warn << "Execution::Configure(): mlpack was built without OpenMP "
+        << "support, so only one thread is used." << std::endl;
+#endif
+
+  Execution::bind = bind;
+  Execution::numa = numa;
+  PinThreads();
+}
+
+size_t Execution::Threads()
+{
+#ifdef HAS_OPENMP
+  return (size_t) omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+void Execution::PinThreads()
+{
+#ifdef MLPACK_HAS_THREAD_PINNING
+  // Unpinning is only necessary if the threads were pinned before.
+  if (bind == BIND_NONE && !pinned)
+    return;
+
+  const std::vector<int>& cpus = AllowedCPUs();
+  if (cpus.empty())
+  {
+    Log::Warn << "Execution::Configure(): cannot get the CPUs available to "
+        << "the process; threads are not pinned." << std::endl;
+    return;
+  }
+
+  #pragma omp parallel
+  {
+    const size_t thread = (size_t) omp_get_thread_num();
+    const size_t threads = (size_t) omp_get_num_threads();
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (bind == BIND_NONE)
+    {
+      for (size_t i = 0; i < cpus.size(); ++i)
+        CPU_SET(cpus[i], &set);
+    }
+    else
+    {
+      // Spreading threads over the CPU numbers puts them on different sockets
+      // before it puts two of them on the same one.
+      const size_t index = (bind == BIND_COMPACT) ? thread :
+          thread * cpus.size() / threads;
+      CPU_SET(cpus[index % cpus.size()], &set);
+    }
+
+    sched_setaffinity(0, sizeof(set), &set);
+  }
+
+  pinned = (bind != BIND_NONE);
+#else
+  if (bind != BIND_NONE)
+    Log::Warn << "Execution::Configure(): thread pinning is only supported on "
+        << "Linux with OpenMP; threads are not pinned." << std::endl;
+#endif
+}
+
+void Execution::SetExecutor(Executor* executor)
+{
+  // Unconverted OpenMP regions and BLAS calls would compete with the
+  // executor's threads, so they run serially while it is installed.
+  if (executor && !Execution::executor)
+  {
+    savedThreads = Threads();
+#ifdef HAS_OPENMP
+    omp_set_num_threads(1);
+#endif
+    BLASThreads(1);
+  }
+  else if (!executor && Execution::executor)
+  {
+#ifdef HAS_OPENMP
+    omp_set_num_threads((int) savedThreads);
+#endif
+    BLASThreads(savedThreads);
+  }
+
+  Execution::executor = executor;
+}
+
+void Execution::Nested(const bool nested)
+{
+  Execution::nested = nested;
+#ifdef HAS_OPENMP
+  // OpenMP clamps the number of levels to the number it supports.
+  omp_set_max_active_levels(nested ? INT_MAX : 1);
+#endif
+}
+
+void Execution::BLASThreads(const size_t threads)
+{
+#ifdef MLPACK_HAS_WEAK_BLAS_SYMBOLS
+  if (openblas_set_num_threads)
+    openblas_set_num_threads((int) threads);
+  if (MKL_Set_Num_Threads)
+    MKL_Set_Num_Threads((int) threads);
+#else
+  (void) threads;
+#endif
+}
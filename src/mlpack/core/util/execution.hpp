@@ -0,0 +1,181 @@
+/**
+ * @file execution.hpp
+ *
+ * The execution configuration of mlpack: the number of OpenMP threads, how
+ * the threads are pinned to CPUs, and how large datasets are placed on the
+ * NUMA nodes of the machine.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_EXECUTION_HPP
+#define MLPACK_CORE_UTIL_EXECUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <functional>
+
+namespace mlpack {
+namespace util {
+
+/**
+ * An Executor runs batches of independent tasks.  Programs that embed mlpack
+ * in a process with its own thread pool can implement this interface on top of
+ * that pool and install it with Execution::SetExecutor(), so that the parallel
+ * loops of mlpack run on the pool instead of on OpenMP threads.
+ */
+class Executor
+{
+ public:
+  //! Nothing to do for the destructor.
+  virtual ~Executor() { }
+
+  //! Get the number of tasks that can run at the same time.
+  virtual size_t Concurrency() const = 0;
+
+  /**
+   * Run task(0), ..., task(tasks - 1), in any order and possibly concurrently,
+   * and return once all of them have finished.  The tasks do not throw.
+   *
+   * @param tasks Number of tasks.
+   * @param task Function to call with the index of each task.
+   */
+  virtual void Run(const size_t tasks,
+                   const std::function<void(size_t)>& task) = 0;
+};
+
+/**
+ * The Execution class holds the execution configuration that data::Load(),
+ * tree construction, and the parallel algorithms of mlpack respect.  It is set
+ * by the --threads, --bind, and --numa options of every mlpack program, or by
+ * a call to Configure().
+ *
+ * Linux allocates each page of memory on the NUMA node of the thread that
+ * first writes to it.  When threads are pinned to CPUs, Place() copies a matrix
+ * into fresh memory in parallel, so that either each thread touches the block
+ * of columns a static OpenMP schedule gives it (first-touch placement), or the
+ * pages are spread round-robin across the threads (interleaved placement).
+ * Placement is a no-op when it is disabled, on small matrices, for non-dense
+ * matrix types, and without OpenMP.
+ *
+ * ParallelFor() runs the iterations of a loop on the installed Executor, or on
+ * OpenMP threads if there is none.  A ParallelFor() inside another one runs
+ * serially unless nested parallelism is enabled with Nested().
+ */
+class Execution
+{
+ public:
+  //! How the OpenMP threads are pinned to CPUs.
+  enum BindPolicy
+  {
+    BIND_NONE,    //!< Threads are not pinned.
+    BIND_COMPACT, //!< Thread i is pinned to the i'th available CPU.
+    BIND_SPREAD   //!< Threads are spread evenly over the available CPUs.
+  };
+
+  //! How large matrices are placed on the NUMA nodes.
+  enum NUMAPolicy
+  {
+    NUMA_NONE,        //!< Matrices are left where they were allocated.
+    NUMA_FIRST_TOUCH, //!< Each thread touches its static block of columns.
+    NUMA_INTERLEAVE   //!< Pages are spread round-robin over the threads.
+  };
+
+  /**
+   * Set the execution configuration.  The threads are pinned immediately, and
+   * stay pinned as long as the OpenMP runtime reuses them.
+   *
+   * @param threads Number of OpenMP threads (0 keeps the OpenMP default).
+   * @param bind How the threads are pinned to CPUs.
+   * @param numa How large matrices are placed on the NUMA nodes.
+   */
+  static void Configure(const size_t threads,
+                        const BindPolicy bind,
+                        const NUMAPolicy numa);
+
+  //! Get the number of threads that parallel regions use.
+  static size_t Threads();
+  //! Get the thread pinning policy.
+  static BindPolicy Bind() { return bind; }
+  //! Get the NUMA placement policy.
+  static NUMAPolicy NUMA() { return numa; }
+
+  /**
+   * Move the given dense matrix into memory placed according to the NUMA
+   * policy.  The contents of the matrix are not changed.
+   *
+   * @param matrix Matrix to place.
+   */
+  template<typename eT>
+  static void Place(arma::Mat<eT>& matrix);
+
+  //! Other matrix types are left where they are.
+  template<typename MatType>
+  static void Place(MatType& /* matrix */) { }
+
+  /**
+   * Install the given executor, or go back to OpenMP if it is NULL.  The
+   * executor is not owned, and must outlive its use.  While an executor is
+   * installed, the OpenMP regions that have not been converted to ParallelFor()
+   * and the BLAS library run with one thread each, so that they do not
+   * oversubscribe the CPUs of the executor.  When the executor is removed, both
+   * go back to the number of OpenMP threads used before it was installed.
+   *
+   * @param executor Executor to run parallel loops on.
+   */
+  static void SetExecutor(Executor* executor);
+  //! Get the installed executor (NULL if OpenMP is used).
+  static Executor* GetExecutor() { return executor; }
+
+  //! Enable or disable nested parallelism (disabled by default).
+  static void Nested(const bool nested);
+  //! Get whether nested parallelism is enabled.
+  static bool Nested() { return nested; }
+
+  /**
+   * Set the number of threads of the BLAS library, if it is OpenBLAS or MKL
+   * and the platform supports weak symbols; otherwise this does nothing.
+   *
+   * @param threads Number of BLAS threads.
+   */
+  static void BLASThreads(const size_t threads);
+
+  /**
+   * Call function(i) for every i in [0, n), in parallel.  The iterations are
+   * grouped into blocks of the given size, which are distributed dynamically
+   * over the threads; cheap iterations should use larger blocks.  If an
+   * iteration throws, the exception is rethrown once the loop has finished.
+   *
+   * @param n Number of iterations.
+   * @param function Function to call with the index of each iteration.
+   * @param grain Number of consecutive iterations of each block.
+   */
+  template<typename FunctionType>
+  static void ParallelFor(const size_t n,
+                          const FunctionType& function,
+                          const size_t grain = 1);
+
+ private:
+  //! Pin the threads of the current OpenMP thread pool.
+  static void PinThreads();
+
+  //! The thread pinning policy.
+  static BindPolicy bind;
+  //! The NUMA placement policy.
+  static NUMAPolicy numa;
+  //! The installed executor, or NULL to use OpenMP.
+  static Executor* executor;
+  //! Whether nested parallel loops run in parallel.
+  static bool nested;
+  //! Whether the current thread runs a task of ParallelFor().
+  static thread_local bool inParallelFor;
+};
+
+} // namespace util
+} // namespace mlpack
+
+// Include implementation.
+#include "execution_impl.hpp"
+
+#endif
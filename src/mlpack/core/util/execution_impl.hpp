@@ -0,0 +1,149 @@
+/**
+ * @file execution_impl.hpp
+ *
+ * Implementation of NUMA placement of matrices and of parallel loops.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_EXECUTION_IMPL_HPP
+#define MLPACK_CORE_UTIL_EXECUTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "execution.hpp"
+
+#include <exception>
+#include <mutex>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace util {
+
+template<typename eT>
+void Execution::Place(arma::Mat<eT>& matrix)
+{
+#ifdef HAS_OPENMP
+  // Placing a matrix that fits in a few pages per thread is not worth a copy.
+  const size_t pageElems = std::max<size_t>(4096 / sizeof(eT), 1);
+  if (numa == NUMA_NONE || omp_get_max_threads() == 1 ||
+      matrix.n_elem < 64 * pageElems * (size_t) omp_get_max_threads())
+    return;
+
+  // The new memory is not initialized, so each of its pages is allocated when
+  // a thread first copies into it.
+  arma::Mat<eT> placed(matrix.n_rows, matrix.n_cols);
+  const eT* source = matrix.memptr();
+  eT* destination = placed.memptr();
+
+  if (numa == NUMA_FIRST_TOUCH)
+  {
+    // This is the split of the columns of any static parallel loop over them.
+    const size_t nRows = matrix.n_rows;
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) matrix.n_cols; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < matrix.n_cols; ++i)
+#endif
+    {
+      std::memcpy(destination + i * nRows, source + i * nRows,
+          sizeof(eT) * nRows);
+    }
+  }
+  else
+  {
+    const size_t nElem = matrix.n_elem;
+    const size_t pages = (nElem + pageElems - 1) / pageElems;
+#ifdef _WIN32
+    #pragma omp parallel for schedule(static, 1)
+    for (intmax_t p = 0; p < (intmax_t) pages; ++p)
+#else
+    #pragma omp parallel for schedule(static, 1)
+    for (size_t p = 0; p < pages; ++p)
+#endif
+    {
+      const size_t begin = p * pageElems;
+      std::memcpy(destination + begin, source + begin,
+          sizeof(eT) * std::min(pageElems, nElem - begin));
+    }
+  }
+
+  matrix.steal_mem(placed);
+#else
+  (void) matrix;
+#endif
+}
+
+template<typename FunctionType>
+void Execution::ParallelFor(const size_t n,
+                            const FunctionType& function,
+                            const size_t grain)
+{
+  const size_t blockSize = std::max<size_t>(grain, 1);
+  const size_t blocks = (n + blockSize - 1) / blockSize;
+  if (blocks <= 1 || (inParallelFor && !nested))
+  {
+    for (size_t i = 0; i < n; ++i)
+      function(i);
+    return;
+  }
+
+  // The first exception thrown by an iteration is kept and rethrown at the
+  // end, since exceptions cannot leave a task or an OpenMP region.
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+  auto runBlock = [&](const size_t b)
+  {
+    const bool outerParallelFor = inParallelFor;
+    inParallelFor = true;
+    try
+    {
+      const size_t end = std::min(n, (b + 1) * blockSize);
+      for (size_t i = b * blockSize; i < end; ++i)
+        function(i);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(exceptionMutex);
+      if (!exception)
+        exception = std::current_exception();
+    }
+    inParallelFor = outerParallelFor;
+  };
+
+  if (executor)
+  {
+    executor->Run(blocks, runBlock);
+  }
+  else
+  {
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t b = 0; b < (intmax_t) blocks; ++b)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < blocks; ++b)
+#endif
+      runBlock((size_t) b);
+  }
+
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+} // namespace util
+} // namespace mlpack
+
+#endif
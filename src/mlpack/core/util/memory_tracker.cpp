@@ -0,0 +1,199 @@
+/**
+ * @file memory_tracker.cpp
+ *
+ * Implementation of the MemoryTracker.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "memory_tracker.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+using namespace mlpack;
+
+namespace {
+
+//! The memory statistics of one phase.
+struct PhaseStats
+{
+  //! Number of times the phase was started and not stopped yet.
+  size_t running = 0;
+  //! Tracked bytes when the phase was last started.
+  size_t startBytes = 0;
+  //! Highest number of tracked bytes while the phase was running.
+  size_t peak = 0;
+  //! Change in tracked bytes over all the finished runs of the phase.
+  long long change = 0;
+};
+
+//! All of the state of the tracker.
+struct TrackerState
+{
+  //! Tracked bytes currently allocated.
+  size_t current = 0;
+  //! Highest number of tracked bytes allocated at once.
+  size_t peak = 0;
+  //! The statistics of every phase.  The elements of a std::map are never
+  //! moved, so they can be pointed to.
+  std::map<std::string, PhaseStats> phases;
+  //! The phases that are running.
+  std::vector<PhaseStats*> running;
+  //! Lock for all of the state.
+  std::mutex mutex;
+};
+
+//! Get the state of the tracker.  It is never destroyed, so that objects that
+//! are destroyed at exit can still record that they are freed.
+TrackerState& State()
+{
+  static TrackerState* state = new TrackerState();
+  return *state;
+}
+
+//! Format the given number of bytes, with a more readable unit.
+std::string FormatBytes(const long long bytes)
+{
+  std::ostringstream oss;
+  oss << bytes << " bytes";
+
+  const double absBytes = (double) std::abs(bytes);
+  oss << std::fixed << std::setprecision(2);
+  if (absBytes >= 1024.0 * 1024.0 * 1024.0)
+    oss << " (" << bytes / (1024.0 * 1024.0 * 1024.0) << " GB)";
+  else if (absBytes >= 1024.0 * 1024.0)
+    oss << " (" << bytes / (1024.0 * 1024.0) << " MB)";
+  else if (absBytes >= 1024.0)
+    oss << " (" << bytes / 1024.0 << " kB)";
+
+  return oss.str();
+}
+
+} // anonymous namespace
+
+void MemoryTracker::Allocate(const size_t bytes)
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.current += bytes;
+  state.peak = std::max(state.peak, state.current);
+  for (PhaseStats* phase : state.running)
+    phase->peak = std::max(phase->peak, state.current);
+}
+
+void MemoryTracker::Free(const size_t bytes)
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.current -= std::min(bytes, state.current);
+}
+
+void MemoryTracker::StartPhase(const std::string& name)
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  PhaseStats& phase = state.phases[name];
+  if (phase.running++ > 0)
+    return;
+
+  phase.startBytes = state.current;
+  phase.peak = std::max(phase.peak, state.current);
+  state.running.push_back(&phase);
+}
+
+void MemoryTracker::StopPhase(const std::string& name)
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  std::map<std::string, PhaseStats>::iterator it = state.phases.find(name);
+  if (it == state.phases.end() || it->second.running == 0)
+    return;
+
+  PhaseStats& phase = it->second;
+  if (--phase.running > 0)
+    return;
+
+  phase.change += (long long) state.current - (long long) phase.startBytes;
+  state.running.erase(std::find(state.running.begin(), state.running.end(),
+      &phase));
+}
+
+size_t MemoryTracker::Current()
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  return state.current;
+}
+
+size_t MemoryTracker::Peak()
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  return state.peak;
+}
+
+size_t MemoryTracker::PhasePeak(const std::string& name)
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  std::map<std::string, PhaseStats>::const_iterator it =
+      state.phases.find(name);
+  return (it == state.phases.end()) ? 0 : it->second.peak;
+}
+
+long long MemoryTracker::PhaseChange(const std::string& name)
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  std::map<std::string, PhaseStats>::const_iterator it =
+      state.phases.find(name);
+  if (it == state.phases.end())
+    return 0;
+
+  // A running phase includes its current run.
+  long long change = it->second.change;
+  if (it->second.running > 0)
+    change += (long long) state.current - (long long) it->second.startBytes;
+  return change;
+}
+
+void MemoryTracker::Print()
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+
+  Log::Info << "Program memory (tracked allocations):" << std::endl;
+  std::map<std::string, PhaseStats>::const_iterator it;
+  for (it = state.phases.begin(); it != state.phases.end(); ++it)
+  {
+    long long change = it->second.change;
+    if (it->second.running > 0)
+      change += (long long) state.current - (long long) it->second.startBytes;
+
+    Log::Info << "  " << it->first << ": peak "
+        << FormatBytes(it->second.peak) << ", change " << FormatBytes(change)
+        << std::endl;
+  }
+
+  Log::Info << "  total: peak " << FormatBytes(state.peak) << ", current "
+      << FormatBytes(state.current) << std::endl;
+}
+
+void MemoryTracker::Reset()
+{
+  TrackerState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.current = 0;
+  state.peak = 0;
+  state.phases.clear();
+  state.running.clear();
+}
@@ -0,0 +1,118 @@
+/**
+ * @file memory_tracker.hpp
+ *
+ * Tracking of the memory allocated by mlpack, for each named phase of a
+ * program.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_MEMORY_TRACKER_HPP
+#define MLPACK_CORE_UTIL_MEMORY_TRACKER_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace mlpack {
+
+/**
+ * The MemoryTracker counts the bytes allocated and freed at the major
+ * allocation sites of mlpack: the nodes of trees, the matrices loaded by
+ * data::Load(), and the result matrices and query trees of NeighborSearch.  It
+ * is not a general heap profiler; memory that is not allocated at one of these
+ * sites is not counted.  Memory that is handed to the caller, such as a loaded
+ * matrix or the results of a search, is counted until the end of the program.
+ *
+ * The tracker has a phase for each timer (see Timer and ScopedTimer): while a
+ * timer is running, its phase records the highest number of tracked bytes
+ * reached, and the change in tracked bytes from when the timer was started to
+ * when it was stopped.  With --print_timers (or --verbose), the phases are
+ * printed after the program timers.
+ *
+ * The allocation sites are only instrumented when mlpack is built with the
+ * MEMORY_TRACKING CMake option, which defines MLPACK_MEMORY_TRACKING;
+ * otherwise the MLPACK_TRACK_ALLOC() and MLPACK_TRACK_FREE() macros expand to
+ * nothing, and no phase is ever started.
+ */
+class MemoryTracker
+{
+ public:
+  /**
+   * Record the allocation of the given number of bytes.  This is thread-safe.
+   *
+   * @param bytes Number of bytes allocated.
+   */
+  static void Allocate(const size_t bytes);
+
+  /**
+   * Record that the given number of bytes was freed.  This is thread-safe.
+   *
+   * @param bytes Number of bytes freed.
+   */
+  static void Free(const size_t bytes);
+
+  /**
+   * Start the phase with the given name.  A phase may be started several
+   * times, also from several threads; it runs until it has been stopped as
+   * many times as it was started.
+   *
+   * @param name Name of the phase.
+   */
+  static void StartPhase(const std::string& name);
+
+  /**
+   * Stop the phase with the given name.
+   *
+   * @param name Name of the phase.
+   */
+  static void StopPhase(const std::string& name);
+
+  //! Get the number of tracked bytes currently allocated.
+  static size_t Current();
+  //! Get the highest number of tracked bytes allocated at once.
+  static size_t Peak();
+
+  /**
+   * Get the highest number of tracked bytes allocated at once while the given
+   * phase was running (0 if it never ran).
+   *
+   * @param name Name of the phase.
+   */
+  static size_t PhasePeak(const std::string& name);
+
+  /**
+   * Get the change in the number of tracked bytes over all the runs of the
+   * given phase; this is negative if the phase freed more than it allocated.
+   *
+   * @param name Name of the phase.
+   */
+  static long long PhaseChange(const std::string& name);
+
+  //! Print the peak and the change of every phase, and the peak and current
+  //! totals, to Log::Info.
+  static void Print();
+
+  //! Forget all allocations and phases.
+  static void Reset();
+
+  //! Get the number of bytes held by the elements of the given matrix.
+  template<typename MatType>
+  static size_t Bytes(const MatType& matrix)
+  {
+    return matrix.n_elem * sizeof(typename MatType::elem_type);
+  }
+};
+
+} // namespace mlpack
+
+#ifdef MLPACK_MEMORY_TRACKING
+  #define MLPACK_TRACK_ALLOC(bytes) ::mlpack::MemoryTracker::Allocate(bytes)
+  #define MLPACK_TRACK_FREE(bytes) ::mlpack::MemoryTracker::Free(bytes)
+#else
+  #define MLPACK_TRACK_ALLOC(bytes)
+  #define MLPACK_TRACK_FREE(bytes)
+#endif
+
+#endif
@@ -14,8 +14,44 @@
 
 #include "prefixedoutstream.hpp"
 
+#include <atomic>
+#include <unordered_map>
+
 using namespace mlpack::util;
 
+PrefixedOutStream::ThreadLine* PrefixedOutStream::LocalLine()
+{
+  if (std::this_thread::get_id() == owner)
+    return NULL;
+
+  // The line buffers of the calling thread, indexed by stream identifier.
+  thread_local std::unordered_map<size_t, ThreadLine> lines;
+  return &lines[id];
+}
+
+void PrefixedOutStream::FlushLine(ThreadLine* line)
+{
+  if (!line)
+    return;
+
+  std::lock_guard<std::recursive_mutex> lock(OutputMutex());
+  destination << line->buffer.str();
+  destination.flush();
+  line->buffer.str("");
+}
+
+std::recursive_mutex& PrefixedOutStream::OutputMutex()
+{
+  static std::recursive_mutex mutex;
+  return mutex;
+}
+
+size_t PrefixedOutStream::NextId()
+{
+  static std::atomic<size_t> nextId(0);
+  return nextId++;
+}
+
 /**
  * These are all necessary because gcc's template mechanism does not seem smart
  * enough to figure out what I want to pass into operator<< without these.  That
@@ -15,6 +15,10 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include <mutex>
+#include <sstream>
+#include <thread>
+
 namespace mlpack {
 namespace util {
 
@@ -42,6 +46,14 @@ namespace util {
  *
  * These objects are used for the mlpack::Log levels (DEBUG, INFO, WARN, and
  * FATAL).
+ *
+ * The stream may be used from several threads at once.  The thread that
+ * created the stream writes directly to the destination; every other thread
+ * collects its output in a line buffer of its own, which is written to the
+ * destination in one piece when the line ends, so lines from different threads
+ * are never interleaved.  When ignoreInput is set (and the stream is not
+ * fatal), output is discarded before it is formatted, so disabled log levels
+ * are cheap to use in hot loops.
  */
 class PrefixedOutStream
 {
@@ -65,7 +77,9 @@ class PrefixedOutStream
       // We want the first call to operator<< to prefix the prefix so we set
       // carriageReturned to true.
       carriageReturned(true),
-      fatal(fatal)
+      fatal(fatal),
+      owner(std::this_thread::get_id()),
+      id(NextId())
     { /* nothing to do */ }
 
   //! Write a bool to the stream.
@@ -114,6 +128,17 @@ class PrefixedOutStream
   bool ignoreInput;
 
  private:
+  //! The line being written by a thread other than the owner of the stream.
+  struct ThreadLine
+  {
+    ThreadLine() : carriageReturned(true) { }
+
+    //! The output of the thread since the end of its last line.
+    std::ostringstream buffer;
+    //! Whether the next output of the thread starts a line.
+    bool carriageReturned;
+  };
+
   /**
    * Conducts the base logic required in all the operator << overloads.  Mostly
    * just a good idea to reduce copy-pasta.
@@ -144,8 +169,30 @@ class PrefixedOutStream
 
   /**
    * Output the prefix, but only if we need to and if we are allowed to.
+   *
+   * @param out Stream the line is written to.
+   * @param lineStart Whether the next output starts a line; reset after the
+   *     prefix is written.
+   */
+  inline void PrefixIfNeeded(std::ostream& out, bool& lineStart);
+
+  /**
+   * Get the line buffer of the calling thread, or NULL if the calling thread is
+   * the owner of the stream (which writes directly to the destination).
    */
-  inline void PrefixIfNeeded();
+  ThreadLine* LocalLine();
+
+  /**
+   * Write the buffered output of the given line to the destination, in one
+   * piece, and empty the buffer.  Nothing is done if line is NULL.
+   */
+  void FlushLine(ThreadLine* line);
+
+  //! The mutex held while writing to any destination.
+  static std::recursive_mutex& OutputMutex();
+
+  //! Get a new unique identifier for a stream.
+  static size_t NextId();
 
   //! Contains the prefix we must prepend to each line.
   std::string prefix;
@@ -157,6 +204,13 @@ class PrefixedOutStream
   //! If true, a std::runtime_error exception will be thrown when a CR is
   //! encountered.
   bool fatal;
+
+  //! The thread that created the stream.
+  std::thread::id owner;
+
+  //! The unique identifier of the stream, used to find the line buffers of the
+  //! other threads.
+  size_t id;
 };
 
 } // namespace util
@@ -38,26 +38,41 @@ template<typename T>
 typename std::enable_if<!arma::is_arma_type<T>::value>::type
 PrefixedOutStream::BaseLogic(const T& val)
 {
+  // Disabled streams discard everything without formatting it.
+  if (ignoreInput && !fatal)
+    return;
+
+  // Threads other than the owner buffer their output until the end of the
+  // line; the owner writes directly, while holding the output mutex.
+  ThreadLine* threadLine = LocalLine();
+  std::ostream& out = threadLine ?
+      static_cast<std::ostream&>(threadLine->buffer) : destination;
+  bool& lineStart = threadLine ? threadLine->carriageReturned :
+      carriageReturned;
+  std::unique_lock<std::recursive_mutex> lock(OutputMutex(), std::defer_lock);
+  if (!threadLine)
+    lock.lock();
+
   // We will use this to track whether or not we need to terminate at the end of
   // this call (only for streams which terminate after a newline).
   bool newlined = false;
   std::string line;
 
   // If we need to, output the prefix.
-  PrefixIfNeeded();
+  PrefixIfNeeded(out, lineStart);
 
   std::ostringstream convert;
   // Sync flags and precision with destination stream
-  convert.setf(destination.flags());
-  convert.precision(destination.precision());
+  convert.setf(out.flags());
+  convert.precision(out.precision());
   convert << val;
 
   if (convert.fail())
   {
-    PrefixIfNeeded();
+    PrefixIfNeeded(out, lineStart);
     if (!ignoreInput)
     {
-      destination << "Failed type conversion to string for output; output not "
+      out << "Failed type conversion to string for output; output not "
           "shown." << std::endl;
       newlined = true;
     }
@@ -72,7 +87,7 @@ PrefixedOutStream::BaseLogic(const T& val)
     {
       // The prefix cannot be necessary at this point.
       if (!ignoreInput) // Only if the user wants it.
-        destination << val;
+        out << val;
 
       return;
     }
@@ -82,34 +97,38 @@ PrefixedOutStream::BaseLogic(const T& val)
     size_t pos = 0;
     while ((nl = line.find('\n', pos)) != std::string::npos)
     {
-      PrefixIfNeeded();
+      PrefixIfNeeded(out, lineStart);
 
       // Only output if the user wants it.
       if (!ignoreInput)
       {
-        destination << line.substr(pos, nl - pos);
-        destination << std::endl;
+        out << line.substr(pos, nl - pos);
+        out << std::endl;
       }
 
       newlined = true; // Ensure this is set for the fatal exception if needed.
-      carriageReturned = true; // Regardless of whether or not we display it.
+      lineStart = true; // Regardless of whether or not we display it.
 
       pos = nl + 1;
     }
 
     if (pos != line.length()) // We need to display the rest.
     {
-      PrefixIfNeeded();
+      PrefixIfNeeded(out, lineStart);
       if (!ignoreInput)
-        destination << line.substr(pos);
+        out << line.substr(pos);
     }
   }
 
+  // Complete lines of other threads are written out now.
+  if (newlined)
+    FlushLine(threadLine);
+
   // If we displayed a newline and we need to throw afterwards, do that.
   if (fatal && newlined)
   {
     if (!ignoreInput)
-      destination << std::endl;
+      out << std::endl;
 
     // Print a backtrace, if we can.
 #ifdef HAS_BFD_DL
@@ -122,21 +141,22 @@ PrefixedOutStream::BaseLogic(const T& val)
       std::string btLine = bt.ToString();
       while ((nl = btLine.find('\n', pos)) != std::string::npos)
       {
-        PrefixIfNeeded();
+        PrefixIfNeeded(out, lineStart);
 
         if (!ignoreInput)
         {
-          destination << btLine.substr(pos, nl - pos);
-          destination << std::endl;
+          out << btLine.substr(pos, nl - pos);
+          out << std::endl;
         }
 
-        carriageReturned = true; // Regardless of whether or not we display it.
+        lineStart = true; // Regardless of whether or not we display it.
 
         pos = nl + 1;
       }
     }
 #endif
 
+    FlushLine(threadLine);
     throw std::runtime_error("fatal error; see Log::Fatal output");
   }
 }
@@ -146,6 +166,21 @@ template<typename T>
 typename std::enable_if<arma::is_arma_type<T>::value>::type
 PrefixedOutStream::BaseLogic(const T& val)
 {
+  // Disabled streams discard everything without formatting it.
+  if (ignoreInput && !fatal)
+    return;
+
+  // Threads other than the owner buffer their output until the end of the
+  // line; the owner writes directly, while holding the output mutex.
+  ThreadLine* threadLine = LocalLine();
+  std::ostream& out = threadLine ?
+      static_cast<std::ostream&>(threadLine->buffer) : destination;
+  bool& lineStart = threadLine ? threadLine->carriageReturned :
+      carriageReturned;
+  std::unique_lock<std::recursive_mutex> lock(OutputMutex(), std::defer_lock);
+  if (!threadLine)
+    lock.lock();
+
   // Extract printable object from the input.
   const arma::Mat<typename T::elem_type>& printVal(val);
 
@@ -155,21 +190,21 @@ PrefixedOutStream::BaseLogic(const T& val)
   std::string line;
 
   // If we need to, output the prefix.
-  PrefixIfNeeded();
+  PrefixIfNeeded(out, lineStart);
 
   std::ostringstream convert;
 
   // Check if the stream is in the default state.
-  if (destination.flags() == convert.flags() &&
-      destination.precision() == convert.precision())
+  if (out.flags() == convert.flags() &&
+      out.precision() == convert.precision())
   {
     printVal.print(convert);
   }
   else
   {
     // Sync flags and precision with destination stream
-    convert.setf(destination.flags());
-    convert.precision(destination.precision());
+    convert.setf(out.flags());
+    convert.precision(out.precision());
 
     // Set width of the convert stream.
     const arma::Mat<typename T::elem_type>& absVal(arma::abs(printVal));
@@ -187,10 +222,10 @@ PrefixedOutStream::BaseLogic(const T& val)
 
   if (convert.fail())
   {
-    PrefixIfNeeded();
+    PrefixIfNeeded(out, lineStart);
     if (!ignoreInput)
     {
-      destination << "Failed type conversion to string for output; output not "
+      out << "Failed type conversion to string for output; output not "
           "shown." << std::endl;
       newlined = true;
     }
@@ -205,7 +240,7 @@ PrefixedOutStream::BaseLogic(const T& val)
     {
       // The prefix cannot be necessary at this point.
       if (!ignoreInput) // Only if the user wants it.
-        destination << val;
+        out << val;
 
       return;
     }
@@ -215,34 +250,38 @@ PrefixedOutStream::BaseLogic(const T& val)
     size_t pos = 0;
     while ((nl = line.find('\n', pos)) != std::string::npos)
     {
-      PrefixIfNeeded();
+      PrefixIfNeeded(out, lineStart);
 
       // Only output if the user wants it.
       if (!ignoreInput)
       {
-        destination << line.substr(pos, nl - pos);
-        destination << std::endl;
+        out << line.substr(pos, nl - pos);
+        out << std::endl;
       }
 
       newlined = true; // Ensure this is set for the fatal exception if needed.
-      carriageReturned = true; // Regardless of whether or not we display it.
+      lineStart = true; // Regardless of whether or not we display it.
 
       pos = nl + 1;
     }
 
     if (pos != line.length()) // We need to display the rest.
     {
-      PrefixIfNeeded();
+      PrefixIfNeeded(out, lineStart);
       if (!ignoreInput)
-        destination << line.substr(pos);
+        out << line.substr(pos);
     }
   }
 
+  // Complete lines of other threads are written out now.
+  if (newlined)
+    FlushLine(threadLine);
+
   // If we displayed a newline and we need to throw afterwards, do that.
   if (fatal && newlined)
   {
     if (!ignoreInput)
-      destination << std::endl;
+      out << std::endl;
 
     // Print a backtrace, if we can.
 #ifdef HAS_BFD_DL
@@ -255,35 +294,36 @@ PrefixedOutStream::BaseLogic(const T& val)
       std::string btLine = bt.ToString();
       while ((nl = btLine.find('\n', pos)) != std::string::npos)
       {
-        PrefixIfNeeded();
+        PrefixIfNeeded(out, lineStart);
 
         if (!ignoreInput)
         {
-          destination << btLine.substr(pos, nl - pos);
-          destination << std::endl;
+          out << btLine.substr(pos, nl - pos);
+          out << std::endl;
         }
 
-        carriageReturned = true; // Regardless of whether or not we display it.
+        lineStart = true; // Regardless of whether or not we display it.
 
         pos = nl + 1;
       }
     }
 #endif
 
+    FlushLine(threadLine);
     throw std::runtime_error("fatal error; see Log::Fatal output");
   }
 }
 
 // This is an inline function (that is why it is here and not in .cc).
-void PrefixedOutStream::PrefixIfNeeded()
+void PrefixedOutStream::PrefixIfNeeded(std::ostream& out, bool& lineStart)
 {
   // If we need to, output a prefix.
-  if (carriageReturned)
+  if (lineStart)
   {
     if (!ignoreInput) // But only if we are allowed to.
-      destination << prefix;
+      out << prefix;
 
-    carriageReturned = false; // Denote that the prefix has been displayed.
+    lineStart = false; // Denote that the prefix has been displayed.
   }
 }
 
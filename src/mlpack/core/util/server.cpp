@@ -0,0 +1,116 @@
+/**
+ * @file server.cpp
+ *
+ * Implementation of ServerRequest and ServeRequests().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "server.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace mlpack;
+using namespace mlpack::util;
+
+ServerRequest::ServerRequest(const std::string& line,
+                             const std::vector<std::string>& allowed)
+{
+  const std::map<std::string, ParamData>& parameters = CLI::Parameters();
+  const std::map<char, std::string>& aliases = CLI::Aliases();
+
+  std::istringstream tokens(line);
+  std::string token;
+  while (tokens >> token)
+  {
+    // Find the parameter, by its command-line name or by its alias.
+    std::string identifier;
+    if (token.size() > 2 && token.compare(0, 2, "--") == 0)
+    {
+      const std::string boostName = token.substr(2);
+      std::map<std::string, ParamData>::const_iterator it;
+      for (it = parameters.begin(); it != parameters.end(); ++it)
+      {
+        if (it->second.boostName == boostName)
+        {
+          identifier = it->first;
+          break;
+        }
+      }
+    }
+    else if (token.size() == 2 && token[0] == '-' && aliases.count(token[1]))
+    {
+      identifier = aliases.at(token[1]);
+    }
+
+    if (identifier.empty())
+      throw std::invalid_argument("unknown option '" + token + "'");
+
+    if (std::find(allowed.begin(), allowed.end(), identifier) == allowed.end())
+      throw std::invalid_argument("option '" + token + "' cannot be given in "
+          "a request");
+
+    if (values.count(identifier))
+      throw std::invalid_argument("option '" + token + "' is given more than "
+          "once");
+
+    // Flags have no value.
+    if (parameters.at(identifier).isFlag)
+    {
+      values[identifier] = "1";
+      continue;
+    }
+
+    std::string value;
+    if (!(tokens >> value))
+      throw std::invalid_argument("option '" + token + "' has no value");
+
+    values[identifier] = value;
+  }
+}
+
+bool ServerRequest::HasParam(const std::string& identifier) const
+{
+  return values.count(identifier) > 0;
+}
+
+size_t mlpack::util::ServeRequests(
+    std::istream& input,
+    std::ostream& output,
+    const std::vector<std::string>& allowed,
+    const std::function<void(const ServerRequest&)>& handler)
+{
+  size_t failures = 0;
+  std::string line;
+  while (std::getline(input, line))
+  {
+    // Skip blank lines and comments.
+    const size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#')
+      continue;
+
+    const size_t end = line.find_last_not_of(" \t\r");
+    if (line.substr(start, end - start + 1) == "quit")
+      break;
+
+    try
+    {
+      ServerRequest request(line, allowed);
+      handler(request);
+      output << "ok" << std::endl;
+    }
+    catch (std::exception& e)
+    {
+      Log::Warn << "Request '" << line << "' failed: " << e.what()
+          << std::endl;
+      output << "error: " << e.what() << std::endl;
+      ++failures;
+    }
+  }
+
+  return failures;
+}
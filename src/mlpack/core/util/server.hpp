@@ -0,0 +1,102 @@
+/**
+ * @file server.hpp
+ *
+ * Support for running a command-line program as a server: the program loads its
+ * model once, and then answers requests read one per line from a stream (for
+ * instance standard input connected to a pipe), without paying the startup
+ * cost for every batch of queries.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_SERVER_HPP
+#define MLPACK_CORE_UTIL_SERVER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <functional>
+
+#include "cli.hpp"
+
+namespace mlpack {
+namespace util {
+
+/**
+ * A request to a program running as a server.  A request is one line holding
+ * options of the program, separated by whitespace, given with the same names
+ * and aliases as on the command line; for instance,
+ *
+ * @code
+ * --query_file queries.csv -k 5 --neighbors_file neighbors.csv
+ * @endcode
+ *
+ * Values cannot contain whitespace.  For matrix and model options, the value
+ * of the option is the name of the file, which the program loads or saves
+ * itself.
+ */
+class ServerRequest
+{
+ public:
+  /**
+   * Parse a request.  A std::invalid_argument is thrown if an option is not a
+   * parameter of the program, is not one of the options allowed in requests,
+   * is given twice, or has no value.
+   *
+   * @param line The options of the request.
+   * @param allowed Names of the parameters (as used with CLI::GetParam()) that
+   *     may be given in requests.
+   */
+  ServerRequest(const std::string& line,
+                const std::vector<std::string>& allowed);
+
+  //! Return whether the given parameter was given in the request.
+  bool HasParam(const std::string& identifier) const;
+
+  /**
+   * Get the value of the given parameter.  If the parameter was not given in
+   * the request, the value it was given when the server was started (or its
+   * default value) is returned, if it is of type T; otherwise, a
+   * std::invalid_argument is thrown.
+   *
+   * @param identifier Name of the parameter.
+   */
+  template<typename T>
+  T GetParam(const std::string& identifier) const;
+
+ private:
+  //! The values of the parameters given in the request, indexed by name.
+  std::map<std::string, std::string> values;
+};
+
+/**
+ * Answer requests read one per line from the given input stream, until it ends
+ * or a line "quit" is read; blank lines and lines starting with '#' are
+ * ignored.  Each request is passed to the handler, and then a line "ok" is
+ * written to the output stream, or, if the request is invalid or the handler
+ * throws an exception (as Log::Fatal does), a line "error: " followed by the
+ * message.  The output is flushed after every response, so that callers can
+ * wait for it.
+ *
+ * Requests are answered one at a time, in order; the handler should use the
+ * OpenMP threads for the work of each request.
+ *
+ * @param input Stream to read the requests from.
+ * @param output Stream to write the responses to.
+ * @param allowed Names of the parameters that may be given in requests.
+ * @param handler Function that answers a request.
+ * @return The number of requests that failed.
+ */
+size_t ServeRequests(
+    std::istream& input,
+    std::ostream& output,
+    const std::vector<std::string>& allowed,
+    const std::function<void(const ServerRequest&)>& handler);
+
+} // namespace util
+} // namespace mlpack
+
+// Include implementation.
+#include "server_impl.hpp"
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * @file server_impl.hpp
+ *
+ * Implementation of the templated functions of ServerRequest.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_SERVER_IMPL_HPP
+#define MLPACK_CORE_UTIL_SERVER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "server.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+namespace mlpack {
+namespace util {
+
+template<typename T>
+T ServerRequest::GetParam(const std::string& identifier) const
+{
+  std::map<std::string, std::string>::const_iterator it =
+      values.find(identifier);
+  if (it != values.end())
+  {
+    try
+    {
+      return boost::lexical_cast<T>(it->second);
+    }
+    catch (boost::bad_lexical_cast& /* e */)
+    {
+      throw std::invalid_argument("invalid value '" + it->second + "' for --" +
+          CLI::Parameters().at(identifier).boostName);
+    }
+  }
+
+  // Fall back to the value given when the server was started.
+  const ParamData& d = CLI::Parameters().at(identifier);
+  if (d.tname != TYPENAME(T))
+    throw std::invalid_argument("--" + d.boostName + " must be given");
+
+  return CLI::GetParam<T>(identifier);
+}
+
+} // namespace util
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * @file simd.hpp
+ *
+ * Definition of the MLPACK_SIMD and MLPACK_SIMD_REDUCTION macros, which mark a
+ * loop as safe to vectorize.  MLPACK_SIMD is for loops whose iterations are
+ * independent, but which the compiler cannot prove to be (for instance because
+ * they read through a lookup table).  Floating-point reductions are normally
+ * not vectorized by the compiler unless -ffast-math is given, because
+ * vectorizing them changes the order of the additions; MLPACK_SIMD_REDUCTION
+ * gives that permission for a single loop.  Both macros use OpenMP 4.0 'simd'
+ * directives, so they only have an effect when mlpack is compiled with OpenMP
+ * 4.0 or newer; otherwise, the loop is left alone.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_SIMD_HPP
+#define MLPACK_CORE_UTIL_SIMD_HPP
+
+#if defined(HAS_OPENMP) && defined(_OPENMP) && (_OPENMP >= 201307)
+  #define MLPACK_PRAGMA(x) _Pragma(#x)
+  #define MLPACK_SIMD MLPACK_PRAGMA(omp simd)
+  #define MLPACK_SIMD_REDUCTION(...) \
+      MLPACK_PRAGMA(omp simd reduction(__VA_ARGS__))
+#else
+  #define MLPACK_SIMD
+  #define MLPACK_SIMD_REDUCTION(...)
+#endif
+
+#endif
@@ -13,13 +13,162 @@
 #include "timers.hpp"
 #include "cli.hpp"
 #include "log.hpp"
+#include "memory_tracker.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 using namespace mlpack;
 using namespace std::chrono;
 
+namespace {
+
+//! An event of the trace: one run of a timer, a scoped timer or a span.
+struct TraceEvent
+{
+  //! Name of the timer or span.
+  std::string name;
+  //! The time at which the run started.
+  high_resolution_clock::time_point start;
+  //! The length of the run.
+  high_resolution_clock::duration duration;
+  //! The thread the run was on.
+  size_t thread;
+  //! The iteration of a span, or SIZE_MAX for a timer.
+  size_t iteration;
+};
+
+//! The time that the events of the trace are relative to.
+const high_resolution_clock::time_point traceEpoch =
+    high_resolution_clock::now();
+
+//! Whether or not the trace is being recorded.
+std::atomic<bool>& TracingFlag()
+{
+  static std::atomic<bool> tracing(false);
+  return tracing;
+}
+
+//! The times of the ScopedTimers of one thread.
+struct ThreadTimers
+{
+  //! Full name of the innermost running scoped timer.
+  std::string scope;
+  //! Time and number of calls of each scoped timer since the last merge.
+  std::map<std::string, std::pair<high_resolution_clock::duration, size_t>>
+      times;
+  //! The events of the trace recorded on this thread.
+  std::vector<TraceEvent> events;
+  //! Lock for the times and events; it is only contended while they are
+  //! merged or written.
+  std::mutex mutex;
+  //! Whether or not a thread currently owns this storage.
+  bool inUse = false;
+  //! The thread that currently owns this storage, as numbered in the trace.
+  size_t thread = 0;
+};
+
+//! Storage of every thread.  The elements of a std::list are never moved.
+std::list<ThreadTimers>& AllThreadTimers()
+{
+  static std::list<ThreadTimers> allThreadTimers;
+  return allThreadTimers;
+}
+
+//! Lock for the list of storage of every thread.
+std::mutex& AllThreadTimersMutex()
+{
+  static std::mutex allThreadTimersMutex;
+  return allThreadTimersMutex;
+}
+
+/**
+ * Hands storage to a thread when it first uses a scoped timer, and makes the
+ * storage available to other threads again when the thread exits.  Any times
+ * that have not been merged yet are kept.
+ */
+class ThreadTimersHandle
+{
+ public:
+  ThreadTimersHandle() : timers(NULL)
+  {
+    std::lock_guard<std::mutex> lock(AllThreadTimersMutex());
+    std::list<ThreadTimers>& allThreadTimers = AllThreadTimers();
+    for (ThreadTimers& t : allThreadTimers)
+    {
+      if (!t.inUse)
+      {
+        timers = &t;
+        break;
+      }
+    }
+
+    if (!timers)
+    {
+      allThreadTimers.emplace_back();
+      timers = &allThreadTimers.back();
+    }
+
+    // Threads are numbered in the order they first use a timer.
+    static size_t threads = 0;
+    timers->inUse = true;
+    timers->thread = threads++;
+  }
+
+  ~ThreadTimersHandle()
+  {
+    std::lock_guard<std::mutex> lock(AllThreadTimersMutex());
+    timers->scope.clear();
+    timers->inUse = false;
+  }
+
+  //! The storage of the thread.
+  ThreadTimers* timers;
+};
+
+//! Get the storage of the calling thread.
+ThreadTimers& LocalThreadTimers()
+{
+  thread_local ThreadTimersHandle handle;
+  return *handle.timers;
+}
+
+//! Record an event of the trace on the calling thread.
+void RecordEvent(const std::string& name,
+                 const high_resolution_clock::time_point start,
+                 const high_resolution_clock::time_point stop,
+                 const size_t iteration)
+{
+  ThreadTimers& threadTimers = LocalThreadTimers();
+  std::lock_guard<std::mutex> lock(threadTimers.mutex);
+  threadTimers.events.push_back(TraceEvent{ name, start, stop - start,
+      threadTimers.thread, iteration });
+}
+
+//! Write the given string to the given stream as a JSON string.
+void WriteJSONString(std::ostream& stream, const std::string& str)
+{
+  stream << '"';
+  for (const char c : str)
+  {
+    if (c == '"' || c == '\\')
+      stream << '\\' << c;
+    else if ((unsigned char) c < 0x20)
+      stream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+          << (int) c << std::dec << std::setfill(' ');
+    else
+      stream << c;
+  }
+  stream << '"';
+}
+
+} // anonymous namespace
+
 /**
  * Start the given timer.
  */
@@ -44,24 +193,208 @@ microseconds Timer::Get(const std::string& name)
   return CLI::GetSingleton().timer.GetTimer(name);
 }
 
+/**
+ * Get the number of calls of the given timer.
+ */
+size_t Timer::GetCalls(const std::string& name)
+{
+  return CLI::GetSingleton().timer.GetCalls(name);
+}
+
+/**
+ * Enable or disable the trace.
+ */
+void Timer::EnableTracing(const bool enable)
+{
+  TracingFlag().store(enable);
+}
+
+/**
+ * Return whether the trace is being recorded.
+ */
+bool Timer::Tracing()
+{
+  return TracingFlag().load(std::memory_order_relaxed);
+}
+
+ScopedTimer::ScopedTimer(const std::string& name)
+{
+  std::string& scope = LocalThreadTimers().scope;
+  parentLength = scope.size();
+  if (!scope.empty())
+    scope += '/';
+  scope += name;
+
+#ifdef MLPACK_MEMORY_TRACKING
+  MemoryTracker::StartPhase(scope);
+#endif
+
+  startTime = high_resolution_clock::now();
+}
+
+ScopedTimer::~ScopedTimer()
+{
+  const high_resolution_clock::time_point stopTime =
+      high_resolution_clock::now();
+
+  ThreadTimers& threadTimers = LocalThreadTimers();
+  {
+    std::lock_guard<std::mutex> lock(threadTimers.mutex);
+    std::pair<high_resolution_clock::duration, size_t>& time =
+        threadTimers.times[threadTimers.scope];
+    time.first += stopTime - startTime;
+    ++time.second;
+
+    if (Timer::Tracing())
+    {
+      threadTimers.events.push_back(TraceEvent{ threadTimers.scope, startTime,
+          stopTime - startTime, threadTimers.thread, SIZE_MAX });
+    }
+  }
+
+#ifdef MLPACK_MEMORY_TRACKING
+  MemoryTracker::StopPhase(threadTimers.scope);
+#endif
+
+  threadTimers.scope.resize(parentLength);
+}
+
+TraceSpan::TraceSpan(const char* name, const size_t iteration) :
+    name(name),
+    iteration(iteration),
+    active(Timer::Tracing())
+{
+  if (active)
+    startTime = high_resolution_clock::now();
+}
+
+TraceSpan::~TraceSpan()
+{
+  if (active)
+    RecordEvent(name, startTime, high_resolution_clock::now(), iteration);
+}
+
+void TraceSpan::Next()
+{
+  if (active)
+  {
+    const high_resolution_clock::time_point stopTime =
+        high_resolution_clock::now();
+    RecordEvent(name, startTime, stopTime, iteration);
+    startTime = stopTime;
+  }
+
+  ++iteration;
+}
+
 std::map<std::string, microseconds>& Timers::GetAllTimers()
 {
+  std::lock_guard<std::mutex> lock(timersMutex);
+  MergeScopedTimers();
   return timers;
 }
 
 microseconds Timers::GetTimer(const std::string& timerName)
 {
+  std::lock_guard<std::mutex> lock(timersMutex);
+  MergeScopedTimers();
   return timers[timerName];
 }
 
+size_t Timers::GetCalls(const std::string& timerName)
+{
+  std::lock_guard<std::mutex> lock(timersMutex);
+  MergeScopedTimers();
+  return timerCalls[timerName];
+}
+
 bool Timers::GetState(std::string timerName)
 {
+  std::lock_guard<std::mutex> lock(timersMutex);
   return timerState[timerName];
 }
 
+void Timers::AddTime(const std::string& timerName,
+                     const microseconds time,
+                     const size_t calls)
+{
+  std::lock_guard<std::mutex> lock(timersMutex);
+  timers[timerName] += time;
+  timerCalls[timerName] += calls;
+}
+
+void Timers::MergeScopedTimers()
+{
+  std::lock_guard<std::mutex> lock(AllThreadTimersMutex());
+  for (ThreadTimers& threadTimers : AllThreadTimers())
+  {
+    std::lock_guard<std::mutex> threadLock(threadTimers.mutex);
+    for (auto& time : threadTimers.times)
+    {
+      timers[time.first] += duration_cast<microseconds>(time.second.first);
+      timerCalls[time.first] += time.second.second;
+    }
+    threadTimers.times.clear();
+  }
+}
+
+void Timers::PrintJSON(std::ostream& stream)
+{
+  std::lock_guard<std::mutex> lock(timersMutex);
+  MergeScopedTimers();
+
+  stream << "{";
+  std::map<std::string, microseconds>::const_iterator it;
+  for (it = timers.begin(); it != timers.end(); ++it)
+  {
+    stream << ((it == timers.begin()) ? "\n  " : ",\n  ");
+    WriteJSONString(stream, it->first);
+    stream << ": { \"microseconds\": " << it->second.count()
+        << ", \"calls\": " << timerCalls[it->first] << " }";
+  }
+  stream << "\n}\n";
+}
+
+void Timers::PrintTrace(std::ostream& stream)
+{
+  // Gather the events of all the threads.
+  std::vector<TraceEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(AllThreadTimersMutex());
+    for (ThreadTimers& threadTimers : AllThreadTimers())
+    {
+      std::lock_guard<std::mutex> threadLock(threadTimers.mutex);
+      events.insert(events.end(), threadTimers.events.begin(),
+          threadTimers.events.end());
+    }
+  }
+
+  std::stable_sort(events.begin(), events.end(),
+      [](const TraceEvent& a, const TraceEvent& b)
+      {
+        return a.start < b.start;
+      });
+
+  stream << "{ \"traceEvents\": [";
+  for (size_t i = 0; i < events.size(); ++i)
+  {
+    stream << ((i == 0) ? "\n  " : ",\n  ") << "{ \"name\": ";
+    WriteJSONString(stream, events[i].name);
+    stream << ", \"ph\": \"X\", \"ts\": "
+        << duration_cast<microseconds>(events[i].start - traceEpoch).count()
+        << ", \"dur\": "
+        << duration_cast<microseconds>(events[i].duration).count()
+        << ", \"pid\": 0, \"tid\": " << events[i].thread;
+    if (events[i].iteration != SIZE_MAX)
+      stream << ", \"args\": { \"iteration\": " << events[i].iteration << " }";
+    stream << " }";
+  }
+  stream << "\n], \"displayTimeUnit\": \"ms\" }\n";
+}
+
 void Timers::PrintTimer(const std::string& timerName)
 {
-  microseconds totalDuration = timers[timerName];
+  microseconds totalDuration = GetTimer(timerName);
   // Convert microseconds to seconds.
   seconds totalDurationSec = duration_cast<seconds>(totalDuration);
   microseconds totalDurationMicroSec =
@@ -117,6 +450,10 @@ void Timers::PrintTimer(const std::string& timerName)
     Log::Info << ")";
   }
 
+  const size_t calls = GetCalls(timerName);
+  if (calls > 1)
+    Log::Info << " [" << calls << " calls]";
+
   Log::Info << std::endl;
 }
 
@@ -127,6 +464,7 @@ high_resolution_clock::time_point Timers::GetTime()
 
 void Timers::StartTimer(const std::string& timerName)
 {
+  std::lock_guard<std::mutex> lock(timersMutex);
   if ((timerState[timerName] == 1) && (timerName != "total_time"))
   {
     std::ostringstream error;
@@ -146,10 +484,15 @@ void Timers::StartTimer(const std::string& timerName)
   }
 
   timerStartTime[timerName] = currTime;
+
+#ifdef MLPACK_MEMORY_TRACKING
+  MemoryTracker::StartPhase(timerName);
+#endif
 }
 
 void Timers::StopTimer(const std::string& timerName)
 {
+  std::lock_guard<std::mutex> lock(timersMutex);
   if ((timerState[timerName] == 0) && (timerName != "total_time"))
   {
     std::ostringstream error;
@@ -165,4 +508,12 @@ void Timers::StopTimer(const std::string& timerName)
   // Calculate the delta time.
   timers[timerName] += duration_cast<microseconds>(currTime -
       timerStartTime[timerName]);
+  ++timerCalls[timerName];
+
+  if (Timer::Tracing())
+    RecordEvent(timerName, timerStartTime[timerName], currTime, SIZE_MAX);
+
+#ifdef MLPACK_MEMORY_TRACKING
+  MemoryTracker::StopPhase(timerName);
+#endif
 }
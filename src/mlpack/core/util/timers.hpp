@@ -14,6 +14,8 @@
 #define MLPACK_CORE_UTILITIES_TIMERS_HPP
 
 #include <map>
+#include <mutex>
+#include <ostream>
 #include <string>
 #include <chrono> // chrono library for cross platform timer calculation
 
@@ -67,6 +69,132 @@ class Timer
    * @param name Name of timer to return value of.
    */
   static std::chrono::microseconds Get(const std::string& name);
+
+  /**
+   * Get the number of times the given timer has been stopped (for a
+   * ScopedTimer, the number of times the scope was left).
+   *
+   * @param name Name of timer to return the number of calls of.
+   */
+  static size_t GetCalls(const std::string& name);
+
+  /**
+   * Enable or disable the recording of the trace of the program.  While the
+   * trace is recorded, each run of a timer, a ScopedTimer or a TraceSpan is
+   * recorded as an event, with its start time, its duration and the thread it
+   * ran on; Timers::PrintTrace() writes the events in the Chrome trace event
+   * format.  The command-line programs record the trace when --trace_file is
+   * given.
+   *
+   * @param enable Whether or not to record the trace.
+   */
+  static void EnableTracing(const bool enable = true);
+
+  //! Return whether or not the trace of the program is being recorded.
+  static bool Tracing();
+};
+
+/**
+ * A timer that runs for the lifetime of the object.  Scoped timers are meant
+ * for code that may run on several threads at once: each thread accumulates
+ * its times in its own storage, without taking any shared lock, and the
+ * per-thread times are summed into the program timers when the timers are read
+ * or printed.  The value of a scoped timer is therefore the total time spent
+ * in the scope by all threads.
+ *
+ * Scoped timers may be nested; the name of a nested timer is prefixed by the
+ * names of the scoped timers that enclose it on the same thread, separated by
+ * '/'.  For instance,
+ *
+ * @code
+ * {
+ *   ScopedTimer t("tree_building");
+ *   {
+ *     ScopedTimer t2("split");
+ *     ...
+ *   }
+ * }
+ * @endcode
+ *
+ * adds time to the timers "tree_building" and "tree_building/split".
+ */
+class ScopedTimer
+{
+ public:
+  /**
+   * Start the scoped timer with the given name.
+   *
+   * @param name Name of the timer, relative to the enclosing scoped timer.
+   */
+  explicit ScopedTimer(const std::string& name);
+
+  //! Stop the timer and add the elapsed time to it.
+  ~ScopedTimer();
+
+  //! Scoped timers cannot be copied.
+  ScopedTimer(const ScopedTimer&) = delete;
+  //! Scoped timers cannot be copied.
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  //! Length of the name of the enclosing scope.
+  size_t parentLength;
+  //! The time at which the timer was started.
+  std::chrono::high_resolution_clock::time_point startTime;
+};
+
+/**
+ * A span of time that is only recorded in the trace of the program (see
+ * Timer::EnableTracing()); unlike a ScopedTimer, it is not added to the
+ * program timers.  Spans are meant for the iterations of algorithms, so that
+ * the trace shows how long each iteration took.  When the trace is not
+ * recorded, a span costs no more than checking a flag.
+ *
+ * A span runs from its construction to its destruction, or to the next call
+ * of Next(), which records the span and starts the span of the next iteration
+ * with the same name:
+ *
+ * @code
+ * TraceSpan span("kmeans_iteration");
+ * for (size_t i = 0; i < iterations; ++i)
+ * {
+ *   ...
+ *   span.Next();
+ * }
+ * @endcode
+ */
+class TraceSpan
+{
+ public:
+  /**
+   * Start the span with the given name.  The name must outlive the span; it is
+   * meant to be a string literal.
+   *
+   * @param name Name of the span.
+   * @param iteration Number of the iteration of the span.
+   */
+  explicit TraceSpan(const char* name, const size_t iteration = 0);
+
+  //! Record the span.
+  ~TraceSpan();
+
+  //! Record the span, and start the span of the next iteration.
+  void Next();
+
+  //! Spans cannot be copied.
+  TraceSpan(const TraceSpan&) = delete;
+  //! Spans cannot be copied.
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  //! Name of the span.
+  const char* name;
+  //! Number of the iteration of the span.
+  size_t iteration;
+  //! Whether or not the span is recorded.
+  bool active;
+  //! The time at which the span was started.
+  std::chrono::high_resolution_clock::time_point startTime;
 };
 
 class Timers
@@ -80,6 +208,13 @@ class Timers
    */
   std::map<std::string, std::chrono::microseconds>& GetAllTimers();
 
+  /**
+   * Returns the number of times the given timer has been stopped.
+   *
+   * @param timerName The name of the timer in question.
+   */
+  size_t GetCalls(const std::string& timerName);
+
   /**
    * Returns a copy of the timer specified.
    *
@@ -95,6 +230,24 @@ class Timers
    */
   void PrintTimer(const std::string& timerName);
 
+  /**
+   * Write all timers to the given stream as a JSON object, mapping the name of
+   * each timer to its value in seconds and the number of times it was run.
+   *
+   * @param stream Stream to write to.
+   */
+  void PrintJSON(std::ostream& stream);
+
+  /**
+   * Write the trace of the program (see Timer::EnableTracing()) to the given
+   * stream in the Chrome trace event format, which chrome://tracing and
+   * Perfetto can display as a timeline.  Each event is a complete ("X") event,
+   * with its start time and duration in microseconds and the thread it ran on.
+   *
+   * @param stream Stream to write to.
+   */
+  void PrintTrace(std::ostream& stream);
+
   /**
    * Initializes a timer, available like a normal value specified on
    * the command line.  Timers are of type timeval.  If a timer is started, then
@@ -120,6 +273,18 @@ class Timers
    */
   bool GetState(std::string timerName);
 
+  /**
+   * Add the given time and number of calls to the given timer.  This is
+   * thread-safe.
+   *
+   * @param timerName The name of the timer in question.
+   * @param time Time to add.
+   * @param calls Number of calls to add.
+   */
+  void AddTime(const std::string& timerName,
+               const std::chrono::microseconds time,
+               const size_t calls);
+
  private:
   //! A map of all the timers that are being tracked.
   std::map<std::string, std::chrono::microseconds> timers;
@@ -128,8 +293,16 @@ class Timers
   //! A map for the starting values of the timers.
   std::map<std::string, std::chrono::high_resolution_clock::time_point>
       timerStartTime;
+  //! A map of the number of times each timer has been stopped.
+  std::map<std::string, size_t> timerCalls;
+  //! Lock for all of the maps.
+  std::mutex timersMutex;
 
   std::chrono::high_resolution_clock::time_point GetTime();
+
+  //! Sum the times of all ScopedTimers into the timers; timersMutex must be
+  //! held.
+  void MergeScopedTimers();
 };
 
 } // namespace mlpack
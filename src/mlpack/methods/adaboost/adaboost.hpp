@@ -66,10 +66,13 @@ namespace adaboost {
  *             const arma::rowvec& weights);
  *
  * // Given the test points, classify them and output predictions into
- * // predictedLabels.
+ * // predictedLabels (which has the right size already).
  * void Classify(const MatType& data, arma::Row<size_t>& predictedLabels);
  * @endcode
  *
+ * Weak learners classify blocks of points from several OpenMP threads at once,
+ * so Classify() must not modify the learner.
+ *
  * For more information on and examples of weak learners, see
  * perceptron::Perceptron<> and decision_stump::DecisionStump<>.
  *
@@ -147,7 +150,9 @@ class AdaBoost
              const double tolerance = 1e-6);
 
   /**
-   * Classify the given test points.
+   * Classify the given test points.  The points are taken in blocks that fit in
+   * the cache, in parallel, and every weak learner classifies a block before
+   * the next block is read, so the test set is only read from memory once.
    *
    * @param test Testing data.
    * @param predictedLabels Vector in which to the predicted labels of the test
@@ -30,6 +30,54 @@
 
 namespace mlpack {
 namespace adaboost {
+namespace details {
+
+/**
+ * Get the number of points of a block of the given dimensionality that fits in
+ * the cache (256kB of doubles).
+ */
+inline size_t BlockSize(const size_t dimensionality)
+{
+  return std::max((size_t) 32768 / std::max(dimensionality, (size_t) 1),
+      (size_t) 64);
+}
+
+/**
+ * Classify the points [begin, begin + count) of the given dataset with the
+ * given weak learner.  The block is passed to the learner as an alias of the
+ * dataset, without copying it.
+ */
+template<typename WeakLearnerType, typename eT>
+void ClassifyBlock(WeakLearnerType& learner,
+                   const arma::Mat<eT>& data,
+                   const size_t begin,
+                   const size_t count,
+                   arma::Row<size_t>& predictions)
+{
+  const arma::Mat<eT> block(const_cast<eT*>(data.colptr(begin)), data.n_rows,
+      count, false, true);
+  predictions.set_size(count);
+  learner.Classify(block, predictions);
+}
+
+/**
+ * Classify the points [begin, begin + count) of the given dataset with the
+ * given weak learner.  Matrices other than dense ones (sparse matrices, for
+ * instance) can't be aliased, so the block is copied.
+ */
+template<typename WeakLearnerType, typename MatType>
+void ClassifyBlock(WeakLearnerType& learner,
+                   const MatType& data,
+                   const size_t begin,
+                   const size_t count,
+                   arma::Row<size_t>& predictions)
+{
+  const MatType block(data.cols(begin, begin + count - 1));
+  predictions.set_size(count);
+  learner.Classify(block, predictions);
+}
+
+} // namespace details
 
 /**
  * Constructor. Currently runs the AdaBoost.MH algorithm.
@@ -85,12 +133,6 @@ void AdaBoost<WeakLearnerType, MatType>::Train(
   // To be used for prediction by the weak learner.
   arma::Row<size_t> predictedLabels(labels.n_cols);
 
-  // Use tempData to modify input data for incorporating weights.
-  MatType tempData(data);
-
-  // This matrix is a helper matrix used to calculate the final hypothesis.
-  arma::mat sumFinalH = arma::zeros<arma::mat>(classes, predictedLabels.n_cols);
-
   // Load the initial weights into a 2-D matrix.
   const double initWeight = 1.0 / double(data.n_cols * classes);
   arma::mat D(classes, data.n_cols);
@@ -99,8 +141,8 @@ void AdaBoost<WeakLearnerType, MatType>::Train(
   // Weights are stored in this row vector.
   arma::rowvec weights(predictedLabels.n_cols);
 
-  // This is the final hypothesis.
-  arma::Row<size_t> finalH(predictedLabels.n_cols);
+  const size_t blockSize = details::BlockSize(data.n_rows);
+  const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
 
   // Now, start the boosting rounds.
   for (size_t i = 0; i < iterations; i++)
@@ -117,19 +159,38 @@ void AdaBoost<WeakLearnerType, MatType>::Train(
     weights = arma::sum(D);
 
     // Use the existing weak learner to train a new one with new weights.
-    WeakLearnerType w(other, tempData, labels, weights);
-    w.Classify(tempData, predictedLabels);
-
-    // Now from predictedLabels, build ht, the weak hypothesis
-    // buildClassificationMatrix(ht, predictedLabels);
+    WeakLearnerType w(other, data, labels, weights);
 
-    // Now, calculate alpha(t) using ht.
-    for (size_t j = 0; j < D.n_cols; j++) // instead of D, ht
+    // Classify the dataset in parallel, one block at a time.  Since the
+    // weights of a point are the sum of its column of D, rt is computed at the
+    // same time.
+    #pragma omp parallel reduction(+:rt)
     {
-      if (predictedLabels(j) == labels(j))
-        rt += arma::accu(D.col(j));
-      else
-        rt -= arma::accu(D.col(j));
+      arma::Row<size_t> blockPredictions;
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables.
+      #pragma omp for schedule(static)
+      for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+      #pragma omp for schedule(static)
+      for (size_t b = 0; b < numBlocks; ++b)
+#endif
+      {
+        const size_t begin = b * blockSize;
+        const size_t count = std::min(blockSize, (size_t) data.n_cols - begin);
+        details::ClassifyBlock(w, data, begin, count, blockPredictions);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+          predictedLabels(begin + j) = blockPredictions(j);
+          if (blockPredictions(j) == labels(begin + j))
+            rt += weights(begin + j);
+          else
+            rt -= weights(begin + j);
+        }
+      }
     }
 
     if ((i > 0) && (std::abs(rt - crt) < tolerance))
@@ -153,46 +214,40 @@ void AdaBoost<WeakLearnerType, MatType>::Train(
     alpha.push_back(alphat);
     wl.push_back(w);
 
-    // Now start modifying the weights.
-    for (size_t j = 0; j < D.n_cols; j++)
+    // Now start modifying the weights; we calculate zt, the normalization
+    // constant, at the same time.
+    const double expo = exp(alphat);
+    #ifdef _WIN32
+      #pragma omp parallel for reduction(+:zt)
+      for (intmax_t j = 0; j < (intmax_t) D.n_cols; j++)
+    #else
+      #pragma omp parallel for reduction(+:zt)
+      for (size_t j = 0; j < D.n_cols; j++)
+    #endif
     {
-      const double expo = exp(alphat);
-      if (predictedLabels(j) == labels(j))
+      double* column = D.colptr(j);
+      const bool correct = (predictedLabels(j) == labels(j));
+      for (size_t k = 0; k < D.n_rows; k++)
       {
-        for (size_t k = 0; k < D.n_rows; k++)
-        {
-          // We calculate zt, the normalization constant.
-          D(k, j) /= expo;
-          zt += D(k, j); // * exp(-1 * alphat * yt(j,k) * ht(j,k));
-
-
-          // Add to the final hypothesis matrix.
-          // sumFinalH(k, j) += (alphat * ht(k, j));
-          if (k == labels(j))
-            sumFinalH(k, j) += (alphat); // * ht(k, j));
-          else
-            sumFinalH(k, j) -= (alphat);
-        }
-      }
-      else
-      {
-        for (size_t k = 0; k < D.n_rows; k++)
-        {
-          // We calculate zt, the normalization constant.
-          D(k, j) *= expo;
-          zt += D(k, j);
-
-          // Add to the final hypothesis matrix.
-          if (k == labels(j))
-            sumFinalH(k, j) += alphat; // * ht(k, j));
-          else
-            sumFinalH(k, j) -= alphat;
-        }
+        if (correct)
+          column[k] /= expo;
+        else
+          column[k] *= expo;
+        zt += column[k];
       }
     }
 
     // Normalize D.
-    D /= zt;
+    #ifdef _WIN32
+      #pragma omp parallel for
+      for (intmax_t j = 0; j < (intmax_t) D.n_cols; j++)
+    #else
+      #pragma omp parallel for
+      for (size_t j = 0; j < D.n_cols; j++)
+    #endif
+    {
+      D.unsafe_col(j) /= zt;
+    }
 
     // Accumulate the value of zt for the Hamming loss bound.
     ztProduct *= zt;
@@ -207,28 +262,46 @@ void AdaBoost<WeakLearnerType, MatType>::Classify(
     const MatType& test,
     arma::Row<size_t>& predictedLabels)
 {
-  arma::Row<size_t> tempPredictedLabels(test.n_cols);
-  arma::mat cMatrix(classes, test.n_cols);
-
-  cMatrix.zeros();
   predictedLabels.set_size(test.n_cols);
 
-  for (size_t i = 0; i < wl.size(); i++)
-  {
-    wl[i].Classify(test, tempPredictedLabels);
+  // Each block of points is classified by every weak learner while it is in
+  // the cache, and only the scores of the block are kept.
+  const size_t blockSize = details::BlockSize(test.n_rows);
+  const size_t numBlocks = (test.n_cols + blockSize - 1) / blockSize;
 
-    for (size_t j = 0; j < tempPredictedLabels.n_cols; j++)
-      cMatrix(tempPredictedLabels(j), j) += alpha[i];
-  }
+  #pragma omp parallel
+  {
+    arma::Row<size_t> blockPredictions;
+    arma::mat scores;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * blockSize;
+      const size_t count = std::min(blockSize, (size_t) test.n_cols - begin);
+      scores.zeros(classes, count);
 
-  arma::colvec cMRow;
-  arma::uword maxIndex = 0;
+      for (size_t i = 0; i < wl.size(); i++)
+      {
+        details::ClassifyBlock(wl[i], test, begin, count, blockPredictions);
+        for (size_t j = 0; j < count; j++)
+          scores(blockPredictions(j), j) += alpha[i];
+      }
 
-  for (size_t i = 0; i < predictedLabels.n_cols; i++)
-  {
-    cMRow = cMatrix.unsafe_col(i);
-    cMRow.max(maxIndex);
-    predictedLabels(i) = maxIndex;
+      arma::uword maxIndex = 0;
+      for (size_t j = 0; j < count; j++)
+      {
+        scores.unsafe_col(j).max(maxIndex);
+        predictedLabels(begin + j) = maxIndex;
+      }
+    }
   }
 }
 
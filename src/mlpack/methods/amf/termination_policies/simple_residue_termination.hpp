@@ -68,10 +68,14 @@ class SimpleResidueTermination
   bool IsConverged(arma::mat& W, arma::mat& H)
   {
     // Calculate the norm and compute the residue, but do it by hand, so as to
-    // avoid calculating (W*H), which may be very large.
+    // avoid calculating (W*H), which may be very large.  The norm of column j
+    // of WH is sqrt(h_j^T (W^T W) h_j), so only the r x r Gram matrix of W is
+    // needed.
+    const arma::mat gram = W.t() * W;
+    const arma::rowvec squaredNorms = arma::sum(H % (gram * H), 0);
     double norm = 0.0;
     for (size_t j = 0; j < H.n_cols; ++j)
-      norm += arma::norm(W * H.col(j), "fro");
+      norm += std::sqrt(std::max(squaredNorms[j], 0.0));
     residue = fabs(normOld - norm) / normOld;
 
     // Store the norm.
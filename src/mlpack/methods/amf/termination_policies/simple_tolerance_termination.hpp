@@ -68,30 +68,10 @@ class SimpleToleranceTermination
    */
   bool IsConverged(arma::mat& W, arma::mat& H)
   {
-    arma::mat WH;
-
-    WH = W * H;
-
     // compute residue
     residueOld = residue;
-    size_t n = V->n_rows;
-    size_t m = V->n_cols;
-    double sum = 0;
     size_t count = 0;
-    for (size_t i = 0; i < n; i++)
-    {
-        for (size_t j = 0; j < m; j++)
-        {
-            double temp = 0;
-            if ((temp = (*V)(i, j)) != 0)
-            {
-                temp = (temp - WH(i, j));
-                temp = temp * temp;
-                sum += temp;
-                count++;
-            }
-        }
-    }
+    const double sum = SquaredError(*V, W, H, count);
     residue = sum / count;
     residue = sqrt(residue);
 
@@ -160,6 +140,81 @@ class SimpleToleranceTermination
   double& Tolerance() { return tolerance; }
 
  private:
+  /**
+   * Compute the sum of the squared errors of WH on the nonzero entries of the
+   * given dense matrix, and count those entries.
+   */
+  template<typename DenseMatType>
+  static double SquaredError(const DenseMatType& V,
+                             const arma::mat& W,
+                             const arma::mat& H,
+                             size_t& count)
+  {
+    const arma::mat WH = W * H;
+
+    double sum = 0;
+    count = 0;
+    for (size_t j = 0; j < V.n_cols; j++)
+    {
+      for (size_t i = 0; i < V.n_rows; i++)
+      {
+        const double value = V(i, j);
+        if (value != 0)
+        {
+          const double error = value - WH(i, j);
+          sum += error * error;
+          count++;
+        }
+      }
+    }
+
+    return sum;
+  }
+
+  /**
+   * Compute the sum of the squared errors of WH on the nonzero entries of the
+   * given sparse matrix, and count those entries.  Only the observed entries of
+   * WH are computed, so the cost is proportional to the number of nonzero
+   * entries times the rank.
+   */
+  static double SquaredError(const arma::sp_mat& V,
+                             const arma::mat& W,
+                             const arma::mat& H,
+                             size_t& count)
+  {
+    // The rows of W are needed contiguously.
+    const arma::mat Wt = W.t();
+    V.sync();
+
+    double sum = 0;
+    size_t nonzeros = 0;
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for reduction(+:sum, nonzeros)
+    for (intmax_t j = 0; j < (intmax_t) V.n_cols; ++j)
+#else
+    #pragma omp parallel for reduction(+:sum, nonzeros)
+    for (size_t j = 0; j < V.n_cols; ++j)
+#endif
+    {
+      for (size_t k = V.col_ptrs[j]; k < V.col_ptrs[j + 1]; ++k)
+      {
+        const double value = V.values[k];
+        if (value != 0)
+        {
+          const double error = value - arma::dot(Wt.col(V.row_indices[k]),
+              H.col(j));
+          sum += error * error;
+          nonzeros++;
+        }
+      }
+    }
+
+    count = nonzeros;
+    return sum;
+  }
+
   //! tolerance
   double tolerance;
   //! iteration threshold
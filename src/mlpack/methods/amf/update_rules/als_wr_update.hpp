@@ -0,0 +1,203 @@
+/**
+ * @file als_wr_update.hpp
+ *
+ * Alternating least squares update rule with weighted-lambda regularization
+ * for AMF on sparse rating matrices.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_ALS_WR_UPDATE_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_ALS_WR_UPDATE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class implements alternating least squares with weighted-lambda
+ * regularization (ALS-WR), as described in the following paper:
+ *
+ * @code
+ * @inproceedings{zhou2008large,
+ *   title={Large-scale parallel collaborative filtering for the Netflix
+ *       prize},
+ *   author={Zhou, Y. and Wilkinson, D. and Schreiber, R. and Pan, R.},
+ *   booktitle={Algorithmic Aspects in Information and Management},
+ *   pages={337--348},
+ *   year={2008}
+ * }
+ * @endcode
+ *
+ * Only the nonzero elements of the input matrix V (the ratings) are fitted.
+ * When W is updated with H held constant, each row of W is the solution of an
+ * independent r x r regularized least squares problem over the ratings of that
+ * item; the same holds for each column of H when H is updated.  These problems
+ * are solved in parallel, if OpenMP is available, and nothing of size n x m is
+ * ever formed.  The regularization of each problem is lambda times the number
+ * of ratings it involves.
+ *
+ * The ratings of each item are the columns of the transpose of V, which is
+ * stored by Initialize().  Dense input matrices are converted to sparse
+ * matrices.
+ */
+class ALSWRUpdate
+{
+ public:
+  /**
+   * Create the update rule with the given regularization parameter.
+   *
+   * @param lambda Regularization parameter (multiplied by the number of
+   *     ratings of each least squares problem).
+   */
+  ALSWRUpdate(const double lambda = 0.05) : lambda(lambda) { }
+
+  /**
+   * Store the transpose of the input matrix, which holds the ratings of each
+   * item in a column.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank Rank of the factorization.
+   */
+  template<typename MatType>
+  void Initialize(const MatType& dataset, const size_t /* rank */)
+  {
+    dataT = arma::trans(arma::sp_mat(dataset));
+  }
+
+  /**
+   * The update rule for the basis matrix W.  Each row of W is set to the
+   * regularized least squares fit of the ratings of that item, given H.
+   *
+   * @param V Input matrix to be factorized (its transpose was stored by
+   *     Initialize()).
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  inline void WUpdate(const MatType& /* V */,
+                      arma::mat& W,
+                      const arma::mat& H)
+  {
+    arma::mat wT;
+    Solve(dataT, H, wT);
+    W = wT.t();
+  }
+
+  /**
+   * The update rule for the encoding matrix H.  Each column of H is set to the
+   * regularized least squares fit of the ratings of that user, given W.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  inline void HUpdate(const arma::sp_mat& V,
+                      const arma::mat& W,
+                      arma::mat& H)
+  {
+    Solve(V, W.t(), H);
+  }
+
+  //! The update rule for the encoding matrix H, for dense input matrices.
+  template<typename MatType>
+  inline void HUpdate(const MatType& V,
+                      const arma::mat& W,
+                      arma::mat& H)
+  {
+    HUpdate(arma::sp_mat(V), W, H);
+  }
+
+  //! Get the regularization parameter.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter.
+  double& Lambda() { return lambda; }
+
+  //! Serialize the update rule.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(lambda, "lambda");
+  }
+
+  /**
+   * Solve the regularized least squares problem of each column of the given
+   * ratings: column j of the result is the vector x minimizing
+   *
+   *   sum_i (ratings(i, j) - factors.col(i)^T x)^2 + lambda n_j ||x||^2
+   *
+   * over the n_j nonzero elements ratings(i, j) of the column.  A column with
+   * no ratings gets a zero vector.  The problems are solved in parallel, if
+   * OpenMP is available; this is also used by BlockALSWRUpdate.
+   */
+  void Solve(const arma::sp_mat& ratings,
+             const arma::mat& factors,
+             arma::mat& result) const
+  {
+    const size_t rank = factors.n_rows;
+    result.set_size(rank, ratings.n_cols);
+
+    #pragma omp parallel
+    {
+      arma::uvec indices;
+      arma::vec values;
+      arma::vec solution;
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables.
+      #pragma omp for schedule(dynamic, 64)
+      for (intmax_t j = 0; j < (intmax_t) ratings.n_cols; ++j)
+#else
+      #pragma omp for schedule(dynamic, 64)
+      for (size_t j = 0; j < ratings.n_cols; ++j)
+#endif
+      {
+        size_t count = 0;
+        for (arma::sp_mat::const_iterator it = ratings.begin_col(j);
+             it != ratings.end_col(j); ++it)
+          ++count;
+
+        if (count == 0)
+        {
+          result.col(j).zeros();
+          continue;
+        }
+
+        indices.set_size(count);
+        values.set_size(count);
+        size_t k = 0;
+        for (arma::sp_mat::const_iterator it = ratings.begin_col(j);
+             it != ratings.end_col(j); ++it, ++k)
+        {
+          indices[k] = it.row();
+          values[k] = (*it);
+        }
+
+        // Form the normal equations from the factors of the rated elements.
+        const arma::mat f = factors.cols(indices);
+        arma::mat gram = f * f.t();
+        gram.diag() += lambda * count;
+
+        if (arma::solve(solution, gram, f * values))
+          result.col(j) = solution;
+        else
+          result.col(j).zeros();
+      }
+    }
+  }
+
+ private:
+  //! Regularization parameter.
+  double lambda;
+  //! Transpose of the input matrix.
+  arma::sp_mat dataT;
+}; // class ALSWRUpdate
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @file block_als_wr_update.hpp
+ *
+ * Alternating least squares update rule with weighted-lambda regularization,
+ * with the ratings partitioned into blocks of users and blocks of items.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_BLOCK_ALS_WR_UPDATE_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_BLOCK_ALS_WR_UPDATE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "als_wr_update.hpp"
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class implements the same ALS-WR iterations as ALSWRUpdate, with the
+ * ratings partitioned the way a distributed ALS partitions them (as in Zhou
+ * et al., 2008): the users are split into blocks of consecutive columns of V,
+ * and the items into blocks of consecutive rows of V.  Each user block holds
+ * the ratings of its users, and solves their columns of H; each item block
+ * holds the ratings of its items, and solves their rows of W.  The ratings of
+ * a block are indexed by the factors it needs, which are the only factors
+ * that block has to receive in each half-iteration: a user block only needs
+ * the rows of W of the items its users rated, and an item block only needs
+ * the columns of H of the users who rated its items.  ExchangedFactors() gives
+ * the number of factor vectors that are received in each iteration.
+ *
+ * The blocks are built once by Initialize(); the factorization is the same as
+ * that of ALSWRUpdate.
+ */
+class BlockALSWRUpdate
+{
+ public:
+  /**
+   * Create the update rule with the given regularization parameter and
+   * number of blocks.
+   *
+   * @param lambda Regularization parameter (multiplied by the number of
+   *     ratings of each least squares problem).
+   * @param numBlocks Number of user blocks and of item blocks.
+   */
+  BlockALSWRUpdate(const double lambda = 0.05, const size_t numBlocks = 4) :
+      solver(lambda),
+      numBlocks(numBlocks)
+  {
+    if (numBlocks == 0)
+      throw std::invalid_argument("BlockALSWRUpdate: numBlocks must be "
+          "positive");
+  }
+
+  /**
+   * Partition the ratings of the input matrix into user blocks and item
+   * blocks.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank Rank of the factorization.
+   */
+  template<typename MatType>
+  void Initialize(const MatType& dataset, const size_t /* rank */)
+  {
+    const arma::sp_mat data(dataset);
+    Partition(data, userBlocks, userBlockItems, userOffsets);
+    Partition(arma::sp_mat(data.t()), itemBlocks, itemBlockUsers, itemOffsets);
+  }
+
+  /**
+   * The update rule for the basis matrix W.  Each item block solves its rows
+   * of W from the columns of H that it needs.
+   *
+   * @param V Input matrix to be factorized (its blocks were stored by
+   *     Initialize()).
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  inline void WUpdate(const MatType& /* V */,
+                      arma::mat& W,
+                      const arma::mat& H)
+  {
+    W.set_size(itemOffsets.back(), H.n_rows);
+    arma::mat wT;
+    for (size_t b = 0; b < itemBlocks.size(); ++b)
+    {
+      solver.Solve(itemBlocks[b], H.cols(itemBlockUsers[b]), wT);
+      if (wT.n_cols > 0)
+        W.rows(itemOffsets[b], itemOffsets[b + 1] - 1) = wT.t();
+    }
+  }
+
+  /**
+   * The update rule for the encoding matrix H.  Each user block solves its
+   * columns of H from the rows of W that it needs.
+   *
+   * @param V Input matrix to be factorized (its blocks were stored by
+   *     Initialize()).
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  template<typename MatType>
+  inline void HUpdate(const MatType& /* V */,
+                      const arma::mat& W,
+                      arma::mat& H)
+  {
+    H.set_size(W.n_cols, userOffsets.back());
+    const arma::mat wT = W.t();
+    arma::mat h;
+    for (size_t b = 0; b < userBlocks.size(); ++b)
+    {
+      solver.Solve(userBlocks[b], wT.cols(userBlockItems[b]), h);
+      if (h.n_cols > 0)
+        H.cols(userOffsets[b], userOffsets[b + 1] - 1) = h;
+    }
+  }
+
+  /**
+   * Get the number of factor vectors that the blocks receive in each
+   * iteration: the rows of W needed by the user blocks, plus the columns of H
+   * needed by the item blocks.
+   */
+  size_t ExchangedFactors() const
+  {
+    size_t exchanged = 0;
+    for (size_t b = 0; b < userBlockItems.size(); ++b)
+      exchanged += userBlockItems[b].n_elem;
+    for (size_t b = 0; b < itemBlockUsers.size(); ++b)
+      exchanged += itemBlockUsers[b].n_elem;
+    return exchanged;
+  }
+
+  //! Get the regularization parameter.
+  double Lambda() const { return solver.Lambda(); }
+  //! Modify the regularization parameter.
+  double& Lambda() { return solver.Lambda(); }
+
+  //! Get the number of user blocks and of item blocks.
+  size_t NumBlocks() const { return numBlocks; }
+
+  //! Serialize the update rule.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(solver, "solver");
+    ar & data::CreateNVP(numBlocks, "numBlocks");
+  }
+
+ private:
+  /**
+   * Split the columns of the given ratings into blocks of consecutive
+   * columns.  The rows of each block are reduced to the rows it has ratings
+   * in, whose indices are stored in needed; offsets holds the first column of
+   * each block, and the number of columns.
+   */
+  void Partition(const arma::sp_mat& ratings,
+                 std::vector<arma::sp_mat>& blocks,
+                 std::vector<arma::uvec>& needed,
+                 std::vector<size_t>& offsets) const
+  {
+    const size_t count = std::max((size_t) 1, std::min(numBlocks,
+        (size_t) ratings.n_cols));
+    blocks.resize(count);
+    needed.resize(count);
+    offsets.resize(count + 1);
+
+    arma::uvec localRows(ratings.n_rows);
+    for (size_t b = 0; b < count; ++b)
+    {
+      offsets[b] = (b * ratings.n_cols) / count;
+      const size_t end = ((b + 1) * ratings.n_cols) / count;
+
+      // Find the rows that this block has ratings in.
+      localRows.fill(ratings.n_rows);
+      for (size_t j = offsets[b]; j < end; ++j)
+        for (arma::sp_mat::const_iterator it = ratings.begin_col(j);
+             it != ratings.end_col(j); ++it)
+          localRows[it.row()] = 0;
+      needed[b] = arma::find(localRows == 0);
+      for (size_t i = 0; i < needed[b].n_elem; ++i)
+        localRows[needed[b][i]] = i;
+
+      // The local rows keep the order of the rows, so each least squares
+      // problem is formed exactly as ALSWRUpdate forms it.
+      size_t nonzeros = 0;
+      for (size_t j = offsets[b]; j < end; ++j)
+        nonzeros += ratings.col(j).n_nonzero;
+      arma::umat locations(2, nonzeros);
+      arma::vec values(nonzeros);
+      size_t k = 0;
+      for (size_t j = offsets[b]; j < end; ++j)
+      {
+        for (arma::sp_mat::const_iterator it = ratings.begin_col(j);
+             it != ratings.end_col(j); ++it, ++k)
+        {
+          locations(0, k) = localRows[it.row()];
+          locations(1, k) = j - offsets[b];
+          values[k] = (*it);
+        }
+      }
+
+      blocks[b] = arma::sp_mat(locations, values, needed[b].n_elem,
+          end - offsets[b]);
+    }
+    offsets[count] = ratings.n_cols;
+  }
+
+  //! The solver of the least squares problems.
+  ALSWRUpdate solver;
+  //! Number of user blocks and of item blocks.
+  size_t numBlocks;
+
+  //! The ratings of each user block, with one row for each item it needs.
+  std::vector<arma::sp_mat> userBlocks;
+  //! The items (rows of W) needed by each user block.
+  std::vector<arma::uvec> userBlockItems;
+  //! The first user of each user block, and the number of users.
+  std::vector<size_t> userOffsets;
+
+  //! The ratings of each item block, with one row for each user it needs.
+  std::vector<arma::sp_mat> itemBlocks;
+  //! The users (columns of H) needed by each item block.
+  std::vector<arma::uvec> itemBlockUsers;
+  //! The first item of each item block, and the number of items.
+  std::vector<size_t> itemOffsets;
+}; // class BlockALSWRUpdate
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
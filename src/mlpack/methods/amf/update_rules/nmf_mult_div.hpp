@@ -41,9 +41,10 @@ namespace amf {
  * is non-increasing between subsequent iterations. Both of the update rules
  * for W and H are defined in this file.
  *
- * This set of update rules is not meant to work with sparse matrices.  Using
- * sparse matrices often causes NaNs in the output, so other choices of update
- * rules are better in that situation.
+ * For sparse matrices, the ratios V / (W H) are only computed at the nonzero
+ * entries of V (the others are zero), so an iteration takes time proportional
+ * to the number of nonzero entries times the rank, instead of to the size of
+ * V times the rank.
  */
 class NMFMultiplicativeDivergenceUpdate
 {
@@ -105,6 +106,26 @@ class NMFMultiplicativeDivergenceUpdate
     }
   }
 
+  /**
+   * The update rule for the basis matrix W, for a sparse input matrix.  The
+   * formula is the same as for a dense matrix, but (W H) is only computed at
+   * the nonzero entries of V.
+   *
+   * @param V Sparse input matrix to be factorized.
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  inline static void WUpdate(const arma::sp_mat& V,
+                             arma::mat& W,
+                             const arma::mat& H)
+  {
+    arma::sp_mat ratio;
+    Ratio(V, W, H, ratio);
+
+    W %= ratio * H.t();
+    W.each_row() /= arma::trans(arma::sum(H, 1));
+  }
+
   /**
    * The update rule for the encoding matrix H. The formula used is
    *
@@ -149,9 +170,67 @@ class NMFMultiplicativeDivergenceUpdate
     }
   }
 
+  /**
+   * The update rule for the encoding matrix H, for a sparse input matrix.  The
+   * formula is the same as for a dense matrix, but (W H) is only computed at
+   * the nonzero entries of V.
+   *
+   * @param V Sparse input matrix to be factorized.
+   * @param W Basis matrix.
+   * @param H Encoding matrix to updated.
+   */
+  inline static void HUpdate(const arma::sp_mat& V,
+                             const arma::mat& W,
+                             arma::mat& H)
+  {
+    arma::sp_mat ratio;
+    Ratio(V, W, H, ratio);
+
+    H %= W.t() * ratio;
+    H.each_col() /= arma::trans(arma::sum(W, 0));
+  }
+
   //! Serialize the object (in this case, there is nothing to serialize).
   template<typename Archive>
   void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
+
+ private:
+  /**
+   * Compute the sparse matrix with the nonzero pattern of V whose entries are
+   * V_{ij} / (W H)_{ij}.  Only the entries of W H at the nonzero entries of V
+   * are computed, and the columns are processed in parallel.
+   */
+  static void Ratio(const arma::sp_mat& V,
+                    const arma::mat& W,
+                    const arma::mat& H,
+                    arma::sp_mat& ratio)
+  {
+    // The rows of W are needed contiguously.
+    const arma::mat Wt = W.t();
+    V.sync();
+
+    arma::vec values(V.n_nonzero);
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t j = 0; j < (intmax_t) V.n_cols; ++j)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < V.n_cols; ++j)
+#endif
+    {
+      for (size_t k = V.col_ptrs[j]; k < V.col_ptrs[j + 1]; ++k)
+      {
+        values[k] = V.values[k] / arma::dot(Wt.col(V.row_indices[k]),
+            H.col(j));
+      }
+    }
+
+    const arma::uvec rowIndices(V.row_indices, V.n_nonzero);
+    const arma::uvec colPointers(V.col_ptrs, V.n_cols + 1);
+    ratio = arma::sp_mat(rowIndices, colPointers, values, V.n_rows, V.n_cols);
+  }
 };
 
 } // namespace amf
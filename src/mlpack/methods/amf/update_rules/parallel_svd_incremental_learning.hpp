@@ -0,0 +1,169 @@
+/**
+ * @file parallel_svd_incremental_learning.hpp
+ *
+ * Lock-free parallel SVD incremental learning, used in AMF (Alternating Matrix
+ * Factorization).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_PARALLEL_SVD_INCREMENTAL_LEARNING_HPP
+#define MLPACK_METHODS_AMF_PARALLEL_SVD_INCREMENTAL_LEARNING_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class computes SVD with incremental learning, like
+ * SVDIncompleteIncrementalLearning and SVDCompleteIncrementalLearning, but
+ * visits the users in parallel without any locks, as in the following paper:
+ *
+ * @code
+ * @inproceedings{niu2011hogwild,
+ *   title={Hogwild!: A lock-free approach to parallelizing stochastic gradient
+ *       descent},
+ *   author={Niu, F. and Recht, B. and R{\'e}, C. and Wright, S. J.},
+ *   booktitle={Advances in Neural Information Processing Systems},
+ *   pages={693--701},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * Each call to WUpdate() takes one pass over all the nonzero elements (the
+ * ratings) of V: for each rating, the feature vector of its item in W and the
+ * feature vector of its user in H are both moved along the gradient of the
+ * error of the rating.  Each user is handled by one thread, so the updates of H
+ * do not conflict; the updates of the rows of W from different threads are not
+ * synchronized, which is harmless when the ratings are sparse.  HUpdate() does
+ * nothing.  Because each iteration is a pass over the data, this should be
+ * used with a termination policy like SimpleResidueTermination or
+ * MaxIterationTermination instead of the incremental termination policies.
+ *
+ * Dense input matrices are converted to sparse matrices.
+ *
+ * @see SVDIncompleteIncrementalLearning, SVDCompleteIncrementalLearning
+ */
+class ParallelSVDIncrementalLearning
+{
+ public:
+  /**
+   * Initialize the parameters of ParallelSVDIncrementalLearning.
+   *
+   * @param u Step value used in incremental learning.
+   * @param kw Regularization constant for W matrix.
+   * @param kh Regularization constant for H matrix.
+   */
+  ParallelSVDIncrementalLearning(double u = 0.001,
+                                 double kw = 0,
+                                 double kh = 0)
+      : u(u), kw(kw), kh(kh)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Initialize parameters before factorization.  There is nothing to do.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank rank of factorization
+   */
+  template<typename MatType>
+  void Initialize(const MatType& /* dataset */, const size_t /* rank */)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Take one pass over all the ratings, updating both W and H.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix to be updated.
+   */
+  inline void WUpdate(const arma::sp_mat& V,
+                      arma::mat& W,
+                      arma::mat& H)
+  {
+    // The feature vector of each item is made contiguous.
+    arma::mat wT = W.t();
+    const size_t rank = wT.n_rows;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (intmax_t j = 0; j < (intmax_t) V.n_cols; ++j)
+#else
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (size_t j = 0; j < V.n_cols; ++j)
+#endif
+    {
+      double* h = H.colptr(j);
+      for (arma::sp_mat::const_iterator it = V.begin_col(j);
+           it != V.end_col(j); ++it)
+      {
+        double* w = wT.colptr(it.row());
+
+        double error = (*it);
+        for (size_t k = 0; k < rank; ++k)
+          error -= w[k] * h[k];
+
+        for (size_t k = 0; k < rank; ++k)
+        {
+          const double wk = w[k];
+          w[k] += u * (error * h[k] - kw * wk);
+          h[k] += u * (error * wk - kh * h[k]);
+        }
+      }
+    }
+
+    W = wT.t();
+  }
+
+  //! Take one pass over all the ratings of a dense input matrix.
+  template<typename MatType>
+  inline void WUpdate(const MatType& V,
+                      arma::mat& W,
+                      arma::mat& H)
+  {
+    WUpdate(arma::sp_mat(V), W, H);
+  }
+
+  /**
+   * The update rule for the encoding matrix H.  H was already updated by
+   * WUpdate(), so there is nothing to do.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  inline void HUpdate(const MatType& /* V */,
+                      const arma::mat& /* W */,
+                      arma::mat& /* H */)
+  {
+    // Nothing to do.
+  }
+
+  //! Get the step size.
+  double StepSize() const { return u; }
+  //! Modify the step size.
+  double& StepSize() { return u; }
+
+ private:
+  //! Step size of incremental learning.
+  double u;
+  //! Regularization parameter for W matrix.
+  double kw;
+  //! Regularization parameter for H matrix.
+  double kh;
+}; // class ParallelSVDIncrementalLearning
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * @file cached_fft_convolution.hpp
+ *
+ * Implementation of the convolution through fft, with the spectra of the
+ * filters and input maps computed once and reused by the Convolution layer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_CACHED_FFT_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_CACHED_FFT_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "border_modes.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the two-dimensional convolution through fft, with the same
+ * orientation of the filter as NaiveConvolution (the filter is not flipped),
+ * and with support for strides.  This class allows specification of the type
+ * of the border type, like NaiveConvolution.
+ *
+ * FullConvolution: returns the full two-dimensional convolution.
+ * ValidConvolution: returns only those parts of the convolution that are
+ * computed without the zero-padded edges.
+ *
+ * When a rule of the Convolution layer is CachedFFTConvolution, the layer works
+ * in the frequency domain: the spectrum of each filter is computed once per
+ * change of the parameters, at the size of the (padded) input maps, and kept
+ * until the parameters change; all the input maps are transformed once per
+ * call; and the products are summed over the input maps (or the output maps,
+ * for Backward()) in the frequency domain, so that each output map takes a
+ * single inverse fft.  Since (ignoring strides) the input maps are at least as
+ * large as any linear convolution or correlation the layer computes, the
+ * circular convolutions of the fft never wrap around.
+ *
+ * @tparam BorderMode Type of the border mode (FullConvolution or
+ * ValidConvolution).
+ */
+template<typename BorderMode = FullConvolution>
+class CachedFFTConvolution
+{
+ public:
+  /**
+   * Compute the two-dimensional fft of each slice of the given maps, zero
+   * padded to the given size.
+   *
+   * @param maps Maps to transform (one per slice).
+   * @param rows Number of rows of the transforms.
+   * @param cols Number of columns of the transforms.
+   * @param spectra Cube to store the transforms in (one per slice).
+   */
+  template<typename eT>
+  static void Spectra(const arma::Cube<eT>& maps,
+                      const size_t rows,
+                      const size_t cols,
+                      arma::Cube<std::complex<eT> >& spectra)
+  {
+    spectra.set_size(rows, cols, maps.n_slices);
+    for (size_t i = 0; i < maps.n_slices; ++i)
+      spectra.slice(i) = arma::fft2(maps.slice(i), rows, cols);
+  }
+
+  /**
+   * Take every dW-th row and every dH-th column of the given stride 1
+   * correlation, starting at the first, and store them in the given output,
+   * which must already have its final size.
+   *
+   * @param correlation Result of the correlation with a stride of 1.
+   * @param dW Stride of filter application in the x direction (rows).
+   * @param dH Stride of filter application in the y direction (columns).
+   * @param output Matrix to store the strided result in.
+   */
+  template<typename eT>
+  static void Subsample(const arma::Mat<eT>& correlation,
+                        const size_t dW,
+                        const size_t dH,
+                        arma::Mat<eT>& output)
+  {
+    for (size_t j = 0; j < output.n_cols; ++j)
+    {
+      const eT* correlationPtr = correlation.colptr(j * dH);
+      eT* outputPtr = output.colptr(j);
+      for (size_t i = 0; i < output.n_rows; ++i)
+        outputPtr[i] = correlationPtr[i * dW];
+    }
+  }
+
+  /*
+   * Perform a convolution (valid mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, ValidConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    // The correlation is the inverse transform of the product of the input
+    // spectrum with the conjugate of the filter spectrum.
+    const arma::Mat<eT> correlation = arma::real(arma::ifft2(
+        arma::fft2(input) % arma::conj(arma::fft2(filter, input.n_rows,
+        input.n_cols))));
+
+    output.set_size((input.n_rows - filter.n_rows) / dW + 1,
+        (input.n_cols - filter.n_cols) / dH + 1);
+    Subsample(correlation, dW, dH, output);
+  }
+
+  /*
+   * Perform a convolution (full mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, FullConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    // Pad the input so that the filter covers every position that overlaps it.
+    arma::Mat<eT> inputPadded = arma::zeros<arma::Mat<eT> >(
+        input.n_rows + 2 * (filter.n_rows - 1),
+        input.n_cols + 2 * (filter.n_cols - 1));
+    inputPadded.submat(filter.n_rows - 1, filter.n_cols - 1,
+        filter.n_rows - 1 + input.n_rows - 1,
+        filter.n_cols - 1 + input.n_cols - 1) = input;
+
+    CachedFFTConvolution<ValidConvolution>::Convolution(inputPadded, filter,
+        output, dW, dH);
+  }
+
+  /*
+   * Perform a convolution using 3rd order tensors.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    CachedFFTConvolution<BorderMode>::Convolution(input.slice(0),
+        filter.slice(0), convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      CachedFFTConvolution<BorderMode>::Convolution(input.slice(i),
+          filter.slice(i), convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using dense matrix as input and a 3rd order tensors
+   * as filter and output.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Mat<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    CachedFFTConvolution<BorderMode>::Convolution(input, filter.slice(0),
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        filter.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < filter.n_slices; i++)
+    {
+      CachedFFTConvolution<BorderMode>::Convolution(input, filter.slice(i),
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using a 3rd order tensors as input and output and a
+   * dense matrix as filter.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Mat<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    CachedFFTConvolution<BorderMode>::Convolution(input.slice(0), filter,
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      CachedFFTConvolution<BorderMode>::Convolution(input.slice(i), filter,
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+};  // class CachedFFTConvolution
+
+/**
+ * Whether the given convolution rule is CachedFFTConvolution, in which case the
+ * Convolution layer works in the frequency domain with cached spectra.
+ */
+template<typename ConvolutionRule>
+struct IsCachedFFTConvolution
+{
+  static const bool value = false;
+};
+
+template<typename BorderMode>
+struct IsCachedFFTConvolution<CachedFFTConvolution<BorderMode> >
+{
+  static const bool value = true;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,306 @@
+/**
+ * @file im2col_convolution.hpp
+ *
+ * Implementation of the convolution through im2col lowering and matrix
+ * multiplication.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "border_modes.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the two-dimensional convolution by lowering the input into a column
+ * matrix (im2col), so that the convolution becomes a matrix multiplication.
+ * Each column of the lowered matrix holds the input entries under the filter
+ * at one output position.  This class allows specification of the type of the
+ * border type, like NaiveConvolution.
+ *
+ * FullConvolution: returns the full two-dimensional convolution.
+ * ValidConvolution: returns only those parts of the convolution that are
+ * computed without the zero-padded edges.
+ *
+ * When all the rules of the Convolution layer are Im2ColConvolution, the layer
+ * lowers all the input maps at once, and Forward(), Backward() and Gradient()
+ * each perform a single matrix multiplication (BLAS GEMM) over all input and
+ * output maps, with workspace matrices that are reused across calls.
+ *
+ * @tparam BorderMode Type of the border mode (FullConvolution or
+ * ValidConvolution).
+ */
+template<typename BorderMode = FullConvolution>
+class Im2ColConvolution
+{
+ public:
+  /**
+   * Lower the given input maps into a column matrix.  Column i + outWidth * j
+   * holds the entries of all the maps that the filter covers at output
+   * position (i, j); the entries of each map are stored by column of the
+   * filter, and the maps follow each other.
+   *
+   * @param input Input maps (one per slice).
+   * @param kW Width of the filter (rows).
+   * @param kH Height of the filter (columns).
+   * @param dW Stride of filter application in the x direction (rows).
+   * @param dH Stride of filter application in the y direction (columns).
+   * @param columns Matrix to store the lowered input in.
+   */
+  template<typename eT>
+  static void Im2Col(const arma::Cube<eT>& input,
+                     const size_t kW,
+                     const size_t kH,
+                     const size_t dW,
+                     const size_t dH,
+                     arma::Mat<eT>& columns)
+  {
+    const size_t outWidth = (input.n_rows - kW) / dW + 1;
+    const size_t outHeight = (input.n_cols - kH) / dH + 1;
+    columns.set_size(kW * kH * input.n_slices, outWidth * outHeight);
+
+    for (size_t j = 0; j < outHeight; ++j)
+    {
+      for (size_t i = 0; i < outWidth; ++i)
+      {
+        eT* column = columns.colptr(i + outWidth * j);
+        for (size_t s = 0; s < input.n_slices; ++s)
+        {
+          for (size_t kj = 0; kj < kH; ++kj, column += kW)
+          {
+            const eT* inputPtr = input.slice_colptr(s, j * dH + kj) + i * dW;
+            std::copy(inputPtr, inputPtr + kW, column);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Add the entries of a column matrix back onto the input maps it was lowered
+   * from with Im2Col().  Entries that were lowered more than once are summed.
+   *
+   * @param columns Lowered matrix.
+   * @param kW Width of the filter (rows).
+   * @param kH Height of the filter (columns).
+   * @param dW Stride of filter application in the x direction (rows).
+   * @param dH Stride of filter application in the y direction (columns).
+   * @param output Input maps to add to; it must already have the right size.
+   */
+  template<typename eT>
+  static void Col2Im(const arma::Mat<eT>& columns,
+                     const size_t kW,
+                     const size_t kH,
+                     const size_t dW,
+                     const size_t dH,
+                     arma::Cube<eT>& output)
+  {
+    const size_t outWidth = (output.n_rows - kW) / dW + 1;
+    const size_t outHeight = (output.n_cols - kH) / dH + 1;
+
+    for (size_t j = 0; j < outHeight; ++j)
+    {
+      for (size_t i = 0; i < outWidth; ++i)
+      {
+        const eT* column = columns.colptr(i + outWidth * j);
+        for (size_t s = 0; s < output.n_slices; ++s)
+        {
+          for (size_t kj = 0; kj < kH; ++kj)
+          {
+            eT* outputPtr = output.slice_colptr(s, j * dH + kj) + i * dW;
+            for (size_t ki = 0; ki < kW; ++ki)
+              outputPtr[ki] += *column++;
+          }
+        }
+      }
+    }
+  }
+
+  /*
+   * Perform a convolution (valid mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, ValidConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    const arma::Cube<eT> inputCube(const_cast<eT*>(input.memptr()),
+        input.n_rows, input.n_cols, 1, false, true);
+
+    arma::Mat<eT> columns;
+    Im2Col(inputCube, filter.n_rows, filter.n_cols, dW, dH, columns);
+
+    output.set_size((input.n_rows - filter.n_rows) / dW + 1,
+        (input.n_cols - filter.n_cols) / dH + 1);
+    arma::Mat<eT> outputRow(output.memptr(), 1, output.n_elem, false, true);
+    outputRow = arma::vectorise(filter).t() * columns;
+  }
+
+  /*
+   * Perform a convolution (full mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, FullConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    const size_t outputRows = (input.n_rows + 2 * (filter.n_rows - 1)) * dW;
+    const size_t outputCols = (input.n_cols + 2 * (filter.n_cols - 1)) * dH;
+
+    // Pad filter and input to the working output shape.
+    arma::Mat<eT> inputPadded = arma::zeros<arma::Mat<eT> >(outputRows,
+        outputCols);
+    inputPadded.submat(filter.n_rows - 1, filter.n_cols - 1,
+        filter.n_rows - 1 + input.n_rows - 1,
+        filter.n_cols - 1 + input.n_cols - 1) = input;
+
+    Im2ColConvolution<ValidConvolution>::Convolution(inputPadded, filter,
+        output, 1, 1);
+  }
+
+  /*
+   * Perform a convolution using 3rd order tensors.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0),
+        filter.slice(0), convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i),
+          filter.slice(i), convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using dense matrix as input and a 3rd order tensors
+   * as filter and output.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Mat<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(0),
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        filter.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < filter.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(i),
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using a 3rd order tensors as input and output and a
+   * dense matrix as filter.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Mat<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0), filter,
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i), filter,
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+};  // class Im2ColConvolution
+
+/**
+ * Whether the given convolution rule is Im2ColConvolution, in which case the
+ * Convolution layer lowers all its input maps at once.
+ */
+template<typename ConvolutionRule>
+struct IsIm2ColConvolution
+{
+  static const bool value = false;
+};
+
+template<typename BorderMode>
+struct IsIm2ColConvolution<Im2ColConvolution<BorderMode> >
+{
+  static const bool value = true;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_ANN_FFN_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/batch_prefetcher.hpp>
 
 #include "visitor/delete_visitor.hpp"
 #include "visitor/delta_visitor.hpp"
@@ -23,6 +24,8 @@
 #include "visitor/reset_visitor.hpp"
 #include "visitor/weight_size_visitor.hpp"
 #include "visitor/copy_visitor.hpp"
+#include "visitor/batch_support_visitor.hpp"
+#include "visitor/sparse_gradient_support_visitor.hpp"
 
 #include "init_rules/network_init.hpp"
 
@@ -38,16 +41,20 @@ namespace ann /** Artificial Neural Network. */ {
  *
  * @tparam OutputLayerType The output layer type used to evaluate the network.
  * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam MatType Type of the data and parameters of the network (arma::mat or
+ *     arma::fmat).  The output layer and all added modules must use the same
+ *     matrix type.
  */
 template<
   typename OutputLayerType = NegativeLogLikelihood<>,
-  typename InitializationRuleType = RandomInitialization
+  typename InitializationRuleType = RandomInitialization,
+  typename MatType = arma::mat
 >
 class FFN
 {
  public:
   //! Convenience typedef for the internal model construction.
-  using NetworkType = FFN<OutputLayerType, InitializationRuleType>;
+  using NetworkType = FFN<OutputLayerType, InitializationRuleType, MatType>;
 
   /**
    * Create the FFN object with the given predictors and responses set (this is
@@ -89,8 +96,8 @@ class FFN
    * @param initializeRule Optional instantiated InitializationRule object
    *        for initializing the network parameter.
    */
-  FFN(arma::mat predictors,
-      arma::mat responses,
+  FFN(MatType predictors,
+      MatType responses,
       OutputLayerType outputLayer = OutputLayerType(),
       InitializationRuleType initializeRule = InitializationRuleType());
 
@@ -118,8 +125,8 @@ class FFN
           mlpack::optimization::RMSProp,
       typename... OptimizerTypeArgs
   >
-  void Train(arma::mat predictors,
-             arma::mat responses,
+  void Train(MatType predictors,
+             MatType responses,
              OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer);
 
   /**
@@ -141,20 +148,51 @@ class FFN
   template<
       template<typename...> class OptimizerType = mlpack::optimization::RMSProp
   >
-  void Train(arma::mat predictors, arma::mat responses);
+  void Train(MatType predictors, MatType responses);
+
+  /**
+   * Train the feedforward network on the mini-batches read by the given
+   * prefetcher (see data::BatchPrefetcher), so that the training data doesn't
+   * have to fit in memory.  The optimizer must be able to read from a
+   * prefetcher, like mlpack::optimization::MiniBatchSGD; the batch size and
+   * shuffling of the prefetcher are used.
+   *
+   * This will use the existing model parameters as a starting point for the
+   * optimization, or initialize them if the model was not trained yet.
+   *
+   * @tparam SourceType Type of the batch source of the prefetcher.
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param batches Prefetcher to read the training mini-batches from.
+   * @param optimizer Instantiated optimizer used to train the model.
+   */
+  template<
+      typename SourceType,
+      template<typename, typename...> class OptimizerType,
+      typename... OptimizerTypeArgs
+  >
+  void Train(data::BatchPrefetcher<SourceType, MatType>& batches,
+             OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer);
 
   /**
    * Predict the responses to a given set of predictors. The responses will
    * reflect the output of the given output layer as returned by the
    * output layer function.
    *
-   * If you want to pass in a parameter and discard the original parameter
-   * object, be sure to use std::move to avoid unnecessary copy.
+   * If every module of the network supports batches (see
+   * BatchSupportVisitor), the predictors are passed through the network
+   * batchSize points at a time; otherwise one point at a time.  The predictors
+   * are not copied, and the output buffers of the modules keep their size from
+   * one batch to the next, so no memory is allocated for the intermediate
+   * results once the first batch has been processed.  If results already has
+   * the right size, it is reused as well.
    *
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to pass through the network at once.
    */
-  void Predict(arma::mat predictors, arma::mat& results);
+  void Predict(const MatType& predictors,
+               MatType& results,
+               const size_t batchSize = 256);
 
   /**
    * Evaluate the feedforward network with the given parameters. This function
@@ -165,10 +203,48 @@ class FFN
    * @param deterministic Whether or not to train or test the model. Note some
    *        layer act differently in training or testing mode.
    */
-  double Evaluate(const arma::mat& parameters,
+  double Evaluate(const MatType& parameters,
                   const size_t i,
                   const bool deterministic = true);
 
+  /**
+   * Evaluate the feedforward network with the given parameters on the batch of
+   * points [begin, begin + batchSize).  The whole batch is passed through each
+   * layer at once, so layers like Linear can use a single matrix-matrix
+   * product instead of one matrix-vector product per point.  The returned
+   * objective is the sum of the objectives of each point in the batch.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to use for objective function
+   *        evaluation.
+   * @param deterministic Whether or not to train or test the model. Note some
+   *        layer act differently in training or testing mode.
+   */
+  double Evaluate(const MatType& parameters,
+                  const size_t begin,
+                  const size_t batchSize,
+                  const bool deterministic);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on the batch of
+   * points [begin, begin + batchSize) in testing (deterministic) mode.  This is
+   * used by optimizers such as MiniBatchSGD.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to use for objective function
+   *        evaluation.
+   */
+  double Evaluate(const MatType& parameters,
+                  const size_t begin,
+                  const size_t batchSize)
+  {
+    return Evaluate(parameters, begin, batchSize, true);
+  }
+
   /**
    * Evaluate the gradient of the feedforward network with the given parameters,
    * and with respect to only one point in the dataset. This is useful for
@@ -178,9 +254,85 @@ class FFN
    * @param i Index of points to use for objective function gradient evaluation.
    * @param gradient Matrix to output gradient into.
    */
-  void Gradient(const arma::mat& parameters,
+  void Gradient(const MatType& parameters,
+                const size_t i,
+                MatType& gradient);
+
+  /**
+   * Evaluate the gradient of the feedforward network with the given parameters,
+   * and with respect to only one point in the dataset, as a sparse matrix.
+   * The modules that support it (see SparseGradientSupportVisitor), like
+   * Lookup, only give the gradient of the parameters the point uses, so the
+   * cost of this doesn't depend on the size of their parameters; the gradient
+   * of the other modules is dense.  SGD and the optimizers based on it use this
+   * (see HasSparseGradient) when UseSparseGradient() is true and the update
+   * policy supports sparse gradients.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param i Index of points to use for objective function gradient evaluation.
+   * @param gradient Sparse matrix to output gradient into.
+   */
+  void Gradient(const MatType& parameters,
                 const size_t i,
-                arma::mat& gradient);
+                arma::SpMat<typename MatType::elem_type>& gradient);
+
+  /**
+   * Return true if a module of the network computes its gradient sparsely, so
+   * that the sparse Gradient() overload is cheaper than the dense one.
+   */
+  bool UseSparseGradient() const;
+
+  /**
+   * Evaluate the gradient of the feedforward network with the given parameters
+   * with respect to the batch of points [begin, begin + batchSize).  The
+   * resulting gradient is the sum of the gradients of each point in the batch.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first point to use for objective function
+   *        gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to use for objective function gradient
+   *        evaluation.
+   */
+  void Gradient(const MatType& parameters,
+                const size_t begin,
+                MatType& gradient,
+                const size_t batchSize);
+
+  /**
+   * Evaluate the feedforward network and its gradient with the given
+   * parameters on the batch of points [begin, begin + batchSize), with one
+   * forward pass.  The objective is computed in training mode, as it is in
+   * Gradient(); it is the sum of the objectives of each point in the batch.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first point to use for objective function
+   *        gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to use for objective function gradient
+   *        evaluation.
+   * @return The objective function of the batch.
+   */
+  double EvaluateWithGradient(const MatType& parameters,
+                              const size_t begin,
+                              MatType& gradient,
+                              const size_t batchSize);
+
+  /**
+   * Evaluate the feedforward network and its gradient with the given
+   * parameters on the i'th point, with one forward pass.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param i Index of the point to use.
+   * @param gradient Matrix to output gradient into.
+   * @return The objective function of the point.
+   */
+  double EvaluateWithGradient(const MatType& parameters,
+                              const size_t i,
+                              MatType& gradient)
+  {
+    return EvaluateWithGradient(parameters, i, gradient, 1);
+  }
 
   /**
    * Compute the gradient of the feedforward network based on given input and target.
@@ -189,8 +341,8 @@ class FFN
    * @param responses Outputs results from input training variables.
    * @return Desired gradients of the feedforward network.
    */
-  arma::mat Gradient(const arma::mat& predictors,
-                     const arma::mat& responses);
+  MatType Gradient(const MatType& predictors,
+                   const MatType& responses);
 
   /*
    * Add a new module to the model.
@@ -205,21 +357,33 @@ class FFN
    *
    * @param layer The Layer to be added to the model.
    */
-  void Add(LayerTypes layer) { network.push_back(layer); }
+  void Add(LayerTypes<MatType> layer) { network.push_back(layer); }
+
+  //! Get the modules of the network.
+  const std::vector<LayerTypes<MatType>>& Model() const { return network; }
 
   //! Return the number of separable functions (the number of predictor points).
   size_t NumFunctions() const { return numFunctions; }
 
   //! Return the initial point for the optimization.
-  const arma::mat& Parameters() const { return parameter; }
+  const MatType& Parameters() const { return parameter; }
   //! Modify the initial point for the optimization.
-  arma::mat& Parameters() { return parameter; }
+  MatType& Parameters() { return parameter; }
 
   /**
    * Reset the module infomration (weights/parameters).
    */
   void ResetParameters();
 
+  /**
+   * Prepare the network for the given data.
+   * This function won't actually trigger training process.
+   *
+   * @param predictors Input data variables.
+   * @param responses Outputs results from input data variables.
+   */
+  void ResetData(MatType predictors, MatType responses);
+
   //! Serialize the model.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
@@ -228,26 +392,29 @@ class FFN
   // Helper functions.
   /**
    * The Forward algorithm (part of the Forward-Backward algorithm).  Computes
-   * forward probabilities for each module.
+   * forward probabilities for each module, or only for the modules before the
+   * given one.
    *
    * @param input Data sequence to compute probabilities for.
+   * @param end Index of the first module not to run (by default, all the
+   *     modules run).
    */
-  void Forward(arma::mat&& input);
+  void Forward(MatType&& input, const size_t end = size_t(-1));
 
   /**
-   * Prepare the network for the given data.
-   * This function won't actually trigger training process.
-   *
-   * @param predictors Input data variables.
-   * @param responses Outputs results from input data variables.
+   * The Backward algorithm (part of the Forward-Backward algorithm). Computes
+   * the error of the output layer for the current target, and the backward
+   * pass for each module.
    */
-  void ResetData(arma::mat predictors, arma::mat responses);
+  void Backward();
 
   /**
-   * The Backward algorithm (part of the Forward-Backward algorithm). Computes
-   * backward pass for module.
+   * Return true if the output layer is NegativeLogLikelihood and the last
+   * module is LogSoftMax.  Then the loss and the error of the LogSoftMax
+   * module are computed from its input in one pass by SoftMaxCrossEntropy, and
+   * the output of the LogSoftMax module is only computed for predictions.
    */
-  void Backward();
+  bool FusedOutput() const;
 
   /**
    * Iterate through all layer modules and update the the gradient using the
@@ -255,6 +422,14 @@ class FFN
    */
   void Gradient();
 
+  /**
+   * Prepare the parameters for the first training call.  Parameters that
+   * already fit the network (because they were loaded or set, for instance
+   * by Sparsify()) are kept and handed to the modules again; otherwise the
+   * parameters are initialized with the initialization rule.
+   */
+  void InitializeParameters();
+
   /**
    * Reset the module status by setting the current deterministic parameter
    * for all modules that implement the Deterministic function.
@@ -264,7 +439,14 @@ class FFN
   /**
    * Reset the gradient for all modules that implement the Gradient function.
    */
-  void ResetGradients(arma::mat& gradient);
+  void ResetGradients(MatType& gradient);
+
+  /**
+   * Return true if every module of the network can process a batch of points
+   * at once.  If not, batches are passed through the network one point at a
+   * time.
+   */
+  bool BatchSupport() const;
 
   /**
    * Swap the content of this network with given network.
@@ -276,6 +458,10 @@ class FFN
   //! Instantiated outputlayer used to evaluate the network.
   OutputLayerType outputLayer;
 
+  //! The output layer used instead of outputLayer and the final LogSoftMax
+  //! module, if FusedOutput() is true.
+  SoftMaxCrossEntropy<MatType, MatType> fusedOutputLayer;
+
   //! Instantiated InitializationRule object for initializing the network
   //! parameter.
   InitializationRuleType initializeRule;
@@ -290,46 +476,46 @@ class FFN
   bool reset;
 
   //! Locally-stored model modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<MatType>> network;
 
   //! The matrix of data points (predictors).
-  arma::mat predictors;
+  MatType predictors;
 
   //! The matrix of responses to the input data points.
-  arma::mat responses;
+  MatType responses;
 
   //! Matrix of (trained) parameters.
-  arma::mat parameter;
+  MatType parameter;
 
   //! The number of separable functions (the number of predictor points).
   size_t numFunctions;
 
   //! The current error for the backward pass.
-  arma::mat error;
+  MatType error;
 
   //! THe current input of the forward/backward pass.
-  arma::mat currentInput;
+  MatType currentInput;
 
   //! THe current target of the forward/backward pass.
-  arma::mat currentTarget;
+  MatType currentTarget;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<MatType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<MatType> outputParameterVisitor;
 
   //! Locally-stored weight size visitor.
-  WeightSizeVisitor weightSizeVisitor;
+  WeightSizeVisitor<MatType> weightSizeVisitor;
 
   //! Locally-stored output width visitor.
-  OutputWidthVisitor outputWidthVisitor;
+  OutputWidthVisitor<MatType> outputWidthVisitor;
 
   //! Locally-stored output height visitor.
-  OutputHeightVisitor outputHeightVisitor;
+  OutputHeightVisitor<MatType> outputHeightVisitor;
 
   //! Locally-stored reset visitor.
-  ResetVisitor resetVisitor;
+  ResetVisitor<MatType> resetVisitor;
 
   //! Locally-stored delete visitor.
   DeleteVisitor deleteVisitor;
@@ -338,19 +524,23 @@ class FFN
   bool deterministic;
 
   //! Locally-stored delta object.
-  arma::mat delta;
+  MatType delta;
 
   //! Locally-stored input parameter object.
-  arma::mat inputParameter;
+  MatType inputParameter;
 
   //! Locally-stored output parameter object.
-  arma::mat outputParameter;
+  MatType outputParameter;
 
   //! Locally-stored gradient parameter.
-  arma::mat gradient;
+  MatType gradient;
+
+  //! Locally-stored gradient of the modules without a sparse gradient, used by
+  //! the sparse Gradient() overload.
+  MatType denseGradient;
 
   //! Locally-stored copy visitor
-  CopyVisitor copyVisitor;
+  CopyVisitor<MatType> copyVisitor;
 }; // class FFN
 
 } // namespace ann
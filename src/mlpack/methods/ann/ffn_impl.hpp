@@ -15,6 +15,7 @@
 // In case it hasn't been included yet.
 #include "ffn.hpp"
 
+#include "visitor/alias_check_visitor.hpp"
 #include "visitor/forward_visitor.hpp"
 #include "visitor/backward_visitor.hpp"
 #include "visitor/deterministic_set_visitor.hpp"
@@ -22,13 +23,16 @@
 #include "visitor/gradient_visitor.hpp"
 #include "visitor/set_input_height_visitor.hpp"
 #include "visitor/set_input_width_visitor.hpp"
+#include "visitor/sparse_gradient_visitor.hpp"
+#include "visitor/weight_set_visitor.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::FFN(
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::FFN(
     OutputLayerType outputLayer, InitializationRuleType initializeRule) :
     outputLayer(std::move(outputLayer)),
     initializeRule(std::move(initializeRule)),
@@ -39,10 +43,11 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
   /* Nothing to do here */
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::FFN(
-    arma::mat predictors,
-    arma::mat responses,
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::FFN(
+    MatType predictors,
+    MatType responses,
     OutputLayerType outputLayer,
     InitializationRuleType initializeRule) :
     outputLayer(std::move(outputLayer)),
@@ -57,16 +62,18 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
   numFunctions = this->responses.n_cols;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::~FFN()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::~FFN()
 {
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deleteVisitor));
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::ResetData(
-    arma::mat predictors, arma::mat responses)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::ResetData(
+    MatType predictors, MatType responses)
 {
   numFunctions = responses.n_cols;
   this->predictors = std::move(predictors);
@@ -76,18 +83,19 @@ void FFN<OutputLayerType, InitializationRuleType>::ResetData(
 
   if (!reset)
   {
-    ResetParameters();
+    InitializeParameters();
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<
     template<typename, typename...> class OptimizerType,
     typename... OptimizerTypeArgs
 >
-void FFN<OutputLayerType, InitializationRuleType>::Train(
-      arma::mat predictors,
-      arma::mat responses,
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Train(
+      MatType predictors,
+      MatType responses,
       OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer)
 {
   ResetData(std::move(predictors), std::move(responses));
@@ -101,10 +109,37 @@ void FFN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+template<
+    typename SourceType,
+    template<typename, typename...> class OptimizerType,
+    typename... OptimizerTypeArgs
+>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Train(
+      data::BatchPrefetcher<SourceType, MatType>& batches,
+      OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer)
+{
+  // The optimizer needs the size of the parameters before the first batch.
+  if (parameter.is_empty())
+  {
+    ResetParameters();
+  }
+
+  // Train the model.
+  Timer::Start("ffn_optimization");
+  const double out = optimizer.Optimize(*this, parameter, batches);
+  Timer::Stop("ffn_optimization");
+
+  Log::Info << "FFN::FFN(): final objective of trained model is " << out
+      << "." << std::endl;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<template<typename...> class OptimizerType>
-void FFN<OutputLayerType, InitializationRuleType>::Train(
-    arma::mat predictors, arma::mat responses)
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Train(
+    MatType predictors, MatType responses)
 {
   numFunctions = responses.n_cols;
 
@@ -116,7 +151,7 @@ void FFN<OutputLayerType, InitializationRuleType>::Train(
 
   if (!reset)
   {
-    ResetParameters();
+    InitializeParameters();
   }
 
   OptimizerType<decltype(*this)> optimizer(*this);
@@ -130,9 +165,10 @@ void FFN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Predict(
-    arma::mat predictors, arma::mat& results)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Predict(
+    const MatType& predictors, MatType& results, const size_t batchSize)
 {
   if (parameter.is_empty())
   {
@@ -145,29 +181,41 @@ void FFN<OutputLayerType, InitializationRuleType>::Predict(
     ResetDeterministic();
   }
 
-  arma::mat resultsTemp;
-  Forward(std::move(arma::mat(predictors.colptr(0),
-      predictors.n_rows, 1, false, true)));
-  resultsTemp = boost::apply_visitor(outputParameterVisitor,
-      network.back()).col(0);
-
-  results = arma::mat(resultsTemp.n_elem, predictors.n_cols);
-  results.col(0) = resultsTemp.col(0);
-
-  for (size_t i = 1; i < predictors.n_cols; i++)
+  const size_t step = BatchSupport() ? std::max(batchSize, (size_t) 1) : 1;
+  for (size_t begin = 0; begin < predictors.n_cols; begin += step)
   {
-    Forward(std::move(arma::mat(predictors.colptr(i),
-        predictors.n_rows, 1, false, true)));
+    const size_t end = std::min(begin + step, (size_t) predictors.n_cols) - 1;
+
+    // Pass an alias of the batch through the network; the modules only read
+    // their input.
+    Forward(std::move(MatType(const_cast<typename MatType::elem_type*>(
+        predictors.colptr(begin)), predictors.n_rows, end - begin + 1, false,
+        true)));
 
-    resultsTemp = boost::apply_visitor(outputParameterVisitor,
+    const MatType& output = boost::apply_visitor(outputParameterVisitor,
         network.back());
-    results.col(i) = resultsTemp.col(0);
+    if (begin == 0)
+      results.set_size(output.n_rows, predictors.n_cols);
+
+    results.cols(begin, end) = output;
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
-    const arma::mat& /* parameters */, const size_t i, const bool deterministic)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType, MatType>::Evaluate(
+    const MatType& parameters, const size_t i, const bool deterministic)
+{
+  return Evaluate(parameters, i, 1, deterministic);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType, MatType>::Evaluate(
+    const MatType& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    const bool deterministic)
 {
   if (parameter.is_empty())
   {
@@ -180,8 +228,26 @@ double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
     ResetDeterministic();
   }
 
-  currentInput = predictors.unsafe_col(i);
-  currentTarget = responses.unsafe_col(i);
+  if (batchSize > 1 && !BatchSupport())
+  {
+    double res = 0;
+    for (size_t i = begin; i < begin + batchSize; ++i)
+      res += Evaluate(parameters, i, 1, deterministic);
+
+    return res;
+  }
+
+  currentInput = predictors.cols(begin, begin + batchSize - 1);
+  currentTarget = responses.cols(begin, begin + batchSize - 1);
+
+  if (FusedOutput())
+  {
+    // Compute the loss from the input of the LogSoftMax module.
+    Forward(std::move(currentInput), network.size() - 1);
+    return fusedOutputLayer.Forward(std::move(boost::apply_visitor(
+        outputParameterVisitor, network[network.size() - 2])),
+        std::move(currentTarget));
+  }
 
   Forward(std::move(currentInput));
   double res = outputLayer.Forward(std::move(boost::apply_visitor(
@@ -190,10 +256,159 @@ double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
   return res;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Gradient(
-    const arma::mat& parameters, const size_t i, arma::mat& gradient)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+    const MatType& parameters, const size_t i, MatType& gradient)
 {
+  Gradient(parameters, i, gradient, 1);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+    const MatType& parameters,
+    const size_t i,
+    arma::SpMat<typename MatType::elem_type>& gradient)
+{
+  typedef typename MatType::elem_type ElemType;
+
+  if (parameter.is_empty())
+    ResetParameters();
+
+  Evaluate(parameters, i, 1, false);
+  Backward();
+
+  // The modules without a sparse gradient write their gradient into
+  // denseGradient, where their parameters follow each other without those of
+  // the modules with a sparse gradient.
+  std::vector<size_t> sizes(network.size());
+  std::vector<bool> sparse(network.size());
+  size_t denseSize = 0;
+  for (size_t l = 0; l < network.size(); ++l)
+  {
+    sizes[l] = boost::apply_visitor(weightSizeVisitor, network[l]);
+    sparse[l] = boost::apply_visitor(SparseGradientSupportVisitor(),
+        network[l]);
+    if (!sparse[l])
+      denseSize += sizes[l];
+  }
+
+  denseGradient.zeros(denseSize, 1);
+  for (size_t l = 0, offset = 0; l < network.size(); ++l)
+  {
+    if (!sparse[l])
+    {
+      offset += boost::apply_visitor(GradientSetVisitor<MatType>(std::move(
+          denseGradient), offset), network[l]);
+    }
+  }
+
+  // Compute the gradient of each module, as Gradient() does.
+  std::vector<arma::uvec> indices(network.size());
+  std::vector<MatType> blocks(network.size());
+  size_t nonZeros = denseSize;
+  for (size_t l = 0; l < network.size(); ++l)
+  {
+    MatType&& input = (l == 0) ? std::move(currentInput) : std::move(
+        boost::apply_visitor(outputParameterVisitor, network[l - 1]));
+    MatType&& layerDelta = (l == network.size() - 1) ? std::move(error) :
+        std::move(boost::apply_visitor(deltaVisitor, network[l + 1]));
+
+    if (sparse[l])
+    {
+      boost::apply_visitor(SparseGradientVisitor<MatType>(std::move(input),
+          std::move(layerDelta), indices[l], blocks[l]), network[l]);
+      nonZeros += blocks[l].n_elem;
+    }
+    else
+    {
+      boost::apply_visitor(GradientVisitor<MatType>(std::move(input),
+          std::move(layerDelta)), network[l]);
+    }
+  }
+
+  // Collect the entries in order, so the locations don't need sorting.
+  arma::umat locations(2, nonZeros, arma::fill::zeros);
+  arma::Col<ElemType> values(nonZeros);
+  for (size_t l = 0, offset = 0, denseOffset = 0, n = 0; l < network.size();
+       offset += sizes[l], ++l)
+  {
+    if (sparse[l])
+    {
+      const MatType& block = blocks[l];
+      for (size_t k = 0; k < indices[l].n_elem; ++k)
+      {
+        const size_t column = offset + indices[l][k] * block.n_rows;
+        for (size_t r = 0; r < block.n_rows; ++r, ++n)
+        {
+          locations(0, n) = column + r;
+          values[n] = block(r, k);
+        }
+      }
+    }
+    else
+    {
+      for (size_t j = 0; j < sizes[l]; ++j, ++n)
+      {
+        locations(0, n) = offset + j;
+        values[n] = denseGradient[denseOffset + j];
+      }
+      denseOffset += sizes[l];
+    }
+  }
+
+  gradient = arma::SpMat<ElemType>(locations, values, parameter.n_rows,
+      parameter.n_cols, false, false);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+bool FFN<OutputLayerType, InitializationRuleType, MatType>::
+UseSparseGradient() const
+{
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (boost::apply_visitor(SparseGradientSupportVisitor(), network[i]))
+      return true;
+  }
+
+  return false;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+    const MatType& parameters,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize)
+{
+  EvaluateWithGradient(parameters, begin, gradient, batchSize);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType, MatType>::
+EvaluateWithGradient(const MatType& parameters,
+                     const size_t begin,
+                     MatType& gradient,
+                     const size_t batchSize)
+{
+  if (batchSize > 1 && !BatchSupport())
+  {
+    double res = EvaluateWithGradient(parameters, begin, gradient, 1);
+
+    MatType pointGradient;
+    for (size_t i = begin + 1; i < begin + batchSize; ++i)
+    {
+      res += EvaluateWithGradient(parameters, i, pointGradient, 1);
+      gradient += pointGradient;
+    }
+
+    return res;
+  }
+
   if (gradient.is_empty())
   {
     if (parameter.is_empty())
@@ -201,35 +416,46 @@ void FFN<OutputLayerType, InitializationRuleType>::Gradient(
       ResetParameters();
     }
 
-    gradient = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+    gradient = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
   }
   else
   {
     gradient.zeros();
   }
 
-  Evaluate(parameters, i, false);
-
-  outputLayer.Backward(std::move(boost::apply_visitor(outputParameterVisitor,
-      network.back())), std::move(currentTarget), std::move(error));
+  const double res = Evaluate(parameters, begin, batchSize, false);
 
   Backward();
   ResetGradients(gradient);
   Gradient();
+
+#ifdef DEBUG
+  // Make sure that no module trained a copy of its parameters or gradient.
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    offset += boost::apply_visitor(AliasCheckVisitor<MatType>(std::move(
+        parameter), std::move(gradient), offset), network[i]);
+  }
+#endif
+
+  return res;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-arma::mat FFN<OutputLayerType, InitializationRuleType>::Gradient(
-  const arma::mat& predictors, const arma::mat& responses)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+MatType FFN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+  const MatType& predictors, const MatType& responses)
 {
   ResetData(predictors, responses);
-  arma::mat gradients;
+  MatType gradients;
   Gradient(Parameters(), 0, gradients);
   return gradients;
 };
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::ResetParameters()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::ResetParameters()
 {
   ResetDeterministic();
 
@@ -238,30 +464,72 @@ void FFN<OutputLayerType, InitializationRuleType>::ResetParameters()
   networkInit.Initialize(network, parameter);
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::ResetDeterministic()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::
+InitializeParameters()
 {
-  DeterministicSetVisitor deterministicSetVisitor(deterministic);
+  size_t weights = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+    weights += boost::apply_visitor(weightSizeVisitor, network[i]);
+
+  if (parameter.n_elem != weights || weights == 0)
+  {
+    ResetParameters();
+    return;
+  }
+
+  // The parameters may have been replaced, so alias them again.
+  for (size_t i = 0, offset = 0; i < network.size(); ++i)
+  {
+    offset += boost::apply_visitor(WeightSetVisitor<MatType>(std::move(
+        parameter), offset), network[i]);
+
+    boost::apply_visitor(resetVisitor, network[i]);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+bool FFN<OutputLayerType, InitializationRuleType, MatType>::BatchSupport() const
+{
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (!boost::apply_visitor(BatchSupportVisitor(), network[i]))
+      return false;
+  }
+
+  return true;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::ResetDeterministic()
+{
+  DeterministicSetVisitor<MatType> deterministicSetVisitor(deterministic);
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deterministicSetVisitor));
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::ResetGradients(
-    arma::mat& gradient)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::ResetGradients(
+    MatType& gradient)
 {
   size_t offset = 0;
   for (size_t i = 0; i < network.size(); ++i)
   {
-    offset += boost::apply_visitor(GradientSetVisitor(std::move(gradient),
-        offset), network[i]);
+    offset += boost::apply_visitor(GradientSetVisitor<MatType>(std::move(
+        gradient), offset), network[i]);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Forward(
+    MatType&& input, const size_t end)
 {
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
+  boost::apply_visitor(ForwardVisitor<MatType>(std::move(input), std::move(
       boost::apply_visitor(outputParameterVisitor, network.front()))),
       network.front());
 
@@ -278,18 +546,18 @@ void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
     }
   }
 
-  for (size_t i = 1; i < network.size(); ++i)
+  for (size_t i = 1; i < std::min(end, network.size()); ++i)
   {
     if (!reset)
     {
       // Set the input width.
-      boost::apply_visitor(SetInputWidthVisitor(width), network[i]);
+      boost::apply_visitor(SetInputWidthVisitor<MatType>(width), network[i]);
 
       // Set the input height.
-      boost::apply_visitor(SetInputHeightVisitor(height), network[i]);
+      boost::apply_visitor(SetInputHeightVisitor<MatType>(height), network[i]);
     }
 
-    boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
+    boost::apply_visitor(ForwardVisitor<MatType>(std::move(boost::apply_visitor(
         outputParameterVisitor, network[i - 1])), std::move(
         boost::apply_visitor(outputParameterVisitor, network[i]))), network[i]);
 
@@ -315,44 +583,75 @@ void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Backward()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Backward()
 {
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, network.back())), std::move(error), std::move(
-      boost::apply_visitor(deltaVisitor, network.back()))), network.back());
+  if (FusedOutput())
+  {
+    // The error of the LogSoftMax module is computed directly from its input.
+    fusedOutputLayer.Backward(std::move(boost::apply_visitor(
+        outputParameterVisitor, network[network.size() - 2])),
+        std::move(currentTarget), std::move(boost::apply_visitor(deltaVisitor,
+        network.back())));
+  }
+  else
+  {
+    outputLayer.Backward(std::move(boost::apply_visitor(
+        outputParameterVisitor, network.back())), std::move(currentTarget),
+        std::move(error));
+
+    boost::apply_visitor(BackwardVisitor<MatType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, network.back())),
+        std::move(error), std::move(boost::apply_visitor(deltaVisitor,
+        network.back()))), network.back());
+  }
 
   for (size_t i = 2; i < network.size(); ++i)
   {
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[network.size() - i])), std::move(
-        boost::apply_visitor(deltaVisitor, network[network.size() - i + 1])),
-        std::move(boost::apply_visitor(deltaVisitor,
-        network[network.size() - i]))), network[network.size() - i]);
+    boost::apply_visitor(BackwardVisitor<MatType>(std::move(
+        boost::apply_visitor(outputParameterVisitor,
+        network[network.size() - i])), std::move(boost::apply_visitor(
+        deltaVisitor, network[network.size() - i + 1])), std::move(
+        boost::apply_visitor(deltaVisitor, network[network.size() - i]))),
+        network[network.size() - i]);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Gradient()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+bool FFN<OutputLayerType, InitializationRuleType, MatType>::FusedOutput() const
+{
+  return IsNegativeLogLikelihood<OutputLayerType>::value &&
+      network.size() > 1 &&
+      boost::get<LogSoftMax<MatType, MatType>*>(&network.back()) != NULL;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Gradient()
 {
-  boost::apply_visitor(GradientVisitor(std::move(currentInput), std::move(
-      boost::apply_visitor(deltaVisitor, network[1]))), network.front());
+  boost::apply_visitor(GradientVisitor<MatType>(std::move(currentInput),
+      std::move(boost::apply_visitor(deltaVisitor, network[1]))),
+      network.front());
 
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
-    boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[i - 1])), std::move(
-        boost::apply_visitor(deltaVisitor, network[i + 1]))), network[i]);
+    boost::apply_visitor(GradientVisitor<MatType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, network[i - 1])),
+        std::move(boost::apply_visitor(deltaVisitor, network[i + 1]))),
+        network[i]);
   }
 
-  boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
+  boost::apply_visitor(GradientVisitor<MatType>(std::move(boost::apply_visitor(
       outputParameterVisitor, network[network.size() - 2])), std::move(error)),
       network[network.size() - 1]);
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<typename Archive>
-void FFN<OutputLayerType, InitializationRuleType>::Serialize(
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Serialize(
     Archive& ar, const unsigned int /* version */)
 {
   ar & data::CreateNVP(parameter, "parameter");
@@ -369,16 +668,17 @@ void FFN<OutputLayerType, InitializationRuleType>::Serialize(
     size_t offset = 0;
     for (size_t i = 0; i < network.size(); ++i)
     {
-      offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
-          offset), network[i]);
+      offset += boost::apply_visitor(WeightSetVisitor<MatType>(std::move(
+          parameter), offset), network[i]);
 
       boost::apply_visitor(resetVisitor, network[i]);
     }
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Swap(FFN& network)
 {
   std::swap(outputLayer, network.outputLayer);
   std::swap(initializeRule, network.initializeRule);
@@ -400,8 +700,9 @@ void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
   std::swap(gradient, network.gradient);
 };
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::FFN(
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::FFN(
     const FFN& network):
     outputLayer(network.outputLayer),
     initializeRule(network.initializeRule),
@@ -427,10 +728,24 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     this->network.push_back(boost::apply_visitor(copyVisitor,
         network.network[i]));
   }
+
+  // The copied modules hold their own weights, so point them to the copied
+  // parameters, like NetworkInitialization does.
+  if (!parameter.is_empty())
+  {
+    for (size_t i = 0, offset = 0; i < this->network.size(); ++i)
+    {
+      offset += boost::apply_visitor(WeightSetVisitor<MatType>(std::move(
+          parameter), offset), this->network[i]);
+
+      boost::apply_visitor(resetVisitor, this->network[i]);
+    }
+  }
 };
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::FFN(
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::FFN(
     FFN&& network):
     outputLayer(std::move(network.outputLayer)),
     initializeRule(std::move(network.initializeRule)),
@@ -453,9 +768,10 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
   this->network = std::move(network.network);
 };
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>&
-FFN<OutputLayerType, InitializationRuleType>::operator = (FFN network)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>&
+FFN<OutputLayerType, InitializationRuleType, MatType>::operator = (FFN network)
 {
   Swap(network);
   return *this;
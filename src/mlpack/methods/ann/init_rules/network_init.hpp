@@ -51,9 +51,15 @@ class NetworkInitialization
    *
    * @param network Network that should be initialized.
    * @param parameter The network parameter.
+   * @tparam MatType Type of the data and parameters of the network.
    */
-  void Initialize(const std::vector<LayerTypes>& network, arma::mat& parameter)
+  template<typename MatType>
+  void Initialize(const std::vector<LayerTypes<MatType> >& network,
+                  MatType& parameter)
   {
+    WeightSizeVisitor<MatType> weightSizeVisitor;
+    ResetVisitor<MatType> resetVisitor;
+
     // Determine the number of parameter/weights of the given network.
     size_t weights = 0;
     for (size_t i = 0; i < network.size(); ++i)
@@ -69,7 +75,7 @@ class NetworkInitialization
         // initialization rule.
         const size_t weight = boost::apply_visitor(weightSizeVisitor,
             network[i]);
-        arma::mat tmp = arma::mat(parameter.memptr() + offset,
+        MatType tmp = MatType(parameter.memptr() + offset,
             weight, 1, false, false);
         initializeRule.Initialize(tmp, tmp.n_elem, 1);
 
@@ -88,8 +94,8 @@ class NetworkInitialization
     // hold various other modules.
     for (size_t i = 0, offset = 0; i < network.size(); ++i)
     {
-      offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
-          offset), network[i]);
+      offset += boost::apply_visitor(WeightSetVisitor<MatType>(std::move(
+          parameter), offset), network[i]);
 
       boost::apply_visitor(resetVisitor, network[i]);
     }
@@ -99,12 +105,6 @@ class NetworkInitialization
   //! Instantiated InitializationRule object for initializing the network
   //! parameter.
   InitializationRuleType initializeRule;
-
-  //! Locally-stored reset visitor.
-  ResetVisitor resetVisitor;
-
-  //! Locally-stored weight size visitor.
-  WeightSizeVisitor weightSizeVisitor;
 }; // class NetworkInitialization
 
 } // namespace ann
@@ -51,7 +51,9 @@ void Add<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient = error;
+  // Sum over the batch; the gradient keeps the shape of the bias, so that it
+  // stays a view of the network gradient.
+  gradient = arma::sum(error, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
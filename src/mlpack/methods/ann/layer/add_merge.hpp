@@ -72,7 +72,7 @@ class AddMerge
    *
    * @param layer The Layer to be added to the model.
    */
-  void Add(LayerTypes layer) { network.push_back(layer); }
+  void Add(LayerTypes<OutputDataType> layer) { network.push_back(layer); }
 
   /*
    * Add a new module to the model.
@@ -112,16 +112,16 @@ class AddMerge
   void Serialize(Archive& ar, const unsigned int /* version */);
 
  private:
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 
   //! Locally-stored delete visitor module object.
   DeleteVisitor deleteVisitor;
 
   //! Locally-stored output parameter visitor module object.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<OutputDataType> outputParameterVisitor;
 
   //! Locally-stored delta visitor module object.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<OutputDataType> deltaVisitor;
 
   //! Locally-stored delta object.
   OutputDataType delta;
@@ -30,9 +30,9 @@ namespace ann /** Artificial Neural Network. */ {
  * feed-forward fully connected network container which plugs various layers
  * together.
  *
- * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ * @tparam InputDataType Type of the input data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
- * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ * @tparam OutputDataType Type of the output data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
  */
 template <
@@ -107,10 +107,10 @@ class Concat
    *
    * @param layer The Layer to be added to the model.
    */
-  void Add(LayerTypes layer) { network.push_back(layer); }
+  void Add(LayerTypes<OutputDataType> layer) { network.push_back(layer); }
 
   //! Return the model modules.
-  std::vector<LayerTypes>& Model()
+  std::vector<LayerTypes<OutputDataType>>& Model()
   {
     if (model)
     {
@@ -121,28 +121,28 @@ class Concat
   }
 
   //! Return the initial point for the optimization.
-  const arma::mat& Parameters() const { return parameters; }
+  const OutputDataType& Parameters() const { return parameters; }
   //! Modify the initial point for the optimization.
-  arma::mat& Parameters() { return parameters; }
+  OutputDataType& Parameters() { return parameters; }
 
-  arma::mat const& InputParameter() const { return inputParameter; }
+  OutputDataType const& InputParameter() const { return inputParameter; }
   //! Modify the input parameter.
-  arma::mat& InputParameter() { return inputParameter; }
+  OutputDataType& InputParameter() { return inputParameter; }
 
   //! Get the output parameter.
-  arma::mat const& OutputParameter() const { return outputParameter; }
+  OutputDataType const& OutputParameter() const { return outputParameter; }
   //! Modify the output parameter.
-  arma::mat& OutputParameter() { return outputParameter; }
+  OutputDataType& OutputParameter() { return outputParameter; }
 
   //! Get the delta.e
-  arma::mat const& Delta() const { return delta; }
+  OutputDataType const& Delta() const { return delta; }
   //! Modify the delta.
-  arma::mat& Delta() { return delta; }
+  OutputDataType& Delta() { return delta; }
 
   //! Get the gradient.
-  arma::mat const& Gradient() const { return gradient; }
+  OutputDataType const& Gradient() const { return gradient; }
   //! Modify the gradient.
-  arma::mat& Gradient() { return gradient; }
+  OutputDataType& Gradient() { return gradient; }
 
   /**
    * Serialize the layer
@@ -158,34 +158,34 @@ class Concat
   bool same;
 
   //! Locally-stored network modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 
   //! Locally-stored model parameters.
-  arma::mat parameters;
+  OutputDataType parameters;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<OutputDataType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<OutputDataType> outputParameterVisitor;
 
   //! Locally-stored delete visitor.
   DeleteVisitor deleteVisitor;
 
   //! Locally-stored empty list of modules.
-  std::vector<LayerTypes> empty;
+  std::vector<LayerTypes<OutputDataType>> empty;
 
   //! Locally-stored delta object.
-  arma::mat delta;
+  OutputDataType delta;
 
   //! Locally-stored input parameter object.
-  arma::mat inputParameter;
+  OutputDataType inputParameter;
 
   //! Locally-stored output parameter object.
-  arma::mat outputParameter;
+  OutputDataType outputParameter;
 
   //! Locally-stored gradient object.
-  arma::mat gradient;
+  OutputDataType gradient;
 }; // class Concat
 
 } // namespace ann
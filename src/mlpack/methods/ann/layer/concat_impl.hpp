@@ -38,8 +38,8 @@ void Concat<InputDataType, OutputDataType>::Forward(
 
   for (size_t i = 0; i < network.size(); ++i)
   {
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-        boost::apply_visitor(outputParameterVisitor, network[i]))),
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(boost::apply_visitor(outputParameterVisitor, network[i]))),
         network[i]);
 
     if (boost::apply_visitor(
@@ -50,7 +50,7 @@ void Concat<InputDataType, OutputDataType>::Forward(
     }
   }
 
-  output = arma::zeros(outSize, network.size());
+  output.zeros(outSize, network.size());
   for (size_t i = 0; i < network.size(); ++i)
   {
     size_t elements = boost::apply_visitor(outputParameterVisitor,
@@ -82,7 +82,7 @@ void Concat<InputDataType, OutputDataType>::Backward(
     elements = boost::apply_visitor(outputParameterVisitor,
         network[i]).n_elem;
 
-    arma::mat delta;
+    arma::Mat<eT> delta;
     if (gy.n_cols == 1)
     {
       delta = gy.submat(j, 0, j + elements - 1, 0);
@@ -92,9 +92,10 @@ void Concat<InputDataType, OutputDataType>::Backward(
       delta = gy.submat(0, i, elements - 1, i);
     }
 
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[i])), std::move(delta), std::move(
-        boost::apply_visitor(deltaVisitor, network[i]))), network[i]);
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, network[i])), std::move(
+        delta), std::move(boost::apply_visitor(deltaVisitor, network[i]))),
+        network[i]);
 
     if (boost::apply_visitor(deltaVisitor, network[i]).n_elem > outSize)
     {
@@ -116,7 +117,7 @@ void Concat<InputDataType, OutputDataType>::Backward(
 
   if (!same)
   {
-    g = arma::zeros(outSize, network.size());
+    g.zeros(outSize, network.size());
     for (size_t i = 0; i < network.size(); ++i)
     {
       size_t elements = boost::apply_visitor(deltaVisitor, network[i]).n_elem;
@@ -143,7 +144,7 @@ void Concat<InputDataType, OutputDataType>::Gradient(
 {
   for (size_t i = 0; i < network.size(); ++i)
   {
-    boost::apply_visitor(GradientVisitor(std::move(input),
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
         std::move(error)), network[i]);
   }
 }
@@ -18,6 +18,8 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/cached_fft_convolution.hpp>
 
 #include "layer_types.hpp"
 
@@ -161,6 +163,30 @@ class Convolution
   //! Modify the output height.
   size_t& OutputHeight() { return outputHeight; }
 
+  //! Get the number of input maps.
+  size_t InputSize() const { return inSize; }
+
+  //! Get the number of output maps.
+  size_t OutputSize() const { return outSize; }
+
+  //! Get the filter width.
+  size_t KernelWidth() const { return kW; }
+
+  //! Get the filter height.
+  size_t KernelHeight() const { return kH; }
+
+  //! Get the stride of the filter in x-direction.
+  size_t StrideWidth() const { return dW; }
+
+  //! Get the stride of the filter in y-direction.
+  size_t StrideHeight() const { return dH; }
+
+  //! Get the padding width.
+  size_t PadWidth() const { return padW; }
+
+  //! Get the padding height.
+  size_t PadHeight() const { return padH; }
+
   /**
    * Serialize the layer
    */
@@ -231,7 +257,7 @@ class Convolution
     if (output.n_rows != input.n_rows + wPad * 2 ||
         output.n_cols != input.n_cols + hPad * 2)
     {
-      output = arma::zeros(input.n_rows + wPad * 2, input.n_cols + hPad * 2);
+      output.zeros(input.n_rows + wPad * 2, input.n_cols + hPad * 2);
     }
 
     output.submat(wPad, hPad, wPad + input.n_rows - 1,
@@ -252,12 +278,62 @@ class Convolution
            size_t hPad,
            arma::Cube<eT>& output)
   {
-    output = arma::zeros(input.n_rows + wPad * 2,
-        input.n_cols + hPad * 2, input.n_slices);
+    output.zeros(input.n_rows + wPad * 2, input.n_cols + hPad * 2,
+        input.n_slices);
 
     for (size_t i = 0; i < input.n_slices; ++i)
     {
-      Pad<double>(input.slice(i), wPad, hPad, output.slice(i));
+      Pad<eT>(input.slice(i), wPad, hPad, output.slice(i));
+    }
+  }
+
+  /*
+   * Compute the spectra of the filters at the given size, unless they were
+   * already computed at that size from the current parameters.
+   *
+   * @param rows Number of rows of the spectra.
+   * @param cols Number of columns of the spectra.
+   */
+  void UpdateFilterSpectra(const size_t rows, const size_t cols)
+  {
+    if (filterSpectra.n_rows == rows && filterSpectra.n_cols == cols &&
+        filterSpectra.n_slices == weight.n_slices &&
+        spectraWeights.n_elem == weight.n_elem &&
+        std::equal(weight.begin(), weight.end(), spectraWeights.begin()))
+    {
+      return;
+    }
+
+    CachedFFTConvolution<>::Spectra(weight, rows, cols, filterSpectra);
+    spectraWeights = OutputDataType(weight.memptr(), weight.n_elem, 1);
+  }
+
+  /*
+   * Compute the spectrum of each map of the given error, at the given size.
+   * The error entries are placed dW rows and dH columns apart, as the
+   * outputs they belong to, so that strides are taken into account.
+   *
+   * @param error The error of the output maps.
+   * @param rows Number of rows of the spectra.
+   * @param cols Number of columns of the spectra.
+   */
+  template<typename eT>
+  void UpdateErrorSpectra(const arma::Mat<eT>& error,
+                          const size_t rows,
+                          const size_t cols)
+  {
+    arma::Mat<eT> spreadError(rows, cols);
+    errorSpectra.set_size(rows, cols, outSize);
+
+    const eT* errorPtr = error.memptr();
+    for (size_t outMap = 0; outMap < outSize; ++outMap)
+    {
+      spreadError.zeros();
+      for (size_t j = 0; j < outputHeight; ++j)
+        for (size_t i = 0; i < outputWidth; ++i, ++errorPtr)
+          spreadError(i * dW, j * dH) = *errorPtr;
+
+      errorSpectra.slice(outMap) = arma::fft2(spreadError);
     }
   }
 
@@ -289,10 +365,10 @@ class Convolution
   OutputDataType weights;
 
   //! Locally-stored weight object.
-  arma::cube weight;
+  arma::Cube<typename OutputDataType::elem_type> weight;
 
   //! Locally-stored bias term object.
-  arma::mat bias;
+  OutputDataType bias;
 
   //! Locally-stored input width.
   size_t inputWidth;
@@ -307,19 +383,42 @@ class Convolution
   size_t outputHeight;
 
   //! Locally-stored transformed output parameter.
-  arma::cube outputTemp;
+  arma::Cube<typename OutputDataType::elem_type> outputTemp;
 
   //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
+  arma::Cube<typename OutputDataType::elem_type> inputTemp;
 
   //! Locally-stored transformed padded input parameter.
-  arma::cube inputPaddedTemp;
+  arma::Cube<typename OutputDataType::elem_type> inputPaddedTemp;
 
   //! Locally-stored transformed error parameter.
-  arma::cube gTemp;
+  arma::Cube<typename OutputDataType::elem_type> gTemp;
 
   //! Locally-stored transformed gradient parameter.
-  arma::cube gradientTemp;
+  arma::Cube<typename OutputDataType::elem_type> gradientTemp;
+
+  //! Locally-stored lowered input, if the rules are Im2ColConvolution.
+  OutputDataType columns;
+
+  //! Locally-stored error of the lowered input, if the rules are
+  //! Im2ColConvolution.
+  OutputDataType columnsDelta;
+
+  //! Locally-stored spectra of the filters, if the rules are
+  //! CachedFFTConvolution.
+  arma::Cube<std::complex<typename OutputDataType::elem_type> > filterSpectra;
+
+  //! Locally-stored copy of the parameters the filter spectra were computed
+  //! from.
+  OutputDataType spectraWeights;
+
+  //! Locally-stored spectra of the input maps, if the rules are
+  //! CachedFFTConvolution.
+  arma::Cube<std::complex<typename OutputDataType::elem_type> > inputSpectra;
+
+  //! Locally-stored spectra of the error maps, if the rules are
+  //! CachedFFTConvolution.
+  arma::Cube<std::complex<typename OutputDataType::elem_type> > errorSpectra;
 
   //! Locally-stored delta object.
   OutputDataType delta;
@@ -91,9 +91,9 @@ void Convolution<
     OutputDataType
 >::Reset()
 {
-    weight = arma::cube(weights.memptr(), kW, kH,
-        outSize * inSize, false, false);
-    bias = arma::mat(weights.memptr() + weight.n_elem,
+    weight = arma::Cube<typename OutputDataType::elem_type>(weights.memptr(),
+        kW, kH, outSize * inSize, false, false);
+    bias = OutputDataType(weights.memptr() + weight.n_elem,
         outSize, 1, false, false);
 }
 
@@ -113,7 +113,7 @@ void Convolution<
     OutputDataType
 >::Forward(const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, inSize);
+  inputTemp = arma::Cube<eT>(input.memptr(), inputWidth, inputHeight, inSize);
 
   if (padW != 0 || padH != 0)
   {
@@ -123,6 +123,62 @@ void Convolution<
   size_t wConv = ConvOutSize(inputWidth, kW, dW, padW);
   size_t hConv = ConvOutSize(inputHeight, kH, dH, padH);
 
+  if (IsIm2ColConvolution<ForwardConvolutionRule>::value)
+  {
+    // Lower all the input maps, so that all the output maps are computed with
+    // one matrix multiplication.
+    Im2ColConvolution<>::Im2Col((padW != 0 || padH != 0) ? inputPaddedTemp :
+        inputTemp, kW, kH, dW, dH, columns);
+
+    outputTemp.set_size(wConv, hConv, outSize);
+    arma::Mat<eT> outputMaps(outputTemp.memptr(), wConv * hConv, outSize,
+        false, true);
+    outputMaps = columns.t() * arma::Mat<eT>(weight.memptr(),
+        kW * kH * inSize, outSize, false, true);
+    outputMaps.each_row() += arma::trans(bias.col(0));
+
+    output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
+
+    outputWidth = outputTemp.n_rows;
+    outputHeight = outputTemp.n_cols;
+    return;
+  }
+
+  if (IsCachedFFTConvolution<ForwardConvolutionRule>::value)
+  {
+    // Transform all the input maps at once; the filter spectra are only
+    // recomputed when the parameters changed.
+    const arma::Cube<eT>& maps = (padW != 0 || padH != 0) ? inputPaddedTemp :
+        inputTemp;
+    UpdateFilterSpectra(maps.n_rows, maps.n_cols);
+    CachedFFTConvolution<>::Spectra(maps, maps.n_rows, maps.n_cols,
+        inputSpectra);
+
+    outputTemp.set_size(wConv, hConv, outSize);
+    arma::Mat<std::complex<eT> > sum(maps.n_rows, maps.n_cols);
+    for (size_t outMap = 0; outMap < outSize; outMap++)
+    {
+      // Sum the correlations with all the input maps in the frequency domain,
+      // so that the output map takes a single inverse transform.
+      sum.zeros();
+      for (size_t inMap = 0; inMap < inSize; inMap++)
+      {
+        sum += inputSpectra.slice(inMap) %
+            arma::conj(filterSpectra.slice(outMap * inSize + inMap));
+      }
+
+      CachedFFTConvolution<>::Subsample(arma::Mat<eT>(arma::real(
+          arma::ifft2(sum))), dW, dH, outputTemp.slice(outMap));
+      outputTemp.slice(outMap) += bias(outMap);
+    }
+
+    output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
+
+    outputWidth = outputTemp.n_rows;
+    outputHeight = outputTemp.n_cols;
+    return;
+  }
+
   outputTemp = arma::zeros<arma::Cube<eT> >(wConv, hConv, outSize);
 
   for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
@@ -171,7 +227,59 @@ void Convolution<
 >::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(),
+  if (IsIm2ColConvolution<BackwardConvolutionRule>::value)
+  {
+    // Compute the error of the lowered input with one matrix multiplication,
+    // then add it back onto the input maps.
+    const arma::Mat<eT> mappedError(gy.memptr(), outputWidth * outputHeight,
+        outSize, false, true);
+    columnsDelta = arma::Mat<eT>(weight.memptr(), kW * kH * inSize, outSize,
+        false, true) * mappedError.t();
+
+    gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows + 2 * padW,
+        inputTemp.n_cols + 2 * padH, inputTemp.n_slices);
+    Im2ColConvolution<>::Col2Im(columnsDelta, kW, kH, dW, dH, gTemp);
+    if (padW != 0 || padH != 0)
+    {
+      gTemp = gTemp.tube(padW, padH, padW + inputTemp.n_rows - 1,
+          padH + inputTemp.n_cols - 1);
+    }
+
+    g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem, 1);
+    return;
+  }
+
+  if (IsCachedFFTConvolution<BackwardConvolutionRule>::value)
+  {
+    // The error of the padded input maps is the sum of the convolutions of the
+    // error maps with the filters; sum them in the frequency domain, so that
+    // each input map takes a single inverse transform.
+    const size_t rows = inputTemp.n_rows + 2 * padW;
+    const size_t cols = inputTemp.n_cols + 2 * padH;
+    UpdateFilterSpectra(rows, cols);
+    UpdateErrorSpectra(gy, rows, cols);
+
+    gTemp.set_size(inputTemp.n_rows, inputTemp.n_cols, inSize);
+    arma::Mat<std::complex<eT> > sum(rows, cols);
+    for (size_t inMap = 0; inMap < inSize; inMap++)
+    {
+      sum.zeros();
+      for (size_t outMap = 0; outMap < outSize; outMap++)
+      {
+        sum += errorSpectra.slice(outMap) %
+            filterSpectra.slice(outMap * inSize + inMap);
+      }
+
+      const arma::Mat<eT> inputError = arma::real(arma::ifft2(sum));
+      gTemp.slice(inMap) = inputError.submat(padW, padH,
+          padW + inputTemp.n_rows - 1, padH + inputTemp.n_cols - 1);
+    }
+
+    g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem, 1);
+    return;
+  }
+
+  arma::Cube<eT> mappedError = arma::Cube<eT>(gy.memptr(),
         outputWidth, outputHeight, outSize);
   gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
@@ -201,7 +309,7 @@ void Convolution<
     }
   }
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem, 1);
 }
 
 template<
@@ -223,15 +331,71 @@ void Convolution<
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  arma::cube mappedError;
+  if (IsIm2ColConvolution<GradientConvolutionRule>::value)
+  {
+    // The lowered input is still there if Forward() computed it.
+    if (!IsIm2ColConvolution<ForwardConvolutionRule>::value)
+    {
+      Im2ColConvolution<>::Im2Col((padW != 0 || padH != 0) ?
+          inputPaddedTemp : inputTemp, kW, kH, dW, dH, columns);
+    }
+
+    // Compute the gradient of all the filters with one matrix multiplication.
+    const arma::Mat<eT> mappedError(error.memptr(), outputWidth *
+        outputHeight, outSize, false, true);
+    arma::Mat<eT> weightGradient(gradient.memptr(), kW * kH * inSize, outSize,
+        false, true);
+    weightGradient = columns * mappedError;
+
+    gradient.submat(weight.n_elem, 0, weight.n_elem + outSize - 1, 0) =
+        arma::trans(arma::sum(mappedError));
+    return;
+  }
+
+  if (IsCachedFFTConvolution<GradientConvolutionRule>::value)
+  {
+    // The input spectra are still there if Forward() computed them.
+    const arma::Cube<eT>& maps = (padW != 0 || padH != 0) ? inputPaddedTemp :
+        inputTemp;
+    if (!IsCachedFFTConvolution<ForwardConvolutionRule>::value)
+    {
+      CachedFFTConvolution<>::Spectra(maps, maps.n_rows, maps.n_cols,
+          inputSpectra);
+    }
+    UpdateErrorSpectra(error, maps.n_rows, maps.n_cols);
+
+    // The gradient of each filter is the correlation of its input map with the
+    // error of its output map.
+    arma::Cube<eT> weightGradient(gradient.memptr(), kW, kH, outSize * inSize,
+        false, true);
+    for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
+    {
+      for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
+      {
+        const arma::Mat<eT> correlation = arma::real(arma::ifft2(
+            inputSpectra.slice(inMap) % arma::conj(errorSpectra.slice(
+            outMap))));
+        weightGradient.slice(outMapIdx) = correlation.submat(0, 0, kW - 1,
+            kH - 1);
+      }
+    }
+
+    const arma::Mat<eT> mappedError(error.memptr(), outputWidth *
+        outputHeight, outSize, false, true);
+    gradient.submat(weight.n_elem, 0, weight.n_elem + outSize - 1, 0) =
+        arma::trans(arma::sum(mappedError));
+    return;
+  }
+
+  arma::Cube<eT> mappedError;
   if (padW != 0 && padH != 0)
   {
-    mappedError = arma::cube(error.memptr(), outputWidth / padW,
+    mappedError = arma::Cube<eT>(error.memptr(), outputWidth / padW,
         outputHeight / padH, outSize);
   }
   else
   {
-    mappedError = arma::cube(error.memptr(), outputWidth,
+    mappedError = arma::Cube<eT>(error.memptr(), outputWidth,
         outputHeight, outSize);
   }
 
@@ -265,7 +429,7 @@ void Convolution<
       {
         for (size_t i = 0; i < output.n_slices; i++)
         {
-          arma::mat subOutput = output.slice(i);
+          arma::Mat<eT> subOutput = output.slice(i);
 
           gradientTemp.slice(s) += subOutput.submat(subOutput.n_rows / 2,
               subOutput.n_cols / 2,
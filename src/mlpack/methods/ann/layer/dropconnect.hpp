@@ -15,6 +15,7 @@
 #define MLPACK_METHODS_ANN_LAYER_DROPCONNECT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 #include "layer_types.hpp"
 #include "add_merge.hpp"
@@ -113,7 +114,7 @@ class DropConnect
                 arma::Mat<eT>&& /* gradient */);
 
   //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
+  std::vector<LayerTypes<OutputDataType>>& Model() { return network; }
 
   //! Get the parameters.
   OutputDataType const& Parameters() const { return parameters; }
@@ -194,10 +195,10 @@ class DropConnect
   OutputDataType denoise;
 
   //! Locally-stored layer module.
-  LayerTypes baseLayer;
+  LayerTypes<OutputDataType> baseLayer;
 
   //! Locally-stored network modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 }; // class DropConnect.
 
 }  // namespace ann
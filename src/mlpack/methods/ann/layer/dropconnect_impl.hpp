@@ -40,7 +40,7 @@ DropConnect<InputDataType, OutputDataType>::DropConnect(
     const double ratio) :
     ratio(ratio),
     scale(1.0 / (1 - ratio)),
-    baseLayer(new Linear<InputDataType, OutputDataType>(inSize, outSize))
+    baseLayer(new Linear<OutputDataType, OutputDataType>(inSize, outSize))
 {
   network.push_back(baseLayer);
 }
@@ -61,24 +61,25 @@ void DropConnect<InputDataType, OutputDataType>::Forward(
   // (during testing).
   if (deterministic)
   {
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(output)),
-        baseLayer);
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(output)), baseLayer);
   }
   else
   {
     // Save weights for denoising.
-    boost::apply_visitor(ParametersVisitor(std::move(denoise)), baseLayer);
+    boost::apply_visitor(ParametersVisitor<OutputDataType>(std::move(denoise)),
+        baseLayer);
 
     // Scale with input / (1 - ratio) and set values to zero with
     // probability ratio.
-    mask = arma::randu<arma::Mat<eT> >(denoise.n_rows, denoise.n_cols);
-    mask.transform([&](double val) { return (val > ratio); });
+    mask.set_size(denoise.n_rows, denoise.n_cols);
+    math::RandBernoulliFill(mask, 1.0 - ratio);
 
-    boost::apply_visitor(ParametersSetVisitor(std::move(denoise % mask)),
-        baseLayer);
+    boost::apply_visitor(ParametersSetVisitor<OutputDataType>(std::move(denoise
+        % mask)), baseLayer);
 
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(output)),
-        baseLayer);
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(output)), baseLayer);
 
     output = output * scale;
   }
@@ -91,8 +92,8 @@ void DropConnect<InputDataType, OutputDataType>::Backward(
     arma::Mat<eT>&& gy,
     arma::Mat<eT>&& g)
 {
-  boost::apply_visitor(BackwardVisitor(std::move(input), std::move(gy),
-      std::move(g)), baseLayer);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(input),
+      std::move(gy), std::move(g)), baseLayer);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -102,11 +103,12 @@ void DropConnect<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& /* gradient */)
 {
-  boost::apply_visitor(GradientVisitor(std::move(input), std::move(error)),
-      baseLayer);
+  boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+      std::move(error)), baseLayer);
 
   // Denoise the weights.
-  boost::apply_visitor(ParametersSetVisitor(std::move(denoise)), baseLayer);
+  boost::apply_visitor(ParametersSetVisitor<OutputDataType>(std::move(denoise)),
+      baseLayer);
 }
 
 template<typename InputDataType, typename OutputDataType>
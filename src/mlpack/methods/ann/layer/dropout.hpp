@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_ANN_LAYER_DROPOUT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -52,8 +52,8 @@ void Dropout<InputDataType, OutputDataType>::Forward(
   {
     // Scale with input / (1 - ratio) and set values to zero with probability
     // ratio.
-    mask = arma::randu<arma::Mat<eT> >(input.n_rows, input.n_cols);
-    mask.transform( [&](double val) { return (val > ratio); } );
+    mask.set_size(input.n_rows, input.n_cols);
+    math::RandBernoulliFill(mask, 1.0 - ratio);
     output = input % mask * scale;
   }
 }
@@ -0,0 +1,215 @@
+/**
+ * @file fast_lstm.hpp
+ *
+ * Definition of the FastLSTM class, which implements a lstm network layer
+ * whose gates are computed together.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_FAST_LSTM_HPP
+#define MLPACK_METHODS_ANN_LAYER_FAST_LSTM_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * An implementation of a lstm network layer that computes the pre-activations
+ * of all four gates with a single matrix multiplication of the stacked weights
+ * with the stacked input and previous output, instead of going through
+ * separate modules like the LSTM layer.  The layer processes a batch of
+ * sequences at once (one sequence per column), and stores the activations of
+ * all the steps of the sequences in cubes that are only reallocated when the
+ * batch size changes, for backpropagation through time.
+ *
+ * The gates are stored in the order input gate, forget gate, output gate and
+ * cell candidate.
+ *
+ * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ */
+template <
+    typename InputDataType = arma::mat,
+    typename OutputDataType = arma::mat
+>
+class FastLSTM
+{
+ public:
+  //! Create the FastLSTM object.
+  FastLSTM();
+
+  /**
+   * Create the FastLSTM layer object using the specified parameters.
+   *
+   * @param inSize The number of input units.
+   * @param outSize The number of output units.
+   * @param rho Maximum number of steps to backpropagate through time (BPTT).
+   */
+  FastLSTM(const size_t inSize, const size_t outSize, const size_t rho);
+
+  /*
+   * Reset the layer parameter.
+   */
+  void Reset();
+
+  /**
+   * Ordinary feed forward pass of a neural network, evaluating the function
+   * f(x) by propagating the activity forward through f.  Each column of the
+   * input is one step of a different sequence.
+   *
+   * @param input Input data used for evaluating the specified function.
+   * @param output Resulting output activation.
+   */
+  template<typename eT>
+  void Forward(const arma::Mat<eT>&& input, arma::Mat<eT>&& output);
+
+  /**
+   * Ordinary feed backward pass of a neural network, calculating the function
+   * f(x) by propagating x backwards trough f. Using the results from the feed
+   * forward pass.  The steps are visited in reverse order.
+   *
+   * @param input The propagated input activation.
+   * @param gy The backpropagated error.
+   * @param g The calculated gradient.
+   */
+  template<typename eT>
+  void Backward(const arma::Mat<eT>&& /* input */,
+                arma::Mat<eT>&& gy,
+                arma::Mat<eT>&& g);
+
+  /*
+   * Calculate the gradient of the step of the last call to Backward(), using
+   * the stored input of that step.
+   *
+   * @param input The input parameter used for calculating the gradient.
+   * @param error The calculated error.
+   * @param gradient The calculated gradient.
+   */
+  template<typename eT>
+  void Gradient(const arma::Mat<eT>&& /* input */,
+                arma::Mat<eT>&& /* error */,
+                arma::Mat<eT>&& gradient);
+
+  //! Get the maximum number of steps to backpropagate through time (BPTT).
+  size_t Rho() const { return rho; }
+  //! Modify the maximum number of steps to backpropagate through time (BPTT).
+  size_t& Rho() { return rho; }
+
+  //! Get the step of the sequences the next Forward() call computes.
+  size_t ForwardStep() const { return forwardStep; }
+  //! Modify the step of the sequences the next Forward() call computes; the
+  //! state of the earlier steps is kept, so a step can be computed again.
+  size_t& ForwardStep() { return forwardStep; }
+
+  //! Get the parameters.
+  OutputDataType const& Parameters() const { return weights; }
+  //! Modify the parameters.
+  OutputDataType& Parameters() { return weights; }
+
+  //! Get the input parameter.
+  InputDataType const& InputParameter() const { return inputParameter; }
+  //! Modify the input parameter.
+  InputDataType& InputParameter() { return inputParameter; }
+
+  //! Get the output parameter.
+  OutputDataType const& OutputParameter() const { return outputParameter; }
+  //! Modify the output parameter.
+  OutputDataType& OutputParameter() { return outputParameter; }
+
+  //! Get the delta.
+  OutputDataType const& Delta() const { return delta; }
+  //! Modify the delta.
+  OutputDataType& Delta() { return delta; }
+
+  //! Get the gradient.
+  OutputDataType const& Gradient() const { return gradient; }
+  //! Modify the gradient.
+  OutputDataType& Gradient() { return gradient; }
+
+  /**
+   * Serialize the layer
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The type of the stored activations.
+  typedef arma::Cube<typename OutputDataType::elem_type> CubeType;
+
+  //! Locally-stored number of input units.
+  size_t inSize;
+
+  //! Locally-stored number of output units.
+  size_t outSize;
+
+  //! Number of steps to backpropagate through time (BPTT).
+  size_t rho;
+
+  //! Locally-stored number of forward steps.
+  size_t forwardStep;
+
+  //! Locally-stored number of backward steps.
+  size_t backwardStep;
+
+  //! Locally-stored number of gradient steps.
+  size_t gradientStep;
+
+  //! Locally-stored weight object.
+  OutputDataType weights;
+
+  //! Locally-stored stacked gate weights (4 * outSize x (inSize + outSize)).
+  OutputDataType weight;
+
+  //! Locally-stored stacked gate biases.
+  OutputDataType bias;
+
+  //! The stacked input and previous output of each step.
+  CubeType stackedInput;
+
+  //! The gate activations of each step.
+  CubeType gateActivation;
+
+  //! The cell state before (slice 0) and after each step.
+  CubeType cellState;
+
+  //! The activation of the cell state of each step.
+  CubeType cellActivation;
+
+  //! Locally-stored error with respect to the output of the current step.
+  OutputDataType outputError;
+
+  //! Locally-stored error with respect to the cell state of the current step.
+  OutputDataType cellError;
+
+  //! Locally-stored error with respect to the gate pre-activations.
+  OutputDataType gateError;
+
+  //! Locally-stored error with respect to the stacked input.
+  OutputDataType stackedError;
+
+  //! Locally-stored delta object.
+  OutputDataType delta;
+
+  //! Locally-stored gradient object.
+  OutputDataType gradient;
+
+  //! Locally-stored input parameter object.
+  InputDataType inputParameter;
+
+  //! Locally-stored output parameter object.
+  OutputDataType outputParameter;
+}; // class FastLSTM
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "fast_lstm_impl.hpp"
+
+#endif
@@ -0,0 +1,217 @@
+/**
+ * @file fast_lstm_impl.hpp
+ *
+ * Implementation of the FastLSTM class, which implements a lstm network layer
+ * whose gates are computed together.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_FAST_LSTM_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_FAST_LSTM_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "fast_lstm.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename InputDataType, typename OutputDataType>
+FastLSTM<InputDataType, OutputDataType>::FastLSTM() :
+    forwardStep(0),
+    backwardStep(0),
+    gradientStep(0)
+{
+  // Nothing to do here.
+}
+
+template<typename InputDataType, typename OutputDataType>
+FastLSTM<InputDataType, OutputDataType>::FastLSTM(
+    const size_t inSize,
+    const size_t outSize,
+    const size_t rho) :
+    inSize(inSize),
+    outSize(outSize),
+    rho(rho),
+    forwardStep(0),
+    backwardStep(0),
+    gradientStep(0)
+{
+  weights.set_size(4 * outSize * (inSize + outSize) + 4 * outSize, 1);
+}
+
+template<typename InputDataType, typename OutputDataType>
+void FastLSTM<InputDataType, OutputDataType>::Reset()
+{
+  weight = OutputDataType(weights.memptr(), 4 * outSize, inSize + outSize,
+      false, false);
+  bias = OutputDataType(weights.memptr() + weight.n_elem, 4 * outSize, 1,
+      false, false);
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void FastLSTM<InputDataType, OutputDataType>::Forward(
+    const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
+{
+  const size_t batchSize = input.n_cols;
+
+  // The activations are only reallocated if the batch size changes, in which
+  // case new sequences start.
+  if (stackedInput.n_cols != batchSize || stackedInput.n_slices != rho)
+  {
+    stackedInput.set_size(inSize + outSize, batchSize, rho);
+    gateActivation.set_size(4 * outSize, batchSize, rho);
+    cellState.set_size(outSize, batchSize, rho + 1);
+    cellActivation.set_size(outSize, batchSize, rho);
+    forwardStep = 0;
+  }
+
+  // Every sequence starts with an empty output and cell state.
+  if (forwardStep == 0)
+  {
+    stackedInput.slice(0).rows(inSize, inSize + outSize - 1).zeros();
+    cellState.slice(0).zeros();
+  }
+
+  arma::Mat<eT>& stacked = stackedInput.slice(forwardStep);
+  stacked.rows(0, inSize - 1) = input;
+
+  // Compute the pre-activations of all the gates of all the sequences at once.
+  arma::Mat<eT>& gates = gateActivation.slice(forwardStep);
+  gates = weight * stacked;
+  gates.each_col() += bias;
+
+  output.set_size(outSize, batchSize);
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    eT* gate = gates.colptr(j);
+    for (size_t k = 0; k < 3 * outSize; ++k)
+      gate[k] = 1.0 / (1.0 + std::exp(-gate[k]));
+    for (size_t k = 3 * outSize; k < 4 * outSize; ++k)
+      gate[k] = std::tanh(gate[k]);
+
+    // Update the cell: input gate * cell candidate + forget gate * prevCell.
+    const eT* prevCell = cellState.slice_colptr(forwardStep, j);
+    eT* cell = cellState.slice_colptr(forwardStep + 1, j);
+    eT* cellAct = cellActivation.slice_colptr(forwardStep, j);
+    eT* out = output.colptr(j);
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      cell[k] = gate[k] * gate[3 * outSize + k] +
+          gate[outSize + k] * prevCell[k];
+      cellAct[k] = std::tanh(cell[k]);
+      out[k] = gate[2 * outSize + k] * cellAct[k];
+    }
+  }
+
+  // The output is part of the input of the next step.
+  if (forwardStep + 1 < rho)
+  {
+    stackedInput.slice(forwardStep + 1).rows(inSize, inSize + outSize - 1) =
+        output;
+  }
+
+  forwardStep++;
+  if (forwardStep == rho)
+    forwardStep = 0;
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void FastLSTM<InputDataType, OutputDataType>::Backward(
+  const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
+{
+  const size_t step = rho - 1 - backwardStep;
+  const size_t batchSize = gy.n_cols;
+
+  // The error of the output also includes the error that the next step
+  // propagated back through its input.
+  if (backwardStep == 0)
+  {
+    outputError = gy;
+    cellError.zeros(outSize, batchSize);
+  }
+  else
+  {
+    outputError += gy;
+  }
+
+  const arma::Mat<eT>& gates = gateActivation.slice(step);
+  gateError.set_size(4 * outSize, batchSize);
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const eT* gate = gates.colptr(j);
+    const eT* prevCell = cellState.slice_colptr(step, j);
+    const eT* cellAct = cellActivation.slice_colptr(step, j);
+    const eT* outError = outputError.colptr(j);
+    eT* cError = cellError.colptr(j);
+    eT* gError = gateError.colptr(j);
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const eT inputGate = gate[k];
+      const eT forgetGate = gate[outSize + k];
+      const eT outputGate = gate[2 * outSize + k];
+      const eT candidate = gate[3 * outSize + k];
+
+      cError[k] += outError[k] * outputGate * (1 - cellAct[k] * cellAct[k]);
+      gError[k] = cError[k] * candidate * inputGate * (1 - inputGate);
+      gError[outSize + k] = cError[k] * prevCell[k] * forgetGate *
+          (1 - forgetGate);
+      gError[2 * outSize + k] = outError[k] * cellAct[k] * outputGate *
+          (1 - outputGate);
+      gError[3 * outSize + k] = cError[k] * inputGate *
+          (1 - candidate * candidate);
+
+      // Error of the cell state of the previous step.
+      cError[k] *= forgetGate;
+    }
+  }
+
+  // Propagate the error of all the gates back at once; the part belonging to
+  // the previous output goes to the previous step.
+  stackedError = weight.t() * gateError;
+  g = stackedError.rows(0, inSize - 1);
+  outputError = stackedError.rows(inSize, inSize + outSize - 1);
+
+  backwardStep++;
+  if (backwardStep == rho)
+    backwardStep = 0;
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void FastLSTM<InputDataType, OutputDataType>::Gradient(
+    const arma::Mat<eT>&& /* input */,
+    arma::Mat<eT>&& /* error */,
+    arma::Mat<eT>&& gradient)
+{
+  const size_t step = rho - 1 - gradientStep;
+
+  arma::Mat<eT> weightGradient(gradient.memptr(), weight.n_rows,
+      weight.n_cols, false, true);
+  weightGradient = gateError * stackedInput.slice(step).t();
+  gradient.rows(weight.n_elem, gradient.n_elem - 1) = arma::sum(gateError, 1);
+
+  gradientStep++;
+  if (gradientStep == rho)
+    gradientStep = 0;
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename Archive>
+void FastLSTM<InputDataType, OutputDataType>::Serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(weights, "weights");
+  ar & data::CreateNVP(inSize, "inSize");
+  ar & data::CreateNVP(outSize, "outSize");
+  ar & data::CreateNVP(rho, "rho");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -38,7 +38,7 @@ template<typename eT>
 void Glimpse<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  inputTemp = arma::cube(input.colptr(0), inputWidth, inputHeight, inSize);
+  inputTemp = arma::Cube<eT>(input.colptr(0), inputWidth, inputHeight, inSize);
   outputTemp = arma::Cube<eT>(size, size, depth * inputTemp.n_slices);
 
   location = input.submat(0, 1, 1, 1);
@@ -123,7 +123,7 @@ void Glimpse<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
   // Generate a cube using the backpropagated error matrix.
-  arma::Cube<eT> mappedError = arma::zeros<arma::cube>(outputWidth,
+  arma::Cube<eT> mappedError = arma::zeros<arma::Cube<eT> >(outputWidth,
       outputHeight, 1);
 
   location = locationParameter.back();
@@ -138,7 +138,7 @@ void Glimpse<InputDataType, OutputDataType>::Backward(
     }
   }
 
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows, inputTemp.n_cols,
+  gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows, inputTemp.n_cols,
       inputTemp.n_slices);
 
   for (size_t inputIdx = 0; inputIdx < inSize; inputIdx++)
@@ -202,7 +202,7 @@ void Glimpse<InputDataType, OutputDataType>::Backward(
   }
 
   Transform(gTemp);
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
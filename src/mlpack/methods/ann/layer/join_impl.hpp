@@ -41,7 +41,7 @@ void Join<InputDataType, OutputDataType>::Backward(
     arma::Mat<eT>&& gy,
     arma::Mat<eT>&& g)
 {
-  g = arma::mat(gy.memptr(), inSizeRows, inSizeCols, false, false);
+  g = arma::Mat<eT>(gy.memptr(), inSizeRows, inSizeCols, false, false);
 }
 
 template<typename InputDataType, typename OutputDataType>
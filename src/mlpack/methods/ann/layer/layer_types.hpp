@@ -20,6 +20,7 @@
 #include <mlpack/methods/ann/layer/constant.hpp>
 #include <mlpack/methods/ann/layer/dropout.hpp>
 #include <mlpack/methods/ann/layer/elu.hpp>
+#include <mlpack/methods/ann/layer/fast_lstm.hpp>
 #include <mlpack/methods/ann/layer/hard_tanh.hpp>
 #include <mlpack/methods/ann/layer/join.hpp>
 #include <mlpack/methods/ann/layer/leaky_relu.hpp>
@@ -33,11 +34,15 @@
 #include <mlpack/methods/ann/layer/parametric_relu.hpp>
 #include <mlpack/methods/ann/layer/reinforce_normal.hpp>
 #include <mlpack/methods/ann/layer/select.hpp>
+#include <mlpack/methods/ann/layer/softmax_cross_entropy.hpp>
+#include <mlpack/methods/ann/layer/sparse_linear.hpp>
 
 // Convolution modules.
 #include <mlpack/methods/ann/convolution_rules/border_modes.hpp>
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/cached_fft_convolution.hpp>
 
 namespace mlpack {
 namespace ann {
@@ -75,44 +80,61 @@ template<
 >
 class RecurrentAttention;
 
+/**
+ * The types of all the modules that can be used to construct a model working
+ * on the given matrix type.  All modules of a model share the same matrix type,
+ * so that a model can work entirely in single precision (arma::fmat).
+ *
+ * @tparam MatType Type of the data and parameters of the modules (arma::mat or
+ *     arma::fmat).
+ */
+template<typename MatType = arma::mat>
 using LayerTypes = boost::variant<
-    Add<arma::mat, arma::mat>*,
-    AddMerge<arma::mat, arma::mat>*,
-    BaseLayer<LogisticFunction, arma::mat, arma::mat>*,
-    BaseLayer<IdentityFunction, arma::mat, arma::mat>*,
-    BaseLayer<TanhFunction, arma::mat, arma::mat>*,
-    BaseLayer<RectifierFunction, arma::mat, arma::mat>*,
-    Concat<arma::mat, arma::mat>*,
-    ConcatPerformance<NegativeLogLikelihood<arma::mat, arma::mat>,
-                      arma::mat, arma::mat>*,
-    Constant<arma::mat, arma::mat>*,
+    Add<MatType, MatType>*,
+    AddMerge<MatType, MatType>*,
+    BaseLayer<LogisticFunction, MatType, MatType>*,
+    BaseLayer<IdentityFunction, MatType, MatType>*,
+    BaseLayer<TanhFunction, MatType, MatType>*,
+    BaseLayer<RectifierFunction, MatType, MatType>*,
+    Concat<MatType, MatType>*,
+    ConcatPerformance<NegativeLogLikelihood<MatType, MatType>,
+                      MatType, MatType>*,
+    Constant<MatType, MatType>*,
     Convolution<NaiveConvolution<ValidConvolution>,
                 NaiveConvolution<FullConvolution>,
-                NaiveConvolution<ValidConvolution>, arma::mat, arma::mat>*,
-    DropConnect<arma::mat, arma::mat>*,
-    Dropout<arma::mat, arma::mat>*,
-    ELU<arma::mat, arma::mat>*,
-    Glimpse<arma::mat, arma::mat>*,
-    HardTanH<arma::mat, arma::mat>*,
-    Join<arma::mat, arma::mat>*,
-    LeakyReLU<arma::mat, arma::mat>*,
-    Linear<arma::mat, arma::mat>*,
-    LinearNoBias<arma::mat, arma::mat>*,
-    LogSoftMax<arma::mat, arma::mat>*,
-    Lookup<arma::mat, arma::mat>*,
-    LSTM<arma::mat, arma::mat>*,
-    MaxPooling<arma::mat, arma::mat>*,
-    MeanPooling<arma::mat, arma::mat>*,
-    MeanSquaredError<arma::mat, arma::mat>*,
-    MultiplyConstant<arma::mat, arma::mat>*,
-    NegativeLogLikelihood<arma::mat, arma::mat>*,
-    PReLU<arma::mat, arma::mat>*,
-    Recurrent<arma::mat, arma::mat>*,
-    RecurrentAttention<arma::mat, arma::mat>*,
-    ReinforceNormal<arma::mat, arma::mat>*,
-    Select<arma::mat, arma::mat>*,
-    Sequential<arma::mat, arma::mat>*,
-    VRClassReward<arma::mat, arma::mat>*
+                NaiveConvolution<ValidConvolution>, MatType, MatType>*,
+    Convolution<Im2ColConvolution<ValidConvolution>,
+                Im2ColConvolution<FullConvolution>,
+                Im2ColConvolution<ValidConvolution>, MatType, MatType>*,
+    Convolution<CachedFFTConvolution<ValidConvolution>,
+                CachedFFTConvolution<FullConvolution>,
+                CachedFFTConvolution<ValidConvolution>, MatType, MatType>*,
+    DropConnect<MatType, MatType>*,
+    Dropout<MatType, MatType>*,
+    ELU<MatType, MatType>*,
+    FastLSTM<MatType, MatType>*,
+    Glimpse<MatType, MatType>*,
+    HardTanH<MatType, MatType>*,
+    Join<MatType, MatType>*,
+    LeakyReLU<MatType, MatType>*,
+    Linear<MatType, MatType>*,
+    LinearNoBias<MatType, MatType>*,
+    LogSoftMax<MatType, MatType>*,
+    Lookup<MatType, MatType>*,
+    LSTM<MatType, MatType>*,
+    MaxPooling<MatType, MatType>*,
+    MeanPooling<MatType, MatType>*,
+    MeanSquaredError<MatType, MatType>*,
+    MultiplyConstant<MatType, MatType>*,
+    NegativeLogLikelihood<MatType, MatType>*,
+    PReLU<MatType, MatType>*,
+    Recurrent<MatType, MatType>*,
+    RecurrentAttention<MatType, MatType>*,
+    ReinforceNormal<MatType, MatType>*,
+    Select<MatType, MatType>*,
+    Sequential<MatType, MatType>*,
+    SparseLinear<MatType, MatType>*,
+    VRClassReward<MatType, MatType>*
 >;
 
 } // namespace ann
@@ -37,7 +37,7 @@ LinearNoBias<InputDataType, OutputDataType>::LinearNoBias(
 template <typename InputDataType, typename OutputDataType>
 void LinearNoBias<InputDataType, OutputDataType>::Reset()
 {
-  weight = arma::mat(weights.memptr(), outSize, inSize, false, false);
+  weight = OutputDataType(weights.memptr(), outSize, inSize, false, false);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -63,8 +63,11 @@ void LinearNoBias<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient.submat(0, 0, weight.n_elem - 1, 0) = arma::vectorise(
-      error * input.t());
+  // Write the product directly into the gradient memory, instead of through a
+  // temporary.
+  arma::Mat<eT> weightGradient(gradient.memptr(), weight.n_rows, weight.n_cols,
+      false, true);
+  weightGradient = error * input.t();
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -29,7 +29,7 @@ template<typename InputType, typename OutputType>
 void LogSoftMax<InputDataType, OutputDataType>::Forward(
     const InputType&& input, OutputType&& output)
 {
-  arma::mat maxInput = arma::repmat(arma::max(input), input.n_rows, 1);
+  OutputDataType maxInput = arma::repmat(arma::max(input), input.n_rows, 1);
   output = (maxInput - input);
 
   // Approximation of the hyperbolic tangent. The acuracy however is
@@ -57,7 +57,9 @@ void LogSoftMax<InputDataType, OutputDataType>::Forward(
     return 0.0;
   });
 
-  output = input - (maxInput + std::log(arma::accu(output)));
+  // Normalize each column (point) separately.
+  output = input - (maxInput + arma::repmat(arma::log(arma::sum(output)),
+      input.n_rows, 1));
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -67,7 +69,7 @@ void LogSoftMax<InputDataType, OutputDataType>::Backward(
     arma::Mat<eT>&& gy,
     arma::Mat<eT>&& g)
 {
-  g = gy - arma::exp(input) * arma::accu(gy);
+  g = gy - arma::exp(input) % arma::repmat(arma::sum(gy), input.n_rows, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -80,6 +80,23 @@ class Lookup
                 arma::Mat<eT>&& error,
                 arma::Mat<eT>&& gradient);
 
+  /*
+   * Calculate the gradient with respect to the embeddings used by the input
+   * only, as a list of columns of the weights (the embeddings) and the
+   * gradient of each of them, so that the cost doesn't depend on the number of
+   * embeddings.  The gradient of the other embeddings is zero.
+   *
+   * @param input The input parameter used for calculating the gradient.
+   * @param error The calculated error.
+   * @param indices The sorted indices of the embeddings used by the input.
+   * @param block The gradient of each of those embeddings, one per column.
+   */
+  template<typename eT>
+  void SparseGradient(const arma::Mat<eT>&& input,
+                      arma::Mat<eT>&& error,
+                      arma::uvec& indices,
+                      arma::Mat<eT>& block);
+
   //! Get the parameters.
   OutputDataType const& Parameters() const { return weights; }
   //! Modify the parameters.
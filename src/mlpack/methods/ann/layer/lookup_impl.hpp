@@ -54,8 +54,31 @@ void Lookup<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient = arma::zeros<arma::Mat<eT> >(weights.n_rows, weights.n_cols);
-  gradient.cols(arma::conv_to<arma::uvec>::from(input) - 1) = error;
+  // An embedding may be used more than once, so add up its gradients.
+  const arma::uvec tokens = arma::conv_to<arma::uvec>::from(input) - 1;
+  gradient.zeros(weights.n_rows, weights.n_cols);
+  for (size_t i = 0; i < tokens.n_elem; ++i)
+    gradient.col(tokens[i]) += error.col(i);
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void Lookup<InputDataType, OutputDataType>::SparseGradient(
+    const arma::Mat<eT>&& input,
+    arma::Mat<eT>&& error,
+    arma::uvec& indices,
+    arma::Mat<eT>& block)
+{
+  const arma::uvec tokens = arma::conv_to<arma::uvec>::from(input) - 1;
+  indices = arma::unique(tokens);
+
+  block.zeros(weights.n_rows, indices.n_elem);
+  for (size_t i = 0; i < tokens.n_elem; ++i)
+  {
+    const size_t column = std::lower_bound(indices.begin(), indices.end(),
+        tokens[i]) - indices.begin();
+    block.col(column) += error.col(i);
+  }
 }
 
 template<typename InputDataType, typename OutputDataType>
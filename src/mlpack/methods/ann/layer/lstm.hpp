@@ -34,9 +34,9 @@ namespace ann /** Artificial Neural Network. */ {
  * for the gates and cells and also of the type of the function used to
  * initialize and update the peephole weights.
  *
- * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ * @tparam InputDataType Type of the input data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
- * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ * @tparam OutputDataType Type of the output data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
  */
 template <
@@ -130,7 +130,7 @@ class LSTM
   OutputDataType& Gradient() { return gradient; }
 
   //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
+  std::vector<LayerTypes<OutputDataType>>& Model() { return network; }
 
   /**
    * Serialize the layer
@@ -152,43 +152,43 @@ class LSTM
   OutputDataType weights;
 
   //! Locally-stored previous output.
-  arma::mat prevOutput;
+  OutputDataType prevOutput;
 
   //! Locally-stored previous cell state.
-  arma::mat prevCell;
+  OutputDataType prevCell;
 
   //! Locally-stored input 2 gate module.
-  LayerTypes input2GateModule;
+  LayerTypes<OutputDataType> input2GateModule;
 
   //! Locally-stored output 2 gate module.
-  LayerTypes output2GateModule;
+  LayerTypes<OutputDataType> output2GateModule;
 
   //! Locally-stored input gate module.
-  LayerTypes inputGateModule;
+  LayerTypes<OutputDataType> inputGateModule;
 
   //! Locally-stored hidden state module.
-  LayerTypes hiddenStateModule;
+  LayerTypes<OutputDataType> hiddenStateModule;
 
   //! Locally-stored forget gate module.
-  LayerTypes forgetGateModule;
+  LayerTypes<OutputDataType> forgetGateModule;
 
   //! Locally-stored output gate module.
-  LayerTypes outputGateModule;
+  LayerTypes<OutputDataType> outputGateModule;
 
   //! Locally-stored cell module.
-  LayerTypes cellModule;
+  LayerTypes<OutputDataType> cellModule;
 
   //! Locally-stored cell activation module.
-  LayerTypes cellActivationModule;
+  LayerTypes<OutputDataType> cellActivationModule;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<OutputDataType> outputParameterVisitor;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<OutputDataType> deltaVisitor;
 
   //! Locally-stored list of network modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 
   //! Locally-stored number of forward steps.
   size_t forwardStep;
@@ -200,19 +200,19 @@ class LSTM
   size_t gradientStep;
 
   //! Locally-stored cell parameters.
-  std::vector<arma::mat> cellParameter;
+  std::vector<OutputDataType> cellParameter;
 
   //! Locally-stored output parameters.
-  std::vector<arma::mat> outParameter;
+  std::vector<OutputDataType> outParameter;
 
   //! Locally-stored previous error.
-  arma::mat prevError;
+  OutputDataType prevError;
 
   //! Locally-stored cell activation error.
-  arma::mat cellActivationError;
+  OutputDataType cellActivationError;
 
   //! Locally-stored foget gate error.
-  arma::mat forgetGateError;
+  OutputDataType forgetGateError;
 
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
@@ -42,32 +42,40 @@ LSTM<InputDataType, OutputDataType>::LSTM(
     gradientStep(0),
     deterministic(false)
 {
-  input2GateModule = new Linear<>(inSize, 4 * outSize);
-  output2GateModule = new LinearNoBias<>(outSize, 4 * outSize);
+  input2GateModule = new Linear<OutputDataType, OutputDataType>(inSize,
+      4 * outSize);
+  output2GateModule = new LinearNoBias<OutputDataType, OutputDataType>(outSize,
+      4 * outSize);
 
   network.push_back(input2GateModule);
   network.push_back(output2GateModule);
 
-  inputGateModule = new SigmoidLayer<>();
-  hiddenStateModule = new TanHLayer<>();
-  forgetGateModule = new SigmoidLayer<>();
-  outputGateModule = new SigmoidLayer<>();
+  inputGateModule = new SigmoidLayer<LogisticFunction, OutputDataType,
+      OutputDataType>();
+  hiddenStateModule = new TanHLayer<TanhFunction, OutputDataType,
+      OutputDataType>();
+  forgetGateModule = new SigmoidLayer<LogisticFunction, OutputDataType,
+      OutputDataType>();
+  outputGateModule = new SigmoidLayer<LogisticFunction, OutputDataType,
+      OutputDataType>();
 
   network.push_back(inputGateModule);
   network.push_back(hiddenStateModule);
   network.push_back(forgetGateModule);
   network.push_back(outputGateModule);
 
-  cellModule = new IdentityLayer<>();
-  cellActivationModule = new TanHLayer<>();
+  cellModule = new IdentityLayer<IdentityFunction, OutputDataType,
+      OutputDataType>();
+  cellActivationModule = new TanHLayer<TanhFunction, OutputDataType,
+      OutputDataType>();
 
   network.push_back(cellModule);
   network.push_back(cellActivationModule);
 
-  prevOutput = arma::zeros<arma::mat>(outSize, 1);
-  prevCell = arma::zeros<arma::mat>(outSize, 1);
-  prevError = arma::zeros<arma::mat>(4 * outSize, 1);
-  cellActivationError = arma::zeros<arma::mat>(outSize, 1);
+  prevOutput = arma::zeros<OutputDataType>(outSize, 1);
+  prevCell = arma::zeros<OutputDataType>(outSize, 1);
+  prevError = arma::zeros<OutputDataType>(4 * outSize, 1);
+  cellActivationError = arma::zeros<OutputDataType>(outSize, 1);
 
   cellParameter.reserve(rho);
   outParameter.reserve(rho);
@@ -84,30 +92,30 @@ void LSTM<InputDataType, OutputDataType>::Forward(
     outParameter.push_back(prevOutput);
   }
 
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-      boost::apply_visitor(outputParameterVisitor, input2GateModule))),
-      input2GateModule);
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+      std::move(boost::apply_visitor(outputParameterVisitor,
+      input2GateModule))), input2GateModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(prevOutput), std::move(
-      boost::apply_visitor(outputParameterVisitor, output2GateModule))),
-      output2GateModule);
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(prevOutput),
+      std::move(boost::apply_visitor(outputParameterVisitor,
+      output2GateModule))), output2GateModule);
 
   output = boost::apply_visitor(outputParameterVisitor, input2GateModule) +
       boost::apply_visitor(outputParameterVisitor, output2GateModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(output.submat(
       0, 0, 1 * outSize - 1, 0)), std::move(boost::apply_visitor(
       outputParameterVisitor, inputGateModule))), inputGateModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(output.submat(
       1 * outSize, 0, 2 * outSize - 1, 0)), std::move(boost::apply_visitor(
       outputParameterVisitor, hiddenStateModule))), hiddenStateModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(output.submat(
       2 * outSize, 0, 3 * outSize - 1, 0)), std::move(boost::apply_visitor(
       outputParameterVisitor, forgetGateModule))), forgetGateModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(output.submat(
       3 * outSize, 0, 4 * outSize - 1, 0)), std::move(boost::apply_visitor(
       outputParameterVisitor, outputGateModule))), outputGateModule);
 
@@ -119,12 +127,14 @@ void LSTM<InputDataType, OutputDataType>::Forward(
       hiddenStateModule)) + (boost::apply_visitor(outputParameterVisitor,
       forgetGateModule) % prevCell);
 
-  boost::apply_visitor(ForwardVisitor(std::move(prevCell), std::move(
-      boost::apply_visitor(outputParameterVisitor, cellModule))), cellModule);
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(prevCell),
+      std::move(boost::apply_visitor(outputParameterVisitor, cellModule))),
+      cellModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, cellModule)), std::move(boost::apply_visitor(
-      outputParameterVisitor, cellActivationModule))), cellActivationModule);
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, cellModule)), std::move(
+      boost::apply_visitor(outputParameterVisitor, cellActivationModule))),
+      cellActivationModule);
 
   output = boost::apply_visitor(outputParameterVisitor,
       cellActivationModule) % boost::apply_visitor(outputParameterVisitor,
@@ -151,16 +161,16 @@ void LSTM<InputDataType, OutputDataType>::Backward(
     gy += boost::apply_visitor(deltaVisitor, output2GateModule);
   }
 
-  arma::mat g1 = boost::apply_visitor(outputParameterVisitor,
+  arma::Mat<eT> g1 = boost::apply_visitor(outputParameterVisitor,
       cellActivationModule) % gy;
 
-  arma::mat g2 = boost::apply_visitor(outputParameterVisitor,
+  arma::Mat<eT> g2 = boost::apply_visitor(outputParameterVisitor,
       outputGateModule) % gy;
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, cellActivationModule)), std::move(g2),
-      std::move(boost::apply_visitor(deltaVisitor, cellActivationModule))),
-      cellActivationModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, cellActivationModule)),
+      std::move(g2), std::move(boost::apply_visitor(deltaVisitor,
+      cellActivationModule))), cellActivationModule);
 
   cellActivationError = boost::apply_visitor(deltaVisitor,
       cellActivationModule);
@@ -170,37 +180,37 @@ void LSTM<InputDataType, OutputDataType>::Backward(
     cellActivationError += forgetGateError;
   }
 
-  arma::mat g4 = boost::apply_visitor(outputParameterVisitor,
+  arma::Mat<eT> g4 = boost::apply_visitor(outputParameterVisitor,
       inputGateModule) % cellActivationError;
 
-  arma::mat g5 = boost::apply_visitor(outputParameterVisitor,
+  arma::Mat<eT> g5 = boost::apply_visitor(outputParameterVisitor,
       hiddenStateModule) % cellActivationError;
 
   forgetGateError = boost::apply_visitor(outputParameterVisitor,
       forgetGateModule) % cellActivationError;
 
-  arma::mat g7 = cellParameter[cellParameter.size() -
+  arma::Mat<eT> g7 = cellParameter[cellParameter.size() -
       backwardStep - 1] % cellActivationError;
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, inputGateModule)), std::move(g5),
-      std::move(boost::apply_visitor(deltaVisitor, inputGateModule))),
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, inputGateModule)), std::move(
+      g5), std::move(boost::apply_visitor(deltaVisitor, inputGateModule))),
       inputGateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, hiddenStateModule)), std::move(g4),
-      std::move(boost::apply_visitor(deltaVisitor, hiddenStateModule))),
-      hiddenStateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, hiddenStateModule)),
+      std::move(g4), std::move(boost::apply_visitor(deltaVisitor,
+      hiddenStateModule))), hiddenStateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, forgetGateModule)), std::move(g7),
-      std::move(boost::apply_visitor(deltaVisitor, forgetGateModule))),
-      forgetGateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, forgetGateModule)),
+      std::move(g7), std::move(boost::apply_visitor(deltaVisitor,
+      forgetGateModule))), forgetGateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, outputGateModule)), std::move(g1),
-      std::move(boost::apply_visitor(deltaVisitor, outputGateModule))),
-      outputGateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, outputGateModule)),
+      std::move(g1), std::move(boost::apply_visitor(deltaVisitor,
+      outputGateModule))), outputGateModule);
 
   prevError.submat(0, 0, 1 * outSize - 1, 0) = boost::apply_visitor(
       deltaVisitor, inputGateModule);
@@ -211,15 +221,15 @@ void LSTM<InputDataType, OutputDataType>::Backward(
   prevError.submat(3 * outSize, 0, 4 * outSize - 1, 0) = boost::apply_visitor(
       deltaVisitor, outputGateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, input2GateModule)), std::move(prevError),
-      std::move(boost::apply_visitor(deltaVisitor, input2GateModule))),
-      input2GateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, input2GateModule)),
+      std::move(prevError), std::move(boost::apply_visitor(deltaVisitor,
+      input2GateModule))), input2GateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, output2GateModule)), std::move(prevError),
-      std::move(boost::apply_visitor(deltaVisitor, output2GateModule))),
-      output2GateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, output2GateModule)),
+      std::move(prevError), std::move(boost::apply_visitor(deltaVisitor,
+      output2GateModule))), output2GateModule);
 
   backwardStep++;
   if (backwardStep == rho)
@@ -238,10 +248,10 @@ void LSTM<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& /* error */,
     arma::Mat<eT>&& /* gradient */)
 {
-  boost::apply_visitor(GradientVisitor(std::move(input), std::move(prevError)),
-      input2GateModule);
+  boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+      std::move(prevError)), input2GateModule);
 
-  boost::apply_visitor(GradientVisitor(
+  boost::apply_visitor(GradientVisitor<OutputDataType>(
       std::move(outParameter[outParameter.size() - gradientStep - 1]),
       std::move(prevError)), output2GateModule);
 
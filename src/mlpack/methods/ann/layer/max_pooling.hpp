@@ -141,58 +141,78 @@ class MaxPooling
   void Serialize(Archive& ar, const unsigned int /* version */);
 
  private:
- /**
-   * Apply pooling to the input and store the results.
+  /**
+   * Apply pooling to all the slices of the input and store the results, and,
+   * unless indices is NULL, the index in the input of each maximum (the first
+   * one, in column-major order, if there are ties).  Windows are cut off at
+   * the edges of the input.  If WindowRows and WindowCols are not 0,
+   * they give the size of the window at compile time, so that the loops over
+   * the window are unrolled; the window then must fit within the input.
    *
    * @param input The input to be apply the pooling rule.
    * @param output The pooled result.
-   * @param poolingIndices The pooled indices.
+   * @param indices Array to store the pooled indices in, or NULL.
+   * @param windowRows Number of rows of the pooling window.
+   * @param windowCols Number of columns of the pooling window.
    */
-  template<typename eT>
-  void PoolingOperation(const arma::Mat<eT>& input,
-                        arma::Mat<eT>& output,
-                        arma::Mat<eT>& poolingIndices)
+  template<size_t WindowRows, size_t WindowCols, typename eT>
+  void PoolingOperation(const arma::Cube<eT>& input,
+                        arma::Cube<eT>& output,
+                        size_t* indices,
+                        const size_t windowRows,
+                        const size_t windowCols)
   {
-    for (size_t j = 0, colidx = 0; j < output.n_cols; ++j, colidx += dW)
+    const size_t sliceElems = input.n_rows * input.n_cols;
+
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+#ifdef _WIN32
+    #pragma omp parallel for
+    for (intmax_t s = 0; s < (intmax_t) input.n_slices; ++s)
+#else
+    #pragma omp parallel for
+    for (size_t s = 0; s < input.n_slices; ++s)
+#endif
     {
-      for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dH)
-      {
-        arma::mat subInput = input(arma::span(rowidx, rowidx + kW - 1 - offset),
-            arma::span(colidx, colidx + kH - 1 - offset));
-
-        const size_t idx = pooling.Pooling(subInput);
-        output(i, j) = subInput(idx);
+      const eT* inputPtr = input.slice_memptr(s);
+      eT* outputPtr = output.slice_memptr(s);
+      size_t* indicesPtr = (indices == NULL) ? NULL :
+          indices + s * output.n_rows * output.n_cols;
 
-        if (!deterministic)
+      for (size_t j = 0, colidx = 0; j < output.n_cols; ++j, colidx += dH)
+      {
+        const size_t colBegin = std::min(colidx, input.n_cols - 1);
+        const size_t cols = WindowCols ? WindowCols : std::max((size_t) 1,
+            std::min(windowCols, input.n_cols - colBegin));
+        for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dW)
         {
-          arma::Mat<size_t> subIndices = indices(arma::span(rowidx,
-              rowidx + kW - 1 - offset),
-              arma::span(colidx, colidx + kH - 1 - offset));
-
-          poolingIndices(i, j) = subIndices(idx);
+          const size_t rowBegin = std::min(rowidx, input.n_rows - 1);
+          const size_t rows = WindowRows ? WindowRows : std::max((size_t) 1,
+              std::min(windowRows, input.n_rows - rowBegin));
+
+          size_t maxIndex = rowBegin + colBegin * input.n_rows;
+          eT maxValue = inputPtr[maxIndex];
+          for (size_t c = 0; c < cols; ++c)
+          {
+            const size_t colIndex = rowBegin + (colBegin + c) * input.n_rows;
+            for (size_t r = 0; r < rows; ++r)
+            {
+              if (inputPtr[colIndex + r] > maxValue)
+              {
+                maxValue = inputPtr[colIndex + r];
+                maxIndex = colIndex + r;
+              }
+            }
+          }
+
+          *outputPtr++ = maxValue;
+          if (indicesPtr != NULL)
+            *indicesPtr++ = s * sliceElems + maxIndex;
         }
       }
     }
   }
 
-  /**
-   * Apply unpooling to the input and store the results.
-   *
-   * @param error The backward error.
-   * @param output The pooled result.
-   * @param poolingIndices The pooled indices.
-   */
-  template<typename eT>
-  void Unpooling(const arma::Mat<eT>& error,
-                 arma::Mat<eT>& output,
-                 arma::Mat<eT>& poolingIndices)
-  {
-    for (size_t i = 0; i < poolingIndices.n_elem; ++i)
-    {
-      output(poolingIndices(i)) += error(i);
-    }
-  }
-
   //! Locally-stored number of input units.
   size_t inSize;
 
@@ -211,9 +231,6 @@ class MaxPooling
   //! Locally-stored height of the stride operation.
   size_t dH;
 
-  //! Locally-stored reset parameter used to initialize the module once.
-  bool reset;
-
   //! Rounding operation used.
   bool floor;
 
@@ -236,16 +253,13 @@ class MaxPooling
   bool deterministic;
 
   //! Locally-stored output parameter.
-  arma::cube outputTemp;
+  arma::Cube<typename OutputDataType::elem_type> outputTemp;
 
   //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
+  arma::Cube<typename OutputDataType::elem_type> inputTemp;
 
   //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
-
-  //! Locally-stored pooling strategy.
-  MaxPoolingRule pooling;
+  arma::Cube<typename OutputDataType::elem_type> gTemp;
 
   //! Locally-stored delta object.
   OutputDataType delta;
@@ -259,14 +273,9 @@ class MaxPooling
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
 
-  //! Locally-stored indices matrix parameter.
-  arma::Mat<size_t> indices;
-
-  //! Locally-stored indices column parameter.
-  arma::Col<size_t> indicesCol;
-
-  //! Locally-stored pooling indicies.
-  std::vector<arma::cube> poolingIndices;
+  //! Locally-stored indices in the input of the maxima found by each forward
+  //! pass that has not been propagated backward yet.
+  std::vector<arma::Col<size_t> > poolingIndices;
 }; // class MaxPooling
 
 } // namespace ann
@@ -36,7 +36,6 @@ MaxPooling<InputDataType, OutputDataType>::MaxPooling(
     kH(kH),
     dW(dW),
     dH(dH),
-    reset(false),
     floor(floor),
     offset(0),
     inputWidth(0),
@@ -54,7 +53,7 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
   const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
   const size_t slices = input.n_elem / (inputWidth * inputHeight);
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, slices);
+  inputTemp = arma::Cube<eT>(input.memptr(), inputWidth, inputHeight, slices);
 
   if (floor)
   {
@@ -69,38 +68,28 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
     offset = 1;
   }
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(outputWidth, outputHeight,
-      slices);
+  outputTemp.set_size(outputWidth, outputHeight, slices);
 
+  size_t* indicesPtr = NULL;
   if (!deterministic)
   {
-    poolingIndices.push_back(outputTemp);
+    poolingIndices.push_back(arma::Col<size_t>(outputTemp.n_elem));
+    indicesPtr = poolingIndices.back().memptr();
   }
 
-  if (!reset)
-  {
-    size_t elements = inputWidth * inputHeight;
-    indicesCol = arma::linspace<arma::Col<size_t> >(0, (elements - 1),
-        elements);
-
-    indices = arma::Mat<size_t>(indicesCol.memptr(), inputWidth, inputHeight);
-
-    reset = true;
-  }
-
-  for (size_t s = 0; s < inputTemp.n_slices; s++)
-  {
-    if (!deterministic)
-    {
-      PoolingOperation(inputTemp.slice(s), outputTemp.slice(s),
-        poolingIndices.back().slice(s));
-    }
-    else
-    {
-      PoolingOperation(inputTemp.slice(s), outputTemp.slice(s),
-          inputTemp.slice(s));
-    }
-  }
+  // All the slices (the maps of all the points of the batch) are pooled in one
+  // call.  Windows of the most common sizes are unrolled at compile time; this
+  // needs the windows to fit within the input, which they do when rounding
+  // down.
+  const size_t windowRows = kW - offset;
+  const size_t windowCols = kH - offset;
+  if (floor && windowRows == 2 && windowCols == 2)
+    PoolingOperation<2, 2>(inputTemp, outputTemp, indicesPtr, 2, 2);
+  else if (floor && windowRows == 3 && windowCols == 3)
+    PoolingOperation<3, 3>(inputTemp, outputTemp, indicesPtr, 3, 3);
+  else
+    PoolingOperation<0, 0>(inputTemp, outputTemp, indicesPtr, windowRows,
+        windowCols);
 
   output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
 
@@ -114,21 +103,33 @@ template<typename eT>
 void MaxPooling<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(), outputWidth,
-      outputHeight, outSize);
-
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
+  gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
 
-  for (size_t s = 0; s < mappedError.n_slices; s++)
+  // Route the error of each output to the maximum found by Forward().  The
+  // indices of a slice all lie within that slice, so the slices are
+  // independent.
+  const arma::Col<size_t>& indices = poolingIndices.back();
+  const size_t sliceOutputs = outputWidth * outputHeight;
+  eT* gTempPtr = gTemp.memptr();
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for
+  for (intmax_t s = 0; s < (intmax_t) outSize; ++s)
+#else
+  #pragma omp parallel for
+  for (size_t s = 0; s < outSize; ++s)
+#endif
   {
-    Unpooling(mappedError.slice(s), gTemp.slice(s),
-        poolingIndices.back().slice(s));
+    for (size_t i = s * sliceOutputs; i < (s + 1) * sliceOutputs; ++i)
+      gTempPtr[indices[i]] += gy[i];
   }
 
   poolingIndices.pop_back();
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
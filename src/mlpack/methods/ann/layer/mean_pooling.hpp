@@ -122,59 +122,93 @@ class MeanPooling
 
  private:
   /**
-   * Apply pooling to the input and store the results.
+   * Apply pooling to all the slices of the input and store the results, or,
+   * if Backward is true, distribute the error of each output evenly over its
+   * window and add it to the input error.  Windows are cut off at the edges of
+   * the input.  If WindowRows and WindowCols are not 0, they give the size of
+   * the window at compile time, so that the loops over the window are
+   * unrolled; the window then must fit within the input.
    *
-   * @param input The input to be apply the pooling rule.
-   * @param output The pooled result.
+   * @param input The input to be apply the pooling rule (or the input error
+   *     to add to, if Backward is true).
+   * @param output The pooled result (or the backward error).
+   * @param windowRows Number of rows of the pooling window.
+   * @param windowCols Number of columns of the pooling window.
    */
-  template<typename eT>
-  void Pooling(const arma::Mat<eT>& input, arma::Mat<eT>& output)
+  template<bool Backward, size_t WindowRows, size_t WindowCols, typename eT>
+  void PoolingOperation(arma::Cube<eT>& input,
+                        arma::Cube<eT>& output,
+                        const size_t windowRows,
+                        const size_t windowCols)
   {
-    const size_t rStep = kW;
-    const size_t cStep = kH;
-
-    for (size_t j = 0, colidx = 0; j < output.n_cols; ++j, colidx += dH)
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+#ifdef _WIN32
+    #pragma omp parallel for
+    for (intmax_t s = 0; s < (intmax_t) input.n_slices; ++s)
+#else
+    #pragma omp parallel for
+    for (size_t s = 0; s < input.n_slices; ++s)
+#endif
     {
-      for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dW)
-      {
-        arma::mat subInput = input(
-            arma::span(rowidx, rowidx + rStep - 1 - offset),
-            arma::span(colidx, colidx + cStep - 1 - offset));
+      eT* inputPtr = input.slice_memptr(s);
+      eT* outputPtr = output.slice_memptr(s);
 
-        output(i, j) = arma::mean(arma::mean(subInput));
+      for (size_t j = 0, colidx = 0; j < output.n_cols; ++j, colidx += dH)
+      {
+        const size_t colBegin = std::min(colidx, input.n_cols - 1);
+        const size_t cols = WindowCols ? WindowCols : std::max((size_t) 1,
+            std::min(windowCols, input.n_cols - colBegin));
+        for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dW)
+        {
+          const size_t rowBegin = std::min(rowidx, input.n_rows - 1);
+          const size_t rows = WindowRows ? WindowRows : std::max((size_t) 1,
+              std::min(windowRows, input.n_rows - rowBegin));
+
+          if (Backward)
+          {
+            const eT error = *outputPtr++ / (rows * cols);
+            for (size_t c = 0; c < cols; ++c)
+            {
+              eT* colPtr = inputPtr + rowBegin + (colBegin + c) * input.n_rows;
+              for (size_t r = 0; r < rows; ++r)
+                colPtr[r] += error;
+            }
+          }
+          else
+          {
+            eT sum = 0;
+            for (size_t c = 0; c < cols; ++c)
+            {
+              const eT* colPtr = inputPtr + rowBegin + (colBegin + c) *
+                  input.n_rows;
+              for (size_t r = 0; r < rows; ++r)
+                sum += colPtr[r];
+            }
+
+            *outputPtr++ = sum / (rows * cols);
+          }
+        }
       }
     }
   }
 
   /**
-   * Apply unpooling to the input and store the results.
-   *
-   * @param input The input to be apply the unpooling rule.
-   * @param output The pooled result.
+   * Call PoolingOperation() with the size of the window known at compile time
+   * for the most common window sizes.
    */
-  template<typename eT>
-  void Unpooling(const arma::Mat<eT>& input,
-                 const arma::Mat<eT>& error,
-                 arma::Mat<eT>& output)
+  template<bool Backward, typename eT>
+  void Pool(arma::Cube<eT>& input, arma::Cube<eT>& output)
   {
-    const size_t rStep = input.n_rows / error.n_rows - offset;
-    const size_t cStep = input.n_cols / error.n_cols - offset;
-
-    arma::Mat<eT> unpooledError;
-    for (size_t j = 0; j < input.n_cols - cStep; j += cStep)
-    {
-      for (size_t i = 0; i < input.n_rows - rStep; i += rStep)
-      {
-        const arma::Mat<eT>& inputArea = input(arma::span(i, i + rStep - 1),
-            arma::span(j, j + cStep - 1));
-
-        unpooledError = arma::Mat<eT>(inputArea.n_rows, inputArea.n_cols);
-        unpooledError.fill(error(i / rStep, j / cStep) / inputArea.n_elem);
-
-        output(arma::span(i, i + rStep - 1 - offset),
-            arma::span(j, j + cStep - 1 - offset)) += unpooledError;
-      }
-    }
+    // The windows only fit within the input when rounding down.
+    const size_t windowRows = kW - offset;
+    const size_t windowCols = kH - offset;
+    if (floor && windowRows == 2 && windowCols == 2)
+      PoolingOperation<Backward, 2, 2>(input, output, 2, 2);
+    else if (floor && windowRows == 3 && windowCols == 3)
+      PoolingOperation<Backward, 3, 3>(input, output, 3, 3);
+    else
+      PoolingOperation<Backward, 0, 0>(input, output, windowRows, windowCols);
   }
 
   //! Locally-stored number of input units.
@@ -220,13 +254,13 @@ class MeanPooling
   size_t offset;
 
   //! Locally-stored output parameter.
-  arma::cube outputTemp;
+  arma::Cube<typename OutputDataType::elem_type> outputTemp;
 
   //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
+  arma::Cube<typename OutputDataType::elem_type> inputTemp;
 
   //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
+  arma::Cube<typename OutputDataType::elem_type> gTemp;
 
   //! Locally-stored delta object.
   OutputDataType delta;
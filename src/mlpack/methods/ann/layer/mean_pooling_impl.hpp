@@ -54,7 +54,7 @@ void MeanPooling<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
   size_t slices = input.n_elem / (inputWidth * inputHeight);
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, slices);
+  inputTemp = arma::Cube<eT>(input.memptr(), inputWidth, inputHeight, slices);
 
   if (floor)
   {
@@ -71,11 +71,10 @@ void MeanPooling<InputDataType, OutputDataType>::Forward(
     offset = 1;
   }
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(outputWidth, outputHeight,
-      slices);
-
-  for (size_t s = 0; s < inputTemp.n_slices; s++)
-    Pooling(inputTemp.slice(s), outputTemp.slice(s));
+  // All the slices (the maps of all the points of the batch) are pooled in one
+  // call.
+  outputTemp.set_size(outputWidth, outputHeight, slices);
+  Pool<false>(inputTemp, outputTemp);
 
   output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
 
@@ -91,18 +90,14 @@ void MeanPooling<InputDataType, OutputDataType>::Backward(
   arma::Mat<eT>&& gy,
   arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(), outputWidth,
-      outputHeight, outSize);
+  arma::Cube<eT> mappedError(gy.memptr(), outputWidth, outputHeight, outSize,
+      false, true);
 
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
+  gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
+  Pool<true>(gTemp, mappedError);
 
-  for (size_t s = 0; s < mappedError.n_slices; s++)
-  {
-    Unpooling(inputTemp.slice(s), mappedError.slice(s), gTemp.slice(s));
-  }
-
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
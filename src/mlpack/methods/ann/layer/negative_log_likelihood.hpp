@@ -97,6 +97,23 @@ class NegativeLogLikelihood
   OutputDataType outputParameter;
 }; // class NegativeLogLikelihood
 
+/**
+ * Whether the given output layer is NegativeLogLikelihood, in which case FFN
+ * fuses it with a final LogSoftMax module (see SoftMaxCrossEntropy).
+ */
+template<typename OutputLayerType>
+struct IsNegativeLogLikelihood
+{
+  static const bool value = false;
+};
+
+template<typename InputDataType, typename OutputDataType>
+struct IsNegativeLogLikelihood<
+    NegativeLogLikelihood<InputDataType, OutputDataType> >
+{
+  static const bool value = true;
+};
+
 } // namespace ann
 } // namespace mlpack
 
@@ -61,11 +61,11 @@ void PReLU<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& gradient)
 {
   if (gradient.n_elem == 0) {
-    gradient = arma::zeros<arma::mat>(1, 1);
+    gradient.zeros(1, 1);
   }
 
-  arma::mat zeros = arma::zeros<arma::mat>(input.n_rows, input.n_cols);
-  gradient(0) = arma::accu(error % arma::min(zeros, input)) / input.n_cols;
+  gradient(0) = arma::accu(error % arma::clamp(input,
+      std::numeric_limits<eT>::lowest(), 0)) / input.n_cols;
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -0,0 +1,207 @@
+/**
+ * @file quantized_layer.hpp
+ *
+ * Definition of the QuantizedLayer class, which runs a Linear, LinearNoBias or
+ * Convolution module with int8 weights for inference.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_QUANTIZED_LAYER_HPP
+#define MLPACK_METHODS_ANN_LAYER_QUANTIZED_LAYER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A QuantizedLayer holds the weights of a trained Linear, LinearNoBias or
+ * Convolution module as int8 values, with one scale per output unit (or output
+ * map), and computes the output of the module with integer arithmetic.  The
+ * input of each point (or, for a convolution, of each output position) is
+ * quantized to int8 on the fly with its own scale, the products are
+ * accumulated in 32-bit integers, and the result is scaled back and the
+ * (unquantized) bias is added.  Both quantizations are symmetric, so the error
+ * of each output is about 1% of the magnitude of its terms.
+ *
+ * The layer is meant to be used through QuantizedFFN, which builds it with
+ * QuantizeVisitor.  The weights take a byte each, so a serialized layer is
+ * about an eighth of the size of the double precision module.
+ */
+class QuantizedLayer
+{
+ public:
+  /**
+   * Create an empty QuantizedLayer, which stands for a module that is not
+   * quantized.
+   */
+  QuantizedLayer();
+
+  /**
+   * Quantize the weights of a Linear (or LinearNoBias) module.
+   *
+   * @param weight The weight matrix, one row per output unit.
+   * @param bias The bias, one entry per output unit; it may be empty.
+   */
+  template<typename eT>
+  QuantizedLayer(const arma::Mat<eT>& weight, const arma::Mat<eT>& bias);
+
+  /**
+   * Quantize the filters of a Convolution module.
+   *
+   * @param weight The filters, one column per output map, lowered as
+   *     Im2ColConvolution::Im2Col() lowers the input maps.
+   * @param bias The bias, one entry per output map.
+   * @param inputWidth The width of the input maps.
+   * @param inputHeight The height of the input maps.
+   * @param kW The width of the filters.
+   * @param kH The height of the filters.
+   * @param dW The stride of the filters in x-direction.
+   * @param dH The stride of the filters in y-direction.
+   * @param padW The padding width of the input maps.
+   * @param padH The padding height of the input maps.
+   */
+  template<typename eT>
+  QuantizedLayer(const arma::Mat<eT>& weight,
+                 const arma::Mat<eT>& bias,
+                 const size_t inputWidth,
+                 const size_t inputHeight,
+                 const size_t kW,
+                 const size_t kH,
+                 const size_t dW,
+                 const size_t dH,
+                 const size_t padW,
+                 const size_t padH);
+
+  /**
+   * Compute the output of the module for the given input, one column per
+   * point.
+   *
+   * @param input Input data used for evaluating the module.
+   * @param output Resulting output activation.
+   */
+  template<typename eT>
+  void Forward(const arma::Mat<eT>& input, arma::Mat<eT>& output) const;
+
+  //! Return whether the layer holds no module.
+  bool IsEmpty() const { return weights.empty(); }
+
+  //! Return whether the layer is a convolution.
+  bool IsConvolution() const { return convolution; }
+
+  //! Get the number of output units (or output maps).
+  size_t OutputSize() const { return outSize; }
+
+  //! Get the width of the output maps (0 if the layer is not a convolution).
+  size_t OutputWidth() const { return outputWidth; }
+
+  //! Get the height of the output maps (0 if the layer is not a convolution).
+  size_t OutputHeight() const { return outputHeight; }
+
+  //! Get the quantized weights, one block of InputSize() values per output.
+  const std::vector<int8_t>& Weights() const { return weights; }
+
+  //! Get the scale of the weights of each output.
+  const arma::vec& Scales() const { return scales; }
+
+  /**
+   * Quantize the given values symmetrically to int8, and return the scale
+   * that the quantized values have to be multiplied by.
+   *
+   * @param values Values to quantize.
+   * @param n Number of values.
+   * @param quantized Array of (at least) n values to store the result in.
+   */
+  template<typename eT>
+  static double Quantize(const eT* values, const size_t n, int8_t* quantized);
+
+  /**
+   * Compute out(i, j) = aScales[i] * bScales[j] * dot(a_i, b_j) for every pair
+   * of the int8 vectors a_i (i < na) and b_j (j < nb) of length n, which are
+   * stored one after the other.  out is stored by column, with na rows.
+   */
+  template<typename eT>
+  static void Multiply(const int8_t* a,
+                       const double* aScales,
+                       const size_t na,
+                       const int8_t* b,
+                       const double* bScales,
+                       const size_t nb,
+                       const size_t n,
+                       eT* out);
+
+  /**
+   * Serialize the layer.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Quantize the weights, one column per output.
+  template<typename eT>
+  void QuantizeWeights(const arma::Mat<eT>& weight);
+
+  //! Store the bias, if it isn't empty.
+  template<typename eT>
+  void SetBias(const arma::Mat<eT>& bias);
+
+  //! Whether the layer is a convolution.
+  bool convolution;
+
+  //! The number of weights of each output (the length of a lowered input
+  //! column, for a convolution).
+  size_t inSize;
+
+  //! The number of output units (or output maps).
+  size_t outSize;
+
+  //! The quantized weights, inSize values per output.
+  std::vector<int8_t> weights;
+
+  //! The scale of the weights of each output.
+  arma::vec scales;
+
+  //! The bias of each output; empty for LinearNoBias.
+  arma::vec bias;
+
+  //! The input width, for a convolution.
+  size_t inputWidth;
+
+  //! The input height, for a convolution.
+  size_t inputHeight;
+
+  //! The filter width, for a convolution.
+  size_t kW;
+
+  //! The filter height, for a convolution.
+  size_t kH;
+
+  //! The stride in x-direction, for a convolution.
+  size_t dW;
+
+  //! The stride in y-direction, for a convolution.
+  size_t dH;
+
+  //! The padding width, for a convolution.
+  size_t padW;
+
+  //! The padding height, for a convolution.
+  size_t padH;
+
+  //! The output width, for a convolution.
+  size_t outputWidth;
+
+  //! The output height, for a convolution.
+  size_t outputHeight;
+}; // class QuantizedLayer
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantized_layer_impl.hpp"
+
+#endif
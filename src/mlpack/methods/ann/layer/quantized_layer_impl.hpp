@@ -0,0 +1,316 @@
+/**
+ * @file quantized_layer_impl.hpp
+ *
+ * Implementation of the QuantizedLayer class, which runs a Linear, LinearNoBias
+ * or Convolution module with int8 weights for inference.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_QUANTIZED_LAYER_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_QUANTIZED_LAYER_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "quantized_layer.hpp"
+
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline QuantizedLayer::QuantizedLayer() :
+    convolution(false),
+    inSize(0),
+    outSize(0),
+    inputWidth(0),
+    inputHeight(0),
+    kW(0),
+    kH(0),
+    dW(0),
+    dH(0),
+    padW(0),
+    padH(0),
+    outputWidth(0),
+    outputHeight(0)
+{
+  // Nothing to do here.
+}
+
+template<typename eT>
+QuantizedLayer::QuantizedLayer(const arma::Mat<eT>& weight,
+                               const arma::Mat<eT>& bias) :
+    convolution(false),
+    inputWidth(0),
+    inputHeight(0),
+    kW(0),
+    kH(0),
+    dW(0),
+    dH(0),
+    padW(0),
+    padH(0),
+    outputWidth(0),
+    outputHeight(0)
+{
+  // Each output unit is a row of the weights.
+  QuantizeWeights(arma::Mat<eT>(weight.t()));
+  SetBias(bias);
+}
+
+template<typename eT>
+QuantizedLayer::QuantizedLayer(const arma::Mat<eT>& weight,
+                               const arma::Mat<eT>& bias,
+                               const size_t inputWidth,
+                               const size_t inputHeight,
+                               const size_t kW,
+                               const size_t kH,
+                               const size_t dW,
+                               const size_t dH,
+                               const size_t padW,
+                               const size_t padH) :
+    convolution(true),
+    inputWidth(inputWidth),
+    inputHeight(inputHeight),
+    kW(kW),
+    kH(kH),
+    dW(dW),
+    dH(dH),
+    padW(padW),
+    padH(padH)
+{
+  if (inputWidth + 2 * padW < kW || inputHeight + 2 * padH < kH)
+  {
+    throw std::invalid_argument("QuantizedLayer: the input maps are smaller "
+        "than the filters");
+  }
+
+  QuantizeWeights(weight);
+  SetBias(bias);
+  outputWidth = (inputWidth + 2 * padW - kW) / dW + 1;
+  outputHeight = (inputHeight + 2 * padH - kH) / dH + 1;
+}
+
+template<typename eT>
+void QuantizedLayer::QuantizeWeights(const arma::Mat<eT>& weight)
+{
+  inSize = weight.n_rows;
+  outSize = weight.n_cols;
+  weights.resize(weight.n_elem);
+  scales.set_size(outSize);
+  for (size_t i = 0; i < outSize; ++i)
+    scales[i] = Quantize(weight.colptr(i), inSize, &weights[i * inSize]);
+}
+
+template<typename eT>
+void QuantizedLayer::SetBias(const arma::Mat<eT>& bias)
+{
+  if (!bias.is_empty() && bias.n_elem != outSize)
+  {
+    throw std::invalid_argument("QuantizedLayer: the bias doesn't have one "
+        "entry per output");
+  }
+
+  this->bias = arma::conv_to<arma::vec>::from(arma::vectorise(bias));
+}
+
+template<typename eT>
+double QuantizedLayer::Quantize(const eT* values,
+                                const size_t n,
+                                int8_t* quantized)
+{
+  double maxValue = 0;
+  for (size_t i = 0; i < n; ++i)
+    maxValue = std::max(maxValue, (double) std::abs(values[i]));
+
+  // Values are mapped to [-127, 127], so that negating them can't overflow.
+  const double inverseScale = (maxValue > 0) ? 127.0 / maxValue : 0.0;
+  for (size_t i = 0; i < n; ++i)
+    quantized[i] = (int8_t) std::lround(values[i] * inverseScale);
+
+  return maxValue / 127.0;
+}
+
+template<typename eT>
+void QuantizedLayer::Multiply(const int8_t* a,
+                              const double* aScales,
+                              const size_t na,
+                              const int8_t* b,
+                              const double* bScales,
+                              const size_t nb,
+                              const size_t n,
+                              eT* out)
+{
+  // Each iteration computes the products of four of the vectors a_i with all
+  // the vectors b_j, so that each b_j is read once per four products.  The
+  // inner loops are plain integer multiply-adds, which compilers vectorize.
+  const size_t blocks = (na + 3) / 4;
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for
+  for (intmax_t block = 0; block < (intmax_t) blocks; ++block)
+#else
+  #pragma omp parallel for
+  for (size_t block = 0; block < blocks; ++block)
+#endif
+  {
+    const size_t i = 4 * block;
+    if (i + 4 <= na)
+    {
+      const int8_t* a0 = a + i * n;
+      const int8_t* a1 = a0 + n;
+      const int8_t* a2 = a1 + n;
+      const int8_t* a3 = a2 + n;
+      for (size_t j = 0; j < nb; ++j)
+      {
+        const int8_t* bj = b + j * n;
+        int32_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+        for (size_t k = 0; k < n; ++k)
+        {
+          const int32_t value = bj[k];
+          sum0 += int32_t(a0[k]) * value;
+          sum1 += int32_t(a1[k]) * value;
+          sum2 += int32_t(a2[k]) * value;
+          sum3 += int32_t(a3[k]) * value;
+        }
+
+        eT* outPtr = out + j * na + i;
+        outPtr[0] = eT(aScales[i] * bScales[j] * sum0);
+        outPtr[1] = eT(aScales[i + 1] * bScales[j] * sum1);
+        outPtr[2] = eT(aScales[i + 2] * bScales[j] * sum2);
+        outPtr[3] = eT(aScales[i + 3] * bScales[j] * sum3);
+      }
+    }
+    else
+    {
+      for (size_t r = i; r < na; ++r)
+      {
+        const int8_t* ar = a + r * n;
+        for (size_t j = 0; j < nb; ++j)
+        {
+          const int8_t* bj = b + j * n;
+          int32_t sum = 0;
+          for (size_t k = 0; k < n; ++k)
+            sum += int32_t(ar[k]) * int32_t(bj[k]);
+
+          out[j * na + r] = eT(aScales[r] * bScales[j] * sum);
+        }
+      }
+    }
+  }
+}
+
+template<typename eT>
+void QuantizedLayer::Forward(const arma::Mat<eT>& input,
+                             arma::Mat<eT>& output) const
+{
+  if (!convolution)
+  {
+    if (input.n_rows != inSize)
+    {
+      std::ostringstream oss;
+      oss << "QuantizedLayer::Forward(): the input has " << input.n_rows
+          << " rows, but the layer has " << inSize << " inputs";
+      throw std::invalid_argument(oss.str());
+    }
+
+    // Quantize each point with its own scale.
+    std::vector<int8_t> quantizedInput(input.n_elem);
+    arma::vec inputScales(input.n_cols);
+    for (size_t j = 0; j < input.n_cols; ++j)
+    {
+      inputScales[j] = Quantize(input.colptr(j), inSize,
+          &quantizedInput[j * inSize]);
+    }
+
+    output.set_size(outSize, input.n_cols);
+    Multiply(weights.data(), scales.memptr(), outSize, quantizedInput.data(),
+        inputScales.memptr(), input.n_cols, inSize, output.memptr());
+
+    if (!bias.is_empty())
+      output.each_col() += arma::conv_to<arma::Col<eT> >::from(bias);
+
+    return;
+  }
+
+  const size_t inMaps = inSize / (kW * kH);
+  if (input.n_rows != inputWidth * inputHeight * inMaps)
+  {
+    std::ostringstream oss;
+    oss << "QuantizedLayer::Forward(): the input has " << input.n_rows
+        << " rows, but the layer has " << inputWidth * inputHeight * inMaps
+        << " inputs";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t positions = outputWidth * outputHeight;
+  output.set_size(positions * outSize, input.n_cols);
+
+  arma::Cube<eT> paddedInput;
+  if (padW != 0 || padH != 0)
+  {
+    paddedInput.zeros(inputWidth + 2 * padW, inputHeight + 2 * padH, inMaps);
+  }
+
+  arma::Mat<eT> columns;
+  std::vector<int8_t> quantizedColumns(positions * inSize);
+  arma::vec columnScales(positions);
+  for (size_t c = 0; c < input.n_cols; ++c)
+  {
+    const arma::Cube<eT> maps(const_cast<eT*>(input.colptr(c)), inputWidth,
+        inputHeight, inMaps, false, true);
+    if (padW != 0 || padH != 0)
+    {
+      paddedInput.subcube(padW, padH, 0, padW + inputWidth - 1,
+          padH + inputHeight - 1, inMaps - 1) = maps;
+    }
+
+    // Lower the input, and quantize each output position with its own scale.
+    Im2ColConvolution<>::Im2Col((padW != 0 || padH != 0) ? paddedInput : maps,
+        kW, kH, dW, dH, columns);
+    for (size_t p = 0; p < positions; ++p)
+    {
+      columnScales[p] = Quantize(columns.colptr(p), inSize,
+          &quantizedColumns[p * inSize]);
+    }
+
+    // The result holds the output maps one after the other.
+    eT* outputPtr = output.colptr(c);
+    Multiply(quantizedColumns.data(), columnScales.memptr(), positions,
+        weights.data(), scales.memptr(), outSize, inSize, outputPtr);
+
+    for (size_t o = 0; o < outSize; ++o)
+    {
+      for (size_t p = 0; p < positions; ++p)
+        outputPtr[o * positions + p] += eT(bias[o]);
+    }
+  }
+}
+
+template<typename Archive>
+void QuantizedLayer::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(convolution, "convolution");
+  ar & data::CreateNVP(inSize, "inSize");
+  ar & data::CreateNVP(outSize, "outSize");
+  ar & data::CreateNVP(weights, "weights");
+  ar & data::CreateNVP(scales, "scales");
+  ar & data::CreateNVP(bias, "bias");
+  ar & data::CreateNVP(inputWidth, "inputWidth");
+  ar & data::CreateNVP(inputHeight, "inputHeight");
+  ar & data::CreateNVP(kW, "kW");
+  ar & data::CreateNVP(kH, "kH");
+  ar & data::CreateNVP(dW, "dW");
+  ar & data::CreateNVP(dH, "dH");
+  ar & data::CreateNVP(padW, "padW");
+  ar & data::CreateNVP(padH, "padH");
+  ar & data::CreateNVP(outputWidth, "outputWidth");
+  ar & data::CreateNVP(outputHeight, "outputHeight");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
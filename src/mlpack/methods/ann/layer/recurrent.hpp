@@ -31,9 +31,9 @@ namespace ann /** Artificial Neural Network. */ {
  * Implementation of the RecurrentLayer class. Recurrent layers can be used
  * similarly to feed-forward layers.
  *
- * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ * @tparam InputDataType Type of the input data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
- * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ * @tparam OutputDataType Type of the output data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
  */
 template <
@@ -99,7 +99,7 @@ class Recurrent
                 arma::Mat<eT>&& /* gradient */);
 
   //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
+  std::vector<LayerTypes<OutputDataType>>& Model() { return network; }
 
     //! The value of the deterministic parameter.
   bool Deterministic() const { return deterministic; }
@@ -139,16 +139,16 @@ class Recurrent
 
  private:
   //! Locally-stored start module.
-  LayerTypes startModule;
+  LayerTypes<OutputDataType> startModule;
 
   //! Locally-stored input module.
-  LayerTypes inputModule;
+  LayerTypes<OutputDataType> inputModule;
 
   //! Locally-stored feedback module.
-  LayerTypes feedbackModule;
+  LayerTypes<OutputDataType> feedbackModule;
 
   //! Locally-stored transfer module.
-  LayerTypes transferModule;
+  LayerTypes<OutputDataType> transferModule;
 
   //! Number of steps to backpropagate through time (BPTT).
   size_t rho;
@@ -169,28 +169,28 @@ class Recurrent
   OutputDataType parameters;
 
   //! Locally-stored initial module.
-  LayerTypes initialModule;
+  LayerTypes<OutputDataType> initialModule;
 
   //! Locally-stored recurrent module.
-  LayerTypes recurrentModule;
+  LayerTypes<OutputDataType> recurrentModule;
 
   //! Locally-stored model modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 
   //! Locally-stored merge module.
-  LayerTypes mergeModule;
+  LayerTypes<OutputDataType> mergeModule;
 
   //! Locally-stored weight size visitor.
-  WeightSizeVisitor weightSizeVisitor;
+  WeightSizeVisitor<OutputDataType> weightSizeVisitor;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<OutputDataType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<OutputDataType> outputParameterVisitor;
 
   //! Locally-stored feedback output parameters.
-  std::vector<arma::mat> feedbackOutputParameter;
+  std::vector<OutputDataType> feedbackOutputParameter;
 
   //! Locally-stored delta object.
   OutputDataType delta;
@@ -205,7 +205,7 @@ class Recurrent
   OutputDataType outputParameter;
 
   //! Locally-stored recurrent error parameter.
-  arma::mat recurrentError;
+  OutputDataType recurrentError;
 }; // class Recurrent
 
 } // namespace ann
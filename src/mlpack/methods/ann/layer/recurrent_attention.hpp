@@ -43,9 +43,9 @@ namespace ann /** Artificial Neural Network. */ {
  * }
  * @endcode
  *
- * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ * @tparam InputDataType Type of the input data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
- * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ * @tparam OutputDataType Type of the output data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
  */
 template <
@@ -106,7 +106,7 @@ class RecurrentAttention
                 arma::Mat<eT>&& /* gradient */);
 
   //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
+  std::vector<LayerTypes<OutputDataType>>& Model() { return network; }
 
     //! The value of the deterministic parameter.
   bool Deterministic() const { return deterministic; }
@@ -153,20 +153,20 @@ class RecurrentAttention
     // Gradient of the action module.
     if (backwardStep == (rho - 1))
     {
-      boost::apply_visitor(GradientVisitor(std::move(initialInput),
-          std::move(actionError)), actionModule);
+      boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(
+          initialInput), std::move(actionError)), actionModule);
     }
     else
     {
-      boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
-          outputParameterVisitor, actionModule)), std::move(actionError)),
-          actionModule);
+      boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(
+          boost::apply_visitor(outputParameterVisitor, actionModule)),
+          std::move(actionError)), actionModule);
     }
 
     // Gradient of the recurrent module.
-    boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, rnnModule)), std::move(recurrentError)),
-        rnnModule);
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, rnnModule)), std::move(
+        recurrentError)), rnnModule);
 
     attentionGradient += intermediateGradient;
   }
@@ -175,10 +175,10 @@ class RecurrentAttention
   size_t outSize;
 
   //! Locally-stored start module.
-  LayerTypes rnnModule;
+  LayerTypes<OutputDataType> rnnModule;
 
   //! Locally-stored input module.
-  LayerTypes actionModule;
+  LayerTypes<OutputDataType> actionModule;
 
   //! Number of steps to backpropagate through time (BPTT).
   size_t rho;
@@ -196,31 +196,31 @@ class RecurrentAttention
   OutputDataType parameters;
 
   //! Locally-stored initial module.
-  LayerTypes initialModule;
+  LayerTypes<OutputDataType> initialModule;
 
   //! Locally-stored recurrent module.
-  LayerTypes recurrentModule;
+  LayerTypes<OutputDataType> recurrentModule;
 
   //! Locally-stored model modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 
   //! Locally-stored merge module.
-  LayerTypes mergeModule;
+  LayerTypes<OutputDataType> mergeModule;
 
   //! Locally-stored weight size visitor.
-  WeightSizeVisitor weightSizeVisitor;
+  WeightSizeVisitor<OutputDataType> weightSizeVisitor;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<OutputDataType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<OutputDataType> outputParameterVisitor;
 
   //! Locally-stored feedback output parameters.
-  std::vector<arma::mat> feedbackOutputParameter;
+  std::vector<OutputDataType> feedbackOutputParameter;
 
   //! List of all module parameters for the backward pass (BBTT).
-  std::vector<arma::mat> moduleOutputParameter;
+  std::vector<OutputDataType> moduleOutputParameter;
 
   //! Locally-stored delta object.
   OutputDataType delta;
@@ -235,28 +235,28 @@ class RecurrentAttention
   OutputDataType outputParameter;
 
   //! Locally-stored recurrent error parameter.
-  arma::mat recurrentError;
+  OutputDataType recurrentError;
 
   //! Locally-stored action error parameter.
-  arma::mat actionError;
+  OutputDataType actionError;
 
   //! Locally-stored action delta.
-  arma::mat actionDelta;
+  OutputDataType actionDelta;
 
   //! Locally-stored recurrent delta.
-  arma::mat rnnDelta;
+  OutputDataType rnnDelta;
 
   //! Locally-stored initial action input.
-  arma::mat initialInput;
+  OutputDataType initialInput;
 
   //! Locally-stored reset visitor.
-  ResetVisitor resetVisitor;
+  ResetVisitor<OutputDataType> resetVisitor;
 
   //! Locally-stored attention gradient.
-  arma::mat attentionGradient;
+  OutputDataType attentionGradient;
 
   //! Locally-stored intermediate gradient for the attention module.
-  arma::mat intermediateGradient;
+  OutputDataType intermediateGradient;
 }; // class RecurrentAttention
 
 } // namespace ann
@@ -47,23 +47,26 @@ Recurrent<InputDataType, OutputDataType>::Recurrent(
     gradientStep(0),
     deterministic(false)
 {
-  initialModule = new Sequential<>();
-  mergeModule = new AddMerge<>();
-  recurrentModule = new Sequential<>(false);
+  initialModule = new Sequential<OutputDataType, OutputDataType>();
+  mergeModule = new AddMerge<OutputDataType, OutputDataType>();
+  recurrentModule = new Sequential<OutputDataType, OutputDataType>(false);
 
-  boost::apply_visitor(AddVisitor(inputModule), initialModule);
-  boost::apply_visitor(AddVisitor(startModule), initialModule);
-  boost::apply_visitor(AddVisitor(transferModule), initialModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(inputModule), initialModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(startModule), initialModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(transferModule),
+      initialModule);
 
   boost::apply_visitor(weightSizeVisitor, startModule);
   boost::apply_visitor(weightSizeVisitor, inputModule);
   boost::apply_visitor(weightSizeVisitor, feedbackModule);
   boost::apply_visitor(weightSizeVisitor, transferModule);
 
-  boost::apply_visitor(AddVisitor(inputModule), mergeModule);
-  boost::apply_visitor(AddVisitor(feedbackModule), mergeModule);
-  boost::apply_visitor(AddVisitor(mergeModule), recurrentModule);
-  boost::apply_visitor(AddVisitor(transferModule), recurrentModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(inputModule), mergeModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(feedbackModule), mergeModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(mergeModule),
+      recurrentModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(transferModule),
+      recurrentModule);
 
   network.push_back(initialModule);
   network.push_back(mergeModule);
@@ -78,22 +81,22 @@ void Recurrent<InputDataType, OutputDataType>::Forward(
 {
   if (forwardStep == 0)
   {
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(output)),
-        initialModule);
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(output)), initialModule);
   }
   else
   {
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-        boost::apply_visitor(outputParameterVisitor, inputModule))),
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(boost::apply_visitor(outputParameterVisitor, inputModule))),
         inputModule);
 
-    boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, transferModule)), std::move(
-        boost::apply_visitor(outputParameterVisitor, feedbackModule))),
-        feedbackModule);
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, transferModule)),
+        std::move(boost::apply_visitor(outputParameterVisitor,
+        feedbackModule))), feedbackModule);
 
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(output)),
-        recurrentModule);
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(output)), recurrentModule);
   }
 
   output = boost::apply_visitor(outputParameterVisitor, transferModule);
@@ -101,7 +104,11 @@ void Recurrent<InputDataType, OutputDataType>::Forward(
   // Save the feedback output parameter when training the module.
   if (!deterministic)
   {
-    feedbackOutputParameter.push_back(output);
+    // Keep one matrix per time step, and reuse them between the sequences.
+    if (feedbackOutputParameter.size() != rho)
+      feedbackOutputParameter.resize(rho);
+
+    feedbackOutputParameter[forwardStep] = output;
   }
 
   forwardStep++;
@@ -133,26 +140,27 @@ void Recurrent<InputDataType, OutputDataType>::Backward(
 
   if (backwardStep < (rho - 1))
   {
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, recurrentModule)), std::move(recurrentError),
-        std::move(boost::apply_visitor(deltaVisitor, recurrentModule))),
-        recurrentModule);
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, recurrentModule)),
+        std::move(recurrentError), std::move(boost::apply_visitor(deltaVisitor,
+        recurrentModule))), recurrentModule);
 
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, inputModule)), std::move(
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, inputModule)), std::move(
         boost::apply_visitor(deltaVisitor, recurrentModule)), std::move(g)),
         inputModule);
 
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, feedbackModule)), std::move(
-        boost::apply_visitor(deltaVisitor, recurrentModule)), std::move(
-        boost::apply_visitor(deltaVisitor, feedbackModule))), feedbackModule);
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, feedbackModule)),
+        std::move(boost::apply_visitor(deltaVisitor, recurrentModule)),
+        std::move(boost::apply_visitor(deltaVisitor, feedbackModule))),
+        feedbackModule);
   }
   else
   {
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, initialModule)), std::move(recurrentError),
-        std::move(g)), initialModule);
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, initialModule)), std::move(
+        recurrentError), std::move(g)), initialModule);
   }
 
   recurrentError = boost::apply_visitor(deltaVisitor, feedbackModule);
@@ -168,32 +176,33 @@ void Recurrent<InputDataType, OutputDataType>::Gradient(
 {
   if (gradientStep < (rho - 1))
   {
-    boost::apply_visitor(GradientVisitor(std::move(input), std::move(error)),
-        recurrentModule);
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+        std::move(error)), recurrentModule);
 
-    boost::apply_visitor(GradientVisitor(std::move(input), std::move(
-        boost::apply_visitor(deltaVisitor, mergeModule))), inputModule);
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+        std::move(boost::apply_visitor(deltaVisitor, mergeModule))),
+        inputModule);
 
-    boost::apply_visitor(GradientVisitor(std::move(
-        feedbackOutputParameter[feedbackOutputParameter.size() - 2 -
-        gradientStep]), std::move(boost::apply_visitor(deltaVisitor,
-        mergeModule))), feedbackModule);
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(
+        feedbackOutputParameter[rho - 2 - gradientStep]), std::move(
+        boost::apply_visitor(deltaVisitor, mergeModule))), feedbackModule);
   }
   else
   {
-    boost::apply_visitor(GradientZeroVisitor(), recurrentModule);
-    boost::apply_visitor(GradientZeroVisitor(), inputModule);
-    boost::apply_visitor(GradientZeroVisitor(), feedbackModule);
+    boost::apply_visitor(GradientZeroVisitor<OutputDataType>(),
+        recurrentModule);
+    boost::apply_visitor(GradientZeroVisitor<OutputDataType>(), inputModule);
+    boost::apply_visitor(GradientZeroVisitor<OutputDataType>(), feedbackModule);
 
-    boost::apply_visitor(GradientVisitor(std::move(input), std::move(
-        boost::apply_visitor(deltaVisitor, startModule))), initialModule);
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+        std::move(boost::apply_visitor(deltaVisitor, startModule))),
+        initialModule);
   }
 
   gradientStep++;
   if (gradientStep == rho)
   {
     gradientStep = 0;
-    feedbackOutputParameter.clear();
   }
 }
 
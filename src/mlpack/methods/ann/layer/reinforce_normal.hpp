@@ -17,9 +17,9 @@ namespace ann /** Artificial Neural Network. */ {
  * Implementation of the reinforce normal layer. The reinforce normal layer
  * implements the REINFORCE algorithm for the normal distribution.
  *
- * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ * @tparam InputDataType Type of the input data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
- * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ * @tparam OutputDataType Type of the output data (arma::colvec, OutputDataType,
  *         arma::sp_mat or arma::cube).
  */
 template <
@@ -106,7 +106,7 @@ class ReinforceNormal
   OutputDataType outputParameter;
 
   //!  Locally-stored output module parameter parameters.
-  std::vector<arma::mat> moduleInputParameter;
+  std::vector<OutputDataType> moduleInputParameter;
 
   //! If true use maximum a posteriori during the forward pass.
   bool deterministic;
@@ -37,7 +37,7 @@ Sequential<InputDataType, OutputDataType>::~Sequential()
 {
   if (!model)
   {
-    for (LayerTypes& layer : network)
+    for (LayerTypes<OutputDataType>& layer : network)
     {
       boost::apply_visitor(deleteVisitor, layer);
     }
@@ -49,8 +49,8 @@ template<typename eT>
 void Sequential<InputDataType, OutputDataType>::Forward(
     arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-      boost::apply_visitor(outputParameterVisitor, network.front()))),
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+      std::move(boost::apply_visitor(outputParameterVisitor, network.front()))),
       network.front());
 
   if (!reset)
@@ -71,15 +71,17 @@ void Sequential<InputDataType, OutputDataType>::Forward(
     if (!reset)
     {
       // Set the input width.
-      boost::apply_visitor(SetInputWidthVisitor(width, true), network[i]);
+      boost::apply_visitor(SetInputWidthVisitor<OutputDataType>(width, true),
+          network[i]);
 
       // Set the input height.
-      boost::apply_visitor(SetInputHeightVisitor(height, true), network[i]);
+      boost::apply_visitor(SetInputHeightVisitor<OutputDataType>(height, true),
+          network[i]);
     }
 
-    boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[i - 1])), std::move(
-        boost::apply_visitor(outputParameterVisitor, network[i]))),
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, network[i - 1])),
+        std::move(boost::apply_visitor(outputParameterVisitor, network[i]))),
         network[i]);
 
     if (!reset)
@@ -111,18 +113,19 @@ template<typename eT>
 void Sequential<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, network.back())), std::move(gy),
-      std::move(boost::apply_visitor(deltaVisitor, network.back()))),
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, network.back())), std::move(
+      gy), std::move(boost::apply_visitor(deltaVisitor, network.back()))),
       network.back());
 
   for (size_t i = 2; i < network.size() + 1; ++i)
   {
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[network.size() - i])), std::move(
-        boost::apply_visitor(deltaVisitor, network[network.size() - i + 1])),
-        std::move(boost::apply_visitor(deltaVisitor,
-        network[network.size() - i]))), network[network.size() - i]);
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, network[network.size() -
+        i])), std::move(boost::apply_visitor(deltaVisitor,
+        network[network.size() - i + 1])), std::move(boost::apply_visitor(
+        deltaVisitor, network[network.size() - i]))), network[network.size() -
+        i]);
   }
 
   g = boost::apply_visitor(deltaVisitor, network.front());
@@ -135,14 +138,15 @@ void Sequential<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& /* gradient */)
 {
-  boost::apply_visitor(GradientVisitor(std::move(input), std::move(error)),
-      network.front());
+  boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+      std::move(error)), network.front());
 
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
-    boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[i - 1])), std::move(
-        boost::apply_visitor(deltaVisitor, network[i + 1]))), network[i]);
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, network[i - 1])),
+        std::move(boost::apply_visitor(deltaVisitor, network[i + 1]))),
+        network[i]);
   }
 }
 
@@ -0,0 +1,116 @@
+/**
+ * @file softmax_cross_entropy.hpp
+ *
+ * Definition of the SoftMaxCrossEntropy class, which fuses the LogSoftMax
+ * module and the NegativeLogLikelihood output layer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_SOFTMAX_CROSS_ENTROPY_HPP
+#define MLPACK_METHODS_ANN_LAYER_SOFTMAX_CROSS_ENTROPY_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Implementation of the softmax cross entropy output layer, which computes the
+ * negative log likelihood of the softmax of its input in a single, numerically
+ * stable pass over each column of unnormalized log-probabilities (logits).  It
+ * gives the same loss as a LogSoftMax module followed by the
+ * NegativeLogLikelihood layer, but it never stores the log-probabilities, and
+ * its gradient (the softmax minus the one-hot target) is computed directly,
+ * without the intermediate error of the two separate layers.  The layer
+ * expects a class index, in the range between 1 and the number of classes, as
+ * target.
+ *
+ * FFN uses this layer itself when its output layer is NegativeLogLikelihood
+ * and its last module is LogSoftMax, so those networks don't need to be
+ * changed; this layer can also be used as the output layer directly, in which
+ * case the network predicts logits.
+ *
+ * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ */
+template <
+    typename InputDataType = arma::mat,
+    typename OutputDataType = arma::mat
+>
+class SoftMaxCrossEntropy
+{
+ public:
+  /**
+   * Create the SoftMaxCrossEntropy object.
+   */
+  SoftMaxCrossEntropy();
+
+  /**
+   * Computes the negative log likelihood of the softmax of the input.
+   *
+   * @param input The logits, one column per point.
+   * @param target The target vector, that contains the class index in the range
+   *        between 1 and the number of classes.
+   */
+  template<typename eT>
+  double Forward(const arma::Mat<eT>&& input, const arma::Mat<eT>&& target);
+
+  /**
+   * Ordinary feed backward pass of a neural network, which gives the gradient
+   * of the loss with respect to the logits: the softmax of the input minus the
+   * one-hot encoding of the target.
+   *
+   * @param input The logits, one column per point.
+   * @param target The target vector, that contains the class index in the range
+   *        between 1 and the number of classes.
+   * @param output The calculated error.
+   */
+  template<typename eT>
+  void Backward(const arma::Mat<eT>&& input,
+                const arma::Mat<eT>&& target,
+                arma::Mat<eT>&& output);
+
+  //! Get the input parameter.
+  InputDataType& InputParameter() const { return inputParameter; }
+  //! Modify the input parameter.
+  InputDataType& InputParameter() { return inputParameter; }
+
+  //! Get the output parameter.
+  OutputDataType& OutputParameter() const { return outputParameter; }
+  //! Modify the output parameter.
+  OutputDataType& OutputParameter() { return outputParameter; }
+
+  //! Get the delta.
+  OutputDataType& Delta() const { return delta; }
+  //! Modify the delta.
+  OutputDataType& Delta() { return delta; }
+
+  /**
+   * Serialize the layer
+   */
+  template<typename Archive>
+  void Serialize(Archive& /* ar */, const unsigned int /* version */);
+
+ private:
+  //! Locally-stored delta object.
+  OutputDataType delta;
+
+  //! Locally-stored input parameter object.
+  InputDataType inputParameter;
+
+  //! Locally-stored output parameter object.
+  OutputDataType outputParameter;
+}; // class SoftMaxCrossEntropy
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "softmax_cross_entropy_impl.hpp"
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file softmax_cross_entropy_impl.hpp
+ *
+ * Implementation of the SoftMaxCrossEntropy class, which fuses the LogSoftMax
+ * module and the NegativeLogLikelihood output layer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_SOFTMAX_CROSS_ENTROPY_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_SOFTMAX_CROSS_ENTROPY_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "softmax_cross_entropy.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename InputDataType, typename OutputDataType>
+SoftMaxCrossEntropy<InputDataType, OutputDataType>::SoftMaxCrossEntropy()
+{
+  // Nothing to do here.
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+double SoftMaxCrossEntropy<InputDataType, OutputDataType>::Forward(
+    const arma::Mat<eT>&& input, const arma::Mat<eT>&& target)
+{
+  double output = 0;
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for reduction(+:output)
+  for (intmax_t i = 0; i < (intmax_t) input.n_cols; ++i)
+#else
+  #pragma omp parallel for reduction(+:output)
+  for (size_t i = 0; i < input.n_cols; ++i)
+#endif
+  {
+    const size_t currentTarget = target(i) - 1;
+    Log::Assert(currentTarget < input.n_rows, "Target class out of range.");
+
+    // The loss is log(sum(exp(x))) - x(target); the maximum is subtracted
+    // before exponentiating, so that nothing overflows.
+    const eT* logits = input.colptr(i);
+    const eT maxLogit = *std::max_element(logits, logits + input.n_rows);
+    double sum = 0;
+    for (size_t j = 0; j < input.n_rows; ++j)
+      sum += std::exp(double(logits[j] - maxLogit));
+
+    output += std::log(sum) + maxLogit - logits[currentTarget];
+  }
+
+  return output;
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void SoftMaxCrossEntropy<InputDataType, OutputDataType>::Backward(
+      const arma::Mat<eT>&& input,
+      const arma::Mat<eT>&& target,
+      arma::Mat<eT>&& output)
+{
+  output.set_size(input.n_rows, input.n_cols);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for
+  for (intmax_t i = 0; i < (intmax_t) input.n_cols; ++i)
+#else
+  #pragma omp parallel for
+  for (size_t i = 0; i < input.n_cols; ++i)
+#endif
+  {
+    const size_t currentTarget = target(i) - 1;
+    Log::Assert(currentTarget < input.n_rows, "Target class out of range.");
+
+    // Write the shifted exponentials to the output, then normalize them.
+    const eT* logits = input.colptr(i);
+    eT* error = output.colptr(i);
+    const eT maxLogit = *std::max_element(logits, logits + input.n_rows);
+    double sum = 0;
+    for (size_t j = 0; j < input.n_rows; ++j)
+    {
+      error[j] = std::exp(logits[j] - maxLogit);
+      sum += error[j];
+    }
+
+    const eT scale = eT(1 / sum);
+    for (size_t j = 0; j < input.n_rows; ++j)
+      error[j] *= scale;
+    error[currentTarget] -= 1;
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename Archive>
+void SoftMaxCrossEntropy<InputDataType, OutputDataType>::Serialize(
+    Archive& /* ar */,
+    const unsigned int /* version */)
+{
+  // Nothing to do here.
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,197 @@
+/**
+ * @file sparse_linear.hpp
+ *
+ * Definition of the SparseLinear class, a fully-connected layer whose weight
+ * matrix is sparse.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_SPARSE_LINEAR_HPP
+#define MLPACK_METHODS_ANN_LAYER_SPARSE_LINEAR_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Implementation of the SparseLinear class.  The SparseLinear class computes
+ * the same function as Linear (or LinearNoBias), but only the weights of a
+ * fixed sparsity pattern exist, usually the ones that are left after the
+ * network was pruned with PruneByMagnitude() and converted with Sparsify().
+ *
+ * The pattern is stored in compressed sparse row (CSR) form: the weights of
+ * each output unit are contiguous, so that the forward pass of each point
+ * reads its input at random and writes each output once.  Only the nonzero
+ * weights (and the bias) are parameters of the layer, so training the layer
+ * keeps its sparsity pattern.
+ *
+ * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ */
+template <
+    typename InputDataType = arma::mat,
+    typename OutputDataType = arma::mat
+>
+class SparseLinear
+{
+ public:
+  //! Create the SparseLinear object.
+  SparseLinear();
+
+  /**
+   * Create the SparseLinear object with the sparsity pattern of the given
+   * weight matrix.  The parameters are initialized with the nonzero values of
+   * the matrix and a zero bias.
+   *
+   * @param weight The weight matrix, one row per output unit.
+   * @param hasBias Whether the layer has a bias (like Linear) or not (like
+   *     LinearNoBias).
+   */
+  template<typename eT>
+  SparseLinear(const arma::SpMat<eT>& weight, const bool hasBias = true);
+
+  /*
+   * Reset the layer parameter.
+   */
+  void Reset();
+
+  /**
+   * Ordinary feed forward pass of a neural network, evaluating the function
+   * f(x) by propagating the activity forward through f.
+   *
+   * @param input Input data used for evaluating the specified function.
+   * @param output Resulting output activation.
+   */
+  template<typename eT>
+  void Forward(const arma::Mat<eT>&& input, arma::Mat<eT>&& output);
+
+  /**
+   * Ordinary feed backward pass of a neural network, calculating the function
+   * f(x) by propagating x backwards trough f. Using the results from the feed
+   * forward pass.
+   *
+   * @param input The propagated input activation.
+   * @param gy The backpropagated error.
+   * @param g The calculated gradient.
+   */
+  template<typename eT>
+  void Backward(const arma::Mat<eT>&& /* input */,
+                arma::Mat<eT>&& gy,
+                arma::Mat<eT>&& g);
+
+  /*
+   * Calculate the gradient using the output delta and the input activation.
+   *
+   * @param input The input parameter used for calculating the gradient.
+   * @param error The calculated error.
+   * @param gradient The calculated gradient.
+   */
+  template<typename eT>
+  void Gradient(const arma::Mat<eT>&& input,
+                arma::Mat<eT>&& error,
+                arma::Mat<eT>&& gradient);
+
+  //! Get the parameters.
+  OutputDataType const& Parameters() const { return weights; }
+  //! Modify the parameters.
+  OutputDataType& Parameters() { return weights; }
+
+  //! Get the input parameter.
+  InputDataType const& InputParameter() const { return inputParameter; }
+  //! Modify the input parameter.
+  InputDataType& InputParameter() { return inputParameter; }
+
+  //! Get the output parameter.
+  OutputDataType const& OutputParameter() const { return outputParameter; }
+  //! Modify the output parameter.
+  OutputDataType& OutputParameter() { return outputParameter; }
+
+  //! Get the delta.
+  OutputDataType const& Delta() const { return delta; }
+  //! Modify the delta.
+  OutputDataType& Delta() { return delta; }
+
+  //! Get the gradient.
+  OutputDataType const& Gradient() const { return gradient; }
+  //! Modify the gradient.
+  OutputDataType& Gradient() { return gradient; }
+
+  //! Get the number of input units.
+  size_t InputSize() const { return inSize; }
+
+  //! Get the number of output units.
+  size_t OutputSize() const { return outSize; }
+
+  //! Get whether the layer has a bias.
+  bool HasBias() const { return hasBias; }
+
+  //! Get the number of weights of the sparsity pattern.
+  size_t NonZeros() const { return columns.n_elem; }
+
+  //! Get the start of the weights of each output unit (and the end of the
+  //! last), in the order of the parameters.
+  const arma::uvec& RowPointers() const { return rowPointers; }
+
+  //! Get the input unit of each weight, in the order of the parameters.
+  const arma::uvec& Columns() const { return columns; }
+
+  //! Get the current weights as a sparse matrix, one row per output unit.
+  arma::sp_mat Weight() const;
+
+  /**
+   * Serialize the layer
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Locally-stored number of input units.
+  size_t inSize;
+
+  //! Locally-stored number of output units.
+  size_t outSize;
+
+  //! Whether the layer has a bias.
+  bool hasBias;
+
+  //! The start of the weights of each output unit, outSize + 1 entries.
+  arma::uvec rowPointers;
+
+  //! The input unit of each weight.
+  arma::uvec columns;
+
+  //! Locally-stored weight object.
+  OutputDataType weights;
+
+  //! Locally-stored nonzero weight values (an alias of the weights).
+  OutputDataType values;
+
+  //! Locally-stored bias term parameters (an alias of the weights).
+  OutputDataType bias;
+
+  //! Locally-stored delta object.
+  OutputDataType delta;
+
+  //! Locally-stored gradient object.
+  OutputDataType gradient;
+
+  //! Locally-stored input parameter object.
+  InputDataType inputParameter;
+
+  //! Locally-stored output parameter object.
+  OutputDataType outputParameter;
+}; // class SparseLinear
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_linear_impl.hpp"
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * @file sparse_linear_impl.hpp
+ *
+ * Implementation of the SparseLinear class, a fully-connected layer whose
+ * weight matrix is sparse.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_SPARSE_LINEAR_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_SPARSE_LINEAR_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "sparse_linear.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename InputDataType, typename OutputDataType>
+SparseLinear<InputDataType, OutputDataType>::SparseLinear() :
+    inSize(0),
+    outSize(0),
+    hasBias(false)
+{
+  // Nothing to do here.
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+SparseLinear<InputDataType, OutputDataType>::SparseLinear(
+    const arma::SpMat<eT>& weight, const bool hasBias) :
+    inSize(weight.n_cols),
+    outSize(weight.n_rows),
+    hasBias(hasBias)
+{
+  // Armadillo stores sparse matrices by column, so the columns of the
+  // transpose are the rows of the weights.
+  arma::SpMat<eT> weightT = weight.t();
+  weightT.sync();
+
+  rowPointers = arma::uvec(outSize + 1);
+  for (size_t i = 0; i <= outSize; ++i)
+    rowPointers[i] = weightT.col_ptrs[i];
+
+  columns = arma::uvec(weightT.n_nonzero);
+  weights.zeros(weightT.n_nonzero + (hasBias ? outSize : 0), 1);
+  for (size_t i = 0; i < weightT.n_nonzero; ++i)
+  {
+    columns[i] = weightT.row_indices[i];
+    weights[i] = weightT.values[i];
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+void SparseLinear<InputDataType, OutputDataType>::Reset()
+{
+  values = OutputDataType(weights.memptr(), columns.n_elem, 1, false, false);
+  if (hasBias)
+  {
+    bias = OutputDataType(weights.memptr() + columns.n_elem, outSize, 1, false,
+        false);
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void SparseLinear<InputDataType, OutputDataType>::Forward(
+    const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
+{
+  output.set_size(outSize, input.n_cols);
+
+  // Each output is the dot product of the weights of its row with the input
+  // entries they point to.
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for
+  for (intmax_t c = 0; c < (intmax_t) input.n_cols; ++c)
+#else
+  #pragma omp parallel for
+  for (size_t c = 0; c < input.n_cols; ++c)
+#endif
+  {
+    const eT* inputPtr = input.colptr(c);
+    eT* outputPtr = output.colptr(c);
+    for (size_t r = 0; r < outSize; ++r)
+    {
+      eT sum = hasBias ? bias[r] : eT(0);
+      for (size_t k = rowPointers[r]; k < rowPointers[r + 1]; ++k)
+        sum += values[k] * inputPtr[columns[k]];
+
+      outputPtr[r] = sum;
+    }
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void SparseLinear<InputDataType, OutputDataType>::Backward(
+    const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
+{
+  // Scatter the error of each output to the inputs its weights point to.
+  g.zeros(inSize, gy.n_cols);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for
+  for (intmax_t c = 0; c < (intmax_t) gy.n_cols; ++c)
+#else
+  #pragma omp parallel for
+  for (size_t c = 0; c < gy.n_cols; ++c)
+#endif
+  {
+    const eT* gyPtr = gy.colptr(c);
+    eT* gPtr = g.colptr(c);
+    for (size_t r = 0; r < outSize; ++r)
+    {
+      const eT error = gyPtr[r];
+      for (size_t k = rowPointers[r]; k < rowPointers[r + 1]; ++k)
+        gPtr[columns[k]] += values[k] * error;
+    }
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void SparseLinear<InputDataType, OutputDataType>::Gradient(
+    const arma::Mat<eT>&& input,
+    arma::Mat<eT>&& error,
+    arma::Mat<eT>&& gradient)
+{
+  // Only the weights of the pattern have a gradient; each row is handled by
+  // one thread, which reads the points one column at a time.
+  eT* gradientPtr = gradient.memptr();
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for
+  for (intmax_t r = 0; r < (intmax_t) outSize; ++r)
+#else
+  #pragma omp parallel for
+  for (size_t r = 0; r < outSize; ++r)
+#endif
+  {
+    for (size_t k = rowPointers[r]; k < rowPointers[r + 1]; ++k)
+      gradientPtr[k] = 0;
+
+    for (size_t c = 0; c < input.n_cols; ++c)
+    {
+      const eT e = error(r, c);
+      const eT* inputPtr = input.colptr(c);
+      for (size_t k = rowPointers[r]; k < rowPointers[r + 1]; ++k)
+        gradientPtr[k] += e * inputPtr[columns[k]];
+    }
+  }
+
+  if (hasBias)
+  {
+    arma::Mat<eT> biasGradient(gradientPtr + columns.n_elem, outSize, 1, false,
+        true);
+    biasGradient = arma::sum(error, 1);
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+arma::sp_mat SparseLinear<InputDataType, OutputDataType>::Weight() const
+{
+  if (columns.is_empty())
+    return arma::sp_mat(outSize, inSize);
+
+  arma::umat locations(2, columns.n_elem);
+  for (size_t r = 0; r < outSize; ++r)
+  {
+    for (size_t k = rowPointers[r]; k < rowPointers[r + 1]; ++k)
+    {
+      locations(0, k) = r;
+      locations(1, k) = columns[k];
+    }
+  }
+
+  const arma::vec weightValues = arma::conv_to<arma::vec>::from(
+      arma::vectorise(weights.rows(0, columns.n_elem - 1)));
+  return arma::sp_mat(locations, weightValues, outSize, inSize);
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename Archive>
+void SparseLinear<InputDataType, OutputDataType>::Serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(weights, "weights");
+  ar & data::CreateNVP(inSize, "inSize");
+  ar & data::CreateNVP(outSize, "outSize");
+  ar & data::CreateNVP(hasBias, "hasBias");
+  ar & data::CreateNVP(rowPointers, "rowPointers");
+  ar & data::CreateNVP(columns, "columns");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
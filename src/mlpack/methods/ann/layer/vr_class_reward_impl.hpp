@@ -85,7 +85,8 @@ void VRClassReward<InputDataType, OutputDataType>::Backward(
   const double norm = sizeAverage ? 2.0 / (input.n_cols - 1) : 2.0;
 
   output(0, 1) = norm * (input(0, 1) - reward);
-  boost::apply_visitor(RewardSetVisitor(vrReward), network.back());
+  boost::apply_visitor(RewardSetVisitor<OutputDataType>(vrReward),
+      network.back());
 }
 
 template<typename InputDataType, typename OutputDataType>
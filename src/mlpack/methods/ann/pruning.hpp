@@ -0,0 +1,230 @@
+/**
+ * @file pruning.hpp
+ *
+ * Magnitude pruning of the Linear and LinearNoBias modules of a trained feed
+ * forward network, and conversion of the pruned modules to SparseLinear.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_PRUNING_HPP
+#define MLPACK_METHODS_ANN_PRUNING_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "ffn.hpp"
+#include "layer/linear.hpp"
+#include "layer/linear_no_bias.hpp"
+#include "layer/sparse_linear.hpp"
+#include "visitor/copy_visitor.hpp"
+#include "visitor/weight_size_visitor.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+namespace details {
+
+/**
+ * If the given module is a Linear or LinearNoBias module, store its number of
+ * output and input units and return true; the weight matrix is stored by
+ * column at the start of the parameters of the module, followed by the bias
+ * (if any).
+ */
+template<typename MatType>
+bool DenseWeightSize(const LayerTypes<MatType>& layer,
+                     size_t& outSize,
+                     size_t& inSize,
+                     bool& hasBias)
+{
+  if (Linear<MatType, MatType>* const* linear =
+      boost::get<Linear<MatType, MatType>*>(&layer))
+  {
+    outSize = (*linear)->OutputSize();
+    inSize = (*linear)->InputSize();
+    hasBias = true;
+    return true;
+  }
+
+  if (LinearNoBias<MatType, MatType>* const* linear =
+      boost::get<LinearNoBias<MatType, MatType>*>(&layer))
+  {
+    outSize = (*linear)->OutputSize();
+    inSize = (*linear)->InputSize();
+    hasBias = false;
+    return true;
+  }
+
+  return false;
+}
+
+} // namespace details
+
+/**
+ * Set the given fraction of the weights of every Linear and LinearNoBias module
+ * of the network to zero, starting with the weights of the smallest magnitude
+ * of each module.  The bias is not pruned, and the other modules are left as
+ * they are.  Only the modules of the network itself are pruned; modules inside
+ * a Sequential or Concat module are kept as they are.
+ *
+ * Training the network afterwards updates the pruned weights too; to fine-tune
+ * the network with the pruned weights fixed at zero, convert it with
+ * Sparsify() first.
+ *
+ * @param network Trained network to prune.
+ * @param sparsity Fraction of the weights of each module to set to zero, in
+ *     [0, 1].
+ * @return The number of weights that were set to zero.
+ */
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename MatType>
+size_t PruneByMagnitude(
+    FFN<OutputLayerType, InitializationRuleType, MatType>& network,
+    const double sparsity)
+{
+  if (sparsity < 0.0 || sparsity > 1.0)
+  {
+    throw std::invalid_argument("PruneByMagnitude(): the sparsity must be in "
+        "[0, 1]");
+  }
+
+  if (network.Parameters().is_empty())
+  {
+    throw std::invalid_argument("PruneByMagnitude(): the network has no "
+        "parameters");
+  }
+
+  const std::vector<LayerTypes<MatType>>& model = network.Model();
+  WeightSizeVisitor<MatType> weightSizeVisitor;
+  size_t pruned = 0;
+  for (size_t i = 0, offset = 0; i < model.size();
+       offset += boost::apply_visitor(weightSizeVisitor, model[i]), ++i)
+  {
+    size_t outSize, inSize;
+    bool hasBias;
+    if (!details::DenseWeightSize(model[i], outSize, inSize, hasBias))
+      continue;
+
+    // The modules alias the parameters of the network, so the weights are
+    // changed in place.
+    MatType weight(network.Parameters().memptr() + offset, outSize * inSize,
+        1, false, true);
+    const size_t numPruned = (size_t) (sparsity * weight.n_elem);
+    const arma::uvec order = arma::sort_index(arma::abs(weight));
+    for (size_t j = 0; j < numPruned; ++j)
+      weight[order[j]] = 0;
+
+    pruned += numPruned;
+  }
+
+  return pruned;
+}
+
+/**
+ * Build a copy of the given network in which every Linear and LinearNoBias
+ * module is replaced by a SparseLinear module that holds only the nonzero
+ * weights of the module (usually after PruneByMagnitude()), and its bias.
+ * The other modules are copied.  The parameters of the sparse network are set
+ * from those of the network, so that both compute the same function.
+ *
+ * Only the nonzero weights are parameters of the sparse network, so training
+ * it keeps the pruned weights at zero.  Like FFN, the sparse network serializes
+ * its parameters but not its modules; the sparsity pattern of each SparseLinear
+ * module can be saved with SparseLinear::Weight(), to build the modules again
+ * before loading.
+ *
+ * @param network Trained network to convert.
+ * @param sparseNetwork Network without modules to add the modules to, with the
+ *     output layer the converted network should use.
+ */
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename MatType>
+void Sparsify(
+    const FFN<OutputLayerType, InitializationRuleType, MatType>& network,
+    FFN<OutputLayerType, InitializationRuleType, MatType>& sparseNetwork)
+{
+  typedef typename MatType::elem_type ElemType;
+
+  if (network.Parameters().is_empty())
+    throw std::invalid_argument("Sparsify(): the network has no parameters");
+
+  if (!sparseNetwork.Model().empty())
+  {
+    throw std::invalid_argument("Sparsify(): the sparse network already has "
+        "modules");
+  }
+
+  const std::vector<LayerTypes<MatType>>& model = network.Model();
+  const MatType& parameters = network.Parameters();
+  WeightSizeVisitor<MatType> weightSizeVisitor;
+  CopyVisitor<MatType> copyVisitor;
+  for (size_t i = 0, offset = 0; i < model.size();
+       offset += boost::apply_visitor(weightSizeVisitor, model[i]), ++i)
+  {
+    size_t outSize, inSize;
+    bool hasBias;
+    if (details::DenseWeightSize(model[i], outSize, inSize, hasBias))
+    {
+      const MatType weight(const_cast<ElemType*>(parameters.memptr()) +
+          offset, outSize, inSize, false, true);
+      sparseNetwork.Add(new SparseLinear<MatType, MatType>(
+          arma::SpMat<ElemType>(weight), hasBias));
+    }
+    else
+    {
+      sparseNetwork.Add(boost::apply_visitor(copyVisitor, model[i]));
+    }
+  }
+
+  // Set up the parameters of the sparse network and hand them to its modules,
+  // then fill them in.
+  sparseNetwork.ResetParameters();
+  const std::vector<LayerTypes<MatType>>& sparseModel = sparseNetwork.Model();
+  MatType& sparseParameters = sparseNetwork.Parameters();
+  for (size_t i = 0, offset = 0, sparseOffset = 0; i < model.size(); ++i)
+  {
+    const size_t size = boost::apply_visitor(weightSizeVisitor, model[i]);
+    const size_t sparseSize = boost::apply_visitor(weightSizeVisitor,
+        sparseModel[i]);
+
+    size_t outSize, inSize;
+    bool hasBias;
+    if (details::DenseWeightSize(model[i], outSize, inSize, hasBias))
+    {
+      const SparseLinear<MatType, MatType>& layer =
+          *boost::get<SparseLinear<MatType, MatType>*>(sparseModel[i]);
+      const arma::uvec& rowPointers = layer.RowPointers();
+      const arma::uvec& columns = layer.Columns();
+      for (size_t r = 0; r < outSize; ++r)
+      {
+        for (size_t k = rowPointers[r]; k < rowPointers[r + 1]; ++k)
+        {
+          sparseParameters[sparseOffset + k] =
+              parameters[offset + columns[k] * outSize + r];
+        }
+      }
+
+      if (hasBias)
+      {
+        sparseParameters.rows(sparseOffset + columns.n_elem,
+            sparseOffset + sparseSize - 1) = parameters.rows(offset +
+            outSize * inSize, offset + size - 1);
+      }
+    }
+    else if (size > 0)
+    {
+      sparseParameters.rows(sparseOffset, sparseOffset + sparseSize - 1) =
+          parameters.rows(offset, offset + size - 1);
+    }
+
+    offset += size;
+    sparseOffset += sparseSize;
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file quantized_ffn.hpp
+ *
+ * Definition of the QuantizedFFN class, an inference-only version of a trained
+ * feed forward network with int8 weights.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZED_FFN_HPP
+#define MLPACK_METHODS_ANN_QUANTIZED_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "ffn.hpp"
+#include "layer/quantized_layer.hpp"
+#include "visitor/copy_visitor.hpp"
+#include "visitor/delete_visitor.hpp"
+#include "visitor/output_height_visitor.hpp"
+#include "visitor/output_parameter_visitor.hpp"
+#include "visitor/output_width_visitor.hpp"
+#include "visitor/reset_visitor.hpp"
+#include "visitor/weight_size_visitor.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A QuantizedFFN is a trained FFN whose Linear, LinearNoBias and Convolution
+ * modules are quantized to int8 weights with one scale per output unit (or
+ * output map), for inference only: the modules are run with integer matrix
+ * products (see QuantizedLayer), and the serialized model holds a byte per
+ * weight of those modules instead of eight.  The other modules are kept as
+ * they are, with double precision parameters.  Predictions match those of the
+ * FFN up to the quantization error, which is about 1% of the magnitude of the
+ * terms of each output.
+ *
+ * Only the modules of the network itself are quantized; modules inside a
+ * Sequential or Concat module are kept as they are.
+ *
+ * Like FFN, a QuantizedFFN serializes the parameters of its modules, but not
+ * the modules themselves, so the modules of the original network have to be
+ * added (in the same order) before the QuantizedFFN is loaded:
+ *
+ * @code
+ * FFN<NegativeLogLikelihood<> > model;
+ * model.Add<Linear<> >(10, 100);
+ * model.Add<SigmoidLayer<> >();
+ * model.Add<Linear<> >(100, 3);
+ * model.Add<LogSoftMax<> >();
+ * model.Train(data, labels);
+ *
+ * QuantizedFFN<> quantized(model);
+ * data::Save("model.bin", "model", quantized);
+ *
+ * QuantizedFFN<> loaded;
+ * loaded.Add<Linear<> >(10, 100);
+ * loaded.Add<SigmoidLayer<> >();
+ * loaded.Add<Linear<> >(100, 3);
+ * loaded.Add<LogSoftMax<> >();
+ * data::Load("model.bin", "model", loaded);
+ * loaded.Predict(data, predictions);
+ * @endcode
+ *
+ * @tparam MatType Type of the data and parameters of the network (arma::mat or
+ *     arma::fmat).
+ */
+template<typename MatType = arma::mat>
+class QuantizedFFN
+{
+ public:
+  /**
+   * Create an empty QuantizedFFN, to add the modules of a network to before
+   * loading it.
+   */
+  QuantizedFFN();
+
+  /**
+   * Quantize the given trained network.  The network is not modified.
+   *
+   * @param ffn The network to quantize.
+   */
+  template<typename OutputLayerType, typename InitializationRuleType>
+  QuantizedFFN(
+      const FFN<OutputLayerType, InitializationRuleType, MatType>& ffn);
+
+  //! Destructor to release allocated memory.
+  ~QuantizedFFN();
+
+  /*
+   * Add a new module to the model, before loading it.
+   *
+   * @param args The layer parameter.
+   */
+  template <class LayerType, class... Args>
+  void Add(Args... args) { network.push_back(new LayerType(args...)); }
+
+  /*
+   * Add a new module to the model, before loading it.
+   *
+   * @param layer The Layer to be added to the model.
+   */
+  void Add(LayerTypes<MatType> layer) { network.push_back(layer); }
+
+  /**
+   * Predict the responses to a given set of predictors.  The responses will
+   * reflect the output of the network's last module, as for FFN::Predict().
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to pass through the network at once, if
+   *     all the modules can process batches.
+   */
+  void Predict(const MatType& predictors,
+               MatType& results,
+               const size_t batchSize = 256);
+
+  //! Get the quantized layers, one per module of the network; the layers of
+  //! the modules that are not quantized are empty.
+  const std::vector<QuantizedLayer>& Layers() const { return layers; }
+
+  //! Get the parameters of the modules that are not quantized.
+  const MatType& Parameters() const { return parameter; }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  // Don't copy a QuantizedFFN.
+  QuantizedFFN(const QuantizedFFN&);
+  QuantizedFFN& operator=(const QuantizedFFN&);
+
+  /**
+   * Replace the quantized modules by an IdentityLayer, which holds the output
+   * of their QuantizedLayer, point the other modules to the parameters, and
+   * set all the modules to deterministic mode.
+   */
+  void ResetModules();
+
+  /**
+   * Pass the given batch of points through the network.
+   *
+   * @param input The batch of points.
+   */
+  void Forward(MatType&& input);
+
+  //! Locally-stored model modules.
+  std::vector<LayerTypes<MatType>> network;
+
+  //! The quantized layers, one per module.
+  std::vector<QuantizedLayer> layers;
+
+  //! The parameters of the modules that are not quantized.
+  MatType parameter;
+
+  //! The input width.
+  size_t width;
+
+  //! The input height.
+  size_t height;
+
+  //! Locally-stored output parameter visitor.
+  OutputParameterVisitor<MatType> outputParameterVisitor;
+
+  //! Locally-stored weight size visitor.
+  WeightSizeVisitor<MatType> weightSizeVisitor;
+
+  //! Locally-stored output width visitor.
+  OutputWidthVisitor<MatType> outputWidthVisitor;
+
+  //! Locally-stored output height visitor.
+  OutputHeightVisitor<MatType> outputHeightVisitor;
+
+  //! Locally-stored reset visitor.
+  ResetVisitor<MatType> resetVisitor;
+
+  //! Locally-stored delete visitor.
+  DeleteVisitor deleteVisitor;
+
+  //! Locally-stored copy visitor.
+  CopyVisitor<MatType> copyVisitor;
+}; // class QuantizedFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantized_ffn_impl.hpp"
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * @file quantized_ffn_impl.hpp
+ *
+ * Implementation of the QuantizedFFN class, an inference-only version of a
+ * trained feed forward network with int8 weights.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZED_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_QUANTIZED_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantized_ffn.hpp"
+
+#include "visitor/batch_support_visitor.hpp"
+#include "visitor/deterministic_set_visitor.hpp"
+#include "visitor/forward_visitor.hpp"
+#include "visitor/quantize_visitor.hpp"
+#include "visitor/set_input_height_visitor.hpp"
+#include "visitor/set_input_width_visitor.hpp"
+#include "visitor/weight_set_visitor.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename MatType>
+QuantizedFFN<MatType>::QuantizedFFN() : width(0), height(0)
+{
+  // Nothing to do here.
+}
+
+template<typename MatType>
+template<typename OutputLayerType, typename InitializationRuleType>
+QuantizedFFN<MatType>::QuantizedFFN(
+    const FFN<OutputLayerType, InitializationRuleType, MatType>& ffn) :
+    width(0),
+    height(0)
+{
+  const std::vector<LayerTypes<MatType>>& model = ffn.Model();
+  if (ffn.Parameters().is_empty())
+  {
+    throw std::invalid_argument("QuantizedFFN: the network has not been "
+        "trained");
+  }
+
+  // Quantize what can be quantized, and collect the parameters of the other
+  // modules; the parameters of the network follow each other in module order.
+  layers.resize(model.size());
+  std::vector<size_t> sizes(model.size());
+  size_t parameterSize = 0;
+  for (size_t i = 0; i < model.size(); ++i)
+  {
+    sizes[i] = boost::apply_visitor(weightSizeVisitor, model[i]);
+    if (!boost::apply_visitor(QuantizeVisitor(layers[i]), model[i]))
+      parameterSize += sizes[i];
+  }
+
+  parameter.set_size(parameterSize, 1);
+  for (size_t i = 0, offset = 0, ffnOffset = 0; i < model.size();
+       ffnOffset += sizes[i], ++i)
+  {
+    if (layers[i].IsEmpty())
+    {
+      network.push_back(boost::apply_visitor(copyVisitor, model[i]));
+      if (sizes[i] > 0)
+      {
+        parameter.rows(offset, offset + sizes[i] - 1) =
+            ffn.Parameters().rows(ffnOffset, ffnOffset + sizes[i] - 1);
+        offset += sizes[i];
+      }
+    }
+    else
+    {
+      network.push_back(new IdentityLayer<IdentityFunction, MatType,
+          MatType>());
+    }
+  }
+
+  ResetModules();
+}
+
+template<typename MatType>
+QuantizedFFN<MatType>::~QuantizedFFN()
+{
+  std::for_each(network.begin(), network.end(),
+      boost::apply_visitor(deleteVisitor));
+}
+
+template<typename MatType>
+void QuantizedFFN<MatType>::ResetModules()
+{
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (!layers[i].IsEmpty())
+    {
+      // The module the layer was quantized from may have been added before
+      // loading; its weights are not needed.
+      if (boost::get<IdentityLayer<IdentityFunction, MatType, MatType>*>(
+          &network[i]) == NULL)
+      {
+        boost::apply_visitor(deleteVisitor, network[i]);
+        network[i] = new IdentityLayer<IdentityFunction, MatType, MatType>();
+      }
+
+      continue;
+    }
+
+    const size_t size = boost::apply_visitor(weightSizeVisitor, network[i]);
+    if (offset + size > parameter.n_elem)
+    {
+      throw std::invalid_argument("QuantizedFFN: the modules don't match the "
+          "parameters of the model");
+    }
+
+    offset += boost::apply_visitor(WeightSetVisitor<MatType>(std::move(
+        parameter), offset), network[i]);
+    boost::apply_visitor(resetVisitor, network[i]);
+  }
+
+  if (offset != parameter.n_elem)
+  {
+    throw std::invalid_argument("QuantizedFFN: the modules don't match the "
+        "parameters of the model");
+  }
+
+  DeterministicSetVisitor<MatType> deterministicSetVisitor(true);
+  std::for_each(network.begin(), network.end(),
+      boost::apply_visitor(deterministicSetVisitor));
+}
+
+template<typename MatType>
+void QuantizedFFN<MatType>::Predict(const MatType& predictors,
+                                    MatType& results,
+                                    const size_t batchSize)
+{
+  if (network.empty())
+    throw std::invalid_argument("QuantizedFFN::Predict(): the model is empty");
+
+  // The quantized layers process batches, and so do the IdentityLayers that
+  // stand for them.
+  bool batchSupport = true;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (!boost::apply_visitor(BatchSupportVisitor(), network[i]))
+      batchSupport = false;
+  }
+
+  const size_t step = batchSupport ? std::max(batchSize, (size_t) 1) : 1;
+  for (size_t begin = 0; begin < predictors.n_cols; begin += step)
+  {
+    const size_t end = std::min(begin + step, (size_t) predictors.n_cols) - 1;
+
+    // Pass an alias of the batch through the network; the modules only read
+    // their input.
+    Forward(std::move(MatType(const_cast<typename MatType::elem_type*>(
+        predictors.colptr(begin)), predictors.n_rows, end - begin + 1, false,
+        true)));
+
+    const MatType& output = boost::apply_visitor(outputParameterVisitor,
+        network.back());
+    if (begin == 0)
+      results.set_size(output.n_rows, predictors.n_cols);
+
+    results.cols(begin, end) = output;
+  }
+}
+
+template<typename MatType>
+void QuantizedFFN<MatType>::Forward(MatType&& input)
+{
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    MatType& output = boost::apply_visitor(outputParameterVisitor, network[i]);
+    MatType&& layerInput = (i == 0) ? std::move(input) : std::move(
+        boost::apply_visitor(outputParameterVisitor, network[i - 1]));
+
+    if (!layers[i].IsEmpty())
+    {
+      layers[i].Forward(layerInput, output);
+      if (layers[i].IsConvolution())
+      {
+        width = layers[i].OutputWidth();
+        height = layers[i].OutputHeight();
+      }
+
+      continue;
+    }
+
+    // Pass the size of the maps on, as FFN does.
+    if (i > 0)
+    {
+      boost::apply_visitor(SetInputWidthVisitor<MatType>(width), network[i]);
+      boost::apply_visitor(SetInputHeightVisitor<MatType>(height),
+          network[i]);
+    }
+
+    boost::apply_visitor(ForwardVisitor<MatType>(std::move(layerInput),
+        std::move(output)), network[i]);
+
+    if (boost::apply_visitor(outputWidthVisitor, network[i]) != 0)
+      width = boost::apply_visitor(outputWidthVisitor, network[i]);
+
+    if (boost::apply_visitor(outputHeightVisitor, network[i]) != 0)
+      height = boost::apply_visitor(outputHeightVisitor, network[i]);
+  }
+}
+
+template<typename MatType>
+template<typename Archive>
+void QuantizedFFN<MatType>::Serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  // Serialize each layer.  If we are loading, we must resize the vector of
+  // layers correctly.
+  size_t numLayers = layers.size();
+  ar & data::CreateNVP(numLayers, "numLayers");
+  if (Archive::is_loading::value)
+  {
+    layers.clear();
+    layers.resize(numLayers);
+  }
+
+  for (size_t i = 0; i < layers.size(); ++i)
+  {
+    std::ostringstream oss;
+    oss << "layer" << i;
+    ar & data::CreateNVP(layers[i], oss.str());
+  }
+
+  ar & data::CreateNVP(parameter, "parameter");
+
+  // If we are loading, the modules have to be set up again.
+  if (Archive::is_loading::value)
+  {
+    if (layers.size() != network.size())
+    {
+      std::ostringstream oss;
+      oss << "QuantizedFFN: the model has " << layers.size() << " modules, but "
+          << network.size() << " modules were added";
+      throw std::invalid_argument(oss.str());
+    }
+
+    width = 0;
+    height = 0;
+    ResetModules();
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
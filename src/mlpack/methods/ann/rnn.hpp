@@ -18,6 +18,7 @@
 #include "visitor/delta_visitor.hpp"
 #include "visitor/output_parameter_visitor.hpp"
 #include "visitor/reset_visitor.hpp"
+#include "visitor/batch_support_visitor.hpp"
 
 #include "init_rules/network_init.hpp"
 
@@ -33,16 +34,20 @@ namespace ann /** Artificial Neural Network. */ {
  *
  * @tparam OutputLayerType The output layer type used to evaluate the network.
  * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam MatType Type of the data and parameters of the network (arma::mat or
+ *     arma::fmat).  The output layer and all added modules must use the same
+ *     matrix type.
  */
 template<
   typename OutputLayerType = NegativeLogLikelihood<>,
-  typename InitializationRuleType = RandomInitialization
+  typename InitializationRuleType = RandomInitialization,
+  typename MatType = arma::mat
 >
 class RNN
 {
  public:
   //! Convenience typedef for the internal model construction.
-  using NetworkType = RNN<OutputLayerType, InitializationRuleType>;
+  using NetworkType = RNN<OutputLayerType, InitializationRuleType, MatType>;
 
   /**
    * Create the RNN object with the given predictors and responses set (this is
@@ -81,8 +86,8 @@ class RNN
    * @param initializeRule Optional instantiated InitializationRule object
    *        for initializing the network parameter.
    */
-  RNN(arma::mat predictors,
-      arma::mat responses,
+  RNN(MatType predictors,
+      MatType responses,
       const size_t rho,
       const bool single = false,
       OutputLayerType outputLayer = OutputLayerType(),
@@ -112,8 +117,8 @@ class RNN
           mlpack::optimization::StandardSGD,
       typename... OptimizerTypeArgs
   >
-  void Train(arma::mat predictors,
-             arma::mat responses,
+  void Train(MatType predictors,
+             MatType responses,
              OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer);
 
   /**
@@ -136,7 +141,7 @@ class RNN
       template<typename...> class OptimizerType =
           mlpack::optimization::StandardSGD
   >
-  void Train(arma::mat predictors, arma::mat responses);
+  void Train(MatType predictors, MatType responses);
 
   /**
    * Predict the responses to a given set of predictors. The responses will
@@ -149,7 +154,7 @@ class RNN
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
    */
-  void Predict(arma::mat predictors, arma::mat& results);
+  void Predict(MatType predictors, MatType& results);
 
   /**
    * Evaluate the recurrent neural network with the given parameters. This
@@ -160,10 +165,49 @@ class RNN
    * @param deterministic Whether or not to train or test the model. Note some
    *        layer act differently in training or testing mode.
    */
-  double Evaluate(const arma::mat& /* parameters */,
+  double Evaluate(const MatType& /* parameters */,
                   const size_t i,
                   const bool deterministic = true);
 
+  /**
+   * Evaluate the recurrent neural network with the given parameters on the
+   * batch of sequences [begin, begin + batchSize).  If every module supports
+   * batches (like FastLSTM and Linear), each step of all the sequences is
+   * passed through the network at once; otherwise the sequences are evaluated
+   * one at a time.  The returned objective is the sum of the objectives of each
+   * sequence in the batch.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first sequence to use for objective function
+   *        evaluation.
+   * @param batchSize Number of sequences to use for objective function
+   *        evaluation.
+   * @param deterministic Whether or not to train or test the model. Note some
+   *        layer act differently in training or testing mode.
+   */
+  double Evaluate(const MatType& parameters,
+                  const size_t begin,
+                  const size_t batchSize,
+                  const bool deterministic);
+
+  /**
+   * Evaluate the recurrent neural network with the given parameters on the
+   * batch of sequences [begin, begin + batchSize) in testing (deterministic)
+   * mode.  This is used by optimizers such as MiniBatchSGD.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first sequence to use for objective function
+   *        evaluation.
+   * @param batchSize Number of sequences to use for objective function
+   *        evaluation.
+   */
+  double Evaluate(const MatType& parameters,
+                  const size_t begin,
+                  const size_t batchSize)
+  {
+    return Evaluate(parameters, begin, batchSize, true);
+  }
+
   /**
    * Evaluate the gradient of the recurrent neural network with the given
    * parameters, and with respect to only one point in the dataset. This is
@@ -174,9 +218,27 @@ class RNN
    * @param i Index of points to use for objective function gradient evaluation.
    * @param gradient Matrix to output gradient into.
    */
-  void Gradient(const arma::mat& parameters,
+  void Gradient(const MatType& parameters,
                 const size_t i,
-                arma::mat& gradient);
+                MatType& gradient);
+
+  /**
+   * Evaluate the gradient of the recurrent neural network with the given
+   * parameters with respect to the batch of sequences [begin, begin +
+   * batchSize).  The resulting gradient is the sum of the gradients of each
+   * sequence in the batch.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first sequence to use for objective function
+   *        gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of sequences to use for objective function
+   *        gradient evaluation.
+   */
+  void Gradient(const MatType& parameters,
+                const size_t begin,
+                MatType& gradient,
+                const size_t batchSize);
 
   /*
    * Add a new module to the model.
@@ -199,15 +261,29 @@ class RNN
    *
    * @param layer The Layer to be added to the model.
    */
-  void Add(LayerTypes layer) { network.push_back(layer); }
+  void Add(LayerTypes<MatType> layer) { network.push_back(layer); }
 
   //! Return the number of separable functions (the number of predictor points).
   size_t NumFunctions() const { return numFunctions; }
 
   //! Return the initial point for the optimization.
-  const arma::mat& Parameters() const { return parameter; }
+  const MatType& Parameters() const { return parameter; }
   //! Modify the initial point for the optimization.
-  arma::mat& Parameters() { return parameter; }
+  MatType& Parameters() { return parameter; }
+
+  /**
+   * Get whether the outputs of the modules for each step are computed again
+   * during the backward pass through time, instead of being stored for all rho
+   * steps during the forward pass.  This trades one more forward pass per
+   * gradient for the memory of the stored outputs.  It is only used if every
+   * module supports it (see RecomputeSupportVisitor); otherwise the outputs
+   * are stored.  Modules that draw random values in training mode (like
+   * Dropout) draw new ones when a step is computed again.
+   */
+  bool RecomputeOutputs() const { return recompute; }
+  //! Modify whether the outputs of the modules are computed again during the
+  //! backward pass through time.
+  bool& RecomputeOutputs() { return recompute; }
 
   //! Serialize the model.
   template<typename Archive>
@@ -221,7 +297,7 @@ class RNN
    *
    * @param input Data sequence to compute probabilities for.
    */
-  void Forward(arma::mat&& input);
+  void Forward(MatType&& input);
 
   /**
    * The Backward algorithm (part of the Forward-Backward algorithm). Computes
@@ -241,7 +317,7 @@ class RNN
    * @param predictors Input predictors.
    * @param results Vector to put output prediction of a response into.
    */
-  void SinglePredict(const arma::mat& predictors, arma::mat& results);
+  void SinglePredict(const MatType& predictors, MatType& results);
 
   /**
    * Reset the module infomration (weights/parameters).
@@ -257,7 +333,21 @@ class RNN
   /**
    * Reset the gradient for all modules that implement the Gradient function.
    */
-  void ResetGradients(arma::mat& gradient);
+  void ResetGradients(MatType& gradient);
+
+  /**
+   * Return true if every module of the network can process a batch of
+   * sequences at once.  If not, batches are passed through the network one
+   * sequence at a time.
+   */
+  bool BatchSupport() const;
+
+  /**
+   * Return true if the outputs of the modules should be computed again for
+   * each step during the backward pass: RecomputeOutputs() is set, and every
+   * module supports it.
+   */
+  bool UseRecompute() const;
 
   //! Number of steps to backpropagate through time (BPTT).
   size_t rho;
@@ -284,41 +374,48 @@ class RNN
     //! Only predict the last element of the input sequence.
   bool single;
 
+  //! Whether to compute the outputs of the modules again during the backward
+  //! pass instead of storing them.
+  bool recompute;
+
   //! Locally-stored model modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<MatType>> network;
 
   //! The matrix of data points (predictors).
-  arma::mat predictors;
+  MatType predictors;
 
   //! The matrix of responses to the input data points.
-  arma::mat responses;
+  MatType responses;
 
   //! Matrix of (trained) parameters.
-  arma::mat parameter;
+  MatType parameter;
 
   //! The number of separable functions (the number of predictor points).
   size_t numFunctions;
 
   //! The current error for the backward pass.
-  arma::mat error;
+  MatType error;
 
   //! THe current input of the forward/backward pass.
-  arma::mat currentInput;
+  MatType currentInput;
+
+  //! The gradient of the current time step, which the modules write into.
+  MatType currentGradient;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<MatType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<MatType> outputParameterVisitor;
 
   //! List of all module parameters for the backward pass (BBTT).
-  std::vector<arma::mat> moduleOutputParameter;
+  std::vector<MatType> moduleOutputParameter;
 
   //! Locally-stored weight size visitor.
-  WeightSizeVisitor weightSizeVisitor;
+  WeightSizeVisitor<MatType> weightSizeVisitor;
 
   //! Locally-stored reset visitor.
-  ResetVisitor resetVisitor;
+  ResetVisitor<MatType> resetVisitor;
 
   //! Locally-stored delete visitor.
   DeleteVisitor deleteVisitor;
@@ -15,20 +15,24 @@
 // In case it hasn't been included yet.
 #include "rnn.hpp"
 
+#include "visitor/alias_check_visitor.hpp"
 #include "visitor/load_output_parameter_visitor.hpp"
 #include "visitor/save_output_parameter_visitor.hpp"
+#include "visitor/forward_step_set_visitor.hpp"
 #include "visitor/forward_visitor.hpp"
 #include "visitor/backward_visitor.hpp"
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
 #include "visitor/gradient_visitor.hpp"
+#include "visitor/recompute_support_visitor.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 
-template<typename OutputLayerType, typename InitializationRuleType>
-RNN<OutputLayerType, InitializationRuleType>::RNN(
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+RNN<OutputLayerType, InitializationRuleType, MatType>::RNN(
     const size_t rho,
     const bool single,
     OutputLayerType outputLayer,
@@ -40,15 +44,17 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     outputSize(0),
     targetSize(0),
     reset(false),
-    single(single)
+    single(single),
+    recompute(false)
 {
   /* Nothing to do here */
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-RNN<OutputLayerType, InitializationRuleType>::RNN(
-    arma::mat predictors,
-    arma::mat responses,
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+RNN<OutputLayerType, InitializationRuleType, MatType>::RNN(
+    MatType predictors,
+    MatType responses,
     const size_t rho,
     const bool single,
     OutputLayerType outputLayer,
@@ -61,6 +67,7 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     targetSize(0),
     reset(false),
     single(single),
+    recompute(false),
     predictors(std::move(predictors)),
     responses(std::move(responses)),
     deterministic(true)
@@ -69,23 +76,25 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
   ResetDeterministic();
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-RNN<OutputLayerType, InitializationRuleType>::~RNN()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+RNN<OutputLayerType, InitializationRuleType, MatType>::~RNN()
 {
-  for (LayerTypes& layer : network)
+  for (LayerTypes<MatType>& layer : network)
   {
     boost::apply_visitor(deleteVisitor, layer);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<
     template<typename, typename...> class OptimizerType,
     typename... OptimizerTypeArgs
 >
-void RNN<OutputLayerType, InitializationRuleType>::Train(
-    arma::mat predictors,
-    arma::mat responses,
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Train(
+    MatType predictors,
+    MatType responses,
     OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer)
 {
   numFunctions = responses.n_cols;
@@ -111,10 +120,11 @@ void RNN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<template<typename...> class OptimizerType>
-void RNN<OutputLayerType, InitializationRuleType>::Train(
-    arma::mat predictors, arma::mat responses)
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Train(
+    MatType predictors, MatType responses)
 {
   numFunctions = responses.n_cols;
 
@@ -141,9 +151,10 @@ void RNN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Predict(
-    arma::mat predictors, arma::mat& results)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Predict(
+    MatType predictors, MatType& results)
 {
   if (parameter.is_empty())
   {
@@ -156,22 +167,23 @@ void RNN<OutputLayerType, InitializationRuleType>::Predict(
     ResetDeterministic();
   }
 
-  results = arma::zeros<arma::mat>(outputSize * rho, predictors.n_cols);
-  arma::mat resultsTemp = results.col(0);
+  results = arma::zeros<MatType>(outputSize * rho, predictors.n_cols);
+  MatType resultsTemp = results.col(0);
 
   for (size_t i = 0; i < predictors.n_cols; i++)
   {
     SinglePredict(
-        arma::mat(predictors.colptr(i), predictors.n_rows, 1, false, true),
+        MatType(predictors.colptr(i), predictors.n_rows, 1, false, true),
         resultsTemp);
 
     results.col(i) = resultsTemp;
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::SinglePredict(
-    const arma::mat& predictors, arma::mat& results)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::SinglePredict(
+    const MatType& predictors, MatType& results)
 {
   for (size_t seqNum = 0; seqNum < rho; ++seqNum)
   {
@@ -184,9 +196,21 @@ void RNN<OutputLayerType, InitializationRuleType>::SinglePredict(
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
-    const arma::mat& /* parameters */, const size_t i, const bool deterministic)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double RNN<OutputLayerType, InitializationRuleType, MatType>::Evaluate(
+    const MatType& parameters, const size_t i, const bool deterministic)
+{
+  return Evaluate(parameters, i, 1, deterministic);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double RNN<OutputLayerType, InitializationRuleType, MatType>::Evaluate(
+    const MatType& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    const bool deterministic)
 {
   if (parameter.is_empty())
   {
@@ -200,15 +224,25 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
     ResetDeterministic();
   }
 
-  arma::mat input = arma::mat(predictors.colptr(i), predictors.n_rows,
-      1, false, true);
-  arma::mat target = arma::mat(responses.colptr(i), responses.n_rows,
-      1, false, true);
+  if (batchSize > 1 && !BatchSupport())
+  {
+    double performance = 0;
+    for (size_t i = begin; i < begin + batchSize; ++i)
+      performance += Evaluate(parameters, i, 1, deterministic);
+
+    return performance;
+  }
+
+  // Each column of the batch holds a whole sequence.
+  MatType input = MatType(const_cast<typename MatType::elem_type*>(
+      predictors.colptr(begin)), predictors.n_rows, batchSize, false, true);
+  MatType target = MatType(const_cast<typename MatType::elem_type*>(
+      responses.colptr(begin)), responses.n_rows, batchSize, false, true);
 
   if (!inputSize)
   {
-    inputSize = input.n_elem / rho;
-    targetSize = target.n_elem / rho;
+    inputSize = input.n_rows / rho;
+    targetSize = target.n_rows / rho;
   }
 
   double performance = 0;
@@ -216,16 +250,18 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
   for (size_t seqNum = 0; seqNum < rho; ++seqNum)
   {
     currentInput = input.rows(seqNum * inputSize, (seqNum + 1) * inputSize - 1);
-    arma::mat currentTarget = target.rows(seqNum * targetSize,
+    MatType currentTarget = target.rows(seqNum * targetSize,
         (seqNum + 1) * targetSize - 1);
 
     Forward(std::move(currentInput));
 
-    if (!deterministic)
+    // The outputs are kept for the backward pass, unless they are computed
+    // again then.
+    if (!deterministic && !UseRecompute())
     {
       for (size_t l = 0; l < network.size(); ++l)
       {
-        boost::apply_visitor(SaveOutputParameterVisitor(
+        boost::apply_visitor(SaveOutputParameterVisitor<MatType>(
             std::move(moduleOutputParameter)), network[l]);
       }
     }
@@ -237,16 +273,42 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
   if (!outputSize)
   {
     outputSize = boost::apply_visitor(outputParameterVisitor,
-        network.back()).n_elem;
+        network.back()).n_rows;
   }
 
   return performance;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Gradient(
-    const arma::mat& parameters, const size_t i, arma::mat& gradient)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+    const MatType& parameters, const size_t i, MatType& gradient)
+{
+  Gradient(parameters, i, gradient, 1);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+    const MatType& parameters,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize)
 {
+  if (batchSize > 1 && !BatchSupport())
+  {
+    Gradient(parameters, begin, gradient, 1);
+
+    MatType sequenceGradient;
+    for (size_t i = begin + 1; i < begin + batchSize; ++i)
+    {
+      Gradient(parameters, i, sequenceGradient, 1);
+      gradient += sequenceGradient;
+    }
+
+    return;
+  }
+
   if (gradient.is_empty())
   {
     if (parameter.is_empty())
@@ -255,37 +317,55 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
       reset = true;
     }
 
-    gradient = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+    gradient = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
   }
   else
   {
     gradient.zeros();
   }
 
-  Evaluate(parameters, i, false);
+  Evaluate(parameters, begin, batchSize, false);
 
-  arma::mat currentGradient = arma::zeros<arma::mat>(parameter.n_rows,
-      parameter.n_cols);
+  // The modules write their gradient for each time step into currentGradient,
+  // which is kept between the calls so it isn't reallocated.
+  currentGradient.set_size(parameter.n_rows, parameter.n_cols);
   ResetGradients(currentGradient);
 
-  arma::mat input = arma::mat(predictors.colptr(i), predictors.n_rows,
-      1, false, true);
-  arma::mat target = arma::mat(responses.colptr(i), responses.n_rows,
-      1, false, true);
+  MatType input = MatType(const_cast<typename MatType::elem_type*>(
+      predictors.colptr(begin)), predictors.n_rows, batchSize, false, true);
+  MatType target = MatType(const_cast<typename MatType::elem_type*>(
+      responses.colptr(begin)), responses.n_rows, batchSize, false, true);
 
+  const bool useRecompute = UseRecompute();
   for (size_t seqNum = 0; seqNum < rho; ++seqNum)
   {
     currentGradient.zeros();
 
-    arma::mat currentTarget = target.rows((rho - seqNum - 1) * targetSize,
+    MatType currentTarget = target.rows((rho - seqNum - 1) * targetSize,
         (rho - seqNum) * targetSize - 1);
     currentInput = input.rows((rho - seqNum - 1) * inputSize,
         (rho - seqNum) * inputSize - 1);
 
-    for (size_t l = 0; l < network.size(); ++l)
+    if (useRecompute)
+    {
+      // Compute the outputs of this step again; the recurrent modules resume
+      // from the state they kept for it.
+      for (size_t l = 0; l < network.size(); ++l)
+      {
+        boost::apply_visitor(ForwardStepSetVisitor<MatType>(rho - seqNum - 1),
+            network[l]);
+      }
+
+      Forward(std::move(currentInput));
+    }
+    else
     {
-      boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(moduleOutputParameter)), network[network.size() - 1 - l]);
+      for (size_t l = 0; l < network.size(); ++l)
+      {
+        boost::apply_visitor(LoadOutputParameterVisitor<MatType>(
+            std::move(moduleOutputParameter)),
+            network[network.size() - 1 - l]);
+      }
     }
 
     if (single && seqNum > 0)
@@ -303,10 +383,28 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
     Gradient();
     gradient += currentGradient;
   }
+
+  // The next sequences start at the first step.
+  if (useRecompute)
+  {
+    for (size_t l = 0; l < network.size(); ++l)
+      boost::apply_visitor(ForwardStepSetVisitor<MatType>(0), network[l]);
+  }
+
+#ifdef DEBUG
+  // Make sure that no module trained a copy of its parameters or gradient.
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    offset += boost::apply_visitor(AliasCheckVisitor<MatType>(std::move(
+        parameter), std::move(currentGradient), offset), network[i]);
+  }
+#endif
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::ResetParameters()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::ResetParameters()
 {
   ResetDeterministic();
 
@@ -315,53 +413,87 @@ void RNN<OutputLayerType, InitializationRuleType>::ResetParameters()
   networkInit.Initialize(network, parameter);
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::ResetDeterministic()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::ResetDeterministic()
 {
-  DeterministicSetVisitor deterministicSetVisitor(deterministic);
+  DeterministicSetVisitor<MatType> deterministicSetVisitor(deterministic);
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deterministicSetVisitor));
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::ResetGradients(
-    arma::mat& gradient)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+bool RNN<OutputLayerType, InitializationRuleType, MatType>::BatchSupport() const
+{
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (!boost::apply_visitor(BatchSupportVisitor(), network[i]))
+      return false;
+  }
+
+  return true;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+bool RNN<OutputLayerType, InitializationRuleType, MatType>::UseRecompute() const
+{
+  if (!recompute)
+    return false;
+
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (!boost::apply_visitor(RecomputeSupportVisitor<MatType>(), network[i]))
+      return false;
+  }
+
+  return true;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::ResetGradients(
+    MatType& gradient)
 {
   size_t offset = 0;
-  for (LayerTypes& layer : network)
+  for (LayerTypes<MatType>& layer : network)
   {
-    offset += boost::apply_visitor(GradientSetVisitor(std::move(gradient),
-        offset), layer);
+    offset += boost::apply_visitor(GradientSetVisitor<MatType>(std::move(
+        gradient), offset), layer);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Forward(
+    MatType&& input)
 {
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
+  boost::apply_visitor(ForwardVisitor<MatType>(std::move(input), std::move(
       boost::apply_visitor(outputParameterVisitor, network.front()))),
       network.front());
 
   for (size_t i = 1; i < network.size(); ++i)
   {
-    boost::apply_visitor(ForwardVisitor(
+    boost::apply_visitor(ForwardVisitor<MatType>(
         std::move(boost::apply_visitor(outputParameterVisitor, network[i - 1])),
         std::move(boost::apply_visitor(outputParameterVisitor, network[i]))),
         network[i]);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Backward()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Backward()
 {
-  boost::apply_visitor(BackwardVisitor(
+  boost::apply_visitor(BackwardVisitor<MatType>(
         std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
         std::move(error), std::move(boost::apply_visitor(deltaVisitor,
         network.back()))), network.back());
 
   for (size_t i = 2; i < network.size(); ++i)
   {
-    boost::apply_visitor(BackwardVisitor(
+    boost::apply_visitor(BackwardVisitor<MatType>(
         std::move(boost::apply_visitor(outputParameterVisitor,
         network[network.size() - i])), std::move(boost::apply_visitor(
         deltaVisitor, network[network.size() - i + 1])), std::move(
@@ -370,24 +502,27 @@ void RNN<OutputLayerType, InitializationRuleType>::Backward()
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Gradient()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Gradient()
 {
-  boost::apply_visitor(GradientVisitor(std::move(currentInput), std::move(
-      boost::apply_visitor(deltaVisitor, network[1]))), network.front());
+  boost::apply_visitor(GradientVisitor<MatType>(std::move(currentInput),
+      std::move(boost::apply_visitor(deltaVisitor, network[1]))),
+      network.front());
 
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
-    boost::apply_visitor(GradientVisitor(
+    boost::apply_visitor(GradientVisitor<MatType>(
         std::move(boost::apply_visitor(outputParameterVisitor, network[i - 1])),
         std::move(boost::apply_visitor(deltaVisitor, network[i + 1]))),
         network[i]);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<typename Archive>
-void RNN<OutputLayerType, InitializationRuleType>::Serialize(
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Serialize(
     Archive& ar, const unsigned int /* version */)
 {
   ar & data::CreateNVP(parameter, "parameter");
@@ -404,10 +539,10 @@ void RNN<OutputLayerType, InitializationRuleType>::Serialize(
     reset = false;
 
     size_t offset = 0;
-    for (LayerTypes& layer : network)
+    for (LayerTypes<MatType>& layer : network)
     {
-      offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
-          offset), layer);
+      offset += boost::apply_visitor(WeightSetVisitor<MatType>(std::move(
+          parameter), offset), layer);
 
       boost::apply_visitor(resetVisitor, layer);
     }
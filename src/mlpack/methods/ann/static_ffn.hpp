@@ -0,0 +1,422 @@
+/**
+ * @file static_ffn.hpp
+ *
+ * Definition of the StaticFFN class, a feed forward network whose layer types
+ * are fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <array>
+
+#include "visitor/batch_support_visitor.hpp"
+#include "visitor/output_height_visitor.hpp"
+#include "visitor/output_width_visitor.hpp"
+
+#include "init_rules/init_rules_traits.hpp"
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/init_rules/random_init.hpp>
+#include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Implementation of a feed forward neural network whose layers are given as
+ * template parameters and held by value in a std::tuple, for example
+ *
+ * @code
+ * StaticFFN<NegativeLogLikelihood<>, RandomInitialization,
+ *     Linear<>, SigmoidLayer<>, Linear<>, LogSoftMax<> >
+ *     model(Linear<>(4, 8), SigmoidLayer<>(), Linear<>(8, 2), LogSoftMax<>());
+ * @endcode
+ *
+ * Since the type of every layer is known at compile time, the calls to the
+ * layers are resolved statically and can be inlined, instead of going through
+ * boost::apply_visitor() for every module in every pass like FFN does, and the
+ * offsets of the layer weights in the parameter matrix are computed once.
+ * This helps networks with many small layers.  The existing visitors are
+ * applied directly to the layers, so every layer that works with FFN works
+ * here too.
+ *
+ * StaticFFN provides the same functions as FFN (Train(), Predict(), the
+ * separable Evaluate() and Gradient() overloads and Serialize()), so it works
+ * with the same optimizers, and its serialized parameters have the same layout
+ * as those of an FFN with the same layers.
+ *
+ * @tparam OutputLayerType The output layer type used to evaluate the network.
+ * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam Layers Types of the layers of the network, from input to output
+ *     (at least two).
+ */
+template<
+  typename OutputLayerType,
+  typename InitializationRuleType,
+  typename... Layers
+>
+class StaticFFN
+{
+  static_assert(sizeof...(Layers) >= 2,
+      "StaticFFN needs at least two layers.");
+
+ public:
+  //! Convenience typedef for the internal model construction.
+  using NetworkType = StaticFFN<OutputLayerType, InitializationRuleType,
+      Layers...>;
+
+  //! The number of layers.
+  static const size_t NumLayers = sizeof...(Layers);
+
+  /**
+   * Create the StaticFFN object with the given layers.
+   *
+   * @param layers The layers of the network.
+   */
+  StaticFFN(Layers... layers);
+
+  /**
+   * Create the StaticFFN object with the given layers, output layer and
+   * initialization rule.
+   *
+   * @param outputLayer Output layer used to evaluate the network.
+   * @param initializeRule Optional instantiated InitializationRule object
+   *        for initializing the network parameter.
+   * @param layers The layers of the network.
+   */
+  StaticFFN(OutputLayerType outputLayer,
+            InitializationRuleType initializeRule,
+            Layers... layers);
+
+  //! Copy constructor; the copied layers use the copied parameters.
+  StaticFFN(const StaticFFN& network);
+
+  //! Copy assignment operator; the copied layers use the copied parameters.
+  StaticFFN& operator=(const StaticFFN& network);
+
+  /**
+   * Train the feedforward network on the given input data using the given
+   * optimizer.
+   *
+   * This will use the existing model parameters as a starting point for the
+   * optimization. If this is not what you want, then you should access the
+   * parameters vector directly with Parameters() and modify it as desired.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param optimizer Instantiated optimizer used to train the model.
+   */
+  template<
+      template<typename, typename...> class OptimizerType =
+          mlpack::optimization::RMSProp,
+      typename... OptimizerTypeArgs
+  >
+  void Train(arma::mat predictors,
+             arma::mat responses,
+             OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer);
+
+  /**
+   * Train the feedforward network on the given input data. By default, the
+   * RMSProp optimization algorithm is used, but others can be specified
+   * (such as mlpack::optimization::SGD).
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   */
+  template<
+      template<typename...> class OptimizerType = mlpack::optimization::RMSProp
+  >
+  void Train(arma::mat predictors, arma::mat responses);
+
+  /**
+   * Predict the responses to a given set of predictors, batchSize points at a
+   * time if every layer supports batches (see BatchSupportVisitor), and one
+   * point at a time otherwise.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to pass through the network at once.
+   */
+  void Predict(const arma::mat& predictors,
+               arma::mat& results,
+               const size_t batchSize = 256);
+
+  /**
+   * Evaluate the feedforward network with the given parameters. This function
+   * is usually called by the optimizer to train the model.
+   *
+   * @param parameters Matrix model parameters.
+   * @param i Index of point to use for objective function evaluation.
+   * @param deterministic Whether or not to train or test the model. Note some
+   *        layer act differently in training or testing mode.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t i,
+                  const bool deterministic = true);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on the batch of
+   * points [begin, begin + batchSize).  The returned objective is the sum of
+   * the objectives of each point in the batch.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to use for objective function
+   *        evaluation.
+   * @param deterministic Whether or not to train or test the model. Note some
+   *        layer act differently in training or testing mode.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize,
+                  const bool deterministic);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on the batch of
+   * points [begin, begin + batchSize) in testing (deterministic) mode.  This is
+   * used by optimizers such as MiniBatchSGD.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to use for objective function
+   *        evaluation.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize)
+  {
+    return Evaluate(parameters, begin, batchSize, true);
+  }
+
+  /**
+   * Evaluate the gradient of the feedforward network with the given parameters,
+   * and with respect to only one point in the dataset.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param i Index of points to use for objective function gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient);
+
+  /**
+   * Evaluate the gradient of the feedforward network with the given parameters
+   * with respect to the batch of points [begin, begin + batchSize).  The
+   * resulting gradient is the sum of the gradients of each point in the batch.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first point to use for objective function
+   *        gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to use for objective function gradient
+   *        evaluation.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize);
+
+  //! Get the layer of the given index.
+  template<size_t I>
+  const typename std::tuple_element<I, std::tuple<Layers...> >::type&
+  Layer() const { return std::get<I>(network); }
+  //! Modify the layer of the given index.
+  template<size_t I>
+  typename std::tuple_element<I, std::tuple<Layers...> >::type&
+  Layer() { return std::get<I>(network); }
+
+  //! Return the number of separable functions (the number of predictor points).
+  size_t NumFunctions() const { return numFunctions; }
+
+  //! Return the initial point for the optimization.
+  const arma::mat& Parameters() const { return parameter; }
+  //! Modify the initial point for the optimization.
+  arma::mat& Parameters() { return parameter; }
+
+  /**
+   * Reset the module infomration (weights/parameters).
+   */
+  void ResetParameters();
+
+  //! Serialize the model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Get the input of the layer of the given index.
+  template<size_t I>
+  typename std::enable_if<I == 0, arma::mat&>::type LayerInput()
+  { return currentInput; }
+  template<size_t I>
+  typename std::enable_if<(I > 0), arma::mat&>::type LayerInput()
+  { return std::get<I - 1>(network).OutputParameter(); }
+
+  //! Get the error backpropagated into the layer of the given index.
+  template<size_t I>
+  typename std::enable_if<I + 1 == NumLayers, arma::mat&>::type LayerError()
+  { return error; }
+  template<size_t I>
+  typename std::enable_if<(I + 1 < NumLayers), arma::mat&>::type LayerError()
+  { return std::get<I + 1>(network).Delta(); }
+
+  /**
+   * Pass the current input forward through the layers, starting at the layer
+   * of the given index.
+   */
+  template<size_t I = 0>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type Forward();
+  template<size_t I = 0>
+  typename std::enable_if<I == sizeof...(Layers), void>::type Forward() { }
+
+  /**
+   * Pass the error backward through the layers, starting at the layer of the
+   * given index and going down to the second layer.
+   */
+  template<size_t I = NumLayers - 1>
+  typename std::enable_if<(I > 0), void>::type Backward();
+  template<size_t I = NumLayers - 1>
+  typename std::enable_if<I == 0, void>::type Backward() { }
+
+  /**
+   * Compute the gradient of the layers, starting at the layer of the given
+   * index.
+   */
+  template<size_t I = 0>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type Gradient();
+  template<size_t I = 0>
+  typename std::enable_if<I == sizeof...(Layers), void>::type Gradient() { }
+
+  /**
+   * Point the weights of the layers, starting at the layer of the given index,
+   * to the parameter matrix, and store the offsets of the weights.
+   */
+  template<size_t I = 0>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type ResetWeights(
+      const size_t offset = 0);
+  template<size_t I = 0>
+  typename std::enable_if<I == sizeof...(Layers), void>::type ResetWeights(
+      const size_t /* offset */ = 0) { }
+
+  /**
+   * Point the gradients of the layers, starting at the layer of the given
+   * index, to the given gradient matrix.
+   */
+  template<size_t I = 0>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type ResetGradients(
+      arma::mat& gradient);
+  template<size_t I = 0>
+  typename std::enable_if<I == sizeof...(Layers), void>::type ResetGradients(
+      arma::mat& /* gradient */) { }
+
+  /**
+   * Apply the given visitor to the layers, starting at the layer of the given
+   * index.
+   */
+  template<typename VisitorType, size_t I = 0>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type Apply(
+      const VisitorType& visitor);
+  template<typename VisitorType, size_t I = 0>
+  typename std::enable_if<I == sizeof...(Layers), void>::type Apply(
+      const VisitorType& /* visitor */) { }
+
+  /**
+   * Return the total number of weights of the layers, starting at the layer of
+   * the given index.
+   */
+  template<size_t I = 0>
+  typename std::enable_if<(I < sizeof...(Layers)), size_t>::type WeightSize();
+  template<size_t I = 0>
+  typename std::enable_if<I == sizeof...(Layers), size_t>::type WeightSize()
+  { return 0; }
+
+  /**
+   * Return true if every layer, starting at the layer of the given index, can
+   * process a batch of points at once.
+   */
+  template<size_t I = 0>
+  typename std::enable_if<(I < sizeof...(Layers)), bool>::type BatchSupport();
+  template<size_t I = 0>
+  typename std::enable_if<I == sizeof...(Layers), bool>::type BatchSupport()
+  { return true; }
+
+  /**
+   * Prepare the network for the given data.
+   *
+   * @param predictors Input data variables.
+   * @param responses Outputs results from input data variables.
+   */
+  void ResetData(arma::mat predictors, arma::mat responses);
+
+  /**
+   * Reset the module status by setting the current deterministic parameter
+   * for all modules that implement the Deterministic function.
+   */
+  void ResetDeterministic();
+
+  //! Instantiated outputlayer used to evaluate the network.
+  OutputLayerType outputLayer;
+
+  //! Instantiated InitializationRule object for initializing the network
+  //! parameter.
+  InitializationRuleType initializeRule;
+
+  //! The layers of the network.
+  std::tuple<Layers...> network;
+
+  //! The offset of the weights of each layer in the parameter matrix.
+  std::array<size_t, sizeof...(Layers)> offsets;
+
+  //! The input width.
+  size_t width;
+
+  //! The input height.
+  size_t height;
+
+  //! Indicator if the input width and height have been passed through the
+  //! network.
+  bool reset;
+
+  //! The matrix of data points (predictors).
+  arma::mat predictors;
+
+  //! The matrix of responses to the input data points.
+  arma::mat responses;
+
+  //! Matrix of (trained) parameters.
+  arma::mat parameter;
+
+  //! The number of separable functions (the number of predictor points).
+  size_t numFunctions;
+
+  //! The current error for the backward pass.
+  arma::mat error;
+
+  //! The current input of the forward/backward pass.
+  arma::mat currentInput;
+
+  //! The current target of the forward/backward pass.
+  arma::mat currentTarget;
+
+  //! The current evaluation mode (training or testing).
+  bool deterministic;
+}; // class StaticFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "static_ffn_impl.hpp"
+
+#endif
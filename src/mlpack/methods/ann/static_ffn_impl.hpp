@@ -0,0 +1,466 @@
+/**
+ * @file static_ffn_impl.hpp
+ *
+ * Implementation of the StaticFFN class, a feed forward network whose layer
+ * types are fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "static_ffn.hpp"
+
+#include "visitor/deterministic_set_visitor.hpp"
+#include "visitor/gradient_set_visitor.hpp"
+#include "visitor/gradient_visitor.hpp"
+#include "visitor/reset_visitor.hpp"
+#include "visitor/set_input_height_visitor.hpp"
+#include "visitor/set_input_width_visitor.hpp"
+#include "visitor/weight_set_visitor.hpp"
+#include "visitor/weight_size_visitor.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+const size_t StaticFFN<OutputLayerType, InitializationRuleType,
+    Layers...>::NumLayers;
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    Layers... layers) :
+    network(std::move(layers)...),
+    width(0),
+    height(0),
+    reset(false),
+    numFunctions(0),
+    deterministic(true)
+{
+  offsets.fill(0);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    OutputLayerType outputLayer,
+    InitializationRuleType initializeRule,
+    Layers... layers) :
+    outputLayer(std::move(outputLayer)),
+    initializeRule(std::move(initializeRule)),
+    network(std::move(layers)...),
+    width(0),
+    height(0),
+    reset(false),
+    numFunctions(0),
+    deterministic(true)
+{
+  offsets.fill(0);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    const StaticFFN& network) :
+    outputLayer(network.outputLayer),
+    initializeRule(network.initializeRule),
+    network(network.network),
+    offsets(network.offsets),
+    width(network.width),
+    height(network.height),
+    reset(network.reset),
+    predictors(network.predictors),
+    responses(network.responses),
+    parameter(network.parameter),
+    numFunctions(network.numFunctions),
+    deterministic(network.deterministic)
+{
+  // The copied layers hold their own weights, so point them to the copied
+  // parameters.
+  if (!parameter.is_empty())
+    ResetWeights();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::operator=(
+    const StaticFFN& network)
+{
+  if (this != &network)
+  {
+    outputLayer = network.outputLayer;
+    initializeRule = network.initializeRule;
+    this->network = network.network;
+    offsets = network.offsets;
+    width = network.width;
+    height = network.height;
+    reset = network.reset;
+    predictors = network.predictors;
+    responses = network.responses;
+    parameter = network.parameter;
+    numFunctions = network.numFunctions;
+    deterministic = network.deterministic;
+
+    if (!parameter.is_empty())
+      ResetWeights();
+  }
+
+  return *this;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::ResetData(
+    arma::mat predictors, arma::mat responses)
+{
+  numFunctions = responses.n_cols;
+  this->predictors = std::move(predictors);
+  this->responses = std::move(responses);
+  this->deterministic = true;
+  ResetDeterministic();
+
+  if (parameter.is_empty())
+    ResetParameters();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<
+    template<typename, typename...> class OptimizerType,
+    typename... OptimizerTypeArgs
+>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+      arma::mat predictors,
+      arma::mat responses,
+      OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer)
+{
+  ResetData(std::move(predictors), std::move(responses));
+
+  // Train the model.
+  Timer::Start("ffn_optimization");
+  const double out = optimizer.Optimize(*this, parameter);
+  Timer::Stop("ffn_optimization");
+
+  Log::Info << "StaticFFN::StaticFFN(): final objective of trained model is "
+      << out << "." << std::endl;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<template<typename...> class OptimizerType>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+    arma::mat predictors, arma::mat responses)
+{
+  ResetData(std::move(predictors), std::move(responses));
+
+  OptimizerType<decltype(*this)> optimizer(*this);
+
+  // Train the model.
+  Timer::Start("ffn_optimization");
+  const double out = optimizer.Optimize(*this, parameter);
+  Timer::Stop("ffn_optimization");
+
+  Log::Info << "StaticFFN::StaticFFN(): final objective of trained model is "
+      << out << "." << std::endl;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Predict(
+    const arma::mat& predictors, arma::mat& results, const size_t batchSize)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  const size_t step = BatchSupport() ? std::max(batchSize, (size_t) 1) : 1;
+  for (size_t begin = 0; begin < predictors.n_cols; begin += step)
+  {
+    const size_t end = std::min(begin + step, (size_t) predictors.n_cols) - 1;
+
+    // Pass an alias of the batch through the network; the layers only read
+    // their input.
+    currentInput = arma::mat(const_cast<double*>(predictors.colptr(begin)),
+        predictors.n_rows, end - begin + 1, false, true);
+    Forward();
+
+    const arma::mat& output = std::get<NumLayers - 1>(network)
+        .OutputParameter();
+    if (begin == 0)
+      results.set_size(output.n_rows, predictors.n_cols);
+
+    results.cols(begin, end) = output;
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const arma::mat& parameters, const size_t i, const bool deterministic)
+{
+  return Evaluate(parameters, i, 1, deterministic);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    const bool deterministic)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (deterministic != this->deterministic)
+  {
+    this->deterministic = deterministic;
+    ResetDeterministic();
+  }
+
+  if (batchSize > 1 && !BatchSupport())
+  {
+    double res = 0;
+    for (size_t i = begin; i < begin + batchSize; ++i)
+      res += Evaluate(parameters, i, 1, deterministic);
+
+    return res;
+  }
+
+  currentInput = predictors.cols(begin, begin + batchSize - 1);
+  currentTarget = responses.cols(begin, begin + batchSize - 1);
+
+  Forward();
+  return outputLayer.Forward(std::move(std::get<NumLayers - 1>(network)
+      .OutputParameter()), std::move(currentTarget));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient(
+    const arma::mat& parameters, const size_t i, arma::mat& gradient)
+{
+  Gradient(parameters, i, gradient, 1);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize)
+{
+  if (batchSize > 1 && !BatchSupport())
+  {
+    Gradient(parameters, begin, gradient, 1);
+
+    arma::mat pointGradient;
+    for (size_t i = begin + 1; i < begin + batchSize; ++i)
+    {
+      Gradient(parameters, i, pointGradient, 1);
+      gradient += pointGradient;
+    }
+
+    return;
+  }
+
+  if (parameter.is_empty())
+    ResetParameters();
+
+  gradient.zeros(parameter.n_rows, parameter.n_cols);
+
+  Evaluate(parameters, begin, batchSize, false);
+
+  outputLayer.Backward(std::move(std::get<NumLayers - 1>(network)
+      .OutputParameter()), std::move(currentTarget), std::move(error));
+
+  Backward();
+  ResetGradients(gradient);
+  Gradient();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+ResetParameters()
+{
+  ResetDeterministic();
+
+  // Initialize the weights of each layer with the given initialization rule,
+  // like NetworkInitialization does.
+  parameter.set_size(WeightSize(), 1);
+  if (ann::InitTraits<InitializationRuleType>::UseLayer)
+  {
+    ResetWeights();
+    for (size_t i = 0; i < NumLayers; ++i)
+    {
+      const size_t end = (i + 1 < NumLayers) ? offsets[i + 1] :
+          parameter.n_elem;
+      arma::mat tmp(parameter.memptr() + offsets[i], end - offsets[i], 1,
+          false, false);
+      initializeRule.Initialize(tmp, tmp.n_elem, 1);
+    }
+  }
+  else
+  {
+    initializeRule.Initialize(parameter, parameter.n_elem, 1);
+  }
+
+  ResetWeights();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+ResetDeterministic()
+{
+  Apply(DeterministicSetVisitor<arma::mat>(deterministic));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Forward()
+{
+  auto& layer = std::get<I>(network);
+
+  // The input width and height only have to be passed through the network
+  // once.
+  if (!reset)
+  {
+    if (I > 0)
+    {
+      SetInputWidthVisitor<arma::mat>(width)(&layer);
+      SetInputHeightVisitor<arma::mat>(height)(&layer);
+    }
+
+    if (OutputWidthVisitor<arma::mat>()(&layer) != 0)
+      width = OutputWidthVisitor<arma::mat>()(&layer);
+
+    if (OutputHeightVisitor<arma::mat>()(&layer) != 0)
+      height = OutputHeightVisitor<arma::mat>()(&layer);
+
+    if (I + 1 == NumLayers)
+      reset = true;
+  }
+
+  layer.Forward(std::move(LayerInput<I>()), std::move(layer.OutputParameter()));
+  Forward<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I > 0), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Backward()
+{
+  auto& layer = std::get<I>(network);
+  layer.Backward(std::move(layer.OutputParameter()),
+      std::move(LayerError<I>()), std::move(layer.Delta()));
+  Backward<I - 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient()
+{
+  GradientVisitor<arma::mat>(std::move(LayerInput<I>()),
+      std::move(LayerError<I>()))(&std::get<I>(network));
+  Gradient<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::ResetWeights(
+    const size_t offset)
+{
+  auto& layer = std::get<I>(network);
+  offsets[I] = offset;
+  const size_t weights = WeightSetVisitor<arma::mat>(std::move(parameter),
+      offset)(&layer);
+  ResetVisitor<arma::mat>()(&layer);
+  ResetWeights<I + 1>(offset + weights);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::ResetGradients(
+    arma::mat& gradient)
+{
+  GradientSetVisitor<arma::mat>(std::move(gradient), offsets[I])(
+      &std::get<I>(network));
+  ResetGradients<I + 1>(gradient);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename VisitorType, size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Apply(
+    const VisitorType& visitor)
+{
+  visitor(&std::get<I>(network));
+  Apply<VisitorType, I + 1>(visitor);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::WeightSize()
+{
+  return WeightSizeVisitor<arma::mat>()(&std::get<I>(network)) +
+      WeightSize<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), bool>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::BatchSupport()
+{
+  return BatchSupportVisitor()(&std::get<I>(network)) && BatchSupport<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename Archive>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(parameter, "parameter");
+  ar & data::CreateNVP(width, "width");
+  ar & data::CreateNVP(height, "height");
+
+  // If we are loading, we need to point the layers to the loaded weights.
+  if (Archive::is_loading::value)
+  {
+    reset = false;
+    ResetWeights();
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -23,7 +23,10 @@ namespace ann {
 
 /**
  * AddVisitor exposes the Add() method of the given module.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class AddVisitor : public boost::static_visitor<void>
 {
  public:
@@ -37,18 +40,18 @@ class AddVisitor : public boost::static_visitor<void>
 
  private:
   //! The layer that should be added.
-  LayerTypes newLayer;
+  LayerTypes<MatType> newLayer;
 
   //! Only add the layer if the module implements the Add() function.
   template<typename T>
   typename std::enable_if<
-      HasAddCheck<T, void(T::*)(LayerTypes)>::value, void>::type
+      HasAddCheck<T, void(T::*)(LayerTypes<MatType>)>::value, void>::type
   LayerAdd(T* layer) const;
 
   //! Do not add the layer if the module doesn't implement the Add() function.
   template<typename T>
   typename std::enable_if<
-      !HasAddCheck<T, void(T::*)(LayerTypes)>::value, void>::type
+      !HasAddCheck<T, void(T::*)(LayerTypes<MatType>)>::value, void>::type
   LayerAdd(T* layer) const;
 };
 
@@ -0,0 +1,101 @@
+/**
+ * @file alias_check_visitor.hpp
+ *
+ * This file provides a debugging check that every module works on views of the
+ * network parameters and gradient, instead of on its own copies.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_ALIAS_CHECK_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_ALIAS_CHECK_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * AliasCheckVisitor checks (with Log::Assert()) that the parameters and the
+ * gradient of the visited module, and of all its sub-modules, point into the
+ * given parameter and gradient matrices at the expected offsets, as set by
+ * WeightSetVisitor and GradientSetVisitor.  A module that reallocated one of
+ * them (for instance by assigning a matrix of another size) would silently
+ * train its own copy, so this is checked in debug builds.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
+ */
+template<typename MatType = arma::mat>
+class AliasCheckVisitor : public boost::static_visitor<size_t>
+{
+ public:
+  //! Check the module against the given parameters, gradient and offset.
+  AliasCheckVisitor(MatType&& weight,
+                    MatType&& gradient,
+                    const size_t offset = 0);
+
+  //! Check the module, and return the number of parameters it holds.
+  template<typename LayerType>
+  size_t operator()(LayerType* layer) const;
+
+ private:
+  //! The parameters set.
+  MatType&& weight;
+
+  //! The gradient set.
+  MatType&& gradient;
+
+  //! The parameter offset.
+  size_t offset;
+
+  //! Check the parameters if the module implements the Parameters() function.
+  template<typename T>
+  typename std::enable_if<
+      HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  CheckParameters(T* layer) const;
+
+  //! Nothing to check if the module doesn't implement Parameters().
+  template<typename T>
+  typename std::enable_if<
+      !HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  CheckParameters(T* layer) const;
+
+  //! Check the gradient if the module implements the Gradient() function.
+  template<typename T>
+  typename std::enable_if<
+      HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+  CheckGradient(T* layer) const;
+
+  //! Nothing to check if the module doesn't implement Gradient().
+  template<typename T>
+  typename std::enable_if<
+      !HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+  CheckGradient(T* layer) const;
+
+  //! Check the sub-modules if the module implements the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
+  CheckModel(T* layer, const size_t modelOffset) const;
+
+  //! Nothing to check if the module doesn't implement Model().
+  template<typename T>
+  typename std::enable_if<
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
+  CheckModel(T* layer, const size_t modelOffset) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "alias_check_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * @file alias_check_visitor_impl.hpp
+ *
+ * Implementation of the parameter and gradient alias check.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_ALIAS_CHECK_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_ALIAS_CHECK_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "alias_check_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! AliasCheckVisitor visitor class.
+template<typename MatType>
+inline AliasCheckVisitor<MatType>::AliasCheckVisitor(MatType&& weight,
+                                                     MatType&& gradient,
+                                                     const size_t offset) :
+    weight(std::move(weight)),
+    gradient(std::move(gradient)),
+    offset(offset)
+{
+  /* Nothing to do here. */
+}
+
+template<typename MatType>
+template<typename LayerType>
+inline size_t AliasCheckVisitor<MatType>::operator()(LayerType* layer) const
+{
+  const size_t size = CheckParameters(layer);
+  CheckGradient(layer);
+
+  return size + CheckModel(layer, size);
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+AliasCheckVisitor<MatType>::CheckParameters(T* layer) const
+{
+  if (layer->Parameters().n_elem > 0)
+  {
+    Log::Assert(layer->Parameters().memptr() == weight.memptr() + offset,
+        "module parameters are not a view of the network parameters");
+  }
+
+  return layer->Parameters().n_elem;
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    !HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+AliasCheckVisitor<MatType>::CheckParameters(T* /* layer */) const
+{
+  return 0;
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+AliasCheckVisitor<MatType>::CheckGradient(T* layer) const
+{
+  if (layer->Gradient().n_elem > 0)
+  {
+    Log::Assert(layer->Gradient().memptr() == gradient.memptr() + offset,
+        "module gradient is not a view of the network gradient");
+  }
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    !HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+AliasCheckVisitor<MatType>::CheckGradient(T* /* layer */) const
+{
+  /* Nothing to do here. */
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+AliasCheckVisitor<MatType>::CheckModel(T* layer,
+                                       const size_t modelOffset) const
+{
+  size_t size = 0;
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    size += boost::apply_visitor(AliasCheckVisitor<MatType>(std::move(weight),
+        std::move(gradient), offset + modelOffset + size), layer->Model()[i]);
+  }
+
+  return size;
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+AliasCheckVisitor<MatType>::CheckModel(T* /* layer */,
+                                       const size_t /* modelOffset */) const
+{
+  return 0;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -24,13 +24,16 @@ namespace ann {
 /**
  * BackwardVisitor executes the Backward() function given the input, error and
  * delta parameter.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class BackwardVisitor : public boost::static_visitor<void>
 {
  public:
   //! Execute the Backward() function given the input, error and delta
   //! parameter.
-  BackwardVisitor(arma::mat&& input, arma::mat&& error, arma::mat&& delta);
+  BackwardVisitor(MatType&& input, MatType&& error, MatType&& delta);
 
   //! Execute the Backward() function.
   template<typename LayerType>
@@ -38,13 +41,13 @@ class BackwardVisitor : public boost::static_visitor<void>
 
  private:
   //! The input parameter set.
-  arma::mat&& input;
+  MatType&& input;
 
   //! The error parameter.
-  arma::mat&& error;
+  MatType&& error;
 
   //! The delta parameter.
-  arma::mat&& delta;
+  MatType&& delta;
 };
 
 } // namespace ann
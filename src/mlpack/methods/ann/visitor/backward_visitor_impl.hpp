@@ -19,9 +19,10 @@ namespace mlpack {
 namespace ann {
 
 //! BackwardVisitor visitor class.
-inline BackwardVisitor::BackwardVisitor(arma::mat&& input,
-                                        arma::mat&& error,
-                                        arma::mat&& delta) :
+template<typename MatType>
+inline BackwardVisitor<MatType>::BackwardVisitor(MatType&& input,
+                                                 MatType&& error,
+                                                 MatType&& delta) :
   input(std::move(input)),
   error(std::move(error)),
   delta(std::move(delta))
@@ -29,8 +30,9 @@ inline BackwardVisitor::BackwardVisitor(arma::mat&& input,
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void BackwardVisitor::operator()(LayerType* layer) const
+inline void BackwardVisitor<MatType>::operator()(LayerType* layer) const
 {
   layer->Backward(std::move(input), std::move(error), std::move(delta));
 }
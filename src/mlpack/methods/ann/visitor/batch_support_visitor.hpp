@@ -0,0 +1,92 @@
+/**
+ * @file batch_support_visitor.hpp
+ *
+ * This file provides an abstraction that tells whether a given layer is able
+ * to process a batch of points (one point per column) in a single Forward(),
+ * Backward() and Gradient() call.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_BATCH_SUPPORT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_BATCH_SUPPORT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * BatchSupportVisitor returns true if the given module can process a batch of
+ * points at once, where the gradient of a batch is the sum of the gradients of
+ * each point in the batch.  Modules that only handle one point at a time (like
+ * Convolution or LSTM) return false.
+ */
+class BatchSupportVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Return false for modules that only handle one point at a time.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  //! Activation function modules work element-wise.
+  template<typename ActivationFunction,
+           typename InputDataType,
+           typename OutputDataType>
+  bool operator()(
+      BaseLayer<ActivationFunction, InputDataType, OutputDataType>* layer)
+      const;
+
+  //! Return true for the Linear module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(Linear<InputDataType, OutputDataType>* layer) const;
+
+  //! Return true for the LinearNoBias module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(LinearNoBias<InputDataType, OutputDataType>* layer) const;
+
+  //! Return true for the SparseLinear module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(SparseLinear<InputDataType, OutputDataType>* layer) const;
+
+  //! Return true for the Dropout module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(Dropout<InputDataType, OutputDataType>* layer) const;
+
+  //! Return true for the FastLSTM module; each column is one sequence.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(FastLSTM<InputDataType, OutputDataType>* layer) const;
+
+  //! Return true for the ELU module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(ELU<InputDataType, OutputDataType>* layer) const;
+
+  //! Return true for the HardTanH module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(HardTanH<InputDataType, OutputDataType>* layer) const;
+
+  //! Return true for the LeakyReLU module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(LeakyReLU<InputDataType, OutputDataType>* layer) const;
+
+  //! Return true for the LogSoftMax module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(LogSoftMax<InputDataType, OutputDataType>* layer) const;
+
+  //! Return true for the MultiplyConstant module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(MultiplyConstant<InputDataType, OutputDataType>* layer)
+      const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "batch_support_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * @file batch_support_visitor_impl.hpp
+ *
+ * Implementation of the batch support layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_BATCH_SUPPORT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_BATCH_SUPPORT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "batch_support_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! BatchSupportVisitor visitor class.
+template<typename LayerType>
+inline bool BatchSupportVisitor::operator()(LayerType* /* layer */) const
+{
+  return false;
+}
+
+template<typename ActivationFunction,
+         typename InputDataType,
+         typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    BaseLayer<ActivationFunction, InputDataType, OutputDataType>* /* layer */)
+    const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    Linear<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    LinearNoBias<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    SparseLinear<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    Dropout<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    FastLSTM<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    ELU<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    HardTanH<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    LeakyReLU<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    LogSoftMax<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchSupportVisitor::operator()(
+    MultiplyConstant<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
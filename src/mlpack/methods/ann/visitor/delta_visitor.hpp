@@ -23,13 +23,16 @@ namespace ann {
 
 /**
  * DeltaVisitor exposes the delta parameter of the given module.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
-class DeltaVisitor : public boost::static_visitor<arma::mat&>
+template<typename MatType = arma::mat>
+class DeltaVisitor : public boost::static_visitor<MatType&>
 {
  public:
   //! Return the delta parameter.
   template<typename LayerType>
-  arma::mat& operator()(LayerType* layer) const;
+  MatType& operator()(LayerType* layer) const;
 };
 
 } // namespace ann
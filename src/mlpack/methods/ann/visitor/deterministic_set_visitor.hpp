@@ -25,7 +25,10 @@ namespace ann {
 /**
  * DeterministicSetVisitor set the deterministic parameter given the
  * deterministic value.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class DeterministicSetVisitor : public boost::static_visitor<void>
 {
  public:
@@ -45,7 +48,8 @@ class DeterministicSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   LayerDeterministic(T* layer) const;
 
   //! Set the deterministic parameter if the module implements the
@@ -53,7 +57,8 @@ class DeterministicSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   LayerDeterministic(T* layer) const;
 
   //! Set the deterministic parameter if the module implements the
@@ -61,7 +66,8 @@ class DeterministicSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   LayerDeterministic(T* layer) const;
 
   //! Do not set the deterministic parameter if the module doesn't implement the
@@ -69,7 +75,8 @@ class DeterministicSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   LayerDeterministic(T* layer) const;
 };
 
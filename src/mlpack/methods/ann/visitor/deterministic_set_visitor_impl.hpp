@@ -19,60 +19,70 @@ namespace mlpack {
 namespace ann {
 
 //! DeterministicSetVisitor visitor class.
-inline DeterministicSetVisitor::DeterministicSetVisitor(
+template<typename MatType>
+inline DeterministicSetVisitor<MatType>::DeterministicSetVisitor(
     const bool deterministic) : deterministic(deterministic)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void DeterministicSetVisitor::operator()(LayerType* layer) const
+inline void DeterministicSetVisitor<MatType>::operator()(LayerType* layer) const
 {
   LayerDeterministic(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-DeterministicSetVisitor::LayerDeterministic(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+DeterministicSetVisitor<MatType>::LayerDeterministic(T* layer) const
 {
   layer->Deterministic() = deterministic;
 
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(DeterministicSetVisitor(deterministic),
+    boost::apply_visitor(DeterministicSetVisitor<MatType>(deterministic),
         layer->Model()[i]);
   }
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-DeterministicSetVisitor::LayerDeterministic(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+DeterministicSetVisitor<MatType>::LayerDeterministic(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(DeterministicSetVisitor(deterministic),
+    boost::apply_visitor(DeterministicSetVisitor<MatType>(deterministic),
         layer->Model()[i]);
   }
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-DeterministicSetVisitor::LayerDeterministic(T* layer) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+DeterministicSetVisitor<MatType>::LayerDeterministic(T* layer) const
 {
   layer->Deterministic() = deterministic;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-DeterministicSetVisitor::LayerDeterministic(T* /* input */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+DeterministicSetVisitor<MatType>::LayerDeterministic(T* /* input */) const
 {
   /* Nothing to do here. */
 }
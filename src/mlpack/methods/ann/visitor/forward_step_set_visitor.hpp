@@ -0,0 +1,73 @@
+/**
+ * @file forward_step_set_visitor.hpp
+ *
+ * This file provides an abstraction to rewind the recurrent modules of a
+ * network to a given step of the current sequences.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_FORWARD_STEP_SET_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_FORWARD_STEP_SET_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * ForwardStepSetVisitor sets the step of the sequences that the next Forward()
+ * call of a FastLSTM module computes, so that a step can be computed again
+ * from the state the module kept (see RecomputeSupportVisitor).  Modules
+ * without recurrent state are left alone, and the modules held by a module are
+ * visited too.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
+ */
+template<typename MatType = arma::mat>
+class ForwardStepSetVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Set the forward step to the given step.
+  ForwardStepSetVisitor(const size_t step);
+
+  //! Set the forward step of the modules the module holds, if any.
+  template<typename LayerType>
+  void operator()(LayerType* layer) const;
+
+  //! Set the forward step of the FastLSTM module.
+  template<typename InputDataType, typename OutputDataType>
+  void operator()(FastLSTM<InputDataType, OutputDataType>* layer) const;
+
+ private:
+  //! The step to set.
+  const size_t step;
+
+  //! Set the forward step of the modules held by the module, if it implements
+  //! the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
+  LayerForwardStep(T* layer) const;
+
+  //! Do nothing if the module doesn't implement the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
+  LayerForwardStep(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "forward_step_set_visitor_impl.hpp"
+
+#endif
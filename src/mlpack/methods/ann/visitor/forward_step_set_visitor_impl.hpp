@@ -0,0 +1,70 @@
+/**
+ * @file forward_step_set_visitor_impl.hpp
+ *
+ * Implementation of the forward step set layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_FORWARD_STEP_SET_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_FORWARD_STEP_SET_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "forward_step_set_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! ForwardStepSetVisitor visitor class.
+template<typename MatType>
+inline ForwardStepSetVisitor<MatType>::ForwardStepSetVisitor(
+    const size_t step) : step(step)
+{
+  /* Nothing to do here. */
+}
+
+template<typename MatType>
+template<typename LayerType>
+inline void ForwardStepSetVisitor<MatType>::operator()(LayerType* layer) const
+{
+  LayerForwardStep(layer);
+}
+
+template<typename MatType>
+template<typename InputDataType, typename OutputDataType>
+inline void ForwardStepSetVisitor<MatType>::operator()(
+    FastLSTM<InputDataType, OutputDataType>* layer) const
+{
+  layer->ForwardStep() = step;
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+ForwardStepSetVisitor<MatType>::LayerForwardStep(T* layer) const
+{
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    boost::apply_visitor(ForwardStepSetVisitor<MatType>(step),
+        layer->Model()[i]);
+  }
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+ForwardStepSetVisitor<MatType>::LayerForwardStep(T* /* layer */) const
+{
+  /* Nothing to do here. */
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -23,12 +23,15 @@ namespace ann {
 
 /**
  * GradientSetVisitor update the gradient parameter given the gradient set.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class GradientSetVisitor : public boost::static_visitor<size_t>
 {
  public:
   //! Update the gradient parameter given the gradient set.
-  GradientSetVisitor(arma::mat&& gradient, size_t offset = 0);
+  GradientSetVisitor(MatType&& gradient, size_t offset = 0);
 
   //! Update the gradient parameter.
   template<typename LayerType>
@@ -36,7 +39,7 @@ class GradientSetVisitor : public boost::static_visitor<size_t>
 
  private:
   //! The gradient set.
-  arma::mat&& gradient;
+  MatType&& gradient;
 
   //! The gradient offset.
   size_t offset;
@@ -44,31 +47,35 @@ class GradientSetVisitor : public boost::static_visitor<size_t>
   //! Update the gradient if the module implements the Gradient() function.
   template<typename T>
   typename std::enable_if<
-      HasGradientCheck<T, arma::mat&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+      HasGradientCheck<T, MatType&(T::*)()>::value &&
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Update the gradient if the module implements the Model() function.
   template<typename T>
   typename std::enable_if<
-      !HasGradientCheck<T, arma::mat&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+      !HasGradientCheck<T, MatType&(T::*)()>::value &&
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Update the gradient if the module implements the Gradient() and Model()
   //! function.
   template<typename T>
   typename std::enable_if<
-      HasGradientCheck<T, arma::mat&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+      HasGradientCheck<T, MatType&(T::*)()>::value &&
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Do not update the gradient parameter if the module doesn't implement the
   //! Gradient() or Model() function.
   template<typename T, typename P>
   typename std::enable_if<
       !HasGradientCheck<T, P&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerGradients(T* layer, P& input) const;
 };
 
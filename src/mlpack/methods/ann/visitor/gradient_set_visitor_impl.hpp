@@ -19,72 +19,86 @@ namespace mlpack {
 namespace ann {
 
 //! GradientSetVisitor visitor class.
-inline GradientSetVisitor::GradientSetVisitor(arma::mat&& gradient,
-                                              size_t offset) :
+template<typename MatType>
+inline GradientSetVisitor<MatType>::GradientSetVisitor(MatType&& gradient,
+                                                       size_t offset) :
     gradient(std::move(gradient)),
     offset(offset)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline size_t GradientSetVisitor::operator()(LayerType* layer) const
+inline size_t GradientSetVisitor<MatType>::operator()(LayerType* layer) const
 {
   return LayerGradients(layer, layer->OutputParameter());
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    HasGradientCheck<T, arma::mat&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-GradientSetVisitor::LayerGradients(T* layer, arma::mat& /* input */) const
+    HasGradientCheck<T, MatType&(T::*)()>::value &&
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+GradientSetVisitor<MatType>::LayerGradients(T* layer,
+                                            MatType& /* input */) const
 {
-  layer->Gradient() = arma::mat(gradient.memptr() + offset,
+  layer->Gradient() = MatType(gradient.memptr() + offset,
       layer->Parameters().n_rows, layer->Parameters().n_cols, false, false);
 
   return layer->Parameters().n_elem;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    !HasGradientCheck<T, arma::mat&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-GradientSetVisitor::LayerGradients(T* layer, arma::mat& /* input */) const
+    !HasGradientCheck<T, MatType&(T::*)()>::value &&
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+GradientSetVisitor<MatType>::LayerGradients(T* layer,
+                                            MatType& /* input */) const
 {
   size_t modelOffset = 0;
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    modelOffset += boost::apply_visitor(GradientSetVisitor(
+    modelOffset += boost::apply_visitor(GradientSetVisitor<MatType>(
         std::move(gradient), modelOffset + offset), layer->Model()[i]);
   }
 
   return modelOffset;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    HasGradientCheck<T, arma::mat&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-GradientSetVisitor::LayerGradients(T* layer, arma::mat& /* input */) const
+    HasGradientCheck<T, MatType&(T::*)()>::value &&
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+GradientSetVisitor<MatType>::LayerGradients(T* layer,
+                                            MatType& /* input */) const
 {
-  layer->Gradient() = arma::mat(gradient.memptr() + offset,
+  layer->Gradient() = MatType(gradient.memptr() + offset,
       layer->Parameters().n_rows, layer->Parameters().n_cols, false, false);
 
   size_t modelOffset = layer->Parameters().n_elem;
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    modelOffset += boost::apply_visitor(GradientSetVisitor(
+    modelOffset += boost::apply_visitor(GradientSetVisitor<MatType>(
         std::move(gradient), modelOffset + offset), layer->Model()[i]);
   }
 
   return modelOffset;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasGradientCheck<T, P&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-GradientSetVisitor::LayerGradients(T* /* layer */, P& /* input */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+GradientSetVisitor<MatType>::LayerGradients(T* /* layer */,
+                                            P& /* input */) const
 {
   return 0;
 }
@@ -24,13 +24,16 @@ namespace ann {
 /**
  * SearchModeVisitor executes the Gradient() method of the given module using
  * the input and delta parameter.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class GradientVisitor : public boost::static_visitor<void>
 {
  public:
   //! Executes the Gradient() method of the given module using the input and
   //! delta parameter.
-  GradientVisitor(arma::mat&& input, arma::mat&& delta);
+  GradientVisitor(MatType&& input, MatType&& delta);
 
   //! Executes the Gradient() method.
   template<typename LayerType>
@@ -38,17 +41,17 @@ class GradientVisitor : public boost::static_visitor<void>
 
  private:
   //! The input set.
-  arma::mat&& input;
+  MatType&& input;
 
   //! The delta parameter.
-  arma::mat&& delta;
+  MatType&& delta;
 
   //! Execute the Gradient() function if the module implements the Gradient()
   //! function.
   template<typename T>
   typename std::enable_if<
-      HasGradientCheck<T, arma::mat&(T::*)()>::value, void>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+      HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Do not execute the Gradient() function if the module doesn't implement
   //! the Gradient() function.
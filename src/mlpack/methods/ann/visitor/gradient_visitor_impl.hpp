@@ -19,32 +19,37 @@ namespace mlpack {
 namespace ann {
 
 //! GradientVisitor visitor class.
-inline GradientVisitor::GradientVisitor(arma::mat&& input, arma::mat&& delta) :
+template<typename MatType>
+inline GradientVisitor<MatType>::GradientVisitor(MatType&& input,
+                                                 MatType&& delta) :
     input(std::move(input)),
     delta(std::move(delta))
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void GradientVisitor::operator()(LayerType* layer) const
+inline void GradientVisitor<MatType>::operator()(LayerType* layer) const
 {
   LayerGradients(layer, layer->OutputParameter());
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    HasGradientCheck<T, arma::mat&(T::*)()>::value, void>::type
-GradientVisitor::LayerGradients(T* layer, arma::mat& /* input */) const
+    HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+GradientVisitor<MatType>::LayerGradients(T* layer, MatType& /* input */) const
 {
   layer->Gradient(std::move(input), std::move(delta),
       std::move(layer->Gradient()));
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasGradientCheck<T, P&(T::*)()>::value, void>::type
-GradientVisitor::LayerGradients(T* /* layer */, P& /* input */) const
+GradientVisitor<MatType>::LayerGradients(T* /* layer */, P& /* input */) const
 {
   /* Nothing to do here. */
 }
@@ -19,29 +19,35 @@ namespace mlpack {
 namespace ann {
 
 //! GradientZeroVisitor visitor class.
-inline GradientZeroVisitor::GradientZeroVisitor()
+template<typename MatType>
+inline GradientZeroVisitor<MatType>::GradientZeroVisitor()
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void GradientZeroVisitor::operator()(LayerType* layer) const
+inline void GradientZeroVisitor<MatType>::operator()(LayerType* layer) const
 {
   LayerGradients(layer, layer->OutputParameter());
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    HasGradientCheck<T, arma::mat&(T::*)()>::value, void>::type
-GradientZeroVisitor::LayerGradients(T* layer, arma::mat& /* input */) const
+    HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+GradientZeroVisitor<MatType>::LayerGradients(T* layer,
+                                             MatType& /* input */) const
 {
   layer->Gradient().zeros();
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasGradientCheck<T, P&(T::*)()>::value, void>::type
-GradientZeroVisitor::LayerGradients(T* /* layer */, P& /* input */) const
+GradientZeroVisitor<MatType>::LayerGradients(T* /* layer */,
+                                             P& /* input */) const
 {
   /* Nothing to do here. */
 }
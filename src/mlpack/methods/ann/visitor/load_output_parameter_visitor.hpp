@@ -25,12 +25,15 @@ namespace ann {
 /**
  * LoadOutputParameterVisitor restores the output parameter using the given
  * parameter set.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class LoadOutputParameterVisitor : public boost::static_visitor<void>
 {
  public:
   //! Restore the output parameter given a parameter set.
-  LoadOutputParameterVisitor(std::vector<arma::mat>&& parameter);
+  LoadOutputParameterVisitor(std::vector<MatType>&& parameter);
 
   //! Restore the output parameter.
   template<typename LayerType>
@@ -38,20 +41,22 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
 
  private:
   //! The parameter set.
-  std::vector<arma::mat>&& parameter;
+  std::vector<MatType>&& parameter;
 
   //! Restore the output parameter for a module which doesn't implement the
   //! Model() function.
   template<typename T>
   typename std::enable_if<
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   OutputParameter(T* layer) const;
 
   //! Restore the output parameter for a module which implements the Model()
   //! function.
   template<typename T>
   typename std::enable_if<
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   OutputParameter(T* layer) const;
 };
 
@@ -19,36 +19,43 @@ namespace mlpack {
 namespace ann {
 
 //! LoadOutputParameterVisitor visitor class.
-inline LoadOutputParameterVisitor::LoadOutputParameterVisitor(
-    std::vector<arma::mat>&& parameter) : parameter(std::move(parameter))
+template<typename MatType>
+inline LoadOutputParameterVisitor<MatType>::LoadOutputParameterVisitor(
+    std::vector<MatType>&& parameter) : parameter(std::move(parameter))
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void LoadOutputParameterVisitor::operator()(LayerType* layer) const
+inline void LoadOutputParameterVisitor<MatType>::operator()(
+    LayerType* layer) const
 {
   OutputParameter(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-LoadOutputParameterVisitor::OutputParameter(T* layer) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+LoadOutputParameterVisitor<MatType>::OutputParameter(T* layer) const
 {
   layer->OutputParameter() = parameter.back();
   parameter.pop_back();
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-LoadOutputParameterVisitor::OutputParameter(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+LoadOutputParameterVisitor<MatType>::OutputParameter(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(LoadOutputParameterVisitor(std::move(parameter)),
-        layer->Model()[layer->Model().size() - i - 1]);
+    boost::apply_visitor(LoadOutputParameterVisitor<MatType>(
+        std::move(parameter)), layer->Model()[layer->Model().size() - i - 1]);
   }
 
   layer->OutputParameter() = parameter.back();
@@ -24,7 +24,10 @@ namespace ann {
 
 /**
  * OutputWidthVisitor exposes the OutputHeight() method of the given module.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class OutputHeightVisitor : public boost::static_visitor<size_t>
 {
  public:
@@ -38,7 +41,8 @@ class OutputHeightVisitor : public boost::static_visitor<size_t>
   template<typename T>
   typename std::enable_if<
       !HasInputHeight<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerOutputHeight(T* layer) const;
 
   //! Return the output height if the module implements the InputHeight()
@@ -46,14 +50,16 @@ class OutputHeightVisitor : public boost::static_visitor<size_t>
   template<typename T>
   typename std::enable_if<
       HasInputHeight<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerOutputHeight(T* layer) const;
 
   //! Return the output height if the module implements the Model() function.
   template<typename T>
   typename std::enable_if<
       !HasInputHeight<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerOutputHeight(T* layer) const;
 
   //! Return the output height if the module implement the Model() or
@@ -61,7 +67,8 @@ class OutputHeightVisitor : public boost::static_visitor<size_t>
   template<typename T>
   typename std::enable_if<
       HasInputHeight<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerOutputHeight(T* layer) const;
 };
 
@@ -19,39 +19,46 @@ namespace mlpack {
 namespace ann {
 
 //! OutputHeightVisitor visitor class.
+template<typename MatType>
 template<typename LayerType>
-inline size_t OutputHeightVisitor::operator()(LayerType* layer) const
+inline size_t OutputHeightVisitor<MatType>::operator()(LayerType* layer) const
 {
   return LayerOutputHeight(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasInputHeight<T, size_t&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-OutputHeightVisitor::LayerOutputHeight(T* /* layer */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+OutputHeightVisitor<MatType>::LayerOutputHeight(T* /* layer */) const
 {
   return 0;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasInputHeight<T, size_t&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-OutputHeightVisitor::LayerOutputHeight(T* layer) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+OutputHeightVisitor<MatType>::LayerOutputHeight(T* layer) const
 {
   return layer->OutputHeight();
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasInputHeight<T, size_t&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-OutputHeightVisitor::LayerOutputHeight(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+OutputHeightVisitor<MatType>::LayerOutputHeight(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    size_t outputHeight = boost::apply_visitor(OutputHeightVisitor(),
+    size_t outputHeight = boost::apply_visitor(OutputHeightVisitor<MatType>(),
         layer->Model()[layer->Model().size() - 1 - i]);
 
     if (outputHeight != 0)
@@ -63,11 +70,13 @@ OutputHeightVisitor::LayerOutputHeight(T* layer) const
   return 0;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasInputHeight<T, size_t&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-OutputHeightVisitor::LayerOutputHeight(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+OutputHeightVisitor<MatType>::LayerOutputHeight(T* layer) const
 {
   size_t outputHeight = layer->OutputHeight();
 
@@ -75,7 +84,7 @@ OutputHeightVisitor::LayerOutputHeight(T* layer) const
   {
     for (size_t i = 0; i < layer->Model().size(); ++i)
     {
-      outputHeight = boost::apply_visitor(OutputHeightVisitor(),
+      outputHeight = boost::apply_visitor(OutputHeightVisitor<MatType>(),
           layer->Model()[layer->Model().size() - 1 - i]);
 
       if (outputHeight != 0)
@@ -23,13 +23,16 @@ namespace ann {
 
 /**
  * OutputParameterVisitor exposes the output parameter of the given module.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
-class OutputParameterVisitor : public boost::static_visitor<arma::mat&>
+template<typename MatType = arma::mat>
+class OutputParameterVisitor : public boost::static_visitor<MatType&>
 {
  public:
   //! Return the output parameter set.
   template<typename LayerType>
-  arma::mat& operator()(LayerType* layer) const;
+  MatType& operator()(LayerType* layer) const;
 };
 
 } // namespace ann
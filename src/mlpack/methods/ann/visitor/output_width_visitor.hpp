@@ -24,7 +24,10 @@ namespace ann {
 
 /**
  * OutputWidthVisitor exposes the OutputWidth() method of the given module.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class OutputWidthVisitor : public boost::static_visitor<size_t>
 {
  public:
@@ -38,7 +41,8 @@ class OutputWidthVisitor : public boost::static_visitor<size_t>
   template<typename T>
   typename std::enable_if<
       !HasInputWidth<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerOutputWidth(T* layer) const;
 
   //! Return the output width if the module implements the InputWidth()
@@ -46,14 +50,16 @@ class OutputWidthVisitor : public boost::static_visitor<size_t>
   template<typename T>
   typename std::enable_if<
       HasInputWidth<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerOutputWidth(T* layer) const;
 
   //! Return the output width if the module implements the Model() function.
   template<typename T>
   typename std::enable_if<
       !HasInputWidth<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerOutputWidth(T* layer) const;
 
   //! Return the output width if the module implements the Model() or
@@ -61,7 +67,8 @@ class OutputWidthVisitor : public boost::static_visitor<size_t>
   template<typename T>
   typename std::enable_if<
       HasInputWidth<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerOutputWidth(T* layer) const;
 };
 
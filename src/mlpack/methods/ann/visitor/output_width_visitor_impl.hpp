@@ -19,39 +19,46 @@ namespace mlpack {
 namespace ann {
 
 //! OutputWidthVisitor visitor class.
+template<typename MatType>
 template<typename LayerType>
-inline size_t OutputWidthVisitor::operator()(LayerType* layer) const
+inline size_t OutputWidthVisitor<MatType>::operator()(LayerType* layer) const
 {
   return LayerOutputWidth(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasInputWidth<T, size_t&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-OutputWidthVisitor::LayerOutputWidth(T* /* layer */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+OutputWidthVisitor<MatType>::LayerOutputWidth(T* /* layer */) const
 {
   return 0;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasInputWidth<T, size_t&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-OutputWidthVisitor::LayerOutputWidth(T* layer) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+OutputWidthVisitor<MatType>::LayerOutputWidth(T* layer) const
 {
   return layer->OutputWidth();
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasInputWidth<T, size_t&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-OutputWidthVisitor::LayerOutputWidth(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+OutputWidthVisitor<MatType>::LayerOutputWidth(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    size_t outputWidth = boost::apply_visitor(OutputWidthVisitor(),
+    size_t outputWidth = boost::apply_visitor(OutputWidthVisitor<MatType>(),
         layer->Model()[layer->Model().size() - 1 - i]);
 
     if (outputWidth != 0)
@@ -63,11 +70,13 @@ OutputWidthVisitor::LayerOutputWidth(T* layer) const
   return 0;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasInputWidth<T, size_t&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-OutputWidthVisitor::LayerOutputWidth(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+OutputWidthVisitor<MatType>::LayerOutputWidth(T* layer) const
 {
   size_t outputWidth = layer->OutputWidth();
 
@@ -75,7 +84,7 @@ OutputWidthVisitor::LayerOutputWidth(T* layer) const
   {
     for (size_t i = 0; i < layer->Model().size(); ++i)
     {
-      outputWidth = boost::apply_visitor(OutputWidthVisitor(),
+      outputWidth = boost::apply_visitor(OutputWidthVisitor<MatType>(),
           layer->Model()[layer->Model().size() - 1 - i]);
 
       if (outputWidth != 0)
@@ -23,12 +23,15 @@ namespace ann {
 
 /**
  * ParametersSetVisitor update the parameters set using the given matrix.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class ParametersSetVisitor : public boost::static_visitor<void>
 {
  public:
   //! Update the parameters set given the parameters matrix.
-  ParametersSetVisitor(arma::mat&& parameters);
+  ParametersSetVisitor(MatType&& parameters);
 
   //! Update the parameters set.
   template<typename LayerType>
@@ -36,7 +39,7 @@ class ParametersSetVisitor : public boost::static_visitor<void>
 
  private:
   //! The parameters set.
-  arma::mat&& parameters;
+  MatType&& parameters;
 
   //! Do not update the parameters set if the module doesn't implement the
   //! Parameters() function.
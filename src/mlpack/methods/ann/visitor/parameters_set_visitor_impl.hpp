@@ -19,30 +19,36 @@ namespace mlpack {
 namespace ann {
 
 //! ParametersSetVisitor visitor class.
-inline ParametersSetVisitor::ParametersSetVisitor(arma::mat&& parameters) :
+template<typename MatType>
+inline ParametersSetVisitor<MatType>::ParametersSetVisitor(
+    MatType&& parameters) :
     parameters(std::move(parameters))
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void ParametersSetVisitor::operator()(LayerType *layer) const
+inline void ParametersSetVisitor<MatType>::operator()(LayerType *layer) const
 {
   LayerParameters(layer, layer->OutputParameter());
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasParametersCheck<T, P&(T::*)()>::value, void>::type
-ParametersSetVisitor::LayerParameters(T* /* layer */, P& /* output */) const
+ParametersSetVisitor<MatType>::LayerParameters(T* /* layer */,
+                                               P& /* output */) const
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     HasParametersCheck<T, P&(T::*)()>::value, void>::type
-ParametersSetVisitor::LayerParameters(T* layer, P& /* output */) const
+ParametersSetVisitor<MatType>::LayerParameters(T* layer, P& /* output */) const
 {
   layer->Parameters() = parameters;
 }
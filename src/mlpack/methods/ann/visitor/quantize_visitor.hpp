@@ -0,0 +1,68 @@
+/**
+ * @file quantize_visitor.hpp
+ *
+ * This file provides an abstraction that quantizes the weights of a given
+ * layer to int8, for the layers that QuantizedLayer supports.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/layer/quantized_layer.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * QuantizeVisitor stores the int8 version of the given module in a
+ * QuantizedLayer and returns true, if the module is a Linear, LinearNoBias or
+ * Convolution module; for any other module it returns false.  A Convolution
+ * module can only be quantized once its input size is known, that is, after it
+ * has been run.
+ */
+class QuantizeVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Quantize the modules into the given layer.
+  QuantizeVisitor(QuantizedLayer& quantizedLayer);
+
+  //! Return false for the modules that can't be quantized.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  //! Quantize the Linear module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(Linear<InputDataType, OutputDataType>* layer) const;
+
+  //! Quantize the LinearNoBias module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(LinearNoBias<InputDataType, OutputDataType>* layer) const;
+
+  //! Quantize the Convolution module.
+  template<typename ForwardConvolutionRule,
+           typename BackwardConvolutionRule,
+           typename GradientConvolutionRule,
+           typename InputDataType,
+           typename OutputDataType>
+  bool operator()(Convolution<ForwardConvolutionRule, BackwardConvolutionRule,
+      GradientConvolutionRule, InputDataType, OutputDataType>* layer) const;
+
+ private:
+  //! The layer to store the quantized module in.
+  QuantizedLayer& quantizedLayer;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantize_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file quantize_visitor_impl.hpp
+ *
+ * Implementation of the quantize layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantize_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! QuantizeVisitor visitor class.
+inline QuantizeVisitor::QuantizeVisitor(QuantizedLayer& quantizedLayer) :
+    quantizedLayer(quantizedLayer)
+{
+  /* Nothing to do here. */
+}
+
+template<typename LayerType>
+inline bool QuantizeVisitor::operator()(LayerType* /* layer */) const
+{
+  return false;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool QuantizeVisitor::operator()(
+    Linear<InputDataType, OutputDataType>* layer) const
+{
+  typedef typename OutputDataType::elem_type ElemType;
+
+  // The weights are followed by the bias.
+  ElemType* weights = layer->Parameters().memptr();
+  const size_t weightSize = layer->OutputSize() * layer->InputSize();
+  quantizedLayer = QuantizedLayer(arma::Mat<ElemType>(weights,
+      layer->OutputSize(), layer->InputSize(), false, true),
+      arma::Mat<ElemType>(weights + weightSize, layer->OutputSize(), 1, false,
+      true));
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool QuantizeVisitor::operator()(
+    LinearNoBias<InputDataType, OutputDataType>* layer) const
+{
+  typedef typename OutputDataType::elem_type ElemType;
+
+  quantizedLayer = QuantizedLayer(arma::Mat<ElemType>(
+      layer->Parameters().memptr(), layer->OutputSize(), layer->InputSize(),
+      false, true), arma::Mat<ElemType>());
+  return true;
+}
+
+template<typename ForwardConvolutionRule,
+         typename BackwardConvolutionRule,
+         typename GradientConvolutionRule,
+         typename InputDataType,
+         typename OutputDataType>
+inline bool QuantizeVisitor::operator()(
+    Convolution<ForwardConvolutionRule, BackwardConvolutionRule,
+        GradientConvolutionRule, InputDataType, OutputDataType>* layer) const
+{
+  typedef typename OutputDataType::elem_type ElemType;
+
+  if (layer->InputWidth() == 0 || layer->InputHeight() == 0)
+    return false;
+
+  // The filters of each output map follow each other, as Im2Col() lowers the
+  // input maps, and they are followed by the bias.
+  ElemType* weights = layer->Parameters().memptr();
+  const size_t filterSize = layer->KernelWidth() * layer->KernelHeight() *
+      layer->InputSize();
+  quantizedLayer = QuantizedLayer(arma::Mat<ElemType>(weights, filterSize,
+      layer->OutputSize(), false, true), arma::Mat<ElemType>(weights +
+      filterSize * layer->OutputSize(), layer->OutputSize(), 1, false, true),
+      layer->InputWidth(), layer->InputHeight(), layer->KernelWidth(),
+      layer->KernelHeight(), layer->StrideWidth(), layer->StrideHeight(),
+      layer->PadWidth(), layer->PadHeight());
+  return true;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
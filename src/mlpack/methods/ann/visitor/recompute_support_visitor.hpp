@@ -0,0 +1,80 @@
+/**
+ * @file recompute_support_visitor.hpp
+ *
+ * This file provides an abstraction that tells whether the outputs of a given
+ * layer for a step of a sequence can be computed again during the backward
+ * pass through time, instead of being stored during the forward pass.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_RECOMPUTE_SUPPORT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_RECOMPUTE_SUPPORT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * RecomputeSupportVisitor returns true if the Forward() call of the given
+ * module for any step of a sequence can be repeated during the backward pass
+ * through time (see RNN::RecomputeOutputs()).  This is the case for modules
+ * without recurrent state, and for the FastLSTM module, which keeps the state
+ * of every step and can be rewound with ForwardStepSetVisitor.  The LSTM,
+ * Recurrent and RecurrentAttention modules append to their state in each
+ * Forward() call, so they return false; a module that holds other modules
+ * returns true if all of them do.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
+ */
+template<typename MatType = arma::mat>
+class RecomputeSupportVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Return whether the module (and the modules it holds) can be recomputed.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  //! Return false for the LSTM module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(LSTM<InputDataType, OutputDataType>* layer) const;
+
+  //! Return false for the Recurrent module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(Recurrent<InputDataType, OutputDataType>* layer) const;
+
+  //! Return false for the RecurrentAttention module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(RecurrentAttention<InputDataType, OutputDataType>* layer)
+      const;
+
+ private:
+  //! Check the modules held by the module, if it implements the Model()
+  //! function.
+  template<typename T>
+  typename std::enable_if<
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
+  LayerRecompute(T* layer) const;
+
+  //! Return true if the module doesn't implement the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
+  LayerRecompute(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "recompute_support_visitor_impl.hpp"
+
+#endif
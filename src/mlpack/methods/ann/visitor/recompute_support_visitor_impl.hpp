@@ -0,0 +1,83 @@
+/**
+ * @file recompute_support_visitor_impl.hpp
+ *
+ * Implementation of the recompute support layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_RECOMPUTE_SUPPORT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_RECOMPUTE_SUPPORT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "recompute_support_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! RecomputeSupportVisitor visitor class.
+template<typename MatType>
+template<typename LayerType>
+inline bool RecomputeSupportVisitor<MatType>::operator()(
+    LayerType* layer) const
+{
+  return LayerRecompute(layer);
+}
+
+template<typename MatType>
+template<typename InputDataType, typename OutputDataType>
+inline bool RecomputeSupportVisitor<MatType>::operator()(
+    LSTM<InputDataType, OutputDataType>* /* layer */) const
+{
+  return false;
+}
+
+template<typename MatType>
+template<typename InputDataType, typename OutputDataType>
+inline bool RecomputeSupportVisitor<MatType>::operator()(
+    Recurrent<InputDataType, OutputDataType>* /* layer */) const
+{
+  return false;
+}
+
+template<typename MatType>
+template<typename InputDataType, typename OutputDataType>
+inline bool RecomputeSupportVisitor<MatType>::operator()(
+    RecurrentAttention<InputDataType, OutputDataType>* /* layer */) const
+{
+  return false;
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+RecomputeSupportVisitor<MatType>::LayerRecompute(T* layer) const
+{
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    if (!boost::apply_visitor(RecomputeSupportVisitor<MatType>(),
+        layer->Model()[i]))
+      return false;
+  }
+
+  return true;
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+RecomputeSupportVisitor<MatType>::LayerRecompute(T* /* layer */) const
+{
+  return true;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -23,7 +23,10 @@ namespace ann {
 
 /**
  * ResetVisitor executes the Reset() function.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class ResetVisitor : public boost::static_visitor<void>
 {
  public:
@@ -37,7 +40,8 @@ class ResetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasResetCheck<T, void(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   ResetParameter(T* layer) const;
 
   //! Execute the Reset() function for a module which implements the Model()
@@ -45,7 +49,8 @@ class ResetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasResetCheck<T, void(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   ResetParameter(T* layer) const;
 
   //! Execute the Reset() function for a module which implements the Reset()
@@ -53,7 +58,8 @@ class ResetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasResetCheck<T, void(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   ResetParameter(T* layer) const;
 
   //! Do not execute the Reset() function for a module which doesn't implement
@@ -61,7 +67,8 @@ class ResetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasResetCheck<T, void(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   ResetParameter(T* layer) const;
 };
 
@@ -19,52 +19,61 @@ namespace mlpack {
 namespace ann {
 
 //! ResetVisitor visitor class.
+template<typename MatType>
 template<typename LayerType>
-inline void ResetVisitor::operator()(LayerType* layer) const
+inline void ResetVisitor<MatType>::operator()(LayerType* layer) const
 {
   ResetParameter(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasResetCheck<T, void(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-ResetVisitor::ResetParameter(T* layer) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+ResetVisitor<MatType>::ResetParameter(T* layer) const
 {
   layer->Reset();
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasResetCheck<T, void(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-ResetVisitor::ResetParameter(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+ResetVisitor<MatType>::ResetParameter(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(ResetVisitor(), layer->Model()[i]);
+    boost::apply_visitor(ResetVisitor<MatType>(), layer->Model()[i]);
   }
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasResetCheck<T, void(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-ResetVisitor::ResetParameter(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+ResetVisitor<MatType>::ResetParameter(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(ResetVisitor(), layer->Model()[i]);
+    boost::apply_visitor(ResetVisitor<MatType>(), layer->Model()[i]);
   }
 
   layer->Reset();
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasResetCheck<T, void(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-ResetVisitor::ResetParameter(T* /* layer */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+ResetVisitor<MatType>::ResetParameter(T* /* layer */) const
 {
   /* Nothing to do here. */
 }
@@ -23,7 +23,10 @@ namespace ann {
 
 /**
  * RewardSetVisitor set the reward parameter given the reward value.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class RewardSetVisitor : public boost::static_visitor<void>
 {
  public:
@@ -43,7 +46,8 @@ class RewardSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasRewardCheck<T, double&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   LayerReward(T* layer) const;
 
   //! Set the deterministic parameter if the module implements the
@@ -51,7 +55,8 @@ class RewardSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasRewardCheck<T, double&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   LayerReward(T* layer) const;
 
   //! Set the deterministic parameter if the module implements the
@@ -59,7 +64,8 @@ class RewardSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasRewardCheck<T, double&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   LayerReward(T* layer) const;
 
   //! Do not set the deterministic parameter if the module doesn't implement the
@@ -67,7 +73,8 @@ class RewardSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasRewardCheck<T, double&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      void>::type
   LayerReward(T* layer) const;
 };
 
@@ -19,59 +19,70 @@ namespace mlpack {
 namespace ann {
 
 //! RewardSetVisitor visitor class.
-inline RewardSetVisitor::RewardSetVisitor(const double reward) : reward(reward)
+template<typename MatType>
+inline RewardSetVisitor<MatType>::RewardSetVisitor(const double reward) :
+    reward(reward)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void RewardSetVisitor::operator()(LayerType* layer) const
+inline void RewardSetVisitor<MatType>::operator()(LayerType* layer) const
 {
   LayerReward(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasRewardCheck<T, double&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-RewardSetVisitor::LayerReward(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+RewardSetVisitor<MatType>::LayerReward(T* layer) const
 {
   layer->Reward() = reward;
 
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(RewardSetVisitor(reward),
+    boost::apply_visitor(RewardSetVisitor<MatType>(reward),
         layer->Model()[i]);
   }
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasRewardCheck<T, double&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-RewardSetVisitor::LayerReward(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+RewardSetVisitor<MatType>::LayerReward(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(RewardSetVisitor(reward),
+    boost::apply_visitor(RewardSetVisitor<MatType>(reward),
         layer->Model()[i]);
   }
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasRewardCheck<T, double&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-RewardSetVisitor::LayerReward(T* layer) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+RewardSetVisitor<MatType>::LayerReward(T* layer) const
 {
   layer->Reward() = reward;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasRewardCheck<T, double&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-RewardSetVisitor::LayerReward(T* /* input */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    void>::type
+RewardSetVisitor<MatType>::LayerReward(T* /* input */) const
 {
   /* Nothing to do here. */
 }
@@ -24,7 +24,10 @@ namespace ann {
 /**
  * SetInputHeightVisitor updates the input height parameter with the given input
  * height.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class SetInputHeightVisitor : public boost::static_visitor<bool>
 {
  public:
@@ -47,7 +50,8 @@ class SetInputHeightVisitor : public boost::static_visitor<bool>
   template<typename T>
   typename std::enable_if<
       !HasInputHeight<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
   LayerInputHeight(T* layer) const;
 
   //! Update the input height if the module implements the InputHeight()
@@ -55,14 +59,16 @@ class SetInputHeightVisitor : public boost::static_visitor<bool>
   template<typename T>
   typename std::enable_if<
       HasInputHeight<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
   LayerInputHeight(T* layer) const;
 
   //! Update the input height if the module implements the Model() function.
   template<typename T>
   typename std::enable_if<
       !HasInputHeight<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
   LayerInputHeight(T* layer) const;
 
   //! Update the input height if the module implements the InputHeight() or
@@ -70,7 +76,8 @@ class SetInputHeightVisitor : public boost::static_visitor<bool>
   template<typename T>
   typename std::enable_if<
       HasInputHeight<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
   LayerInputHeight(T* layer) const;
 };
 
@@ -19,34 +19,41 @@ namespace mlpack {
 namespace ann {
 
 //! SetInputHeightVisitor visitor class.
-inline SetInputHeightVisitor::SetInputHeightVisitor(const size_t inputHeight,
-                                                    const bool reset) :
+template<typename MatType>
+inline SetInputHeightVisitor<MatType>::SetInputHeightVisitor(
+    const size_t inputHeight,
+    const bool reset) :
     inputHeight(inputHeight),
     reset(reset)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline bool SetInputHeightVisitor::operator()(LayerType* layer) const
+inline bool SetInputHeightVisitor<MatType>::operator()(LayerType* layer) const
 {
   return LayerInputHeight(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasInputHeight<T, size_t&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
-SetInputHeightVisitor::LayerInputHeight(T* /* layer */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+SetInputHeightVisitor<MatType>::LayerInputHeight(T* /* layer */) const
 {
   return false;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasInputHeight<T, size_t&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
-SetInputHeightVisitor::LayerInputHeight(T* layer) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+SetInputHeightVisitor<MatType>::LayerInputHeight(T* layer) const
 {
   if (layer->InputHeight() == 0 || reset)
   {
@@ -56,26 +63,30 @@ SetInputHeightVisitor::LayerInputHeight(T* layer) const
   return true;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasInputHeight<T, size_t&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
-SetInputHeightVisitor::LayerInputHeight(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+SetInputHeightVisitor<MatType>::LayerInputHeight(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(SetInputHeightVisitor(inputHeight, reset),
+    boost::apply_visitor(SetInputHeightVisitor<MatType>(inputHeight, reset),
         layer->Model()[i]);
   }
 
   return true;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasInputHeight<T, size_t&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
-SetInputHeightVisitor::LayerInputHeight(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+SetInputHeightVisitor<MatType>::LayerInputHeight(T* layer) const
 {
   if (layer->InputHeight() == 0  || reset)
   {
@@ -84,7 +95,7 @@ SetInputHeightVisitor::LayerInputHeight(T* layer) const
 
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(SetInputHeightVisitor(inputHeight, reset),
+    boost::apply_visitor(SetInputHeightVisitor<MatType>(inputHeight, reset),
         layer->Model()[i]);
   }
 
@@ -24,7 +24,10 @@ namespace ann {
 /**
  * SetInputWidthVisitor updates the input width parameter with the given input
  * width.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class SetInputWidthVisitor : public boost::static_visitor<bool>
 {
  public:
@@ -47,21 +50,24 @@ class SetInputWidthVisitor : public boost::static_visitor<bool>
   template<typename T>
   typename std::enable_if<
       !HasInputWidth<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
   LayerInputWidth(T* layer) const;
 
   //! Update the input width if the module implements the InputWidth() function.
   template<typename T>
   typename std::enable_if<
       HasInputWidth<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
   LayerInputWidth(T* layer) const;
 
   //! Update the input width if the module implements the Model() function.
   template<typename T>
   typename std::enable_if<
       !HasInputWidth<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
   LayerInputWidth(T* layer) const;
 
   //! Update the input width if the module implements the InputWidth() or
@@ -69,7 +75,8 @@ class SetInputWidthVisitor : public boost::static_visitor<bool>
   template<typename T>
   typename std::enable_if<
       HasInputWidth<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      bool>::type
   LayerInputWidth(T* layer) const;
 };
 
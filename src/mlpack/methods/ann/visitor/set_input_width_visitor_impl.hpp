@@ -19,34 +19,41 @@ namespace mlpack {
 namespace ann {
 
 //! SetInputWidthVisitor visitor class.
-inline SetInputWidthVisitor::SetInputWidthVisitor(const size_t inputWidth,
-                                                  const bool reset) :
+template<typename MatType>
+inline SetInputWidthVisitor<MatType>::SetInputWidthVisitor(
+    const size_t inputWidth,
+    const bool reset) :
     inputWidth(inputWidth),
     reset(reset)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline bool SetInputWidthVisitor::operator()(LayerType* layer) const
+inline bool SetInputWidthVisitor<MatType>::operator()(LayerType* layer) const
 {
   return LayerInputWidth(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasInputWidth<T, size_t&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
-SetInputWidthVisitor::LayerInputWidth(T* /* layer */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+SetInputWidthVisitor<MatType>::LayerInputWidth(T* /* layer */) const
 {
   return false;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasInputWidth<T, size_t&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
-SetInputWidthVisitor::LayerInputWidth(T* layer) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+SetInputWidthVisitor<MatType>::LayerInputWidth(T* layer) const
 {
   if (layer->InputWidth() == 0 || reset)
   {
@@ -56,26 +63,30 @@ SetInputWidthVisitor::LayerInputWidth(T* layer) const
   return true;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasInputWidth<T, size_t&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
-SetInputWidthVisitor::LayerInputWidth(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+SetInputWidthVisitor<MatType>::LayerInputWidth(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(SetInputWidthVisitor(inputWidth, reset),
+    boost::apply_visitor(SetInputWidthVisitor<MatType>(inputWidth, reset),
         layer->Model()[i]);
   }
 
   return true;
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasInputWidth<T, size_t&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
-SetInputWidthVisitor::LayerInputWidth(T* layer) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    bool>::type
+SetInputWidthVisitor<MatType>::LayerInputWidth(T* layer) const
 {
   if (layer->InputWidth() == 0 || reset)
   {
@@ -84,7 +95,7 @@ SetInputWidthVisitor::LayerInputWidth(T* layer) const
 
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(SetInputWidthVisitor(inputWidth, reset),
+    boost::apply_visitor(SetInputWidthVisitor<MatType>(inputWidth, reset),
         layer->Model()[i]);
   }
 
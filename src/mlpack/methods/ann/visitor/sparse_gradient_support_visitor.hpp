@@ -0,0 +1,47 @@
+/**
+ * @file sparse_gradient_support_visitor.hpp
+ *
+ * This file provides an abstraction that tells whether a given layer can
+ * compute the gradient of its parameters sparsely, as a list of the columns of
+ * its weights that the input uses and their gradient.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_SUPPORT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_SUPPORT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * SparseGradientSupportVisitor returns true if the given module implements
+ * SparseGradient() (see SparseGradientVisitor), which is the case for the
+ * Lookup module, whose gradient is zero for the embeddings the input doesn't
+ * use.
+ */
+class SparseGradientSupportVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Return false for modules that only compute dense gradients.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  //! Return true for the Lookup module.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(Lookup<InputDataType, OutputDataType>* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_gradient_support_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file sparse_gradient_support_visitor_impl.hpp
+ *
+ * Implementation of the sparse gradient support layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_SUPPORT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_SUPPORT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sparse_gradient_support_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! SparseGradientSupportVisitor visitor class.
+template<typename LayerType>
+inline bool SparseGradientSupportVisitor::operator()(
+    LayerType* /* layer */) const
+{
+  return false;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool SparseGradientSupportVisitor::operator()(
+    Lookup<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ * @file sparse_gradient_visitor.hpp
+ *
+ * This file provides an abstraction for the SparseGradient() function for
+ * different layers and automatically directs any parameter to the right layer
+ * type.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * SparseGradientVisitor executes the SparseGradient() method of the given
+ * module using the input and delta parameter: the gradient is given by the
+ * indices of the columns of the weights of the module that it covers, and the
+ * gradient of each of those columns.  Other modules (see
+ * SparseGradientSupportVisitor) are left alone.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
+ */
+template<typename MatType = arma::mat>
+class SparseGradientVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Executes the SparseGradient() method of the given module using the input
+  //! and delta parameter, and stores the results in indices and block.
+  SparseGradientVisitor(MatType&& input,
+                        MatType&& delta,
+                        arma::uvec& indices,
+                        MatType& block);
+
+  //! Do nothing for modules that only compute dense gradients.
+  template<typename LayerType>
+  void operator()(LayerType* layer) const;
+
+  //! Execute the SparseGradient() method of the Lookup module.
+  template<typename InputDataType, typename OutputDataType>
+  void operator()(Lookup<InputDataType, OutputDataType>* layer) const;
+
+ private:
+  //! The input set.
+  MatType&& input;
+
+  //! The delta parameter.
+  MatType&& delta;
+
+  //! The indices of the columns of the weights in the gradient.
+  arma::uvec& indices;
+
+  //! The gradient of those columns.
+  MatType& block;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_gradient_visitor_impl.hpp"
+
+#endif
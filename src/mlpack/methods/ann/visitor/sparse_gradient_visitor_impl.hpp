@@ -0,0 +1,54 @@
+/**
+ * @file sparse_gradient_visitor_impl.hpp
+ *
+ * Implementation of the SparseGradient() function layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sparse_gradient_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! SparseGradientVisitor visitor class.
+template<typename MatType>
+inline SparseGradientVisitor<MatType>::SparseGradientVisitor(
+    MatType&& input,
+    MatType&& delta,
+    arma::uvec& indices,
+    MatType& block) :
+    input(std::move(input)),
+    delta(std::move(delta)),
+    indices(indices),
+    block(block)
+{
+  /* Nothing to do here. */
+}
+
+template<typename MatType>
+template<typename LayerType>
+inline void SparseGradientVisitor<MatType>::operator()(
+    LayerType* /* layer */) const
+{
+  /* Nothing to do here. */
+}
+
+template<typename MatType>
+template<typename InputDataType, typename OutputDataType>
+inline void SparseGradientVisitor<MatType>::operator()(
+    Lookup<InputDataType, OutputDataType>* layer) const
+{
+  layer->SparseGradient(std::move(input), std::move(delta), indices, block);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
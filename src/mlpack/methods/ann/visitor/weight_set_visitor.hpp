@@ -23,12 +23,15 @@ namespace ann {
 
 /**
  * WeightSetVisitor update the module parameters given the parameters set.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class WeightSetVisitor : public boost::static_visitor<size_t>
 {
  public:
   //! Update the parameters given the parameters set and offset.
-  WeightSetVisitor(arma::mat&& weight, const size_t offset = 0);
+  WeightSetVisitor(MatType&& weight, const size_t offset = 0);
 
   //! Update the parameters set.
   template<typename LayerType>
@@ -36,7 +39,7 @@ class WeightSetVisitor : public boost::static_visitor<size_t>
 
  private:
   //! The parameters set.
-  arma::mat&& weight;
+  MatType&& weight;
 
   //! The parameters offset.
   const size_t offset;
@@ -46,21 +49,24 @@ class WeightSetVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       !HasParametersCheck<T, P&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerSize(T* layer, P&& input) const;
 
   //! Update the parameters if the module implements the Model() function.
   template<typename T, typename P>
   typename std::enable_if<
       !HasParametersCheck<T, P&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerSize(T* layer, P&& input) const;
 
   //! Update the parameters if the module implements the Parameters() function.
   template<typename T, typename P>
   typename std::enable_if<
       HasParametersCheck<T, P&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerSize(T* layer, P&& input) const;
 
   //! Update the parameters if the module implements the Model() and
@@ -68,7 +74,8 @@ class WeightSetVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       HasParametersCheck<T, P&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerSize(T* layer, P&& input) const;
 };
 
@@ -19,70 +19,80 @@ namespace mlpack {
 namespace ann {
 
 //! WeightSetVisitor visitor class.
-inline WeightSetVisitor::WeightSetVisitor(arma::mat&& weight,
-                                          const size_t offset) :
+template<typename MatType>
+inline WeightSetVisitor<MatType>::WeightSetVisitor(MatType&& weight,
+                                                   const size_t offset) :
     weight(std::move(weight)),
     offset(offset)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline size_t WeightSetVisitor::operator()(LayerType* layer) const
+inline size_t WeightSetVisitor<MatType>::operator()(LayerType* layer) const
 {
   return LayerSize(layer, std::move(layer->OutputParameter()));
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasParametersCheck<T, P&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-WeightSetVisitor::LayerSize(T* /* layer */, P&& /*output */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+WeightSetVisitor<MatType>::LayerSize(T* /* layer */, P&& /*output */) const
 {
   return 0;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasParametersCheck<T, P&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-WeightSetVisitor::LayerSize(T* layer, P&& /*output */) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+WeightSetVisitor<MatType>::LayerSize(T* layer, P&& /*output */) const
 {
   size_t modelOffset = 0;
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    modelOffset += boost::apply_visitor(WeightSetVisitor(
+    modelOffset += boost::apply_visitor(WeightSetVisitor<MatType>(
         std::move(weight), modelOffset + offset), layer->Model()[i]);
   }
 
   return modelOffset;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     HasParametersCheck<T, P&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-WeightSetVisitor::LayerSize(T* layer, P&& /* output */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+WeightSetVisitor<MatType>::LayerSize(T* layer, P&& /* output */) const
 {
-  layer->Parameters() = arma::mat(weight.memptr() + offset,
+  layer->Parameters() = MatType(weight.memptr() + offset,
       layer->Parameters().n_rows, layer->Parameters().n_cols, false, false);
 
   return layer->Parameters().n_elem;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     HasParametersCheck<T, P&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-WeightSetVisitor::LayerSize(T* layer, P&& /* output */) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+WeightSetVisitor<MatType>::LayerSize(T* layer, P&& /* output */) const
 {
-  layer->Parameters() = arma::mat(weight.memptr() + offset,
+  layer->Parameters() = MatType(weight.memptr() + offset,
       layer->Parameters().n_rows, layer->Parameters().n_cols, false, false);
 
   size_t modelOffset = layer->Parameters().n_elem;
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    modelOffset += boost::apply_visitor(WeightSetVisitor(
+    modelOffset += boost::apply_visitor(WeightSetVisitor<MatType>(
         std::move(weight), modelOffset + offset), layer->Model()[i]);
   }
 
@@ -24,7 +24,10 @@ namespace ann {
 
 /**
  * WeightSizeVisitor returns the number of weights of the given module.
+ *
+ * @tparam MatType Type of the data and parameters of the visited modules.
  */
+template<typename MatType = arma::mat>
 class WeightSizeVisitor : public boost::static_visitor<size_t>
 {
  public:
@@ -38,7 +41,8 @@ class WeightSizeVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       !HasParametersCheck<T, P&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerSize(T* layer, P& output) const;
 
   //! Return the number of parameters if the module implements the Model()
@@ -46,7 +50,8 @@ class WeightSizeVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       !HasParametersCheck<T, P&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerSize(T* layer, P& output) const;
 
   //! Return the number of parameters if the module implements the Parameters()
@@ -54,7 +59,8 @@ class WeightSizeVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       HasParametersCheck<T, P&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerSize(T* layer, P& output) const;
 
   //! Return the accumulated number of parameters if the module implements the
@@ -62,7 +68,8 @@ class WeightSizeVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       HasParametersCheck<T, P&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+      size_t>::type
   LayerSize(T* layer, P& output) const;
 };
 
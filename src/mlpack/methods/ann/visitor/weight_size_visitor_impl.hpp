@@ -19,55 +19,66 @@ namespace mlpack {
 namespace ann {
 
 //! WeightSizeVisitor visitor class.
+template<typename MatType>
 template<typename LayerType>
-inline size_t WeightSizeVisitor::operator()(LayerType* layer) const
+inline size_t WeightSizeVisitor<MatType>::operator()(LayerType* layer) const
 {
   return LayerSize(layer, layer->OutputParameter());
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasParametersCheck<T, P&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-WeightSizeVisitor::LayerSize(T* /* layer */, P& /* output */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+WeightSizeVisitor<MatType>::LayerSize(T* /* layer */, P& /* output */) const
 {
   return 0;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasParametersCheck<T, P&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-WeightSizeVisitor::LayerSize(T* layer, P& /* output */) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+WeightSizeVisitor<MatType>::LayerSize(T* layer, P& /* output */) const
 {
   size_t weights = 0;
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    weights += boost::apply_visitor(WeightSizeVisitor(), layer->Model()[i]);
+    weights += boost::apply_visitor(WeightSizeVisitor<MatType>(),
+        layer->Model()[i]);
   }
 
   return weights;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     HasParametersCheck<T, P&(T::*)()>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-WeightSizeVisitor::LayerSize(T* layer, P& /* output */) const
+    !HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+WeightSizeVisitor<MatType>::LayerSize(T* layer, P& /* output */) const
 {
   return layer->Parameters().n_elem;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     HasParametersCheck<T, P&(T::*)()>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
-WeightSizeVisitor::LayerSize(T* layer, P& /* output */) const
+    HasModelCheck<T, std::vector<LayerTypes<MatType>>&(T::*)()>::value,
+    size_t>::type
+WeightSizeVisitor<MatType>::LayerSize(T* layer, P& /* output */) const
 {
   size_t weights = layer->Parameters().n_elem;
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    weights += boost::apply_visitor(WeightSizeVisitor(), layer->Model()[i]);
+    weights += boost::apply_visitor(WeightSizeVisitor<MatType>(),
+        layer->Model()[i]);
   }
 
   return weights;
@@ -81,11 +81,22 @@ void DrusillaSelect<MatType>::Train(
   candidateSet.set_size(referenceSet.n_rows, l * m);
   candidateIndices.set_size(l * m);
 
-  arma::vec dataMean(arma::mean(referenceSet, 1));
+  typedef typename MatType::elem_type ElemType;
+
+  const arma::Col<ElemType> dataMean(arma::mean(referenceSet, 1));
   arma::vec norms(referenceSet.n_cols);
 
+  // The points are independent, so they are centered in parallel.
   MatType refCopy(referenceSet.n_rows, referenceSet.n_cols);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for
+  for (intmax_t i = 0; i < (intmax_t) refCopy.n_cols; ++i)
+#else
+  #pragma omp parallel for
   for (size_t i = 0; i < refCopy.n_cols; ++i)
+#endif
   {
     refCopy.col(i) = referenceSet.col(i) - dataMean;
     norms[i] = arma::norm(refCopy.col(i));
@@ -98,12 +109,23 @@ void DrusillaSelect<MatType>::Train(
     arma::uword maxIndex;
     norms.max(maxIndex);
 
-    arma::vec line(refCopy.col(maxIndex) / arma::norm(refCopy.col(maxIndex)));
+    const arma::Col<ElemType> line(refCopy.col(maxIndex) /
+        arma::norm(refCopy.col(maxIndex)));
 
-    // Calculate distortion and offset and make scores.
-    std::vector<bool> closeAngle(referenceSet.n_cols, false);
+    // Calculate distortion and offset and make scores.  Every point is
+    // independent, so this is done in parallel (closeAngle holds chars, since
+    // the elements of std::vector<bool> can't be written concurrently).
+    std::vector<char> closeAngle(referenceSet.n_cols, false);
     arma::vec sums(referenceSet.n_cols);
+  #ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for
+    for (intmax_t j = 0; j < (intmax_t) referenceSet.n_cols; ++j)
+  #else
+    #pragma omp parallel for
     for (size_t j = 0; j < referenceSet.n_cols; ++j)
+  #endif
     {
       if (norms[j] > 0.0)
       {
@@ -180,16 +202,44 @@ void DrusillaSelect<MatType>::Search(const MatType& querySet,
         "greater than number of points in candidate set!  Increase l or m.");
 
   // We'll use the NeighborSearchRules class to perform our brute-force search.
-  // Note that we aren't using trees for our search, so we can use 'int' as a
-  // TreeType.
-  metric::EuclideanDistance metric;
-  NeighborSearchRules<FurthestNeighborSort, metric::EuclideanDistance,
+  // Note that we aren't using trees for our search, so the TreeType is only
+  // used for its matrix type.
+  typedef NeighborSearchRules<FurthestNeighborSort, metric::EuclideanDistance,
       tree::KDTree<metric::EuclideanDistance, tree::EmptyStatistic, MatType>>
-      rules(candidateSet, querySet, k, metric, 0, false);
+      RuleType;
+  metric::EuclideanDistance metric;
+  RuleType rules(candidateSet, querySet, k, metric, 0, false);
+
+  // Blocks of queries are compared with the whole candidate set in parallel;
+  // on dense data, BaseCaseBlock() computes the distances of a block with one
+  // matrix multiplication.  Each thread has its own rules object that shares
+  // the candidate lists, and never works on the same query as another.
+  const size_t blockSize = 64;
+  const size_t numBlocks = (querySet.n_cols + blockSize - 1) / blockSize;
+  #pragma omp parallel
+  {
+    RuleType threadRules(rules);
+    std::vector<size_t> queryIndices;
+
+  #ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+  #else
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+  #endif
+    {
+      const size_t end = std::min((size_t) (b + 1) * blockSize,
+          (size_t) querySet.n_cols);
+      queryIndices.clear();
+      for (size_t q = b * blockSize; q < end; ++q)
+        queryIndices.push_back(q);
 
-  for (size_t q = 0; q < querySet.n_cols; ++q)
-    for (size_t r = 0; r < candidateSet.n_cols; ++r)
-      rules.BaseCase(q, r);
+      threadRules.BaseCaseBlock(queryIndices, 0, candidateSet.n_cols);
+    }
+  }
 
   rules.GetResults(neighbors, distances);
 
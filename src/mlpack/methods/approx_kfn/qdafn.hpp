@@ -34,6 +34,9 @@ template<typename MatType = arma::mat>
 class QDAFN
 {
  public:
+  //! The type of the elements of the data (float tables halve the memory).
+  typedef typename MatType::elem_type ElemType;
+
   /**
    * Construct the QDAFN object but do not train it.  Be sure to call Train()
    * before calling Search().
@@ -97,14 +100,14 @@ class QDAFN
   //! The number of elements to store for each projection.
   size_t m;
   //! The random lines we are projecting onto.  Has l columns.
-  arma::mat lines;
+  arma::Mat<ElemType> lines;
   //! Projections of each point onto each random line.
-  arma::mat projections;
+  arma::Mat<ElemType> projections;
 
   //! Indices of the points for each S.
   arma::Mat<size_t> sIndices;
   //! Values of a_i * x for each point in S.
-  arma::mat sValues;
+  arma::Mat<ElemType> sValues;
 
   // Candidate sets; one element in the vector for each table.
   std::vector<MatType> candidateSet;
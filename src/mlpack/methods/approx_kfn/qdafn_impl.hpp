@@ -61,29 +61,52 @@ void QDAFN<MatType>::Train(const MatType& referenceSet,
   // Build tables.  This is done by drawing random points from a Gaussian
   // distribution as the vectors we project onto.  The Gaussian should have zero
   // mean and unit variance.
+  if (m > referenceSet.n_cols)
+    throw std::invalid_argument("QDAFN::Train(): m must not be greater than "
+        "the number of points in the reference set!");
+
   mlpack::distribution::GaussianDistribution gd(referenceSet.n_rows);
   lines.set_size(referenceSet.n_rows, l);
   for (size_t i = 0; i < l; ++i)
-    lines.col(i) = gd.Random();
+    lines.col(i) = arma::conv_to<arma::Col<ElemType>>::from(gd.Random());
 
   // Now, project each of the reference points onto each line, and collect the
   // top m elements.
   projections = referenceSet.t() * lines;
 
-  // Loop over each projection and find the top m elements.
+  // Loop over each projection and find the top m elements.  The tables are
+  // independent, so they are built in parallel.  Only the top m elements are
+  // sorted, with ties broken by index.
   sIndices.set_size(m, l);
   sValues.set_size(m, l);
   candidateSet.resize(l);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t i = 0; i < (intmax_t) l; ++i)
+#else
+  #pragma omp parallel for schedule(dynamic)
   for (size_t i = 0; i < l; ++i)
+#endif
   {
+    const ElemType* projection = projections.colptr(i);
+    std::vector<size_t> sortedIndices(projections.n_rows);
+    for (size_t j = 0; j < sortedIndices.size(); ++j)
+      sortedIndices[j] = j;
+    std::partial_sort(sortedIndices.begin(), sortedIndices.begin() + m,
+        sortedIndices.end(), [projection](const size_t a, const size_t b)
+        {
+          return (projection[a] > projection[b]) ||
+              (projection[a] == projection[b] && a < b);
+        });
+
+    // Grab the top m elements; they are stored contiguously for each table.
     candidateSet[i].set_size(referenceSet.n_rows, m);
-    arma::uvec sortedIndices = arma::sort_index(projections.col(i), "descend");
-
-    // Grab the top m elements.
     for (size_t j = 0; j < m; ++j)
     {
       sIndices(j, i) = sortedIndices[j];
-      sValues(j, i) = projections(sortedIndices[j], i);
+      sValues(j, i) = projection[sortedIndices[j]];
       candidateSet[i].col(j) = referenceSet.col(sortedIndices[j]);
     }
   }
@@ -104,8 +127,17 @@ void QDAFN<MatType>::Search(const MatType& querySet,
   neighbors.fill(size_t() - 1);
   distances.zeros(k, querySet.n_cols);
 
-  // Search for each point.
+  // Search for each point; the queries are independent, so they are searched
+  // in parallel.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+  #pragma omp parallel for schedule(dynamic, 64)
   for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
   {
     // Initialize a priority queue.
     // The size_t represents the index of the table, and the double represents
@@ -129,7 +161,7 @@ void QDAFN<MatType>::Search(const MatType& querySet,
         resultsQueue(std::less<std::pair<double, size_t>>(), std::move(v));
     for (size_t i = 0; i < m; ++i)
     {
-      std::pair<size_t, double> p = queue.top();
+      std::pair<double, size_t> p = queue.top();
       queue.pop();
 
       // Get index of reference point to look at.
@@ -49,8 +49,6 @@ void RandomizedBlockKrylovSVD::Apply(const arma::mat& data,
                                      arma::mat& v,
                                      const size_t rank)
 {
-  arma::mat Q, R, block, blockIteration;
-
   if (blockSize == 0)
   {
     blockSize = rank + 10;
@@ -59,30 +57,19 @@ void RandomizedBlockKrylovSVD::Apply(const arma::mat& data,
   // Random block initialization.
   arma::mat G = arma::randn(data.n_cols, blockSize);
 
-  // Construct and orthonormalize Krylov subspace.
-  arma::mat K(data.n_rows, blockSize * (maxIterations + 1));
-
-  // Create a working matrix using data from writable auxiliary memory
-  // (K matrix). Doing so avoids an uncessary copy in upcoming step.
-  block = arma::mat(K.memptr(), data.n_rows, blockSize, false, false);
-  arma::qr_econ(block, R, data * G);
+  // Construct the orthonormal basis of the Krylov subspace one block at a
+  // time; the Krylov matrix itself is never stored.
+  arma::mat Q(data.n_rows, std::min((size_t) data.n_rows,
+      blockSize * (maxIterations + 1)));
+  arma::mat block = data * G;
+  size_t columns = AppendBlock(Q, 0, block);
 
-  for (size_t blockOffset = block.n_elem; blockOffset < K.n_elem;
-      blockOffset += block.n_elem)
+  for (size_t i = 0; i < maxIterations && columns < Q.n_cols; ++i)
   {
-    // Temporary working matrix to store the result in the correct place.
-    blockIteration = arma::mat(K.memptr() + blockOffset, block.n_rows,
-        block.n_cols, false, false);
-
-    arma::qr_econ(blockIteration, R, data * (data.t() * block));
-
-    // Update working matrix for the next iteration.
-    block = arma::mat(K.memptr() + blockOffset, block.n_rows, block.n_cols,
-        false, false);
+    block = data * (data.t() * block);
+    columns = AppendBlock(Q, columns, block);
   }
 
-  arma::qr_econ(Q, R, K);
-
   // Approximate eigenvalues and eigenvectors using Rayleigh–Ritz method.
   arma::svd_econ(u, s, v, Q.t() * data);
 
@@ -92,5 +79,38 @@ void RandomizedBlockKrylovSVD::Apply(const arma::mat& data,
   u = Q * u;
 }
 
+size_t RandomizedBlockKrylovSVD::AppendBlock(arma::mat& Q,
+                                             const size_t columns,
+                                             arma::mat& block)
+{
+  arma::mat R;
+  if (columns == 0)
+  {
+    arma::qr_econ(block, R, block);
+  }
+  else
+  {
+    // Block classical Gram-Schmidt, done twice: a single pass loses the
+    // orthogonality to the basis when the block is nearly in its span.
+    const arma::mat basis(Q.memptr(), Q.n_rows, columns, false, true);
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+      block -= basis * (basis.t() * block);
+      arma::qr_econ(block, R, block);
+    }
+  }
+
+  // The basis can't have more columns than the data has dimensions.
+  const size_t newColumns = std::min((size_t) block.n_cols,
+      (size_t) Q.n_cols - columns);
+  if (newColumns < block.n_cols)
+    block.shed_cols(newColumns, block.n_cols - 1);
+
+  if (newColumns > 0)
+    Q.cols(columns, columns + newColumns - 1) = block;
+
+  return columns + newColumns;
+}
+
 } // namespace svd
 } // namespace mlpack
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_BLOCK_KRYLOV_SVD_RANDOMIZED_BLOCK_KRYLOV_SVD_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/batch_prefetcher.hpp>
 
 namespace mlpack {
 namespace svd {
@@ -104,6 +105,58 @@ class RandomizedBlockKrylovSVD
              arma::mat& v,
              const size_t rank);
 
+  /**
+   * Apply the randomized block krylov SVD to the provided data set minus the
+   * given mean of each dimension, (data - mean * 1^T), without forming the
+   * centered matrix: the mean is subtracted implicitly in every product with
+   * the data (data * G - mean * (1^T * G)).  This lets a sparse data set be
+   * decomposed as if it were centered, while it stays sparse.
+   *
+   * @param data Data matrix (dense or sparse).
+   * @param u First unitary matrix.
+   * @param v Second unitary matrix.
+   * @param s Diagonal matrix of singular values.
+   * @param rank Rank of the approximation.
+   * @param mean Mean to subtract from each point of the data.
+   */
+  template<typename MatType>
+  void Apply(const MatType& data,
+             arma::mat& u,
+             arma::vec& s,
+             arma::mat& v,
+             const size_t rank,
+             const arma::vec& mean);
+
+  /**
+   * Compute the leading left singular vectors and singular values of the data
+   * read from the given batch source (see data/batch_source.hpp), without ever
+   * holding more than a few column blocks of the data in memory.  Only the
+   * predictors of the shards are used.  The blocks are read by a
+   * data::BatchPrefetcher, so the next block is read while the current one is
+   * processed.
+   *
+   * Every block of the Krylov subspace after the first is one pass over the
+   * data, and one more pass projects the data onto the subspace, so
+   * (MaxIterations() + 2) passes are made in total.  Besides the batches, only
+   * the orthonormal basis of the subspace (d x (MaxIterations() + 1) *
+   * BlockSize() for d dimensions) and a few d x BlockSize() blocks are stored.
+   * The right singular vectors are not computed, since they have one entry per
+   * point.
+   *
+   * @param source Source of the column blocks of the data.
+   * @param u Matrix to store the left singular vectors into.
+   * @param s Vector to store the singular values into.
+   * @param rank Rank of the approximation.
+   * @param batchSize Number of columns in each batch.
+   * @return The number of points in the data.
+   */
+  template<typename SourceType>
+  size_t Apply(SourceType& source,
+               arma::mat& u,
+               arma::vec& s,
+               const size_t rank,
+               const size_t batchSize = 65536);
+
   //! Get the number of iterations for the power method.
   size_t MaxIterations() const { return maxIterations; }
   //! Modify the number of iterations for the power method.
@@ -120,9 +173,27 @@ class RandomizedBlockKrylovSVD
 
   //! The block size value.
   size_t blockSize;
+
+  /**
+   * Orthonormalize the given block of the Krylov subspace against the first
+   * 'columns' columns of Q, and store it in the following columns of Q (as
+   * many as fit).  The block is replaced by its orthonormalized columns, which
+   * are used to compute the next block.
+   *
+   * @param Q Orthonormal basis of the Krylov subspace.
+   * @param columns Number of columns of Q that are filled already.
+   * @param block Block to append to the basis.
+   * @return The number of columns of Q that are filled.
+   */
+  static size_t AppendBlock(arma::mat& Q,
+                            const size_t columns,
+                            arma::mat& block);
 };
 
 } // namespace svd
 } // namespace mlpack
 
+// Include implementation.
+#include "randomized_block_krylov_svd_impl.hpp"
+
 #endif
@@ -0,0 +1,161 @@
+/**
+ * @file randomized_block_krylov_svd_impl.hpp
+ *
+ * Implementation of the randomized block krylov SVD method for implicitly
+ * centered data and for data that is read from a batch source.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_BLOCK_KRYLOV_SVD_RANDOMIZED_BLOCK_KRYLOV_SVD_IMPL_HPP
+#define MLPACK_METHODS_BLOCK_KRYLOV_SVD_RANDOMIZED_BLOCK_KRYLOV_SVD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "randomized_block_krylov_svd.hpp"
+
+namespace mlpack {
+namespace svd {
+
+template<typename MatType>
+void RandomizedBlockKrylovSVD::Apply(const MatType& data,
+                                     arma::mat& u,
+                                     arma::vec& s,
+                                     arma::mat& v,
+                                     const size_t rank,
+                                     const arma::vec& mean)
+{
+  if (mean.n_elem != data.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "RandomizedBlockKrylovSVD::Apply(): the mean has " << mean.n_elem
+        << " elements, but the data has " << data.n_rows << " dimensions";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (blockSize == 0)
+  {
+    blockSize = rank + 10;
+  }
+
+  // Random block initialization.
+  arma::mat G = arma::randn(data.n_cols, blockSize);
+
+  // Construct and orthonormalize Krylov subspace, as for dense data; every
+  // product with the centered data C = (data - mean * 1^T) is computed as
+  // C * X = data * X - mean * (1^T * X), and C^T * X = data^T * X -
+  // 1 * (mean^T * X).
+  arma::mat Q(data.n_rows, std::min((size_t) data.n_rows,
+      blockSize * (maxIterations + 1)));
+  arma::mat block = data * G - mean * arma::sum(G, 0);
+  size_t columns = AppendBlock(Q, 0, block);
+
+  arma::mat product;
+  for (size_t i = 0; i < maxIterations && columns < Q.n_cols; ++i)
+  {
+    product = data.t() * block;
+    product.each_row() -= mean.t() * block;
+    block = data * product - mean * arma::sum(product, 0);
+    columns = AppendBlock(Q, columns, block);
+  }
+
+  // Approximate eigenvalues and eigenvectors using Rayleigh–Ritz method, on
+  // Q^T * C = Q^T * data - (Q^T * mean) * 1^T.
+  product = Q.t() * data;
+  product.each_col() -= Q.t() * mean;
+  arma::svd_econ(u, s, v, product);
+
+  u = Q * u;
+}
+
+template<typename SourceType>
+size_t RandomizedBlockKrylovSVD::Apply(SourceType& source,
+                                       arma::mat& u,
+                                       arma::vec& s,
+                                       const size_t rank,
+                                       const size_t batchSize)
+{
+  data::BatchPrefetcher<SourceType> batches(source, batchSize, false);
+  arma::mat batch, responses;
+
+  if (blockSize == 0)
+  {
+    blockSize = rank + 10;
+  }
+
+  // The first pass computes the first block of the Krylov subspace, A * G; the
+  // rows of the random matrix G are drawn for each batch, so G isn't stored.
+  arma::mat block;
+  size_t n = 0;
+  batches.Reset();
+  while (batches.Next(batch, responses))
+  {
+    if (n == 0)
+    {
+      block.zeros(batch.n_rows, blockSize);
+    }
+    else if (batch.n_rows != block.n_rows)
+    {
+      throw std::invalid_argument("RandomizedBlockKrylovSVD::Apply(): the "
+          "batches of the data have different numbers of dimensions");
+    }
+
+    block += batch * arma::randn<arma::mat>(batch.n_cols, blockSize);
+    n += batch.n_cols;
+  }
+
+  if (n == 0)
+  {
+    throw std::invalid_argument("RandomizedBlockKrylovSVD::Apply(): no data "
+        "to decompose");
+  }
+
+  const size_t d = block.n_rows;
+  arma::mat Q(d, std::min(d, blockSize * (maxIterations + 1)));
+  size_t columns = AppendBlock(Q, 0, block);
+
+  // Every other block is one pass over the data: A * A^T * X is accumulated
+  // batch by batch.
+  arma::mat next;
+  for (size_t i = 0; i < maxIterations && columns < Q.n_cols; ++i)
+  {
+    next.zeros(d, block.n_cols);
+    batches.Reset();
+    while (batches.Next(batch, responses))
+      next += batch * (batch.t() * block);
+
+    block = std::move(next);
+    columns = AppendBlock(Q, columns, block);
+  }
+
+  // The last pass computes the Gram matrix of the data projected onto Q, whose
+  // eigendecomposition gives the singular values and (rotated) left singular
+  // vectors of Q^T * A (the Rayleigh–Ritz step).
+  arma::mat gram(Q.n_cols, Q.n_cols, arma::fill::zeros), projected;
+  batches.Reset();
+  while (batches.Next(batch, responses))
+  {
+    projected = Q.t() * batch;
+    gram += projected * projected.t();
+  }
+
+  arma::vec eigval;
+  arma::mat eigvec;
+  arma::eig_sym(eigval, eigvec, 0.5 * (gram + gram.t()));
+
+  // The eigenvalues are in ascending order; keep the k largest, from largest
+  // to smallest.
+  const size_t k = std::min(rank, (size_t) Q.n_cols);
+  eigval = arma::flipud(eigval);
+  eigvec = arma::fliplr(eigvec);
+  s = arma::sqrt(arma::clamp(eigval.subvec(0, k - 1), 0.0, DBL_MAX));
+  u = Q * eigvec.cols(0, k - 1);
+
+  return n;
+}
+
+} // namespace svd
+} // namespace mlpack
+
+#endif
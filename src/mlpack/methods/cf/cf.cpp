@@ -15,7 +15,7 @@
  */
 #include "cf.hpp"
 
-#include <queue>
+#include <algorithm>
 
 namespace mlpack {
 namespace cf {
@@ -24,7 +24,8 @@ namespace cf {
 CF::CF(const size_t numUsersForSimilarity,
        const size_t rank) :
     numUsersForSimilarity(numUsersForSimilarity),
-    rank(rank)
+    rank(rank),
+    hasItemIndex(false)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -36,6 +37,176 @@ CF::CF(const size_t numUsersForSimilarity,
   }
 }
 
+void CF::BuildItemIndex()
+{
+  // The feature vectors of the items are the rows of W.  The tree takes
+  // ownership of its dataset, so the index stays valid when the model is
+  // copied.
+  typedef fastmks::FastMKS<kernel::LinearKernel>::Tree TreeType;
+  Timer::Start("cf_item_index");
+  itemIndex.Train(new TreeType(arma::mat(w.t())));
+  Timer::Stop("cf_item_index");
+  hasItemIndex = true;
+}
+
+void CF::ClearItemIndex()
+{
+  if (hasItemIndex)
+    itemIndex = fastmks::FastMKS<kernel::LinearKernel>();
+  hasItemIndex = false;
+}
+
+void CF::AddRatings(const arma::mat& data, const double lambda)
+{
+  arma::sp_mat ratings;
+  CleanData(data, ratings);
+  AddRatings(ratings, lambda);
+}
+
+void CF::AddRatings(const arma::sp_mat& ratings, const double lambda)
+{
+  if (w.n_elem == 0 || h.n_elem == 0)
+  {
+    throw std::invalid_argument("CF::AddRatings(): the model must be trained "
+        "before ratings are added");
+  }
+  if (lambda < 0.0)
+  {
+    std::ostringstream oss;
+    oss << "CF::AddRatings(): lambda must be non-negative (" << lambda
+        << " given)";
+    throw std::invalid_argument(oss.str());
+  }
+
+  Timer::Start("cf_add_ratings");
+  const size_t oldItems = w.n_rows;
+  const size_t oldUsers = h.n_cols;
+  const size_t numItems = std::max(oldItems, (size_t) ratings.n_rows);
+  const size_t numUsers = std::max(oldUsers, (size_t) ratings.n_cols);
+
+  // Merge the new ratings into the data; a new rating replaces the old rating
+  // of the same user for the same item.
+  arma::sp_mat newRatings(ratings);
+  newRatings.resize(numItems, numUsers);
+  cleanedData.resize(numItems, numUsers);
+  cleanedData += newRatings - cleanedData % arma::spones(newRatings);
+  const arma::sp_mat& data = cleanedData;
+
+  // The new users and items start with empty feature vectors.
+  w.resize(numItems, w.n_cols);
+  h.resize(h.n_rows, numUsers);
+
+  // Find the new users that were given ratings.
+  std::vector<size_t> users;
+  for (size_t j = oldUsers; j < numUsers; ++j)
+    if (newRatings.col_ptrs[j + 1] > newRatings.col_ptrs[j])
+      users.push_back(j);
+
+  // Fit the feature vector of a user to its ratings of the first knownItems
+  // items, if it rated any of them.
+  auto foldInUser = [&](const size_t user, const size_t knownItems)
+  {
+    std::vector<arma::uword> items;
+    std::vector<double> values;
+    for (arma::sp_mat::const_iterator it = data.begin_col(user);
+         it != data.end_col(user); ++it)
+    {
+      if (it.row() < knownItems)
+      {
+        items.push_back(it.row());
+        values.push_back(*it);
+      }
+    }
+
+    if (items.empty())
+      return false;
+
+    h.col(user) = FoldIn(w.rows(arma::uvec(items)), arma::vec(values), lambda);
+    return true;
+  };
+
+  // First fit each of the new users to its ratings of the old items.  A new
+  // user that only rated new items is fit after the new items.  Each user
+  // writes its own column of H.
+  std::vector<char> hasFactors(numUsers, false);
+  std::fill(hasFactors.begin(), hasFactors.begin() + oldUsers, true);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t u = 0; u < (intmax_t) users.size(); ++u)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t u = 0; u < users.size(); ++u)
+#endif
+  {
+    if (foldInUser(users[u], oldItems))
+      hasFactors[users[u]] = true;
+  }
+
+  // Then fit each new item to the ratings of the users that have feature
+  // vectors.  The transposed ratings of the new items have a column for each
+  // new item.
+  if (numItems > oldItems)
+  {
+    const arma::sp_mat itemRatings = data.rows(oldItems, numItems - 1).t();
+#ifdef _WIN32
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) itemRatings.n_cols; ++i)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < itemRatings.n_cols; ++i)
+#endif
+    {
+      std::vector<arma::uword> raters;
+      std::vector<double> values;
+      for (arma::sp_mat::const_iterator it = itemRatings.begin_col(i);
+           it != itemRatings.end_col(i); ++it)
+      {
+        if (hasFactors[it.row()])
+        {
+          raters.push_back(it.row());
+          values.push_back(*it);
+        }
+      }
+
+      if (!raters.empty())
+      {
+        w.row(oldItems + i) = trans(FoldIn(trans(h.cols(arma::uvec(raters))),
+            arma::vec(values), lambda));
+      }
+    }
+  }
+
+  // Finally fit the new users that only rated new items.
+  for (size_t u = 0; u < users.size(); ++u)
+    if (!hasFactors[users[u]])
+      foldInUser(users[u], numItems);
+
+  // The item index holds the old items only.
+  if (hasItemIndex && numItems > oldItems)
+    BuildItemIndex();
+  Timer::Stop("cf_add_ratings");
+
+  Log::Info << "CF::AddRatings(): added " << ratings.n_nonzero << " ratings ("
+      << (numUsers - oldUsers) << " new users, " << (numItems - oldItems)
+      << " new items)." << std::endl;
+}
+
+arma::vec CF::FoldIn(const arma::mat& factors,
+                     const arma::vec& ratings,
+                     const double lambda)
+{
+  // Without regularization the problem may be underdetermined, so take the
+  // least-norm solution.
+  if (lambda == 0.0)
+    return arma::pinv(factors) * ratings;
+
+  return arma::solve(factors.t() * factors +
+      lambda * arma::eye<arma::mat>(factors.n_cols, factors.n_cols),
+      factors.t() * ratings);
+}
+
 void CF::GetRecommendations(const size_t numRecs,
                             arma::Mat<size_t>& recommendations)
 {
@@ -83,59 +254,154 @@ void CF::GetRecommendations(const size_t numRecs,
   arma::mat resultingDistances; // Temporary storage.
   a.Search(query, numUsersForSimilarity, neighborhood, resultingDistances);
 
-  // Generate recommendations for each query user by finding the maximum numRecs
-  // elements in the averages matrix.
-  recommendations.set_size(numRecs, users.n_elem);
-  arma::mat values(numRecs, users.n_elem);
+  // The estimated ratings of a user are the average of the ratings of its
+  // neighbors, w * h.col(n), which is w times the average of the columns of h
+  // of its neighbors.  So the ratings of a block of users are a single matrix
+  // product.
+  arma::mat averageH(h.n_rows, users.n_elem, arma::fill::zeros);
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+      averageH.col(i) += h.col(neighborhood(j, i));
+    averageH.col(i) /= neighborhood.n_rows;
+  }
 
-  for (size_t i = 0; i < users.n_elem; i++)
+  recommendations.set_size(numRecs, users.n_elem);
+  std::vector<char> notEnough(users.n_elem, false);
+  if (hasItemIndex)
+    IndexRecommendations(numRecs, averageH, recommendations, users, notEnough);
+  else
+    DenseRecommendations(numRecs, averageH, recommendations, users, notEnough);
+
+  // If we were not able to come up with enough recommendations, issue a
+  // warning.
+  for (size_t i = 0; i < users.n_elem; ++i)
   {
-    // First, calculate average of neighborhood values.
-    arma::vec averages;
-    averages.zeros(cleanedData.n_rows);
+    if (notEnough[i])
+      Log::Warn << "Could not provide " << numRecs << " recommendations "
+          << "for user " << users(i) << " (not enough un-rated items)!"
+          << std::endl;
+  }
+}
 
-    for (size_t j = 0; j < neighborhood.n_rows; ++j)
-      averages += w * h.col(neighborhood(j, i));
-    averages /= neighborhood.n_rows;
-
-    // Let's build the list of candidate recomendations for the given user.
-    // Default candidate: the smallest possible value and invalid item number.
-    const Candidate def = std::make_pair(-DBL_MAX, cleanedData.n_rows);
-    std::vector<Candidate> vect(numRecs, def);
-    typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-        CandidateList;
-    CandidateList pqueue(CandidateCmp(), std::move(vect));
-
-    // Look through the averages column corresponding to the current user.
-    for (size_t j = 0; j < averages.n_rows; ++j)
-    {
-      // Ensure that the user hasn't already rated the item.
-      if (cleanedData(j, users(i)) != 0.0)
-        continue; // The user already rated the item.
+void CF::DenseRecommendations(const size_t numRecs,
+                              const arma::mat& averageH,
+                              arma::Mat<size_t>& recommendations,
+                              const arma::Col<size_t>& users,
+                              std::vector<char>& notEnough)
+{
+  // Generate recommendations for each query user by finding the maximum numRecs
+  // elements in its column of the averages matrix.  The blocks are sized so the
+  // averages of a block stay reasonably small.
+  const size_t blockSize = std::max((size_t) 1, std::min((size_t) 256,
+      (size_t) (1 << 21) / std::max((size_t) 1, (size_t) cleanedData.n_rows)));
+  const size_t numBlocks = (users.n_elem + blockSize - 1) / blockSize;
 
+  #pragma omp parallel
+  {
+    arma::mat averages;
+    std::vector<Candidate> candidates;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(begin + blockSize, (size_t) users.n_elem);
+      averages = w * averageH.cols(begin, end - 1);
 
-      // Is the estimated value better than the worst candidate?
-      if (averages[i] > pqueue.top().first)
+      for (size_t i = begin; i < end; ++i)
       {
-        Candidate c = std::make_pair(averages[j], j);
-        pqueue.pop();
-        pqueue.push(c);
+        // Let's build the list of candidate recommendations for the given user,
+        // skipping the items the user has already rated.  The rated items are
+        // the (sorted) nonzero rows of the user's column of the data.
+        candidates.clear();
+        arma::sp_mat::const_iterator it = cleanedData.begin_col(users(i));
+        arma::sp_mat::const_iterator itEnd = cleanedData.end_col(users(i));
+        for (size_t j = 0; j < averages.n_rows; ++j)
+        {
+          if (it != itEnd && it.row() == j)
+          {
+            ++it;
+            continue; // The user already rated the item.
+          }
+
+          candidates.push_back(std::make_pair(averages(j, i - begin), j));
+        }
+
+        // Select the best numRecs candidates, and sort them.
+        const size_t found = std::min(numRecs, candidates.size());
+        if (found < candidates.size())
+        {
+          std::nth_element(candidates.begin(), candidates.begin() + found,
+              candidates.end(), CandidateCmp());
+        }
+        std::sort(candidates.begin(), candidates.begin() + found,
+            CandidateCmp());
+
+        for (size_t p = 0; p < found; ++p)
+          recommendations(p, i) = candidates[p].second;
+
+        // Pad with an invalid item number, if there were not enough un-rated
+        // items.
+        for (size_t p = found; p < numRecs; ++p)
+          recommendations(p, i) = cleanedData.n_rows;
+        notEnough[i] = (found < numRecs);
       }
     }
+  }
+}
 
-    for (size_t p = 1; p <= numRecs; p++)
+void CF::IndexRecommendations(const size_t numRecs,
+                              const arma::mat& averageH,
+                              arma::Mat<size_t>& recommendations,
+                              const arma::Col<size_t>& users,
+                              std::vector<char>& notEnough)
+{
+  // The estimated rating of item j is w.row(j) * averageH.col(i), so the best
+  // items are the maximum inner product results of the averaged vectors in the
+  // index.  A user's rated items may be among them, so search for enough
+  // results to still have numRecs after skipping the rated items.
+  size_t maxRated = 0;
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    size_t rated = 0;
+    for (arma::sp_mat::const_iterator it = cleanedData.begin_col(users(i));
+         it != cleanedData.end_col(users(i)); ++it)
+      ++rated;
+    maxRated = std::max(maxRated, rated);
+  }
+  const size_t k = std::min(numRecs + maxRated, (size_t) cleanedData.n_rows);
+  if (k == 0)
+    return;
+
+  arma::Mat<size_t> indices;
+  arma::mat kernels;
+  itemIndex.Search(averageH, k, indices, kernels);
+
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    size_t found = 0;
+    for (size_t p = 0; p < k && found < numRecs; ++p)
     {
-      recommendations(numRecs - p, i) = pqueue.top().second;
-      values(numRecs - p, i) = pqueue.top().first;
-      pqueue.pop();
+      // Skip the items the user has already rated.
+      if (cleanedData(indices(p, i), users(i)) != 0.0)
+        continue;
+
+      recommendations(found++, i) = indices(p, i);
     }
 
-    // If we were not able to come up with enough recommendations, issue a
-    // warning.
-    if (recommendations(numRecs - 1, i) == def.second)
-      Log::Warn << "Could not provide " << numRecs << " recommendations "
-          << "for user " << users(i) << " (not enough un-rated items)!"
-          << std::endl;
+    // Pad with an invalid item number, if there were not enough un-rated
+    // items.
+    for (size_t p = found; p < numRecs; ++p)
+      recommendations(p, i) = cleanedData.n_rows;
+    notEnough[i] = (found < numRecs);
   }
 }
 
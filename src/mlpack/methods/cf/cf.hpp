@@ -21,6 +21,8 @@
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
 #include <mlpack/methods/amf/termination_policies/simple_residue_termination.hpp>
+#include <mlpack/methods/fastmks/fastmks.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
 #include <set>
 #include <map>
 #include <iostream>
@@ -161,6 +163,36 @@ class CF
              const typename std::enable_if_t<
                  !FactorizerTraits<FactorizerType>::UsesCoordinateList>* = 0);
 
+  /**
+   * Add the given ratings to a trained model without factorizing the rating
+   * matrix again.  The ratings are a sparse matrix of items vs. users, as for
+   * Train(); users and items with indices past those of the model are new, and
+   * a rating replaces any old rating of the same user for the same item.
+   *
+   * Each new user gets a feature vector (a column of H), found by regularized
+   * least squares against the fixed feature vectors of the items it rated;
+   * then each new item gets its feature vector (a row of W) against the fixed
+   * vectors of the users that rated it.  The feature vectors of the old users
+   * and items are not changed, but their new ratings are used to fit the new
+   * ones and are skipped by GetRecommendations(); an item index is rebuilt if
+   * new items were added.  This keeps the recommendations fresh between full
+   * calls to Train(); the model drifts from the one Train() would give as more
+   * ratings are added.
+   *
+   * @param ratings New ratings, items vs. users.
+   * @param lambda Regularization of the least squares problems.
+   */
+  void AddRatings(const arma::sp_mat& ratings, const double lambda = 0.01);
+
+  /**
+   * Add the ratings of the given (user, item, rating) table to a trained model
+   * without factorizing the rating matrix again; see the other overload.
+   *
+   * @param data New ratings, as a coordinate list.
+   * @param lambda Regularization of the least squares problems.
+   */
+  void AddRatings(const arma::mat& data, const double lambda = 0.01);
+
   //! Sets number of users for calculating similarity.
   void NumUsersForSimilarity(const size_t num)
   {
@@ -198,6 +230,23 @@ class CF
   //! Get the cleaned data matrix.
   const arma::sp_mat& CleanedData() const { return cleanedData; }
 
+  /**
+   * Build a FastMKS index (with the linear kernel) over the item feature
+   * vectors (the rows of W).  After this is called, GetRecommendations() finds
+   * the items with the largest estimated ratings of each user by max-kernel
+   * search in the index, instead of computing the estimated ratings of every
+   * item.  The index is saved with the model, and is discarded when the model
+   * is trained again.  The recommendations are the same as without the index
+   * (except for the order of items with equal estimated ratings).
+   */
+  void BuildItemIndex();
+
+  //! Discard the item index, if there is one.
+  void ClearItemIndex();
+
+  //! Get whether or not GetRecommendations() uses an item index.
+  bool HasItemIndex() const { return hasItemIndex; }
+
   /**
    * Generates the given number of recommendations for all users.
    *
@@ -261,6 +310,40 @@ class CF
   arma::mat h;
   //! Cleaned data matrix.
   arma::sp_mat cleanedData;
+  //! If true, itemIndex holds an index of the item feature vectors.
+  bool hasItemIndex;
+  //! Max-kernel search index of the item feature vectors.
+  fastmks::FastMKS<kernel::LinearKernel> itemIndex;
+
+  /**
+   * Generate recommendations from the averaged feature vectors of the
+   * neighborhoods of the given users, by computing the estimated ratings of
+   * every item.
+   */
+  void DenseRecommendations(const size_t numRecs,
+                            const arma::mat& averageH,
+                            arma::Mat<size_t>& recommendations,
+                            const arma::Col<size_t>& users,
+                            std::vector<char>& notEnough);
+
+  /**
+   * Generate recommendations from the averaged feature vectors of the
+   * neighborhoods of the given users, using the item index.
+   */
+  void IndexRecommendations(const size_t numRecs,
+                            const arma::mat& averageH,
+                            arma::Mat<size_t>& recommendations,
+                            const arma::Col<size_t>& users,
+                            std::vector<char>& notEnough);
+
+  /**
+   * Solve the regularized least squares problem
+   * min_x ||ratings - factors * x||^2 + lambda ||x||^2, where each row of
+   * factors is the feature vector of one rating.
+   */
+  static arma::vec FoldIn(const arma::mat& factors,
+                          const arma::vec& ratings,
+                          const double lambda);
 
   //! Candidate represents a possible recommendation (value, item).
   typedef std::pair<double, size_t> Candidate;
@@ -277,6 +360,10 @@ class CF
 } // namespace cf
 } // namespace mlpack
 
+//! Set the serialization version of the CF class.  Version 1 added the item
+//! index.
+BOOST_TEMPLATE_CLASS_VERSION(template<>, mlpack::cf::CF, 1);
+
 // Include implementation of templated functions.
 #include "cf_impl.hpp"
 
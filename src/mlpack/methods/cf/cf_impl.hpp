@@ -59,7 +59,8 @@ CF::CF(const arma::mat& data,
        const size_t numUsersForSimilarity,
        const size_t rank) :
     numUsersForSimilarity(numUsersForSimilarity),
-    rank(rank)
+    rank(rank),
+    hasItemIndex(false)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -84,7 +85,8 @@ CF::CF(const arma::sp_mat& data,
        const typename std::enable_if_t<
            !FactorizerTraits<FactorizerType>::UsesCoordinateList>*) :
     numUsersForSimilarity(numUsersForSimilarity),
-    rank(rank)
+    rank(rank),
+    hasItemIndex(false)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -123,6 +125,9 @@ void CF::Train(const arma::mat& data, FactorizerType factorizer)
   Timer::Start("cf_factorization");
   ApplyFactorizer(factorizer, data, cleanedData, this->rank, w, h);
   Timer::Stop("cf_factorization");
+
+  // Any item index was built on the old item feature vectors.
+  ClearItemIndex();
 }
 
 template<typename FactorizerType>
@@ -151,11 +156,14 @@ void CF::Train(const arma::sp_mat& data,
   Timer::Start("cf_factorization");
   factorizer.Apply(cleanedData, this->rank, w, h);
   Timer::Stop("cf_factorization");
+
+  // Any item index was built on the old item feature vectors.
+  ClearItemIndex();
 }
 
 //! Serialize the model.
 template<typename Archive>
-void CF::Serialize(Archive& ar, const unsigned int /* version */)
+void CF::Serialize(Archive& ar, const unsigned int version)
 {
   // This model is simple; just serialize all the members.  No special handling
   // required.
@@ -166,6 +174,21 @@ void CF::Serialize(Archive& ar, const unsigned int /* version */)
   ar & CreateNVP(w, "w");
   ar & CreateNVP(h, "h");
   ar & CreateNVP(cleanedData, "cleanedData");
+
+  // Backward compatibility: older versions of CF didn't have an item index.
+  if (version > 0)
+  {
+    ar & CreateNVP(hasItemIndex, "hasItemIndex");
+    if (hasItemIndex)
+      ar & CreateNVP(itemIndex, "itemIndex");
+  }
+  else if (Archive::is_loading::value)
+  {
+    hasItemIndex = false;
+  }
+
+  if (Archive::is_loading::value && !hasItemIndex)
+    itemIndex = fastmks::FastMKS<kernel::LinearKernel>();
 }
 
 } // namespace cf
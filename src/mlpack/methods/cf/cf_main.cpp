@@ -12,6 +12,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/server.hpp>
 #include <mlpack/core/math/random.hpp>
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/regularized_svd/regularized_svd.hpp>
@@ -57,9 +58,33 @@ PROGRAM_INFO("Collaborating Filtering", "This program performs collaborative "
     "'BatchSVD' -- SVD batch learning\n"
     "'SVDIncompleteIncremental' -- SVD incomplete incremental learning\n"
     "'SVDCompleteIncremental' -- SVD complete incremental learning\n"
+    "'ParallelSVDIncremental' -- SVD incremental learning, with the users "
+    "visited in parallel\n"
+    "'ALS' -- Alternating least squares with weighted-lambda regularization, "
+    "fitting only the given ratings (the least squares problems of each user "
+    "and item are solved in parallel)\n"
+    "'BlockALS' -- ALS with the ratings partitioned into blocks of users and "
+    "blocks of items, as in a distributed ALS; each block only uses the "
+    "factors of the users and items it has ratings of.  The number of blocks "
+    "is given by --blocks.\n"
     "\n"
+    "If the --item_index (-X) flag is given, a FastMKS index of the item "
+    "feature vectors is built, and recommendations are found with max-kernel "
+    "search in the index instead of by estimating the rating of every item.  "
+    "The index is saved with the model, so a model loaded with the "
+    "--input_model_file (-m) parameter keeps using it."
+    "\n\n"
     "A trained model may be saved to a file with the --output_model_file (-M) "
-    "parameter.");
+    "parameter."
+    "\n\n"
+    "With --server, the program trains or loads the model once and then "
+    "answers recommendation requests read from standard input, one per line, "
+    "until the input ends or a line 'quit' is read.  A request holds the "
+    "options --query_file or --all_user_recommendations, --output_file, and "
+    "optionally --recommendations (or their aliases); for each request, a line "
+    "'ok' or 'error: <message>' is written to standard output.  Since "
+    "--verbose output also goes to standard output, it should not be used "
+    "with --server.");
 
 // Parameters for training a model.
 PARAM_MATRIX_IN("training", "Input dataset to perform CF on.", "t");
@@ -70,6 +95,8 @@ PARAM_INT_IN("neighborhood", "Size of the neighborhood of similar users to "
 PARAM_INT_IN("rank", "Rank of decomposed matrices (if 0, a heuristic is used to"
     " estimate the rank).", "R", 0);
 PARAM_MATRIX_IN("test", "Test set to calculate RMSE on.", "T");
+PARAM_INT_IN("blocks", "Number of blocks of users and of items for the "
+    "'BlockALS' algorithm.", "", 4);
 
 // Offer the user the option to set the maximum number of iterations, and
 // terminate only based on the number of iterations.
@@ -92,9 +119,15 @@ PARAM_UMATRIX_OUT("output", "Matrix that will store output recommendations.",
     "o");
 PARAM_INT_IN("recommendations", "Number of recommendations to generate for each"
     " query user.", "c", 5);
+PARAM_FLAG("item_index", "Build a FastMKS index of the item feature vectors to "
+    "generate recommendations with.", "X");
 
 PARAM_INT_IN("seed", "Set the random seed (0 uses std::time(NULL)).", "s", 0);
 
+PARAM_FLAG("server", "If true, answer recommendation requests read from "
+    "standard input with the model, instead of generating recommendations "
+    "once.", "");
+
 void ComputeRecommendations(CF& cf,
                             const size_t numRecs,
                             arma::Mat<size_t>& recommendations)
@@ -148,9 +181,66 @@ void ComputeRMSE(CF& cf)
   Log::Info << "RMSE is " << rmse << "." << endl;
 }
 
+void ServeRecommendations(CF& cf)
+{
+  const vector<string> options = { "query", "all_user_recommendations",
+      "output", "recommendations" };
+  const size_t failures = util::ServeRequests(cin, cout, options,
+      [&cf](const util::ServerRequest& request)
+  {
+    if (request.HasParam("query") ==
+        request.HasParam("all_user_recommendations"))
+      throw invalid_argument("exactly one of --query_file and "
+          "--all_user_recommendations must be given");
+
+    const int numRecs = request.GetParam<int>("recommendations");
+    if (numRecs <= 0)
+      throw invalid_argument("--recommendations must be positive");
+
+    arma::Mat<size_t> recommendations;
+    if (request.HasParam("query"))
+    {
+      const string queryFile = request.GetParam<string>("query");
+      arma::Mat<size_t> users;
+      if (!data::Load(queryFile, users, false))
+        throw runtime_error("cannot load query users from '" + queryFile +
+            "'");
+      if (users.n_rows > 1)
+        users = users.t();
+      if (users.n_rows > 1)
+        throw invalid_argument("list of query users must be one-dimensional");
+
+      cf.GetRecommendations((size_t) numRecs, recommendations,
+          users.row(0).t());
+    }
+    else
+    {
+      cf.GetRecommendations((size_t) numRecs, recommendations);
+    }
+
+    const string file = request.GetParam<string>("output");
+    if (!data::Save(file, recommendations, false))
+      throw runtime_error("cannot save recommendations to '" + file + "'");
+  });
+
+  Log::Info << "Server stopped; " << failures << " request(s) failed." << endl;
+}
+
 void PerformAction(CF& c)
 {
-  if (CLI::HasParam("query") || CLI::HasParam("all_user_recommendations"))
+  if (CLI::HasParam("item_index") && !c.HasItemIndex())
+  {
+    Log::Info << "Building FastMKS index of item feature vectors." << endl;
+    c.BuildItemIndex();
+  }
+
+  if (CLI::HasParam("server"))
+  {
+    // Answer requests until the input ends.
+    ServeRecommendations(c);
+  }
+  else if (CLI::HasParam("query") ||
+      CLI::HasParam("all_user_recommendations"))
   {
     // Get parameters for generating recommendations.
     const size_t numRecs = (size_t) CLI::GetParam<int>("recommendations");
@@ -189,6 +279,7 @@ void AssembleFactorizerType(const std::string& algorithm,
                             const size_t rank)
 {
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
+  const size_t blocks = (size_t) CLI::GetParam<int>("blocks");
   if (maxIterationTermination)
   {
     // Force termination when maximum number of iterations reached.
@@ -217,6 +308,25 @@ void AssembleFactorizerType(const std::string& algorithm,
           SVDCompleteIncrementalLearning<arma::sp_mat>> FactorizerType;
       PerformAction(FactorizerType(mit), dataset, rank);
     }
+    else if (algorithm == "ParallelSVDIncremental")
+    {
+      typedef AMF<MaxIterationTermination, RandomInitialization,
+          ParallelSVDIncrementalLearning> FactorizerType;
+      PerformAction(FactorizerType(mit), dataset, rank);
+    }
+    else if (algorithm == "ALS")
+    {
+      typedef AMF<MaxIterationTermination, RandomInitialization, ALSWRUpdate>
+          FactorizerType;
+      PerformAction(FactorizerType(mit), dataset, rank);
+    }
+    else if (algorithm == "BlockALS")
+    {
+      typedef AMF<MaxIterationTermination, RandomInitialization,
+          BlockALSWRUpdate> FactorizerType;
+      PerformAction(FactorizerType(mit, RandomInitialization(),
+          BlockALSWRUpdate(0.05, blocks)), dataset, rank);
+    }
     else if (algorithm == "RegSVD")
     {
       Log::Fatal << "--iteration_only_termination not supported with 'RegSVD' "
@@ -238,6 +348,16 @@ void AssembleFactorizerType(const std::string& algorithm,
           rank);
     else if (algorithm == "SVDCompleteIncremental")
       PerformAction(SparseSVDCompleteIncrementalFactorizer(srt), dataset, rank);
+    else if (algorithm == "ParallelSVDIncremental")
+      PerformAction(AMF<SimpleResidueTermination, RandomAcolInitialization<>,
+          ParallelSVDIncrementalLearning>(srt), dataset, rank);
+    else if (algorithm == "ALS")
+      PerformAction(AMF<SimpleResidueTermination, RandomAcolInitialization<>,
+          ALSWRUpdate>(srt), dataset, rank);
+    else if (algorithm == "BlockALS")
+      PerformAction(AMF<SimpleResidueTermination, RandomAcolInitialization<>,
+          BlockALSWRUpdate>(srt, RandomAcolInitialization<>(),
+          BlockALSWRUpdate(0.05, blocks)), dataset, rank);
     else if (algorithm == "RegSVD")
       PerformAction(RegularizedSVD<>(maxIterations), dataset, rank);
   }
@@ -267,7 +387,8 @@ int main(int argc, char** argv)
     Log::Fatal << "Both --query_file and --all_user_recommendations are given, "
         << "but only one is allowed!" << endl;
 
-  if (!CLI::HasParam("output") && !CLI::HasParam("output_model"))
+  if (!CLI::HasParam("output") && !CLI::HasParam("output_model") &&
+      !CLI::HasParam("server"))
     Log::Warn << "Neither --output_file nor --output_model_file are specified; "
         << "no output will be saved." << endl;
 
@@ -298,10 +419,18 @@ int main(int argc, char** argv)
         algo != "BatchSVD" &&
         algo != "SVDIncompleteIncremental" &&
         algo != "SVDCompleteIncremental" &&
+        algo != "ParallelSVDIncremental" &&
+        algo != "ALS" &&
+        algo != "BlockALS" &&
         algo != "RegSVD")
       Log::Fatal << "Invalid decomposition algorithm.  Choices are 'NMF', "
           << "'BatchSVD', 'SVDIncompleteIncremental', 'SVDCompleteIncremental',"
-          << " and 'RegSVD'." << endl;
+          << " 'ParallelSVDIncremental', 'ALS', 'BlockALS', and 'RegSVD'."
+          << endl;
+
+    if (CLI::GetParam<int>("blocks") <= 0)
+      Log::Fatal << "Invalid number of blocks (" << CLI::GetParam<int>("blocks")
+          << "); must be positive!" << endl;
 
     // Issue a warning if the user provided a minimum residue but it will be
     // ignored.
@@ -0,0 +1,100 @@
+/**
+ * @file concurrent_union_find.hpp
+ *
+ * A union-find data structure that can be updated by several threads at once
+ * without locks.  Each point is initially in its own component; Union(x, y)
+ * unites the components of x and y, and Find(x) returns the index of the
+ * component of x.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_CONCURRENT_UNION_FIND_HPP
+#define MLPACK_METHODS_DBSCAN_CONCURRENT_UNION_FIND_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <atomic>
+
+namespace mlpack {
+namespace dbscan {
+
+/**
+ * A lock-free union-find data structure.  The root of a component is always
+ * linked below a root with a smaller index, with an atomic compare-and-swap,
+ * so no cycles can be created by concurrent calls to Union(); Find() halves
+ * the paths it follows, which keeps the trees shallow.  The index of a
+ * component is the smallest index of the points in it once all calls to
+ * Union() have finished.
+ */
+class ConcurrentUnionFind
+{
+ public:
+  //! Construct the object with the given number of points.
+  ConcurrentUnionFind(const size_t size) : parent(size)
+  {
+    for (size_t i = 0; i < size; ++i)
+      parent[i].store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the component containing an element.
+   *
+   * @param x The element to find the component of.
+   * @return The index of the component containing x.
+   */
+  size_t Find(size_t x)
+  {
+    while (true)
+    {
+      size_t p = parent[x].load(std::memory_order_acquire);
+      if (p == x)
+        return x;
+
+      // Point x to its grandparent, if no other thread changed its parent in
+      // the meantime.
+      const size_t grandparent = parent[p].load(std::memory_order_acquire);
+      if (grandparent != p)
+        parent[x].compare_exchange_weak(p, grandparent,
+            std::memory_order_acq_rel);
+
+      x = grandparent;
+    }
+  }
+
+  /**
+   * Union the components containing x and y.
+   *
+   * @param x One element.
+   * @param y The other element.
+   */
+  void Union(size_t x, size_t y)
+  {
+    while (true)
+    {
+      x = Find(x);
+      y = Find(y);
+      if (x == y)
+        return;
+
+      // Link the larger root below the smaller one.  If the larger root
+      // stopped being a root in the meantime, try again.
+      if (x < y)
+        std::swap(x, y);
+      size_t expected = x;
+      if (parent[x].compare_exchange_strong(expected, y,
+          std::memory_order_acq_rel))
+        return;
+    }
+  }
+
+ private:
+  //! The parent of each element; roots are their own parents.
+  std::vector<std::atomic<size_t>> parent;
+};
+
+} // namespace dbscan
+} // namespace mlpack
+
+#endif
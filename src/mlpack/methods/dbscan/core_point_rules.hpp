@@ -0,0 +1,173 @@
+/**
+ * @file core_point_rules.hpp
+ *
+ * Rules for the tree traversal that merges the core points of DBSCAN into
+ * clusters and assigns the other points to the cluster of a nearby core
+ * point, without storing the neighbors of any point.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_CORE_POINT_RULES_HPP
+#define MLPACK_METHODS_DBSCAN_CORE_POINT_RULES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/traversal_info.hpp>
+#include <boost/dynamic_bitset.hpp>
+#include <atomic>
+
+#include "concurrent_union_find.hpp"
+
+namespace mlpack {
+namespace dbscan {
+
+/**
+ * The CorePointRules class is used for a monochromatic traversal of a tree
+ * built on the dataset, once it is known which points are core points.  Two
+ * core points closer than epsilon are united in the union-find structure, and
+ * a point that is not a core point is assigned to the first core point found
+ * closer than epsilon.  Several copies of the rules may traverse disjoint
+ * parts of the tree at the same time, since the union-find structure and the
+ * assignments are updated atomically.
+ *
+ * The traversal terminates early wherever it cannot change the result: the
+ * distance of a pair of points is not computed if both are core points that
+ * are already in the same cluster, if neither is a core point, or if the point
+ * that is not a core point is already assigned; and when every point of a node
+ * is closer than epsilon to every point of another node, the points of both
+ * nodes are merged without computing any distance.
+ *
+ * @tparam MetricType The metric to use for computation.
+ * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ */
+template<typename MetricType, typename TreeType>
+class CorePointRules
+{
+ public:
+  /**
+   * Construct the CorePointRules object.
+   *
+   * @param dataset Set of points (in the order of the tree, if any).
+   * @param epsilon Maximum distance between two neighboring points.
+   * @param core The core points.
+   * @param uf Union-find structure that holds the clusters of core points.
+   * @param owners The core point that each point which is not a core point is
+   *     assigned to, or SIZE_MAX if it has not been assigned yet.
+   * @param metric Instantiated metric.
+   */
+  CorePointRules(const arma::mat& dataset,
+                 const double epsilon,
+                 const boost::dynamic_bitset<>& core,
+                 ConcurrentUnionFind& uf,
+                 std::vector<std::atomic<size_t>>& owners,
+                 MetricType& metric);
+
+  /**
+   * Compute the base case between the given query point and reference point.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceIndex Index of reference point.
+   */
+  double BaseCase(const size_t queryIndex, const size_t referenceIndex);
+
+  /**
+   * Get the score for recursion order.  DBL_MAX indicates that the node should
+   * be pruned.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceNode Candidate node to be recursed into.
+   */
+  double Score(const size_t queryIndex, TreeType& referenceNode);
+
+  /**
+   * Re-evaluate the score for recursion order; the node is pruned if the query
+   * point has been assigned to a core point in the meantime.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceNode Candidate node to be recursed into.
+   * @param oldScore Old score produced by Score() (or Rescore()).
+   */
+  double Rescore(const size_t queryIndex,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  /**
+   * Get the score for recursion order.  DBL_MAX indicates that the node
+   * combination should be pruned.
+   *
+   * @param queryNode Candidate query node to recurse into.
+   * @param referenceNode Candidate reference node to recurse into.
+   */
+  double Score(TreeType& queryNode, TreeType& referenceNode);
+
+  /**
+   * Re-evaluate the score for recursion order.
+   *
+   * @param queryNode Candidate query node to recurse into.
+   * @param referenceNode Candidate reference node to recurse into.
+   * @param oldScore Old score produced by Score() (or Rescore()).
+   */
+  double Rescore(TreeType& queryNode,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  typedef typename tree::TraversalInfo<TreeType> TraversalInfoType;
+
+  const TraversalInfoType& TraversalInfo() const { return traversalInfo; }
+  TraversalInfoType& TraversalInfo() { return traversalInfo; }
+
+  //! Get the number of base cases.
+  size_t BaseCases() const { return baseCases; }
+  //! Get the number of scores.
+  size_t Scores() const { return scores; }
+
+ private:
+  //! The dataset.
+  const arma::mat& dataset;
+
+  //! The maximum distance between two neighboring points.
+  double epsilon;
+
+  //! The core points.
+  const boost::dynamic_bitset<>& core;
+
+  //! The clusters of core points.
+  ConcurrentUnionFind& uf;
+
+  //! The core point each point that is not a core point is assigned to.
+  std::vector<std::atomic<size_t>>& owners;
+
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! Return true if the given pair of points may change the result.
+  bool Useful(const size_t a, const size_t b);
+
+  //! Connect two points closer than epsilon.
+  void Connect(const size_t a, const size_t b);
+
+  //! Assign the given point, which is not a core point, to the given core
+  //! point, unless it is already assigned.
+  void Assign(const size_t point, const size_t corePoint);
+
+  //! Connect all the points of the two given nodes, knowing that every pair
+  //! of them is closer than epsilon.
+  void ConnectNodes(TreeType& queryNode, TreeType& referenceNode);
+
+  TraversalInfoType traversalInfo;
+
+  //! The number of base cases.
+  size_t baseCases;
+  //! The number of scores.
+  size_t scores;
+};
+
+} // namespace dbscan
+} // namespace mlpack
+
+// Include implementation.
+#include "core_point_rules_impl.hpp"
+
+#endif
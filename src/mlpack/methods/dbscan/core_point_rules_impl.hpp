@@ -0,0 +1,238 @@
+/**
+ * @file core_point_rules_impl.hpp
+ *
+ * Implementation of the rules that merge the core points of DBSCAN.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_CORE_POINT_RULES_IMPL_HPP
+#define MLPACK_METHODS_DBSCAN_CORE_POINT_RULES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "core_point_rules.hpp"
+
+namespace mlpack {
+namespace dbscan {
+
+template<typename MetricType, typename TreeType>
+CorePointRules<MetricType, TreeType>::CorePointRules(
+    const arma::mat& dataset,
+    const double epsilon,
+    const boost::dynamic_bitset<>& core,
+    ConcurrentUnionFind& uf,
+    std::vector<std::atomic<size_t>>& owners,
+    MetricType& metric) :
+    dataset(dataset),
+    epsilon(epsilon),
+    core(core),
+    uf(uf),
+    owners(owners),
+    metric(metric),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename TreeType>
+inline force_inline
+double CorePointRules<MetricType, TreeType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceIndex)
+{
+  if (!Useful(queryIndex, referenceIndex))
+    return 0.0; // No value to return... this shouldn't do anything bad.
+
+  const double distance = metric.Evaluate(dataset.unsafe_col(queryIndex),
+      dataset.unsafe_col(referenceIndex));
+  ++baseCases;
+
+  if (distance <= epsilon)
+    Connect(queryIndex, referenceIndex);
+
+  return distance;
+}
+
+template<typename MetricType, typename TreeType>
+double CorePointRules<MetricType, TreeType>::Score(const size_t queryIndex,
+                                                   TreeType& referenceNode)
+{
+  // A point that is not a core point only needs to be assigned once.
+  if (!core[queryIndex] &&
+      owners[queryIndex].load(std::memory_order_relaxed) != SIZE_MAX)
+    return DBL_MAX;
+
+  const math::Range distances =
+      referenceNode.RangeDistance(dataset.unsafe_col(queryIndex));
+  ++scores;
+
+  if (distances.Lo() > epsilon)
+    return DBL_MAX;
+
+  // If every point of the node is in the range, connect them all without
+  // computing their distances.
+  if (distances.Hi() <= epsilon)
+  {
+    for (size_t i = 0; i < referenceNode.NumDescendants(); ++i)
+    {
+      const size_t referenceIndex = referenceNode.Descendant(i);
+      if (Useful(queryIndex, referenceIndex))
+        Connect(queryIndex, referenceIndex);
+    }
+
+    return DBL_MAX;
+  }
+
+  // Visit closer nodes first, because any core point in the range is enough
+  // for a point that is not a core point.
+  return distances.Lo();
+}
+
+template<typename MetricType, typename TreeType>
+double CorePointRules<MetricType, TreeType>::Rescore(
+    const size_t queryIndex,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
+{
+  if (!core[queryIndex] &&
+      owners[queryIndex].load(std::memory_order_relaxed) != SIZE_MAX)
+    return DBL_MAX;
+
+  return oldScore;
+}
+
+template<typename MetricType, typename TreeType>
+double CorePointRules<MetricType, TreeType>::Score(TreeType& queryNode,
+                                                   TreeType& referenceNode)
+{
+  const math::Range distances = referenceNode.RangeDistance(queryNode);
+  ++scores;
+
+  if (distances.Lo() > epsilon)
+    return DBL_MAX;
+
+  // If every pair of points of the nodes is in the range, connect them all
+  // without computing their distances.
+  if (distances.Hi() <= epsilon)
+  {
+    ConnectNodes(queryNode, referenceNode);
+    return DBL_MAX;
+  }
+
+  return distances.Lo();
+}
+
+template<typename MetricType, typename TreeType>
+double CorePointRules<MetricType, TreeType>::Rescore(
+    TreeType& /* queryNode */,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
+{
+  return oldScore;
+}
+
+template<typename MetricType, typename TreeType>
+inline force_inline
+bool CorePointRules<MetricType, TreeType>::Useful(const size_t a,
+                                                  const size_t b)
+{
+  if (a == b)
+    return false;
+
+  const bool aCore = core[a];
+  const bool bCore = core[b];
+  if (aCore && bCore)
+    return uf.Find(a) != uf.Find(b);
+  else if (aCore)
+    return owners[b].load(std::memory_order_relaxed) == SIZE_MAX;
+  else if (bCore)
+    return owners[a].load(std::memory_order_relaxed) == SIZE_MAX;
+  else
+    return false;
+}
+
+template<typename MetricType, typename TreeType>
+inline force_inline
+void CorePointRules<MetricType, TreeType>::Connect(const size_t a,
+                                                   const size_t b)
+{
+  if (core[a] && core[b])
+    uf.Union(a, b);
+  else if (core[a])
+    Assign(b, a);
+  else if (core[b])
+    Assign(a, b);
+}
+
+template<typename MetricType, typename TreeType>
+inline force_inline
+void CorePointRules<MetricType, TreeType>::Assign(const size_t point,
+                                                  const size_t corePoint)
+{
+  // Only the first assignment counts.
+  size_t expected = SIZE_MAX;
+  owners[point].compare_exchange_strong(expected, corePoint,
+      std::memory_order_relaxed);
+}
+
+template<typename MetricType, typename TreeType>
+void CorePointRules<MetricType, TreeType>::ConnectNodes(
+    TreeType& queryNode,
+    TreeType& referenceNode)
+{
+  // Find a core point in each node.
+  size_t queryCore = SIZE_MAX;
+  for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
+  {
+    if (core[queryNode.Descendant(i)])
+    {
+      queryCore = queryNode.Descendant(i);
+      break;
+    }
+  }
+
+  size_t referenceCore = SIZE_MAX;
+  for (size_t i = 0; i < referenceNode.NumDescendants(); ++i)
+  {
+    if (core[referenceNode.Descendant(i)])
+    {
+      referenceCore = referenceNode.Descendant(i);
+      break;
+    }
+  }
+
+  // Every point of each node is in the range of the core point of the other
+  // node, so all the core points of both nodes are in one cluster, and the
+  // other points can be assigned to that core point.
+  if (referenceCore != SIZE_MAX)
+  {
+    for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
+    {
+      const size_t queryIndex = queryNode.Descendant(i);
+      if (core[queryIndex])
+        uf.Union(queryIndex, referenceCore);
+      else
+        Assign(queryIndex, referenceCore);
+    }
+  }
+
+  if (queryCore != SIZE_MAX)
+  {
+    for (size_t i = 0; i < referenceNode.NumDescendants(); ++i)
+    {
+      const size_t referenceIndex = referenceNode.Descendant(i);
+      if (core[referenceIndex])
+        uf.Union(referenceIndex, queryCore);
+      else
+        Assign(referenceIndex, queryCore);
+    }
+  }
+}
+
+} // namespace dbscan
+} // namespace mlpack
+
+#endif
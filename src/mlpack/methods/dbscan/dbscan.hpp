@@ -17,6 +17,7 @@
 #include <mlpack/methods/range_search/range_search.hpp>
 #include <mlpack/methods/emst/union_find.hpp>
 #include "random_point_selection.hpp"
+#include "concurrent_union_find.hpp"
 #include <boost/dynamic_bitset.hpp>
 
 namespace mlpack {
@@ -59,17 +60,29 @@ class DBSCAN
    * When batchMode is false, each point will be searched iteratively, which
    * could be slower but will use less memory.
    *
+   * If corePoints is true, the standard DBSCAN definition of clusters is used
+   * instead: a point is a core point if there are at least minPoints points
+   * (including itself) within epsilon of it, the core points closer than
+   * epsilon to each other are in the same cluster, and every other point
+   * belongs to the cluster of a core point within epsilon of it (or is noise
+   * if there is none).  The core points are found by only counting the
+   * neighbors of each point, and the clusters are then merged by a parallel
+   * traversal of the tree of the range search, so the neighbors of the points
+   * are never stored and the memory used is O(n) (batchMode is then ignored).
+   *
    * @param epsilon Size of range query.
    * @param minPoints Minimum number of points for each cluster.
    * @param batchMode If true, all points are searched in batch.
    * @param rangeSearch Optional instantiated RangeSearch object.
    * @param pointSelector OptionL instantiated PointSelectionPolicy object.
+   * @param corePoints If true, only core points are merged into clusters.
    */
   DBSCAN(const double epsilon,
          const size_t minPoints,
          const bool batchMode = true,
          RangeSearchType rangeSearch = RangeSearchType(),
-         PointSelectionPolicy pointSelector = PointSelectionPolicy());
+         PointSelectionPolicy pointSelector = PointSelectionPolicy(),
+         const bool corePoints = false);
 
   /**
    * Performs DBSCAN clustering on the data, returning number of clusters
@@ -111,6 +124,23 @@ class DBSCAN
                  arma::Row<size_t>& assignments,
                  arma::mat& centroids);
 
+  /**
+   * Performs DBSCAN clustering on the dataset of the given shared tree,
+   * searching the tree itself instead of building a new one, and returning the
+   * number of clusters and also the list of cluster assignments, in the
+   * original order of the points.  The range search object is replaced by one
+   * that searches the shared tree, in the same single-tree or dual-tree mode.
+   * The clusters are the same as with the other overloads, but they may be
+   * numbered differently.
+   *
+   * @tparam TreeType Type of the tree; must be RangeSearchType::Tree.
+   * @param tree Shared tree to cluster the points of.
+   * @param assignments Vector to store cluster assignments.
+   */
+  template<typename TreeType>
+  size_t Cluster(const tree::SharedTree<TreeType>& tree,
+                 arma::Row<size_t>& assignments);
+
  private:
   //! Maximum distance between two points to be part of same cluster.
   double epsilon;
@@ -128,6 +158,21 @@ class DBSCAN
   //! Instantiated point selection policy.
   PointSelectionPolicy pointSelector;
 
+  //! Whether only core points are merged into clusters.
+  bool corePoints;
+
+  /**
+   * Performs DBSCAN clustering on the reference set the range search object
+   * has been trained on, returning the number of clusters and also the list of
+   * cluster assignments.
+   *
+   * @param data Dataset to cluster (the reference set of the range search).
+   * @param assignments Vector to store cluster assignments.
+   */
+  template<typename MatType>
+  size_t ClusterTrained(const MatType& data,
+                        arma::Row<size_t>& assignments);
+
   /**
    * Performs DBSCAN clustering on the data, returning the number of clusters and
    * also the list of cluster assignments.  This searches each point iteratively,
@@ -154,6 +199,37 @@ class DBSCAN
   template<typename MatType>
   void BatchCluster(const MatType& data,
                     emst::UnionFind& uf);
+
+  /**
+   * Performs DBSCAN clustering on the data with the standard definition of
+   * core points, returning the number of clusters and also the list of cluster
+   * assignments (SIZE_MAX for noise).
+   *
+   * @param data Dataset to cluster.
+   * @param assignments Vector to store cluster assignments.
+   */
+  template<typename MatType>
+  size_t CorePointCluster(const MatType& data,
+                          arma::Row<size_t>& assignments);
+
+  /**
+   * Merge the core points closer than epsilon to each other into clusters, and
+   * assign each other point to a core point closer than epsilon, with the
+   * search mode of the range search object (naive, single-tree or dual-tree),
+   * in parallel with OpenMP.  The points are indexed in the order of the
+   * reference set of the range search object.
+   *
+   * @param metric Instantiated metric of the range search object.
+   * @param core The core points.
+   * @param uf Union-find structure that will hold the clusters of core points.
+   * @param owners Will hold the core point each other point is assigned to, or
+   *     SIZE_MAX; must be initialized to SIZE_MAX.
+   */
+  template<typename MetricType>
+  void MergeCorePoints(MetricType& metric,
+                       const boost::dynamic_bitset<>& core,
+                       ConcurrentUnionFind& uf,
+                       std::vector<std::atomic<size_t>>& owners);
 };
 
 } // namespace dbscan
@@ -13,6 +13,11 @@
 #define MLPACK_METHODS_DBSCAN_DBSCAN_IMPL_HPP
 
 #include "dbscan.hpp"
+#include "core_point_rules.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace dbscan {
@@ -26,12 +31,14 @@ DBSCAN<RangeSearchType, PointSelectionPolicy>::DBSCAN(
     const size_t minPoints,
     const bool batchMode,
     RangeSearchType rangeSearch,
-    PointSelectionPolicy pointSelector) :
+    PointSelectionPolicy pointSelector,
+    const bool corePoints) :
     epsilon(epsilon),
     minPoints(minPoints),
     batchMode(batchMode),
     rangeSearch(rangeSearch),
-    pointSelector(pointSelector)
+    pointSelector(pointSelector),
+    corePoints(corePoints)
 {
   // Nothing to do.
 }
@@ -100,9 +107,61 @@ size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::Cluster(
     const MatType& data,
     arma::Row<size_t>& assignments)
 {
+  rangeSearch.Train(data);
+  return ClusterTrained(data, assignments);
+}
+
+/**
+ * Performs DBSCAN clustering on the dataset of a shared tree, returning the
+ * number of clusters and also the list of cluster assignments.
+ */
+template<typename RangeSearchType, typename PointSelectionPolicy>
+template<typename TreeType>
+size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::Cluster(
+    const tree::SharedTree<TreeType>& tree,
+    arma::Row<size_t>& assignments)
+{
+  static_assert(std::is_same<TreeType, typename RangeSearchType::Tree>::value,
+      "DBSCAN::Cluster(): the shared tree must be of the tree type of the "
+      "range search.");
+
+  rangeSearch = RangeSearchType(tree, rangeSearch.SingleMode(),
+      rangeSearch.Metric());
+
+  // The points are clustered in the order of the tree.
+  arma::Row<size_t> treeAssignments;
+  const size_t numClusters = ClusterTrained(tree.Dataset(), treeAssignments);
+
+  const std::vector<size_t>& oldFromNew = tree.OldFromNew();
+  if (oldFromNew.empty())
+  {
+    assignments = std::move(treeAssignments);
+  }
+  else
+  {
+    assignments.set_size(treeAssignments.n_elem);
+    for (size_t i = 0; i < treeAssignments.n_elem; ++i)
+      assignments[oldFromNew[i]] = treeAssignments[i];
+  }
+
+  return numClusters;
+}
+
+/**
+ * Performs DBSCAN clustering on the reference set of the range search object,
+ * returning the number of clusters and also the list of cluster assignments.
+ */
+template<typename RangeSearchType, typename PointSelectionPolicy>
+template<typename MatType>
+size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::ClusterTrained(
+    const MatType& data,
+    arma::Row<size_t>& assignments)
+{
+  if (corePoints)
+    return CorePointCluster(data, assignments);
+
   // Initialize the UnionFind object.
   emst::UnionFind uf(data.n_cols);
-  rangeSearch.Train(data);
 
   if (batchMode)
     BatchCluster(data, uf);
@@ -185,7 +244,6 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::BatchCluster(
   std::vector<std::vector<size_t>> neighbors;
   std::vector<std::vector<double>> distances;
   Log::Info << "Performing range search." << std::endl;
-  rangeSearch.Train(data);
   rangeSearch.Search(data, math::Range(0.0, epsilon), neighbors, distances);
   Log::Info << "Range search complete." << std::endl;
 
@@ -198,6 +256,202 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::BatchCluster(
   }
 }
 
+/**
+ * Performs DBSCAN clustering on the data with the standard definition of core
+ * points, without storing the neighbors of any point.
+ */
+template<typename RangeSearchType, typename PointSelectionPolicy>
+template<typename MatType>
+size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::CorePointCluster(
+    const MatType& data,
+    arma::Row<size_t>& assignments)
+{
+  const size_t n = data.n_cols;
+
+  // Count the neighbors of each point (not including itself).
+  Log::Info << "Counting neighbors." << std::endl;
+  arma::Col<size_t> counts;
+  rangeSearch.Count(math::Range(0.0, epsilon), counts);
+
+  // The range search may have rearranged the points when it built its tree;
+  // the clusters are merged in that order.
+  const std::vector<size_t>& oldFromNew = rangeSearch.OldFromNewReferences();
+
+  boost::dynamic_bitset<> core(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const size_t index = oldFromNew.empty() ? i : oldFromNew[i];
+    core[i] = (counts[index] + 1 >= minPoints);
+  }
+  Log::Info << core.count() << " core points found." << std::endl;
+
+  // Merge the core points into clusters and assign the other points.
+  ConcurrentUnionFind uf(n);
+  std::vector<std::atomic<size_t>> owners(n);
+  for (size_t i = 0; i < n; ++i)
+    owners[i].store(SIZE_MAX, std::memory_order_relaxed);
+
+  MergeCorePoints(rangeSearch.Metric(), core, uf, owners);
+
+  // Now number the clusters and set the assignments.
+  arma::Col<size_t> clusters(n);
+  clusters.fill(SIZE_MAX);
+  size_t numClusters = 0;
+  assignments.set_size(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const size_t index = oldFromNew.empty() ? i : oldFromNew[i];
+    size_t root = SIZE_MAX;
+    if (core[i])
+      root = uf.Find(i);
+    else if (owners[i].load(std::memory_order_relaxed) != SIZE_MAX)
+      root = uf.Find(owners[i].load(std::memory_order_relaxed));
+
+    if (root == SIZE_MAX)
+    {
+      assignments[index] = SIZE_MAX; // This point is noise.
+      continue;
+    }
+
+    if (clusters[root] == SIZE_MAX)
+      clusters[root] = numClusters++;
+    assignments[index] = clusters[root];
+  }
+
+  Log::Info << numClusters << " clusters found." << std::endl;
+
+  return numClusters;
+}
+
+/**
+ * Merge the core points into clusters and assign the other points to them, in
+ * parallel.
+ */
+template<typename RangeSearchType, typename PointSelectionPolicy>
+template<typename MetricType>
+void DBSCAN<RangeSearchType, PointSelectionPolicy>::MergeCorePoints(
+    MetricType& metric,
+    const boost::dynamic_bitset<>& core,
+    ConcurrentUnionFind& uf,
+    std::vector<std::atomic<size_t>>& owners)
+{
+  typedef typename RangeSearchType::Tree Tree;
+  typedef CorePointRules<MetricType, Tree> RuleType;
+
+  const arma::mat& dataset = rangeSearch.ReferenceSet();
+  RuleType rules(dataset, epsilon, core, uf, owners, metric);
+
+  // Each thread uses its own copy of the rules; the union-find structure and
+  // the owners are shared, and updated atomically.
+  size_t baseCases = 0;
+  size_t scores = 0;
+  if (rangeSearch.Naive())
+  {
+    // Each pair of points only needs to be visited once.
+    #pragma omp parallel reduction(+:baseCases)
+    {
+      RuleType threadRules(rules);
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(dynamic, 16)
+      for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+      #pragma omp for schedule(dynamic, 16)
+      for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
+      {
+        for (size_t j = i + 1; j < dataset.n_cols; ++j)
+          threadRules.BaseCase(i, j);
+      }
+
+      baseCases += threadRules.BaseCases();
+    }
+  }
+  else if (rangeSearch.SingleMode())
+  {
+    #pragma omp parallel reduction(+:baseCases, scores)
+    {
+      RuleType threadRules(rules);
+      typename Tree::template SingleTreeTraverser<RuleType>
+          traverser(threadRules);
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(dynamic, 16)
+      for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+      #pragma omp for schedule(dynamic, 16)
+      for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
+        traverser.Traverse(i, *rangeSearch.ReferenceTree());
+
+      baseCases += threadRules.BaseCases();
+      scores += threadRules.Scores();
+    }
+  }
+  else
+  {
+    // Split the tree into a few disjoint subtrees per thread, and traverse
+    // each of them against the whole tree.
+#ifdef HAS_OPENMP
+    const size_t numThreads = omp_get_max_threads();
+#else
+    const size_t numThreads = 1;
+#endif
+
+    std::vector<Tree*> queryNodes(1, rangeSearch.ReferenceTree());
+    while (numThreads > 1 && queryNodes.size() < 4 * numThreads)
+    {
+      // Find the subtree with the most descendants that can be split.
+      size_t largest = queryNodes.size();
+      for (size_t i = 0; i < queryNodes.size(); ++i)
+      {
+        if (queryNodes[i]->NumChildren() > 0 &&
+            (largest == queryNodes.size() || queryNodes[i]->NumDescendants() >
+            queryNodes[largest]->NumDescendants()))
+          largest = i;
+      }
+
+      if (largest == queryNodes.size())
+        break; // Only leaves are left.
+
+      Tree* node = queryNodes[largest];
+      queryNodes[largest] = &node->Child(0);
+      for (size_t i = 1; i < node->NumChildren(); ++i)
+        queryNodes.push_back(&node->Child(i));
+    }
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic) reduction(+:baseCases, scores)
+    for (intmax_t i = 0; i < (intmax_t) queryNodes.size(); ++i)
+#else
+    #pragma omp parallel for schedule(dynamic) reduction(+:baseCases, scores)
+    for (size_t i = 0; i < queryNodes.size(); ++i)
+#endif
+    {
+      RuleType threadRules(rules);
+      typename Tree::template DualTreeTraverser<RuleType>
+          traverser(threadRules);
+
+      traverser.Traverse(*queryNodes[i], *rangeSearch.ReferenceTree());
+
+      baseCases += threadRules.BaseCases();
+      scores += threadRules.Scores();
+    }
+  }
+
+  Log::Info << baseCases << " base cases and " << scores << " scores to merge "
+      << "core points." << std::endl;
+}
+
 } // namespace dbscan
 } // namespace mlpack
 
@@ -45,6 +45,13 @@ PROGRAM_INFO("DBSCAN clustering",
     " of batch search is too high.  The --naive option will force brute-force "
     "range search."
     "\n\n"
+    "With --core_points, only the points with at least --min_size points "
+    "within --epsilon (core points) are merged into clusters, and every other "
+    "point joins the cluster of a core point within --epsilon, or is labeled "
+    "as noise.  In this mode the neighbors of each point are only counted, so "
+    "the memory used does not depend on the number of neighbors, and the "
+    "clusters are merged in parallel."
+    "\n\n"
     "An example usage to run DBSCAN on the dataset in input.csv with a radius "
     "of 0.5 and a minimum cluster size of 5 is given below:"
     "\n\n"
@@ -65,6 +72,11 @@ PARAM_FLAG("single_mode", "If set, single-tree range search (not dual-tree) "
     "will be used.", "S");
 PARAM_FLAG("naive", "If set, brute-force range search (not tree-based) "
     "will be used.", "N");
+PARAM_FLAG("core_points", "If set, the standard definition of DBSCAN clusters "
+    "is used: only core points (points with at least --min_size points within "
+    "--epsilon, including themselves) are merged into clusters, and the other "
+    "points join the cluster of a core point within --epsilon or are noise.  "
+    "The neighbors of the points are counted but never stored.", "c");
 
 // Actually run the clustering, and process the output.
 template<typename RangeSearchType>
@@ -80,7 +92,7 @@ void RunDBSCAN(RangeSearchType rs = RangeSearchType())
   const size_t minSize = (size_t) CLI::GetParam<int>("min_size");
 
   DBSCAN<RangeSearchType> d(epsilon, minSize, !CLI::HasParam("single_mode"),
-      rs);
+      rs, RandomPointSelection(), CLI::HasParam("core_points"));
 
   // If possible, avoid the overhead of calculating centroids.
   arma::Row<size_t> assignments;
@@ -28,6 +28,12 @@ namespace decision_stump {
  * last bin has range up to \infty (split[i + 1] does not exist in that case).
  * Points that are below the first bin will take the label of the first bin.
  *
+ * Training sorts every dimension of the data once, and evaluates the
+ * dimensions in parallel.  A stump trained directly on a dataset keeps the
+ * sorted indices of its dimensions, so that stumps trained on the same dataset
+ * with the copy-and-train constructor (as AdaBoost does in every round) do not
+ * sort it again.
+ *
  * @tparam MatType Type of matrix that is being used (sparse or dense).
  */
 template<typename MatType = arma::mat>
@@ -53,6 +59,10 @@ class DecisionStump
    * from an already initiated decision stump, other. It appropriately sets the
    * weight vector.
    *
+   * If other was trained directly on data (the same object, which must not
+   * have been modified since), the sorted indices of its dimensions are used
+   * instead of sorting data again.
+   *
    * @param other The other initiated Decision Stump object from
    *      which we copy the values.
    * @param data The data on which to train this object on.
@@ -145,16 +155,30 @@ class DecisionStump
   //! Stores the labels for each splitting bin.
   arma::Col<size_t> binLabels;
 
+  //! The indices that sort each dimension of the dataset the stump was last
+  //! trained on directly, one column per dimension.  This is not serialized.
+  arma::Mat<arma::uword> sortedIndices;
+  //! The dataset that sortedIndices were computed for, or NULL.
+  const void* sortedData;
+
+  /**
+   * Compute the indices that sort each dimension of the given dataset (with a
+   * stable sort), one column per dimension.  The dimensions are sorted in
+   * parallel.
+   */
+  static void SortDimensions(const MatType& data,
+                             arma::Mat<arma::uword>& indices);
+
   /**
    * Sets up dimension as if it were splitting on it and finds entropy when
    * splitting on dimension.
    *
-   * @param dimension A row from the training data, which might be a
-   *     candidate for the splitting dimension.
+   * @param sortedIndex The indices that sort a row from the training data,
+   *     which might be a candidate for the splitting dimension.
    * @tparam UseWeights Whether we need to run a weighted Decision Stump.
    */
-  template<bool UseWeights, typename VecType>
-  double SetupSplitDimension(const VecType& dimension,
+  template<bool UseWeights>
+  double SetupSplitDimension(const arma::uvec& sortedIndex,
                              const arma::Row<size_t>& labels,
                              const arma::rowvec& weightD);
 
@@ -164,9 +188,11 @@ class DecisionStump
    *
    * @tparam dimension dimension is the dimension decided by the constructor
    *      on which we now train the decision stump.
+   * @param sortedIndex The indices that sort the dimension.
    */
   template<typename VecType>
   void TrainOnDim(const VecType& dimension,
+                  const arma::uvec& sortedIndex,
                   const arma::Row<size_t>& labels);
 
   /**
@@ -184,14 +210,6 @@ class DecisionStump
   template<typename VecType>
   double CountMostFreq(const VecType& subCols);
 
-  /**
-   * Returns 1 if all the values of featureRow are not same.
-   *
-   * @param featureRow The dimension which is checked for identical values.
-   */
-  template<typename VecType>
-  int IsDistinct(const VecType& featureRow);
-
   /**
    * Calculate the entropy of the given dimension.
    *
@@ -211,13 +229,16 @@ class DecisionStump
    * @param data Dataset to train on.
    * @param labels Labels for dataset.
    * @param weights Weights for this set of labels.
+   * @param indices The indices that sort each dimension of the dataset, as
+   *      given by SortDimensions().
    * @tparam UseWeights If true, the weights in the weight vector will be used
    *      (otherwise they are ignored).
    */
   template<bool UseWeights>
   void Train(const MatType& data,
              const arma::Row<size_t>& labels,
-             const arma::rowvec& weights);
+             const arma::rowvec& weights,
+             const arma::Mat<arma::uword>& indices);
 };
 
 } // namespace decision_stump
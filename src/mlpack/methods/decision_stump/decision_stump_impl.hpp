@@ -33,10 +33,14 @@ DecisionStump<MatType>::DecisionStump(const MatType& data,
                                       const size_t classes,
                                       const size_t bucketSize) :
     classes(classes),
-    bucketSize(bucketSize)
+    bucketSize(bucketSize),
+    sortedData(NULL)
 {
+  SortDimensions(data, sortedIndices);
+  sortedData = &data;
+
   arma::rowvec weights;
-  Train<false>(data, labels, weights);
+  Train<false>(data, labels, weights, sortedIndices);
 }
 
 /**
@@ -48,7 +52,8 @@ DecisionStump<MatType>::DecisionStump() :
     bucketSize(0),
     splitDimension(0),
     split(1),
-    binLabels(1)
+    binLabels(1),
+    sortedData(NULL)
 {
   split[0] = DBL_MAX;
   binLabels[0] = 0;
@@ -66,9 +71,12 @@ void DecisionStump<MatType>::Train(const MatType& data,
   this->classes = classes;
   this->bucketSize = bucketSize;
 
+  SortDimensions(data, sortedIndices);
+  sortedData = &data;
+
   // Pass to unweighted training function.
   arma::rowvec weights;
-  Train<false>(data, labels, weights);
+  Train<false>(data, labels, weights, sortedIndices);
 }
 
 /**
@@ -86,8 +94,11 @@ void DecisionStump<MatType>::Train(const MatType& data,
   this->classes = classes;
   this->bucketSize = bucketSize;
 
+  SortDimensions(data, sortedIndices);
+  sortedData = &data;
+
   // Pass to weighted training function.
-  Train<true>(data, labels, weights);
+  Train<true>(data, labels, weights, sortedIndices);
 }
 
 /**
@@ -101,40 +112,83 @@ template<typename MatType>
 template<bool UseWeights>
 void DecisionStump<MatType>::Train(const MatType& data,
                                    const arma::Row<size_t>& labels,
-                                   const arma::rowvec& weights)
+                                   const arma::rowvec& weights,
+                                   const arma::Mat<arma::uword>& indices)
 {
-  // If classLabels are not all identical, proceed with training.
-  size_t bestDim = 0;
-  double entropy;
   const double rootEntropy = CalculateEntropy<UseWeights>(labels, weights);
 
-  double gain, bestGain = 0.0;
+  // Go through each dimension of the data in parallel.  Dimensions with
+  // identical values are not candidates, and keep a gain of 0, which is never
+  // chosen.
+  arma::vec gains(data.n_rows, arma::fill::zeros);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.  If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #ifdef _WIN32
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t i = 0; i < (intmax_t) data.n_rows; i++)
+  #else
+  #pragma omp parallel for schedule(dynamic)
   for (size_t i = 0; i < data.n_rows; i++)
+  #endif
   {
-    // Go through each dimension of the data.
-    if (IsDistinct(data.row(i)))
+    const arma::uvec sortedIndex(const_cast<arma::uword*>(indices.colptr(i)),
+        indices.n_rows, false, true);
+
+    // The values of the dimension are all identical if its smallest and
+    // largest values are.
+    if (data(i, sortedIndex[0]) != data(i, sortedIndex[data.n_cols - 1]))
     {
       // For each dimension with non-identical values, treat it as a potential
       // splitting dimension and calculate entropy if split on it.
-      entropy = SetupSplitDimension<UseWeights>(data.row(i), labels, weights);
-
-      gain = rootEntropy - entropy;
-      // Find the dimension with the best entropy so that the gain is
-      // maximized.
+      gains[i] = rootEntropy - SetupSplitDimension<UseWeights>(sortedIndex,
+          labels, weights);
+    }
+  }
 
-      // We are maximizing gain, which is what is returned from
-      // SetupSplitDimension().
-      if (gain < bestGain)
-      {
-        bestDim = i;
-        bestGain = gain;
-      }
+  // Find the dimension with the best entropy so that the gain is maximized;
+  // ties go to the first dimension.
+  size_t bestDim = 0;
+  double bestGain = 0.0;
+  for (size_t i = 0; i < data.n_rows; i++)
+  {
+    // We are maximizing gain, which is what is returned from
+    // SetupSplitDimension().
+    if (gains[i] < bestGain)
+    {
+      bestDim = i;
+      bestGain = gains[i];
     }
   }
   splitDimension = bestDim;
 
   // Once the splitting column/dimension has been decided, train on it.
-  TrainOnDim(data.row(splitDimension), labels);
+  const arma::uvec sortedIndex(const_cast<arma::uword*>(
+      indices.colptr(splitDimension)), indices.n_rows, false, true);
+  TrainOnDim(data.row(splitDimension), sortedIndex, labels);
+}
+
+/**
+ * Compute the indices that sort each dimension of the dataset.
+ */
+template<typename MatType>
+void DecisionStump<MatType>::SortDimensions(const MatType& data,
+                                            arma::Mat<arma::uword>& indices)
+{
+  indices.set_size(data.n_cols, data.n_rows);
+
+  #ifdef _WIN32
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t i = 0; i < (intmax_t) data.n_rows; i++)
+  #else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < data.n_rows; i++)
+  #endif
+  {
+    // This sort is stable.
+    indices.col(i) = arma::stable_sort_index(data.row(i).t());
+  }
 }
 
 /**
@@ -188,9 +242,23 @@ DecisionStump<MatType>::DecisionStump(const DecisionStump<>& other,
                                       const arma::Row<size_t>& labels,
                                       const arma::rowvec& weights) :
     classes(other.classes),
-    bucketSize(other.bucketSize)
+    bucketSize(other.bucketSize),
+    sortedData(NULL)
 {
-  Train<true>(data, labels, weights);
+  // Use the sorted dimensions of other if it was trained on this dataset.  The
+  // indices are not kept, since this stump may be stored (for instance by
+  // AdaBoost) long after training.
+  if (other.sortedData == &data && other.sortedIndices.n_rows == data.n_cols &&
+      other.sortedIndices.n_cols == data.n_rows)
+  {
+    Train<true>(data, labels, weights, other.sortedIndices);
+  }
+  else
+  {
+    arma::Mat<arma::uword> indices;
+    SortDimensions(data, indices);
+    Train<true>(data, labels, weights, indices);
+  }
 }
 
 /**
@@ -221,29 +289,27 @@ void DecisionStump<MatType>::Serialize(Archive& ar,
  * @param UseWeights Whether we need to run a weighted Decision Stump.
  */
 template<typename MatType>
-template<bool UseWeights, typename VecType>
+template<bool UseWeights>
 double DecisionStump<MatType>::SetupSplitDimension(
-    const VecType& dimension,
+    const arma::uvec& sortedIndex,
     const arma::Row<size_t>& labels,
     const arma::rowvec& weights)
 {
   size_t i, count, begin, end;
   double entropy = 0.0;
 
-  // Store the indices of the sorted dimension to build a vector of sorted
-  // labels.  This sort is stable.
-  arma::uvec sortedIndexDim = arma::stable_sort_index(dimension.t());
+  // Use the indices of the sorted dimension to build a vector of sorted
+  // labels.
+  arma::Row<size_t> sortedLabels(sortedIndex.n_elem);
+  arma::rowvec sortedWeights(sortedIndex.n_elem);
 
-  arma::Row<size_t> sortedLabels(dimension.n_elem);
-  arma::rowvec sortedWeights(dimension.n_elem);
-
-  for (i = 0; i < dimension.n_elem; i++)
+  for (i = 0; i < sortedIndex.n_elem; i++)
   {
-    sortedLabels(i) = labels(sortedIndexDim(i));
+    sortedLabels(i) = labels(sortedIndex(i));
 
     // Apply weights if necessary.
     if (UseWeights)
-      sortedWeights(i) = weights(sortedIndexDim(i));
+      sortedWeights(i) = weights(sortedIndex(i));
   }
 
   i = 0;
@@ -313,17 +379,23 @@ double DecisionStump<MatType>::SetupSplitDimension(
 template<typename MatType>
 template<typename VecType>
 void DecisionStump<MatType>::TrainOnDim(const VecType& dimension,
+                                        const arma::uvec& sortedIndex,
                                         const arma::Row<size_t>& labels)
 {
   size_t i, count, begin, end;
 
-  typename MatType::row_type sortedSplitDim = arma::sort(dimension);
-  arma::uvec sortedSplitIndexDim = arma::stable_sort_index(dimension.t());
+  typename MatType::row_type sortedSplitDim(dimension.n_elem);
   arma::Row<size_t> sortedLabels(dimension.n_elem);
-  sortedLabels.fill(0);
 
   for (i = 0; i < dimension.n_elem; i++)
-    sortedLabels(i) = labels(sortedSplitIndexDim(i));
+  {
+    sortedSplitDim(i) = dimension(sortedIndex(i));
+    sortedLabels(i) = labels(sortedIndex(i));
+  }
+
+  // Forget the bins of any previous training.
+  split.reset();
+  binLabels.reset();
 
   arma::rowvec subCols;
   double mostFreq;
@@ -438,22 +510,6 @@ double DecisionStump<MatType>::CountMostFreq(const VecType& subCols)
   return mostFreq;
 }
 
-/**
- * Returns 1 if all the values of featureRow are not the same.
- *
- * @param featureRow The dimension which is checked for identical values.
- */
-template<typename MatType>
-template<typename VecType>
-int DecisionStump<MatType>::IsDistinct(const VecType& featureRow)
-{
-  typename VecType::elem_type val = featureRow(0);
-  for (size_t i = 1; i < featureRow.n_elem; ++i)
-    if (val != featureRow(i))
-      return 1;
-  return 0;
-}
-
 /**
  * Calculate entropy of dimension.
  *
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_DECISION_TREE_ALL_CATEGORICAL_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "flat_tree.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -85,6 +86,24 @@ class AllCategoricalSplit
       const ElemType& point,
       const arma::Col<ElemType>& classProbabilities,
       const AuxiliarySplitInfo<ElemType>& /* aux */);
+
+  /**
+   * Add the split to the given flat tree.
+   *
+   * @param dimension Dimension of the split.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux Auxiliary information for the split.
+   * @param flat Flat tree to add the split to.
+   */
+  template<typename ElemType>
+  static void Freeze(const size_t dimension,
+                     const arma::Col<ElemType>& classProbabilities,
+                     const AuxiliarySplitInfo<ElemType>& aux,
+                     FlatTree<ElemType>& flat)
+  {
+    flat.AddSplit(FlatTree<ElemType>::CATEGORICAL, dimension,
+        NumChildren(classProbabilities, aux));
+  }
 };
 
 } // namespace tree
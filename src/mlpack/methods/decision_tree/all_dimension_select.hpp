@@ -41,6 +41,12 @@ class AllDimensionSelect
    */
   size_t Next() { return ++i; }
 
+  /**
+   * Seed the random number generator; this policy is not random, so there is
+   * nothing to do.
+   */
+  static void Seed(const size_t /* seed */) { }
+
  private:
   //! The current dimension we are looking at.
   size_t i;
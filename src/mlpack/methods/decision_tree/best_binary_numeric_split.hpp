@@ -13,15 +13,19 @@
 #define MLPACK_METHODS_DECISION_TREE_BEST_BINARY_NUMERIC_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "flat_tree.hpp"
 
 namespace mlpack {
 namespace tree {
 
 /**
  * The BestBinaryNumericSplit is a splitting function for decision trees that
- * will exhaustively search a numeric dimension for the best binary split.
+ * will exhaustively search a numeric dimension for the best binary split.  The
+ * points are sorted once, and the class counts of the two children are updated
+ * as the split point moves through them, so the search takes O(n log n) time.
  *
- * @tparam FitnessFunction Fitness function to use to calculate gain.
+ * @tparam FitnessFunction Fitness function to use to calculate gain; it must
+ *     provide EvaluatePtr(), which calculates the gain from class counts.
  */
 template<typename FitnessFunction>
 class BestBinaryNumericSplit
@@ -83,6 +87,24 @@ class BestBinaryNumericSplit
       const ElemType& point,
       const arma::Col<ElemType>& classProbabilities,
       const AuxiliarySplitInfo<ElemType>& /* aux */);
+
+  /**
+   * Add the split to the given flat tree.
+   *
+   * @param dimension Dimension of the split.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   * @param flat Flat tree to add the split to.
+   */
+  template<typename ElemType>
+  static void Freeze(const size_t dimension,
+                     const arma::Col<ElemType>& classProbabilities,
+                     const AuxiliarySplitInfo<ElemType>& /* aux */,
+                     FlatTree<ElemType>& flat)
+  {
+    flat.AddSplit(FlatTree<ElemType>::NUMERIC_LESS_EQUAL, dimension, 2,
+        classProbabilities.memptr(), 1);
+  }
 };
 
 } // namespace tree
@@ -1,5 +1,5 @@
 /**
- * @file best_binary_numeric_split_impl.hpl
+ * @file best_binary_numeric_split_impl.hpp
  * @author Ryan Curtin
  *
  * Implementation of strategy that finds the best binary numeric split.
@@ -33,50 +33,68 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
 
   // Next, sort the data.
   arma::uvec sortedIndices = arma::sort_index(data);
-  arma::Row<size_t> sortedLabels(labels.n_elem);
-  arma::rowvec sortedWeights;
-  for (size_t i = 0; i < sortedLabels.n_elem; ++i)
-    sortedLabels[i] = labels[sortedIndices[i]];
 
-  // Only initialize if we are using weights.
-  if (UseWeights)
+  // The class counts (or class weight sums) of the points to the left and to
+  // the right of the split point are updated as the split point moves through
+  // the sorted points, so that each split point takes O(numClasses) time.  At
+  // first, all points are on the right.
+  arma::vec classCounts(2 * numClasses, arma::fill::zeros);
+  double* leftCounts = classCounts.memptr();
+  double* rightCounts = leftCounts + numClasses;
+  double leftWeights = 0.0;
+  double rightWeights = 0.0;
+  for (size_t i = 0; i < data.n_elem; ++i)
   {
-    sortedWeights.set_size(sortedLabels.n_elem);
-    // The weights must keep the same order of labels
-    for (size_t i = 0; i < sortedLabels.n_elem; ++i)
-      sortedWeights[i] = weights[sortedIndices[i]];
+    if (UseWeights)
+    {
+      rightCounts[labels[i]] += weights[i];
+      rightWeights += weights[i];
+    }
+    else
+    {
+      rightCounts[labels[i]]++;
+    }
   }
 
   // Loop through all possible split points, choosing the best one.  Also, force
   // a minimum leaf size of 1 (empty children don't make sense).
   double bestFoundGain = bestGain;
   const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
-  for (size_t index = minimum; index < data.n_elem - (minimum - 1); ++index)
+  for (size_t index = 1; index < data.n_elem - (minimum - 1); ++index)
   {
+    // Move the point before the split point to the left.
+    const size_t moved = sortedIndices[index - 1];
+    if (UseWeights)
+    {
+      leftCounts[labels[moved]] += weights[moved];
+      rightCounts[labels[moved]] -= weights[moved];
+      leftWeights += weights[moved];
+      rightWeights -= weights[moved];
+    }
+    else
+    {
+      leftCounts[labels[moved]]++;
+      rightCounts[labels[moved]]--;
+    }
+
+    // Make sure that the left child is big enough.
+    if (index < minimum)
+      continue;
+
     // Make sure that the value has changed.
     if (data[sortedIndices[index]] == data[sortedIndices[index - 1]])
       continue;
 
-    // Calculate the gain for the left and right child.  Only use weights if
-    // needed.
-    const double leftGain = UseWeights ?
-        FitnessFunction::template Evaluate<true>(sortedLabels.subvec(0,
-            index - 1), numClasses, sortedWeights.subvec(0, index - 1)) :
-        FitnessFunction::template Evaluate<false>(sortedLabels.subvec(0,
-            index - 1), numClasses, sortedWeights /* ignored */);
-    const double rightGain = UseWeights ?
-        FitnessFunction::template Evaluate<true>(sortedLabels.subvec(index,
-            sortedLabels.n_elem - 1), numClasses, sortedWeights.subvec(index,
-            sortedLabels.n_elem - 1)) :
-        FitnessFunction::template Evaluate<false>(sortedLabels.subvec(index,
-            sortedLabels.n_elem - 1), numClasses, sortedWeights /* ignored */);
+    // Calculate the gain for the left and right child.
+    const double leftGain = FitnessFunction::EvaluatePtr(leftCounts,
+        numClasses, UseWeights ? leftWeights : (double) index);
+    const double rightGain = FitnessFunction::EvaluatePtr(rightCounts,
+        numClasses, UseWeights ? rightWeights :
+        (double) (data.n_elem - index));
 
     double gain;
     if (UseWeights)
     {
-      const double leftWeights = arma::accu(sortedWeights.subvec(0, index - 1));
-      const double rightWeights = arma::accu(sortedWeights.subvec(index,
-          sortedWeights.n_elem - 1));
       const double fullWeight = leftWeights + rightWeights;
 
       gain = (leftWeights / fullWeight) * leftGain +
@@ -85,7 +103,7 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
     else
     {
       // Calculate the fraction of points in the left and right children.
-      const double leftRatio = double(index) / double(sortedLabels.n_elem);
+      const double leftRatio = double(index) / double(data.n_elem);
       const double rightRatio = 1.0 - leftRatio;
 
       // Calculate the gain at this split point.
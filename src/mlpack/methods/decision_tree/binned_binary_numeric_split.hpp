@@ -0,0 +1,141 @@
+/**
+ * @file binned_binary_numeric_split.hpp
+ *
+ * A tree splitter that finds the best binary numeric split between the bins of
+ * a histogram of the points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_BINNED_BINARY_NUMERIC_SPLIT_HPP
+#define MLPACK_METHODS_DECISION_TREE_BINNED_BINARY_NUMERIC_SPLIT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "flat_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The BinnedBinaryNumericSplit is a splitting function for decision trees that
+ * searches a numeric dimension for the best binary split, like
+ * BestBinaryNumericSplit, but only considers split points between the bins of
+ * a histogram of the points.  The range of the values of the points in the node
+ * is divided into NumBins bins of equal width, and one pass over the points
+ * collects the class counts of each bin; no sorting is done, so the search
+ * takes O(n + NumBins * numClasses) time.  The split value is halfway between
+ * the largest value on the left and the smallest value on the right, so each
+ * point goes to the child it was counted in.
+ *
+ * To use this with DecisionTree with the default number of bins, use
+ * HistogramBinaryNumericSplit, which takes only the fitness function:
+ *
+ * @code
+ * DecisionTree<GiniGain, HistogramBinaryNumericSplit> tree(data, labels,
+ *     numClasses);
+ * @endcode
+ *
+ * @tparam FitnessFunction Fitness function to use to calculate gain; it must
+ *     provide EvaluatePtr(), which calculates the gain from class counts.
+ * @tparam NumBins Number of bins of the histogram.
+ */
+template<typename FitnessFunction, size_t NumBins = 64>
+class BinnedBinaryNumericSplit
+{
+ public:
+  // No extra info needed for split.
+  template<typename ElemType>
+  class AuxiliarySplitInfo { };
+
+  /**
+   * Check if we can split a node.  If we can split a node in a way that
+   * improves on 'bestGain', then we return the improved gain.  Otherwise we
+   * return the value 'bestGain'.  If a split is made, then classProbabilities
+   * and aux may be modified.
+   *
+   * @param bestGain Best gain seen so far (we'll only split if we find gain
+   *      better than this).
+   * @param data The dimension of data points to check for a split in.
+   * @param labels Labels for each point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of the points.
+   * @param minimumLeafSize Minimum number of points in a leaf node for
+   *      splitting.
+   * @param classProbabilities Class probabilities vector, which may be filled
+   *      with split information a successful split.
+   * @param aux Auxiliary split information, which may be modified on a
+   *      successful split.
+   */
+  template<bool UseWeights, typename VecType, typename WeightVecType>
+  static double SplitIfBetter(
+      const double bestGain,
+      const VecType& data,
+      const arma::Row<size_t>& labels,
+      const size_t numClasses,
+      const WeightVecType& weights,
+      const size_t minimumLeafSize,
+      arma::Col<typename VecType::elem_type>& classProbabilities,
+      AuxiliarySplitInfo<typename VecType::elem_type>& aux);
+
+  /**
+   * Returns 2, since the binary split always has two children.
+   */
+  template<typename ElemType>
+  static size_t NumChildren(const arma::Col<ElemType>& /* classProbabilities */,
+                            const AuxiliarySplitInfo<ElemType>& /* aux */)
+  {
+    return 2;
+  }
+
+  /**
+   * Given a point, calculate which child it should go to (left or right).
+   *
+   * @param point Point to calculate direction of.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   */
+  template<typename ElemType>
+  static size_t CalculateDirection(
+      const ElemType& point,
+      const arma::Col<ElemType>& classProbabilities,
+      const AuxiliarySplitInfo<ElemType>& /* aux */)
+  {
+    if (point <= classProbabilities[0])
+      return 0; // Go left.
+    else
+      return 1; // Go right.
+  }
+
+  /**
+   * Add the split to the given flat tree.
+   *
+   * @param dimension Dimension of the split.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   * @param flat Flat tree to add the split to.
+   */
+  template<typename ElemType>
+  static void Freeze(const size_t dimension,
+                     const arma::Col<ElemType>& classProbabilities,
+                     const AuxiliarySplitInfo<ElemType>& /* aux */,
+                     FlatTree<ElemType>& flat)
+  {
+    flat.AddSplit(FlatTree<ElemType>::NUMERIC_LESS_EQUAL, dimension, 2,
+        classProbabilities.memptr(), 1);
+  }
+};
+
+//! The BinnedBinaryNumericSplit with the default number of bins, which can be
+//! given to DecisionTree as the NumericSplitType.
+template<typename FitnessFunction>
+using HistogramBinaryNumericSplit = BinnedBinaryNumericSplit<FitnessFunction>;
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "binned_binary_numeric_split_impl.hpp"
+
+#endif
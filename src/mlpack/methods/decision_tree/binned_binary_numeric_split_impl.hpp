@@ -0,0 +1,139 @@
+/**
+ * @file binned_binary_numeric_split_impl.hpp
+ *
+ * Implementation of the strategy that finds the best binary numeric split
+ * between the bins of a histogram.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_BINNED_BINARY_NUMERIC_SPLIT_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_BINNED_BINARY_NUMERIC_SPLIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "binned_binary_numeric_split.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction, size_t NumBins>
+template<bool UseWeights, typename VecType, typename WeightVecType>
+double BinnedBinaryNumericSplit<FitnessFunction, NumBins>::SplitIfBetter(
+    const double bestGain,
+    const VecType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const WeightVecType& weights,
+    const size_t minimumLeafSize,
+    arma::Col<typename VecType::elem_type>& classProbabilities,
+    AuxiliarySplitInfo<typename VecType::elem_type>& /* aux */)
+{
+  typedef typename VecType::elem_type ElemType;
+
+  // First sanity check: if we don't have enough points, we can't split.
+  if (data.n_elem < (minimumLeafSize * 2) || data.n_elem == 0)
+    return bestGain;
+
+  // If all the values are the same, there is nothing to split.
+  const ElemType minValue = arma::min(data);
+  const ElemType maxValue = arma::max(data);
+  if (minValue == maxValue)
+    return bestGain;
+
+  // Collect the class counts (or class weight sums), the number of points, and
+  // the smallest and largest value of each bin.  Equal values always fall in
+  // the same bin, and the bins are ordered by value.
+  const double scale = double(NumBins) / (double(maxValue) - double(minValue));
+  arma::mat binCounts(numClasses, NumBins, arma::fill::zeros);
+  arma::Col<size_t> binPoints(NumBins, arma::fill::zeros);
+  arma::Col<ElemType> binMin(NumBins);
+  arma::Col<ElemType> binMax(NumBins);
+  for (size_t i = 0; i < data.n_elem; ++i)
+  {
+    const size_t bin = std::min((size_t) ((double(data[i]) -
+        double(minValue)) * scale), NumBins - 1);
+    if (binPoints[bin] == 0)
+    {
+      binMin[bin] = data[i];
+      binMax[bin] = data[i];
+    }
+    else
+    {
+      binMin[bin] = std::min(binMin[bin], data[i]);
+      binMax[bin] = std::max(binMax[bin], data[i]);
+    }
+
+    binCounts(labels[i], bin) += UseWeights ? weights[i] : 1.0;
+    ++binPoints[bin];
+  }
+
+  // At first, all points are on the right.
+  arma::vec leftCounts(numClasses, arma::fill::zeros);
+  arma::vec rightCounts = arma::sum(binCounts, 1);
+  double leftWeights = 0.0;
+  double rightWeights = arma::accu(rightCounts);
+  size_t leftPoints = 0;
+
+  // Loop through the split points between each non-empty bin and the next
+  // non-empty bin, choosing the best one.  Also, force a minimum leaf size of 1
+  // (empty children don't make sense).
+  double bestFoundGain = bestGain;
+  const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
+  size_t left = 0;
+  while (left < NumBins && binPoints[left] == 0)
+    ++left;
+  while (left < NumBins)
+  {
+    size_t right = left + 1;
+    while (right < NumBins && binPoints[right] == 0)
+      ++right;
+    if (right == NumBins)
+      break;
+
+    // Move the left bin to the left child.
+    leftCounts += binCounts.col(left);
+    rightCounts -= binCounts.col(left);
+    leftWeights += arma::accu(binCounts.col(left));
+    rightWeights -= arma::accu(binCounts.col(left));
+    leftPoints += binPoints[left];
+    const size_t rightPoints = data.n_elem - leftPoints;
+    if (rightPoints < minimum)
+      break;
+
+    if (leftPoints >= minimum)
+    {
+      // Calculate the gain for the left and right child.
+      const double leftGain = FitnessFunction::EvaluatePtr(
+          leftCounts.memptr(), numClasses, leftWeights);
+      const double rightGain = FitnessFunction::EvaluatePtr(
+          rightCounts.memptr(), numClasses, rightWeights);
+
+      const double leftRatio = UseWeights ?
+          leftWeights / (leftWeights + rightWeights) :
+          double(leftPoints) / double(data.n_elem);
+      const double gain = leftRatio * leftGain + (1.0 - leftRatio) * rightGain;
+
+      if (gain > bestFoundGain || gain == 0.0)
+      {
+        bestFoundGain = gain;
+        classProbabilities.set_size(1);
+        classProbabilities[0] = (binMax[left] + binMin[right]) / 2.0;
+
+        // No split will be better than this one.
+        if (gain == 0.0)
+          return gain;
+      }
+    }
+
+    left = right;
+  }
+
+  return bestFoundGain;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
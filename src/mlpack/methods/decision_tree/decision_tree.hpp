@@ -16,9 +16,13 @@
 #include <mlpack/prereqs.hpp>
 #include "gini_gain.hpp"
 #include "best_binary_numeric_split.hpp"
+#include "binned_binary_numeric_split.hpp"
 #include "all_categorical_split.hpp"
 #include "all_dimension_select.hpp"
+#include "multiple_random_dimension_select.hpp"
+#include "flat_tree.hpp"
 #include <type_traits>
+#include <queue>
 
 namespace mlpack {
 namespace tree {
@@ -317,6 +321,10 @@ class DecisionTree :
   //! Get the number of children.
   size_t NumChildren() const { return children.size(); }
 
+  //! Get the class probabilities of a leaf.  If the node has children, this
+  //! holds split information instead.
+  const arma::vec& ClassProbabilities() const { return classProbabilities; }
+
   //! Get the child of the given index.
   const DecisionTree& Child(const size_t i) const { return *children[i]; }
   //! Modify the child of the given index (be careful!).
@@ -332,6 +340,13 @@ class DecisionTree :
   template<typename VecType>
   size_t CalculateDirection(const VecType& point) const;
 
+  /**
+   * Convert the trained tree into a FlatTree: a contiguous array of nodes that
+   * classifies batches of points faster than the tree.  The flat tree does not
+   * change if this tree is trained again.
+   */
+  FlatTree<ElemType> Freeze() const;
+
  private:
   //! The vector of children.
   std::vector<DecisionTree*> children;
@@ -533,45 +533,88 @@ void DecisionTree<FitnessFunction,
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = datasetInfo.Dimensionality(); // This means "no split".
+
+  // The dimensions are searched in parallel, so first collect them.
+  std::vector<size_t> dims;
   DimensionSelectionType dimensions(datasetInfo.Dimensionality());
   for (size_t i = dimensions.Begin(); i != dimensions.End();
        i = dimensions.Next())
+    dims.push_back(i);
+
+  // Each thread finds the best split of its dimensions, and then the best split
+  // over all threads is taken (the first dimension wins ties, as it would if
+  // the dimensions were searched in order).  Small nodes are not worth the
+  // overhead of a parallel region.
+  const double nodeGain = bestGain;
+  #pragma omp parallel if (count >= 1024)
   {
-    double dimGain = -DBL_MAX;
-    if (datasetInfo.Type(i) == data::Datatype::categorical)
-    {
-      dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(bestGain,
-          data.cols(begin, begin + count - 1).row(i),
-          datasetInfo.NumMappings(i),
-          labels.subvec(begin, begin + count - 1),
-          numClasses,
-          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-          minimumLeafSize,
-          classProbabilities,
-          *this);
-    }
-    else if (datasetInfo.Type(i) == data::Datatype::numeric)
+    double threadGain = nodeGain;
+    size_t threadDim = datasetInfo.Dimensionality();
+    arma::vec threadProbabilities;
+    NumericAuxiliarySplitInfo threadNumericAux;
+    CategoricalAuxiliarySplitInfo threadCategoricalAux;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t d = 0; d < (intmax_t) dims.size(); ++d)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t d = 0; d < dims.size(); ++d)
+#endif
     {
-      dimGain = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
-          data.cols(begin, begin + count - 1).row(i),
-          labels.subvec(begin, begin + count - 1),
-          numClasses,
-          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-          minimumLeafSize,
-          classProbabilities,
-          *this);
+      // If the gain is the best possible, no need to keep looking.
+      if (threadGain == 0.0)
+        continue;
+
+      const size_t i = dims[d];
+      double dimGain = -DBL_MAX;
+      if (datasetInfo.Type(i) == data::Datatype::categorical)
+      {
+        dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(
+            threadGain,
+            data.cols(begin, begin + count - 1).row(i),
+            datasetInfo.NumMappings(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            threadProbabilities,
+            threadCategoricalAux);
+      }
+      else if (datasetInfo.Type(i) == data::Datatype::numeric)
+      {
+        dimGain = NumericSplit::template SplitIfBetter<UseWeights>(threadGain,
+            data.cols(begin, begin + count - 1).row(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            threadProbabilities,
+            threadNumericAux);
+      }
+
+      // Was there an improvement?  If so mark that it's the new best dimension.
+      if (dimGain > threadGain)
+      {
+        threadDim = i;
+        threadGain = dimGain;
+      }
     }
 
-    // Was there an improvement?  If so mark that it's the new best dimension.
-    if (dimGain > bestGain)
+    #pragma omp critical
     {
-      bestDim = i;
-      bestGain = dimGain;
+      if (threadDim != datasetInfo.Dimensionality() && (threadGain > bestGain ||
+          (threadGain == bestGain && threadDim < bestDim)))
+      {
+        bestDim = threadDim;
+        bestGain = threadGain;
+        classProbabilities = threadProbabilities;
+        NumericAuxiliarySplitInfo::operator=(threadNumericAux);
+        CategoricalAuxiliarySplitInfo::operator=(threadCategoricalAux);
+      }
     }
-
-    // If the gain is the best possible, no need to keep looking.
-    if (bestGain == 0.0)
-      break;
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -697,29 +740,71 @@ void DecisionTree<FitnessFunction,
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = data.n_rows; // This means "no split".
-  for (size_t i = 0; i < data.n_rows; ++i)
+
+  // The dimensions are searched in parallel, so first collect them.
+  std::vector<size_t> dims;
+  DimensionSelectionType dimensions(data.n_rows);
+  for (size_t i = dimensions.Begin(); i != dimensions.End();
+       i = dimensions.Next())
+    dims.push_back(i);
+
+  // Each thread finds the best split of its dimensions, and then the best split
+  // over all threads is taken (the first dimension wins ties, as it would if
+  // the dimensions were searched in order).  Small nodes are not worth the
+  // overhead of a parallel region.
+  const double nodeGain = bestGain;
+  #pragma omp parallel if (count >= 1024)
   {
-    const double dimGain = NumericSplitType<FitnessFunction>::template
-        SplitIfBetter<UseWeights>(bestGain,
-                                  data.cols(begin, begin + count - 1).row(i),
-                                  labels.cols(begin, begin + count - 1),
-                                  numClasses,
-                                  UseWeights ?
-                                      weights.cols(begin, begin + count - 1) :
-                                      weights,
-                                  minimumLeafSize,
-                                  classProbabilities,
-                                  *this);
-
-    if (dimGain > bestGain)
+    double threadGain = nodeGain;
+    size_t threadDim = data.n_rows;
+    arma::vec threadProbabilities;
+    NumericAuxiliarySplitInfo threadAux;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t d = 0; d < (intmax_t) dims.size(); ++d)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t d = 0; d < dims.size(); ++d)
+#endif
     {
-      bestDim = i;
-      bestGain = dimGain;
+      // If the gain is the best possible, no need to keep looking.
+      if (threadGain == 0.0)
+        continue;
+
+      const size_t i = dims[d];
+      const double dimGain = NumericSplitType<FitnessFunction>::template
+          SplitIfBetter<UseWeights>(threadGain,
+                                    data.cols(begin, begin + count - 1).row(i),
+                                    labels.cols(begin, begin + count - 1),
+                                    numClasses,
+                                    UseWeights ?
+                                        weights.cols(begin, begin + count - 1) :
+                                        weights,
+                                    minimumLeafSize,
+                                    threadProbabilities,
+                                    threadAux);
+
+      if (dimGain > threadGain)
+      {
+        threadDim = i;
+        threadGain = dimGain;
+      }
     }
 
-    // If the gain is the best possible, no need to keep looking.
-    if (bestGain == 0.0)
-      break;
+    #pragma omp critical
+    {
+      if (threadDim != data.n_rows && (threadGain > bestGain ||
+          (threadGain == bestGain && threadDim < bestDim)))
+      {
+        bestDim = threadDim;
+        bestGain = threadGain;
+        classProbabilities = threadProbabilities;
+        NumericAuxiliarySplitInfo::operator=(threadAux);
+      }
+    }
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -983,6 +1068,60 @@ size_t DecisionTree<FitnessFunction,
         classProbabilities, *this);
 }
 
+//! Convert the tree into a flat tree.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+FlatTree<ElemType> DecisionTree<FitnessFunction,
+                                NumericSplitType,
+                                CategoricalSplitType,
+                                DimensionSelectionType,
+                                ElemType,
+                                NoRecursion>::Freeze() const
+{
+  // Any leaf holds the probability of each class.
+  const DecisionTree* leaf = this;
+  while (leaf->NumChildren() != 0)
+    leaf = leaf->children[0];
+  FlatTree<ElemType> flat(leaf->classProbabilities.n_elem);
+
+  // The nodes are added in breadth-first order, so that the children of each
+  // node are stored together.
+  std::queue<const DecisionTree*> queue;
+  queue.push(this);
+  while (!queue.empty())
+  {
+    const DecisionTree* node = queue.front();
+    queue.pop();
+
+    if (node->children.size() == 0)
+    {
+      const size_t majorityClass = node->dimensionTypeOrMajorityClass;
+      const double probability = (majorityClass <
+          node->classProbabilities.n_elem) ?
+          node->classProbabilities[majorityClass] : 0.0;
+      flat.AddLeaf(majorityClass, probability, node->classProbabilities);
+      continue;
+    }
+
+    if ((data::Datatype) node->dimensionTypeOrMajorityClass ==
+        data::Datatype::categorical)
+      CategoricalSplit::Freeze(node->splitDimension, node->classProbabilities,
+          *node, flat);
+    else
+      NumericSplit::Freeze(node->splitDimension, node->classProbabilities,
+          *node, flat);
+
+    for (size_t i = 0; i < node->children.size(); ++i)
+      queue.push(node->children[i]);
+  }
+
+  return flat;
+}
+
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
          template<typename> class CategoricalSplitType,
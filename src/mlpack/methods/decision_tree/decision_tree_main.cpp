@@ -195,7 +195,7 @@ int main(int argc, char** argv)
     arma::Row<size_t> predictions;
     arma::mat probabilities;
 
-    model.tree.Classify(testPoints, predictions, probabilities);
+    model.tree.Freeze().Classify(testPoints, predictions, probabilities);
 
     // Do we need to calculate accuracy?
     if (CLI::HasParam("test_labels"))
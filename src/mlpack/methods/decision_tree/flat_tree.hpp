@@ -0,0 +1,187 @@
+/**
+ * @file flat_tree.hpp
+ *
+ * Definition of the FlatTree class, a contiguous representation of a trained
+ * classification tree for fast batch classification.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_FLAT_TREE_HPP
+#define MLPACK_METHODS_DECISION_TREE_FLAT_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A FlatTree holds a trained classification tree as one array of nodes, each
+ * with its split dimension, the offset of its split points, and the offset of
+ * its first child; the children of a node are stored together.  The leaves
+ * hold their predicted class and class probabilities.  A FlatTree is obtained
+ * from a trained tree with DecisionTree::Freeze() or HoeffdingTree::Freeze(),
+ * and it does not change when the tree is trained further.
+ *
+ * Batch classification moves blocks of points down the tree one level at a
+ * time, so the memory accesses of different points in the block overlap
+ * instead of each point chasing pointers to the bottom of the tree.  Blocks
+ * are classified in parallel, if OpenMP is available.
+ *
+ * The nodes must be added in breadth-first order, with AddLeaf() and
+ * AddSplit(); split types do this in their Freeze() functions.
+ *
+ * @tparam ElemType Type of the elements of the data.
+ */
+template<typename ElemType = double>
+class FlatTree
+{
+ public:
+  //! The ways a node can send a point to its children.
+  enum SplitKind
+  {
+    //! The node is a leaf.
+    LEAF,
+    //! Go to child 0 if the value is at most the split point, else child 1.
+    NUMERIC_LESS_EQUAL,
+    //! Go to child 0 if the value is less than the split point, else child 1.
+    NUMERIC_LESS,
+    //! Go to the child of the number of (sorted) split points the value is
+    //! greater than.
+    NUMERIC_BINS,
+    //! Go to the child of the (categorical) value.
+    CATEGORICAL
+  };
+
+  //! One node of the tree.
+  struct Node
+  {
+    //! The kind of split (or LEAF).
+    size_t kind;
+    //! The dimension the node splits on.
+    size_t dimension;
+    //! The index of the first child, or of the leaf if the node is a leaf.
+    size_t first;
+    //! The index of the first split point of the node.
+    size_t splitBegin;
+    //! One past the index of the last split point of the node.
+    size_t splitEnd;
+  };
+
+  //! The number of points moved down the tree together.
+  static const size_t BlockSize = 64;
+
+  /**
+   * Create an empty flat tree, to which nodes can be added.
+   *
+   * @param numClasses Number of classes.
+   */
+  FlatTree(const size_t numClasses = 0);
+
+  /**
+   * Add a leaf.
+   *
+   * @param prediction Predicted class of the leaf.
+   * @param probability Probability of the predicted class.
+   * @param probabilities Probabilities of each class.
+   */
+  void AddLeaf(const size_t prediction,
+               const double probability,
+               const arma::vec& probabilities);
+
+  /**
+   * Add a node with children.
+   *
+   * @param kind Kind of split.
+   * @param dimension Dimension the node splits on.
+   * @param numChildren Number of children of the node.
+   * @param splitPoints Split points of the node.
+   * @param numSplitPoints Number of split points.
+   */
+  void AddSplit(const SplitKind kind,
+                const size_t dimension,
+                const size_t numChildren,
+                const ElemType* splitPoints = NULL,
+                const size_t numSplitPoints = 0);
+
+  /**
+   * Predict the classes of the given points.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data, arma::Row<size_t>& predictions) const;
+
+  /**
+   * Predict the classes of the given points, and the probability of the
+   * predicted class of each point.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   * @param probabilities This will be filled with the probability of the
+   *      predicted class of each point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::rowvec& probabilities) const;
+
+  /**
+   * Predict the classes of the given points, and the probability of each class
+   * for each point.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   * @param probabilities This will be filled with class probabilities for each
+   *      point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of nodes.
+  size_t NumNodes() const { return nodes.size(); }
+  //! Get the number of leaves.
+  size_t NumLeaves() const { return leafPredictions.size(); }
+  //! Get the node of the given index.
+  const Node& GetNode(const size_t i) const { return nodes[i]; }
+  //! Get the number of classes.
+  size_t NumClasses() const { return numClasses; }
+
+ private:
+  /**
+   * Find the index of the leaf of each given point.
+   */
+  template<typename MatType>
+  void FindLeaves(const MatType& data, arma::Col<size_t>& leaves) const;
+
+  //! Get the index of the child of the node that the value goes to.
+  size_t Next(const Node& node, const ElemType value) const;
+
+  //! The number of classes.
+  size_t numClasses;
+  //! The nodes, in breadth-first order.
+  std::vector<Node> nodes;
+  //! The split points of all the nodes.
+  std::vector<ElemType> splitPoints;
+  //! The index of the next child to be added.
+  size_t nextChild;
+  //! The predicted class of each leaf.
+  std::vector<size_t> leafPredictions;
+  //! The probability of the predicted class of each leaf.
+  std::vector<double> leafProbability;
+  //! The class probabilities of each leaf, one column per leaf.
+  std::vector<double> leafProbabilities;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_tree_impl.hpp"
+
+#endif
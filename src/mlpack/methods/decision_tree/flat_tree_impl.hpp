@@ -0,0 +1,193 @@
+/**
+ * @file flat_tree_impl.hpp
+ *
+ * Implementation of the FlatTree class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_FLAT_TREE_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_FLAT_TREE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename ElemType>
+const size_t FlatTree<ElemType>::BlockSize;
+
+template<typename ElemType>
+FlatTree<ElemType>::FlatTree(const size_t numClasses) :
+    numClasses(numClasses),
+    nextChild(1)
+{
+  // Nothing to do.
+}
+
+template<typename ElemType>
+void FlatTree<ElemType>::AddLeaf(const size_t prediction,
+                                 const double probability,
+                                 const arma::vec& probabilities)
+{
+  Node node;
+  node.kind = LEAF;
+  node.dimension = 0;
+  node.first = leafPredictions.size();
+  node.splitBegin = node.splitEnd = splitPoints.size();
+  nodes.push_back(node);
+
+  leafPredictions.push_back(prediction);
+  leafProbability.push_back(probability);
+  for (size_t c = 0; c < numClasses; ++c)
+    leafProbabilities.push_back((c < probabilities.n_elem) ?
+        probabilities[c] : 0.0);
+}
+
+template<typename ElemType>
+void FlatTree<ElemType>::AddSplit(const SplitKind kind,
+                                  const size_t dimension,
+                                  const size_t numChildren,
+                                  const ElemType* points,
+                                  const size_t numSplitPoints)
+{
+  Node node;
+  node.kind = kind;
+  node.dimension = dimension;
+  node.first = nextChild;
+  node.splitBegin = splitPoints.size();
+  splitPoints.insert(splitPoints.end(), points, points + numSplitPoints);
+  node.splitEnd = splitPoints.size();
+  nodes.push_back(node);
+
+  nextChild += numChildren;
+}
+
+template<typename ElemType>
+inline size_t FlatTree<ElemType>::Next(const Node& node,
+                                       const ElemType value) const
+{
+  switch (node.kind)
+  {
+    case NUMERIC_LESS_EQUAL:
+      return node.first + (value > splitPoints[node.splitBegin]);
+    case NUMERIC_LESS:
+      return node.first + (value >= splitPoints[node.splitBegin]);
+    case NUMERIC_BINS:
+    {
+      size_t bin = node.splitBegin;
+      while (bin < node.splitEnd && value > splitPoints[bin])
+        ++bin;
+      return node.first + (bin - node.splitBegin);
+    }
+    default:
+      return node.first + (size_t) value;
+  }
+}
+
+template<typename ElemType>
+template<typename MatType>
+void FlatTree<ElemType>::FindLeaves(const MatType& data,
+                                    arma::Col<size_t>& leaves) const
+{
+  leaves.set_size(data.n_cols);
+  if (nodes.size() == 0)
+    throw std::invalid_argument("FlatTree::Classify(): the tree is empty");
+
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * BlockSize;
+    const size_t count = std::min(BlockSize, (size_t) data.n_cols - begin);
+
+    // Move every point of the block down one level at a time, until all of
+    // them have reached a leaf.
+    size_t current[BlockSize];
+    std::fill(current, current + count, 0);
+    bool moved = true;
+    while (moved)
+    {
+      moved = false;
+      for (size_t j = 0; j < count; ++j)
+      {
+        const Node& node = nodes[current[j]];
+        if (node.kind != LEAF)
+        {
+          current[j] = Next(node, data(node.dimension, begin + j));
+          moved = true;
+        }
+      }
+    }
+
+    for (size_t j = 0; j < count; ++j)
+      leaves[begin + j] = nodes[current[j]].first;
+  }
+}
+
+template<typename ElemType>
+template<typename MatType>
+void FlatTree<ElemType>::Classify(const MatType& data,
+                                  arma::Row<size_t>& predictions) const
+{
+  arma::Col<size_t> leaves;
+  FindLeaves(data, leaves);
+
+  predictions.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    predictions[i] = leafPredictions[leaves[i]];
+}
+
+template<typename ElemType>
+template<typename MatType>
+void FlatTree<ElemType>::Classify(const MatType& data,
+                                  arma::Row<size_t>& predictions,
+                                  arma::rowvec& probabilities) const
+{
+  arma::Col<size_t> leaves;
+  FindLeaves(data, leaves);
+
+  predictions.set_size(data.n_cols);
+  probabilities.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    predictions[i] = leafPredictions[leaves[i]];
+    probabilities[i] = leafProbability[leaves[i]];
+  }
+}
+
+template<typename ElemType>
+template<typename MatType>
+void FlatTree<ElemType>::Classify(const MatType& data,
+                                  arma::Row<size_t>& predictions,
+                                  arma::mat& probabilities) const
+{
+  arma::Col<size_t> leaves;
+  FindLeaves(data, leaves);
+
+  predictions.set_size(data.n_cols);
+  probabilities.set_size(numClasses, data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    predictions[i] = leafPredictions[leaves[i]];
+    std::copy(leafProbabilities.begin() + leaves[i] * numClasses,
+        leafProbabilities.begin() + (leaves[i] + 1) * numClasses,
+        probabilities.colptr(i));
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
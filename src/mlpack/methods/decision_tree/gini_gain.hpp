@@ -86,6 +86,34 @@ class GiniGain
     return -impurity;
   }
 
+  /**
+   * Evaluate the Gini impurity of a set of points, given the number of points
+   * (or the sum of the weights of the points) in each class.
+   *
+   * @param counts Number (or weight) of points in each class.
+   * @param numClasses Number of classes in the dataset.
+   * @param totalCount Total number (or weight) of points.
+   */
+  template<typename CountType>
+  static double EvaluatePtr(const CountType* counts,
+                            const size_t numClasses,
+                            const CountType totalCount)
+  {
+    // Corner case: if there are no elements (or no weight), the impurity is
+    // zero.
+    if (totalCount == 0)
+      return 0.0;
+
+    double impurity = 0.0;
+    for (size_t i = 0; i < numClasses; ++i)
+    {
+      const double f = ((double) counts[i] / (double) totalCount);
+      impurity += f * (1.0 - f);
+    }
+
+    return -impurity;
+  }
+
   /**
    * Return the range of the Gini impurity for the given number of classes.
    * (That is, the difference between the maximum possible value and the minimum
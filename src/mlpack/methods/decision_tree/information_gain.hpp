@@ -84,6 +84,34 @@ class InformationGain
     return gain;
   }
 
+  /**
+   * Calculate the information gain of a set of points, given the number of
+   * points (or the sum of the weights of the points) in each class.
+   *
+   * @param counts Number (or weight) of points in each class.
+   * @param numClasses Number of classes in the dataset.
+   * @param totalCount Total number (or weight) of points.
+   */
+  template<typename CountType>
+  static double EvaluatePtr(const CountType* counts,
+                            const size_t numClasses,
+                            const CountType totalCount)
+  {
+    // Edge case: if there are no elements (or no weight), the gain is zero.
+    if (totalCount == 0)
+      return 0.0;
+
+    double gain = 0.0;
+    for (size_t i = 0; i < numClasses; ++i)
+    {
+      const double f = ((double) counts[i] / (double) totalCount);
+      if (f > 0.0)
+        gain += f * std::log2(f);
+    }
+
+    return gain;
+  }
+
   /**
    * Return the range of the information gain for the given number of classes.
    * (That is, the difference between the maximum possible value and the minimum
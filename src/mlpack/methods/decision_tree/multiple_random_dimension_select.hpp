@@ -0,0 +1,112 @@
+/**
+ * @file multiple_random_dimension_select.hpp
+ *
+ * Select a random subset of the dimensions at each decision tree node, as done
+ * by random forests.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_MULTIPLE_RANDOM_DIMENSION_SELECT_HPP
+#define MLPACK_METHODS_DECISION_TREE_MULTIPLE_RANDOM_DIMENSION_SELECT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <random>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * This dimension selection policy selects a different random subset of the
+ * dimensions for each decision tree node to split on.  The dimensions are
+ * returned in increasing order.
+ *
+ * The random numbers come from a generator owned by the calling thread, so that
+ * trees may be trained by several threads at once (as RandomForest does).  Call
+ * Seed() on the thread that trains a tree to make the tree reproducible.
+ *
+ * @tparam NumDimensions Number of dimensions to select; if 0, the square root
+ *     of the number of dimensions (rounded up) is used.
+ */
+template<size_t NumDimensions = 0>
+class MultipleRandomDimensionSelect
+{
+ public:
+  /**
+   * Construct the MultipleRandomDimensionSelect object for the given number of
+   * dimensions, and select the dimensions.
+   */
+  MultipleRandomDimensionSelect(const size_t dimensions) :
+      i(0),
+      dimensions(dimensions)
+  {
+    const size_t numSelected = std::min(dimensions, (NumDimensions == 0) ?
+        (size_t) std::ceil(std::sqrt((double) dimensions)) : NumDimensions);
+
+    // Take the first numSelected elements of a partial Fisher-Yates shuffle.
+    std::vector<size_t> all(dimensions);
+    for (size_t d = 0; d < dimensions; ++d)
+      all[d] = d;
+    for (size_t d = 0; d < numSelected; ++d)
+    {
+      std::uniform_int_distribution<size_t> dist(d, dimensions - 1);
+      std::swap(all[d], all[dist(Generator())]);
+    }
+
+    values.assign(all.begin(), all.begin() + numSelected);
+    std::sort(values.begin(), values.end());
+    values.push_back(dimensions); // This marks the end.
+  }
+
+  /**
+   * Get the first dimension to select from.
+   */
+  size_t Begin()
+  {
+    i = 0;
+    return values[0];
+  }
+
+  /**
+   * Get the last dimension to select from.
+   */
+  size_t End() const { return dimensions; }
+
+  /**
+   * Get the next dimension.
+   */
+  size_t Next() { return values[++i]; }
+
+  /**
+   * Seed the random number generator of the calling thread.
+   *
+   * @param seed Seed for the generator.
+   */
+  static void Seed(const size_t seed)
+  {
+    Generator().seed((std::mt19937::result_type) seed);
+  }
+
+  //! Get the random number generator of the calling thread.
+  static std::mt19937& Generator()
+  {
+    static thread_local std::mt19937 generator;
+    return generator;
+  }
+
+ private:
+  //! The selected dimensions, followed by the number of dimensions.
+  std::vector<size_t> values;
+  //! The index of the current dimension.
+  size_t i;
+  //! The number of dimensions to select from.
+  const size_t dimensions;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
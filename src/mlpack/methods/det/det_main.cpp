@@ -35,7 +35,10 @@ PROGRAM_INFO("Density Estimation With Density Estimation Trees",
     "for this task will be the tree that was trained on the given training "
     "points, or a tree stored in the file given with the --input_model_file "
     "(-m) parameter.  The density estimates for the test points may be saved "
-    "into the file specified with the --test_set_estimates_file (-E) option.");
+    "into the file specified with the --test_set_estimates_file (-E) option.  "
+    "If --tag_leaves (-g) is given, the leaves of the tree are tagged, and the "
+    "tag of the leaf containing each test point is saved as a second row of "
+    "that file, computed in the same pass as the density estimates.");
 
 // Input data files.
 PARAM_MATRIX_IN("training", "The data set on which to build a density "
@@ -54,6 +57,9 @@ PARAM_MATRIX_OUT("training_set_estimates", "The output density estimates on "
     "the training set from the final optimally pruned tree.", "e");
 PARAM_MATRIX_OUT("test_set_estimates", "The output estimates on the test set "
     "from the final optimally pruned tree.", "E");
+PARAM_FLAG("tag_leaves", "If set, the tag of the leaf containing each test "
+    "point is saved as the second row of the --test_set_estimates_file (-E) "
+    "output.", "g");
 PARAM_MATRIX_OUT("vi", "The output variable importance values for each "
     "feature.", "i");
 
@@ -112,6 +118,10 @@ int main(int argc, char *argv[])
     Log::Warn << "--test_set_estimates_file (-E) ignored because --test_file "
         << "(-T) is not specified." << endl;
 
+  if (!CLI::HasParam("test_set_estimates") && CLI::HasParam("tag_leaves"))
+    Log::Warn << "--tag_leaves (-g) ignored because --test_set_estimates_file "
+        << "(-E) is not specified." << endl;
+
   // Are we training a DET or loading from file?
   DTree<arma::mat, int>* tree;
   if (CLI::HasParam("training"))
@@ -145,10 +155,9 @@ int main(int argc, char *argv[])
     if (CLI::HasParam("training_set_estimates"))
     {
       // Compute density estimates for each point in the training set.
-      arma::rowvec trainingDensities(trainingData.n_cols);
+      arma::rowvec trainingDensities;
       Timer::Start("det_estimation_time");
-      for (size_t i = 0; i < trainingData.n_cols; i++)
-        trainingDensities[i] = tree->ComputeValue(trainingData.unsafe_col(i));
+      tree->ComputeValues(trainingData, trainingDensities);
       Timer::Stop("det_estimation_time");
 
       CLI::GetParam<arma::mat>("training_set_estimates") =
@@ -166,15 +175,33 @@ int main(int argc, char *argv[])
   {
     arma::mat testData = std::move(CLI::GetParam<arma::mat>("test"));
 
-    // Compute test set densities.
-    Timer::Start("det_test_set_estimation");
-    arma::rowvec testDensities(testData.n_cols);
-    for (size_t i = 0; i < testData.n_cols; i++)
-      testDensities[i] = tree->ComputeValue(testData.unsafe_col(i));
-    Timer::Stop("det_test_set_estimation");
+    // Compute test set densities, and the tags of the leaves of the test
+    // points if they are wanted.
+    arma::rowvec testDensities;
+    if (CLI::HasParam("test_set_estimates") && CLI::HasParam("tag_leaves"))
+    {
+      tree->TagTree();
+
+      Timer::Start("det_test_set_estimation");
+      arma::Row<int> testTags;
+      tree->ComputeValues(testData, testDensities, testTags);
+      Timer::Stop("det_test_set_estimation");
+
+      arma::mat& estimates = CLI::GetParam<arma::mat>("test_set_estimates");
+      estimates.set_size(2, testData.n_cols);
+      estimates.row(0) = testDensities;
+      estimates.row(1) = arma::conv_to<arma::rowvec>::from(testTags);
+    }
+    else
+    {
+      Timer::Start("det_test_set_estimation");
+      tree->ComputeValues(testData, testDensities);
+      Timer::Stop("det_test_set_estimation");
 
-    if (CLI::HasParam("test_set_estimates"))
-      CLI::GetParam<arma::mat>("test_set_estimates") = std::move(testDensities);
+      if (CLI::HasParam("test_set_estimates"))
+        CLI::GetParam<arma::mat>("test_set_estimates") =
+            std::move(testDensities);
+    }
   }
 
   // Print variable importance.
@@ -154,6 +154,11 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
     outfile.close();
   }
 
+  // Keep the fully grown tree, so that the optimal tree can be pruned from it
+  // instead of being grown again.
+  DTree<MatType, TagType>* dtreeOpt = new DTree<MatType, TagType>(dtree);
+  const double fullTreeAlpha = alpha;
+
   // Sequentially prune and save the alpha values and the values of c_t^2 * r_t.
   std::vector<std::pair<double, double> > prunedSequence;
   while (dtree.SubtreeLeaves() > 1)
@@ -179,47 +184,43 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
   Log::Info << prunedSequence.size() << " trees in the sequence; maximum alpha:"
       << " " << oldAlpha << "." << std::endl;
 
-  MatType cvData(dataset);
   const size_t testSize = dataset.n_cols / folds;
 
-  arma::vec regularizationConstants(prunedSequence.size());
-  regularizationConstants.fill(0.0);
+  // Each fold fills its own column with its contributions to the
+  // regularization constants, so no synchronization is needed.
+  arma::mat foldConstants(prunedSequence.size(), folds);
+  foldConstants.fill(0.0);
 
   Timer::Start("cross_validation");
   // Go through each fold.  On the Visual Studio compiler, we have to use
   // intmax_t because size_t is not yet supported by their OpenMP
   // implementation.
 #ifdef _WIN32
-  #pragma omp parallel for default(none) \
-      shared(cvData, prunedSequence, regularizationConstants)
+  #pragma omp parallel for default(none) schedule(dynamic) \
+      shared(dataset, prunedSequence, foldConstants)
   for (intmax_t fold = 0; fold < (intmax_t) folds; fold++)
 #else
-  #pragma omp parallel for default(none) \
-      shared(cvData, prunedSequence, regularizationConstants)
+  #pragma omp parallel for default(none) schedule(dynamic) \
+      shared(dataset, prunedSequence, foldConstants)
   for (size_t fold = 0; fold < folds; fold++)
 #endif
   {
-    // Break up data into train and test sets.
+    // Break up data into train and test sets.  The test set is an alias of the
+    // dataset; the training set is gathered in one pass, since growing the
+    // tree reorders it.
     const size_t start = fold * testSize;
     const size_t end = std::min((size_t) (fold + 1)
-                                * testSize, (size_t) cvData.n_cols);
+                                * testSize, (size_t) dataset.n_cols);
 
-    MatType test = cvData.cols(start, end - 1);
-    MatType train(cvData.n_rows, cvData.n_cols - test.n_cols);
+    const MatType test(dataset.colptr(start), dataset.n_rows, end - start,
+        false, true);
 
-    if (start == 0 && end < cvData.n_cols)
-    {
-      train.cols(0, train.n_cols - 1) = cvData.cols(end, cvData.n_cols - 1);
-    }
-    else if (start > 0 && end == cvData.n_cols)
-    {
-      train.cols(0, train.n_cols - 1) = cvData.cols(0, start - 1);
-    }
-    else
-    {
-      train.cols(0, start - 1) = cvData.cols(0, start - 1);
-      train.cols(start, train.n_cols - 1) = cvData.cols(end, cvData.n_cols - 1);
-    }
+    arma::uvec trainIndices(dataset.n_cols - test.n_cols);
+    for (size_t i = 0; i < start; ++i)
+      trainIndices[i] = i;
+    for (size_t i = end; i < dataset.n_cols; ++i)
+      trainIndices[i - test.n_cols] = i;
+    MatType train = dataset.cols(trainIndices);
 
     // Initialize the tree.
     DTree<MatType, TagType> cvDTree(train);
@@ -236,21 +237,16 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
     // Sequentially prune with all the values of available alphas and adding
     // values for test values.  Don't enter this loop if there are less than two
     // trees in the pruned sequence.
-    arma::vec cvRegularizationConstants(prunedSequence.size());
-    cvRegularizationConstants.fill(0.0);
+    arma::rowvec densities;
     for (size_t i = 0;
          i < ((prunedSequence.size() < 2) ? 0 : prunedSequence.size() - 2); ++i)
     {
       // Compute test values for this state of the tree.
-      double cvVal = 0.0;
-      for (size_t j = 0; j < test.n_cols; j++)
-      {
-        arma::vec testPoint = test.unsafe_col(j);
-        cvVal += cvDTree.ComputeValue(testPoint);
-      }
+      cvDTree.ComputeValues(test, densities);
 
       // Update the cv regularization constant.
-      cvRegularizationConstants[i] += 2.0 * cvVal / (double) cvData.n_cols;
+      foldConstants(i, fold) += 2.0 * arma::accu(densities) /
+          (double) dataset.n_cols;
 
       // Determine the new alpha value and prune accordingly.
       double cvOldAlpha = 0.5 * (prunedSequence[i + 1].first
@@ -259,22 +255,16 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
     }
 
     // Compute test values for this state of the tree.
-    double cvVal = 0.0;
-    for (size_t i = 0; i < test.n_cols; ++i)
-    {
-      typename MatType::vec_type testPoint = test.unsafe_col(i);
-      cvVal += cvDTree.ComputeValue(testPoint);
-    }
+    cvDTree.ComputeValues(test, densities);
 
     if (prunedSequence.size() > 2)
-      cvRegularizationConstants[prunedSequence.size() - 2] += 2.0 * cvVal
-        / (double) cvData.n_cols;
-
-    #pragma omp critical(DTreeCVUpdate)
-    regularizationConstants += cvRegularizationConstants;
+      foldConstants(prunedSequence.size() - 2, fold) += 2.0 *
+          arma::accu(densities) / (double) dataset.n_cols;
   }
   Timer::Stop("cross_validation");
 
+  const arma::vec regularizationConstants = arma::sum(foldConstants, 1);
+
   double optimalAlpha = -1.0;
   long double cvBestError = -std::numeric_limits<long double>::max();
 
@@ -294,29 +284,13 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
 
   Log::Info << "Optimal alpha: " << optimalAlpha << "." << std::endl;
 
-  // Initialize the tree.
-  DTree<MatType, TagType>* dtreeOpt = new DTree<MatType, TagType>(dataset);
-
-  // Getting ready to grow the tree...
-  for (size_t i = 0; i < oldFromNew.n_elem; i++)
-    oldFromNew[i] = i;
-
-  // Save the dataset since it would be modified while growing the tree.
-  newDataset = dataset;
-
-  // Grow the tree.
+  // Prune the copy of the fully grown tree with the optimal alpha.
   oldAlpha = -DBL_MAX;
-  alpha = dtreeOpt->Grow(newDataset,
-                         oldFromNew,
-                         useVolumeReg,
-                         maxLeafSize,
-                         minLeafSize);
-
-  // Prune with optimal alpha.
+  alpha = fullTreeAlpha;
   while ((oldAlpha < optimalAlpha) && (dtreeOpt->SubtreeLeaves() > 1))
   {
     oldAlpha = alpha;
-    alpha = dtreeOpt->PruneAndUpdate(oldAlpha, newDataset.n_cols, useVolumeReg);
+    alpha = dtreeOpt->PruneAndUpdate(oldAlpha, dataset.n_cols, useVolumeReg);
 
     // Some sanity checks.
     Log::Assert((alpha < std::numeric_limits<double>::max()) ||
@@ -148,7 +148,10 @@ class DTree
 
   /**
    * Greedily expand the tree.  The points in the dataset will be reordered
-   * during tree growth.
+   * during tree growth.  The points of a dense dataset are sorted along every
+   * dimension once, and the sorted values are partitioned between the
+   * children of each node that is split; the subtrees of large nodes are grown
+   * in parallel.
    *
    * @param data Dataset to build tree on.
    * @param oldFromNew Mappings from old points to new points.
@@ -198,6 +201,31 @@ class DTree
    */
   TagType FindBucket(const VecType& query) const;
 
+  /**
+   * Compute the density estimate of each of the given points.  The tree is
+   * first laid out as one array of nodes, in breadth-first order, and then
+   * blocks of points are moved down the array together, one level at a time,
+   * in parallel if OpenMP is available.  This is much faster than calling
+   * ComputeValue() for each point when there are many points.
+   *
+   * @param data Points to estimate the density of.
+   * @param densities Row vector to store the density estimates in.
+   */
+  void ComputeValues(const MatType& data, arma::rowvec& densities) const;
+
+  /**
+   * Compute the density estimate of each of the given points, and the tag of
+   * the leaf containing each point (as with FindBucket()), in the same pass.
+   * TagTree() should be called before this.
+   *
+   * @param data Points to estimate the density of.
+   * @param densities Row vector to store the density estimates in.
+   * @param tags Row vector to store the tags of the leaves in.
+   */
+  void ComputeValues(const MatType& data,
+                     arma::rowvec& densities,
+                     arma::Row<TagType>& tags) const;
+
   /**
    * Compute the variable importance of each dimension in the learned tree.
    *
@@ -319,14 +347,88 @@ class DTree
   // Utility methods.
 
   /**
-   * Find the dimension to split on.
+   * Greedily expand the subtree rooted at this node, given the points of this
+   * node sorted along every dimension (see Grow()).  If sortedValues is empty,
+   * the points are sorted again at every node instead.
+   */
+  double GrowNode(MatType& data,
+                  arma::Col<size_t>& oldFromNew,
+                  const bool useVolReg,
+                  const size_t maxLeafSize,
+                  const size_t minLeafSize,
+                  arma::Mat<ElemType>& sortedValues,
+                  arma::Mat<size_t>& sortedIds,
+                  std::vector<char>& goesLeft);
+
+  /**
+   * Find the dimension to split on.  If sortedValues is given, column d of it
+   * must hold the values of dimension d of the points of this node in sorted
+   * order (in rows start to end - 1); otherwise the values are sorted here.
    */
   bool FindSplit(const MatType& data,
                  size_t& splitDim,
                  ElemType& splitValue,
                  double& leftError,
                  double& rightError,
-                 const size_t minLeafSize = 5) const;
+                 const size_t minLeafSize = 5,
+                 const arma::Mat<ElemType>* sortedValues = NULL) const;
+
+  //! The best split of the points of a node along one dimension.
+  struct DimensionSplit
+  {
+    //! Whether a split was found.
+    bool found;
+    //! The log-negative-error of the node if it is split, up to the terms
+    //! that do not depend on the split.
+    double error;
+    //! The split value.
+    ElemType value;
+    //! The (non-log) negative error estimate of the left child.
+    double leftError;
+    //! The (non-log) negative error estimate of the right child.
+    double rightError;
+  };
+
+  /**
+   * Find the best split along the given dimension.
+   */
+  DimensionSplit FindSplitInDimension(
+      const MatType& data,
+      const size_t dim,
+      const size_t minLeafSize,
+      const arma::Mat<ElemType>* sortedValues) const;
+
+  //! One node of the tree, as laid out for batch queries.
+  struct FlatNode
+  {
+    //! The index of the left child (the right child follows it), or 0 if the
+    //! node is a leaf; the root never is a child.
+    size_t children;
+    //! The splitting dimension.
+    size_t splitDim;
+    //! The split value.
+    ElemType splitValue;
+    //! The density estimate, if the node is a leaf.
+    double density;
+    //! The tag, if the node is a leaf.
+    TagType tag;
+  };
+
+  //! The number of points moved down the tree together in batch queries.
+  static const size_t BlockSize = 64;
+
+  /**
+   * Lay out the subtree rooted at this node as an array of nodes, in
+   * breadth-first order.
+   */
+  void Flatten(std::vector<FlatNode>& nodes) const;
+
+  /**
+   * Find the index of the leaf (in the given flattened tree) of each point.
+   */
+  void FindLeaves(const MatType& data,
+                  const std::vector<FlatNode>& nodes,
+                  arma::Col<size_t>& leaves) const;
 
   /**
    * Split the data, returning the number of points left of the split.
@@ -335,6 +437,17 @@ class DTree
                    const size_t splitDim,
                    const ElemType splitValue,
                    arma::Col<size_t>& oldFromNew) const;
+
+  /**
+   * Partition the sorted values and indices of the points of this node
+   * between the children, keeping them sorted, once the data has been split
+   * along splitDim at splitIndex.
+   */
+  void SplitSorted(const size_t splitDim,
+                   const size_t splitIndex,
+                   arma::Mat<ElemType>& sortedValues,
+                   arma::Mat<size_t>& sortedIds,
+                   std::vector<char>& goesLeft) const;
 };
 
 } // namespace det
@@ -12,6 +12,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include "dtree.hpp"
+#include <mlpack/core/util/execution.hpp>
 #include <stack>
 #include <vector>
 
@@ -20,6 +21,34 @@ using namespace det;
 
 namespace details
 {
+  /**
+   * Put all the splits of the given sorted values of one dimension in a
+   * vector, ensuring the minimum leaf size on both sides.
+   */
+  template <typename ElemType>
+  void ExtractSortedSplits(std::vector<std::pair<ElemType, size_t>>& splitVec,
+                           const ElemType* dimVec,
+                           const size_t n,
+                           const size_t minLeafSize)
+  {
+    typedef std::pair<ElemType, size_t> SplitItem;
+
+    // Ensure the minimum leaf size on both sides. We need to figure out why
+    // there are spikes if this minLeafSize is enforced here...
+    for (size_t i = minLeafSize - 1; i < n - minLeafSize; ++i)
+    {
+      // This makes sense for real continuous data. This kinda corrupts the
+      // data and estimation if the data is ordinal. Potentially we can fix
+      // that by taking into account ordinality later in the min/max update,
+      // but then we can end-up with a zero-volumed dimension. No good.
+      const ElemType split = (dimVec[i] + dimVec[i + 1]) / 2.0;
+
+      // Check if we can split here (two points are different)
+      if (split != dimVec[i])
+        splitVec.push_back(SplitItem(split, i + 1));
+    }
+  }
+
   /**
    * This one sorts and scand the given per-dimension extract and puts all splits
    * in a vector, that can easily be iterated afterwards. General implementation.
@@ -36,24 +65,11 @@ namespace details
       std::is_same<typename MatType::elem_type, ElemType>::value == true,
       "The ElemType does not correspond to the matrix's element type.");
 
-    typedef std::pair<ElemType, size_t> SplitItem;
     const typename MatType::row_type dimVec =
       arma::sort(data(dim, arma::span(start, end - 1)));
 
-    // Ensure the minimum leaf size on both sides. We need to figure out why
-    // there are spikes if this minLeafSize is enforced here...
-    for (size_t i = minLeafSize - 1; i < dimVec.n_elem - minLeafSize; ++i)
-    {
-      // This makes sense for real continuous data. This kinda corrupts the
-      // data and estimation if the data is ordinal. Potentially we can fix
-      // that by taking into account ordinality later in the min/max update,
-      // but then we can end-up with a zero-volumed dimension. No good.
-      const ElemType split = (dimVec[i] + dimVec[i + 1]) / 2.0;
-
-      // Check if we can split here (two points are different)
-      if (split != dimVec[i])
-        splitVec.push_back(SplitItem(split, i + 1));
-    }
+    ExtractSortedSplits(splitVec, dimVec.memptr(), dimVec.n_elem,
+        minLeafSize);
   }
 
   // Now the custom arma::Mat implementation
@@ -65,23 +81,13 @@ namespace details
                      const size_t end,
                      const size_t minLeafSize)
   {
-    typedef std::pair<ElemType, size_t> SplitItem;
-    arma::vec dimVec = data(dim, arma::span(start, end - 1)).t();
+    arma::Col<ElemType> dimVec = data(dim, arma::span(start, end - 1)).t();
 
     // We sort these, in-place (it's a copy of the data, anyways).
     std::sort(dimVec.begin(), dimVec.end());
 
-    for (size_t i = minLeafSize - 1; i < dimVec.n_elem - minLeafSize; ++i)
-    {
-      // This makes sense for real continuous data. This kinda corrupts the
-      // data and estimation if the data is ordinal. Potentially we can fix
-      // that by taking into account ordinality later in the min/max update,
-      // but then we can end-up with a zero-volumed dimension. No good.
-      const ElemType split = (dimVec[i] + dimVec[i + 1]) / 2.0;
-
-      if (split != dimVec[i])
-        splitVec.push_back(SplitItem(split, i + 1));
-    }
+    ExtractSortedSplits(splitVec, dimVec.memptr(), dimVec.n_elem,
+        minLeafSize);
   }
 
   // This the custom, sparse optimized implementation of the same routine.
@@ -145,8 +151,63 @@ namespace details
       lastVal = newVal;
     }
   }
+
+  /**
+   * Matrices that are not dense are not presorted, because the sorted values
+   * of every dimension would take much more memory than the matrix itself, so
+   * this leaves sortedValues empty.
+   */
+  template <typename ElemType, typename MatType>
+  void PresortDimensions(const MatType& /* data */,
+                         const size_t /* start */,
+                         const size_t /* end */,
+                         arma::Mat<ElemType>& /* sortedValues */,
+                         arma::Mat<size_t>& /* sortedIds */)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Sort the points in [start, end) of a dense matrix along every dimension,
+   * so that column d of sortedValues holds the values of dimension d in
+   * ascending order, and column d of sortedIds holds the index of the point
+   * each of those values belongs to.  The dimensions are sorted in parallel.
+   */
+  template <typename ElemType>
+  void PresortDimensions(const arma::Mat<ElemType>& data,
+                         const size_t start,
+                         const size_t end,
+                         arma::Mat<ElemType>& sortedValues,
+                         arma::Mat<size_t>& sortedIds)
+  {
+    sortedValues.set_size(data.n_cols, data.n_rows);
+    sortedIds.set_size(data.n_cols, data.n_rows);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for
+    for (intmax_t dim = 0; dim < (intmax_t) data.n_rows; ++dim)
+#else
+    #pragma omp parallel for
+    for (size_t dim = 0; dim < data.n_rows; ++dim)
+#endif
+    {
+      const arma::uvec order = arma::sort_index(
+          data(dim, arma::span(start, end - 1)));
+      for (size_t i = 0; i < order.n_elem; ++i)
+      {
+        sortedIds(start + i, dim) = start + order[i];
+        sortedValues(start + i, dim) = data(dim, start + order[i]);
+      }
+    }
+  }
 }; // namespace details
 
+template <typename MatType, typename TagType>
+const size_t DTree<MatType, TagType>::BlockSize;
+
 template <typename MatType, typename TagType>
 DTree<MatType, TagType>::DTree() :
     start(0),
@@ -431,116 +492,163 @@ bool DTree<MatType, TagType>::FindSplit(const MatType& data,
                                         ElemType& splitValue,
                                         double& leftError,
                                         double& rightError,
-                                        const size_t minLeafSize) const
+                                        const size_t minLeafSize,
+                                        const arma::Mat<ElemType>* sortedValues)
+    const
 {
-  typedef std::pair<ElemType, size_t>   SplitItem;
-
   // Ensure the dimensionality of the data is the same as the dimensionality of
   // the bounding rectangle.
   Log::Assert(data.n_rows == maxVals.n_elem);
   Log::Assert(data.n_rows == minVals.n_elem);
 
-  const size_t points = end - start;
-
-  double minError = logNegError;
-  bool splitFound = false;
+  // The best split of each dimension.  They are only compared once all of them
+  // are found, so no synchronization is needed and ties always go to the
+  // lowest dimension.
+  std::vector<DimensionSplit> dimSplits(maxVals.n_elem);
 
-  // Loop through each dimension.
+  // Loop through each dimension.  Visual Studio only implements OpenMP 2.0,
+  // which has no tasks, so there the dimensions are split among threads with
+  // a parallel loop; elsewhere, each dimension of a large node is a task, so
+  // that the dimensions can be searched in parallel while other threads grow
+  // other subtrees.
 #ifdef _WIN32
-  #pragma omp parallel for default(shared)
+  #pragma omp parallel for
   for (intmax_t dim = 0; dim < (intmax_t) maxVals.n_elem; ++dim)
+    dimSplits[dim] = FindSplitInDimension(data, dim, minLeafSize,
+        sortedValues);
 #else
-  #pragma omp parallel for default(shared)
+  const size_t points = end - start;
   for (size_t dim = 0; dim < maxVals.n_elem; ++dim)
+  {
+    #pragma omp task default(shared) firstprivate(dim) if (points >= 4096)
+    dimSplits[dim] = FindSplitInDimension(data, dim, minLeafSize,
+        sortedValues);
+  }
+  #pragma omp taskwait
 #endif
+
+  double minError = logNegError;
+  bool splitFound = false;
+  for (size_t dim = 0; dim < maxVals.n_elem; ++dim)
   {
-    const ElemType min = minVals[dim];
-    const ElemType max = maxVals[dim];
+    const DimensionSplit& dimSplit = dimSplits[dim];
+    if ((dimSplit.error > minError) && dimSplit.found)
+    {
+      // Calculate actual error (in logspace) by adding terms back to our
+      // estimate.
+      const double volumeWithoutDim = logVolume -
+          std::log(maxVals[dim] - minVals[dim]);
+
+      minError = dimSplit.error;
+      splitDim = dim;
+      splitValue = dimSplit.value;
+      leftError = std::log(dimSplit.leftError) -
+          2 * std::log((double) data.n_cols) - volumeWithoutDim;
+      rightError = std::log(dimSplit.rightError) -
+          2 * std::log((double) data.n_cols) - volumeWithoutDim;
+      splitFound = true;
+    } // end if better split found in this dimension.
+  }
 
-    // If there is nothing to split in this dimension, move on.
-    if (max - min == 0.0)
-      continue; // Skip to next dimension.
+  return splitFound;
+}
+
+// Find the best split of the points of this node along the given dimension.
+template <typename MatType, typename TagType>
+typename DTree<MatType, TagType>::DimensionSplit
+DTree<MatType, TagType>::FindSplitInDimension(
+    const MatType& data,
+    const size_t dim,
+    const size_t minLeafSize,
+    const arma::Mat<ElemType>* sortedValues) const
+{
+  typedef std::pair<ElemType, size_t> SplitItem;
 
-    // Find the log volume of all the other dimensions.
-    const double volumeWithoutDim = logVolume - std::log(max - min);
+  DimensionSplit result;
+  result.found = false;
+  result.error = -DBL_MAX;
+  // For -Wuninitialized.  These will always be set to something else before
+  // use.
+  result.value = 0.0;
+  result.leftError = 0.0;
+  result.rightError = 0.0;
 
-    // Initializing all other stuff for this dimension.
-    bool dimSplitFound = false;
-    // Take an error estimate for this dimension.
-    double minDimError = std::pow(points, 2.0) / (max - min);
-    double dimLeftError = 0.0; // For -Wuninitialized.  These variables will
-    double dimRightError = 0.0; // always be set to something else before use.
-    ElemType dimSplitValue = 0.0;
+  const ElemType min = minVals[dim];
+  const ElemType max = maxVals[dim];
 
-    // Get the values for splitting. The old implementation:
-    //   dimVec = data.row(dim).subvec(start, end - 1);
-    //   dimVec = arma::sort(dimVec);
-    // could be quite inefficient for sparse matrices, due to
-    // copy operations (3). This one has custom implementation for dense and
-    // sparse matrices.
+  // If there is nothing to split in this dimension, move on.
+  if (max - min == 0.0)
+    return result;
 
-    std::vector<SplitItem> splitVec;
+  const size_t points = end - start;
+
+  // Find the log volume of all the other dimensions.
+  const double volumeWithoutDim = logVolume - std::log(max - min);
+
+  // Take an error estimate for this dimension.
+  double minDimError = std::pow(points, 2.0) / (max - min);
+
+  // Get the values for splitting.  If the points are already sorted along
+  // every dimension, the sorted values of this node are used directly.
+  // Otherwise, the old implementation:
+  //   dimVec = data.row(dim).subvec(start, end - 1);
+  //   dimVec = arma::sort(dimVec);
+  // could be quite inefficient for sparse matrices, due to
+  // copy operations (3). This one has custom implementation for dense and
+  // sparse matrices.
+  std::vector<SplitItem> splitVec;
+  if (sortedValues != NULL)
+  {
+    details::ExtractSortedSplits(splitVec, sortedValues->colptr(dim) + start,
+        points, minLeafSize);
+  }
+  else
+  {
     details::ExtractSplits<ElemType>(splitVec, data, dim, start, end,
         minLeafSize);
+  }
 
-    // Iterate on all the splits for this dimension
-    for (typename std::vector<SplitItem>::iterator i = splitVec.begin();
-         i != splitVec.end();
-         ++i)
-    {
-      const ElemType split = i->first;
-      const size_t position = i->second;
+  // Iterate on all the splits for this dimension
+  for (typename std::vector<SplitItem>::iterator i = splitVec.begin();
+       i != splitVec.end();
+       ++i)
+  {
+    const ElemType split = i->first;
+    const size_t position = i->second;
 
-      // Another way of picking split is using this:
-      //   split = leftsplit;
-      if ((split - min > 0.0) && (max - split > 0.0))
+    // Another way of picking split is using this:
+    //   split = leftsplit;
+    if ((split - min > 0.0) && (max - split > 0.0))
+    {
+      // Ensure that the right node will have at least the minimum number of
+      // points.
+      Log::Assert((points - position) >= minLeafSize);
+
+      // Now we have to see if the error will be reduced.  Simple manipulation
+      // of the error function gives us the condition we must satisfy:
+      //   |t_l|^2 / V_l + |t_r|^2 / V_r  >= |t|^2 / (V_l + V_r)
+      // and because the volume is only dependent on the dimension we are
+      // splitting, we can assume V_l is just the range of the left and V_r is
+      // just the range of the right.
+      double negLeftError = std::pow(position, 2.0) / (split - min);
+      double negRightError = std::pow(points - position, 2.0) / (max - split);
+
+      // If this is better, take it.
+      if ((negLeftError + negRightError) >= minDimError)
       {
-        // Ensure that the right node will have at least the minimum number of
-        // points.
-        Log::Assert((points - position) >= minLeafSize);
-
-        // Now we have to see if the error will be reduced.  Simple manipulation
-        // of the error function gives us the condition we must satisfy:
-        //   |t_l|^2 / V_l + |t_r|^2 / V_r  >= |t|^2 / (V_l + V_r)
-        // and because the volume is only dependent on the dimension we are
-        // splitting, we can assume V_l is just the range of the left and V_r is
-        // just the range of the right.
-        double negLeftError = std::pow(position, 2.0) / (split - min);
-        double negRightError = std::pow(points - position, 2.0) / (max - split);
-
-        // If this is better, take it.
-        if ((negLeftError + negRightError) >= minDimError)
-        {
-          minDimError = negLeftError + negRightError;
-          dimLeftError = negLeftError;
-          dimRightError = negRightError;
-          dimSplitValue = split;
-          dimSplitFound = true;
-        }
+        minDimError = negLeftError + negRightError;
+        result.leftError = negLeftError;
+        result.rightError = negRightError;
+        result.value = split;
+        result.found = true;
       }
     }
+  }
 
-    const double actualMinDimError = std::log(minDimError)
-      - 2 * std::log((double) data.n_cols)
+  result.error = std::log(minDimError) - 2 * std::log((double) data.n_cols)
       - volumeWithoutDim;
 
-#pragma omp critical(DTreeFindUpdate)
-    if ((actualMinDimError > minError) && dimSplitFound)
-    {
-      // Calculate actual error (in logspace) by adding terms back to our
-      // estimate.
-      minError = actualMinDimError;
-      splitDim = dim;
-      splitValue = dimSplitValue;
-      leftError = std::log(dimLeftError) - 2 * std::log((double) data.n_cols)
-        - volumeWithoutDim;
-      rightError = std::log(dimRightError) - 2 * std::log((double) data.n_cols)
-        - volumeWithoutDim;
-      splitFound = true;
-    } // end if better split found in this dimension.
-  }
-
-  return splitFound;
+  return result;
 }
 
 template <typename MatType, typename TagType>
@@ -577,6 +685,70 @@ size_t DTree<MatType, TagType>::SplitData(MatType& data,
   return left;
 }
 
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::SplitSorted(const size_t splitDim,
+                                          const size_t splitIndex,
+                                          arma::Mat<ElemType>& sortedValues,
+                                          arma::Mat<size_t>& sortedIds,
+                                          std::vector<char>& goesLeft) const
+{
+  // The points are already sorted along the split dimension, so the first
+  // splitIndex - start of them are those that go to the left child.
+  for (size_t i = start; i < end; ++i)
+    goesLeft[sortedIds(i, splitDim)] = (i < splitIndex);
+
+  // Every other dimension is partitioned stably, so that the values of each
+  // child are still sorted.  The dimensions of large nodes are partitioned in
+  // parallel.
+#ifdef _WIN32
+  #pragma omp parallel for if (end - start >= 4096)
+  for (intmax_t dim = 0; dim < (intmax_t) sortedValues.n_cols; ++dim)
+#else
+  for (size_t dim = 0; dim < sortedValues.n_cols; ++dim)
+#endif
+  {
+    if ((size_t) dim == splitDim)
+      continue;
+
+#ifndef _WIN32
+    #pragma omp task default(shared) firstprivate(dim) \
+        if (end - start >= 4096)
+#endif
+    {
+      ElemType* values = sortedValues.colptr(dim);
+      size_t* ids = sortedIds.colptr(dim);
+
+      // The points of the right child are stored aside while the points of
+      // the left child are moved to the front.
+      std::vector<std::pair<ElemType, size_t>> right;
+      right.reserve(end - splitIndex);
+      size_t l = start;
+      for (size_t i = start; i < end; ++i)
+      {
+        if (goesLeft[ids[i]])
+        {
+          values[l] = values[i];
+          ids[l] = ids[i];
+          ++l;
+        }
+        else
+        {
+          right.push_back(std::make_pair(values[i], ids[i]));
+        }
+      }
+
+      for (size_t i = 0; i < right.size(); ++i)
+      {
+        values[splitIndex + i] = right[i].first;
+        ids[splitIndex + i] = right[i].second;
+      }
+    }
+  }
+#ifndef _WIN32
+  #pragma omp taskwait
+#endif
+}
+
 // Greedily expand the tree
 template <typename MatType, typename TagType>
 double DTree<MatType, TagType>::Grow(MatType& data,
@@ -588,6 +760,46 @@ double DTree<MatType, TagType>::Grow(MatType& data,
   Log::Assert(data.n_rows == maxVals.n_elem);
   Log::Assert(data.n_rows == minVals.n_elem);
 
+  // Sort the points along every dimension once; the sorted values are then
+  // partitioned as the nodes are split, instead of being sorted again at
+  // every node.
+  arma::Mat<ElemType> sortedValues;
+  arma::Mat<size_t> sortedIds;
+  if ((size_t) (end - start) > maxLeafSize)
+    details::PresortDimensions(data, start, end, sortedValues, sortedIds);
+  std::vector<char> goesLeft(sortedIds.n_elem == 0 ? 0 : data.n_cols);
+
+  double alpha;
+#ifdef _WIN32
+  // Visual Studio only implements OpenMP 2.0, which has no tasks, so the
+  // subtrees are grown one after the other.
+  alpha = GrowNode(data, oldFromNew, useVolReg, maxLeafSize, minLeafSize,
+      sortedValues, sortedIds, goesLeft);
+#else
+  // The subtrees of large nodes are grown as tasks, by the threads of this
+  // team.
+  #pragma omp parallel if ((size_t) (end - start) >= 4096)
+  {
+    #pragma omp single
+    alpha = GrowNode(data, oldFromNew, useVolReg, maxLeafSize, minLeafSize,
+        sortedValues, sortedIds, goesLeft);
+  }
+#endif
+
+  return alpha;
+}
+
+// Greedily expand the subtree rooted at this node.
+template <typename MatType, typename TagType>
+double DTree<MatType, TagType>::GrowNode(MatType& data,
+                                         arma::Col<size_t>& oldFromNew,
+                                         const bool useVolReg,
+                                         const size_t maxLeafSize,
+                                         const size_t minLeafSize,
+                                         arma::Mat<ElemType>& sortedValues,
+                                         arma::Mat<size_t>& sortedIds,
+                                         std::vector<char>& goesLeft)
+{
   double leftG, rightG;
 
   // Compute points ratio.
@@ -606,11 +818,14 @@ double DTree<MatType, TagType>::Grow(MatType& data,
     size_t dim;
     double splitValueTmp;
     double leftError, rightError;
-    if (FindSplit(data, dim, splitValueTmp, leftError, rightError, minLeafSize))
+    if (FindSplit(data, dim, splitValueTmp, leftError, rightError, minLeafSize,
+        sortedValues.n_elem == 0 ? NULL : &sortedValues))
     {
       // Move the data around for the children to have points in a node lie
       // contiguously (to increase efficiency during the training).
       const size_t splitIndex = SplitData(data, dim, splitValueTmp, oldFromNew);
+      if (sortedValues.n_elem > 0)
+        SplitSorted(dim, splitIndex, sortedValues, sortedIds, goesLeft);
 
       // Make max and min vals for the children.
       StatType maxValsL(maxVals);
@@ -629,10 +844,21 @@ double DTree<MatType, TagType>::Grow(MatType& data,
       left = new DTree(maxValsL, minValsL, start, splitIndex, leftError);
       right = new DTree(maxValsR, minValsR, splitIndex, end, rightError);
 
-      leftG = left->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-                         minLeafSize);
-      rightG = right->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-                           minLeafSize);
+      // The children hold disjoint ranges of points, so a large left child is
+      // grown by another task while this one grows the right child.
+#ifdef _WIN32
+      leftG = left->GrowNode(data, oldFromNew, useVolReg, maxLeafSize,
+          minLeafSize, sortedValues, sortedIds, goesLeft);
+#else
+      #pragma omp task default(shared) if (splitIndex - start >= 4096)
+      leftG = left->GrowNode(data, oldFromNew, useVolReg, maxLeafSize,
+          minLeafSize, sortedValues, sortedIds, goesLeft);
+#endif
+      rightG = right->GrowNode(data, oldFromNew, useVolReg, maxLeafSize,
+          minLeafSize, sortedValues, sortedIds, goesLeft);
+#ifndef _WIN32
+      #pragma omp taskwait
+#endif
 
       // Store values of R(T~) and |T~|.
       subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
@@ -915,6 +1141,146 @@ TagType DTree<MatType, TagType>::FindBucket(const VecType& query) const
   }
 }
 
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::ComputeValues(const MatType& data,
+                                            arma::rowvec& densities) const
+{
+  Log::Assert(data.n_rows == maxVals.n_elem);
+
+  std::vector<FlatNode> nodes;
+  Flatten(nodes);
+  arma::Col<size_t> leaves;
+  FindLeaves(data, nodes, leaves);
+
+  densities.set_size(data.n_cols);
+
+  util::Execution::ParallelFor(data.n_cols, [&](const size_t i)
+  {
+    densities[i] = nodes[leaves[i]].density;
+
+    // As in ComputeValue(), points outside of the range of the root have no
+    // density.
+    if (root)
+    {
+      for (size_t d = 0; d < data.n_rows; ++d)
+      {
+        if ((data(d, i) < minVals[d]) || (data(d, i) > maxVals[d]))
+        {
+          densities[i] = 0.0;
+          break;
+        }
+      }
+    }
+  }, 256);
+}
+
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::ComputeValues(const MatType& data,
+                                            arma::rowvec& densities,
+                                            arma::Row<TagType>& tags) const
+{
+  Log::Assert(data.n_rows == maxVals.n_elem);
+
+  std::vector<FlatNode> nodes;
+  Flatten(nodes);
+  arma::Col<size_t> leaves;
+  FindLeaves(data, nodes, leaves);
+
+  densities.set_size(data.n_cols);
+  tags.set_size(data.n_cols);
+
+  util::Execution::ParallelFor(data.n_cols, [&](const size_t i)
+  {
+    densities[i] = nodes[leaves[i]].density;
+    tags[i] = nodes[leaves[i]].tag;
+
+    // As in ComputeValue(), points outside of the range of the root have no
+    // density; they still have the tag of a leaf, as in FindBucket().
+    if (root)
+    {
+      for (size_t d = 0; d < data.n_rows; ++d)
+      {
+        if ((data(d, i) < minVals[d]) || (data(d, i) > maxVals[d]))
+        {
+          densities[i] = 0.0;
+          break;
+        }
+      }
+    }
+  }, 256);
+}
+
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::Flatten(std::vector<FlatNode>& nodes) const
+{
+  // Visit the nodes in breadth-first order, so that the children of each node
+  // are next to each other.
+  std::vector<const DTree*> order(1, this);
+  nodes.clear();
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    const DTree& node = *order[i];
+
+    FlatNode flat;
+    flat.children = 0;
+    flat.splitDim = node.splitDim;
+    flat.splitValue = node.splitValue;
+    flat.density = 0.0;
+    flat.tag = node.bucketTag;
+
+    if (node.subtreeLeaves == 1 || node.left == NULL)
+    {
+      flat.density = std::exp(std::log(node.ratio) - node.logVolume);
+    }
+    else
+    {
+      flat.children = order.size();
+      order.push_back(node.left);
+      order.push_back(node.right);
+    }
+
+    nodes.push_back(flat);
+  }
+}
+
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::FindLeaves(const MatType& data,
+                                         const std::vector<FlatNode>& nodes,
+                                         arma::Col<size_t>& leaves) const
+{
+  leaves.set_size(data.n_cols);
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+  util::Execution::ParallelFor(numBlocks, [&](const size_t b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t count = std::min(BlockSize, (size_t) data.n_cols - begin);
+
+    // Move every point of the block down one level at a time, until all of
+    // them have reached a leaf.
+    size_t current[BlockSize];
+    std::fill(current, current + count, 0);
+    bool moved = true;
+    while (moved)
+    {
+      moved = false;
+      for (size_t j = 0; j < count; ++j)
+      {
+        const FlatNode& node = nodes[current[j]];
+        if (node.children != 0)
+        {
+          current[j] = node.children +
+              ((data(node.splitDim, begin + j) <= node.splitValue) ? 0 : 1);
+          moved = true;
+        }
+      }
+    }
+
+    for (size_t j = 0; j < count; ++j)
+      leaves[begin + j] = current[j];
+  });
+}
+
 template <typename MatType, typename TagType>
 void
 DTree<MatType, TagType>::ComputeVariableImportance(arma::vec& importances) const
@@ -27,6 +27,7 @@
 
 #include "dtb_stat.hpp"
 #include "edge_pair.hpp"
+#include "lock_free_union_find.hpp"
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
@@ -68,6 +69,11 @@ namespace emst /** Euclidean Minimum Spanning Trees. */ {
  * More advanced usage of the class can use different types of trees, pass in an
  * already-built tree, or compute the MST using the O(n^2) naive algorithm.
  *
+ * With OpenMP, each Boruvka step is run in parallel: the query tree is split
+ * into subtrees that the threads traverse against the whole tree, each thread
+ * keeping its own candidate edges (so each thread uses O(n) extra memory), and
+ * the candidate edges are then added in parallel with a lock-free union-find.
+ *
  * @tparam MetricType The metric to use.
  * @tparam MatType The type of data matrix to use.
  * @tparam TreeType Type of tree to use.  This should follow the TreeType policy
@@ -102,8 +108,8 @@ class DualTreeBoruvka
   //! Edges.
   std::vector<EdgePair> edges; // We must use vector with non-numerical types.
 
-  //! Connections.
-  UnionFind connections;
+  //! Connections.  These may be used by several threads at once.
+  LockFreeUnionFind connections;
 
   //! List of edge nodes.
   arma::Col<size_t> neighborsInComponent;
@@ -183,7 +189,8 @@ class DualTreeBoruvka
   void AddEdge(const size_t e1, const size_t e2, const double distance);
 
   /**
-   * Adds all the edges found in one iteration to the list of neighbors.
+   * Adds all the edges found in one iteration to the list of neighbors.  This
+   * is done in parallel with OpenMP.
    */
   void AddAllEdges();
 
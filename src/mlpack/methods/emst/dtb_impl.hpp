@@ -123,22 +123,123 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
 
   totalDist = 0; // Reset distance.
 
+  // Each thread finds candidate edges with its own rules, which store them in
+  // their own candidate arrays; the first thread uses the members.  After each
+  // traversal the best candidate of each component is kept.
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
   typedef DTBRules<MetricType, Tree> RuleType;
-  RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
-                 neighborsOutComponent, metric);
+  std::vector<arma::vec> threadDistances(numThreads - 1);
+  std::vector<arma::Col<size_t>> threadInComponent(numThreads - 1);
+  std::vector<arma::Col<size_t>> threadOutComponent(numThreads - 1);
+  std::vector<RuleType> rules;
+  rules.reserve(numThreads);
+  rules.push_back(RuleType(data, connections, neighborsDistances,
+      neighborsInComponent, neighborsOutComponent, metric));
+  for (size_t t = 0; t < numThreads - 1; ++t)
+  {
+    threadDistances[t].set_size(data.n_cols);
+    threadDistances[t].fill(DBL_MAX);
+    threadInComponent[t].set_size(data.n_cols);
+    threadOutComponent[t].set_size(data.n_cols);
+    rules.push_back(RuleType(data, connections, threadDistances[t],
+        threadInComponent[t], threadOutComponent[t], metric));
+  }
+
+  // To traverse in parallel, the query tree is split into disjoint subtrees,
+  // each of which is traversed against the whole reference tree.  Only nodes
+  // that hold no points themselves are split, so that each query point is in
+  // exactly one subtree.
+  std::vector<Tree*> queryNodes;
+  if (!naive)
+  {
+    queryNodes.push_back(tree);
+    bool split = true;
+    while (split && numThreads > 1 && queryNodes.size() < 8 * numThreads)
+    {
+      split = false;
+      std::vector<Tree*> children;
+      for (size_t i = 0; i < queryNodes.size(); ++i)
+      {
+        if (queryNodes[i]->NumChildren() > 0 && queryNodes[i]->NumPoints() == 0)
+        {
+          for (size_t j = 0; j < queryNodes[i]->NumChildren(); ++j)
+            children.push_back(&queryNodes[i]->Child(j));
+          split = true;
+        }
+        else
+        {
+          children.push_back(queryNodes[i]);
+        }
+      }
+      queryNodes.swap(children);
+    }
+  }
+
   while (edges.size() < (data.n_cols - 1))
   {
-    if (naive)
+    #pragma omp parallel
     {
-      // Full O(N^2) traversal.
-      for (size_t i = 0; i < data.n_cols; ++i)
-        for (size_t j = 0; j < data.n_cols; ++j)
-          rules.BaseCase(i, j);
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+      if (naive)
+      {
+        // Full O(N^2) traversal.
+#ifdef _WIN32
+        // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+        // doesn't support unsigned loop variables.
+        #pragma omp for schedule(dynamic, 16)
+        for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+        #pragma omp for schedule(dynamic, 16)
+        for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+          for (size_t j = 0; j < data.n_cols; ++j)
+            rules[thread].BaseCase(i, j);
+      }
+      else
+      {
+        typename Tree::template DualTreeTraverser<RuleType>
+            traverser(rules[thread]);
+#ifdef _WIN32
+        #pragma omp for schedule(dynamic)
+        for (intmax_t i = 0; i < (intmax_t) queryNodes.size(); ++i)
+#else
+        #pragma omp for schedule(dynamic)
+        for (size_t i = 0; i < queryNodes.size(); ++i)
+#endif
+          traverser.Traverse(*queryNodes[i], *tree);
+      }
     }
-    else
+
+    if (numThreads > 1)
     {
-      typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-      traverser.Traverse(*tree, *tree);
+      // Keep the best candidate edge of each component.
+#ifdef _WIN32
+      #pragma omp parallel for schedule(static)
+      for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+      #pragma omp parallel for schedule(static)
+      for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+      {
+        for (size_t t = 0; t < numThreads - 1; ++t)
+        {
+          if (threadDistances[t][i] < neighborsDistances[i])
+          {
+            neighborsDistances[i] = threadDistances[t][i];
+            neighborsInComponent[i] = threadInComponent[t][i];
+            neighborsOutComponent[i] = threadOutComponent[t][i];
+          }
+          threadDistances[t][i] = DBL_MAX;
+        }
+      }
     }
 
     AddAllEdges();
@@ -148,8 +249,16 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
     Log::Info << edges.size() << " edges found so far." << std::endl;
     if (!naive)
     {
-      Log::Info << rules.BaseCases() << " cumulative base cases." << std::endl;
-      Log::Info << rules.Scores() << " cumulative node combinations scored."
+      size_t baseCases = 0;
+      size_t scores = 0;
+      for (size_t t = 0; t < numThreads; ++t)
+      {
+        baseCases += rules[t].BaseCases();
+        scores += rules[t].Scores();
+      }
+
+      Log::Info << baseCases << " cumulative base cases." << std::endl;
+      Log::Info << scores << " cumulative node combinations scored."
           << std::endl;
     }
   }
@@ -195,18 +304,54 @@ template<
              typename TreeMatType> class TreeType>
 void DualTreeBoruvka<MetricType, MatType, TreeType>::AddAllEdges()
 {
-  for (size_t i = 0; i < data.n_cols; i++)
+  // Only the component roots have a candidate edge.  The candidates are added
+  // in parallel; when two components found each other, the union-find lets
+  // only one thread add the edge.
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+  std::vector<std::vector<EdgePair>> threadEdges(numThreads);
+
+  #pragma omp parallel
   {
-    size_t component = connections.Find(i);
-    size_t inEdge = neighborsInComponent[component];
-    size_t outEdge = neighborsOutComponent[component];
-    if (connections.Find(inEdge) != connections.Find(outEdge))
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+
+#ifdef _WIN32
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+    {
+      if (neighborsDistances[i] == DBL_MAX)
+        continue;
+
+      const size_t inEdge = neighborsInComponent[i];
+      const size_t outEdge = neighborsOutComponent[i];
+      if (connections.Union(inEdge, outEdge))
+      {
+        threadEdges[thread].push_back(EdgePair(inEdge, outEdge,
+            neighborsDistances[i]));
+      }
+    }
+  }
+
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    for (size_t i = 0; i < threadEdges[t].size(); ++i)
     {
       // totalDist = totalDist + dist;
       // changed to make this agree with the cover tree code
-      totalDist += neighborsDistances[component];
-      AddEdge(inEdge, outEdge, neighborsDistances[component]);
-      connections.Union(inEdge, outEdge);
+      totalDist += threadEdges[t][i].Distance();
+      AddEdge(threadEdges[t][i].Lesser(), threadEdges[t][i].Greater(),
+          threadEdges[t][i].Distance());
     }
   }
 }
@@ -318,8 +463,7 @@ template<
              typename TreeMatType> class TreeType>
 void DualTreeBoruvka<MetricType, MatType, TreeType>::Cleanup()
 {
-  for (size_t i = 0; i < data.n_cols; i++)
-    neighborsDistances[i] = DBL_MAX;
+  neighborsDistances.fill(DBL_MAX);
 
   if (!naive)
     CleanupHelper(tree);
@@ -16,6 +16,8 @@
 
 #include <mlpack/core/tree/traversal_info.hpp>
 
+#include "lock_free_union_find.hpp"
+
 namespace mlpack {
 namespace emst {
 
@@ -24,7 +26,7 @@ class DTBRules
 {
  public:
   DTBRules(const arma::mat& dataSet,
-           UnionFind& connections,
+           LockFreeUnionFind& connections,
            arma::vec& neighborsDistances,
            arma::Col<size_t>& neighborsInComponent,
            arma::Col<size_t>& neighborsOutComponent,
@@ -102,7 +104,7 @@ class DTBRules
   const arma::mat& dataSet;
 
   //! Stores the tree structure so far
-  UnionFind& connections;
+  LockFreeUnionFind& connections;
 
   //! The distance to the candidate nearest neighbor for each component.
   arma::vec& neighborsDistances;
@@ -0,0 +1,105 @@
+/**
+ * @file lock_free_union_find.hpp
+ *
+ * Implements a Union-Find data structure that may be used by several threads
+ * at once without locks.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_EMST_LOCK_FREE_UNION_FIND_HPP
+#define MLPACK_METHODS_EMST_LOCK_FREE_UNION_FIND_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <atomic>
+
+namespace mlpack {
+namespace emst {
+
+/**
+ * A Union-Find data structure whose Find() and Union() may be called by
+ * several threads at once.  Like UnionFind, each point is initially in its own
+ * component; Union(x, y) unites the components containing x and y, and Find(x)
+ * returns the index of the component containing x.
+ *
+ * The parent of each point is updated with atomic compare-and-swap operations
+ * instead of locks.  The root with the greater index is always linked under the
+ * root with the lesser index, so the index of a component is the least index of
+ * the points in it, and Find() shortens the paths it follows by path halving.
+ * See Anderson and Woll, "Wait-free Parallel Algorithms for the Union-Find
+ * Problem" (STOC 1991).
+ */
+class LockFreeUnionFind
+{
+ private:
+  std::vector<std::atomic<size_t>> parent;
+
+ public:
+  //! Construct the object with the given size.
+  LockFreeUnionFind(const size_t size) : parent(size)
+  {
+    for (size_t i = 0; i < size; ++i)
+      parent[i].store(i);
+  }
+
+  /**
+   * Returns the component containing an element.
+   *
+   * @param x the component to be found
+   * @return The index of the component containing x
+   */
+  size_t Find(size_t x)
+  {
+    size_t xParent = parent[x].load();
+    while (xParent != x)
+    {
+      // Point x to its grandparent.  If another thread changed the parent of x
+      // in the meantime, that is fine too: it can only have moved x closer to
+      // the root.
+      const size_t xGrandparent = parent[xParent].load();
+      if (xGrandparent != xParent)
+        parent[x].compare_exchange_weak(xParent, xGrandparent);
+
+      x = xGrandparent;
+      xParent = parent[x].load();
+    }
+
+    return x;
+  }
+
+  /**
+   * Union the components containing x and y.
+   *
+   * @param x one component
+   * @param y the other component
+   * @return false if x and y were already in the same component.
+   */
+  bool Union(const size_t x, const size_t y)
+  {
+    while (true)
+    {
+      size_t xRoot = Find(x);
+      size_t yRoot = Find(y);
+
+      if (xRoot == yRoot)
+        return false;
+
+      if (xRoot < yRoot)
+        std::swap(xRoot, yRoot);
+
+      // This only succeeds if xRoot is still a root; otherwise another thread
+      // linked it first, and we must try again with the new roots.
+      size_t expected = xRoot;
+      if (parent[xRoot].compare_exchange_strong(expected, yRoot))
+        return true;
+    }
+  }
+}; // class LockFreeUnionFind
+
+} // namespace emst
+} // namespace mlpack
+
+#endif // MLPACK_METHODS_EMST_LOCK_FREE_UNION_FIND_HPP
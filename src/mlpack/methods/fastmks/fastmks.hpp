@@ -271,6 +271,13 @@ class FastMKS
   //! The instantiated inner-product metric induced by the given kernel.
   metric::IPMetric<KernelType> metric;
 
+  //! The cached self-kernels of the reference points (sqrt(K(r, r)) for each
+  //! reference point r), computed on the first tree search.
+  arma::vec referenceKernels;
+
+  //! Get the self-kernels of the reference points, computing them if needed.
+  const arma::vec& ReferenceKernels();
+
   //! Candidate represents a possible candidate point (value, index).
   typedef std::pair<double, size_t> Candidate;
 
@@ -285,6 +292,24 @@ class FastMKS
   //! Use a priority queue to represent the list of candidate points.
   typedef std::priority_queue<Candidate, std::vector<Candidate>,
       CandidateCmp> CandidateList;
+
+  /**
+   * Search for the k maximum kernel values of each query point by brute force.
+   * If sameSet is true, the query set is the reference set, and no point is
+   * returned as its own candidate.
+   */
+  void NaiveSearch(const MatType& querySet,
+                   const size_t k,
+                   arma::Mat<size_t>& indices,
+                   arma::mat& kernels,
+                   const bool sameSet);
+
+  /**
+   * Split the given query tree into disjoint subtrees, so that they can be
+   * traversed in parallel: the subtree with the most descendants is replaced
+   * by its children, until there are a few subtrees for each thread.
+   */
+  static void SplitQueryTree(Tree* queryTree, std::vector<Tree*>& queryNodes);
 };
 
 } // namespace fastmks
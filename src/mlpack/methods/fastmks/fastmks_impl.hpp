@@ -18,6 +18,11 @@
 #include "fastmks_rules.hpp"
 
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace fastmks {
@@ -189,6 +194,9 @@ FastMKS<KernelType, MatType, TreeType>::operator=(const FastMKS& other)
 
   singleMode = other.singleMode;
   naive = other.naive;
+  referenceKernels.clear();
+
+  return *this;
 }
 
 template<typename KernelType,
@@ -217,6 +225,7 @@ void FastMKS<KernelType, MatType, TreeType>::Train(const MatType& referenceSet)
 
   this->referenceSet = &referenceSet;
   this->setOwner = false;
+  referenceKernels.clear();
 
   if (!naive)
   {
@@ -241,6 +250,7 @@ void FastMKS<KernelType, MatType, TreeType>::Train(const MatType& referenceSet,
   this->referenceSet = &referenceSet;
   this->metric = metric::IPMetric<KernelType>(kernel);
   this->setOwner = false;
+  referenceKernels.clear();
 
   if (!naive)
   {
@@ -268,6 +278,7 @@ void FastMKS<KernelType, MatType, TreeType>::Train(Tree* tree)
   this->referenceSet = &tree->Dataset();
   this->metric = metric::IPMetric<KernelType>(tree->Metric().Kernel());
   this->setOwner = false;
+  referenceKernels.clear();
 
   if (treeOwner && referenceTree)
     delete referenceTree;
@@ -304,33 +315,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        const double eval = metric.Kernel().Evaluate(querySet.col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    NaiveSearch(querySet, k, indices, kernels, false);
 
     Timer::Stop("computing_products");
 
@@ -343,7 +328,8 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     // Create rules object (this will store the results).  This constructor
     // precalculates each self-kernel value.
     typedef FastMKSRules<KernelType, Tree> RuleType;
-    RuleType rules(*referenceSet, querySet, k, metric.Kernel());
+    RuleType rules(*referenceSet, querySet, k, metric.Kernel(),
+        &ReferenceKernels());
 
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
@@ -400,15 +386,48 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   kernels.set_size(k, queryTree->Dataset().n_cols);
 
   Timer::Start("computing_products");
+
+  // The query self-kernels can be taken from the metric of the query tree, if
+  // it cached them while the tree was built.
+  const metric::IPMetric<KernelType>& queryMetric = queryTree->Metric();
+  arma::vec queryKernels;
+  if (queryMetric.HasSelfKernels(queryTree->Dataset()))
+    queryKernels = arma::sqrt(queryMetric.SelfKernels());
+
   typedef FastMKSRules<KernelType, Tree> RuleType;
-  RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel());
+  RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel(),
+      &ReferenceKernels(), queryKernels.is_empty() ? NULL : &queryKernels);
+
+  // The results of disjoint query subtrees are independent, so the subtrees
+  // are traversed in parallel.  Each thread has its own rules object for the
+  // traversal state, but all of them store their results in 'rules'.
+  std::vector<Tree*> queryNodes;
+  SplitQueryTree(queryTree, queryNodes);
+
+  size_t baseCases = 0;
+  size_t scores = 0;
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic) reduction(+:baseCases, scores)
+  for (intmax_t i = 0; i < (intmax_t) queryNodes.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic) reduction(+:baseCases, scores)
+  for (size_t i = 0; i < queryNodes.size(); ++i)
+#endif
+  {
+    RuleType threadRules(&rules);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(threadRules);
 
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(*queryNodes[i], *referenceTree);
 
-  traverser.Traverse(*queryTree, *referenceTree);
+    baseCases += threadRules.BaseCases();
+    scores += threadRules.Scores();
+  }
 
-  Log::Info << rules.BaseCases() << " base cases." << std::endl;
-  Log::Info << rules.Scores() << " scores." << std::endl;
+  Log::Info << baseCases << " base cases." << std::endl;
+  Log::Info << scores << " scores." << std::endl;
 
   rules.GetResults(indices, kernels);
 
@@ -433,36 +452,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < referenceSet->n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        if (q == r)
-          continue; // Don't return the point as its own candidate.
-
-        const double eval = metric.Kernel().Evaluate(referenceSet->col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    NaiveSearch(*referenceSet, k, indices, kernels, true);
 
     Timer::Stop("computing_products");
 
@@ -475,7 +465,8 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     // Create rules object (this will store the results).  This constructor
     // precalculates each self-kernel value.
     typedef FastMKSRules<KernelType, Tree> RuleType;
-    RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel());
+    RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel(),
+        &ReferenceKernels());
 
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
@@ -502,6 +493,154 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   Search(referenceTree, k, indices, kernels);
 }
 
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::NaiveSearch(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels,
+    const bool sameSet)
+{
+  // The kernel values are computed for blocks of query and reference points at
+  // a time, which lets kernels that can be evaluated in batches use a matrix
+  // product; then, the candidate lists of the queries in the block are
+  // updated in parallel.
+  const size_t blockSize = 256;
+  const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+
+  arma::mat products;
+  for (size_t qBegin = 0; qBegin < querySet.n_cols; qBegin += blockSize)
+  {
+    const size_t qEnd = std::min(qBegin + blockSize, (size_t) querySet.n_cols);
+    const MatType queryBlock = querySet.cols(qBegin, qEnd - 1);
+    std::vector<CandidateList> pqueues(qEnd - qBegin,
+        CandidateList(CandidateCmp(), std::vector<Candidate>(k, def)));
+
+    for (size_t rBegin = 0; rBegin < referenceSet->n_cols;
+        rBegin += blockSize)
+    {
+      const size_t rEnd = std::min(rBegin + blockSize,
+          (size_t) referenceSet->n_cols);
+      const MatType referenceBlock = referenceSet->cols(rBegin, rEnd - 1);
+      kernel::KernelMatrix(metric.Kernel(), referenceBlock, queryBlock,
+          products);
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp parallel for schedule(static)
+      for (intmax_t qi = 0; qi < (intmax_t) (qEnd - qBegin); ++qi)
+#else
+      #pragma omp parallel for schedule(static)
+      for (size_t qi = 0; qi < qEnd - qBegin; ++qi)
+#endif
+      {
+        CandidateList& pqueue = pqueues[qi];
+        for (size_t ri = 0; ri < rEnd - rBegin; ++ri)
+        {
+          // Don't return the point as its own candidate.
+          if (sameSet && qBegin + qi == rBegin + ri)
+            continue;
+
+          const double eval = products(ri, qi);
+          if (eval > pqueue.top().first)
+          {
+            Candidate c = std::make_pair(eval, rBegin + ri);
+            pqueue.pop();
+            pqueue.push(c);
+          }
+        }
+      }
+    }
+
+    for (size_t qi = 0; qi < qEnd - qBegin; ++qi)
+    {
+      for (size_t j = 1; j <= k; j++)
+      {
+        indices(k - j, qBegin + qi) = pqueues[qi].top().second;
+        kernels(k - j, qBegin + qi) = pqueues[qi].top().first;
+        pqueues[qi].pop();
+      }
+    }
+  }
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+const arma::vec& FastMKS<KernelType, MatType, TreeType>::ReferenceKernels()
+{
+  if (referenceKernels.n_elem != referenceSet->n_cols)
+  {
+    // The metric of the reference tree may already hold K(r, r) from the
+    // construction of the tree.
+    const metric::IPMetric<KernelType>& treeMetric = referenceTree ?
+        referenceTree->Metric() : metric;
+    if (treeMetric.HasSelfKernels(*referenceSet))
+    {
+      referenceKernels = arma::sqrt(treeMetric.SelfKernels());
+    }
+    else
+    {
+      referenceKernels.set_size(referenceSet->n_cols);
+      for (size_t i = 0; i < referenceSet->n_cols; ++i)
+        referenceKernels[i] = sqrt(metric.Kernel().Evaluate(
+            referenceSet->col(i), referenceSet->col(i)));
+    }
+  }
+
+  return referenceKernels;
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::SplitQueryTree(
+    Tree* queryTree,
+    std::vector<Tree*>& queryNodes)
+{
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  queryNodes.assign(1, queryTree);
+  while (numThreads > 1 && queryNodes.size() < 4 * numThreads)
+  {
+    // Find the subtree with the most descendants that can be split.
+    size_t largest = queryNodes.size();
+    for (size_t i = 0; i < queryNodes.size(); ++i)
+    {
+      if (queryNodes[i]->NumChildren() > 0 && (largest == queryNodes.size() ||
+          queryNodes[i]->NumDescendants() >
+          queryNodes[largest]->NumDescendants()))
+        largest = i;
+    }
+
+    if (largest == queryNodes.size())
+      break; // Only leaves are left.
+
+    // The traversals read the bounds of the ancestors of the subtrees but never
+    // update them, so they must not hold the bounds of an earlier search.
+    Tree* node = queryNodes[largest];
+    node->Stat().Bound() = -DBL_MAX;
+
+    queryNodes[largest] = &node->Child(0);
+    for (size_t i = 1; i < node->NumChildren(); ++i)
+      queryNodes.push_back(&node->Child(i));
+  }
+}
+
 //! Serialize the model.
 template<typename KernelType,
          typename MatType,
@@ -519,6 +658,10 @@ void FastMKS<KernelType, MatType, TreeType>::Serialize(
   ar & CreateNVP(naive, "naive");
   ar & CreateNVP(singleMode, "singleMode");
 
+  // The cached self-kernels are recomputed on the next search.
+  if (Archive::is_loading::value)
+    referenceKernels.clear();
+
   // If we are doing naive search, serialize the dataset.  Otherwise we
   // serialize the tree.
   if (naive)
@@ -42,11 +42,30 @@ class FastMKSRules
    * @param querySet Set of query data.
    * @param k Number of candidates to search for.
    * @param kernel Kernel to run FastMKS with.
+   * @param referenceKernels If given, the precomputed self-kernels
+   *     (sqrt(K(r, r)) for each reference point r), which must outlive this
+   *     object; otherwise, they are computed here.
+   * @param queryKernels If given, the precomputed self-kernels of the query
+   *     points, which must outlive this object; otherwise, they are computed
+   *     here.
    */
   FastMKSRules(const typename TreeType::Mat& referenceSet,
                const typename TreeType::Mat& querySet,
                const size_t k,
-               KernelType& kernel);
+               KernelType& kernel,
+               const arma::vec* referenceKernels = NULL,
+               const arma::vec* queryKernels = NULL);
+
+  /**
+   * Construct a FastMKSRules object that shares the datasets, the cached
+   * self-kernels and the candidate lists of the given object, but has its own
+   * traversal state and counters.  This lets different threads traverse
+   * disjoint query subtrees at the same time; the given object must outlive
+   * this one, and it holds the results.
+   *
+   * @param other Rules object to share the results with.
+   */
+  explicit FastMKSRules(FastMKSRules* other);
 
   /**
    * Store the list of candidates for each query point in the given matrices.
@@ -148,16 +167,22 @@ class FastMKSRules
   typedef boost::heap::priority_queue<Candidate,
       boost::heap::compare<CandidateCmp>> CandidateList;
 
+  //! The candidates of each point, if this object holds them.
+  std::vector<CandidateList> localCandidates;
   //! Set of candidates for each point.
-  std::vector<CandidateList> candidates;
+  std::vector<CandidateList>& candidates;
 
   //! Number of points to search for.
   const size_t k;
 
+  //! The query set self-kernels, if this object holds them.
+  arma::vec localQueryKernels;
+  //! The reference set self-kernels, if this object holds them.
+  arma::vec localReferenceKernels;
   //! Cached query set self-kernels (|| q || for each q).
-  arma::vec queryKernels;
+  const arma::vec& queryKernels;
   //! Cached reference set self-kernels (|| r || for each r).
-  arma::vec referenceKernels;
+  const arma::vec& referenceKernels;
 
   //! The instantiated kernel.
   KernelType& kernel;
@@ -172,6 +197,16 @@ class FastMKSRules
   //! Calculate the bound for a given query node.
   double CalculateBound(TreeType& queryNode) const;
 
+  /**
+   * Compute the self-kernel sqrt(K(x, x)) of each point x of the given
+   * dataset.
+   *
+   * @param dataset Set of points.
+   * @param selfKernels Vector to store the self-kernels in.
+   */
+  void SelfKernels(const typename TreeType::Mat& dataset,
+                   arma::vec& selfKernels);
+
   /**
    * Helper function to insert a point into the list of candidate points.
    *
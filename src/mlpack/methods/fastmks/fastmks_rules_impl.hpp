@@ -23,10 +23,16 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     const typename TreeType::Mat& referenceSet,
     const typename TreeType::Mat& querySet,
     const size_t k,
-    KernelType& kernel) :
+    KernelType& kernel,
+    const arma::vec* referenceKernels,
+    const arma::vec* queryKernels) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(localCandidates),
     k(k),
+    queryKernels(queryKernels ? *queryKernels : localQueryKernels),
+    referenceKernels(referenceKernels ? *referenceKernels :
+        localReferenceKernels),
     kernel(kernel),
     lastQueryIndex(-1),
     lastReferenceIndex(-1),
@@ -34,16 +40,12 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     baseCases(0),
     scores(0)
 {
-  // Precompute each self-kernel.
-  queryKernels.set_size(querySet.n_cols);
-  for (size_t i = 0; i < querySet.n_cols; ++i)
-    queryKernels[i] = sqrt(kernel.Evaluate(querySet.col(i),
-                                           querySet.col(i)));
+  // Precompute each self-kernel that wasn't given.
+  if (!queryKernels)
+    SelfKernels(querySet, localQueryKernels);
 
-  referenceKernels.set_size(referenceSet.n_cols);
-  for (size_t i = 0; i < referenceSet.n_cols; ++i)
-    referenceKernels[i] = sqrt(kernel.Evaluate(referenceSet.col(i),
-                                               referenceSet.col(i)));
+  if (!referenceKernels)
+    SelfKernels(referenceSet, localReferenceKernels);
 
   // Set to invalid memory, so that the first node combination does not try to
   // dereference null pointers.
@@ -61,7 +63,28 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
   for (size_t i = 0; i < k; i++)
     pqueue.push(def);
   std::vector<CandidateList> tmp(querySet.n_cols, pqueue);
-  candidates.swap(tmp);
+  localCandidates.swap(tmp);
+}
+
+template<typename KernelType, typename TreeType>
+FastMKSRules<KernelType, TreeType>::FastMKSRules(FastMKSRules* other) :
+    referenceSet(other->referenceSet),
+    querySet(other->querySet),
+    candidates(other->candidates),
+    k(other->k),
+    queryKernels(other->queryKernels),
+    referenceKernels(other->referenceKernels),
+    kernel(other->kernel),
+    lastQueryIndex(-1),
+    lastReferenceIndex(-1),
+    lastKernel(0.0),
+    baseCases(0),
+    scores(0)
+{
+  // Set to invalid memory, so that the first node combination does not try to
+  // dereference null pointers.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
 }
 
 template<typename KernelType, typename TreeType>
@@ -516,6 +539,27 @@ double FastMKSRules<KernelType, TreeType>::CalculateBound(TreeType& queryNode)
   return (interA > interB) ? interA : interB;
 }
 
+template<typename KernelType, typename TreeType>
+void FastMKSRules<KernelType, TreeType>::SelfKernels(
+    const typename TreeType::Mat& dataset,
+    arma::vec& selfKernels)
+{
+  selfKernels.set_size(dataset.n_cols);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for if (dataset.n_cols >= 2048)
+  for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+  #pragma omp parallel for if (dataset.n_cols >= 2048)
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
+  {
+    selfKernels[i] = sqrt(kernel.Evaluate(dataset.col(i), dataset.col(i)));
+  }
+}
+
 /**
  * Helper function to insert a point into the list of candidate points.
  *
@@ -31,6 +31,9 @@ class DiagonalConstraint
     covariance = arma::diagmat(diagonal);
   }
 
+  //! The diagonal of a covariance matrix is already diagonal; do nothing.
+  static void ApplyConstraint(const arma::vec& /* diagCovariance */) { }
+
   //! Serialize the constraint (which holds nothing, so, nothing to do).
   template<typename Archive>
   static void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
@@ -0,0 +1,169 @@
+/**
+ * @file diagonal_gmm.cpp
+ *
+ * Implementation of the non-template methods of DiagonalGMM.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "diagonal_gmm.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * Create a DiagonalGMM with the given number of Gaussians, each of which have
+ * the specified dimensionality, zero mean and identity covariance.
+ *
+ * @param gaussians Number of Gaussians in this model.
+ * @param dimensionality Dimensionality of each Gaussian.
+ */
+DiagonalGMM::DiagonalGMM(const size_t gaussians, const size_t dimensionality) :
+    gaussians(gaussians),
+    dimensionality(dimensionality),
+    dists(gaussians,
+        distribution::DiagonalGaussianDistribution(dimensionality)),
+    weights(gaussians)
+{
+  // Set equal weights.  Technically this model is still valid, but only barely.
+  weights.fill(1.0 / gaussians);
+}
+
+// Copy constructor.
+DiagonalGMM::DiagonalGMM(const DiagonalGMM& other) :
+    gaussians(other.Gaussians()),
+    dimensionality(other.dimensionality),
+    dists(other.dists),
+    weights(other.weights) { /* Nothing to do. */ }
+
+DiagonalGMM& DiagonalGMM::operator=(const DiagonalGMM& other)
+{
+  gaussians = other.gaussians;
+  dimensionality = other.dimensionality;
+  dists = other.dists;
+  weights = other.weights;
+
+  return *this;
+}
+
+/**
+ * Return the probability of the given observation being from this model.
+ */
+double DiagonalGMM::Probability(const arma::vec& observation) const
+{
+  // Sum the probability for each Gaussian in our mixture (and we have to
+  // multiply by the prior for each Gaussian too).
+  double sum = 0;
+  for (size_t i = 0; i < gaussians; i++)
+    sum += weights[i] * dists[i].Probability(observation);
+
+  return sum;
+}
+
+/**
+ * Return the probability of the given observation being from the given
+ * component in the mixture.
+ */
+double DiagonalGMM::Probability(const arma::vec& observation,
+                        const size_t component) const
+{
+  // We are only considering one Gaussian component -- so we only need to call
+  // Probability() once.  We do consider the prior probability!
+  return weights[component] * dists[component].Probability(observation);
+}
+
+/**
+ * Return a randomly generated observation according to the probability
+ * distribution defined by this object.
+ */
+arma::vec DiagonalGMM::Random() const
+{
+  // Determine which Gaussian it will be coming from.
+  double gaussRand = math::Random();
+  size_t gaussian = 0;
+
+  double sumProb = 0;
+  for (size_t g = 0; g < gaussians; g++)
+  {
+    sumProb += weights(g);
+    if (gaussRand <= sumProb)
+    {
+      gaussian = g;
+      break;
+    }
+  }
+
+  return dists[gaussian].Random();
+}
+
+/**
+ * Return the probability of each of the given observations being from this
+ * model.
+ */
+void DiagonalGMM::Probability(const arma::mat& observations,
+                      arma::vec& probabilities) const
+{
+  LogProbability(observations, probabilities);
+  probabilities = arma::exp(probabilities);
+}
+
+/**
+ * Return the log probability of each of the given observations being from this
+ * model.
+ */
+void DiagonalGMM::LogProbability(const arma::mat& observations,
+                         arma::vec& logProbabilities) const
+{
+  arma::mat componentLogProbabilities;
+  ComponentLogProbabilities(observations, dists, weights,
+      componentLogProbabilities);
+
+  logProbabilities.set_size(observations.n_cols);
+  for (size_t j = 0; j < observations.n_cols; ++j)
+    logProbabilities[j] = LogSumExp(componentLogProbabilities.unsafe_col(j));
+}
+
+/**
+ * Classify the given observations as being from an individual component in this
+ * model.
+ */
+void DiagonalGMM::Classify(const arma::mat& observations,
+                   arma::Row<size_t>& labels) const
+{
+  // The most probable component of each observation is the one with the
+  // largest (weighted) log probability.
+  arma::mat componentLogProbabilities;
+  ComponentLogProbabilities(observations, dists, weights,
+      componentLogProbabilities);
+
+  labels.set_size(observations.n_cols);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    arma::uword maxIndex = 0;
+    componentLogProbabilities.unsafe_col(i).max(maxIndex);
+    labels[i] = maxIndex;
+  }
+}
+
+/**
+ * Get the log-likelihood of this data's fit to the model.
+ */
+double DiagonalGMM::LogLikelihood(
+    const arma::mat& data,
+    const std::vector<distribution::DiagonalGaussianDistribution>& distsL,
+    const arma::vec& weightsL) const
+{
+  arma::mat componentLogProbabilities;
+  ComponentLogProbabilities(data, distsL, weightsL, componentLogProbabilities);
+
+  // Now sum over every point.
+  double loglikelihood = 0;
+  for (size_t j = 0; j < data.n_cols; j++)
+    loglikelihood += LogSumExp(componentLogProbabilities.unsafe_col(j));
+  return loglikelihood;
+}
+
+} // namespace gmm
+} // namespace mlpack
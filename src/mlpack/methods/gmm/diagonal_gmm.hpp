@@ -0,0 +1,324 @@
+/**
+ * @file diagonal_gmm.hpp
+ *
+ * Defines a Gaussian Mixture Model whose components have diagonal covariances,
+ * and estimates the parameters of the model.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_DIAGONAL_GMM_HPP
+#define MLPACK_METHODS_GMM_DIAGONAL_GMM_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
+
+// This is the default fitting method class.
+#include "em_fit.hpp"
+#include "mixture_log_probabilities.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+//! The default fitting type of DiagonalGMM: the EM algorithm, estimating only
+//! the variances of the components.
+typedef EMFit<kmeans::KMeans<>, PositiveDefiniteConstraint,
+    distribution::DiagonalGaussianDistribution> DiagonalEMFit;
+
+/**
+ * A Gaussian Mixture Model whose components have diagonal covariances.  It has
+ * the same interface as GMM, but its components are
+ * DiagonalGaussianDistributions, which only store the variances of each
+ * dimension; so a component takes O(d) memory instead of O(d^2), and the
+ * probabilities of the observations and each iteration of the EM algorithm
+ * take O(d) time per observation and component instead of O(d^2).  For
+ * high-dimensional data this is much faster than a GMM trained with
+ * DiagonalConstraint, which gives the same model but still stores and
+ * computes with full covariance matrices.
+ *
+ * The FittingType of Train() must provide the same functions as for GMM, with
+ * std::vector<distribution::DiagonalGaussianDistribution> components; the
+ * default is DiagonalEMFit, and any EMFit with DiagonalGaussianDistribution as
+ * its Distribution parameter may be used.
+ *
+ * Example use:
+ *
+ * @code
+ * // Set up a mixture of 5 gaussians in a 1000-dimensional space.
+ * DiagonalGMM g(5, 1000);
+ *
+ * // Train the model given the data observations, using the default EM
+ * // fitting mechanism.
+ * g.Train(data);
+ *
+ * // Get the log probability of each observation.
+ * arma::vec logProbabilities;
+ * g.LogProbability(data, logProbabilities);
+ * @endcode
+ */
+class DiagonalGMM
+{
+ private:
+  //! The number of Gaussians in the model.
+  size_t gaussians;
+  //! The dimensionality of the model.
+  size_t dimensionality;
+
+  //! Vector of Gaussians
+  std::vector<distribution::DiagonalGaussianDistribution> dists;
+
+  //! Vector of a priori weights for each Gaussian.
+  arma::vec weights;
+
+ public:
+  /**
+   * Create an empty Gaussian Mixture Model, with zero gaussians.
+   */
+  DiagonalGMM() :
+      gaussians(0),
+      dimensionality(0)
+  {
+    // Warn the user.  They probably don't want to do this.  If this constructor
+    // is being used (because it is required by some template classes), the user
+    // should know that it is potentially dangerous.
+    Log::Debug << "DiagonalGMM::DiagonalGMM(): no parameters given; "
+        << "Estimate() may fail unless parameters are set." << std::endl;
+  }
+
+  /**
+   * Create a DiagonalGMM with the given number of Gaussians, each of which
+   * have the specified dimensionality, zero mean and identity covariance.
+   *
+   * @param gaussians Number of Gaussians in this model.
+   * @param dimensionality Dimensionality of each Gaussian.
+   */
+  DiagonalGMM(const size_t gaussians, const size_t dimensionality);
+
+  /**
+   * Create a DiagonalGMM with the given dists and weights.
+   *
+   * @param dists Distributions of the model.
+   * @param weights Weights of the model.
+   */
+  DiagonalGMM(
+      const std::vector<distribution::DiagonalGaussianDistribution>& dists,
+      const arma::vec& weights) :
+      gaussians(dists.size()),
+      dimensionality((!dists.empty()) ? dists[0].Mean().n_elem : 0),
+      dists(dists),
+      weights(weights) { /* Nothing to do. */ }
+
+  //! Copy constructor for DiagonalGMMs.
+  DiagonalGMM(const DiagonalGMM& other);
+
+  //! Copy operator for DiagonalGMMs.
+  DiagonalGMM& operator=(const DiagonalGMM& other);
+
+  //! Return the number of gaussians in the model.
+  size_t Gaussians() const { return gaussians; }
+  //! Return the dimensionality of the model.
+  size_t Dimensionality() const { return dimensionality; }
+
+  /**
+   * Return a const reference to a component distribution.
+   *
+   * @param i index of component.
+   */
+  const distribution::DiagonalGaussianDistribution& Component(size_t i) const {
+      return dists[i]; }
+  /**
+   * Return a reference to a component distribution.
+   *
+   * @param i index of component.
+   */
+  distribution::DiagonalGaussianDistribution& Component(size_t i)
+  { return dists[i]; }
+
+  //! Return a const reference to the a priori weights of each Gaussian.
+  const arma::vec& Weights() const { return weights; }
+  //! Return a reference to the a priori weights of each Gaussian.
+  arma::vec& Weights() { return weights; }
+
+  /**
+   * Return the probability that the given observation came from this
+   * distribution.
+   *
+   * @param observation Observation to evaluate the probability of.
+   */
+  double Probability(const arma::vec& observation) const;
+
+  /**
+   * Return the probability that the given observation came from the given
+   * Gaussian component in this distribution.
+   *
+   * @param observation Observation to evaluate the probability of.
+   * @param component Index of the component of the model to be considered.
+   */
+  double Probability(const arma::vec& observation,
+                     const size_t component) const;
+
+  /**
+   * Compute the probability that each of the given observations came from
+   * this distribution.  The observations are processed in blocks, in parallel
+   * if OpenMP is available; see LogProbability().
+   *
+   * @param observations Observations to evaluate the probabilities of.
+   * @param probabilities Vector to store the probability of each observation
+   *     in.
+   */
+  void Probability(const arma::mat& observations,
+                   arma::vec& probabilities) const;
+
+  /**
+   * Compute the log probability that each of the given observations came from
+   * this distribution.  The log probabilities of all the components are
+   * computed for blocks of observations at a time (in parallel if OpenMP is
+   * available), and are summed with the log-sum-exp trick, so observations far
+   * from every component do not underflow to a probability of zero.
+   *
+   * @param observations Observations to evaluate the log probabilities of.
+   * @param logProbabilities Vector to store the log probability of each
+   *     observation in.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
+  /**
+   * Return a randomly generated observation according to the probability
+   * distribution defined by this object.
+   *
+   * @return Random observation from this model.
+   */
+  arma::vec Random() const;
+
+  /**
+   * Estimate the probability distribution directly from the given observations,
+   * using the given algorithm in the FittingType class to fit the data.
+   *
+   * The fitting will be performed 'trials' times; from these trials, the model
+   * with the greatest log-likelihood will be selected.  By default, only one
+   * trial is performed.  The log-likelihood of the best fitting is returned.
+   *
+   * Optionally, the existing model can be used as an initial model for the
+   * estimation by setting 'useExistingModel' to true.  If the fitting procedure
+   * is deterministic after the initial position is given, then 'trials' should
+   * be set to 1.
+   *
+   * @tparam FittingType The type of fitting method which should be used
+   *     (DiagonalEMFit is suggested).
+   * @param observations Observations of the model.
+   * @param trials Number of trials to perform; the model in these trials with
+   *      the greatest log-likelihood will be selected.
+   * @param useExistingModel If true, the existing model is used as an initial
+   *      model for the estimation.
+   * @return The log-likelihood of the best fit.
+   */
+  template<typename FittingType = DiagonalEMFit>
+  double Train(const arma::mat& observations,
+               const size_t trials = 1,
+               const bool useExistingModel = false,
+               FittingType fitter = FittingType());
+
+  /**
+   * Estimate the probability distribution directly from the given observations,
+   * taking into account the probability of each observation actually being from
+   * this distribution, and using the given algorithm in the FittingType class
+   * to fit the data.
+   *
+   * The fitting will be performed 'trials' times; from these trials, the model
+   * with the greatest log-likelihood will be selected.  By default, only one
+   * trial is performed.  The log-likelihood of the best fitting is returned.
+   *
+   * Optionally, the existing model can be used as an initial model for the
+   * estimation by setting 'useExistingModel' to true.  If the fitting procedure
+   * is deterministic after the initial position is given, then 'trials' should
+   * be set to 1.
+   *
+   * @param observations Observations of the model.
+   * @param probabilities Probability of each observation being from this
+   *     distribution.
+   * @param trials Number of trials to perform; the model in these trials with
+   *     the greatest log-likelihood will be selected.
+   * @param useExistingModel If true, the existing model is used as an initial
+   *     model for the estimation.
+   * @return The log-likelihood of the best fit.
+   */
+  template<typename FittingType = DiagonalEMFit>
+  double Train(const arma::mat& observations,
+               const arma::vec& probabilities,
+               const size_t trials = 1,
+               const bool useExistingModel = false,
+               FittingType fitter = FittingType());
+
+  /**
+   * Classify the given observations as being from an individual component in
+   * this model.  The resultant classifications are stored in the 'labels'
+   * object, and each label will be between 0 and (Gaussians() - 1).  Supposing
+   * that a point was classified with label 2, and that our DiagonalGMM object
+   * was called 'gmm', one could access the relevant Gaussian distribution as
+   * follows:
+   *
+   * @code
+   * arma::vec mean = gmm.Component(2).Mean();
+   * arma::vec variances = gmm.Component(2).Covariance();
+   * double priorWeight = gmm.Weights()[2];
+   * @endcode
+   *
+   * @param observations List of observations to classify.
+   * @param labels Object which will be filled with labels.
+   */
+  void Classify(const arma::mat& observations,
+                arma::Row<size_t>& labels) const;
+
+  /**
+   * Serialize the Diagonalmodel.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  /**
+   * This function computes the loglikelihood of the given model.  This function
+   * is used by DiagonalGMM::Train().
+   *
+   * @param dataPoints Observations to calculate the likelihood for.
+   * @param means Means of the given mixture model.
+   * @param covars Covariances of the given mixture model.
+   * @param weights Weights of the given mixture model.
+   */
+  double LogLikelihood(
+      const arma::mat& dataPoints,
+      const std::vector<distribution::DiagonalGaussianDistribution>& distsL,
+      const arma::vec& weights) const;
+
+  /**
+   * Run the given number of trials of the given estimation, and keep the model
+   * with the greatest log-likelihood.  The trials run in parallel if OpenMP is
+   * available, each on its own copy of the model; trial i seeds the random
+   * number generator of its thread with the i'th of a list of seeds drawn from
+   * mlpack::math::RandGen() beforehand, so the result does not depend on the
+   * number of threads.  This function is used by DiagonalGMM::Train().
+   *
+   * @param observations Observations of the model.
+   * @param trials Number of trials to perform (at least 2).
+   * @param useExistingModel If true, each trial starts from the current model.
+   * @param estimate Function that fits the given dists and weights.
+   * @return The log-likelihood of the best fit.
+   */
+  template<typename EstimateType>
+  double TrainTrials(const arma::mat& observations,
+                     const size_t trials,
+                     const bool useExistingModel,
+                     const EstimateType& estimate);
+};
+
+} // namespace gmm
+} // namespace mlpack
+
+// Include implementation.
+#include "diagonal_gmm_impl.hpp"
+
+#endif
+
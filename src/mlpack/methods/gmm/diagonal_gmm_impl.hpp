@@ -0,0 +1,208 @@
+/**
+ * @file diagonal_gmm_impl.hpp
+ *
+ * Implementation of the template methods of DiagonalGMM.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_DIAGONAL_GMM_IMPL_HPP
+#define MLPACK_METHODS_GMM_DIAGONAL_GMM_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "diagonal_gmm.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * Fit the model to the given observations.
+ */
+template<typename FittingType>
+double DiagonalGMM::Train(const arma::mat& observations,
+                  const size_t trials,
+                  const bool useExistingModel,
+                  FittingType fitter)
+{
+  double bestLikelihood; // This will be reported later.
+
+  // We don't need to store temporary models if we are only doing one trial.
+  if (trials == 1)
+  {
+    // Train the model.  The user will have been warned earlier if the model was
+    // initialized with no parameters (0 gaussians, dimensionality of 0).
+    fitter.Estimate(observations, dists, weights, useExistingModel);
+    bestLikelihood = LogLikelihood(observations, dists, weights);
+  }
+  else
+  {
+    if (trials == 0)
+      return -DBL_MAX; // It's what they asked for...
+
+    // Each trial uses its own copy of the fitter.
+    bestLikelihood = TrainTrials(observations, trials, useExistingModel,
+        [&](std::vector<distribution::DiagonalGaussianDistribution>& trialDists,
+            arma::vec& trialWeights)
+        {
+          FittingType trialFitter(fitter);
+          trialFitter.Estimate(observations, trialDists, trialWeights,
+              useExistingModel);
+        });
+  }
+
+  // Report final log-likelihood and return it.
+  Log::Info << "DiagonalGMM::Train(): log-likelihood of trained model is "
+      << bestLikelihood << "." << std::endl;
+  return bestLikelihood;
+}
+
+/**
+ * Fit the model to the given observations, each of which has a certain
+ * probability of being from this distribution.
+ */
+template<typename FittingType>
+double DiagonalGMM::Train(const arma::mat& observations,
+                  const arma::vec& probabilities,
+                  const size_t trials,
+                  const bool useExistingModel,
+                  FittingType fitter)
+{
+  double bestLikelihood; // This will be reported later.
+
+  // We don't need to store temporary models if we are only doing one trial.
+  if (trials == 1)
+  {
+    // Train the model.  The user will have been warned earlier if the model was
+    // initialized with no parameters (0 gaussians, dimensionality of 0).
+    fitter.Estimate(observations, probabilities, dists, weights,
+        useExistingModel);
+    bestLikelihood = LogLikelihood(observations, dists, weights);
+  }
+  else
+  {
+    if (trials == 0)
+      return -DBL_MAX; // It's what they asked for...
+
+    // Each trial uses its own copy of the fitter.
+    bestLikelihood = TrainTrials(observations, trials, useExistingModel,
+        [&](std::vector<distribution::DiagonalGaussianDistribution>& trialDists,
+            arma::vec& trialWeights)
+        {
+          FittingType trialFitter(fitter);
+          trialFitter.Estimate(observations, probabilities, trialDists,
+              trialWeights, useExistingModel);
+        });
+  }
+
+  // Report final log-likelihood and return it.
+  Log::Info << "DiagonalGMM::Train(): log-likelihood of trained model is "
+      << bestLikelihood << "." << std::endl;
+  return bestLikelihood;
+}
+
+/**
+ * Run the trials of Train() in parallel and keep the best model.
+ */
+template<typename EstimateType>
+double DiagonalGMM::TrainTrials(const arma::mat& observations,
+                        const size_t trials,
+                        const bool useExistingModel,
+                        const EstimateType& estimate)
+{
+  // Draw the seeds of the trials first, so that each trial gets the same
+  // random numbers whichever thread runs it.
+  std::vector<uint64_t> seeds(trials);
+  for (size_t t = 0; t < trials; ++t)
+    seeds[t] = math::RandGen()();
+
+  // Every trial starts from the current model if it is used, or from an
+  // unfitted model otherwise; the observations are shared.
+  std::vector<std::vector<distribution::DiagonalGaussianDistribution>>
+      trialDists(trials, useExistingModel ? dists :
+      std::vector<distribution::DiagonalGaussianDistribution>(gaussians,
+      distribution::DiagonalGaussianDistribution(dimensionality)));
+  std::vector<arma::vec> trialWeights(trials, useExistingModel ? weights :
+      arma::vec(gaussians));
+  arma::vec likelihoods(trials);
+  std::exception_ptr error;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t t = 0; t < (intmax_t) trials; ++t)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t t = 0; t < trials; ++t)
+#endif
+  {
+    try
+    {
+      math::RandGen().Seed(seeds[t]);
+
+      estimate(trialDists[t], trialWeights[t]);
+      likelihoods[t] = LogLikelihood(observations, trialDists[t],
+          trialWeights[t]);
+    }
+    catch (...)
+    {
+      #pragma omp critical
+      {
+        if (!error)
+          error = std::current_exception();
+      }
+    }
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+
+  size_t best = 0;
+  for (size_t t = 0; t < trials; ++t)
+  {
+    Log::Info << "DiagonalGMM::Train(): Log-likelihood of trial " << t << " is "
+        << likelihoods[t] << "." << std::endl;
+
+    if (likelihoods[t] > likelihoods[best])
+      best = t;
+  }
+
+  dists = std::move(trialDists[best]);
+  weights = std::move(trialWeights[best]);
+  return likelihoods[best];
+}
+
+/**
+ * Serialize the object.
+ */
+template<typename Archive>
+void DiagonalGMM::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(gaussians, "gaussians");
+  ar & CreateNVP(dimensionality, "dimensionality");
+
+  // Load (or save) the gaussians.  Not going to use the default std::vector
+  // serialize here because it won't call out correctly to Serialize() for each
+  // Gaussian distribution.
+  if (Archive::is_loading::value)
+    dists.resize(gaussians);
+
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    std::ostringstream oss;
+    oss << "dist" << i;
+    ar & CreateNVP(dists[i], oss.str());
+  }
+
+  ar & CreateNVP(weights, "weights");
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
+
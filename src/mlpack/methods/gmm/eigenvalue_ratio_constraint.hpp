@@ -76,6 +76,20 @@ class EigenvalueRatioConstraint
     covariance = eigenvectors * arma::diagmat(eigenvalues) * eigenvectors.t();
   }
 
+  /**
+   * Apply the eigenvalue ratio constraint to the given diagonal of a diagonal
+   * covariance matrix, whose eigenvalues are its diagonal elements.
+   */
+  void ApplyConstraint(arma::vec& diagCovariance) const
+  {
+    // Order the diagonal as arma::eig_sym() orders the eigenvalues, and force
+    // the same values in that order.
+    const arma::uvec order = arma::sort_index(diagCovariance);
+    const double first = diagCovariance[order[0]];
+    for (size_t i = 0; i < order.n_elem; ++i)
+      diagCovariance[order[i]] = first * ratios[i];
+  }
+
   //! Serialize the constraint.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */)
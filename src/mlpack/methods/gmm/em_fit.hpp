@@ -16,6 +16,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
 
 // Default clustering mechanism.
 #include <mlpack/methods/kmeans/kmeans.hpp>
@@ -37,12 +38,29 @@ namespace gmm {
  *
  * This method should create 'clusters' clusters, and return the assignment of
  * each point to a cluster.
+ *
+ * The components of the mixture are GaussianDistributions by default; with
+ * DiagonalGaussianDistribution as the Distribution parameter, only the
+ * variances of the components are estimated and stored, so that an iteration
+ * takes O(d) time and memory per point and component instead of O(d^2).  The
+ * covariance constraint is then applied to the vector of variances.
  */
 template<typename InitialClusteringType = kmeans::KMeans<>,
-         typename CovarianceConstraintPolicy = PositiveDefiniteConstraint>
+         typename CovarianceConstraintPolicy = PositiveDefiniteConstraint,
+         typename Distribution = distribution::GaussianDistribution>
 class EMFit
 {
  public:
+  //! The type of the covariance of a component: a matrix, or the vector of
+  //! variances for a DiagonalGaussianDistribution.
+  typedef typename std::decay<decltype(
+      std::declval<const Distribution&>().Covariance())>::type CovarianceType;
+  //! The type of the second moments of all the components: a slice of a cube
+  //! for each component, or a column of a matrix if only the variances of the
+  //! components are estimated.
+  typedef typename std::conditional<std::is_same<CovarianceType,
+      arma::vec>::value, arma::mat, arma::cube>::type SecondMomentsType;
+
   /**
    * Construct the EMFit object, optionally passing an InitialClusteringType
    * object (just in case it needs to store state).  Setting the maximum number
@@ -81,7 +99,7 @@ class EMFit
    *      clustering.
    */
   void Estimate(const arma::mat& observations,
-                std::vector<distribution::GaussianDistribution>& dists,
+                std::vector<Distribution>& dists,
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
@@ -104,7 +122,30 @@ class EMFit
    */
   void Estimate(const arma::mat& observations,
                 const arma::vec& probabilities,
-                std::vector<distribution::GaussianDistribution>& dists,
+                std::vector<Distribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel = false);
+
+  /**
+   * Fit observations that are split into shards to a Gaussian mixture model
+   * (GMM) using the EM algorithm.  The E step runs on each shard separately,
+   * and only the sufficient statistics of each shard (the sum of the
+   * conditional probabilities, and the weighted first and second moments of
+   * each component) are summed to run the M step, so this is the structure of
+   * a distributed fit where each shard lives on a different machine.  The
+   * model and the convergence check are the same as those of Estimate() on
+   * all of the observations, up to floating-point rounding.  If
+   * useInitialModel is false, the initial clustering is computed on the first
+   * shard only.
+   *
+   * @param shards Shards of the observations to train on.
+   * @param dists Vector to store the trained components in.
+   * @param weights Vector to store a priori weights in.
+   * @param useInitialModel If true, the given model is used for the initial
+   *      clustering.
+   */
+  void Estimate(const std::vector<arma::mat>& shards,
+                std::vector<Distribution>& dists,
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
@@ -132,11 +173,11 @@ class EMFit
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int version);
 
- private:
   /**
    * Run the clusterer, and then turn the cluster assignments into Gaussians.
-   * This is a helper function for both overloads of Estimate().  The vectors
-   * must be already set to the number of clusters.
+   * This is a helper function for both overloads of Estimate(), and is also
+   * used by OnlineEMFit.  The vectors must be already set to the number of
+   * clusters.
    *
    * @param observations List of observations.
    * @param means Vector to store means in.
@@ -144,23 +185,134 @@ class EMFit
    * @param weights Vector to store a priori weights in.
    */
   void InitialClustering(const arma::mat& observations,
-                         std::vector<distribution::GaussianDistribution>& dists,
+                         std::vector<Distribution>& dists,
                          arma::vec& weights);
 
+ private:
   /**
-   * Calculate the log-likelihood of a model.  Yes, this is reimplemented in the
-   * GMM code.  Intuition suggests that the log-likelihood is not the best way
-   * to determine if the EM algorithm has converged.
+   * Run the E step: calculate the probability of each component given each
+   * observation (column i of condProb holds the probabilities for observation
+   * i), and return the log-likelihood of the model.  The observations are
+   * processed in blocks, in parallel with OpenMP, so the log-likelihood comes
+   * for free instead of needing another pass over the data.
    *
-   * @param data Data matrix.
-   * @param means Vector of means.
-   * @param covariances Vector of covariance matrices.
-   * @param weights Vector of a priori weights.
+   * @param observations List of observations.
+   * @param dists Current components of the model.
+   * @param weights Current a priori weights of the components.
+   * @param condProb Matrix to store the conditional probabilities in.
    */
-  double LogLikelihood(const arma::mat& data,
-                       const std::vector<distribution::GaussianDistribution>&
-                           dists,
-                       const arma::vec& weights) const;
+  double EStep(const arma::mat& observations,
+               const std::vector<Distribution>& dists,
+               const arma::vec& weights,
+               arma::mat& condProb) const;
+
+  /**
+   * Run the M step: update the components and weights of the model from the
+   * conditional probabilities given by EStep().  If probabilities is not
+   * empty, each observation is weighted by its probability of being from this
+   * model.
+   *
+   * @param observations List of observations.
+   * @param condProb Conditional probabilities given by EStep().
+   * @param probabilities Probability of each point being from this model (or
+   *     an empty vector).
+   * @param dists Components of the model to update.
+   * @param weights A priori weights of the components to update.
+   */
+  void MStep(const arma::mat& observations,
+             const arma::mat& condProb,
+             const arma::vec& probabilities,
+             std::vector<Distribution>& dists,
+             arma::vec& weights);
+
+  /**
+   * Add the sufficient statistics of the given observations to probSums,
+   * moments and secondMoments: for each component, the sum of the conditional
+   * probabilities, and the first and second moments of the observations
+   * around the current mean, weighted by those probabilities.  Each thread
+   * accumulates the statistics of its blocks of observations in its own
+   * buffers; the statistics are taken around the current means, so that they
+   * can be gathered in a single pass without losing precision.
+   *
+   * @param observations List of observations.
+   * @param condProb Conditional probabilities given by EStep().
+   * @param probabilities Probability of each point being from this model (or
+   *     an empty vector).
+   * @param dists Current components of the model.
+   * @param probSums Sums of the conditional probabilities to add to.
+   * @param moments First moments to add to (one column per component).
+   * @param secondMoments Second moments to add to (one slice, or one column of
+   *     variances, per component).
+   */
+  void AccumulateStatistics(
+      const arma::mat& observations,
+      const arma::mat& condProb,
+      const arma::vec& probabilities,
+      const std::vector<Distribution>& dists,
+      arma::vec& probSums,
+      arma::mat& moments,
+      SecondMomentsType& secondMoments) const;
+
+  /**
+   * Update the components and weights of the model from the sufficient
+   * statistics given by AccumulateStatistics().
+   *
+   * @param probSums Sums of the conditional probabilities.
+   * @param moments First moments around the current means.
+   * @param secondMoments Second moments around the current means.
+   * @param totalWeight Total weight of the observations.
+   * @param dists Components of the model to update.
+   * @param weights A priori weights of the components to update.
+   */
+  void UpdateModel(const arma::vec& probSums,
+                   const arma::mat& moments,
+                   const SecondMomentsType& secondMoments,
+                   const double totalWeight,
+                   std::vector<Distribution>& dists,
+                   arma::vec& weights);
+
+  //! Set the second moments of full covariances to zero.
+  static void ZeroSecondMoments(const size_t dimensionality,
+                                const size_t components,
+                                arma::cube& secondMoments);
+  //! Set the second moments of diagonal covariances to zero.
+  static void ZeroSecondMoments(const size_t dimensionality,
+                                const size_t components,
+                                arma::mat& secondMoments);
+
+  //! Add the weighted outer products of the given differences to the second
+  //! moments of the given component.
+  static void AddSecondMoments(const arma::mat& diffs,
+                               const arma::rowvec& prob,
+                               const size_t component,
+                               arma::cube& secondMoments);
+  //! Add the weighted squares of the given differences to the second moments
+  //! of the given component.
+  static void AddSecondMoments(const arma::mat& diffs,
+                               const arma::rowvec& prob,
+                               const size_t component,
+                               arma::mat& secondMoments);
+
+  //! Get the covariance of the given component from its second moments around
+  //! the old mean and the shift of its mean.
+  static arma::mat ComponentCovariance(const arma::cube& secondMoments,
+                                       const size_t component,
+                                       const double probSum,
+                                       const arma::vec& shift);
+  //! Get the variances of the given component from its second moments around
+  //! the old mean and the shift of its mean.
+  static arma::vec ComponentCovariance(const arma::mat& secondMoments,
+                                       const size_t component,
+                                       const double probSum,
+                                       const arma::vec& shift);
+
+  //! Add the outer product of the given vector to a full covariance.
+  static void AddOuterProduct(const arma::vec& x, arma::mat& covariance);
+  //! Add the squares of the given vector to a diagonal covariance.
+  static void AddOuterProduct(const arma::vec& x, arma::vec& covariance);
+
+  //! Number of observations in each block processed by EStep() and MStep().
+  static const size_t blockSize = 1024;
 
   //! Maximum iterations of EM algorithm.
   size_t maxIterations;
@@ -15,27 +15,33 @@
 
 // In case it hasn't been included yet.
 #include "em_fit.hpp"
+#include "mixture_log_probabilities.hpp"
 
 namespace mlpack {
 namespace gmm {
 
 //! Constructor.
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-EMFit<InitialClusteringType, CovarianceConstraintPolicy>::EMFit(
-    const size_t maxIterations,
-    const double tolerance,
-    InitialClusteringType clusterer,
-    CovarianceConstraintPolicy constraint) :
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+EMFit(const size_t maxIterations,
+      const double tolerance,
+      InitialClusteringType clusterer,
+      CovarianceConstraintPolicy constraint) :
     maxIterations(maxIterations),
     tolerance(tolerance),
     clusterer(clusterer),
     constraint(constraint)
 { /* Nothing to do. */ }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Estimate(
     const arma::mat& observations,
-    std::vector<distribution::GaussianDistribution>& dists,
+    std::vector<Distribution>& dists,
     arma::vec& weights,
     const bool useInitialModel)
 {
@@ -43,174 +49,366 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  // The E step also gives the log-likelihood of the model it was run on.
+  arma::mat condProb;
+  double l = EStep(observations, dists, weights, condProb);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condProb(observations.n_cols, dists.size());
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
   while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
   {
+    TraceSpan span("em_iteration", iteration);
     Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
         << "log-likelihood " << l << "." << std::endl;
 
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
+    // Calculate the new means, covariances and weights using the conditional
+    // probabilities of choosing a particular Gaussian given the observations
+    // and the previous model.
+    MStep(observations, condProb, arma::vec(), dists, weights);
 
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
+    // Calculate the conditional probabilities for the updated model; this also
+    // gives the new log-likelihood.
+    lOld = l;
+    l = EStep(observations, dists, weights, condProb);
 
-    // Store the sum of the probability of each state over all the observations.
-    arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
+    iteration++;
+  }
+}
 
-    // Calculate the new value of the means using the updated conditional
-    // probabilities.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0)
-        dists[i].Mean() = (observations * condProb.col(i)) / probRowSums[i];
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i)));
-
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0.0)
-      {
-        arma::mat covariance = (tmp * trans(tmpB)) / probRowSums[i];
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
-    }
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Estimate(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    std::vector<Distribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel)
+{
+  if (!useInitialModel)
+    InitialClustering(observations, dists, weights);
+
+  // The E step also gives the log-likelihood of the model it was run on.
+  arma::mat condProb;
+  double l = EStep(observations, dists, weights, condProb);
 
-    // Calculate the new values for omega using the updated conditional
-    // probabilities.
-    weights = probRowSums / observations.n_cols;
+  Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
+      << l << std::endl;
+
+  double lOld = -DBL_MAX;
 
-    // Update values of l; calculate new log-likelihood.
+  // Iterate to update the model until no more improvement is found.
+  size_t iteration = 1;
+  while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
+  {
+    TraceSpan span("em_iteration", iteration);
+    // Calculate the new means, covariances and weights, taking into account
+    // the probability of each point being from this mixture.
+    MStep(observations, condProb, probabilities, dists, weights);
+
+    // Calculate the conditional probabilities for the updated model; this also
+    // gives the new log-likelihood.
     lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    l = EStep(observations, dists, weights, condProb);
 
     iteration++;
   }
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
-    const arma::mat& observations,
-    const arma::vec& probabilities,
-    std::vector<distribution::GaussianDistribution>& dists,
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Estimate(
+    const std::vector<arma::mat>& shards,
+    std::vector<Distribution>& dists,
     arma::vec& weights,
     const bool useInitialModel)
 {
+  if (shards.empty())
+    throw std::invalid_argument("EMFit::Estimate(): no shards given");
+
+  size_t numPoints = 0;
+  for (size_t s = 0; s < shards.size(); ++s)
+  {
+    if (shards[s].n_rows != shards[0].n_rows)
+    {
+      std::ostringstream oss;
+      oss << "EMFit::Estimate(): shard " << s << " has dimensionality "
+          << shards[s].n_rows << ", but shard 0 has dimensionality "
+          << shards[0].n_rows;
+      throw std::invalid_argument(oss.str());
+    }
+
+    numPoints += shards[s].n_cols;
+  }
+
   if (!useInitialModel)
-    InitialClustering(observations, dists, weights);
+    InitialClustering(shards[0], dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  // The E step runs on each shard; the log-likelihood of the model is the sum
+  // of the log-likelihoods of the shards.
+  std::vector<arma::mat> condProbs(shards.size());
+  double l = 0.0;
+  for (size_t s = 0; s < shards.size(); ++s)
+    l += EStep(shards[s], dists, weights, condProbs[s]);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condProb(observations.n_cols, dists.size());
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
   while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
   {
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
+    TraceSpan span("em_iteration", iteration);
+    Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
+        << "log-likelihood " << l << "." << std::endl;
+
+    // The sufficient statistics of the shards are summed (in shard order), and
+    // the model is updated once from the sums.
+    const size_t dimensionality = shards[0].n_rows;
+    arma::vec probSums(dists.size(), arma::fill::zeros);
+    arma::mat moments(dimensionality, dists.size(), arma::fill::zeros);
+    SecondMomentsType secondMoments;
+    ZeroSecondMoments(dimensionality, dists.size(), secondMoments);
+    for (size_t s = 0; s < shards.size(); ++s)
     {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
+      AccumulateStatistics(shards[s], condProbs[s], arma::vec(), dists,
+          probSums, moments, secondMoments);
     }
+    UpdateModel(probSums, moments, secondMoments, numPoints, dists, weights);
+
+    lOld = l;
+    l = 0.0;
+    for (size_t s = 0; s < shards.size(); ++s)
+      l += EStep(shards[s], dists, weights, condProbs[s]);
+
+    iteration++;
+  }
+}
 
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+double EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+EStep(
+    const arma::mat& observations,
+    const std::vector<Distribution>& dists,
+    const arma::vec& weights,
+    arma::mat& condProb) const
+{
+  // Store the log probability of each observation being from each Gaussian,
+  // plus the log of its weight.
+  ComponentLogProbabilities(observations, dists, weights, condProb, blockSize);
+
+  // The log-likelihood of each block is summed afterwards in order, so that
+  // the result does not depend on the number of threads.
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+  arma::vec blockLogLikelihoods(numBlocks);
+  size_t outliers = 0;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(static) reduction(+:outliers)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static) reduction(+:outliers)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) observations.n_cols)
+        - 1;
+
+    // Normalize column-wise in log space, and sum the log-likelihood of each
+    // observation.
+    double logLikelihood = 0.0;
+    for (size_t j = begin; j <= end; ++j)
     {
+      arma::vec column(condProb.colptr(j), condProb.n_rows, false, true);
+      const double logProbSum = LogSumExp(column);
+
       // Avoid dividing by zero; if the probability for everything is 0, we
       // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
+      if (std::isfinite(logProbSum))
+        column = arma::exp(column - logProbSum);
+      else
+        column.zeros();
+
+      if (logProbSum == -std::numeric_limits<double>::infinity())
+        ++outliers;
+
+      logLikelihood += logProbSum;
     }
 
-    // This will store the sum of probabilities of each state over all the
-    // observations.
-    arma::vec probRowSums(dists.size());
+    blockLogLikelihoods[b] = logLikelihood;
+  }
 
-    // Calculate the new value of the means using the updated conditional
-    // probabilities.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Calculate the sum of probabilities of points, which is the
-      // conditional probability of each point being from Gaussian i
-      // multiplied by the probability of the point being from this mixture
-      // model.
-      probRowSums[i] = accu(condProb.col(i) % probabilities);
+  if (outliers > 0)
+    Log::Info << "Likelihood of " << outliers << " points is 0!  They are "
+        << "probably outliers." << std::endl;
+
+  return accu(blockLogLikelihoods);
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+MStep(
+    const arma::mat& observations,
+    const arma::mat& condProb,
+    const arma::vec& probabilities,
+    std::vector<Distribution>& dists,
+    arma::vec& weights)
+{
+  arma::vec probSums(dists.size(), arma::fill::zeros);
+  arma::mat moments(observations.n_rows, dists.size(), arma::fill::zeros);
+  SecondMomentsType secondMoments;
+  ZeroSecondMoments(observations.n_rows, dists.size(), secondMoments);
+  AccumulateStatistics(observations, condProb, probabilities, dists, probSums,
+      moments, secondMoments);
+
+  const double totalWeight = (probabilities.n_elem > 0) ?
+      accu(probabilities) : observations.n_cols;
+  UpdateModel(probSums, moments, secondMoments, totalWeight, dists, weights);
+}
 
-      dists[i].Mean() = (observations * (condProb.col(i) % probabilities)) /
-        probRowSums[i];
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+AccumulateStatistics(
+    const arma::mat& observations,
+    const arma::mat& condProb,
+    const arma::vec& probabilities,
+    const std::vector<Distribution>& dists,
+    arma::vec& probSums,
+    arma::mat& moments,
+    SecondMomentsType& secondMoments) const
+{
+  const size_t dimensionality = observations.n_rows;
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+
+  // Each thread sums, for each Gaussian, the probabilities of its points and
+  // the first and second moments of its points around the current mean,
+  // weighted by those probabilities.  These are summed in thread order
+  // afterwards, so the result only depends on the number of threads.
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+  std::vector<arma::vec> threadProbSums(numThreads);
+  std::vector<arma::mat> threadMoments(numThreads);
+  std::vector<SecondMomentsType> threadSecondMoments(numThreads);
 
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i) % probabilities));
+  #pragma omp parallel
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::vec& localProbSums = threadProbSums[thread];
+    arma::mat& localMoments = threadMoments[thread];
+    SecondMomentsType& localSecondMoments = threadSecondMoments[thread];
+    localProbSums.zeros(dists.size());
+    localMoments.zeros(dimensionality, dists.size());
+    ZeroSecondMoments(dimensionality, dists.size(), localSecondMoments);
+
+#ifdef _WIN32
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(begin + blockSize,
+          (size_t) observations.n_cols) - 1;
 
-      arma::mat cov = (tmp * trans(tmpB)) / probRowSums[i];
+      arma::mat blockProb = condProb.cols(begin, end);
+      if (probabilities.n_elem > 0)
+        blockProb.each_row() %= trans(probabilities.subvec(begin, end));
 
-      // Apply covariance constraint.
-      constraint.ApplyConstraint(cov);
+      for (size_t i = 0; i < dists.size(); ++i)
+      {
+        const arma::mat diffs = observations.cols(begin, end).each_col() -
+            dists[i].Mean();
+        const arma::rowvec prob = blockProb.row(i);
 
-      dists[i].Covariance(std::move(cov));
+        localProbSums[i] += accu(prob);
+        localMoments.col(i) += diffs * trans(prob);
+        AddSecondMoments(diffs, prob, i, localSecondMoments);
+      }
     }
+  }
 
-    // Calculate the new values for omega using the updated conditional
-    // probabilities.
-    weights = probRowSums / accu(probabilities);
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    // A thread may not have run, if the runtime gave us fewer threads.
+    if (threadProbSums[t].n_elem == 0)
+      continue;
 
-    // Update values of l; calculate new log-likelihood.
-    lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    probSums += threadProbSums[t];
+    moments += threadMoments[t];
+    secondMoments += threadSecondMoments[t];
+  }
+}
 
-    iteration++;
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+UpdateModel(
+    const arma::vec& probSums,
+    const arma::mat& moments,
+    const SecondMomentsType& secondMoments,
+    const double totalWeight,
+    std::vector<Distribution>& dists,
+    arma::vec& weights)
+{
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    // Don't update if there's no probability of the Gaussian having points.
+    if (probSums[i] == 0.0)
+      continue;
+
+    // The new mean is the current mean plus the mean of the differences, and
+    // the new covariance follows from the moments around the current mean.
+    const arma::vec shift = moments.col(i) / probSums[i];
+    dists[i].Mean() += shift;
+
+    CovarianceType covariance = ComponentCovariance(secondMoments, i,
+        probSums[i], shift);
+
+    // Apply covariance constraint.
+    constraint.ApplyConstraint(covariance);
+    dists[i].Covariance(std::move(covariance));
   }
+
+  // Calculate the new values for omega using the updated conditional
+  // probabilities.
+  weights = probSums / totalWeight;
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
 InitialClustering(const arma::mat& observations,
-                  std::vector<distribution::GaussianDistribution>& dists,
+                  std::vector<Distribution>& dists,
                   arma::vec& weights)
 {
   // Assignments from clustering.
@@ -220,7 +418,7 @@ InitialClustering(const arma::mat& observations,
   clusterer.Cluster(observations, dists.size(), assignments);
 
   std::vector<arma::vec> means(dists.size());
-  std::vector<arma::mat> covs(dists.size());
+  std::vector<CovarianceType> covs(dists.size());
 
   // Now calculate the means, covariances, and weights.
   weights.zeros();
@@ -240,7 +438,7 @@ InitialClustering(const arma::mat& observations,
     means[cluster] += observations.col(i);
 
     // Add this to the relevant covariance.
-    covs[cluster] += observations.col(i) * trans(observations.col(i));
+    AddOuterProduct(observations.col(i), covs[cluster]);
 
     // Now add one to the weights (we will normalize).
     weights[cluster]++;
@@ -256,7 +454,7 @@ InitialClustering(const arma::mat& observations,
   {
     const size_t cluster = assignments[i];
     const arma::vec normObs = observations.col(i) - means[cluster];
-    covs[cluster] += normObs * normObs.t();
+    AddOuterProduct(normObs, covs[cluster]);
   }
 
   for (size_t i = 0; i < dists.size(); ++i)
@@ -274,39 +472,103 @@ InitialClustering(const arma::mat& observations,
   weights /= accu(weights);
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-double EMFit<InitialClusteringType, CovarianceConstraintPolicy>::LogLikelihood(
-    const arma::mat& observations,
-    const std::vector<distribution::GaussianDistribution>& dists,
-    const arma::vec& weights) const
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+ZeroSecondMoments(const size_t dimensionality,
+                  const size_t components,
+                  arma::cube& secondMoments)
 {
-  double logLikelihood = 0;
+  secondMoments.zeros(dimensionality, dimensionality, components);
+}
 
-  arma::vec phis;
-  arma::mat likelihoods(dists.size(), observations.n_cols);
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+ZeroSecondMoments(const size_t dimensionality,
+                  const size_t components,
+                  arma::mat& secondMoments)
+{
+  secondMoments.zeros(dimensionality, components);
+}
 
-  for (size_t i = 0; i < dists.size(); ++i)
-  {
-    dists[i].Probability(observations, phis);
-    likelihoods.row(i) = weights(i) * trans(phis);
-  }
-  // Now sum over every point.
-  for (size_t j = 0; j < observations.n_cols; ++j)
-  {
-    if (accu(likelihoods.col(j)) == 0)
-      Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
-          << "outlier." << std::endl;
-    logLikelihood += log(accu(likelihoods.col(j)));
-  }
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+AddSecondMoments(const arma::mat& diffs,
+                 const arma::rowvec& prob,
+                 const size_t component,
+                 arma::cube& secondMoments)
+{
+  secondMoments.slice(component) += (diffs.each_row() % prob) * trans(diffs);
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+AddSecondMoments(const arma::mat& diffs,
+                 const arma::rowvec& prob,
+                 const size_t component,
+                 arma::mat& secondMoments)
+{
+  // Only the diagonal of the outer products is needed.
+  secondMoments.col(component) += arma::square(diffs) * trans(prob);
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+arma::mat
+EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+ComponentCovariance(const arma::cube& secondMoments,
+                    const size_t component,
+                    const double probSum,
+                    const arma::vec& shift)
+{
+  return secondMoments.slice(component) / probSum - shift * trans(shift);
+}
 
-  return logLikelihood;
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+arma::vec
+EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+ComponentCovariance(const arma::mat& secondMoments,
+                    const size_t component,
+                    const double probSum,
+                    const arma::vec& shift)
+{
+  return secondMoments.col(component) / probSum - arma::square(shift);
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+AddOuterProduct(const arma::vec& x, arma::mat& covariance)
+{
+  covariance += x * trans(x);
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+AddOuterProduct(const arma::vec& x, arma::vec& covariance)
+{
+  covariance += arma::square(x);
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
 template<typename Archive>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Serialize(
-    Archive& ar,
-    const unsigned int /* version */)
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Serialize(Archive& ar, const unsigned int /* version */)
 {
   using data::CreateNVP;
 
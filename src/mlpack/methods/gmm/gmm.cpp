@@ -101,6 +101,33 @@ arma::vec GMM::Random() const
       arma::randn<arma::vec>(dimensionality) + dists[gaussian].Mean();
 }
 
+/**
+ * Return the probability of each of the given observations being from this
+ * GMM.
+ */
+void GMM::Probability(const arma::mat& observations,
+                      arma::vec& probabilities) const
+{
+  LogProbability(observations, probabilities);
+  probabilities = arma::exp(probabilities);
+}
+
+/**
+ * Return the log probability of each of the given observations being from this
+ * GMM.
+ */
+void GMM::LogProbability(const arma::mat& observations,
+                         arma::vec& logProbabilities) const
+{
+  arma::mat componentLogProbabilities;
+  ComponentLogProbabilities(observations, dists, weights,
+      componentLogProbabilities);
+
+  logProbabilities.set_size(observations.n_cols);
+  for (size_t j = 0; j < observations.n_cols; ++j)
+    logProbabilities[j] = LogSumExp(componentLogProbabilities.unsafe_col(j));
+}
+
 /**
  * Classify the given observations as being from an individual component in this
  * GMM.
@@ -108,24 +135,18 @@ arma::vec GMM::Random() const
 void GMM::Classify(const arma::mat& observations,
                    arma::Row<size_t>& labels) const
 {
-  // This is not the best way to do this!
+  // The most probable component of each observation is the one with the
+  // largest (weighted) log probability.
+  arma::mat componentLogProbabilities;
+  ComponentLogProbabilities(observations, dists, weights,
+      componentLogProbabilities);
 
-  // We should not have to fill this with values, because each one should be
-  // overwritten.
   labels.set_size(observations.n_cols);
   for (size_t i = 0; i < observations.n_cols; ++i)
   {
-    // Find maximum probability component.
-    double probability = 0;
-    for (size_t j = 0; j < gaussians; ++j)
-    {
-      double newProb = Probability(observations.unsafe_col(i), j);
-      if (newProb >= probability)
-      {
-        probability = newProb;
-        labels[i] = j;
-      }
-    }
+    arma::uword maxIndex = 0;
+    componentLogProbabilities.unsafe_col(i).max(maxIndex);
+    labels[i] = maxIndex;
   }
 }
 
@@ -137,19 +158,13 @@ double GMM::LogLikelihood(
     const std::vector<distribution::GaussianDistribution>& distsL,
     const arma::vec& weightsL) const
 {
-  double loglikelihood = 0;
-  arma::vec phis;
-  arma::mat likelihoods(gaussians, data.n_cols);
-
-  for (size_t i = 0; i < gaussians; i++)
-  {
-    distsL[i].Probability(data, phis);
-    likelihoods.row(i) = weightsL(i) * trans(phis);
-  }
+  arma::mat componentLogProbabilities;
+  ComponentLogProbabilities(data, distsL, weightsL, componentLogProbabilities);
 
   // Now sum over every point.
+  double loglikelihood = 0;
   for (size_t j = 0; j < data.n_cols; j++)
-    loglikelihood += log(accu(likelihoods.col(j)));
+    loglikelihood += LogSumExp(componentLogProbabilities.unsafe_col(j));
   return loglikelihood;
 }
 
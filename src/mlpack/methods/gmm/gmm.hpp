@@ -18,6 +18,7 @@
 
 // This is the default fitting method class.
 #include "em_fit.hpp"
+#include "mixture_log_probabilities.hpp"
 
 namespace mlpack {
 namespace gmm /** Gaussian Mixture Models. */ {
@@ -52,7 +53,8 @@ namespace gmm /** Gaussian Mixture Models. */ {
  *
  * For a sample implementation, see the EMFit class; this class uses the EM
  * algorithm to train a GMM, and is the default fitting type for the Train()
- * method.
+ * method.  The OnlineEMFit class may be used instead to train from mini-batches
+ * of the observations.
  *
  * The GMM, once trained, can be used to generate random points from the
  * distribution and estimate the probability of points being from the
@@ -175,6 +177,32 @@ class GMM
   double Probability(const arma::vec& observation,
                      const size_t component) const;
 
+  /**
+   * Compute the probability that each of the given observations came from
+   * this distribution.  The observations are processed in blocks, in parallel
+   * if OpenMP is available; see LogProbability().
+   *
+   * @param observations Observations to evaluate the probabilities of.
+   * @param probabilities Vector to store the probability of each observation
+   *     in.
+   */
+  void Probability(const arma::mat& observations,
+                   arma::vec& probabilities) const;
+
+  /**
+   * Compute the log probability that each of the given observations came from
+   * this distribution.  The log probabilities of all the components are
+   * computed for blocks of observations at a time (in parallel if OpenMP is
+   * available), and are summed with the log-sum-exp trick, so observations far
+   * from every component do not underflow to a probability of zero.
+   *
+   * @param observations Observations to evaluate the log probabilities of.
+   * @param logProbabilities Vector to store the log probability of each
+   *     observation in.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.
@@ -281,6 +309,26 @@ class GMM
       const arma::mat& dataPoints,
       const std::vector<distribution::GaussianDistribution>& distsL,
       const arma::vec& weights) const;
+
+  /**
+   * Run the given number of trials of the given estimation, and keep the model
+   * with the greatest log-likelihood.  The trials run in parallel if OpenMP is
+   * available, each on its own copy of the model; trial i seeds the random
+   * number generator of its thread with the i'th of a list of seeds drawn from
+   * mlpack::math::RandGen() beforehand, so the result does not depend on the
+   * number of threads.  This function is used by GMM::Train().
+   *
+   * @param observations Observations of the model.
+   * @param trials Number of trials to perform (at least 2).
+   * @param useExistingModel If true, each trial starts from the current model.
+   * @param estimate Function that fits the given dists and weights.
+   * @return The log-likelihood of the best fit.
+   */
+  template<typename EstimateType>
+  double TrainTrials(const arma::mat& observations,
+                     const size_t trials,
+                     const bool useExistingModel,
+                     const EstimateType& estimate);
 };
 
 } // namespace gmm
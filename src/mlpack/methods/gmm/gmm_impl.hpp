@@ -44,55 +44,15 @@ double GMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location, we must save it.
-    std::vector<distribution::GaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
-    if (useExistingModel)
-    {
-      distsOrig = dists;
-      weightsOrig = weights;
-    }
-
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to copy it.
-    fitter.Estimate(observations, dists, weights, useExistingModel);
-
-    bestLikelihood = LogLikelihood(observations, dists, weights);
-
-    Log::Info << "GMM::Train(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
-
-    // Now the temporary model.
-    std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
-        distribution::GaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
-
-    for (size_t trial = 1; trial < trials; ++trial)
-    {
-      if (useExistingModel)
-      {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
-      }
-
-      fitter.Estimate(observations, distsTrial, weightsTrial, useExistingModel);
-
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
-
-      Log::Info << "GMM::Train(): Log-likelihood of trial " << trial << " is "
-          << newLikelihood << "." << std::endl;
-
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
-
-        dists = distsTrial;
-        weights = weightsTrial;
-      }
-    }
+    // Each trial uses its own copy of the fitter.
+    bestLikelihood = TrainTrials(observations, trials, useExistingModel,
+        [&](std::vector<distribution::GaussianDistribution>& trialDists,
+            arma::vec& trialWeights)
+        {
+          FittingType trialFitter(fitter);
+          trialFitter.Estimate(observations, trialDists, trialWeights,
+              useExistingModel);
+        });
   }
 
   // Report final log-likelihood and return it.
@@ -128,63 +88,93 @@ double GMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location, we must save it.
-    std::vector<distribution::GaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
-    if (useExistingModel)
-    {
-      distsOrig = dists;
-      weightsOrig = weights;
-    }
-
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to copy it.
-    fitter.Estimate(observations, probabilities, dists, weights,
-        useExistingModel);
-
-    bestLikelihood = LogLikelihood(observations, dists, weights);
+    // Each trial uses its own copy of the fitter.
+    bestLikelihood = TrainTrials(observations, trials, useExistingModel,
+        [&](std::vector<distribution::GaussianDistribution>& trialDists,
+            arma::vec& trialWeights)
+        {
+          FittingType trialFitter(fitter);
+          trialFitter.Estimate(observations, probabilities, trialDists,
+              trialWeights, useExistingModel);
+        });
+  }
 
-    Log::Debug << "GMM::Train(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
+  // Report final log-likelihood and return it.
+  Log::Info << "GMM::Train(): log-likelihood of trained GMM is "
+      << bestLikelihood << "." << std::endl;
+  return bestLikelihood;
+}
 
-    // Now the temporary model.
-    std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
-        distribution::GaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
+/**
+ * Run the trials of Train() in parallel and keep the best model.
+ */
+template<typename EstimateType>
+double GMM::TrainTrials(const arma::mat& observations,
+                        const size_t trials,
+                        const bool useExistingModel,
+                        const EstimateType& estimate)
+{
+  // Draw the seeds of the trials first, so that each trial gets the same
+  // random numbers whichever thread runs it.
+  std::vector<uint64_t> seeds(trials);
+  for (size_t t = 0; t < trials; ++t)
+    seeds[t] = math::RandGen()();
+
+  // Every trial starts from the current model if it is used, or from an
+  // unfitted model otherwise; the observations are shared.
+  std::vector<std::vector<distribution::GaussianDistribution>> trialDists(
+      trials, useExistingModel ? dists :
+      std::vector<distribution::GaussianDistribution>(gaussians,
+      distribution::GaussianDistribution(dimensionality)));
+  std::vector<arma::vec> trialWeights(trials, useExistingModel ? weights :
+      arma::vec(gaussians));
+  arma::vec likelihoods(trials);
+  std::exception_ptr error;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t t = 0; t < (intmax_t) trials; ++t)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t t = 0; t < trials; ++t)
+#endif
+  {
+    try
+    {
+      math::RandGen().Seed(seeds[t]);
 
-    for (size_t trial = 1; trial < trials; ++trial)
+      estimate(trialDists[t], trialWeights[t]);
+      likelihoods[t] = LogLikelihood(observations, trialDists[t],
+          trialWeights[t]);
+    }
+    catch (...)
     {
-      if (useExistingModel)
+      #pragma omp critical
       {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
+        if (!error)
+          error = std::current_exception();
       }
+    }
+  }
 
-      fitter.Estimate(observations, probabilities, distsTrial, weightsTrial,
-          useExistingModel);
-
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
-
-      Log::Debug << "GMM::Train(): Log-likelihood of trial " << trial << " is "
-          << newLikelihood << "." << std::endl;
+  if (error)
+    std::rethrow_exception(error);
 
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
+  size_t best = 0;
+  for (size_t t = 0; t < trials; ++t)
+  {
+    Log::Info << "GMM::Train(): Log-likelihood of trial " << t << " is "
+        << likelihoods[t] << "." << std::endl;
 
-        dists = distsTrial;
-        weights = weightsTrial;
-      }
-    }
+    if (likelihoods[t] > likelihoods[best])
+      best = t;
   }
 
-  // Report final log-likelihood and return it.
-  Log::Info << "GMM::Train(): log-likelihood of trained GMM is "
-      << bestLikelihood << "." << std::endl;
-  return bestLikelihood;
+  dists = std::move(trialDists[best]);
+  weights = std::move(trialWeights[best]);
+  return likelihoods[best];
 }
 
 /**
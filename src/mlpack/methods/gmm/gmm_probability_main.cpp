@@ -44,11 +44,10 @@ int main(int argc, char** argv)
   arma::mat dataset = std::move(CLI::GetParam<arma::mat>("input"));
 
   // Now calculate the probabilities.
-  arma::rowvec probabilities(dataset.n_cols);
-  for (size_t i = 0; i < dataset.n_cols; ++i)
-    probabilities[i] = gmm.Probability(dataset.unsafe_col(i));
+  arma::vec probabilities;
+  gmm.Probability(dataset, probabilities);
 
   // And save the result.
   if (CLI::HasParam("output"))
-    CLI::GetParam<arma::mat>("output") = std::move(probabilities);
+    CLI::GetParam<arma::mat>("output") = trans(probabilities);
 }
@@ -0,0 +1,96 @@
+/**
+ * @file mixture_log_probabilities.hpp
+ *
+ * Batched computation of the log probabilities of points under the components
+ * of a mixture of Gaussians, shared by GMM and EMFit.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_MIXTURE_LOG_PROBABILITIES_HPP
+#define MLPACK_METHODS_GMM_MIXTURE_LOG_PROBABILITIES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * Compute, for each component i of a mixture of Gaussians and each observation
+ * j, log(weights[i]) + log(P(observation j | component i)).  The observations
+ * are processed in blocks, in parallel if OpenMP is available; for each block,
+ * the Mahalanobis terms of every component are found with one triangular solve
+ * against the cached Cholesky factor of its covariance (or, for a
+ * DiagonalGaussianDistribution, with one product against its inverse
+ * variances).
+ *
+ * @tparam DistributionType Type of the components, GaussianDistribution or
+ *     DiagonalGaussianDistribution.
+ * @param observations Observations to evaluate, one per column.
+ * @param dists Components of the mixture.
+ * @param weights Weights of the components.
+ * @param logProbabilities Matrix to store the log probabilities in, with one
+ *     row per component and one column per observation.
+ * @param blockSize Number of observations in each block.
+ */
+template<typename DistributionType>
+void ComponentLogProbabilities(
+    const arma::mat& observations,
+    const std::vector<DistributionType>& dists,
+    const arma::vec& weights,
+    arma::mat& logProbabilities,
+    const size_t blockSize = 1024)
+{
+  logProbabilities.set_size(dists.size(), observations.n_cols);
+  const arma::vec logWeights = arma::log(weights);
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * blockSize;
+    const size_t count = std::min(blockSize, observations.n_cols - begin);
+
+    // Alias the block instead of copying it.
+    const arma::mat block(const_cast<double*>(observations.colptr(begin)),
+        observations.n_rows, count, false, true);
+
+    arma::vec logPhis;
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      dists[i].LogProbability(block, logPhis);
+      logProbabilities.submat(i, begin, i, begin + count - 1) = logWeights[i] +
+          trans(logPhis);
+    }
+  }
+}
+
+/**
+ * Compute log(sum(exp(x))) for the given vector without underflow, by
+ * factoring out its largest element.  If every element is -inf, -inf is
+ * returned.
+ */
+inline double LogSumExp(const arma::vec& x)
+{
+  const double maxValue = x.max();
+  if (!std::isfinite(maxValue))
+    return maxValue;
+
+  return maxValue + std::log(arma::accu(arma::exp(x - maxValue)));
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,285 @@
+/**
+ * @file online_em_fit.hpp
+ *
+ * Utility class to fit a GMM with the online (stochastic mini-batch) EM
+ * algorithm.  It may be used by GMM::Train<>() in place of EMFit.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_ONLINE_EM_FIT_HPP
+#define MLPACK_METHODS_GMM_ONLINE_EM_FIT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/gaussian_distribution.hpp>
+
+#include "em_fit.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * This class fits a GMM to observations with the online EM algorithm, which
+ * updates the model from one mini-batch of observations at a time instead of
+ * from the whole dataset.  Running averages of the sufficient statistics (the
+ * responsibilities of each Gaussian, and the first and second moments of the
+ * observations weighted by them) are kept; after the E step on a mini-batch,
+ * the statistics of the mini-batch are blended into the running averages with
+ * the step size
+ *
+ *   rho_t = (t + stepOffset)^(-stepDecay),
+ *
+ * and the weights, means and covariances are recomputed from them (the
+ * covariances go through the CovarianceConstraintPolicy, as with EMFit).  The
+ * step decay should be in (0.5, 1] for the algorithm to converge.  For more
+ * information, see the following paper:
+ *
+ * @code
+ * @article{cappe2009online,
+ *   title={On-line expectation-maximization algorithm for latent data models},
+ *   author={Capp{\'e}, O. and Moulines, E.},
+ *   journal={Journal of the Royal Statistical Society: Series B},
+ *   volume={71},
+ *   number={3},
+ *   pages={593--613},
+ *   year={2009}
+ * }
+ * @endcode
+ *
+ * Estimate() provides the FittingType interface of GMM::Train(): it runs the
+ * initial clustering on the observations, and then takes steps on shuffled
+ * mini-batches for at most maxIterations passes over the data.  To fit data
+ * that does not fit in memory, call Initialize() on a sample of the data, and
+ * then Step() on each mini-batch as it arrives:
+ *
+ * @code
+ * OnlineEMFit<> fitter(1000);
+ * std::vector<GaussianDistribution> dists(gaussians,
+ *     GaussianDistribution(dimensionality));
+ * arma::vec weights(gaussians);
+ * fitter.Initialize(sample, dists, weights);
+ * while (ReadBatch(batch)) // For some data source.
+ *   fitter.Step(batch, dists, weights);
+ * @endcode
+ *
+ * @tparam InitialClusteringType Clustering mechanism used by Initialize(); see
+ *     EMFit.
+ * @tparam CovarianceConstraintPolicy Constraint applied to each covariance.
+ */
+template<typename InitialClusteringType = kmeans::KMeans<>,
+         typename CovarianceConstraintPolicy = PositiveDefiniteConstraint>
+class OnlineEMFit
+{
+ public:
+  /**
+   * Construct the OnlineEMFit object.  Setting the maximum number of
+   * iterations to 0 means that Estimate() will make passes over the data until
+   * the mean log-likelihood of a pass changes by less than the tolerance.
+   *
+   * @param batchSize Number of observations in each mini-batch of Estimate().
+   * @param maxIterations Maximum number of passes over the data of Estimate().
+   * @param tolerance Change of the mean log-likelihood of the observations in
+   *     a pass required for convergence.
+   * @param stepDecay Decay of the step size; this must be in (0.5, 1].
+   * @param stepOffset Offset of the step size; larger values give smaller
+   *     early steps.
+   * @param clusterer Object which will perform the initial clustering.
+   * @param constraint Object which applies constraints to the covariances.
+   */
+  OnlineEMFit(const size_t batchSize = 1000,
+              const size_t maxIterations = 10,
+              const double tolerance = 1e-5,
+              const double stepDecay = 0.6,
+              const double stepOffset = 1.0,
+              InitialClusteringType clusterer = InitialClusteringType(),
+              CovarianceConstraintPolicy constraint =
+                  CovarianceConstraintPolicy());
+
+  /**
+   * Fit the observations to a Gaussian mixture model (GMM) with the online EM
+   * algorithm.  The size of the vectors (indicating the number of components)
+   * must already be set.  Optionally, if useInitialModel is set to true, then
+   * the model given in the dists and weights parameters is used as the
+   * initial model, instead of using the InitialClusteringType::Cluster()
+   * option.
+   *
+   * @param observations List of observations to train on.
+   * @param dists Vector to store the trained Gaussians in.
+   * @param weights Vector to store a priori weights in.
+   * @param useInitialModel If true, the given model is used for the initial
+   *      clustering.
+   */
+  void Estimate(const arma::mat& observations,
+                std::vector<distribution::GaussianDistribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel = false);
+
+  /**
+   * Fit the observations to a Gaussian mixture model (GMM) with the online EM
+   * algorithm, taking into account the probabilities of each point being from
+   * this mixture.  The size of the vectors (indicating the number of
+   * components) must already be set.  Optionally, if useInitialModel is set to
+   * true, then the model given in the dists and weights parameters is used as
+   * the initial model, instead of using the InitialClusteringType::Cluster()
+   * option.
+   *
+   * @param observations List of observations to train on.
+   * @param probabilities Probability of each point being from this model.
+   * @param dists Vector to store the trained Gaussians in.
+   * @param weights Vector to store a priori weights in.
+   * @param useInitialModel If true, the given model is used for the initial
+   *      clustering.
+   */
+  void Estimate(const arma::mat& observations,
+                const arma::vec& probabilities,
+                std::vector<distribution::GaussianDistribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel = false);
+
+  /**
+   * Compute an initial model by clustering the given sample of the data, and
+   * forget the statistics of any previous steps.  The size of the vectors must
+   * already be set.
+   *
+   * @param sample Observations to cluster.
+   * @param dists Vector to store the initial Gaussians in.
+   * @param weights Vector to store the initial a priori weights in.
+   */
+  void Initialize(const arma::mat& sample,
+                  std::vector<distribution::GaussianDistribution>& dists,
+                  arma::vec& weights);
+
+  /**
+   * Take one step of the online EM algorithm on the given mini-batch, and
+   * update the model.  If no step has been taken since the last call to
+   * Initialize() or Reset(), the running statistics are started from the
+   * given model.  The log-likelihood of the mini-batch under the model before
+   * the update is returned.
+   *
+   * @param batch Mini-batch of observations.
+   * @param dists Gaussians of the model to update.
+   * @param weights A priori weights of the model to update.
+   * @return Log-likelihood of the mini-batch.
+   */
+  double Step(const arma::mat& batch,
+              std::vector<distribution::GaussianDistribution>& dists,
+              arma::vec& weights);
+
+  /**
+   * Take one step of the online EM algorithm on the given mini-batch, where
+   * each observation is weighted by its probability of being from this
+   * mixture, and update the model.
+   *
+   * @param batch Mini-batch of observations.
+   * @param probabilities Probability of each point being from this model.
+   * @param dists Gaussians of the model to update.
+   * @param weights A priori weights of the model to update.
+   * @return Log-likelihood of the mini-batch (not weighted).
+   */
+  double Step(const arma::mat& batch,
+              const arma::vec& probabilities,
+              std::vector<distribution::GaussianDistribution>& dists,
+              arma::vec& weights);
+
+  //! Forget the statistics of all previous steps.
+  void Reset() { steps = 0; }
+
+  //! Get the number of steps taken since the statistics were reset.
+  size_t Steps() const { return steps; }
+
+  //! Get the number of observations in each mini-batch of Estimate().
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of observations in each mini-batch of Estimate().
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the maximum number of passes over the data of Estimate().
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of passes over the data of Estimate().
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for the convergence of Estimate().
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for the convergence of Estimate().
+  double& Tolerance() { return tolerance; }
+
+  //! Get the decay of the step size.
+  double StepDecay() const { return stepDecay; }
+  //! Modify the decay of the step size.
+  double& StepDecay() { return stepDecay; }
+
+  //! Get the offset of the step size.
+  double StepOffset() const { return stepOffset; }
+  //! Modify the offset of the step size.
+  double& StepOffset() { return stepOffset; }
+
+  //! Get the clusterer.
+  const InitialClusteringType& Clusterer() const { return clusterer; }
+  //! Modify the clusterer.
+  InitialClusteringType& Clusterer() { return clusterer; }
+
+  //! Get the covariance constraint policy class.
+  const CovarianceConstraintPolicy& Constraint() const { return constraint; }
+  //! Modify the covariance constraint policy class.
+  CovarianceConstraintPolicy& Constraint() { return constraint; }
+
+  //! Serialize the fitter, including the running statistics.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int version);
+
+ private:
+  /**
+   * Take one step of the online EM algorithm on the given mini-batch, where
+   * each observation is weighted by the given probabilities (or by 1, if
+   * probabilities is empty).
+   */
+  double WeightedStep(const arma::mat& batch,
+                      const arma::vec& probabilities,
+                      std::vector<distribution::GaussianDistribution>& dists,
+                      arma::vec& weights);
+
+  /**
+   * Run passes over shuffled mini-batches of the observations, as done by
+   * both overloads of Estimate().
+   */
+  void Passes(const arma::mat& observations,
+              const arma::vec& probabilities,
+              std::vector<distribution::GaussianDistribution>& dists,
+              arma::vec& weights);
+
+  //! Number of observations in each mini-batch of Estimate().
+  size_t batchSize;
+  //! Maximum number of passes over the data of Estimate().
+  size_t maxIterations;
+  //! Tolerance for convergence of Estimate().
+  double tolerance;
+  //! Decay of the step size.
+  double stepDecay;
+  //! Offset of the step size.
+  double stepOffset;
+  //! Object which will perform the clustering.
+  InitialClusteringType clusterer;
+  //! Object which applies constraints to the covariance matrix.
+  CovarianceConstraintPolicy constraint;
+
+  //! Number of steps taken since the statistics were reset.
+  size_t steps;
+  //! The point the moments are taken around, so that they keep their
+  //! precision when the data is far from the origin.
+  arma::vec origin;
+  //! Running average of the responsibility of each Gaussian.
+  arma::vec probSums;
+  //! Running average of the first moments of each Gaussian (one column each).
+  arma::mat moments;
+  //! Running average of the second moments of each Gaussian (one slice each).
+  arma::cube secondMoments;
+};
+
+} // namespace gmm
+} // namespace mlpack
+
+// Include implementation.
+#include "online_em_fit_impl.hpp"
+
+#endif
@@ -0,0 +1,286 @@
+/**
+ * @file online_em_fit_impl.hpp
+ *
+ * Implementation of the online EM algorithm for fitting GMMs.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_ONLINE_EM_FIT_IMPL_HPP
+#define MLPACK_METHODS_GMM_ONLINE_EM_FIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "online_em_fit.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+//! Constructor.
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::OnlineEMFit(
+    const size_t batchSize,
+    const size_t maxIterations,
+    const double tolerance,
+    const double stepDecay,
+    const double stepOffset,
+    InitialClusteringType clusterer,
+    CovarianceConstraintPolicy constraint) :
+    batchSize(batchSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    stepDecay(stepDecay),
+    stepOffset(stepOffset),
+    clusterer(clusterer),
+    constraint(constraint),
+    steps(0)
+{
+  if (batchSize == 0)
+    throw std::invalid_argument("OnlineEMFit::OnlineEMFit(): batchSize must "
+        "be positive");
+  if (stepDecay <= 0.5 || stepDecay > 1.0)
+    throw std::invalid_argument("OnlineEMFit::OnlineEMFit(): stepDecay must "
+        "be in (0.5, 1]");
+  if (stepOffset < 0.0)
+    throw std::invalid_argument("OnlineEMFit::OnlineEMFit(): stepOffset must "
+        "not be negative");
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
+    const arma::mat& observations,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel)
+{
+  if (useInitialModel)
+    Reset();
+  else
+    Initialize(observations, dists, weights);
+
+  Passes(observations, arma::vec(), dists, weights);
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel)
+{
+  if (useInitialModel)
+    Reset();
+  else
+    Initialize(observations, dists, weights);
+
+  Passes(observations, probabilities, dists, weights);
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Initialize(
+    const arma::mat& sample,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  EMFit<InitialClusteringType, CovarianceConstraintPolicy> em(0, 0.0,
+      clusterer, constraint);
+  em.InitialClustering(sample, dists, weights);
+  Reset();
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+double OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Step(
+    const arma::mat& batch,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  return WeightedStep(batch, arma::vec(), dists, weights);
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+double OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Step(
+    const arma::mat& batch,
+    const arma::vec& probabilities,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  if (probabilities.n_elem != batch.n_cols)
+    throw std::invalid_argument("OnlineEMFit::Step(): the number of "
+        "probabilities must be the same as the number of observations");
+
+  return WeightedStep(batch, probabilities, dists, weights);
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+double OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+WeightedStep(const arma::mat& batch,
+             const arma::vec& probabilities,
+             std::vector<distribution::GaussianDistribution>& dists,
+             arma::vec& weights)
+{
+  const size_t dimensionality = batch.n_rows;
+  if (dists.size() == 0 || dimensionality != dists[0].Dimensionality())
+    throw std::invalid_argument("OnlineEMFit::Step(): the dimensionality of "
+        "the observations must be the same as that of the model");
+
+  // The first step starts the running statistics from the given model.
+  if (steps == 0)
+  {
+    origin = dists[0].Mean() * weights[0];
+    for (size_t i = 1; i < dists.size(); ++i)
+      origin += dists[i].Mean() * weights[i];
+
+    probSums = weights;
+    moments.set_size(dimensionality, dists.size());
+    secondMoments.set_size(dimensionality, dimensionality, dists.size());
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      const arma::vec diff = dists[i].Mean() - origin;
+      moments.col(i) = weights[i] * diff;
+      secondMoments.slice(i) = weights[i] * (dists[i].Covariance() +
+          diff * trans(diff));
+    }
+  }
+
+  // E step: calculate the conditional probabilities of choosing each Gaussian
+  // given the observations, normalizing in log space.
+  arma::mat condProb;
+  ComponentLogProbabilities(batch, dists, weights, condProb);
+
+  double logLikelihood = 0.0;
+  for (size_t j = 0; j < batch.n_cols; ++j)
+  {
+    arma::vec column(condProb.colptr(j), condProb.n_rows, false, true);
+    const double logProbSum = LogSumExp(column);
+
+    // Avoid dividing by zero; if the probability for everything is 0, we
+    // don't want to make it NaN.
+    if (std::isfinite(logProbSum))
+      column = arma::exp(column - logProbSum);
+    else
+      column.zeros();
+
+    logLikelihood += logProbSum;
+  }
+
+  if (probabilities.n_elem > 0)
+    condProb.each_row() %= trans(probabilities);
+  const double totalWeight = (probabilities.n_elem > 0) ?
+      accu(probabilities) : (double) batch.n_cols;
+  if (totalWeight == 0.0)
+    return logLikelihood;
+
+  // Blend the statistics of the mini-batch into the running statistics.
+  ++steps;
+  const double rho = std::pow(steps + stepOffset, -stepDecay);
+  const arma::mat diffs = batch.each_col() - origin;
+  #pragma omp parallel for schedule(static)
+  for (int i = 0; i < (int) dists.size(); ++i)
+  {
+    const arma::rowvec prob = condProb.row(i) / totalWeight;
+    probSums[i] = (1 - rho) * probSums[i] + rho * accu(prob);
+    moments.col(i) = (1 - rho) * moments.col(i) + rho * (diffs * trans(prob));
+    secondMoments.slice(i) = (1 - rho) * secondMoments.slice(i) +
+        rho * ((diffs.each_row() % prob) * trans(diffs));
+  }
+
+  // M step: recompute the model from the running statistics.
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    // Don't update if there's no probability of the Gaussian having points.
+    if (probSums[i] == 0.0)
+      continue;
+
+    const arma::vec shift = moments.col(i) / probSums[i];
+    dists[i].Mean() = origin + shift;
+
+    arma::mat covariance = secondMoments.slice(i) / probSums[i] -
+        shift * trans(shift);
+
+    // Apply covariance constraint.
+    constraint.ApplyConstraint(covariance);
+    dists[i].Covariance(std::move(covariance));
+  }
+
+  weights = probSums / accu(probSums);
+
+  return logLikelihood;
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Passes(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  if (probabilities.n_elem > 0 && probabilities.n_elem != observations.n_cols)
+    throw std::invalid_argument("OnlineEMFit::Estimate(): the number of "
+        "probabilities must be the same as the number of observations");
+
+  double l = -DBL_MAX;
+  double lOld;
+  size_t iteration = 0;
+  do
+  {
+    // Visit the observations in a different random order on each pass.
+    const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+        observations.n_cols - 1, observations.n_cols));
+
+    lOld = l;
+    l = 0.0;
+    for (size_t begin = 0; begin < observations.n_cols; begin += batchSize)
+    {
+      const size_t end = std::min(begin + batchSize,
+          (size_t) observations.n_cols) - 1;
+      const arma::uvec indices = order.subvec(begin, end);
+      if (probabilities.n_elem > 0)
+      {
+        l += WeightedStep(observations.cols(indices), probabilities(indices),
+            dists, weights);
+      }
+      else
+      {
+        l += WeightedStep(observations.cols(indices), arma::vec(), dists,
+            weights);
+      }
+    }
+
+    // This is the mean log-likelihood of the observations, with the model
+    // changing during the pass.
+    l /= observations.n_cols;
+    ++iteration;
+
+    Log::Info << "OnlineEMFit::Estimate(): pass " << iteration << ", mean "
+        << "log-likelihood " << l << "." << std::endl;
+  } while (std::abs(l - lOld) > tolerance && iteration != maxIterations);
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+template<typename Archive>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(batchSize, "batchSize");
+  ar & CreateNVP(maxIterations, "maxIterations");
+  ar & CreateNVP(tolerance, "tolerance");
+  ar & CreateNVP(stepDecay, "stepDecay");
+  ar & CreateNVP(stepOffset, "stepOffset");
+  ar & CreateNVP(clusterer, "clusterer");
+  ar & CreateNVP(constraint, "constraint");
+  ar & CreateNVP(steps, "steps");
+  ar & CreateNVP(origin, "origin");
+  ar & CreateNVP(probSums, "probSums");
+  ar & CreateNVP(moments, "moments");
+  ar & CreateNVP(secondMoments, "secondMoments");
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
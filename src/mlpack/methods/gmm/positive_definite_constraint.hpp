@@ -62,6 +62,20 @@ class PositiveDefiniteConstraint
     }
   }
 
+  /**
+   * Apply the same constraint to the diagonal of a diagonal covariance matrix,
+   * whose eigenvalues are its diagonal elements.
+   *
+   * @param diagCovariance Diagonal of the covariance matrix.
+   */
+  static void ApplyConstraint(arma::vec& diagCovariance)
+  {
+    const double maxVariance = diagCovariance.max();
+    const double minVariance = std::max(maxVariance / 1e5, 1e-50);
+    for (size_t i = 0; i < diagCovariance.n_elem; ++i)
+      diagCovariance[i] = std::max(diagCovariance[i], minVariance);
+  }
+
   //! Serialize the constraint (which stores nothing, so, nothing to do).
   template<typename Archive>
   static void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
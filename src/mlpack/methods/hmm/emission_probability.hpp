@@ -0,0 +1,117 @@
+/**
+ * @file emission_probability.hpp
+ *
+ * Compute the probabilities of a sequence of observations under an emission
+ * distribution, with one batch call when the distribution provides it.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HMM_EMISSION_PROBABILITY_HPP
+#define MLPACK_METHODS_HMM_EMISSION_PROBABILITY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace hmm {
+
+HAS_MEM_FUNC(Probability, HasProbabilityCheck);
+HAS_MEM_FUNC(LogProbability, HasLogProbabilityCheck);
+
+/**
+ * Detect whether a distribution has the batch
+ * Probability(const arma::mat&, arma::vec&) const overload.  All of the
+ * distributions in core/dists and GMM have it; a distribution without it is
+ * evaluated one observation at a time.
+ */
+template<typename Distribution>
+struct HasBatchProbability
+{
+  static const bool value = HasProbabilityCheck<Distribution,
+      void(Distribution::*)(const arma::mat&, arma::vec&) const>::value;
+};
+
+/**
+ * Detect whether a distribution has the batch
+ * LogProbability(const arma::mat&, arma::vec&) const overload.
+ */
+template<typename Distribution>
+struct HasBatchLogProbability
+{
+  static const bool value = HasLogProbabilityCheck<Distribution,
+      void(Distribution::*)(const arma::mat&, arma::vec&) const>::value;
+};
+
+/**
+ * Compute the probability of each observation (column) of the given sequence
+ * under the given distribution.  This overload uses the batch Probability()
+ * of the distribution.
+ */
+template<typename Distribution>
+inline void EmissionProbability(
+    const Distribution& distribution,
+    const arma::mat& dataSeq,
+    arma::vec& probabilities,
+    const typename std::enable_if_t<
+        HasBatchProbability<Distribution>::value>* = 0)
+{
+  distribution.Probability(dataSeq, probabilities);
+}
+
+/**
+ * Compute the probability of each observation (column) of the given sequence
+ * under the given distribution, one observation at a time.
+ */
+template<typename Distribution>
+inline void EmissionProbability(
+    const Distribution& distribution,
+    const arma::mat& dataSeq,
+    arma::vec& probabilities,
+    const typename std::enable_if_t<
+        !HasBatchProbability<Distribution>::value>* = 0)
+{
+  probabilities.set_size(dataSeq.n_cols);
+  for (size_t t = 0; t < dataSeq.n_cols; ++t)
+    probabilities[t] = distribution.Probability(dataSeq.unsafe_col(t));
+}
+
+/**
+ * Compute the log probability of each observation (column) of the given
+ * sequence under the given distribution.  This overload uses the batch
+ * LogProbability() of the distribution, so probabilities too small for a
+ * double don't become -inf.
+ */
+template<typename Distribution>
+inline void EmissionLogProbability(
+    const Distribution& distribution,
+    const arma::mat& dataSeq,
+    arma::vec& logProbabilities,
+    const typename std::enable_if_t<
+        HasBatchLogProbability<Distribution>::value>* = 0)
+{
+  distribution.LogProbability(dataSeq, logProbabilities);
+}
+
+/**
+ * Compute the log probability of each observation (column) of the given
+ * sequence under the given distribution, as the log of its probability.
+ */
+template<typename Distribution>
+inline void EmissionLogProbability(
+    const Distribution& distribution,
+    const arma::mat& dataSeq,
+    arma::vec& logProbabilities,
+    const typename std::enable_if_t<
+        !HasBatchLogProbability<Distribution>::value>* = 0)
+{
+  EmissionProbability(distribution, dataSeq, logProbabilities);
+  logProbabilities = arma::log(logProbabilities);
+}
+
+} // namespace hmm
+} // namespace mlpack
+
+#endif
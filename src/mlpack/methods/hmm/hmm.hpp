@@ -17,6 +17,8 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/dists/discrete_distribution.hpp>
 
+#include "emission_probability.hpp"
+
 namespace mlpack {
 namespace hmm /** Hidden Markov Models. */ {
 
@@ -54,7 +56,9 @@ namespace hmm /** Hidden Markov Models. */ {
  * would use the DiscreteDistribution class when the observations are
  * non-negative integers.  Other distributions could be Gaussians, a mixture of
  * Gaussians (GMM), or any other probability distribution implementing the
- * four Distribution functions.
+ * four Distribution functions.  For high-dimensional observations,
+ * DiagonalGaussianDistribution is a Gaussian that only stores the variance of
+ * each dimension, and evaluates and trains in O(d) time per observation.
  *
  * Usage of the HMM class generally involves either training an HMM or loading
  * an already-known HMM and taking probability measurements of sequences.
@@ -79,9 +83,36 @@ namespace hmm /** Hidden Markov Models. */ {
  * (with Predict()), generate a sequence (with Generate()), or estimate the
  * probabilities of each state for a sequence of observations (with Train()).
  *
+ * The transition matrix may be sparse (arma::sp_mat), for HMMs with many states
+ * and a sparse topology (for instance, left-to-right or banded HMMs).  Then
+ * each step of the forward-backward algorithm, the Viterbi algorithm, and
+ * Baum-Welch training takes time linear in the number of nonzero elements of
+ * the transition matrix instead of quadratic in the number of states.  The
+ * zero elements of the transition matrix stay zero during Baum-Welch training,
+ * so the topology must be given with the initial transition matrix.  Filter()
+ * is only available with a dense transition matrix.
+ *
+ * @code
+ * // A left-to-right HMM where each state either stays or moves to the next.
+ * arma::sp_mat transition(states, states);
+ * for (size_t i = 0; i < states; ++i)
+ * {
+ *   transition(i, i) = (i + 1 < states) ? 0.5 : 1.0;
+ *   if (i + 1 < states)
+ *     transition(i + 1, i) = 0.5;
+ * }
+ *
+ * HMM<GaussianDistribution, arma::sp_mat> hmm(initial, transition,
+ *     std::vector<GaussianDistribution>(states, GaussianDistribution(d)));
+ * hmm.Train(observations);
+ * @endcode
+ *
  * @tparam Distribution Type of emission distribution for this HMM.
+ * @tparam TransitionType Type of the transition matrix (arma::mat or
+ *     arma::sp_mat).
  */
-template<typename Distribution = distribution::DiscreteDistribution>
+template<typename Distribution = distribution::DiscreteDistribution,
+         typename TransitionType = arma::mat>
 class HMM
 {
  public:
@@ -134,7 +165,7 @@ class HMM
    *      (Baum-Welch).
    */
   HMM(const arma::vec& initial,
-      const arma::mat& transition,
+      const TransitionType& transition,
       const std::vector<Distribution>& emission,
       const double tolerance = 1e-5);
 
@@ -259,6 +290,21 @@ class HMM
   double Predict(const arma::mat& dataSeq,
                  arma::Row<size_t>& stateSeq) const;
 
+  /**
+   * Compute the most probable hidden state sequence for each of the given data
+   * sequences, using the Viterbi algorithm.  The sequences are decoded in
+   * parallel, if OpenMP is available.
+   *
+   * @param dataSeq Vector of observation sequences.
+   * @param stateSeq Vector in which the most probable state sequence of each
+   *    data sequence will be stored.
+   * @param logLikelihoods Vector in which the log-likelihood of the most
+   *    probable state sequence of each data sequence will be stored.
+   */
+  void Predict(const std::vector<arma::mat>& dataSeq,
+               std::vector<arma::Row<size_t>>& stateSeq,
+               arma::vec& logLikelihoods) const;
+
   /**
    * Compute the log-likelihood of the given data sequence.
    *
@@ -267,6 +313,17 @@ class HMM
    */
   double LogLikelihood(const arma::mat& dataSeq) const;
 
+  /**
+   * Compute the log-likelihood of each of the given data sequences.  The
+   * sequences are scored in parallel, if OpenMP is available.
+   *
+   * @param dataSeq Vector of data sequences to evaluate the likelihood of.
+   * @param logLikelihoods Vector in which the log-likelihood of each sequence
+   *    will be stored.
+   */
+  void LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                     arma::vec& logLikelihoods) const;
+
   /**
    * HMM filtering. Computes the k-step-ahead expected emission at each time
    * conditioned only on prior observations. That is
@@ -303,9 +360,9 @@ class HMM
   arma::vec& Initial() { return initial; }
 
   //! Return the transition matrix.
-  const arma::mat& Transition() const { return transition; }
+  const TransitionType& Transition() const { return transition; }
   //! Return a modifiable transition matrix reference.
-  arma::mat& Transition() { return transition; }
+  TransitionType& Transition() { return transition; }
 
   //! Return the emission distributions.
   const std::vector<Distribution>& Emission() const { return emission; }
@@ -359,13 +416,110 @@ class HMM
                 const arma::vec& scales,
                 arma::mat& backwardProb) const;
 
+  /**
+   * Compute the probability of each observation in the given data sequence
+   * being emitted by each hidden state.  The returned matrix has rows equal to
+   * the number of hidden states and columns equal to the number of
+   * observations.  Each row is computed with one batch call to the emission
+   * distribution of the state, if it has one (see HasBatchProbability).
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param emissionProb Matrix in which emission probabilities will be saved.
+   */
+  void EmissionProbabilities(const arma::mat& dataSeq,
+                             arma::mat& emissionProb) const;
+
+  /**
+   * Compute the log probability of each observation in the given data
+   * sequence being emitted by each hidden state, in the same layout as
+   * EmissionProbabilities().
+   *
+   * @param dataSeq Data sequence to compute log probabilities for.
+   * @param logEmissionProb Matrix in which log emission probabilities will be
+   *     saved.
+   */
+  void LogEmissionProbabilities(const arma::mat& dataSeq,
+                                arma::mat& logEmissionProb) const;
+
+  /**
+   * The Forward algorithm, given the emission probabilities computed by
+   * EmissionProbabilities().
+   *
+   * @param emissionProb Emission probabilities of the data sequence.
+   * @param scales Vector in which scaling factors will be saved.
+   * @param forwardProb Matrix in which forward probabilities will be saved.
+   */
+  void ForwardFromEmission(const arma::mat& emissionProb,
+                           arma::vec& scales,
+                           arma::mat& forwardProb) const;
+
+  /**
+   * The Backward algorithm, given the emission probabilities computed by
+   * EmissionProbabilities() and the scaling factors found by Forward().
+   *
+   * @param emissionProb Emission probabilities of the data sequence.
+   * @param scales Vector of scaling factors.
+   * @param backwardProb Matrix in which backward probabilities will be saved.
+   */
+  void BackwardFromEmission(const arma::mat& emissionProb,
+                            const arma::vec& scales,
+                            arma::mat& backwardProb) const;
+
   //! Set of emission probability distributions; one for each state.
   std::vector<Distribution> emission;
 
   //! Transition probability matrix.
-  arma::mat transition;
+  TransitionType transition;
 
  private:
+  //! Normalize each column of the transition matrix to sum to 1 (columns with
+  //! no probability are left as they are).
+  static void NormalizeTransition(arma::mat& transition);
+  static void NormalizeTransition(arma::sp_mat& transition);
+
+  //! Set the transition matrix to the number of each transition in the given
+  //! state sequences.
+  static void CountTransitions(const std::vector<arma::Row<size_t> >& stateSeq,
+                               arma::mat& transition);
+  static void CountTransitions(const std::vector<arma::Row<size_t> >& stateSeq,
+                               arma::sp_mat& transition);
+
+  //! Set the Baum-Welch statistics of the transition matrix to zero.
+  static void ResetTransitionStatistics(const arma::mat& transition,
+                                        arma::mat& statistics);
+  static void ResetTransitionStatistics(const arma::sp_mat& transition,
+                                        arma::mat& statistics);
+
+  //! Add next * trans(forward) to the Baum-Welch statistics of the transition
+  //! matrix, where next holds the scaled backward probabilities of the
+  //! following time step.
+  static void AddTransitionStatistics(const arma::mat& transition,
+                                      const arma::mat& next,
+                                      const arma::mat& forward,
+                                      arma::mat& statistics);
+  static void AddTransitionStatistics(const arma::sp_mat& transition,
+                                      const arma::mat& next,
+                                      const arma::mat& forward,
+                                      arma::mat& statistics);
+
+  //! Multiply the transition matrix by the Baum-Welch statistics, and
+  //! normalize it.
+  static void UpdateTransition(const arma::mat& statistics,
+                               arma::mat& transition);
+  static void UpdateTransition(const arma::mat& statistics,
+                               arma::sp_mat& transition);
+
+  //! Fill the columns after the first of the Viterbi log-probabilities and the
+  //! back pointers.
+  static void ViterbiRecursion(const arma::mat& transition,
+                               const arma::mat& logEmissionProb,
+                               arma::mat& logStateProb,
+                               arma::mat& stateSeqBack);
+  static void ViterbiRecursion(const arma::sp_mat& transition,
+                               const arma::mat& logEmissionProb,
+                               arma::mat& logStateProb,
+                               arma::mat& stateSeqBack);
+
   //! Initial state probability vector.
   arma::vec initial;
 
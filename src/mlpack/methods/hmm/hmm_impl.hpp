@@ -24,10 +24,10 @@ namespace hmm {
  * Create the Hidden Markov Model with the given number of hidden states and the
  * given number of emission states.
  */
-template<typename Distribution>
-HMM<Distribution>::HMM(const size_t states,
-                       const Distribution emissions,
-                       const double tolerance) :
+template<typename Distribution, typename TransitionType>
+HMM<Distribution, TransitionType>::HMM(const size_t states,
+                                       const Distribution emissions,
+                                       const double tolerance) :
     emission(states, /* default distribution */ emissions),
     transition(arma::randu<arma::mat>(states, states)),
     initial(arma::randu<arma::vec>(states) / (double) states),
@@ -36,19 +36,19 @@ HMM<Distribution>::HMM(const size_t states,
 {
   // Normalize the transition probabilities and initial state probabilities.
   initial /= arma::accu(initial);
-  for (size_t i = 0; i < transition.n_cols; ++i)
-    transition.col(i) /= arma::accu(transition.col(i));
+  NormalizeTransition(transition);
 }
 
 /**
  * Create the Hidden Markov Model with the given transition matrix and the given
  * emission probability matrix.
  */
-template<typename Distribution>
-HMM<Distribution>::HMM(const arma::vec& initial,
-                       const arma::mat& transition,
-                       const std::vector<Distribution>& emission,
-                       const double tolerance) :
+template<typename Distribution, typename TransitionType>
+HMM<Distribution, TransitionType>::HMM(
+    const arma::vec& initial,
+    const TransitionType& transition,
+    const std::vector<Distribution>& emission,
+    const double tolerance) :
     emission(emission),
     transition(transition),
     initial(initial),
@@ -81,8 +81,9 @@ HMM<Distribution>::HMM(const arma::vec& initial,
  *
  * @param dataSeq Set of data sequences to train on.
  */
-template<typename Distribution>
-void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Train(
+    const std::vector<arma::mat>& dataSeq)
 {
   // We should allow a guess at the transition and emission matrices.
   double loglik = 0;
@@ -104,92 +105,139 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   }
 
   // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
+  // all now so we don't have to do any allocation later on.  The observations
+  // of sequence seq start at column offsets[seq] of the emission list.
   std::vector<arma::vec> emissionProb(transition.n_cols,
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
+  std::vector<size_t> offsets(dataSeq.size() + 1, 0);
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+  {
+    offsets[seq + 1] = offsets[seq] + dataSeq[seq].n_cols;
+    if (dataSeq[seq].n_cols > 0)
+      emissionList.cols(offsets[seq], offsets[seq + 1] - 1) = dataSeq[seq];
+  }
+
+  // The sequences are handled in parallel.  Each thread accumulates the new
+  // initial probabilities and transition matrix for its sequences, and these
+  // are summed in thread order afterwards, so the result only depends on the
+  // number of threads.
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+  std::vector<arma::vec> threadInitial(numThreads);
+  std::vector<arma::mat> threadTransition(numThreads);
+  arma::mat newTransition;
+  arma::vec seqLoglik(dataSeq.size());
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
   // Markov Models: Estimation and Control", pp. 36-40.
   for (size_t iter = 0; iter < iterations; iter++)
   {
-    // Clear new transition matrix and emission probabilities.
-    arma::vec newInitial(transition.n_rows);
-    newInitial.zeros();
-    arma::mat newTransition(transition.n_rows, transition.n_cols);
-    newTransition.zeros();
+    TraceSpan span("hmm_iteration", iter);
 
-    // Reset log likelihood.
-    loglik = 0;
-
-    // Sum over time.
-    size_t sumTime = 0;
-
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    #pragma omp parallel
     {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+      arma::vec& newInitial = threadInitial[thread];
+      arma::mat& newTransition = threadTransition[thread];
+      newInitial.zeros(transition.n_rows);
+      ResetTransitionStatistics(transition, newTransition);
+
+      arma::mat seqEmissionProb;
       arma::mat stateProb;
       arma::mat forward;
       arma::mat backward;
       arma::vec scales;
 
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += Estimate(dataSeq[seq], stateProb, forward, backward, scales);
+      // Loop over each sequence.
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables.
+      #pragma omp for schedule(dynamic)
+      for (intmax_t seq = 0; seq < (intmax_t) dataSeq.size(); seq++)
+#else
+      #pragma omp for schedule(dynamic)
+      for (size_t seq = 0; seq < dataSeq.size(); seq++)
+#endif
+      {
+        const size_t length = dataSeq[seq].n_cols;
+        if (length == 0)
+        {
+          seqLoglik[seq] = 0.0;
+          continue;
+        }
 
-      // Add to estimate of initial probability for state j.
-      for (size_t j = 0; j < transition.n_cols; ++j)
-        newInitial[j] += stateProb(j, 0);
+        // Add the log-likelihood of this sequence.  This is the E-step.
+        EmissionProbabilities(dataSeq[seq], seqEmissionProb);
+        ForwardFromEmission(seqEmissionProb, scales, forward);
+        BackwardFromEmission(seqEmissionProb, scales, backward);
+        stateProb = forward % backward;
+        seqLoglik[seq] = accu(log(scales));
+
+        // Add to estimate of initial probability for state j.
+        newInitial += stateProb.col(0);
+
+        // Now re-estimate the parameters.  This is the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+        //           b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+        //           b(i, t)
+        // We store the new estimates in a different matrix.  The estimate of
+        // T_ij (probability of transition from state j to state i) is a sum
+        // over time of the products of the forward probabilities of state j
+        // and the scaled backward probabilities of state i; we postpone
+        // multiplication of the old T_ij until later.
+        if (length > 1)
+        {
+          arma::mat next = backward.cols(1, length - 1) %
+              seqEmissionProb.cols(1, length - 1);
+          next.each_row() /= trans(scales.subvec(1, length - 1));
+          AddTransitionStatistics(transition, next,
+              forward.cols(0, length - 2), newTransition);
+        }
 
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; ++t)
-      {
+        // Store the state probabilities, for Distribution::Train().
         for (size_t j = 0; j < transition.n_cols; ++j)
         {
-          if (t < dataSeq[seq].n_cols - 1)
-          {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < transition.n_rows; i++)
-              newTransition(i, j) += forward(j, t) * backward(i, t + 1) *
-                  emission[i].Probability(dataSeq[seq].unsafe_col(t + 1)) /
-                  scales[t + 1];
-          }
-
-          // Add to list of emission observations, for Distribution::Train().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = stateProb(j, t);
+          emissionProb[j].subvec(offsets[seq], offsets[seq + 1] - 1) =
+              trans(stateProb.row(j));
         }
-        sumTime++;
       }
     }
 
+    arma::vec newInitial(transition.n_rows, arma::fill::zeros);
+    ResetTransitionStatistics(transition, newTransition);
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+      // A thread may not have run, if the runtime gave us fewer threads.
+      if (threadInitial[t].n_elem == 0)
+        continue;
+
+      newInitial += threadInitial[t];
+      newTransition += threadTransition[t];
+    }
+
+    loglik = accu(seqLoglik);
+
     // Normalize the new initial probabilities.
     if (dataSeq.size() > 1)
       initial = newInitial / dataSeq.size();
     else
       initial = newInitial;
 
-    // Assign the new transition matrix.  We use %= (element-wise
-    // multiplication) because every element of the new transition matrix must
-    // still be multiplied by the old elements (this is the multiplication we
-    // earlier postponed).
-    transition %= newTransition;
-
-    // Now we normalize the transition matrix.
-    for (size_t i = 0; i < transition.n_cols; i++)
-    {
-      const double sum = accu(transition.col(i));
-      if (sum > 0.0)
-        transition.col(i) /= sum;
-      else
-        transition.col(i).fill(1.0 / (double) transition.n_rows);
-    }
+    // Assign the new transition matrix.  Every element of the new transition
+    // matrix must still be multiplied by the old elements (this is the
+    // multiplication we earlier postponed), and then it is normalized.
+    UpdateTransition(newTransition, transition);
 
     // Now estimate emission probabilities.
     for (size_t state = 0; state < transition.n_cols; state++)
@@ -212,9 +260,10 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
  * Train the model using the given labeled observations; the transition and
  * emission matrices are directly estimated.
  */
-template<typename Distribution>
-void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
-                              const std::vector<arma::Row<size_t> >& stateSeq)
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Train(
+    const std::vector<arma::mat>& dataSeq,
+    const std::vector<arma::Row<size_t> >& stateSeq)
 {
   // Simple error checking.
   if (dataSeq.size() != stateSeq.size())
@@ -225,7 +274,6 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
   }
 
   initial.zeros();
-  transition.zeros();
 
   // Estimate the transition and emission matrices directly from the
   // observations.  The emission list holds the time indices for observations
@@ -250,33 +298,20 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
           << dimensionality << " dimensions)." << std::endl;
     }
 
-    // Loop over each observation in the sequence.  For estimation of the
-    // transition matrix, we must ignore the last observation.
+    // Loop over each observation in the sequence.
     initial[stateSeq[seq][0]]++;
-    for (size_t t = 0; t < dataSeq[seq].n_cols - 1; t++)
-    {
-      transition(stateSeq[seq][t + 1], stateSeq[seq][t])++;
+    for (size_t t = 0; t < dataSeq[seq].n_cols; t++)
       emissionList[stateSeq[seq][t]].push_back(std::make_pair(seq, t));
-    }
-
-    // Last observation.
-    emissionList[stateSeq[seq][stateSeq[seq].n_elem - 1]].push_back(
-        std::make_pair(seq, stateSeq[seq].n_elem - 1));
   }
 
   // Normalize initial weights.
   initial /= accu(initial);
 
-  // Normalize transition matrix.
-  for (size_t col = 0; col < transition.n_cols; col++)
-  {
-    // If the transition probability sum is greater than 0 in this column, the
-    // emission probability sum will also be greater than 0.  We want to avoid
-    // division by 0.
-    double sum = accu(transition.col(col));
-    if (sum > 0)
-      transition.col(col) /= sum;
-  }
+  // Count the transitions, and normalize the transition matrix.  If the
+  // transition probability sum is greater than 0 in a column, the emission
+  // probability sum will also be greater than 0.
+  CountTransitions(stateSeq, transition);
+  NormalizeTransition(transition);
 
   // Estimate emission matrix.
   for (size_t state = 0; state < transition.n_cols; state++)
@@ -307,16 +342,19 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
  * Estimate the probabilities of each hidden state at each time step for each
  * given data observation.
  */
-template<typename Distribution>
-double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
-                                   arma::mat& stateProb,
-                                   arma::mat& forwardProb,
-                                   arma::mat& backwardProb,
-                                   arma::vec& scales) const
-{
-  // First run the forward-backward algorithm.
-  Forward(dataSeq, scales, forwardProb);
-  Backward(dataSeq, scales, backwardProb);
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::Estimate(const arma::mat& dataSeq,
+                                                   arma::mat& stateProb,
+                                                   arma::mat& forwardProb,
+                                                   arma::mat& backwardProb,
+                                                   arma::vec& scales) const
+{
+  // First run the forward-backward algorithm.  The emission probabilities are
+  // only computed once for both.
+  arma::mat emissionProb;
+  EmissionProbabilities(dataSeq, emissionProb);
+  ForwardFromEmission(emissionProb, scales, forwardProb);
+  BackwardFromEmission(emissionProb, scales, backwardProb);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
@@ -330,9 +368,9 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
  * Estimate the probabilities of each hidden state at each time step for each
  * given data observation.
  */
-template<typename Distribution>
-double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
-                                   arma::mat& stateProb) const
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::Estimate(const arma::mat& dataSeq,
+                                                   arma::mat& stateProb) const
 {
   // We don't need to save these.
   arma::mat forwardProb, backwardProb;
@@ -346,11 +384,12 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
  * stored in the dataSequence parameter, and the state sequence is stored in
  * the stateSequence parameter.
  */
-template<typename Distribution>
-void HMM<Distribution>::Generate(const size_t length,
-                                 arma::mat& dataSequence,
-                                 arma::Row<size_t>& stateSequence,
-                                 const size_t startState) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Generate(
+    const size_t length,
+    arma::mat& dataSequence,
+    arma::Row<size_t>& stateSequence,
+    const size_t startState) const
 {
   // Set vectors to the right size.
   stateSequence.set_size(length);
@@ -395,9 +434,10 @@ void HMM<Distribution>::Generate(const size_t length,
  * using the Viterbi algorithm. Returns the log-likelihood of the most likely
  * sequence.
  */
-template<typename Distribution>
-double HMM<Distribution>::Predict(const arma::mat& dataSeq,
-                                  arma::Row<size_t>& stateSeq) const
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::Predict(
+    const arma::mat& dataSeq,
+    arma::Row<size_t>& stateSeq) const
 {
   // This is an implementation of the Viterbi algorithm for finding the most
   // probable sequence of states to produce the observed data sequence.  We
@@ -407,38 +447,22 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
   arma::mat logStateProb(transition.n_rows, dataSeq.n_cols);
   arma::mat stateSeqBack(transition.n_rows, dataSeq.n_cols);
 
-  // Store the logs of the transposed transition matrix.  This is because we
-  // will be using the rows of the transition matrix.
-  arma::mat logTrans(log(trans(transition)));
+  // The emission probabilities are computed once, in log-space.
+  arma::mat logEmissionProb;
+  LogEmissionProbabilities(dataSeq, logEmissionProb);
 
   // The calculation of the first state is slightly different; the probability
   // of the first state being state j is the maximum probability that the state
   // came to be j from another state.
-  logStateProb.col(0).zeros();
+  logStateProb.col(0) = log(initial) + logEmissionProb.col(0);
   for (size_t state = 0; state < transition.n_rows; state++)
-  {
-    logStateProb(state, 0) = log(initial[state] *
-        emission[state].Probability(dataSeq.unsafe_col(0)));
     stateSeqBack(state, 0) = state;
-  }
 
-  // Store the best first state.
-  arma::uword index;
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
-  {
-    // Assemble the state probability for this element.
-    // Given that we are in state j, we use state with the highest probability
-    // of being the previous state.
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
-      logStateProb(j, t) = prob.max(index) +
-          log(emission[j].Probability(dataSeq.unsafe_col(t)));
-        stateSeqBack(j, t) = index;
-    }
-  }
+  // Now compute the state probabilities for each successive observation.
+  ViterbiRecursion(transition, logEmissionProb, logStateProb, stateSeqBack);
 
   // Backtrack to find the most probable state sequence.
+  arma::uword index;
   logStateProb.unsafe_col(dataSeq.n_cols - 1).max(index);
   stateSeq[dataSeq.n_cols - 1] = index;
   for (size_t t = 2; t <= dataSeq.n_cols; t++)
@@ -448,11 +472,36 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
   return logStateProb(stateSeq(dataSeq.n_cols - 1), dataSeq.n_cols - 1);
 }
 
+/**
+ * Compute the most probable hidden state sequence for each of the given data
+ * sequences using the Viterbi algorithm.
+ */
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Predict(
+    const std::vector<arma::mat>& dataSeq,
+    std::vector<arma::Row<size_t>>& stateSeq,
+    arma::vec& logLikelihoods) const
+{
+  stateSeq.resize(dataSeq.size());
+  logLikelihoods.set_size(dataSeq.size());
+
+  // The sequences are independent, so they are decoded in parallel.
+#ifdef _WIN32
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (intmax_t seq = 0; seq < (intmax_t) dataSeq.size(); seq++)
+#else
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+#endif
+    logLikelihoods[seq] = Predict(dataSeq[seq], stateSeq[seq]);
+}
+
 /**
  * Compute the log-likelihood of the given data sequence.
  */
-template<typename Distribution>
-double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::LogLikelihood(
+    const arma::mat& dataSeq) const
 {
   arma::mat forward;
   arma::vec scales;
@@ -463,13 +512,45 @@ double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
   return accu(log(scales));
 }
 
+/**
+ * Compute the log-likelihood of each of the given data sequences.
+ */
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::LogLikelihood(
+    const std::vector<arma::mat>& dataSeq,
+    arma::vec& logLikelihoods) const
+{
+  logLikelihoods.set_size(dataSeq.size());
+
+  // The sequences are independent, so they are scored in parallel.
+  #pragma omp parallel
+  {
+    arma::mat emissionProb;
+    arma::mat forward;
+    arma::vec scales;
+
+#ifdef _WIN32
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t seq = 0; seq < (intmax_t) dataSeq.size(); seq++)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+#endif
+    {
+      EmissionProbabilities(dataSeq[seq], emissionProb);
+      ForwardFromEmission(emissionProb, scales, forward);
+      logLikelihoods[seq] = accu(log(scales));
+    }
+  }
+}
+
 /**
  * HMM filtering.
  */
-template<typename Distribution>
-void HMM<Distribution>::Filter(const arma::mat& dataSeq,
-                               arma::mat& filterSeq,
-                               size_t ahead) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Filter(const arma::mat& dataSeq,
+                                               arma::mat& filterSeq,
+                                               size_t ahead) const
 {
   // First run the forward algorithm.
   arma::mat forwardProb;
@@ -490,9 +571,9 @@ void HMM<Distribution>::Filter(const arma::mat& dataSeq,
 /**
  * HMM smoothing.
  */
-template<typename Distribution>
-void HMM<Distribution>::Smooth(const arma::mat& dataSeq,
-                               arma::mat& smoothSeq) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Smooth(const arma::mat& dataSeq,
+                                               arma::mat& smoothSeq) const
 {
   // First run the forward algorithm.
   arma::mat stateProb;
@@ -508,24 +589,77 @@ void HMM<Distribution>::Smooth(const arma::mat& dataSeq,
 /**
  * The Forward procedure (part of the Forward-Backward algorithm).
  */
-template<typename Distribution>
-void HMM<Distribution>::Forward(const arma::mat& dataSeq,
-                                arma::vec& scales,
-                                arma::mat& forwardProb) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Forward(const arma::mat& dataSeq,
+                                                arma::vec& scales,
+                                                arma::mat& forwardProb) const
+{
+  arma::mat emissionProb;
+  EmissionProbabilities(dataSeq, emissionProb);
+  ForwardFromEmission(emissionProb, scales, forwardProb);
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Backward(const arma::mat& dataSeq,
+                                                 const arma::vec& scales,
+                                                 arma::mat& backwardProb) const
+{
+  arma::mat emissionProb;
+  EmissionProbabilities(dataSeq, emissionProb);
+  BackwardFromEmission(emissionProb, scales, backwardProb);
+}
+
+/**
+ * Compute the probability of each observation being emitted by each state.
+ */
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::EmissionProbabilities(
+    const arma::mat& dataSeq,
+    arma::mat& emissionProb) const
+{
+  emissionProb.set_size(transition.n_rows, dataSeq.n_cols);
+  arma::vec stateProb;
+  for (size_t state = 0; state < transition.n_rows; state++)
+  {
+    EmissionProbability(emission[state], dataSeq, stateProb);
+    emissionProb.row(state) = trans(stateProb);
+  }
+}
+
+/**
+ * Compute the log probability of each observation being emitted by each state.
+ */
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::LogEmissionProbabilities(
+    const arma::mat& dataSeq,
+    arma::mat& logEmissionProb) const
+{
+  logEmissionProb.set_size(transition.n_rows, dataSeq.n_cols);
+  arma::vec stateLogProb;
+  for (size_t state = 0; state < transition.n_rows; state++)
+  {
+    EmissionLogProbability(emission[state], dataSeq, stateLogProb);
+    logEmissionProb.row(state) = trans(stateLogProb);
+  }
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::ForwardFromEmission(
+    const arma::mat& emissionProb,
+    arma::vec& scales,
+    arma::mat& forwardProb) const
 {
   // Our goal is to calculate the forward probabilities:
   //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardProb.zeros(transition.n_rows, dataSeq.n_cols);
-  scales.zeros(dataSeq.n_cols);
+  forwardProb.set_size(transition.n_rows, emissionProb.n_cols);
+  scales.set_size(emissionProb.n_cols);
 
   // The first entry in the forward algorithm uses the initial state
   // probabilities.  Note that MATLAB assumes that the starting state (at
   // t = -1) is state 0; this is not our assumption here.  To force that
   // behavior, you could append a single starting state to every single data
   // sequence and that should produce results in line with MATLAB.
-  for (size_t state = 0; state < transition.n_rows; state++)
-    forwardProb(state, 0) = initial(state) *
-        emission[state].Probability(dataSeq.unsafe_col(0));
+  forwardProb.col(0) = initial % emissionProb.col(0);
 
   // Then normalize the column.
   scales[0] = accu(forwardProb.col(0));
@@ -533,17 +667,13 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
     forwardProb.col(0) /= scales[0];
 
   // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  for (size_t t = 1; t < emissionProb.n_cols; t++)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      forwardProb(j, t) = accu(forwardProb.col(t - 1) %
-          trans(transition.row(j))) *
-          emission[j].Probability(dataSeq.unsafe_col(t));
-    }
+    // The forward probability of state j at time t is the sum over all states
+    // of the probability of the previous state transitioning to the current
+    // state and emitting the given observation.
+    forwardProb.col(t) = (transition * forwardProb.col(t - 1)) %
+        emissionProb.col(t);
 
     // Normalize probability.
     scales[t] = accu(forwardProb.col(t));
@@ -552,42 +682,286 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
   }
 }
 
-template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& scales,
-                                 arma::mat& backwardProb) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::BackwardFromEmission(
+    const arma::mat& emissionProb,
+    const arma::vec& scales,
+    arma::mat& backwardProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardProb.zeros(transition.n_rows, dataSeq.n_cols);
+  backwardProb.set_size(transition.n_rows, emissionProb.n_cols);
 
   // The last element probability is 1.
-  backwardProb.col(dataSeq.n_cols - 1).fill(1);
+  backwardProb.col(emissionProb.n_cols - 1).fill(1);
 
   // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
+  for (size_t t = emissionProb.n_cols - 2; t + 1 > 0; t--)
+  {
+    // The backward probability of state j at time t is the sum over all state
+    // of the probability of the next state having been a transition from the
+    // current state multiplied by the probability of each of those states
+    // emitting the given observation.
+    backwardProb.col(t) = trans(transition) * (backwardProb.col(t + 1) %
+        emissionProb.col(t + 1));
+
+    // Normalize by the weights from the forward algorithm.
+    if (scales[t + 1] > 0.0)
+      backwardProb.col(t) /= scales[t + 1];
+  }
+}
+
+//! Normalize each column of a dense transition matrix.
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::NormalizeTransition(
+    arma::mat& transition)
+{
+  for (size_t i = 0; i < transition.n_cols; ++i)
+  {
+    // We want to avoid division by 0.
+    const double sum = accu(transition.col(i));
+    if (sum > 0.0)
+      transition.col(i) /= sum;
+  }
+}
+
+//! Normalize each column of a sparse transition matrix.
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::NormalizeTransition(
+    arma::sp_mat& transition)
+{
+  arma::vec sums(transition.n_cols, arma::fill::zeros);
+  for (arma::sp_mat::const_iterator it = transition.begin();
+       it != transition.end(); ++it)
+    sums[it.col()] += (*it);
+
+  arma::umat locations(2, transition.n_nonzero);
+  arma::vec values(transition.n_nonzero);
+  size_t i = 0;
+  for (arma::sp_mat::const_iterator it = transition.begin();
+       it != transition.end(); ++it, ++i)
+  {
+    locations(0, i) = it.row();
+    locations(1, i) = it.col();
+    values[i] = (sums[it.col()] > 0.0) ? (*it) / sums[it.col()] : (*it);
+  }
+
+  transition = arma::sp_mat(locations, values, transition.n_rows,
+      transition.n_cols);
+}
+
+//! Count the transitions of the state sequences into a dense matrix.
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::CountTransitions(
+    const std::vector<arma::Row<size_t> >& stateSeq,
+    arma::mat& transition)
+{
+  transition.zeros();
+  for (size_t seq = 0; seq < stateSeq.size(); ++seq)
+    for (size_t t = 0; t + 1 < stateSeq[seq].n_elem; ++t)
+      transition(stateSeq[seq][t + 1], stateSeq[seq][t])++;
+}
+
+//! Count the transitions of the state sequences into a sparse matrix.
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::CountTransitions(
+    const std::vector<arma::Row<size_t> >& stateSeq,
+    arma::sp_mat& transition)
+{
+  // Inserting the elements one at a time would take quadratic time, so all the
+  // transitions are collected and the matrix is built at once, adding the
+  // values of repeated locations.
+  size_t transitions = 0;
+  for (size_t seq = 0; seq < stateSeq.size(); ++seq)
+    if (stateSeq[seq].n_elem > 1)
+      transitions += stateSeq[seq].n_elem - 1;
+
+  arma::umat locations(2, transitions);
+  size_t i = 0;
+  for (size_t seq = 0; seq < stateSeq.size(); ++seq)
   {
+    for (size_t t = 0; t + 1 < stateSeq[seq].n_elem; ++t, ++i)
+    {
+      locations(0, i) = stateSeq[seq][t + 1];
+      locations(1, i) = stateSeq[seq][t];
+    }
+  }
+
+  transition = arma::sp_mat(true, locations, arma::ones<arma::vec>(transitions),
+      transition.n_rows, transition.n_cols);
+}
+
+//! The statistics of a dense transition matrix are a dense matrix.
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::ResetTransitionStatistics(
+    const arma::mat& transition,
+    arma::mat& statistics)
+{
+  statistics.zeros(transition.n_rows, transition.n_cols);
+}
+
+//! The statistics of a sparse transition matrix are only kept for its nonzero
+//! elements, in column-major order.
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::ResetTransitionStatistics(
+    const arma::sp_mat& transition,
+    arma::mat& statistics)
+{
+  statistics.zeros(transition.n_nonzero, 1);
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::AddTransitionStatistics(
+    const arma::mat& /* transition */,
+    const arma::mat& next,
+    const arma::mat& forward,
+    arma::mat& statistics)
+{
+  statistics += next * trans(forward);
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::AddTransitionStatistics(
+    const arma::sp_mat& transition,
+    const arma::mat& next,
+    const arma::mat& forward,
+    arma::mat& statistics)
+{
+  // Only the nonzero elements are computed, so each time step costs O(nnz).
+  // The time series of each state are made contiguous first.
+  const arma::mat nextT = trans(next);
+  const arma::mat forwardT = trans(forward);
+  size_t i = 0;
+  for (arma::sp_mat::const_iterator it = transition.begin();
+       it != transition.end(); ++it, ++i)
+  {
+    statistics[i] += arma::dot(nextT.unsafe_col(it.row()),
+        forwardT.unsafe_col(it.col()));
+  }
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::UpdateTransition(
+    const arma::mat& statistics,
+    arma::mat& transition)
+{
+  // We use %= (element-wise multiplication) to multiply by the old elements.
+  transition %= statistics;
+
+  // Now we normalize the transition matrix.
+  for (size_t i = 0; i < transition.n_cols; i++)
+  {
+    const double sum = accu(transition.col(i));
+    if (sum > 0.0)
+      transition.col(i) /= sum;
+    else
+      transition.col(i).fill(1.0 / (double) transition.n_rows);
+  }
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::UpdateTransition(
+    const arma::mat& statistics,
+    arma::sp_mat& transition)
+{
+  // Filling a column with no probability uniformly would make the matrix
+  // dense, so such a column keeps its old probabilities instead.
+  arma::vec sums(transition.n_cols, arma::fill::zeros);
+  size_t i = 0;
+  for (arma::sp_mat::const_iterator it = transition.begin();
+       it != transition.end(); ++it, ++i)
+    sums[it.col()] += (*it) * statistics[i];
+
+  arma::umat locations(2, transition.n_nonzero);
+  arma::vec values(transition.n_nonzero);
+  i = 0;
+  for (arma::sp_mat::const_iterator it = transition.begin();
+       it != transition.end(); ++it, ++i)
+  {
+    locations(0, i) = it.row();
+    locations(1, i) = it.col();
+    values[i] = (sums[it.col()] > 0.0) ?
+        (*it) * statistics[i] / sums[it.col()] : (*it);
+  }
+
+  transition = arma::sp_mat(locations, values, transition.n_rows,
+      transition.n_cols);
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::ViterbiRecursion(
+    const arma::mat& transition,
+    const arma::mat& logEmissionProb,
+    arma::mat& logStateProb,
+    arma::mat& stateSeqBack)
+{
+  // Store the logs of the transposed transition matrix.  This is because we
+  // will be using the rows of the transition matrix.
+  arma::mat logTrans(log(trans(transition)));
+
+  arma::uword index;
+  for (size_t t = 1; t < logEmissionProb.n_cols; t++)
+  {
+    // Assemble the state probability for this element.
+    // Given that we are in state j, we use state with the highest probability
+    // of being the previous state.
     for (size_t j = 0; j < transition.n_rows; j++)
     {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < transition.n_rows; state++)
-        backwardProb(j, t) += transition(state, j) * backwardProb(state, t + 1)
-            * emission[state].Probability(dataSeq.unsafe_col(t + 1));
-
-      // Normalize by the weights from the forward algorithm.
-      if (scales[t + 1] > 0.0)
-        backwardProb(j, t) /= scales[t + 1];
+      arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
+      logStateProb(j, t) = prob.max(index) + logEmissionProb(j, t);
+      stateSeqBack(j, t) = index;
+    }
+  }
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::ViterbiRecursion(
+    const arma::sp_mat& transition,
+    const arma::mat& logEmissionProb,
+    arma::mat& logStateProb,
+    arma::mat& stateSeqBack)
+{
+  // Column j of the transposed transition matrix holds the states that may
+  // precede state j, so each time step only visits the nonzero elements.  The
+  // logs of the elements are stored in the order they are visited.
+  const arma::sp_mat transT = trans(transition);
+  arma::vec logTrans(transT.n_nonzero);
+  size_t i = 0;
+  for (arma::sp_mat::const_iterator it = transT.begin(); it != transT.end();
+       ++it, ++i)
+    logTrans[i] = std::log(*it);
+
+  for (size_t t = 1; t < logEmissionProb.n_cols; t++)
+  {
+    i = 0;
+    for (size_t j = 0; j < transT.n_cols; j++)
+    {
+      // A state with no possible predecessor has probability 0.
+      double best = -std::numeric_limits<double>::infinity();
+      size_t index = 0;
+      for (arma::sp_mat::const_iterator it = transT.begin_col(j);
+           it != transT.end_col(j); ++it, ++i)
+      {
+        const double prob = logStateProb(it.row(), t - 1) + logTrans[i];
+        if (prob > best)
+        {
+          best = prob;
+          index = it.row();
+        }
+      }
+
+      logStateProb(j, t) = best + logEmissionProb(j, t);
+      stateSeqBack(j, t) = index;
     }
   }
 }
 
 //! Serialize the HMM.
-template<typename Distribution>
+template<typename Distribution, typename TransitionType>
 template<typename Archive>
-void HMM<Distribution>::Serialize(Archive& ar, const unsigned int /* version */)
+void HMM<Distribution, TransitionType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
 {
   ar & data::CreateNVP(dimensionality, "dimensionality");
   ar & data::CreateNVP(tolerance, "tolerance");
@@ -28,12 +28,24 @@ using namespace std;
 PROGRAM_INFO("Hidden Markov Model (HMM) Sequence Log-Likelihood", "This "
     "utility takes an already-trained HMM (--model_file) and evaluates the "
     "log-likelihood of a given sequence of observations (--input_file).  The "
-    "computed log-likelihood is given directly to stdout.");
+    "computed log-likelihood is given directly to stdout."
+    "\n\n"
+    "Many sequences may be scored at once: if --lengths_file is given, the "
+    "observations in --input_file are taken to be a concatenation of sequences "
+    "with the given lengths, and the log-likelihood of each sequence is saved "
+    "to the file specified by --log_likelihoods_file.  The sequences are "
+    "scored in parallel, if OpenMP is available.");
 
 PARAM_MATRIX_IN_REQ("input", "File containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "File containing HMM.", "m");
+PARAM_UMATRIX_IN("lengths", "File containing the length of each sequence in "
+    "the observations, if they are a concatenation of sequences.", "l");
 
-PARAM_DOUBLE_OUT("log_likelihood", "Log-likelihood of the sequence.");
+PARAM_MATRIX_OUT("log_likelihoods", "File to save the log-likelihood of each "
+    "sequence to, if --lengths_file is given.", "o");
+
+PARAM_DOUBLE_OUT("log_likelihood", "Log-likelihood of the sequence (or sum "
+    "of the log-likelihoods of the sequences, if --lengths_file is given).");
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
@@ -59,6 +71,36 @@ struct Loglik
           << "not equal to the dimensionality of the HMM ("
           << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
+    if (CLI::HasParam("lengths"))
+    {
+      const arma::Mat<size_t> lengths =
+          std::move(CLI::GetParam<arma::Mat<size_t>>("lengths"));
+      if (accu(lengths) != dataSeq.n_cols)
+        Log::Fatal << "Sum of the sequence lengths (" << accu(lengths) << ") "
+            << "is not equal to the number of observations (" << dataSeq.n_cols
+            << ")!" << endl;
+
+      // Split the observations into the sequences.
+      std::vector<mat> sequences(lengths.n_elem);
+      size_t begin = 0;
+      for (size_t i = 0; i < lengths.n_elem; ++i)
+      {
+        if (lengths[i] == 0)
+          Log::Fatal << "Length of sequence " << i << " is 0!" << endl;
+
+        sequences[i] = dataSeq.cols(begin, begin + lengths[i] - 1);
+        begin += lengths[i];
+      }
+
+      vec logliks;
+      hmm.LogLikelihood(sequences, logliks);
+
+      CLI::GetParam<double>("log_likelihood") = accu(logliks);
+      if (CLI::HasParam("log_likelihoods"))
+        CLI::GetParam<mat>("log_likelihoods") = std::move(logliks);
+      return;
+    }
+
     const double loglik = hmm.LogLikelihood(dataSeq);
 
     CLI::GetParam<double>("log_likelihood") = loglik;
@@ -70,6 +112,10 @@ int main(int argc, char** argv)
   // Parse command line options.
   CLI::ParseCommandLine(argc, argv);
 
+  if (CLI::HasParam("log_likelihoods") && !CLI::HasParam("lengths"))
+    Log::Warn << "--log_likelihoods_file ignored because --lengths_file is not "
+        << "specified." << endl;
+
   // Load model, and calculate the log-likelihood of the sequence.
   CLI::GetParam<HMMModel>("input_model").PerformAction<Loglik>((void*) NULL);
 }
@@ -15,6 +15,7 @@
 
 #include "hmm.hpp"
 #include "hmm_model.hpp"
+#include "streaming_viterbi.hpp"
 
 #include <mlpack/methods/gmm/gmm.hpp>
 
@@ -30,11 +31,64 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction", "This "
     "utility takes an already-trained HMM (--model_file) and evaluates the "
     "most probably hidden state sequence of a given sequence of observations "
     "(--input_file), using the Viterbi algorithm.  The computed state sequence "
-    "is saved to the specified output file (--output_file).");
+    "is saved to the specified output file (--output_file)."
+    "\n\n"
+    "Many sequences may be decoded at once: if --lengths_file is given, the "
+    "observations in --input_file are taken to be a concatenation of sequences "
+    "with the given lengths, and the output file holds the concatenation of "
+    "the state sequences.  The sequences are decoded in parallel, if OpenMP is "
+    "available."
+    "\n\n"
+    "If --stream is specified, the observations are read from standard input "
+    "instead, one per line (with the values separated by whitespace or "
+    "commas), and the state of each observation is printed to standard output "
+    "as soon as it is decided: when the most probable paths of all states "
+    "agree on it, or at the latest when --lag more observations have been "
+    "read.  A state printed because of the lag is the most probable one given "
+    "the observations so far, so it may differ from the one --input_file "
+    "would give.  The states of the remaining observations are printed at the "
+    "end of the input.  Only the last --lag observations are held in "
+    "memory.");
 
-PARAM_MATRIX_IN_REQ("input", "Matrix containing observations,", "i");
+PARAM_MATRIX_IN("input", "Matrix containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "Trained HMM to use.", "m");
 PARAM_UMATRIX_OUT("output", "File to save predicted state sequence to.", "o");
+PARAM_UMATRIX_IN("lengths", "File containing the length of each sequence in "
+    "the observations, if they are a concatenation of sequences.", "l");
+PARAM_FLAG("stream", "Read observations from standard input and print the "
+    "decoded states to standard output.", "S");
+PARAM_INT_IN("lag", "Largest number of observations read after an observation "
+    "before its state is printed, with --stream.", "L", 32);
+
+// Parse the values of one observation from the given line, separated by
+// whitespace or commas.
+void ParseObservation(const std::string& line, std::vector<double>& values)
+{
+  values.clear();
+  const char* p = line.c_str();
+  while (true)
+  {
+    // Skip delimiters.
+    while (*p == ',' || std::isspace((unsigned char) *p))
+      ++p;
+    if (*p == '\0')
+      break;
+
+    char* end;
+    values.push_back(std::strtod(p, &end));
+    if (end == p)
+      Log::Fatal << "Cannot parse observation '" << line << "'!" << endl;
+    p = end;
+  }
+}
+
+// Print the given states to standard output, one per line.
+void PrintStates(const arma::Row<size_t>& states)
+{
+  for (size_t i = 0; i < states.n_elem; ++i)
+    cout << states[i] << "\n";
+  cout << flush;
+}
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
@@ -43,6 +97,12 @@ struct Viterbi
   template<typename HMMType>
   static void Apply(HMMType& hmm, void* /* extraInfo */)
   {
+    if (CLI::HasParam("stream"))
+    {
+      Stream(hmm);
+      return;
+    }
+
     // Load observations.
     mat dataSeq = std::move(CLI::GetParam<arma::mat>("input"));
 
@@ -61,12 +121,85 @@ struct Viterbi
           << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
     arma::Row<size_t> sequence;
-    hmm.Predict(dataSeq, sequence);
+    if (CLI::HasParam("lengths"))
+    {
+      const arma::Mat<size_t> lengths =
+          std::move(CLI::GetParam<arma::Mat<size_t>>("lengths"));
+      if (accu(lengths) != dataSeq.n_cols)
+        Log::Fatal << "Sum of the sequence lengths (" << accu(lengths) << ") "
+            << "is not equal to the number of observations (" << dataSeq.n_cols
+            << ")!" << endl;
+
+      // Split the observations into the sequences.
+      std::vector<mat> sequences(lengths.n_elem);
+      size_t begin = 0;
+      for (size_t i = 0; i < lengths.n_elem; ++i)
+      {
+        if (lengths[i] == 0)
+          Log::Fatal << "Length of sequence " << i << " is 0!" << endl;
+
+        sequences[i] = dataSeq.cols(begin, begin + lengths[i] - 1);
+        begin += lengths[i];
+      }
+
+      std::vector<arma::Row<size_t>> stateSeqs;
+      vec logLikelihoods;
+      hmm.Predict(sequences, stateSeqs, logLikelihoods);
+
+      // Concatenate the state sequences, in the order of the observations.
+      sequence.set_size(dataSeq.n_cols);
+      begin = 0;
+      for (size_t i = 0; i < stateSeqs.size(); ++i)
+      {
+        sequence.subvec(begin, begin + lengths[i] - 1) = stateSeqs[i];
+        begin += lengths[i];
+      }
+    }
+    else
+    {
+      hmm.Predict(dataSeq, sequence);
+    }
 
     // Save output.
     if (CLI::HasParam("output"))
       CLI::GetParam<arma::Mat<size_t>>("output") = std::move(sequence);
   }
+
+  // Decode the observations on standard input as they are read.
+  template<typename HMMType>
+  static void Stream(HMMType& hmm)
+  {
+    const size_t dimensionality = hmm.Emission()[0].Dimensionality();
+    StreamingViterbi<HMMType> decoder(hmm, (size_t) CLI::GetParam<int>("lag"));
+
+    std::string line;
+    std::vector<double> values;
+    arma::Row<size_t> states;
+    while (std::getline(cin, line))
+    {
+      ParseObservation(line, values);
+
+      // Skip empty lines.
+      if (values.empty())
+        continue;
+
+      if (values.size() != dimensionality)
+        Log::Fatal << "Observation '" << line << "' has " << values.size()
+            << " dimensions, but the HMM has " << dimensionality << "!"
+            << endl;
+
+      decoder.Push(arma::mat(values.data(), dimensionality, 1));
+      decoder.PopStates(states);
+      PrintStates(states);
+    }
+
+    decoder.Flush();
+    decoder.PopStates(states);
+    PrintStates(states);
+
+    Log::Info << "Log-likelihood of the " << decoder.Observations()
+        << " observations: " << decoder.LogLikelihood() << "." << endl;
+  }
 };
 
 int main(int argc, char** argv)
@@ -74,7 +207,22 @@ int main(int argc, char** argv)
   // Parse command line options.
   CLI::ParseCommandLine(argc, argv);
 
-  if (!CLI::HasParam("output"))
+  if (CLI::HasParam("stream"))
+  {
+    if (CLI::HasParam("input") || CLI::HasParam("lengths") ||
+        CLI::HasParam("output"))
+      Log::Fatal << "--input_file, --lengths_file and --output_file cannot be "
+          << "given with --stream!" << endl;
+    if (CLI::GetParam<int>("lag") <= 0)
+      Log::Fatal << "Invalid value for --lag (" << CLI::GetParam<int>("lag")
+          << "); it must be positive!" << endl;
+  }
+  else if (!CLI::HasParam("input"))
+  {
+    Log::Fatal << "--input_file (-i) must be specified unless --stream is "
+        << "given!" << endl;
+  }
+  else if (!CLI::HasParam("output"))
     Log::Warn << "--output_file (-o) is not specified; no results will be "
         << "saved!" << endl;
 
@@ -0,0 +1,199 @@
+/**
+ * @file streaming_viterbi.hpp
+ *
+ * Definition of the StreamingViterbi class, which decodes the hidden states of
+ * an unbounded stream of observations with an HMM, one or many observations at
+ * a time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HMM_STREAMING_VITERBI_HPP
+#define MLPACK_METHODS_HMM_STREAMING_VITERBI_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "emission_probability.hpp"
+
+#include <deque>
+
+namespace mlpack {
+namespace hmm {
+
+/**
+ * The StreamingViterbi class runs the Viterbi algorithm and the forward
+ * algorithm of an HMM on a stream of observations that is not known in
+ * advance, without holding the whole sequence.  HMM::Predict() and
+ * HMM::Filter() need the complete sequence and a table with a column for every
+ * observation; StreamingViterbi only keeps the back pointers of the
+ * observations whose state is not decided yet, so it holds O(N * lag) values
+ * for N states.
+ *
+ * The state of an observation is finalized when the survivor paths of all the
+ * states meet at it (after that, every later observation gives it the same
+ * state, so it is the state the Viterbi algorithm would give on the whole
+ * sequence), or, at the latest, when 'lag' more observations have been
+ * consumed; then it is the state on the most probable path so far, which
+ * later observations could have changed.  Flush() finalizes the states of all
+ * of the observations consumed so far (as at the end of a stream), so if it
+ * is only called at the end, the states are those of HMM::Predict() when the
+ * lag is never reached.
+ *
+ * The forward algorithm runs along, so that the log-likelihood of the
+ * observations so far and the filtered probabilities of the states of the
+ * last observation are always available.
+ *
+ * @code
+ * HMM<GaussianDistribution> hmm;
+ * StreamingViterbi<HMM<GaussianDistribution>> decoder(hmm, 20);
+ *
+ * arma::Row<size_t> states;
+ * while (ReadObservations(observations))
+ * {
+ *   decoder.Push(observations);
+ *   decoder.PopStates(states); // The newly finalized states.
+ * }
+ * decoder.Flush();
+ * decoder.PopStates(states);
+ * @endcode
+ *
+ * @tparam HMMType Type of the HMM.
+ */
+template<typename HMMType>
+class StreamingViterbi
+{
+ public:
+  /**
+   * Create the decoder for the given HMM, which must not be modified or
+   * destroyed while the decoder is used.
+   *
+   * @param hmm HMM to decode the observations with.
+   * @param lag Largest number of observations consumed after an observation
+   *     before its state is finalized (at least 1).
+   * @param detectConvergence If true, the state of an observation is also
+   *     finalized as soon as the survivor paths meet at it.
+   */
+  StreamingViterbi(const HMMType& hmm,
+                   const size_t lag = 32,
+                   const bool detectConvergence = true);
+
+  /**
+   * Consume the given observations, one per column, which follow the
+   * observations consumed so far.  The states that get finalized are available
+   * from PopStates().
+   *
+   * @param observations Observations to consume.
+   */
+  void Push(const arma::mat& observations);
+
+  /**
+   * Finalize the states of all of the observations consumed so far, with the
+   * most probable path of the observations so far.  Observations may still be
+   * consumed afterwards, as a continuation of the same stream.
+   */
+  void Flush();
+
+  /**
+   * Move the states that were finalized since the last call into the given
+   * row, in the order of the observations.
+   *
+   * @param states Row to store the finalized states in.
+   */
+  void PopStates(arma::Row<size_t>& states);
+
+  //! Start a new stream, forgetting all the observations consumed so far.
+  void Reset();
+
+  //! Get the number of observations consumed so far.
+  size_t Observations() const { return observations; }
+  //! Get the number of observations whose state has been finalized.
+  size_t NumFinalized() const { return observations - window.size(); }
+  //! Get the number of observations whose state is not finalized yet.
+  size_t NumPending() const { return window.size(); }
+
+  //! Get the log-likelihood of the observations consumed so far.
+  double LogLikelihood() const { return logLikelihood; }
+  //! Get the log-likelihood of the most probable state path of the
+  //! observations consumed so far.
+  double ViterbiLogLikelihood() const;
+
+  /**
+   * Get the filtered probabilities of the states of the last observation,
+   * given all the observations consumed so far.
+   */
+  const arma::vec& Filtered() const { return forward; }
+
+  //! Get the lag.
+  size_t Lag() const { return lag; }
+  //! Get whether the convergence of the survivor paths is detected.
+  bool DetectConvergence() const { return detectConvergence; }
+
+ private:
+  //! The HMM.
+  const HMMType& hmm;
+  //! The largest number of pending observations.
+  size_t lag;
+  //! Whether the convergence of the survivor paths is detected.
+  bool detectConvergence;
+
+  //! The logs of the elements of the transposed transition matrix, if it is
+  //! dense.
+  arma::mat logTransT;
+  //! The transposed transition matrix, if it is sparse.
+  arma::sp_mat transT;
+  //! The logs of the nonzero elements of transT, in order.
+  arma::vec logTransValues;
+
+  //! The number of observations consumed.
+  size_t observations;
+  //! The back pointers of each pending observation: element j of a column is
+  //! the state of the previous observation on the survivor path of state j.
+  std::deque<arma::Col<size_t>> window;
+  //! The states finalized since the last call to PopStates().
+  std::vector<size_t> finalized;
+
+  //! The Viterbi log-probabilities of the last observation, less
+  //! viterbiOffset (so that they don't lose precision on long streams).
+  arma::vec logDelta;
+  //! The offset of the Viterbi log-probabilities.
+  double viterbiOffset;
+  //! The filtered state probabilities of the last observation.
+  arma::vec forward;
+  //! The log-likelihood of the observations consumed.
+  double logLikelihood;
+
+  //! Store the transition matrix in the form of the Viterbi steps.
+  void InitializeTransition(const arma::mat& transition);
+  void InitializeTransition(const arma::sp_mat& transition);
+
+  //! Compute the Viterbi log-probabilities and back pointers of the next
+  //! observation from those of the previous one.
+  void ViterbiStep(const arma::mat& transition,
+                   const arma::vec& logEmission,
+                   arma::vec& newLogDelta,
+                   arma::Col<size_t>& backPointers) const;
+  void ViterbiStep(const arma::sp_mat& transition,
+                   const arma::vec& logEmission,
+                   arma::vec& newLogDelta,
+                   arma::Col<size_t>& backPointers) const;
+
+  //! Consume one observation, given its log emission probabilities.
+  void Step(const arma::vec& logEmission);
+
+  //! Finalize the states of the first 'count' pending observations, along the
+  //! survivor path that has the given state at the last of them.
+  void Finalize(const size_t count, size_t state);
+
+  //! Finalize the pending observations at which the survivor paths meet.
+  void FinalizeConverged();
+};
+
+} // namespace hmm
+} // namespace mlpack
+
+// Include implementation.
+#include "streaming_viterbi_impl.hpp"
+
+#endif
@@ -0,0 +1,312 @@
+/**
+ * @file streaming_viterbi_impl.hpp
+ *
+ * Implementation of the StreamingViterbi class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HMM_STREAMING_VITERBI_IMPL_HPP
+#define MLPACK_METHODS_HMM_STREAMING_VITERBI_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "streaming_viterbi.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+template<typename HMMType>
+StreamingViterbi<HMMType>::StreamingViterbi(const HMMType& hmm,
+                                            const size_t lag,
+                                            const bool detectConvergence) :
+    hmm(hmm),
+    lag(lag),
+    detectConvergence(detectConvergence),
+    observations(0),
+    viterbiOffset(0.0),
+    logLikelihood(0.0)
+{
+  if (lag == 0)
+  {
+    throw std::invalid_argument("StreamingViterbi::StreamingViterbi(): the lag "
+        "must be at least 1");
+  }
+
+  InitializeTransition(hmm.Transition());
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::Push(const arma::mat& newObservations)
+{
+  if (newObservations.n_cols == 0)
+    return;
+
+  const size_t states = hmm.Initial().n_elem;
+  if (newObservations.n_rows != hmm.Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "StreamingViterbi::Push(): observations have dimensionality "
+        << newObservations.n_rows << " but the HMM has dimensionality "
+        << hmm.Dimensionality();
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The emission probabilities of all the new observations are computed at
+  // once; column t holds the log emission probabilities of observation t.
+  arma::mat logEmissionProb(states, newObservations.n_cols);
+  arma::vec logProbs;
+  for (size_t i = 0; i < states; i++)
+  {
+    EmissionLogProbability(hmm.Emission()[i], newObservations, logProbs);
+    logEmissionProb.row(i) = trans(logProbs);
+  }
+
+  for (size_t t = 0; t < newObservations.n_cols; t++)
+    Step(logEmissionProb.col(t));
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::Flush()
+{
+  if (window.empty())
+    return;
+
+  arma::uword index;
+  logDelta.max(index);
+  Finalize(window.size(), index);
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::PopStates(arma::Row<size_t>& states)
+{
+  states = arma::conv_to<arma::Row<size_t>>::from(finalized);
+  finalized.clear();
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::Reset()
+{
+  observations = 0;
+  window.clear();
+  finalized.clear();
+  logDelta.reset();
+  viterbiOffset = 0.0;
+  forward.reset();
+  logLikelihood = 0.0;
+}
+
+template<typename HMMType>
+double StreamingViterbi<HMMType>::ViterbiLogLikelihood() const
+{
+  if (observations == 0)
+    return 0.0;
+
+  return logDelta.max() + viterbiOffset;
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::InitializeTransition(
+    const arma::mat& transition)
+{
+  // The Viterbi steps use the rows of the transition matrix.
+  logTransT = log(trans(transition));
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::InitializeTransition(
+    const arma::sp_mat& transition)
+{
+  // Column j of the transposed transition matrix holds the states that may
+  // precede state j; the logs of its elements are stored in the order they
+  // are visited, as in HMM::Predict().
+  transT = trans(transition);
+  logTransValues.set_size(transT.n_nonzero);
+  size_t i = 0;
+  for (arma::sp_mat::const_iterator it = transT.begin(); it != transT.end();
+       ++it, ++i)
+    logTransValues[i] = std::log(*it);
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::ViterbiStep(
+    const arma::mat& /* transition */,
+    const arma::vec& logEmission,
+    arma::vec& newLogDelta,
+    arma::Col<size_t>& backPointers) const
+{
+  arma::uword index;
+  for (size_t j = 0; j < logTransT.n_cols; j++)
+  {
+    const arma::vec prob = logDelta + logTransT.col(j);
+    newLogDelta[j] = prob.max(index) + logEmission[j];
+    backPointers[j] = index;
+  }
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::ViterbiStep(
+    const arma::sp_mat& /* transition */,
+    const arma::vec& logEmission,
+    arma::vec& newLogDelta,
+    arma::Col<size_t>& backPointers) const
+{
+  size_t i = 0;
+  for (size_t j = 0; j < transT.n_cols; j++)
+  {
+    // A state with no possible predecessor has probability 0.
+    double best = -std::numeric_limits<double>::infinity();
+    size_t index = 0;
+    for (arma::sp_mat::const_iterator it = transT.begin_col(j);
+         it != transT.end_col(j); ++it, ++i)
+    {
+      const double prob = logDelta[it.row()] + logTransValues[i];
+      if (prob > best)
+      {
+        best = prob;
+        index = it.row();
+      }
+    }
+
+    newLogDelta[j] = best + logEmission[j];
+    backPointers[j] = index;
+  }
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::Step(const arma::vec& logEmission)
+{
+  const size_t states = logEmission.n_elem;
+
+  // Forward algorithm: the emission probabilities are scaled by the largest of
+  // them, so that they don't underflow, and the filtered probabilities are
+  // normalized after each observation; the log-likelihood accumulates the
+  // logs of the scales.
+  const double maxLogEmission = logEmission.max();
+  if (observations == 0)
+    forward = hmm.Initial();
+  else
+    forward = hmm.Transition() * forward;
+  if (std::isfinite(maxLogEmission))
+    forward %= arma::exp(logEmission - maxLogEmission);
+  else
+    forward.zeros(); // The observation is impossible.
+  const double scale = arma::accu(forward);
+  if (scale > 0.0)
+    forward /= scale;
+  logLikelihood += std::log(scale) + maxLogEmission;
+
+  // Viterbi algorithm.  The first observation has no predecessor, so it points
+  // to itself.
+  arma::Col<size_t> backPointers(states);
+  if (observations == 0)
+  {
+    logDelta = log(hmm.Initial()) + logEmission;
+    for (size_t j = 0; j < states; j++)
+      backPointers[j] = j;
+  }
+  else
+  {
+    arma::vec newLogDelta(states);
+    ViterbiStep(hmm.Transition(), logEmission, newLogDelta, backPointers);
+    logDelta = std::move(newLogDelta);
+  }
+
+  // The log-probabilities only matter relative to each other, so the largest
+  // one is moved into the offset; otherwise they would grow without bound on
+  // a long stream and lose precision.
+  const double maxLogDelta = logDelta.max();
+  if (std::isfinite(maxLogDelta))
+  {
+    logDelta -= maxLogDelta;
+    viterbiOffset += maxLogDelta;
+  }
+
+  window.push_back(std::move(backPointers));
+  ++observations;
+
+  if (detectConvergence)
+    FinalizeConverged();
+
+  // The oldest pending observation gets the state on the current most
+  // probable path when the window is full.
+  if (window.size() > lag)
+  {
+    arma::uword index;
+    logDelta.max(index);
+    size_t state = index;
+    for (size_t p = window.size() - 1; p > 0; --p)
+      state = window[p][state];
+
+    Finalize(1, state);
+  }
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::Finalize(const size_t count, size_t state)
+{
+  const size_t start = finalized.size();
+  finalized.resize(start + count);
+  finalized[start + count - 1] = state;
+  for (size_t p = count - 1; p > 0; --p)
+  {
+    state = window[p][state];
+    finalized[start + p - 1] = state;
+  }
+
+  window.erase(window.begin(), window.begin() + count);
+}
+
+template<typename HMMType>
+void StreamingViterbi<HMMType>::FinalizeConverged()
+{
+  // Only the states that are possible at the last observation have survivor
+  // paths.
+  std::vector<size_t> survivors;
+  for (size_t j = 0; j < logDelta.n_elem; j++)
+    if (logDelta[j] > -std::numeric_limits<double>::infinity())
+      survivors.push_back(j);
+
+  if (survivors.empty())
+    return;
+
+  // Follow the survivor paths back until they meet; every later observation
+  // extends one of them, so the states up to that observation are decided.
+  std::vector<char> seen(logDelta.n_elem);
+  std::vector<size_t> previous;
+  for (size_t p = window.size() - 1; survivors.size() > 1; --p)
+  {
+    // The paths don't meet within the window.
+    if (p == 0)
+      return;
+
+    previous.clear();
+    for (size_t s : survivors)
+    {
+      const size_t state = window[p][s];
+      if (!seen[state])
+      {
+        seen[state] = 1;
+        previous.push_back(state);
+      }
+    }
+    for (size_t s : previous)
+      seen[s] = 0;
+
+    survivors.swap(previous);
+    if (survivors.size() == 1)
+    {
+      Finalize(p, survivors[0]);
+      return;
+    }
+  }
+
+  // Only one state is possible at the last observation.
+  Finalize(window.size(), survivors[0]);
+}
+
+} // namespace hmm
+} // namespace mlpack
+
+#endif
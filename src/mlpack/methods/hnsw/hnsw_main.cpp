@@ -0,0 +1,227 @@
+/**
+ * @file hnsw_main.cpp
+ *
+ * This file computes approximate nearest neighbors with a hierarchical
+ * navigable small world (HNSW) graph.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+#include "hnsw_search.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+// Information about the program itself.
+PROGRAM_INFO("K-Approximate-Nearest-Neighbor Search with HNSW",
+    "This program will calculate the k approximate-nearest-neighbors of a set "
+    "of points using a hierarchical navigable small world (HNSW) graph.  Each "
+    "reference point is linked to at most --max_neighbors points near it on "
+    "each layer of the graph, and the graph is searched greedily.  The "
+    "number of candidates kept while searching (specified with --ef) trades "
+    "speed for recall, and may be changed when a model is loaded; the number "
+    "of candidates kept while building the graph is specified with "
+    "--ef_construction.  Distances output are exact distances to the "
+    "neighbors found."
+    "\n\n"
+    "You may specify a separate set of reference points and query points, or "
+    "just a reference set which will be used as both the reference and query "
+    "set (in which case a point is not its own neighbor).  For example, the "
+    "following will return 5 neighbors from the data for each point in "
+    "'input.csv' and store the distances in 'distances.csv' and the neighbors "
+    "in the file 'neighbors.csv':"
+    "\n\n"
+    "$ mlpack_hnsw -k 5 -r input.csv -d distances.csv -n neighbors.csv "
+    "\n\n"
+    "The output files are organized such that row i and column j in the "
+    "neighbors output file corresponds to the index of the point in the "
+    "reference set which is the i'th nearest neighbor from the point in the "
+    "query set with index j.  Row i and column j in the distances output file "
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "Because the graph is built randomly, results may be different from run "
+    "to run.  Thus, the --seed option can be specified to set the random "
+    "seed.");
+
+// Define our input parameters that this program will take.
+PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
+PARAM_MATRIX_OUT("distances", "Matrix to output distances into.", "d");
+PARAM_UMATRIX_OUT("neighbors", "Matrix to output neighbors into.", "n");
+PARAM_MATRIX_IN("true_distances", "Matrix of true distances to compute "
+    "the effective error (average relative error) (it is printed when -v is "
+    "specified).", "D");
+PARAM_UMATRIX_IN("true_neighbors", "Matrix of true neighbors to compute the "
+    "recall (it is printed when -v is specified).", "T");
+
+// We can load or save models.
+PARAM_MODEL_IN(HNSWSearch<>, "input_model", "Input HNSW model.", "m");
+PARAM_MODEL_OUT(HNSWSearch<>, "output_model", "Output for trained HNSW model.",
+    "M");
+
+PARAM_MATRIX_IN("query", "Matrix containing query points (optional).", "q");
+PARAM_INT_IN("k", "Number of nearest neighbors to find.", "k", 0);
+
+PARAM_INT_IN("max_neighbors", "Maximum number of links of each point on each "
+    "layer above layer 0 (twice as many are allowed on layer 0).", "N", 16);
+PARAM_INT_IN("ef_construction", "Number of candidates kept while building the "
+    "graph.", "c", 200);
+PARAM_INT_IN("ef", "Number of candidates kept while searching.", "e", 50);
+PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+
+int main(int argc, char *argv[])
+{
+  // Give CLI the command line parameters the user passed in.
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) time(NULL));
+
+  if (CLI::HasParam("input_model") && CLI::HasParam("reference"))
+  {
+    Log::Fatal << "Cannot specify both --reference_file and --input_model_file!"
+        << " Either create a new model with --reference_file or use an existing"
+        << " model with --input_model_file." << endl;
+  }
+
+  if (!CLI::HasParam("input_model") && !CLI::HasParam("reference"))
+  {
+    Log::Fatal << "Must specify either --input_model_file or --reference_file!"
+        << endl;
+  }
+
+  if (!CLI::HasParam("neighbors") && !CLI::HasParam("distances") &&
+      !CLI::HasParam("output_model"))
+  {
+    Log::Warn << "Neither --neighbors_file, --distances_file, nor "
+        << "--output_model_file are specified; no results will be saved."
+        << endl;
+  }
+
+  if (CLI::HasParam("query") && !CLI::HasParam("k"))
+    Log::Fatal << "--k must be specified if search is to be done!" << endl;
+
+  if (!CLI::HasParam("k") && CLI::HasParam("neighbors"))
+    Log::Warn << "--neighbors_file ignored because --k is not specified."
+        << endl;
+
+  if (!CLI::HasParam("k") && CLI::HasParam("distances"))
+    Log::Warn << "--distances_file ignored because --k is not specified."
+        << endl;
+
+  if (CLI::GetParam<int>("k") < 0)
+    Log::Fatal << "Invalid k: " << CLI::GetParam<int>("k") << "; must be "
+        << "greater than 0!" << endl;
+  if (CLI::GetParam<int>("max_neighbors") < 2)
+    Log::Fatal << "--max_neighbors must be at least 2!" << endl;
+  if (CLI::GetParam<int>("ef_construction") <= 0)
+    Log::Fatal << "--ef_construction must be positive!" << endl;
+  if (CLI::GetParam<int>("ef") <= 0)
+    Log::Fatal << "--ef must be positive!" << endl;
+
+  const size_t k = (size_t) CLI::GetParam<int>("k");
+
+  HNSWSearch<> hnsw;
+  if (CLI::HasParam("reference"))
+  {
+    arma::mat referenceData = std::move(CLI::GetParam<arma::mat>("reference"));
+    Log::Info << "Loaded reference data from '"
+        << CLI::GetUnmappedParam<arma::mat>("reference") << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+
+    hnsw.MaxNeighbors() = (size_t) CLI::GetParam<int>("max_neighbors");
+    hnsw.EfConstruction() = (size_t) CLI::GetParam<int>("ef_construction");
+
+    Timer::Start("graph_building");
+    hnsw.Train(std::move(referenceData));
+    Timer::Stop("graph_building");
+  }
+  else
+  {
+    hnsw = std::move(CLI::GetParam<HNSWSearch<>>("input_model"));
+    Log::Info << "Loaded HNSW model from '"
+        << CLI::GetUnmappedParam<HNSWSearch<>>("input_model") << "' (trained "
+        << "on " << hnsw.ReferenceSet().n_rows << "x"
+        << hnsw.ReferenceSet().n_cols << " dataset)." << endl;
+  }
+
+  // The number of candidates kept while searching does not affect the graph,
+  // so it may always be given.
+  hnsw.Ef() = (size_t) CLI::GetParam<int>("ef");
+
+  if (CLI::HasParam("k"))
+  {
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+
+    Log::Info << "Computing " << k << " approximate nearest neighbors with "
+        << "ef = " << hnsw.Ef() << "." << endl;
+
+    Timer::Start("computing_neighbors");
+    if (CLI::HasParam("query"))
+    {
+      const arma::mat queryData = std::move(CLI::GetParam<arma::mat>("query"));
+      Log::Info << "Loaded query data from '"
+          << CLI::GetUnmappedParam<arma::mat>("query") << "' ("
+          << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
+
+      hnsw.Search(queryData, k, neighbors, distances);
+    }
+    else
+    {
+      hnsw.Search(k, neighbors, distances);
+    }
+    Timer::Stop("computing_neighbors");
+
+    Log::Info << "Neighbors computed." << endl;
+
+    // Calculate the effective error, if desired.
+    if (CLI::HasParam("true_distances"))
+    {
+      arma::mat trueDistances =
+          std::move(CLI::GetParam<arma::mat>("true_distances"));
+
+      if (trueDistances.n_rows != distances.n_rows ||
+          trueDistances.n_cols != distances.n_cols)
+        Log::Fatal << "The true distances file must have the same number of "
+            << "values than the set of distances being queried!" << endl;
+
+      Log::Info << "Effective error: " << KNN::EffectiveError(distances,
+          trueDistances) << endl;
+    }
+
+    // Calculate the recall, if desired.
+    if (CLI::HasParam("true_neighbors"))
+    {
+      arma::Mat<size_t> trueNeighbors =
+          std::move(CLI::GetParam<arma::Mat<size_t>>("true_neighbors"));
+
+      if (trueNeighbors.n_rows != neighbors.n_rows ||
+          trueNeighbors.n_cols != neighbors.n_cols)
+        Log::Fatal << "The true neighbors file must have the same number of "
+            << "values than the set of neighbors being queried!" << endl;
+
+      Log::Info << "Recall: " << KNN::Recall(neighbors, trueNeighbors) << endl;
+    }
+
+    // Save output, if desired.
+    if (CLI::HasParam("neighbors"))
+      CLI::GetParam<arma::Mat<size_t>>("neighbors") = std::move(neighbors);
+    if (CLI::HasParam("distances"))
+      CLI::GetParam<arma::mat>("distances") = std::move(distances);
+  }
+
+  if (CLI::HasParam("output_model"))
+    CLI::GetParam<HNSWSearch<>>("output_model") = std::move(hnsw);
+
+  CLI::Destroy();
+}
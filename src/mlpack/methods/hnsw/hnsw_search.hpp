@@ -0,0 +1,297 @@
+/**
+ * @file hnsw_search.hpp
+ *
+ * Defines the HNSWSearch class, which performs approximate nearest neighbor
+ * search with a hierarchical navigable small world graph.
+ *
+ * The method is described in the following paper:
+ *
+ * @article{malkov2016efficient,
+ *   title={Efficient and robust approximate nearest neighbor search using
+ *       Hierarchical Navigable Small World graphs},
+ *   author={Malkov, Y. A. and Yashunin, D. A.},
+ *   journal={arXiv preprint arXiv:1603.09320},
+ *   year={2016}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HNSW_HNSW_SEARCH_HPP
+#define MLPACK_METHODS_HNSW_HNSW_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include <mutex>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The HNSWSearch class builds a hierarchical navigable small world (HNSW)
+ * graph on a reference set, and uses it to find the approximate nearest
+ * neighbors of query points.
+ *
+ * Each reference point is a node of the graph, and is given a random level;
+ * the number of nodes decreases exponentially with the level.  On each layer,
+ * a node is linked to (at most) maxNeighbors nodes of that layer that are near
+ * it (twice as many on layer 0).  To search, the graph is descended greedily
+ * from the top layer to layer 1, and a best-first search that keeps the ef
+ * best nodes found is then run on layer 0.  Larger values of ef give higher
+ * recall and slower searches; ef can be changed at any time, without
+ * rebuilding the graph.
+ *
+ * The graph is built by inserting the points one by one, with
+ * efConstruction in place of ef; with OpenMP, the points are inserted in
+ * parallel.
+ *
+ * The Search() functions have the same signatures as those of NeighborSearch,
+ * so HNSWSearch can be used in place of KNN.  The distances returned are exact
+ * distances; only the neighbors are approximate.
+ *
+ * @code
+ * HNSWSearch<> hnsw(referenceSet);
+ * hnsw.Ef() = 100;
+ * hnsw.Search(querySet, 5, neighbors, distances);
+ * @endcode
+ *
+ * @tparam MetricType The metric to use for computation.
+ * @tparam MatType The type of data matrix.
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename MatType = arma::mat>
+class HNSWSearch
+{
+ public:
+  /**
+   * Create the HNSWSearch object with an empty reference set.  Be sure to
+   * call Train() before calling Search().
+   *
+   * @param maxNeighbors Maximum number of links of each node on the layers
+   *     above layer 0 (twice as many are allowed on layer 0).
+   * @param efConstruction Number of candidates kept while building the graph.
+   * @param ef Number of candidates kept while searching.
+   * @param metric An optional instance of the MetricType class.
+   */
+  HNSWSearch(const size_t maxNeighbors = 16,
+             const size_t efConstruction = 200,
+             const size_t ef = 50,
+             const MetricType metric = MetricType());
+
+  /**
+   * Create the HNSWSearch object and build the graph on the given reference
+   * set.  If copies of the reference set are not wanted, std::move() it in.
+   *
+   * @param referenceSet Set of reference points.
+   * @param maxNeighbors Maximum number of links of each node on the layers
+   *     above layer 0 (twice as many are allowed on layer 0).
+   * @param efConstruction Number of candidates kept while building the graph.
+   * @param ef Number of candidates kept while searching.
+   * @param metric An optional instance of the MetricType class.
+   */
+  HNSWSearch(MatType referenceSet,
+             const size_t maxNeighbors = 16,
+             const size_t efConstruction = 200,
+             const size_t ef = 50,
+             const MetricType metric = MetricType());
+
+  /**
+   * Build the graph on the given reference set, replacing any previous graph.
+   * If copies of the reference set are not wanted, std::move() it in.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(MatType referenceSet);
+
+  /**
+   * For each point in the query set, compute the approximate k nearest
+   * neighbors in the reference set, and store their indices and distances in
+   * the given matrices, which will have k rows and one column for each query
+   * point.  If fewer than k neighbors are found for a query (which may only
+   * happen if the graph is disconnected), the remaining neighbors are set to
+   * the number of reference points and their distances to DBL_MAX.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances) const;
+
+  /**
+   * Compute the approximate k nearest neighbors of each point of the
+   * reference set, excluding the point itself.
+   *
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each point.
+   * @param distances Matrix storing distances of neighbors for each point.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances) const;
+
+  //! Serialize the model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+  //! Get the reference set.
+  const MatType& ReferenceSet() const { return referenceSet; }
+
+  //! Get the maximum number of links of each node above layer 0.
+  size_t MaxNeighbors() const { return maxNeighbors; }
+  //! Modify the maximum number of links of each node (used by Train()).
+  size_t& MaxNeighbors() { return maxNeighbors; }
+
+  //! Get the number of candidates kept while building the graph.
+  size_t EfConstruction() const { return efConstruction; }
+  //! Modify the number of candidates kept while building the graph (used by
+  //! Train()).
+  size_t& EfConstruction() { return efConstruction; }
+
+  //! Get the number of candidates kept while searching.
+  size_t Ef() const { return ef; }
+  //! Modify the number of candidates kept while searching.
+  size_t& Ef() { return ef; }
+
+  //! Get the instantiated metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the instantiated metric.
+  MetricType& Metric() { return metric; }
+
+  //! Get the top layer of the graph.
+  size_t MaxLevel() const { return maxLevel; }
+  //! Get the node the searches start from (a node of the top layer).
+  size_t EntryPoint() const { return entryPoint; }
+  //! Get the level of the given node.
+  size_t Level(const size_t point) const { return links[point].size() - 1; }
+  //! Get the links of the given node on the given layer.
+  const std::vector<size_t>& Links(const size_t point,
+                                   const size_t layer) const
+  {
+    return links[point][layer];
+  }
+
+ private:
+  //! Candidate represents a node of the graph (distance, index).
+  typedef std::pair<double, size_t> Candidate;
+
+  /**
+   * The set of nodes visited by a search.  Clearing it is O(1), so that one
+   * object can be reused for many searches.
+   */
+  class VisitedList
+  {
+   public:
+    //! Create the list for the given number of nodes.
+    VisitedList(const size_t size) : tags(size, 0), tag(1) { }
+
+    //! Forget all visited nodes.
+    void Reset()
+    {
+      if (++tag == 0)
+      {
+        std::fill(tags.begin(), tags.end(), 0);
+        tag = 1;
+      }
+    }
+
+    //! Mark the given node as visited; return false if it already was.
+    bool Visit(const size_t i)
+    {
+      if (tags[i] == tag)
+        return false;
+      tags[i] = tag;
+      return true;
+    }
+
+   private:
+    //! The tag of the last search that visited each node.
+    std::vector<unsigned int> tags;
+    //! The tag of the current search.
+    unsigned int tag;
+  };
+
+  //! Maximum number of links of each node above layer 0.
+  size_t maxNeighbors;
+  //! Number of candidates kept while building the graph.
+  size_t efConstruction;
+  //! Number of candidates kept while searching.
+  size_t ef;
+  //! Instantiated metric.
+  MetricType metric;
+
+  //! The reference set.
+  MatType referenceSet;
+  //! The links of each node on each of its layers.
+  std::vector<std::vector<std::vector<size_t>>> links;
+  //! The node the searches start from.
+  size_t entryPoint;
+  //! The top layer of the graph.
+  size_t maxLevel;
+
+  //! Get the maximum number of links of a node on the given layer.
+  size_t MaxLinks(const size_t layer) const
+  {
+    return (layer == 0) ? 2 * maxNeighbors : maxNeighbors;
+  }
+
+  /**
+   * Search one layer of the graph for the nodes nearest to the given query,
+   * starting from the given node and keeping the ef best nodes found.  The
+   * results are stored in ascending order of distance.  If locks is not NULL,
+   * the links of each node are read under its lock (this is needed while the
+   * graph is built in parallel).
+   */
+  template<typename VecType>
+  void SearchLayer(const VecType& query,
+                   const Candidate& entry,
+                   const size_t ef,
+                   const size_t layer,
+                   VisitedList& visited,
+                   std::vector<Candidate>& results,
+                   std::mutex* locks) const;
+
+  /**
+   * Select at most maxLinks of the given candidates (sorted in ascending
+   * order of distance) to link to, with the heuristic of the paper: a
+   * candidate is skipped if it is closer to an already selected node than to
+   * the node being linked.
+   */
+  void SelectNeighbors(const std::vector<Candidate>& candidates,
+                       const size_t maxLinks,
+                       std::vector<size_t>& selected) const;
+
+  /**
+   * Insert the given point into the graph; its level must have been set
+   * already.
+   */
+  void Insert(const size_t point,
+              std::mutex* locks,
+              std::mutex& entryLock,
+              VisitedList& visited);
+
+  /**
+   * Search the graph for the approximate k nearest neighbors of the given
+   * query, and store them in ascending order of distance.
+   */
+  template<typename VecType>
+  void SearchPoint(const VecType& query,
+                   const size_t k,
+                   VisitedList& visited,
+                   std::vector<Candidate>& results) const;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "hnsw_search_impl.hpp"
+
+#endif
@@ -0,0 +1,438 @@
+/**
+ * @file hnsw_search_impl.hpp
+ *
+ * Implementation of the HNSWSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HNSW_HNSW_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_HNSW_HNSW_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hnsw_search.hpp"
+
+#include <queue>
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+// Construct the object without a reference set.
+template<typename MetricType, typename MatType>
+HNSWSearch<MetricType, MatType>::HNSWSearch(const size_t maxNeighbors,
+                                            const size_t efConstruction,
+                                            const size_t ef,
+                                            const MetricType metric) :
+    maxNeighbors(maxNeighbors),
+    efConstruction(efConstruction),
+    ef(ef),
+    metric(metric),
+    entryPoint(0),
+    maxLevel(0)
+{
+  // Nothing to do.
+}
+
+// Construct the object and build the graph.
+template<typename MetricType, typename MatType>
+HNSWSearch<MetricType, MatType>::HNSWSearch(MatType referenceSet,
+                                            const size_t maxNeighbors,
+                                            const size_t efConstruction,
+                                            const size_t ef,
+                                            const MetricType metric) :
+    maxNeighbors(maxNeighbors),
+    efConstruction(efConstruction),
+    ef(ef),
+    metric(metric),
+    entryPoint(0),
+    maxLevel(0)
+{
+  Train(std::move(referenceSet));
+}
+
+// Build the graph.
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Train(MatType referenceSetIn)
+{
+  if (maxNeighbors < 2)
+    throw std::invalid_argument("HNSWSearch::Train(): the maximum number of "
+        "neighbors must be at least 2!");
+  if (efConstruction == 0)
+    throw std::invalid_argument("HNSWSearch::Train(): efConstruction must be "
+        "positive!");
+
+  referenceSet = std::move(referenceSetIn);
+  links.clear();
+  entryPoint = 0;
+  maxLevel = 0;
+
+  const size_t numPoints = referenceSet.n_cols;
+  if (numPoints == 0)
+    return;
+
+  // Draw the level of each node.  The levels are drawn before the points are
+  // inserted, because the random number generator is not thread-safe.  The
+  // number of nodes of each level decreases by a factor of maxNeighbors.
+  const double levelMultiplier = 1.0 / std::log((double) maxNeighbors);
+  links.resize(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const size_t level = (size_t) std::floor(-std::log(1.0 - math::Random()) *
+        levelMultiplier);
+    links[i].resize(level + 1);
+  }
+
+  // The first point is the entry point of the graph; insert the others.
+  maxLevel = Level(0);
+  std::vector<std::mutex> locks(numPoints);
+  std::mutex entryLock;
+
+  #pragma omp parallel
+  {
+    VisitedList visited(numPoints);
+
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+#ifdef _WIN32
+    #pragma omp for schedule(dynamic)
+    for (intmax_t i = 1; i < (intmax_t) numPoints; ++i)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t i = 1; i < numPoints; ++i)
+#endif
+    {
+      Insert((size_t) i, locks.data(), entryLock, visited);
+    }
+  }
+
+  Log::Info << "Built HNSW graph on " << numPoints << " points with "
+      << maxLevel + 1 << " layers." << std::endl;
+}
+
+// Insert a point into the graph.
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Insert(const size_t point,
+                                             std::mutex* locks,
+                                             std::mutex& entryLock,
+                                             VisitedList& visited)
+{
+  const size_t level = Level(point);
+
+  // If the point becomes the new entry point, the lock is held for the whole
+  // insertion, so that no other insertion starts from it before it is linked.
+  std::unique_lock<std::mutex> entryGuard(entryLock);
+  const size_t currentMaxLevel = maxLevel;
+  const size_t currentEntryPoint = entryPoint;
+  if (level <= currentMaxLevel)
+    entryGuard.unlock();
+
+  const auto query = referenceSet.unsafe_col(point);
+  Candidate current(metric.Evaluate(query,
+      referenceSet.unsafe_col(currentEntryPoint)), currentEntryPoint);
+
+  // Descend greedily through the layers above the level of the point.
+  std::vector<Candidate> results;
+  for (size_t layer = currentMaxLevel; layer > level; --layer)
+  {
+    SearchLayer(query, current, 1, layer, visited, results, locks);
+    current = results[0];
+  }
+
+  // Link the point on each of its layers that are already in the graph.
+  std::vector<size_t> selected;
+  std::vector<Candidate> neighborCandidates;
+  for (size_t layer = std::min(level, currentMaxLevel) + 1; layer-- > 0; )
+  {
+    SearchLayer(query, current, efConstruction, layer, visited, results,
+        locks);
+    SelectNeighbors(results, maxNeighbors, selected);
+    {
+      std::lock_guard<std::mutex> lock(locks[point]);
+      links[point][layer] = selected;
+    }
+
+    // Link the selected nodes back to the point, and prune their links if
+    // they have too many.
+    for (size_t i = 0; i < selected.size(); ++i)
+    {
+      const size_t neighbor = selected[i];
+      std::lock_guard<std::mutex> lock(locks[neighbor]);
+      std::vector<size_t>& neighborLinks = links[neighbor][layer];
+      neighborLinks.push_back(point);
+      if (neighborLinks.size() > MaxLinks(layer))
+      {
+        neighborCandidates.clear();
+        for (size_t j = 0; j < neighborLinks.size(); ++j)
+        {
+          neighborCandidates.push_back(Candidate(metric.Evaluate(
+              referenceSet.unsafe_col(neighbor),
+              referenceSet.unsafe_col(neighborLinks[j])), neighborLinks[j]));
+        }
+        std::sort(neighborCandidates.begin(), neighborCandidates.end());
+        SelectNeighbors(neighborCandidates, MaxLinks(layer), neighborLinks);
+      }
+    }
+
+    current = results[0];
+  }
+
+  // The lock is still held in this case.
+  if (level > currentMaxLevel)
+  {
+    entryPoint = point;
+    maxLevel = level;
+  }
+}
+
+// Search one layer of the graph.
+template<typename MetricType, typename MatType>
+template<typename VecType>
+void HNSWSearch<MetricType, MatType>::SearchLayer(
+    const VecType& query,
+    const Candidate& entry,
+    const size_t ef,
+    const size_t layer,
+    VisitedList& visited,
+    std::vector<Candidate>& results,
+    std::mutex* locks) const
+{
+  visited.Reset();
+  visited.Visit(entry.second);
+
+  // The candidates to expand, the nearest on top, and the best nodes found,
+  // the worst on top.
+  std::priority_queue<Candidate, std::vector<Candidate>,
+      std::greater<Candidate>> candidates;
+  std::priority_queue<Candidate> best;
+  candidates.push(entry);
+  best.push(entry);
+
+  std::vector<size_t> linksCopy;
+  while (!candidates.empty())
+  {
+    const Candidate c = candidates.top();
+    // No remaining candidate can improve the results.
+    if (c.first > best.top().first)
+      break;
+    candidates.pop();
+
+    if (locks)
+    {
+      std::lock_guard<std::mutex> lock(locks[c.second]);
+      linksCopy = links[c.second][layer];
+    }
+    const std::vector<size_t>& nodeLinks = locks ? linksCopy :
+        links[c.second][layer];
+
+    for (size_t i = 0; i < nodeLinks.size(); ++i)
+    {
+      const size_t node = nodeLinks[i];
+      if (!visited.Visit(node))
+        continue;
+
+      const double distance = metric.Evaluate(query,
+          referenceSet.unsafe_col(node));
+      if (best.size() < ef || distance < best.top().first)
+      {
+        candidates.push(Candidate(distance, node));
+        best.push(Candidate(distance, node));
+        if (best.size() > ef)
+          best.pop();
+      }
+    }
+  }
+
+  results.resize(best.size());
+  for (size_t i = best.size(); i > 0; --i)
+  {
+    results[i - 1] = best.top();
+    best.pop();
+  }
+}
+
+// Select the nodes to link to.
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::SelectNeighbors(
+    const std::vector<Candidate>& candidates,
+    const size_t maxLinks,
+    std::vector<size_t>& selected) const
+{
+  selected.clear();
+  for (size_t i = 0; i < candidates.size() && selected.size() < maxLinks; ++i)
+  {
+    bool keep = true;
+    for (size_t j = 0; j < selected.size(); ++j)
+    {
+      if (metric.Evaluate(referenceSet.unsafe_col(candidates[i].second),
+          referenceSet.unsafe_col(selected[j])) < candidates[i].first)
+      {
+        keep = false;
+        break;
+      }
+    }
+
+    if (keep)
+      selected.push_back(candidates[i].second);
+  }
+}
+
+// Search the graph for one query.
+template<typename MetricType, typename MatType>
+template<typename VecType>
+void HNSWSearch<MetricType, MatType>::SearchPoint(
+    const VecType& query,
+    const size_t k,
+    VisitedList& visited,
+    std::vector<Candidate>& results) const
+{
+  Candidate current(metric.Evaluate(query, referenceSet.unsafe_col(entryPoint)),
+      entryPoint);
+  for (size_t layer = maxLevel; layer > 0; --layer)
+  {
+    SearchLayer(query, current, 1, layer, visited, results, NULL);
+    current = results[0];
+  }
+
+  SearchLayer(query, current, std::max(ef, k), 0, visited, results, NULL);
+}
+
+// Search for the neighbors of a query set.
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Search(const MatType& querySet,
+                                             const size_t k,
+                                             arma::Mat<size_t>& neighbors,
+                                             arma::mat& distances) const
+{
+  if (querySet.n_rows != referenceSet.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "HNSWSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality the model "
+        << "was trained on (" << referenceSet.n_rows << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (k > referenceSet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "HNSWSearch::Search(): requested " << k << " approximate nearest "
+        << "neighbors, but reference set has " << referenceSet.n_cols
+        << " points!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+  if (k == 0)
+    return;
+
+  #pragma omp parallel
+  {
+    VisitedList visited(referenceSet.n_cols);
+    std::vector<Candidate> results;
+
+#ifdef _WIN32
+    #pragma omp for schedule(dynamic)
+    for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
+    {
+      SearchPoint(querySet.col(q), k, visited, results);
+
+      for (size_t j = 0; j < k; ++j)
+      {
+        neighbors(j, q) = (j < results.size()) ? results[j].second :
+            referenceSet.n_cols;
+        distances(j, q) = (j < results.size()) ? results[j].first : DBL_MAX;
+      }
+    }
+  }
+}
+
+// Search for the neighbors of the reference set.
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Search(const size_t k,
+                                             arma::Mat<size_t>& neighbors,
+                                             arma::mat& distances) const
+{
+  if (k >= referenceSet.n_cols && k > 0)
+  {
+    std::ostringstream oss;
+    oss << "HNSWSearch::Search(): requested " << k << " approximate nearest "
+        << "neighbors, but reference set has " << referenceSet.n_cols
+        << " points (and each point is not its own neighbor)!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  neighbors.set_size(k, referenceSet.n_cols);
+  distances.set_size(k, referenceSet.n_cols);
+  if (k == 0)
+    return;
+
+  #pragma omp parallel
+  {
+    VisitedList visited(referenceSet.n_cols);
+    std::vector<Candidate> results;
+
+#ifdef _WIN32
+    #pragma omp for schedule(dynamic)
+    for (intmax_t q = 0; q < (intmax_t) referenceSet.n_cols; ++q)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t q = 0; q < referenceSet.n_cols; ++q)
+#endif
+    {
+      // Search for one more neighbor, and skip the point itself.
+      SearchPoint(referenceSet.unsafe_col(q), k + 1, visited, results);
+
+      size_t j = 0;
+      for (size_t r = 0; r < results.size() && j < k; ++r)
+      {
+        if (results[r].second == (size_t) q)
+          continue;
+
+        neighbors(j, q) = results[r].second;
+        distances(j, q) = results[r].first;
+        ++j;
+      }
+
+      for (; j < k; ++j)
+      {
+        neighbors(j, q) = referenceSet.n_cols;
+        distances(j, q) = DBL_MAX;
+      }
+    }
+  }
+}
+
+// Serialize the model.
+template<typename MetricType, typename MatType>
+template<typename Archive>
+void HNSWSearch<MetricType, MatType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(maxNeighbors, "maxNeighbors");
+  ar & CreateNVP(efConstruction, "efConstruction");
+  ar & CreateNVP(ef, "ef");
+  ar & CreateNVP(metric, "metric");
+  ar & CreateNVP(referenceSet, "referenceSet");
+  if (Archive::is_loading::value)
+    links.clear();
+  ar & CreateNVP(links, "links");
+  ar & CreateNVP(entryPoint, "entryPoint");
+  ar & CreateNVP(maxLevel, "maxLevel");
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,8 @@
 
 #include "binary_numeric_split_info.hpp"
 
+#include <boost/serialization/utility.hpp>
+
 namespace mlpack {
 namespace tree {
 
@@ -33,11 +35,13 @@ namespace tree {
  * }
  * @endcode
  *
- * This splitting procedure builds a binary tree on points it has seen so far,
- * and then EvaluateFitnessFunction() returns the best possible split in O(n)
- * time, where n is the number of samples seen so far.  Every split with this
- * split type returns only two splits (greater than or equal to the split point,
- * and less than the split point).  The Train() function should take O(1) time.
+ * This splitting procedure keeps the points it has seen so far in a sorted
+ * buffer, and then EvaluateFitnessFunction() returns the best possible split in
+ * O(n) time, where n is the number of samples seen so far.  Every split with
+ * this split type returns only two splits (greater than or equal to the split
+ * point, and less than the split point).  The Train() function takes O(1)
+ * time: new points are appended to the end of the buffer, and are only sorted
+ * and merged into the sorted part when the fitness function is evaluated.
  *
  * @tparam FitnessFunction Fitness function to use for calculating gain.
  * @tparam ObservationType Type of observation used by this dimension.
@@ -106,13 +110,43 @@ class BinaryNumericSplit
   //! The probability of the majority class given the points seen so far.
   double MajorityProbability() const;
 
+  /**
+   * Add the points seen by another split of the same dimension to this one, as
+   * if this split had been trained on them too.
+   *
+   * @param other Split to merge into this one.
+   */
+  void Merge(const BinaryNumericSplit& other);
+
+  //! Return a split with the same number of classes that has seen no points.
+  BinaryNumericSplit EmptyCopy() const
+  {
+    return BinaryNumericSplit(classCounts.n_elem, *this);
+  }
+
   //! Serialize the object.
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */);
+  void Serialize(Archive& ar, const unsigned int version);
 
  private:
-  //! The elements seen so far, in sorted order.
-  std::multimap<ObservationType, size_t> sortedElements;
+  //! A point seen so far: its value and its label.
+  typedef std::pair<ObservationType, size_t> Element;
+
+  //! Compare the values of two elements.
+  static bool CompareValues(const Element& a, const Element& b)
+  {
+    return a.first < b.first;
+  }
+
+  //! Sort the elements that were added since the last time.
+  void SortElements();
+
+  //! The elements seen so far.  The first sortedCount are sorted by value (and
+  //! points with the same value are in the order they were seen); the others
+  //! are in the order they were seen.
+  std::vector<Element> elements;
+  //! The number of sorted elements at the start of the elements vector.
+  size_t sortedCount;
   //! The classes we have seen so far (for majority calculations).
   arma::Col<size_t> classCounts;
 
@@ -130,6 +164,24 @@ using BinaryDoubleNumericSplit = BinaryNumericSplit<FitnessFunction, double>;
 } // namespace tree
 } // namespace mlpack
 
+//! Set the serialization version of the BinaryNumericSplit class.  This is what
+//! BOOST_TEMPLATE_CLASS_VERSION does, but that macro can't take a template
+//! with more than one parameter.
+namespace boost {
+namespace serialization {
+
+template<typename FitnessFunction, typename ObservationType>
+struct version<mlpack::data::SecondShim<
+    mlpack::tree::BinaryNumericSplit<FitnessFunction, ObservationType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "binary_numeric_split_impl.hpp"
 
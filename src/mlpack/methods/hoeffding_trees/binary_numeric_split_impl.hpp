@@ -21,6 +21,7 @@ namespace tree {
 template<typename FitnessFunction, typename ObservationType>
 BinaryNumericSplit<FitnessFunction, ObservationType>::BinaryNumericSplit(
     const size_t numClasses) :
+    sortedCount(0),
     classCounts(numClasses),
     bestSplit(std::numeric_limits<ObservationType>::min()),
     isAccurate(true)
@@ -33,6 +34,7 @@ template<typename FitnessFunction, typename ObservationType>
 BinaryNumericSplit<FitnessFunction, ObservationType>::BinaryNumericSplit(
     const size_t numClasses,
     const BinaryNumericSplit& /* other */) :
+    sortedCount(0),
     classCounts(numClasses),
     bestSplit(std::numeric_limits<ObservationType>::min()),
     isAccurate(true)
@@ -46,8 +48,8 @@ void BinaryNumericSplit<FitnessFunction, ObservationType>::Train(
     ObservationType value,
     const size_t label)
 {
-  // Push it into the multimap, and update the class counts.
-  sortedElements.insert(std::pair<ObservationType, size_t>(value, label));
+  // Append it to the buffer, and update the class counts.
+  elements.push_back(Element(value, label));
   ++classCounts[label];
 
   // Whatever we have cached is no longer valid.
@@ -59,7 +61,8 @@ void BinaryNumericSplit<FitnessFunction, ObservationType>::
     EvaluateFitnessFunction(double& bestFitness,
                             double& secondBestFitness)
 {
-  // Unfortunately, we have to iterate over the map.
+  // Unfortunately, we have to iterate over all the points.
+  SortElements();
   bestSplit = std::numeric_limits<ObservationType>::min();
 
   // Initialize the sufficient statistics.
@@ -69,13 +72,16 @@ void BinaryNumericSplit<FitnessFunction, ObservationType>::
 
   bestFitness = FitnessFunction::Evaluate(counts);
   secondBestFitness = 0.0;
+  isAccurate = true;
+  if (elements.empty())
+    return;
 
   // Initialize to the first observation, so we don't calculate gain on the
   // first iteration (it will be 0).
-  ObservationType lastObservation = (*sortedElements.begin()).first;
+  ObservationType lastObservation = elements.front().first;
   size_t lastClass = classCounts.n_elem;
-  for (typename std::multimap<ObservationType, size_t>::const_iterator it =
-      sortedElements.begin(); it != sortedElements.end(); ++it)
+  for (typename std::vector<Element>::const_iterator it = elements.begin();
+       it != elements.end(); ++it)
   {
     // If this value is the same as the last, or if this is the first value, or
     // we have the same class as the previous observation, don't calculate the
@@ -101,8 +107,6 @@ void BinaryNumericSplit<FitnessFunction, ObservationType>::
     --counts((*it).second, 1);
     ++counts((*it).second, 0);
   }
-
-  isAccurate = true;
 }
 
 template<typename FitnessFunction, typename ObservationType>
@@ -125,9 +129,8 @@ void BinaryNumericSplit<FitnessFunction, ObservationType>::Split(
 
   double min = DBL_MAX;
   double max = -DBL_MAX;
-  for (typename std::multimap<ObservationType, size_t>::const_iterator it =
-      sortedElements.begin(); // (*it).first < bestSplit; ++it)
-      it != sortedElements.end(); ++it)
+  for (typename std::vector<Element>::const_iterator it = elements.begin();
+       it != elements.end(); ++it)
   {
     // Move the point to the correct side of the split.
     if ((*it).first < bestSplit)
@@ -168,15 +171,60 @@ double BinaryNumericSplit<FitnessFunction, ObservationType>::
   return double(arma::max(classCounts)) / double(arma::accu(classCounts));
 }
 
+template<typename FitnessFunction, typename ObservationType>
+void BinaryNumericSplit<FitnessFunction, ObservationType>::Merge(
+    const BinaryNumericSplit& other)
+{
+  // The elements of the other split are sorted with the new ones when they are
+  // needed.
+  elements.insert(elements.end(), other.elements.begin(),
+      other.elements.end());
+  classCounts += other.classCounts;
+  isAccurate = false;
+}
+
+template<typename FitnessFunction, typename ObservationType>
+void BinaryNumericSplit<FitnessFunction, ObservationType>::SortElements()
+{
+  if (sortedCount == elements.size())
+    return;
+
+  // Both sorts are stable, so points with the same value stay in the order
+  // they were seen, as they would in a std::multimap.
+  std::stable_sort(elements.begin() + sortedCount, elements.end(),
+      CompareValues);
+  std::inplace_merge(elements.begin(), elements.begin() + sortedCount,
+      elements.end(), CompareValues);
+  sortedCount = elements.size();
+}
+
 template<typename FitnessFunction, typename ObservationType>
 template<typename Archive>
 void BinaryNumericSplit<FitnessFunction, ObservationType>::Serialize(
     Archive& ar,
-    const unsigned int /* version */)
+    const unsigned int version)
 {
   // Serialize.
-  ar & data::CreateNVP(sortedElements, "sortedElements");
+  if (Archive::is_loading::value && version == 0)
+  {
+    // Older versions stored the points in a std::multimap.
+    std::multimap<ObservationType, size_t> sortedElements;
+    ar & data::CreateNVP(sortedElements, "sortedElements");
+    elements.assign(sortedElements.begin(), sortedElements.end());
+  }
+  else
+  {
+    if (Archive::is_saving::value)
+      SortElements();
+    ar & data::CreateNVP(elements, "elements");
+  }
   ar & data::CreateNVP(classCounts, "classCounts");
+
+  if (Archive::is_loading::value)
+  {
+    sortedCount = elements.size();
+    isAccurate = false;
+  }
 }
 
 
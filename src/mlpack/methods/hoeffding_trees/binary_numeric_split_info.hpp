@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_HOEFFDING_TREES_BINARY_NUMERIC_SPLIT_INFO_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_tree/flat_tree.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -32,6 +33,17 @@ class BinaryNumericSplitInfo
     return (value < splitPoint) ? 0 : 1;
   }
 
+  //! Add the split to the given flat tree.
+  template<typename eT>
+  void Freeze(const size_t dimension,
+              const size_t numChildren,
+              FlatTree<eT>& flat) const
+  {
+    const eT point = (eT) splitPoint;
+    flat.AddSplit(FlatTree<eT>::NUMERIC_LESS, dimension, numChildren, &point,
+        1);
+  }
+
   //! Serialize the split (save/load the split points).
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */)
@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_HOEFFDING_TREES_CATEGORICAL_SPLIT_INFO_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_tree/flat_tree.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -30,6 +31,15 @@ class CategoricalSplitInfo
     return size_t(value);
   }
 
+  //! Add the split to the given flat tree.
+  template<typename eT>
+  static void Freeze(const size_t dimension,
+                     const size_t numChildren,
+                     FlatTree<eT>& flat)
+  {
+    flat.AddSplit(FlatTree<eT>::CATEGORICAL, dimension, numChildren);
+  }
+
   //! Serialize the object.  (Nothing needs to be saved.)
   template<typename Archive>
   void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
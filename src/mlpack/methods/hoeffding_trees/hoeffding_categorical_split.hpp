@@ -101,6 +101,24 @@ class HoeffdingCategoricalSplit
    */
   void Split(arma::Col<size_t>& childMajorities, SplitInfo& splitInfo);
 
+  /**
+   * Add the points seen by another split of the same dimension to this one, as
+   * if this split had been trained on them too.
+   *
+   * @param other Split to merge into this one.
+   */
+  void Merge(const HoeffdingCategoricalSplit& other)
+  {
+    sufficientStatistics += other.sufficientStatistics;
+  }
+
+  //! Return a split of the same dimension that has seen no points.
+  HoeffdingCategoricalSplit EmptyCopy() const
+  {
+    return HoeffdingCategoricalSplit(sufficientStatistics.n_cols,
+        sufficientStatistics.n_rows, *this);
+  }
+
   //! Get the majority class seen so far.
   size_t MajorityClass() const;
   //! Get the probability of the majority class given the points seen so far.
@@ -119,6 +119,25 @@ class HoeffdingNumericSplit
   //! Return the number of bins.
   size_t Bins() const { return bins; }
 
+  /**
+   * Add the points seen by another split of the same dimension to this one.
+   * Points that the other split has not binned yet are trained on one by one,
+   * so if neither split has binned its points, the result is exact.  If both
+   * have, and their bins are the same, the counts are summed; if the bins
+   * differ, the counts of each bin of the other split are added to the bin of
+   * this split that holds the middle of it, so the result is approximate.
+   *
+   * @param other Split to merge into this one.
+   */
+  void Merge(const HoeffdingNumericSplit& other);
+
+  /**
+   * Return a split with the same parameters as this one, that has seen no
+   * points.  If this split has already made its bins, the new split has the
+   * same bins, so that it can be merged back exactly.
+   */
+  HoeffdingNumericSplit EmptyCopy() const;
+
   //! Serialize the object.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
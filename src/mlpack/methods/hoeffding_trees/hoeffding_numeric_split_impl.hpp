@@ -186,6 +186,77 @@ double HoeffdingNumericSplit<FitnessFunction, ObservationType>::
   }
 }
 
+template<typename FitnessFunction, typename ObservationType>
+void HoeffdingNumericSplit<FitnessFunction, ObservationType>::Merge(
+    const HoeffdingNumericSplit& other)
+{
+  if (other.samplesSeen < other.observationsBeforeBinning)
+  {
+    // The other split only holds observations, so we can train on them.
+    for (size_t i = 0; i < other.samplesSeen; ++i)
+      Train(other.observations[i], other.labels[i]);
+    return;
+  }
+
+  if (samplesSeen < observationsBeforeBinning)
+  {
+    // Only the other split has made its bins, so take them, and train on our
+    // observations.
+    HoeffdingNumericSplit merged(other);
+    for (size_t i = 0; i < samplesSeen; ++i)
+      merged.Train(observations[i], labels[i]);
+    *this = merged;
+    return;
+  }
+
+  if (other.bins == bins &&
+      (bins == 1 || arma::all(other.splitPoints == splitPoints)))
+  {
+    sufficientStatistics += other.sufficientStatistics;
+    return;
+  }
+
+  // A single bin has no split points to place it with.
+  if (other.bins == 1)
+  {
+    sufficientStatistics.col(0) += other.sufficientStatistics.col(0);
+    return;
+  }
+
+  // The bins differ, so move the counts of each bin of the other split to the
+  // bin of this split that holds its middle.  (With two bins, the width of the
+  // bins is unknown, so the split point stands for both bins.)
+  const ObservationType binWidth = (other.bins > 2) ?
+      other.splitPoints[1] - other.splitPoints[0] : ObservationType(0);
+  for (size_t i = 0; i < other.bins; ++i)
+  {
+    const ObservationType middle = (i + 1 < other.bins) ?
+        other.splitPoints[i] - binWidth / 2 :
+        other.splitPoints[other.bins - 2] + binWidth / 2;
+
+    size_t bin = 0;
+    while (bin < bins - 1 && middle > splitPoints[bin])
+      ++bin;
+
+    sufficientStatistics.col(bin) += other.sufficientStatistics.col(i);
+  }
+}
+
+template<typename FitnessFunction, typename ObservationType>
+HoeffdingNumericSplit<FitnessFunction, ObservationType>
+HoeffdingNumericSplit<FitnessFunction, ObservationType>::EmptyCopy() const
+{
+  HoeffdingNumericSplit split(sufficientStatistics.n_rows, *this);
+  if (samplesSeen >= observationsBeforeBinning)
+  {
+    // Once the bins are made, samplesSeen doesn't change any more.
+    split.splitPoints = splitPoints;
+    split.samplesSeen = samplesSeen;
+  }
+
+  return split;
+}
+
 template<typename FitnessFunction, typename ObservationType>
 template<typename Archive>
 void HoeffdingNumericSplit<FitnessFunction, ObservationType>::Serialize(
@@ -18,6 +18,8 @@
 #include "gini_impurity.hpp"
 #include "hoeffding_numeric_split.hpp"
 #include "hoeffding_categorical_split.hpp"
+#include <mlpack/methods/decision_tree/flat_tree.hpp>
+#include <queue>
 
 namespace mlpack {
 namespace tree {
@@ -152,6 +154,14 @@ class HoeffdingTree
    * Train on a set of points, either in streaming mode or in batch mode, with
    * the given labels.
    *
+   * In streaming mode, the points are first routed to the leaves of the tree in
+   * parallel (with OpenMP), and then the leaves are trained in parallel, each
+   * on its own points in order by a single thread, so that no split statistics
+   * are shared between threads.  Since a leaf only ever sees its own points,
+   * the tree is exactly the one that training on the points one at a time, in
+   * order, would give.  Calling this repeatedly with mini-batches of a stream
+   * is therefore much faster than training on each point.
+   *
    * @param data Data points to train on.
    * @param label Labels of data points.
    * @param batchTraining If true, perform training in batch.
@@ -161,6 +171,29 @@ class HoeffdingTree
              const arma::Row<size_t>& labels,
              const bool batchTraining = true);
 
+  /**
+   * Train on a set of points in streaming mode with several workers (the
+   * OpenMP threads), as a horizontally parallel Hoeffding tree.  The points are
+   * taken in rounds of syncInterval points.  In each round, every thread takes
+   * a contiguous share of the points, routes them to the leaves, and gathers
+   * the split statistics of those leaves in its own (initially empty) buffers;
+   * at the end of the round, the buffers are merged into the leaves in thread
+   * order, and each leaf that has seen at least another checkInterval points
+   * checks for a split.
+   *
+   * Splits only happen between rounds, and the statistics of numeric splits
+   * may only be merged approximately (see HoeffdingNumericSplit::Merge()), so
+   * the tree may differ slightly from the one Train() would give.
+   *
+   * @param data Data points to train on.
+   * @param labels Labels of data points.
+   * @param syncInterval Number of points between merges.
+   */
+  template<typename MatType>
+  void ParallelTrain(const MatType& data,
+                     const arma::Row<size_t>& labels,
+                     const size_t syncInterval = 10000);
+
   /**
    * Train on a single point in streaming mode, with the given label.
    *
@@ -228,6 +261,15 @@ class HoeffdingTree
   template<typename VecType>
   size_t CalculateDirection(const VecType& point) const;
 
+  /**
+   * Convert the tree into a FlatTree: a contiguous array of nodes that
+   * classifies batches of points faster than the tree.  The flat tree does not
+   * change if this tree is trained further.  Only the probability of the
+   * majority class of each leaf is known, so the other class probabilities of
+   * the flat tree are zero.
+   */
+  FlatTree<double> Freeze() const;
+
   /**
    * Classify the given point, using this node and the entire (sub)tree beneath
    * it.  The predicted label is returned.
@@ -289,6 +331,65 @@ class HoeffdingTree
   void Serialize(Archive& ar, const unsigned int /* version */);
 
  private:
+  /**
+   * Find the leaf that the given point currently goes to.
+   *
+   * @param point Point to find the leaf of.
+   */
+  template<typename VecType>
+  HoeffdingTree* FindLeaf(const VecType& point);
+
+  /**
+   * Train this leaf in streaming mode on the given points, in order.  If the
+   * leaf splits, the remaining points are passed to its children.
+   *
+   * @param data Dataset the points come from.
+   * @param labels Labels of the dataset.
+   * @param points Indices of the points to train on.
+   */
+  template<typename MatType>
+  void TrainPoints(const MatType& data,
+                   const arma::Row<size_t>& labels,
+                   const std::vector<size_t>& points);
+
+  //! Split statistics gathered by a worker for a leaf in ParallelTrain().
+  struct LeafStatistics
+  {
+    //! The number of samples seen.
+    size_t numSamples;
+    //! Information for splitting of numeric features.
+    std::vector<NumericSplitType<FitnessFunction>> numericSplits;
+    //! Information for splitting of categorical features.
+    std::vector<CategoricalSplitType<FitnessFunction>> categoricalSplits;
+  };
+
+  //! Get empty split statistics for this leaf.
+  LeafStatistics EmptyStatistics() const;
+
+  /**
+   * Add the given point to the given split statistics of this leaf.
+   *
+   * @param statistics Statistics to update.
+   * @param point Point to train on.
+   * @param label Label of the point.
+   */
+  template<typename VecType>
+  void TrainStatistics(LeafStatistics& statistics,
+                       const VecType& point,
+                       const size_t label) const;
+
+  /**
+   * Merge the given split statistics into this leaf, in order, and then split
+   * the leaf if another checkInterval samples have been seen and the split
+   * check succeeds.
+   *
+   * @param statistics Statistics to merge.
+   */
+  void MergeStatistics(const std::vector<const LeafStatistics*>& statistics);
+
+  //! Update the majority class and its probability from the split statistics.
+  void UpdateMajorityClass();
+
   // We need to keep some information for before we have split.
 
   //! Information for splitting of numeric features (used before split).
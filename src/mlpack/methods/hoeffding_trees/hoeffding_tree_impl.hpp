@@ -264,9 +264,326 @@ void HoeffdingTree<
   }
   else
   {
-    // We aren't training in batch mode; loop through the points.
+    // We aren't training in batch mode.  The leaves cannot change until they
+    // are trained, so first find the leaf of every point.
+    std::vector<HoeffdingTree*> leaves(data.n_cols);
+
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #ifdef _WIN32
+      #pragma omp parallel for
+      for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+    #else
+      #pragma omp parallel for
+      for (size_t i = 0; i < data.n_cols; ++i)
+    #endif
+    {
+      leaves[i] = FindLeaf(data.col(i));
+    }
+
+    // Group the points by leaf, keeping their order.
+    std::unordered_map<HoeffdingTree*, size_t> groupIndices;
+    std::vector<HoeffdingTree*> groupLeaves;
+    std::vector<std::vector<size_t>> groups;
     for (size_t i = 0; i < data.n_cols; ++i)
-      Train(data.col(i), labels[i]);
+    {
+      typename std::unordered_map<HoeffdingTree*, size_t>::iterator it =
+          groupIndices.find(leaves[i]);
+      if (it == groupIndices.end())
+      {
+        it = groupIndices.insert(std::make_pair(leaves[i],
+            groups.size())).first;
+        groupLeaves.push_back(leaves[i]);
+        groups.push_back(std::vector<size_t>());
+      }
+
+      groups[it->second].push_back(i);
+    }
+
+    // Each leaf, and the subtree it grows, is only touched by one thread.
+    // Exceptions cannot leave the parallel region, so the first one is
+    // rethrown after it.
+    std::exception_ptr error;
+
+    #ifdef _WIN32
+      #pragma omp parallel for schedule(dynamic)
+      for (intmax_t i = 0; i < (intmax_t) groups.size(); ++i)
+    #else
+      #pragma omp parallel for schedule(dynamic)
+      for (size_t i = 0; i < groups.size(); ++i)
+    #endif
+    {
+      try
+      {
+        groupLeaves[i]->TrainPoints(data, labels, groups[i]);
+      }
+      catch (...)
+      {
+        #pragma omp critical
+        {
+          if (!error)
+            error = std::current_exception();
+        }
+      }
+    }
+
+    if (error)
+      std::rethrow_exception(error);
+  }
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename VecType>
+HoeffdingTree<FitnessFunction, NumericSplitType, CategoricalSplitType>*
+HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::FindLeaf(const VecType& point)
+{
+  HoeffdingTree* node = this;
+  while (node->splitDimension != size_t(-1))
+    node = node->children[node->CalculateDirection(point)];
+
+  return node;
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename MatType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::TrainPoints(const MatType& data,
+               const arma::Row<size_t>& labels,
+               const std::vector<size_t>& points)
+{
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    if (splitDimension != size_t(-1))
+    {
+      // We have split, so the rest of the points go to the children.
+      std::vector<std::vector<size_t>> childPoints(children.size());
+      for (size_t j = i; j < points.size(); ++j)
+      {
+        childPoints[CalculateDirection(data.col(points[j]))].push_back(
+            points[j]);
+      }
+
+      for (size_t c = 0; c < children.size(); ++c)
+        if (!childPoints[c].empty())
+          children[c]->TrainPoints(data, labels, childPoints[c]);
+
+      return;
+    }
+
+    Train(data.col(points[i]), labels[points[i]]);
+  }
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename MatType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::ParallelTrain(const MatType& data,
+                 const arma::Row<size_t>& labels,
+                 const size_t syncInterval)
+{
+  if (syncInterval == 0)
+    throw std::invalid_argument("HoeffdingTree::ParallelTrain(): syncInterval "
+        "must be positive");
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+  typedef std::unordered_map<HoeffdingTree*, LeafStatistics> StatisticsMap;
+
+  for (size_t begin = 0; begin < data.n_cols; begin += syncInterval)
+  {
+    const size_t end = std::min(begin + syncInterval, (size_t) data.n_cols);
+
+    // The tree doesn't change during the round, so every thread gathers the
+    // statistics of its points on its own.
+    std::vector<StatisticsMap> threadStatistics(numThreads);
+    #pragma omp parallel
+    {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+      StatisticsMap& statistics = threadStatistics[thread];
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables.
+      #pragma omp for schedule(static)
+      for (intmax_t i = begin; i < (intmax_t) end; ++i)
+#else
+      #pragma omp for schedule(static)
+      for (size_t i = begin; i < end; ++i)
+#endif
+      {
+        HoeffdingTree* leaf = FindLeaf(data.col(i));
+        typename StatisticsMap::iterator it = statistics.find(leaf);
+        if (it == statistics.end())
+        {
+          it = statistics.insert(std::make_pair(leaf,
+              leaf->EmptyStatistics())).first;
+        }
+
+        leaf->TrainStatistics(it->second, data.col(i), labels[i]);
+      }
+    }
+
+    // Collect the statistics of each leaf, in thread order.
+    std::unordered_map<HoeffdingTree*, size_t> leafIndices;
+    std::vector<HoeffdingTree*> leaves;
+    std::vector<std::vector<const LeafStatistics*>> leafStatistics;
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+      typename StatisticsMap::const_iterator it;
+      for (it = threadStatistics[t].begin(); it != threadStatistics[t].end();
+           ++it)
+      {
+        typename std::unordered_map<HoeffdingTree*, size_t>::iterator index =
+            leafIndices.find(it->first);
+        if (index == leafIndices.end())
+        {
+          index = leafIndices.insert(std::make_pair(it->first,
+              leaves.size())).first;
+          leaves.push_back(it->first);
+          leafStatistics.push_back(std::vector<const LeafStatistics*>());
+        }
+
+        leafStatistics[index->second].push_back(&it->second);
+      }
+    }
+
+    // Merge the statistics into the leaves, and split them.
+    #ifdef _WIN32
+      #pragma omp parallel for schedule(dynamic)
+      for (intmax_t i = 0; i < (intmax_t) leaves.size(); ++i)
+    #else
+      #pragma omp parallel for schedule(dynamic)
+      for (size_t i = 0; i < leaves.size(); ++i)
+    #endif
+    {
+      leaves[i]->MergeStatistics(leafStatistics[i]);
+    }
+  }
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+typename HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::LeafStatistics
+HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::EmptyStatistics() const
+{
+  LeafStatistics statistics;
+  statistics.numSamples = 0;
+  for (size_t i = 0; i < numericSplits.size(); ++i)
+    statistics.numericSplits.push_back(numericSplits[i].EmptyCopy());
+  for (size_t i = 0; i < categoricalSplits.size(); ++i)
+    statistics.categoricalSplits.push_back(categoricalSplits[i].EmptyCopy());
+
+  return statistics;
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename VecType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::TrainStatistics(LeafStatistics& statistics,
+                   const VecType& point,
+                   const size_t label) const
+{
+  ++statistics.numSamples;
+  size_t numericIndex = 0;
+  size_t categoricalIndex = 0;
+  for (size_t i = 0; i < point.n_rows; ++i)
+  {
+    if (datasetInfo->Type(i) == data::Datatype::categorical)
+      statistics.categoricalSplits[categoricalIndex++].Train(point[i], label);
+    else if (datasetInfo->Type(i) == data::Datatype::numeric)
+      statistics.numericSplits[numericIndex++].Train(point[i], label);
+  }
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::MergeStatistics(const std::vector<const LeafStatistics*>& statistics)
+{
+  const size_t oldSamples = numSamples;
+  for (size_t s = 0; s < statistics.size(); ++s)
+  {
+    numSamples += statistics[s]->numSamples;
+    for (size_t i = 0; i < numericSplits.size(); ++i)
+      numericSplits[i].Merge(statistics[s]->numericSplits[i]);
+    for (size_t i = 0; i < categoricalSplits.size(); ++i)
+      categoricalSplits[i].Merge(statistics[s]->categoricalSplits[i]);
+  }
+
+  UpdateMajorityClass();
+
+  // Check for a split if we passed a multiple of checkInterval.
+  if (numSamples / checkInterval != oldSamples / checkInterval)
+  {
+    const size_t numChildren = SplitCheck();
+    if (numChildren > 0)
+    {
+      children.clear();
+      CreateChildren();
+    }
+  }
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::UpdateMajorityClass()
+{
+  if (categoricalSplits.size() > 0)
+  {
+    majorityClass = categoricalSplits[0].MajorityClass();
+    majorityProbability = categoricalSplits[0].MajorityProbability();
+  }
+  else
+  {
+    majorityClass = numericSplits[0].MajorityClass();
+    majorityProbability = numericSplits[0].MajorityProbability();
   }
 }
 
@@ -295,16 +612,7 @@ void HoeffdingTree<
     }
 
     // Grab majority class from splits.
-    if (categoricalSplits.size() > 0)
-    {
-      majorityClass = categoricalSplits[0].MajorityClass();
-      majorityProbability = categoricalSplits[0].MajorityProbability();
-    }
-    else
-    {
-      majorityClass = numericSplits[0].MajorityClass();
-      majorityProbability = numericSplits[0].MajorityProbability();
-    }
+    UpdateMajorityClass();
 
     // Check for a split, if we should.
     if (numSamples % checkInterval == 0)
@@ -501,6 +809,53 @@ size_t HoeffdingTree<
     return 0; // Not sure what to do here...
 }
 
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+FlatTree<double> HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Freeze() const
+{
+  FlatTree<double> flat(numClasses);
+
+  // The nodes are added in breadth-first order, so that the children of each
+  // node are stored together.
+  std::queue<const HoeffdingTree*> queue;
+  queue.push(this);
+  while (!queue.empty())
+  {
+    const HoeffdingTree* node = queue.front();
+    queue.pop();
+
+    if (node->children.size() == 0)
+    {
+      arma::vec probabilities(numClasses, arma::fill::zeros);
+      if (node->majorityClass < numClasses)
+        probabilities[node->majorityClass] = node->majorityProbability;
+      flat.AddLeaf(node->majorityClass, node->majorityProbability,
+          probabilities);
+      continue;
+    }
+
+    if (node->datasetInfo->Type(node->splitDimension) ==
+        data::Datatype::categorical)
+      node->categoricalSplit.Freeze(node->splitDimension,
+          node->children.size(), flat);
+    else
+      node->numericSplit.Freeze(node->splitDimension, node->children.size(),
+          flat);
+
+    for (size_t i = 0; i < node->children.size(); ++i)
+      queue.push(node->children[i]);
+  }
+
+  return flat;
+}
+
 template<
     typename FitnessFunction,
     template<typename> class NumericSplitType,
@@ -203,23 +203,23 @@ void HoeffdingTreeModel::Train(const arma::mat& dataset,
 void HoeffdingTreeModel::Classify(const arma::mat& dataset,
                                   arma::Row<size_t>& predictions) const
 {
-  // Call Classify() with the right model.
+  // Call Classify() on the flattened form of the right model.
   switch (type)
   {
     case GINI_HOEFFDING:
-      giniHoeffdingTree->Classify(dataset, predictions);
+      giniHoeffdingTree->Freeze().Classify(dataset, predictions);
       break;
 
     case GINI_BINARY:
-      giniBinaryTree->Classify(dataset, predictions);
+      giniBinaryTree->Freeze().Classify(dataset, predictions);
       break;
 
     case INFO_HOEFFDING:
-      infoHoeffdingTree->Classify(dataset, predictions);
+      infoHoeffdingTree->Freeze().Classify(dataset, predictions);
       break;
 
     case INFO_BINARY:
-      infoBinaryTree->Classify(dataset, predictions);
+      infoBinaryTree->Freeze().Classify(dataset, predictions);
       break;
   }
 }
@@ -229,23 +229,23 @@ void HoeffdingTreeModel::Classify(const arma::mat& dataset,
                                   arma::Row<size_t>& predictions,
                                   arma::rowvec& probabilities) const
 {
-  // Call Classify() with the right model.
+  // Call Classify() on the flattened form of the right model.
   switch (type)
   {
     case GINI_HOEFFDING:
-      giniHoeffdingTree->Classify(dataset, predictions, probabilities);
+      giniHoeffdingTree->Freeze().Classify(dataset, predictions, probabilities);
       break;
 
     case GINI_BINARY:
-      giniBinaryTree->Classify(dataset, predictions, probabilities);
+      giniBinaryTree->Freeze().Classify(dataset, predictions, probabilities);
       break;
 
     case INFO_HOEFFDING:
-      infoHoeffdingTree->Classify(dataset, predictions, probabilities);
+      infoHoeffdingTree->Freeze().Classify(dataset, predictions, probabilities);
       break;
 
     case INFO_BINARY:
-      infoBinaryTree->Classify(dataset, predictions, probabilities);
+      infoBinaryTree->Freeze().Classify(dataset, predictions, probabilities);
       break;
   }
 }
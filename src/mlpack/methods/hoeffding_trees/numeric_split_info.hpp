@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_HOEFFDING_TREES_NUMERIC_SPLIT_INFO_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_tree/flat_tree.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -36,6 +37,18 @@ class NumericSplitInfo
     return bin;
   }
 
+  //! Add the split to the given flat tree.
+  template<typename eT>
+  void Freeze(const size_t dimension,
+              const size_t numChildren,
+              FlatTree<eT>& flat) const
+  {
+    const arma::Col<eT> points = arma::conv_to<arma::Col<eT>>::from(
+        splitPoints);
+    flat.AddSplit(FlatTree<eT>::NUMERIC_BINS, dimension, numChildren,
+        points.memptr(), points.n_elem);
+  }
+
   //! Serialize the split (save/load the split points).
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */)
@@ -0,0 +1,289 @@
+/**
+ * @file kde.hpp
+ *
+ * Defines the KDE class, which performs kernel density estimation with trees.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_HPP
+#define MLPACK_METHODS_KDE_KDE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/statistic.hpp>
+#include <mlpack/core/tree/shared_tree.hpp>
+
+namespace mlpack {
+namespace kde /** Kernel density estimation. */ {
+
+/**
+ * The KDE class estimates, for each query point, the average of the kernel
+ * between the query point and every point of the reference set,
+ *
+ * @f[
+ * f(q) = \frac{1}{N} \sum_{r = 1}^{N} K(d(q, r)),
+ * @f]
+ *
+ * which is a kernel density estimate up to the normalization constant of the
+ * kernel.  Besides the naive O(N) computation per query point, the estimates
+ * can be computed with single-tree or dual-tree algorithms.  The kernel between
+ * the points of two tree nodes is bounded by the kernel of their minimum and
+ * maximum distances, and when these bounds are close enough, the reference node
+ * is not visited: every one of its points contributes the midpoint of the
+ * bounds instead.  A reference node is pruned when
+ *
+ * @f[
+ * \frac{K_{max} - K_{min}}{2} \le \epsilon_{rel} K_{min} + \epsilon_{abs},
+ * @f]
+ *
+ * so the estimate of each query point is within relError times the true
+ * estimate plus absError of the true estimate.  A relative and absolute error
+ * of zero makes the computation exact.  The single-tree search is parallel over
+ * the query points and the dual-tree search is parallel over subtrees of the
+ * query tree, with OpenMP.
+ *
+ * @code
+ * extern arma::mat reference, query;
+ *
+ * KDE<> kde(0.01, 0.0, kernel::GaussianKernel(0.5));
+ * kde.Train(reference);
+ * arma::vec estimations;
+ * kde.Evaluate(query, estimations);
+ * @endcode
+ *
+ * @tparam KernelType Kernel to use; KernelTraits<KernelType> must have
+ *     DecreasesWithDistance set to true.
+ * @tparam MetricType Metric to use for the distances.
+ * @tparam MatType Type of the data matrices.
+ * @tparam TreeType Type of tree to use; each point must be held by a single
+ *     leaf, so trees with self-children (like the cover tree) can't be used.
+ * @tparam StatisticType Statistic of the tree nodes, which KDE does not use;
+ *     it can be set to share the tree of another model (see tree::SharedTree).
+ */
+template<typename KernelType = kernel::GaussianKernel,
+         typename MetricType = metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree,
+         typename StatisticType = tree::EmptyStatistic>
+class KDE
+{
+  static_assert(kernel::KernelTraits<KernelType>::DecreasesWithDistance,
+      "KDE: the kernel must decrease with the distance between the points");
+
+ public:
+  //! Convenience typedef.
+  typedef TreeType<MetricType, StatisticType, MatType> Tree;
+
+  static_assert(!tree::TreeTraits<Tree>::HasSelfChildren,
+      "KDE: trees with self-children would count some points twice");
+
+  /**
+   * Create the KDE object with the given error tolerances and kernel.  The
+   * object must be trained with Train() before estimates can be computed.  A
+   * std::invalid_argument is thrown if relError is not in [0, 1] or absError
+   * is negative.
+   *
+   * @param relError Relative error tolerance of each estimate.
+   * @param absError Absolute error tolerance of each estimate.
+   * @param kernel Instantiated kernel.
+   * @param metric Instantiated metric.
+   * @param naive If true, the estimates are computed without trees.
+   * @param singleMode If true, single-tree search is used instead of dual-tree
+   *     search.
+   */
+  KDE(const double relError = 0.05,
+      const double absError = 0.0,
+      const KernelType kernel = KernelType(),
+      const MetricType metric = MetricType(),
+      const bool naive = false,
+      const bool singleMode = false);
+
+  /**
+   * Create the KDE object on the given shared reference tree, which is neither
+   * copied nor modified, so that other models can search it at the same time
+   * (see tree::SharedTree).  The estimates of Evaluate() without a query set
+   * are in the original order of the points.  Calling Train() stops sharing
+   * the tree.
+   *
+   * @param referenceTree Shared pre-built tree for reference points.
+   * @param relError Relative error tolerance of each estimate.
+   * @param absError Absolute error tolerance of each estimate.
+   * @param kernel Instantiated kernel.
+   * @param metric Instantiated metric.
+   * @param singleMode If true, single-tree search is used instead of dual-tree
+   *     search.
+   */
+  KDE(const tree::SharedTree<Tree>& referenceTree,
+      const double relError = 0.05,
+      const double absError = 0.0,
+      const KernelType kernel = KernelType(),
+      const MetricType metric = MetricType(),
+      const bool singleMode = false);
+
+  //! Copy the given KDE object, including its reference tree.
+  KDE(const KDE& other);
+
+  //! Take ownership of the reference tree of the given KDE object.
+  KDE(KDE&& other);
+
+  //! Copy the given KDE object, including its reference tree.
+  KDE& operator=(const KDE& other);
+
+  //! Take ownership of the reference tree of the given KDE object.
+  KDE& operator=(KDE&& other);
+
+  //! Free the reference tree.
+  ~KDE();
+
+  /**
+   * Build the reference tree on the given reference set.  The tree is built
+   * in naive mode too, to hold the reference set.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(MatType referenceSet);
+
+  /**
+   * Compute the estimate of each of the given query points.  A
+   * std::runtime_error is thrown if the model has not been trained, and a
+   * std::invalid_argument if the dimensionality of the query points does not
+   * match that of the reference points.
+   *
+   * @param querySet Set of query points.
+   * @param estimations Vector to store the estimate of each query point in.
+   */
+  void Evaluate(const MatType& querySet, arma::vec& estimations);
+
+  /**
+   * Compute the estimate of each of the reference points, with the reference
+   * points also used as the query points (so each point contributes K(0) to
+   * its own estimate).  A std::runtime_error is thrown if the model has not
+   * been trained.
+   *
+   * @param estimations Vector to store the estimate of each reference point in.
+   */
+  void Evaluate(arma::vec& estimations);
+
+  //! Get the relative error tolerance.
+  double RelativeError() const { return relError; }
+  //! Modify the relative error tolerance.
+  double& RelativeError() { return relError; }
+
+  //! Get the absolute error tolerance.
+  double AbsoluteError() const { return absError; }
+  //! Modify the absolute error tolerance.
+  double& AbsoluteError() { return absError; }
+
+  //! Get the kernel.
+  const KernelType& Kernel() const { return kernel; }
+  //! Modify the kernel.
+  KernelType& Kernel() { return kernel; }
+
+  //! Get the metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the metric.
+  MetricType& Metric() { return metric; }
+
+  //! Get whether or not naive computation is used.
+  bool Naive() const { return naive; }
+  //! Modify whether or not naive computation is used.
+  bool& Naive() { return naive; }
+
+  //! Get whether or not single-tree search is used.
+  bool SingleMode() const { return singleMode; }
+  //! Modify whether or not single-tree search is used.
+  bool& SingleMode() { return singleMode; }
+
+  //! Get whether or not the model has been trained.
+  bool IsTrained() const { return referenceTree != NULL; }
+
+  //! Get the reference tree (NULL if the model has not been trained).
+  Tree* ReferenceTree() { return referenceTree; }
+
+  //! Get the number of base cases of the last evaluation.
+  size_t BaseCases() const { return baseCases; }
+  //! Get the number of scores of the last evaluation.
+  size_t Scores() const { return scores; }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The tree built on the reference points.
+  Tree* referenceTree;
+  //! Mapping from the indices of the tree to the original reference points.
+  std::vector<size_t> oldFromNewReferences;
+
+  //! The relative error tolerance.
+  double relError;
+  //! The absolute error tolerance.
+  double absError;
+
+  //! The instantiated kernel.
+  KernelType kernel;
+  //! The instantiated metric.
+  MetricType metric;
+
+  //! If true, the estimates are computed without trees.
+  bool naive;
+  //! If true, single-tree search is used.
+  bool singleMode;
+
+  //! The total number of base cases during the last evaluation.
+  size_t baseCases;
+  //! The total number of scores during the last evaluation.
+  size_t scores;
+
+  //! The shared reference tree, if the reference tree is shared; then
+  //! referenceTree points to it, and it is never modified.
+  std::shared_ptr<const Tree> sharedTree;
+
+  //! Check the error tolerances given to a constructor.
+  void CheckErrors() const;
+
+  /**
+   * Compute the estimates of the given query points in naive mode, in
+   * parallel over the query points, as sums over the reference points.
+   */
+  void NaiveEvaluate(const MatType& querySet, arma::vec& estimations);
+
+  /**
+   * Traverse the reference tree for each of the given number of query points
+   * with the given rules, in parallel over the query points with OpenMP, and
+   * set the number of base cases and scores.
+   */
+  template<typename RuleType>
+  void SingleTreeEvaluate(RuleType& rules, const size_t numQueries);
+
+  /**
+   * Traverse the given query tree and the reference tree with the given rules,
+   * in parallel over subtrees of the query tree with OpenMP, and set the number
+   * of base cases and scores.
+   */
+  template<typename RuleType>
+  void DualTreeEvaluate(RuleType& rules, Tree* queryTree);
+
+  /**
+   * Split the given query tree into disjoint subtrees that together hold all
+   * the query points, so that there are a few subtrees per thread to balance
+   * the load of the dual-tree traversal.
+   */
+  static void SplitQueryTree(Tree* queryTree, std::vector<Tree*>& queryNodes);
+};
+
+} // namespace kde
+} // namespace mlpack
+
+// Include implementation.
+#include "kde_impl.hpp"
+
+#endif
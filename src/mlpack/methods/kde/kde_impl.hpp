@@ -0,0 +1,609 @@
+/**
+ * @file kde_impl.hpp
+ *
+ * Implementation of the KDE class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_IMPL_HPP
+#define MLPACK_METHODS_KDE_KDE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kde.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+// The rules for traversal.
+#include "kde_rules.hpp"
+
+namespace mlpack {
+namespace kde {
+
+//! Call the tree constructor that does mapping.
+template<typename TreeType, typename MatType>
+TreeType* BuildTree(
+    MatType&& dataset,
+    std::vector<size_t>& oldFromNew,
+    const typename std::enable_if<
+        tree::TreeTraits<TreeType>::RearrangesDataset>::type* = 0)
+{
+  return new TreeType(std::forward<MatType>(dataset), oldFromNew);
+}
+
+//! Call the tree constructor that does not do mapping.
+template<typename TreeType, typename MatType>
+TreeType* BuildTree(
+    MatType&& dataset,
+    std::vector<size_t>& oldFromNew,
+    const typename std::enable_if<
+        !tree::TreeTraits<TreeType>::RearrangesDataset>::type* = 0)
+{
+  oldFromNew.clear();
+  return new TreeType(std::forward<MatType>(dataset));
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::KDE(
+    const double relError,
+    const double absError,
+    const KernelType kernel,
+    const MetricType metric,
+    const bool naive,
+    const bool singleMode) :
+    referenceTree(NULL),
+    relError(relError),
+    absError(absError),
+    kernel(kernel),
+    metric(metric),
+    naive(naive),
+    singleMode(!naive && singleMode), // Naive overrides single mode.
+    baseCases(0),
+    scores(0)
+{
+  CheckErrors();
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::KDE(
+    const tree::SharedTree<Tree>& referenceTree,
+    const double relError,
+    const double absError,
+    const KernelType kernel,
+    const MetricType metric,
+    const bool singleMode) :
+    referenceTree(const_cast<Tree*>(&referenceTree.Tree())),
+    oldFromNewReferences(referenceTree.OldFromNew()),
+    relError(relError),
+    absError(absError),
+    kernel(kernel),
+    metric(metric),
+    naive(false),
+    singleMode(singleMode),
+    baseCases(0),
+    scores(0),
+    sharedTree(referenceTree.TreePointer())
+{
+  CheckErrors();
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::KDE(
+    const KDE& other) :
+    referenceTree(other.sharedTree ? other.referenceTree :
+        (other.referenceTree ? new Tree(*other.referenceTree) : NULL)),
+    oldFromNewReferences(other.oldFromNewReferences),
+    relError(other.relError),
+    absError(other.absError),
+    kernel(other.kernel),
+    metric(other.metric),
+    naive(other.naive),
+    singleMode(other.singleMode),
+    baseCases(other.baseCases),
+    scores(other.scores),
+    sharedTree(other.sharedTree)
+{
+  // Nothing to do.
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::KDE(
+    KDE&& other) :
+    referenceTree(other.referenceTree),
+    oldFromNewReferences(std::move(other.oldFromNewReferences)),
+    relError(other.relError),
+    absError(other.absError),
+    kernel(std::move(other.kernel)),
+    metric(std::move(other.metric)),
+    naive(other.naive),
+    singleMode(other.singleMode),
+    baseCases(other.baseCases),
+    scores(other.scores),
+    sharedTree(std::move(other.sharedTree))
+{
+  other.referenceTree = NULL;
+  other.baseCases = 0;
+  other.scores = 0;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+KDE<KernelType, MetricType, MatType, TreeType, StatisticType>&
+KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::operator=(
+    const KDE& other)
+{
+  if (this != &other)
+  {
+    Tree* newTree = other.sharedTree ? other.referenceTree :
+        (other.referenceTree ? new Tree(*other.referenceTree) : NULL);
+    if (!sharedTree)
+      delete referenceTree;
+    referenceTree = newTree;
+    sharedTree = other.sharedTree;
+
+    oldFromNewReferences = other.oldFromNewReferences;
+    relError = other.relError;
+    absError = other.absError;
+    kernel = other.kernel;
+    metric = other.metric;
+    naive = other.naive;
+    singleMode = other.singleMode;
+    baseCases = other.baseCases;
+    scores = other.scores;
+  }
+
+  return *this;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+KDE<KernelType, MetricType, MatType, TreeType, StatisticType>&
+KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::operator=(
+    KDE&& other)
+{
+  if (this != &other)
+  {
+    if (!sharedTree)
+      delete referenceTree;
+    referenceTree = other.referenceTree;
+    other.referenceTree = NULL;
+    sharedTree = std::move(other.sharedTree);
+
+    oldFromNewReferences = std::move(other.oldFromNewReferences);
+    relError = other.relError;
+    absError = other.absError;
+    kernel = std::move(other.kernel);
+    metric = std::move(other.metric);
+    naive = other.naive;
+    singleMode = other.singleMode;
+    baseCases = other.baseCases;
+    scores = other.scores;
+  }
+
+  return *this;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::~KDE()
+{
+  if (!sharedTree)
+    delete referenceTree;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::Train(
+    MatType referenceSet)
+{
+  Tree* newTree = BuildTree<Tree>(std::move(referenceSet),
+      oldFromNewReferences);
+  if (!sharedTree)
+    delete referenceTree;
+  referenceTree = newTree;
+  sharedTree.reset();
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void KDE<KernelType, MetricType, MatType, TreeType,
+         StatisticType>::CheckErrors() const
+{
+  if (relError < 0.0 || relError > 1.0)
+  {
+    std::ostringstream oss;
+    oss << "KDE::KDE(): relative error tolerance (" << relError << ") must be "
+        << "in [0, 1]";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (absError < 0.0)
+  {
+    std::ostringstream oss;
+    oss << "KDE::KDE(): absolute error tolerance (" << absError << ") must be "
+        << "non-negative";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::Evaluate(
+    const MatType& querySet,
+    arma::vec& estimations)
+{
+  if (!referenceTree)
+    throw std::runtime_error("KDE::Evaluate(): the model has not been "
+        "trained");
+
+  const MatType& referenceSet = referenceTree->Dataset();
+  if (querySet.n_rows != referenceSet.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "KDE::Evaluate(): dimensionality of query set (" << querySet.n_rows
+        << ") does not match dimensionality of reference set ("
+        << referenceSet.n_rows << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  typedef KDERules<MetricType, KernelType, Tree> RuleType;
+
+  estimations.zeros(querySet.n_cols);
+  if (naive)
+  {
+    NaiveEvaluate(querySet, estimations);
+  }
+  else if (singleMode)
+  {
+    RuleType rules(referenceSet, querySet, estimations, relError, absError,
+        metric, kernel);
+    SingleTreeEvaluate(rules, querySet.n_cols);
+  }
+  else
+  {
+    Timer::Start("tree_building");
+    std::vector<size_t> oldFromNewQueries;
+    Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+    Timer::Stop("tree_building");
+
+    arma::vec sums(querySet.n_cols, arma::fill::zeros);
+    RuleType rules(referenceSet, queryTree->Dataset(), sums, relError,
+        absError, metric, kernel);
+    DualTreeEvaluate(rules, queryTree);
+    delete queryTree;
+
+    // Unmap the query points, if the tree mapped them.
+    if (tree::TreeTraits<Tree>::RearrangesDataset)
+    {
+      for (size_t i = 0; i < sums.n_elem; ++i)
+        estimations[oldFromNewQueries[i]] = sums[i];
+    }
+    else
+    {
+      estimations = std::move(sums);
+    }
+  }
+
+  if (referenceSet.n_cols > 0)
+    estimations /= referenceSet.n_cols;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::Evaluate(
+    arma::vec& estimations)
+{
+  if (!referenceTree)
+    throw std::runtime_error("KDE::Evaluate(): the model has not been "
+        "trained");
+
+  typedef KDERules<MetricType, KernelType, Tree> RuleType;
+
+  const MatType& referenceSet = referenceTree->Dataset();
+  arma::vec sums(referenceSet.n_cols, arma::fill::zeros);
+  if (naive)
+  {
+    NaiveEvaluate(referenceSet, sums);
+  }
+  else
+  {
+    RuleType rules(referenceSet, referenceSet, sums, relError, absError,
+        metric, kernel);
+    if (singleMode)
+      SingleTreeEvaluate(rules, referenceSet.n_cols);
+    else
+      DualTreeEvaluate(rules, referenceTree);
+  }
+
+  // Unmap the reference points, if the tree mapped them (a shared tree may
+  // come without its mapping).
+  if (tree::TreeTraits<Tree>::RearrangesDataset &&
+      !oldFromNewReferences.empty())
+  {
+    estimations.set_size(sums.n_elem);
+    for (size_t i = 0; i < sums.n_elem; ++i)
+      estimations[oldFromNewReferences[i]] = sums[i];
+  }
+  else
+  {
+    estimations = std::move(sums);
+  }
+
+  if (referenceSet.n_cols > 0)
+    estimations /= referenceSet.n_cols;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void KDE<KernelType, MetricType, MatType, TreeType,
+         StatisticType>::NaiveEvaluate(
+    const MatType& querySet,
+    arma::vec& estimations)
+{
+  const MatType& referenceSet = referenceTree->Dataset();
+
+  // Each query point is summed over the reference points, one after the other.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+#endif
+  {
+    double sum = 0.0;
+    for (size_t j = 0; j < referenceSet.n_cols; ++j)
+      sum += kernel.Evaluate(metric.Evaluate(querySet.col(i),
+          referenceSet.col(j)));
+    estimations[i] = sum;
+  }
+
+  baseCases = querySet.n_cols * referenceSet.n_cols;
+  scores = 0;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+template<typename RuleType>
+void KDE<KernelType, MetricType, MatType, TreeType,
+         StatisticType>::SingleTreeEvaluate(
+    RuleType& rules,
+    const size_t numQueries)
+{
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+
+  // Each thread traverses the reference tree for its own query points, with its
+  // own copy of the rules.  The sums of different query points are stored in
+  // different elements, so no merging is needed.
+  #pragma omp parallel reduction(+:totalBaseCases, totalScores)
+  {
+    RuleType threadRules(rules);
+    typename Tree::template SingleTreeTraverser<RuleType>
+        traverser(threadRules);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) numQueries; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < numQueries; ++i)
+#endif
+      traverser.Traverse(i, *referenceTree);
+
+    totalBaseCases += threadRules.BaseCases();
+    totalScores += threadRules.Scores();
+  }
+
+  baseCases = totalBaseCases;
+  scores = totalScores;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+template<typename RuleType>
+void KDE<KernelType, MetricType, MatType, TreeType,
+         StatisticType>::DualTreeEvaluate(
+    RuleType& rules,
+    Tree* queryTree)
+{
+  std::vector<Tree*> queryNodes;
+  SplitQueryTree(queryTree, queryNodes);
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+
+  // The subtrees hold disjoint sets of query points, so each one can be
+  // traversed against the reference tree by a different thread, with its own
+  // copy of the rules.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:totalBaseCases, totalScores)
+  for (intmax_t i = 0; i < (intmax_t) queryNodes.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:totalBaseCases, totalScores)
+  for (size_t i = 0; i < queryNodes.size(); ++i)
+#endif
+  {
+    RuleType threadRules(rules);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(threadRules);
+
+    traverser.Traverse(*queryNodes[i], *referenceTree);
+
+    totalBaseCases += threadRules.BaseCases();
+    totalScores += threadRules.Scores();
+  }
+
+  baseCases = totalBaseCases;
+  scores = totalScores;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void KDE<KernelType, MetricType, MatType, TreeType,
+         StatisticType>::SplitQueryTree(
+    Tree* queryTree,
+    std::vector<Tree*>& queryNodes)
+{
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  queryNodes.assign(1, queryTree);
+  while (numThreads > 1 && queryNodes.size() < 4 * numThreads)
+  {
+    // Find the subtree with the most descendants that can be split.
+    size_t largest = queryNodes.size();
+    for (size_t i = 0; i < queryNodes.size(); ++i)
+    {
+      if (queryNodes[i]->NumChildren() > 0 && (largest == queryNodes.size() ||
+          queryNodes[i]->NumDescendants() >
+          queryNodes[largest]->NumDescendants()))
+        largest = i;
+    }
+
+    if (largest == queryNodes.size())
+      break; // Only leaves are left.
+
+    Tree* node = queryNodes[largest];
+    queryNodes[largest] = &node->Child(0);
+    for (size_t i = 1; i < node->NumChildren(); ++i)
+      queryNodes.push_back(&node->Child(i));
+  }
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+template<typename Archive>
+void KDE<KernelType, MetricType, MatType, TreeType, StatisticType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(relError, "relError");
+  ar & CreateNVP(absError, "absError");
+  ar & CreateNVP(kernel, "kernel");
+  ar & CreateNVP(metric, "metric");
+  ar & CreateNVP(naive, "naive");
+  ar & CreateNVP(singleMode, "singleMode");
+
+  // Delete the current reference tree, if we are loading.
+  if (Archive::is_loading::value)
+  {
+    if (!sharedTree)
+      delete referenceTree;
+    referenceTree = NULL;
+    sharedTree.reset();
+    baseCases = 0;
+    scores = 0;
+  }
+
+  ar & CreateNVP(referenceTree, "referenceTree");
+  ar & CreateNVP(oldFromNewReferences, "oldFromNewReferences");
+}
+
+} // namespace kde
+} // namespace mlpack
+
+#endif
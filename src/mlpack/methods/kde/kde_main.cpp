@@ -0,0 +1,199 @@
+/**
+ * @file kde_main.cpp
+ *
+ * Executable for kernel density estimation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+
+#include "kde.hpp"
+#include "kde_model.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::kde;
+
+PROGRAM_INFO("Kernel Density Estimation",
+    "This program performs kernel density estimation: for each point in the "
+    "query set, the average of the kernel between the query point and every "
+    "point in the reference set is computed.  For the Gaussian, Epanechnikov "
+    "and spherical kernels, the estimates are normalized so that they are "
+    "densities.  If no query set is given, the estimates of the reference "
+    "points are computed.  The estimates are computed with dual-tree search by "
+    "default, or with single-tree search (--single_mode) or naive computation "
+    "(--naive).  The error of each estimate is at most --rel_error times the "
+    "true estimate plus --abs_error; both can be set to 0 for exact results."
+    "\n\n"
+    "For example, the following command computes the Gaussian kernel density "
+    "estimates of the points in 'query.csv' with the points in "
+    "'reference.csv', with a bandwidth of 0.5 and a relative error of at most "
+    "1%, and stores them in 'estimates.csv':"
+    "\n\n"
+    "$ mlpack_kde --reference_file reference.csv --query_file query.csv\n"
+    "  --bandwidth 0.5 --rel_error 0.01 --predictions_file estimates.csv"
+    "\n\n"
+    "The model can be saved with --output_model_file and reused with "
+    "--input_model_file, so that the reference tree is not built again.");
+
+// Model-building parameters.
+PARAM_MATRIX_IN("reference", "Input reference dataset.", "r");
+PARAM_STRING_IN("kernel", "Kernel to use: 'gaussian', 'epanechnikov', "
+    "'laplacian', 'spherical', or 'triangular'.", "k", "gaussian");
+PARAM_STRING_IN("tree", "Tree to use: 'kd-tree', 'ball-tree', or 'octree'.",
+    "t", "kd-tree");
+PARAM_DOUBLE_IN("bandwidth", "Bandwidth of the kernel.", "b", 1.0);
+
+// Load/save models.
+PARAM_MODEL_IN(KDEModel, "input_model", "Contains pre-trained KDE model.",
+    "m");
+PARAM_MODEL_OUT(KDEModel, "output_model", "If specified, the KDE model will "
+    "be saved here.", "M");
+
+// Evaluation parameters.
+PARAM_MATRIX_IN("query", "Query dataset.", "q");
+PARAM_DOUBLE_IN("rel_error", "Relative error tolerance of each estimate.",
+    "e", 0.05);
+PARAM_DOUBLE_IN("abs_error", "Absolute error tolerance of each estimate.",
+    "E", 0.0);
+PARAM_FLAG("naive", "If true, the estimates are computed without trees.", "N");
+PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
+    "dual-tree search).", "S");
+
+PARAM_COL_OUT("predictions", "Vector to store the estimates in.", "p");
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  // Validate command-line parameters.
+  if (CLI::HasParam("reference") && CLI::HasParam("input_model"))
+    Log::Fatal << "Cannot specify both --reference_file (-r) and "
+        << "--input_model_file (-m)!" << endl;
+
+  if (!CLI::HasParam("reference") && !CLI::HasParam("input_model"))
+    Log::Fatal << "Must specify either --reference_file (-r) or "
+        << "--input_model_file (-m)!" << endl;
+
+  if (CLI::HasParam("input_model"))
+  {
+    if (CLI::HasParam("kernel"))
+      Log::Warn << "--kernel (-k) ignored because --input_model_file (-m) is "
+          << "specified." << endl;
+    if (CLI::HasParam("tree"))
+      Log::Warn << "--tree (-t) ignored because --input_model_file (-m) is "
+          << "specified." << endl;
+    if (CLI::HasParam("bandwidth"))
+      Log::Warn << "--bandwidth (-b) ignored because --input_model_file (-m) "
+          << "is specified." << endl;
+  }
+
+  if (!CLI::HasParam("predictions") && !CLI::HasParam("output_model"))
+    Log::Warn << "Neither --predictions_file (-p) nor --output_model_file (-M) "
+        << "is specified; no output will be saved!" << endl;
+
+  if (CLI::HasParam("naive") && CLI::HasParam("single_mode"))
+    Log::Warn << "--single_mode (-S) ignored because --naive (-N) is present."
+        << endl;
+
+  const double relError = CLI::GetParam<double>("rel_error");
+  if (relError < 0.0 || relError > 1.0)
+    Log::Fatal << "Invalid --rel_error (-e) " << relError << "; must be in "
+        << "[0, 1]." << endl;
+
+  const double absError = CLI::GetParam<double>("abs_error");
+  if (absError < 0.0)
+    Log::Fatal << "Invalid --abs_error (-E) " << absError << "; must be "
+        << "non-negative." << endl;
+
+  KDEModel model;
+  if (CLI::HasParam("reference"))
+  {
+    const double bandwidth = CLI::GetParam<double>("bandwidth");
+    if (bandwidth <= 0.0)
+      Log::Fatal << "Invalid --bandwidth (-b) " << bandwidth << "; must be "
+          << "positive." << endl;
+
+    const string kernelType = CLI::GetParam<string>("kernel");
+    if (kernelType == "gaussian")
+      model.KernelType() = KDEModel::GAUSSIAN_KERNEL;
+    else if (kernelType == "epanechnikov")
+      model.KernelType() = KDEModel::EPANECHNIKOV_KERNEL;
+    else if (kernelType == "laplacian")
+      model.KernelType() = KDEModel::LAPLACIAN_KERNEL;
+    else if (kernelType == "spherical")
+      model.KernelType() = KDEModel::SPHERICAL_KERNEL;
+    else if (kernelType == "triangular")
+      model.KernelType() = KDEModel::TRIANGULAR_KERNEL;
+    else
+      Log::Fatal << "Invalid kernel type: '" << kernelType << "'; must be "
+          << "'gaussian', 'epanechnikov', 'laplacian', 'spherical', or "
+          << "'triangular'." << endl;
+
+    const string treeType = CLI::GetParam<string>("tree");
+    if (treeType == "kd-tree")
+      model.TreeType() = KDEModel::KD_TREE;
+    else if (treeType == "ball-tree")
+      model.TreeType() = KDEModel::BALL_TREE;
+    else if (treeType == "octree")
+      model.TreeType() = KDEModel::OCTREE;
+    else
+      Log::Fatal << "Invalid tree type: '" << treeType << "'; must be "
+          << "'kd-tree', 'ball-tree', or 'octree'." << endl;
+
+    model.Bandwidth() = bandwidth;
+    model.RelativeError() = relError;
+    model.AbsoluteError() = absError;
+
+    arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
+    Log::Info << "Loaded reference data (" << referenceSet.n_rows << " x "
+        << referenceSet.n_cols << ")." << endl;
+
+    model.BuildModel(std::move(referenceSet));
+  }
+  else
+  {
+    // Load model from file.
+    model = std::move(CLI::GetParam<KDEModel>("input_model"));
+    model.RelativeError() = relError;
+    model.AbsoluteError() = absError;
+  }
+
+  // Set evaluation preferences.
+  model.Naive() = CLI::HasParam("naive");
+  model.SingleMode() = CLI::HasParam("single_mode");
+
+  if (CLI::HasParam("predictions"))
+  {
+    arma::vec estimations;
+    if (CLI::HasParam("query"))
+    {
+      const arma::mat& querySet = CLI::GetParam<arma::mat>("query");
+      Log::Info << "Loaded query data (" << querySet.n_rows << " x "
+          << querySet.n_cols << ")." << endl;
+
+      model.Evaluate(querySet, estimations);
+    }
+    else
+    {
+      model.Evaluate(estimations);
+    }
+
+    CLI::GetParam<arma::vec>("predictions") = std::move(estimations);
+  }
+  else if (CLI::HasParam("query"))
+  {
+    Log::Warn << "--query_file (-q) ignored, because --predictions_file (-p) "
+        << "is not specified." << endl;
+  }
+
+  // Save the model, if requested.
+  if (CLI::HasParam("output_model"))
+    CLI::GetParam<KDEModel>("output_model") = std::move(model);
+
+  CLI::Destroy();
+}
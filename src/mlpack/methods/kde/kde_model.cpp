@@ -0,0 +1,228 @@
+/**
+ * @file kde_model.cpp
+ *
+ * Implementation of the kernel density estimation model class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "kde_model.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::kde;
+
+namespace {
+
+//! Make sure the error tolerances are valid, since they can be modified after
+//! the model is built.
+void CheckErrors(const double relError, const double absError)
+{
+  if (relError < 0.0 || relError > 1.0)
+  {
+    std::ostringstream oss;
+    oss << "KDEModel::Evaluate(): relative error tolerance (" << relError
+        << ") must be in [0, 1]";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (absError < 0.0)
+  {
+    std::ostringstream oss;
+    oss << "KDEModel::Evaluate(): absolute error tolerance (" << absError
+        << ") must be non-negative";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+} // anonymous namespace
+
+//! Save the reference set for training.
+TrainVisitor::TrainVisitor(arma::mat&& referenceSet) :
+    referenceSet(std::move(referenceSet))
+{}
+
+//! Save the parameters of the evaluation.
+EvaluateVisitor::EvaluateVisitor(const arma::mat* querySet,
+                                 arma::vec& estimations,
+                                 const double relError,
+                                 const double absError,
+                                 const bool naive,
+                                 const bool singleMode) :
+    querySet(querySet),
+    estimations(estimations),
+    relError(relError),
+    absError(absError),
+    naive(naive),
+    singleMode(singleMode)
+{}
+
+/**
+ * Initialize the KDEModel with the given parameters.
+ */
+KDEModel::KDEModel(const double bandwidth,
+                   const double relError,
+                   const double absError,
+                   const KernelTypes kernelType,
+                   const TreeTypes treeType) :
+    bandwidth(bandwidth),
+    relError(relError),
+    absError(absError),
+    naive(false),
+    singleMode(false),
+    kernelType(kernelType),
+    treeType(treeType)
+{
+  InitializeModel(false);
+}
+
+// Copy constructor.
+KDEModel::KDEModel(const KDEModel& other) :
+    bandwidth(other.bandwidth),
+    relError(other.relError),
+    absError(other.absError),
+    naive(other.naive),
+    singleMode(other.singleMode),
+    kernelType(other.kernelType),
+    treeType(other.treeType),
+    kdeModel(boost::apply_visitor(CopyVisitor<KDEVariant>(), other.kdeModel))
+{
+  // Nothing to do.
+}
+
+// Move constructor.
+KDEModel::KDEModel(KDEModel&& other) :
+    bandwidth(other.bandwidth),
+    relError(other.relError),
+    absError(other.absError),
+    naive(other.naive),
+    singleMode(other.singleMode),
+    kernelType(other.kernelType),
+    treeType(other.treeType),
+    kdeModel(other.kdeModel)
+{
+  // Reset other model.
+  other.kdeModel = KDEVariant();
+}
+
+// Copy operator.
+KDEModel& KDEModel::operator=(const KDEModel& other)
+{
+  if (this != &other)
+  {
+    KDEVariant copy = boost::apply_visitor(CopyVisitor<KDEVariant>(),
+        other.kdeModel);
+    boost::apply_visitor(DeleteVisitor(), kdeModel);
+
+    bandwidth = other.bandwidth;
+    relError = other.relError;
+    absError = other.absError;
+    naive = other.naive;
+    singleMode = other.singleMode;
+    kernelType = other.kernelType;
+    treeType = other.treeType;
+    kdeModel = copy;
+  }
+
+  return *this;
+}
+
+// Move operator.
+KDEModel& KDEModel::operator=(KDEModel&& other)
+{
+  if (this != &other)
+  {
+    boost::apply_visitor(DeleteVisitor(), kdeModel);
+
+    bandwidth = other.bandwidth;
+    relError = other.relError;
+    absError = other.absError;
+    naive = other.naive;
+    singleMode = other.singleMode;
+    kernelType = other.kernelType;
+    treeType = other.treeType;
+    kdeModel = other.kdeModel;
+
+    other.kdeModel = KDEVariant();
+  }
+
+  return *this;
+}
+
+// Clean memory.
+KDEModel::~KDEModel()
+{
+  boost::apply_visitor(DeleteVisitor(), kdeModel);
+}
+
+void KDEModel::BuildModel(arma::mat&& referenceSet)
+{
+  if (bandwidth <= 0.0)
+  {
+    std::ostringstream oss;
+    oss << "KDEModel::BuildModel(): bandwidth (" << bandwidth << ") must be "
+        << "positive";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Clean memory, if necessary.  The KDE constructor checks the error
+  // tolerances, so the model must not hold the deleted object if it throws.
+  boost::apply_visitor(DeleteVisitor(), kdeModel);
+  InitializeModel(false);
+  InitializeModel(true);
+
+  Log::Info << "Building reference tree..." << endl;
+  Timer::Start("tree_building");
+
+  TrainVisitor train(std::move(referenceSet));
+  boost::apply_visitor(train, kdeModel);
+
+  Timer::Stop("tree_building");
+  Log::Info << "Tree built." << endl;
+}
+
+void KDEModel::Evaluate(const arma::mat& querySet, arma::vec& estimations)
+{
+  CheckErrors(relError, absError);
+
+  Timer::Start("computing_kde");
+  EvaluateVisitor evaluate(&querySet, estimations, relError, absError, naive,
+      singleMode);
+  boost::apply_visitor(evaluate, kdeModel);
+  Timer::Stop("computing_kde");
+}
+
+void KDEModel::Evaluate(arma::vec& estimations)
+{
+  CheckErrors(relError, absError);
+
+  Timer::Start("computing_kde");
+  EvaluateVisitor evaluate(NULL, estimations, relError, absError, naive,
+      singleMode);
+  boost::apply_visitor(evaluate, kdeModel);
+  Timer::Stop("computing_kde");
+}
+
+void KDEModel::InitializeModel(const bool allocate)
+{
+  switch (kernelType)
+  {
+    case GAUSSIAN_KERNEL:
+      InitializeModel(kernel::GaussianKernel(bandwidth), allocate);
+      break;
+    case EPANECHNIKOV_KERNEL:
+      InitializeModel(kernel::EpanechnikovKernel(bandwidth), allocate);
+      break;
+    case LAPLACIAN_KERNEL:
+      InitializeModel(kernel::LaplacianKernel(bandwidth), allocate);
+      break;
+    case SPHERICAL_KERNEL:
+      InitializeModel(kernel::SphericalKernel(bandwidth), allocate);
+      break;
+    case TRIANGULAR_KERNEL:
+      InitializeModel(kernel::TriangularKernel(bandwidth), allocate);
+      break;
+  }
+}
@@ -0,0 +1,313 @@
+/**
+ * @file kde_model.hpp
+ *
+ * A model for kernel density estimation, which abstracts away the kernel and
+ * tree types, so that the mlpack_kde program can choose them at run time and
+ * serialize the result.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_MODEL_HPP
+#define MLPACK_METHODS_KDE_KDE_MODEL_HPP
+
+#include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/epanechnikov_kernel.hpp>
+#include <mlpack/core/kernels/laplacian_kernel.hpp>
+#include <mlpack/core/kernels/spherical_kernel.hpp>
+#include <mlpack/core/kernels/triangular_kernel.hpp>
+#include <boost/variant.hpp>
+#include "kde.hpp"
+
+namespace mlpack {
+namespace kde {
+
+/**
+ * Alias template for the KDE types used by KDEModel.
+ */
+template<typename KernelType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+using KDEType = KDE<KernelType, metric::EuclideanDistance, arma::mat, TreeType>;
+
+/**
+ * TrainVisitor builds the reference tree of the given KDEType on the reference
+ * set.
+ */
+class TrainVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The reference set to train on.
+  arma::mat&& referenceSet;
+
+ public:
+  //! Train the given KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+
+  //! Construct the TrainVisitor with the given reference set.
+  TrainVisitor(arma::mat&& referenceSet);
+};
+
+/**
+ * EvaluateVisitor sets the error tolerances and the search mode of the given
+ * KDEType and computes the estimates of the query points, or of the reference
+ * points if there is no query set.  The estimates are normalized with the
+ * normalization constant of the kernel, if it has one.
+ */
+class EvaluateVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The query set, or NULL to use the reference set.
+  const arma::mat* querySet;
+  //! The estimates.
+  arma::vec& estimations;
+  //! The relative error tolerance.
+  const double relError;
+  //! The absolute error tolerance.
+  const double absError;
+  //! Whether to use naive computation.
+  const bool naive;
+  //! Whether to use single-tree search.
+  const bool singleMode;
+
+ public:
+  //! Compute the estimates with the given KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+
+  //! Construct the EvaluateVisitor with the given parameters.
+  EvaluateVisitor(const arma::mat* querySet,
+                  arma::vec& estimations,
+                  const double relError,
+                  const double absError,
+                  const bool naive,
+                  const bool singleMode);
+};
+
+/**
+ * CopyVisitor returns a deep copy of the given KDEType, as the same alternative
+ * of the variant type V.
+ */
+template<typename V>
+class CopyVisitor : public boost::static_visitor<V>
+{
+ public:
+  //! Copy the given KDE object.
+  template<typename KDEType>
+  V operator()(const KDEType* kde) const;
+};
+
+/**
+ * DeleteVisitor deletes the given KDEType instance.
+ */
+class DeleteVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Delete the KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+};
+
+/**
+ * Exposes the Serialize() method of the given KDEType.
+ */
+template<typename Archive>
+class SerializeVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! Archive to serialize to.
+  Archive& ar;
+  //! Name of the model to serialize.
+  const std::string& name;
+
+ public:
+  //! Serialize the given model.
+  template<typename KDEType>
+  void operator()(KDEType*& kde) const;
+
+  //! Construct the SerializeVisitor with the given archive and name.
+  SerializeVisitor(Archive& ar, const std::string& name);
+};
+
+/**
+ * The KDEModel holds a KDE object with one of the supported kernels and trees,
+ * and reflects the KDE API.
+ */
+class KDEModel
+{
+ public:
+  //! The kernels supported by the model.
+  enum KernelTypes
+  {
+    GAUSSIAN_KERNEL,
+    EPANECHNIKOV_KERNEL,
+    LAPLACIAN_KERNEL,
+    SPHERICAL_KERNEL,
+    TRIANGULAR_KERNEL
+  };
+
+  //! The trees supported by the model.
+  enum TreeTypes
+  {
+    KD_TREE,
+    BALL_TREE,
+    OCTREE
+  };
+
+  /**
+   * Initialize the KDEModel with the given parameters.  The model must be built
+   * with BuildModel() before it is used.
+   *
+   * @param bandwidth Bandwidth of the kernel.
+   * @param relError Relative error tolerance of each estimate.
+   * @param absError Absolute error tolerance of each estimate.
+   * @param kernelType Type of kernel.
+   * @param treeType Type of tree.
+   */
+  KDEModel(const double bandwidth = 1.0,
+           const double relError = 0.05,
+           const double absError = 0.0,
+           const KernelTypes kernelType = GAUSSIAN_KERNEL,
+           const TreeTypes treeType = KD_TREE);
+
+  //! Copy the given model.
+  KDEModel(const KDEModel& other);
+
+  //! Take ownership of the contents of the given model.
+  KDEModel(KDEModel&& other);
+
+  //! Copy the given model.
+  KDEModel& operator=(const KDEModel& other);
+
+  //! Take ownership of the contents of the given model.
+  KDEModel& operator=(KDEModel&& other);
+
+  //! Clean memory, if necessary.
+  ~KDEModel();
+
+  /**
+   * Build the model with the current kernel and tree types on the given
+   * reference set.  A std::invalid_argument is thrown if the bandwidth is not
+   * positive or the error tolerances are invalid.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void BuildModel(arma::mat&& referenceSet);
+
+  /**
+   * Compute the estimates of the given query points.
+   *
+   * @param querySet Set of query points.
+   * @param estimations Vector to store the estimates in.
+   */
+  void Evaluate(const arma::mat& querySet, arma::vec& estimations);
+
+  /**
+   * Compute the estimates of the reference points.
+   *
+   * @param estimations Vector to store the estimates in.
+   */
+  void Evaluate(arma::vec& estimations);
+
+  //! Get the bandwidth of the kernel.
+  double Bandwidth() const { return bandwidth; }
+  //! Modify the bandwidth of the kernel (takes effect at BuildModel()).
+  double& Bandwidth() { return bandwidth; }
+
+  //! Get the relative error tolerance.
+  double RelativeError() const { return relError; }
+  //! Modify the relative error tolerance.
+  double& RelativeError() { return relError; }
+
+  //! Get the absolute error tolerance.
+  double AbsoluteError() const { return absError; }
+  //! Modify the absolute error tolerance.
+  double& AbsoluteError() { return absError; }
+
+  //! Get whether or not naive computation is used.
+  bool Naive() const { return naive; }
+  //! Modify whether or not naive computation is used.
+  bool& Naive() { return naive; }
+
+  //! Get whether or not single-tree search is used.
+  bool SingleMode() const { return singleMode; }
+  //! Modify whether or not single-tree search is used.
+  bool& SingleMode() { return singleMode; }
+
+  //! Get the kernel type.
+  KernelTypes KernelType() const { return kernelType; }
+  //! Modify the kernel type (takes effect at BuildModel()).
+  KernelTypes& KernelType() { return kernelType; }
+
+  //! Get the tree type.
+  TreeTypes TreeType() const { return treeType; }
+  //! Modify the tree type (takes effect at BuildModel()).
+  TreeTypes& TreeType() { return treeType; }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The bandwidth of the kernel.
+  double bandwidth;
+  //! The relative error tolerance.
+  double relError;
+  //! The absolute error tolerance.
+  double absError;
+  //! Whether to use naive computation.
+  bool naive;
+  //! Whether to use single-tree search.
+  bool singleMode;
+  //! The type of kernel.
+  KernelTypes kernelType;
+  //! The type of tree.
+  TreeTypes treeType;
+
+  /**
+   * kdeModel holds an instance of the KDE class for the current kernel and
+   * tree types, or NULL if the model has not been built.  It is accessed
+   * through the visitor classes defined above.
+   */
+  typedef boost::variant<KDEType<kernel::GaussianKernel, tree::KDTree>*,
+                         KDEType<kernel::GaussianKernel, tree::BallTree>*,
+                         KDEType<kernel::GaussianKernel, tree::Octree>*,
+                         KDEType<kernel::EpanechnikovKernel, tree::KDTree>*,
+                         KDEType<kernel::EpanechnikovKernel, tree::BallTree>*,
+                         KDEType<kernel::EpanechnikovKernel, tree::Octree>*,
+                         KDEType<kernel::LaplacianKernel, tree::KDTree>*,
+                         KDEType<kernel::LaplacianKernel, tree::BallTree>*,
+                         KDEType<kernel::LaplacianKernel, tree::Octree>*,
+                         KDEType<kernel::SphericalKernel, tree::KDTree>*,
+                         KDEType<kernel::SphericalKernel, tree::BallTree>*,
+                         KDEType<kernel::SphericalKernel, tree::Octree>*,
+                         KDEType<kernel::TriangularKernel, tree::KDTree>*,
+                         KDEType<kernel::TriangularKernel, tree::BallTree>*,
+                         KDEType<kernel::TriangularKernel, tree::Octree>*>
+      KDEVariant;
+  KDEVariant kdeModel;
+
+  /**
+   * Set kdeModel to an untrained KDE object (or a NULL pointer, if allocate is
+   * false) of the current kernel and tree types.
+   */
+  void InitializeModel(const bool allocate);
+
+  //! Set kdeModel to a KDE object with the given kernel and the current tree
+  //! type (or a NULL pointer of that type, if allocate is false).
+  template<typename TKernelType>
+  void InitializeModel(const TKernelType& kernel, const bool allocate);
+};
+
+} // namespace kde
+} // namespace mlpack
+
+#include "kde_model_impl.hpp"
+
+#endif
@@ -0,0 +1,172 @@
+/**
+ * @file kde_model_impl.hpp
+ *
+ * Implementation of the templated functions of KDEModel and its visitors.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_MODEL_IMPL_HPP
+#define MLPACK_METHODS_KDE_KDE_MODEL_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kde_model.hpp"
+
+namespace mlpack {
+namespace kde {
+
+namespace details {
+
+//! Kernels without a normalization constant are left unnormalized.
+template<typename KernelType>
+double KernelNormalizer(KernelType& /* kernel */,
+                        const size_t /* dimension */)
+{
+  return 1.0;
+}
+
+//! Get the normalization constant of the Gaussian kernel.
+inline double KernelNormalizer(kernel::GaussianKernel& kernel,
+                               const size_t dimension)
+{
+  return kernel.Normalizer(dimension);
+}
+
+//! Get the normalization constant of the Epanechnikov kernel.
+inline double KernelNormalizer(kernel::EpanechnikovKernel& kernel,
+                               const size_t dimension)
+{
+  return kernel.Normalizer(dimension);
+}
+
+//! Get the normalization constant of the spherical kernel.
+inline double KernelNormalizer(kernel::SphericalKernel& kernel,
+                               const size_t dimension)
+{
+  return kernel.Normalizer(dimension);
+}
+
+} // namespace details
+
+//! Train the given KDEType instance.
+template<typename KDEType>
+void TrainVisitor::operator()(KDEType* kde) const
+{
+  if (kde)
+    return kde->Train(std::move(referenceSet));
+  throw std::runtime_error("no KDE model initialized");
+}
+
+//! Compute the estimates with the given KDEType instance.
+template<typename KDEType>
+void EvaluateVisitor::operator()(KDEType* kde) const
+{
+  if (!kde)
+    throw std::runtime_error("no KDE model initialized");
+
+  kde->RelativeError() = relError;
+  kde->AbsoluteError() = absError;
+  kde->Naive() = naive;
+  kde->SingleMode() = !naive && singleMode; // Naive overrides single mode.
+
+  if (querySet)
+    kde->Evaluate(*querySet, estimations);
+  else
+    kde->Evaluate(estimations);
+
+  estimations /= details::KernelNormalizer(kde->Kernel(),
+      kde->ReferenceTree()->Dataset().n_rows);
+}
+
+//! Copy the given KDEType instance.
+template<typename V>
+template<typename KDEType>
+V CopyVisitor<V>::operator()(const KDEType* kde) const
+{
+  return V(kde ? new KDEType(*kde) : NULL);
+}
+
+//! Clean memory.
+template<typename KDEType>
+void DeleteVisitor::operator()(KDEType* kde) const
+{
+  if (kde)
+    delete kde;
+}
+
+//! Save parameters for serializing.
+template<typename Archive>
+SerializeVisitor<Archive>::SerializeVisitor(Archive& ar,
+                                            const std::string& name) :
+    ar(ar),
+    name(name)
+{}
+
+//! Serialize the given KDEType instance.
+template<typename Archive>
+template<typename KDEType>
+void SerializeVisitor<Archive>::operator()(KDEType*& kde) const
+{
+  ar & data::CreateNVP(kde, name);
+}
+
+template<typename TKernelType>
+void KDEModel::InitializeModel(const TKernelType& kernel, const bool allocate)
+{
+  switch (treeType)
+  {
+    case KD_TREE:
+      if (allocate)
+        kdeModel = new KDEType<TKernelType, tree::KDTree>(relError, absError,
+            kernel);
+      else
+        kdeModel = (KDEType<TKernelType, tree::KDTree>*) NULL;
+      break;
+    case BALL_TREE:
+      if (allocate)
+        kdeModel = new KDEType<TKernelType, tree::BallTree>(relError, absError,
+            kernel);
+      else
+        kdeModel = (KDEType<TKernelType, tree::BallTree>*) NULL;
+      break;
+    case OCTREE:
+      if (allocate)
+        kdeModel = new KDEType<TKernelType, tree::Octree>(relError, absError,
+            kernel);
+      else
+        kdeModel = (KDEType<TKernelType, tree::Octree>*) NULL;
+      break;
+  }
+}
+
+template<typename Archive>
+void KDEModel::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(bandwidth, "bandwidth");
+  ar & CreateNVP(relError, "relError");
+  ar & CreateNVP(absError, "absError");
+  ar & CreateNVP(naive, "naive");
+  ar & CreateNVP(singleMode, "singleMode");
+  ar & CreateNVP(kernelType, "kernelType");
+  ar & CreateNVP(treeType, "treeType");
+
+  // When loading, the variant must hold a pointer of the type being loaded.
+  if (Archive::is_loading::value)
+  {
+    boost::apply_visitor(DeleteVisitor(), kdeModel);
+    InitializeModel(false);
+  }
+
+  const std::string name = "kde_model";
+  SerializeVisitor<Archive> s(ar, name);
+  boost::apply_visitor(s, kdeModel);
+}
+
+} // namespace kde
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * @file kde_rules.hpp
+ *
+ * Rules for the single-tree and dual-tree kernel density estimation traversals.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_RULES_HPP
+#define MLPACK_METHODS_KDE_KDE_RULES_HPP
+
+#include <mlpack/core/tree/traversal_info.hpp>
+
+namespace mlpack {
+namespace kde {
+
+/**
+ * The rules of the kernel density estimation traversals.  The sums of the
+ * kernels between each query point and the reference points are accumulated
+ * into the given vector.  A reference node whose kernel bounds with a query
+ * point or node are tight enough for the error tolerances is pruned, and each
+ * of its points contributes the midpoint of the bounds.  The rules only write
+ * to the sums of the query points they are given, so copies of the rules can
+ * traverse disjoint query points or subtrees in parallel.
+ */
+template<typename MetricType, typename KernelType, typename TreeType>
+class KDERules
+{
+ public:
+  /**
+   * Construct the rules.
+   *
+   * @param referenceSet Set of reference points.
+   * @param querySet Set of query points.
+   * @param sums Sums of the kernels of each query point (to be added to).
+   * @param relError Relative error tolerance.
+   * @param absError Absolute error tolerance (per reference point).
+   * @param metric Instantiated metric.
+   * @param kernel Instantiated kernel.
+   */
+  KDERules(const typename TreeType::Mat& referenceSet,
+           const typename TreeType::Mat& querySet,
+           arma::vec& sums,
+           const double relError,
+           const double absError,
+           MetricType& metric,
+           const KernelType& kernel);
+
+  //! Add the kernel between the given query and reference points.
+  double BaseCase(const size_t queryIndex, const size_t referenceIndex);
+
+  /**
+   * Get the score for recursion order, or prune the reference node (and return
+   * DBL_MAX) if its points can be approximated for the given query point.
+   */
+  double Score(const size_t queryIndex, TreeType& referenceNode);
+
+  /**
+   * Get the score for recursion order, or prune the reference node (and return
+   * DBL_MAX) if its points can be approximated for every query point of the
+   * query node.
+   */
+  double Score(TreeType& queryNode, TreeType& referenceNode);
+
+  //! The bounds don't change during the traversal, so nothing is rescored.
+  double Rescore(const size_t /* queryIndex */,
+                 TreeType& /* referenceNode */,
+                 const double oldScore) const { return oldScore; }
+
+  //! The bounds don't change during the traversal, so nothing is rescored.
+  double Rescore(TreeType& /* queryNode */,
+                 TreeType& /* referenceNode */,
+                 const double oldScore) const { return oldScore; }
+
+  typedef typename tree::TraversalInfo<TreeType> TraversalInfoType;
+
+  //! Get the traversal info.
+  const TraversalInfoType& TraversalInfo() const { return traversalInfo; }
+  //! Modify the traversal info.
+  TraversalInfoType& TraversalInfo() { return traversalInfo; }
+
+  //! Get the number of base cases.
+  size_t BaseCases() const { return baseCases; }
+  //! Get the number of scores.
+  size_t Scores() const { return scores; }
+
+ private:
+  //! The reference set.
+  const typename TreeType::Mat& referenceSet;
+  //! The query set.
+  const typename TreeType::Mat& querySet;
+  //! The sums of the kernels of each query point.
+  arma::vec& sums;
+  //! The relative error tolerance.
+  const double relError;
+  //! The absolute error tolerance.
+  const double absError;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! The instantiated kernel.
+  const KernelType& kernel;
+
+  //! The number of base cases.
+  size_t baseCases;
+  //! The number of scores.
+  size_t scores;
+
+  //! Traversal info (unused, but required by the traversers).
+  TraversalInfoType traversalInfo;
+
+  /**
+   * Get the contribution of each point of a reference node with the given
+   * range of distances, if the kernel bounds are tight enough, or a negative
+   * value otherwise.
+   */
+  double Approximation(const math::Range& distances) const;
+};
+
+} // namespace kde
+} // namespace mlpack
+
+// Include implementation.
+#include "kde_rules_impl.hpp"
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file kde_rules_impl.hpp
+ *
+ * Implementation of the rules of the kernel density estimation traversals.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_RULES_IMPL_HPP
+#define MLPACK_METHODS_KDE_KDE_RULES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kde_rules.hpp"
+
+namespace mlpack {
+namespace kde {
+
+template<typename MetricType, typename KernelType, typename TreeType>
+KDERules<MetricType, KernelType, TreeType>::KDERules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
+    arma::vec& sums,
+    const double relError,
+    const double absError,
+    MetricType& metric,
+    const KernelType& kernel) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    sums(sums),
+    relError(relError),
+    absError(absError),
+    metric(metric),
+    kernel(kernel),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline force_inline
+double KDERules<MetricType, KernelType, TreeType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceIndex)
+{
+  const double distance = metric.Evaluate(querySet.col(queryIndex),
+      referenceSet.col(referenceIndex));
+  sums[queryIndex] += kernel.Evaluate(distance);
+  ++baseCases;
+
+  return distance;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline double KDERules<MetricType, KernelType, TreeType>::Score(
+    const size_t queryIndex,
+    TreeType& referenceNode)
+{
+  const math::Range distances =
+      referenceNode.RangeDistance(querySet.col(queryIndex));
+  ++scores;
+
+  const double approximation = Approximation(distances);
+  if (approximation < 0.0)
+    return distances.Lo();
+
+  sums[queryIndex] += referenceNode.NumDescendants() * approximation;
+  return DBL_MAX;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline double KDERules<MetricType, KernelType, TreeType>::Score(
+    TreeType& queryNode,
+    TreeType& referenceNode)
+{
+  const math::Range distances = queryNode.RangeDistance(referenceNode);
+  ++scores;
+
+  const double approximation = Approximation(distances);
+  if (approximation < 0.0)
+    return distances.Lo();
+
+  // Every query point of the node gets the same contribution.
+  const double contribution = referenceNode.NumDescendants() * approximation;
+  for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
+    sums[queryNode.Descendant(i)] += contribution;
+
+  return DBL_MAX;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline double KDERules<MetricType, KernelType, TreeType>::Approximation(
+    const math::Range& distances) const
+{
+  // The kernel decreases with the distance, so it is largest at the minimum
+  // distance and smallest at the maximum distance.  Using the midpoint of the
+  // bounds for every point makes an error of at most half their difference.
+  const double maxKernel = kernel.Evaluate(distances.Lo());
+  const double minKernel = kernel.Evaluate(distances.Hi());
+  if (maxKernel - minKernel <= 2.0 * (relError * minKernel + absError))
+    return (maxKernel + minKernel) / 2.0;
+
+  return -1.0;
+}
+
+} // namespace kde
+} // namespace mlpack
+
+#endif
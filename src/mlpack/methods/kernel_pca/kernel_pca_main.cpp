@@ -29,6 +29,8 @@
 #include <mlpack/methods/nystroem_method/kmeans_selection.hpp>
 #include <mlpack/methods/nystroem_method/nystroem_method.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/random_fourier_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/randomized_method.hpp>
 
 #include "kernel_pca.hpp"
 
@@ -87,7 +89,19 @@ PROGRAM_INFO("Kernel Principal Components Analysis",
     " a subset of the data as basis to reconstruct the kernel matrix; to "
     "specify the sampling scheme, the --sampling parameter is used, the "
     "sampling scheme for the nystr\u00F6m method can be chosen from the "
-    "following list: kmeans, random, ordered.");
+    "following list: kmeans, random, ordered."
+    "\n\n"
+    "For large datasets, the --randomized_method (-r) option computes only the "
+    "leading --new_dimensionality eigenvectors with a randomized eigensolver "
+    "that never stores the kernel matrix; the kernel is evaluated on the fly, "
+    "in parallel, so the memory used grows linearly with the number of points "
+    "instead of quadratically."
+    "\n\n"
+    "For the 'gaussian' and 'laplacian' kernels, the --fourier_method (-F) "
+    "option instead performs ordinary PCA on random Fourier features of the "
+    "points (\"Random Features for Large-Scale Kernel Machines\", 2007), "
+    "which approximate the kernel; this takes time and memory linear in the "
+    "number of points.");
 
 PARAM_MATRIX_IN_REQ("input", "Input dataset to perform KPCA on.", "i");
 PARAM_MATRIX_OUT("output", "Matrix to save modified dataset to.", "o");
@@ -102,6 +116,10 @@ PARAM_FLAG("center", "If set, the transformed data will be centered about the "
     "origin.", "c");
 
 PARAM_FLAG("nystroem_method", "If set, the nystroem method will be used.", "n");
+PARAM_FLAG("randomized_method", "If set, the matrix-free randomized "
+    "eigensolver will be used.", "r");
+PARAM_FLAG("fourier_method", "If set, random Fourier features will be used "
+    "to approximate the kernel ('gaussian' and 'laplacian' only).", "F");
 
 PARAM_STRING_IN("sampling", "Sampling scheme to use for the nystroem method: "
     "'kmeans', 'random', 'ordered'", "s", "kmeans");
@@ -114,11 +132,42 @@ PARAM_DOUBLE_IN("bandwidth", "Bandwidth, for 'gaussian' and 'laplacian' "
 PARAM_DOUBLE_IN("degree", "Degree of polynomial, for 'polynomial' kernel.", "D",
     1.0);
 
+//! Run KPCA with random Fourier features, for the kernels that support them.
+template<typename KernelType>
+void RunFourierKPCA(
+    arma::mat& dataset,
+    const bool centerTransformedData,
+    const size_t newDim,
+    KernelType& kernel,
+    const typename std::enable_if<
+        HasFourierFeatures<KernelType>::value>::type* = 0)
+{
+  KernelPCA<KernelType, RandomFourierKernelRule<KernelType> > kpca(kernel,
+      centerTransformedData);
+  kpca.Apply(dataset, newDim);
+}
+
+//! The other kernels have no random Fourier features.
+template<typename KernelType>
+void RunFourierKPCA(
+    arma::mat& /* dataset */,
+    const bool /* centerTransformedData */,
+    const size_t /* newDim */,
+    KernelType& /* kernel */,
+    const typename std::enable_if<
+        !HasFourierFeatures<KernelType>::value>::type* = 0)
+{
+  Log::Fatal << "--fourier_method (-F) can only be used with the 'gaussian' "
+      << "and 'laplacian' kernels!" << endl;
+}
+
 //! Run RunKPCA on the specified dataset for the given kernel type.
 template<typename KernelType>
 void RunKPCA(arma::mat& dataset,
              const bool centerTransformedData,
              const bool nystroem,
+             const bool randomized,
+             const bool fourier,
              const size_t newDim,
              const string& sampling,
              KernelType& kernel)
@@ -151,6 +200,16 @@ void RunKPCA(arma::mat& dataset,
         << "choices are 'kmeans', 'random' and 'ordered'" << endl;
     }
   }
+  else if (randomized)
+  {
+    KernelPCA<KernelType, RandomizedKernelRule<KernelType> > kpca(kernel,
+        centerTransformedData);
+    kpca.Apply(dataset, newDim);
+  }
+  else if (fourier)
+  {
+    RunFourierKPCA(dataset, centerTransformedData, newDim, kernel);
+  }
   else
   {
     KernelPCA<KernelType> kpca(kernel, centerTransformedData);
@@ -189,21 +248,28 @@ int main(int argc, char** argv)
 
   const bool centerTransformedData = CLI::HasParam("center");
   const bool nystroem = CLI::HasParam("nystroem_method");
+  const bool randomized = CLI::HasParam("randomized_method");
+  const bool fourier = CLI::HasParam("fourier_method");
+  if ((int) nystroem + (int) randomized + (int) fourier > 1)
+  {
+    Log::Fatal << "Only one of --nystroem_method (-n), --randomized_method "
+        << "(-r), and --fourier_method (-F) may be specified!" << endl;
+  }
   const string sampling = CLI::GetParam<string>("sampling");
 
   if (kernelType == "linear")
   {
     LinearKernel kernel;
-    RunKPCA<LinearKernel>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<LinearKernel>(dataset, centerTransformedData, nystroem,
+        randomized, fourier, newDim, sampling, kernel);
   }
   else if (kernelType == "gaussian")
   {
     const double bandwidth = CLI::GetParam<double>("bandwidth");
 
     GaussianKernel kernel(bandwidth);
-    RunKPCA<GaussianKernel>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<GaussianKernel>(dataset, centerTransformedData, nystroem,
+        randomized, fourier, newDim, sampling, kernel);
   }
   else if (kernelType == "polynomial")
   {
@@ -212,7 +278,7 @@ int main(int argc, char** argv)
 
     PolynomialKernel kernel(degree, offset);
     RunKPCA<PolynomialKernel>(dataset, centerTransformedData, nystroem,
-        newDim, sampling, kernel);
+        randomized, fourier, newDim, sampling, kernel);
   }
   else if (kernelType == "hyptan")
   {
@@ -221,15 +287,15 @@ int main(int argc, char** argv)
 
     HyperbolicTangentKernel kernel(scale, offset);
     RunKPCA<HyperbolicTangentKernel>(dataset, centerTransformedData, nystroem,
-        newDim, sampling, kernel);
+        randomized, fourier, newDim, sampling, kernel);
   }
   else if (kernelType == "laplacian")
   {
     const double bandwidth = CLI::GetParam<double>("bandwidth");
 
     LaplacianKernel kernel(bandwidth);
-    RunKPCA<LaplacianKernel>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<LaplacianKernel>(dataset, centerTransformedData, nystroem,
+        randomized, fourier, newDim, sampling, kernel);
   }
   else if (kernelType == "epanechnikov")
   {
@@ -237,13 +303,13 @@ int main(int argc, char** argv)
 
     EpanechnikovKernel kernel(bandwidth);
     RunKPCA<EpanechnikovKernel>(dataset, centerTransformedData, nystroem,
-        newDim, sampling, kernel);
+        randomized, fourier, newDim, sampling, kernel);
   }
   else if (kernelType == "cosine")
   {
     CosineDistance kernel;
-    RunKPCA<CosineDistance>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<CosineDistance>(dataset, centerTransformedData, nystroem,
+        randomized, fourier, newDim, sampling, kernel);
   }
   else
   {
@@ -0,0 +1,166 @@
+/**
+ * @file random_fourier_method.hpp
+ *
+ * Use random Fourier features to compute kernel principal components in time
+ * linear in the number of points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+
+#ifndef MLPACK_METHODS_KERNEL_PCA_RANDOM_FOURIER_METHOD_HPP
+#define MLPACK_METHODS_KERNEL_PCA_RANDOM_FOURIER_METHOD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/random_fourier_features.hpp>
+
+namespace mlpack {
+namespace kpca {
+
+/**
+ * Approximate kernel PCA for shift-invariant kernels by ordinary PCA on
+ * NumFeatures random Fourier features of the points (see
+ * kernel::RandomFourierFeatures).  The features are computed for BlockSize
+ * points at a time, in parallel with OpenMP, and only their mean and their
+ * NumFeatures x NumFeatures covariance are accumulated, so neither the kernel
+ * matrix nor the features of all points are ever stored; the features are
+ * computed again to project the points.  The cost is O(n d D + n D^2) time and
+ * O(D^2 + rank n) memory for n points of dimensionality d and D features.
+ *
+ * The eigenvalues are those of the centered kernel matrix approximated by the
+ * features, and the eigenvectors are returned in the feature space (one
+ * column of NumFeatures elements per component).
+ *
+ * @tparam KernelType Shift-invariant kernel to be used for computation.
+ * @tparam NumFeatures Number of random Fourier features.
+ * @tparam BlockSize Number of points whose features are computed at once.
+ */
+template<
+  typename KernelType,
+  size_t NumFeatures = 1024,
+  size_t BlockSize = 4096
+>
+class RandomFourierKernelRule
+{
+ public:
+  /**
+   * Compute the leading kernel principal components with random Fourier
+   * features.
+   *
+   * @param data Input data points.
+   * @param transformedData Matrix to output results into.
+   * @param eigval KPCA eigenvalues will be written to this vector.
+   * @param eigvec KPCA eigenvectors will be written to this matrix.
+   * @param rank Number of components to compute.
+   * @param kernel Kernel to be used for computation.
+   */
+  static void ApplyKernelMatrix(const arma::mat& data,
+                                arma::mat& transformedData,
+                                arma::vec& eigval,
+                                arma::mat& eigvec,
+                                const size_t rank,
+                                KernelType kernel = KernelType())
+  {
+    const size_t n = data.n_cols;
+    const size_t k = (rank == 0 || rank > NumFeatures) ? NumFeatures : rank;
+    const kernel::RandomFourierFeatures<KernelType> features(data.n_rows,
+        NumFeatures, kernel);
+    const size_t numBlocks = (n + BlockSize - 1) / BlockSize;
+
+    // Each thread accumulates the sums of its blocks; these are added in
+    // thread order afterwards, so the result only depends on the number of
+    // threads.
+#ifdef HAS_OPENMP
+    const size_t numThreads = omp_get_max_threads();
+#else
+    const size_t numThreads = 1;
+#endif
+    std::vector<arma::vec> threadSums(numThreads);
+    std::vector<arma::mat> threadProducts(numThreads);
+
+    #pragma omp parallel
+    {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+      threadSums[thread].zeros(NumFeatures);
+      threadProducts[thread].zeros(NumFeatures, NumFeatures);
+      arma::mat block;
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables.
+      #pragma omp for schedule(static)
+      for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+      #pragma omp for schedule(static)
+      for (size_t b = 0; b < numBlocks; ++b)
+#endif
+      {
+        const size_t begin = (size_t) b * BlockSize;
+        const size_t end = std::min(begin + BlockSize, n);
+        features.Transform(data.cols(begin, end - 1), block);
+
+        threadSums[thread] += arma::sum(block, 1);
+        threadProducts[thread] += block * block.t();
+      }
+    }
+
+    arma::vec mean(NumFeatures, arma::fill::zeros);
+    arma::mat covariance(NumFeatures, NumFeatures, arma::fill::zeros);
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+      // A thread may not have run, if the runtime gave us fewer threads.
+      if (threadSums[t].n_elem == 0)
+        continue;
+
+      mean += threadSums[t];
+      covariance += threadProducts[t];
+    }
+    mean /= n;
+
+    // The centered kernel matrix Z^T Z and the scatter matrix Z Z^T of the
+    // centered features have the same nonzero eigenvalues.
+    covariance -= n * mean * mean.t();
+    covariance = 0.5 * (covariance + covariance.t());
+
+    arma::vec allEigval;
+    arma::mat allEigvec;
+    arma::eig_sym(allEigval, allEigvec, covariance);
+
+    // The eigenvalues are in ascending order; keep the k largest, from largest
+    // to smallest.
+    eigval = arma::flipud(allEigval.tail(k));
+    eigvec = arma::fliplr(allEigvec.tail_cols(k));
+
+    // Project the centered features of each block onto the components.  The
+    // data may be the output matrix too, so it is only replaced at the end.
+    arma::mat projections(k, n);
+#ifdef _WIN32
+    #pragma omp parallel for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = (size_t) b * BlockSize;
+      const size_t end = std::min(begin + BlockSize, n);
+      arma::mat block;
+      features.Transform(data.cols(begin, end - 1), block);
+      block.each_col() -= mean;
+      projections.cols(begin, end - 1) = eigvec.t() * block;
+    }
+
+    transformedData = std::move(projections);
+  }
+};
+
+} // namespace kpca
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,165 @@
+/**
+ * @file randomized_method.hpp
+ *
+ * Use a randomized eigensolver that never forms the kernel matrix to compute
+ * the leading kernel principal components.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+
+#ifndef MLPACK_METHODS_KERNEL_PCA_RANDOMIZED_METHOD_HPP
+#define MLPACK_METHODS_KERNEL_PCA_RANDOMIZED_METHOD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+
+namespace mlpack {
+namespace kpca {
+
+/**
+ * Compute the leading eigenpairs of the centered kernel matrix with randomized
+ * subspace iteration ("Finding structure with randomness: Probabilistic
+ * algorithms for constructing approximate matrix decompositions", Halko et
+ * al., 2011).  The kernel matrix is never stored: every product of the
+ * centered kernel matrix with a block of vectors evaluates the kernel on the
+ * fly, in tiles of TileSize x TileSize points that are processed in parallel
+ * with OpenMP, and the centering is applied to the block of vectors instead of
+ * to the kernel matrix.  So, the memory used is O(n * (rank + Oversampling))
+ * instead of O(n^2), at the cost of (2 * PowerIterations + 2) passes of kernel
+ * evaluations over all pairs of points.
+ *
+ * Only the rank largest eigenvalues (and their eigenvectors) are returned.
+ *
+ * @tparam KernelType Kernel to be used for computation.
+ * @tparam Oversampling Number of extra vectors used in the subspace iteration.
+ * @tparam PowerIterations Number of power iterations.
+ * @tparam TileSize Number of points in each side of a tile.
+ */
+template<
+  typename KernelType,
+  size_t Oversampling = 10,
+  size_t PowerIterations = 2,
+  size_t TileSize = 256
+>
+class RandomizedKernelRule
+{
+ public:
+  /**
+   * Compute the leading eigenpairs of the centered kernel matrix without
+   * constructing it.
+   *
+   * @param data Input data points.
+   * @param transformedData Matrix to output results into.
+   * @param eigval KPCA eigenvalues will be written to this vector.
+   * @param eigvec KPCA eigenvectors will be written to this matrix.
+   * @param rank Number of eigenpairs to compute.
+   * @param kernel Kernel to be used for computation.
+   */
+  static void ApplyKernelMatrix(const arma::mat& data,
+                                arma::mat& transformedData,
+                                arma::vec& eigval,
+                                arma::mat& eigvec,
+                                const size_t rank,
+                                KernelType kernel = KernelType())
+  {
+    const size_t n = data.n_cols;
+    const size_t k = (rank == 0 || rank > n) ? n : rank;
+    const size_t l = std::min(k + Oversampling, n);
+
+    // Find an orthonormal basis of the range of the centered kernel matrix,
+    // using power iterations to make the leading eigenvectors stand out.
+    arma::mat q, r, y;
+    arma::mat omega(n, l, arma::fill::randn);
+    CenteredKernelProduct(data, kernel, omega, y);
+    for (size_t i = 0; i < PowerIterations; ++i)
+    {
+      arma::qr_econ(q, r, y);
+      CenteredKernelProduct(data, kernel, q, y);
+    }
+    arma::qr_econ(q, r, y);
+
+    // Project the centered kernel matrix onto the basis and eigendecompose the
+    // small projected matrix.
+    arma::mat z;
+    CenteredKernelProduct(data, kernel, q, z);
+    arma::mat projected = q.t() * z;
+    projected = 0.5 * (projected + projected.t());
+
+    arma::vec smallEigval;
+    arma::mat smallEigvec;
+    arma::eig_sym(smallEigval, smallEigvec, projected);
+
+    // The eigenvalues are in ascending order; keep the k largest, from largest
+    // to smallest.
+    smallEigval = arma::flipud(smallEigval);
+    smallEigvec = arma::fliplr(smallEigvec);
+    eigval = smallEigval.subvec(0, k - 1);
+    smallEigvec = smallEigvec.cols(0, k - 1);
+
+    eigvec = q * smallEigvec;
+
+    // The centered kernel matrix times the eigenvectors is z * smallEigvec, so
+    // no more kernel evaluations are needed.
+    transformedData = (z * smallEigvec).t();
+    transformedData.each_col() /= arma::sqrt(eigval);
+  }
+
+ private:
+  /**
+   * Compute result = H * K * H * vectors, where K is the kernel matrix of the
+   * data and H = I - 1 1^T / n is the centering matrix.  Each thread computes
+   * the rows of K * (H * vectors) that belong to one tile of points, one tile
+   * of kernel evaluations at a time.
+   */
+  static void CenteredKernelProduct(const arma::mat& data,
+                                    KernelType& kernel,
+                                    const arma::mat& vectors,
+                                    arma::mat& result)
+  {
+    const size_t n = data.n_cols;
+    const size_t numTiles = (n + TileSize - 1) / TileSize;
+
+    arma::mat centered = vectors;
+    centered.each_row() -= arma::mean(centered, 0);
+
+    result.zeros(n, vectors.n_cols);
+
+    // The tiles of points are independent, so they are processed in parallel.
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t t = 0; t < (intmax_t) numTiles; ++t)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t t = 0; t < numTiles; ++t)
+#endif
+    {
+      const size_t begin = (size_t) t * TileSize;
+      const size_t end = std::min(begin + TileSize, n);
+      const arma::mat tile = data.cols(begin, end - 1);
+      arma::mat block;
+
+      for (size_t cBegin = 0; cBegin < n; cBegin += TileSize)
+      {
+        const size_t cEnd = std::min(cBegin + TileSize, n);
+        kernel::KernelMatrix(kernel, tile,
+            arma::mat(data.cols(cBegin, cEnd - 1)), block);
+
+        result.rows(begin, end - 1) += block *
+            centered.rows(cBegin, cEnd - 1);
+      }
+    }
+
+    result.each_row() -= arma::mean(result, 0);
+  }
+};
+
+} // namespace kpca
+} // namespace mlpack
+
+#endif
@@ -30,6 +30,9 @@ namespace kmeans {
  * dataset.  The conditions under which this will perform best are probably
  * limited to the case where k is close to the number of points in the dataset,
  * and the number of iterations of the k-means algorithm will be few.
+ *
+ * Between iterations, the bounds of the children of large nodes of the tree are
+ * updated by separate OpenMP tasks.
  */
 template<
     typename MetricType,
@@ -97,8 +100,10 @@ class DualTreeKMeans
   arma::vec upperBounds;
   //! Lower bounds on second closest cluster distance for each point.
   arma::vec lowerBounds;
-  //! Indicator of whether or not the point is pruned.
-  std::vector<bool> prunedPoints;
+  //! Indicator of whether or not the point is pruned.  This is not a
+  //! std::vector<bool>, so that the points of different nodes can be updated
+  //! at the same time.
+  std::vector<char> prunedPoints;
 
   arma::Row<size_t> assignments;
 
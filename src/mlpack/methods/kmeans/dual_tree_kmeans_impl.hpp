@@ -136,7 +136,12 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
 
     Timer::Stop("knn");
 
-    UpdateTree(*tree, centroids);
+    // The children of large nodes are updated by separate tasks.
+    #pragma omp parallel if (dataset.n_cols >= 4096)
+    {
+      #pragma omp single
+      UpdateTree(*tree, centroids);
+    }
 
     for (size_t i = 0; i < dataset.n_cols; ++i)
       visited[i] = false;
@@ -328,6 +333,7 @@ visited[node.Descendant(i)] << ".\n";
                    node.MaxDistance(centroids.col(node.Stat().Owner())));
       adjustedUpperBound = node.Stat().UpperBound();
 
+      #pragma omp atomic
       ++distanceCalculations;
       if (node.Stat().UpperBound() < node.Stat().LowerBound())
         node.Stat().StaticPruned() = true;
@@ -339,12 +345,26 @@ visited[node.Descendant(i)] << ".\n";
   }
 
   // Recurse into children, and if all the children (and all the points) are
-  // pruned, then we can mark this as statically pruned.
-  bool allChildrenPruned = true;
+  // pruned, then we can mark this as statically pruned.  The children hold
+  // disjoint sets of points, so large children are updated by separate tasks.
+  // Visual Studio only implements OpenMP 2.0, which has no tasks, so there the
+  // children are updated one after the other.
   for (size_t i = 0; i < node.NumChildren(); ++i)
   {
+#ifndef _WIN32
+    #pragma omp task default(shared) firstprivate(i) \
+        if (node.Child(i).NumDescendants() >= 1024)
+#endif
     UpdateTree(node.Child(i), centroids, unadjustedUpperBound,
         adjustedUpperBound, unadjustedLowerBound, adjustedLowerBound);
+  }
+#ifndef _WIN32
+  #pragma omp taskwait
+#endif
+
+  bool allChildrenPruned = true;
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
     if (!node.Child(i).Stat().StaticPruned())
       allChildrenPruned = false;
   }
@@ -400,6 +420,7 @@ visited[node.Descendant(i)] << ".\n";
         // Attempt to tighten the bound.
         upperBounds[index] = metric.Evaluate(dataset.col(index),
                                              centroids.col(owner));
+        #pragma omp atomic
         ++distanceCalculations;
         if (upperBounds[index] < pruningLowerBound)
         {
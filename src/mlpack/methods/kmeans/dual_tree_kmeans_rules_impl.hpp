@@ -25,7 +25,7 @@ DualTreeKMeansRules<MetricType, TreeType>::DualTreeKMeansRules(
     arma::vec& upperBounds,
     arma::vec& lowerBounds,
     MetricType& metric,
-    const std::vector<bool>& prunedPoints,
+    const std::vector<char>& prunedPoints,
     const std::vector<size_t>& oldFromNewCentroids,
     std::vector<bool>& visited) :
     centroids(centroids),
@@ -46,9 +46,6 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // being the closest cluster centroid.
   clusterDistances.diag().fill(DBL_MAX);
 
-  // Initially set r(x) to true.
-  std::vector<bool> mustRecalculate(dataset.n_cols, true);
-
   // If this is the first iteration, we must reset all the bounds.
   if (lowerBounds.n_rows != centroids.n_cols)
   {
@@ -63,13 +60,24 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
 
   // Step 1: for all centers, compute between-cluster distances.  For all
   // centers, compute s(c) = 1/2 min d(c, c').
+  size_t iterationDistances = 0;
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:iterationDistances)
+  for (intmax_t i = 0; i < (intmax_t) centroids.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:iterationDistances)
   for (size_t i = 0; i < centroids.n_cols; ++i)
+#endif
   {
     for (size_t j = i + 1; j < centroids.n_cols; ++j)
     {
       const double distance = metric.Evaluate(centroids.col(i),
                                               centroids.col(j));
-      distanceCalculations++;
+      iterationDistances++;
       clusterDistances(i, j) = distance;
       clusterDistances(j, i) = distance;
     }
@@ -79,23 +87,53 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // that this is equivalent to s(c) for each cluster c.
   minClusterDistances = 0.5 * arma::min(clusterDistances).t();
 
-  // Now loop over all points, and see which ones need to be updated.
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  // Each thread accumulates the points it assigns into its own partial
+  // centroids; these are summed in thread order afterwards, so the result only
+  // depends on the number of threads.
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+  std::vector<arma::mat> threadCentroids(numThreads);
+  std::vector<arma::Col<size_t>> threadCounts(numThreads);
+
+  #pragma omp parallel reduction(+:iterationDistances)
   {
-    // Step 2: identify all points such that u(x) <= s(c(x)).
-    if (upperBounds(i) <= minClusterDistances(assignments[i]))
-    {
-      // No change needed.  This point must still belong to that cluster.
-      counts(assignments[i])++;
-      newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
-      continue;
-    }
-    else
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localCentroids = threadCentroids[thread];
+    arma::Col<size_t>& localCounts = threadCounts[thread];
+    localCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    localCounts.zeros(centroids.n_cols);
+
+    // Now loop over all points, and see which ones need to be updated.
+#ifdef _WIN32
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
     {
+      // Step 2: identify all points such that u(x) <= s(c(x)).
+      if (upperBounds(i) <= minClusterDistances(assignments[i]))
+      {
+        // No change needed.  This point must still belong to that cluster.
+        localCounts(assignments[i])++;
+        localCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+        continue;
+      }
+
+      // Initially set r(x) to true.
+      bool mustRecalculate = true;
       for (size_t c = 0; c < centroids.n_cols; ++c)
       {
-        // Step 3: for all remaining points x and centers c such that c != c(x),
-        // u(x) > l(x, c) and u(x) > 0.5 d(c(x), c)...
+        // Step 3: for all remaining points x and centers c such that
+        // c != c(x), u(x) > l(x, c) and u(x) > 0.5 d(c(x), c)...
         if (assignments[i] == c)
           continue; // Pruned because this cluster is already the assignment.
 
@@ -108,13 +146,13 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
         // Step 3a: if r(x) then compute d(x, c(x)) and assign r(x) = false.
         // Otherwise, d(x, c(x)) = u(x).
         double dist;
-        if (mustRecalculate[i])
+        if (mustRecalculate)
         {
-          mustRecalculate[i] = false;
+          mustRecalculate = false;
           dist = metric.Evaluate(dataset.col(i), centroids.col(assignments[i]));
           lowerBounds(assignments[i], i) = dist;
           upperBounds(i) = dist;
-          distanceCalculations++;
+          iterationDistances++;
 
           // Check if we can prune again.
           if (upperBounds(i) <= lowerBounds(c, i))
@@ -136,7 +174,7 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
           const double pointDist = metric.Evaluate(dataset.col(i),
                                                    centroids.col(c));
           lowerBounds(c, i) = pointDist;
-          distanceCalculations++;
+          iterationDistances++;
           if (pointDist < dist)
           {
             upperBounds(i) = pointDist;
@@ -144,14 +182,25 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
           }
         }
       }
+
+      // At this point, we know the new cluster assignment.
+      // Step 4: for each center c, let m(c) be the mean of the points assigned
+      // to c.
+      localCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+      localCounts[assignments[i]]++;
     }
+  }
 
-    // At this point, we know the new cluster assignment.
-    // Step 4: for each center c, let m(c) be the mean of the points assigned to
-    // c.
-    newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
-    counts[assignments[i]]++;
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    // A thread may not have run, if the runtime gave us fewer threads.
+    if (threadCounts[t].n_elem == 0)
+      continue;
+
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
   }
+  distanceCalculations += iterationDistances;
 
   // Now, normalize and calculate the distance each cluster has moved.
   arma::vec moveDistances(centroids.n_cols);
@@ -166,7 +215,13 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     distanceCalculations++;
   }
 
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
   for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
   {
     // Step 5: for each point x and center c, assign
     //   l(x, c) = max { l(x, c) - d(c, m(c)), 0 }.
@@ -63,7 +63,8 @@ namespace kmeans /** K-Means clustering. */ {
  * @tparam LloydStepType Implementation of single Lloyd step to use.
  *
  * @see RandomPartition, SampleInitialization, RefinedStart, AllowEmptyClusters,
- *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans
+ *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans, HamerlyKMeans,
+ *      YinyangKMeans
  */
 template<typename MetricType = metric::EuclideanDistance,
          typename InitialPartitionPolicy = SampleInitialization,
@@ -155,6 +156,28 @@ class KMeans
                const bool initialAssignmentGuess = false,
                const bool initialCentroidGuess = false);
 
+  /**
+   * Run k-means clustering several times from different initial partitions,
+   * and keep the clustering with the lowest inertia (the sum of the squared
+   * distances between the points and their centroids).  The runs are
+   * independent, and are done in parallel if OpenMP is available; each one
+   * uses a copy of this object, and its own random seed, drawn beforehand so
+   * that the result does not depend on the number of threads.  Ties go to the
+   * first run.  A std::invalid_argument is thrown if restarts is 0.
+   *
+   * @param data Dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param restarts Number of runs.
+   * @param assignments Vector to store cluster assignments in.
+   * @param centroids Matrix in which centroids are stored.
+   * @return The inertia of the clustering that was kept.
+   */
+  double ClusterRestarts(const MatType& data,
+                         const size_t clusters,
+                         const size_t restarts,
+                         arma::Row<size_t>& assignments,
+                         arma::mat& centroids);
+
   //! Get the maximum number of iterations.
   size_t MaxIterations() const { return maxIterations; }
   //! Set the maximum number of iterations.
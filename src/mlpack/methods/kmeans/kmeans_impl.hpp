@@ -15,6 +15,8 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/util/sfinae_utility.hpp>
 
+#include <exception>
+
 namespace mlpack {
 namespace kmeans {
 
@@ -213,6 +215,8 @@ Cluster(const MatType& data,
 
   do
   {
+    TraceSpan span("kmeans_iteration", iteration);
+
     // We have two centroid matrices.  We don't want to copy anything, so,
     // depending on the iteration number, we use a different centroid matrix...
     if (iteration % 2 == 0)
@@ -335,6 +339,85 @@ Cluster(const MatType& data,
   }
 }
 
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+double KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+ClusterRestarts(const MatType& data,
+                const size_t clusters,
+                const size_t restarts,
+                arma::Row<size_t>& assignments,
+                arma::mat& centroids)
+{
+  if (restarts == 0)
+    throw std::invalid_argument("KMeans::ClusterRestarts(): the number of "
+        "restarts must be positive");
+
+  std::vector<uint64_t> seeds(restarts);
+  for (size_t r = 0; r < restarts; ++r)
+    seeds[r] = math::RandGen()();
+
+  std::vector<arma::Row<size_t>> allAssignments(restarts);
+  std::vector<arma::mat> allCentroids(restarts);
+  arma::vec inertias(restarts);
+  std::exception_ptr error;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t r = 0; r < (intmax_t) restarts; ++r)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t r = 0; r < restarts; ++r)
+#endif
+  {
+    try
+    {
+      math::RandGen().Seed(seeds[r]);
+
+      KMeans run(*this);
+      run.Cluster(data, clusters, allAssignments[r], allCentroids[r]);
+
+      double inertia = 0.0;
+      for (size_t i = 0; i < data.n_cols; ++i)
+      {
+        const double distance = run.Metric().Evaluate(data.col(i),
+            allCentroids[r].col(allAssignments[r][i]));
+        inertia += distance * distance;
+      }
+      inertias[r] = inertia;
+    }
+    catch (...)
+    {
+      #pragma omp critical
+      {
+        if (!error)
+          error = std::current_exception();
+      }
+    }
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+
+  size_t best = 0;
+  for (size_t r = 1; r < restarts; ++r)
+    if (inertias[r] < inertias[best])
+      best = r;
+
+  assignments = std::move(allAssignments[best]);
+  centroids = std::move(allCentroids[best]);
+  return inertias[best];
+}
+
 template<typename MetricType,
          typename InitialPartitionPolicy,
          typename EmptyClusterPolicy,
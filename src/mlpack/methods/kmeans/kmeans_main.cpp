@@ -16,10 +16,13 @@
 #include "allow_empty_clusters.hpp"
 #include "kill_empty_clusters.hpp"
 #include "refined_start.hpp"
+#include "kmeans_parallel_initialization.hpp"
 #include "elkan_kmeans.hpp"
 #include "hamerly_kmeans.hpp"
+#include "yinyang_kmeans.hpp"
 #include "pelleg_moore_kmeans.hpp"
 #include "dual_tree_kmeans.hpp"
+#include "streaming_kmeans.hpp"
 
 using namespace mlpack;
 using namespace mlpack::kmeans;
@@ -39,15 +42,39 @@ PROGRAM_INFO("K-Means Clustering", "This program performs K-Means clustering "
     " random samples of the dataset; to specify the number of samples, the "
     "--samples parameter is used, and to specify the percentage of the dataset "
     "to be used in each sample, the --percentage parameter is used (it should "
-    "be a value between 0.0 and 1.0)."
+    "be a value between 0.0 and 1.0).  Alternately, the k-means|| "
+    "initialization (Bahmani et al., \"Scalable k-means++\", 2012) can be "
+    "used with the --kmeans_parallel option; it samples candidates in "
+    "--rounds passes over the data, about --oversampling times the number of "
+    "clusters in each, and reduces them to the initial centroids with "
+    "k-means++."
+    "\n\n"
+    "With --restarts, k-means is run several times from different initial "
+    "points (in parallel, if OpenMP is available), and the clustering with the "
+    "lowest inertia (the sum of the squared distances between the points and "
+    "their centroids) is kept."
     "\n\n"
     "There are several options available for the algorithm used for each Lloyd "
     "iteration, specified with the --algorithm (-a) option.  The standard O(kN)"
     " approach can be used ('naive').  Other options include the Pelleg-Moore "
     "tree-based algorithm ('pelleg-moore'), Elkan's triangle-inequality based "
     "algorithm ('elkan'), Hamerly's modification to Elkan's algorithm "
-    "('hamerly'), the dual-tree k-means algorithm ('dualtree'), and the "
-    "dual-tree k-means algorithm using the cover tree ('dualtree-covertree')."
+    "('hamerly'), Yinyang k-means, which keeps bounds for groups of about ten "
+    "centroids and suits large numbers of clusters ('yinyang'), the dual-tree "
+    "k-means algorithm ('dualtree'), and the dual-tree k-means algorithm using "
+    "the cover tree ('dualtree-covertree')."
+    "\n\n"
+    "The 'minibatch' algorithm runs mini-batch k-means (Sculley, \"Web-scale "
+    "k-means clustering\", 2010): each iteration samples --batch_size points "
+    "from the dataset and moves the centroids towards them, so iterations are "
+    "much cheaper than full Lloyd iterations but the clustering is "
+    "approximate.  At most --max_iterations batches are used.  If --streaming "
+    "is also specified, the input dataset is never loaded into memory; "
+    "instead, batches of consecutive points are read from the input file (which"
+    " must be a CSV or whitespace-separated text file), starting again at the "
+    "beginning of the file when its end is reached, and only the centroids can "
+    "be saved.  The empty cluster options and the initialization and restart "
+    "options are ignored by the 'minibatch' algorithm."
     "\n\n"
     "The behavior for when an empty cluster is encountered can be modified with"
     " the --allow_empty_clusters (-e) option.  When this option is specified "
@@ -97,9 +124,27 @@ PARAM_INT_IN("samplings", "Number of samplings to perform for refined start "
 PARAM_DOUBLE_IN("percentage", "Percentage of dataset to use for each refined "
     "start sampling (use when --refined_start is specified).", "p", 0.02);
 
+// Parameters for the k-means|| initialization.
+PARAM_FLAG("kmeans_parallel", "Use the k-means|| initialization to choose "
+    "initial points.", "");
+PARAM_INT_IN("rounds", "Number of sampling rounds of the k-means|| "
+    "initialization (use when --kmeans_parallel is specified).", "", 5);
+PARAM_DOUBLE_IN("oversampling", "Expected number of candidates sampled in each "
+    "round of the k-means|| initialization, as a multiple of the number of "
+    "clusters (use when --kmeans_parallel is specified).", "", 2.0);
+
+PARAM_INT_IN("restarts", "Number of times to run k-means from different "
+    "initial points; the clustering with the lowest inertia is kept.", "", 1);
+
 PARAM_STRING_IN("algorithm", "Algorithm to use for the Lloyd iteration "
-    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', or "
-    "'dualtree-covertree').", "a", "naive");
+    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'yinyang', 'dualtree', "
+    "'dualtree-covertree', or 'minibatch').", "a", "naive");
+
+// Parameters for mini-batch k-means.
+PARAM_INT_IN("batch_size", "Number of points in each batch (use when "
+    "--algorithm is 'minibatch').", "b", 1000);
+PARAM_FLAG("streaming", "Read batches from the input file instead of loading "
+    "it (use when --algorithm is 'minibatch').", "M");
 
 // Given the type of initial partition policy, figure out the empty cluster
 // policy and run k-means.
@@ -117,6 +162,13 @@ template<typename InitialPartitionPolicy,
          template<class, class> class LloydStepType>
 void RunKMeans(const InitialPartitionPolicy& ipp);
 
+// Run mini-batch k-means, either on the dataset in memory or on batches read
+// from the input file.
+void RunMiniBatchKMeans();
+
+// Save the cluster assignments as the user asked.
+void SaveAssignments(arma::mat& dataset, arma::Row<size_t>& assignments);
+
 int main(int argc, char** argv)
 {
   CLI::ParseCommandLine(argc, argv);
@@ -127,6 +179,13 @@ int main(int argc, char** argv)
   else
     math::RandomSeed((size_t) std::time(NULL));
 
+  // Mini-batch k-means doesn't use the KMeans class.
+  if (CLI::GetParam<string>("algorithm") == "minibatch")
+  {
+    RunMiniBatchKMeans();
+    return 0;
+  }
+
   // Now, start building the KMeans type that we'll be using.  Start with the
   // initial partition policy.  The call to FindEmptyClusterPolicy<> results in
   // a call to RunKMeans<> and the algorithm is completed.
@@ -142,8 +201,27 @@ int main(int argc, char** argv)
       Log::Fatal << "Percentage for sampling (" << percentage << ") must be "
           << "greater than 0.0 and less than or equal to 1.0!" << endl;
 
+    if (CLI::HasParam("kmeans_parallel"))
+      Log::Fatal << "Only one of --refined_start (-r) and --kmeans_parallel "
+          << "may be specified!" << endl;
+
     FindEmptyClusterPolicy<RefinedStart>(RefinedStart(samplings, percentage));
   }
+  else if (CLI::HasParam("kmeans_parallel"))
+  {
+    const int rounds = CLI::GetParam<int>("rounds");
+    const double oversampling = CLI::GetParam<double>("oversampling");
+
+    if (rounds < 0)
+      Log::Fatal << "Number of rounds (" << rounds << ") must be greater than "
+          << "or equal to 0!" << endl;
+    if (oversampling <= 0.0)
+      Log::Fatal << "Oversampling factor (" << oversampling << ") must be "
+          << "greater than 0.0!" << endl;
+
+    FindEmptyClusterPolicy<KMeansParallelInitialization>(
+        KMeansParallelInitialization(rounds, oversampling));
+  }
   else
   {
     FindEmptyClusterPolicy<SampleInitialization>(SampleInitialization());
@@ -177,6 +255,8 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, ElkanKMeans>(ipp);
   else if (algorithm == "hamerly")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, HamerlyKMeans>(ipp);
+  else if (algorithm == "yinyang")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, YinyangKMeans>(ipp);
   else if (algorithm == "pelleg-moore")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
         PellegMooreKMeans>(ipp);
@@ -190,8 +270,8 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, NaiveKMeans>(ipp);
   else
     Log::Fatal << "Unknown algorithm: '" << algorithm << "'.  Supported options"
-        << " are 'naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', and "
-        << "'dualtree-covertree'." << endl;
+        << " are 'naive', 'pelleg-moore', 'elkan', 'hamerly', 'yinyang', "
+        << "'dualtree', 'dualtree-covertree', and 'minibatch'." << endl;
 }
 
 // Given the template parameters, sanitize/load input and run k-means.
@@ -225,6 +305,13 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
         ")! Must be greater than or equal to 0." << endl;
   }
 
+  const int restarts = CLI::GetParam<int>("restarts");
+  if (restarts < 1)
+  {
+    Log::Fatal << "Invalid number of restarts (" << restarts << ")! Must be "
+        << "greater than 0." << endl;
+  }
+
   // Make sure we have an output file if we're not doing the work in-place.
   if (!CLI::HasParam("in_place") && !CLI::HasParam("output") &&
       !CLI::HasParam("centroid"))
@@ -250,6 +337,10 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
           << "because --refined_start is also specified!" << endl;
     else
       Log::Info << "Using initial centroid guesses." << endl;
+
+    if (restarts > 1)
+      Log::Warn << "--restarts will be ignored because initial centroids are "
+          << "specified." << endl;
   }
 
   Timer::Start("clustering");
@@ -258,7 +349,19 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
          EmptyClusterPolicy,
          LloydStepType> kmeans(maxIterations, metric::EuclideanDistance(), ipp);
 
-  if (CLI::HasParam("output") || CLI::HasParam("in_place"))
+  if (restarts > 1 && !initialCentroidGuess)
+  {
+    arma::Row<size_t> assignments;
+    const double inertia = kmeans.ClusterRestarts(dataset, clusters,
+        size_t(restarts), assignments, centroids);
+    Timer::Stop("clustering");
+    Log::Info << "Best inertia of " << restarts << " restarts: " << inertia
+        << "." << endl;
+
+    if (CLI::HasParam("output") || CLI::HasParam("in_place"))
+      SaveAssignments(dataset, assignments);
+  }
+  else if (CLI::HasParam("output") || CLI::HasParam("in_place"))
   {
     // We need to get the assignments.
     arma::Row<size_t> assignments;
@@ -266,61 +369,258 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
         false, initialCentroidGuess);
     Timer::Stop("clustering");
 
-    // Now figure out what to do with our results.
-    if (CLI::HasParam("in_place"))
+    SaveAssignments(dataset, assignments);
+  }
+  else
+  {
+    // Just save the centroids.
+    kmeans.Cluster(dataset, clusters, centroids, initialCentroidGuess);
+    Timer::Stop("clustering");
+  }
+
+  // Should we write the centroids to a file?
+  if (CLI::HasParam("centroid"))
+    CLI::GetParam<arma::mat>("centroid") = std::move(centroids);
+}
+
+// Save the cluster assignments as the user asked.
+void SaveAssignments(arma::mat& dataset, arma::Row<size_t>& assignments)
+{
+  if (CLI::HasParam("in_place"))
+  {
+    // Add the column of assignments to the dataset; but we have to convert
+    // them to type double first.
+    arma::rowvec converted(assignments.n_elem);
+    for (size_t i = 0; i < assignments.n_elem; i++)
+      converted(i) = (double) assignments(i);
+
+    dataset.insert_rows(dataset.n_rows, converted);
+
+    // Save the dataset.  We have to do a little trickery to get it to save
+    // the input file correctly.
+    CLI::GetUnmappedParam<arma::mat>("output") =
+        CLI::GetUnmappedParam<arma::mat>("input");
+    CLI::GetParam<arma::mat>("output") = std::move(dataset);
+  }
+  else
+  {
+    if (CLI::HasParam("labels_only"))
     {
-      // Add the column of assignments to the dataset; but we have to convert
-      // them to type double first.
+      // Save only the labels.  But the labels are a different type so we need
+      // to do a bit of trickery to get them to save as the right type: we'll
+      // add another option with type Mat<size_t> called 'output_labels', then
+      // set the 'output' option to nothing, and set the 'output_labels'
+      // option to what the user passed for 'output'.
+      CLI::Add<arma::Mat<size_t>>(arma::Mat<size_t>(), "output_labels",
+          "Labels for input dataset.", '\0', false, false, false);
+      CLI::GetUnmappedParam<arma::Mat<size_t>>("output_labels") =
+          CLI::GetUnmappedParam<arma::mat>("output");
+      CLI::GetUnmappedParam<arma::mat>("output") = "";
+
+      CLI::GetParam<arma::Mat<size_t>>("output_labels") =
+          std::move(assignments);
+    }
+    else
+    {
+      // Convert the assignments to doubles.
       arma::rowvec converted(assignments.n_elem);
       for (size_t i = 0; i < assignments.n_elem; i++)
         converted(i) = (double) assignments(i);
 
       dataset.insert_rows(dataset.n_rows, converted);
 
-      // Save the dataset.  We have to do a little trickery to get it to save
-      // the input file correctly.
-      CLI::GetUnmappedParam<arma::mat>("output") =
-          CLI::GetUnmappedParam<arma::mat>("input");
+      // Now save, in the different file.
       CLI::GetParam<arma::mat>("output") = std::move(dataset);
     }
-    else
+  }
+}
+
+// Read the next batch of at most batchSize points (one per line) from the given
+// text file.  Return false if there are no more points in the file.
+bool ReadBatch(std::ifstream& stream,
+               const size_t batchSize,
+               arma::mat& batch)
+{
+  std::vector<double> values;
+  size_t dimensionality = 0;
+  size_t points = 0;
+  std::string line;
+  while (points < batchSize && std::getline(stream, line))
+  {
+    const size_t oldSize = values.size();
+    const char* p = line.c_str();
+    while (true)
     {
-      if (CLI::HasParam("labels_only"))
-      {
-        // Save only the labels.  But the labels are a different type so we need
-        // to do a bit of trickery to get them to save as the right type: we'll
-        // add another option with type Mat<size_t> called 'output_labels', then
-        // set the 'output' option to nothing, and set the 'output_labels'
-        // option to what the user passed for 'output'.
-        CLI::Add<arma::Mat<size_t>>(arma::Mat<size_t>(), "output_labels",
-            "Labels for input dataset.", '\0', false, false, false);
-        CLI::GetUnmappedParam<arma::Mat<size_t>>("output_labels") =
-            CLI::GetUnmappedParam<arma::mat>("output");
-        CLI::GetUnmappedParam<arma::mat>("output") = "";
-
-        CLI::GetParam<arma::Mat<size_t>>("output_labels") =
-            std::move(assignments);
-      }
-      else
-      {
-        // Convert the assignments to doubles.
-        arma::rowvec converted(assignments.n_elem);
-        for (size_t i = 0; i < assignments.n_elem; i++)
-          converted(i) = (double) assignments(i);
+      // Skip delimiters.
+      while (*p == ',' || std::isspace((unsigned char) *p))
+        ++p;
+      if (*p == '\0')
+        break;
+
+      char* end;
+      values.push_back(std::strtod(p, &end));
+      if (end == p)
+        Log::Fatal << "Cannot parse '" << line << "' in the input file!"
+            << endl;
+      p = end;
+    }
 
-        dataset.insert_rows(dataset.n_rows, converted);
+    // Skip empty lines.
+    if (values.size() == oldSize)
+      continue;
 
-        // Now save, in the different file.
-        CLI::GetParam<arma::mat>("output") = std::move(dataset);
-      }
-    }
+    if (points == 0)
+      dimensionality = values.size() - oldSize;
+    else if (values.size() - oldSize != dimensionality)
+      Log::Fatal << "Line '" << line << "' of the input file has "
+          << (values.size() - oldSize) << " dimensions, but it should have "
+          << dimensionality << "!" << endl;
+
+    ++points;
   }
-  else
+
+  if (points == 0)
+    return false;
+
+  batch = arma::mat(values.data(), dimensionality, points);
+  return true;
+}
+
+void RunMiniBatchKMeans()
+{
+  if (CLI::HasParam("refined_start") || CLI::HasParam("allow_empty_clusters") ||
+      CLI::HasParam("kill_empty_clusters"))
+    Log::Warn << "--refined_start, --allow_empty_clusters and "
+        << "--kill_empty_clusters are ignored by the 'minibatch' algorithm."
+        << endl;
+  if (CLI::HasParam("kmeans_parallel") || CLI::HasParam("restarts"))
+    Log::Warn << "--kmeans_parallel and --restarts are ignored by the "
+        << "'minibatch' algorithm." << endl;
+
+  int clusters = CLI::GetParam<int>("clusters");
+  if (clusters < 0)
   {
-    // Just save the centroids.
-    kmeans.Cluster(dataset, clusters, centroids, initialCentroidGuess);
+    Log::Fatal << "Invalid number of clusters requested (" << clusters << ")! "
+        << "Must be greater than or equal to 0." << endl;
+  }
+  else if (clusters == 0 && !CLI::HasParam("initial_centroids"))
+  {
+    Log::Fatal << "Number of clusters requested is 0, and no initial centroids "
+        << "provided!" << endl;
+  }
+
+  const int maxIterations = CLI::GetParam<int>("max_iterations");
+  if (maxIterations < 0)
+  {
+    Log::Fatal << "Invalid value for maximum iterations (" << maxIterations <<
+        ")! Must be greater than or equal to 0." << endl;
+  }
+
+  const int restarts = CLI::GetParam<int>("restarts");
+  if (restarts < 1)
+  {
+    Log::Fatal << "Invalid number of restarts (" << restarts << ")! Must be "
+        << "greater than 0." << endl;
+  }
+
+  const int batchSize = CLI::GetParam<int>("batch_size");
+  if (batchSize <= 0)
+  {
+    Log::Fatal << "Invalid batch size (" << batchSize << ")!  Must be greater "
+        << "than 0." << endl;
+  }
+
+  const bool streaming = CLI::HasParam("streaming");
+  if (streaming && (CLI::HasParam("output") || CLI::HasParam("in_place")))
+  {
+    Log::Fatal << "Only --centroid can be saved when --streaming is specified!"
+        << endl;
+  }
+  else if (!CLI::HasParam("in_place") && !CLI::HasParam("output") &&
+      !CLI::HasParam("centroid"))
+  {
+    Log::Warn << "--output_file, --in_place, and --centroid_file are not set; "
+        << "no results will be saved." << std::endl;
+  }
+
+  arma::mat centroids;
+  const bool initialCentroidGuess = CLI::HasParam("initial_centroids");
+  if (initialCentroidGuess)
+  {
+    centroids = std::move(CLI::GetParam<arma::mat>("initial_centroids"));
+    if (clusters == 0)
+      clusters = centroids.n_cols;
+    Log::Info << "Using initial centroid guesses." << endl;
+  }
+
+  StreamingKMeans<> kmeans(maxIterations);
+
+  if (streaming)
+  {
+    // Don't load the dataset; read it from the file as we go.
+    const std::string filename = CLI::GetUnmappedParam<arma::mat>("input");
+    std::ifstream stream(filename.c_str());
+    if (!stream.is_open())
+      Log::Fatal << "Cannot open file '" << filename << "'!" << endl;
+
+    auto source = [&](arma::mat& batch)
+    {
+      if (ReadBatch(stream, batchSize, batch))
+        return true;
+
+      // Start again at the beginning of the file.
+      stream.clear();
+      stream.seekg(0, std::ios::beg);
+      return ReadBatch(stream, batchSize, batch);
+    };
+
+    Timer::Start("clustering");
+    kmeans.Cluster(source, clusters, centroids, initialCentroidGuess);
     Timer::Stop("clustering");
   }
+  else
+  {
+    arma::mat dataset = CLI::GetParam<arma::mat>("input");
+
+    // Sample each batch from the dataset.
+    auto source = [&](arma::mat& batch)
+    {
+      batch.set_size(dataset.n_rows, batchSize);
+      for (int i = 0; i < batchSize; ++i)
+        batch.col(i) = dataset.col(math::RandInt(0, dataset.n_cols));
+      return true;
+    };
+
+    Timer::Start("clustering");
+    kmeans.Cluster(source, clusters, centroids, initialCentroidGuess);
+
+    if (CLI::HasParam("output") || CLI::HasParam("in_place"))
+    {
+      // Assign each point to its closest centroid.
+      arma::Row<size_t> assignments(dataset.n_cols);
+      for (size_t i = 0; i < dataset.n_cols; ++i)
+      {
+        double minDistance = std::numeric_limits<double>::infinity();
+        for (size_t j = 0; j < centroids.n_cols; ++j)
+        {
+          const double distance = metric::EuclideanDistance::Evaluate(
+              dataset.col(i), centroids.col(j));
+          if (distance < minDistance)
+          {
+            minDistance = distance;
+            assignments[i] = j;
+          }
+        }
+      }
+      Timer::Stop("clustering");
+
+      SaveAssignments(dataset, assignments);
+    }
+    else
+    {
+      Timer::Stop("clustering");
+    }
+  }
 
   // Should we write the centroids to a file?
   if (CLI::HasParam("centroid"))
@@ -0,0 +1,130 @@
+/**
+ * @file kmeans_parallel_initialization.hpp
+ *
+ * An implementation of the k-means|| initialization of Bahmani et al., a
+ * parallel variant of k-means++ seeding.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The k-means|| initialization chooses initial centroids that are spread out
+ * like those of k-means++, but in a few passes over the data instead of one
+ * pass per centroid.  Starting from a random point, each round samples every
+ * point independently with probability proportional to its squared distance to
+ * the closest candidate so far, so that about oversampling * k candidates are
+ * added per round.  Each candidate is then weighted by the number of points
+ * closest to it, and the weighted candidates are reduced to k centroids with
+ * k-means++.  It is an implementation of the following paper:
+ *
+ * @code
+ * @article{bahmani2012scalable,
+ *   title={Scalable k-means++},
+ *   author={Bahmani, Bahman and Moseley, Benjamin and Vattani, Andrea and
+ *       Kumar, Ravi and Vassilvitskii, Sergei},
+ *   journal={Proceedings of the VLDB Endowment},
+ *   volume={5},
+ *   number={7},
+ *   pages={622--633},
+ *   year={2012}
+ * }
+ * @endcode
+ *
+ * The distances between the points and the new candidates of each round are
+ * computed in parallel (if OpenMP is available) for blocks of points at a
+ * time, through matrix products.  The random numbers are drawn serially, so the
+ * result does not depend on the number of threads.  The squared Euclidean
+ * distance is always used.
+ */
+class KMeansParallelInitialization
+{
+ public:
+  /**
+   * Create the KMeansParallelInitialization object, optionally specifying the
+   * number of sampling rounds and the oversampling factor.
+   *
+   * @param rounds Number of sampling rounds.
+   * @param oversampling Expected number of candidates added in each round, as
+   *     a multiple of the number of clusters.
+   */
+  KMeansParallelInitialization(const size_t rounds = 5,
+                               const double oversampling = 2.0) :
+      rounds(rounds), oversampling(oversampling) { }
+
+  /**
+   * Choose initial centroids for the given number of clusters with the
+   * k-means|| algorithm.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset to choose centroids from.
+   * @param clusters Number of clusters.
+   * @param centroids Matrix to store centroids into.
+   */
+  template<typename MatType>
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::mat& centroids);
+
+  //! Get the number of sampling rounds.
+  size_t Rounds() const { return rounds; }
+  //! Modify the number of sampling rounds.
+  size_t& Rounds() { return rounds; }
+
+  //! Get the oversampling factor.
+  double Oversampling() const { return oversampling; }
+  //! Modify the oversampling factor.
+  double& Oversampling() { return oversampling; }
+
+  //! Serialize the object.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(rounds, "rounds");
+    ar & data::CreateNVP(oversampling, "oversampling");
+  }
+
+ private:
+  //! The number of sampling rounds.
+  size_t rounds;
+  //! The expected number of candidates per round, as a multiple of k.
+  double oversampling;
+
+  /**
+   * Update the squared distance of each point to its closest candidate, and
+   * the index of that candidate, with the candidates from the given one on.
+   *
+   * @param data Dataset.
+   * @param norms Squared norm of each point.
+   * @param candidates Indices of the candidate points.
+   * @param begin Index of the first new candidate in candidates.
+   * @param distances Squared distance of each point to its closest candidate.
+   * @param closest Index (in candidates) of the closest candidate of each
+   *     point.
+   */
+  template<typename MatType>
+  static void UpdateDistances(const MatType& data,
+                              const arma::vec& norms,
+                              const std::vector<size_t>& candidates,
+                              const size_t begin,
+                              arma::vec& distances,
+                              arma::Col<size_t>& closest);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "kmeans_parallel_initialization_impl.hpp"
+
+#endif
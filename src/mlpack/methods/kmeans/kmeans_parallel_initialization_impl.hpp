@@ -0,0 +1,191 @@
+/**
+ * @file kmeans_parallel_initialization_impl.hpp
+ *
+ * Implementation of the k-means|| initialization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_parallel_initialization.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansParallelInitialization::Cluster(const MatType& data,
+                                           const size_t clusters,
+                                           arma::mat& centroids)
+{
+  const size_t n = data.n_cols;
+  centroids.set_size(data.n_rows, clusters);
+  if (n == 0 || clusters == 0)
+    return;
+
+  // Squared norms of the points, for the distance computations.
+  arma::vec norms(n);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for if (n >= 4096)
+  for (intmax_t i = 0; i < (intmax_t) n; ++i)
+#else
+  #pragma omp parallel for if (n >= 4096)
+  for (size_t i = 0; i < n; ++i)
+#endif
+  {
+    norms[i] = arma::dot(data.col(i), data.col(i));
+  }
+
+  // Start with a random point, then sample each point independently in each
+  // round with probability proportional to its squared distance to the
+  // closest candidate.
+  std::vector<size_t> candidates(1, math::RandInt(0, n));
+  arma::vec distances(n);
+  distances.fill(std::numeric_limits<double>::infinity());
+  arma::Col<size_t> closest(n);
+  UpdateDistances(data, norms, candidates, 0, distances, closest);
+
+  const double expected = oversampling * clusters;
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    const double cost = arma::accu(distances);
+    if (cost <= 0.0)
+      break;
+
+    const size_t begin = candidates.size();
+    for (size_t i = 0; i < n; ++i)
+      if (math::RandGen().Uniform() * cost < expected * distances[i])
+        candidates.push_back(i);
+
+    if (candidates.size() > begin)
+      UpdateDistances(data, norms, candidates, begin, distances, closest);
+  }
+
+  // If there are not enough distinct candidates, the rest of the centroids are
+  // random points.
+  const size_t m = candidates.size();
+  if (m <= clusters)
+  {
+    for (size_t c = 0; c < m; ++c)
+      centroids.col(c) = arma::vec(data.col(candidates[c]));
+    for (size_t c = m; c < clusters; ++c)
+      centroids.col(c) = arma::vec(data.col(math::RandInt(0, n)));
+    return;
+  }
+
+  // Weight each candidate by the number of points that are closest to it.
+  arma::vec weights(m, arma::fill::zeros);
+  for (size_t i = 0; i < n; ++i)
+    weights[closest[i]] += 1.0;
+
+  arma::mat points(data.n_rows, m);
+  for (size_t j = 0; j < m; ++j)
+    points.col(j) = arma::vec(data.col(candidates[j]));
+  const arma::vec pointNorms = arma::trans(arma::sum(arma::square(points)));
+
+  // Reduce the candidates to the centroids with weighted k-means++.
+  arma::vec minDistances(m);
+  minDistances.fill(std::numeric_limits<double>::infinity());
+  for (size_t c = 0; c < clusters; ++c)
+  {
+    const arma::vec probabilities = (c == 0) ? weights :
+        arma::vec(weights % minDistances);
+    const double total = arma::accu(probabilities);
+
+    size_t index = m - 1;
+    if (total > 0.0)
+    {
+      const double u = math::RandGen().Uniform() * total;
+      double sum = 0.0;
+      for (size_t j = 0; j < m; ++j)
+      {
+        sum += probabilities[j];
+        if (u < sum)
+        {
+          index = j;
+          break;
+        }
+      }
+    }
+    else
+    {
+      // Every candidate is already a centroid.
+      index = math::RandInt(0, m);
+    }
+
+    centroids.col(c) = points.col(index);
+    arma::vec newDistances = pointNorms + pointNorms[index] -
+        2.0 * arma::trans(points) * points.col(index);
+    minDistances = arma::min(minDistances, arma::clamp(newDistances, 0.0,
+        arma::datum::inf));
+  }
+}
+
+template<typename MatType>
+void KMeansParallelInitialization::UpdateDistances(
+    const MatType& data,
+    const arma::vec& norms,
+    const std::vector<size_t>& candidates,
+    const size_t begin,
+    arma::vec& distances,
+    arma::Col<size_t>& closest)
+{
+  const size_t numNew = candidates.size() - begin;
+  arma::mat newCandidates(data.n_rows, numNew);
+  arma::vec newNorms(numNew);
+  for (size_t j = 0; j < numNew; ++j)
+  {
+    newCandidates.col(j) = arma::vec(data.col(candidates[begin + j]));
+    newNorms[j] = norms[candidates[begin + j]];
+  }
+
+  // The distances to the new candidates are computed for blocks of points at
+  // a time, with a matrix product.
+  const size_t blockSize = 1024;
+  const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
+#ifdef _WIN32
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t first = b * blockSize;
+    const size_t last = std::min(first + blockSize, (size_t) data.n_cols);
+    const arma::mat products = arma::trans(newCandidates) *
+        data.cols(first, last - 1);
+
+    for (size_t i = first; i < last; ++i)
+    {
+      for (size_t j = 0; j < numNew; ++j)
+      {
+        const double distance = std::max(norms[i] + newNorms[j] -
+            2.0 * products(j, i - first), 0.0);
+        if (distance < distances[i])
+        {
+          distances[i] = distance;
+          closest[i] = begin + j;
+        }
+      }
+    }
+  }
+
+  // Make sure that the candidates themselves can't be sampled again.
+  for (size_t j = begin; j < candidates.size(); ++j)
+  {
+    distances[candidates[j]] = 0.0;
+    closest[candidates[j]] = j;
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
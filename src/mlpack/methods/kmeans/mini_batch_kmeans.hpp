@@ -0,0 +1,124 @@
+/**
+ * @file mini_batch_kmeans.hpp
+ *
+ * An implementation of mini-batch k-means (Sculley, "Web-scale k-means
+ * clustering", 2010) as a Lloyd step type.  Each iteration only looks at a
+ * small random sample of the dataset, which makes each iteration far cheaper
+ * than a full Lloyd iteration on large datasets, at the cost of a slightly
+ * worse clustering.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * A single mini-batch k-means iteration, for use as the LloydStepType of the
+ * KMeans class.  Each call to Iterate() samples a batch of points uniformly at
+ * random (with replacement) from the dataset, assigns each of them to its
+ * nearest centroid, and then moves each centroid towards each of its points
+ * with a per-centroid learning rate of 1 / (number of points assigned to that
+ * centroid so far).
+ *
+ * The counts returned by Iterate() are the number of points assigned to each
+ * centroid over all iterations so far, so a cluster is only considered empty by
+ * the EmptyClusterPolicy if no sampled point has ever been assigned to it.  If
+ * the batches are small compared to the number of clusters, AllowEmptyClusters
+ * may be a better choice than the default MaxVarianceNewCluster.
+ *
+ * The KMeans class creates this object with the default batch size; use
+ * StreamingKMeans to choose the batch size or to cluster data that does not
+ * fit in memory.
+ *
+ * @tparam MetricType Type of metric used with this implementation.
+ * @tparam MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class MiniBatchKMeans
+{
+ public:
+  /**
+   * Construct the MiniBatchKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points to sample in each iteration.
+   */
+  MiniBatchKMeans(const MatType& dataset,
+                  MetricType& metric,
+                  const size_t batchSize = 1000);
+
+  /**
+   * Run a single mini-batch iteration, storing the updated centroids in
+   * newCentroids and the total number of points assigned so far to each
+   * centroid in counts.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points assigned to each cluster so far.
+   * @return Norm of the movement of the centroids.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  /**
+   * Assign the given points of the given matrix to their nearest centroids,
+   * then move each centroid towards its points with a learning rate of 1 /
+   * clusterCounts[c], incrementing clusterCounts for each assigned point.  The
+   * assignments are computed in parallel, if OpenMP is available.  This is used
+   * by both MiniBatchKMeans and StreamingKMeans.
+   *
+   * @param points Matrix holding the points of the batch.
+   * @param indices Indices of the points of the batch in the matrix.
+   * @param metric Instantiated metric.
+   * @param centroids Centroids to update.
+   * @param clusterCounts Number of points assigned to each centroid so far.
+   * @return Number of distance calculations performed.
+   */
+  template<typename PointsType>
+  static size_t UpdateCentroids(const PointsType& points,
+                                const arma::Col<size_t>& indices,
+                                MetricType& metric,
+                                arma::mat& centroids,
+                                arma::Col<size_t>& clusterCounts);
+
+  //! Get the number of distance calculations.
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! Number of points sampled in each iteration.
+  size_t batchSize;
+
+  //! Number of points assigned to each cluster so far.
+  arma::Col<size_t> clusterCounts;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file mini_batch_kmeans_impl.hpp
+ *
+ * Implementation of the mini-batch k-means Lloyd step.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(const MatType& dataset,
+                                                      MetricType& metric,
+                                                      const size_t batchSize) :
+    dataset(dataset),
+    metric(metric),
+    batchSize(batchSize),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Iterate(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  // If this is the first iteration, no points have been assigned yet.
+  if (clusterCounts.n_elem != centroids.n_cols)
+    clusterCounts.zeros(centroids.n_cols);
+
+  // Sample the batch.
+  arma::Col<size_t> indices(batchSize);
+  for (size_t i = 0; i < batchSize; ++i)
+    indices[i] = math::RandInt(0, dataset.n_cols);
+
+  newCentroids = centroids;
+  distanceCalculations += UpdateCentroids(dataset, indices, metric,
+      newCentroids, clusterCounts);
+
+  counts = clusterCounts;
+
+  // Calculate the movement of the centroids.
+  double cNorm = 0.0;
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(c), newCentroids.col(c)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+template<typename MetricType, typename MatType>
+template<typename PointsType>
+size_t MiniBatchKMeans<MetricType, MatType>::UpdateCentroids(
+    const PointsType& points,
+    const arma::Col<size_t>& indices,
+    MetricType& metric,
+    arma::mat& centroids,
+    arma::Col<size_t>& clusterCounts)
+{
+  // First find the nearest centroid of every point in the batch; this is where
+  // nearly all the time goes.
+  arma::Col<size_t> closestClusters(indices.n_elem);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) indices.n_elem; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < indices.n_elem; ++i)
+#endif
+  {
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      const double distance = metric.Evaluate(points.col(indices[i]),
+          centroids.col(j));
+
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    closestClusters[i] = closestCluster;
+  }
+
+  // Now take a gradient step for each point, in order.
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    const size_t c = closestClusters[i];
+    Log::Assert(c != centroids.n_cols);
+
+    const double eta = 1.0 / (double) (++clusterCounts[c]);
+    centroids.col(c) = (1.0 - eta) * centroids.col(c) +
+        eta * arma::vec(points.col(indices[i]));
+  }
+
+  return indices.n_elem * centroids.n_cols;
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -62,6 +62,10 @@ class NaiveKMeans
 
   //! Number of distance calculations.
   size_t distanceCalculations;
+
+  //! Number of points whose distances to the centroids are computed with one
+  //! matrix product, for the Euclidean distance.
+  static const size_t blockSize = 256;
 };
 
 } // namespace kmeans
@@ -20,6 +20,14 @@
 namespace mlpack {
 namespace kmeans {
 
+//! Whether the metric is the (possibly squared) Euclidean distance, whose
+//! closest centroids can be found with a matrix product.
+template<typename MetricType>
+struct IsEuclideanMetric : std::false_type { };
+
+template<bool TakeRoot>
+struct IsEuclideanMetric<metric::LMetric<2, TakeRoot>> : std::true_type { };
+
 template<typename MetricType, typename MatType>
 NaiveKMeans<MetricType, MatType>::NaiveKMeans(const MatType& dataset,
                                               MetricType& metric) :
@@ -37,29 +45,117 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
 
-  // Find the closest centroid to each point and update the new centroids.
-  for (size_t i = 0; i < dataset.n_cols; i++)
+  // Each thread accumulates the points it assigns into its own partial
+  // centroids; these are summed in thread order afterwards, so the result only
+  // depends on the number of threads.
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+  std::vector<arma::mat> threadCentroids(numThreads);
+  std::vector<arma::Col<size_t>> threadCounts(numThreads);
+
+  // The squared norms of the centroids, for the Euclidean distance.
+  const arma::vec centroidNorms = IsEuclideanMetric<MetricType>::value ?
+      arma::vec(trans(arma::sum(arma::square(centroids), 0))) : arma::vec();
+
+  #pragma omp parallel
   {
-    // Find the closest centroid to this point.
-    double minDistance = std::numeric_limits<double>::infinity();
-    size_t closestCluster = centroids.n_cols; // Invalid value.
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localCentroids = threadCentroids[thread];
+    arma::Col<size_t>& localCounts = threadCounts[thread];
+    localCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    localCounts.zeros(centroids.n_cols);
 
-    for (size_t j = 0; j < centroids.n_cols; j++)
+    if (IsEuclideanMetric<MetricType>::value)
     {
-      const double distance = metric.Evaluate(dataset.col(i), centroids.col(j));
+      // For the Euclidean distance, the closest centroids of a block of points
+      // are found with one matrix product, so that the distance computations
+      // run in the BLAS (and on the GPU, if mlpack is linked against NVBLAS).
+      const size_t numBlocks = (dataset.n_cols + blockSize - 1) / blockSize;
+      arma::mat scores;
 
-      if (distance < minDistance)
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables.
+      #pragma omp for schedule(static)
+      for (intmax_t b = 0; b < (intmax_t) numBlocks; b++)
+#else
+      #pragma omp for schedule(static)
+      for (size_t b = 0; b < numBlocks; b++)
+#endif
       {
-        minDistance = distance;
-        closestCluster = j;
+        const size_t begin = b * blockSize;
+        const size_t end = std::min((size_t) (b + 1) * blockSize,
+            (size_t) dataset.n_cols);
+
+        // argmin_c ||x - c||^2 = argmin_c (||c||^2 - 2 c^T x), so the norms of
+        // the points are not needed.
+        scores = -2 * trans(centroids) * dataset.cols(begin, end - 1);
+        scores.each_col() += centroidNorms;
+
+        for (size_t i = begin; i < end; i++)
+        {
+          arma::uword closestCluster;
+          scores.unsafe_col(i - begin).min(closestCluster);
+
+          localCentroids.col(closestCluster) += arma::vec(dataset.col(i));
+          localCounts(closestCluster)++;
+        }
       }
     }
+    else
+    {
+      // Find the closest centroid to each point and update the new centroids.
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables.
+      #pragma omp for schedule(static)
+      for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; i++)
+#else
+      #pragma omp for schedule(static)
+      for (size_t i = 0; i < dataset.n_cols; i++)
+#endif
+      {
+        // Find the closest centroid to this point.
+        double minDistance = std::numeric_limits<double>::infinity();
+        size_t closestCluster = centroids.n_cols; // Invalid value.
+
+        for (size_t j = 0; j < centroids.n_cols; j++)
+        {
+          const double distance = metric.Evaluate(dataset.col(i),
+              centroids.col(j));
+
+          if (distance < minDistance)
+          {
+            minDistance = distance;
+            closestCluster = j;
+          }
+        }
+
+        Log::Assert(closestCluster != centroids.n_cols);
 
-    Log::Assert(closestCluster != centroids.n_cols);
+        // We now have the minimum distance centroid index.  Update that
+        // centroid.
+        localCentroids.col(closestCluster) += arma::vec(dataset.col(i));
+        localCounts(closestCluster)++;
+      }
+    }
+  }
+
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    // A thread may not have run, if the runtime gave us fewer threads.
+    if (threadCounts[t].n_elem == 0)
+      continue;
 
-    // We now have the minimum distance centroid index.  Update that centroid.
-    newCentroids.col(closestCluster) += arma::vec(dataset.col(i));
-    counts(closestCluster)++;
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
   }
 
   // Now normalize the centroid.
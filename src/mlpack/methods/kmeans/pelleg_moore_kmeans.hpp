@@ -22,7 +22,9 @@ namespace kmeans {
 /**
  * An implementation of Pelleg-Moore's 'blacklist' algorithm for k-means
  * clustering.  This algorithm builds a kd-tree on the data points and traverses
- * it in order to determine the closest clusters to each point.
+ * it in order to determine the closest clusters to each point.  Once the top
+ * levels of the tree have been scored, the remaining subtrees are traversed in
+ * parallel (if OpenMP is available).
  *
  * For more information on the algorithm, see
  *
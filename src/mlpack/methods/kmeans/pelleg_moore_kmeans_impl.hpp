@@ -53,15 +53,66 @@ double PellegMooreKMeans<MetricType, MatType>::Iterate(
   typedef PellegMooreKMeansRules<MetricType, TreeType> RulesType;
   RulesType rules(dataset, centroids, newCentroids, counts, metric);
 
-  // Use single-tree traverser.
-  typename TreeType::template SingleTreeTraverser<RulesType> traverser(rules);
-
-  // Now, do a traversal with a fake query index (since the query index is
-  // irrelevant; we are checking each node with all clusters.
-  traverser.Traverse(0, *tree);
+  // The top levels of the tree are scored here, until there are enough
+  // subtrees left to traverse in parallel.  The query index is a fake index,
+  // since it is irrelevant; we are checking each node with all clusters.
+  std::vector<TreeType*> subtrees(1, tree);
+  while (!subtrees.empty() && subtrees.size() < 64)
+  {
+    std::vector<TreeType*> children;
+    for (size_t i = 0; i < subtrees.size(); ++i)
+    {
+      // The points of a leaf have already been assigned when it was scored.
+      for (size_t j = 0; j < subtrees[i]->NumChildren(); ++j)
+      {
+        if (rules.Score(0, subtrees[i]->Child(j)) != DBL_MAX)
+          children.push_back(&subtrees[i]->Child(j));
+      }
+    }
 
+    subtrees.swap(children);
+  }
   distanceCalculations += rules.DistanceCalculations();
 
+  // Each subtree is traversed with its own centroid accumulators, which are
+  // summed in order afterwards, so that the result does not depend on the
+  // number of threads.  The subtrees hold disjoint sets of nodes, so their
+  // statistics can be updated at the same time.
+  std::vector<arma::mat> subtreeCentroids(subtrees.size());
+  std::vector<arma::Col<size_t>> subtreeCounts(subtrees.size());
+  size_t subtreeDistanceCalculations = 0;
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:subtreeDistanceCalculations)
+  for (intmax_t i = 0; i < (intmax_t) subtrees.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:subtreeDistanceCalculations)
+  for (size_t i = 0; i < subtrees.size(); ++i)
+#endif
+  {
+    subtreeCentroids[i].zeros(centroids.n_rows, centroids.n_cols);
+    subtreeCounts[i].zeros(centroids.n_cols);
+    RulesType subtreeRules(dataset, centroids, subtreeCentroids[i],
+        subtreeCounts[i], metric);
+
+    // Use single-tree traverser.
+    typename TreeType::template SingleTreeTraverser<RulesType>
+        traverser(subtreeRules);
+    traverser.Traverse(0, *subtrees[i]);
+
+    subtreeDistanceCalculations += subtreeRules.DistanceCalculations();
+  }
+
+  for (size_t i = 0; i < subtrees.size(); ++i)
+  {
+    newCentroids += subtreeCentroids[i];
+    counts += subtreeCounts[i];
+  }
+  distanceCalculations += subtreeDistanceCalculations;
+
   // Now, calculate how far the clusters moved, after normalizing them.
   double residual = 0.0;
   for (size_t c = 0; c < centroids.n_cols; ++c)
@@ -0,0 +1,113 @@
+/**
+ * @file sharded_kmeans.hpp
+ *
+ * Lloyd iterations of k-means on a dataset that is split into shards, where
+ * only the per-cluster sums of each shard are combined.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_SHARDED_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_SHARDED_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include "naive_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This class runs the Lloyd iterations of k-means on a dataset that is split
+ * into shards, which is the structure of a distributed k-means where each
+ * shard lives on a different machine.  In each iteration, the Lloyd step of
+ * each shard computes the new centroids and counts of the points of that
+ * shard, and only those are combined: the new centroid of each cluster is the
+ * count-weighted mean of the centroids of the shards.  The residual and the
+ * convergence check are computed on the combined centroids, so the
+ * iterations are the same as those of KMeans on all of the points, up to
+ * floating-point rounding.
+ *
+ * Empty clusters keep their centroid from the last iteration, as with the
+ * AllowEmptyClusters policy; the other policies need all of the points.
+ *
+ * @code
+ * std::vector<arma::mat> shards; // Each shard of the dataset.
+ * ShardedKMeans<> kmeans;
+ * arma::mat centroids;
+ * kmeans.Cluster(shards, 10, centroids);
+ * @endcode
+ *
+ * @tparam MetricType The distance metric to use.
+ * @tparam LloydStepType Lloyd step of each shard.  It must not keep state
+ *     about the centroids between iterations (as NaiveKMeans does not),
+ *     because the centroids given to the next iteration are the combined ones.
+ * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         template<class, class> class LloydStepType = NaiveKMeans,
+         typename MatType = arma::mat>
+class ShardedKMeans
+{
+ public:
+  /**
+   * Create the ShardedKMeans object.
+   *
+   * @param maxIterations Maximum number of iterations allowed before giving up
+   *     (0 is valid, but the algorithm may never terminate).
+   * @param metric Optional instantiated metric.
+   */
+  ShardedKMeans(const size_t maxIterations = 1000,
+                const MetricType metric = MetricType());
+
+  /**
+   * Cluster the points of all of the given shards.  If initialGuess is false,
+   * the initial centroids are sampled from the points of the shards.
+   *
+   * @param shards Shards of the dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param centroids Matrix in which the centroids are stored.
+   * @param initialGuess If true, centroids holds the initial centroids.
+   */
+  void Cluster(const std::vector<MatType>& shards,
+               const size_t clusters,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
+  //! Get the number of points of each cluster after the last Cluster() call.
+  const arma::Col<size_t>& Counts() const { return counts; }
+
+  //! Get the number of iterations of the last Cluster() call.
+  size_t Iterations() const { return iterations; }
+
+  //! Get the maximum number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Set the maximum number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the distance metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the distance metric.
+  MetricType& Metric() { return metric; }
+
+ private:
+  //! Maximum number of iterations before giving up.
+  size_t maxIterations;
+  //! Instantiated distance metric.
+  MetricType metric;
+  //! Number of points of each cluster after the last Cluster() call.
+  arma::Col<size_t> counts;
+  //! Number of iterations of the last Cluster() call.
+  size_t iterations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "sharded_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,161 @@
+/**
+ * @file sharded_kmeans_impl.hpp
+ *
+ * Implementation of the ShardedKMeans class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_SHARDED_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_SHARDED_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sharded_kmeans.hpp"
+
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType,
+         template<class, class> class LloydStepType,
+         typename MatType>
+ShardedKMeans<MetricType, LloydStepType, MatType>::ShardedKMeans(
+    const size_t maxIterations,
+    const MetricType metric) :
+    maxIterations(maxIterations),
+    metric(metric),
+    iterations(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void ShardedKMeans<MetricType, LloydStepType, MatType>::Cluster(
+    const std::vector<MatType>& shards,
+    const size_t clusters,
+    arma::mat& centroids,
+    const bool initialGuess)
+{
+  if (shards.empty())
+    throw std::invalid_argument("ShardedKMeans::Cluster(): no shards given");
+
+  size_t numPoints = 0;
+  for (size_t s = 0; s < shards.size(); ++s)
+  {
+    if (shards[s].n_rows != shards[0].n_rows)
+    {
+      std::ostringstream oss;
+      oss << "ShardedKMeans::Cluster(): shard " << s << " has dimensionality "
+          << shards[s].n_rows << ", but shard 0 has dimensionality "
+          << shards[0].n_rows;
+      throw std::invalid_argument(oss.str());
+    }
+
+    numPoints += shards[s].n_cols;
+  }
+
+  if (clusters == 0 || clusters > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "ShardedKMeans::Cluster(): cannot compute " << clusters
+        << " clusters of " << numPoints << " points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t dimensionality = shards[0].n_rows;
+  if (initialGuess)
+  {
+    if (centroids.n_rows != dimensionality || centroids.n_cols != clusters)
+    {
+      std::ostringstream oss;
+      oss << "ShardedKMeans::Cluster(): initial centroids have size "
+          << centroids.n_rows << "x" << centroids.n_cols << ", but should "
+          << "have size " << dimensionality << "x" << clusters;
+      throw std::invalid_argument(oss.str());
+    }
+  }
+  else
+  {
+    // Sample the initial centroids from all of the points.
+    centroids.set_size(dimensionality, clusters);
+    for (size_t i = 0; i < clusters; ++i)
+    {
+      size_t index = math::RandInt(0, numPoints);
+      size_t s = 0;
+      while (index >= shards[s].n_cols)
+        index -= shards[s++].n_cols;
+
+      centroids.col(i) = arma::vec(shards[s].col(index));
+    }
+  }
+
+  std::vector<LloydStepType<MetricType, MatType>*> steps;
+  for (size_t s = 0; s < shards.size(); ++s)
+    steps.push_back(new LloydStepType<MetricType, MatType>(shards[s], metric));
+
+  arma::mat newCentroids;
+  arma::mat shardCentroids;
+  arma::Col<size_t> shardCounts;
+  iterations = 0;
+  double cNorm;
+  do
+  {
+    // Run the Lloyd step of each shard, and combine the sums of the clusters
+    // in shard order.
+    newCentroids.zeros(dimensionality, clusters);
+    counts.zeros(clusters);
+    for (size_t s = 0; s < shards.size(); ++s)
+    {
+      steps[s]->Iterate(centroids, shardCentroids, shardCounts);
+      for (size_t c = 0; c < clusters; ++c)
+      {
+        if (shardCounts[c] > 0)
+          newCentroids.col(c) += shardCounts[c] * shardCentroids.col(c);
+      }
+      counts += shardCounts;
+    }
+
+    cNorm = 0.0;
+    for (size_t c = 0; c < clusters; ++c)
+    {
+      // Empty clusters keep their last centroid.
+      if (counts[c] == 0)
+        newCentroids.col(c) = centroids.col(c);
+      else
+        newCentroids.col(c) /= counts[c];
+
+      cNorm += std::pow(metric.Evaluate(centroids.col(c),
+          newCentroids.col(c)), 2.0);
+    }
+    cNorm = std::sqrt(cNorm);
+    centroids.swap(newCentroids);
+
+    iterations++;
+    Log::Info << "ShardedKMeans::Cluster(): iteration " << iterations
+        << ", residual " << cNorm << ".\n";
+    if (std::isnan(cNorm) || std::isinf(cNorm))
+      cNorm = 1e-4; // Keep iterating.
+  } while (cNorm > 1e-5 && iterations != maxIterations);
+
+  size_t distanceCalculations = 0;
+  for (size_t s = 0; s < shards.size(); ++s)
+  {
+    distanceCalculations += steps[s]->DistanceCalculations();
+    delete steps[s];
+  }
+
+  Log::Info << "ShardedKMeans::Cluster(): " << ((iterations != maxIterations) ?
+      "converged after " : "terminated after limit of ") << iterations
+      << " iterations; " << distanceCalculations << " distance calculations."
+      << std::endl;
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file streaming_kmeans.hpp
+ *
+ * Mini-batch k-means on a stream of batches, so that datasets that do not fit
+ * in memory can be clustered.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_STREAMING_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_STREAMING_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include <functional>
+
+#include "mini_batch_kmeans.hpp"
+#include "sample_initialization.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This class runs mini-batch k-means (Sculley, "Web-scale k-means
+ * clustering", 2010) on batches of points given by a callback, so only one
+ * batch has to be held in memory at a time.  The callback is called repeatedly
+ * to get the next batch, and it should return false once there are no more
+ * batches.  For k-means on a dataset in memory, use KMeans with the
+ * MiniBatchKMeans Lloyd step, or give a callback that samples the dataset.
+ *
+ * @code
+ * // Read batches of 1000 points from some source.
+ * auto source = [&](arma::mat& batch)
+ * {
+ *   return ReadNextBatch(input, 1000, batch);
+ * };
+ *
+ * StreamingKMeans<> skm;
+ * arma::mat centroids;
+ * skm.Cluster(source, 10, centroids);
+ * @endcode
+ *
+ * If no initial centroids are given, they are sampled from the first batch,
+ * which must then hold at least as many points as there are clusters.
+ *
+ * @tparam MetricType The distance metric to use.
+ */
+template<typename MetricType = metric::EuclideanDistance>
+class StreamingKMeans
+{
+ public:
+  //! The type of the callback that gives the next batch.
+  typedef std::function<bool(arma::mat&)> BatchSourceType;
+
+  /**
+   * Create the StreamingKMeans object.
+   *
+   * @param maxBatches Maximum number of batches to process (0 means no limit;
+   *     the algorithm then stops when the source is exhausted or it converges).
+   * @param tolerance Stop when the centroids move less than this after a
+   *     batch.
+   * @param metric Optional instantiated metric.
+   */
+  StreamingKMeans(const size_t maxBatches = 0,
+                  const double tolerance = 1e-5,
+                  const MetricType metric = MetricType());
+
+  /**
+   * Cluster the points given by the source.
+   *
+   * @param source Callback that fills its argument with the next batch and
+   *     returns true, or returns false if there are no more batches.
+   * @param clusters Number of clusters to compute.
+   * @param centroids Matrix in which the centroids are stored.
+   * @param initialGuess If true, centroids holds the initial centroids.
+   */
+  void Cluster(const BatchSourceType& source,
+               const size_t clusters,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
+  //! Get the number of points assigned to each cluster by the last call to
+  //! Cluster().
+  const arma::Col<size_t>& Counts() const { return counts; }
+
+  //! Get the maximum number of batches.
+  size_t MaxBatches() const { return maxBatches; }
+  //! Modify the maximum number of batches.
+  size_t& MaxBatches() { return maxBatches; }
+
+  //! Get the tolerance.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the distance metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the distance metric.
+  MetricType& Metric() { return metric; }
+
+ private:
+  //! Maximum number of batches to process.
+  size_t maxBatches;
+  //! Convergence tolerance.
+  double tolerance;
+  //! Instantiated distance metric.
+  MetricType metric;
+  //! Number of points assigned to each cluster.
+  arma::Col<size_t> counts;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "streaming_kmeans_impl.hpp"
+
+#endif
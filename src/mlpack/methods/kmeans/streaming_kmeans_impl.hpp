@@ -0,0 +1,109 @@
+/**
+ * @file streaming_kmeans_impl.hpp
+ *
+ * Implementation of StreamingKMeans.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_STREAMING_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_STREAMING_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "streaming_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType>
+StreamingKMeans<MetricType>::StreamingKMeans(const size_t maxBatches,
+                                             const double tolerance,
+                                             const MetricType metric) :
+    maxBatches(maxBatches),
+    tolerance(tolerance),
+    metric(metric)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType>
+void StreamingKMeans<MetricType>::Cluster(const BatchSourceType& source,
+                                          const size_t clusters,
+                                          arma::mat& centroids,
+                                          const bool initialGuess)
+{
+  if (initialGuess && centroids.n_cols != clusters)
+    Log::Fatal << "StreamingKMeans::Cluster(): wrong number of initial cluster "
+        << "centroids (" << centroids.n_cols << ", should be " << clusters
+        << ")!" << std::endl;
+
+  counts.zeros(clusters);
+
+  arma::mat batch;
+  arma::Col<size_t> indices;
+  size_t batches = 0;
+  size_t distanceCalculations = 0;
+  double cNorm = DBL_MAX;
+  while ((maxBatches == 0 || batches < maxBatches) && cNorm > tolerance)
+  {
+    if (!source(batch))
+      break;
+
+    if (batch.n_cols == 0)
+      continue;
+
+    if (batches == 0 && !initialGuess)
+    {
+      if (batch.n_cols < clusters)
+        Log::Fatal << "StreamingKMeans::Cluster(): the first batch has fewer "
+            << "points (" << batch.n_cols << ") than clusters (" << clusters
+            << "); cannot sample initial centroids!" << std::endl;
+
+      SampleInitialization::Cluster(batch, clusters, centroids);
+    }
+
+    if (batch.n_rows != centroids.n_rows)
+      Log::Fatal << "StreamingKMeans::Cluster(): batch " << batches << " has "
+          << "dimensionality " << batch.n_rows << ", but the centroids have "
+          << "dimensionality " << centroids.n_rows << "!" << std::endl;
+
+    if (indices.n_elem != batch.n_cols)
+      indices = arma::linspace<arma::Col<size_t>>(0, batch.n_cols - 1,
+          batch.n_cols);
+
+    const arma::mat oldCentroids(centroids);
+    distanceCalculations += MiniBatchKMeans<MetricType, arma::mat>::
+        UpdateCentroids(batch, indices, metric, centroids, counts);
+
+    cNorm = 0.0;
+    for (size_t c = 0; c < clusters; ++c)
+    {
+      cNorm += std::pow(metric.Evaluate(oldCentroids.col(c),
+          centroids.col(c)), 2.0);
+    }
+    cNorm = std::sqrt(cNorm);
+    distanceCalculations += clusters;
+
+    ++batches;
+    Log::Info << "StreamingKMeans::Cluster(): batch " << batches << ", "
+        << "residual " << cNorm << ".\n";
+  }
+
+  if (batches == 0)
+    Log::Warn << "StreamingKMeans::Cluster(): the source gave no points!"
+        << std::endl;
+  else if (cNorm <= tolerance)
+    Log::Info << "StreamingKMeans::Cluster(): converged after " << batches
+        << " batches." << std::endl;
+  else
+    Log::Info << "StreamingKMeans::Cluster(): terminated after " << batches
+        << " batches." << std::endl;
+  Log::Info << distanceCalculations << " distance calculations." << std::endl;
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
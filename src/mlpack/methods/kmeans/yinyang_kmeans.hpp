@@ -0,0 +1,126 @@
+/**
+ * @file yinyang_kmeans.hpp
+ *
+ * An implementation of Yinyang k-means (Ding et al., 2015), which keeps one
+ * lower bound per group of centroids for each point.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * Yinyang k-means splits the centroids into about k / 10 groups, by clustering
+ * the initial centroids, and keeps for each point an upper bound on the
+ * distance to its centroid and a lower bound on the distance to the other
+ * centroids of each group.  Whole groups are pruned with these bounds (the
+ * group filter), and the centroids of the remaining groups are pruned with the
+ * group bound and their own movement (the local filter), so the pruning is
+ * close to that of Elkan's algorithm while the bounds take O(N k / 10) memory
+ * instead of O(N k).  The bounds are stored in single precision, rounded
+ * outwards so that they stay valid, which halves their memory again; the
+ * clustering is the same as that of the naive algorithm.
+ *
+ * The movement of the centroids is measured at the start of each iteration
+ * against the centroids returned by the previous one, so the bounds stay valid
+ * when the empty cluster policy moves a centroid in between.
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @inproceedings{ding2015yinyang,
+ *   title={Yinyang K-means: A Drop-In Replacement of the Classic K-means with
+ *       Consistent Speedup},
+ *   author={Ding, Y. and Zhao, Y. and Shen, X. and Musuvathi, M. and
+ *       Mytkowicz, T.},
+ *   booktitle={Proceedings of the 32nd International Conference on Machine
+ *       Learning (ICML '15)},
+ *   pages={579--587},
+ *   year={2015}
+ * }
+ * @endcode
+ */
+template<typename MetricType, typename MatType>
+class YinyangKMeans
+{
+ public:
+  /**
+   * Construct the YinyangKMeans object, which must store several sets of
+   * bounds.
+   */
+  YinyangKMeans(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Run a single iteration of Yinyang k-means, updating the given centroids
+   * into the newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Current counts, to be overwritten with new counts.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the number of groups of centroids (set on the first iteration).
+  size_t NumGroups() const { return groupStarts.n_elem - 1; }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The indices of the centroids, sorted by group.
+  arma::Col<size_t> groupMembers;
+  //! The index in groupMembers of the first centroid of each group, followed
+  //! by the number of centroids.
+  arma::Col<size_t> groupStarts;
+  //! The group of each centroid.
+  arma::Col<size_t> centroidGroups;
+
+  //! The centroids returned by the last iteration.
+  arma::mat lastCentroids;
+  //! The distance each centroid moved since the last iteration.
+  arma::vec drifts;
+  //! The largest distance a centroid of each group moved.
+  arma::vec groupDrifts;
+
+  //! Upper bounds on the distance between each point and its centroid.
+  arma::fvec upperBounds;
+  //! Lower bounds on the distance between each point (column) and the
+  //! centroids of each group (row) other than its own centroid.
+  arma::fmat lowerBounds;
+  //! Assignments for each point.
+  arma::Col<size_t> assignments;
+
+  //! Track distance calculations.
+  size_t distanceCalculations;
+
+  /**
+   * Split the centroids into groups with a few Lloyd iterations on the
+   * centroids themselves.
+   */
+  void InitializeGroups(const arma::mat& centroids);
+
+  //! Round the given distance up to a float.
+  static float RoundUp(const double distance);
+  //! Round the given distance down to a float.
+  static float RoundDown(const double distance);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "yinyang_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,343 @@
+/**
+ * @file yinyang_kmeans_impl.hpp
+ *
+ * An implementation of Yinyang k-means (Ding et al., 2015), which keeps one
+ * lower bound per group of centroids for each point.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "yinyang_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+YinyangKMeans<MetricType, MatType>::YinyangKMeans(const MatType& dataset,
+                                                  MetricType& metric) :
+    dataset(dataset),
+    metric(metric),
+    groupStarts(1, arma::fill::zeros),
+    distanceCalculations(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename MatType>
+double YinyangKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                   arma::mat& newCentroids,
+                                                   arma::Col<size_t>& counts)
+{
+  // If this is the first iteration, we need to group the centroids and set all
+  // the bounds.
+  if (centroidGroups.n_elem != centroids.n_cols)
+  {
+    InitializeGroups(centroids);
+
+    upperBounds.set_size(dataset.n_cols);
+    upperBounds.fill(std::numeric_limits<float>::infinity());
+    lowerBounds.zeros(NumGroups(), dataset.n_cols);
+    assignments.zeros(dataset.n_cols);
+    drifts.zeros(centroids.n_cols);
+    groupDrifts.zeros(NumGroups());
+  }
+  else
+  {
+    // Find out how far each centroid moved since the last iteration, then
+    // loosen the bounds by that much.
+    groupDrifts.zeros();
+    for (size_t c = 0; c < centroids.n_cols; ++c)
+    {
+      drifts(c) = metric.Evaluate(lastCentroids.col(c), centroids.col(c));
+      groupDrifts(centroidGroups[c]) = std::max(groupDrifts(centroidGroups[c]),
+          drifts(c));
+    }
+    distanceCalculations += centroids.n_cols;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
+    {
+      upperBounds(i) = RoundUp(upperBounds(i) + drifts(assignments[i]));
+      for (size_t g = 0; g < groupDrifts.n_elem; ++g)
+        lowerBounds(g, i) = RoundDown(lowerBounds(g, i) - groupDrifts(g));
+    }
+  }
+
+  // Reset new centroids.
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+
+  // Each thread accumulates the points it assigns into its own partial
+  // centroids; these are summed in thread order afterwards, so the result only
+  // depends on the number of threads.
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+  std::vector<arma::mat> threadCentroids(numThreads);
+  std::vector<arma::Col<size_t>> threadCounts(numThreads);
+  const size_t numGroups = NumGroups();
+  size_t yinyangPruned = 0;
+  size_t iterationDistances = 0;
+
+  #pragma omp parallel reduction(+:yinyangPruned, iterationDistances)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localCentroids = threadCentroids[thread];
+    arma::Col<size_t>& localCounts = threadCounts[thread];
+    localCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    localCounts.zeros(centroids.n_cols);
+
+    // The smallest and second smallest distance (or bound) of each group that
+    // is searched, and the centroid with the smallest one.
+    arma::vec groupMin(numGroups), groupSecondMin(numGroups);
+    arma::Col<size_t> groupMinIndex(numGroups);
+    std::vector<bool> searched(numGroups);
+
+#ifdef _WIN32
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
+    {
+      const size_t assignment = assignments[i];
+      const double globalLowerBound = arma::min(lowerBounds.col(i));
+
+      // Global filter: no other centroid can be closer.
+      if (upperBounds(i) <= globalLowerBound)
+      {
+        ++yinyangPruned;
+        localCentroids.col(assignment) += dataset.col(i);
+        ++localCounts(assignment);
+        continue;
+      }
+
+      // Tighten the upper bound, and try again.
+      const double assignmentDistance = metric.Evaluate(dataset.col(i),
+          centroids.col(assignment));
+      ++iterationDistances;
+      if (assignmentDistance <= globalLowerBound)
+      {
+        upperBounds(i) = RoundUp(assignmentDistance);
+        localCentroids.col(assignment) += dataset.col(i);
+        ++localCounts(assignment);
+        continue;
+      }
+
+      double bestDistance = assignmentDistance;
+      size_t bestCluster = assignment;
+      for (size_t g = 0; g < numGroups; ++g)
+      {
+        // Group filter: no centroid of this group (other than the current
+        // centroid, if it is in the group) can be closer than the best so far.
+        const double lowerBound = lowerBounds(g, i);
+        searched[g] = (lowerBound < bestDistance);
+        if (!searched[g])
+          continue;
+
+        groupMin(g) = DBL_MAX;
+        groupSecondMin(g) = DBL_MAX;
+        groupMinIndex(g) = centroids.n_cols;
+        for (size_t j = groupStarts[g]; j < groupStarts[g + 1]; ++j)
+        {
+          const size_t c = groupMembers[j];
+
+          // Local filter: the lower bound of the group before this iteration
+          // bounds the distance to each of its centroids, less the movement
+          // of that centroid.
+          double distance = assignmentDistance;
+          if (c != assignment)
+          {
+            distance = lowerBound + groupDrifts(g) - drifts(c);
+            if (distance < bestDistance)
+            {
+              distance = metric.Evaluate(dataset.col(i), centroids.col(c));
+              ++iterationDistances;
+              if (distance < bestDistance)
+              {
+                bestDistance = distance;
+                bestCluster = c;
+              }
+            }
+          }
+
+          if (distance < groupMin(g))
+          {
+            groupSecondMin(g) = groupMin(g);
+            groupMin(g) = distance;
+            groupMinIndex(g) = c;
+          }
+          else if (distance < groupSecondMin(g))
+          {
+            groupSecondMin(g) = distance;
+          }
+        }
+      }
+
+      // Now that the closest centroid is known, set the group bounds: each
+      // searched group is bounded by its smallest distance other than that of
+      // the new centroid, and the group of the old centroid must also bound
+      // the distance to it.
+      for (size_t g = 0; g < numGroups; ++g)
+      {
+        if (searched[g])
+        {
+          lowerBounds(g, i) = RoundDown((groupMinIndex(g) == bestCluster) ?
+              groupSecondMin(g) : groupMin(g));
+        }
+      }
+
+      const size_t oldGroup = centroidGroups[assignment];
+      if (bestCluster != assignment && !searched[oldGroup])
+      {
+        lowerBounds(oldGroup, i) = std::min(lowerBounds(oldGroup, i),
+            RoundDown(assignmentDistance));
+      }
+
+      upperBounds(i) = RoundUp(bestDistance);
+      assignments[i] = bestCluster;
+      localCentroids.col(bestCluster) += dataset.col(i);
+      ++localCounts(bestCluster);
+    }
+  }
+
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    // A thread may not have run, if the runtime gave us fewer threads.
+    if (threadCounts[t].n_elem == 0)
+      continue;
+
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
+  }
+  distanceCalculations += iterationDistances;
+
+  // Normalize centroids and calculate cluster movement.
+  double centroidMovement = 0.0;
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+  {
+    if (counts(c) > 0)
+      newCentroids.col(c) /= counts(c);
+
+    centroidMovement += std::pow(metric.Evaluate(centroids.col(c),
+        newCentroids.col(c)), 2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  // Keep the new centroids, to measure how far they are moved before the next
+  // iteration.
+  lastCentroids = newCentroids;
+
+  Log::Info << "Yinyang prunes: " << yinyangPruned << ".\n";
+
+  return std::sqrt(centroidMovement);
+}
+
+template<typename MetricType, typename MatType>
+void YinyangKMeans<MetricType, MatType>::InitializeGroups(
+    const arma::mat& centroids)
+{
+  const size_t k = centroids.n_cols;
+  const size_t numGroups = std::max(k / 10, (size_t) 1);
+
+  // Start from evenly spaced centroids, and run a few Lloyd iterations on the
+  // centroids; a group that becomes empty keeps its position.
+  arma::mat groupCentroids(centroids.n_rows, numGroups);
+  for (size_t g = 0; g < numGroups; ++g)
+    groupCentroids.col(g) = centroids.col(g * k / numGroups);
+
+  centroidGroups.set_size(k);
+  arma::Col<size_t> groupCounts(numGroups);
+  for (size_t iteration = 0; iteration < 5; ++iteration)
+  {
+    for (size_t c = 0; c < k; ++c)
+    {
+      double minDistance = DBL_MAX;
+      for (size_t g = 0; g < numGroups; ++g)
+      {
+        const double distance = metric.Evaluate(centroids.col(c),
+            groupCentroids.col(g));
+        if (distance < minDistance)
+        {
+          minDistance = distance;
+          centroidGroups[c] = g;
+        }
+      }
+    }
+    distanceCalculations += k * numGroups;
+
+    arma::mat newGroupCentroids(centroids.n_rows, numGroups,
+        arma::fill::zeros);
+    groupCounts.zeros();
+    for (size_t c = 0; c < k; ++c)
+    {
+      newGroupCentroids.col(centroidGroups[c]) += centroids.col(c);
+      ++groupCounts[centroidGroups[c]];
+    }
+
+    for (size_t g = 0; g < numGroups; ++g)
+    {
+      if (groupCounts[g] > 0)
+        groupCentroids.col(g) = newGroupCentroids.col(g) / groupCounts[g];
+    }
+  }
+
+  // Sort the centroids by group.
+  groupStarts.zeros(numGroups + 1);
+  for (size_t g = 0; g < numGroups; ++g)
+    groupStarts[g + 1] = groupStarts[g] + groupCounts[g];
+
+  groupMembers.set_size(k);
+  arma::Col<size_t> next = groupStarts.head(numGroups);
+  for (size_t c = 0; c < k; ++c)
+    groupMembers[next[centroidGroups[c]]++] = c;
+}
+
+template<typename MetricType, typename MatType>
+float YinyangKMeans<MetricType, MatType>::RoundUp(const double distance)
+{
+  if (distance >= std::numeric_limits<float>::max())
+    return std::numeric_limits<float>::infinity();
+
+  float bound = (float) distance;
+  if (bound < distance)
+    bound = std::nextafter(bound, std::numeric_limits<float>::infinity());
+  return bound;
+}
+
+template<typename MetricType, typename MatType>
+float YinyangKMeans<MetricType, MatType>::RoundDown(const double distance)
+{
+  if (distance >= std::numeric_limits<float>::max())
+    return std::numeric_limits<float>::max();
+
+  float bound = (float) distance;
+  if (bound > distance)
+    bound = std::nextafter(bound, -std::numeric_limits<float>::infinity());
+  return bound;
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -13,6 +13,10 @@
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/timers.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::regression;
 
@@ -26,7 +30,8 @@ LARS::LARS(const bool useCholesky,
     lambda1(lambda1),
     elasticNet((lambda1 != 0) && (lambda2 != 0)),
     lambda2(lambda2),
-    tolerance(tolerance)
+    tolerance(tolerance),
+    incrementalCorrelations(false)
 { /* Nothing left to do. */ }
 
 LARS::LARS(const bool useCholesky,
@@ -40,7 +45,8 @@ LARS::LARS(const bool useCholesky,
     lambda1(lambda1),
     elasticNet((lambda1 != 0) && (lambda2 != 0)),
     lambda2(lambda2),
-    tolerance(tolerance)
+    tolerance(tolerance),
+    incrementalCorrelations(false)
 { /* Nothing left to do */ }
 
 LARS::LARS(const arma::mat& data,
@@ -56,7 +62,8 @@ LARS::LARS(const arma::mat& data,
     lambda1(lambda1),
     elasticNet((lambda1 != 0) && (lambda2 != 0)),
     lambda2(lambda2),
-    tolerance(tolerance)
+    tolerance(tolerance),
+    incrementalCorrelations(false)
 {
   arma::rowvec rowResponses = responses.t();
   Train(data, rowResponses, transposeData);
@@ -76,7 +83,8 @@ LARS::LARS(const arma::mat& data,
     lambda1(lambda1),
     elasticNet((lambda1 != 0) && (lambda2 != 0)),
     lambda2(lambda2),
-    tolerance(tolerance)
+    tolerance(tolerance),
+    incrementalCorrelations(false)
 {
   arma::rowvec rowResponses = responses.t();
   Train(data, rowResponses, transposeData);
@@ -130,7 +138,8 @@ void LARS::Train(const arma::mat& matX,
                  arma::vec& beta,
                  const bool transposeData)
 {
-  Timer::Start("lars_regression");
+  // A scoped timer, since LARS may be trained on several threads at once.
+  ScopedTimer timer("lars_regression");
 
   // Clear any previous solution information.
   betaPath.clear();
@@ -185,7 +194,6 @@ void LARS::Train(const arma::mat& matX,
   if (maxCorr < lambda1)
   {
     lambdaPath[0] = lambda1;
-    Timer::Stop("lars_regression");
     return;
   }
 
@@ -315,8 +323,20 @@ void LARS::Train(const arma::mat& matX,
       }
     }
 
-    // compute "equiangular" direction in output space
-    ComputeYHatDirection(dataRef, betaDirection, yHatDirection);
+    // Compute the correlations of all dimensions with the "equiangular"
+    // direction in output space.  Without the Gram matrix, this is one
+    // matrix-vector product with the data.
+    arma::vec dirCorr;
+    if (incrementalCorrelations)
+    {
+      ComputeDirectionCorrelations(betaDirection, dirCorr);
+    }
+    else
+    {
+      // compute "equiangular" direction in output space
+      ComputeYHatDirection(dataRef, betaDirection, yHatDirection);
+      dirCorr = trans(dataRef) * yHatDirection;
+    }
 
     double gamma = maxCorr / normalization;
 
@@ -329,9 +349,8 @@ void LARS::Train(const arma::mat& matX,
         if (isActive[ind] || isIgnored[ind])
           continue;
 
-        double dirCorr = dot(dataRef.col(ind), yHatDirection);
-        double val1 = (maxCorr - corr(ind)) / (normalization - dirCorr);
-        double val2 = (maxCorr + corr(ind)) / (normalization + dirCorr);
+        double val1 = (maxCorr - corr(ind)) / (normalization - dirCorr(ind));
+        double val2 = (maxCorr + corr(ind)) / (normalization + dirCorr(ind));
         if ((val1 > 0) && (val1 < gamma))
           gamma = val1;
         if ((val2 > 0) && (val2 < gamma))
@@ -364,8 +383,24 @@ void LARS::Train(const arma::mat& matX,
       }
     }
 
-    // Update the prediction.
-    yHat += gamma * yHatDirection;
+    // Update the prediction, or directly the correlations (while the active
+    // set still matches betaDirection).
+    if (incrementalCorrelations)
+    {
+      corr -= gamma * dirCorr;
+
+      // Without Cholesky decomposition, lambda2 * I is part of the Gram
+      // matrix already.
+      if (elasticNet && useCholesky)
+      {
+        for (size_t i = 0; i < activeSet.size(); i++)
+          corr(activeSet[i]) -= lambda2 * gamma * betaDirection(i);
+      }
+    }
+    else
+    {
+      yHat += gamma * yHatDirection;
+    }
 
     // Update the estimator.
     for (size_t i = 0; i < activeSet.size(); i++)
@@ -391,9 +426,12 @@ void LARS::Train(const arma::mat& matX,
       Deactivate(changeInd);
     }
 
-    corr = vecXTy - trans(dataRef) * yHat;
-    if (elasticNet)
-      corr -= lambda2 * beta;
+    if (!incrementalCorrelations)
+    {
+      corr = vecXTy - trans(dataRef) * yHat;
+      if (elasticNet)
+        corr -= lambda2 * beta;
+    }
 
     double curLambda = 0;
     for (size_t i = 0; i < activeSet.size(); i++)
@@ -416,8 +454,6 @@ void LARS::Train(const arma::mat& matX,
 
   // Unfortunate copy...
   beta = betaPath.back();
-
-  Timer::Stop("lars_regression");
 }
 
 void LARS::Train(const arma::mat& data,
@@ -476,6 +512,33 @@ void LARS::ComputeYHatDirection(const arma::mat& matX,
     yHatDirection += betaDirection(i) * matX.col(activeSet[i]);
 }
 
+void LARS::ComputeDirectionCorrelations(const arma::vec& betaDirection,
+                                        arma::vec& dirCorr) const
+{
+  // The Gram matrix is symmetric, so row j of G(:, A) is the active part of
+  // column j, which is contiguous in memory.
+  const size_t dims = matGram->n_cols;
+  dirCorr.set_size(dims);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t j = 0; j < (intmax_t) dims; ++j)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t j = 0; j < dims; ++j)
+#endif
+  {
+    const double* gramCol = matGram->colptr(j);
+    double sum = 0.0;
+    for (size_t i = 0; i < activeSet.size(); ++i)
+      sum += gramCol[activeSet[i]] * betaDirection[i];
+    dirCorr[j] = sum;
+  }
+}
+
 void LARS::InterpolateBeta()
 {
   int pathLength = betaPath.size();
@@ -58,6 +58,14 @@ namespace regression {
  * Note: This algorithm is not recommended for use (in terms of efficiency)
  * when \f$ \lambda_1 \f$ = 0.
  *
+ * By default, the correlations \f$ X^T (y - X \beta) \f$ are recomputed from
+ * the data at each step, which takes O(n d) time for n points and d
+ * dimensions.  If IncrementalCorrelations() is set, they are instead updated
+ * at each step from the columns of the Gram matrix for the active set, in
+ * O(d |A|) time for an active set A (in parallel, if OpenMP is available), so
+ * that after the Gram matrix is computed, no step of the path has to go
+ * through the data.  The results are the same, up to floating-point rounding.
+ *
  * For more details, see the following papers:
  *
  * @code
@@ -333,6 +341,11 @@ class LARS
   //! Access the upper triangular cholesky factor.
   const arma::mat& MatUtriCholFactor() const { return matUtriCholFactor; }
 
+  //! Get whether the correlations are updated from the Gram matrix.
+  bool IncrementalCorrelations() const { return incrementalCorrelations; }
+  //! Modify whether the correlations are updated from the Gram matrix.
+  bool& IncrementalCorrelations() { return incrementalCorrelations; }
+
   /**
    * Serialize the LARS model.
    */
@@ -365,6 +378,9 @@ class LARS
   //! Tolerance for main loop.
   double tolerance;
 
+  //! Whether to update the correlations from the Gram matrix at each step.
+  bool incrementalCorrelations;
+
   //! Solution path.
   std::vector<arma::vec> betaPath;
 
@@ -411,6 +427,17 @@ class LARS
                             const arma::vec& betaDirection,
                             arma::vec& yHatDirection);
 
+  /**
+   * Compute the correlations of every dimension with the "equiangular"
+   * direction in output space, from the columns of the Gram matrix for the
+   * active set (that is, G(:, A) * betaDirection).
+   *
+   * @param betaDirection Direction in parameter space, for the active set.
+   * @param dirCorr Vector to store the correlations in.
+   */
+  void ComputeDirectionCorrelations(const arma::vec& betaDirection,
+                                    arma::vec& dirCorr) const;
+
   // interpolate to compute last solution vector
   void InterpolateBeta();
 
@@ -71,6 +71,8 @@ PARAM_DOUBLE_IN("lambda2", "Regularization parameter for l2-norm penalty.", "L",
     0);
 PARAM_FLAG("use_cholesky", "Use Cholesky decomposition during computation "
     "rather than explicitly computing the full Gram matrix.", "c");
+PARAM_FLAG("incremental_correlations", "Update the correlations at each step "
+    "from the Gram matrix, instead of recomputing them from the data.", "I");
 
 int main(int argc, char* argv[])
 {
@@ -115,6 +117,7 @@ int main(int argc, char* argv[])
 
   // Initialize the object.
   LARS lars(useCholesky, lambda1, lambda2);
+  lars.IncrementalCorrelations() = CLI::HasParam("incremental_correlations");
 
   if (CLI::HasParam("input"))
   {
@@ -37,14 +37,19 @@ LinearRegression::LinearRegression(const arma::mat& predictors,
                                    const double lambda,
                                    const bool intercept) :
     lambda(lambda),
-    intercept(intercept)
+    intercept(intercept),
+    numPoints(0)
 {
   Train(predictors, responses, weights, intercept);
 }
 
 LinearRegression::LinearRegression(const LinearRegression& linearRegression) :
     parameters(linearRegression.parameters),
-    lambda(linearRegression.lambda)
+    lambda(linearRegression.lambda),
+    intercept(linearRegression.intercept),
+    gram(linearRegression.gram),
+    moments(linearRegression.moments),
+    numPoints(linearRegression.numPoints)
 { /* Nothing to do. */ }
 
 void LinearRegression::Train(const arma::mat& predictors,
@@ -69,6 +74,12 @@ void LinearRegression::Train(const arma::mat& predictors,
 {
   this->intercept = intercept;
 
+  // The statistics of any previous calls to Update() don't describe this model
+  // anymore.
+  gram.reset();
+  moments.reset();
+  numPoints = 0;
+
   /*
    * We want to calculate the a_i coefficients of:
    * \sum_{i=0}^n (a_i * x_i^i)
@@ -127,6 +138,141 @@ void LinearRegression::Train(const arma::mat& predictors,
   }
 }
 
+void LinearRegression::Update(const arma::mat& predictors,
+                              const arma::rowvec& responses,
+                              const bool solve)
+{
+  Update(predictors, responses, arma::rowvec(), solve);
+}
+
+void LinearRegression::Update(const arma::mat& predictors,
+                              const arma::rowvec& responses,
+                              const arma::rowvec& weights,
+                              const bool solve)
+{
+  if (responses.n_elem != predictors.n_cols)
+  {
+    Log::Fatal << "LinearRegression::Update(): the batch has "
+        << predictors.n_cols << " points, but " << responses.n_elem
+        << " responses!" << std::endl;
+  }
+
+  if (weights.n_elem > 0 && weights.n_elem != predictors.n_cols)
+  {
+    Log::Fatal << "LinearRegression::Update(): the batch has "
+        << predictors.n_cols << " points, but " << weights.n_elem
+        << " weights!" << std::endl;
+  }
+
+  InitializeStatistics(predictors.n_rows);
+
+  // If there is an intercept, the first row and column of the statistics hold
+  // the intercept terms, so that the statistics are those of the predictors
+  // with a row of ones added, without having to copy the predictors.
+  const size_t offset = intercept ? 1 : 0;
+  const size_t last = gram.n_rows - 1;
+  if (weights.n_elem == 0)
+  {
+    gram.submat(offset, offset, last, last) += predictors * predictors.t();
+    moments.subvec(offset, last) += predictors * responses.t();
+
+    if (intercept)
+    {
+      const arma::vec sums = arma::sum(predictors, 1);
+      gram(0, 0) += predictors.n_cols;
+      gram.submat(1, 0, last, 0) += sums;
+      gram.submat(0, 1, 0, last) += sums.t();
+      moments(0) += arma::accu(responses);
+    }
+  }
+  else
+  {
+    const arma::mat weighted = predictors.each_row() % weights;
+    gram.submat(offset, offset, last, last) += weighted * predictors.t();
+    moments.subvec(offset, last) += weighted * responses.t();
+
+    if (intercept)
+    {
+      const arma::vec sums = arma::sum(weighted, 1);
+      gram(0, 0) += arma::accu(weights);
+      gram.submat(1, 0, last, 0) += sums;
+      gram.submat(0, 1, 0, last) += sums.t();
+      moments(0) += arma::dot(weights, responses);
+    }
+  }
+
+  numPoints += predictors.n_cols;
+
+  if (solve)
+    Solve();
+}
+
+void LinearRegression::Merge(const LinearRegression& other, const bool solve)
+{
+  if (other.intercept != intercept)
+  {
+    Log::Fatal << "LinearRegression::Merge(): cannot merge a model "
+        << (other.intercept ? "with" : "without") << " an intercept into a "
+        << "model " << (intercept ? "with" : "without") << " one!"
+        << std::endl;
+  }
+
+  if (other.numPoints > 0)
+  {
+    InitializeStatistics(other.gram.n_rows - (intercept ? 1 : 0));
+    gram += other.gram;
+    moments += other.moments;
+    numPoints += other.numPoints;
+  }
+
+  if (solve)
+    Solve();
+}
+
+void LinearRegression::Solve()
+{
+  if (numPoints == 0)
+  {
+    Log::Fatal << "LinearRegression::Solve(): no points have been given to "
+        << "Update()!" << std::endl;
+  }
+
+  // The normal equations are (X X^T + lambda I) B = X y, where the intercept is
+  // not penalized.
+  arma::mat a = gram;
+  for (size_t i = (intercept ? 1 : 0); i < a.n_rows; ++i)
+    a(i, i) += lambda;
+
+  // With a = R^T R, solve R^T z = X y, then R B = z.
+  arma::mat r;
+  if (arma::chol(r, a))
+  {
+    const arma::vec z = arma::solve(arma::trimatl(r.t()), moments);
+    parameters = arma::solve(arma::trimatu(r), z);
+  }
+  else
+  {
+    // The matrix is singular; take the minimum-norm solution.
+    parameters = arma::pinv(a) * moments;
+  }
+}
+
+void LinearRegression::InitializeStatistics(const size_t dimensionality)
+{
+  const size_t size = dimensionality + (intercept ? 1 : 0);
+  if (numPoints == 0)
+  {
+    gram.zeros(size, size);
+    moments.zeros(size);
+  }
+  else if (gram.n_rows != size)
+  {
+    Log::Fatal << "LinearRegression::Update(): the batch has " << dimensionality
+        << " dimensions, but the model was updated with points of "
+        << (gram.n_rows - (intercept ? 1 : 0)) << " dimensions!" << std::endl;
+  }
+}
+
 void LinearRegression::Predict(const arma::mat& points, arma::vec& predictions)
     const
 {
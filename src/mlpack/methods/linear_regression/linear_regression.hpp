@@ -22,6 +22,25 @@ namespace regression /** Regression methods. */ {
  * A simple linear regression algorithm using ordinary least squares.
  * Optionally, this class can perform ridge regression, if the lambda parameter
  * is set to a number greater than zero.
+ *
+ * The model can be trained at once on all the data with Train(), or
+ * incrementally with Update(), which only accumulates the sufficient statistics
+ * X X^T and X y of each batch and solves the normal equations with a Cholesky
+ * decomposition.  Incremental training needs O(d^2) memory for d dimensions,
+ * whatever the number of points, so a dataset that does not fit in memory can
+ * be fit one shard at a time; models trained on different shards (for
+ * instance, in parallel) can then be combined with Merge().
+ *
+ * @code
+ * LinearRegression lr;
+ * lr.Lambda() = 0.01;
+ * for (size_t i = 0; i < numShards; ++i)
+ * {
+ *   // Load the shard, then accumulate it without solving.
+ *   lr.Update(shardPredictors, shardResponses, false);
+ * }
+ * lr.Solve();
+ * @endcode
  */
 class LinearRegression
 {
@@ -81,14 +100,13 @@ class LinearRegression
    * called (or make sure the model parameters are set) before calling
    * Predict()!
    */
-  LinearRegression() : lambda(0.0), intercept(true) { }
+  LinearRegression() : lambda(0.0), intercept(true), numPoints(0) { }
 
   /**
    * Train the LinearRegression model on the given data.  Careful!  This will
-   * completely ignore and overwrite the existing model.  This particular
-   * implementation does not have an incremental training algorithm.  To set the
-   * regularization parameter lambda, call Lambda() or set a different value in
-   * the constructor.
+   * completely ignore and overwrite the existing model.  For incremental
+   * training, use Update() instead.  To set the regularization parameter
+   * lambda, call Lambda() or set a different value in the constructor.
    *
    * @param predictors X, the matrix of data points to train the model on.
    * @param responses y, the vector of responses to each data point.
@@ -102,10 +120,9 @@ class LinearRegression
 
   /**
    * Train the LinearRegression model on the given data. Careful! This will
-   * completely ignore and overwrite the existing model. This particular
-   * implementation does not have an incremental training algorithm.  To set the
-   * regularization parameter lambda, call Lambda() or set a different value in
-   * the constructor.
+   * completely ignore and overwrite the existing model. For incremental
+   * training, use Update() instead.  To set the regularization parameter
+   * lambda, call Lambda() or set a different value in the constructor.
    *
    * @param predictors X, the matrix of data points to train the model on.
    * @param responses y, the responses to the data points.
@@ -117,10 +134,10 @@ class LinearRegression
 
   /**
    * Train the LinearRegression model on the given data and weights. Careful!
-   * This will completely ignore and overwrite the existing model. This
-   * particular implementation does not have an incremental training algorithm.
-   * To set the regularization parameter lambda, call Lambda() or set a
-   * different value in the constructor.
+   * This will completely ignore and overwrite the existing model. For
+   * incremental training, use Update() instead.  To set the regularization
+   * parameter lambda, call Lambda() or set a different value in the
+   * constructor.
    *
    * @param predictors X, the matrix of data points to train the model on.
    * @param responses y, the responses to the data points.
@@ -132,6 +149,61 @@ class LinearRegression
              const arma::rowvec& weights,
              const bool intercept = true);
 
+  /**
+   * Add the given batch of points to the sufficient statistics of the model
+   * (X X^T and X y, along with the intercept terms, if the model has an
+   * intercept), and, if solve is true, solve for the parameters.  The
+   * statistics are kept across calls, so after Update() has been called on
+   * every batch of a dataset, the parameters are the least-squares solution
+   * for the whole dataset.  The statistics of Train() are not kept, so the
+   * first call to Update() after Train() (or on an untrained model) starts
+   * new statistics.  Every batch must have the same dimensionality.
+   *
+   * To fit many batches, pass solve = false and call Solve() once at the end.
+   *
+   * @param predictors X, the batch of data points.
+   * @param responses y, the responses to the data points.
+   * @param solve Whether to solve for the parameters after the update.
+   */
+  void Update(const arma::mat& predictors,
+              const arma::rowvec& responses,
+              const bool solve = true);
+
+  /**
+   * Add the given batch of weighted points to the sufficient statistics of the
+   * model, and, if solve is true, solve for the parameters.  See the other
+   * overload of Update() for more details.
+   *
+   * @param predictors X, the batch of data points.
+   * @param responses y, the responses to the data points.
+   * @param weights Observation weights (for boosting).
+   * @param solve Whether to solve for the parameters after the update.
+   */
+  void Update(const arma::mat& predictors,
+              const arma::rowvec& responses,
+              const arma::rowvec& weights,
+              const bool solve = true);
+
+  /**
+   * Add the sufficient statistics accumulated by Update() in another model
+   * (for instance, one trained on another shard of the dataset) to the
+   * statistics of this model, and, if solve is true, solve for the parameters.
+   * Both models must use the same intercept setting and dimensionality.
+   *
+   * @param other Model to take the statistics of.
+   * @param solve Whether to solve for the parameters after the merge.
+   */
+  void Merge(const LinearRegression& other, const bool solve = true);
+
+  /**
+   * Solve for the parameters from the sufficient statistics accumulated by
+   * Update() and Merge(), using the current value of lambda.  The normal
+   * equations are solved with a Cholesky decomposition; if that fails (which
+   * may happen when lambda is 0 and the points do not span the whole space),
+   * the minimum-norm solution is used instead.
+   */
+  void Solve();
+
   /**
    * Calculate y_i for each data point in points.
    *
@@ -201,16 +273,37 @@ class LinearRegression
 
   //! Return whether or not an intercept term is used in the model.
   bool Intercept() const { return intercept; }
+  //! Modify whether or not an intercept term is used in the model.  This must
+  //! not be changed between calls to Update().
+  bool& Intercept() { return intercept; }
+
+  //! Return the number of points accumulated by Update().
+  size_t NumPoints() const { return numPoints; }
 
   /**
    * Serialize the model.
    */
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */)
+  void Serialize(Archive& ar, const unsigned int version)
   {
     ar & data::CreateNVP(parameters, "parameters");
     ar & data::CreateNVP(lambda, "lambda");
     ar & data::CreateNVP(intercept, "intercept");
+
+    // Backward compatibility: older versions of LinearRegression didn't have
+    // the sufficient statistics.
+    if (version > 0)
+    {
+      ar & data::CreateNVP(gram, "gram");
+      ar & data::CreateNVP(moments, "moments");
+      ar & data::CreateNVP(numPoints, "numPoints");
+    }
+    else if (Archive::is_loading::value)
+    {
+      gram.reset();
+      moments.reset();
+      numPoints = 0;
+    }
   }
 
  private:
@@ -228,9 +321,28 @@ class LinearRegression
 
   //! Indicates whether first parameter is intercept.
   bool intercept;
+
+  //! The accumulated X X^T (with the intercept row and column, if any).
+  arma::mat gram;
+  //! The accumulated X y (with the intercept term, if any).
+  arma::vec moments;
+  //! The number of points accumulated by Update().
+  size_t numPoints;
+
+  //! Check that the statistics can hold points of the given dimensionality,
+  //! and initialize them if they are empty.
+  void InitializeStatistics(const size_t dimensionality);
 };
 
 } // namespace regression
 } // namespace mlpack
 
+//! Set the serialization version of the LinearRegression class.  Version 1
+//! added the sufficient statistics.
+BOOST_TEMPLATE_CLASS_VERSION(template<>, mlpack::regression::LinearRegression,
+    1);
+
+// Include the specialization of FoldTrainer for cross-validation.
+#include "linear_regression_fold_trainer.hpp"
+
 #endif // MLPACK_METHODS_LINEAR_REGRESSION_HPP
@@ -0,0 +1,89 @@
+/**
+ * @file linear_regression_fold_trainer.hpp
+ *
+ * Specialization of FoldTrainer for LinearRegression, which shares the
+ * sufficient statistics of each fold between the models of the other folds.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LINEAR_REGRESSION_LINEAR_REGRESSION_FOLD_TRAINER_HPP
+#define MLPACK_METHODS_LINEAR_REGRESSION_LINEAR_REGRESSION_FOLD_TRAINER_HPP
+
+#include <mlpack/core/cv/fold_trainer.hpp>
+#include "linear_regression.hpp"
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * The model of a fold is the least-squares solution for the points of the
+ * other folds, so the sufficient statistics (X X^T and X y) of each fold are
+ * accumulated once, and the model of every fold merges those of the other
+ * folds before solving the normal equations.  The points are then read once
+ * instead of k - 1 times.
+ */
+template<>
+class FoldTrainer<regression::LinearRegression>
+{
+ public:
+  /**
+   * Train the model of every fold.
+   *
+   * @param cv The cross-validation to train the models of.
+   * @param models Vector of cv.K() models to fill.
+   * @param lambda Regularization constant for ridge regression.
+   * @param intercept Whether or not to include an intercept term.
+   */
+  template<typename CVType>
+  static void Train(
+      const CVType& cv,
+      std::vector<std::unique_ptr<regression::LinearRegression>>& models,
+      const double lambda = 0,
+      const bool intercept = true)
+  {
+    std::vector<regression::LinearRegression> statistics(cv.K());
+
+  #ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) cv.K(); ++i)
+  #else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < cv.K(); ++i)
+  #endif
+    {
+      typename CVType::DatasetType data;
+      typename CVType::ResponsesType responses;
+      cv.Fold(i, data, responses);
+
+      statistics[i].Intercept() = intercept;
+      statistics[i].Update(data, responses, false);
+    }
+
+  #ifdef _WIN32
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) cv.K(); ++i)
+  #else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < cv.K(); ++i)
+  #endif
+    {
+      models[i].reset(new regression::LinearRegression());
+      models[i]->Lambda() = lambda;
+      models[i]->Intercept() = intercept;
+      for (size_t j = 0; j < cv.K(); ++j)
+        if (j != (size_t) i)
+          models[i]->Merge(statistics[j], false);
+      models[i]->Solve();
+    }
+  }
+};
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
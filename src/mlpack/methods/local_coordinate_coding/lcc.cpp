@@ -34,32 +34,46 @@ void LocalCoordinateCoding::Encode(const arma::mat& data, arma::mat& codes)
       data.n_cols) + repmat(sum(square(data)), atoms, 1) - 2 * trans(dictionary)
       * data);
 
-  arma::mat dictGram = trans(dictionary) * dictionary;
-  arma::mat dictGramTD(dictGram.n_rows, dictGram.n_cols);
+  // The Gram matrix of the dictionary is computed once and shared by all
+  // threads; the weighted Gram matrix of each point is W G W.
+  const arma::mat dictGram = trans(dictionary) * dictionary;
 
+  Log::Debug << "Encoding " << data.n_cols << " points." << std::endl;
+
+  // Every point is an independent weighted LARS problem, so the points are
+  // encoded in parallel; each thread keeps its own work matrices.
   codes.set_size(atoms, data.n_cols);
-  for (size_t i = 0; i < data.n_cols; i++)
+  #pragma omp parallel
   {
-    // Report progress.
-    if ((i % 100) == 0)
+    arma::mat dictPrime, dictGramTD;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) data.n_cols; i++)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < data.n_cols; i++)
+#endif
     {
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-    }
+      const arma::vec invW = invSqDists.unsafe_col(i);
+      dictPrime = dictionary;
+      dictPrime.each_row() %= invW.t();
 
-    arma::vec invW = invSqDists.unsafe_col(i);
-    arma::mat dictPrime = dictionary * diagmat(invW);
+      dictGramTD = dictGram % (invW * invW.t());
 
-    arma::mat dictGramTD = diagmat(invW) * dictGram * diagmat(invW);
+      bool useCholesky = false;
+      regression::LARS lars(useCholesky, dictGramTD, 0.5 * lambda);
 
-    bool useCholesky = false;
-    regression::LARS lars(useCholesky, dictGramTD, 0.5 * lambda);
-
-    // Run LARS for this point, by making an alias of the point and passing
-    // that.
-    arma::vec beta = codes.unsafe_col(i);
-    arma::rowvec responses = data.unsafe_col(i).t();
-    lars.Train(dictPrime, responses, beta, false);
-    beta %= invW; // Remember, beta is an alias of codes.col(i).
+      // Run LARS for this point, by making an alias of the point and passing
+      // that.
+      arma::vec beta = codes.unsafe_col(i);
+      arma::rowvec responses = data.unsafe_col(i).t();
+      lars.Train(dictPrime, responses, beta, false);
+      beta %= invW; // Remember, beta is an alias of codes.col(i).
+    }
   }
 }
 
@@ -90,6 +90,20 @@ class LogisticRegressionFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluate the logistic regression log-likelihood function and its gradient
+   * with the given parameters, in one pass over the data.  The points are
+   * split into one contiguous block per OpenMP thread, each thread computes
+   * the objective and the gradient of its block, and the results are summed.
+   * This is used by L-BFGS (see HasEvaluateWithGradient).
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param gradient Vector to output gradient into.
+   * @return The objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
   /**
    * Evaluate the gradient of the logistic regression log-likelihood function
    * with the given parameters, and with respect to only one point in the
@@ -104,6 +118,73 @@ class LogisticRegressionFunction
                 const size_t i,
                 arma::mat& gradient) const;
 
+  /**
+   * Evaluate the logistic regression log-likelihood function and its gradient
+   * with respect to only one point in the dataset, computing the sigmoid of
+   * the point once.  This is used by SGD (see EvaluateWithGradientBatch()).
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of point to use for objective function evaluation.
+   * @param gradient Vector to output gradient into.
+   * @return The objective function of the point.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t i,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the gradient of the logistic regression log-likelihood function
+   * with respect to only one point in the dataset, as a sparse matrix.  This
+   * is only available for sparse data (MatType is arma::sp_mat).  Without
+   * regularization, only the intercept and the parameters of the non-zero
+   * features of the point are non-zero, so the optimizers that use sparse
+   * gradients (see HasSparseGradient) only update those; with regularization,
+   * every parameter is non-zero.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of points to use for objective function gradient evaluation.
+   * @param gradient Sparse vector to output gradient into.
+   */
+  template<typename T = MatType>
+  typename std::enable_if<arma::is_arma_sparse_type<T>::value>::type
+  Gradient(const arma::mat& parameters,
+           const size_t i,
+           arma::sp_mat& gradient) const;
+
+  /**
+   * Return the derivative of the objective of one point with respect to its
+   * linear score (the intercept plus the dot product of the point and the
+   * weights).  Without regularization, the gradient of the point is this
+   * coefficient times the point, with a 1 prepended for the intercept; this is
+   * used by SAGA to store one scalar per point (see HasLinearGradient).
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of point to use.
+   */
+  double GradientCoefficient(const arma::mat& parameters, const size_t i) const;
+
+  /**
+   * Add the given multiple of point i, with a 1 prepended for the intercept, to
+   * the given gradient.
+   *
+   * @param i Index of point to add.
+   * @param scale Multiple of the point to add.
+   * @param gradient Vector to add the point to.
+   */
+  void AddScaledPoint(const size_t i,
+                      const double scale,
+                      arma::mat& gradient) const;
+
+  /**
+   * Evaluate the gradient of the L2-regularization term of the whole
+   * objective; the separable gradients each include 1 / NumFunctions() of it.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param gradient Vector to output gradient into.
+   */
+  void RegularizationGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
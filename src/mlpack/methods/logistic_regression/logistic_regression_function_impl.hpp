@@ -15,6 +15,10 @@
 // In case it hasn't been included yet.
 #include "logistic_regression_function.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace regression {
 
@@ -144,6 +148,72 @@ void LogisticRegressionFunction<MatType>::Gradient(
       sigmoids).t() + regularization;
 }
 
+/**
+ * Evaluate the logistic regression objective function and its gradient in one
+ * pass, with one block of points per thread.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  const size_t dimensionality = parameters.n_elem - 1;
+  const arma::vec weights = parameters.col(0).subvec(1, dimensionality);
+
+  size_t numBlocks = 1;
+#ifdef HAS_OPENMP
+  numBlocks = std::max(std::min((size_t) omp_get_max_threads(),
+      (size_t) predictors.n_cols), (size_t) 1);
+#endif
+
+  // Each block stores its objective and gradient in its own column, so that
+  // no synchronization is needed until the final sum.
+  arma::mat blockGradients(parameters.n_elem, numBlocks, arma::fill::zeros);
+  arma::vec blockObjectives(numBlocks, arma::fill::zeros);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * predictors.n_cols / numBlocks;
+    const size_t end = (b + 1) * predictors.n_cols / numBlocks;
+    if (begin == end)
+      continue;
+
+    const arma::rowvec sigmoids = 1.0 / (1.0 + arma::exp(-parameters(0, 0) -
+        weights.t() * predictors.cols(begin, end - 1)));
+
+    double objective = 0.0;
+    for (size_t i = begin; i < end; ++i)
+    {
+      if (responses[i] == 1)
+        objective += std::log(sigmoids[i - begin]);
+      else
+        objective += std::log(1.0 - sigmoids[i - begin]);
+    }
+    blockObjectives[b] = -objective;
+
+    const arma::rowvec errors = arma::conv_to<arma::rowvec>::from(
+        responses.subvec(begin, end - 1)) - sigmoids;
+    blockGradients(0, b) = -arma::accu(errors);
+    blockGradients.submat(1, b, dimensionality, b) =
+        -(predictors.cols(begin, end - 1) * errors.t());
+  }
+
+  gradient = arma::sum(blockGradients, 1);
+  gradient.col(0).subvec(1, dimensionality) += lambda * weights;
+
+  return arma::accu(blockObjectives) + 0.5 * lambda * arma::dot(weights,
+      weights);
+}
+
 /**
  * Evaluate the individual gradients of the logistic regression objective
  * function with respect to individual points.  This is useful for optimizers
@@ -170,6 +240,126 @@ void LogisticRegressionFunction<MatType>::Gradient(
       * (responses[i] - sigmoid) + regularization;
 }
 
+/**
+ * Evaluate the logistic regression objective function and its gradient with
+ * respect to one point.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::mat& gradient) const
+{
+  const size_t dimensionality = parameters.n_elem - 1;
+
+  // The regularization terms are divided by the number of points, as in the
+  // separate Evaluate() and Gradient().
+  const double regularization = lambda * (1.0 / (2.0 * predictors.n_cols)) *
+      arma::dot(parameters.col(0).subvec(1, dimensionality),
+                parameters.col(0).subvec(1, dimensionality));
+
+  const double sigmoid = 1.0 / (1.0 + std::exp(-parameters(0, 0)
+      - arma::dot(predictors.col(i), parameters.col(0).subvec(1,
+      dimensionality))));
+
+  gradient.set_size(parameters.n_elem);
+  gradient[0] = -(responses[i] - sigmoid);
+  gradient.col(0).subvec(1, dimensionality) = -predictors.col(i)
+      * (responses[i] - sigmoid) + lambda * parameters.col(0).subvec(1,
+      dimensionality) / predictors.n_cols;
+
+  if (responses[i] == 1)
+    return -log(sigmoid) + regularization;
+  else
+    return -log(1.0 - sigmoid) + regularization;
+}
+
+/**
+ * Evaluate the individual gradient of the logistic regression objective
+ * function with respect to one point, as a sparse vector.
+ */
+template<typename MatType>
+template<typename T>
+typename std::enable_if<arma::is_arma_sparse_type<T>::value>::type
+LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::sp_mat& gradient) const
+{
+  // The regularization term touches every parameter.
+  if (lambda != 0.0)
+  {
+    arma::mat denseGradient;
+    Gradient(parameters, i, denseGradient);
+    gradient = arma::sp_mat(denseGradient);
+    return;
+  }
+
+  const double sigmoid = 1.0 / (1.0 + std::exp(-parameters(0, 0)
+      - arma::dot(predictors.col(i), parameters.col(0).subvec(1,
+      parameters.n_elem - 1))));
+  const double error = -(responses[i] - sigmoid);
+
+  // Only the intercept and the non-zero features of the point have a gradient.
+  const arma::sp_mat point(predictors.col(i));
+  arma::umat locations(2, point.n_nonzero + 1, arma::fill::zeros);
+  arma::vec values(point.n_nonzero + 1);
+  values[0] = error;
+
+  size_t k = 1;
+  for (arma::sp_mat::const_iterator it = point.begin(); it != point.end();
+      ++it, ++k)
+  {
+    locations(0, k) = it.row() + 1;
+    values[k] = error * (*it);
+  }
+
+  gradient = arma::sp_mat(locations, values, parameters.n_elem, 1);
+}
+
+/**
+ * Evaluate the derivative of the objective of one point with respect to its
+ * linear score.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::GradientCoefficient(
+    const arma::mat& parameters,
+    const size_t i) const
+{
+  const double sigmoid = 1.0 / (1.0 + std::exp(-parameters(0, 0)
+      - arma::dot(predictors.col(i), parameters.col(0).subvec(1,
+      parameters.n_elem - 1))));
+
+  return -(responses[i] - sigmoid);
+}
+
+/**
+ * Add a multiple of one point, with the intercept, to the gradient.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::AddScaledPoint(
+    const size_t i,
+    const double scale,
+    arma::mat& gradient) const
+{
+  gradient[0] += scale;
+  gradient.col(0).subvec(1, gradient.n_elem - 1) += scale * predictors.col(i);
+}
+
+/**
+ * Evaluate the gradient of the regularization term.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::RegularizationGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  gradient.set_size(parameters.n_elem);
+  gradient[0] = 0.0;
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = lambda *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+}
+
 } // namespace regression
 } // namespace mlpack
 
@@ -153,7 +153,7 @@ double LogisticRegression<MatType>::ComputeError(
     const arma::Row<size_t>& responses) const
 {
   // Construct a new error function.
-  LogisticRegressionFunction<> newErrorFunction(predictors, responses,
+  LogisticRegressionFunction<MatType> newErrorFunction(predictors, responses,
       lambda);
 
   return newErrorFunction.Evaluate(parameters);
@@ -72,7 +72,14 @@ PROGRAM_INFO("L2-regularized Logistic Regression and Prediction",
     "\n\n"
     "This implementation of logistic regression does not support the general "
     "multi-class case but instead only the two-class case.  Any responses must "
-    "be either 0 or 1.");
+    "be either 0 or 1."
+    "\n\n"
+    "If --sparse (-S) is given, the training and test datasets are loaded as "
+    "sparse matrices, and the model is trained and used without ever making a "
+    "dense copy of them.  Sparse datasets must be in coordinate list format, "
+    "with one 'point dimension value' line for each non-zero value and the "
+    "extension .txt or .coo, or in Armadillo binary format (.bin).  The labels "
+    "of a sparse training set may also be given as its last dimension.");
 
 // Training parameters.
 PARAM_MATRIX_IN("training", "A matrix containing the training set (the matrix "
@@ -92,6 +99,8 @@ PARAM_INT_IN("max_iterations", "Maximum iterations for optimizer (0 indicates "
 PARAM_DOUBLE_IN("step_size", "Step size for SGD and mini-batch SGD optimizers.",
     "s", 0.01);
 PARAM_INT_IN("batch_size", "Batch size for mini-batch SGD.", "b", 50);
+PARAM_FLAG("sparse", "If set, the training and test datasets are loaded as "
+    "sparse matrices.", "S");
 
 // Model loading/saving.
 PARAM_MODEL_IN(LogisticRegression<>, "input_model", "Existing model "
@@ -110,95 +119,45 @@ PARAM_DOUBLE_IN("decision_boundary", "Decision boundary for prediction; if the "
     "logistic function for a point is less than the boundary, the class is "
     "taken to be 0; otherwise, the class is 1.", "d", 0.5);
 
-int main(int argc, char** argv)
+// Load the given dataset as a dense matrix.
+void LoadDataset(const string& name, arma::mat& dataset)
 {
-  CLI::ParseCommandLine(argc, argv);
-
-  // Collect command-line options.
-  const double lambda = CLI::GetParam<double>("lambda");
-  const string optimizerType = CLI::GetParam<string>("optimizer");
-  const double tolerance = CLI::GetParam<double>("tolerance");
-  const double stepSize = CLI::GetParam<double>("step_size");
-  const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
-  const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
-  const double decisionBoundary = CLI::GetParam<double>("decision_boundary");
-
-  // One of inputFile and modelFile must be specified.
-  if (!CLI::HasParam("training") && !CLI::HasParam("input_model"))
-    Log::Fatal << "One of --input_model_file or --training_file must be "
-        << "specified." << endl;
-
-  // If no output file is given, the user should know that the model will not be
-  // saved, but only if a model is being trained.
-  if (!CLI::HasParam("output_model") && CLI::HasParam("training"))
-    Log::Warn << "--output_model_file not given; trained model will not be "
-        << "saved." << endl;
-
-  if (CLI::HasParam("test") && !CLI::HasParam("output") &&
-      !CLI::HasParam("output_probabilities"))
-    Log::Warn << "--test_file specified, but neither --output_file nor "
-        << "--output_probabilities_file are specified; no test "
-        << "output will be saved!" << endl;
-
-  if (CLI::HasParam("output") && !CLI::HasParam("test"))
-    Log::Warn << "--output_file ignored because --test_file is not specified."
-        << endl;
-
-  if (CLI::HasParam("output_probabilities") && !CLI::HasParam("test"))
-    Log::Warn << "--output_probabilities_file ignored because --test_file is "
-        << "not specified." << endl;
-
-  // Tolerance needs to be positive.
-  if (tolerance < 0.0)
-    Log::Fatal << "Tolerance must be positive (received " << tolerance << ")."
-        << endl;
-
-  // Optimizer has to be L-BFGS or SGD.
-  if (optimizerType != "lbfgs" && optimizerType != "sgd" &&
-      optimizerType != "minibatch-sgd")
-    Log::Fatal << "--optimizer must be 'lbfgs', 'sgd', or 'minibatch-sgd'."
-        << endl;
-
-  // Lambda must be positive.
-  if (lambda < 0.0)
-    Log::Fatal << "L2-regularization parameter (--lambda) must be positive ("
-        << "received " << lambda << ")." << endl;
-
-  // Decision boundary must be between 0 and 1.
-  if (decisionBoundary < 0.0 || decisionBoundary > 1.0)
-    Log::Fatal << "Decision boundary (--decision_boundary) must be between 0.0 "
-        << "and 1.0 (received " << decisionBoundary << ")." << endl;
-
-  if ((stepSize < 0.0) &&
-      (optimizerType == "sgd" || optimizerType == "minibatch-sgd"))
-    Log::Fatal << "Step size (--step_size) must be positive (received "
-        << stepSize << ")." << endl;
-
-  if (CLI::HasParam("step_size") && optimizerType == "lbfgs")
-    Log::Warn << "Step size (--step_size) ignored because 'sgd' optimizer is "
-        << "not being used." << endl;
+  dataset = std::move(CLI::GetParam<arma::mat>(name));
+}
 
-  if (CLI::HasParam("batch_size") && optimizerType != "minibatch-sgd")
-    Log::Warn << "Batch size (--batch_size) ignored because 'minibatch-sgd' "
-        << "optimizer is not being used." << endl;
+// Load the given dataset as a sparse matrix, without a dense copy.
+void LoadDataset(const string& name, arma::sp_mat& dataset)
+{
+  data::Load(CLI::GetUnmappedParam<arma::mat>(name), dataset, true);
+}
 
+/**
+ * Train the model on the training set and classify the test set, if they are
+ * given, holding both datasets as matrices of type MatType.
+ */
+template<typename MatType>
+void TrainAndClassify(LogisticRegression<>& model,
+                      const double lambda,
+                      const string& optimizerType,
+                      const double tolerance,
+                      const double stepSize,
+                      const size_t batchSize,
+                      const size_t maxIterations,
+                      const double decisionBoundary)
+{
   // These are the matrices we might use.
-  arma::mat regressors;
+  MatType regressors;
   arma::Row<size_t> responses;
-  arma::mat testSet;
+  MatType testSet;
   arma::Row<size_t> predictions;
 
   // Load data matrix.
   if (CLI::HasParam("training"))
-    regressors = std::move(CLI::GetParam<arma::mat>("training"));
+    LoadDataset("training", regressors);
 
-  // Load the model, if necessary.
-  LogisticRegression<> model(0, 0); // Empty model.
-  if (CLI::HasParam("input_model"))
-    model = std::move(CLI::GetParam<LogisticRegression<>>("input_model"));
-  else
+  // Set the size of the parameters vector, if necessary.
+  if (!CLI::HasParam("input_model"))
   {
-    // Set the size of the parameters vector, if necessary.
     if (!CLI::HasParam("labels"))
       model.Parameters() = arma::zeros<arma::vec>(regressors.n_rows - 1);
     else
@@ -217,7 +176,7 @@ int main(int argc, char** argv)
   {
     // The initial predictors for y, Nx1.
     responses = arma::conv_to<arma::Row<size_t>>::from(
-        regressors.row(regressors.n_rows - 1));
+        arma::rowvec(regressors.row(regressors.n_rows - 1)));
     regressors.shed_row(regressors.n_rows - 1);
   }
 
@@ -226,34 +185,40 @@ int main(int argc, char** argv)
     Log::Fatal << "The labels must be either 0 or 1, not " << max(responses)
         << "!" << endl;
 
+  // The model that works on MatType holds the same parameters as the given
+  // model.
+  LogisticRegression<MatType> typedModel(0, lambda);
+  typedModel.Parameters() = model.Parameters();
+
   // Now, do the training.
   if (CLI::HasParam("training"))
   {
-    LogisticRegressionFunction<> lrf(regressors, responses, model.Parameters());
+    LogisticRegressionFunction<MatType> lrf(regressors, responses,
+        typedModel.Parameters(), lambda);
     if (optimizerType == "sgd")
     {
-      SGD<LogisticRegressionFunction<>> sgdOpt(lrf);
+      SGD<LogisticRegressionFunction<MatType>> sgdOpt(lrf);
       sgdOpt.MaxIterations() = maxIterations;
       sgdOpt.Tolerance() = tolerance;
       sgdOpt.StepSize() = stepSize;
       Log::Info << "Training model with SGD optimizer." << endl;
 
       // This will train the model.
-      model.Train(sgdOpt);
+      typedModel.Train(sgdOpt);
     }
     else if (optimizerType == "lbfgs")
     {
-      L_BFGS<LogisticRegressionFunction<>> lbfgsOpt(lrf);
+      L_BFGS<LogisticRegressionFunction<MatType>> lbfgsOpt(lrf);
       lbfgsOpt.MaxIterations() = maxIterations;
       lbfgsOpt.MinGradientNorm() = tolerance;
       Log::Info << "Training model with L-BFGS optimizer." << endl;
 
       // This will train the model.
-      model.Train(lbfgsOpt);
+      typedModel.Train(lbfgsOpt);
     }
     else if (optimizerType == "minibatch-sgd")
     {
-      MiniBatchSGD<LogisticRegressionFunction<>> mbsgdOpt(lrf);
+      MiniBatchSGD<LogisticRegressionFunction<MatType>> mbsgdOpt(lrf);
       mbsgdOpt.BatchSize() = batchSize;
       mbsgdOpt.Tolerance() = tolerance;
       mbsgdOpt.StepSize() = stepSize;
@@ -261,13 +226,15 @@ int main(int argc, char** argv)
       Log::Info << "Training model with mini-batch SGD optimizer (batch size "
           << batchSize << ")." << endl;
 
-      model.Train(mbsgdOpt);
+      typedModel.Train(mbsgdOpt);
     }
+
+    model.Parameters() = typedModel.Parameters();
   }
 
   if (CLI::HasParam("test"))
   {
-    testSet = std::move(CLI::GetParam<arma::mat>("test"));
+    LoadDataset("test", testSet);
 
     // We must perform predictions on the test set.  Training (and the
     // optimizer) are irrelevant here; we'll pass in the model we have.
@@ -275,7 +242,7 @@ int main(int argc, char** argv)
     {
       Log::Info << "Predicting classes of points in '"
           << CLI::GetUnmappedParam<arma::mat>("test") << "'." << endl;
-      model.Classify(testSet, predictions, decisionBoundary);
+      typedModel.Classify(testSet, predictions, decisionBoundary);
 
       CLI::GetParam<arma::Row<size_t>>("output") = std::move(predictions);
     }
@@ -285,12 +252,101 @@ int main(int argc, char** argv)
       Log::Info << "Calculating class probabilities of points in '"
           << CLI::GetUnmappedParam<arma::mat>("test") << "'." << endl;
       arma::mat probabilities;
-      model.Classify(testSet, probabilities);
+      typedModel.Classify(testSet, probabilities);
 
       CLI::GetParam<arma::mat>("output_probabilities") =
           std::move(probabilities);
     }
   }
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  // Collect command-line options.
+  const double lambda = CLI::GetParam<double>("lambda");
+  const string optimizerType = CLI::GetParam<string>("optimizer");
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  const double stepSize = CLI::GetParam<double>("step_size");
+  const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
+  const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
+  const double decisionBoundary = CLI::GetParam<double>("decision_boundary");
+
+  // One of inputFile and modelFile must be specified.
+  if (!CLI::HasParam("training") && !CLI::HasParam("input_model"))
+    Log::Fatal << "One of --input_model_file or --training_file must be "
+        << "specified." << endl;
+
+  // If no output file is given, the user should know that the model will not be
+  // saved, but only if a model is being trained.
+  if (!CLI::HasParam("output_model") && CLI::HasParam("training"))
+    Log::Warn << "--output_model_file not given; trained model will not be "
+        << "saved." << endl;
+
+  if (CLI::HasParam("test") && !CLI::HasParam("output") &&
+      !CLI::HasParam("output_probabilities"))
+    Log::Warn << "--test_file specified, but neither --output_file nor "
+        << "--output_probabilities_file are specified; no test "
+        << "output will be saved!" << endl;
+
+  if (CLI::HasParam("output") && !CLI::HasParam("test"))
+    Log::Warn << "--output_file ignored because --test_file is not specified."
+        << endl;
+
+  if (CLI::HasParam("output_probabilities") && !CLI::HasParam("test"))
+    Log::Warn << "--output_probabilities_file ignored because --test_file is "
+        << "not specified." << endl;
+
+  // Tolerance needs to be positive.
+  if (tolerance < 0.0)
+    Log::Fatal << "Tolerance must be positive (received " << tolerance << ")."
+        << endl;
+
+  // Optimizer has to be L-BFGS or SGD.
+  if (optimizerType != "lbfgs" && optimizerType != "sgd" &&
+      optimizerType != "minibatch-sgd")
+    Log::Fatal << "--optimizer must be 'lbfgs', 'sgd', or 'minibatch-sgd'."
+        << endl;
+
+  // Lambda must be positive.
+  if (lambda < 0.0)
+    Log::Fatal << "L2-regularization parameter (--lambda) must be positive ("
+        << "received " << lambda << ")." << endl;
+
+  // Decision boundary must be between 0 and 1.
+  if (decisionBoundary < 0.0 || decisionBoundary > 1.0)
+    Log::Fatal << "Decision boundary (--decision_boundary) must be between 0.0 "
+        << "and 1.0 (received " << decisionBoundary << ")." << endl;
+
+  if ((stepSize < 0.0) &&
+      (optimizerType == "sgd" || optimizerType == "minibatch-sgd"))
+    Log::Fatal << "Step size (--step_size) must be positive (received "
+        << stepSize << ")." << endl;
+
+  if (CLI::HasParam("step_size") && optimizerType == "lbfgs")
+    Log::Warn << "Step size (--step_size) ignored because 'sgd' optimizer is "
+        << "not being used." << endl;
+
+  if (CLI::HasParam("batch_size") && optimizerType != "minibatch-sgd")
+    Log::Warn << "Batch size (--batch_size) ignored because 'minibatch-sgd' "
+        << "optimizer is not being used." << endl;
+
+  // Load the model, if necessary.
+  LogisticRegression<> model(0, 0); // Empty model.
+  if (CLI::HasParam("input_model"))
+    model = std::move(CLI::GetParam<LogisticRegression<>>("input_model"));
+
+  if (CLI::HasParam("sparse"))
+  {
+    TrainAndClassify<arma::sp_mat>(model, lambda, optimizerType, tolerance,
+        stepSize, batchSize, maxIterations, decisionBoundary);
+  }
+  else
+  {
+    TrainAndClassify<arma::mat>(model, lambda, optimizerType, tolerance,
+        stepSize, batchSize, maxIterations, decisionBoundary);
+  }
 
   if (CLI::HasParam("output_model"))
   {
@@ -189,6 +189,38 @@ class LSHSearch
              const size_t bucketSize = 500,
              const arma::cube& projection = arma::cube());
 
+  /**
+   * Add the given points to the index, without retraining it.  The points are
+   * hashed with the existing projections and offsets and appended to the
+   * reference set, so the first new point gets the index
+   * ReferenceSet().n_cols before the call.  Each new point is appended to its
+   * bucket in each table; the buckets of inserted points grow as needed and
+   * are not limited by the bucket size.  If the index does not own its
+   * reference set, the reference set is copied first.
+   *
+   * @param newPoints Points to add to the index.
+   */
+  void Insert(const arma::mat& newPoints);
+
+  /**
+   * Mark the point with the given index as deleted, so it is never returned
+   * as a neighbor again.  The point stays in the reference set and in the
+   * buckets until Compact() is called, so the indices of the other points
+   * don't change.  Returns false if the point does not exist or was already
+   * deleted.
+   *
+   * @param index Index of the point to delete.
+   */
+  bool Delete(const size_t index);
+
+  /**
+   * Merge the points added by Insert() into the compact second hash table, and
+   * remove the deleted points from the buckets.  This is a single pass over
+   * the second hash table, which makes searches as fast as after Train();
+   * nothing is rehashed.
+   */
+  void Compact();
+
   /**
    * Compute the nearest neighbors of the points in the given query set and
    * store the output in the given matrices.  The matrices will be set to the
@@ -281,9 +313,19 @@ class LSHSearch
   //! Get the bucket size of the second hash.
   size_t BucketSize() const { return bucketSize; }
 
-  //! Get the second hash table.
-  const std::vector<arma::Col<size_t>>& SecondHashTable() const
-      { return secondHashTable; }
+  //! Get the number of deleted points.
+  size_t NumDeleted() const { return numDeleted; }
+  //! Return whether the point with the given index was deleted.
+  bool IsDeleted(const size_t index) const { return deleted[index]; }
+
+  //! Get the start of each bucket of the second hash table in
+  //! BucketContents(); bucket i holds the elements in [BucketOffsets()[i],
+  //! BucketOffsets()[i + 1]).
+  const arma::Col<size_t>& BucketOffsets() const { return bucketOffsets; }
+
+  //! Get the contents of all of the buckets of the second hash table, stored
+  //! one after the other.
+  const arma::Col<arma::u32>& BucketContents() const { return bucketContents; }
 
   //! Get the projection tables.
   const arma::cube& Projections() { return projections; }
@@ -303,21 +345,66 @@ class LSHSearch
    * hash table and all the points (if any) in those buckets are collected as
    * the potential neighbor candidates.
    *
-   * @param queryPoint The query point currently being processed.
+   * @param queryCodesNotFloored The projections of the query point in each
+   *    table to search (one column per table), as computed by
+   *    ProjectQueries().
    * @param referenceIndices The list of neighbor candidates obtained from
    *    hashing the query into all the hash tables and eventually into
    *    multiple buckets of the second hash table.
-   * @param numTablesToSearch The number of tables to perform the search in. If
-   *    0, all tables are searched.
    * @param T The number of additional probing bins for multiprobe LSH. If 0,
    *    single-probe is used.
    */
-  template<typename VecType>
-  void ReturnIndicesFromTable(const VecType& queryPoint,
+  void ReturnIndicesFromTable(const arma::mat& queryCodesNotFloored,
                               arma::uvec& referenceIndices,
-                              size_t numTablesToSearch,
                               const size_t T) const;
 
+  /**
+   * Compute the projections of a block of queries in the first
+   * numTablesToSearch tables, including the offsets.  Slice i of the given
+   * cube will hold the projections in table i, with one column for each
+   * query.  This is done with one matrix multiplication per table for the
+   * whole block, instead of one per table for each query.
+   *
+   * @param querySet Set of query points.
+   * @param begin Index of the first query of the block.
+   * @param count Number of queries in the block.
+   * @param numTablesToSearch Number of tables to compute projections in.
+   * @param queryCodesNotFloored Cube to store the projections in.
+   */
+  void ProjectQueries(const arma::mat& querySet,
+                      const size_t begin,
+                      const size_t count,
+                      const size_t numTablesToSearch,
+                      arma::cube& queryCodesNotFloored) const;
+
+  /**
+   * Build the compact representation of the second hash table (bucketOffsets
+   * and bucketContents) from a list of buckets.  This is used to load models
+   * saved by older versions of LSHSearch.
+   *
+   * @param buckets Contents of each bucket of the second hash table.
+   */
+  void CompactBuckets(const std::vector<arma::Col<size_t>>& buckets);
+
+  /**
+   * Hash the given points into the second hash table in each table, with the
+   * current projections and offsets.  Element (i, j) of secondHashVectors is
+   * set to the second hash value of point j in table i.
+   *
+   * @param points Points to hash.
+   * @param secondHashVectors Matrix to store the second hash values in.
+   */
+  void HashPoints(const arma::mat& points,
+                  arma::Mat<size_t>& secondHashVectors) const;
+
+  //! Get the number of elements in the given row of the second hash table,
+  //! including inserted points.
+  size_t BucketLength(const size_t row) const
+  {
+    return bucketOffsets[row + 1] - bucketOffsets[row] +
+        ((row < insertedContents.size()) ? insertedContents[row].size() : 0);
+  }
+
   /**
    * This is a helper function that computes the distance of the query to the
    * neighbor candidates and appropriately stores the best 'k' candidates.  This
@@ -443,18 +530,30 @@ class LSHSearch
   //! The bucket size of the second hash.
   size_t bucketSize;
 
-  //! The final hash table; should be (< secondHashSize) vectors each with
-  //! (<= bucketSize) elements.
-  std::vector<arma::Col<size_t>> secondHashTable;
+  //! The final hash table: the contents of all of the (< secondHashSize)
+  //! buckets, each with (<= bucketSize) elements, stored one after the other.
+  //! Point indices are stored in 32 bits to make the table smaller.
+  arma::Col<arma::u32> bucketContents;
 
-  //! The number of elements present in each hash bucket; should be
-  //! secondHashSize.
-  arma::Col<size_t> bucketContentSize;
+  //! The start of each bucket in bucketContents, plus the total number of
+  //! elements at the end; the size of bucket i is
+  //! bucketOffsets[i + 1] - bucketOffsets[i].
+  arma::Col<size_t> bucketOffsets;
 
-  //! For a particular hash value, points to the row in secondHashTable
-  //! corresponding to this value. Length secondHashSize.
+  //! For a particular hash value, points to the bucket corresponding to this
+  //! value (secondHashSize if it is empty). Length secondHashSize.
   arma::Col<size_t> bucketRowInHashTable;
 
+  //! The points added to each row of the second hash table by Insert() since
+  //! the last Train() or Compact(); a row made by Insert() has no elements in
+  //! bucketContents.
+  std::vector<std::vector<arma::u32>> insertedContents;
+
+  //! Whether each point of the reference set was deleted.
+  std::vector<bool> deleted;
+  //! The number of deleted points.
+  size_t numDeleted;
+
   //! The number of distance evaluations.
   size_t distanceEvaluations;
 
@@ -479,7 +578,7 @@ class LSHSearch
 
 //! Set the serialization version of the LSHSearch class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::LSHSearch<SortPolicy>, 1);
+    mlpack::neighbor::LSHSearch<SortPolicy>, 3);
 
 // Include implementation.
 #include "lsh_search_impl.hpp"
@@ -14,6 +14,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/math/random.hpp>
+#include <mlpack/core/util/execution.hpp>
 
 namespace mlpack {
 namespace neighbor {
@@ -34,6 +35,7 @@ LSHSearch(const arma::mat& referenceSet,
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
+  numDeleted(0),
   distanceEvaluations(0)
 {
   // Pass work to training function.
@@ -56,6 +58,7 @@ LSHSearch(const arma::mat& referenceSet,
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
+  numDeleted(0),
   distanceEvaluations(0)
 {
   // Pass work to training function
@@ -73,6 +76,7 @@ LSHSearch<SortPolicy>::LSHSearch() :
     hashWidth(0),
     secondHashSize(99901),
     bucketSize(500),
+    numDeleted(0),
     distanceEvaluations(0)
 {
 }
@@ -90,9 +94,12 @@ LSHSearch<SortPolicy>::LSHSearch(const LSHSearch& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(other.secondHashWeights),
     bucketSize(other.bucketSize),
-    secondHashTable(other.secondHashTable),
-    bucketContentSize(other.bucketContentSize),
+    bucketContents(other.bucketContents),
+    bucketOffsets(other.bucketOffsets),
     bucketRowInHashTable(other.bucketRowInHashTable),
+    insertedContents(other.insertedContents),
+    deleted(other.deleted),
+    numDeleted(other.numDeleted),
     distanceEvaluations(other.distanceEvaluations)
 {
   // Nothing to do.
@@ -111,9 +118,12 @@ LSHSearch<SortPolicy>::LSHSearch(LSHSearch&& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(std::move(other.secondHashWeights)),
     bucketSize(other.bucketSize),
-    secondHashTable(std::move(other.secondHashTable)),
-    bucketContentSize(std::move(other.bucketContentSize)),
+    bucketContents(std::move(other.bucketContents)),
+    bucketOffsets(std::move(other.bucketOffsets)),
     bucketRowInHashTable(std::move(other.bucketRowInHashTable)),
+    insertedContents(std::move(other.insertedContents)),
+    deleted(std::move(other.deleted)),
+    numDeleted(other.numDeleted),
     distanceEvaluations(other.distanceEvaluations)
 {
   // Reset other model to defaults.
@@ -124,6 +134,9 @@ LSHSearch<SortPolicy>::LSHSearch(LSHSearch&& other) :
   other.hashWidth = 0;
   other.secondHashSize = 99901;
   other.bucketSize = 500;
+  other.insertedContents.clear();
+  other.deleted.clear();
+  other.numDeleted = 0;
   other.distanceEvaluations = 0;
 }
 
@@ -144,9 +157,12 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(const LSHSearch& other)
   secondHashSize = other.secondHashSize;
   secondHashWeights = other.secondHashWeights;
   bucketSize = other.bucketSize;
-  secondHashTable = other.secondHashTable;
-  bucketContentSize = other.bucketContentSize;
+  bucketContents = other.bucketContents;
+  bucketOffsets = other.bucketOffsets;
   bucketRowInHashTable = other.bucketRowInHashTable;
+  insertedContents = other.insertedContents;
+  deleted = other.deleted;
+  numDeleted = other.numDeleted;
   distanceEvaluations = other.distanceEvaluations;
 
   return *this;
@@ -169,9 +185,12 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(LSHSearch&& other)
   secondHashSize = other.secondHashSize;
   secondHashWeights = std::move(other.secondHashWeights);
   bucketSize = other.bucketSize;
-  secondHashTable = std::move(other.secondHashTable);
-  bucketContentSize = std::move(other.bucketContentSize);
+  bucketContents = std::move(other.bucketContents);
+  bucketOffsets = std::move(other.bucketOffsets);
   bucketRowInHashTable = std::move(other.bucketRowInHashTable);
+  insertedContents = std::move(other.insertedContents);
+  deleted = std::move(other.deleted);
+  numDeleted = other.numDeleted;
   distanceEvaluations = other.distanceEvaluations;
 
   // Reset other model to defaults.
@@ -182,6 +201,9 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(LSHSearch&& other)
   other.hashWidth = 0;
   other.secondHashSize = 99901;
   other.bucketSize = 500;
+  other.insertedContents.clear();
+  other.deleted.clear();
+  other.numDeleted = 0;
   other.distanceEvaluations = 0;
 
   return *this;
@@ -247,13 +269,6 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
   secondHashWeights = arma::floor(arma::randu(numProj) *
                                   (double) secondHashSize);
 
-  // Instead of putting the points in the row corresponding to the bucket, we
-  // chose the next empty row and keep track of the row in which the bucket
-  // lies. This allows us to stack together and slice out the empty buckets at
-  // the end of the hashing.
-  bucketRowInHashTable.set_size(secondHashSize);
-  bucketRowInHashTable.fill(secondHashSize);
-
   // Step II: The offsets for all projections in all tables.
   // Since the 'offsets' are in [0, hashWidth], we obtain the 'offsets'
   // as randu(numProj, numTables) * hashWidth.
@@ -281,28 +296,112 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
         "tables provided must be equal to numProj");
   }
 
+  // Point indices are stored in 32 bits in the second hash table.
+  if (referenceSet.n_cols > UINT32_MAX)
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Train(): reference set has " << referenceSet.n_cols
+        << " points, but at most " << UINT32_MAX << " are supported!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
   // We will store the second hash vectors in this matrix; the second hash
-  // vector for table i will be held in row i.  We have to use int and not
-  // size_t, otherwise negative numbers are cast to 0.
-  arma::Mat<size_t> secondHashVectors(numTables, referenceSet.n_cols);
+  // vector for table i will be held in row i.
+  arma::Mat<size_t> secondHashVectors;
+  HashPoints(referenceSet, secondHashVectors);
+
+  // Now, using the hash vectors for each table, count the number of rows we
+  // have in the second hash table.
+  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
+  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
+    secondHashBinCounts[secondHashVectors[i]]++;
+
+  // Enforce the maximum bucket size.
+  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
+  secondHashBinCounts.transform([effectiveBucketSize](size_t val)
+      { return std::min(val, effectiveBucketSize); });
+
+  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
+
+  // Instead of putting the points in the row corresponding to the bucket, we
+  // chose the next empty row (in the order the buckets are first seen) and
+  // keep track of the row in which the bucket lies.  This allows us to store
+  // all the non-empty buckets one after the other, without any padding.
+  bucketRowInHashTable.set_size(secondHashSize);
+  bucketRowInHashTable.fill(secondHashSize);
+  bucketOffsets.set_size(numRowsInTable + 1);
+  bucketOffsets[0] = 0;
+
+  size_t currentRow = 0;
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      const size_t hashInd = secondHashVectors(i, j);
+      if (bucketRowInHashTable[hashInd] == secondHashSize)
+      {
+        bucketRowInHashTable[hashInd] = currentRow;
+        bucketOffsets[currentRow + 1] = bucketOffsets[currentRow] +
+            secondHashBinCounts[hashInd];
+        currentRow++;
+      }
+    }
+  }
+
+  // Next we must assign each point in each table to the right bucket.  The
+  // bucket sizes were capped above, so only the first points hashed to a full
+  // bucket are kept.
+  bucketContents.set_size(bucketOffsets[numRowsInTable]);
+  arma::Col<size_t> bucketFill(numRowsInTable, arma::fill::zeros);
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      // This is the bucket number.  The point ID is 'j'.
+      const size_t index = bucketRowInHashTable[secondHashVectors(i, j)];
+
+      // If this bucket is not full, add the point.
+      if (bucketOffsets[index] + bucketFill[index] < bucketOffsets[index + 1])
+        bucketContents[bucketOffsets[index] + bucketFill[index]++] = j;
+    } // Loop over all points in the reference set.
+  } // Loop over tables.
 
-  for (size_t i = 0; i < numTables; i++)
+  Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
+            << "maximum length of " << arma::max(secondHashBinCounts) << ", "
+            << "totaling " << arma::accu(secondHashBinCounts) << " elements."
+            << std::endl;
+
+  // Nothing has been inserted or deleted yet.
+  insertedContents.clear();
+  deleted.assign(referenceSet.n_cols, false);
+  numDeleted = 0;
+}
+
+// Hash each point to a bucket of the second hash table in each table.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::HashPoints(
+    const arma::mat& points,
+    arma::Mat<size_t>& secondHashVectors) const
+{
+  secondHashVectors.set_size(numTables, points.n_cols);
+
+  // The tables are independent, so they are hashed in parallel.
+  util::Execution::ParallelFor(numTables, [&](const size_t i)
   {
     // Step IV: create the 'numProj'-dimensional key for each point in each
     // table.
 
     // The following code performs the task of hashing each point to a
     // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
-    // 'referenceSet.n_cols') key matrix.
+    // 'points.n_cols') key matrix.
     //
     // For a single table, let the 'numProj' projections be denoted by 'proj_i'
     // and the corresponding offset be 'offset_i'.  Then the key of a single
     // point is obtained as:
     // key = { floor((<proj_i, point> + offset_i) / 'hashWidth') forall i }
-    arma::mat offsetMat = arma::repmat(offsets.unsafe_col(i), 1,
-                                       referenceSet.n_cols);
-    arma::mat hashMat = projections.slice(i).t() * (referenceSet);
-    hashMat += offsetMat;
+    arma::mat hashMat = projections.slice(i).t() * points;
+    hashMat.each_col() += offsets.unsafe_col(i);
     hashMat /= hashWidth;
 
     // Step V: Putting the points in the 'secondHashTable' by hashing the key.
@@ -324,57 +423,126 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
         secondHashVectors(i, j) = key;
       }
     }
+  });
+}
+
+// Add the given points to the index.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Insert(const arma::mat& newPoints)
+{
+  if (newPoints.n_cols == 0)
+    return;
+
+  if (newPoints.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Insert(): new points have dimensionality "
+        << newPoints.n_rows << ", but the reference set has dimensionality "
+        << referenceSet->n_rows << "!";
+    throw std::invalid_argument(oss.str());
   }
 
-  // Now, using the hash vectors for each table, count the number of rows we
-  // have in the second hash table.
-  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
-  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
-    secondHashBinCounts[secondHashVectors[i]]++;
+  const size_t firstIndex = referenceSet->n_cols;
+  if (firstIndex + newPoints.n_cols > UINT32_MAX)
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Insert(): the index would have "
+        << firstIndex + newPoints.n_cols << " points, but at most "
+        << UINT32_MAX << " are supported!";
+    throw std::invalid_argument(oss.str());
+  }
 
-  // Enforce the maximum bucket size.
-  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
-  secondHashBinCounts.transform([effectiveBucketSize](size_t val)
-      { return std::min(val, effectiveBucketSize); });
+  // The new points are appended to the reference set, so we must own it.
+  if (!ownsSet)
+  {
+    referenceSet = new arma::mat(*referenceSet);
+    ownsSet = true;
+  }
+  const_cast<arma::mat*>(referenceSet)->insert_cols(firstIndex, newPoints);
+  deleted.resize(referenceSet->n_cols, false);
 
-  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
-  bucketContentSize.zeros(numRowsInTable);
-  secondHashTable.resize(numRowsInTable);
+  // Hash the new points with the existing projections and offsets.
+  arma::Mat<size_t> secondHashVectors;
+  HashPoints(newPoints, secondHashVectors);
 
-  // Next we must assign each point in each table to the right second hash
-  // table.
-  size_t currentRow = 0;
+  // Inserted points are appended to the list of their bucket, so buckets are
+  // not limited by bucketSize.  A bucket that was empty gets a new row, with
+  // no elements in bucketContents.
+  insertedContents.resize(bucketOffsets.n_elem - 1);
   for (size_t i = 0; i < numTables; ++i)
   {
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
-    for (size_t j = 0; j < secondHashVectors.n_cols; j++)
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
     {
-      // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVectors(i, j);
-      // The point ID is 'j'.
-
-      // If this is currently an empty bucket, start a new row keep track of
-      // which row corresponds to the bucket.
-      const size_t maxSize = secondHashBinCounts[hashInd];
+      const size_t hashInd = secondHashVectors(i, j);
       if (bucketRowInHashTable[hashInd] == secondHashSize)
       {
-        bucketRowInHashTable[hashInd] = currentRow;
-        secondHashTable[currentRow].set_size(maxSize);
-        currentRow++;
+        bucketRowInHashTable[hashInd] = insertedContents.size();
+        bucketOffsets.resize(bucketOffsets.n_elem + 1);
+        bucketOffsets[bucketOffsets.n_elem - 1] =
+            bucketOffsets[bucketOffsets.n_elem - 2];
+        insertedContents.resize(insertedContents.size() + 1);
       }
 
-      // If this vector in the hash table is not full, add the point.
-      const size_t index = bucketRowInHashTable[hashInd];
-      if (bucketContentSize[index] < maxSize)
-        secondHashTable[index](bucketContentSize[index]++) = j;
-    } // Loop over all points in the reference set.
-  } // Loop over tables.
+      insertedContents[bucketRowInHashTable[hashInd]].push_back(
+          firstIndex + j);
+    }
+  }
+}
 
-  Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
-            << "maximum length of " << arma::max(secondHashBinCounts) << ", "
-            << "totaling " << arma::accu(secondHashBinCounts) << " elements."
-            << std::endl;
+// Mark a point as deleted.
+template<typename SortPolicy>
+bool LSHSearch<SortPolicy>::Delete(const size_t index)
+{
+  if (index >= deleted.size() || deleted[index])
+    return false;
+
+  deleted[index] = true;
+  ++numDeleted;
+  return true;
+}
+
+// Merge the inserted points into the compact second hash table.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Compact()
+{
+  const size_t numRows = bucketOffsets.n_elem - 1;
+  std::vector<arma::Col<size_t>> buckets(numRows);
+  for (size_t i = 0; i < numRows; ++i)
+  {
+    const size_t numInserted = (i < insertedContents.size()) ?
+        insertedContents[i].size() : 0;
+    buckets[i].set_size(bucketOffsets[i + 1] - bucketOffsets[i] +
+        numInserted);
+
+    // Deleted points are dropped from the buckets.
+    size_t size = 0;
+    for (size_t j = bucketOffsets[i]; j < bucketOffsets[i + 1]; ++j)
+      if (!deleted[bucketContents[j]])
+        buckets[i][size++] = bucketContents[j];
+    for (size_t j = 0; j < numInserted; ++j)
+      if (!deleted[insertedContents[i][j]])
+        buckets[i][size++] = insertedContents[i][j];
+    buckets[i].resize(size);
+  }
+
+  CompactBuckets(buckets);
+  insertedContents.clear();
+}
+
+// Build the compact second hash table from a list of buckets.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::CompactBuckets(
+    const std::vector<arma::Col<size_t>>& buckets)
+{
+  bucketOffsets.set_size(buckets.size() + 1);
+  bucketOffsets[0] = 0;
+  for (size_t i = 0; i < buckets.size(); ++i)
+    bucketOffsets[i + 1] = bucketOffsets[i] + buckets[i].n_elem;
+
+  bucketContents.set_size(bucketOffsets[buckets.size()]);
+  for (size_t i = 0; i < buckets.size(); ++i)
+    for (size_t j = 0; j < buckets[i].n_elem; ++j)
+      bucketContents[bucketOffsets[i] + j] = buckets[i][j];
 }
 
 // Base case where the query set is the reference set.  (So, we can't return
@@ -726,36 +894,37 @@ void LSHSearch<SortPolicy>::GetAdditionalProbingBins(
   }
 }
 
+// Compute the projections of a block of queries in each table.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::ProjectQueries(
+    const arma::mat& querySet,
+    const size_t begin,
+    const size_t count,
+    const size_t numTablesToSearch,
+    arma::cube& queryCodesNotFloored) const
+{
+  queryCodesNotFloored.set_size(numProj, count, numTablesToSearch);
+  for (size_t i = 0; i < numTablesToSearch; ++i)
+  {
+    queryCodesNotFloored.slice(i) = projections.slice(i).t() *
+        querySet.cols(begin, begin + count - 1);
+    queryCodesNotFloored.slice(i).each_col() += offsets.unsafe_col(i);
+  }
+}
+
 template<typename SortPolicy>
-template<typename VecType>
 void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
-    const VecType& queryPoint,
+    const arma::mat& queryCodesNotFloored,
     arma::uvec& referenceIndices,
-    size_t numTablesToSearch,
     const size_t T) const
 {
-  // Decide on the number of tables to look into.
-  if (numTablesToSearch == 0) // If no user input is given, search all.
-    numTablesToSearch = numTables;
-
-  // Sanity check to make sure that the existing number of tables is not
-  // exceeded.
-  if (numTablesToSearch > numTables)
-    numTablesToSearch = numTables;
-
-  // Hash the query in each of the 'numTablesToSearch' hash tables using the
-  // 'numProj' projections for each table. This gives us 'numTablesToSearch'
-  // keys for the query where each key is a 'numProj' dimensional integer
-  // vector.
-
-  // Compute the projection of the query in each table.
-  arma::mat allProjInTables(numProj, numTablesToSearch);
-  arma::mat queryCodesNotFloored(numProj, numTablesToSearch);
-  for (size_t i = 0; i < numTablesToSearch; i++)
-    queryCodesNotFloored.unsafe_col(i) = projections.slice(i).t() * queryPoint;
-
-  queryCodesNotFloored += offsets.cols(0, numTablesToSearch - 1);
-  allProjInTables = arma::floor(queryCodesNotFloored / hashWidth);
+  // The query has been hashed in each of the 'numTablesToSearch' hash tables
+  // using the 'numProj' projections for each table. This gives us
+  // 'numTablesToSearch' keys for the query where each key is a 'numProj'
+  // dimensional integer vector.
+  const size_t numTablesToSearch = queryCodesNotFloored.n_cols;
+  const arma::mat allProjInTables = arma::floor(queryCodesNotFloored /
+      hashWidth);
 
   // Use hashMat to store the primary probing codes and any additional codes
   // from multiprobe LSH.
@@ -773,10 +942,11 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
   // Compute hash codes of additional probing bins.
   if (T > 0)
   {
+    // The same matrix is reused for the probing sequence of every table.
+    arma::mat additionalProbingBins;
     for (size_t i = 0; i < numTablesToSearch; ++i)
     {
       // Construct this table's probing sequence of length T.
-      arma::mat additionalProbingBins;
       GetAdditionalProbingBins(allProjInTables.unsafe_col(i),
                                 queryCodesNotFloored.unsafe_col(i),
                                 T,
@@ -800,8 +970,8 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
     {
       const size_t hashInd = hashMat(p, i); // find query's bucket
       const size_t tableRow = bucketRowInHashTable[hashInd];
-      if (tableRow < secondHashSize)
-        maxNumPoints += bucketContentSize[tableRow]; // count bucket contents
+      if (tableRow < secondHashSize) // count bucket contents
+        maxNumPoints += BucketLength(tableRow);
     }
   }
 
@@ -832,18 +1002,21 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
         size_t hashInd = hashMat(p, i);
         size_t tableRow = bucketRowInHashTable[hashInd];
 
-        if (tableRow < secondHashSize && bucketContentSize[tableRow] > 0)
+        if (tableRow < secondHashSize)
         {
           // Pick the indices in the bucket corresponding to hashInd.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsidered[ secondHashTable[tableRow](j) ]++;
+          for (size_t j = bucketOffsets[tableRow];
+               j < bucketOffsets[tableRow + 1]; ++j)
+            refPointsConsidered[bucketContents[j]]++;
+          if (tableRow < insertedContents.size())
+            for (size_t j = 0; j < insertedContents[tableRow].size(); ++j)
+              refPointsConsidered[insertedContents[tableRow][j]]++;
         }
       }
     }
 
     // Only keep reference points found in at least one bucket.
     referenceIndices = arma::find(refPointsConsidered > 0);
-    return;
   }
   else
   {
@@ -866,15 +1039,28 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
         if (tableRow < secondHashSize)
         {
           // Store all secondHashTable points in the candidates set.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsideredSmall(start++) = secondHashTable[tableRow](j);
-       }
+          for (size_t j = bucketOffsets[tableRow];
+               j < bucketOffsets[tableRow + 1]; ++j)
+            refPointsConsideredSmall(start++) = bucketContents[j];
+          if (tableRow < insertedContents.size())
+            for (size_t j = 0; j < insertedContents[tableRow].size(); ++j)
+              refPointsConsideredSmall(start++) = insertedContents[tableRow][j];
+        }
       }
     }
 
     // Keep only one copy of each candidate.
     referenceIndices = arma::unique(refPointsConsideredSmall);
-    return;
+  }
+
+  // Drop the candidates that were deleted.
+  if (numDeleted > 0)
+  {
+    size_t numLive = 0;
+    for (size_t i = 0; i < referenceIndices.n_elem; ++i)
+      if (!deleted[referenceIndices[i]])
+        referenceIndices[numLive++] = referenceIndices[i];
+    referenceIndices.resize(numLive);
   }
 }
 
@@ -930,44 +1116,51 @@ void LSHSearch<SortPolicy>::Search(const arma::mat& querySet,
     Log::Info << "Running multiprobe LSH with " << Teffective
         <<" additional probing bins per table per query." << std::endl;
 
+  // Decide on the number of tables to look into.  If no user input is given,
+  // or more tables than exist are requested, search all of them.
+  const size_t tablesToSearch = (numTablesToSearch == 0 ||
+      numTablesToSearch > numTables) ? numTables : numTablesToSearch;
+
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-#ifdef _WIN32
-  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
-  // support unsigned loop variables. If we're building for Visual Studio, use
-  // the intmax_t type instead.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
-#else
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (size_t i = 0; i < querySet.n_cols; ++i)
-#endif
+  // The queries are projected in blocks, so that the projections of a whole
+  // block are computed with one matrix multiplication per table.
+  const size_t queryBlockSize = 1024;
+  arma::cube queryCodesNotFloored;
+  arma::Col<size_t> indicesReturned(queryBlockSize);
+  for (size_t begin = 0; begin < querySet.n_cols; begin += queryBlockSize)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running
-    // #pragma omp atomic
-    avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    const size_t count = std::min(queryBlockSize,
+        (size_t) (querySet.n_cols - begin));
+    ProjectQueries(querySet, begin, count, tablesToSearch,
+        queryCodesNotFloored);
+
+    // Parallelization to process more than one query at a time.
+    util::Execution::ParallelFor(count, [&](const size_t q)
+    {
+      // Go through every query point.
+      // Hash every query into every hash table and eventually into the
+      // 'secondHashTable' to obtain the neighbor candidates.
+      const size_t i = begin + q;
+      arma::mat queryCodes(numProj, tablesToSearch);
+      for (size_t t = 0; t < tablesToSearch; ++t)
+        queryCodes.col(t) = queryCodesNotFloored.slice(t).col(q);
+
+      arma::uvec refIndices;
+      ReturnIndicesFromTable(queryCodes, refIndices, Teffective);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      indicesReturned[q] = refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    });
+
+    avgIndicesReturned += arma::accu(indicesReturned.head(count));
   }
 
   Timer::Stop("computing_neighbors");
@@ -1007,44 +1200,51 @@ Search(const size_t k,
     Log::Info << "Running multiprobe LSH with " << Teffective <<
       " additional probing bins per table per query."<< std::endl;
 
+  // Decide on the number of tables to look into.  If no user input is given,
+  // or more tables than exist are requested, search all of them.
+  const size_t tablesToSearch = (numTablesToSearch == 0 ||
+      numTablesToSearch > numTables) ? numTables : numTablesToSearch;
+
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-#ifdef _WIN32
-  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
-  // support unsigned loop variables. If we're building for Visual Studio, use
-  // the intmax_t type instead.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (intmax_t i = 0; i < (intmax_t) referenceSet->n_cols; ++i)
-#else
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (size_t i = 0; i < referenceSet->n_cols; ++i)
-#endif
+  // The queries are projected in blocks, so that the projections of a whole
+  // block are computed with one matrix multiplication per table.
+  const size_t queryBlockSize = 1024;
+  arma::cube queryCodesNotFloored;
+  arma::Col<size_t> indicesReturned(queryBlockSize);
+  for (size_t begin = 0; begin < referenceSet->n_cols; begin += queryBlockSize)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(referenceSet->col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running.
-    // #pragma omp atomic
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    const size_t count = std::min(queryBlockSize,
+        (size_t) (referenceSet->n_cols - begin));
+    ProjectQueries(*referenceSet, begin, count, tablesToSearch,
+        queryCodesNotFloored);
+
+    // Parallelization to process more than one query at a time.
+    util::Execution::ParallelFor(count, [&](const size_t q)
+    {
+      // Go through every query point.
+      // Hash every query into every hash table and eventually into the
+      // 'secondHashTable' to obtain the neighbor candidates.
+      const size_t i = begin + q;
+      arma::mat queryCodes(numProj, tablesToSearch);
+      for (size_t t = 0; t < tablesToSearch; ++t)
+        queryCodes.col(t) = queryCodesNotFloored.slice(t).col(q);
+
+      arma::uvec refIndices;
+      ReturnIndicesFromTable(queryCodes, refIndices, Teffective);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      indicesReturned[q] = refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    });
+
+    avgIndicesReturned += arma::accu(indicesReturned.head(count));
   }
 
   Timer::Stop("computing_neighbors");
@@ -1089,6 +1289,10 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
 {
   using data::CreateNVP;
 
+  // The inserted points are saved in the compact second hash table.
+  if (Archive::is_saving::value && !insertedContents.empty())
+    Compact();
+
   // If we are loading, we are going to own the reference set.
   if (Archive::is_loading::value)
   {
@@ -1126,11 +1330,11 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
   ar & CreateNVP(secondHashSize, "secondHashSize");
   ar & CreateNVP(secondHashWeights, "secondHashWeights");
   ar & CreateNVP(bucketSize, "bucketSize");
-  // needs specific handling for new version
 
-  // Backward compatibility: in older versions of LSHSearch, the secondHashTable
-  // was stored as an arma::Mat<size_t>.  So we need to properly load that, then
-  // prune it down to size.
+  // Backward compatibility: older versions of LSHSearch stored the second hash
+  // table as a list of buckets, and version 0 stored it as an
+  // arma::Mat<size_t>.  So we need to properly load that, then convert it to
+  // the compact representation.
   if (version == 0)
   {
     arma::Mat<size_t> tmpSecondHashTable;
@@ -1140,7 +1344,7 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
     // it.
     tmpSecondHashTable = tmpSecondHashTable.t();
 
-    secondHashTable.resize(tmpSecondHashTable.n_cols);
+    std::vector<arma::Col<size_t>> buckets(tmpSecondHashTable.n_cols);
     for (size_t i = 0; i < tmpSecondHashTable.n_cols; ++i)
     {
       // Find length of each column.  We know we are at the end of the list when
@@ -1152,57 +1356,75 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
           break;
 
       // Set the size of the new column correctly.
-      secondHashTable[i].set_size(len);
+      buckets[i].set_size(len);
       for (size_t j = 0; j < len; ++j)
-        secondHashTable[i](j) = tmpSecondHashTable(j, i);
+        buckets[i](j) = tmpSecondHashTable(j, i);
     }
+    CompactBuckets(buckets);
+
+    // The bucket sizes are given by the buckets themselves, so the old
+    // bucketContentSize is not needed.
+    arma::Col<size_t> tmpBucketContentSize;
+    ar & CreateNVP(tmpBucketContentSize, "bucketContentSize");
+    ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
   }
-  else
+  else if (version == 1)
   {
     size_t tables;
-    if (Archive::is_saving::value)
-      tables = secondHashTable.size();
     ar & CreateNVP(tables, "numSecondHashTables");
 
-    // Set size of second hash table if needed.
-    if (Archive::is_loading::value)
-    {
-      secondHashTable.clear();
-      secondHashTable.resize(tables);
-    }
-
-    for (size_t i = 0; i < secondHashTable.size(); ++i)
+    std::vector<arma::Col<size_t>> buckets(tables);
+    for (size_t i = 0; i < buckets.size(); ++i)
     {
       std::ostringstream oss;
       oss << "secondHashTable" << i;
-      ar & CreateNVP(secondHashTable[i], oss.str());
+      ar & CreateNVP(buckets[i], oss.str());
     }
-  }
+    CompactBuckets(buckets);
 
-  // Backward compatibility: old versions of LSHSearch held bucketContentSize
-  // for all possible buckets (of size secondHashSize), but now we hold a
-  // compressed representation.
-  if (version == 0)
-  {
-    // The vector was stored in the old uncompressed form.  So we need to shrink
-    // it.  But we can't do that until we have bucketRowInHashTable, so we also
-    // have to load that.
     arma::Col<size_t> tmpBucketContentSize;
     ar & CreateNVP(tmpBucketContentSize, "bucketContentSize");
     ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
-
-    // Compress into a smaller vector by just dropping all of the zeros.
-    bucketContentSize.set_size(secondHashTable.size());
-    for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
-      if (tmpBucketContentSize[i] > 0)
-        bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
   }
   else
   {
-    ar & CreateNVP(bucketContentSize, "bucketContentSize");
+    ar & CreateNVP(bucketOffsets, "bucketOffsets");
+    ar & CreateNVP(bucketContents, "bucketContents");
     ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
   }
 
+  // Version 3 added the deleted points; older models have none.
+  if (version >= 3)
+  {
+    arma::Col<size_t> deletedIndices;
+    if (Archive::is_saving::value)
+    {
+      deletedIndices.set_size(numDeleted);
+      size_t k = 0;
+      for (size_t i = 0; i < deleted.size(); ++i)
+        if (deleted[i])
+          deletedIndices[k++] = i;
+    }
+
+    ar & CreateNVP(deletedIndices, "deletedIndices");
+
+    if (Archive::is_loading::value)
+    {
+      deleted.assign(referenceSet->n_cols, false);
+      for (size_t i = 0; i < deletedIndices.n_elem; ++i)
+        deleted[deletedIndices[i]] = true;
+      numDeleted = deletedIndices.n_elem;
+    }
+  }
+  else if (Archive::is_loading::value)
+  {
+    deleted.assign(referenceSet->n_cols, false);
+    numDeleted = 0;
+  }
+
+  if (Archive::is_loading::value)
+    insertedContents.clear();
+
   ar & CreateNVP(distanceEvaluations, "distanceEvaluations");
 }
 
@@ -0,0 +1,219 @@
+/**
+ * @file simhash_search.hpp
+ *
+ * Defines the SimHashSearch class, which performs approximate nearest neighbor
+ * search with the cosine distance, using locality-sensitive hashing with sign
+ * random projections (SimHash).  The hash of a point in each table is packed
+ * into one 64-bit word, so the tables are small and codes are compared with a
+ * population count.
+ *
+ * The hash family is described in the following paper:
+ *
+ * @inproceedings{charikar2002similarity,
+ *   title={Similarity estimation techniques from rounding algorithms},
+ *   author={Charikar, M.S.},
+ *   booktitle={Proceedings of the 34th Annual ACM Symposium on Theory of
+ *       Computing},
+ *   pages={380--388},
+ *   year={2002},
+ *   organization={ACM}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LSH_SIMHASH_SEARCH_HPP
+#define MLPACK_METHODS_LSH_SIMHASH_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The SimHashSearch class builds SimHash tables on a reference set, and uses
+ * them to find the approximate nearest neighbors of query points with the
+ * cosine distance, 1 - cos(q, r).  Where LSHSearch hashes with 2-stable
+ * projections for the Euclidean distance, each bit of a SimHash code is the
+ * sign of the projection of the point on a random Gaussian direction, so two
+ * points agree on a bit with probability 1 - theta / pi, where theta is the
+ * angle between them.
+ *
+ * Each of the numTables tables hashes a point to a code of numBits (at most
+ * 64) bits, stored in one 64-bit word.  A table is the list of the points
+ * sorted by code, so its bucket for a code is found by binary search.  To
+ * search, the buckets of all the codes within the given Hamming radius of the
+ * code of the query are probed in each table (multi-probe LSH); with a radius
+ * of r, each table probes sum_{i <= r} (numBits choose i) buckets.  If a number
+ * of candidates is given, the candidates are then prefiltered by their Hamming
+ * distance to the query summed over all of the tables, computed with one
+ * population count per table, and only the best ones are ranked with the exact
+ * cosine distance.
+ *
+ * @code
+ * SimHashSearch<> simhash(referenceSet, 16, 8);
+ * simhash.Search(querySet, 5, neighbors, distances, 1);
+ * @endcode
+ *
+ * @tparam MatType Type of the reference and query sets.
+ */
+template<typename MatType = arma::mat>
+class SimHashSearch
+{
+ public:
+  /**
+   * Create the SimHashSearch object without training it.  Be sure to call
+   * Train() before calling Search().
+   *
+   * @param numBits Number of bits of the code of each table (at most 64).
+   * @param numTables Number of hash tables.
+   */
+  SimHashSearch(const size_t numBits = 16, const size_t numTables = 8);
+
+  /**
+   * Create the SimHashSearch object and build the tables on the given
+   * reference set, with random projections.
+   *
+   * @param referenceSet Set of reference points.
+   * @param numBits Number of bits of the code of each table (at most 64).
+   * @param numTables Number of hash tables.
+   */
+  SimHashSearch(const MatType& referenceSet,
+                const size_t numBits = 16,
+                const size_t numTables = 8);
+
+  /**
+   * Build the tables on the given reference set with random projections,
+   * replacing any previous tables.  A normalized copy of the reference set is
+   * kept to compute the exact distances.  A std::invalid_argument is thrown
+   * if the parameters do not fit the reference set.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(const MatType& referenceSet);
+
+  /**
+   * Build the tables on the given reference set with the given projections,
+   * replacing any previous tables.  Column b + t * numBits of the projections
+   * is the direction of bit b of table t, so the number of columns must be a
+   * multiple of NumBits(), and NumTables() is set from it.
+   *
+   * @param referenceSet Set of reference points.
+   * @param projections Matrix of the projection directions.
+   */
+  void Train(const MatType& referenceSet, const arma::mat& projections);
+
+  /**
+   * Compute the approximate k nearest neighbors of each point in the query
+   * set with the cosine distance, and store their indices and distances in
+   * the given matrices, which will have k rows and one column for each query
+   * point.  If fewer than k candidates are found for a query, the remaining
+   * neighbors are set to NumPoints() and their distances to DBL_MAX.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   * @param hammingRadius Hamming radius of the ball of codes probed in each
+   *     table.  If 0, only the bucket of the code of the query is probed.
+   * @param numCandidates Maximum number of candidates of each query whose
+   *     exact distance is computed; the candidates with the smallest total
+   *     Hamming distance are kept.  If 0, all of the candidates are ranked.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances,
+              const size_t hammingRadius = 0,
+              const size_t numCandidates = 0) const;
+
+  /**
+   * Compute the Hamming distance between two codes, the number of bits that
+   * differ.  With GCC and clang this is a single POPCNT instruction when the
+   * target supports it.
+   */
+  static size_t HammingDistance(const uint64_t a, const uint64_t b)
+  {
+#if defined(__GNUC__)
+    return (size_t) __builtin_popcountll(a ^ b);
+#else
+    uint64_t x = a ^ b;
+    size_t count = 0;
+    for (; x != 0; ++count)
+      x &= x - 1;
+    return count;
+#endif
+  }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+  //! Get the number of bits of each code.
+  size_t NumBits() const { return numBits; }
+  //! Modify the number of bits of each code (used by Train()).
+  size_t& NumBits() { return numBits; }
+
+  //! Get the number of hash tables.
+  size_t NumTables() const { return numTables; }
+  //! Modify the number of hash tables (used by Train()).
+  size_t& NumTables() { return numTables; }
+
+  //! Get the number of indexed points.
+  size_t NumPoints() const { return referenceSet.n_cols; }
+
+  //! Get the projection directions (one column per bit).
+  const arma::mat& Projections() const { return projections; }
+
+  //! Get the normalized reference set (zero points are kept as they are).
+  const arma::mat& ReferenceSet() const { return referenceSet; }
+
+  //! Get the code of the given point in the given table.
+  uint64_t Code(const size_t point, const size_t table) const
+  { return codes[point * numTables + table]; }
+
+  //! Get the code of the given point in each table.
+  void Hash(const arma::vec& point, std::vector<uint64_t>& pointCodes) const;
+
+ private:
+  //! Number of bits of each code.
+  size_t numBits;
+  //! Number of hash tables.
+  size_t numTables;
+
+  //! The projection directions; column b + t * numBits is bit b of table t.
+  arma::mat projections;
+  //! The normalized reference set.
+  arma::mat referenceSet;
+
+  //! The codes of each point; the codes of point i are at [i * numTables,
+  //! (i + 1) * numTables).
+  std::vector<uint64_t> codes;
+  //! The codes of each table in sorted order; table t is at [t * NumPoints(),
+  //! (t + 1) * NumPoints()).
+  std::vector<uint64_t> tableCodes;
+  //! The index of the point of each element of tableCodes.
+  arma::Col<arma::u32> tableIndices;
+
+  /**
+   * Add the points of all of the buckets of the given table whose codes
+   * differ from the given code in up to radius bits, all at positions of at
+   * least firstBit, to the candidates.
+   */
+  void ProbeBall(const size_t table,
+                 const uint64_t code,
+                 const size_t firstBit,
+                 const size_t radius,
+                 std::vector<size_t>& candidates) const;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "simhash_search_impl.hpp"
+
+#endif
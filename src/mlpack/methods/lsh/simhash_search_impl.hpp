@@ -0,0 +1,326 @@
+/**
+ * @file simhash_search_impl.hpp
+ *
+ * Implementation of the SimHashSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LSH_SIMHASH_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_LSH_SIMHASH_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "simhash_search.hpp"
+
+#include <queue>
+
+namespace mlpack {
+namespace neighbor {
+
+// Non-training constructor.
+template<typename MatType>
+SimHashSearch<MatType>::SimHashSearch(const size_t numBits,
+                                      const size_t numTables) :
+    numBits(numBits),
+    numTables(numTables)
+{
+  // Nothing to do.
+}
+
+// Training constructor.
+template<typename MatType>
+SimHashSearch<MatType>::SimHashSearch(const MatType& referenceSet,
+                                      const size_t numBits,
+                                      const size_t numTables) :
+    numBits(numBits),
+    numTables(numTables)
+{
+  Train(referenceSet);
+}
+
+// Build the tables with random projections.
+template<typename MatType>
+void SimHashSearch<MatType>::Train(const MatType& referenceSet)
+{
+  if (numBits == 0 || numBits > 64)
+    throw std::invalid_argument("SimHashSearch::Train(): the number of bits "
+        "must be between 1 and 64!");
+  if (numTables == 0)
+    throw std::invalid_argument("SimHashSearch::Train(): the number of tables "
+        "must be positive!");
+
+  Train(referenceSet, arma::randn<arma::mat>(referenceSet.n_rows,
+      numBits * numTables));
+}
+
+// Build the tables with the given projections.
+template<typename MatType>
+void SimHashSearch<MatType>::Train(const MatType& referenceSet,
+                                   const arma::mat& projections)
+{
+  const size_t numPoints = referenceSet.n_cols;
+
+  if (numBits == 0 || numBits > 64)
+    throw std::invalid_argument("SimHashSearch::Train(): the number of bits "
+        "must be between 1 and 64!");
+  if (projections.n_rows != referenceSet.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "SimHashSearch::Train(): dimensionality of projections ("
+        << projections.n_rows << ") is not equal to the dimensionality of the "
+        << "reference set (" << referenceSet.n_rows << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+  if (projections.n_cols == 0 || projections.n_cols % numBits != 0)
+  {
+    std::ostringstream oss;
+    oss << "SimHashSearch::Train(): the number of projections ("
+        << projections.n_cols << ") is not a positive multiple of the number "
+        << "of bits (" << numBits << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+  // Point indices are stored in 32 bits.
+  if (numPoints > UINT32_MAX)
+    throw std::invalid_argument("SimHashSearch::Train(): too many reference "
+        "points!");
+
+  this->projections = projections;
+  numTables = projections.n_cols / numBits;
+
+  // Normalize the reference set, so that the cosine distance is one minus a
+  // dot product.
+  this->referenceSet = arma::conv_to<arma::mat>::from(referenceSet);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const double norm = arma::norm(this->referenceSet.col(i), 2);
+    if (norm > 0)
+      this->referenceSet.col(i) /= norm;
+  }
+
+  // The bits of all the tables are the signs of one matrix product.
+  const arma::mat projected = projections.t() * this->referenceSet;
+  codes.assign(numPoints * numTables, 0);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    for (size_t t = 0; t < numTables; ++t)
+    {
+      uint64_t code = 0;
+      for (size_t b = 0; b < numBits; ++b)
+        if (projected(t * numBits + b, i) >= 0)
+          code |= (uint64_t(1) << b);
+      codes[i * numTables + t] = code;
+    }
+  }
+
+  // Sort the points of each table by code; the index breaks ties, so the
+  // tables do not depend on the sort implementation.
+  tableCodes.resize(numPoints * numTables);
+  tableIndices.set_size(numPoints * numTables);
+  std::vector<std::pair<uint64_t, arma::u32>> table(numPoints);
+  for (size_t t = 0; t < numTables; ++t)
+  {
+    for (size_t i = 0; i < numPoints; ++i)
+      table[i] = std::make_pair(codes[i * numTables + t], (arma::u32) i);
+    std::sort(table.begin(), table.end());
+
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+      tableCodes[t * numPoints + i] = table[i].first;
+      tableIndices[t * numPoints + i] = table[i].second;
+    }
+  }
+
+  Log::Info << "Built " << numTables << " SimHash tables of " << numPoints
+      << " points with " << numBits << "-bit codes." << std::endl;
+}
+
+// Compute the codes of a point.
+template<typename MatType>
+void SimHashSearch<MatType>::Hash(const arma::vec& point,
+                                  std::vector<uint64_t>& pointCodes) const
+{
+  // The sign of a projection does not depend on the norm of the point.
+  const arma::vec projected = projections.t() * point;
+  pointCodes.assign(numTables, 0);
+  for (size_t t = 0; t < numTables; ++t)
+    for (size_t b = 0; b < numBits; ++b)
+      if (projected[t * numBits + b] >= 0)
+        pointCodes[t] |= (uint64_t(1) << b);
+}
+
+// Probe all of the buckets within a Hamming ball.
+template<typename MatType>
+void SimHashSearch<MatType>::ProbeBall(const size_t table,
+                                       const uint64_t code,
+                                       const size_t firstBit,
+                                       const size_t radius,
+                                       std::vector<size_t>& candidates) const
+{
+  const std::vector<uint64_t>::const_iterator begin = tableCodes.begin() +
+      table * NumPoints();
+  const std::vector<uint64_t>::const_iterator end = begin + NumPoints();
+  const std::pair<std::vector<uint64_t>::const_iterator,
+      std::vector<uint64_t>::const_iterator> bucket =
+      std::equal_range(begin, end, code);
+  for (std::vector<uint64_t>::const_iterator it = bucket.first;
+       it != bucket.second; ++it)
+    candidates.push_back(tableIndices[it - tableCodes.begin()]);
+
+  // Each code of the ball is probed once: the bits are flipped in increasing
+  // order.
+  if (radius == 0)
+    return;
+  for (size_t b = firstBit; b < numBits; ++b)
+    ProbeBall(table, code ^ (uint64_t(1) << b), b + 1, radius - 1, candidates);
+}
+
+// Search for approximate nearest neighbors.
+template<typename MatType>
+void SimHashSearch<MatType>::Search(const MatType& querySet,
+                                    const size_t k,
+                                    arma::Mat<size_t>& neighbors,
+                                    arma::mat& distances,
+                                    const size_t hammingRadius,
+                                    const size_t numCandidates) const
+{
+  if (querySet.n_rows != referenceSet.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "SimHashSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality the model "
+        << "was trained on (" << referenceSet.n_rows << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (k > NumPoints())
+  {
+    std::ostringstream oss;
+    oss << "SimHashSearch::Search(): requested " << k << " approximate "
+        << "nearest neighbors, but reference set has " << NumPoints()
+        << " points!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (hammingRadius > numBits)
+  {
+    std::ostringstream oss;
+    oss << "SimHashSearch::Search(): Hamming radius (" << hammingRadius
+        << ") is greater than the number of bits (" << numBits << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+  if (k == 0)
+    return;
+
+  // Candidate represents a possible candidate neighbor (distance, index); the
+  // worst candidate is at the top of the queue.
+  typedef std::pair<double, size_t> Candidate;
+  typedef std::priority_queue<Candidate> CandidateList;
+
+  // Parallelization to process more than one query at a time.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for \
+      shared(neighbors, distances) \
+      schedule(dynamic)
+  for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+  #pragma omp parallel for \
+      shared(neighbors, distances) \
+      schedule(dynamic)
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
+  {
+    arma::vec query = arma::conv_to<arma::vec>::from(querySet.col(q));
+    const double norm = arma::norm(query, 2);
+    if (norm > 0)
+      query /= norm;
+
+    std::vector<uint64_t> queryCodes;
+    Hash(query, queryCodes);
+
+    // Gather the points of all the probed buckets, once each.
+    std::vector<size_t> candidates;
+    for (size_t t = 0; t < numTables; ++t)
+      ProbeBall(t, queryCodes[t], 0, hammingRadius, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+        candidates.end());
+
+    // Keep only the candidates with the smallest total Hamming distance, if
+    // requested; ties are broken by index.
+    if (numCandidates > 0 && candidates.size() > numCandidates)
+    {
+      std::vector<std::pair<size_t, size_t>> hamming(candidates.size());
+      for (size_t c = 0; c < candidates.size(); ++c)
+      {
+        const uint64_t* pointCodes = codes.data() + candidates[c] * numTables;
+        size_t total = 0;
+        for (size_t t = 0; t < numTables; ++t)
+          total += HammingDistance(pointCodes[t], queryCodes[t]);
+        hamming[c] = std::make_pair(total, candidates[c]);
+      }
+
+      std::nth_element(hamming.begin(), hamming.begin() + numCandidates,
+          hamming.end());
+      candidates.resize(numCandidates);
+      for (size_t c = 0; c < numCandidates; ++c)
+        candidates[c] = hamming[c].second;
+    }
+
+    // Rank the remaining candidates with the exact cosine distance.
+    std::vector<Candidate> vect(k, std::make_pair(DBL_MAX, NumPoints()));
+    CandidateList pqueue(std::less<Candidate>(), std::move(vect));
+    for (size_t c = 0; c < candidates.size(); ++c)
+    {
+      const double distance = 1.0 - arma::dot(query,
+          referenceSet.col(candidates[c]));
+      const Candidate candidate = std::make_pair(distance, candidates[c]);
+      if (candidate < pqueue.top())
+      {
+        pqueue.pop();
+        pqueue.push(candidate);
+      }
+    }
+
+    for (size_t j = 1; j <= k; ++j)
+    {
+      neighbors(k - j, q) = pqueue.top().second;
+      distances(k - j, q) = pqueue.top().first;
+      pqueue.pop();
+    }
+  }
+}
+
+template<typename MatType>
+template<typename Archive>
+void SimHashSearch<MatType>::Serialize(Archive& ar,
+                                       const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(numBits, "numBits");
+  ar & CreateNVP(numTables, "numTables");
+  ar & CreateNVP(projections, "projections");
+  ar & CreateNVP(referenceSet, "referenceSet");
+  if (Archive::is_loading::value)
+  {
+    codes.clear();
+    tableCodes.clear();
+  }
+  ar & CreateNVP(codes, "codes");
+  ar & CreateNVP(tableCodes, "tableCodes");
+  ar & CreateNVP(tableIndices, "tableIndices");
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
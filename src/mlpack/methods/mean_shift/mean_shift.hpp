@@ -25,7 +25,9 @@ namespace meanshift /** Mean shift clustering. */ {
 /**
  * This class implements mean shift clustering.  For each point in dataset,
  * apply mean shift algorithm until maximum iterations or convergence.  Then
- * remove duplicate centroids.
+ * remove duplicate centroids.  The points (or seeds) are shifted in parallel
+ * with OpenMP, all with single-tree range searches on one tree built on the
+ * dataset.
  *
  * A simple example of how to run mean shift clustering is shown below.
  *
@@ -150,6 +152,21 @@ class MeanShift
                     const std::vector<double>&, /*unused*/
                     arma::colvec& centroid);
 
+  /**
+   * Add the converged centroids to the given centroids, in order, skipping
+   * each one that is closer than the radius to a centroid that was already
+   * added.  The added centroids are held in a map from hypercube cells of side
+   * length radius, so that only the centroids in the neighboring cells need to
+   * be checked.
+   *
+   * @param allCentroids Final centroid of each seed.
+   * @param converged Whether the centroid of each seed converged.
+   * @param centroids Matrix to add the centroids to.
+   */
+  void MergeCentroids(const arma::mat& allCentroids,
+                      const std::vector<char>& converged,
+                      arma::mat& centroids);
+
   /**
    * If distance of two centroids is less than radius, one will be removed.
    * Points with distance to current centroid less than radius will be used
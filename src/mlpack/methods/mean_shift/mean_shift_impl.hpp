@@ -176,6 +176,86 @@ CalculateCentroid(const MatType& data,
   return true;
 }
 
+// Add the converged centroids that are not duplicates to the centroids.
+template<bool UseKernel, typename KernelType, typename MatType>
+void MeanShift<UseKernel, KernelType, MatType>::MergeCentroids(
+    const arma::mat& allCentroids,
+    const std::vector<char>& converged,
+    arma::mat& centroids)
+{
+  typedef arma::colvec VecType;
+
+  // The columns already in centroids are kept, and then each converged
+  // centroid is kept if it is not within the radius of a kept one.
+  const size_t numOld = centroids.n_cols;
+  arma::mat candidates = centroids;
+  for (size_t i = 0; i < allCentroids.n_cols; ++i)
+    if (converged[i])
+      candidates.insert_cols(candidates.n_cols, allCentroids.unsafe_col(i));
+
+  // The kept centroids are held in hypercube cells of side length radius, so a
+  // centroid within the radius of another is in the same cell or in one of the
+  // 3^d cells around it.  When there are fewer kept centroids than that, it is
+  // cheaper to check all of them.
+  std::map<VecType, std::vector<size_t>, less<VecType> > cells;
+  const double numNeighborCells = std::pow(3.0, (double) candidates.n_rows);
+  std::vector<size_t> kept;
+  for (size_t i = 0; i < candidates.n_cols; ++i)
+  {
+    const VecType cell = arma::floor(candidates.unsafe_col(i) / radius);
+
+    // The centroids that were given are never removed.
+    bool isDuplicated = false;
+    if (i >= numOld && (double) kept.size() <= numNeighborCells)
+    {
+      for (size_t k = 0; k < kept.size() && !isDuplicated; ++k)
+      {
+        isDuplicated = (metric::EuclideanDistance::Evaluate(
+            candidates.unsafe_col(i), candidates.unsafe_col(kept[k])) <
+            radius);
+      }
+    }
+    else if (i >= numOld)
+    {
+      // Visit each neighboring cell, counting the offsets in base 3.
+      VecType offset(candidates.n_rows);
+      offset.fill(-1.0);
+      while (!isDuplicated)
+      {
+        const VecType neighborCell = cell + offset;
+        typename std::map<VecType, std::vector<size_t>,
+            less<VecType> >::const_iterator it = cells.find(neighborCell);
+        if (it != cells.end())
+        {
+          for (size_t k = 0; k < it->second.size() && !isDuplicated; ++k)
+          {
+            isDuplicated = (metric::EuclideanDistance::Evaluate(
+                candidates.unsafe_col(i),
+                candidates.unsafe_col(it->second[k])) < radius);
+          }
+        }
+
+        size_t j = 0;
+        while (j < offset.n_elem && offset[j] == 1.0)
+          offset[j++] = -1.0;
+        if (j == offset.n_elem)
+          break;
+        offset[j] += 1.0;
+      }
+    }
+
+    if (!isDuplicated)
+    {
+      kept.push_back(i);
+      cells[cell].push_back(i);
+    }
+  }
+
+  centroids.set_size(candidates.n_rows, kept.size());
+  for (size_t k = 0; k < kept.size(); ++k)
+    centroids.col(k) = candidates.col(kept[k]);
+}
+
 /**
  * Perform Mean Shift clustering on the data set, returning a list of cluster
  * assignments and centroids.
@@ -201,65 +281,83 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
     pSeeds = &seeds;
   }
 
-  // Holds all centroids before removing duplicate ones.
-  arma::mat allCentroids(pSeeds->n_rows, pSeeds->n_cols);
-
   assignments.set_size(data.n_cols);
 
+  // One tree is built on the data, and each seed is searched with a
+  // single-tree traversal of it.
+  typedef range::RangeSearch<>::Tree Tree;
+  typedef range::RangeSearchRules<metric::EuclideanDistance, Tree> RuleType;
   range::RangeSearch<> rangeSearcher(data);
-  math::Range validRadius(0, radius);
-  std::vector<std::vector<size_t> > neighbors;
-  std::vector<std::vector<double> > distances;
+  const arma::mat& referenceSet = rangeSearcher.ReferenceSet();
+  Tree* referenceTree = rangeSearcher.ReferenceTree();
+  const math::Range validRadius(0, radius);
 
-  // For each seed, perform mean shift algorithm.
-  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+  // Holds all centroids before removing duplicate ones, and whether each of
+  // them converged.
+  arma::mat allCentroids(pSeeds->n_rows, pSeeds->n_cols);
+  std::vector<char> converged(pSeeds->n_cols, 0);
+
+  // The seeds are shifted independently, so they are distributed over the
+  // threads; each thread has its own rules and results for the search.
+  #pragma omp parallel
   {
-    // Initial centroid is the seed itself.
-    allCentroids.col(i) = pSeeds->unsafe_col(i);
-    for (size_t completedIterations = 0; completedIterations < maxIterations;
-         completedIterations++)
+    metric::EuclideanDistance metric;
+    std::vector<std::vector<size_t> > neighbors(1);
+    std::vector<std::vector<double> > distances(1);
+    arma::mat centroid(pSeeds->n_rows, 1);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) pSeeds->n_cols; ++i)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t i = 0; i < pSeeds->n_cols; ++i)
+#endif
     {
-      // Store new centroid in this.
-      arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
-
-      rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius,
-          neighbors, distances);
-      if (neighbors[0].size() <= 1)
-        break;
-
-      // Calculate new centroid.
-      if (!CalculateCentroid(data, neighbors[0], distances[0], newCentroid))
-        newCentroid = allCentroids.unsafe_col(i);
-
-      // If the mean shift vector is small enough, it has converged.
-      if (metric::EuclideanDistance::Evaluate(newCentroid,
-          allCentroids.unsafe_col(i)) < 1e-3 * radius)
+      // Initial centroid is the seed itself.
+      centroid.col(0) = pSeeds->col(i);
+      for (size_t completedIterations = 0; completedIterations < maxIterations;
+           completedIterations++)
       {
-        // Determine if the new centroid is duplicate with old ones.
-        bool isDuplicated = false;
-        for (size_t k = 0; k < centroids.n_cols; ++k)
+        // Find the points within the radius of the centroid.
+        neighbors[0].clear();
+        distances[0].clear();
+        RuleType rules(referenceSet, centroid, validRadius, neighbors,
+            distances, metric);
+        typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+        traverser.Traverse(0, *referenceTree);
+
+        if (neighbors[0].size() <= 1)
+          break;
+
+        // Calculate new centroid.
+        arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
+        if (!CalculateCentroid(referenceSet, neighbors[0], distances[0],
+            newCentroid))
+          newCentroid = centroid.col(0);
+
+        // If the mean shift vector is small enough, it has converged.
+        if (metric::EuclideanDistance::Evaluate(newCentroid,
+            centroid.unsafe_col(0)) < 1e-3 * radius)
         {
-          const double distance = metric::EuclideanDistance::Evaluate(
-              allCentroids.unsafe_col(i), centroids.unsafe_col(k));
-          if (distance < radius)
-          {
-            isDuplicated = true;
-            break;
-          }
+          converged[i] = 1;
+          break;
         }
 
-        if (!isDuplicated)
-          centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
-
-        // Get out of the loop.
-        break;
+        // Update the centroid.
+        centroid.col(0) = newCentroid;
       }
 
-      // Update the centroid.
-      allCentroids.col(i) = newCentroid;
+      allCentroids.col(i) = centroid.col(0);
     }
   }
 
+  // Remove the duplicate centroids.
+  MergeCentroids(allCentroids, converged, centroids);
+
   // Assign centroids to each point.
   neighbor::KNN neighborSearcher(centroids);
   arma::mat neighborDistances;
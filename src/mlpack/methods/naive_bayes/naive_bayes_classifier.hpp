@@ -34,6 +34,11 @@ namespace naive_bayes /** The Naive Bayes Classifier. */ {
  * For classifying a data point (x_1, x_2, ..., x_n), it computes the following:
  * arg max_y(P(Y = y)*P(X_1 = x_1 | Y = y) * ... * P(X_n = x_n | Y = y))
  *
+ * The log likelihoods of a set of points are computed for blocks of points at
+ * once, with matrix products, and the blocks are processed in parallel when
+ * OpenMP is available.  Points may also be given as a sparse matrix (for
+ * instance, word counts of documents) to a classifier trained on dense data.
+ *
  * Example use:
  *
  * @code
@@ -91,6 +96,10 @@ class NaiveBayesClassifier
    * classes, either re-initialize or call Means(), Variances(), and
    * Probabilities() individually to set them to the right size.
    *
+   * With the incremental algorithm, the points are split between the OpenMP
+   * threads, and the statistics of each thread are merged into the model as
+   * Merge() does.
+   *
    * @param data The dataset to train on.
    * @param incremental Whether or not to use the incremental algorithm for
    *      training.
@@ -110,6 +119,18 @@ class NaiveBayesClassifier
   template<typename VecType>
   void Train(const VecType& point, const size_t label);
 
+  /**
+   * Merge the given model into this one, so that this model becomes the model
+   * trained on the points of both (up to floating-point error).  This can be
+   * used to train models on separate parts of a dataset, for instance on
+   * different machines, and then combine them.  A std::invalid_argument is
+   * thrown if the models do not have the same dimensionality and number of
+   * classes.
+   *
+   * @param other Model to merge into this one.
+   */
+  void Merge(const NaiveBayesClassifier& other);
+
   /**
    * Classify the given point, using the training GaussianNB model. The predicted label is
    * returned.
@@ -151,6 +172,17 @@ class NaiveBayesClassifier
   void Classify(const MatType& data,
                 arma::Row<size_t>& predictions) const;
 
+  /**
+   * Classify the given sparse points using the training GaussianNB model.
+   * The predicted labels for each point are stored in the given vector.
+   *
+   * @param data List of data points.
+   * @param predictions Vector that class predictions will be placed into.
+   */
+  template<typename eT>
+  void Classify(const arma::SpMat<eT>& data,
+                arma::Row<size_t>& predictions) const;
+
   /**
    * Classify the given points using the training GaussianNB model
    * and also return estimates of the probabilities for each class in the given matrix.
@@ -173,6 +205,21 @@ class NaiveBayesClassifier
                 arma::Row<size_t>& predictions,
                 arma::mat& probabilities) const;
 
+  /**
+   * Classify the given sparse points using the training GaussianNB model and
+   * also return estimates of the probabilities for each class in the given
+   * matrix.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   * @param probabilities This will be filled with class probabilities for each
+   *      point.
+   */
+  template<typename eT>
+  void Classify(const arma::SpMat<eT>& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
   //! Get the sample means for each class.
   const MatType& Means() const { return means; }
   //! Modify the sample means for each class.
@@ -222,6 +269,56 @@ class NaiveBayesClassifier
    */
   void LogLikelihood(const MatType& data,
                      arma::mat& logLikelihoods) const;
+
+  /**
+   * Compute the unnormalized posterior log probability of the given sparse
+   * points (log likelihood).
+   *
+   * @param data Set of points to compute posterior log probability for.
+   * @param logLikelihoods Matrix to store log likelihoods in.
+   */
+  template<typename eT>
+  void LogLikelihood(const arma::SpMat<eT>& data,
+                     arma::mat& logLikelihoods) const;
+
+  /**
+   * Compute the log likelihoods of the given points, for blocks of points at
+   * a time.
+   */
+  template<typename DataType>
+  void BlockLogLikelihood(const DataType& data,
+                          arma::mat& logLikelihoods) const;
+
+  /**
+   * Get the sufficient statistics of the model: the number of points of each
+   * class, and the sum of squared differences from the mean of each feature
+   * for each class (the means are the sample means).
+   */
+  void GetStatistics(arma::vec& counts, arma::mat& m2) const;
+
+  /**
+   * Merge the given statistics into the given statistics of the model, whose
+   * means are the sample means.
+   */
+  void MergeStatistics(arma::vec& counts,
+                       arma::mat& m2,
+                       const arma::vec& otherCounts,
+                       const arma::mat& otherMeans,
+                       const arma::mat& otherM2);
+
+  //! Set the variances, probabilities and number of points of the model from
+  //! the given statistics.
+  void SetStatistics(const arma::vec& counts, const arma::mat& m2);
+
+  //! Compute log(sum(exp(logLikelihoods))) without underflow.
+  static double LogSumExp(const arma::vec& logLikelihoods);
+
+  //! Find the class of maximum log likelihood for each point.
+  static void Predict(const arma::mat& logLikelihoods,
+                      arma::Row<size_t>& predictions);
+
+  //! Turn the log likelihoods of each point into class probabilities.
+  static void Normalize(arma::mat& logLikelihoods);
 };
 
 } // namespace naive_bayes
@@ -230,4 +327,7 @@ class NaiveBayesClassifier
 // Include implementation.
 #include "naive_bayes_classifier_impl.hpp"
 
+// Include the specialization of FoldTrainer for cross-validation.
+#include "naive_bayes_fold_trainer.hpp"
+
 #endif
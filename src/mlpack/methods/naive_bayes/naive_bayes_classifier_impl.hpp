@@ -73,72 +73,109 @@ void NaiveBayesClassifier<MatType>::Train(const MatType& data,
   // for each of the features with respect to each of the labels.
   if (incremental)
   {
-    // Use incremental algorithm.
-    // Fist, de-normalize probabilities.
-    probabilities *= trainingPoints;
-
-    for (size_t j = 0; j < data.n_cols; ++j)
+    // Use incremental algorithm.  Each thread computes the number of points,
+    // the mean and the sum of squared differences from the mean of each class
+    // for its share of the points with Welford's algorithm; these statistics
+    // are then merged into the model, in the order of the threads.
+    #ifdef HAS_OPENMP
+    const size_t numThreads = omp_get_max_threads();
+    #else
+    const size_t numThreads = 1;
+    #endif
+
+    std::vector<arma::vec> threadCounts(numThreads);
+    std::vector<arma::mat> threadMeans(numThreads);
+    std::vector<arma::mat> threadM2(numThreads);
+
+    #pragma omp parallel
     {
-      const size_t label = labels[j];
-      ++probabilities[label];
-
-      arma::vec delta = data.col(j) - means.col(label);
-      means.col(label) += delta / probabilities[label];
-      variances.col(label) += delta % (data.col(j) - means.col(label));
+      #ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+      #else
+      const size_t thread = 0;
+      #endif
+
+      arma::vec& counts = threadCounts[thread];
+      arma::mat& localMeans = threadMeans[thread];
+      arma::mat& localM2 = threadM2[thread];
+      counts.zeros(probabilities.n_elem);
+      localMeans.zeros(means.n_rows, means.n_cols);
+      localM2.zeros(means.n_rows, means.n_cols);
+
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables.  If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #ifdef _WIN32
+      #pragma omp for schedule(static)
+      for (intmax_t j = 0; j < (intmax_t) data.n_cols; ++j)
+      #else
+      #pragma omp for schedule(static)
+      for (size_t j = 0; j < data.n_cols; ++j)
+      #endif
+      {
+        const size_t label = labels[j];
+        ++counts[label];
+
+        const arma::vec point(data.col(j));
+        const arma::vec delta = point - localMeans.col(label);
+        localMeans.col(label) += delta / counts[label];
+        localM2.col(label) += delta % (point - localMeans.col(label));
+      }
     }
 
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
-    {
-      if (probabilities[i] > 2)
-        variances.col(i) /= (probabilities[i] - 1);
-    }
+    arma::vec counts;
+    arma::mat m2;
+    GetStatistics(counts, m2);
+    for (size_t t = 0; t < numThreads; ++t)
+      MergeStatistics(counts, m2, threadCounts[t], threadMeans[t],
+          threadM2[t]);
+    SetStatistics(counts, m2);
+    return;
   }
-  else
-  {
-    // Set all parameters to zero
-    probabilities.zeros();
-    means.zeros();
-    variances.zeros();
-
-    // Don't use incremental algorithm.  This is a two-pass algorithm.  It is
-    // possible to calculate the means and variances using a faster one-pass
-    // algorithm but there are some precision and stability issues.  If this is
-    // too slow, it's an option to use the faster algorithm by default and then
-    // have this (and the incremental algorithm) be other options.
-
-    // Calculate the means.
-    for (size_t j = 0; j < data.n_cols; ++j)
-    {
-      const size_t label = labels[j];
-      ++probabilities[label];
-      means.col(label) += data.col(j);
-    }
 
-    // Normalize means.
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
-      if (probabilities[i] != 0.0)
-        means.col(i) /= probabilities[i];
+  // Set all parameters to zero
+  probabilities.zeros();
+  means.zeros();
+  variances.zeros();
 
-    // Calculate variances.
-    for (size_t j = 0; j < data.n_cols; ++j)
-    {
-      const size_t label = labels[j];
-      variances.col(label) += square(data.col(j) - means.col(label));
-    }
+  // Don't use incremental algorithm.  This is a two-pass algorithm.  It is
+  // possible to calculate the means and variances using a faster one-pass
+  // algorithm but there are some precision and stability issues.  If this is
+  // too slow, it's an option to use the faster algorithm by default and then
+  // have this (and the incremental algorithm) be other options.
 
-    // Normalize variances.
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
-      if (probabilities[i] > 1)
-        variances.col(i) /= (probabilities[i] - 1);
+  // Calculate the means.
+  for (size_t j = 0; j < data.n_cols; ++j)
+  {
+    const size_t label = labels[j];
+    ++probabilities[label];
+    means.col(label) += data.col(j);
   }
 
+  // Normalize means.
+  for (size_t i = 0; i < probabilities.n_elem; ++i)
+    if (probabilities[i] != 0.0)
+      means.col(i) /= probabilities[i];
+
+  // Calculate variances.
+  for (size_t j = 0; j < data.n_cols; ++j)
+  {
+    const size_t label = labels[j];
+    variances.col(label) += square(data.col(j) - means.col(label));
+  }
+
+  // Normalize variances.
+  for (size_t i = 0; i < probabilities.n_elem; ++i)
+    if (probabilities[i] > 1)
+      variances.col(i) /= (probabilities[i] - 1);
+
   // Ensure that the variances are invertible.
   for (size_t i = 0; i < variances.n_elem; ++i)
     if (variances[i] == 0.0)
       variances[i] = 1e-50;
 
   probabilities /= data.n_cols;
-  trainingPoints += data.n_cols;
+  trainingPoints = data.n_cols;
 }
 
 template<typename MatType>
@@ -162,6 +199,86 @@ void NaiveBayesClassifier<MatType>::Train(const VecType& point,
   probabilities /= trainingPoints;
 }
 
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Merge(const NaiveBayesClassifier& other)
+{
+  if (other.means.n_rows != means.n_rows ||
+      other.means.n_cols != means.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "NaiveBayesClassifier::Merge(): cannot merge a model with "
+        << other.means.n_rows << " dimensions and " << other.means.n_cols
+        << " classes into a model with " << means.n_rows << " dimensions and "
+        << means.n_cols << " classes";
+    throw std::invalid_argument(oss.str());
+  }
+
+  arma::vec counts, otherCounts;
+  arma::mat m2, otherM2;
+  GetStatistics(counts, m2);
+  other.GetStatistics(otherCounts, otherM2);
+  MergeStatistics(counts, m2, otherCounts, arma::mat(other.means), otherM2);
+  SetStatistics(counts, m2);
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::GetStatistics(arma::vec& counts,
+                                                  arma::mat& m2) const
+{
+  counts = arma::round(probabilities * trainingPoints);
+  m2.zeros(variances.n_rows, variances.n_cols);
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    if (counts[i] > 1)
+      m2.col(i) = variances.col(i) * (counts[i] - 1);
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::MergeStatistics(
+    arma::vec& counts,
+    arma::mat& m2,
+    const arma::vec& otherCounts,
+    const arma::mat& otherMeans,
+    const arma::mat& otherM2)
+{
+  // This is the pairwise update of Chan, Golub and LeVeque.
+  for (size_t i = 0; i < counts.n_elem; ++i)
+  {
+    if (otherCounts[i] == 0)
+      continue;
+
+    const double total = counts[i] + otherCounts[i];
+    const arma::vec delta = otherMeans.col(i) - means.col(i);
+    means.col(i) += delta * (otherCounts[i] / total);
+    m2.col(i) += otherM2.col(i) + square(delta) * (counts[i] * otherCounts[i] /
+        total);
+    counts[i] = total;
+  }
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::SetStatistics(const arma::vec& counts,
+                                                  const arma::mat& m2)
+{
+  for (size_t i = 0; i < counts.n_elem; ++i)
+  {
+    if (counts[i] > 1)
+      variances.col(i) = m2.col(i) / (counts[i] - 1);
+    else
+      variances.col(i) = m2.col(i);
+  }
+
+  // Ensure that the variances are invertible.
+  for (size_t i = 0; i < variances.n_elem; ++i)
+    if (variances[i] == 0.0)
+      variances[i] = 1e-50;
+
+  trainingPoints = (size_t) arma::accu(counts);
+  if (trainingPoints > 0)
+    probabilities = counts / trainingPoints;
+  else
+    probabilities.zeros(counts.n_elem);
+}
+
 template<typename MatType>
 template<typename VecType>
 void NaiveBayesClassifier<MatType>::LogLikelihood(
@@ -173,7 +290,6 @@ void NaiveBayesClassifier<MatType>::LogLikelihood(
   Log::Assert(point.n_rows == means.n_rows);
 
   logLikelihoods = arma::log(probabilities);
-  arma::mat invVar = 1.0 / variances;
 
   // Calculate the joint log likelihood of point for each of the
   // means.n_cols.
@@ -182,15 +298,17 @@ void NaiveBayesClassifier<MatType>::LogLikelihood(
   for (size_t i = 0; i < means.n_cols; i++)
   {
     // This is an adaptation of gmm::phi() for the case where the covariance is
-    // a diagonal matrix.
-    arma::vec diffs = point - means.col(i);
-    arma::vec rhs = -0.5 * arma::diagmat(invVar.col(i)) * diffs;
-    double exponent = arma::accu(diffs % rhs); // log(exp(value)) == value
+    // a diagonal matrix.  Its log-determinant is the sum of the logs of the
+    // variances; computing it this way avoids underflow of the determinant in
+    // high dimensions.
+    const arma::vec diffs = point - means.col(i);
+    const double exponent = -0.5 * arma::accu(square(diffs) /
+        variances.col(i));
 
     // Calculate point log likelihood as sum of logs to decrease floating point
     // errors.
     logLikelihoods(i) += (point.n_rows / -2.0 * log(2 * M_PI) - 0.5 *
-        log(arma::det(arma::diagmat(variances.col(i)))) + exponent);
+        arma::accu(arma::log(variances.col(i))) + exponent);
   }
 }
 
@@ -199,11 +317,68 @@ void NaiveBayesClassifier<MatType>::LogLikelihood(
     const MatType& data,
     arma::mat& logLikelihoods) const
 {
+  BlockLogLikelihood(data, logLikelihoods);
+}
+
+template<typename MatType>
+template<typename eT>
+void NaiveBayesClassifier<MatType>::LogLikelihood(
+    const arma::SpMat<eT>& data,
+    arma::mat& logLikelihoods) const
+{
+  BlockLogLikelihood(data, logLikelihoods);
+}
+
+template<typename MatType>
+template<typename DataType>
+void NaiveBayesClassifier<MatType>::BlockLogLikelihood(
+    const DataType& data,
+    arma::mat& logLikelihoods) const
+{
+  // Check that the number of features in the test data is same as in the
+  // training data.
+  Log::Assert(data.n_rows == means.n_rows);
+
+  // The log likelihood of the point x for the class i is
+  //
+  //   log p_i - 0.5 sum_k (log(2 pi v_ik) + (x_k - m_ik)^2 / v_ik),
+  //
+  // which is a linear function of x and of square(x).  So, for a block of
+  // points, the log likelihoods of all the classes are given by two matrix
+  // products plus a constant for each class; this also works for sparse data,
+  // whose zeros are then never visited.
+  const arma::mat invVar = 1.0 / arma::mat(variances);
+  const arma::mat scaledMeans = arma::mat(means) % invVar;
+  const arma::mat linear = trans(scaledMeans);
+  const arma::mat quadratic = -0.5 * trans(invVar);
+  const arma::vec constant = arma::log(probabilities) - 0.5 *
+      (data.n_rows * log(2 * M_PI) + trans(sum(arma::log(arma::mat(variances)))
+      + sum(arma::mat(means) % scaledMeans)));
+
   logLikelihoods.set_size(means.n_cols, data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
+
+  // Blocks of points are small enough to stay in cache.
+  const size_t blockSize = std::max((size_t) 32768 /
+      std::max(data.n_rows, (size_t) 1), (size_t) 64);
+  const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.  If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+  #else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+  #endif
   {
-    arma::vec v = logLikelihoods.unsafe_col(i);
-    LogLikelihood(data.col(i), v);
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) data.n_cols) - 1;
+
+    logLikelihoods.cols(begin, end) = linear * data.cols(begin, end) +
+        quadratic * square(data.cols(begin, end));
+    logLikelihoods.cols(begin, end).each_col() += constant;
   }
 }
 
@@ -232,13 +407,11 @@ void NaiveBayesClassifier<MatType>::Classify(const VecType& point,
   // term.
   arma::vec logLikelihoods;
   LogLikelihood(point, logLikelihoods);
-  const double logProbX = log(arma::accu(exp(logLikelihoods))); // Log(Prob(X)).
-  logLikelihoods -= logProbX;
 
   arma::uword maxIndex = 0;
   logLikelihoods.max(maxIndex);
   prediction = (size_t) maxIndex;
-  probabilities = exp(logLikelihoods); // log(exp(value)) == value.
+  probabilities = exp(logLikelihoods - LogSumExp(logLikelihoods));
 }
 
 template<typename MatType>
@@ -246,17 +419,20 @@ void NaiveBayesClassifier<MatType>::Classify(
     const MatType& data,
     arma::Row<size_t>& predictions) const
 {
-  predictions.set_size(data.n_cols);
-
   arma::mat logLikelihoods;
   LogLikelihood(data, logLikelihoods);
+  Predict(logLikelihoods, predictions);
+}
 
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    arma::uword maxIndex = 0;
-    logLikelihoods.unsafe_col(i).max(maxIndex);
-    predictions[i] = maxIndex;
-  }
+template<typename MatType>
+template<typename eT>
+void NaiveBayesClassifier<MatType>::Classify(
+    const arma::SpMat<eT>& data,
+    arma::Row<size_t>& predictions) const
+{
+  arma::mat logLikelihoods;
+  LogLikelihood(data, logLikelihoods);
+  Predict(logLikelihoods, predictions);
 }
 
 template<typename MatType>
@@ -265,26 +441,67 @@ void NaiveBayesClassifier<MatType>::Classify(
     arma::Row<size_t>& predictions,
     arma::mat& predictionProbs) const
 {
-  predictions.set_size(data.n_cols);
+  LogLikelihood(data, predictionProbs);
+  Predict(predictionProbs, predictions);
+  Normalize(predictionProbs);
+}
 
-  arma::mat logLikelihoods;
-  LogLikelihood(data, logLikelihoods);
+template<typename MatType>
+template<typename eT>
+void NaiveBayesClassifier<MatType>::Classify(
+    const arma::SpMat<eT>& data,
+    arma::Row<size_t>& predictions,
+    arma::mat& predictionProbs) const
+{
+  LogLikelihood(data, predictionProbs);
+  Predict(predictionProbs, predictions);
+  Normalize(predictionProbs);
+}
 
-  arma::vec logProbX(data.n_cols); // log(Prob(X)) for each point.
-  for (size_t j = 0; j < data.n_cols; ++j)
+template<typename MatType>
+double NaiveBayesClassifier<MatType>::LogSumExp(
+    const arma::vec& logLikelihoods)
+{
+  // Subtract the maximum, so that the largest term is exp(0) = 1 and the sum
+  // can neither underflow to zero nor overflow.
+  const double maxLogLikelihood = logLikelihoods.max();
+  if (!std::isfinite(maxLogLikelihood))
+    return maxLogLikelihood;
+
+  return maxLogLikelihood + log(arma::accu(exp(logLikelihoods -
+      maxLogLikelihood)));
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Predict(
+    const arma::mat& logLikelihoods,
+    arma::Row<size_t>& predictions)
+{
+  predictions.set_size(logLikelihoods.n_cols);
+  for (size_t i = 0; i < logLikelihoods.n_cols; ++i)
   {
-    logProbX(j) = log(arma::accu(exp(logLikelihoods.col(j))));
-    logLikelihoods.col(j) -= logProbX(j);
+    arma::uword maxIndex = 0;
+    logLikelihoods.col(i).max(maxIndex);
+    predictions[i] = maxIndex;
   }
+}
 
-  predictionProbs = arma::exp(logLikelihoods);
-
-  // Now calculate maximum probabilities for each point.
-  for (size_t i = 0; i < data.n_cols; ++i)
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Normalize(arma::mat& logLikelihoods)
+{
+  // Turn the log likelihoods of each point into class probabilities, by
+  // subtracting log(Prob(X)).
+  #ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t j = 0; j < (intmax_t) logLikelihoods.n_cols; ++j)
+  #else
+  #pragma omp parallel for schedule(static)
+  for (size_t j = 0; j < logLikelihoods.n_cols; ++j)
+  #endif
   {
-    arma::uword maxIndex;
-    logLikelihoods.unsafe_col(i).max(maxIndex);
-    predictions[i] = maxIndex;
+    arma::vec column(logLikelihoods.colptr(j), logLikelihoods.n_rows, false,
+        true);
+    column = exp(column - LogSumExp(column));
   }
 }
 
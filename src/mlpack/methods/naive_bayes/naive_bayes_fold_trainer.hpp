@@ -0,0 +1,102 @@
+/**
+ * @file naive_bayes_fold_trainer.hpp
+ *
+ * Specialization of FoldTrainer for NaiveBayesClassifier, which shares the
+ * statistics of each fold between the models of the other folds.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NAIVE_BAYES_NAIVE_BAYES_FOLD_TRAINER_HPP
+#define MLPACK_METHODS_NAIVE_BAYES_NAIVE_BAYES_FOLD_TRAINER_HPP
+
+#include <mlpack/core/cv/fold_trainer.hpp>
+#include "naive_bayes_classifier.hpp"
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * The model of a fold is given by the class counts, means and variances of the
+ * points of the other folds, so a model is trained on each fold once, and the
+ * model of every fold merges the models of the other folds.  The points are
+ * then read once instead of k - 1 times.
+ */
+template<typename MatType>
+class FoldTrainer<naive_bayes::NaiveBayesClassifier<MatType>>
+{
+ public:
+  /**
+   * Train the model of every fold.
+   *
+   * @param cv The cross-validation to train the models of.
+   * @param models Vector of cv.K() models to fill.
+   * @param classes Number of classes in the dataset.
+   * @param incrementalVariance Unused: the merged statistics are always
+   *     computed with the numerically stable incremental algorithm.
+   */
+  template<typename CVType>
+  static void Train(
+      const CVType& cv,
+      std::vector<std::unique_ptr<
+          naive_bayes::NaiveBayesClassifier<MatType>>>& models,
+      const size_t classes,
+      const bool /* incrementalVariance */ = false)
+  {
+    typedef naive_bayes::NaiveBayesClassifier<MatType> ModelType;
+
+    std::vector<std::unique_ptr<ModelType>> statistics(cv.K());
+    std::exception_ptr error;
+
+  #ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) cv.K(); ++i)
+  #else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < cv.K(); ++i)
+  #endif
+    {
+      try
+      {
+        typename CVType::DatasetType data;
+        typename CVType::ResponsesType responses;
+        cv.Fold(i, data, responses);
+        statistics[i].reset(new ModelType(data, responses, classes, true));
+      }
+      catch (...)
+      {
+        #pragma omp critical
+        {
+          if (!error)
+            error = std::current_exception();
+        }
+      }
+    }
+
+    if (error)
+      std::rethrow_exception(error);
+
+  #ifdef _WIN32
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) cv.K(); ++i)
+  #else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < cv.K(); ++i)
+  #endif
+    {
+      models[i].reset(new ModelType(statistics[0]->Means().n_rows, classes));
+      for (size_t j = 0; j < cv.K(); ++j)
+        if (j != (size_t) i)
+          models[i]->Merge(*statistics[j]);
+    }
+  }
+};
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
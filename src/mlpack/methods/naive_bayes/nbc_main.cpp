@@ -14,6 +14,7 @@
  */
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/server.hpp>
 #include <mlpack/core/data/normalize_labels.hpp>
 
 #include "naive_bayes_classifier.hpp"
@@ -41,7 +42,15 @@ PROGRAM_INFO("Parametric Naive Bayes Classifier",
     "specified with the --test_file (-T) option, and the classifications will "
     "be saved to the file specified with the --output_file (-o) option.  If "
     "saving a trained model is desired, the --output_model_file (-M) option "
-    "should be given.");
+    "should be given."
+    "\n\n"
+    "With --server, the program trains or loads the model once and then "
+    "answers requests read from standard input, one per line, until the input "
+    "ends or a line 'quit' is read.  A request holds the options --test_file, "
+    "--output_file and --output_probs_file (or their aliases); for each "
+    "request, a line 'ok' or 'error: <message>' is written to standard output. "
+    " Since --verbose output also goes to standard output, it should not be "
+    "used with --server.");
 
 // A struct for saving the model with mappings.
 struct NBCModel
@@ -80,6 +89,9 @@ PARAM_UROW_OUT("output", "The matrix in which the predicted labels for the"
 PARAM_MATRIX_OUT("output_probs", "The matrix in which the predicted probability"
     " of labels for the test set will be written.", "p");
 
+PARAM_FLAG("server", "If true, answer classification requests read from "
+    "standard input with the model, instead of classifying once.", "");
+
 int main(int argc, char* argv[])
 {
   CLI::ParseCommandLine(argc, argv);
@@ -101,7 +113,7 @@ int main(int argc, char* argv[])
         << "(-t) is not specified." << endl;
 
   if (!CLI::HasParam("output") && !CLI::HasParam("output_model") &&
-      !CLI::HasParam("output_probs"))
+      !CLI::HasParam("output_probs") && !CLI::HasParam("server"))
     Log::Warn << "Neither --output_file (-o), nor --output_model_file (-M), nor"
         << " --output_proba_file (-p) specified; no output will be saved!"
         << endl;
@@ -158,8 +170,53 @@ int main(int argc, char* argv[])
     model = std::move(CLI::GetParam<NBCModel>("input_model"));
   }
 
+  // In server mode, answer requests until the input ends.
+  if (CLI::HasParam("server"))
+  {
+    const vector<string> options = { "test", "output", "output_probs" };
+    const size_t failures = util::ServeRequests(cin, cout, options,
+        [&model](const util::ServerRequest& request)
+    {
+      const string testFile = request.GetParam<string>("test");
+      mat testingData;
+      if (!data::Load(testFile, testingData, false))
+        throw runtime_error("cannot load test data from '" + testFile + "'");
+
+      if (testingData.n_rows != model.nbc.Means().n_rows)
+      {
+        ostringstream oss;
+        oss << "test data dimensionality (" << testingData.n_rows << ") must "
+            << "be the same as training data (" << model.nbc.Means().n_rows
+            << ")";
+        throw invalid_argument(oss.str());
+      }
+
+      Row<size_t> predictions;
+      mat probabilities;
+      model.nbc.Classify(testingData, predictions, probabilities);
+
+      if (request.HasParam("output"))
+      {
+        Row<size_t> rawResults;
+        data::RevertLabels(predictions, model.mappings, rawResults);
+
+        const string file = request.GetParam<string>("output");
+        if (!data::Save(file, rawResults, false))
+          throw runtime_error("cannot save predictions to '" + file + "'");
+      }
+      if (request.HasParam("output_probs"))
+      {
+        const string file = request.GetParam<string>("output_probs");
+        if (!data::Save(file, probabilities, false))
+          throw runtime_error("cannot save probabilities to '" + file + "'");
+      }
+    });
+
+    Log::Info << "Server stopped; " << failures << " request(s) failed."
+        << endl;
+  }
   // Do we need to do testing?
-  if (CLI::HasParam("test"))
+  else if (CLI::HasParam("test"))
   {
     mat testingData = std::move(CLI::GetParam<mat>("test"));
 
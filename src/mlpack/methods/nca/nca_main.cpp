@@ -76,7 +76,13 @@ PROGRAM_INFO("Neighborhood Components Analysis (NCA)",
     "documentation (in lbfgs.hpp) or the vast set of published literature on "
     "L-BFGS."
     "\n\n"
-    "By default, the SGD optimizer is used.");
+    "By default, the SGD optimizer is used."
+    "\n\n"
+    "Computing the NCA objective takes time quadratic in the number of points."
+    "  For large datasets, --num_neighbors (-k) can be given to only consider "
+    "the k nearest neighbors of each point in the stretched space; they are "
+    "searched again every --refresh_interval (-R) iterations (for SGD and "
+    "mini-batch SGD, every --refresh_interval passes over the data).");
 
 PARAM_MATRIX_IN_REQ("input", "Input dataset to run NCA on.", "i");
 PARAM_MATRIX_OUT("output", "Output matrix for learned distance matrix.", "o");
@@ -110,6 +116,11 @@ PARAM_DOUBLE_IN("min_step", "Minimum step of line search for L-BFGS.", "m",
 PARAM_DOUBLE_IN("max_step", "Maximum step of line search for L-BFGS.", "M",
     1e20);
 
+PARAM_INT_IN("num_neighbors", "Number of nearest neighbors to compute the "
+    "objective over (0 indicates all points).", "k", 0);
+PARAM_INT_IN("refresh_interval", "Number of iterations between nearest neighbor"
+    " searches, if --num_neighbors is given.", "R", 10);
+
 PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 
 using namespace mlpack;
@@ -199,6 +210,18 @@ int main(int argc, char* argv[])
   const double maxStep = CLI::GetParam<double>("max_step");
   const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
 
+  if (CLI::GetParam<int>("num_neighbors") < 0)
+    Log::Fatal << "Invalid number of neighbors (" << CLI::GetParam<int>(
+        "num_neighbors") << ")!  Must be greater than or equal to 0." << endl;
+
+  if (CLI::GetParam<int>("refresh_interval") <= 0)
+    Log::Fatal << "Invalid refresh interval (" << CLI::GetParam<int>(
+        "refresh_interval") << ")!  Must be greater than 0." << endl;
+
+  const size_t numNeighbors = (size_t) CLI::GetParam<int>("num_neighbors");
+  const size_t refreshInterval = (size_t) CLI::GetParam<int>(
+      "refresh_interval");
+
   // Load data.
   arma::mat data = std::move(CLI::GetParam<arma::mat>("input"));
 
@@ -250,6 +273,8 @@ int main(int argc, char* argv[])
     nca.Optimizer().MaxIterations() = maxIterations;
     nca.Optimizer().Tolerance() = tolerance;
     nca.Optimizer().Shuffle() = shuffle;
+    nca.Optimizer().Function().NumNeighbors() = numNeighbors;
+    nca.Optimizer().Function().RefreshInterval() = refreshInterval;
 
     nca.LearnDistance(distance);
   }
@@ -264,6 +289,8 @@ int main(int argc, char* argv[])
     nca.Optimizer().MaxLineSearchTrials() = maxLineSearchTrials;
     nca.Optimizer().MinStep() = minStep;
     nca.Optimizer().MaxStep() = maxStep;
+    nca.Optimizer().Function().NumNeighbors() = numNeighbors;
+    nca.Optimizer().Function().RefreshInterval() = refreshInterval;
 
     nca.LearnDistance(distance);
   }
@@ -275,6 +302,8 @@ int main(int argc, char* argv[])
     nca.Optimizer().Tolerance() = tolerance;
     nca.Optimizer().Shuffle() = shuffle;
     nca.Optimizer().BatchSize() = batchSize;
+    nca.Optimizer().Function().NumNeighbors() = numNeighbors;
+    nca.Optimizer().Function().RefreshInterval() = refreshInterval;
 
     nca.LearnDistance(distance);
   }
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_NCA_NCA_SOFTMAX_ERROR_FUNCTION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 namespace mlpack {
 namespace nca {
@@ -37,6 +38,21 @@ namespace nca {
  * optimizers use, overloads of Evaluate() and Gradient() are given which only
  * operate on one point in the dataset.  This is useful for optimizers like
  * stochastic gradient descent (see mlpack::optimization::SGD).
+ *
+ * Computing the exact objective takes O(n^2) time for n points.  If
+ * NumNeighbors() is set to k > 0, the sums over all other points in p_ij and in
+ * the gradient are truncated to the k nearest neighbors of each point in the
+ * stretched space, which are found with neighbor::KNN and refreshed every
+ * RefreshInterval() iterations (for the non-separable functions, an iteration
+ * is an evaluation at new coordinates; for the separable functions, it is a
+ * pass over all the points).  Since the terms of far-away points are
+ * exponentially small, this is a close approximation that takes O(n k) time
+ * per iteration, plus the cost of the neighbor search.  The neighbors are
+ * found with the Euclidean distance, so they are the exact nearest neighbors
+ * when MetricType is the (squared) Euclidean distance.
+ *
+ * The non-separable Gradient() is computed in parallel over the points if
+ * OpenMP is available.
  */
 template<typename MetricType = metric::SquaredEuclideanDistance>
 class SoftmaxErrorFunction
@@ -102,6 +118,33 @@ class SoftmaxErrorFunction
                 const size_t i,
                 arma::mat& gradient);
 
+  /**
+   * Evaluate the softmax function and its gradient for the given covariance
+   * matrix.  This is the non-separable implementation; the precalculation is
+   * only checked once.
+   *
+   * @param covariance Covariance matrix of Mahalanobis distance.
+   * @param gradient Matrix to store the calculated gradient in.
+   * @return The objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& covariance,
+                              arma::mat& gradient);
+
+  /**
+   * Evaluate the softmax objective function and its gradient for the given
+   * covariance matrix on only one point of the dataset, with one scan over the
+   * other points (or the neighbors of the point).  This is the separable
+   * implementation, used by SGD (see EvaluateWithGradientBatch()).
+   *
+   * @param covariance Covariance matrix of Mahalanobis distance.
+   * @param i Index of point to use for objective function.
+   * @param gradient Matrix to store the calculated gradient in.
+   * @return The objective function of the point.
+   */
+  double EvaluateWithGradient(const arma::mat& covariance,
+                              const size_t i,
+                              arma::mat& gradient);
+
   /**
    * Get the initial point.
    */
@@ -113,6 +156,16 @@ class SoftmaxErrorFunction
    */
   size_t NumFunctions() const { return dataset.n_cols; }
 
+  //! Get the number of neighbors that p_ij is computed over (0 means all).
+  size_t NumNeighbors() const { return numNeighbors; }
+  //! Modify the number of neighbors that p_ij is computed over (0 means all).
+  size_t& NumNeighbors() { return numNeighbors; }
+
+  //! Get the number of iterations between neighbor searches.
+  size_t RefreshInterval() const { return refreshInterval; }
+  //! Modify the number of iterations between neighbor searches.
+  size_t& RefreshInterval() { return refreshInterval; }
+
  private:
   //! The dataset.
   const arma::mat& dataset;
@@ -135,6 +188,29 @@ class SoftmaxErrorFunction
   //! False if nothing has ever been precalculated (only at construction time).
   bool precalculated;
 
+  //! The number of neighbors to truncate the sums to (0 means no truncation).
+  size_t numNeighbors;
+  //! The number of iterations between neighbor searches.
+  size_t refreshInterval;
+  //! The nearest neighbors of each point in the stretched space (one column
+  //! per point); empty until the first search.
+  arma::Mat<size_t> neighbors;
+  //! The number of iterations since the last neighbor search.
+  size_t neighborAge;
+  //! The number of separable evaluations since the last full pass.
+  size_t separableCalls;
+
+  /**
+   * Search for the nearest neighbors of each point in the stretched space if
+   * no search has been done yet, or if the last one is more than
+   * refreshInterval iterations old.  If separable is true, this counts as one
+   * call of a separable function.
+   *
+   * @param coordinates Coordinates matrix to stretch the dataset with.
+   * @param separable Whether this is called by a separable function.
+   */
+  void RefreshNeighbors(const arma::mat& coordinates, const bool separable);
+
   /**
    * Precalculate the denominators and numerators that will make up the p_ij,
    * but only if the coordinates matrix is different than the last coordinates
@@ -144,7 +220,7 @@ class SoftmaxErrorFunction
    * This will update last_coordinates_ and stretched_dataset_, and also
    * calculate the p_i and denominators_ which are used in the calculation of
    * p_i or p_ij.  The calculation will be O((n * (n + 1)) / 2), which is not
-   * great.
+   * great, or O(n k) when the sums are truncated to k neighbors.
    *
    * @param coordinates Coordinates matrix to use for precalculation.
    */
@@ -15,6 +15,10 @@
 // In case it hasn't been included already.
 #include "nca_softmax_error_function.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace nca {
 
@@ -27,7 +31,11 @@ SoftmaxErrorFunction<MetricType>::SoftmaxErrorFunction(
     dataset(dataset),
     labels(labels),
     metric(metric),
-    precalculated(false)
+    precalculated(false),
+    numNeighbors(0),
+    refreshInterval(10),
+    neighborAge(0),
+    separableCalls(0)
 { /* nothing to do */ }
 
 //! The non-separable implementation, which uses Precalculate() to save time.
@@ -51,6 +59,34 @@ double SoftmaxErrorFunction<MetricType>::Evaluate(const arma::mat& coordinates,
   double denominator = 0;
   double numerator = 0;
 
+  // With truncation, only the neighbors of the point need to be stretched.
+  if (numNeighbors > 0)
+  {
+    RefreshNeighbors(coordinates, true);
+
+    const arma::vec stretchedPoint = coordinates * dataset.col(i);
+    for (size_t m = 0; m < neighbors.n_rows; ++m)
+    {
+      const size_t k = neighbors(m, i);
+      const arma::vec stretchedNeighbor = coordinates * dataset.col(k);
+      const double eval = std::exp(-metric.Evaluate(stretchedPoint,
+          stretchedNeighbor));
+
+      if (labels[i] == labels[k])
+        numerator += eval;
+
+      denominator += eval;
+    }
+
+    if (denominator == 0.0)
+    {
+      Log::Warn << "Denominator of p_" << i << " is 0!" << std::endl;
+      return 0;
+    }
+
+    return -(numerator / denominator);
+  }
+
   // It's quicker to do this now than one point at a time later.
   stretchedDataset = coordinates * dataset;
 
@@ -103,39 +139,108 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
   //     (((p_i - (1 / p_i)) p_ik) + ((p_k - (1 / p_k)) p_ki)) x_ik x_ik^T
   //   otherwise, add
   //     (p_i p_ik + p_k p_ki) x_ik x_ik^T
+  //
+  // With truncation, the neighbor relation isn't symmetric, so each point i
+  // instead adds, for each of its neighbors k,
+  //   (p_i - 1) p_ik x_ik x_ik^T if k is in the class of i, and
+  //   p_i p_ik x_ik x_ik^T otherwise.
+  //
+  // Each thread sums the terms of its points into its own matrix.
+  const size_t n = stretchedDataset.n_cols;
   arma::mat sum;
-  sum.zeros(stretchedDataset.n_rows, stretchedDataset.n_rows);
-  for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+  sum.zeros(dataset.n_rows, dataset.n_rows);
+
+  #pragma omp parallel
   {
-    for (size_t k = (i + 1); k < stretchedDataset.n_cols; k++)
+    arma::mat threadSum;
+    threadSum.zeros(dataset.n_rows, dataset.n_rows);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) n; i++)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t i = 0; i < n; i++)
+#endif
     {
-      // Calculate p_ik and p_ki first.
-      double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                         stretchedDataset.unsafe_col(k)));
-      double p_ik = 0, p_ki = 0;
-      p_ik = eval / denominators(i);
-      p_ki = eval / denominators(k);
-
-      // Subtract x_i from x_k.  We are not using stretched points here.
-      arma::vec x_ik = dataset.col(i) - dataset.col(k);
-      arma::mat secondTerm = (x_ik * trans(x_ik));
+      if (numNeighbors > 0)
+      {
+        for (size_t m = 0; m < neighbors.n_rows; m++)
+        {
+          const size_t k = neighbors(m, i);
+          const double eval = exp(-metric.Evaluate(
+              stretchedDataset.unsafe_col(i), stretchedDataset.unsafe_col(k)));
+          const double p_ik = eval / denominators(i);
+
+          // Subtract x_i from x_k.  We are not using stretched points here.
+          const arma::vec x_ik = dataset.col(i) - dataset.col(k);
+          if (labels[i] == labels[k])
+            threadSum += ((p[i] - 1) * p_ik) * (x_ik * trans(x_ik));
+          else
+            threadSum += (p[i] * p_ik) * (x_ik * trans(x_ik));
+        }
+
+        continue;
+      }
 
-      if (labels[i] == labels[k])
-        sum += ((p[i] - 1) * p_ik + (p[k] - 1) * p_ki) * secondTerm;
-      else
-        sum += (p[i] * p_ik + p[k] * p_ki) * secondTerm;
+      for (size_t k = (i + 1); k < n; k++)
+      {
+        // Calculate p_ik and p_ki first.
+        double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
+                                           stretchedDataset.unsafe_col(k)));
+        double p_ik = 0, p_ki = 0;
+        p_ik = eval / denominators(i);
+        p_ki = eval / denominators(k);
+
+        // Subtract x_i from x_k.  We are not using stretched points here.
+        arma::vec x_ik = dataset.col(i) - dataset.col(k);
+        arma::mat secondTerm = (x_ik * trans(x_ik));
+
+        if (labels[i] == labels[k])
+          threadSum += ((p[i] - 1) * p_ik + (p[k] - 1) * p_ki) * secondTerm;
+        else
+          threadSum += (p[i] * p_ik + p[k] * p_ki) * secondTerm;
+      }
     }
+
+    #pragma omp critical
+    sum += threadSum;
   }
 
   // Assemble the final gradient.
   gradient = -2 * coordinates * sum;
 }
 
+//! The non-separable implementation of the objective and the gradient.
+template<typename MetricType>
+double SoftmaxErrorFunction<MetricType>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient)
+{
+  // Gradient() precalculates the p_i for these coordinates.
+  Gradient(coordinates, gradient);
+
+  return -accu(p); // Negate because our solver minimizes.
+}
+
 //! The separable implementation.
 template<typename MetricType>
 void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
                                                 const size_t i,
                                                 arma::mat& gradient)
+{
+  EvaluateWithGradient(coordinates, i, gradient);
+}
+
+//! The separable implementation of the objective and the gradient.
+template<typename MetricType>
+double SoftmaxErrorFunction<MetricType>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    const size_t i,
+    arma::mat& gradient)
 {
   // We will need to calculate p_i before this evaluation is done, so these two
   // variables will hold the information necessary for that.
@@ -150,18 +255,42 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
   firstTerm.zeros(coordinates.n_rows, coordinates.n_cols);
   secondTerm.zeros(coordinates.n_rows, coordinates.n_cols);
 
-  // Compute the stretched dataset.
-  stretchedDataset = coordinates * dataset;
+  // With truncation, only the neighbors of the point are considered, and only
+  // they need to be stretched.
+  arma::vec stretchedPoint;
+  if (numNeighbors > 0)
+  {
+    RefreshNeighbors(coordinates, true);
+    stretchedPoint = coordinates * dataset.col(i);
+  }
+  else
+  {
+    // Compute the stretched dataset.
+    stretchedDataset = coordinates * dataset;
+  }
 
-  for (size_t k = 0; k < dataset.n_cols; ++k)
+  const size_t numCandidates = (numNeighbors > 0) ? neighbors.n_rows :
+      dataset.n_cols;
+  for (size_t m = 0; m < numCandidates; ++m)
   {
+    const size_t k = (numNeighbors > 0) ? neighbors(m, i) : m;
+
     // Don't consider the case where the points are the same.
     if (i == k)
       continue;
 
     // Calculate the numerator of p_ik.
-    double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                       stretchedDataset.unsafe_col(k)));
+    double eval;
+    if (numNeighbors > 0)
+    {
+      const arma::vec stretchedNeighbor = coordinates * dataset.col(k);
+      eval = exp(-metric.Evaluate(stretchedPoint, stretchedNeighbor));
+    }
+    else
+    {
+      eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
+                                  stretchedDataset.unsafe_col(k)));
+    }
 
     // If the points are in the same class, we must add to the second term of
     // the gradient as well as the numerator of p_i.  We will divide by the
@@ -187,7 +316,7 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
     // If the denominator is zero, then all p_ik should be zero and there is
     // no gradient contribution from this point.
     gradient.zeros(coordinates.n_rows, coordinates.n_rows);
-    return;
+    return 0;
   }
   else
   {
@@ -199,6 +328,8 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
   // Now multiply the first term by p_i, and add the two together and multiply
   // all by 2 * A.  We negate it though, because our optimizer is a minimizer.
   gradient = -2 * coordinates * (p * firstTerm - secondTerm);
+
+  return -p; // Negate because the optimizer is a minimizer.
 }
 
 template<typename MetricType>
@@ -231,23 +362,55 @@ void SoftmaxErrorFunction<MetricType>::Precalculate(
   // order of O((n * (n + 1)) / 2), which really isn't all that great.
   p.zeros(stretchedDataset.n_cols);
   denominators.zeros(stretchedDataset.n_cols);
-  for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+  if (numNeighbors > 0)
   {
-    for (size_t j = (i + 1); j < stretchedDataset.n_cols; j++)
+    // Only the neighbors of each point are considered, so this is O(n k), and
+    // each point only updates its own sums.
+    RefreshNeighbors(coordinates, false);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) stretchedDataset.n_cols; i++)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+#endif
     {
-      // Evaluate exp(-d(x_i, x_j)).
-      double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                         stretchedDataset.unsafe_col(j)));
-
-      // Add this to the denominators of both p_i and p_j: K(i, j) = K(j, i).
-      denominators[i] += eval;
-      denominators[j] += eval;
+      for (size_t m = 0; m < neighbors.n_rows; m++)
+      {
+        const size_t j = neighbors(m, i);
+        const double eval = exp(-metric.Evaluate(
+            stretchedDataset.unsafe_col(i), stretchedDataset.unsafe_col(j)));
 
-      // If i and j are the same class, add to numerator of both.
-      if (labels[i] == labels[j])
+        denominators[i] += eval;
+        if (labels[i] == labels[j])
+          p[i] += eval;
+      }
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+    {
+      for (size_t j = (i + 1); j < stretchedDataset.n_cols; j++)
       {
-        p[i] += eval;
-        p[j] += eval;
+        // Evaluate exp(-d(x_i, x_j)).
+        double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
+                                           stretchedDataset.unsafe_col(j)));
+
+        // Add this to the denominators of both p_i and p_j: K(i, j) = K(j, i).
+        denominators[i] += eval;
+        denominators[j] += eval;
+
+        // If i and j are the same class, add to numerator of both.
+        if (labels[i] == labels[j])
+        {
+          p[i] += eval;
+          p[j] += eval;
+        }
       }
     }
   }
@@ -272,6 +435,35 @@ void SoftmaxErrorFunction<MetricType>::Precalculate(
   precalculated = true;
 }
 
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::RefreshNeighbors(
+    const arma::mat& coordinates,
+    const bool separable)
+{
+  if (separable && (++separableCalls >= dataset.n_cols))
+  {
+    // One pass over the points is one iteration.
+    separableCalls = 0;
+    ++neighborAge;
+  }
+  else if (!separable)
+  {
+    ++neighborAge;
+  }
+
+  if ((neighbors.n_cols == dataset.n_cols) && (neighborAge < refreshInterval))
+    return;
+
+  // Each point is not its own neighbor, so there are at most n - 1.
+  const size_t k = std::min(numNeighbors, (size_t) dataset.n_cols - 1);
+  neighbor::KNN knn(arma::mat(coordinates * dataset));
+  arma::mat distances;
+  knn.Search(k, neighbors, distances);
+
+  neighborAge = 0;
+  separableCalls = 0;
+}
+
 } // namespace nca
 } // namespace mlpack
 
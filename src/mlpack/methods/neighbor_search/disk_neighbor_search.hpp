@@ -0,0 +1,156 @@
+/**
+ * @file disk_neighbor_search.hpp
+ *
+ * Defines the DiskNeighborSearch class, which performs neighbor searches on a
+ * reference set that is stored on disk as shards, each with its own tree, and
+ * read into memory one shard at a time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_DISK_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_DISK_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "neighbor_search.hpp"
+#include "sharded_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The DiskNeighborSearch class performs exact (or approximate, with epsilon)
+ * neighbor searches on a reference set that is larger than memory.  The
+ * reference set is split into shards, and each shard is saved to its own file
+ * as a NeighborSearch model, holding the points of the shard and their tree, in
+ * mlpack's binary model format (.mlmodel), in which the tree is stored as flat
+ * arrays of nodes.  BuildShards() writes these files from any batch source
+ * (see data/batch_source.hpp); for instance, a data::MappedBatchSource over an
+ * .mlbin file reads the reference set from disk one shard at a time.
+ *
+ * A search reads the shards in order, and searches the whole query set in
+ * each of them, while the next shard is read from disk in a background thread;
+ * so at most two shards are in memory at any time, and reading the shards is
+ * overlapped with searching them.  The best k neighbors over all the shards
+ * read so far are kept for each query point.  A query point is only searched
+ * in a shard if the root bound of the tree of the shard may hold a better
+ * neighbor than its current k'th best one.
+ *
+ * The point with index i in shard s has the index Offset(s) + i in the
+ * results, where the offsets are the numbers of points of the shards before
+ * it; the offsets are known once a search has read all the shards.
+ *
+ * @code
+ * data::MappedBatchSource<double> source("reference.mlbin", 1000000);
+ * std::vector<std::string> files =
+ *     DiskNeighborSearch<>::BuildShards(source, "reference_shard");
+ *
+ * DiskNeighborSearch<> knn(files);
+ * knn.Search(querySet, 5, neighbors, distances);
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam MetricType The metric to use for computation.
+ * @tparam MatType The type of data matrix.
+ * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         typename MetricType = mlpack::metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class DiskNeighborSearch
+{
+ public:
+  //! The type of the search of each shard.
+  typedef NeighborSearch<SortPolicy, MetricType, MatType, TreeType> NSType;
+
+  /**
+   * Build a tree on each shard of the given batch source, and save the points
+   * of the shard with their tree to the file prefix + "_" + s + ".mlmodel" (for
+   * shard s).  Only one shard is held in memory at a time.  The responses of
+   * the batch source are ignored.  A std::runtime_error is thrown if a file
+   * can't be written, and a std::invalid_argument if a shard is empty or if
+   * the shards have different dimensionalities.
+   *
+   * @param source Batch source giving the shards of the reference set.
+   * @param prefix Prefix of the names of the files to write.
+   * @param mode Neighbor search mode used to search each shard.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   * @return The names of the files, in the order of the shards.
+   */
+  template<typename SourceType>
+  static std::vector<std::string> BuildShards(
+      SourceType& source,
+      const std::string& prefix,
+      const NeighborSearchMode mode = DUAL_TREE_MODE,
+      const double epsilon = 0,
+      const MetricType metric = MetricType());
+
+  /**
+   * Create the search over the given shard files, written by BuildShards().
+   * No file is read until Search() is called.
+   *
+   * @param shardFiles Names of the files of the shards.
+   */
+  DiskNeighborSearch(const std::vector<std::string>& shardFiles);
+
+  /**
+   * For each point in the query set, compute the k best neighbors among the
+   * points of all the shards, and store their indices and distances in the
+   * given matrices, which will have k rows and one column for each query
+   * point.  A std::runtime_error is thrown if a shard can't be read, and a
+   * std::invalid_argument if there are fewer than k reference points or if
+   * the dimensionalities do not match.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the number of shards.
+  size_t NumShards() const { return shardFiles.size(); }
+  //! Get the names of the files of the shards.
+  const std::vector<std::string>& ShardFiles() const { return shardFiles; }
+
+  //! Get the number of points in all the shards (0 before the first search).
+  size_t NumPoints() const { return offsets.empty() ? 0 : offsets.back(); }
+  //! Get the index of the first point of the given shard in the results
+  //! (only after the first search).
+  size_t Offset(const size_t shard) const { return offsets[shard]; }
+
+  //! Get the number of (query point, shard) pairs that were pruned by the
+  //! last search.
+  size_t PrunedShards() const { return prunedShards; }
+
+ private:
+  //! The names of the files of the shards.
+  std::vector<std::string> shardFiles;
+  //! The index of the first point of each shard, and the number of points
+  //! (empty before the first search).
+  std::vector<size_t> offsets;
+  //! The number of (query point, shard) pairs pruned by the last search.
+  size_t prunedShards;
+
+  //! Read the search of the given shard from its file.
+  NSType* LoadShard(const size_t shard) const;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "disk_neighbor_search_impl.hpp"
+
+#endif
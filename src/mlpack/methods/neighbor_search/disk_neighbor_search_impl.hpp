@@ -0,0 +1,258 @@
+/**
+ * @file disk_neighbor_search_impl.hpp
+ *
+ * Implementation of the DiskNeighborSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_DISK_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_DISK_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "disk_neighbor_search.hpp"
+
+#include <exception>
+#include <memory>
+#include <thread>
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename SourceType>
+std::vector<std::string>
+DiskNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::BuildShards(
+    SourceType& source,
+    const std::string& prefix,
+    const NeighborSearchMode mode,
+    const double epsilon,
+    const MetricType metric)
+{
+  if (epsilon < 0)
+    throw std::invalid_argument("epsilon must be non-negative");
+  if (source.NumShards() == 0)
+    throw std::invalid_argument("there must be at least one shard");
+
+  std::vector<std::string> files;
+  size_t dimensionality = 0;
+  for (size_t s = 0; s < source.NumShards(); ++s)
+  {
+    MatType shard, responses;
+    source.LoadShard(s, shard, responses);
+    if (shard.n_cols == 0)
+      throw std::invalid_argument("shards must not be empty");
+    if (s == 0)
+      dimensionality = shard.n_rows;
+    if (shard.n_rows != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "shard " << s << " has dimensionality " << shard.n_rows
+          << ", but shard 0 has dimensionality " << dimensionality;
+      throw std::invalid_argument(oss.str());
+    }
+
+    std::ostringstream filename;
+    filename << prefix << "_" << s << ".mlmodel";
+    NSType search(std::move(shard), mode, epsilon, metric);
+    data::Save(filename.str(), "shard", search, true);
+    files.push_back(filename.str());
+
+    Log::Info << "Saved shard " << s << " (" << search.ReferenceSet().n_cols
+        << " points) to '" << filename.str() << "'." << std::endl;
+  }
+
+  return files;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+DiskNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+DiskNeighborSearch(const std::vector<std::string>& shardFiles) :
+    shardFiles(shardFiles),
+    prunedShards(0)
+{
+  if (shardFiles.empty())
+    throw std::invalid_argument("there must be at least one shard");
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+typename DiskNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::NSType*
+DiskNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::LoadShard(
+    const size_t shard) const
+{
+  std::unique_ptr<NSType> search(new NSType());
+  data::Load(shardFiles[shard], "shard", *search, true);
+  if (search->ReferenceSet().n_cols == 0)
+  {
+    std::ostringstream oss;
+    oss << "shard '" << shardFiles[shard] << "' is empty";
+    throw std::runtime_error(oss.str());
+  }
+
+  return search.release();
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DiskNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  // The number of points is only known once all the shards have been read.
+  if (!offsets.empty() && k > NumPoints())
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << NumPoints() << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  const size_t numQueries = querySet.n_cols;
+  neighbors.set_size(k, numQueries);
+  neighbors.fill(SIZE_MAX);
+  distances.set_size(k, numQueries);
+  distances.fill(SortPolicy::WorstDistance());
+  if (k == 0)
+    return;
+
+  std::vector<size_t> newOffsets(1, 0);
+  size_t pruned = 0;
+  std::unique_ptr<NSType> current(LoadShard(0));
+  for (size_t s = 0; s < shardFiles.size(); ++s)
+  {
+    // Read the next shard while this one is searched.
+    std::unique_ptr<NSType> next;
+    std::exception_ptr error;
+    std::thread prefetcher;
+    if (s + 1 < shardFiles.size())
+    {
+      prefetcher = std::thread([this, s, &next, &error]()
+      {
+        try
+        {
+          next.reset(LoadShard(s + 1));
+        }
+        catch (...)
+        {
+          error = std::current_exception();
+        }
+      });
+    }
+
+    try
+    {
+      const NSType& search = *current;
+      const size_t shardPoints = search.ReferenceSet().n_cols;
+      if (querySet.n_rows != search.ReferenceSet().n_rows)
+      {
+        std::ostringstream oss;
+        oss << "dimensionality of query set (" << querySet.n_rows << ") is not "
+            << "equal to the dimensionality of shard " << s << " ("
+            << search.ReferenceSet().n_rows << ")";
+        throw std::invalid_argument(oss.str());
+      }
+      newOffsets.push_back(newOffsets.back() + shardPoints);
+
+      // Only search the query points whose k'th best neighbor could be
+      // improved by a point of this shard.  There is no tree to bound the
+      // shard with in naive mode.
+      std::vector<arma::uword> queries;
+      for (size_t q = 0; q < numQueries; ++q)
+      {
+        const double kthBest = SortPolicy::Relax(distances(k - 1, q),
+            search.Epsilon());
+        if (search.SearchMode() == NAIVE_MODE ||
+            SortPolicy::IsBetter(SortPolicy::BestPointToNodeDistance(
+            querySet.col(q), &search.ReferenceTree()), kthBest))
+          queries.push_back(q);
+        else
+          ++pruned;
+      }
+
+      if (!queries.empty())
+      {
+        const arma::uvec queryIndices(queries);
+        const size_t shardK = std::min(k, shardPoints);
+        arma::Mat<size_t> shardNeighbors;
+        arma::mat shardDistances;
+        current->Search(querySet.cols(queryIndices), shardK, shardNeighbors,
+            shardDistances);
+
+        // Merge the results of this shard into the best results so far.
+        arma::Mat<size_t> mergedNeighbors(k, numQueries);
+        mergedNeighbors.fill(SIZE_MAX);
+        arma::mat mergedDistances(k, numQueries);
+        mergedDistances.fill(SortPolicy::WorstDistance());
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+          for (size_t j = 0; j < shardK; ++j)
+          {
+            mergedNeighbors(j, queries[i]) = newOffsets[s] +
+                shardNeighbors(j, i);
+            mergedDistances(j, queries[i]) = shardDistances(j, i);
+          }
+        }
+
+        ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+            MergeResults(neighbors, distances, mergedNeighbors,
+            mergedDistances);
+      }
+    }
+    catch (...)
+    {
+      if (prefetcher.joinable())
+        prefetcher.join();
+      throw;
+    }
+
+    // Free this shard before waiting for the next one.
+    current.reset();
+    if (prefetcher.joinable())
+      prefetcher.join();
+    if (error)
+      std::rethrow_exception(error);
+    current = std::move(next);
+
+    Log::Info << "Searched shard " << s << " of " << shardFiles.size() << "."
+        << std::endl;
+  }
+
+  offsets = std::move(newOffsets);
+  prunedShards = pruned;
+
+  if (k > NumPoints())
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << NumPoints() << ")";
+    throw std::invalid_argument(ss.str());
+  }
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
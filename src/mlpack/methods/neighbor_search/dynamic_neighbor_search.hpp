@@ -0,0 +1,251 @@
+/**
+ * @file dynamic_neighbor_search.hpp
+ *
+ * Defines the DynamicNeighborSearch class, which performs neighbor searches on
+ * a reference set that points can be inserted into and deleted from.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_DYNAMIC_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_DYNAMIC_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The DynamicNeighborSearch class performs the same searches as the
+ * NeighborSearch class, on a reference set that points may be inserted into
+ * and deleted from at any time, with any tree type (the trees themselves are
+ * never modified).
+ *
+ * This is done with the logarithmic method: the reference points are held in
+ * a small buffer and in a forest of static trees, where the tree of level i
+ * holds about bufferSize * 2^i points.  New points go into the buffer, which
+ * is searched by brute force; when the buffer is full, it is merged with the
+ * trees of the levels below the first empty level into one new tree on that
+ * level.  Each point is thus moved into a new tree only O(log n) times.
+ * Deleted points are only marked as deleted and skipped at search time; a
+ * tree is rebuilt without its deleted points once more than half of its
+ * points are deleted.  Compact() rebuilds everything into a single tree, which
+ * gives the fastest searches, and may be called whenever it is convenient.
+ *
+ * At search time, each tree is searched with a NeighborSearch object, and the
+ * results of the trees and of the buffer are merged.
+ *
+ * Each point is identified by the index returned by Insert(); the points given
+ * to Train() get the indices 0 to n - 1.  The neighbors returned by Search()
+ * are these indices.
+ *
+ * @code
+ * DynamicNeighborSearch<> knn(referenceSet);
+ * const size_t index = knn.Insert(newPoint);
+ * knn.Delete(3);
+ * knn.Search(querySet, 5, neighbors, distances);
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam MetricType The metric to use for computation.
+ * @tparam MatType The type of data matrix.
+ * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         typename MetricType = mlpack::metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class DynamicNeighborSearch
+{
+ public:
+  //! The type of the searches of each tree.
+  typedef NeighborSearch<SortPolicy, MetricType, MatType, TreeType> NSType;
+  //! The type of each tree.
+  typedef typename NSType::Tree Tree;
+  //! The type of a single point.
+  typedef arma::Col<typename MatType::elem_type> VecType;
+
+  /**
+   * Create the object with an empty reference set.
+   *
+   * @param bufferSize Number of inserted points that are held in the buffer
+   *     before they are put into a tree.
+   * @param mode Neighbor search mode used to search each tree.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   */
+  DynamicNeighborSearch(const size_t bufferSize = 128,
+                        const NeighborSearchMode mode = DUAL_TREE_MODE,
+                        const double epsilon = 0,
+                        const MetricType metric = MetricType());
+
+  /**
+   * Create the object and build a tree on the given reference set.  The
+   * points get the indices 0 to referenceSet.n_cols - 1.
+   *
+   * @param referenceSet Set of reference points.
+   * @param bufferSize Number of inserted points that are held in the buffer
+   *     before they are put into a tree.
+   * @param mode Neighbor search mode used to search each tree.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   */
+  DynamicNeighborSearch(MatType referenceSet,
+                        const size_t bufferSize = 128,
+                        const NeighborSearchMode mode = DUAL_TREE_MODE,
+                        const double epsilon = 0,
+                        const MetricType metric = MetricType());
+
+  //! The trees are not copyable.
+  DynamicNeighborSearch(const DynamicNeighborSearch& other) = delete;
+  //! The trees are not copyable.
+  DynamicNeighborSearch& operator=(const DynamicNeighborSearch& other) =
+      delete;
+
+  //! Delete all of the trees.
+  ~DynamicNeighborSearch();
+
+  /**
+   * Replace the reference set with the given one.  All points previously
+   * inserted are removed, and the new points get the indices 0 to
+   * referenceSet.n_cols - 1.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(MatType referenceSet);
+
+  /**
+   * Insert a point into the reference set, and return its index.  A
+   * std::invalid_argument is thrown if the dimensionality of the point is
+   * wrong.
+   *
+   * @param point Point to insert.
+   */
+  size_t Insert(const VecType& point);
+
+  /**
+   * Delete the point with the given index from the reference set.  A
+   * std::invalid_argument is thrown if there is no such point.
+   *
+   * @param index Index of the point to delete.
+   */
+  void Delete(const size_t index);
+
+  //! Return whether the point with the given index is in the reference set.
+  bool Contains(const size_t index) const
+  {
+    return (index < location.size()) && (location[index] != removedLocation);
+  }
+
+  /**
+   * Put all of the points into a single tree, dropping the deleted points.
+   * This makes searches as fast as with a NeighborSearch object built on the
+   * same points.
+   */
+  void Compact();
+
+  /**
+   * For each point in the query set, compute the k best neighbors among the
+   * points of the reference set, and store their indices and distances in the
+   * given matrices, which will have k rows and one column for each query
+   * point.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the number of points in the reference set.
+  size_t NumPoints() const { return numPoints; }
+
+  //! Get the number of trees in the forest.
+  size_t NumTrees() const;
+
+  //! Get the number of points held in the buffer.
+  size_t NumBufferedPoints() const { return bufferIndices.size(); }
+
+  //! Get the size of the buffer.
+  size_t BufferSize() const { return bufferSize; }
+
+ private:
+  //! One tree of the forest.
+  struct Level
+  {
+    //! The search on the tree.
+    NSType* search;
+    //! The index of each point of the tree's dataset.
+    std::vector<size_t> indices;
+    //! The number of points of the tree that have been deleted.
+    size_t numDeleted;
+  };
+
+  //! The location of points that are held in the buffer.
+  static const size_t bufferLocation = size_t(-1);
+  //! The location of points that have been deleted.
+  static const size_t removedLocation = size_t(-2);
+
+  //! Number of points held in the buffer before they are put into a tree.
+  size_t bufferSize;
+  //! The search mode for each tree.
+  NeighborSearchMode searchMode;
+  //! Relative approximate error.
+  double epsilon;
+  //! Instantiated metric.
+  MetricType metric;
+
+  //! The trees of each level (NULL for empty levels).
+  std::vector<Level*> levels;
+  //! The buffer of inserted points; it has bufferSize columns, of which the
+  //! first bufferIndices.size() are used.
+  MatType buffer;
+  //! The index of each point in the buffer.
+  std::vector<size_t> bufferIndices;
+  //! The level of each point (or bufferLocation or removedLocation), by
+  //! index.
+  std::vector<size_t> location;
+  //! The number of points in the reference set.
+  size_t numPoints;
+
+  //! Build a tree on the given points, and put it on the given (empty) level.
+  void BuildLevel(const size_t level,
+                  MatType&& dataset,
+                  std::vector<size_t>&& indices);
+
+  //! Append the points of the given level that have not been deleted to the
+  //! given dataset, starting at column indices.size().
+  void AppendLevel(const Level& level,
+                   MatType& dataset,
+                   std::vector<size_t>& indices) const;
+
+  //! Put the buffer and the trees below the first empty level into that level.
+  void MergeBuffer();
+
+  //! Rebuild the tree of the given level without its deleted points.
+  void CompactLevel(const size_t level);
+
+  //! Delete all trees and empty the buffer.
+  void Clear();
+
+  //! Get the smallest level that can hold the given number of points.
+  size_t LevelFor(const size_t count) const;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "dynamic_neighbor_search_impl.hpp"
+
+#endif
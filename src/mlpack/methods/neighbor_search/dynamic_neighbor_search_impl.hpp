@@ -0,0 +1,502 @@
+/**
+ * @file dynamic_neighbor_search_impl.hpp
+ *
+ * Implementation of the DynamicNeighborSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_DYNAMIC_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_DYNAMIC_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "dynamic_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+const size_t DynamicNeighborSearch<SortPolicy, MetricType, MatType,
+    TreeType>::bufferLocation;
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+const size_t DynamicNeighborSearch<SortPolicy, MetricType, MatType,
+    TreeType>::removedLocation;
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+DynamicNeighborSearch(const size_t bufferSize,
+                      const NeighborSearchMode mode,
+                      const double epsilon,
+                      const MetricType metric) :
+    bufferSize(bufferSize),
+    searchMode(mode),
+    epsilon(epsilon),
+    metric(metric),
+    numPoints(0)
+{
+  if (bufferSize == 0)
+    throw std::invalid_argument("bufferSize must be positive");
+  if (epsilon < 0)
+    throw std::invalid_argument("epsilon must be non-negative");
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+DynamicNeighborSearch(MatType referenceSet,
+                      const size_t bufferSize,
+                      const NeighborSearchMode mode,
+                      const double epsilon,
+                      const MetricType metric) :
+    DynamicNeighborSearch(bufferSize, mode, epsilon, metric)
+{
+  Train(std::move(referenceSet));
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+~DynamicNeighborSearch()
+{
+  Clear();
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::Train(
+    MatType referenceSet)
+{
+  Clear();
+
+  const size_t n = referenceSet.n_cols;
+  buffer.set_size(referenceSet.n_rows, bufferSize);
+  location.assign(n, 0);
+  numPoints = n;
+
+  if (n > 0)
+  {
+    std::vector<size_t> indices(n);
+    for (size_t i = 0; i < n; ++i)
+      indices[i] = i;
+
+    BuildLevel(LevelFor(n), std::move(referenceSet), std::move(indices));
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+size_t DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+Insert(const VecType& point)
+{
+  // The first point decides the dimensionality, if there was no reference set.
+  if (buffer.n_rows == 0)
+    buffer.set_size(point.n_elem, bufferSize);
+
+  if (point.n_elem != buffer.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "DynamicNeighborSearch::Insert(): point has dimensionality "
+        << point.n_elem << ", but the reference set has dimensionality "
+        << buffer.n_rows;
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t index = location.size();
+  buffer.col(bufferIndices.size()) = point;
+  bufferIndices.push_back(index);
+  location.push_back(bufferLocation);
+  ++numPoints;
+
+  if (bufferIndices.size() == bufferSize)
+    MergeBuffer();
+
+  return index;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::Delete(
+    const size_t index)
+{
+  if (!Contains(index))
+  {
+    std::ostringstream oss;
+    oss << "DynamicNeighborSearch::Delete(): there is no point with index "
+        << index << " in the reference set";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t level = location[index];
+  location[index] = removedLocation;
+  --numPoints;
+
+  if (level == bufferLocation)
+  {
+    // Move the last buffered point into the place of the deleted one.
+    const size_t last = bufferIndices.size() - 1;
+    const size_t position = std::find(bufferIndices.begin(),
+        bufferIndices.end(), index) - bufferIndices.begin();
+    if (position != last)
+    {
+      buffer.col(position) = buffer.col(last);
+      bufferIndices[position] = bufferIndices[last];
+    }
+    bufferIndices.pop_back();
+  }
+  else
+  {
+    // The point stays in its tree until the tree is rebuilt.
+    Level& l = *levels[level];
+    ++l.numDeleted;
+    if (2 * l.numDeleted > l.indices.size())
+      CompactLevel(level);
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+Compact()
+{
+  MatType dataset(buffer.n_rows, numPoints);
+  std::vector<size_t> indices;
+  indices.reserve(numPoints);
+
+  for (size_t i = 0; i < bufferIndices.size(); ++i)
+  {
+    dataset.col(indices.size()) = buffer.col(i);
+    indices.push_back(bufferIndices[i]);
+  }
+  bufferIndices.clear();
+
+  for (size_t i = 0; i < levels.size(); ++i)
+  {
+    if (levels[i])
+    {
+      AppendLevel(*levels[i], dataset, indices);
+      delete levels[i]->search;
+      delete levels[i];
+    }
+  }
+  levels.clear();
+
+  if (!indices.empty())
+    BuildLevel(LevelFor(indices.size()), std::move(dataset),
+        std::move(indices));
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  if (k > numPoints)
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << numPoints << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  // The candidate neighbors (distance, index) of each query point, from all
+  // of the trees and the buffer.
+  typedef std::pair<double, size_t> Candidate;
+  std::vector<std::vector<Candidate>> candidates(querySet.n_cols);
+
+  arma::Mat<size_t> levelNeighbors;
+  arma::mat levelDistances;
+  for (size_t l = 0; l < levels.size(); ++l)
+  {
+    if (!levels[l])
+      continue;
+
+    // Deleted points may be among the results, so ask for enough extra
+    // neighbors that at least k (or all) of the points that are left are
+    // returned.
+    const Level& level = *levels[l];
+    const size_t levelK = std::min(k + level.numDeleted, level.indices.size());
+    if (levelK == 0)
+      continue;
+
+    level.search->Search(querySet, levelK, levelNeighbors, levelDistances);
+
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+    {
+      for (size_t j = 0; j < levelK; ++j)
+      {
+        const size_t index = level.indices[levelNeighbors(j, q)];
+        if (location[index] != removedLocation)
+          candidates[q].push_back(Candidate(levelDistances(j, q), index));
+      }
+    }
+  }
+
+  // The buffer is searched by brute force.
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+  {
+    for (size_t i = 0; i < bufferIndices.size(); ++i)
+    {
+      const double distance = metric.Evaluate(querySet.col(q),
+          buffer.col(i));
+      candidates[q].push_back(Candidate(distance, bufferIndices[i]));
+    }
+  }
+
+  // Keep the k best candidates of each query point.
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+  {
+    std::vector<Candidate>& c = candidates[q];
+    std::partial_sort(c.begin(), c.begin() + k, c.end(),
+        [](const Candidate& a, const Candidate& b)
+        {
+          return SortPolicy::IsBetter(a.first, b.first) ||
+              (a.first == b.first && a.second < b.second);
+        });
+
+    for (size_t j = 0; j < k; ++j)
+    {
+      neighbors(j, q) = c[j].second;
+      distances(j, q) = c[j].first;
+    }
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+size_t DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+NumTrees() const
+{
+  size_t count = 0;
+  for (size_t i = 0; i < levels.size(); ++i)
+    if (levels[i])
+      ++count;
+
+  return count;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+BuildLevel(const size_t level,
+           MatType&& dataset,
+           std::vector<size_t>&& indices)
+{
+  if (levels.size() <= level)
+    levels.resize(level + 1, NULL);
+
+  std::vector<size_t> oldFromNew;
+  Tree* tree = BuildTree<Tree>(std::move(dataset), oldFromNew);
+
+  Level* l = new Level;
+  l->numDeleted = 0;
+
+  // The tree may have rearranged the points.
+  if (oldFromNew.empty())
+  {
+    l->indices = std::move(indices);
+  }
+  else
+  {
+    l->indices.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+      l->indices[i] = indices[oldFromNew[i]];
+  }
+
+  l->search = new NSType(std::move(*tree), searchMode, epsilon, metric);
+  delete tree;
+
+  for (size_t i = 0; i < l->indices.size(); ++i)
+    location[l->indices[i]] = level;
+
+  levels[level] = l;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+AppendLevel(const Level& level,
+            MatType& dataset,
+            std::vector<size_t>& indices) const
+{
+  const MatType& levelSet = level.search->ReferenceSet();
+  for (size_t i = 0; i < level.indices.size(); ++i)
+  {
+    if (location[level.indices[i]] != removedLocation)
+    {
+      dataset.col(indices.size()) = levelSet.col(i);
+      indices.push_back(level.indices[i]);
+    }
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+MergeBuffer()
+{
+  // Find the first empty level; everything below it is merged into it.
+  size_t target = 0;
+  while (target < levels.size() && levels[target])
+    ++target;
+
+  size_t count = bufferIndices.size();
+  for (size_t i = 0; i < target; ++i)
+    count += levels[i]->indices.size() - levels[i]->numDeleted;
+
+  MatType dataset(buffer.n_rows, count);
+  std::vector<size_t> indices;
+  indices.reserve(count);
+
+  for (size_t i = 0; i < bufferIndices.size(); ++i)
+  {
+    dataset.col(indices.size()) = buffer.col(i);
+    indices.push_back(bufferIndices[i]);
+  }
+  bufferIndices.clear();
+
+  for (size_t i = 0; i < target; ++i)
+  {
+    AppendLevel(*levels[i], dataset, indices);
+    delete levels[i]->search;
+    delete levels[i];
+    levels[i] = NULL;
+  }
+
+  BuildLevel(target, std::move(dataset), std::move(indices));
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+CompactLevel(const size_t level)
+{
+  Level* l = levels[level];
+  const size_t count = l->indices.size() - l->numDeleted;
+
+  MatType dataset(buffer.n_rows, count);
+  std::vector<size_t> indices;
+  indices.reserve(count);
+  AppendLevel(*l, dataset, indices);
+
+  delete l->search;
+  delete l;
+  levels[level] = NULL;
+
+  if (count > 0)
+    BuildLevel(level, std::move(dataset), std::move(indices));
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::Clear()
+{
+  for (size_t i = 0; i < levels.size(); ++i)
+  {
+    if (levels[i])
+    {
+      delete levels[i]->search;
+      delete levels[i];
+    }
+  }
+
+  levels.clear();
+  bufferIndices.clear();
+  location.clear();
+  numPoints = 0;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+size_t DynamicNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+LevelFor(const size_t count) const
+{
+  size_t level = 0;
+  while ((bufferSize << level) < count)
+    ++level;
+
+  return level;
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
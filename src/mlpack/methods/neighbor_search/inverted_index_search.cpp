@@ -0,0 +1,337 @@
+/**
+ * @file inverted_index_search.cpp
+ *
+ * Implementation of the InvertedIndexSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "inverted_index_search.hpp"
+
+#include <queue>
+
+namespace mlpack {
+namespace neighbor {
+
+namespace {
+
+//! A candidate neighbor (similarity, index).
+typedef std::pair<double, size_t> Candidate;
+
+//! Order candidates from the best to the worst: by decreasing similarity, and
+//! by increasing index for equal similarities.  With this order, the top of a
+//! priority queue is the worst candidate.
+struct CandidateCompare
+{
+  bool operator()(const Candidate& a, const Candidate& b) const
+  {
+    return (a.first > b.first) || (a.first == b.first && a.second < b.second);
+  }
+};
+
+} // namespace
+
+InvertedIndexSearch::InvertedIndexSearch(const bool normalize) :
+    normalize(normalize),
+    numPoints(0),
+    postingOffsets(arma::zeros<arma::Col<size_t>>(1)),
+    scored(0)
+{
+  // Nothing to do.
+}
+
+InvertedIndexSearch::InvertedIndexSearch(const arma::sp_mat& referenceSet,
+                                         const bool normalize) :
+    normalize(normalize),
+    numPoints(0),
+    scored(0)
+{
+  Train(referenceSet);
+}
+
+void InvertedIndexSearch::Train(const arma::sp_mat& referenceSet)
+{
+  // Point indices are stored in 32 bits.
+  if (referenceSet.n_cols > UINT32_MAX)
+    throw std::invalid_argument("InvertedIndexSearch::Train(): too many "
+        "reference points!");
+  if (referenceSet.n_rows == 0)
+    throw std::invalid_argument("InvertedIndexSearch::Train(): the reference "
+        "set must have at least one dimension!");
+
+  numPoints = referenceSet.n_cols;
+  const size_t dimensionality = referenceSet.n_rows;
+
+  arma::vec norms(numPoints, arma::fill::zeros);
+  postingOffsets.zeros(dimensionality + 1);
+  for (arma::sp_mat::const_iterator it = referenceSet.begin();
+       it != referenceSet.end(); ++it)
+  {
+    norms[it.col()] += (*it) * (*it);
+    ++postingOffsets[it.row() + 1];
+  }
+  norms = arma::sqrt(norms);
+  for (size_t d = 0; d < dimensionality; ++d)
+    postingOffsets[d + 1] += postingOffsets[d];
+
+  // The iteration goes through the points in order, so each posting list is
+  // sorted by point.
+  arma::Col<size_t> fill = postingOffsets.subvec(0, dimensionality - 1);
+  postingPoints.set_size(postingOffsets[dimensionality]);
+  postingValues.set_size(postingOffsets[dimensionality]);
+  maxValues.set_size(dimensionality);
+  maxValues.fill(-DBL_MAX);
+  minValues.set_size(dimensionality);
+  minValues.fill(DBL_MAX);
+  for (arma::sp_mat::const_iterator it = referenceSet.begin();
+       it != referenceSet.end(); ++it)
+  {
+    const size_t d = it.row();
+    const double value = (normalize && norms[it.col()] > 0) ?
+        (*it) / norms[it.col()] : (*it);
+
+    postingPoints[fill[d]] = (arma::u32) it.col();
+    postingValues[fill[d]] = value;
+    ++fill[d];
+    maxValues[d] = std::max(maxValues[d], value);
+    minValues[d] = std::min(minValues[d], value);
+  }
+
+  Log::Info << "Built inverted index of " << numPoints << " points with "
+      << postingValues.n_elem << " postings in " << dimensionality
+      << " dimensions." << std::endl;
+}
+
+size_t InvertedIndexSearch::SearchPoint(const arma::sp_mat& querySet,
+                                        const size_t queryIndex,
+                                        const size_t skip,
+                                        const size_t k,
+                                        arma::Mat<size_t>& neighbors,
+                                        arma::mat& similarities) const
+{
+  if (k == 0)
+    return 0;
+
+  // Gather the weight of each non-zero dimension of the query.
+  std::vector<size_t> dims;
+  std::vector<double> weights;
+  double norm = 0.0;
+  for (arma::sp_mat::const_col_iterator it = querySet.begin_col(queryIndex);
+       it != querySet.end_col(queryIndex); ++it)
+  {
+    norm += (*it) * (*it);
+    if (postingOffsets[it.row() + 1] > postingOffsets[it.row()])
+    {
+      dims.push_back(it.row());
+      weights.push_back(*it);
+    }
+  }
+  if (normalize && norm > 0)
+    for (size_t i = 0; i < weights.size(); ++i)
+      weights[i] /= std::sqrt(norm);
+
+  // Sort the terms by increasing bound on their contribution to a score.  A
+  // point that is not in a posting list gets a contribution of 0 from it.
+  const size_t numTerms = dims.size();
+  std::vector<std::pair<double, size_t>> terms(numTerms);
+  for (size_t i = 0; i < numTerms; ++i)
+  {
+    const double bound = std::max(0.0, std::max(weights[i] *
+        maxValues[dims[i]], weights[i] * minValues[dims[i]]));
+    terms[i] = std::make_pair(bound, i);
+  }
+  std::sort(terms.begin(), terms.end());
+
+  // prefixBounds[i] bounds the total contribution of the first i terms.
+  std::vector<double> prefixBounds(numTerms + 1, 0.0);
+  std::vector<double> termWeights(numTerms);
+  std::vector<size_t> cursors(numTerms), ends(numTerms);
+  for (size_t i = 0; i < numTerms; ++i)
+  {
+    const size_t term = terms[i].second;
+    prefixBounds[i + 1] = prefixBounds[i] + terms[i].first;
+    termWeights[i] = weights[term];
+    cursors[i] = postingOffsets[dims[term]];
+    ends[i] = postingOffsets[dims[term] + 1];
+  }
+
+  std::priority_queue<Candidate, std::vector<Candidate>, CandidateCompare>
+      pqueue;
+  const arma::u32* points = postingPoints.memptr();
+  size_t pointsScored = 0;
+
+  // The terms [0, firstEssential) are non-essential: a point that is only in
+  // their lists cannot do better than the k'th best candidate.
+  size_t firstEssential = 0;
+  while (true)
+  {
+    const double threshold = (pqueue.size() < k) ? -DBL_MAX :
+        pqueue.top().first;
+    while (firstEssential < numTerms &&
+           prefixBounds[firstEssential + 1] < threshold)
+      ++firstEssential;
+    if (firstEssential == numTerms)
+      break;
+
+    // The next point to score is the smallest one in the essential lists.
+    size_t point = numPoints;
+    for (size_t i = firstEssential; i < numTerms; ++i)
+      if (cursors[i] < ends[i] && points[cursors[i]] < point)
+        point = points[cursors[i]];
+    if (point == numPoints)
+      break;
+
+    double score = 0.0;
+    for (size_t i = firstEssential; i < numTerms; ++i)
+    {
+      if (cursors[i] < ends[i] && points[cursors[i]] == point)
+      {
+        score += termWeights[i] * postingValues[cursors[i]];
+        ++cursors[i];
+      }
+    }
+
+    if (point == skip)
+      continue;
+
+    // Add the non-essential contributions, the largest bounds first, and stop
+    // as soon as the point cannot beat the k'th best candidate.
+    bool pruned = false;
+    for (size_t i = firstEssential; i-- > 0; )
+    {
+      if (score + prefixBounds[i + 1] < threshold)
+      {
+        pruned = true;
+        break;
+      }
+
+      cursors[i] = std::lower_bound(points + cursors[i], points + ends[i],
+          (arma::u32) point) - points;
+      if (cursors[i] < ends[i] && points[cursors[i]] == point)
+        score += termWeights[i] * postingValues[cursors[i]];
+    }
+    if (pruned)
+      continue;
+
+    ++pointsScored;
+    const Candidate candidate = std::make_pair(score, point);
+    if (pqueue.size() < k)
+    {
+      pqueue.push(candidate);
+    }
+    else if (CandidateCompare()(candidate, pqueue.top()))
+    {
+      pqueue.pop();
+      pqueue.push(candidate);
+    }
+  }
+
+  for (size_t j = pqueue.size(); j < k; ++j)
+  {
+    neighbors(j, queryIndex) = numPoints;
+    similarities(j, queryIndex) = -DBL_MAX;
+  }
+  for (size_t j = pqueue.size(); j > 0; --j)
+  {
+    neighbors(j - 1, queryIndex) = pqueue.top().second;
+    similarities(j - 1, queryIndex) = pqueue.top().first;
+    pqueue.pop();
+  }
+
+  return pointsScored;
+}
+
+void InvertedIndexSearch::SearchAll(const arma::sp_mat& querySet,
+                                    const size_t k,
+                                    arma::Mat<size_t>& neighbors,
+                                    arma::mat& similarities,
+                                    const bool monochromatic) const
+{
+  neighbors.set_size(k, querySet.n_cols);
+  similarities.set_size(k, querySet.n_cols);
+
+  size_t totalScored = 0;
+  // Parallelization to process more than one query at a time.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for \
+      shared(neighbors, similarities) \
+      reduction(+:totalScored) \
+      schedule(dynamic)
+  for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+  #pragma omp parallel for \
+      shared(neighbors, similarities) \
+      reduction(+:totalScored) \
+      schedule(dynamic)
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
+  {
+    totalScored += SearchPoint(querySet, q, monochromatic ? q : numPoints, k,
+        neighbors, similarities);
+  }
+
+  scored = totalScored;
+}
+
+void InvertedIndexSearch::Search(const arma::sp_mat& querySet,
+                                 const size_t k,
+                                 arma::Mat<size_t>& neighbors,
+                                 arma::mat& similarities) const
+{
+  if (querySet.n_rows != Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "InvertedIndexSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality the index "
+        << "was built on (" << Dimensionality() << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (k > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "InvertedIndexSearch::Search(): requested " << k << " nearest "
+        << "neighbors, but the reference set has " << numPoints << " points!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  SearchAll(querySet, k, neighbors, similarities, false);
+}
+
+void InvertedIndexSearch::Search(const size_t k,
+                                 arma::Mat<size_t>& neighbors,
+                                 arma::mat& similarities) const
+{
+  if (k >= numPoints)
+  {
+    std::ostringstream oss;
+    oss << "InvertedIndexSearch::Search(): requested " << k << " nearest "
+        << "neighbors, but the reference set has only " << numPoints - 1
+        << " other points!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Rebuild the (normalized) reference set from the posting lists; the
+  // similarities are the same as with the original points.
+  arma::umat locations(2, postingValues.n_elem);
+  for (size_t d = 0; d < Dimensionality(); ++d)
+  {
+    for (size_t j = postingOffsets[d]; j < postingOffsets[d + 1]; ++j)
+    {
+      locations(0, j) = d;
+      locations(1, j) = postingPoints[j];
+    }
+  }
+  const arma::sp_mat referenceSet(locations, postingValues, Dimensionality(),
+      numPoints);
+
+  SearchAll(referenceSet, k, neighbors, similarities, true);
+}
+
+} // namespace neighbor
+} // namespace mlpack
@@ -0,0 +1,207 @@
+/**
+ * @file inverted_index_search.hpp
+ *
+ * Defines the InvertedIndexSearch class, which finds the neighbors with the
+ * largest cosine similarity or inner product of sparse, high-dimensional
+ * points (such as TF-IDF vectors) with an inverted index and MaxScore pruning.
+ *
+ * The pruning strategy is described in the following paper:
+ *
+ * @article{turtle1995query,
+ *   title={Query evaluation: strategies and optimizations},
+ *   author={Turtle, H. and Flood, J.},
+ *   journal={Information Processing \& Management},
+ *   volume={31},
+ *   number={6},
+ *   pages={831--850},
+ *   year={1995}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_INVERTED_INDEX_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_INVERTED_INDEX_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The InvertedIndexSearch class performs exact k-nearest-neighbor search on
+ * sparse reference points, where the nearest neighbors are the points with the
+ * largest inner product with the query point, or the largest cosine similarity
+ * if the points are normalized.  The trees of NeighborSearch do not work well
+ * on sparse data with very many dimensions; here, the work of a query is only
+ * proportional to the lengths of the posting lists of its non-zero dimensions.
+ *
+ * The index holds one posting list for each dimension: the points with a
+ * non-zero value in that dimension, sorted by index, with their values.  A
+ * query is evaluated one reference point at a time over the posting lists of
+ * its non-zero dimensions (document-at-a-time), with MaxScore pruning: the
+ * largest contribution of each dimension to a score is known from its largest
+ * and smallest values, so the dimensions whose bounds sum to no more than the
+ * k'th best score so far are non-essential.  Only the points in the lists of
+ * the essential dimensions are scored, and the scoring of a point stops as
+ * soon as its bound falls to the k'th best score.
+ *
+ * Only the points that share at least one non-zero dimension with a query are
+ * candidates; if there are fewer than k of them, the remaining neighbors are
+ * set to NumPoints() and their similarities to -DBL_MAX.
+ *
+ * @code
+ * InvertedIndexSearch search(referenceSet); // arma::sp_mat, one point per
+ *                                           // column.
+ * search.Search(querySet, 10, neighbors, similarities);
+ * @endcode
+ */
+class InvertedIndexSearch
+{
+ public:
+  /**
+   * Create the InvertedIndexSearch object without building an index.  Be sure
+   * to call Train() before calling Search().
+   *
+   * @param normalize If true, search by cosine similarity; otherwise, by inner
+   *     product.
+   */
+  InvertedIndexSearch(const bool normalize = true);
+
+  /**
+   * Create the InvertedIndexSearch object and build the index on the given
+   * reference set.  The reference set is not kept.
+   *
+   * @param referenceSet Set of reference points.
+   * @param normalize If true, search by cosine similarity; otherwise, by inner
+   *     product.
+   */
+  InvertedIndexSearch(const arma::sp_mat& referenceSet,
+                      const bool normalize = true);
+
+  /**
+   * Build the index on the given reference set, replacing any previous index.
+   * A std::invalid_argument is thrown if there are too many points.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(const arma::sp_mat& referenceSet);
+
+  /**
+   * For each point in the query set, compute the k reference points with the
+   * largest similarity to it, and store their indices and similarities in the
+   * given matrices, which will have k rows and one column for each query
+   * point, sorted from the best to the worst.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param similarities Matrix storing similarities of neighbors for each
+   *     query point.
+   */
+  void Search(const arma::sp_mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& similarities) const;
+
+  /**
+   * For each point the index was built on, compute the k other points with the
+   * largest similarity to it, as above.  The point itself is not a neighbor.
+   *
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each point.
+   * @param similarities Matrix storing similarities of neighbors for each
+   *     point.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& similarities) const;
+
+  //! Serialize the index.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+  //! Get whether the points are normalized (cosine similarity).
+  bool Normalize() const { return normalize; }
+  //! Modify whether the points are normalized (used by Train()).
+  bool& Normalize() { return normalize; }
+
+  //! Get the number of indexed points.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the dimensionality of the indexed points.
+  size_t Dimensionality() const { return postingOffsets.n_elem - 1; }
+
+  //! Get the start of the posting list of each dimension, followed by the
+  //! number of postings.
+  const arma::Col<size_t>& PostingOffsets() const { return postingOffsets; }
+  //! Get the point of each posting.
+  const arma::Col<arma::u32>& PostingPoints() const { return postingPoints; }
+  //! Get the (normalized, if requested) value of each posting.
+  const arma::vec& PostingValues() const { return postingValues; }
+
+  //! Get the number of points scored by the last search, summed over the
+  //! query points; the rest were pruned.
+  size_t Scored() const { return scored; }
+
+ private:
+  //! Whether the points are normalized.
+  bool normalize;
+  //! The number of indexed points.
+  size_t numPoints;
+
+  //! The start of the posting list of each dimension, followed by the number
+  //! of postings.
+  arma::Col<size_t> postingOffsets;
+  //! The point of each posting.
+  arma::Col<arma::u32> postingPoints;
+  //! The value of each posting.
+  arma::vec postingValues;
+  //! The largest value of each dimension.
+  arma::vec maxValues;
+  //! The smallest value of each dimension.
+  arma::vec minValues;
+
+  //! The number of points scored by the last search.
+  mutable size_t scored;
+
+  /**
+   * Search the neighbors of one query point, skipping the reference point with
+   * the given index (NumPoints() to skip none), and store them in the given
+   * column of the results.  Return the number of points scored.
+   */
+  size_t SearchPoint(const arma::sp_mat& querySet,
+                     const size_t queryIndex,
+                     const size_t skip,
+                     const size_t k,
+                     arma::Mat<size_t>& neighbors,
+                     arma::mat& similarities) const;
+
+  //! Search for each query point, skipping its own index if monochromatic.
+  void SearchAll(const arma::sp_mat& querySet,
+                 const size_t k,
+                 arma::Mat<size_t>& neighbors,
+                 arma::mat& similarities,
+                 const bool monochromatic) const;
+};
+
+template<typename Archive>
+void InvertedIndexSearch::Serialize(Archive& ar,
+                                    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(normalize, "normalize");
+  ar & CreateNVP(numPoints, "numPoints");
+  ar & CreateNVP(postingOffsets, "postingOffsets");
+  ar & CreateNVP(postingPoints, "postingPoints");
+  ar & CreateNVP(postingValues, "postingValues");
+  ar & CreateNVP(maxValues, "maxValues");
+  ar & CreateNVP(minValues, "minValues");
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -74,7 +74,8 @@ PARAM_INT_IN("k", "Number of furthest neighbors to find.", "k", 0);
 // building.
 PARAM_STRING_IN("tree_type", "Type of tree to use: 'kd', 'vp', 'rp', 'max-rp', "
     "'ub', 'cover', 'r', 'r-star', 'x', 'ball', 'hilbert-r', 'r-plus', "
-    "'r-plus-plus', 'oct'.", "t", "kd");
+    "'r-plus-plus', 'oct', or 'auto' to choose the tree type and leaf size by "
+    "timing each candidate on a sample of the reference set.", "t", "kd");
 PARAM_INT_IN("leaf_size", "Leaf size for tree building (used for kd-trees, "
     "vp trees, random projection trees, UB trees, R trees, R* trees, X trees, "
     "Hilbert R trees, R+ trees, R++ trees, and octrees).", "l", 20);
@@ -266,11 +267,11 @@ int main(int argc, char *argv[])
       tree = KFNModel::UB_TREE;
     else if (treeType == "oct")
       tree = KFNModel::OCTREE;
-    else
+    else if (treeType != "auto")
       Log::Fatal << "Unknown tree type '" << treeType << "'; valid choices are "
           << "'kd', 'vp', 'rp', 'max-rp', 'ub', 'cover', 'r', 'r-star', 'x', "
-          << "'ball', 'hilbert-r', 'r-plus', 'r-plus-plus', and 'oct'."
-          << endl;
+          << "'ball', 'hilbert-r', 'r-plus', 'r-plus-plus', 'oct', and "
+          << "'auto'." << endl;
 
     kfn.TreeType() = tree;
     kfn.RandomBasis() = randomBasis;
@@ -281,7 +282,21 @@ int main(int argc, char *argv[])
         << CLI::GetUnmappedParam<arma::mat>("reference") << "' ("
         << referenceSet.n_rows << "x" << referenceSet.n_cols << ")." << endl;
 
-    kfn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode, epsilon);
+    // The selected tree type and leaf size are stored in the model.
+    size_t leafSize = size_t(lsInt);
+    if (treeType == "auto")
+    {
+      if (CLI::HasParam("leaf_size"))
+        Log::Warn << "--leaf_size (-l) will be ignored because --tree_type is "
+            << "'auto'." << endl;
+
+      const size_t k = std::max(CLI::GetParam<int>("k"), 1);
+      kfn.SelectTree(referenceSet, std::min(k, (size_t) referenceSet.n_cols),
+          searchMode, epsilon);
+      leafSize = kfn.LeafSize();
+    }
+
+    kfn.BuildModel(std::move(referenceSet), leafSize, searchMode, epsilon);
   }
   else
   {
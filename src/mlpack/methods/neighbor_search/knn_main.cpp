@@ -12,14 +12,17 @@
  */
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/server.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include "neighbor_search.hpp"
+#include "inverted_index_search.hpp"
 #include "unmap.hpp"
 #include "ns_model.hpp"
 
@@ -51,7 +54,34 @@ PROGRAM_INFO("k-Nearest-Neighbors",
     "neighbors output file corresponds to the index of the point in the "
     "reference set which is the i'th nearest neighbor from the point in the "
     "query set with index j.  Row i and column j in the distances output file "
-    "corresponds to the distance between those two points.");
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "With --server, the program loads or builds the model once and then "
+    "answers requests read from standard input, one per line, until the "
+    "input ends or a line 'quit' is read.  A request holds the options "
+    "--query_file, --k, --neighbors_file and --distances_file (or their "
+    "aliases); --k defaults to the value given on the command line.  For each "
+    "request, a line 'ok' or 'error: <message>' is written to standard "
+    "output.  For example:"
+    "\n\n"
+    "$ mkfifo requests\n"
+    "$ mlpack_knn --input_model_file=model.xml --server < requests &\n"
+    "$ echo \"-q q1.csv -k 5 -n n1.csv\" > requests"
+    "\n\n"
+    "Since --verbose output also goes to standard output, it should not be "
+    "used with --server."
+    "\n\n"
+    "With --sparse_similarity, the reference and query sets are sparse, and "
+    "each is given as a list of its non-zero values, with one row "
+    "'dimension, point, value' for each; dimensions and points are indexed "
+    "from 0.  The neighbors are then the points with the largest 'cosine' "
+    "similarity or 'inner_product', found with an inverted index (one posting "
+    "list per dimension) and MaxScore pruning, and the output distances are "
+    "1 - similarity for 'cosine' and the negated inner product for "
+    "'inner_product'.  For example:"
+    "\n\n"
+    "$ mlpack_knn --k=10 --reference_file=tfidf.csv "
+    "--sparse_similarity=cosine\n --neighbors_file=neighbors.csv");
 
 // Define our input parameters that this program will take.
 PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
@@ -77,7 +107,9 @@ PARAM_INT_IN("k", "Number of nearest neighbors to find.", "k", 0);
 // building.
 PARAM_STRING_IN("tree_type", "Type of tree to use: 'kd', 'vp', 'rp', 'max-rp', "
     "'ub', 'cover', 'r', 'r-star', 'x', 'ball', 'hilbert-r', 'r-plus', "
-    "'r-plus-plus', 'spill', 'oct'.", "t", "kd");
+    "'r-plus-plus', 'spill', 'oct', or 'auto' to choose the tree type and leaf "
+    "size by timing each candidate on a sample of the reference set.", "t",
+    "kd");
 PARAM_INT_IN("leaf_size", "Leaf size for tree building (used for kd-trees, vp "
     "trees, random projection trees, UB trees, R trees, R* trees, X trees, "
     "Hilbert R trees, R+ trees, R++ trees, spill trees, and octrees).", "l",
@@ -89,11 +121,15 @@ PARAM_DOUBLE_IN("rho", "Balance threshold (only valid for spill trees).", "b",
 
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_MATRIX_IN("transformation", "Linear transformation (with one column per "
+    "dimension of the points) applied to the reference and query points before "
+    "anything else; the search then uses the distance || L x - L y ||, like "
+    "the one learned by mlpack_nca.", "");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
 PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', 'single_tree', "
-    "'dual_tree', 'greedy'.", "a", "dual_tree");
+    "'dual_tree', 'greedy', 'best_first'.", "a", "dual_tree");
 PARAM_FLAG("naive", "(Deprecated) If true, O(n^2) naive mode is used for "
     "computation. Will be removed in mlpack 3.0.0. Use '--algorithm naive' "
     "instead.", "N");
@@ -102,6 +138,129 @@ PARAM_FLAG("single_mode", "(Deprecated) If true, single-tree search is used "
     "'--algorithm single_tree' instead.", "S");
 PARAM_DOUBLE_IN("epsilon", "If specified, will do approximate nearest neighbor "
     "search with given relative error.", "e", 0);
+PARAM_INT_IN("max_leaves", "Maximum number of leaves visited for each query "
+    "point with '--algorithm best_first' (0 for no limit).", "", 0);
+PARAM_DOUBLE_IN("time_limit", "Maximum time in seconds spent on each query "
+    "point with '--algorithm best_first' (0 for no limit).", "", 0);
+PARAM_FLAG("reorder_queries", "If true, the query points of single-tree "
+    "searches are traversed along the Hilbert curve instead of in the order "
+    "of the query set, which keeps the tree in cache when consecutive query "
+    "points are unrelated.", "");
+
+PARAM_FLAG("server", "If true, answer search requests read from standard "
+    "input with the model, instead of searching once.", "");
+
+PARAM_STRING_IN("sparse_similarity", "If given, the reference and query sets "
+    "are sparse coordinate lists, searched with an inverted index by 'cosine' "
+    "similarity or 'inner_product'.", "", "");
+
+// Check a coordinate list, and return its largest dimension.
+double CheckCoordinates(const arma::mat& coordinates)
+{
+  if (coordinates.n_rows != 3 || coordinates.n_cols == 0)
+    Log::Fatal << "Sparse coordinate lists must have three values (dimension, "
+        << "point, value) on each row, and at least one row!" << endl;
+  if (coordinates.rows(0, 1).min() < 0)
+    Log::Fatal << "Dimensions and points of sparse coordinate lists must be "
+        << "non-negative!" << endl;
+
+  return coordinates.row(0).max();
+}
+
+// Convert a coordinate list, with one column (dimension, point, value) for each
+// non-zero value, to a sparse matrix.
+arma::sp_mat CoordinatesToSparse(const arma::mat& coordinates,
+                                 const size_t dimensionality,
+                                 const string& name)
+{
+  const arma::umat locations = arma::conv_to<arma::umat>::from(
+      coordinates.rows(0, 1));
+  const size_t numPoints = arma::max(locations.row(1)) + 1;
+  Log::Info << "Loaded sparse " << name << " set of " << numPoints
+      << " points with " << coordinates.n_cols << " non-zero values." << endl;
+
+  return arma::sp_mat(true, locations, coordinates.row(2).t(), dimensionality,
+      numPoints);
+}
+
+// Search sparse data with an inverted index.
+void SparseSearch()
+{
+  const string similarity = CLI::GetParam<string>("sparse_similarity");
+  if (similarity != "cosine" && similarity != "inner_product")
+    Log::Fatal << "Unknown sparse similarity '" << similarity << "'; valid "
+        << "choices are 'cosine' and 'inner_product'." << endl;
+
+  if (CLI::HasParam("input_model") || CLI::HasParam("output_model") ||
+      CLI::HasParam("server"))
+    Log::Fatal << "--sparse_similarity cannot be used with --input_model_file,"
+        << " --output_model_file or --server." << endl;
+  if (!CLI::HasParam("k"))
+    Log::Fatal << "--k must be specified with --sparse_similarity." << endl;
+
+  arma::mat referenceCoordinates =
+      std::move(CLI::GetParam<arma::mat>("reference"));
+  arma::mat queryCoordinates;
+  if (CLI::HasParam("query"))
+    queryCoordinates = std::move(CLI::GetParam<arma::mat>("query"));
+
+  // Both sets have the dimensionality of the largest dimension of either.
+  double maxDimension = CheckCoordinates(referenceCoordinates);
+  if (CLI::HasParam("query"))
+    maxDimension = std::max(maxDimension, CheckCoordinates(queryCoordinates));
+
+  const size_t dimensionality = (size_t) maxDimension + 1;
+  const arma::sp_mat referenceSet = CoordinatesToSparse(referenceCoordinates,
+      dimensionality, "reference");
+
+  Timer::Start("building_index");
+  InvertedIndexSearch search(referenceSet, similarity == "cosine");
+  Timer::Stop("building_index");
+
+  const size_t k = (size_t) CLI::GetParam<int>("k");
+  const size_t maxK = CLI::HasParam("query") ? search.NumPoints() :
+      search.NumPoints() - 1;
+  if (k == 0 || k > maxK)
+    Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
+        << "than or equal to the number of reference points (" << maxK << ")."
+        << endl;
+
+  arma::Mat<size_t> neighbors;
+  arma::mat similarities;
+  Timer::Start("computing_neighbors");
+  if (CLI::HasParam("query"))
+  {
+    search.Search(CoordinatesToSparse(queryCoordinates, dimensionality,
+        "query"), k, neighbors, similarities);
+  }
+  else
+  {
+    search.Search(k, neighbors, similarities);
+  }
+  Timer::Stop("computing_neighbors");
+  Log::Info << "Search complete; " << search.Scored() << " points were "
+      << "scored." << endl;
+
+  if (CLI::HasParam("true_neighbors"))
+  {
+    const arma::Mat<size_t>& trueNeighbors =
+        CLI::GetParam<arma::Mat<size_t>>("true_neighbors");
+    if (trueNeighbors.n_rows != neighbors.n_rows ||
+        trueNeighbors.n_cols != neighbors.n_cols)
+      Log::Fatal << "The true neighbors file must have the same number of "
+          << "values than the set of neighbors being queried!" << endl;
+
+    Log::Info << "Recall: " << KNN::Recall(neighbors, trueNeighbors) << endl;
+  }
+
+  if (CLI::HasParam("neighbors"))
+    CLI::GetParam<arma::Mat<size_t>>("neighbors") = std::move(neighbors);
+  if (CLI::HasParam("distances"))
+  {
+    CLI::GetParam<arma::mat>("distances") = (similarity == "cosine") ?
+        arma::mat(1.0 - similarities) : arma::mat(-similarities);
+  }
+}
 
 int main(int argc, char *argv[])
 {
@@ -123,6 +282,14 @@ int main(int argc, char *argv[])
     Log::Fatal << "No model specified (--input_model_file) and no reference "
         << "data specified (--reference_file)!  One must be provided." << endl;
 
+  // Sparse data is searched with an inverted index instead of a model.
+  if (CLI::HasParam("sparse_similarity"))
+  {
+    SparseSearch();
+    CLI::Destroy();
+    return 0;
+  }
+
   if (CLI::HasParam("input_model"))
   {
     // Notify the user of parameters that will be ignored.
@@ -132,6 +299,9 @@ int main(int argc, char *argv[])
     if (CLI::HasParam("random_basis"))
       Log::Warn << "--random_basis (-R) will be ignored because "
           << "--input_model_file is specified." << endl;
+    if (CLI::HasParam("transformation"))
+      Log::Warn << "--transformation_file will be ignored because "
+          << "--input_model_file is specified." << endl;
     if (CLI::HasParam("tau"))
       Log::Warn << "--tau (-u) will be ignored because --input_model_file is "
           "specified." << endl;
@@ -146,12 +316,13 @@ int main(int argc, char *argv[])
   }
 
   // The user should give something to do...
-  if (!CLI::HasParam("k") && !CLI::HasParam("output_model"))
+  if (!CLI::HasParam("k") && !CLI::HasParam("output_model") &&
+      !CLI::HasParam("server"))
     Log::Warn << "Neither -k nor --output_model_file are specified, so no "
         << "results from this program will be saved!" << endl;
 
   // If the user specifies k but no output files, they should be warned.
-  if (CLI::HasParam("k") &&
+  if (CLI::HasParam("k") && !CLI::HasParam("server") &&
       !(CLI::HasParam("neighbors") || CLI::HasParam("distances")))
     Log::Warn << "Neither --neighbors_file nor --distances_file is specified, "
         << "so the nearest neighbor search results will not be saved!" << endl;
@@ -213,10 +384,26 @@ int main(int argc, char *argv[])
     searchMode = DUAL_TREE_MODE;
   else if (algorithm == "greedy")
     searchMode = GREEDY_SINGLE_TREE_MODE;
+  else if (algorithm == "best_first")
+    searchMode = BEST_FIRST_SINGLE_TREE_MODE;
   else
     Log::Fatal << "Unknown neighbor search algorithm '" << algorithm << "'; "
-        << "valid choices are 'naive', 'single_tree', 'dual_tree' and 'greedy'."
-        << endl;
+        << "valid choices are 'naive', 'single_tree', 'dual_tree', 'greedy' "
+        << "and 'best_first'." << endl;
+
+  // Sanity check on the budget of best-first search.
+  const int maxLeaves = CLI::GetParam<int>("max_leaves");
+  if (maxLeaves < 0)
+    Log::Fatal << "Invalid max_leaves: " << maxLeaves << ".  Must be "
+        << "non-negative." << endl;
+  const double timeLimit = CLI::GetParam<double>("time_limit");
+  if (timeLimit < 0)
+    Log::Fatal << "Invalid time_limit: " << timeLimit << ".  Must be "
+        << "non-negative." << endl;
+  if ((CLI::HasParam("max_leaves") || CLI::HasParam("time_limit")) &&
+      algorithm != "best_first")
+    Log::Fatal << "--max_leaves and --time_limit are only valid for "
+        << "'--algorithm best_first'." << endl;
 
   if (CLI::HasParam("single_mode"))
   {
@@ -282,14 +469,17 @@ int main(int argc, char *argv[])
       tree = KNNModel::UB_TREE;
     else if (treeType == "oct")
       tree = KNNModel::OCTREE;
-    else
+    else if (treeType != "auto")
       Log::Fatal << "Unknown tree type '" << treeType << "'; valid choices are "
           << "'kd', 'vp', 'rp', 'max-rp', 'ub', 'cover', 'r', 'r-star', 'x', "
-          << "'ball', 'hilbert-r', 'r-plus', 'r-plus-plus', 'spill', and "
-          << "'oct'." << endl;
+          << "'ball', 'hilbert-r', 'r-plus', 'r-plus-plus', 'spill', 'oct', "
+          << "and 'auto'." << endl;
 
     knn.TreeType() = tree;
     knn.RandomBasis() = randomBasis;
+    if (CLI::HasParam("transformation"))
+      knn.Transformation() = std::move(
+          CLI::GetParam<arma::mat>("transformation"));
     knn.LeafSize() = size_t(lsInt);
     knn.Tau() = tau;
     knn.Rho() = rho;
@@ -301,7 +491,21 @@ int main(int argc, char *argv[])
         << referenceSet.n_rows << " x " << referenceSet.n_cols << ")."
         << endl;
 
-    knn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode, epsilon);
+    // The selected tree type and leaf size are stored in the model.
+    size_t leafSize = size_t(lsInt);
+    if (treeType == "auto")
+    {
+      if (CLI::HasParam("leaf_size"))
+        Log::Warn << "--leaf_size (-l) will be ignored because --tree_type is "
+            << "'auto'." << endl;
+
+      const size_t k = std::max(CLI::GetParam<int>("k"), 1);
+      knn.SelectTree(referenceSet, std::min(k, (size_t) referenceSet.n_cols),
+          searchMode, epsilon);
+      leafSize = knn.LeafSize();
+    }
+
+    knn.BuildModel(std::move(referenceSet), leafSize, searchMode, epsilon);
   }
   else
   {
@@ -324,8 +528,56 @@ int main(int argc, char *argv[])
         << endl;
   }
 
+  knn.MaxLeaves() = size_t(maxLeaves);
+  knn.TimeLimit() = timeLimit;
+  knn.ReorderQueries() = CLI::HasParam("reorder_queries");
+
+  // In server mode, answer requests until the input ends.
+  if (CLI::HasParam("server"))
+  {
+    const vector<string> options = { "query", "k", "neighbors", "distances" };
+    const size_t failures = util::ServeRequests(cin, cout, options,
+        [&knn](const util::ServerRequest& request)
+    {
+      const int k = request.GetParam<int>("k");
+      if (k <= 0 || (size_t) k > knn.Dataset().n_cols)
+      {
+        ostringstream oss;
+        oss << "invalid k: " << k << "; must be greater than 0 and less than "
+            << "or equal to the number of reference points ("
+            << knn.Dataset().n_cols << ")";
+        throw invalid_argument(oss.str());
+      }
+
+      const string queryFile = request.GetParam<string>("query");
+      arma::mat queryData;
+      if (!data::Load(queryFile, queryData, false))
+        throw runtime_error("cannot load query data from '" + queryFile +
+            "'");
+
+      arma::Mat<size_t> neighbors;
+      arma::mat distances;
+      knn.Search(std::move(queryData), (size_t) k, neighbors, distances);
+
+      if (request.HasParam("neighbors"))
+      {
+        const string file = request.GetParam<string>("neighbors");
+        if (!data::Save(file, neighbors, false))
+          throw runtime_error("cannot save neighbors to '" + file + "'");
+      }
+      if (request.HasParam("distances"))
+      {
+        const string file = request.GetParam<string>("distances");
+        if (!data::Save(file, distances, false))
+          throw runtime_error("cannot save distances to '" + file + "'");
+      }
+    });
+
+    Log::Info << "Server stopped; " << failures << " request(s) failed."
+        << endl;
+  }
   // Perform search, if desired.
-  if (CLI::HasParam("k"))
+  else if (CLI::HasParam("k"))
   {
     const size_t k = (size_t) CLI::GetParam<int>("k");
 
@@ -20,6 +20,8 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/binary_space_tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/shared_tree.hpp>
+#include <mlpack/core/tree/hilbert_order.hpp>
 
 #include "neighbor_search_stat.hpp"
 #include "sort_policies/nearest_neighbor_sort.hpp"
@@ -31,7 +33,7 @@ namespace mlpack {
 namespace neighbor  {
 
 // Forward declaration.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 class TrainVisitor;
 
 //! NeighborSearchMode represents the different neighbor search modes available.
@@ -40,7 +42,8 @@ enum NeighborSearchMode
   NAIVE_MODE,
   SINGLE_TREE_MODE,
   DUAL_TREE_MODE,
-  GREEDY_SINGLE_TREE_MODE
+  GREEDY_SINGLE_TREE_MODE,
+  BEST_FIRST_SINGLE_TREE_MODE
 };
 
 /**
@@ -57,6 +60,11 @@ enum NeighborSearchMode
  * can be found in the NearestNeighborSort class and the kernel::ExampleKernel
  * class.
  *
+ * In BEST_FIRST_SINGLE_TREE_MODE, the reference nodes are visited in order of
+ * their distance to each query point, and the search of each query point can
+ * be limited with MaxLeaves() and TimeLimit(); the neighbors found within that
+ * budget are returned.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  * @tparam MetricType The metric to use for computation.
  * @tparam MatType The type of data matrix.
@@ -86,6 +94,42 @@ class NeighborSearch
   //! Convenience typedef.
   typedef TreeType<MetricType, NeighborSearchStat<SortPolicy>, MatType> Tree;
 
+  /**
+   * Storage that is kept between calls to the Search() overload that takes a
+   * SearchContext, so that repeated searches with small query sets do not
+   * allocate new candidate lists and do not build query trees.  A
+   * SearchContext should only be used by one thread at a time.
+   */
+  class SearchContext
+  {
+   public:
+    /**
+     * Create the context.  In dual-tree mode, query sets with at most
+     * maxSingleTreeBatch points are searched with single-tree search, because
+     * for so few points building a query tree costs more than it saves.
+     *
+     * @param maxSingleTreeBatch Largest query set for which dual-tree search
+     *     is replaced by single-tree search.
+     */
+    SearchContext(const size_t maxSingleTreeBatch = 64) :
+        maxSingleTreeBatch(maxSingleTreeBatch) { }
+
+    //! Get the largest query set for which single-tree search is used.
+    size_t MaxSingleTreeBatch() const { return maxSingleTreeBatch; }
+    //! Modify the largest query set for which single-tree search is used.
+    size_t& MaxSingleTreeBatch() { return maxSingleTreeBatch; }
+
+   private:
+    //! The largest query set for which single-tree search is used.
+    size_t maxSingleTreeBatch;
+
+    //! The candidate lists of each query point.
+    std::vector<typename NeighborSearchRules<SortPolicy, MetricType,
+        Tree>::CandidateList> candidates;
+
+    friend class NeighborSearch;
+  };
+
   /**
    * Initialize the NeighborSearch object, passing a reference dataset (this is
    * the dataset which is searched).  Optionally, perform the computation in
@@ -189,6 +233,26 @@ class NeighborSearch
       const double epsilon = 0,
       const MetricType metric = MetricType());
 
+  /**
+   * Initialize the NeighborSearch object with the given shared reference tree,
+   * which is neither copied nor modified, so that other models can search it
+   * at the same time (see tree::SharedTree).  As with the other constructors
+   * that take a tree, the reference indices of the results are in the order of
+   * the tree; SharedTree::MapNeighbors() maps them back.  Naive mode is not
+   * available, and a monochromatic search in dual-tree mode is run in
+   * single-tree mode, since it would change the bounds of the shared tree.
+   *
+   * @param referenceTree Shared pre-built tree for reference points.
+   * @param mode Neighbor search mode.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric Instantiated distance metric.
+   */
+  NeighborSearch(
+      const tree::SharedTree<Tree>& referenceTree,
+      const NeighborSearchMode mode = DUAL_TREE_MODE,
+      const double epsilon = 0,
+      const MetricType metric = MetricType());
+
   /**
    * Create a NeighborSearch object without any reference data.  If Search() is
    * called before a reference set is set with Train(), an exception will be
@@ -288,15 +352,86 @@ class NeighborSearch
    * worthwhile to set singleMode = false (either in the constructor or with
    * SingleMode()).
    *
+   * The neighbors may be stored with a smaller index type than size_t, such as
+   * in an arma::Mat<uint32_t>, which halves the memory taken by the results;
+   * std::invalid_argument is thrown if the reference set has too many points
+   * for the index type.  This holds for all the overloads of Search() that
+   * store the neighbors in a matrix.
+   *
+   * @param querySet Set of query points (can be just one point).
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  template<typename IndexType>
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<IndexType>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * For each point in the query set, compute the nearest neighbors and store
+   * the output in the given matrices, reusing the storage of the given
+   * SearchContext.  This is meant for many searches with small query sets:
+   *
+   *  - the candidate lists of the query points are kept in the context, so
+   *    they are not allocated again if the next query set is no larger;
+   *  - in dual-tree mode, query sets with no more than
+   *    context.MaxSingleTreeBatch() points are searched with single-tree
+   *    search, so no query tree is built (larger query sets are searched as
+   *    with the other overloads);
+   *  - the results are written directly into the given matrices, which are
+   *    not reallocated if they already have the right size.
+   *
+   * The results are the same as those of the other overloads.
+   *
+   * @param querySet Set of query points (can be just one point).
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   * @param context Storage reused across searches.
+   */
+  template<typename IndexType>
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<IndexType>& neighbors,
+              arma::mat& distances,
+              SearchContext& context);
+
+  /**
+   * For each point in the query set, compute the nearest neighbors among the
+   * reference points that the given filter lets through, and store the output
+   * in the given matrices.  The query points are split into groups, and
+   * eligible[g][r] says whether reference point r may be returned for the
+   * query points of group g; for instance, the points of the same tenant, or
+   * the points that have not been seen yet.  The filter is applied during the
+   * search, so k eligible neighbors are found without over-fetching, and, if
+   * the reference tree is not shared, the subtrees that hold no eligible point
+   * for a query are pruned, with a summary of the filter kept in the
+   * statistic of each node for the duration of the search.
+   *
+   * The search is naive in NAIVE_MODE, and single-tree in all the other modes
+   * (the groups of the points of a query node may differ).  If fewer than k
+   * reference points are eligible for a query point, its remaining neighbors
+   * have the distance SortPolicy::WorstDistance() and the largest index of
+   * IndexType.
+   *
    * @param querySet Set of query points (can be just one point).
    * @param k Number of neighbors to search for.
+   * @param queryGroups Group of each query point.
+   * @param eligible For each group, whether each reference point is eligible.
    * @param neighbors Matrix storing lists of neighbors for each query point.
    * @param distances Matrix storing distances of neighbors for each query
    *     point.
    */
+  template<typename IndexType>
   void Search(const MatType& querySet,
               const size_t k,
-              arma::Mat<size_t>& neighbors,
+              const arma::Row<size_t>& queryGroups,
+              const std::vector<std::vector<bool>>& eligible,
+              arma::Mat<IndexType>& neighbors,
               arma::mat& distances);
 
   /**
@@ -319,9 +454,10 @@ class NeighborSearch
    * @param sameSet Denotes whether or not the reference and query sets are the
    *      same.
    */
+  template<typename IndexType>
   void Search(Tree& queryTree,
               const size_t k,
-              arma::Mat<size_t>& neighbors,
+              arma::Mat<IndexType>& neighbors,
               arma::mat& distances,
               bool sameSet = false);
 
@@ -339,10 +475,32 @@ class NeighborSearch
    * @param distances Matrix storing distances of neighbors for each query
    *      point.
    */
+  template<typename IndexType>
   void Search(const size_t k,
-              arma::Mat<size_t>& neighbors,
+              arma::Mat<IndexType>& neighbors,
               arma::mat& distances);
 
+  /**
+   * Build the k-nearest-neighbor graph of the reference set: the nearest
+   * neighbors of every reference point are found as with the monochromatic
+   * Search() overload above, and stored in a sparse n x n matrix, where column
+   * i holds the distances from point i to its k neighbors (graph(j, i) is the
+   * distance between point i and its neighbor j).  If symmetrize is true, the
+   * graph is made undirected, so that graph(i, j) = graph(j, i) whenever j is a
+   * neighbor of i or i is a neighbor of j.
+   *
+   * In naive mode each distance between two points is computed only once, for
+   * both points.  Because the graph is sparse, a neighbor at distance zero (a
+   * duplicate point) is not stored.
+   *
+   * @param k Number of neighbors to search for.
+   * @param graph Sparse matrix to store the graph in.
+   * @param symmetrize If true, make the graph symmetric.
+   */
+  void Search(const size_t k,
+              arma::sp_mat& graph,
+              const bool symmetrize = false);
+
   /**
    * Calculate the average relative error (effective error) between the
    * distances calculated and the true distances provided.  The input matrices
@@ -392,6 +550,32 @@ class NeighborSearch
   //! Modify the relative error to be considered in approximate search.
   double& Epsilon() { return epsilon; }
 
+  //! Access the maximum number of leaves visited for each query point in
+  //! best-first single-tree search (0 means no limit).
+  size_t MaxLeaves() const { return maxLeaves; }
+  //! Modify the maximum number of leaves visited for each query point in
+  //! best-first single-tree search (0 means no limit).
+  size_t& MaxLeaves() { return maxLeaves; }
+
+  //! Access the maximum time, in seconds, spent on each query point in
+  //! best-first single-tree search (0 means no limit).
+  double TimeLimit() const { return timeLimit; }
+  //! Modify the maximum time, in seconds, spent on each query point in
+  //! best-first single-tree search (0 means no limit).
+  double& TimeLimit() { return timeLimit; }
+
+  //! Access whether the query points of single-tree searches are traversed in
+  //! the order of the Hilbert curve (see tree::HilbertOrder()) instead of in
+  //! the order of the query set.
+  bool ReorderQueries() const { return reorderQueries; }
+  //! Modify whether the query points of single-tree searches are traversed in
+  //! the order of the Hilbert curve.  This helps when consecutive query points
+  //! are unrelated (like randomly ordered batches of queries): then they visit
+  //! the same parts of the tree, so the tree and the reference points stay in
+  //! cache, and each thread gets query points that are close to each other.
+  //! The results are not affected.
+  bool& ReorderQueries() { return reorderQueries; }
+
   //! Access the reference dataset.
   const MatType& ReferenceSet() const { return *referenceSet; }
 
@@ -421,6 +605,15 @@ class NeighborSearch
   NeighborSearchMode searchMode;
   //! Indicates the relative error to be considered in approximate search.
   double epsilon;
+  //! The maximum number of leaves visited for each query point in best-first
+  //! single-tree search.
+  size_t maxLeaves;
+  //! The maximum time spent on each query point in best-first single-tree
+  //! search, in seconds.
+  double timeLimit;
+  //! If true, the query points of single-tree searches are traversed in the
+  //! order of the Hilbert curve.
+  bool reorderQueries;
 
   //! Instantiation of metric.
   MetricType metric;
@@ -434,8 +627,98 @@ class NeighborSearch
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  //! The shared reference tree, if the reference tree is shared; then
+  //! referenceTree points to it, and it is never modified.
+  std::shared_ptr<const Tree> sharedTree;
+
+  /**
+   * Run a dual-tree traversal of the given query tree against the reference
+   * tree, using the given rules.  If OpenMP is available and more than one
+   * thread may be used, the top levels of the query tree are split into
+   * independent subtrees, and each subtree is traversed against the reference
+   * tree as a separate dynamically scheduled task with its own rules object.
+   * All of those rules objects share the candidate lists of the given rules,
+   * so the results can be obtained from it with GetResults() as usual.
+   *
+   * @param queryTree Tree built on query points.
+   * @param rules Rules to use for the traversal.
+   */
+  template<typename RuleType>
+  void DualTreeTraversal(Tree& queryTree, RuleType& rules);
+
+  /**
+   * Run a single-tree traversal of the reference tree for each of the given
+   * number of query points, using the given rules.  If OpenMP is available, the
+   * query points are split between the threads, and each thread uses its own
+   * traverser and its own rules object, which shares the candidate lists of the
+   * given rules.  Trees whose first point is the centroid (like the cover tree)
+   * are traversed on one thread, because scoring a reference node writes into
+   * its statistic.
+   *
+   * @param querySet Query points (the query set of the rules).
+   * @param rules Rules to use for the traversal.
+   * @param args Additional arguments of the constructor of the traverser.
+   */
+  template<typename TraverserType, typename RuleType, typename... TraverserArgs>
+  void SingleTreeTraversal(const MatType& querySet,
+                           RuleType& rules,
+                           const TraverserArgs&... args);
+
+  /**
+   * Compute the base cases between each of the given number of query points
+   * and every reference point, using the given rules.  The query points are
+   * split into blocks, which are distributed over the threads if OpenMP is
+   * available, and each block is compared with one block of reference points
+   * at a time with BaseCaseBlock(); for the Euclidean distance on dense data,
+   * that is a single matrix multiplication per tile, and only the pairs that
+   * may enter the k best candidates have their distance computed exactly.
+   * Each block uses its own rules object, which shares the candidate lists of
+   * the given rules.
+   *
+   * @param numQueries Number of query points.
+   * @param rules Rules to use for the search.
+   */
+  template<typename RuleType>
+  void NaiveTraversal(const size_t numQueries, RuleType& rules);
+
+  /**
+   * Compute the base cases between every pair of distinct reference points,
+   * for monochromatic search, using the given rules.  Each distance is computed
+   * once by SymmetricBaseCaseBlock() and offered to both points.  The points
+   * are split into blocks, and the pairs of blocks are visited in rounds of a
+   * round-robin schedule: the pairs of a round share no block, so they touch
+   * the candidates of different points and are distributed over the threads
+   * if OpenMP is available.
+   *
+   * @param rules Rules to use for the search.
+   */
+  template<typename RuleType>
+  void SymmetricNaiveTraversal(RuleType& rules);
+
+  /**
+   * Set the EligibleGroups() of the statistic of the given node and of its
+   * descendants: whether, for each group of a filtered search, the node holds
+   * any eligible point.
+   *
+   * @param node Node to summarize the filter in.
+   * @param eligible For each group, whether each reference point is eligible.
+   */
+  static void SummarizeFilter(Tree& node,
+                              const std::vector<std::vector<bool>>& eligible);
+
+  //! Clear the EligibleGroups() of the statistic of the given node and of its
+  //! descendants.
+  static void ClearFilterSummary(Tree& node);
+
+  /**
+   * Throw std::invalid_argument if the index of some reference point does not
+   * fit in the given index type.
+   */
+  template<typename IndexType>
+  void CheckIndexType() const;
+
   //! The NSModel class should have access to internal members.
-  template<typename SortPol>
+  template<typename SortPol, typename Mat>
   friend class TrainVisitor;
 }; // class NeighborSearch
 
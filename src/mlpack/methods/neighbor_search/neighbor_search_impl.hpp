@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/greedy_single_tree_traverser.hpp>
+#include <mlpack/core/tree/best_first_single_tree_traverser.hpp>
 #include "neighbor_search_rules.hpp"
 #include <mlpack/core/tree/spill_tree/is_spill_tree.hpp>
 
@@ -67,6 +68,9 @@ SingleTreeTraversalType>::NeighborSearch(const MatType& referenceSetIn,
     setOwner(false),
     searchMode(mode),
     epsilon(epsilon),
+    maxLeaves(0),
+    timeLimit(0.0),
+    reorderQueries(false),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -98,6 +102,9 @@ SingleTreeTraversalType>::NeighborSearch(MatType&& referenceSetIn,
     setOwner(mode == NAIVE_MODE),
     searchMode(mode),
     epsilon(epsilon),
+    maxLeaves(0),
+    timeLimit(0.0),
+    reorderQueries(false),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -127,6 +134,9 @@ SingleTreeTraversalType>::NeighborSearch(const Tree& referenceTree,
     setOwner(false),
     searchMode(mode),
     epsilon(epsilon),
+    maxLeaves(0),
+    timeLimit(0.0),
+    reorderQueries(false),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -156,6 +166,9 @@ SingleTreeTraversalType>::NeighborSearch(Tree&& referenceTree,
     setOwner(false),
     searchMode(mode),
     epsilon(epsilon),
+    maxLeaves(0),
+    timeLimit(0.0),
+    reorderQueries(false),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -165,6 +178,43 @@ SingleTreeTraversalType>::NeighborSearch(Tree&& referenceTree,
     throw std::invalid_argument("epsilon must be non-negative");
 }
 
+// Construct the object on a shared tree.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
+SingleTreeTraversalType>::NeighborSearch(
+    const tree::SharedTree<Tree>& referenceTree,
+    const NeighborSearchMode mode,
+    const double epsilon,
+    const MetricType metric) :
+    referenceTree(const_cast<Tree*>(&referenceTree.Tree())),
+    referenceSet(&referenceTree.Dataset()),
+    treeOwner(false),
+    setOwner(false),
+    searchMode(mode),
+    epsilon(epsilon),
+    maxLeaves(0),
+    timeLimit(0.0),
+    reorderQueries(false),
+    metric(metric),
+    baseCases(0),
+    scores(0),
+    treeNeedsReset(false),
+    sharedTree(referenceTree.TreePointer())
+{
+  if (epsilon < 0)
+    throw std::invalid_argument("epsilon must be non-negative");
+  if (mode == NAIVE_MODE)
+    throw std::invalid_argument("cannot search a shared reference tree in "
+        "naive mode");
+}
+
 // Construct the object without a reference dataset.
 template<typename SortPolicy,
          typename MetricType,
@@ -184,6 +234,9 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
     setOwner(true),
     searchMode(mode),
     epsilon(epsilon),
+    maxLeaves(0),
+    timeLimit(0.0),
+    reorderQueries(false),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -212,17 +265,22 @@ template<typename SortPolicy,
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
 SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
     oldFromNewReferences(other.oldFromNewReferences),
-    referenceTree(other.referenceTree ? new Tree(*other.referenceTree) : NULL),
+    referenceTree(other.sharedTree ? other.referenceTree :
+        (other.referenceTree ? new Tree(*other.referenceTree) : NULL)),
     referenceSet(other.referenceTree ? &referenceTree->Dataset() :
         new MatType(*other.referenceSet)),
-    treeOwner(other.referenceTree),
+    treeOwner(other.referenceTree && !other.sharedTree),
     setOwner(!other.referenceTree),
     searchMode(other.searchMode),
     epsilon(other.epsilon),
+    maxLeaves(other.maxLeaves),
+    timeLimit(other.timeLimit),
+    reorderQueries(other.reorderQueries),
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    sharedTree(other.sharedTree)
 {
   // Nothing else to do.
 }
@@ -245,10 +303,14 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     setOwner(other.setOwner),
     searchMode(other.searchMode),
     epsilon(other.epsilon),
+    maxLeaves(other.maxLeaves),
+    timeLimit(other.timeLimit),
+    reorderQueries(other.reorderQueries),
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(other.treeNeedsReset)
+    treeNeedsReset(other.treeNeedsReset),
+    sharedTree(std::move(other.sharedTree))
 {
   // Clear the other model.
   other.referenceSet = new MatType();
@@ -258,6 +320,9 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
   other.setOwner = true;
   other.searchMode = DUAL_TREE_MODE,
   other.epsilon = 0.0;
+  other.maxLeaves = 0;
+  other.timeLimit = 0.0;
+  other.reorderQueries = false;
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
@@ -292,13 +357,18 @@ NeighborSearch<SortPolicy,
     delete referenceSet;
 
   oldFromNewReferences = other.oldFromNewReferences;
-  referenceTree = other.referenceTree ? new Tree(*other.referenceTree) : NULL;
+  sharedTree = other.sharedTree;
+  referenceTree = other.sharedTree ? other.referenceTree :
+      (other.referenceTree ? new Tree(*other.referenceTree) : NULL);
   referenceSet = other.referenceTree ? &referenceTree->Dataset() :
       new MatType(*other.referenceSet);
-  treeOwner = (other.referenceTree != NULL);
+  treeOwner = (other.referenceTree != NULL && !other.sharedTree);
   setOwner = (other.referenceTree == NULL);
   searchMode = other.searchMode;
   epsilon = other.epsilon;
+  maxLeaves = other.maxLeaves;
+  timeLimit = other.timeLimit;
+  reorderQueries = other.reorderQueries;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
@@ -334,12 +404,16 @@ NeighborSearch<SortPolicy,
     delete referenceSet;
 
   oldFromNewReferences = std::move(other.oldFromNewReferences);
+  sharedTree = std::move(other.sharedTree);
   referenceTree = other.referenceTree;
   referenceSet = other.referenceSet;
   treeOwner = other.treeOwner;
   setOwner = other.setOwner;
   searchMode = other.searchMode;
   epsilon = other.epsilon;
+  maxLeaves = other.maxLeaves;
+  timeLimit = other.timeLimit;
+  reorderQueries = other.reorderQueries;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
@@ -353,6 +427,9 @@ NeighborSearch<SortPolicy,
   other.setOwner = true;
   other.searchMode = DUAL_TREE_MODE,
   other.epsilon = 0.0;
+  other.maxLeaves = 0;
+  other.timeLimit = 0.0;
+  other.reorderQueries = false;
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
@@ -395,6 +472,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(
     delete referenceTree;
   }
 
+  // Stop sharing the old tree, if it was shared.
+  if (sharedTree)
+  {
+    sharedTree.reset();
+    referenceTree = NULL;
+  }
+
   // We may need to rebuild the tree.
   if (searchMode != NAIVE_MODE)
   {
@@ -435,6 +519,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType&& referenceSetIn)
     delete referenceTree;
   }
 
+  // Stop sharing the old tree, if it was shared.
+  if (sharedTree)
+  {
+    sharedTree.reset();
+    referenceTree = NULL;
+  }
+
   // We may need to rebuild the tree.
   if (searchMode != NAIVE_MODE)
   {
@@ -485,6 +576,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(
     delete this->referenceTree;
   }
 
+  // Stop sharing the old tree, if it was shared.
+  if (sharedTree)
+  {
+    sharedTree.reset();
+    this->referenceTree = NULL;
+  }
+
   if (setOwner && referenceSet)
     delete this->referenceSet;
 
@@ -515,6 +613,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree&& referenceTree)
     delete this->referenceTree;
   }
 
+  // Stop sharing the old tree, if it was shared.
+  if (sharedTree)
+  {
+    sharedTree.reset();
+    this->referenceTree = NULL;
+  }
+
   if (setOwner && referenceSet)
     delete this->referenceSet;
 
@@ -536,11 +641,12 @@ template<typename SortPolicy,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
          template<typename> class SingleTreeTraversalType>
+template<typename IndexType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::Search(
     const MatType& querySet,
     const size_t k,
-    arma::Mat<size_t>& neighbors,
+    arma::Mat<IndexType>& neighbors,
     arma::mat& distances)
 {
   if (k > referenceSet->n_cols)
@@ -551,6 +657,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     throw std::invalid_argument(ss.str());
   }
 
+  CheckIndexType<IndexType>();
+
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -563,7 +671,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   // indices back to their original indices when this computation is finished.
   // To avoid an extra copy, we will store the neighbors and distances in a
   // separate matrix.
-  arma::Mat<size_t>* neighborPtr = &neighbors;
+  arma::Mat<IndexType>* neighborPtr = &neighbors;
   arma::mat* distancePtr = &distances;
 
   // Mapping is only necessary if the tree rearranges points.
@@ -572,15 +680,17 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     if (searchMode == DUAL_TREE_MODE)
     {
       distancePtr = new arma::mat; // Query indices need to be mapped.
-      neighborPtr = new arma::Mat<size_t>;
+      neighborPtr = new arma::Mat<IndexType>;
     }
     else if (!oldFromNewReferences.empty())
-      neighborPtr = new arma::Mat<size_t>; // Reference indices need mapping.
+      neighborPtr = new arma::Mat<IndexType>; // Reference indices need mapping.
   }
 
   // Set the size of the neighbor and distance matrices.
   neighborPtr->set_size(k, querySet.n_cols);
   distancePtr->set_size(k, querySet.n_cols);
+  MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(*neighborPtr) +
+      MemoryTracker::Bytes(*distancePtr));
 
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
 
@@ -591,10 +701,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, querySet, k, metric, epsilon);
 
-      // The naive brute-force traversal.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
+      // The naive brute-force traversal, in tiles.
+      NaiveTraversal(querySet.n_cols, rules);
 
       baseCases += querySet.n_cols * referenceSet->n_cols;
 
@@ -606,12 +714,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, querySet, k, metric, epsilon);
 
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Traverse for each point.
+      SingleTreeTraversal<SingleTreeTraversalType<RuleType>>(querySet,
+          rules);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -630,16 +735,14 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       Timer::Stop("computing_neighbors");
       Timer::Start("tree_building");
       Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+      MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(queryTree->Dataset()));
       Timer::Stop("tree_building");
       Timer::Start("computing_neighbors");
 
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon);
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
-      traverser.Traverse(*queryTree, *referenceTree);
+      DualTreeTraversal(*queryTree, rules);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -651,6 +754,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       rules.GetResults(*neighborPtr, *distancePtr);
 
+      MLPACK_TRACK_FREE(MemoryTracker::Bytes(queryTree->Dataset()));
       delete queryTree;
       break;
     }
@@ -659,12 +763,30 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, querySet, k, metric);
 
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
+      // Traverse for each point.
+      SingleTreeTraversal<tree::GreedySingleTreeTraverser<Tree, RuleType>>(
+          querySet, rules);
+
+      scores += rules.Scores();
+      baseCases += rules.BaseCases();
+
+      Log::Info << rules.Scores() << " node combinations were scored."
+          << std::endl;
+      Log::Info << rules.BaseCases() << " base cases were calculated."
+          << std::endl;
+
+      rules.GetResults(*neighborPtr, *distancePtr);
+      break;
+    }
+    case BEST_FIRST_SINGLE_TREE_MODE:
+    {
+      // Create the helper object for the tree traversal.
+      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Traverse for each point, within the budget; k base cases are always
+      // computed, so that k neighbors are found.
+      SingleTreeTraversal<tree::BestFirstSingleTreeTraverser<Tree, RuleType>>(
+          querySet, rules, maxLeaves, timeLimit, k);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -689,6 +811,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // We must map both query and reference indices.
       neighbors.set_size(k, querySet.n_cols);
       distances.set_size(k, querySet.n_cols);
+      MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(neighbors) +
+          MemoryTracker::Bytes(distances));
 
       for (size_t i = 0; i < distances.n_cols; i++)
       {
@@ -704,6 +828,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       }
 
       // Finished with temporary matrices.
+      MLPACK_TRACK_FREE(MemoryTracker::Bytes(*neighborPtr) +
+          MemoryTracker::Bytes(*distancePtr));
       delete neighborPtr;
       delete distancePtr;
     }
@@ -712,6 +838,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // We must map query indices only.
       neighbors.set_size(k, querySet.n_cols);
       distances.set_size(k, querySet.n_cols);
+      MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(neighbors) +
+          MemoryTracker::Bytes(distances));
 
       for (size_t i = 0; i < distances.n_cols; ++i)
       {
@@ -722,6 +850,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       }
 
       // Finished with temporary matrices.
+      MLPACK_TRACK_FREE(MemoryTracker::Bytes(*neighborPtr) +
+          MemoryTracker::Bytes(*distancePtr));
       delete neighborPtr;
       delete distancePtr;
     }
@@ -729,6 +859,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     {
       // We must map reference indices only.
       neighbors.set_size(k, querySet.n_cols);
+      MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(neighbors));
 
       // Map indices of neighbors.
       for (size_t i = 0; i < neighbors.n_cols; i++)
@@ -736,6 +867,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
           neighbors(j, i) = oldFromNewReferences[(*neighborPtr)(j, i)];
 
       // Finished with temporary matrix.
+      MLPACK_TRACK_FREE(MemoryTracker::Bytes(*neighborPtr));
       delete neighborPtr;
     }
   }
@@ -749,11 +881,218 @@ template<typename SortPolicy,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
          template<typename> class SingleTreeTraversalType>
+template<typename IndexType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<IndexType>& neighbors,
+    arma::mat& distances,
+    SearchContext& context)
+{
+  // Large query sets are better served by a dual-tree search.
+  if (searchMode == DUAL_TREE_MODE &&
+      querySet.n_cols > context.MaxSingleTreeBatch())
+  {
+    Search(querySet, k, neighbors, distances);
+    return;
+  }
+
+  if (k > referenceSet->n_cols)
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << referenceSet->n_cols << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  CheckIndexType<IndexType>();
+
+  Timer::Start("computing_neighbors");
+
+  typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
+
+  // The greedy traversal does not support approximation, as in Search().
+  RuleType rules(*referenceSet, querySet, k, metric,
+      (searchMode == GREEDY_SINGLE_TREE_MODE) ? 0.0 : epsilon, false,
+      context.candidates);
+
+  if (searchMode == NAIVE_MODE)
+  {
+    NaiveTraversal(querySet.n_cols, rules);
+  }
+  else if (searchMode == GREEDY_SINGLE_TREE_MODE)
+  {
+    tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      traverser.Traverse(i, *referenceTree);
+  }
+  else if (searchMode == BEST_FIRST_SINGLE_TREE_MODE)
+  {
+    tree::BestFirstSingleTreeTraverser<Tree, RuleType> traverser(rules,
+        maxLeaves, timeLimit, k);
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      traverser.Traverse(i, *referenceTree);
+  }
+  else
+  {
+    SingleTreeTraversalType<RuleType> traverser(rules);
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      traverser.Traverse(i, *referenceTree);
+  }
+
+  // The naive traversal does not count its base cases itself.
+  baseCases = (searchMode == NAIVE_MODE) ?
+      querySet.n_cols * referenceSet->n_cols : rules.BaseCases();
+  scores = rules.Scores();
+
+  rules.GetResults(neighbors, distances);
+
+  // The query points were not reordered, so only the reference indices may
+  // need to be mapped, and that can be done in place.
+  if (tree::TreeTraits<Tree>::RearrangesDataset &&
+      !oldFromNewReferences.empty())
+  {
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+      neighbors[i] = oldFromNewReferences[neighbors[i]];
+  }
+
+  Timer::Stop("computing_neighbors");
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename IndexType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    const arma::Row<size_t>& queryGroups,
+    const std::vector<std::vector<bool>>& eligible,
+    arma::Mat<IndexType>& neighbors,
+    arma::mat& distances)
+{
+  if (k > referenceSet->n_cols)
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << referenceSet->n_cols << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  CheckIndexType<IndexType>();
+
+  if (queryGroups.n_elem != querySet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "NeighborSearch::Search(): " << queryGroups.n_elem << " query "
+        << "groups were given for " << querySet.n_cols << " query points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  for (size_t g = 0; g < eligible.size(); ++g)
+  {
+    if (eligible[g].size() != referenceSet->n_cols)
+    {
+      std::ostringstream oss;
+      oss << "NeighborSearch::Search(): the filter of group " << g << " has "
+          << eligible[g].size() << " elements, but there are "
+          << referenceSet->n_cols << " reference points";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  if (queryGroups.n_elem > 0 && queryGroups.max() >= eligible.size())
+  {
+    std::ostringstream oss;
+    oss << "NeighborSearch::Search(): query group " << queryGroups.max()
+        << " has no filter (" << eligible.size() << " filters were given)";
+    throw std::invalid_argument(oss.str());
+  }
+
+  Timer::Start("computing_neighbors");
+
+  // The filter is given in the original order of the reference points, so it
+  // is rearranged as the reference tree was.
+  const bool mapReferences = tree::TreeTraits<Tree>::RearrangesDataset &&
+      !oldFromNewReferences.empty();
+  std::vector<std::vector<bool>> mappedEligible;
+  if (mapReferences)
+  {
+    mappedEligible.resize(eligible.size());
+    for (size_t g = 0; g < eligible.size(); ++g)
+    {
+      mappedEligible[g].resize(referenceSet->n_cols);
+      for (size_t i = 0; i < referenceSet->n_cols; ++i)
+        mappedEligible[g][i] = eligible[g][oldFromNewReferences[i]];
+    }
+  }
+  const std::vector<std::vector<bool>>& treeEligible = mapReferences ?
+      mappedEligible : eligible;
+
+  // The filter is summarized in the statistics of the nodes, unless the tree
+  // is shared, since those statistics may be in use by another model.
+  const bool useNodeSummaries = (searchMode != NAIVE_MODE) && !sharedTree;
+  if (useNodeSummaries)
+    SummarizeFilter(*referenceTree, treeEligible);
+
+  typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
+  RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+  rules.Filter(queryGroups, treeEligible, useNodeSummaries);
+
+  if (searchMode == NAIVE_MODE)
+  {
+    NaiveTraversal(querySet.n_cols, rules);
+  }
+  else
+  {
+    SingleTreeTraversal<SingleTreeTraversalType<RuleType>>(querySet,
+        rules);
+  }
+
+  baseCases = rules.BaseCases();
+  scores = rules.Scores();
+
+  if (useNodeSummaries)
+    ClearFilterSummary(*referenceTree);
+
+  // The query points are not reordered.  A query point with fewer than k
+  // eligible points keeps the index size_t() - 1 for the missing ones, which
+  // must not be mapped.
+  arma::Mat<size_t> found;
+  rules.GetResults(found, distances);
+  neighbors.set_size(k, querySet.n_cols);
+  for (size_t i = 0; i < found.n_elem; ++i)
+  {
+    if (found[i] >= referenceSet->n_cols)
+      neighbors[i] = std::numeric_limits<IndexType>::max();
+    else
+      neighbors[i] = mapReferences ? oldFromNewReferences[found[i]] : found[i];
+  }
+
+  Timer::Stop("computing_neighbors");
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename IndexType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::Search(
     Tree& queryTree,
     const size_t k,
-    arma::Mat<size_t>& neighbors,
+    arma::Mat<IndexType>& neighbors,
     arma::mat& distances,
     bool sameSet)
 {
@@ -765,6 +1104,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     throw std::invalid_argument(ss.str());
   }
 
+  CheckIndexType<IndexType>();
+
   // Make sure we are in dual-tree mode.
   if (searchMode != DUAL_TREE_MODE)
     throw std::invalid_argument("cannot call NeighborSearch::Search() with a "
@@ -779,11 +1120,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   const MatType& querySet = queryTree.Dataset();
 
   // We won't need to map query indices, but will we need to map distances?
-  arma::Mat<size_t>* neighborPtr = &neighbors;
+  arma::Mat<IndexType>* neighborPtr = &neighbors;
 
   if (!oldFromNewReferences.empty() &&
       tree::TreeTraits<Tree>::RearrangesDataset)
-    neighborPtr = new arma::Mat<size_t>;
+    neighborPtr = new arma::Mat<IndexType>;
 
   neighborPtr->set_size(k, querySet.n_cols);
   distances.set_size(k, querySet.n_cols);
@@ -792,9 +1133,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, querySet, k, metric, epsilon, sameSet);
 
-  // Create the traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
-  traverser.Traverse(queryTree, *referenceTree);
+  DualTreeTraversal(queryTree, rules);
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
@@ -834,10 +1173,11 @@ template<typename SortPolicy,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
          template<typename> class SingleTreeTraversalType>
+template<typename IndexType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::Search(
     const size_t k,
-    arma::Mat<size_t>& neighbors,
+    arma::Mat<IndexType>& neighbors,
     arma::mat& distances)
 {
   if (k > referenceSet->n_cols)
@@ -848,12 +1188,14 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     throw std::invalid_argument(ss.str());
   }
 
+  CheckIndexType<IndexType>();
+
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
   scores = 0;
 
-  arma::Mat<size_t>* neighborPtr = &neighbors;
+  arma::Mat<IndexType>* neighborPtr = &neighbors;
   arma::mat* distancePtr = &distances;
 
   if (!oldFromNewReferences.empty() &&
@@ -861,38 +1203,40 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   {
     // We will always need to rearrange in this case.
     distancePtr = new arma::mat;
-    neighborPtr = new arma::Mat<size_t>;
+    neighborPtr = new arma::Mat<IndexType>;
   }
 
   // Initialize results.
   neighborPtr->set_size(k, referenceSet->n_cols);
   distancePtr->set_size(k, referenceSet->n_cols);
+  MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(*neighborPtr) +
+      MemoryTracker::Bytes(*distancePtr));
 
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, *referenceSet, k, metric, epsilon,
       true /* don't return the same point as nearest neighbor */);
 
-  switch (searchMode)
+  // A dual-tree search would use the reference tree as the query tree and
+  // change its bounds, so a shared tree is searched single-tree instead.
+  const NeighborSearchMode mode = (searchMode == DUAL_TREE_MODE && sharedTree) ?
+      SINGLE_TREE_MODE : searchMode;
+  switch (mode)
   {
     case NAIVE_MODE:
     {
-      // The naive brute-force solution.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
+      // The naive brute-force solution, in tiles; the query set is the
+      // reference set, so each distance is only computed once.
+      SymmetricNaiveTraversal(rules);
 
-      baseCases += referenceSet->n_cols * referenceSet->n_cols;
+      baseCases += rules.BaseCases();
       break;
     }
     case SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Traverse for each point.
+      SingleTreeTraversal<SingleTreeTraversalType<RuleType>>(
+          *referenceSet, rules);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -925,19 +1269,16 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
         }
       }
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
       if (tree::IsSpillTree<Tree>::value)
       {
         // For Dual Tree Search on SpillTree, the queryTree must be built with
         // non overlapping (tau = 0).
         Tree queryTree(*referenceSet);
-        traverser.Traverse(queryTree, *referenceTree);
+        DualTreeTraversal(queryTree, rules);
       }
       else
       {
-        traverser.Traverse(*referenceTree, *referenceTree);
+        DualTreeTraversal(*referenceTree, rules);
         // Next time we perform this search, we'll need to reset the tree.
         treeNeedsReset = true;
       }
@@ -956,12 +1297,25 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
     case GREEDY_SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
+      // Traverse for each point.
+      SingleTreeTraversal<tree::GreedySingleTreeTraverser<Tree, RuleType>>(
+          *referenceSet, rules);
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      scores += rules.Scores();
+      baseCases += rules.BaseCases();
+
+      Log::Info << rules.Scores() << " node combinations were scored."
+          << std::endl;
+      Log::Info << rules.BaseCases() << " base cases were calculated."
+          << std::endl;
+      break;
+    }
+    case BEST_FIRST_SINGLE_TREE_MODE:
+    {
+      // Traverse for each point, within the budget; k base cases are always
+      // computed, so that k neighbors are found.
+      SingleTreeTraversal<tree::BestFirstSingleTreeTraverser<Tree, RuleType>>(
+          *referenceSet, rules, maxLeaves, timeLimit, k);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -984,6 +1338,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   {
     neighbors.set_size(k, referenceSet->n_cols);
     distances.set_size(k, referenceSet->n_cols);
+    MLPACK_TRACK_ALLOC(MemoryTracker::Bytes(neighbors) +
+        MemoryTracker::Bytes(distances));
 
     for (size_t i = 0; i < distances.n_cols; ++i)
     {
@@ -997,11 +1353,363 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
 
     // Finished with temporary matrices.
+    MLPACK_TRACK_FREE(MemoryTracker::Bytes(*neighborPtr) +
+        MemoryTracker::Bytes(*distancePtr));
     delete neighborPtr;
     delete distancePtr;
   }
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Search(
+    const size_t k,
+    arma::sp_mat& graph,
+    const bool symmetrize)
+{
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  Search(k, neighbors, distances);
+
+  // Collect the edges in column-major order (by column, then by row) and drop
+  // the duplicates of a symmetrized graph; the values of both directions of
+  // an edge are the same distance.
+  const size_t n = neighbors.n_cols;
+  std::vector<std::pair<std::pair<size_t, size_t>, double>> edges;
+  edges.reserve((symmetrize ? 2 : 1) * neighbors.n_elem);
+  for (size_t i = 0; i < n; ++i)
+  {
+    for (size_t j = 0; j < k; ++j)
+    {
+      edges.push_back(std::make_pair(std::make_pair(i, neighbors(j, i)),
+          distances(j, i)));
+      if (symmetrize)
+      {
+        edges.push_back(std::make_pair(std::make_pair(neighbors(j, i), i),
+            distances(j, i)));
+      }
+    }
+  }
+
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end(),
+      [](const std::pair<std::pair<size_t, size_t>, double>& a,
+         const std::pair<std::pair<size_t, size_t>, double>& b)
+      {
+        return a.first == b.first;
+      }), edges.end());
+
+  arma::umat locations(2, edges.size());
+  arma::vec values(edges.size());
+  for (size_t e = 0; e < edges.size(); ++e)
+  {
+    locations(0, e) = edges[e].first.second;
+    locations(1, e) = edges[e].first.first;
+    values[e] = edges[e].second;
+  }
+
+  graph = arma::sp_mat(locations, values, n, n, false /* already sorted */);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::DualTreeTraversal(
+    Tree& queryTree,
+    RuleType& rules)
+{
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // Collect the query subtrees that will be traversed independently.  Points
+  // held by a node above these subtrees would never be seen by any traversal,
+  // so we can only descend through nodes that hold no points.  Trees that may
+  // hold a point in more than one node can't be split safely either, because
+  // two threads could then update the candidates of the same query point.
+  std::vector<Tree*> queryNodes(1, &queryTree);
+  if (numThreads > 1 && !tree::TreeTraits<Tree>::HasDuplicatedPoints &&
+      !tree::IsSpillTree<Tree>::value)
+  {
+    // A few subtrees per thread gives the dynamic schedule some room to
+    // balance the work.
+    while (queryNodes.size() < 4 * numThreads)
+    {
+      std::vector<Tree*> nextNodes;
+      bool canSplit = false;
+      for (size_t i = 0; i < queryNodes.size(); ++i)
+      {
+        Tree* node = queryNodes[i];
+        if (node->NumChildren() == 0)
+        {
+          nextNodes.push_back(node);
+          continue;
+        }
+
+        if (node->NumPoints() > 0)
+        {
+          canSplit = false;
+          break;
+        }
+
+        canSplit = true;
+        for (size_t j = 0; j < node->NumChildren(); ++j)
+          nextNodes.push_back(&node->Child(j));
+      }
+
+      if (!canSplit)
+        break;
+
+      queryNodes.swap(nextNodes);
+    }
+  }
+
+  if (queryNodes.size() == 1)
+  {
+    // Create the traverser.
+    DualTreeTraversalType<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+    return;
+  }
+
+  size_t taskScores = 0;
+  size_t taskBaseCases = 0;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for \
+      schedule(dynamic) \
+      reduction(+:taskScores, taskBaseCases)
+  for (intmax_t i = 0; i < (intmax_t) queryNodes.size(); ++i)
+#else
+  #pragma omp parallel for \
+      schedule(dynamic) \
+      reduction(+:taskScores, taskBaseCases)
+  for (size_t i = 0; i < queryNodes.size(); ++i)
+#endif
+  {
+    // Each task gets its own rules object, which shares the candidate lists of
+    // the given rules.  The subtrees are disjoint, so no two tasks ever touch
+    // the candidates of the same query point.
+    RuleType taskRules(rules);
+    DualTreeTraversalType<RuleType> traverser(taskRules);
+    traverser.Traverse(*queryNodes[i], *referenceTree);
+
+    taskScores += taskRules.Scores();
+    taskBaseCases += taskRules.BaseCases();
+  }
+
+  rules.Scores() += taskScores;
+  rules.BaseCases() += taskBaseCases;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename TraverserType, typename RuleType, typename... TraverserArgs>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SingleTreeTraversal(
+    const MatType& querySet,
+    RuleType& rules,
+    const TraverserArgs&... args)
+{
+  // The results are indexed by the query points, so only the order of the
+  // traversals changes.
+  const size_t numQueries = querySet.n_cols;
+  std::vector<size_t> order;
+  if (reorderQueries)
+    tree::HilbertOrder(querySet, order);
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  if (numThreads == 1 || numQueries < 2 ||
+      tree::TreeTraits<Tree>::FirstPointIsCentroid)
+  {
+    TraverserType traverser(rules, args...);
+    for (size_t i = 0; i < numQueries; ++i)
+      traverser.Traverse(order.empty() ? i : order[i], *referenceTree);
+    return;
+  }
+
+  size_t threadScores = 0;
+  size_t threadBaseCases = 0;
+
+  #pragma omp parallel reduction(+:threadScores, threadBaseCases)
+  {
+    // Each thread gets its own rules object, which shares the candidate lists
+    // of the given rules.  Every query point is traversed by one thread only.
+    RuleType threadRules(rules);
+    TraverserType traverser(threadRules, args...);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) numQueries; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < numQueries; ++i)
+#endif
+      traverser.Traverse(order.empty() ? i : order[i], *referenceTree);
+
+    threadScores += threadRules.Scores();
+    threadBaseCases += threadRules.BaseCases();
+  }
+
+  rules.Scores() += threadScores;
+  rules.BaseCases() += threadBaseCases;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::NaiveTraversal(
+    const size_t numQueries,
+    RuleType& rules)
+{
+  // Each tile of queryBlockSize query points and referenceBlockSize reference
+  // points is one call to BaseCaseBlock(), which is a single matrix
+  // multiplication for the Euclidean distance.
+  const size_t queryBlockSize = 64;
+  const size_t referenceBlockSize = 1024;
+  const size_t numReferences = referenceSet->n_cols;
+  const size_t numBlocks = (numQueries + queryBlockSize - 1) / queryBlockSize;
+
+  size_t blockBaseCases = 0;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic) reduction(+:blockBaseCases)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(dynamic) reduction(+:blockBaseCases)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    // Each block of query points gets its own rules object, which shares the
+    // candidate lists of the given rules.
+    RuleType blockRules(rules);
+
+    const size_t queryBegin = b * queryBlockSize;
+    const size_t queryEnd = std::min(queryBegin + queryBlockSize, numQueries);
+    std::vector<size_t> queryIndices(queryEnd - queryBegin);
+    for (size_t i = 0; i < queryIndices.size(); ++i)
+      queryIndices[i] = queryBegin + i;
+
+    for (size_t r = 0; r < numReferences; r += referenceBlockSize)
+    {
+      blockRules.BaseCaseBlock(queryIndices, r, std::min(referenceBlockSize,
+          numReferences - r));
+    }
+
+    blockBaseCases += blockRules.BaseCases();
+  }
+
+  rules.BaseCases() += blockBaseCases;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SymmetricNaiveTraversal(
+    RuleType& rules)
+{
+  const size_t blockSize = 256;
+  const size_t numPoints = referenceSet->n_cols;
+  const size_t numBlocks = (numPoints + blockSize - 1) / blockSize;
+
+  // The first round compares each block with itself.  The other rounds pair
+  // up the blocks with the circle method, with one extra dummy block if the
+  // number of blocks is odd, so that every pair of blocks meets exactly once.
+  const size_t numSlots = numBlocks + (numBlocks % 2);
+  size_t blockBaseCases = 0;
+  for (size_t round = 0; round < numSlots; ++round)
+  {
+    const size_t numPairs = (round == 0) ? numBlocks : numSlots / 2;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic) reduction(+:blockBaseCases)
+    for (intmax_t p = 0; p < (intmax_t) numPairs; ++p)
+#else
+    #pragma omp parallel for schedule(dynamic) reduction(+:blockBaseCases)
+    for (size_t p = 0; p < numPairs; ++p)
+#endif
+    {
+      size_t first = p, second = p;
+      if (round > 0)
+      {
+        const size_t r = round - 1;
+        first = (p == 0) ? numSlots - 1 : (r + p) % (numSlots - 1);
+        second = (p == 0) ? r : (r + numSlots - 1 - p) % (numSlots - 1);
+      }
+
+      // Skip the pairs with the dummy block.
+      if (first >= numBlocks || second >= numBlocks)
+        continue;
+
+      // Each pair of blocks gets its own rules object, which shares the
+      // candidate lists of the given rules.
+      RuleType blockRules(rules);
+      const size_t firstBegin = first * blockSize;
+      const size_t secondBegin = second * blockSize;
+      blockRules.SymmetricBaseCaseBlock(firstBegin,
+          std::min(blockSize, numPoints - firstBegin), secondBegin,
+          std::min(blockSize, numPoints - secondBegin));
+
+      blockBaseCases += blockRules.BaseCases();
+    }
+  }
+
+  rules.BaseCases() += blockBaseCases;
+}
+
 //! Calculate the average relative error.
 template<typename SortPolicy,
          typename MetricType,
@@ -1040,6 +1748,85 @@ DualTreeTraversalType, SingleTreeTraversalType>::EffectiveError(
   return effectiveError;
 }
 
+//! Summarize the filter of a filtered search in the node statistics.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SummarizeFilter(
+    Tree& node,
+    const std::vector<std::vector<bool>>& eligible)
+{
+  std::vector<bool>& groups = node.Stat().EligibleGroups();
+  groups.assign(eligible.size(), false);
+
+  for (size_t i = 0; i < node.NumPoints(); ++i)
+    for (size_t g = 0; g < eligible.size(); ++g)
+      if (eligible[g][node.Point(i)])
+        groups[g] = true;
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    SummarizeFilter(node.Child(i), eligible);
+    const std::vector<bool>& childGroups =
+        node.Child(i).Stat().EligibleGroups();
+    for (size_t g = 0; g < eligible.size(); ++g)
+      if (childGroups[g])
+        groups[g] = true;
+  }
+}
+
+//! Free the summary of the filter in the node statistics.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::ClearFilterSummary(Tree& node)
+{
+  std::vector<bool>().swap(node.Stat().EligibleGroups());
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    ClearFilterSummary(node.Child(i));
+}
+
+//! Make sure that every reference index fits in the given index type.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename IndexType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::CheckIndexType() const
+{
+  static_assert(std::is_integral<IndexType>::value &&
+      std::is_unsigned<IndexType>::value,
+      "the neighbor indices must be stored with an unsigned integer type");
+
+  if (referenceSet->n_cols > 0 && (referenceSet->n_cols - 1) >
+      (size_t) std::numeric_limits<IndexType>::max())
+  {
+    std::ostringstream oss;
+    oss << "NeighborSearch::Search(): the reference set has "
+        << referenceSet->n_cols << " points, but the largest index that the "
+        << "neighbor matrix can hold is "
+        << (size_t) std::numeric_limits<IndexType>::max();
+    throw std::invalid_argument(oss.str());
+  }
+}
+
 //! Calculate the recall.
 template<typename SortPolicy,
          typename MetricType,
@@ -1088,6 +1875,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Serialize(
 {
   using data::CreateNVP;
 
+  // A loaded model owns its tree.
+  if (Archive::is_loading::value && sharedTree)
+  {
+    sharedTree.reset();
+    referenceTree = NULL;
+  }
+
   // Serialize preferences for search.
   ar & CreateNVP(searchMode, "searchMode");
   ar & CreateNVP(treeNeedsReset, "treeNeedsReset");
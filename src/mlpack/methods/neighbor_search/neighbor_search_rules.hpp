@@ -14,6 +14,10 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/tree/base_case_block.hpp>
+#include "sort_policies/nearest_neighbor_sort.hpp"
+#include "sort_policies/furthest_neighbor_sort.hpp"
 
 #include <queue>
 
@@ -35,6 +39,21 @@ template<typename SortPolicy, typename MetricType, typename TreeType>
 class NeighborSearchRules
 {
  public:
+  //! Candidate represents a possible candidate neighbor (distance, index).
+  typedef std::pair<double, size_t> Candidate;
+
+  //! Compare two candidates based on the distance.
+  struct CandidateCmp {
+    bool operator()(const Candidate& c1, const Candidate& c2)
+    {
+      return !SortPolicy::IsBetter(c2.first, c1.first);
+    };
+  };
+
+  //! Use a priority queue to represent the list of candidate neighbors.
+  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
+      CandidateList;
+
   /**
    * Construct the NeighborSearchRules object.  This is usually done from within
    * the NeighborSearch class at search time.
@@ -54,6 +73,42 @@ class NeighborSearchRules
                       const double epsilon = 0,
                       const bool sameSet = false);
 
+  /**
+   * Construct the NeighborSearchRules object, keeping the candidate lists in
+   * the given storage instead of allocating new ones.  The storage is resized
+   * to hold one list for each query point, and every list is reset; since the
+   * lists are emptied again by GetResults(), storage that is reused for query
+   * sets of the same size does not allocate any memory.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param k Number of neighbors to search for.
+   * @param metric Instantiated metric.
+   * @param epsilon Relative approximate error.
+   * @param sameSet If true, the query and reference set are taken to be the
+   *      same, and a query point will not return itself in the results.
+   * @param candidateStorage Storage for the candidate lists.
+   */
+  NeighborSearchRules(const typename TreeType::Mat& referenceSet,
+                      const typename TreeType::Mat& querySet,
+                      const size_t k,
+                      MetricType& metric,
+                      const double epsilon,
+                      const bool sameSet,
+                      std::vector<CandidateList>& candidateStorage);
+
+  /**
+   * Construct a NeighborSearchRules object that shares the candidate lists of
+   * the given NeighborSearchRules object, but has its own traversal info and
+   * its own base case and score counters.  This is used by parallel
+   * traversals, where each thread needs its own rules object but all results
+   * must end up in the same place.  Two rules objects that share candidates
+   * must never work on the same query point at the same time.
+   *
+   * @param other NeighborSearchRules object whose candidates will be shared.
+   */
+  NeighborSearchRules(NeighborSearchRules& other);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -61,7 +116,27 @@ class NeighborSearchRules
    * @param distances Matrix storing distances of neighbors for each query
    *     point.
    */
-  void GetResults(arma::Mat<size_t>& neighbors, arma::mat& distances);
+  template<typename IndexType>
+  void GetResults(arma::Mat<IndexType>& neighbors, arma::mat& distances);
+
+  /**
+   * Restrict the search with a filter: query point i may only get the
+   * reference points r for which eligible[queryGroups[i]][r] is true.  The
+   * indices are those of the query and reference sets given to the rules.  The
+   * filter must stay alive until the search is finished.
+   *
+   * If useNodeSummaries is true, the EligibleGroups() of the statistic of each
+   * reference node must hold, for each group, whether any point of the node (or
+   * of its descendants) is eligible for the group; Score() then prunes the
+   * nodes with no eligible point for the query.
+   *
+   * @param queryGroups Group of each query point.
+   * @param eligible For each group, whether each reference point is eligible.
+   * @param useNodeSummaries Whether the node statistics summarize the filter.
+   */
+  void Filter(const arma::Row<size_t>& queryGroups,
+              const std::vector<std::vector<bool>>& eligible,
+              const bool useNodeSummaries);
 
   /**
    * Get the distance from the query point to the reference point.
@@ -73,6 +148,41 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between each of the given query points and each of
+   * the reference points in [referenceBegin, referenceBegin + referenceCount),
+   * exactly as if BaseCase() were called for each pair.  For the Euclidean
+   * distance on high-dimensional data, a single matrix multiplication is used
+   * to find the pairs that cannot improve the candidate lists, and the exact
+   * distance is only computed for the other pairs.
+   *
+   * @param queryIndices Indices of query points.
+   * @param referenceBegin Index of the first reference point.
+   * @param referenceCount Number of reference points.
+   */
+  void BaseCaseBlock(const std::vector<size_t>& queryIndices,
+                     const size_t referenceBegin,
+                     const size_t referenceCount);
+
+  /**
+   * Compute the base cases between the points [firstBegin, firstBegin +
+   * firstCount) and [secondBegin, secondBegin + secondCount) of the reference
+   * set in both directions, for monochromatic search: each distance is
+   * calculated once and offered to the candidate lists of both points.  If the
+   * two ranges are the same, each pair of distinct points in the range is
+   * calculated once.  As in BaseCaseBlock(), a matrix multiplication is used
+   * to skip the pairs that cannot improve either candidate list when possible.
+   *
+   * @param firstBegin Index of the first point of the first range.
+   * @param firstCount Number of points in the first range.
+   * @param secondBegin Index of the first point of the second range.
+   * @param secondCount Number of points in the second range.
+   */
+  void SymmetricBaseCaseBlock(const size_t firstBegin,
+                              const size_t firstCount,
+                              const size_t secondBegin,
+                              const size_t secondCount);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -164,23 +274,12 @@ class NeighborSearchRules
   //! The query set.
   const typename TreeType::Mat& querySet;
 
-  //! Candidate represents a possible candidate neighbor (distance, index).
-  typedef std::pair<double, size_t> Candidate;
+  //! Set of candidate neighbors for each point, if this object owns them.
+  std::vector<CandidateList> ownedCandidates;
 
-  //! Compare two candidates based on the distance.
-  struct CandidateCmp {
-    bool operator()(const Candidate& c1, const Candidate& c2)
-    {
-      return !SortPolicy::IsBetter(c2.first, c1.first);
-    };
-  };
-
-  //! Use a priority queue to represent the list of candidate neighbors.
-  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-      CandidateList;
-
-  //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  //! Set of candidate neighbors for each point (these may be shared with
+  //! another NeighborSearchRules object).
+  std::vector<CandidateList>& candidates;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -201,6 +300,14 @@ class NeighborSearchRules
   //! The last base case result.
   double lastBaseCase;
 
+  //! The group of each query point, if the search is filtered.
+  const arma::Row<size_t>* queryGroups;
+  //! For each group, whether each reference point is eligible, if the search
+  //! is filtered.
+  const std::vector<std::vector<bool>>* eligible;
+  //! Whether the node statistics summarize the filter.
+  bool useNodeSummaries;
+
   //! The number of base cases that have been performed.
   size_t baseCases;
   //! The number of scores that have been performed.
@@ -215,6 +322,52 @@ class NeighborSearchRules
    */
   double CalculateBound(TreeType& queryNode) const;
 
+  //! True if BaseCaseBlock() can use BlockSquaredDistances(): the search is for
+  //! nearest or furthest neighbors, with the Euclidean distance, on dense
+  //! double data.
+  typedef std::integral_constant<bool,
+      (std::is_same<SortPolicy, NearestNeighborSort>::value ||
+       std::is_same<SortPolicy, FurthestNeighborSort>::value) &&
+      (std::is_same<MetricType, metric::EuclideanDistance>::value ||
+       std::is_same<MetricType, metric::SquaredEuclideanDistance>::value) &&
+      std::is_same<typename TreeType::Mat, arma::mat>::value>
+      UseBlockDistances;
+
+  //! Compute the base cases of BaseCaseBlock() one pair at a time.
+  void BaseCaseBlock(const std::vector<size_t>& queryIndices,
+                     const size_t referenceBegin,
+                     const size_t referenceCount,
+                     const std::false_type /* useBlockDistances */);
+
+  //! Compute the base cases of BaseCaseBlock() with BlockSquaredDistances().
+  void BaseCaseBlock(const std::vector<size_t>& queryIndices,
+                     const size_t referenceBegin,
+                     const size_t referenceCount,
+                     const std::true_type /* useBlockDistances */);
+
+  //! Compute the base cases of SymmetricBaseCaseBlock() one pair at a time.
+  void SymmetricBaseCaseBlock(const size_t firstBegin,
+                              const size_t firstCount,
+                              const size_t secondBegin,
+                              const size_t secondCount,
+                              const std::false_type /* useBlockDistances */);
+
+  //! Compute the base cases of SymmetricBaseCaseBlock() with
+  //! BlockSquaredDistances().
+  void SymmetricBaseCaseBlock(const size_t firstBegin,
+                              const size_t firstCount,
+                              const size_t secondBegin,
+                              const size_t secondCount,
+                              const std::true_type /* useBlockDistances */);
+
+  //! Return whether the filter lets the given reference point be a neighbor
+  //! of the given query point.
+  bool Eligible(const size_t queryIndex, const size_t referenceIndex) const
+  {
+    return (eligible == NULL) ||
+        (*eligible)[(*queryGroups)[queryIndex]][referenceIndex];
+  }
+
   /**
    * Helper function to insert a point into the list of candidate points.
    *
@@ -29,12 +29,16 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const bool sameSet) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(ownedCandidates),
     k(k),
     metric(metric),
     sameSet(sameSet),
     epsilon(epsilon),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
+    queryGroups(NULL),
+    eligible(NULL),
+    useNodeSummaries(false),
     baseCases(0),
     scores(0)
 {
@@ -60,8 +64,76 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
+NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
+    const size_t k,
+    MetricType& metric,
+    const double epsilon,
+    const bool sameSet,
+    std::vector<CandidateList>& candidateStorage) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    candidates(candidateStorage),
+    k(k),
+    metric(metric),
+    sameSet(sameSet),
+    epsilon(epsilon),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    queryGroups(NULL),
+    eligible(NULL),
+    useNodeSummaries(false),
+    baseCases(0),
+    scores(0)
+{
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+
+  // Reset each of the candidate lists to k worst candidates.  Popping and
+  // pushing keeps the memory of the underlying vectors.
+  const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
+      size_t() - 1);
+
+  candidates.resize(querySet.n_cols);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    CandidateList& pqueue = candidates[i];
+    while (!pqueue.empty())
+      pqueue.pop();
+    for (size_t j = 0; j < k; ++j)
+      pqueue.push(def);
+  }
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
+    NeighborSearchRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(other.candidates),
+    k(other.k),
+    metric(other.metric),
+    sameSet(other.sameSet),
+    epsilon(other.epsilon),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    queryGroups(other.queryGroups),
+    eligible(other.eligible),
+    useNodeSummaries(other.useNodeSummaries),
+    baseCases(0),
+    scores(0)
+{
+  // As in the other constructor, the traversal info must point at something
+  // that is not NULL and not a tree node.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<typename IndexType>
 void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResults(
-    arma::Mat<size_t>& neighbors,
+    arma::Mat<IndexType>& neighbors,
     arma::mat& distances)
 {
   neighbors.set_size(k, querySet.n_cols);
@@ -79,6 +151,17 @@ void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResults(
   }
 };
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::Filter(
+    const arma::Row<size_t>& queryGroups,
+    const std::vector<std::vector<bool>>& eligible,
+    const bool useNodeSummaries)
+{
+  this->queryGroups = &queryGroups;
+  this->eligible = &eligible;
+  this->useNodeSummaries = useNodeSummaries;
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline force_inline // Absolutely MUST be inline so optimizations can happen.
 double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
@@ -89,6 +172,12 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   if (sameSet && (queryIndex == referenceIndex))
     return 0.0;
 
+  // A point that the filter excludes is never a candidate, so its distance is
+  // not needed, unless it is the centroid of a node and gives its bound.
+  const bool isEligible = Eligible(queryIndex, referenceIndex);
+  if (!isEligible && !tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+    return SortPolicy::WorstDistance();
+
   // If we have already performed this base case, then do not perform it again.
   if ((lastQueryIndex == queryIndex) && (lastReferenceIndex == referenceIndex))
     return lastBaseCase;
@@ -97,7 +186,8 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
                                     referenceSet.col(referenceIndex));
   ++baseCases;
 
-  InsertNeighbor(queryIndex, referenceIndex, distance);
+  if (isEligible)
+    InsertNeighbor(queryIndex, referenceIndex, distance);
 
   // Cache this information for the next time BaseCase() is called.
   lastQueryIndex = queryIndex;
@@ -107,12 +197,194 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   return distance;
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::BaseCaseBlock(
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount)
+{
+  BaseCaseBlock(queryIndices, referenceBegin, referenceCount,
+      UseBlockDistances());
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::BaseCaseBlock(
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    const std::false_type /* useBlockDistances */)
+{
+  for (size_t i = 0; i < queryIndices.size(); ++i)
+    for (size_t ref = referenceBegin; ref < referenceBegin + referenceCount;
+        ++ref)
+      BaseCase(queryIndices[i], ref);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::BaseCaseBlock(
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    const std::true_type /* useBlockDistances */)
+{
+  // For low-dimensional data the matrix multiplication does not pay off.
+  if (querySet.n_rows < tree::blockDistanceMinDimensionality)
+  {
+    BaseCaseBlock(queryIndices, referenceBegin, referenceCount,
+        std::false_type());
+    return;
+  }
+
+  arma::mat squaredDistances, maxErrors;
+  tree::BlockSquaredDistances(querySet, queryIndices, referenceSet,
+      referenceBegin, referenceCount, squaredDistances, maxErrors);
+
+  for (size_t j = 0; j < queryIndices.size(); ++j)
+  {
+    const size_t queryIndex = queryIndices[j];
+    for (size_t i = 0; i < referenceCount; ++i)
+    {
+      const size_t referenceIndex = referenceBegin + i;
+
+      // These are the same checks as in BaseCase().
+      if (sameSet && (queryIndex == referenceIndex))
+        continue;
+      if ((lastQueryIndex == queryIndex) &&
+          (lastReferenceIndex == referenceIndex))
+        continue;
+      if (!Eligible(queryIndex, referenceIndex))
+        continue;
+
+      ++baseCases;
+
+      // If even the best possible distance to this reference point (the
+      // smallest one for nearest neighbors, the largest one for furthest
+      // neighbors) is worse than the k'th best candidate, it can't be
+      // inserted, so there is no need to calculate the distance exactly.
+      const double bound = candidates[queryIndex].top().first;
+      const double squaredBound = MetricType::TakeRoot ? bound * bound : bound;
+      const double bestSquaredDistance =
+          std::is_same<SortPolicy, FurthestNeighborSort>::value ?
+          squaredDistances(i, j) + maxErrors(i, j) :
+          squaredDistances(i, j) - maxErrors(i, j);
+      if (!SortPolicy::IsBetter(bestSquaredDistance, squaredBound))
+        continue;
+
+      const double distance = metric.Evaluate(querySet.col(queryIndex),
+                                              referenceSet.col(referenceIndex));
+      InsertNeighbor(queryIndex, referenceIndex, distance);
+
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceIndex;
+      lastBaseCase = distance;
+    }
+  }
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+SymmetricBaseCaseBlock(const size_t firstBegin,
+                       const size_t firstCount,
+                       const size_t secondBegin,
+                       const size_t secondCount)
+{
+  SymmetricBaseCaseBlock(firstBegin, firstCount, secondBegin, secondCount,
+      UseBlockDistances());
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+SymmetricBaseCaseBlock(const size_t firstBegin,
+                       const size_t firstCount,
+                       const size_t secondBegin,
+                       const size_t secondCount,
+                       const std::false_type /* useBlockDistances */)
+{
+  for (size_t a = firstBegin; a < firstBegin + firstCount; ++a)
+  {
+    // Within a single range, only the pairs with a < b are needed.
+    const size_t begin = (firstBegin == secondBegin) ? a + 1 : secondBegin;
+    for (size_t b = begin; b < secondBegin + secondCount; ++b)
+    {
+      ++baseCases;
+
+      const double distance = metric.Evaluate(querySet.col(a),
+                                              referenceSet.col(b));
+      InsertNeighbor(a, b, distance);
+      InsertNeighbor(b, a, distance);
+    }
+  }
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+SymmetricBaseCaseBlock(const size_t firstBegin,
+                       const size_t firstCount,
+                       const size_t secondBegin,
+                       const size_t secondCount,
+                       const std::true_type /* useBlockDistances */)
+{
+  // For low-dimensional data the matrix multiplication does not pay off.
+  if (querySet.n_rows < tree::blockDistanceMinDimensionality)
+  {
+    SymmetricBaseCaseBlock(firstBegin, firstCount, secondBegin, secondCount,
+        std::false_type());
+    return;
+  }
+
+  std::vector<size_t> firstIndices(firstCount);
+  for (size_t j = 0; j < firstCount; ++j)
+    firstIndices[j] = firstBegin + j;
+
+  arma::mat squaredDistances, maxErrors;
+  tree::BlockSquaredDistances(querySet, firstIndices, referenceSet,
+      secondBegin, secondCount, squaredDistances, maxErrors);
+
+  for (size_t j = 0; j < firstCount; ++j)
+  {
+    const size_t a = firstBegin + j;
+
+    // Within a single range, only the pairs with a < b are needed.
+    const size_t begin = (firstBegin == secondBegin) ? j + 1 : 0;
+    for (size_t i = begin; i < secondCount; ++i)
+    {
+      const size_t b = secondBegin + i;
+      ++baseCases;
+
+      // The pair can be skipped if it can improve neither candidate list, so
+      // compare against the worse of the two k'th best candidates.
+      const double firstBound = candidates[a].top().first;
+      const double secondBound = candidates[b].top().first;
+      const double bound = SortPolicy::IsBetter(firstBound, secondBound) ?
+          secondBound : firstBound;
+      const double squaredBound = MetricType::TakeRoot ? bound * bound : bound;
+      const double bestSquaredDistance =
+          std::is_same<SortPolicy, FurthestNeighborSort>::value ?
+          squaredDistances(i, j) + maxErrors(i, j) :
+          squaredDistances(i, j) - maxErrors(i, j);
+      if (!SortPolicy::IsBetter(bestSquaredDistance, squaredBound))
+        continue;
+
+      const double distance = metric.Evaluate(querySet.col(a),
+                                              referenceSet.col(b));
+      InsertNeighbor(a, b, distance);
+      InsertNeighbor(b, a, distance);
+    }
+  }
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     const size_t queryIndex,
     TreeType& referenceNode)
 {
   ++scores; // Count number of Score() calls.
+
+  // Prune the nodes that hold no point that the filter lets through.
+  if (useNodeSummaries &&
+      !referenceNode.Stat().EligibleGroups()[(*queryGroups)[queryIndex]])
+    return DBL_MAX;
+
   double distance;
   if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
   {
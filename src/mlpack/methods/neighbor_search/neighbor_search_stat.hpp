@@ -20,7 +20,8 @@ namespace neighbor {
 
 /**
  * Extra data for each node in the tree.  For neighbor searches, each node only
- * needs to store a bound on neighbor distances.
+ * needs to store a bound on neighbor distances, and, during a filtered search,
+ * which groups of query points the node has eligible points for.
  */
 template<typename SortPolicy>
 class NeighborSearchStat
@@ -39,6 +40,10 @@ class NeighborSearchStat
   double auxBound;
   //! The last distance evaluation.
   double lastDistance;
+  //! For each group of a filtered search, whether any point of the node may be
+  //! returned (see NeighborSearch::Search()).  This is only set for the
+  //! duration of a filtered search, and is not serialized.
+  std::vector<bool> eligibleGroups;
 
  public:
   /**
@@ -89,6 +94,10 @@ class NeighborSearchStat
   double LastDistance() const { return lastDistance; }
   //! Modify the last distance calculation.
   double& LastDistance() { return lastDistance; }
+  //! Get the eligible groups of a filtered search.
+  const std::vector<bool>& EligibleGroups() const { return eligibleGroups; }
+  //! Modify the eligible groups of a filtered search.
+  std::vector<bool>& EligibleGroups() { return eligibleGroups; }
 
   //! Serialize the statistic to/from an archive.
   template<typename Archive>
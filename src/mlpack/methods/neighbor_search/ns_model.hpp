@@ -32,14 +32,15 @@ namespace neighbor {
 template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
 using NSType = NeighborSearch<SortPolicy,
                               metric::EuclideanDistance,
-                              arma::mat,
+                              MatType,
                               TreeType,
                               TreeType<metric::EuclideanDistance,
                                   NeighborSearchStat<SortPolicy>,
-                                  arma::mat>::template DualTreeTraverser>;
+                                  MatType>::template DualTreeTraverser>;
 
 template<typename SortPolicy>
 struct NSModelName
@@ -94,12 +95,12 @@ class MonoSearchVisitor : public boost::static_visitor<void>
  * accept leafSize as a parameter. In these cases, before doing neighbor search,
  * a query tree with proper leafSize is built from the querySet.
  */
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType = arma::mat>
 class BiSearchVisitor : public boost::static_visitor<void>
 {
  private:
   //! The query set for the bichromatic search.
-  const arma::mat& querySet;
+  const MatType& querySet;
   //! The number of neighbors to search for.
   const size_t k;
   //! The result matrix for neighbors.
@@ -122,7 +123,10 @@ class BiSearchVisitor : public boost::static_visitor<void>
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
-  using NSTypeT = NSType<SortPolicy, TreeType>;
+  using NSTypeT = NSType<SortPolicy, TreeType, MatType>;
+
+  //! The type of spill tree search used for this matrix type.
+  typedef DefeatistKNN<tree::SPTree, MatType> SpillKNNType;
 
   //! Default Bichromatic neighbor search on the given NSType instance.
   template<template<typename TreeMetricType,
@@ -137,13 +141,13 @@ class BiSearchVisitor : public boost::static_visitor<void>
   void operator()(NSTypeT<tree::BallTree>* ns) const;
 
   //! Bichromatic neighbor search specialized for SPTrees.
-  void operator()(SpillKNN* ns) const;
+  void operator()(SpillKNNType* ns) const;
 
   //! Bichromatic neighbor search specialized for octrees.
   void operator()(NSTypeT<tree::Octree>* ns) const;
 
   //! Construct the BiSearchVisitor.
-  BiSearchVisitor(const arma::mat& querySet,
+  BiSearchVisitor(const MatType& querySet,
                   const size_t k,
                   arma::Mat<size_t>& neighbors,
                   arma::mat& distances,
@@ -158,12 +162,12 @@ class BiSearchVisitor : public boost::static_visitor<void>
  * accept leafSize as a parameter. In these cases, a reference tree with proper
  * leafSize is built from the referenceSet.
  */
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType = arma::mat>
 class TrainVisitor : public boost::static_visitor<void>
 {
  private:
   //! The reference set to use for training.
-  arma::mat&& referenceSet;
+  MatType&& referenceSet;
   //! The leaf size, used only by BinarySpaceTree.
   size_t leafSize;
   //! Overlapping size (for spill trees).
@@ -180,7 +184,10 @@ class TrainVisitor : public boost::static_visitor<void>
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
-  using NSTypeT = NSType<SortPolicy, TreeType>;
+  using NSTypeT = NSType<SortPolicy, TreeType, MatType>;
+
+  //! The type of spill tree search used for this matrix type.
+  typedef DefeatistKNN<tree::SPTree, MatType> SpillKNNType;
 
   //! Default Train on the given NSType instance.
   template<template<typename TreeMetricType,
@@ -195,14 +202,14 @@ class TrainVisitor : public boost::static_visitor<void>
   void operator()(NSTypeT<tree::BallTree>* ns) const;
 
   //! Train specialized for SPTrees.
-  void operator()(SpillKNN* ns) const;
+  void operator()(SpillKNNType* ns) const;
 
   //! Train specialized for octrees.
   void operator()(NSTypeT<tree::Octree>* ns) const;
 
   //! Construct the TrainVisitor object with the given reference set, leafSize
   //! for BinarySpaceTrees, and tau and rho for spill trees.
-  TrainVisitor(arma::mat&& referenceSet,
+  TrainVisitor(MatType&& referenceSet,
                const size_t leafSize,
                const double tau,
                const double rho);
@@ -230,15 +237,71 @@ class EpsilonVisitor : public boost::static_visitor<double&>
   double& operator()(NSType *ns) const;
 };
 
+/**
+ * ReorderQueriesVisitor exposes the ReorderQueries method of the given NSType.
+ */
+class ReorderQueriesVisitor : public boost::static_visitor<bool&>
+{
+ public:
+  //! Return whether the query points are traversed in Hilbert curve order.
+  template<typename NSType>
+  bool& operator()(NSType *ns) const;
+};
+
+/**
+ * MaxLeavesVisitor exposes the MaxLeaves method of the given NSType.
+ */
+class MaxLeavesVisitor : public boost::static_visitor<size_t&>
+{
+ public:
+  //! Return the maximum number of leaves of best-first search.
+  template<typename NSType>
+  size_t& operator()(NSType *ns) const;
+};
+
+/**
+ * TimeLimitVisitor exposes the TimeLimit method of the given NSType.
+ */
+class TimeLimitVisitor : public boost::static_visitor<double&>
+{
+ public:
+  //! Return the time limit of best-first search.
+  template<typename NSType>
+  double& operator()(NSType *ns) const;
+};
+
+/**
+ * BaseCasesVisitor exposes the BaseCases() method of the given NSType.
+ */
+class BaseCasesVisitor : public boost::static_visitor<size_t>
+{
+ public:
+  //! Return the number of base cases of the last search.
+  template<typename NSType>
+  size_t operator()(NSType *ns) const;
+};
+
+/**
+ * ScoresVisitor exposes the Scores() method of the given NSType.
+ */
+class ScoresVisitor : public boost::static_visitor<size_t>
+{
+ public:
+  //! Return the number of node combinations scored in the last search.
+  template<typename NSType>
+  size_t operator()(NSType *ns) const;
+};
+
 /**
  * ReferenceSetVisitor exposes the referenceSet of the given NSType.
  */
-class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
+template<typename MatType = arma::mat>
+class ReferenceSetVisitor : public boost::static_visitor<const MatType&>
 {
  public:
   //! Return the reference set.
   template<typename NSType>
-  const arma::mat& operator()(NSType *ns) const;
+  const MatType& operator()(NSType *ns) const;
 };
 
 /**
@@ -260,9 +323,14 @@ class DeleteVisitor : public boost::static_visitor<void>
  * flexibility as the NeighborSearch class.  So if you are using it outside of
  * mlpack_knn and mlpack_kfn, be aware that it is limited!
  *
+ * The reference and query sets (and the trees built on them) are held as
+ * MatType; use arma::fmat to store them in single precision, which halves the
+ * memory used by the model.  Distances are always returned as arma::mat.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam MatType The type of matrix the points are held in.
  */
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType = arma::mat>
 class NSModel
 {
  public:
@@ -301,28 +369,31 @@ class NSModel
   //! If true, random projections are used.
   bool randomBasis;
   //! This is the random projection matrix; only used if randomBasis is true.
-  arma::mat q;
+  MatType q;
+  //! The linear transformation applied to the points before anything else, or
+  //! an empty matrix.
+  MatType transformation;
 
   /**
    * nSearch holds an instance of the NeigborSearch class for the current
    * treeType. It is initialized every time BuildModel is executed.
    * We access to the contained value through the visitor classes defined above.
    */
-  boost::variant<NSType<SortPolicy, tree::KDTree>*,
-                 NSType<SortPolicy, tree::StandardCoverTree>*,
-                 NSType<SortPolicy, tree::RTree>*,
-                 NSType<SortPolicy, tree::RStarTree>*,
-                 NSType<SortPolicy, tree::BallTree>*,
-                 NSType<SortPolicy, tree::XTree>*,
-                 NSType<SortPolicy, tree::HilbertRTree>*,
-                 NSType<SortPolicy, tree::RPlusTree>*,
-                 NSType<SortPolicy, tree::RPlusPlusTree>*,
-                 NSType<SortPolicy, tree::VPTree>*,
-                 NSType<SortPolicy, tree::RPTree>*,
-                 NSType<SortPolicy, tree::MaxRPTree>*,
-                 SpillKNN*,
-                 NSType<SortPolicy, tree::UBTree>*,
-                 NSType<SortPolicy, tree::Octree>*> nSearch;
+  boost::variant<NSType<SortPolicy, tree::KDTree, MatType>*,
+                 NSType<SortPolicy, tree::StandardCoverTree, MatType>*,
+                 NSType<SortPolicy, tree::RTree, MatType>*,
+                 NSType<SortPolicy, tree::RStarTree, MatType>*,
+                 NSType<SortPolicy, tree::BallTree, MatType>*,
+                 NSType<SortPolicy, tree::XTree, MatType>*,
+                 NSType<SortPolicy, tree::HilbertRTree, MatType>*,
+                 NSType<SortPolicy, tree::RPlusTree, MatType>*,
+                 NSType<SortPolicy, tree::RPlusPlusTree, MatType>*,
+                 NSType<SortPolicy, tree::VPTree, MatType>*,
+                 NSType<SortPolicy, tree::RPTree, MatType>*,
+                 NSType<SortPolicy, tree::MaxRPTree, MatType>*,
+                 DefeatistKNN<tree::SPTree, MatType>*,
+                 NSType<SortPolicy, tree::UBTree, MatType>*,
+                 NSType<SortPolicy, tree::Octree, MatType>*> nSearch;
 
  public:
   /**
@@ -371,7 +442,7 @@ class NSModel
   void Serialize(Archive& ar, const unsigned int /* version */);
 
   //! Expose the dataset.
-  const arma::mat& Dataset() const;
+  const MatType& Dataset() const;
 
   //! Expose SearchMode.
   NeighborSearchMode SearchMode() const;
@@ -381,6 +452,24 @@ class NSModel
   double Epsilon() const;
   double& Epsilon();
 
+  //! Expose MaxLeaves.
+  size_t MaxLeaves() const;
+  size_t& MaxLeaves();
+
+  //! Expose TimeLimit.
+  double TimeLimit() const;
+  double& TimeLimit();
+
+  //! Expose ReorderQueries.
+  bool ReorderQueries() const;
+  bool& ReorderQueries();
+
+  //! Get the number of base cases of the last search.
+  size_t BaseCases() const;
+
+  //! Get the number of node combinations scored in the last search.
+  size_t Scores() const;
+
   //! Expose leafSize.
   size_t LeafSize() const { return leafSize; }
   size_t& LeafSize() { return leafSize; }
@@ -401,14 +490,54 @@ class NSModel
   bool RandomBasis() const { return randomBasis; }
   bool& RandomBasis() { return randomBasis; }
 
+  /**
+   * Get the linear transformation L that is applied to the reference set in
+   * BuildModel() and to the query sets in Search(), or an empty matrix if the
+   * points are not transformed.  Searching the transformed points with the
+   * Euclidean distance is the same as searching the original points with the
+   * distance d(x, y) = || L x - L y ||, like the one learned by NCA, or the
+   * Mahalanobis distance with L = MahalanobisDistance::Transformation().  The
+   * points are only transformed once, and neighbors are then found with the
+   * fast Euclidean trees and bounds.
+   */
+  const MatType& Transformation() const { return transformation; }
+  //! Modify the linear transformation (don't do this after the model has been
+  //! built).
+  MatType& Transformation() { return transformation; }
+
+  /**
+   * Choose the tree type and leaf size for the given reference set, and set
+   * TreeType() and LeafSize() to them, so that they are stored with the model.
+   * Every tree type that gives exact results (all but the spill tree, and the
+   * octree in more than ten dimensions), with leaf sizes 10, 20 and 40 where
+   * the tree takes a leaf size, is built on a random sample of the reference
+   * set, and a sample of its points is searched with the given search mode.
+   * The candidate with the smallest estimated time to build the tree on the
+   * sample and search all its points is chosen.  The transformation, random
+   * basis, tau and rho of the model are used for the candidates too.
+   *
+   * @param referenceSet Reference set the model will be built on.
+   * @param k Number of neighbors that will be searched for.
+   * @param searchMode Search mode that will be used.
+   * @param epsilon Relative error that will be used.
+   * @param sampleSize Number of reference points to build the candidates on.
+   * @param numQueries Number of sampled points to search for.
+   */
+  void SelectTree(const MatType& referenceSet,
+                  const size_t k,
+                  const NeighborSearchMode searchMode,
+                  const double epsilon = 0,
+                  const size_t sampleSize = 5000,
+                  const size_t numQueries = 500);
+
   //! Build the reference tree.
-  void BuildModel(arma::mat&& referenceSet,
+  void BuildModel(MatType&& referenceSet,
                   const size_t leafSize,
                   const NeighborSearchMode searchMode,
                   const double epsilon = 0);
 
   //! Perform neighbor search.  The query set will be reordered.
-  void Search(arma::mat&& querySet,
+  void Search(MatType&& querySet,
               const size_t k,
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
@@ -425,9 +554,23 @@ class NSModel
 } // namespace neighbor
 } // namespace mlpack
 
-//! Set the serialization version of the NSModel class.
-BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::NSModel<SortPolicy>, 1);
+//! Set the serialization version of the NSModel class.  This is what
+//! BOOST_TEMPLATE_CLASS_VERSION does, but that macro can't take a template
+//! with more than one parameter.  Version 2 added the transformation.
+namespace boost {
+namespace serialization {
+
+template<typename SortPolicy, typename MatType>
+struct version<mlpack::data::SecondShim<
+    mlpack::neighbor::NSModel<SortPolicy, MatType>>>
+{
+  typedef mpl::int_<2> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
 
 // Include implementation.
 #include "ns_model_impl.hpp"
@@ -19,6 +19,7 @@
 #include "ns_model.hpp"
 
 #include <boost/serialization/variant.hpp>
+#include <chrono>
 
 namespace mlpack {
 namespace neighbor {
@@ -33,14 +34,15 @@ void MonoSearchVisitor::operator()(NSType *ns) const
 }
 
 //! Save parameters for bichromatic neighbor search.
-template<typename SortPolicy>
-BiSearchVisitor<SortPolicy>::BiSearchVisitor(const arma::mat& querySet,
-                                             const size_t k,
-                                             arma::Mat<size_t>& neighbors,
-                                             arma::mat& distances,
-                                             const size_t leafSize,
-                                             const double tau,
-                                             const double rho) :
+template<typename SortPolicy, typename MatType>
+BiSearchVisitor<SortPolicy, MatType>::BiSearchVisitor(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    const size_t leafSize,
+    const double tau,
+    const double rho) :
     querySet(querySet),
     k(k),
     neighbors(neighbors),
@@ -51,11 +53,12 @@ BiSearchVisitor<SortPolicy>::BiSearchVisitor(const arma::mat& querySet,
 {}
 
 //! Default Bichromatic neighbor search on the given NSType instance.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<TreeType>* ns) const
 {
   if (ns)
     return ns->Search(querySet, k, neighbors, distances);
@@ -63,8 +66,9 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
 }
 
 //! Bichromatic neighbor search on the given NSType specialized for KDTrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::KDTree>* ns) const
 {
   if (ns)
     return SearchLeaf(ns);
@@ -72,8 +76,9 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
 }
 
 //! Bichromatic neighbor search on the given NSType specialized for BallTrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::BallTree>* ns) const
 {
   if (ns)
     return SearchLeaf(ns);
@@ -81,8 +86,8 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
 }
 
 //! Bichromatic neighbor search specialized for SPTrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(SpillKNN* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(SpillKNNType* ns) const
 {
   if (ns)
   {
@@ -90,7 +95,7 @@ void BiSearchVisitor<SortPolicy>::operator()(SpillKNN* ns) const
     {
       // For Dual Tree Search on SpillTrees, the queryTree must be built with
       // non overlapping (tau = 0).
-      typename SpillKNN::Tree queryTree(std::move(querySet), 0 /* tau*/,
+      typename SpillKNNType::Tree queryTree(std::move(querySet), 0 /* tau*/,
           leafSize, rho);
       ns->Search(queryTree, k, neighbors, distances);
     }
@@ -102,8 +107,9 @@ void BiSearchVisitor<SortPolicy>::operator()(SpillKNN* ns) const
 }
 
 //! Bichromatic neighbor search specialized for octrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::Octree>* ns) const
 {
   if (ns)
     return SearchLeaf(ns);
@@ -111,9 +117,9 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
 }
 
 //! Bichromatic neighbor search on the given NSType considering the leafSize.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<typename NSType>
-void BiSearchVisitor<SortPolicy>::SearchLeaf(NSType* ns) const
+void BiSearchVisitor<SortPolicy, MatType>::SearchLeaf(NSType* ns) const
 {
   if (ns->SearchMode() == DUAL_TREE_MODE)
   {
@@ -139,11 +145,11 @@ void BiSearchVisitor<SortPolicy>::SearchLeaf(NSType* ns) const
 }
 
 //! Save parameters for Train.
-template<typename SortPolicy>
-TrainVisitor<SortPolicy>::TrainVisitor(arma::mat&& referenceSet,
-                                       const size_t leafSize,
-                                       const double tau,
-                                       const double rho) :
+template<typename SortPolicy, typename MatType>
+TrainVisitor<SortPolicy, MatType>::TrainVisitor(MatType&& referenceSet,
+                                                const size_t leafSize,
+                                                const double tau,
+                                                const double rho) :
     referenceSet(std::move(referenceSet)),
     leafSize(leafSize),
     tau(tau),
@@ -151,11 +157,11 @@ TrainVisitor<SortPolicy>::TrainVisitor(arma::mat&& referenceSet,
 {}
 
 //! Default Train on the given NSType instance.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
+void TrainVisitor<SortPolicy, MatType>::operator()(NSTypeT<TreeType>* ns) const
 {
   if (ns)
     return ns->Train(std::move(referenceSet));
@@ -163,8 +169,9 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
 }
 
 //! Train on the given NSType specialized for KDTrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::KDTree>* ns) const
 {
   if (ns)
     return TrainLeaf(ns);
@@ -172,8 +179,9 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
 }
 
 //! Train on the given NSType specialized for BallTrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::BallTree>* ns) const
 {
   if (ns)
     return TrainLeaf(ns);
@@ -181,8 +189,8 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
 }
 
 //! Train specialized for SPTrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(SpillKNN* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(SpillKNNType* ns) const
 {
   if (ns)
   {
@@ -190,7 +198,8 @@ void TrainVisitor<SortPolicy>::operator()(SpillKNN* ns) const
       ns->Train(std::move(referenceSet));
     else
     {
-      typename SpillKNN::Tree tree(std::move(referenceSet), tau, leafSize, rho);
+      typename SpillKNNType::Tree tree(std::move(referenceSet), tau, leafSize,
+          rho);
       ns->Train(std::move(tree));
     }
   }
@@ -199,8 +208,9 @@ void TrainVisitor<SortPolicy>::operator()(SpillKNN* ns) const
 }
 
 //! Train specialized for Octrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::Octree>* ns) const
 {
   if (ns)
     return TrainLeaf(ns);
@@ -208,9 +218,9 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
 }
 
 //! Train on the given NSType considering the leafSize.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<typename NSType>
-void TrainVisitor<SortPolicy>::TrainLeaf(NSType* ns) const
+void TrainVisitor<SortPolicy, MatType>::TrainLeaf(NSType* ns) const
 {
   if (ns->SearchMode() == NAIVE_MODE)
     ns->Train(std::move(referenceSet));
@@ -243,9 +253,55 @@ double& EpsilonVisitor::operator()(NSType* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Expose the MaxLeaves method of the given NSType.
+template<typename NSType>
+size_t& MaxLeavesVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->MaxLeaves();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Expose the TimeLimit method of the given NSType.
+template<typename NSType>
+double& TimeLimitVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->TimeLimit();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Expose the ReorderQueries method of the given NSType.
+template<typename NSType>
+bool& ReorderQueriesVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->ReorderQueries();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Return the number of base cases of the given NSType.
+template<typename NSType>
+size_t BaseCasesVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->BaseCases();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Return the number of scores of the given NSType.
+template<typename NSType>
+size_t ScoresVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->Scores();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Expose the referenceSet of the given NSType.
+template<typename MatType>
 template<typename NSType>
-const arma::mat& ReferenceSetVisitor::operator()(NSType* ns) const
+const MatType& ReferenceSetVisitor<MatType>::operator()(NSType* ns) const
 {
   if (ns)
     return ns->ReferenceSet();
@@ -264,8 +320,8 @@ void DeleteVisitor::operator()(NSType* ns) const
  * Initialize the NSModel with the given type and whether or not a random
  * basis should be used.
  */
-template<typename SortPolicy>
-NSModel<SortPolicy>::NSModel(TreeTypes treeType, bool randomBasis) :
+template<typename SortPolicy, typename MatType>
+NSModel<SortPolicy, MatType>::NSModel(TreeTypes treeType, bool randomBasis) :
     treeType(treeType),
     leafSize(20),
     tau(0),
@@ -275,27 +331,29 @@ NSModel<SortPolicy>::NSModel(TreeTypes treeType, bool randomBasis) :
   // Nothing to do.
 }
 
-template<typename SortPolicy>
-NSModel<SortPolicy>::NSModel(const NSModel& other) :
+template<typename SortPolicy, typename MatType>
+NSModel<SortPolicy, MatType>::NSModel(const NSModel& other) :
     treeType(other.treeType),
     leafSize(other.leafSize),
     tau(other.tau),
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(other.q),
+    transformation(other.transformation),
     nSearch(other.nSearch)
 {
   // Nothing to do.
 }
 
-template<typename SortPolicy>
-NSModel<SortPolicy>::NSModel(NSModel&& other) :
+template<typename SortPolicy, typename MatType>
+NSModel<SortPolicy, MatType>::NSModel(NSModel&& other) :
     treeType(other.treeType),
     leafSize(other.leafSize),
     tau(other.tau),
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(std::move(other.q)),
+    transformation(std::move(other.transformation)),
     nSearch(other.nSearch)
 {
   // Reset parameters of the other model.
@@ -307,8 +365,9 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
   other.nSearch = decltype(other.nSearch)();
 }
 
-template<typename SortPolicy>
-NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
+template<typename SortPolicy, typename MatType>
+NSModel<SortPolicy, MatType>& NSModel<SortPolicy, MatType>::operator=(
+    const NSModel& other)
 {
   boost::apply_visitor(DeleteVisitor(), nSearch);
 
@@ -318,13 +377,15 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
   rho = other.rho;
   randomBasis = other.randomBasis;
   q = other.q;
+  transformation = other.transformation;
   nSearch = other.nSearch;
 
   return *this;
 }
 
-template<typename SortPolicy>
-NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
+template<typename SortPolicy, typename MatType>
+NSModel<SortPolicy, MatType>& NSModel<SortPolicy, MatType>::operator=(
+    NSModel&& other)
 {
   boost::apply_visitor(DeleteVisitor(), nSearch);
 
@@ -334,6 +395,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   rho = other.rho;
   randomBasis = other.randomBasis;
   q = std::move(other.q);
+  transformation = std::move(other.transformation);
   // Copy the pointer and type.
   nSearch = other.nSearch;
 
@@ -349,8 +411,8 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
 }
 
 //! Clean memory, if necessary.
-template<typename SortPolicy>
-NSModel<SortPolicy>::~NSModel()
+template<typename SortPolicy, typename MatType>
+NSModel<SortPolicy, MatType>::~NSModel()
 {
   boost::apply_visitor(DeleteVisitor(), nSearch);
 }
@@ -362,6 +424,7 @@ NSModel<SortPolicy>::~NSModel()
  */
 template<typename Archive,
          typename SortPolicy,
+         typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
@@ -371,7 +434,7 @@ void serialize(
     Archive& ar,
     NeighborSearch<SortPolicy,
                    metric::EuclideanDistance,
-                   arma::mat,
+                   MatType,
                    TreeType,
                    TraversalType,
                    SingleTreeTraversalType>& ns,
@@ -381,9 +444,10 @@ void serialize(
 }
 
 //! Serialize the kNN model.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<typename Archive>
-void NSModel<SortPolicy>::Serialize(Archive& ar, const unsigned int version)
+void NSModel<SortPolicy, MatType>::Serialize(Archive& ar,
+                                             const unsigned int version)
 {
   ar & data::CreateNVP(treeType, "treeType");
   // Backward compatibility: older versions of NSModel didn't include these
@@ -396,6 +460,11 @@ void NSModel<SortPolicy>::Serialize(Archive& ar, const unsigned int version)
   }
   ar & data::CreateNVP(randomBasis, "randomBasis");
   ar & data::CreateNVP(q, "q");
+  // Older versions of NSModel didn't have a transformation.
+  if (version > 1)
+    ar & data::CreateNVP(transformation, "transformation");
+  else if (Archive::is_loading::value)
+    transformation.clear();
 
   // This should never happen, but just in case, be clean with memory.
   if (Archive::is_loading::value)
@@ -406,46 +475,112 @@ void NSModel<SortPolicy>::Serialize(Archive& ar, const unsigned int version)
 }
 
 //! Expose the dataset.
-template<typename SortPolicy>
-const arma::mat& NSModel<SortPolicy>::Dataset() const
+template<typename SortPolicy, typename MatType>
+const MatType& NSModel<SortPolicy, MatType>::Dataset() const
 {
-  return boost::apply_visitor(ReferenceSetVisitor(), nSearch);
+  return boost::apply_visitor(ReferenceSetVisitor<MatType>(), nSearch);
 }
 
 //! Access the search mode.
-template<typename SortPolicy>
-NeighborSearchMode NSModel<SortPolicy>::SearchMode() const
+template<typename SortPolicy, typename MatType>
+NeighborSearchMode NSModel<SortPolicy, MatType>::SearchMode() const
 {
   return boost::apply_visitor(SearchModeVisitor(), nSearch);
 }
 
 //! Modify the search mode.
-template<typename SortPolicy>
-NeighborSearchMode& NSModel<SortPolicy>::SearchMode()
+template<typename SortPolicy, typename MatType>
+NeighborSearchMode& NSModel<SortPolicy, MatType>::SearchMode()
 {
   return boost::apply_visitor(SearchModeVisitor(), nSearch);
 }
 
-template<typename SortPolicy>
-double NSModel<SortPolicy>::Epsilon() const
+template<typename SortPolicy, typename MatType>
+double NSModel<SortPolicy, MatType>::Epsilon() const
 {
   return boost::apply_visitor(EpsilonVisitor(), nSearch);
 }
 
-template<typename SortPolicy>
-double& NSModel<SortPolicy>::Epsilon()
+template<typename SortPolicy, typename MatType>
+double& NSModel<SortPolicy, MatType>::Epsilon()
 {
   return boost::apply_visitor(EpsilonVisitor(), nSearch);
 }
 
+template<typename SortPolicy, typename MatType>
+size_t NSModel<SortPolicy, MatType>::MaxLeaves() const
+{
+  return boost::apply_visitor(MaxLeavesVisitor(), nSearch);
+}
+
+template<typename SortPolicy, typename MatType>
+size_t& NSModel<SortPolicy, MatType>::MaxLeaves()
+{
+  return boost::apply_visitor(MaxLeavesVisitor(), nSearch);
+}
+
+template<typename SortPolicy, typename MatType>
+double NSModel<SortPolicy, MatType>::TimeLimit() const
+{
+  return boost::apply_visitor(TimeLimitVisitor(), nSearch);
+}
+
+template<typename SortPolicy, typename MatType>
+double& NSModel<SortPolicy, MatType>::TimeLimit()
+{
+  return boost::apply_visitor(TimeLimitVisitor(), nSearch);
+}
+
+template<typename SortPolicy, typename MatType>
+bool NSModel<SortPolicy, MatType>::ReorderQueries() const
+{
+  return boost::apply_visitor(ReorderQueriesVisitor(), nSearch);
+}
+
+template<typename SortPolicy, typename MatType>
+bool& NSModel<SortPolicy, MatType>::ReorderQueries()
+{
+  return boost::apply_visitor(ReorderQueriesVisitor(), nSearch);
+}
+
+template<typename SortPolicy, typename MatType>
+size_t NSModel<SortPolicy, MatType>::BaseCases() const
+{
+  return boost::apply_visitor(BaseCasesVisitor(), nSearch);
+}
+
+template<typename SortPolicy, typename MatType>
+size_t NSModel<SortPolicy, MatType>::Scores() const
+{
+  return boost::apply_visitor(ScoresVisitor(), nSearch);
+}
+
 //! Build the reference tree.
-template<typename SortPolicy>
-void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
-                                     const size_t leafSize,
-                                     const NeighborSearchMode searchMode,
-                                     const double epsilon)
+template<typename SortPolicy, typename MatType>
+void NSModel<SortPolicy, MatType>::BuildModel(
+    MatType&& referenceSet,
+    const size_t leafSize,
+    const NeighborSearchMode searchMode,
+    const double epsilon)
 {
   this->leafSize = leafSize;
+
+  // Apply the transformation first, so that the random basis is built in the
+  // space of the transformed points.
+  if (!transformation.is_empty())
+  {
+    if (transformation.n_cols != referenceSet.n_rows)
+    {
+      std::ostringstream oss;
+      oss << "NSModel::BuildModel(): the transformation has "
+          << transformation.n_cols << " columns, but the reference set has "
+          << referenceSet.n_rows << " dimensions";
+      throw std::invalid_argument(oss.str());
+    }
+
+    referenceSet = transformation * referenceSet;
+  }
+
   // Initialize random basis if necessary.
   if (randomBasis)
   {
@@ -454,11 +589,11 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
     {
       // [Q, R] = qr(randn(d, d));
       // Q = Q * diag(sign(diag(R)));
-      arma::mat r;
-      if (arma::qr(q, r, arma::randn<arma::mat>(referenceSet.n_rows,
+      MatType r;
+      if (arma::qr(q, r, arma::randn<MatType>(referenceSet.n_rows,
               referenceSet.n_rows)))
       {
-        arma::vec rDiag(r.n_rows);
+        arma::Col<typename MatType::elem_type> rDiag(r.n_rows);
         for (size_t i = 0; i < rDiag.n_elem; ++i)
         {
           if (r(i, i) < 0)
@@ -494,55 +629,68 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   switch (treeType)
   {
     case KD_TREE:
-      nSearch = new NSType<SortPolicy, tree::KDTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::KDTree, MatType>(
+          searchMode, epsilon);
       break;
     case COVER_TREE:
-      nSearch = new NSType<SortPolicy, tree::StandardCoverTree>(searchMode,
-          epsilon);
+      nSearch = new NSType<SortPolicy, tree::StandardCoverTree, MatType>(
+          searchMode, epsilon);
       break;
     case R_TREE:
-      nSearch = new NSType<SortPolicy, tree::RTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::RTree, MatType>(
+          searchMode, epsilon);
       break;
     case R_STAR_TREE:
-      nSearch = new NSType<SortPolicy, tree::RStarTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::RStarTree, MatType>(
+          searchMode, epsilon);
       break;
     case BALL_TREE:
-      nSearch = new NSType<SortPolicy, tree::BallTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::BallTree, MatType>(
+          searchMode, epsilon);
       break;
     case X_TREE:
-      nSearch = new NSType<SortPolicy, tree::XTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::XTree, MatType>(
+          searchMode, epsilon);
       break;
     case HILBERT_R_TREE:
-      nSearch = new NSType<SortPolicy, tree::HilbertRTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::HilbertRTree, MatType>(
+          searchMode, epsilon);
       break;
     case R_PLUS_TREE:
-      nSearch = new NSType<SortPolicy, tree::RPlusTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::RPlusTree, MatType>(
+          searchMode, epsilon);
       break;
     case R_PLUS_PLUS_TREE:
-      nSearch = new NSType<SortPolicy, tree::RPlusPlusTree>(searchMode,
+      nSearch = new NSType<SortPolicy, tree::RPlusPlusTree, MatType>(searchMode,
           epsilon);
       break;
     case VP_TREE:
-      nSearch = new NSType<SortPolicy, tree::VPTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::VPTree, MatType>(
+          searchMode, epsilon);
       break;
     case RP_TREE:
-      nSearch = new NSType<SortPolicy, tree::RPTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::RPTree, MatType>(
+          searchMode, epsilon);
       break;
     case MAX_RP_TREE:
-      nSearch = new NSType<SortPolicy, tree::MaxRPTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::MaxRPTree, MatType>(
+          searchMode, epsilon);
       break;
     case SPILL_TREE:
-      nSearch = new SpillKNN(searchMode, epsilon);
+      nSearch = new DefeatistKNN<tree::SPTree, MatType>(searchMode, epsilon);
       break;
     case UB_TREE:
-      nSearch = new NSType<SortPolicy, tree::UBTree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::UBTree, MatType>(
+          searchMode, epsilon);
       break;
     case OCTREE:
-      nSearch = new NSType<SortPolicy, tree::Octree>(searchMode, epsilon);
+      nSearch = new NSType<SortPolicy, tree::Octree, MatType>(
+          searchMode, epsilon);
       break;
   }
 
-  TrainVisitor<SortPolicy> tn(std::move(referenceSet), leafSize, tau, rho);
+  TrainVisitor<SortPolicy, MatType> tn(std::move(referenceSet), leafSize, tau,
+      rho);
   boost::apply_visitor(tn, nSearch);
 
   if (searchMode != NAIVE_MODE)
@@ -552,14 +700,122 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   }
 }
 
-//! Perform neighbor search.  The query set will be reordered.
-template<typename SortPolicy>
-void NSModel<SortPolicy>::Search(arma::mat&& querySet,
-                                 const size_t k,
-                                 arma::Mat<size_t>& neighbors,
-                                 arma::mat& distances)
+//! Choose the tree type and leaf size.
+template<typename SortPolicy, typename MatType>
+void NSModel<SortPolicy, MatType>::SelectTree(
+    const MatType& referenceSet,
+    const size_t k,
+    const NeighborSearchMode searchMode,
+    const double epsilon,
+    const size_t sampleSize,
+    const size_t numQueries)
 {
-  // We may need to map the query set randomly.
+  if (referenceSet.n_cols == 0)
+  {
+    throw std::invalid_argument("NSModel::SelectTree(): the reference set is "
+        "empty");
+  }
+
+  const size_t numSamples = std::min(sampleSize, referenceSet.n_cols);
+  const size_t numSampleQueries = std::max(std::min(numQueries, numSamples),
+      (size_t) 1);
+  if (k == 0 || k > numSamples)
+  {
+    std::ostringstream oss;
+    oss << "NSModel::SelectTree(): k must be between 1 and the number of "
+        << "sampled points (" << numSamples << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+      referenceSet.n_cols - 1, referenceSet.n_cols));
+  const MatType sample = referenceSet.cols(order.head(numSamples));
+  const MatType querySample = sample.head_cols(numSampleQueries);
+
+  std::vector<std::pair<TreeTypes, size_t>> candidates;
+  const TreeTypes leafSizeTypes[] = { KD_TREE, BALL_TREE, VP_TREE, RP_TREE,
+      MAX_RP_TREE, UB_TREE, R_TREE, R_STAR_TREE, X_TREE, HILBERT_R_TREE,
+      R_PLUS_TREE, R_PLUS_PLUS_TREE, OCTREE };
+  for (const TreeTypes type : leafSizeTypes)
+  {
+    // An octree node has 2^d children.
+    if (type == OCTREE && referenceSet.n_rows > 10)
+      continue;
+
+    for (const size_t candidateLeafSize : { 10, 20, 40 })
+      candidates.push_back(std::make_pair(type, candidateLeafSize));
+  }
+  candidates.push_back(std::make_pair(COVER_TREE, leafSize));
+
+  // The search time of the sampled queries is scaled up to the whole sample,
+  // so that the time to build the tree is weighed against searching about as
+  // many points as it holds.
+  const double queryScale = (double) numSamples / numSampleQueries;
+  double bestCost = DBL_MAX;
+  for (size_t i = 0; i < candidates.size(); ++i)
+  {
+    NSModel candidate(candidates[i].first, randomBasis);
+    candidate.Transformation() = transformation;
+    candidate.Tau() = tau;
+    candidate.Rho() = rho;
+
+    const std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();
+    candidate.BuildModel(MatType(sample), candidates[i].second, searchMode,
+        epsilon);
+    const std::chrono::high_resolution_clock::time_point built =
+        std::chrono::high_resolution_clock::now();
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    candidate.Search(MatType(querySample), k, neighbors, distances);
+    const std::chrono::high_resolution_clock::time_point end =
+        std::chrono::high_resolution_clock::now();
+
+    const double buildTime = std::chrono::duration<double>(built -
+        start).count();
+    const double searchTime = std::chrono::duration<double>(end -
+        built).count();
+    const double cost = buildTime + queryScale * searchTime;
+    Log::Info << "NSModel::SelectTree(): " << candidate.TreeName()
+        << " with leaf size " << candidates[i].second << ": built in "
+        << buildTime << "s, searched in " << searchTime << "s ("
+        << candidate.BaseCases() << " base cases, " << candidate.Scores()
+        << " scores)." << std::endl;
+
+    if (cost < bestCost)
+    {
+      bestCost = cost;
+      treeType = candidates[i].first;
+      leafSize = candidates[i].second;
+    }
+  }
+
+  Log::Info << "NSModel::SelectTree(): selected " << TreeName()
+      << " with leaf size " << leafSize << "." << std::endl;
+}
+
+//! Perform neighbor search.  The query set will be reordered.
+template<typename SortPolicy, typename MatType>
+void NSModel<SortPolicy, MatType>::Search(MatType&& querySet,
+                                          const size_t k,
+                                          arma::Mat<size_t>& neighbors,
+                                          arma::mat& distances)
+{
+  // The query set goes through the same mappings as the reference set.
+  if (!transformation.is_empty())
+  {
+    if (transformation.n_cols != querySet.n_rows)
+    {
+      std::ostringstream oss;
+      oss << "NSModel::Search(): the transformation has "
+          << transformation.n_cols << " columns, but the query set has "
+          << querySet.n_rows << " dimensions";
+      throw std::invalid_argument(oss.str());
+    }
+
+    querySet = transformation * querySet;
+  }
+
   if (randomBasis)
     querySet = q * querySet;
 
@@ -580,18 +836,22 @@ void NSModel<SortPolicy>::Search(arma::mat&& querySet,
       Log::Info << "greedy single-tree " << TreeName() << " search..."
           << std::endl;
       break;
+    case BEST_FIRST_SINGLE_TREE_MODE:
+      Log::Info << "best-first single-tree " << TreeName() << " search..."
+          << std::endl;
+      break;
   }
 
-  BiSearchVisitor<SortPolicy> search(querySet, k, neighbors, distances,
+  BiSearchVisitor<SortPolicy, MatType> search(querySet, k, neighbors, distances,
       leafSize, tau, rho);
   boost::apply_visitor(search, nSearch);
 }
 
 //! Perform neighbor search.
-template<typename SortPolicy>
-void NSModel<SortPolicy>::Search(const size_t k,
-                                 arma::Mat<size_t>& neighbors,
-                                 arma::mat& distances)
+template<typename SortPolicy, typename MatType>
+void NSModel<SortPolicy, MatType>::Search(const size_t k,
+                                          arma::Mat<size_t>& neighbors,
+                                          arma::mat& distances)
 {
   Log::Info << "Searching for " << k << " neighbors with ";
 
@@ -610,6 +870,10 @@ void NSModel<SortPolicy>::Search(const size_t k,
       Log::Info << "greedy single-tree " << TreeName() << " search..."
           << std::endl;
       break;
+    case BEST_FIRST_SINGLE_TREE_MODE:
+      Log::Info << "best-first single-tree " << TreeName() << " search..."
+          << std::endl;
+      break;
   }
 
   if (Epsilon() != 0 && SearchMode() != NAIVE_MODE)
@@ -621,8 +885,8 @@ void NSModel<SortPolicy>::Search(const size_t k,
 }
 
 //! Get the name of the tree type.
-template<typename SortPolicy>
-std::string NSModel<SortPolicy>::TreeName() const
+template<typename SortPolicy, typename MatType>
+std::string NSModel<SortPolicy, MatType>::TreeName() const
 {
   switch (treeType)
   {
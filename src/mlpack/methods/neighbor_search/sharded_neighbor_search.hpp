@@ -0,0 +1,190 @@
+/**
+ * @file sharded_neighbor_search.hpp
+ *
+ * Defines the ShardedNeighborSearch class, which performs neighbor searches on
+ * a reference set that is split into shards with one tree each.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The ShardedNeighborSearch class performs the same searches as the
+ * NeighborSearch class, on a reference set that is split into shards, each
+ * with its own tree of any tree type.  This is the structure of a distributed
+ * search, where each shard lives on a different machine, and the shards can
+ * be given separately, so the whole reference set never has to be held in one
+ * matrix.  The point with index i in shard s has the index Offset(s) + i in
+ * the results.
+ *
+ * A search runs in two rounds.  First, each query point is searched in its
+ * home shard, the shard whose root bound is closest to it; this gives a k'th
+ * best distance for each query point.  Then each query point is only sent to
+ * the other shards whose root bound may hold a point better than that
+ * distance, so most of the remote work is pruned when the shards are spatially
+ * coherent (for instance, when they are the leaves of a top-level tree).
+ * Finally the results of all the shards are merged pairwise with a tree
+ * reduction; MergeResults() is the merge step.
+ *
+ * In NAIVE_MODE there are no trees, so every query point is searched in every
+ * shard.
+ *
+ * @code
+ * std::vector<arma::mat> shards; // Each shard of the reference set.
+ * ShardedNeighborSearch<> knn(std::move(shards));
+ * knn.Search(querySet, 5, neighbors, distances);
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam MetricType The metric to use for computation.
+ * @tparam MatType The type of data matrix.
+ * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         typename MetricType = mlpack::metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class ShardedNeighborSearch
+{
+ public:
+  //! The type of the search of each shard.
+  typedef NeighborSearch<SortPolicy, MetricType, MatType, TreeType> NSType;
+
+  /**
+   * Build one tree for each of the given shards.
+   *
+   * @param shards The shards of the reference set.
+   * @param mode Neighbor search mode used to search each shard.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   */
+  ShardedNeighborSearch(std::vector<MatType>&& shards,
+                        const NeighborSearchMode mode = DUAL_TREE_MODE,
+                        const double epsilon = 0,
+                        const MetricType metric = MetricType());
+
+  /**
+   * Split the given reference set into the given number of shards of
+   * consecutive points, and build one tree for each of them.
+   *
+   * @param referenceSet Set of reference points.
+   * @param numShards Number of shards to split the reference set into.
+   * @param mode Neighbor search mode used to search each shard.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   */
+  ShardedNeighborSearch(const MatType& referenceSet,
+                        const size_t numShards,
+                        const NeighborSearchMode mode = DUAL_TREE_MODE,
+                        const double epsilon = 0,
+                        const MetricType metric = MetricType());
+
+  //! The trees are not copyable.
+  ShardedNeighborSearch(const ShardedNeighborSearch& other) = delete;
+  //! The trees are not copyable.
+  ShardedNeighborSearch& operator=(const ShardedNeighborSearch& other) =
+      delete;
+
+  //! Delete all of the searches.
+  ~ShardedNeighborSearch();
+
+  /**
+   * For each point in the query set, compute the k best neighbors among the
+   * points of all the shards, and store their indices and distances in the
+   * given matrices, which will have k rows and one column for each query
+   * point.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * Merge two sets of results for the same query points into the first one,
+   * keeping the k best neighbors of each query point.  Each column must be
+   * sorted from best to worst, as the results of Search() are; missing
+   * neighbors have the index SIZE_MAX and the distance
+   * SortPolicy::WorstDistance().  Ties are broken by index.
+   *
+   * @param neighbors First set of neighbors; overwritten with the merged set.
+   * @param distances First set of distances; overwritten with the merged set.
+   * @param otherNeighbors Second set of neighbors.
+   * @param otherDistances Second set of distances.
+   */
+  static void MergeResults(arma::Mat<size_t>& neighbors,
+                           arma::mat& distances,
+                           const arma::Mat<size_t>& otherNeighbors,
+                           const arma::mat& otherDistances);
+
+  //! Get the number of shards.
+  size_t NumShards() const { return searches.size(); }
+  //! Get the number of points in all the shards.
+  size_t NumPoints() const { return offsets.back(); }
+  //! Get the index of the first point of the given shard in the results.
+  size_t Offset(const size_t shard) const { return offsets[shard]; }
+  //! Get the search of the given shard.
+  const NSType& Shard(const size_t shard) const { return *searches[shard]; }
+
+  //! Get the number of (query point, shard) pairs that were pruned by the
+  //! last search.
+  size_t PrunedShards() const { return prunedShards; }
+
+ private:
+  //! The search of each shard.
+  std::vector<NSType*> searches;
+  //! The index of the first point of each shard, and the number of points.
+  std::vector<size_t> offsets;
+  //! The search mode.
+  NeighborSearchMode searchMode;
+  //! The relative approximate error.
+  double epsilon;
+  //! The number of (query point, shard) pairs pruned by the last search.
+  size_t prunedShards;
+
+  //! Build the search of each shard.
+  void BuildShards(std::vector<MatType>&& shards, const MetricType& metric);
+
+  /**
+   * Search the given query points in the given shard, and store the results
+   * (with global indices, padded to k rows) in the given columns of the
+   * neighbors and distances.
+   */
+  void SearchShard(const size_t shard,
+                   const MatType& querySet,
+                   const arma::uvec& queries,
+                   const size_t k,
+                   arma::Mat<size_t>& neighbors,
+                   arma::mat& distances);
+
+  //! Return the best distance that the given shard could hold for the given
+  //! point.
+  template<typename VecType>
+  double ShardBound(const size_t shard, const VecType& point) const;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "sharded_neighbor_search_impl.hpp"
+
+#endif
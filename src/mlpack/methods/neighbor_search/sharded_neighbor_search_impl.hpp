@@ -0,0 +1,329 @@
+/**
+ * @file sharded_neighbor_search_impl.hpp
+ *
+ * Implementation of the ShardedNeighborSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sharded_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+ShardedNeighborSearch(std::vector<MatType>&& shards,
+                      const NeighborSearchMode mode,
+                      const double epsilon,
+                      const MetricType metric) :
+    searchMode(mode),
+    epsilon(epsilon),
+    prunedShards(0)
+{
+  if (epsilon < 0)
+    throw std::invalid_argument("epsilon must be non-negative");
+
+  BuildShards(std::move(shards), metric);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+ShardedNeighborSearch(const MatType& referenceSet,
+                      const size_t numShards,
+                      const NeighborSearchMode mode,
+                      const double epsilon,
+                      const MetricType metric) :
+    searchMode(mode),
+    epsilon(epsilon),
+    prunedShards(0)
+{
+  if (epsilon < 0)
+    throw std::invalid_argument("epsilon must be non-negative");
+
+  if (numShards == 0 || numShards > referenceSet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "cannot split " << referenceSet.n_cols << " reference points into "
+        << numShards << " shards";
+    throw std::invalid_argument(oss.str());
+  }
+
+  std::vector<MatType> shards(numShards);
+  for (size_t s = 0; s < numShards; ++s)
+  {
+    const size_t begin = (s * referenceSet.n_cols) / numShards;
+    const size_t end = ((s + 1) * referenceSet.n_cols) / numShards;
+    shards[s] = referenceSet.cols(begin, end - 1);
+  }
+
+  BuildShards(std::move(shards), metric);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+~ShardedNeighborSearch()
+{
+  for (size_t s = 0; s < searches.size(); ++s)
+    delete searches[s];
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+BuildShards(std::vector<MatType>&& shards, const MetricType& metric)
+{
+  offsets.assign(1, 0);
+  for (size_t s = 0; s < shards.size(); ++s)
+  {
+    if (shards[s].n_cols == 0)
+      throw std::invalid_argument("shards must not be empty");
+    if (shards[s].n_rows != shards[0].n_rows)
+    {
+      std::ostringstream oss;
+      oss << "shard " << s << " has dimensionality " << shards[s].n_rows
+          << ", but shard 0 has dimensionality " << shards[0].n_rows;
+      throw std::invalid_argument(oss.str());
+    }
+
+    offsets.push_back(offsets.back() + shards[s].n_cols);
+    searches.push_back(new NSType(std::move(shards[s]), searchMode, epsilon,
+        metric));
+  }
+
+  if (searches.empty())
+    throw std::invalid_argument("there must be at least one shard");
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename VecType>
+double ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+ShardBound(const size_t shard, const VecType& point) const
+{
+  // There is no tree to bound the shard with in naive mode.
+  if (searchMode == NAIVE_MODE)
+    return SortPolicy::BestDistance();
+
+  return SortPolicy::BestPointToNodeDistance(point,
+      &searches[shard]->ReferenceTree());
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+SearchShard(const size_t shard,
+            const MatType& querySet,
+            const arma::uvec& queries,
+            const size_t k,
+            arma::Mat<size_t>& neighbors,
+            arma::mat& distances)
+{
+  if (queries.n_elem == 0)
+    return;
+
+  const size_t shardK = std::min(k, offsets[shard + 1] - offsets[shard]);
+  const MatType shardQueries = querySet.cols(queries);
+  arma::Mat<size_t> shardNeighbors;
+  arma::mat shardDistances;
+  searches[shard]->Search(shardQueries, shardK, shardNeighbors,
+      shardDistances);
+
+  for (size_t i = 0; i < queries.n_elem; ++i)
+  {
+    for (size_t j = 0; j < shardK; ++j)
+    {
+      neighbors(j, queries[i]) = offsets[shard] + shardNeighbors(j, i);
+      distances(j, queries[i]) = shardDistances(j, i);
+    }
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  if (k > NumPoints())
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << NumPoints() << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  const size_t numShards = searches.size();
+  const size_t numQueries = querySet.n_cols;
+
+  // Find the home shard of each query point: the one whose bound is closest.
+  arma::Col<size_t> home(numQueries, arma::fill::zeros);
+  for (size_t q = 0; q < numQueries; ++q)
+  {
+    double bestBound = ShardBound(0, querySet.col(q));
+    for (size_t s = 1; s < numShards; ++s)
+    {
+      const double bound = ShardBound(s, querySet.col(q));
+      if (SortPolicy::IsBetter(bound, bestBound))
+      {
+        bestBound = bound;
+        home[q] = s;
+      }
+    }
+  }
+
+  // The first round searches each query point in its home shard.
+  neighbors.set_size(k, numQueries);
+  neighbors.fill(SIZE_MAX);
+  distances.set_size(k, numQueries);
+  distances.fill(SortPolicy::WorstDistance());
+  for (size_t s = 0; s < numShards; ++s)
+    SearchShard(s, querySet, arma::find(home == s), k, neighbors, distances);
+
+  // The second round only sends each query point to the other shards that
+  // may hold a better neighbor than its current k'th best one.
+  std::vector<arma::Mat<size_t>> shardNeighbors(numShards + 1);
+  std::vector<arma::mat> shardDistances(numShards + 1);
+  shardNeighbors[0] = std::move(neighbors);
+  shardDistances[0] = std::move(distances);
+  prunedShards = 0;
+  for (size_t s = 0; s < numShards; ++s)
+  {
+    std::vector<arma::uword> queries;
+    for (size_t q = 0; q < numQueries; ++q)
+    {
+      if (home[q] == s)
+        continue;
+
+      const double kthBest = SortPolicy::Relax(shardDistances[0](k - 1, q),
+          epsilon);
+      if (SortPolicy::IsBetter(ShardBound(s, querySet.col(q)), kthBest))
+        queries.push_back(q);
+      else
+        ++prunedShards;
+    }
+
+    shardNeighbors[s + 1].set_size(k, numQueries);
+    shardNeighbors[s + 1].fill(SIZE_MAX);
+    shardDistances[s + 1].set_size(k, numQueries);
+    shardDistances[s + 1].fill(SortPolicy::WorstDistance());
+    SearchShard(s, querySet, arma::uvec(queries), k, shardNeighbors[s + 1],
+        shardDistances[s + 1]);
+  }
+
+  // Merge the results pairwise, with a tree reduction.
+  for (size_t stride = 1; stride < shardNeighbors.size(); stride *= 2)
+  {
+    const size_t numMerges = (shardNeighbors.size() + 2 * stride - 1) /
+        (2 * stride);
+
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t m = 0; m < (intmax_t) numMerges; ++m)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t m = 0; m < numMerges; ++m)
+#endif
+    {
+      const size_t first = 2 * stride * m;
+      const size_t second = first + stride;
+      if (second < shardNeighbors.size())
+      {
+        MergeResults(shardNeighbors[first], shardDistances[first],
+            shardNeighbors[second], shardDistances[second]);
+      }
+    }
+  }
+
+  neighbors = std::move(shardNeighbors[0]);
+  distances = std::move(shardDistances[0]);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+MergeResults(arma::Mat<size_t>& neighbors,
+             arma::mat& distances,
+             const arma::Mat<size_t>& otherNeighbors,
+             const arma::mat& otherDistances)
+{
+  const size_t k = neighbors.n_rows;
+  arma::Col<size_t> mergedNeighbors(k);
+  arma::vec mergedDistances(k);
+  for (size_t q = 0; q < neighbors.n_cols; ++q)
+  {
+    // Both columns are sorted, so the k best of both are found in one pass.
+    size_t a = 0, b = 0;
+    for (size_t j = 0; j < k; ++j)
+    {
+      const bool takeFirst = SortPolicy::IsBetter(distances(a, q),
+          otherDistances(b, q)) || (distances(a, q) == otherDistances(b, q) &&
+          neighbors(a, q) <= otherNeighbors(b, q));
+      if (takeFirst)
+      {
+        mergedNeighbors[j] = neighbors(a, q);
+        mergedDistances[j] = distances(a, q);
+        ++a;
+      }
+      else
+      {
+        mergedNeighbors[j] = otherNeighbors(b, q);
+        mergedDistances[j] = otherDistances(b, q);
+        ++b;
+      }
+    }
+
+    neighbors.col(q) = mergedNeighbors;
+    distances.col(q) = mergedDistances;
+  }
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
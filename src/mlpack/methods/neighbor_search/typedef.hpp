@@ -18,6 +18,7 @@
 #include "neighbor_search.hpp"
 
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/tree/octree.hpp>
 
 #include "sort_policies/nearest_neighbor_sort.hpp"
 #include "sort_policies/furthest_neighbor_sort.hpp"
@@ -43,21 +44,23 @@ typedef NeighborSearch<FurthestNeighborSort, metric::EuclideanDistance> KFN;
  * the k nearest neighbors found.
  * @tparam TreeType The tree type to use; must adhere to the TreeType API,
  *     and implement Defeatist Traversers.
+ * @tparam MatType The type of matrix the points are held in.
  */
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType = tree::SPTree>
+                  typename TreeMatType> class TreeType = tree::SPTree,
+         typename MatType = arma::mat>
 using DefeatistKNN = NeighborSearch<
     NearestNeighborSort,
     metric::EuclideanDistance,
-    arma::mat,
+    MatType,
     TreeType,
     TreeType<metric::EuclideanDistance,
         NeighborSearchStat<NearestNeighborSort>,
-        arma::mat>::template DefeatistDualTreeTraverser,
+        MatType>::template DefeatistDualTreeTraverser,
     TreeType<metric::EuclideanDistance,
         NeighborSearchStat<NearestNeighborSort>,
-        arma::mat>::template DefeatistSingleTreeTraverser>;
+        MatType>::template DefeatistSingleTreeTraverser>;
 
 /**
  * The SpillKNN class is the k-nearest-neighbors method considering defeatist
@@ -66,6 +69,14 @@ using DefeatistKNN = NeighborSearch<
  */
 typedef DefeatistKNN<tree::SPTree> SpillKNN;
 
+/**
+ * The OctreeKNN class is the k-nearest-neighbors method on an Octree, which is
+ * built from the Morton order of the points in low dimensions.  It returns L2
+ * distances (Euclidean distances) for each of the k nearest neighbors.
+ */
+typedef NeighborSearch<NearestNeighborSort, metric::EuclideanDistance,
+    arma::mat, tree::Octree> OctreeKNN;
+
 /**
  * @deprecated
  * The AllkNN class is the k-nearest-neighbors method.  It returns L2 distances
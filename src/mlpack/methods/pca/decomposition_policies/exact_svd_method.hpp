@@ -17,6 +17,7 @@
 #define MLPACK_METHODS_PCA_DECOMPOSITION_POLICIES_EXACT_SVD_METHOD_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/lin_alg.hpp>
 
 namespace mlpack {
 namespace pca {
@@ -45,29 +46,38 @@ class ExactSVDPolicy
              arma::mat& eigvec,
              const size_t /* rank */)
   {
-    // This matrix will store the right singular values; we do not need them.
-    arma::mat v;
-
-    // Do singular value decomposition.  Use the economical singular value
-    // decomposition if the columns are much larger than the rows.
     if (data.n_rows < data.n_cols)
     {
-      // Do economical singular value decomposition and compute only the left
-      // singular vectors.
-      arma::svd_econ(eigvec, eigVal, v, centeredData, 'l');
+      // The left singular vectors of the centered data are the eigenvectors of
+      // its covariance matrix, which can be computed without the copy of the
+      // data that the singular value decomposition makes.
+      arma::mat covariance;
+      math::Covariance(centeredData, covariance, true);
+      arma::eig_sym(eigVal, eigvec, covariance);
+
+      // The eigenvalues are given in ascending order, and rounding may make the
+      // smallest ones slightly negative.
+      eigVal = arma::flipud(arma::clamp(eigVal, 0.0, arma::datum::inf));
+      eigvec = arma::fliplr(eigvec);
     }
     else
     {
+      // This matrix will store the right singular values; we do not need them.
+      arma::mat v;
       arma::svd(eigvec, eigVal, v, centeredData);
-    }
 
-    // Now we must square the singular values to get the eigenvalues.
-    // In addition we must divide by the number of points, because the
-    // covariance matrix is X * X' / (N - 1).
-    eigVal %= eigVal / (data.n_cols - 1);
+      // Now we must square the singular values to get the eigenvalues.
+      // In addition we must divide by the number of points, because the
+      // covariance matrix is X * X' / (N - 1).
+      eigVal %= eigVal / (data.n_cols - 1);
+    }
 
-    // Project the samples to the principals.
-    transformedData = arma::trans(eigvec) * centeredData;
+    // Project the samples to the principals.  When the result overwrites the
+    // centered data, it is computed one block at a time.
+    if (&transformedData == &centeredData)
+      math::TransformInPlace(arma::trans(eigvec), transformedData);
+    else
+      transformedData = arma::trans(eigvec) * centeredData;
   }
 };
 
@@ -77,6 +77,40 @@ class RandomizedBlockKrylovSVDPolicy
     transformedData = arma::trans(eigvec) * centeredData;
   }
 
+  /**
+   * Apply Principal Component Analysis to the provided sparse data set using
+   * the randomized block krylov SVD method.  The data is centered implicitly,
+   * so it is never stored densely; only the transformed data is dense.
+   *
+   * @param data Sparse data matrix.
+   * @param transformedData Matrix to put results of PCA into.
+   * @param eigVal Vector to put eigenvalues into.
+   * @param eigvec Matrix to put eigenvectors (loadings) into.
+   * @param rank Rank of the decomposition.
+   */
+  void Apply(const arma::sp_mat& data,
+             arma::mat& transformedData,
+             arma::vec& eigVal,
+             arma::mat& eigvec,
+             const size_t rank)
+  {
+    // This matrix will store the right singular values; we do not need them.
+    arma::mat v;
+
+    const arma::mat meanMat(arma::sum(data, 1) / data.n_cols);
+    const arma::vec mean = meanMat.col(0);
+
+    svd::RandomizedBlockKrylovSVD rsvd(maxIterations, blockSize);
+    rsvd.Apply(data, eigvec, eigVal, v, rank, mean);
+
+    // The covariance matrix is X * X' / (N - 1).
+    eigVal %= eigVal / (data.n_cols - 1);
+
+    // Project the samples to the principals: eigvec^T * (data - mean * 1^T).
+    transformedData = arma::trans(eigvec) * data;
+    transformedData.each_col() -= arma::trans(eigvec) * mean;
+  }
+
   //! Get the number of iterations for the power method.
   size_t MaxIterations() const { return maxIterations; }
   //! Modify the number of iterations for the power method.
@@ -77,6 +77,63 @@ class RandomizedSVDPolicy
     transformedData = arma::trans(eigvec) * centeredData;
   }
 
+  /**
+   * Apply Principal Component Analysis to the provided sparse data set using
+   * the randomized SVD.  The data is centered implicitly, so it is never
+   * stored densely; only the transformed data is dense.
+   *
+   * @param data Sparse data matrix.
+   * @param transformedData Matrix to put results of PCA into.
+   * @param eigVal Vector to put eigenvalues into.
+   * @param eigvec Matrix to put eigenvectors (loadings) into.
+   * @param rank Rank of the decomposition.
+   */
+  void Apply(const arma::sp_mat& data,
+             arma::mat& transformedData,
+             arma::vec& eigVal,
+             arma::mat& eigvec,
+             const size_t rank)
+  {
+    // This matrix will store the right singular values; we do not need them.
+    arma::mat v;
+
+    svd::RandomizedSVD rsvd(iteratedPower, maxIterations);
+    rsvd.Apply(data, eigvec, eigVal, v, rank);
+
+    // The covariance matrix is X * X' / (N - 1).
+    eigVal %= eigVal / (data.n_cols - 1);
+
+    // Project the samples to the principals: eigvec^T * (data - mean * 1^T).
+    const arma::mat mean(arma::sum(data, 1) / data.n_cols);
+    transformedData = arma::trans(eigvec) * data;
+    transformedData.each_col() -= arma::trans(eigvec) * mean.col(0);
+  }
+
+  /**
+   * Compute the principal components of the data read from the given batch
+   * source with the randomized SVD, in a fixed number of passes over the
+   * column blocks of the data, without centering the data in memory.
+   *
+   * @param source Source of the column blocks of the data.
+   * @param eigVal Vector to put eigenvalues into.
+   * @param eigvec Matrix to put eigenvectors (loadings) into.
+   * @param mean Vector to put the mean of the data into.
+   * @param rank Rank of the decomposition.
+   */
+  template<typename SourceType>
+  void Apply(SourceType& source,
+             arma::vec& eigVal,
+             arma::mat& eigvec,
+             arma::vec& mean,
+             const size_t rank)
+  {
+    svd::RandomizedSVD rsvd(iteratedPower, maxIterations);
+    const size_t n = rsvd.Apply(source, eigvec, eigVal, mean, rank);
+
+    // The covariance matrix is X * X' / (N - 1).
+    eigVal %= eigVal / (n - 1);
+  }
+
   //! Get the size of the normalized power iterations.
   size_t IteratedPower() const { return iteratedPower; }
   //! Modify the size of the normalized power iterations.
@@ -69,6 +69,28 @@ class PCAType
              arma::mat& transformedData,
              arma::vec& eigVal);
 
+  /**
+   * Apply Principal Component Analysis to the provided sparse data set, such
+   * as a term-document matrix (which makes this latent semantic analysis).
+   * The data is never centered in memory: the mean of each dimension is
+   * subtracted implicitly in the products with the data, so only the given
+   * number of principal components and the transformed data are dense.  This
+   * is only available for decomposition policies that take sparse data
+   * (RandomizedSVDPolicy and RandomizedBlockKrylovSVDPolicy), and without
+   * scaling.
+   *
+   * @param data Sparse data matrix.
+   * @param transformedData Matrix to put results of PCA into.
+   * @param eigVal Vector to put eigenvalues into.
+   * @param eigvec Matrix to put eigenvectors (loadings) into.
+   * @param rank Number of principal components to compute.
+   */
+  void Apply(const arma::sp_mat& data,
+             arma::mat& transformedData,
+             arma::vec& eigVal,
+             arma::mat& eigvec,
+             const size_t rank);
+
   /**
    * Use PCA for dimensionality reduction on the given dataset. This will save
    * the newDimension largest principal components of the data and remove the
@@ -105,6 +127,28 @@ class PCAType
    */
   double Apply(arma::mat& data, const double varRetained);
 
+  /**
+   * Compute the rank leading principal components of the data read from the
+   * given batch source (see data/batch_source.hpp), for data that doesn't fit
+   * in memory.  The data is read in column blocks a fixed number of times, and
+   * is never centered in memory; the transformed data isn't computed, but each
+   * block can be projected with eigvec.t() * (block - mean).  This is only
+   * available for decomposition policies that can read batch sources (like
+   * RandomizedSVDPolicy), and without scaling.
+   *
+   * @param source Source of the column blocks of the data.
+   * @param eigVal Vector to put eigenvalues into.
+   * @param eigvec Matrix to put eigenvectors (loadings) into.
+   * @param mean Vector to put the mean of the data into.
+   * @param rank Number of principal components to compute.
+   */
+  template<typename SourceType>
+  void Apply(SourceType& source,
+             arma::vec& eigVal,
+             arma::mat& eigvec,
+             arma::vec& mean,
+             const size_t rank);
+
   //! Get whether or not this PCA object will scale (by standard deviation)
   //! the data when PCA is performed.
   bool ScaleData() const { return scaleData; }
@@ -129,10 +173,24 @@ class PCAType
         if (stdDev[i] == 0)
           stdDev[i] = 1e-50;
 
-      centeredData /= arma::repmat(stdDev, 1, centeredData.n_cols);
+      centeredData.each_col() /= stdDev;
     }
   }
 
+  /**
+   * Center and scale the given data in place and apply PCA to it, overwriting
+   * it with the transformed data, so that no copy of the data is made.
+   *
+   * @param data Data matrix, overwritten with the transformed data.
+   * @param eigVal Vector to put eigenvalues into.
+   * @param eigvec Matrix to put eigenvectors (loadings) into.
+   * @param rank Rank of the decomposition.
+   */
+  void ApplyInPlace(arma::mat& data,
+                    arma::vec& eigVal,
+                    arma::mat& eigvec,
+                    const size_t rank);
+
   //! Whether or not the data will be scaled by standard deviation when PCA is
   //! performed.
   bool scaleData;
@@ -77,6 +77,38 @@ void PCAType<DecompositionPolicy>::Apply(const arma::mat& data,
   Apply(data, transformedData, eigVal, eigvec);
 }
 
+template<typename DecompositionPolicy>
+void PCAType<DecompositionPolicy>::Apply(const arma::sp_mat& data,
+                                         arma::mat& transformedData,
+                                         arma::vec& eigVal,
+                                         arma::mat& eigvec,
+                                         const size_t rank)
+{
+  if (scaleData)
+    Log::Fatal << "PCA::Apply(): sparse data cannot be scaled!" << endl;
+
+  Timer::Start("pca");
+  decomposition.Apply(data, transformedData, eigVal, eigvec, rank);
+  Timer::Stop("pca");
+}
+
+template<typename DecompositionPolicy>
+template<typename SourceType>
+void PCAType<DecompositionPolicy>::Apply(SourceType& source,
+                                         arma::vec& eigVal,
+                                         arma::mat& eigvec,
+                                         arma::vec& mean,
+                                         const size_t rank)
+{
+  if (scaleData)
+    Log::Fatal << "PCA::Apply(): the data of a batch source cannot be scaled!"
+        << endl;
+
+  Timer::Start("pca");
+  decomposition.Apply(source, eigVal, eigvec, mean, rank);
+  Timer::Stop("pca");
+}
+
 /**
  * Use PCA for dimensionality reduction on the given dataset.  This will save
  * the newDimension largest principal components of the data and remove the
@@ -106,14 +138,7 @@ double PCAType<DecompositionPolicy>::Apply(arma::mat& data,
 
   Timer::Start("pca");
 
-  // Center the data into a temporary matrix.
-  arma::mat centeredData;
-  math::Center(data, centeredData);
-
-  // Scale the data if the user ask for.
-  ScaleData(centeredData);
-
-  decomposition.Apply(data, centeredData, data, eigVal, eigvec, newDimension);
+  ApplyInPlace(data, eigVal, eigvec, newDimension);
 
   if (newDimension < eigvec.n_rows)
     // Drop unnecessary rows.
@@ -154,7 +179,9 @@ double PCAType<DecompositionPolicy>::Apply(arma::mat& data,
   arma::mat eigvec;
   arma::vec eigVal;
 
-  Apply(data, data, eigVal, eigvec);
+  Timer::Start("pca");
+  ApplyInPlace(data, eigVal, eigvec, data.n_rows);
+  Timer::Stop("pca");
 
   // Calculate the dimension we should keep.
   size_t newDimension = 0;
@@ -173,6 +200,22 @@ double PCAType<DecompositionPolicy>::Apply(arma::mat& data,
   return varSum;
 }
 
+template<typename DecompositionPolicy>
+void PCAType<DecompositionPolicy>::ApplyInPlace(arma::mat& data,
+                                                arma::vec& eigVal,
+                                                arma::mat& eigvec,
+                                                const size_t rank)
+{
+  // The decomposition policies only need the original data for its size and,
+  // for some of them, its mean, which is zero after centering.
+  math::Center(data);
+
+  // Scale the data if the user ask for.
+  ScaleData(data);
+
+  decomposition.Apply(data, data, data, eigVal, eigvec, rank);
+}
+
 } // namespace pca
 } // namespace mlpack
 
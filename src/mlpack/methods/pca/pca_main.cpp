@@ -29,7 +29,14 @@ PROGRAM_INFO("Principal Components Analysis", "This program performs principal "
     "randomized block krylov or QUIC SVD method. It will transform the data "
     "onto its principal components, optionally performing dimensionality "
     "reduction by ignoring the principal components with the smallest "
-    "eigenvalues.");
+    "eigenvalues."
+    "\n\n"
+    "If --sparse is given, the input is a sparse matrix in coordinate list "
+    "format: each line holds the row, the column and the value of one nonzero "
+    "element.  The data is then never centered densely, so large sparse "
+    "datasets (such as term-document matrices) can be processed.  This is only "
+    "available with the 'randomized' and 'randomized-block-krylov' methods, "
+    "and requires --new_dimensionality (-d).");
 
 // Parameters for program.
 PARAM_MATRIX_IN_REQ("input", "Input dataset to perform PCA on.", "i");
@@ -42,6 +49,9 @@ PARAM_DOUBLE_IN("var_to_retain", "Amount of variance to retain; should be "
 PARAM_FLAG("scale", "If set, the data will be scaled before running PCA, such "
     "that the variance of each feature is 1.", "s");
 
+PARAM_FLAG("sparse", "If set, the input is a sparse matrix in coordinate list "
+    "format (row, column, value).", "S");
+
 PARAM_STRING_IN("decomposition_method", "Method used for the principal "
     "components analysis: 'exact', 'randomized', 'randomized-block-krylov', "
     "'quic'.", "c", "exact");
@@ -76,6 +86,89 @@ void RunPCA(arma::mat& dataset,
       dataset.n_rows << " dimensions)." << endl;
 }
 
+//! Run PCA on the specified sparse dataset with the given decomposition method.
+template<typename DecompositionPolicy>
+void RunSparsePCA(const arma::sp_mat& dataset,
+                  const size_t newDimension,
+                  arma::mat& transformedData)
+{
+  PCAType<DecompositionPolicy> p;
+
+  Log::Info << "Performing PCA on sparse dataset..." << endl;
+  arma::vec eigVal;
+  arma::mat eigvec;
+  p.Apply(dataset, transformedData, eigVal, eigvec, newDimension);
+
+  // The randomized methods may return more components than requested.
+  if (transformedData.n_rows > newDimension)
+  {
+    transformedData.shed_rows(newDimension, transformedData.n_rows - 1);
+    eigVal.shed_rows(newDimension, eigVal.n_elem - 1);
+  }
+
+  // The total variance is the trace of the covariance matrix, which can be
+  // computed from the nonzero elements and the mean without centering.
+  const arma::mat mean(arma::sum(dataset, 1) / dataset.n_cols);
+  const double totalVariance = (arma::accu(arma::square(dataset)) -
+      dataset.n_cols * arma::accu(arma::square(mean))) /
+      (dataset.n_cols - 1);
+
+  Log::Info << (arma::accu(eigVal) / totalVariance * 100) << "% of variance "
+      << "retained (" << transformedData.n_rows << " dimensions)." << endl;
+}
+
+//! Run PCA on the sparse dataset given in coordinate list format.
+void RunSparse(arma::mat& coordinates,
+               const string& decompositionMethod,
+               arma::mat& transformedData)
+{
+  if (coordinates.n_rows != 3)
+  {
+    Log::Fatal << "Sparse input must have 3 columns (row, column, value), but "
+        << "it has " << coordinates.n_rows << "!" << endl;
+  }
+  if (!CLI::HasParam("new_dimensionality"))
+  {
+    Log::Fatal << "--new_dimensionality (-d) must be specified with --sparse!"
+        << endl;
+  }
+  if (CLI::HasParam("var_to_retain") || CLI::HasParam("scale"))
+  {
+    Log::Fatal << "--var_to_retain (-r) and --scale (-s) cannot be used with "
+        << "--sparse!" << endl;
+  }
+
+  const arma::umat locations =
+      arma::conv_to<arma::umat>::from(coordinates.rows(0, 1));
+  const arma::vec values = trans(coordinates.row(2));
+  arma::sp_mat dataset(locations, values);
+  coordinates.reset();
+
+  const int newDimension = CLI::GetParam<int>("new_dimensionality");
+  if (newDimension <= 0 || (size_t) newDimension > dataset.n_rows)
+  {
+    Log::Fatal << "New dimensionality (" << newDimension << ") must be "
+        << "between 1 and the existing dimensionality (" << dataset.n_rows
+        << ")!" << endl;
+  }
+
+  if (decompositionMethod == "randomized")
+  {
+    RunSparsePCA<RandomizedSVDPolicy>(dataset, newDimension, transformedData);
+  }
+  else if (decompositionMethod == "randomized-block-krylov")
+  {
+    RunSparsePCA<RandomizedBlockKrylovSVDPolicy>(dataset, newDimension,
+        transformedData);
+  }
+  else
+  {
+    Log::Fatal << "Invalid decomposition method for sparse data ('"
+        << decompositionMethod << "'); valid choices are 'randomized', "
+        << "'randomized-block-krylov'." << endl;
+  }
+}
+
 int main(int argc, char** argv)
 {
   // Parse commandline.
@@ -89,6 +182,17 @@ int main(int argc, char** argv)
     Log::Warn << "--output_file is not specified; no output will be "
         << "saved." << endl;
 
+  if (CLI::HasParam("sparse"))
+  {
+    arma::mat transformedData;
+    RunSparse(dataset, CLI::GetParam<string>("decomposition_method"),
+        transformedData);
+
+    if (CLI::HasParam("output"))
+      CLI::GetParam<arma::mat>("output") = std::move(transformedData);
+    return 0;
+  }
+
   // Find out what dimension we want.
   size_t newDimension = dataset.n_rows; // No reduction, by default.
   if (CLI::GetParam<int>("new_dimensionality") != 0)
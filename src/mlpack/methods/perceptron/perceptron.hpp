@@ -26,6 +26,11 @@ namespace perceptron {
  * network).  It converges if the supplied training dataset is linearly
  * separable.
  *
+ * By default, the weights are updated after each point, as by the original
+ * perceptron learning rule.  With a batch size larger than one, the points are
+ * instead classified a batch at a time with one matrix product, and the
+ * updates for all the misclassified points of the batch are then applied.
+ *
  * @tparam LearnPolicy Options of SimpleWeightUpdate and GradientDescent.
  * @tparam WeightInitializationPolicy Option of ZeroInitialization and
  *      RandomInitialization.
@@ -45,10 +50,13 @@ class Perceptron
    * @param dimensionality Dimensionality of the dataset.
    * @param maxIterations Maximum number of iterations for the perceptron
    *      learning algorithm.
+   * @param batchSize Number of points classified before the weights are
+   *      updated.
    */
   Perceptron(const size_t numClasses = 0,
              const size_t dimensionality = 0,
-             const size_t maxIterations = 1000);
+             const size_t maxIterations = 1000,
+             const size_t batchSize = 1);
 
   /**
    * Constructor: constructs the perceptron by building the weights matrix,
@@ -62,11 +70,14 @@ class Perceptron
    * @param numClasses Number of classes in the dataset.
    * @param maxIterations Maximum number of iterations for the perceptron
    *      learning algorithm.
+   * @param batchSize Number of points classified before the weights are
+   *      updated.
    */
   Perceptron(const MatType& data,
              const arma::Row<size_t>& labels,
              const size_t numClasses,
-             const size_t maxIterations = 1000);
+             const size_t maxIterations = 1000,
+             const size_t batchSize = 1);
 
   /**
    * Alternate constructor which copies parameters from an already initiated
@@ -116,13 +127,18 @@ class Perceptron
    * Serialize the perceptron.
    */
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */);
+  void Serialize(Archive& ar, const unsigned int version);
 
   //! Get the maximum number of iterations.
   size_t MaxIterations() const { return maxIterations; }
   //! Modify the maximum number of iterations.
   size_t& MaxIterations() { return maxIterations; }
 
+  //! Get the number of points classified before each weight update.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points classified before each weight update.
+  size_t& BatchSize() { return batchSize; }
+
   //! Get the number of classes this perceptron has been trained for.
   size_t NumClasses() const { return weights.n_cols; }
 
@@ -140,6 +156,9 @@ class Perceptron
   //! The maximum number of iterations during training.
   size_t maxIterations;
 
+  //! The number of points classified before each weight update.
+  size_t batchSize;
+
   /**
    * Stores the weights for each of the input class labels.  Each column
    * corresponds to the weights for one class label, and each row corresponds to
@@ -155,6 +174,26 @@ class Perceptron
 } // namespace perceptron
 } // namespace mlpack
 
+//! Set the serialization version of the Perceptron class.  This is what
+//! BOOST_TEMPLATE_CLASS_VERSION does, but that macro can't take a template
+//! with more than one parameter.
+namespace boost {
+namespace serialization {
+
+template<typename LearnPolicy,
+         typename WeightInitializationPolicy,
+         typename MatType>
+struct version<mlpack::data::SecondShim<mlpack::perceptron::Perceptron<
+    LearnPolicy, WeightInitializationPolicy, MatType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 #include "perceptron_impl.hpp"
 
 #endif
@@ -29,8 +29,10 @@ template<
 Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const size_t numClasses,
     const size_t dimensionality,
-    const size_t maxIterations) :
-    maxIterations(maxIterations)
+    const size_t maxIterations,
+    const size_t batchSize) :
+    maxIterations(maxIterations),
+    batchSize(batchSize)
 {
   WeightInitializationPolicy wip;
   wip.Initialize(weights, biases, dimensionality, numClasses);
@@ -55,8 +57,10 @@ Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const MatType& data,
     const arma::Row<size_t>& labels,
     const size_t numClasses,
-    const size_t maxIterations) :
-    maxIterations(maxIterations)
+    const size_t maxIterations,
+    const size_t batchSize) :
+    maxIterations(maxIterations),
+    batchSize(batchSize)
 {
   WeightInitializationPolicy wip;
   wip.Initialize(weights, biases, data.n_rows, numClasses);
@@ -86,7 +90,8 @@ Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const MatType& data,
     const arma::Row<size_t>& labels,
     const arma::rowvec& instanceWeights) :
-    maxIterations(other.maxIterations)
+    maxIterations(other.maxIterations),
+    batchSize(other.batchSize)
 {
   // Insert a row of ones at the top of the training data set.
   WeightInitializationPolicy wip;
@@ -112,14 +117,25 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Classify(
     const MatType& test,
     arma::Row<size_t>& predictedLabels)
 {
-  arma::vec tempLabelMat;
-  arma::uword maxIndex = 0;
-
-  // Could probably be faster if done in batch.
+  // Compute the scores of all the points with one matrix product.
+  arma::mat scores = weights.t() * test;
+  scores.each_col() += biases;
+
+  predictedLabels.set_size(test.n_cols);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.  If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) test.n_cols; i++)
+  #else
+  #pragma omp parallel for schedule(static)
   for (size_t i = 0; i < test.n_cols; i++)
+  #endif
   {
-    tempLabelMat = weights.t() * test.col(i) + biases;
-    tempLabelMat.max(maxIndex);
+    arma::uword maxIndex = 0;
+    scores.unsafe_col(i).max(maxIndex);
     predictedLabels(0, i) = maxIndex;
   }
 }
@@ -143,11 +159,13 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
     const arma::Row<size_t>& labels,
     const arma::rowvec& instanceWeights)
 {
-  size_t j, i = 0;
+  if (batchSize == 0)
+    throw std::invalid_argument("Perceptron::Train(): the batch size must be "
+        "positive");
+
+  size_t i = 0;
   bool converged = false;
-  size_t tempLabel;
-  arma::uword maxIndexRow, maxIndexCol;
-  arma::mat tempLabelMat;
+  arma::mat scores;
 
   LearnPolicy LP;
 
@@ -160,31 +178,39 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
     i++;
     converged = true;
 
-    // Now this inner loop is for going through the dataset in each iteration.
-    for (j = 0; j < data.n_cols; j++)
+    // Now this inner loop is for going through the dataset in each iteration,
+    // one batch at a time.
+    for (size_t begin = 0; begin < data.n_cols; begin += batchSize)
     {
-      // Multiply for each variable and check whether the current weight vector
-      // correctly classifies this.
-      tempLabelMat = weights.t() * data.col(j) + biases;
+      const size_t end = std::min(begin + batchSize, (size_t) data.n_cols) - 1;
 
-      tempLabelMat.max(maxIndexRow, maxIndexCol);
+      // Multiply for each point of the batch and check whether the current
+      // weight vector correctly classifies it.
+      scores = weights.t() * data.cols(begin, end);
+      scores.each_col() += biases;
 
-      // Check whether prediction is correct.
-      if (maxIndexRow != labels(0, j))
+      for (size_t j = begin; j <= end; j++)
       {
-        // Due to incorrect prediction, convergence set to false.
-        converged = false;
-        tempLabel = labels(0, j);
-
-        // Send maxIndexRow for knowing which weight to update, send j to know
-        // the value of the vector to update it with.  Send tempLabel to know
-        // the correct class.
-        if (hasWeights)
-          LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow, tempLabel,
-              instanceWeights(j));
-        else
-          LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow,
-              tempLabel);
+        arma::uword maxIndexRow = 0;
+        scores.unsafe_col(j - begin).max(maxIndexRow);
+
+        // Check whether prediction is correct.
+        if (maxIndexRow != labels(0, j))
+        {
+          // Due to incorrect prediction, convergence set to false.
+          converged = false;
+          const size_t tempLabel = labels(0, j);
+
+          // Send maxIndexRow for knowing which weight to update, send j to
+          // know the value of the vector to update it with.  Send tempLabel to
+          // know the correct class.
+          if (hasWeights)
+            LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow,
+                tempLabel, instanceWeights(j));
+          else
+            LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow,
+                tempLabel);
+        }
       }
     }
   }
@@ -197,11 +223,18 @@ template<typename LearnPolicy,
 template<typename Archive>
 void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Serialize(
     Archive& ar,
-    const unsigned int /* version */)
+    const unsigned int version)
 {
-  // We just need to serialize the maximum number of iterations, the weights,
-  // and the biases.
+  // We just need to serialize the maximum number of iterations, the batch
+  // size, the weights, and the biases.
   ar & data::CreateNVP(maxIterations, "maxIterations");
+
+  // Models before version 1 were always trained one point at a time.
+  if (version > 0)
+    ar & data::CreateNVP(batchSize, "batchSize");
+  else if (Archive::is_loading::value)
+    batchSize = 1;
+
   ar & data::CreateNVP(weights, "weights");
   ar & data::CreateNVP(biases, "biases");
 }
@@ -95,6 +95,9 @@ PARAM_UROW_IN("labels", "A matrix containing labels for the training set.",
     "l");
 PARAM_INT_IN("max_iterations", "The maximum number of iterations the "
     "perceptron is to be run", "n", 1000);
+PARAM_INT_IN("batch_size", "The number of points classified before the "
+    "weights are updated; 1 gives the classic perceptron learning rule.", "b",
+    1);
 
 // Model loading/saving.
 PARAM_MODEL_IN(PerceptronModel, "input_model", "Input perceptron model.", "m");
@@ -113,6 +116,11 @@ int main(int argc, char** argv)
   // First, get all parameters and validate them.
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
 
+  if (CLI::GetParam<int>("batch_size") <= 0)
+    Log::Fatal << "Invalid batch size " << CLI::GetParam<int>("batch_size")
+        << "; --batch_size (-b) must be positive." << endl;
+  const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
+
   // We must either load a model or train a model.
   if (!CLI::HasParam("input_model") && !CLI::HasParam("training"))
     Log::Fatal << "Either an input model must be specified with "
@@ -188,7 +196,7 @@ int main(int argc, char** argv)
       // Create and train the classifier.
       Timer::Start("training");
       p.P() = Perceptron<>(trainingData, labels, max(labels) + 1,
-          maxIterations);
+          maxIterations, batchSize);
       Timer::Stop("training");
     }
     else
@@ -216,6 +224,7 @@ int main(int argc, char** argv)
       // Now train.
       Timer::Start("training");
       p.P().MaxIterations() = maxIterations;
+      p.P().BatchSize() = batchSize;
       p.P().Train(trainingData, labels.t());
       Timer::Stop("training");
     }
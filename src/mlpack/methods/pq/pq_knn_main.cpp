@@ -0,0 +1,223 @@
+/**
+ * @file pq_knn_main.cpp
+ *
+ * This file computes approximate nearest neighbors with an IVF-PQ index
+ * (product quantization).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+#include <mlpack/methods/lsh/lsh_search.hpp>
+
+#include "pq_search.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+// Information about the program itself.
+PROGRAM_INFO("K-Approximate-Nearest-Neighbor Search with Product Quantization",
+    "This program will calculate the k approximate-nearest-neighbors of a set "
+    "of points using an inverted file of product-quantized vectors (IVF-PQ). "
+    "The reference points are clustered into a number of lists (specified "
+    "with --lists), and each point is stored as one byte for each of the "
+    "subvectors its residual is split into (specified with --subvectors), so "
+    "the model is much smaller than the reference set.  At search time, the "
+    "lists nearest to each query (as many as specified with --probes) are "
+    "scanned.  Distances output are approximate."
+    "\n\n"
+    "You may specify a separate set of reference points and query points, or "
+    "just a reference set which will be used as both the reference and query "
+    "set.  For example, the following will return 5 neighbors from the data "
+    "for each point in 'input.csv' and store the distances in 'distances.csv' "
+    "and the neighbors in the file 'neighbors.csv':"
+    "\n\n"
+    "$ mlpack_pq_knn -k 5 -r input.csv -d distances.csv -n neighbors.csv "
+    "\n\n"
+    "The output files are organized such that row i and column j in the "
+    "neighbors output file corresponds to the index of the point in the "
+    "reference set which is the i'th nearest neighbor from the point in the "
+    "query set with index j.  Row i and column j in the distances output file "
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "Because the index is built with k-means, results may be different from "
+    "run to run.  Thus, the --seed option can be specified to set the random "
+    "seed.");
+
+// Define our input parameters that this program will take.
+PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
+PARAM_MATRIX_OUT("distances", "Matrix to output distances into.", "d");
+PARAM_UMATRIX_OUT("neighbors", "Matrix to output neighbors into.", "n");
+
+// We can load or save models.
+PARAM_MODEL_IN(PQSearch<>, "input_model", "Input IVF-PQ model.", "m");
+PARAM_MODEL_OUT(PQSearch<>, "output_model", "Output for trained IVF-PQ model.",
+    "M");
+
+// For testing recall.
+PARAM_UMATRIX_IN("true_neighbors", "Matrix of true neighbors to compute "
+    "recall with (the recall is printed when -v is specified).", "t");
+
+PARAM_INT_IN("k", "Number of nearest neighbors to find.", "k", 0);
+PARAM_MATRIX_IN("query", "Matrix containing query points (optional).", "q");
+
+PARAM_INT_IN("lists", "Number of lists of the coarse quantizer.", "L", 256);
+PARAM_INT_IN("subvectors", "Number of subvectors each point is split into "
+    "(each is stored in one byte).", "S", 8);
+PARAM_INT_IN("codes", "Number of codes for each subvector (at most 256).", "C",
+    256);
+PARAM_INT_IN("max_iterations", "Maximum number of k-means iterations when "
+    "building the model.", "i", 100);
+PARAM_INT_IN("probes", "Number of lists to scan for each query; if 0, all "
+    "lists are scanned.", "p", 8);
+PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
+
+int main(int argc, char *argv[])
+{
+  // Give CLI the command line parameters the user passed in.
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) time(NULL));
+
+  if (CLI::HasParam("input_model") && CLI::HasParam("reference"))
+  {
+    Log::Fatal << "Cannot specify both --reference_file and --input_model_file!"
+        << " Either create a new model with --reference_file or use an existing"
+        << " model with --input_model_file." << endl;
+  }
+
+  if (!CLI::HasParam("input_model") && !CLI::HasParam("reference"))
+  {
+    Log::Fatal << "Must specify either --input_model_file or --reference_file!"
+        << endl;
+  }
+
+  if (!CLI::HasParam("neighbors") && !CLI::HasParam("distances") &&
+      !CLI::HasParam("output_model"))
+  {
+    Log::Warn << "Neither --neighbors_file, --distances_file, nor "
+        << "--output_model_file are specified; no results will be saved."
+        << endl;
+  }
+
+  // The model does not hold the reference set, so the query set must be given
+  // when a model is loaded.
+  if (CLI::HasParam("k") && !CLI::HasParam("query") &&
+      !CLI::HasParam("reference"))
+  {
+    Log::Fatal << "--query_file must be specified if search is to be done "
+        << "with a model given by --input_model_file!" << endl;
+  }
+
+  if (CLI::HasParam("query") && !CLI::HasParam("k"))
+    Log::Fatal << "--k must be specified if search is to be done!" << endl;
+
+  if (!CLI::HasParam("k") && CLI::HasParam("neighbors"))
+    Log::Warn << "--neighbors_file ignored because --k is not specified."
+        << endl;
+
+  if (!CLI::HasParam("k") && CLI::HasParam("distances"))
+    Log::Warn << "--distances_file ignored because --k is not specified."
+        << endl;
+
+  if (CLI::GetParam<int>("lists") <= 0)
+    Log::Fatal << "--lists must be positive!" << endl;
+  if (CLI::GetParam<int>("subvectors") <= 0)
+    Log::Fatal << "--subvectors must be positive!" << endl;
+  if (CLI::GetParam<int>("codes") <= 0 || CLI::GetParam<int>("codes") > 256)
+    Log::Fatal << "--codes must be between 1 and 256!" << endl;
+  if (CLI::GetParam<int>("max_iterations") < 0)
+    Log::Fatal << "--max_iterations must be non-negative!" << endl;
+  if (CLI::GetParam<int>("probes") < 0)
+    Log::Fatal << "--probes must be non-negative!" << endl;
+
+  const size_t k = CLI::GetParam<int>("k");
+  const size_t numProbes = (size_t) CLI::GetParam<int>("probes");
+
+  // This declaration is here so that the matrix doesn't go out of scope.
+  arma::mat referenceData;
+
+  PQSearch<> pq;
+  if (CLI::HasParam("reference"))
+  {
+    referenceData = std::move(CLI::GetParam<arma::mat>("reference"));
+    Log::Info << "Loaded reference data from '"
+        << CLI::GetUnmappedParam<arma::mat>("reference") << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+
+    pq.NumLists() = (size_t) CLI::GetParam<int>("lists");
+    pq.NumSubvectors() = (size_t) CLI::GetParam<int>("subvectors");
+    pq.NumCodes() = (size_t) CLI::GetParam<int>("codes");
+    pq.MaxIterations() = (size_t) CLI::GetParam<int>("max_iterations");
+
+    Timer::Start("index_building");
+    pq.Train(referenceData);
+    Timer::Stop("index_building");
+  }
+  else
+  {
+    pq = std::move(CLI::GetParam<PQSearch<>>("input_model"));
+  }
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  if (CLI::HasParam("k"))
+  {
+    Log::Info << "Computing " << k << " approximate nearest neighbors, "
+        << "scanning " << numProbes << " lists per query." << endl;
+
+    Timer::Start("computing_neighbors");
+    if (CLI::HasParam("query"))
+    {
+      const arma::mat queryData =
+          std::move(CLI::GetParam<arma::mat>("query"));
+      Log::Info << "Loaded query data from '"
+          << CLI::GetUnmappedParam<arma::mat>("query") << "' ("
+          << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
+
+      pq.Search(queryData, k, neighbors, distances, numProbes);
+    }
+    else
+    {
+      pq.Search(referenceData, k, neighbors, distances, numProbes);
+    }
+    Timer::Stop("computing_neighbors");
+
+    Log::Info << "Neighbors computed." << endl;
+  }
+
+  // Compute recall, if desired.
+  if (CLI::HasParam("true_neighbors"))
+  {
+    // Load the true neighbors.
+    arma::Mat<size_t> trueNeighbors =
+        std::move(CLI::GetParam<arma::Mat<size_t>>("true_neighbors"));
+    Log::Info << "Loaded true neighbor indices from '"
+        << CLI::GetUnmappedParam<arma::Mat<size_t>>("true_neighbors") << "'."
+        << endl;
+
+    // Compute recall and print it.
+    double recallPercentage = 100 * LSHSearch<>::ComputeRecall(neighbors,
+        trueNeighbors);
+
+    Log::Info << "Recall: " << recallPercentage << endl;
+  }
+
+  // Save output, if desired.
+  if (CLI::HasParam("distances"))
+    CLI::GetParam<arma::mat>("distances") = std::move(distances);
+  if (CLI::HasParam("neighbors"))
+    CLI::GetParam<arma::Mat<size_t>>("neighbors") = std::move(neighbors);
+  if (CLI::HasParam("output_model"))
+    CLI::GetParam<PQSearch<>>("output_model") = std::move(pq);
+
+  CLI::Destroy();
+}
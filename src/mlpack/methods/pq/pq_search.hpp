@@ -0,0 +1,215 @@
+/**
+ * @file pq_search.hpp
+ *
+ * Defines the PQSearch class, which performs approximate nearest neighbor
+ * search with an inverted file of product-quantized vectors (IVF-PQ).  Only a
+ * short code is stored for each reference point, so the index is much smaller
+ * than the reference set.
+ *
+ * The method is described in the following paper:
+ *
+ * @article{jegou2011product,
+ *   title={Product quantization for nearest neighbor search},
+ *   author={Jegou, H. and Douze, M. and Schmid, C.},
+ *   journal={IEEE Transactions on Pattern Analysis and Machine Intelligence},
+ *   volume={33},
+ *   number={1},
+ *   pages={117--128},
+ *   year={2011}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_PQ_PQ_SEARCH_HPP
+#define MLPACK_METHODS_PQ_PQ_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The PQSearch class builds an IVF-PQ index on a reference set, and uses it to
+ * find the approximate nearest neighbors (with the Euclidean distance) of
+ * query points.
+ *
+ * The reference points are first clustered with k-means into numLists lists
+ * (the coarse quantizer).  The residual of each point (its difference to the
+ * centroid of its list) is then split into numSubvectors subvectors, and each
+ * subvector is replaced by the index of its nearest code in a codebook of at
+ * most 256 codes that is learned with k-means for that subvector.  Each point
+ * is thus stored in numSubvectors bytes, plus four bytes for its index.
+ *
+ * To search, the query is compared with the centroids of all lists, and the
+ * numProbes nearest lists are scanned.  For each scanned list, a table of the
+ * distances between each subvector of the query residual and each code is
+ * computed, and the distance to each point of the list is then approximated by
+ * summing numSubvectors entries of that table (asymmetric distance
+ * computation).  The returned distances are these approximations.
+ *
+ * @code
+ * PQSearch<> pq(referenceSet, 256, 16);
+ * pq.Search(querySet, 5, neighbors, distances, 8);
+ * @endcode
+ *
+ * @tparam MatType Type of the reference and query sets.
+ */
+template<typename MatType = arma::mat>
+class PQSearch
+{
+ public:
+  /**
+   * Create the PQSearch object without training it.  Be sure to call Train()
+   * before calling Search().
+   *
+   * @param numLists Number of lists of the coarse quantizer.
+   * @param numSubvectors Number of subvectors each residual is split into.
+   * @param numCodes Number of codes of each subvector codebook (at most 256).
+   * @param maxIterations Maximum number of k-means iterations.
+   */
+  PQSearch(const size_t numLists = 256,
+           const size_t numSubvectors = 8,
+           const size_t numCodes = 256,
+           const size_t maxIterations = 100);
+
+  /**
+   * Create the PQSearch object and build the index on the given reference set.
+   * The reference set is not kept.
+   *
+   * @param referenceSet Set of reference points.
+   * @param numLists Number of lists of the coarse quantizer.
+   * @param numSubvectors Number of subvectors each residual is split into.
+   * @param numCodes Number of codes of each subvector codebook (at most 256).
+   * @param maxIterations Maximum number of k-means iterations.
+   */
+  PQSearch(const MatType& referenceSet,
+           const size_t numLists = 256,
+           const size_t numSubvectors = 8,
+           const size_t numCodes = 256,
+           const size_t maxIterations = 100);
+
+  /**
+   * Build the index on the given reference set, replacing any previous index.
+   * The reference set is not kept.  A std::invalid_argument is thrown if the
+   * parameters do not fit the reference set.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(const MatType& referenceSet);
+
+  /**
+   * Compute the approximate k nearest neighbors of each point in the query
+   * set, and store their indices and approximate distances in the given
+   * matrices, which will have k rows and one column for each query point.  If
+   * fewer than k points are found for a query, the remaining neighbors are set
+   * to NumPoints() and their distances to DBL_MAX.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   * @param numProbes Number of lists to scan for each query.  If 0, all lists
+   *     are scanned.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances,
+              const size_t numProbes = 1) const;
+
+  //! Serialize the index.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+  //! Get the number of lists of the coarse quantizer.
+  size_t NumLists() const { return numLists; }
+  //! Modify the number of lists of the coarse quantizer (used by Train()).
+  size_t& NumLists() { return numLists; }
+
+  //! Get the number of subvectors.
+  size_t NumSubvectors() const { return numSubvectors; }
+  //! Modify the number of subvectors (used by Train()).
+  size_t& NumSubvectors() { return numSubvectors; }
+
+  //! Get the number of codes of each codebook.
+  size_t NumCodes() const { return numCodes; }
+  //! Modify the number of codes of each codebook (used by Train()).
+  size_t& NumCodes() { return numCodes; }
+
+  //! Get the maximum number of k-means iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of k-means iterations (used by Train()).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the number of indexed points.
+  size_t NumPoints() const { return listIndices.n_elem; }
+
+  //! Get the centroids of the lists (one column per list).
+  const arma::mat& Centroids() const { return centroids; }
+
+  //! Get the codebook of the given subvector (one column per code).
+  const arma::mat& Codebook(const size_t i) const { return codebooks[i]; }
+
+  //! Get the first dimension of each subvector, followed by the
+  //! dimensionality.
+  const arma::Col<size_t>& SubvectorStarts() const { return subvectorStarts; }
+
+  //! Get the start of each list, followed by the number of points; the points
+  //! of list i are in [ListOffsets()[i], ListOffsets()[i + 1]).
+  const arma::Col<size_t>& ListOffsets() const { return listOffsets; }
+
+  //! Get the index of each point, in list order.
+  const arma::Col<arma::u32>& ListIndices() const { return listIndices; }
+
+  //! Get the codes of each point, in list order; element (i, j) is the code of
+  //! subvector j of point i.
+  const arma::Mat<unsigned char>& Codes() const { return codes; }
+
+ private:
+  //! Number of lists of the coarse quantizer.
+  size_t numLists;
+  //! Number of subvectors each residual is split into.
+  size_t numSubvectors;
+  //! Number of codes of each codebook.
+  size_t numCodes;
+  //! Maximum number of k-means iterations.
+  size_t maxIterations;
+
+  //! The centroids of the lists.
+  arma::mat centroids;
+  //! The codebook of each subvector.
+  std::vector<arma::mat> codebooks;
+  //! The first dimension of each subvector, followed by the dimensionality.
+  arma::Col<size_t> subvectorStarts;
+
+  //! The start of each list in listIndices and codes, followed by the number
+  //! of points.
+  arma::Col<size_t> listOffsets;
+  //! The index of each point, in list order.
+  arma::Col<arma::u32> listIndices;
+  //! The codes of each point, in list order; one column per subvector, so that
+  //! the codes of a subvector for a whole list are contiguous.
+  arma::Mat<unsigned char> codes;
+
+  /**
+   * Compute the table of the squared distances between each subvector of the
+   * residual of a query and each code of the corresponding codebook.  Column
+   * j holds the distances for subvector j.
+   *
+   * @param residual Difference between the query and a centroid.
+   * @param table Matrix to store the distance table in.
+   */
+  void DistanceTable(const arma::vec& residual, arma::fmat& table) const;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "pq_search_impl.hpp"
+
+#endif
@@ -0,0 +1,286 @@
+/**
+ * @file pq_search_impl.hpp
+ *
+ * Implementation of the PQSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_PQ_PQ_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_PQ_PQ_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "pq_search.hpp"
+
+#include <queue>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/util/simd.hpp>
+#include <mlpack/methods/kmeans/kmeans.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+// Non-training constructor.
+template<typename MatType>
+PQSearch<MatType>::PQSearch(const size_t numLists,
+                            const size_t numSubvectors,
+                            const size_t numCodes,
+                            const size_t maxIterations) :
+    numLists(numLists),
+    numSubvectors(numSubvectors),
+    numCodes(numCodes),
+    maxIterations(maxIterations)
+{
+  // Nothing to do.
+}
+
+// Training constructor.
+template<typename MatType>
+PQSearch<MatType>::PQSearch(const MatType& referenceSet,
+                            const size_t numLists,
+                            const size_t numSubvectors,
+                            const size_t numCodes,
+                            const size_t maxIterations) :
+    numLists(numLists),
+    numSubvectors(numSubvectors),
+    numCodes(numCodes),
+    maxIterations(maxIterations)
+{
+  Train(referenceSet);
+}
+
+// Build the index.
+template<typename MatType>
+void PQSearch<MatType>::Train(const MatType& referenceSet)
+{
+  const size_t numPoints = referenceSet.n_cols;
+  const size_t dimensionality = referenceSet.n_rows;
+
+  if (numCodes == 0 || numCodes > 256)
+    throw std::invalid_argument("PQSearch::Train(): the number of codes must "
+        "be between 1 and 256!");
+  if (numSubvectors == 0 || numSubvectors > dimensionality)
+    throw std::invalid_argument("PQSearch::Train(): the number of subvectors "
+        "must be between 1 and the dimensionality of the data!");
+  if (numLists == 0 || numLists > numPoints)
+    throw std::invalid_argument("PQSearch::Train(): the number of lists must "
+        "be between 1 and the number of reference points!");
+  // Point indices are stored in 32 bits.
+  if (numPoints > UINT32_MAX)
+    throw std::invalid_argument("PQSearch::Train(): too many reference "
+        "points!");
+
+  // Step I: build the coarse quantizer.  The residuals of the points are then
+  // computed in place.
+  arma::mat residuals = arma::conv_to<arma::mat>::from(referenceSet);
+  kmeans::KMeans<> kmeans(maxIterations);
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(residuals, numLists, assignments, centroids);
+  for (size_t i = 0; i < numPoints; ++i)
+    residuals.col(i) -= centroids.col(assignments[i]);
+
+  // Step II: put the points in their lists, which are stored one after the
+  // other.
+  listOffsets.zeros(numLists + 1);
+  for (size_t i = 0; i < numPoints; ++i)
+    listOffsets[assignments[i] + 1]++;
+  for (size_t l = 0; l < numLists; ++l)
+    listOffsets[l + 1] += listOffsets[l];
+
+  arma::Col<size_t> positions(numPoints);
+  arma::Col<size_t> listFill = listOffsets.subvec(0, numLists - 1);
+  listIndices.set_size(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    positions[i] = listFill[assignments[i]]++;
+    listIndices[positions[i]] = i;
+  }
+
+  // Step III: split the residuals into subvectors, whose dimensionalities
+  // differ by at most one, and quantize each subvector with its own codebook.
+  subvectorStarts.set_size(numSubvectors + 1);
+  for (size_t j = 0; j <= numSubvectors; ++j)
+    subvectorStarts[j] = (j * dimensionality) / numSubvectors;
+
+  const size_t subvectorCodes = std::min(numCodes, numPoints);
+  codebooks.clear();
+  codebooks.resize(numSubvectors);
+  codes.set_size(numPoints, numSubvectors);
+  for (size_t j = 0; j < numSubvectors; ++j)
+  {
+    const arma::mat subvectors = residuals.rows(subvectorStarts[j],
+        subvectorStarts[j + 1] - 1);
+    arma::Row<size_t> subvectorAssignments;
+    kmeans.Cluster(subvectors, subvectorCodes, subvectorAssignments,
+        codebooks[j]);
+
+    for (size_t i = 0; i < numPoints; ++i)
+      codes(positions[i], j) = (unsigned char) subvectorAssignments[i];
+  }
+
+  Log::Info << "Built IVF-PQ index of " << numPoints << " points with "
+      << numLists << " lists and " << numSubvectors << " subvectors of "
+      << subvectorCodes << " codes (" << numSubvectors + sizeof(arma::u32)
+      << " bytes per point)." << std::endl;
+}
+
+// Compute the distance table of a query residual.
+template<typename MatType>
+void PQSearch<MatType>::DistanceTable(const arma::vec& residual,
+                                      arma::fmat& table) const
+{
+  table.set_size(codebooks[0].n_cols, numSubvectors);
+  for (size_t j = 0; j < numSubvectors; ++j)
+  {
+    const arma::mat& codebook = codebooks[j];
+    const arma::vec subvector = residual.subvec(subvectorStarts[j],
+        subvectorStarts[j + 1] - 1);
+    for (size_t c = 0; c < codebook.n_cols; ++c)
+      table(c, j) = (float) metric::SquaredEuclideanDistance::Evaluate(
+          subvector, codebook.col(c));
+  }
+}
+
+// Search for approximate nearest neighbors.
+template<typename MatType>
+void PQSearch<MatType>::Search(const MatType& querySet,
+                               const size_t k,
+                               arma::Mat<size_t>& neighbors,
+                               arma::mat& distances,
+                               const size_t numProbes) const
+{
+  if (querySet.n_rows != centroids.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "PQSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality the model "
+        << "was trained on (" << centroids.n_rows << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (k > NumPoints())
+  {
+    std::ostringstream oss;
+    oss << "PQSearch::Search(): requested " << k << " approximate nearest "
+        << "neighbors, but reference set has " << NumPoints() << " points!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+  if (k == 0)
+    return;
+
+  // Scan all of the lists if no number is given, or if more lists than exist
+  // are requested.
+  const size_t probes = (numProbes == 0 || numProbes > centroids.n_cols) ?
+      centroids.n_cols : numProbes;
+
+  // Candidate represents a possible candidate neighbor (squared distance,
+  // index); the worst candidate is at the top of the queue.
+  typedef std::pair<double, size_t> Candidate;
+  typedef std::priority_queue<Candidate> CandidateList;
+
+  // Parallelization to process more than one query at a time.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for \
+      shared(neighbors, distances) \
+      schedule(dynamic)
+  for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+  #pragma omp parallel for \
+      shared(neighbors, distances) \
+      schedule(dynamic)
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
+  {
+    const arma::vec query = arma::conv_to<arma::vec>::from(querySet.col(q));
+
+    // Find the lists whose centroids are nearest to the query.
+    arma::vec coarseDistances(centroids.n_cols);
+    for (size_t l = 0; l < centroids.n_cols; ++l)
+      coarseDistances[l] = metric::SquaredEuclideanDistance::Evaluate(query,
+          centroids.col(l));
+    const arma::uvec order = arma::sort_index(coarseDistances);
+
+    std::vector<Candidate> vect(k, std::make_pair(DBL_MAX, NumPoints()));
+    CandidateList pqueue(std::less<Candidate>(), std::move(vect));
+
+    arma::fmat table;
+    std::vector<float> listDistances;
+    for (size_t p = 0; p < probes; ++p)
+    {
+      const size_t l = order[p];
+      const size_t start = listOffsets[l];
+      const size_t listSize = listOffsets[l + 1] - start;
+      if (listSize == 0)
+        continue;
+
+      DistanceTable(query - centroids.col(l), table);
+
+      // Approximate the squared distance to each point of the list by summing
+      // the table entries of its codes.  The codes of a subvector are
+      // contiguous for the whole list, so this loop is vectorized.
+      listDistances.assign(listSize, 0.0f);
+      float* listDistancesPtr = listDistances.data();
+      for (size_t j = 0; j < numSubvectors; ++j)
+      {
+        const unsigned char* listCodes = codes.colptr(j) + start;
+        const float* tableColumn = table.colptr(j);
+        MLPACK_SIMD
+        for (size_t i = 0; i < listSize; ++i)
+          listDistancesPtr[i] += tableColumn[listCodes[i]];
+      }
+
+      for (size_t i = 0; i < listSize; ++i)
+      {
+        if (listDistances[i] < pqueue.top().first)
+        {
+          pqueue.pop();
+          pqueue.push(std::make_pair(listDistances[i],
+              listIndices[start + i]));
+        }
+      }
+    }
+
+    for (size_t j = 1; j <= k; ++j)
+    {
+      neighbors(k - j, q) = pqueue.top().second;
+      distances(k - j, q) = (pqueue.top().first == DBL_MAX) ? DBL_MAX :
+          std::sqrt(pqueue.top().first);
+      pqueue.pop();
+    }
+  }
+}
+
+template<typename MatType>
+template<typename Archive>
+void PQSearch<MatType>::Serialize(Archive& ar,
+                                  const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(numLists, "numLists");
+  ar & CreateNVP(numSubvectors, "numSubvectors");
+  ar & CreateNVP(numCodes, "numCodes");
+  ar & CreateNVP(maxIterations, "maxIterations");
+  ar & CreateNVP(centroids, "centroids");
+  if (Archive::is_loading::value)
+    codebooks.clear();
+  ar & CreateNVP(codebooks, "codebooks");
+  ar & CreateNVP(subvectorStarts, "subvectorStarts");
+  ar & CreateNVP(listOffsets, "listOffsets");
+  ar & CreateNVP(listIndices, "listIndices");
+  ar & CreateNVP(codes, "codes");
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -57,37 +57,104 @@ PARAM_FLAG("row_major", "If specified, the program will calculate statistics "
     "represents a point, so this option is generally not necessary.)", "r");
 
 /**
-* Calculates the sum of deviations to the Nth Power.
-*
-* @param input Vector that captures a dimension of a dataset.
-* @param rowMean Mean of the given vector.
-* @param n Degree of power.
-* @return sum of nth power deviations.
-*/
-double SumNthPowerDeviations(const arma::rowvec& input,
-                             const double& fMean,
-                             size_t n)
+ * Statistics of one dimension of the dataset.  The central moments are sums of
+ * powers of the deviations from the mean.
+ */
+struct DimensionStatistics
+{
+  //! Number of values.
+  size_t n;
+  //! Smallest value.
+  double min;
+  //! Largest value.
+  double max;
+  //! Mean of the values.
+  double mean;
+  //! Sum of the squared deviations.
+  double m2;
+  //! Sum of the cubed deviations.
+  double m3;
+  //! Sum of the fourth powers of the deviations.
+  double m4;
+  //! Median of the values.
+  double median;
+};
+
+/**
+ * Calculates the statistics of a dimension of a dataset in one pass over its
+ * values, updating the mean and the central moments incrementally for each
+ * value (Terriberry's extension of Welford's algorithm, which is as stable as
+ * computing them from the final mean).  The values are also copied to the
+ * given buffer, where the median is found with std::nth_element().
+ *
+ * @param values Pointer to the first value of the dimension.
+ * @param n Number of values.
+ * @param stride Distance between two consecutive values.
+ * @param buffer Scratch space for the median.
+ * @return Statistics of the dimension.
+ */
+DimensionStatistics Describe(const double* values,
+                             const size_t n,
+                             const size_t stride,
+                             std::vector<double>& buffer)
 {
-  return arma::sum(arma::pow(input - fMean, static_cast<double>(n)));
+  DimensionStatistics stats;
+  stats.n = n;
+  stats.min = std::numeric_limits<double>::infinity();
+  stats.max = -std::numeric_limits<double>::infinity();
+  stats.mean = stats.m2 = stats.m3 = stats.m4 = 0;
+
+  buffer.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const double x = values[i * stride];
+    buffer[i] = x;
+    stats.min = std::min(stats.min, x);
+    stats.max = std::max(stats.max, x);
+
+    const double k = i + 1;
+    const double delta = x - stats.mean;
+    const double deltaK = delta / k;
+    const double deltaK2 = deltaK * deltaK;
+    const double term = delta * deltaK * i;
+
+    stats.mean += deltaK;
+    stats.m4 += term * deltaK2 * (k * k - 3 * k + 3) + 6 * deltaK2 * stats.m2 -
+        4 * deltaK * stats.m3;
+    stats.m3 += term * deltaK * (k - 2) - 3 * deltaK * stats.m2;
+    stats.m2 += term;
+  }
+
+  // If there is an even number of values, the median is the mean of the two
+  // middle values; the lower one is the largest of the lower half.
+  const size_t middle = n / 2;
+  std::nth_element(buffer.begin(), buffer.begin() + middle, buffer.end());
+  stats.median = buffer[middle];
+  if (n % 2 == 0)
+  {
+    stats.median = (stats.median + *std::max_element(buffer.begin(),
+        buffer.begin() + middle)) / 2;
+  }
+
+  return stats;
 }
 
 /**
- * Calculates Skewness of the given vector.
+ * Calculates Skewness of a dimension.
  *
- * @param input Vector that captures a dimension of a dataset
- * @param rowStd Standard Deviation of the given vector.
- * @param rowMean Mean of the given vector.
- * @return Skewness of the given vector.
+ * @param stats Statistics of the dimension.
+ * @param fStd Standard Deviation of the dimension.
+ * @param population If true, calculate the population skewness.
+ * @return Skewness of the dimension.
  */
-double Skewness(const arma::rowvec& input,
-                const double& fStd,
-                const double& fMean,
+double Skewness(const DimensionStatistics& stats,
+                const double fStd,
                 const bool population)
 {
   double skewness = 0;
   const double S3 = pow(fStd, 3);
-  const double M3 = SumNthPowerDeviations(input, fMean, 3);
-  const double n = input.n_elem;
+  const double M3 = stats.m3;
+  const double n = stats.n;
   if (population)
   {
     // Calculate population skewness
@@ -102,25 +169,24 @@ double Skewness(const arma::rowvec& input,
 }
 
 /**
- * Calculates excess kurtosis of the given vector.
+ * Calculates excess kurtosis of a dimension.
  *
- * @param input Vector that captures a dimension of a dataset
- * @param rowStd Standard Deviation of the given vector.
- * @param rowMean Mean of the given vector.
- * @return Kurtosis of the given vector.
+ * @param stats Statistics of the dimension.
+ * @param fStd Standard Deviation of the dimension.
+ * @param population If true, calculate the population excess kurtosis.
+ * @return Kurtosis of the dimension.
  */
-double Kurtosis(const arma::rowvec& input,
-                const double& fStd,
-                const double& fMean,
+double Kurtosis(const DimensionStatistics& stats,
+                const double fStd,
                 const bool population)
 {
   double kurtosis = 0;
-  const double M4 = SumNthPowerDeviations(input, fMean, 4);
-  const double n = input.n_elem;
+  const double M4 = stats.m4;
+  const double n = stats.n;
   if (population)
   {
     // Calculate population excess kurtosis.
-    const double M2 = SumNthPowerDeviations(input, fMean, 2);
+    const double M2 = stats.m2;
     kurtosis = n * (M4 / pow(M2, 2)) - 3;
   }
   else
@@ -180,50 +246,71 @@ int main(int argc, char** argv)
       % "dim" % "var" % "mean" % "std" % "median" % "min" % "max"
       % "range" % "skew" % "kurt" % "SE" << endl;
 
-  // Lambda function to print out the results.
-  auto PrintStatResults = [&](size_t dim, bool rowMajor)
+  // The dimensions to describe.
+  const size_t dimensions = rowMajor ? data.n_cols : data.n_rows;
+  if ((rowMajor ? data.n_rows : data.n_cols) == 0)
+    Log::Fatal << "The dataset has no points!" << endl;
+
+  std::vector<size_t> dims;
+  if (CLI::HasParam("dimension"))
+  {
+    if (dimension >= dimensions)
+      Log::Fatal << "Invalid dimension " << dimension << "; the dataset has "
+          << dimensions << " dimensions." << endl;
+    dims.push_back(dimension);
+  }
+  else
+  {
+    for (size_t i = 0; i < dimensions; ++i)
+      dims.push_back(i);
+  }
+
+  // Compute the statistics of each dimension in parallel.  Dimensions are rows
+  // of the matrix (so their values are n_rows elements apart), or columns if
+  // --row_major is given.
+  std::vector<DimensionStatistics> stats(dims.size());
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #ifdef _WIN32
+    #pragma omp parallel for
+    for (intmax_t i = 0; i < (intmax_t) dims.size(); ++i)
+  #else
+    #pragma omp parallel for
+    for (size_t i = 0; i < dims.size(); ++i)
+  #endif
   {
-    arma::rowvec feature;
+    std::vector<double> buffer;
     if (rowMajor)
-      feature = arma::conv_to<arma::rowvec>::from(data.col(dim));
+      stats[i] = Describe(data.colptr(dims[i]), data.n_rows, 1, buffer);
     else
-      feature = data.row(dim);
+      stats[i] = Describe(data.memptr() + dims[i], data.n_cols, data.n_rows,
+          buffer);
+  }
 
+  // Print out the results.
+  for (size_t i = 0; i < dims.size(); ++i)
+  {
     // f at the front of the variable names means "feature".
-    const double fMax = arma::max(feature);
-    const double fMin = arma::min(feature);
-    const double fMean = arma::mean(feature);
-    const double fStd = arma::stddev(feature, population);
+    const DimensionStatistics& s = stats[i];
+    const double fVar = s.m2 / (population ? s.n : s.n - 1);
+    const double fStd = sqrt(fVar);
 
     // Print statistics of the given dimension.
     Log::Info << boost::format(numberFormat)
-        % dim
-        % arma::var(feature, population)
-        % fMean
+        % dims[i]
+        % fVar
+        % s.mean
         % fStd
-        % arma::median(feature)
-        % fMin
-        % fMax
-        % (fMax - fMin) // range
-        % Skewness(feature, fStd, fMean, population)
-        % Kurtosis(feature, fStd, fMean, population)
-        % StandardError(feature.n_elem, fStd)
+        % s.median
+        % s.min
+        % s.max
+        % (s.max - s.min) // range
+        % Skewness(s, fStd, population)
+        % Kurtosis(s, fStd, population)
+        % StandardError(s.n, fStd)
         << endl;
-  };
-
-  // If the user specified dimension, describe statistics of the given
-  // dimension. If a dimension is not specified, describe all dimensions.
-  if (CLI::HasParam("dimension"))
-  {
-    PrintStatResults(dimension, rowMajor);
-  }
-  else
-  {
-    const size_t dimensions = rowMajor ? data.n_cols : data.n_rows;
-    for (size_t i = 0; i < dimensions; ++i)
-    {
-      PrintStatResults(i, rowMajor);
-    }
   }
   Timer::Stop("statistics");
 }
@@ -182,10 +182,7 @@ int main(int argc, char** argv)
       Log::Info << "Performing '" << strategy << "' imputation strategy "
           << "to replace '" << missingValue << "' on all dimensions." << endl;
 
-      for (size_t i : dirtyDimensions)
-      {
-        imputer.Impute(input, missingValue, i);
-      }
+      imputer.Impute(input, missingValue, dirtyDimensions);
     }
     Timer::Stop("imputation");
 
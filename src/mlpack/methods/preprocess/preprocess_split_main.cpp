@@ -43,7 +43,16 @@ PROGRAM_INFO("Split Data", "This utility takes a dataset and optionally labels "
     "\n\n"
     "$ mlpack_preprocess_split -i dataset.csv -I labels.csv -r 0.3\n"
     "> -t training_set.csv -l training_labels.csv -T test_set.csv\n"
-    "> -L test_labels.csv");
+    "> -L test_labels.csv"
+    "\n\n"
+    "If --stratify (-z) is given, each class of the labels is split with the "
+    "given ratio, so that both sets keep the proportions of the classes."
+    "\n\n"
+    "Large datasets can be split without loading them with --streaming: the "
+    "data file is then read and the training and test files written one line "
+    "at a time, so this only works for text files with one point per line "
+    "(such as CSV files), and the points keep their order in the file.  Only "
+    "the labels are loaded.");
 
 // Define parameters for data.
 PARAM_MATRIX_IN_REQ("input", "Matrix containing data.", "i");
@@ -59,6 +68,12 @@ PARAM_UMATRIX_OUT("test_labels", "Matrix to save test labels to.", "L");
 PARAM_DOUBLE_IN("test_ratio", "Ratio of test set; if not set,"
     "the ratio defaults to 0.2", "r", 0.2);
 
+PARAM_FLAG("stratify", "If true, split each class with the test ratio, so that "
+    "the training and test sets have the same proportions of the classes.",
+    "z");
+PARAM_FLAG("streaming", "If true, split the data file line by line instead of "
+    "loading it (for text files with one point per line).", "");
+
 PARAM_INT_IN("seed", "Random seed (0 for std::time(NULL)).", "s", 0);
 
 using namespace mlpack;
@@ -123,8 +138,62 @@ int main(int argc, char** argv)
         << " set to 0.2." << endl;
   }
 
-  // Load the data.
+  if (CLI::HasParam("stratify") && !CLI::HasParam("input_labels"))
+    Log::Fatal << "--stratify (-z) requires --input_labels_file (-I)." << endl;
+
+  if (CLI::HasParam("streaming"))
+  {
+    if (!CLI::HasParam("training") || !CLI::HasParam("test"))
+      Log::Fatal << "--streaming requires both --training_file (-t) and "
+          << "--test_file (-T)." << endl;
+
+    // The data is never loaded, so the outputs are written directly to their
+    // files; CLI does not save the (empty) output matrices.
+    const string inputFile = CLI::GetUnmappedParam<arma::mat>("input");
+    const string trainFile = CLI::GetUnmappedParam<arma::mat>("training");
+    const string testFile = CLI::GetUnmappedParam<arma::mat>("test");
+
+    try
+    {
+      if (CLI::HasParam("input_labels"))
+      {
+        arma::Row<size_t> labelsRow =
+            CLI::GetParam<arma::Mat<size_t>>("input_labels").row(0);
+
+        arma::Row<size_t> trainLabels, testLabels;
+        data::SplitFile(inputFile, labelsRow, trainFile, testFile, trainLabels,
+            testLabels, testRatio, CLI::HasParam("stratify"));
+        Log::Info << "Training data contains " << trainLabels.n_elem
+            << " points." << endl;
+        Log::Info << "Test data contains " << testLabels.n_elem << " points."
+            << endl;
+
+        if (CLI::HasParam("training_labels"))
+          CLI::GetParam<arma::Mat<size_t>>("training_labels") =
+              std::move(trainLabels);
+        if (CLI::HasParam("test_labels"))
+          CLI::GetParam<arma::Mat<size_t>>("test_labels") =
+              std::move(testLabels);
+      }
+      else
+      {
+        const size_t testSize = data::SplitFile(inputFile, trainFile, testFile,
+            testRatio);
+        Log::Info << "Test data contains " << testSize << " points." << endl;
+      }
+    }
+    catch (std::exception& e)
+    {
+      Log::Fatal << "Cannot split '" << inputFile << "': " << e.what() << endl;
+    }
+
+    return 0;
+  }
+
+  // Load the data.  It is split in place, so the only copies made are those of
+  // the outputs.
   arma::mat& data = CLI::GetParam<arma::mat>("input");
+  arma::mat trainData, testData;
 
   // If parameters for labels exist, we must split the labels too.
   if (CLI::HasParam("input_labels"))
@@ -132,35 +201,34 @@ int main(int argc, char** argv)
     arma::Mat<size_t>& labels =
         CLI::GetParam<arma::Mat<size_t>>("input_labels");
     arma::Row<size_t> labelsRow = labels.row(0);
+    if (labelsRow.n_elem != data.n_cols)
+      Log::Fatal << "The number of labels (" << labelsRow.n_elem << ") does "
+          << "not match the number of points (" << data.n_cols << ")!" << endl;
+
+    arma::Row<size_t> trainLabels, testLabels;
+    if (CLI::HasParam("stratify"))
+      data::StratifiedSplitInPlace(data, labelsRow, trainData, testData,
+          trainLabels, testLabels, testRatio);
+    else
+      data::SplitInPlace(data, labelsRow, trainData, testData, trainLabels,
+          testLabels, testRatio);
 
-    const auto value = data::Split(data, labelsRow, testRatio);
-    Log::Info << "Training data contains " << get<0>(value).n_cols << " points."
-        << endl;
-    Log::Info << "Test data contains " << get<1>(value).n_cols << " points."
-        << endl;
-
-    if (CLI::HasParam("training"))
-      CLI::GetParam<arma::mat>("training") = std::move(get<0>(value));
-    if (CLI::HasParam("test"))
-      CLI::GetParam<arma::mat>("test") = std::move(get<1>(value));
     if (CLI::HasParam("training_labels"))
-      CLI::GetParam<arma::Mat<size_t>>("training_labels") =
-          std::move(get<2>(value));
+      CLI::GetParam<arma::Mat<size_t>>("training_labels") = trainLabels;
     if (CLI::HasParam("test_labels"))
-      CLI::GetParam<arma::Mat<size_t>>("test_labels") =
-          std::move(get<3>(value));
+      CLI::GetParam<arma::Mat<size_t>>("test_labels") = testLabels;
   }
   else // We have no labels, so just split the dataset.
   {
-    const auto value = data::Split(data, testRatio);
-    Log::Info << "Training data contains " << get<0>(value).n_cols << " points."
-        << endl;
-    Log::Info << "Test data contains " << get<1>(value).n_cols << " points."
-        << endl;
-
-    if (CLI::HasParam("training"))
-      CLI::GetParam<arma::mat>("training") = std::move(get<0>(value));
-    if (CLI::HasParam("test"))
-      CLI::GetParam<arma::mat>("test") = std::move(get<1>(value));
+    data::SplitInPlace(data, trainData, testData, testRatio);
   }
+
+  Log::Info << "Training data contains " << trainData.n_cols << " points."
+      << endl;
+  Log::Info << "Test data contains " << testData.n_cols << " points." << endl;
+
+  if (CLI::HasParam("training"))
+    CLI::GetParam<arma::mat>("training") = trainData;
+  if (CLI::HasParam("test"))
+    CLI::GetParam<arma::mat>("test") = testData;
 }
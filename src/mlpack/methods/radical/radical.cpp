@@ -13,6 +13,7 @@
 #include "radical.hpp"
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/timers.hpp>
+#include <mlpack/core/math/random.hpp>
 
 using namespace std;
 using namespace arma;
@@ -43,53 +44,124 @@ void Radical::CopyAndPerturb(mat& xNew, const mat& x) const
 }
 
 
-double Radical::Vasicek(vec& z) const
+//! Sum the logarithms of the m-spacings of the given sorted sample.
+static double SumLogSpacings(const double* z, const size_t n, const size_t m)
 {
-  z = sort(z);
-
-  // Apparently slower.
-  /*
-  vec logs = log(z.subvec(m, z.n_elem - 1) - z.subvec(0, z.n_elem - 1 - m));
-  //vec val = sum(log(z.subvec(m, nPoints - 1) - z.subvec(0, nPoints - 1 - m)));
-  return (double) sum(logs);
-  */
-
-  // Apparently faster.
+  // Apparently faster than the vectorized version.
   double sum = 0;
-  uword range = z.n_elem - m;
-  for (uword i = 0; i < range; i++)
+  const size_t range = n - m;
+  for (size_t i = 0; i < range; i++)
   {
-    sum += log(z(i + m) - z(i));
+    sum += log(z[i + m] - z[i]);
   }
 
   return sum;
 }
 
+/**
+ * Sort the given values into 'keys', starting from the order of the values of
+ * the previous angle, which is stored in 'order' and updated.  Consecutive
+ * angles are close, so that order is almost right and insertion sort only
+ * moves a few elements; if it moves too many, std::sort() takes over.  The
+ * sorted values are the same either way.
+ */
+static void SortFromPreviousOrder(const vec& values,
+                                  std::vector<uword>& order,
+                                  std::vector<double>& keys,
+                                  const bool first)
+{
+  const size_t n = values.n_elem;
+  const size_t maxMoves = 16 * n;
+  size_t moves = 0;
+
+  if (!first)
+  {
+    for (size_t i = 0; i < n; i++)
+      keys[i] = values[order[i]];
+
+    for (size_t i = 1; i < n && moves <= maxMoves; i++)
+    {
+      const double key = keys[i];
+      const uword index = order[i];
+      size_t j = i;
+      for ( ; j > 0 && keys[j - 1] > key; j--)
+      {
+        keys[j] = keys[j - 1];
+        order[j] = order[j - 1];
+      }
+      keys[j] = key;
+      order[j] = index;
+      moves += i - j;
+    }
+  }
+
+  if (first || moves > maxMoves)
+  {
+    std::sort(order.begin(), order.end(), [&values](const uword a,
+        const uword b) { return values[a] < values[b]; });
+    for (size_t i = 0; i < n; i++)
+      keys[i] = values[order[i]];
+  }
+}
+
+double Radical::Vasicek(vec& z) const
+{
+  z = sort(z);
+  return SumLogSpacings(z.memptr(), z.n_elem, m);
+}
+
 
 double Radical::DoRadical2D(const mat& matX)
 {
   CopyAndPerturb(perturbed, matX);
+  return SearchAngles(perturbed);
+}
 
-  mat::fixed<2, 2> matJacobi;
-
+double Radical::SearchAngles(const mat& sample) const
+{
   vec values(angles);
+  const size_t n = sample.n_rows;
 
-  for (size_t i = 0; i < angles; i++)
+  // Every angle is independent, so they are evaluated in parallel.  Each
+  // thread gets a contiguous range of angles, so that it can sort the
+  // rotated sample of each angle starting from the order of the previous one.
+  #pragma omp parallel
   {
-    const double theta = (i / (double) angles) * M_PI / 2.0;
-    const double cosTheta = cos(theta);
-    const double sinTheta = sin(theta);
+    vec y1(n), y2(n);
+    std::vector<uword> order1(n), order2(n);
+    std::vector<double> keys1(n), keys2(n);
+    for (size_t k = 0; k < n; k++)
+    {
+      order1[k] = k;
+      order2[k] = k;
+    }
+    bool first = true;
+
+  #ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables.
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) angles; i++)
+  #else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < angles; i++)
+  #endif
+    {
+      const double theta = (i / (double) angles) * M_PI / 2.0;
+      const double cosTheta = cos(theta);
+      const double sinTheta = sin(theta);
 
-    matJacobi(0, 0) = cosTheta;
-    matJacobi(1, 0) = -sinTheta;
-    matJacobi(0, 1) = sinTheta;
-    matJacobi(1, 1) = cosTheta;
+      // Rotate the sample by the Jacobi rotation of the angle.
+      y1 = cosTheta * sample.col(0) - sinTheta * sample.col(1);
+      y2 = sinTheta * sample.col(0) + cosTheta * sample.col(1);
 
-    candidate = perturbed * matJacobi;
-    vec candidateY1 = candidate.unsafe_col(0);
-    vec candidateY2 = candidate.unsafe_col(1);
+      SortFromPreviousOrder(y1, order1, keys1, first);
+      SortFromPreviousOrder(y2, order2, keys2, first);
+      first = false;
 
-    values(i) = Vasicek(candidateY1) + Vasicek(candidateY2);
+      values(i) = SumLogSpacings(keys1.data(), n, m) +
+          SumLogSpacings(keys2.data(), n, m);
+    }
   }
 
   uword indOpt = 0;
@@ -132,42 +204,84 @@ void Radical::DoRadical(const mat& matXT, mat& matY, mat& matW)
   Timer::Start("radical_do_radical");
   matW = matWhitening;
 
-  mat matYSubspace(nPoints, 2);
-
-  mat matJ = eye(nDims, nDims);
+  // Each sweep visits every pair of dimensions once, in the rounds of a
+  // round-robin tournament: the pairs of a round are disjoint, so their
+  // rotations are independent and they are searched in parallel.  With an odd
+  // number of dimensions, the pairs with the dummy dimension nDims are
+  // skipped.
+  const size_t nSlots = nDims + (nDims % 2);
+  std::vector<size_t> slots(nSlots);
+  std::vector<std::pair<size_t, size_t>> pairs;
+  std::vector<uint64_t> seeds;
+  vec thetas;
 
   for (size_t sweepNum = 0; sweepNum < sweeps; sweepNum++)
   {
     Log::Info << "RADICAL: sweep " << sweepNum << "." << std::endl;
 
-    for (size_t i = 0; i < nDims - 1; i++)
+    for (size_t round = 0; round + 1 < nSlots; round++)
     {
-      for (size_t j = i + 1; j < nDims; j++)
-      {
-        Log::Debug << "RADICAL 2D on dimensions " << i << " and " << j << "."
-            << std::endl;
-
-        matYSubspace.col(0) = matY.col(i);
-        matYSubspace.col(1) = matY.col(j);
-
-        const double thetaOpt = DoRadical2D(matYSubspace);
-
-        const double cosThetaOpt = cos(thetaOpt);
-        const double sinThetaOpt = sin(thetaOpt);
+      // Slot 0 stays in place and the other ones rotate.
+      slots[0] = 0;
+      for (size_t k = 1; k < nSlots; k++)
+        slots[k] = ((k - 1 + round) % (nSlots - 1)) + 1;
 
-        // Set elements of transformation matrix.
-        matJ(i, i) = cosThetaOpt;
-        matJ(j, i) = -sinThetaOpt;
-        matJ(i, j) = sinThetaOpt;
-        matJ(j, j) = cosThetaOpt;
+      pairs.clear();
+      for (size_t k = 0; k < nSlots / 2; k++)
+      {
+        const size_t i = std::min(slots[k], slots[nSlots - 1 - k]);
+        const size_t j = std::max(slots[k], slots[nSlots - 1 - k]);
+        if (j < nDims)
+        {
+          Log::Debug << "RADICAL 2D on dimensions " << i << " and " << j << "."
+              << std::endl;
+          pairs.push_back(std::make_pair(i, j));
+        }
+      }
 
-        matY *= matJ;
+      // The noise of each pair comes from its own generator, so the result
+      // does not depend on the number of threads.
+      seeds.resize(pairs.size());
+      for (size_t p = 0; p < pairs.size(); p++)
+        seeds[p] = math::RandGen()();
+      thetas.set_size(pairs.size());
+
+    #ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables.
+      #pragma omp parallel for schedule(dynamic) if (pairs.size() > 1)
+      for (intmax_t p = 0; p < (intmax_t) pairs.size(); p++)
+    #else
+      #pragma omp parallel for schedule(dynamic) if (pairs.size() > 1)
+      for (size_t p = 0; p < pairs.size(); p++)
+    #endif
+      {
+        math::Xoshiro256 generator;
+        generator.Seed(seeds[p]);
+
+        mat pairPerturbed(replicates * nPoints, 2);
+        generator.FillNormal(pairPerturbed.memptr(), pairPerturbed.n_elem);
+        pairPerturbed *= noiseStdDev;
+        pairPerturbed.col(0) += repmat(matY.col(pairs[p].first), replicates,
+            1);
+        pairPerturbed.col(1) += repmat(matY.col(pairs[p].second), replicates,
+            1);
+
+        thetas[p] = SearchAngles(pairPerturbed);
+      }
 
-        // Unset elements of transformation matrix, so matJ = eye() again.
-        matJ(i, i) = 1;
-        matJ(j, i) = 0;
-        matJ(i, j) = 0;
-        matJ(j, j) = 1;
+      // Rotate the two dimensions of every pair, as matY * J would with the
+      // Jacobi rotation J of the best angle.
+      for (size_t p = 0; p < pairs.size(); p++)
+      {
+        const size_t i = pairs[p].first;
+        const size_t j = pairs[p].second;
+        const double cosThetaOpt = cos(thetas[p]);
+        const double sinThetaOpt = sin(thetas[p]);
+
+        const vec yi = matY.col(i);
+        matY.col(i) = cosThetaOpt * yi - sinThetaOpt * matY.col(j);
+        matY.col(j) = sinThetaOpt * yi + cosThetaOpt * matY.col(j);
       }
     }
   }
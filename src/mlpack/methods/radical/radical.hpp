@@ -131,8 +131,13 @@ class Radical
 
   //! Internal matrix, held as member variable to prevent memory reallocations.
   arma::mat perturbed;
-  //! Internal matrix, held as member variable to prevent memory reallocations.
-  arma::mat candidate;
+
+  /**
+   * Find the angle of the rotation of the given perturbed two-dimensional
+   * sample (one point per row) that minimizes the sum of the entropies of the
+   * two coordinates.  The angles are evaluated in parallel.
+   */
+  double SearchAngles(const arma::mat& sample) const;
 };
 
 void WhitenFeatureMajorMatrix(const arma::mat& matX,
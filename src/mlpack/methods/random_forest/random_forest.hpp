@@ -0,0 +1,320 @@
+/**
+ * @file random_forest.hpp
+ *
+ * Definition of the RandomForest class, an ensemble of decision trees trained
+ * on bootstrap samples of the data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_RANDOM_FOREST_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_RANDOM_FOREST_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_tree/decision_tree.hpp>
+#include <mlpack/methods/decision_tree/multiple_random_dimension_select.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * This class implements a random forest: an ensemble of decision trees, each
+ * trained on a bootstrap sample of the training data, and each choosing the
+ * best split of every node among a random subset of the dimensions.  The class
+ * probabilities of a point are the average of the class probabilities given by
+ * the trees.  For more information, see the following paper:
+ *
+ * @code
+ * @article{breiman2001random,
+ *   title={Random forests},
+ *   author={Breiman, L.},
+ *   journal={Machine Learning},
+ *   volume={45},
+ *   number={1},
+ *   pages={5--32},
+ *   year={2001}
+ * }
+ * @endcode
+ *
+ * The trees are trained in parallel, if OpenMP is available.  A bootstrap
+ * sample is not formed by copying the sampled points: each tree is trained on
+ * the distinct sampled points, weighted by the number of times they were
+ * sampled.  The random numbers of each tree come from its own seed, so the
+ * forest does not depend on the number of threads.
+ *
+ * After training (or loading), the trees are flattened into arrays that batch
+ * classification walks; points are classified in parallel.
+ *
+ * @tparam FitnessFunction Fitness function to use for the trees.
+ * @tparam DimensionSelectionType Policy to select the dimensions of each node
+ *     to search for a split; it must provide a static Seed() function, which
+ *     seeds its random numbers on the calling thread.
+ * @tparam NumericSplitType Numeric split type of the trees.
+ * @tparam CategoricalSplitType Categorical split type of the trees.
+ * @tparam ElemType Type of the elements of the data.
+ */
+template<typename FitnessFunction = GiniGain,
+         typename DimensionSelectionType = MultipleRandomDimensionSelect<>,
+         template<typename> class NumericSplitType = BestBinaryNumericSplit,
+         template<typename> class CategoricalSplitType = AllCategoricalSplit,
+         typename ElemType = double>
+class RandomForest
+{
+ public:
+  //! The type of the trees in the forest.
+  typedef DecisionTree<FitnessFunction, NumericSplitType, CategoricalSplitType,
+      DimensionSelectionType, ElemType> DecisionTreeType;
+
+  /**
+   * Construct the random forest without any training or specified labels.
+   */
+  RandomForest() : numClasses(0) { }
+
+  /**
+   * Create a random forest, training it on the given numeric data.
+   *
+   * @param dataset Dataset to train on.
+   * @param labels Labels for each point in the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   */
+  template<typename MatType>
+  RandomForest(const MatType& dataset,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const size_t numTrees = 20,
+               const size_t minimumLeafSize = 1);
+
+  /**
+   * Create a random forest, training it on the given data, whose dimensions
+   * may be numeric or categorical.
+   *
+   * @param dataset Dataset to train on.
+   * @param datasetInfo Type information for each dimension of the dataset.
+   * @param labels Labels for each point in the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   */
+  template<typename MatType>
+  RandomForest(const MatType& dataset,
+               const data::DatasetInfo& datasetInfo,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const size_t numTrees = 20,
+               const size_t minimumLeafSize = 1);
+
+  /**
+   * Create a random forest, training it on the given weighted numeric data.
+   *
+   * @param dataset Dataset to train on.
+   * @param labels Labels for each point in the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weight of each point in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   */
+  template<typename MatType>
+  RandomForest(const MatType& dataset,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const arma::rowvec& weights,
+               const size_t numTrees = 20,
+               const size_t minimumLeafSize = 1);
+
+  /**
+   * Copy another random forest.
+   *
+   * @param other Forest to copy.
+   */
+  RandomForest(const RandomForest& other);
+
+  /**
+   * Take ownership of another random forest.
+   *
+   * @param other Forest to take ownership of.
+   */
+  RandomForest(RandomForest&& other);
+
+  /**
+   * Copy another random forest.
+   *
+   * @param other Forest to copy.
+   */
+  RandomForest& operator=(const RandomForest& other);
+
+  /**
+   * Take ownership of another random forest.
+   *
+   * @param other Forest to take ownership of.
+   */
+  RandomForest& operator=(RandomForest&& other);
+
+  /**
+   * Train the random forest on the given numeric data.  This overwrites the
+   * existing model.
+   *
+   * @param dataset Dataset to train on.
+   * @param labels Labels for each point in the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   */
+  template<typename MatType>
+  void Train(const MatType& dataset,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses,
+             const size_t numTrees = 20,
+             const size_t minimumLeafSize = 1);
+
+  /**
+   * Train the random forest on the given data, whose dimensions may be numeric
+   * or categorical.  This overwrites the existing model.
+   *
+   * @param dataset Dataset to train on.
+   * @param datasetInfo Type information for each dimension of the dataset.
+   * @param labels Labels for each point in the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   */
+  template<typename MatType>
+  void Train(const MatType& dataset,
+             const data::DatasetInfo& datasetInfo,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses,
+             const size_t numTrees = 20,
+             const size_t minimumLeafSize = 1);
+
+  /**
+   * Train the random forest on the given weighted numeric data.  This
+   * overwrites the existing model.
+   *
+   * @param dataset Dataset to train on.
+   * @param labels Labels for each point in the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weight of each point in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   */
+  template<typename MatType>
+  void Train(const MatType& dataset,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses,
+             const arma::rowvec& weights,
+             const size_t numTrees = 20,
+             const size_t minimumLeafSize = 1);
+
+  /**
+   * Predict the class of the given point.
+   *
+   * @param point Point to classify.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point) const;
+
+  /**
+   * Predict the class of the given point, and the probability of each class.
+   *
+   * @param point Point to classify.
+   * @param prediction This will be set to the predicted class of the point.
+   * @param probabilities This will be filled with class probabilities for the
+   *      point.
+   */
+  template<typename VecType>
+  void Classify(const VecType& point,
+                size_t& prediction,
+                arma::vec& probabilities) const;
+
+  /**
+   * Predict the classes of the given points.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions) const;
+
+  /**
+   * Predict the classes of the given points, and the probability of each class
+   * for each point.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   * @param probabilities This will be filled with class probabilities for each
+   *      point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of trees in the forest.
+  size_t NumTrees() const { return trees.size(); }
+
+  //! Get the tree of the given index.
+  const DecisionTreeType& Tree(const size_t i) const { return trees[i]; }
+
+  //! Get the number of classes.
+  size_t NumClasses() const { return numClasses; }
+
+  /**
+   * Serialize the random forest.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  /**
+   * Train the trees on bootstrap samples of the data.
+   */
+  template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+  void Train(const MatType& dataset,
+             const data::DatasetInfo& datasetInfo,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses,
+             const arma::rowvec& weights,
+             const size_t numTrees,
+             const size_t minimumLeafSize);
+
+  /**
+   * Flatten the trees into the node arrays used for classification.
+   */
+  void Flatten();
+
+  /**
+   * Add the class probabilities that each tree gives the point to the given
+   * vector.
+   */
+  template<typename VecType>
+  void AccumulateProbabilities(const VecType& point, double* probabilities)
+      const;
+
+  //! The trees in the forest.
+  std::vector<DecisionTreeType> trees;
+  //! The number of classes.
+  size_t numClasses;
+
+  //! The nodes of all the trees, in breadth-first order within each tree.
+  std::vector<const DecisionTreeType*> nodes;
+  //! For each node with children, the index of its first child in nodes; the
+  //! children are stored together.  For each leaf, the index of its column of
+  //! leafProbabilities.
+  std::vector<size_t> nodeIndices;
+  //! The index in nodes of the root of each tree.
+  std::vector<size_t> roots;
+  //! The class probabilities of each leaf of all the trees.
+  arma::mat leafProbabilities;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "random_forest_impl.hpp"
+
+#endif
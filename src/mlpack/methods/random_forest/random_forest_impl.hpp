@@ -0,0 +1,515 @@
+/**
+ * @file random_forest_impl.hpp
+ *
+ * Implementation of the RandomForest class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_RANDOM_FOREST_IMPL_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_RANDOM_FOREST_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "random_forest.hpp"
+
+#include <queue>
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::RandomForest(
+    const MatType& dataset,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t numTrees,
+    const size_t minimumLeafSize) :
+    numClasses(0)
+{
+  Train(dataset, labels, numClasses, numTrees, minimumLeafSize);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::RandomForest(
+    const MatType& dataset,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t numTrees,
+    const size_t minimumLeafSize) :
+    numClasses(0)
+{
+  Train(dataset, datasetInfo, labels, numClasses, numTrees, minimumLeafSize);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::RandomForest(
+    const MatType& dataset,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t numTrees,
+    const size_t minimumLeafSize) :
+    numClasses(0)
+{
+  Train(dataset, labels, numClasses, weights, numTrees, minimumLeafSize);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::RandomForest(const RandomForest& other) :
+    trees(other.trees),
+    numClasses(other.numClasses)
+{
+  // The node arrays point into the trees, so they must be built again.
+  Flatten();
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::RandomForest(RandomForest&& other) :
+    trees(std::move(other.trees)),
+    numClasses(other.numClasses),
+    nodes(std::move(other.nodes)),
+    nodeIndices(std::move(other.nodeIndices)),
+    roots(std::move(other.roots)),
+    leafProbabilities(std::move(other.leafProbabilities))
+{
+  // Moving the vector of trees does not move the trees themselves, so the node
+  // arrays are still valid.
+  other.numClasses = 0;
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>&
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::operator=(const RandomForest& other)
+{
+  if (this != &other)
+  {
+    trees = other.trees;
+    numClasses = other.numClasses;
+    Flatten();
+  }
+
+  return *this;
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>&
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::operator=(RandomForest&& other)
+{
+  if (this != &other)
+  {
+    trees = std::move(other.trees);
+    numClasses = other.numClasses;
+    nodes = std::move(other.nodes);
+    nodeIndices = std::move(other.nodeIndices);
+    roots = std::move(other.roots);
+    leafProbabilities = std::move(other.leafProbabilities);
+    other.numClasses = 0;
+  }
+
+  return *this;
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Train(const MatType& dataset,
+                                           const arma::Row<size_t>& labels,
+                                           const size_t numClasses,
+                                           const size_t numTrees,
+                                           const size_t minimumLeafSize)
+{
+  data::DatasetInfo info; // Ignored.
+  arma::rowvec weights; // Ignored.
+  Train<false, false>(dataset, info, labels, numClasses, weights, numTrees,
+      minimumLeafSize);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Train(
+    const MatType& dataset,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t numTrees,
+    const size_t minimumLeafSize)
+{
+  arma::rowvec weights; // Ignored.
+  Train<false, true>(dataset, datasetInfo, labels, numClasses, weights,
+      numTrees, minimumLeafSize);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Train(const MatType& dataset,
+                                           const arma::Row<size_t>& labels,
+                                           const size_t numClasses,
+                                           const arma::rowvec& weights,
+                                           const size_t numTrees,
+                                           const size_t minimumLeafSize)
+{
+  data::DatasetInfo info; // Ignored.
+  Train<true, false>(dataset, info, labels, numClasses, weights, numTrees,
+      minimumLeafSize);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Train(
+    const MatType& dataset,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t numTrees,
+    const size_t minimumLeafSize)
+{
+  // Check everything before training, since the trees are trained inside a
+  // parallel region.
+  if (dataset.n_cols != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "RandomForest::Train(): number of points (" << dataset.n_cols << ") "
+        << "does not match number of labels (" << labels.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (UseWeights && weights.n_elem != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "RandomForest::Train(): number of weights (" << weights.n_elem
+        << ") does not match number of labels (" << labels.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (dataset.n_cols == 0)
+    throw std::invalid_argument("RandomForest::Train(): the dataset is empty");
+
+  this->numClasses = numClasses;
+  trees.clear();
+  trees.resize(numTrees, DecisionTreeType(numClasses));
+
+  // Draw the seed of each tree now, so that the trees do not depend on the
+  // number of threads.
+  std::vector<size_t> seeds(numTrees);
+  for (size_t i = 0; i < numTrees; ++i)
+    seeds[i] = (size_t) math::RandInt(std::numeric_limits<int>::max());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < (int) numTrees; ++i)
+  {
+    std::mt19937 generator((std::mt19937::result_type) seeds[i]);
+    DimensionSelectionType::Seed(generator());
+
+    // Draw the bootstrap sample, as the number of times each point is sampled.
+    arma::Col<size_t> counts(dataset.n_cols, arma::fill::zeros);
+    std::uniform_int_distribution<size_t> dist(0, dataset.n_cols - 1);
+    for (size_t j = 0; j < dataset.n_cols; ++j)
+      ++counts[dist(generator)];
+
+    // Train on the sampled points, weighted by their counts.
+    const arma::uvec sampled = arma::find(counts > 0);
+    arma::rowvec sampleWeights =
+        arma::conv_to<arma::rowvec>::from(counts.elem(sampled).t());
+    if (UseWeights)
+      sampleWeights %= weights.cols(sampled);
+
+    MatType sampleData = dataset.cols(sampled);
+    arma::Row<size_t> sampleLabels = labels.cols(sampled);
+    if (UseDatasetInfo)
+    {
+      trees[i].Train(std::move(sampleData), datasetInfo,
+          std::move(sampleLabels), numClasses, std::move(sampleWeights),
+          minimumLeafSize);
+    }
+    else
+    {
+      trees[i].Train(std::move(sampleData), std::move(sampleLabels),
+          numClasses, std::move(sampleWeights), minimumLeafSize);
+    }
+  }
+
+  Flatten();
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Flatten()
+{
+  nodes.clear();
+  nodeIndices.clear();
+  roots.clear();
+
+  // First count the leaves, so the leaf probabilities can be stored together.
+  size_t numLeaves = 0;
+  std::queue<const DecisionTreeType*> queue;
+  for (size_t t = 0; t < trees.size(); ++t)
+  {
+    queue.push(&trees[t]);
+    while (!queue.empty())
+    {
+      const DecisionTreeType* node = queue.front();
+      queue.pop();
+      if (node->NumChildren() == 0)
+        ++numLeaves;
+      for (size_t c = 0; c < node->NumChildren(); ++c)
+        queue.push(&node->Child(c));
+    }
+  }
+  leafProbabilities.zeros(numClasses, numLeaves);
+
+  // Now store the nodes of each tree in breadth-first order; the children of a
+  // node are then stored together, right after the children of the nodes
+  // before it.
+  size_t leaf = 0;
+  for (size_t t = 0; t < trees.size(); ++t)
+  {
+    roots.push_back(nodes.size());
+    size_t next = nodes.size() + 1; // Index of the next child to be stored.
+    queue.push(&trees[t]);
+    while (!queue.empty())
+    {
+      const DecisionTreeType* node = queue.front();
+      queue.pop();
+      nodes.push_back(node);
+      if (node->NumChildren() == 0)
+      {
+        const arma::vec& probabilities = node->ClassProbabilities();
+        const size_t n = std::min((size_t) probabilities.n_elem, numClasses);
+        for (size_t c = 0; c < n; ++c)
+          leafProbabilities(c, leaf) = probabilities[c];
+        nodeIndices.push_back(leaf++);
+      }
+      else
+      {
+        nodeIndices.push_back(next);
+        next += node->NumChildren();
+        for (size_t c = 0; c < node->NumChildren(); ++c)
+          queue.push(&node->Child(c));
+      }
+    }
+  }
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename VecType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::AccumulateProbabilities(
+    const VecType& point,
+    double* probabilities) const
+{
+  for (size_t t = 0; t < roots.size(); ++t)
+  {
+    size_t index = roots[t];
+    while (nodes[index]->NumChildren() != 0)
+      index = nodeIndices[index] + nodes[index]->CalculateDirection(point);
+
+    const double* leaf = leafProbabilities.colptr(nodeIndices[index]);
+    for (size_t c = 0; c < numClasses; ++c)
+      probabilities[c] += leaf[c];
+  }
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename VecType>
+size_t RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Classify(const VecType& point) const
+{
+  size_t prediction;
+  arma::vec probabilities;
+  Classify(point, prediction, probabilities);
+  return prediction;
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename VecType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Classify(const VecType& point,
+                                              size_t& prediction,
+                                              arma::vec& probabilities) const
+{
+  probabilities.zeros(numClasses);
+  if (trees.size() == 0)
+  {
+    prediction = 0;
+    return;
+  }
+
+  AccumulateProbabilities(point, probabilities.memptr());
+  probabilities /= trees.size();
+
+  arma::uword maxIndex;
+  probabilities.max(maxIndex);
+  prediction = (size_t) maxIndex;
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Classify(
+    const MatType& data,
+    arma::Row<size_t>& predictions) const
+{
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Classify(
+    const MatType& data,
+    arma::Row<size_t>& predictions,
+    arma::mat& probabilities) const
+{
+  predictions.zeros(data.n_cols);
+  probabilities.zeros(numClasses, data.n_cols);
+  if (trees.size() == 0)
+    return;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+  {
+    AccumulateProbabilities(data.col(i), probabilities.colptr(i));
+    probabilities.col(i) /= trees.size();
+
+    arma::uword maxIndex;
+    probabilities.col(i).max(maxIndex);
+    predictions[i] = (size_t) maxIndex;
+  }
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename Archive>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+    CategoricalSplitType, ElemType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(numClasses, "numClasses");
+
+  size_t numTrees = trees.size();
+  ar & CreateNVP(numTrees, "numTrees");
+  if (Archive::is_loading::value)
+  {
+    trees.clear();
+    trees.resize(numTrees);
+  }
+
+  for (size_t i = 0; i < trees.size(); ++i)
+  {
+    std::ostringstream oss;
+    oss << "tree" << i;
+    ar & CreateNVP(trees[i], oss.str());
+  }
+
+  // The node arrays are not saved; they are built again from the trees.
+  if (Archive::is_loading::value)
+    Flatten();
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
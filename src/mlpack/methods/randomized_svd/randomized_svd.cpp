@@ -52,12 +52,34 @@ void RandomizedSVD::Apply(const arma::mat& data,
                           arma::vec& s,
                           arma::mat& v,
                           const size_t rank)
+{
+  ApplyCentered(data, u, s, v, rank);
+}
+
+void RandomizedSVD::Apply(const arma::sp_mat& data,
+                          arma::mat& u,
+                          arma::vec& s,
+                          arma::mat& v,
+                          const size_t rank)
+{
+  ApplyCentered(data, u, s, v, rank);
+}
+
+template<typename MatType>
+void RandomizedSVD::ApplyCentered(const MatType& data,
+                                  arma::mat& u,
+                                  arma::vec& s,
+                                  arma::mat& v,
+                                  const size_t rank)
 {
   if (iteratedPower == 0)
     iteratedPower = rank + 2;
 
-  // Center the data into a temporary matrix.
-  arma::vec rowMean = arma::sum(data, 1) / data.n_cols + eps;
+  // The data is centered implicitly: the mean is subtracted in every product
+  // with the data.  (The sum of a sparse matrix is sparse, so it is converted
+  // before the mean is formed.)
+  const arma::mat rowSums(arma::sum(data, 1));
+  arma::vec rowMean = rowSums.col(0) / data.n_cols + eps;
 
   arma::mat R, Q, Qdata;
 
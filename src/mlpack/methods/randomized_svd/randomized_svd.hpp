@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_RANDOMIZED_SVD_RANDOMIZED_SVD_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/batch_prefetcher.hpp>
 
 namespace mlpack {
 namespace svd {
@@ -120,6 +121,58 @@ class RandomizedSVD
              arma::mat& v,
              const size_t rank);
 
+  /**
+   * Apply Principal Component Analysis to the provided sparse data set using
+   * the randomized SVD.  As for dense data, the mean of each dimension is
+   * subtracted implicitly in the matrix products (A * R - mu * (1^T * R)), so
+   * the data is never centered, and never stored densely.
+   *
+   * @param data Sparse data matrix.
+   * @param u First unitary matrix.
+   * @param v Second unitary matrix.
+   * @param sigma Diagonal matrix of singular values.
+   * @param rank Rank of the approximation.
+   */
+  void Apply(const arma::sp_mat& data,
+             arma::mat& u,
+             arma::vec& s,
+             arma::mat& v,
+             const size_t rank);
+
+  /**
+   * Compute the leading left singular vectors and singular values of the
+   * centered data read from the given batch source (see
+   * data/batch_source.hpp), without ever holding more than a few column blocks
+   * of the data in memory.  Only the predictors of the shards are used; a
+   * source without responses returns responses with zero rows.  The blocks are
+   * read by a data::BatchPrefetcher, so the next block is read while the
+   * current one is processed.
+   *
+   * The centering is applied implicitly, and every power iteration is one pass
+   * over the data: the sketch Y = (A - mu 1^T) (A - mu 1^T)^T Q is accumulated
+   * block by block, and never needs more than O(d * l) memory for d dimensions
+   * and l = IteratedPower() sketch vectors.  In total, (MaxIterations() + 3)
+   * passes are made over the data: one to compute the mean, one per power
+   * iteration plus one to form the sketch, and one to project the data onto
+   * the sketch.  The right singular vectors are not computed, since they have
+   * one entry per point.
+   *
+   * @param source Source of the column blocks of the data.
+   * @param u Matrix to store the left singular vectors into.
+   * @param s Vector to store the singular values into.
+   * @param mean Vector to store the mean of the data into.
+   * @param rank Rank of the approximation.
+   * @param blockSize Number of columns in each block.
+   * @return The number of points in the data.
+   */
+  template<typename SourceType>
+  size_t Apply(SourceType& source,
+               arma::mat& u,
+               arma::vec& s,
+               arma::vec& mean,
+               const size_t rank,
+               const size_t blockSize = 65536);
+
   //! Get the size of the normalized power iterations.
   size_t IteratedPower() const { return iteratedPower; }
   //! Modify the size of the normalized power iterations.
@@ -144,9 +197,21 @@ class RandomizedSVD
 
   //! The value used for numerical stability.
   double eps;
+
+  //! Apply the randomized SVD to the given dense or sparse data, centering it
+  //! implicitly.
+  template<typename MatType>
+  void ApplyCentered(const MatType& data,
+                     arma::mat& u,
+                     arma::vec& s,
+                     arma::mat& v,
+                     const size_t rank);
 };
 
 } // namespace svd
 } // namespace mlpack
 
+// Include implementation.
+#include "randomized_svd_impl.hpp"
+
 #endif
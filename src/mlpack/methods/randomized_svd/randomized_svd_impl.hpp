@@ -0,0 +1,112 @@
+/**
+ * @file randomized_svd_impl.hpp
+ *
+ * Implementation of the randomized SVD method for data that is read from a
+ * batch source.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOMIZED_SVD_RANDOMIZED_SVD_IMPL_HPP
+#define MLPACK_METHODS_RANDOMIZED_SVD_RANDOMIZED_SVD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "randomized_svd.hpp"
+
+namespace mlpack {
+namespace svd {
+
+template<typename SourceType>
+size_t RandomizedSVD::Apply(SourceType& source,
+                            arma::mat& u,
+                            arma::vec& s,
+                            arma::vec& mean,
+                            const size_t rank,
+                            const size_t blockSize)
+{
+  data::BatchPrefetcher<SourceType> blocks(source, blockSize, false);
+  arma::mat block, responses;
+
+  // The first pass computes the mean of the data.
+  size_t n = 0;
+  blocks.Reset();
+  while (blocks.Next(block, responses))
+  {
+    if (n == 0)
+    {
+      mean.zeros(block.n_rows);
+    }
+    else if (block.n_rows != mean.n_elem)
+    {
+      throw std::invalid_argument("RandomizedSVD::Apply(): the blocks of the "
+          "data have different numbers of dimensions");
+    }
+
+    mean += arma::sum(block, 1);
+    n += block.n_cols;
+  }
+
+  if (n == 0)
+    throw std::invalid_argument("RandomizedSVD::Apply(): no data to decompose");
+
+  mean /= n;
+
+  const size_t d = mean.n_elem;
+  const size_t k = std::min(rank, d);
+  const size_t l = std::min(std::max(iteratedPower == 0 ? rank + 2 :
+      iteratedPower, k), d);
+
+  // Every pass of the power iterations computes
+  // Y = (A - mu 1^T) (A - mu 1^T)^T Q, one block at a time, and orthonormalizes
+  // it.  The first pass sketches the range of the data with a random Q.
+  arma::mat q = arma::randn<arma::mat>(d, l);
+  arma::mat y, r, projected;
+  for (size_t i = 0; i <= maxIterations; ++i)
+  {
+    y.zeros(d, l);
+    const arma::rowvec meanQ = mean.t() * q;
+
+    blocks.Reset();
+    while (blocks.Next(block, responses))
+    {
+      projected = block.t() * q;
+      projected.each_row() -= meanQ;
+      y += block * projected - mean * arma::sum(projected, 0);
+    }
+
+    arma::qr_econ(q, r, y);
+  }
+
+  // The last pass computes the Gram matrix of the centered data projected onto
+  // Q, whose eigendecomposition gives the singular values and (rotated) left
+  // singular vectors of the centered data.
+  arma::mat gram(l, l, arma::fill::zeros);
+  const arma::vec qMean = q.t() * mean;
+  blocks.Reset();
+  while (blocks.Next(block, responses))
+  {
+    projected = q.t() * block;
+    projected.each_col() -= qMean;
+    gram += projected * projected.t();
+  }
+
+  arma::vec eigval;
+  arma::mat eigvec;
+  arma::eig_sym(eigval, eigvec, 0.5 * (gram + gram.t()));
+
+  // The eigenvalues are in ascending order; keep the k largest, from largest
+  // to smallest.
+  eigval = arma::flipud(eigval);
+  eigvec = arma::fliplr(eigvec);
+  s = arma::sqrt(arma::clamp(eigval.subvec(0, k - 1), 0.0, DBL_MAX));
+  u = q * eigvec.cols(0, k - 1);
+
+  return n;
+}
+
+} // namespace svd
+} // namespace mlpack
+
+#endif
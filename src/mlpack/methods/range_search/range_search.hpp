@@ -16,6 +16,9 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/tree/shared_tree.hpp>
+#include <mlpack/core/tree/hilbert_order.hpp>
 #include "range_search_stat.hpp"
 
 namespace mlpack {
@@ -28,22 +31,27 @@ class TrainVisitor;
  * The RangeSearch class is a template class for performing range searches.  It
  * is implemented in the style of a generalized tree-independent dual-tree
  * algorithm; for more details on the actual algorithm, see the RangeSearchRules
- * class.
+ * class.  If OpenMP is available, single-tree search is parallel over the query
+ * points and dual-tree search is parallel over subtrees of the query tree.
  *
  * @tparam MetricType Metric to use for range search calculations.
  * @tparam MatType Type of data to use.
  * @tparam TreeType Type of tree to use; must satisfy the TreeType policy API.
+ * @tparam StatisticType Statistic of the tree nodes; it must have the
+ *     LastDistance() of RangeSearchStat.  A NeighborSearchStat lets the tree be
+ *     shared with a NeighborSearch model (see tree::SharedTree).
  */
 template<typename MetricType = metric::EuclideanDistance,
          typename MatType = arma::mat,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType = tree::KDTree>
+                  typename TreeMatType> class TreeType = tree::KDTree,
+         typename StatisticType = RangeSearchStat>
 class RangeSearch
 {
  public:
   //! Convenience typedef.
-  typedef TreeType<MetricType, RangeSearchStat, MatType> Tree;
+  typedef TreeType<MetricType, StatisticType, MatType> Tree;
 
   /**
    * Initialize the RangeSearch object with a given reference dataset (this is
@@ -118,6 +126,36 @@ class RangeSearch
               const bool singleMode = false,
               const MetricType metric = MetricType());
 
+  /**
+   * Initialize the RangeSearch object with the given pre-constructed reference
+   * tree, which is taken over by this object.  Optionally, choose to use
+   * single-tree mode, and give an instantiated distance metric.
+   *
+   * @param referenceTree Pre-built tree for reference points, which is moved.
+   * @param singleMode Whether single-tree computation should be used (as
+   *      opposed to dual-tree computation).
+   * @param metric Instantiated distance metric.
+   */
+  RangeSearch(Tree&& referenceTree,
+              const bool singleMode = false,
+              const MetricType metric = MetricType());
+
+  /**
+   * Initialize the RangeSearch object with the given shared reference tree,
+   * which is neither copied nor modified, so that other models can search it
+   * at the same time (see tree::SharedTree).  As with the other constructors
+   * that take a tree, the reference indices of the results are in the order of
+   * the tree; SharedTree::MapNeighbors() maps them back.
+   *
+   * @param referenceTree Shared pre-built tree for reference points.
+   * @param singleMode Whether single-tree computation should be used (as
+   *      opposed to dual-tree computation).
+   * @param metric Instantiated distance metric.
+   */
+  RangeSearch(const tree::SharedTree<Tree>& referenceTree,
+              const bool singleMode = false,
+              const MetricType metric = MetricType());
+
   /**
    * Initialize the RangeSearch object without any reference data.  If the
    * monochromatic Search() is called before a reference set is set with
@@ -299,11 +337,82 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, returning the results in compressed sparse row form: the
+   * indices and distances of the points in the range of query point i are
+   * neighbors[offsets[i]] to neighbors[offsets[i + 1] - 1] and
+   * distances[offsets[i]] to distances[offsets[i + 1] - 1].  So, offsets has
+   * one more element than the number of query points, and all the results are
+   * held in two contiguous vectors instead of one vector per query point.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param offsets Vector which will hold the offset of the results of each
+   *      query point, and the total number of results as its last element.
+   * @param neighbors Vector which will hold the indices of the results.
+   * @param distances Vector which will hold the distances of the results.
+   */
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              arma::Col<size_t>& offsets,
+              arma::Col<size_t>& neighbors,
+              arma::vec& distances);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, returning the results in compressed sparse row form (see the
+   * bichromatic overload of this function for the format of the output).
+   *
+   * @param range Range of distances in which to search.
+   * @param offsets Vector which will hold the offset of the results of each
+   *      query point, and the total number of results as its last element.
+   * @param neighbors Vector which will hold the indices of the results.
+   * @param distances Vector which will hold the distances of the results.
+   */
+  void Search(const math::Range& range,
+              arma::Col<size_t>& offsets,
+              arma::Col<size_t>& neighbors,
+              arma::vec& distances);
+
+  /**
+   * Count the reference points in the given range of each point in the query
+   * set, without storing them.  The points of reference nodes that are
+   * entirely in the range are counted without computing their distances, so
+   * this is faster than Search() and takes only O(n) memory for the results.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param counts Vector which will hold the number of reference points in the
+   *      range of each query point.
+   */
+  void Count(const MatType& querySet,
+             const math::Range& range,
+             arma::Col<size_t>& counts);
+
+  /**
+   * Count the points in the given range of each point in the reference set,
+   * without storing them.  A point is not counted in its own range.
+   *
+   * @param range Range of distances in which to search.
+   * @param counts Vector which will hold the number of points in the range of
+   *      each point of the reference set.
+   */
+  void Count(const math::Range& range, arma::Col<size_t>& counts);
+
   //! Get whether single-tree search is being used.
   bool SingleMode() const { return singleMode; }
   //! Modify whether single-tree search is being used.
   bool& SingleMode() { return singleMode; }
 
+  //! Get whether the query points of single-tree searches are traversed in the
+  //! order of the Hilbert curve (see tree::HilbertOrder()).
+  bool ReorderQueries() const { return reorderQueries; }
+  //! Modify whether the query points of single-tree searches are traversed in
+  //! the order of the Hilbert curve, so that consecutive query points visit
+  //! the same parts of the tree.  The results are not affected.
+  bool& ReorderQueries() { return reorderQueries; }
+
   //! Get whether naive search is being used.
   bool Naive() const { return naive; }
   //! Modify whether naive search is being used.
@@ -324,6 +433,17 @@ class RangeSearch
   //! Return the reference tree (or NULL if in naive mode).
   Tree* ReferenceTree() { return referenceTree; }
 
+  //! Get the mappings from the points of the reference tree to the original
+  //! reference points (empty if no tree was built, or if the points were not
+  //! rearranged).
+  const std::vector<size_t>& OldFromNewReferences() const
+  { return oldFromNewReferences; }
+
+  //! Get the instantiated metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the instantiated metric.
+  MetricType& Metric() { return metric; }
+
  private:
   //! Mappings to old reference indices (used when this object builds trees).
   std::vector<size_t> oldFromNewReferences;
@@ -342,6 +462,9 @@ class RangeSearch
   bool naive;
   //! If true, single-tree computation is used.
   bool singleMode;
+  //! If true, the query points of single-tree searches are traversed in the
+  //! order of the Hilbert curve.
+  bool reorderQueries;
 
   //! Instantiated distance metric.
   MetricType metric;
@@ -351,10 +474,57 @@ class RangeSearch
   //! The total number of scores during the last search.
   size_t scores;
 
+  //! The shared reference tree, if the reference tree is shared; then
+  //! referenceTree points to it, and it is never modified.
+  std::shared_ptr<const Tree> sharedTree;
+
+  /**
+   * Traverse the reference tree for each of the given query points (the query
+   * set of the rules) with the given rules, in parallel over the query points
+   * with OpenMP (if the tree type allows it), and set the number of base cases
+   * and scores.  If ReorderQueries() is set, the query points are traversed in
+   * the order of the Hilbert curve.
+   */
+  template<typename RuleType>
+  void SingleTreeSearch(RuleType& rules, const MatType& querySet);
+
+  /**
+   * Traverse the given query tree and the reference tree with the given rules,
+   * in parallel over subtrees of the query tree with OpenMP, and set the number
+   * of base cases and scores.
+   */
+  template<typename RuleType>
+  void DualTreeSearch(RuleType& rules, Tree* queryTree);
+
+  /**
+   * Split the given query tree into disjoint subtrees that together hold all
+   * the query points, so that there are a few subtrees per thread to balance
+   * the load of the dual-tree traversal.
+   */
+  static void SplitQueryTree(Tree* queryTree, std::vector<Tree*>& queryNodes);
+
+  /**
+   * Convert one vector of results per query point to the compressed sparse row
+   * form, and free the given vectors.  The results of the query points are
+   * copied in parallel into disjoint parts of the output.
+   */
+  static void FlattenResults(std::vector<std::vector<size_t>>& nestedNeighbors,
+                             std::vector<std::vector<double>>& nestedDistances,
+                             arma::Col<size_t>& offsets,
+                             arma::Col<size_t>& neighbors,
+                             arma::vec& distances);
+
   //! For access to mappings when building models.
   friend class TrainVisitor;
 };
 
+/**
+ * Range search with the Euclidean distance on an Octree, which is built from
+ * the Morton order of the points in low dimensions.
+ */
+typedef RangeSearch<metric::EuclideanDistance, arma::mat, tree::Octree>
+    OctreeRangeSearch;
+
 } // namespace range
 } // namespace mlpack
 
@@ -15,6 +15,10 @@
 // Just in case it hasn't been included.
 #include "range_search.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 // The rules for traversal.
 #include "range_search_rules.hpp"
 
@@ -46,8 +50,9 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::RangeSearch(
     const MatType& referenceSetIn,
     const bool naive,
     const bool singleMode,
@@ -59,6 +64,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     setOwner(false),
     naive(naive),
     singleMode(!naive && singleMode), // Naive overrides single mode.
+    reorderQueries(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -71,8 +77,9 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::RangeSearch(
     MatType&& referenceSet,
     const bool naive,
     const bool singleMode,
@@ -85,6 +92,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     setOwner(naive),
     naive(naive),
     singleMode(!naive && singleMode),
+    reorderQueries(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -96,8 +104,9 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::RangeSearch(
     Tree* referenceTree,
     const bool singleMode,
     const MetricType metric) :
@@ -107,6 +116,31 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     setOwner(false),
     naive(false),
     singleMode(singleMode),
+    reorderQueries(false),
+    metric(metric),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing else to initialize.
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::RangeSearch(
+    Tree&& referenceTree,
+    const bool singleMode,
+    const MetricType metric) :
+    referenceTree(new Tree(std::move(referenceTree))),
+    referenceSet(&this->referenceTree->Dataset()),
+    treeOwner(true),
+    setOwner(false),
+    naive(false),
+    singleMode(singleMode),
+    reorderQueries(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -118,8 +152,34 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::RangeSearch(
+    const tree::SharedTree<Tree>& referenceTree,
+    const bool singleMode,
+    const MetricType metric) :
+    referenceTree(const_cast<Tree*>(&referenceTree.Tree())),
+    referenceSet(&referenceTree.Dataset()),
+    treeOwner(false),
+    setOwner(false),
+    naive(false),
+    singleMode(singleMode),
+    reorderQueries(false),
+    metric(metric),
+    baseCases(0),
+    scores(0),
+    sharedTree(referenceTree.TreePointer())
+{
+  // Nothing else to initialize.
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::RangeSearch(
     const bool naive,
     const bool singleMode,
     const MetricType metric) :
@@ -129,6 +189,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     setOwner(true),
     naive(naive),
     singleMode(singleMode),
+    reorderQueries(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -146,20 +207,24 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::RangeSearch(
     const RangeSearch& other) :
     oldFromNewReferences(other.oldFromNewReferences),
-    referenceTree(other.referenceTree ? new Tree(*other.referenceTree) : NULL),
+    referenceTree(other.sharedTree ? other.referenceTree :
+        (other.referenceTree ? new Tree(*other.referenceTree) : NULL)),
     referenceSet(other.referenceTree ? &referenceTree->Dataset() :
         new MatType(*other.referenceSet)),
-    treeOwner(other.referenceTree),
+    treeOwner(other.referenceTree && !other.sharedTree),
     setOwner(!other.referenceTree),
     naive(other.naive),
     singleMode(other.singleMode),
+    reorderQueries(other.reorderQueries),
     metric(other.metric),
     baseCases(other.baseCases),
-    scores(other.scores)
+    scores(other.scores),
+    sharedTree(other.sharedTree)
 {
   // Nothing to do.
 }
@@ -168,8 +233,10 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::RangeSearch(
+    RangeSearch&& other) :
     oldFromNewReferences(std::move(other.oldFromNewReferences)),
     referenceTree(other.referenceTree),
     referenceSet(other.referenceSet),
@@ -177,9 +244,11 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
     setOwner(other.setOwner),
     naive(other.naive),
     singleMode(other.singleMode),
+    reorderQueries(other.reorderQueries),
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
-    scores(other.scores)
+    scores(other.scores),
+    sharedTree(std::move(other.sharedTree))
 {
   // Clear other object.
   other.referenceSet = new MatType();
@@ -190,6 +259,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
   other.setOwner = true;
   other.naive = false;
   other.singleMode = false;
+  other.reorderQueries = false;
   other.baseCases = 0;
   other.scores = 0;
 }
@@ -198,9 +268,11 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-RangeSearch<MetricType, MatType, TreeType>&
-RangeSearch<MetricType, MatType, TreeType>::operator=(const RangeSearch& other)
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>&
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::operator=(
+    const RangeSearch& other)
 {
   // Clean memory first.
   if (treeOwner)
@@ -210,13 +282,16 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(const RangeSearch& other)
 
   // Copy the other model.
   oldFromNewReferences = other.oldFromNewReferences;
-  referenceTree = other.referenceTree ? new Tree(*other.referenceTree) : NULL;
+  sharedTree = other.sharedTree;
+  referenceTree = other.sharedTree ? other.referenceTree :
+      (other.referenceTree ? new Tree(*other.referenceTree) : NULL);
   referenceSet = other.referenceTree ? &referenceTree->Dataset() :
       new MatType(*other.referenceSet);
-  treeOwner = other.referenceTree;
+  treeOwner = other.referenceTree && !other.sharedTree;
   setOwner = !other.referenceTree;
   naive = other.naive;
   singleMode = other.singleMode;
+  reorderQueries = other.reorderQueries;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
@@ -228,9 +303,11 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-RangeSearch<MetricType, MatType, TreeType>&
-RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>&
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::operator=(
+    RangeSearch&& other)
 {
   // Clean memory first.
   if (treeOwner)
@@ -240,12 +317,14 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
 
   // Move the other model.
   oldFromNewReferences = std::move(other.oldFromNewReferences);
+  sharedTree = std::move(other.sharedTree);
   referenceTree = other.referenceTree;
   referenceSet = other.referenceSet;
   treeOwner = other.treeOwner;
   setOwner = other.setOwner;
   naive = other.naive;
   singleMode = other.singleMode;
+  reorderQueries = other.reorderQueries;
   metric = std::move(other.metric);
   baseCases = other.baseCases;
   scores = other.scores;
@@ -259,6 +338,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
   other.setOwner = true;
   other.naive = false;
   other.singleMode = false;
+  other.reorderQueries = false;
   other.baseCases = 0;
   other.scores = 0;
 
@@ -269,8 +349,9 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-RangeSearch<MetricType, MatType, TreeType>::~RangeSearch()
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+RangeSearch<MetricType, MatType, TreeType, StatisticType>::~RangeSearch()
 {
   if (treeOwner && referenceTree)
     delete referenceTree;
@@ -282,14 +363,22 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void RangeSearch<MetricType, MatType, TreeType>::Train(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Train(
     const MatType& referenceSet)
 {
   // Clean up the old tree, if we built one.
   if (treeOwner && referenceTree)
     delete referenceTree;
 
+  // Stop sharing the old tree, if it was shared.
+  if (sharedTree)
+  {
+    sharedTree.reset();
+    referenceTree = NULL;
+  }
+
   // Rebuild the tree, if necessary.
   if (!naive)
   {
@@ -317,14 +406,22 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void RangeSearch<MetricType, MatType, TreeType>::Train(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Train(
     MatType&& referenceSet)
 {
   // Clean up the old tree, if we built one.
   if (treeOwner && referenceTree)
     delete referenceTree;
 
+  // Stop sharing the old tree, if it was shared.
+  if (sharedTree)
+  {
+    sharedTree.reset();
+    referenceTree = NULL;
+  }
+
   // We may need to rebuild the tree.
   if (!naive)
   {
@@ -357,8 +454,9 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void RangeSearch<MetricType, MatType, TreeType>::Train(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Train(
   Tree* referenceTree)
 {
   if (naive)
@@ -369,6 +467,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
     delete this->referenceTree;
   if (setOwner && referenceSet)
     delete this->referenceSet;
+  sharedTree.reset();
 
   this->referenceTree = referenceTree;
   this->referenceSet = &referenceTree->Dataset();
@@ -380,8 +479,9 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void RangeSearch<MetricType, MatType, TreeType>::Search(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Search(
     const MatType& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
@@ -456,17 +556,9 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   }
   else if (singleMode)
   {
-    // Create the traverser.
     RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
         metric);
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
+    SingleTreeSearch(rules, querySet);
   }
   else // Dual-tree recursion.
   {
@@ -477,15 +569,9 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     Timer::Stop("range_search/tree_building");
     Timer::Start("range_search/computing_neighbors");
 
-    // Create the traverser.
     RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
         *distancePtr, metric);
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*queryTree, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
+    DualTreeSearch(rules, queryTree);
 
     // Clean up tree memory.
     delete queryTree;
@@ -564,8 +650,9 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void RangeSearch<MetricType, MatType, TreeType>::Search(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Search(
     Tree* queryTree,
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
@@ -602,16 +689,10 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
       distances, metric);
 
-  // Create the traverser.
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-  traverser.Traverse(*queryTree, *referenceTree);
+  DualTreeSearch(rules, queryTree);
 
   Timer::Stop("range_search/computing_neighbors");
 
-  baseCases = rules.BaseCases();
-  scores = rules.Scores();
-
   // Do we need to map indices?
   if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
   {
@@ -635,8 +716,9 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void RangeSearch<MetricType, MatType, TreeType>::Search(
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Search(
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
@@ -681,25 +763,11 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    baseCases = rules.BaseCases();
-    scores = rules.Scores();
+    SingleTreeSearch(rules, *referenceSet);
   }
   else // Dual-tree recursion.
   {
-    // Create the traverser.
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*referenceTree, *referenceTree);
-
-    baseCases = rules.BaseCases();
-    scores = rules.Scores();
+    DualTreeSearch(rules, referenceTree);
   }
 
   Timer::Stop("range_search/computing_neighbors");
@@ -736,14 +804,413 @@ template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    arma::Col<size_t>& offsets,
+    arma::Col<size_t>& neighbors,
+    arma::vec& distances)
+{
+  std::vector<std::vector<size_t>> nestedNeighbors;
+  std::vector<std::vector<double>> nestedDistances;
+  Search(querySet, range, nestedNeighbors, nestedDistances);
+
+  // If there were no reference points, there is an empty result for each query
+  // point.
+  nestedNeighbors.resize(querySet.n_cols);
+  nestedDistances.resize(querySet.n_cols);
+  FlattenResults(nestedNeighbors, nestedDistances, offsets, neighbors,
+      distances);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Search(
+    const math::Range& range,
+    arma::Col<size_t>& offsets,
+    arma::Col<size_t>& neighbors,
+    arma::vec& distances)
+{
+  std::vector<std::vector<size_t>> nestedNeighbors;
+  std::vector<std::vector<double>> nestedDistances;
+  Search(range, nestedNeighbors, nestedDistances);
+
+  nestedNeighbors.resize(referenceSet->n_cols);
+  nestedDistances.resize(referenceSet->n_cols);
+  FlattenResults(nestedNeighbors, nestedDistances, offsets, neighbors,
+      distances);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Count(
+    const MatType& querySet,
+    const math::Range& range,
+    arma::Col<size_t>& counts)
+{
+  if (querySet.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "RangeSearch::Count(): dimensionalities of query set ("
+        << querySet.n_rows << ") and reference set (" << referenceSet->n_rows
+        << ") do not match!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  counts.zeros(querySet.n_cols);
+
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+    return;
+
+  Timer::Start("range_search/computing_neighbors");
+
+  // The rules do not store any results when counting.
+  std::vector<std::vector<size_t>> neighbors;
+  std::vector<std::vector<double>> distances;
+
+  // Create the helper object for the traversal.
+  typedef RangeSearchRules<MetricType, Tree> RuleType;
+
+  // Reset counts.
+  baseCases = 0;
+  scores = 0;
+
+  if (naive)
+  {
+    RuleType rules(*referenceSet, querySet, range, neighbors, distances,
+        metric, false, &counts);
+
+    // The naive brute-force solution.
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      for (size_t j = 0; j < referenceSet->n_cols; ++j)
+        rules.BaseCase(i, j);
+
+    baseCases += (querySet.n_cols * referenceSet->n_cols);
+  }
+  else if (singleMode)
+  {
+    RuleType rules(*referenceSet, querySet, range, neighbors, distances,
+        metric, false, &counts);
+    SingleTreeSearch(rules, querySet);
+  }
+  else // Dual-tree recursion.
+  {
+    // Build the query tree.
+    Timer::Stop("range_search/computing_neighbors");
+    Timer::Start("range_search/tree_building");
+    std::vector<size_t> oldFromNewQueries;
+    Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+    Timer::Stop("range_search/tree_building");
+    Timer::Start("range_search/computing_neighbors");
+
+    // The counts are computed in the order of the points of the query tree.
+    arma::Col<size_t> treeCounts(querySet.n_cols, arma::fill::zeros);
+    RuleType rules(*referenceSet, queryTree->Dataset(), range, neighbors,
+        distances, metric, false, &treeCounts);
+    DualTreeSearch(rules, queryTree);
+
+    // Map the counts back to the original query indices, if necessary.
+    if (tree::TreeTraits<Tree>::RearrangesDataset)
+    {
+      for (size_t i = 0; i < treeCounts.n_elem; ++i)
+        counts[oldFromNewQueries[i]] = treeCounts[i];
+    }
+    else
+    {
+      counts = std::move(treeCounts);
+    }
+
+    // Clean up tree memory.
+    delete queryTree;
+  }
+
+  Timer::Stop("range_search/computing_neighbors");
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Count(
+    const math::Range& range,
+    arma::Col<size_t>& counts)
+{
+  arma::Col<size_t> treeCounts(referenceSet->n_cols, arma::fill::zeros);
+
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+  {
+    counts = std::move(treeCounts);
+    return;
+  }
+
+  Timer::Start("range_search/computing_neighbors");
+
+  // The rules do not store any results when counting.
+  std::vector<std::vector<size_t>> neighbors;
+  std::vector<std::vector<double>> distances;
+
+  // Create the helper object for the traversal.
+  typedef RangeSearchRules<MetricType, Tree> RuleType;
+  RuleType rules(*referenceSet, *referenceSet, range, neighbors, distances,
+      metric, true /* don't count the query in the results */, &treeCounts);
+
+  if (naive)
+  {
+    // The naive brute-force solution.
+    for (size_t i = 0; i < referenceSet->n_cols; ++i)
+      for (size_t j = 0; j < referenceSet->n_cols; ++j)
+        rules.BaseCase(i, j);
+
+    baseCases = (referenceSet->n_cols * referenceSet->n_cols);
+    scores = 0;
+  }
+  else if (singleMode)
+  {
+    SingleTreeSearch(rules, *referenceSet);
+  }
+  else // Dual-tree recursion.
+  {
+    DualTreeSearch(rules, referenceTree);
+  }
+
+  Timer::Stop("range_search/computing_neighbors");
+
+  // Do we need to map the reference indices?
+  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
+  {
+    counts.set_size(treeCounts.n_elem);
+    for (size_t i = 0; i < treeCounts.n_elem; ++i)
+      counts[oldFromNewReferences[i]] = treeCounts[i];
+  }
+  else
+  {
+    counts = std::move(treeCounts);
+  }
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+template<typename RuleType>
+void RangeSearch<MetricType, MatType, TreeType,
+                 StatisticType>::SingleTreeSearch(
+    RuleType& rules,
+    const MatType& querySet)
+{
+  // The results are indexed by the query points, so only the order of the
+  // traversals changes.
+  const size_t numQueries = querySet.n_cols;
+  std::vector<size_t> order;
+  if (reorderQueries)
+    tree::HilbertOrder(querySet, order);
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+
+  // Each thread traverses the reference tree for its own query points, with its
+  // own copy of the rules.  The results of different query points are stored
+  // in different vectors, so no merging is needed.  Trees whose first point is
+  // the centroid make the rules store the last distance in the statistics of
+  // the reference nodes, though, so those are traversed by one thread.
+  #pragma omp parallel if (!tree::TreeTraits<Tree>::FirstPointIsCentroid) \
+      reduction(+:totalBaseCases, totalScores)
+  {
+    RuleType threadRules(rules);
+    typename Tree::template SingleTreeTraverser<RuleType>
+        traverser(threadRules);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) numQueries; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < numQueries; ++i)
+#endif
+      traverser.Traverse(order.empty() ? i : order[i], *referenceTree);
+
+    totalBaseCases += threadRules.BaseCases();
+    totalScores += threadRules.Scores();
+  }
+
+  baseCases = totalBaseCases;
+  scores = totalScores;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+template<typename RuleType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::DualTreeSearch(
+    RuleType& rules,
+    Tree* queryTree)
+{
+  std::vector<Tree*> queryNodes;
+  SplitQueryTree(queryTree, queryNodes);
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+
+  // The subtrees hold disjoint sets of query points, so each one can be
+  // traversed against the reference tree by a different thread, with its own
+  // copy of the rules.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:totalBaseCases, totalScores)
+  for (intmax_t i = 0; i < (intmax_t) queryNodes.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:totalBaseCases, totalScores)
+  for (size_t i = 0; i < queryNodes.size(); ++i)
+#endif
+  {
+    RuleType threadRules(rules);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(threadRules);
+
+    traverser.Traverse(*queryNodes[i], *referenceTree);
+
+    totalBaseCases += threadRules.BaseCases();
+    totalScores += threadRules.Scores();
+  }
+
+  baseCases = totalBaseCases;
+  scores = totalScores;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::SplitQueryTree(
+    Tree* queryTree,
+    std::vector<Tree*>& queryNodes)
+{
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  queryNodes.assign(1, queryTree);
+  while (numThreads > 1 && queryNodes.size() < 4 * numThreads)
+  {
+    // Find the subtree with the most descendants that can be split.
+    size_t largest = queryNodes.size();
+    for (size_t i = 0; i < queryNodes.size(); ++i)
+    {
+      if (queryNodes[i]->NumChildren() > 0 && (largest == queryNodes.size() ||
+          queryNodes[i]->NumDescendants() >
+          queryNodes[largest]->NumDescendants()))
+        largest = i;
+    }
+
+    if (largest == queryNodes.size())
+      break; // Only leaves are left.
+
+    Tree* node = queryNodes[largest];
+    queryNodes[largest] = &node->Child(0);
+    for (size_t i = 1; i < node->NumChildren(); ++i)
+      queryNodes.push_back(&node->Child(i));
+  }
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::FlattenResults(
+    std::vector<std::vector<size_t>>& nestedNeighbors,
+    std::vector<std::vector<double>>& nestedDistances,
+    arma::Col<size_t>& offsets,
+    arma::Col<size_t>& neighbors,
+    arma::vec& distances)
+{
+  // The offset of the results of each query point is the total number of
+  // results of the previous query points.
+  offsets.set_size(nestedNeighbors.size() + 1);
+  offsets[0] = 0;
+  for (size_t i = 0; i < nestedNeighbors.size(); ++i)
+    offsets[i + 1] = offsets[i] + nestedNeighbors[i].size();
+
+  neighbors.set_size(offsets[nestedNeighbors.size()]);
+  distances.set_size(offsets[nestedNeighbors.size()]);
+
+  // Each query point writes to its own part of the output, so they can be
+  // copied in parallel.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (intmax_t i = 0; i < (intmax_t) nestedNeighbors.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (size_t i = 0; i < nestedNeighbors.size(); ++i)
+#endif
+  {
+    std::copy(nestedNeighbors[i].begin(), nestedNeighbors[i].end(),
+        neighbors.begin() + offsets[i]);
+    std::copy(nestedDistances[i].begin(), nestedDistances[i].end(),
+        distances.begin() + offsets[i]);
+
+    // Free the memory of the results of this point as soon as possible.
+    std::vector<size_t>().swap(nestedNeighbors[i]);
+    std::vector<double>().swap(nestedDistances[i]);
+  }
+
+  nestedNeighbors.clear();
+  nestedDistances.clear();
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename StatisticType>
 template<typename Archive>
-void RangeSearch<MetricType, MatType, TreeType>::Serialize(
+void RangeSearch<MetricType, MatType, TreeType, StatisticType>::Serialize(
     Archive& ar,
     const unsigned int /* version */)
 {
   using data::CreateNVP;
 
+  // A loaded model owns its tree.
+  if (Archive::is_loading::value && sharedTree)
+  {
+    sharedTree.reset();
+    referenceTree = NULL;
+  }
+
   // Serialize preferences for search.
   ar & CreateNVP(naive, "naive");
   ar & CreateNVP(singleMode, "singleMode");
@@ -82,6 +82,10 @@ PARAM_INT_IN("leaf_size", "Leaf size for tree building (used for kd-trees, "
     "Hilbert R trees, R+ trees, R++ trees, and octrees).", "l", 20);
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_MATRIX_IN("transformation", "Linear transformation (with one column per "
+    "dimension of the points) applied to the reference and query points before "
+    "anything else; the search then uses the distance || L x - L y ||, like "
+    "the one learned by mlpack_nca.", "");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
@@ -99,6 +103,7 @@ int main(int argc, char *argv[])
   else
     math::RandomSeed((size_t) std::time(NULL));
 
+
   // A user cannot specify both reference data and a model.
   if (CLI::HasParam("reference") && CLI::HasParam("input_model"))
     Log::Fatal << "Only one of --reference_file (-r) or --input_model_file (-m)"
@@ -121,6 +126,9 @@ int main(int argc, char *argv[])
     if (CLI::HasParam("random_basis"))
       Log::Warn << "--random_basis (-R) will be ignored because "
           << "--input_model_file is specified." << endl;
+    if (CLI::HasParam("transformation"))
+      Log::Warn << "--transformation_file will be ignored because "
+          << "--input_model_file is specified." << endl;
     if (CLI::HasParam("naive"))
       Log::Warn << "--naive (-N) will be ignored because --input_model_file is "
           << "specified." << endl;
@@ -198,6 +206,9 @@ int main(int argc, char *argv[])
 
     rs.TreeType() = tree;
     rs.RandomBasis() = randomBasis;
+    if (CLI::HasParam("transformation"))
+      rs.Transformation() = std::move(
+          CLI::GetParam<arma::mat>("transformation"));
 
     arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
 
@@ -13,6 +13,8 @@
 #define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/tree/base_case_block.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
 
 namespace mlpack {
 namespace range {
@@ -40,6 +42,10 @@ class RangeSearchRules
    * @param metric Instantiated metric.
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
+   * @param counts If not NULL, the number of points in the range of each query
+   *      point is added to this vector instead of storing the results in
+   *      neighbors and distances, and the points of reference nodes that are
+   *      entirely in the range are counted without computing their distances.
    */
   RangeSearchRules(const arma::mat& referenceSet,
                    const arma::mat& querySet,
@@ -47,7 +53,8 @@ class RangeSearchRules
                    std::vector<std::vector<size_t> >& neighbors,
                    std::vector<std::vector<double> >& distances,
                    MetricType& metric,
-                   const bool sameSet = false);
+                   const bool sameSet = false,
+                   arma::Col<size_t>* counts = NULL);
 
   /**
    * Compute the base case between the given query point and reference point.
@@ -57,6 +64,22 @@ class RangeSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between each of the given query points and each of
+   * the reference points in [referenceBegin, referenceBegin + referenceCount),
+   * exactly as if BaseCase() were called for each pair.  For the Euclidean
+   * distance on high-dimensional data, a single matrix multiplication is used
+   * to find the pairs that are certainly not in the range, and the exact
+   * distance is only computed for the other pairs.
+   *
+   * @param queryIndices Indices of query points.
+   * @param referenceBegin Index of the first reference point.
+   * @param referenceCount Number of reference points.
+   */
+  void BaseCaseBlock(const std::vector<size_t>& queryIndices,
+                     const size_t referenceBegin,
+                     const size_t referenceCount);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -139,17 +162,45 @@ class RangeSearchRules
   //! If true, the query and reference set are taken to be the same.
   bool sameSet;
 
+  //! If not NULL, the results are only counted, in this vector.
+  arma::Col<size_t>* counts;
+
   //! The last query index.
   size_t lastQueryIndex;
   //! The last reference index.
   size_t lastReferenceIndex;
 
+  //! Store (or count) the given reference point in the results for the given
+  //! query point.
+  void StoreResult(const size_t queryIndex,
+                   const size_t referenceIndex,
+                   const double distance);
+
   //! Add all the points in the given node to the results for the given query
   //! point.  If the base case has already been calculated, we make sure to not
   //! add that to the results twice.
   void AddResult(const size_t queryIndex,
                  TreeType& referenceNode);
 
+  //! True if BaseCaseBlock() can use BlockSquaredDistances(), which is the case
+  //! for the Euclidean distance.
+  typedef std::integral_constant<bool,
+      std::is_same<MetricType, metric::EuclideanDistance>::value ||
+      std::is_same<MetricType, metric::SquaredEuclideanDistance>::value>
+      UseBlockDistances;
+
+  //! Compute the base cases of BaseCaseBlock() one pair at a time.
+  void BaseCaseBlock(const std::vector<size_t>& queryIndices,
+                     const size_t referenceBegin,
+                     const size_t referenceCount,
+                     const std::false_type /* useBlockDistances */);
+
+  //! Compute the base cases of BaseCaseBlock() with BlockSquaredDistances().
+  void BaseCaseBlock(const std::vector<size_t>& queryIndices,
+                     const size_t referenceBegin,
+                     const size_t referenceCount,
+                     const std::true_type /* useBlockDistances */);
+
   TraversalInfoType traversalInfo;
 
   //! The number of base cases.
@@ -26,7 +26,8 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
     std::vector<std::vector<size_t> >& neighbors,
     std::vector<std::vector<double> >& distances,
     MetricType& metric,
-    const bool sameSet) :
+    const bool sameSet,
+    arma::Col<size_t>* counts) :
     referenceSet(referenceSet),
     querySet(querySet),
     range(range),
@@ -34,6 +35,7 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
     distances(distances),
     metric(metric),
     sameSet(sameSet),
+    counts(counts),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
     baseCases(0),
@@ -67,12 +69,90 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   lastReferenceIndex = referenceIndex;
 
   if (range.Contains(distance))
+    StoreResult(queryIndex, referenceIndex, distance);
+
+  return distance;
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearchRules<MetricType, TreeType>::BaseCaseBlock(
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount)
+{
+  BaseCaseBlock(queryIndices, referenceBegin, referenceCount,
+      UseBlockDistances());
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearchRules<MetricType, TreeType>::BaseCaseBlock(
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    const std::false_type /* useBlockDistances */)
+{
+  for (size_t i = 0; i < queryIndices.size(); ++i)
+    for (size_t ref = referenceBegin; ref < referenceBegin + referenceCount;
+        ++ref)
+      BaseCase(queryIndices[i], ref);
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearchRules<MetricType, TreeType>::BaseCaseBlock(
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    const std::true_type /* useBlockDistances */)
+{
+  // For low-dimensional data the matrix multiplication does not pay off.
+  if (querySet.n_rows < tree::blockDistanceMinDimensionality)
   {
-    neighbors[queryIndex].push_back(referenceIndex);
-    distances[queryIndex].push_back(distance);
+    BaseCaseBlock(queryIndices, referenceBegin, referenceCount,
+        std::false_type());
+    return;
   }
 
-  return distance;
+  arma::mat squaredDistances, maxErrors;
+  tree::BlockSquaredDistances(querySet, queryIndices, referenceSet,
+      referenceBegin, referenceCount, squaredDistances, maxErrors);
+
+  // The range, in terms of squared distances.
+  const double squaredLo = (range.Lo() <= 0.0) ? -DBL_MAX :
+      (MetricType::TakeRoot ? range.Lo() * range.Lo() : range.Lo());
+  const double squaredHi = MetricType::TakeRoot ? range.Hi() * range.Hi() :
+      range.Hi();
+
+  for (size_t j = 0; j < queryIndices.size(); ++j)
+  {
+    const size_t queryIndex = queryIndices[j];
+    for (size_t i = 0; i < referenceCount; ++i)
+    {
+      const size_t referenceIndex = referenceBegin + i;
+
+      // These are the same checks as in BaseCase().
+      if (sameSet && (queryIndex == referenceIndex))
+        continue;
+      if ((lastQueryIndex == queryIndex) &&
+          (lastReferenceIndex == referenceIndex))
+        continue;
+
+      ++baseCases;
+
+      // Skip the pair if it is certainly not in the range.
+      if (squaredDistances(i, j) - maxErrors(i, j) > squaredHi ||
+          squaredDistances(i, j) + maxErrors(i, j) < squaredLo)
+        continue;
+
+      const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
+          referenceSet.unsafe_col(referenceIndex));
+
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceIndex;
+
+      if (range.Contains(distance))
+        StoreResult(queryIndex, referenceIndex, distance);
+    }
+  }
 }
 
 //! Single-tree scoring function.
@@ -219,6 +299,25 @@ double RangeSearchRules<MetricType, TreeType>::Rescore(
   return oldScore;
 }
 
+//! Store (or count) one result.
+template<typename MetricType, typename TreeType>
+inline force_inline
+void RangeSearchRules<MetricType, TreeType>::StoreResult(
+    const size_t queryIndex,
+    const size_t referenceIndex,
+    const double distance)
+{
+  if (counts)
+  {
+    ++(*counts)[queryIndex];
+  }
+  else
+  {
+    neighbors[queryIndex].push_back(referenceIndex);
+    distances[queryIndex].push_back(distance);
+  }
+}
+
 //! Add all the points in the given node to the results for the given query
 //! point.
 template<typename MetricType, typename TreeType>
@@ -236,6 +335,20 @@ void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
     baseCaseMod = 1;
   }
 
+  // When only counting, all the points are in the range, so no distances need
+  // to be computed.
+  if (counts)
+  {
+    for (size_t i = baseCaseMod; i < referenceNode.NumDescendants(); ++i)
+    {
+      if (!((&referenceSet == &querySet) &&
+          (queryIndex == referenceNode.Descendant(i))))
+        ++(*counts)[queryIndex];
+    }
+
+    return;
+  }
+
   // Resize distances and neighbors vectors appropriately.  We have to use
   // reserve() and not resize(), because we don't know if we will encounter the
   // case where the datasets and points are the same (and we skip in that case).
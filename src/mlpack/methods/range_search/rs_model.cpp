@@ -33,6 +33,8 @@ RSModel::RSModel(const RSModel& other) :
     treeType(other.treeType),
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
+    q(other.q),
+    transformation(other.transformation),
     rSearch(other.rSearch)
 {
   // Nothing to do.
@@ -43,6 +45,8 @@ RSModel::RSModel(RSModel&& other) :
     treeType(other.treeType),
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
+    q(std::move(other.q)),
+    transformation(std::move(other.transformation)),
     rSearch(other.rSearch)
 {
   // Reset other model.
@@ -60,6 +64,8 @@ RSModel& RSModel::operator=(const RSModel& other)
   treeType = other.treeType;
   leafSize = other.leafSize;
   randomBasis = other.randomBasis;
+  q = other.q;
+  transformation = other.transformation;
   rSearch = other.rSearch;
 
   return *this;
@@ -73,6 +79,8 @@ RSModel& RSModel::operator=(RSModel&& other)
   treeType = other.treeType;
   leafSize = other.leafSize;
   randomBasis = other.randomBasis;
+  q = std::move(other.q);
+  transformation = std::move(other.transformation);
   rSearch = other.rSearch;
 
   // Reset other model.
@@ -95,6 +103,22 @@ void RSModel::BuildModel(arma::mat&& referenceSet,
                          const bool naive,
                          const bool singleMode)
 {
+  // Apply the transformation first, so that the random basis is built in the
+  // space of the transformed points.
+  if (!transformation.is_empty())
+  {
+    if (transformation.n_cols != referenceSet.n_rows)
+    {
+      std::ostringstream oss;
+      oss << "RSModel::BuildModel(): the transformation has "
+          << transformation.n_cols << " columns, but the reference set has "
+          << referenceSet.n_rows << " dimensions";
+      throw std::invalid_argument(oss.str());
+    }
+
+    referenceSet = transformation * referenceSet;
+  }
+
   // Initialize random basis if necessary.
   if (randomBasis)
   {
@@ -192,7 +216,21 @@ void RSModel::Search(arma::mat&& querySet,
                      vector<vector<size_t>>& neighbors,
                      vector<vector<double>>& distances)
 {
-  // We may need to map the query set randomly.
+  // The query set goes through the same mappings as the reference set.
+  if (!transformation.is_empty())
+  {
+    if (transformation.n_cols != querySet.n_rows)
+    {
+      std::ostringstream oss;
+      oss << "RSModel::Search(): the transformation has "
+          << transformation.n_cols << " columns, but the query set has "
+          << querySet.n_rows << " dimensions";
+      throw std::invalid_argument(oss.str());
+    }
+
+    querySet = transformation * querySet;
+  }
+
   if (randomBasis)
     querySet = q * querySet;
 
@@ -264,6 +264,9 @@ class RSModel
   bool randomBasis;
   //! Random projection matrix.
   arma::mat q;
+  //! The linear transformation applied to the points before anything else, or
+  //! an empty matrix.
+  arma::mat transformation;
 
   /**
    * rSearch holds an instance of the RangeSearch class for the current
@@ -362,6 +365,20 @@ class RSModel
   //! been built).
   bool& RandomBasis() { return randomBasis; }
 
+  /**
+   * Get the linear transformation L that is applied to the reference set in
+   * BuildModel() and to the query sets in Search(), or an empty matrix if the
+   * points are not transformed.  Range search with the Euclidean distance on
+   * the transformed points is the same as range search with the distance
+   * d(x, y) = || L x - L y || on the original points, like the one learned by
+   * NCA, or the Mahalanobis distance with
+   * L = MahalanobisDistance::Transformation().
+   */
+  const arma::mat& Transformation() const { return transformation; }
+  //! Modify the linear transformation (don't do this after the model has been
+  //! built).
+  arma::mat& Transformation() { return transformation; }
+
   /**
    * Build the reference tree on the given dataset with the given parameters.
    * This takes possession of the reference set to avoid a copy.
@@ -420,6 +437,10 @@ class RSModel
 } // namespace range
 } // namespace mlpack
 
+//! Set the serialization version of the RSModel class.  Version 1 added the
+//! transformation.
+BOOST_TEMPLATE_CLASS_VERSION(template<>, mlpack::range::RSModel, 1);
+
 // Include implementation (of Serialize() and inline functions).
 #include "rs_model_impl.hpp"
 
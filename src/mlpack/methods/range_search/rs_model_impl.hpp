@@ -222,13 +222,18 @@ bool& NaiveVisitor::operator()(RSType* rs) const
 
 // Serialize the model.
 template<typename Archive>
-void RSModel::Serialize(Archive& ar, const unsigned int /* version */)
+void RSModel::Serialize(Archive& ar, const unsigned int version)
 {
   using data::CreateNVP;
 
   ar & CreateNVP(treeType, "treeType");
   ar & CreateNVP(randomBasis, "randomBasis");
   ar & CreateNVP(q, "q");
+  // Older versions of RSModel didn't have a transformation.
+  if (version > 0)
+    ar & CreateNVP(transformation, "transformation");
+  else if (Archive::is_loading::value)
+    transformation.clear();
 
   // This should never happen, but just in case...
   if (Archive::is_loading::value)
@@ -24,6 +24,8 @@
 #define MLPACK_METHODS_RANN_RA_SEARCH_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <map>
+#include <tuple>
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
 
@@ -451,6 +453,20 @@ class RASearch
   //! Instantiation of kernel.
   MetricType metric;
 
+  //! The minimum number of samples required per query, for every combination
+  //! of (number of reference points, k, tau, alpha) searched with so far.
+  std::map<std::tuple<size_t, size_t, double, double>, size_t> samplesReqd;
+
+  //! Get the minimum number of samples required per query to find k
+  //! neighbors in the reference set, computing it only if it has not been
+  //! computed yet for the current tau and alpha.
+  size_t MinimumSamplesReqd(const size_t k);
+
+  //! Traverse the reference tree for each of the given number of query points
+  //! with the given rules, in parallel.
+  template<typename RuleType>
+  void SingleTreeSearch(RuleType& rules, const size_t numQueries);
+
   //! RAModel can modify internal members as necessary.
   friend class RAModel<SortPolicy>;
 }; // class RASearch
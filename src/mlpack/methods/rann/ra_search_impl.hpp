@@ -335,32 +335,21 @@ Search(const MatType& querySet,
   distancePtr->set_size(k, querySet.n_cols);
 
   typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
+  const size_t numSamples = MinimumSamplesReqd(k);
 
   if (naive)
   {
+    // The rules sample enough reference points uniformly for each query point
+    // when they are constructed.
     RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, naive,
-        sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
-
-    // Find how many samples from the reference set we need and sample uniformly
-    // from the reference set without replacement.
-    const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
-        k, tau, alpha);
-    arma::uvec distinctSamples;
-    math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
-        distinctSamples);
-
-    // Run the base case on each combination of query point and sampled
-    // reference point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < distinctSamples.n_elem; ++j)
-        rules.BaseCase(i, (size_t) distinctSamples[j]);
+        sampleAtLeaves, firstLeafExact, singleSampleLimit, false, numSamples);
 
     rules.GetResults(*neighborPtr, *distancePtr);
   }
   else if (singleMode)
   {
     RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, naive,
-        sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
+        sampleAtLeaves, firstLeafExact, singleSampleLimit, false, numSamples);
 
     // If the reference root node is a leaf, then the sampling has already been
     // done in the RASearchRules constructor.  This happens when naive = true.
@@ -368,12 +357,7 @@ Search(const MatType& querySet,
     {
       Log::Info << "Performing single-tree traversal..." << std::endl;
 
-      // Create the traverser.
-      typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      SingleTreeSearch(rules, querySet.n_cols);
 
       Log::Info << "Single-tree traversal complete." << std::endl;
       Log::Info << "Average number of distance calculations per query point: "
@@ -396,7 +380,8 @@ Search(const MatType& querySet,
     Timer::Start("computing_neighbors");
 
     RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, tau, alpha,
-        naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
+        naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false,
+        numSamples);
     typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
     Log::Info << "Query statistic pre-search: "
@@ -509,7 +494,8 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   // Create the helper object for the tree traversal.
   typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, tau, alpha,
-      naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
+      naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false,
+      MinimumSamplesReqd(k));
 
   // Create the traverser.
   typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
@@ -565,18 +551,11 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   // Create the helper object for the tree traversal.
   typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, *referenceSet, k, metric, tau, alpha, naive,
-      sampleAtLeaves, firstLeafExact, singleSampleLimit, true /* same sets */);
+      sampleAtLeaves, firstLeafExact, singleSampleLimit, true /* same sets */,
+      MinimumSamplesReqd(k));
 
   if (naive)
   {
-    // Find how many samples from the reference set we need and sample uniformly
-    // from the reference set without replacement.
-    const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
-        k, tau, alpha);
-    arma::uvec distinctSamples;
-    math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
-        distinctSamples);
-
     // The naive brute-force solution.
     for (size_t i = 0; i < referenceSet->n_cols; ++i)
       for (size_t j = 0; j < referenceSet->n_cols; ++j)
@@ -584,12 +563,7 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    SingleTreeSearch(rules, referenceSet->n_cols);
   }
   else
   {
@@ -626,6 +600,64 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   }
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+size_t RASearch<SortPolicy, MetricType, MatType, TreeType>::
+MinimumSamplesReqd(const size_t k)
+{
+  const std::tuple<size_t, size_t, double, double> key(referenceSet->n_cols,
+      k, tau, alpha);
+
+  typename std::map<std::tuple<size_t, size_t, double, double>,
+      size_t>::const_iterator it = samplesReqd.find(key);
+  if (it != samplesReqd.end())
+    return it->second;
+
+  Timer::Start("computing_number_of_samples_reqd");
+  const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
+      k, tau, alpha);
+  Timer::Stop("computing_number_of_samples_reqd");
+
+  samplesReqd[key] = numSamples;
+  return numSamples;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+void RASearch<SortPolicy, MetricType, MatType, TreeType>::SingleTreeSearch(
+    RuleType& rules,
+    const size_t numQueries)
+{
+  // The rules only modify the candidates and the counts of samples of the query
+  // point being traversed, so all the threads share them; each thread only
+  // needs its own traverser.
+  #pragma omp parallel
+  {
+    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) numQueries; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < numQueries; ++i)
+#endif
+      traverser.Traverse(i, *referenceTree);
+  }
+}
+
 template<typename SortPolicy,
          typename MetricType,
          typename MatType,
@@ -25,6 +25,10 @@ namespace neighbor {
  * The RASearchRules class is a template helper class used by RASearch class
  * when performing rank-approximate search via random-sampling.
  *
+ * In single-tree mode, all the state that a traversal for one query point
+ * modifies belongs to that query point, so different query points may be
+ * traversed by different threads at the same time with the same rules object.
+ *
  * @tparam SortPolicy The sort policy for distances.
  * @tparam MetricType The metric to use for computation.
  * @tparam TreeType The tree type to use; must adhere to the TreeType API.
@@ -53,6 +57,9 @@ class RASearchRules
    *     approximated by sampling.
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
+   * @param numSamplesReqd The minimum number of samples required per query,
+   *      if it is already known; if 0, it is computed from n, k, tau and
+   *      alpha.
    */
   RASearchRules(const arma::mat& referenceSet,
                 const arma::mat& querySet,
@@ -64,7 +71,8 @@ class RASearchRules
                 const bool sampleAtLeaves = false,
                 const bool firstLeafExact = false,
                 const size_t singleSampleLimit = 20,
-                const bool sameSet = false);
+                const bool sameSet = false,
+                const size_t numSamplesReqd = 0);
 
   /**
    * Store the list of candidates for each query point in the given matrices.
@@ -227,7 +235,7 @@ class RASearchRules
                  const double oldScore);
 
 
-  size_t NumDistComputations() { return numDistComputations; }
+  size_t NumDistComputations() { return arma::accu(numDistComputations); }
   size_t NumEffectiveSamples()
   {
     if (numSamplesMade.n_elem == 0)
@@ -290,8 +298,9 @@ class RASearchRules
   //! The sampling ratio.
   double samplingRatio;
 
-  //! The number of distance calculations performed during search.
-  size_t numDistComputations;
+  //! The number of distance calculations performed during search, for every
+  //! query.
+  arma::Col<size_t> numDistComputations;
 
   //! If the query and reference set are identical, this is true.
   bool sameSet;
@@ -30,7 +30,8 @@ RASearchRules(const arma::mat& referenceSet,
               const bool sampleAtLeaves,
               const bool firstLeafExact,
               const size_t singleSampleLimit,
-              const bool sameSet) :
+              const bool sameSet,
+              const size_t numSamplesReqd) :
     referenceSet(referenceSet),
     querySet(querySet),
     k(k),
@@ -38,6 +39,7 @@ RASearchRules(const arma::mat& referenceSet,
     sampleAtLeaves(sampleAtLeaves),
     firstLeafExact(firstLeafExact),
     singleSampleLimit(singleSampleLimit),
+    numSamplesReqd(numSamplesReqd),
     sameSet(sameSet)
 {
   // Validate tau to make sure that the rank approximation is greater than the
@@ -58,17 +60,23 @@ RASearchRules(const arma::mat& referenceSet,
         << t << " points; because k = " << k << ", this is exact search!"
         << std::endl;
 
-  Timer::Start("computing_number_of_samples_reqd");
-  numSamplesReqd = RAUtil::MinimumSamplesReqd(n, k, tau, alpha);
-  Timer::Stop("computing_number_of_samples_reqd");
+  // The number of samples only needs to be computed if the caller does not
+  // already know it.
+  if (this->numSamplesReqd == 0)
+  {
+    Timer::Start("computing_number_of_samples_reqd");
+    this->numSamplesReqd = RAUtil::MinimumSamplesReqd(n, k, tau, alpha);
+    Timer::Stop("computing_number_of_samples_reqd");
+  }
+
+  samplingRatio = (double) this->numSamplesReqd / (double) n;
+
+  Log::Info << "Minimum samples required per query: " << this->numSamplesReqd
+      << ", sampling ratio: " << samplingRatio << std::endl;
 
   // Initialize some statistics to be collected during the search.
   numSamplesMade = arma::zeros<arma::Col<size_t> >(querySet.n_cols);
-  numDistComputations = 0;
-  samplingRatio = (double) numSamplesReqd / (double) n;
-
-  Log::Info << "Minimum samples required per query: " << numSamplesReqd <<
-    ", sampling ratio: " << samplingRatio << std::endl;
+  numDistComputations = arma::zeros<arma::Col<size_t> >(querySet.n_cols);
 
   // Let's build the list of candidate neighbors for each query point.
   // It will be initialized with k candidates: (WorstDistance, size_t() - 1)
@@ -86,13 +94,28 @@ RASearchRules(const arma::mat& referenceSet,
 
   if (naive) // No tree traversal; just do naive sampling here.
   {
-    // Sample enough points.
-    arma::uvec distinctSamples;
-    for (size_t i = 0; i < querySet.n_cols; ++i)
+    // Sample enough points.  The query points are independent, so they are
+    // sampled in parallel, each thread with its own sample buffer.
+    #pragma omp parallel
     {
-      math::ObtainDistinctSamples(0, n, numSamplesReqd, distinctSamples);
-      for (size_t j = 0; j < distinctSamples.n_elem; j++)
-        BaseCase(i, (size_t) distinctSamples[j]);
+      arma::uvec distinctSamples;
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(static)
+      for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
+#else
+      #pragma omp for schedule(static)
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+#endif
+      {
+        math::ObtainDistinctSamples(0, n, this->numSamplesReqd,
+            distinctSamples);
+        for (size_t j = 0; j < distinctSamples.n_elem; j++)
+          BaseCase(i, (size_t) distinctSamples[j]);
+      }
     }
   }
 }
@@ -135,7 +158,7 @@ double RASearchRules<SortPolicy, MetricType, TreeType>::BaseCase(
 
   numSamplesMade[queryIndex]++;
 
-  numDistComputations++;
+  numDistComputations[queryIndex]++;
 
   return distance;
 }
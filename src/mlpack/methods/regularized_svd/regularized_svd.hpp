@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
 #include <mlpack/methods/cf/cf.hpp>
 
 #include "regularized_svd_function.hpp"
@@ -69,10 +70,14 @@ class RegularizedSVD
    * @param iterations Number of optimization iterations.
    * @param alpha Learning rate for the SGD optimizer.
    * @param lambda Regularization parameter for the optimization.
+   * @param parallel If true, the ratings are processed by several threads at
+   *        once with lock-free (Hogwild) updates of the user and item columns
+   *        (see mlpack::optimization::ParallelSGD), instead of serially.
    */
   RegularizedSVD(const size_t iterations = 10,
                  const double alpha = 0.01,
-                 const double lambda = 0.02);
+                 const double lambda = 0.02,
+                 const bool parallel = false);
 
   /**
    * Obtains the user and item matrices using the provided data and rank.
@@ -94,6 +99,8 @@ class RegularizedSVD
   double alpha;
   //! Regularization parameter for the optimization.
   double lambda;
+  //! Whether to update the parameters from several threads at once.
+  bool parallel;
 };
 
 } // namespace svd
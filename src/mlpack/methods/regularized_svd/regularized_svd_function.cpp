@@ -122,6 +122,58 @@ void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
   }
 }
 
+void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
+                                      const size_t i,
+                                      arma::mat& gradient) const
+{
+  // Indices for accessing the the correct parameter columns.
+  const size_t user = data(0, i);
+  const size_t item = data(1, i) + numUsers;
+
+  // Prediction error for the example.
+  const double rating = data(2, i);
+  double ratingError = rating - arma::dot(parameters.col(user),
+                                          parameters.col(item));
+
+  gradient.zeros(rank, numUsers + numItems);
+  gradient.col(user) = 2 * (lambda * parameters.col(user) -
+                            ratingError * parameters.col(item));
+  gradient.col(item) = 2 * (lambda * parameters.col(item) -
+                            ratingError * parameters.col(user));
+}
+
+void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
+                                      const size_t i,
+                                      arma::sp_mat& gradient) const
+{
+  // Indices for accessing the the correct parameter columns.
+  const size_t user = data(0, i);
+  const size_t item = data(1, i) + numUsers;
+
+  // Prediction error for the example.
+  const double rating = data(2, i);
+  double ratingError = rating - arma::dot(parameters.col(user),
+                                          parameters.col(item));
+
+  // Build the two non-zero columns with a single batch insertion.
+  arma::umat locations(2, 2 * rank);
+  arma::vec values(2 * rank);
+  for (size_t j = 0; j < rank; ++j)
+  {
+    locations(0, j) = j;
+    locations(1, j) = user;
+    values[j] = 2 * (lambda * parameters(j, user) -
+                     ratingError * parameters(j, item));
+
+    locations(0, rank + j) = j;
+    locations(1, rank + j) = item;
+    values[rank + j] = 2 * (lambda * parameters(j, item) -
+                            ratingError * parameters(j, user));
+  }
+
+  gradient = arma::sp_mat(locations, values, rank, numUsers + numItems);
+}
+
 } // namespace svd
 } // namespace mlpack
 
@@ -129,6 +181,7 @@ void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
 namespace mlpack {
 namespace optimization {
 
+template<>
 template<>
 double StandardSGD<mlpack::svd::RegularizedSVDFunction>::Optimize(
     mlpack::svd::RegularizedSVDFunction& function,
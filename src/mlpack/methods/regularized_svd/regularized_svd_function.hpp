@@ -62,6 +62,33 @@ class RegularizedSVDFunction
   void Gradient(const arma::mat& parameters,
                 arma::mat& gradient) const;
 
+  /**
+   * Evaluates the gradient of the cost function for one training example.
+   * Only the parameter columns of the user and the item of the example are
+   * non-zero.
+   *
+   * @param parameters Parameters(user/item matrices) of the decomposition.
+   * @param i Index of the training example to be used.
+   * @param gradient Calculated gradient for the parameters.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient) const;
+
+  /**
+   * Evaluates the gradient of the cost function for one training example, as a
+   * sparse matrix that only holds the parameter columns of the user and the
+   * item of the example.  The lock-free mode of ParallelSGD uses this to only
+   * update those columns.
+   *
+   * @param parameters Parameters(user/item matrices) of the decomposition.
+   * @param i Index of the training example to be used.
+   * @param gradient Calculated gradient for the parameters.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::sp_mat& gradient) const;
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -110,6 +137,7 @@ namespace optimization {
    * abstraction does not work as fast as we might like it to.
    */
   template<>
+  template<>
   double StandardSGD<mlpack::svd::RegularizedSVDFunction>::Optimize(
       mlpack::svd::RegularizedSVDFunction& function,
       arma::mat& parameters);
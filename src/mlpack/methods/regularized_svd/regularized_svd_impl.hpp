@@ -19,10 +19,12 @@ namespace svd {
 template<template<typename...> class OptimizerType>
 RegularizedSVD<OptimizerType>::RegularizedSVD(const size_t iterations,
                                               const double alpha,
-                                              const double lambda) :
+                                              const double lambda,
+                                              const bool parallel) :
     iterations(iterations),
     alpha(alpha),
-    lambda(lambda)
+    lambda(lambda),
+    parallel(parallel)
 {
   // Nothing to do.
 }
@@ -35,12 +37,25 @@ void RegularizedSVD<OptimizerType>::Apply(const arma::mat& data,
 {
   // Make the optimizer object using a RegularizedSVDFunction object.
   RegularizedSVDFunction rSVDFunc(data, rank, lambda);
-  mlpack::optimization::StandardSGD<RegularizedSVDFunction> optimizer(
-      rSVDFunc, alpha, iterations * data.n_cols);
 
   // Get optimized parameters.
   arma::mat parameters = rSVDFunc.GetInitialPoint();
-  optimizer.Optimize(parameters);
+  if (parallel)
+  {
+    // Each rating only touches the columns of its user and item, so the
+    // threads update the shared parameters without locking.  The gradient of
+    // RegularizedSVDFunction has a factor of 2 that the specialization of
+    // StandardSGD folds into its step size, so the step size is halved.
+    mlpack::optimization::ParallelSGD<RegularizedSVDFunction> optimizer(
+        rSVDFunc, 1, alpha / 2, iterations * data.n_cols, -1, true, true);
+    optimizer.Optimize(parameters);
+  }
+  else
+  {
+    mlpack::optimization::StandardSGD<RegularizedSVDFunction> optimizer(
+        rSVDFunc, alpha, iterations * data.n_cols);
+    optimizer.Optimize(parameters);
+  }
 
   // Constants for extracting user and item matrices.
   const size_t numUsers = max(data.row(0)) + 1;
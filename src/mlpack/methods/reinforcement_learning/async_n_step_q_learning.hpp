@@ -0,0 +1,173 @@
+/**
+ * @file async_n_step_q_learning.hpp
+ *
+ * This file is the definition of the AsyncNStepQLearning class, which
+ * implements asynchronous n-step Q-Learning.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ASYNC_N_STEP_Q_LEARNING_HPP
+#define MLPACK_METHODS_RL_ASYNC_N_STEP_Q_LEARNING_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <atomic>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of asynchronous n-step Q-Learning.  Each OpenMP thread is a
+ * worker with its own copy of the environment, of the network and of the
+ * behavior policy.  A worker takes up to nSteps steps in its environment,
+ * computes the n-step returns of these steps with its copy of the target
+ * network, and applies the gradient of the squared error of its action values
+ * directly to the shared parameters of the learning network, without any
+ * locking (as in Hogwild), with the update policy of the optimizer.  No
+ * experience replay is needed, since the workers explore different parts of the
+ * environment at the same time.
+ *
+ * For more details, see the following:
+ * @code
+ * @inproceedings{Mnih2016,
+ *  author    = {Volodymyr Mnih and
+ *               Adria Puigdomenech Badia and
+ *               Mehdi Mirza and
+ *               Alex Graves and
+ *               Timothy P. Lillicrap and
+ *               Tim Harley and
+ *               David Silver and
+ *               Koray Kavukcuoglu},
+ *  title     = {Asynchronous Methods for Deep Reinforcement Learning},
+ *  booktitle = {Proceedings of the 33rd International Conference on Machine
+ *               Learning},
+ *  year      = {2016}
+ * }
+ * @endcode
+ *
+ * @tparam EnvironmentType The environment of the reinforcement learning task.
+ * @tparam NetworkType The network to compute action value.
+ * @tparam UpdaterType The update policy used to apply the gradients (for
+ *     instance mlpack::optimization::VanillaUpdate or RMSPropUpdate); its
+ *     state is shared by all workers.
+ * @tparam PolicyType Behavior policy of the agent.
+ */
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+class AsyncNStepQLearning
+{
+ public:
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  /**
+   * Create the AsyncNStepQLearning object with given settings.
+   *
+   * If you want to pass in a parameter and discard the original parameter
+   * object, be sure to use std::move to avoid unnecessary copy.
+   *
+   * @param network The network to compute action value.
+   * @param updater The update policy used to apply the gradients.
+   * @param stepSize Step size of the updates.
+   * @param discount Discount for future return.
+   * @param policy Behavior policy of the agent; each worker gets its own copy.
+   * @param nSteps Maximum number of steps of a worker between two updates.
+   * @param targetNetworkSyncInterval Interval (steps of all workers) to sync
+   *        the target network.
+   * @param stepLimit Maximum steps in each episode, 0 means no limit.
+   * @param environment Reinforcement learning task.
+   */
+  AsyncNStepQLearning(NetworkType network,
+                      UpdaterType updater,
+                      const double stepSize,
+                      const double discount,
+                      PolicyType policy,
+                      const size_t nSteps,
+                      const size_t targetNetworkSyncInterval,
+                      const size_t stepLimit = 0,
+                      EnvironmentType environment = EnvironmentType());
+
+  /**
+   * Run the workers in parallel until they have taken the given number of
+   * steps in total.  The workers start new episodes, and their copies of the
+   * behavior policy anneal independently.
+   *
+   * @param steps Number of steps to take, summed over all workers.
+   */
+  void Train(const size_t steps);
+
+  /**
+   * Execute an episode with the greedy policy of the learning network, without
+   * learning.
+   *
+   * @return Return of the episode.
+   */
+  double Episode();
+
+  /**
+   * @return Total steps from beginning.
+   */
+  size_t TotalSteps() const { return totalSteps; }
+
+  //! Get the learning network.
+  const NetworkType& Network() const { return learningNetwork; }
+
+ private:
+  /**
+   * Run one worker until the total number of steps reaches lastStep.
+   */
+  void Work(const size_t lastStep,
+            typename UpdaterType::template Policy<arma::mat>& updatePolicy);
+
+  //! Locally-stored learning network, whose parameters are shared.
+  NetworkType learningNetwork;
+
+  //! Locally-stored update policy.
+  UpdaterType updater;
+
+  //! Step size of the updates.
+  double stepSize;
+
+  //! Discount factor of future return.
+  double discount;
+
+  //! Locally-stored behavior policy, copied by each worker.
+  PolicyType policy;
+
+  //! Maximum steps of a worker between two updates.
+  size_t nSteps;
+
+  //! Interval (steps) to update target network.
+  size_t targetNetworkSyncInterval;
+
+  //! Maximum steps for each episode.
+  size_t stepLimit;
+
+  //! Locally-stored reinforcement learning task.
+  EnvironmentType environment;
+
+  //! Parameters of the target network.
+  arma::mat targetParameters;
+
+  //! Number of times the target network was synced.
+  std::atomic<size_t> targetVersion;
+
+  //! Total steps from the beginning of the task.
+  std::atomic<size_t> totalSteps;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+// Include implementation
+#include "async_n_step_q_learning_impl.hpp"
+#endif
@@ -0,0 +1,223 @@
+/**
+ * @file async_n_step_q_learning_impl.hpp
+ *
+ * This file is the implementation of the AsyncNStepQLearning class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ASYNC_N_STEP_Q_LEARNING_IMPL_HPP
+#define MLPACK_METHODS_RL_ASYNC_N_STEP_Q_LEARNING_IMPL_HPP
+
+#include "async_n_step_q_learning.hpp"
+
+namespace mlpack {
+namespace rl {
+
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+AsyncNStepQLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  PolicyType
+>::AsyncNStepQLearning(NetworkType network,
+                       UpdaterType updater,
+                       const double stepSize,
+                       const double discount,
+                       PolicyType policy,
+                       const size_t nSteps,
+                       const size_t targetNetworkSyncInterval,
+                       const size_t stepLimit,
+                       EnvironmentType environment):
+    learningNetwork(std::move(network)),
+    updater(std::move(updater)),
+    stepSize(stepSize),
+    discount(discount),
+    policy(std::move(policy)),
+    nSteps(nSteps),
+    targetNetworkSyncInterval(targetNetworkSyncInterval),
+    stepLimit(stepLimit),
+    environment(std::move(environment)),
+    targetVersion(0),
+    totalSteps(0)
+{
+  learningNetwork.ResetParameters();
+  targetParameters = learningNetwork.Parameters();
+}
+
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+void AsyncNStepQLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  PolicyType
+>::Train(const size_t steps)
+{
+  // The state of the update policy is shared by all workers.
+  typename UpdaterType::template Policy<arma::mat> updatePolicy(updater,
+      learningNetwork.Parameters().n_rows, learningNetwork.Parameters().n_cols);
+
+  const size_t lastStep = totalSteps + steps;
+
+  #pragma omp parallel
+  {
+    Work(lastStep, updatePolicy);
+  }
+}
+
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+void AsyncNStepQLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  PolicyType
+>::Work(const size_t lastStep,
+        typename UpdaterType::template Policy<arma::mat>& updatePolicy)
+{
+  // Each worker has its own copy of everything but the shared parameters.
+  NetworkType network(learningNetwork);
+  NetworkType targetNetwork(learningNetwork);
+  size_t localTargetVersion = SIZE_MAX;
+  PolicyType workerPolicy(policy);
+  EnvironmentType workerEnvironment(environment);
+
+  StateType state = workerEnvironment.InitialSample();
+  size_t episodeSteps = 0;
+
+  arma::mat states(StateType::dimension, nSteps);
+  arma::Col<size_t> actions(nSteps);
+  arma::colvec rewards(nSteps);
+  arma::colvec actionValue;
+  arma::mat target, gradient;
+
+  while (totalSteps < lastStep)
+  {
+    // Start from the current shared parameters.
+    network.Parameters() = learningNetwork.Parameters();
+    if (localTargetVersion != targetVersion)
+    {
+      #pragma omp critical(asyncTargetNetwork)
+      {
+        targetNetwork.Parameters() = targetParameters;
+        localTargetVersion = targetVersion;
+      }
+    }
+
+    // Take up to nSteps steps in the environment.
+    size_t n = 0;
+    bool terminal = false, episodeEnd = false;
+    while (n < nSteps && !episodeEnd)
+    {
+      network.Predict(state.Encode(), actionValue);
+      const ActionType action = workerPolicy.Sample(actionValue);
+
+      StateType nextState;
+      states.col(n) = state.Encode();
+      actions[n] = action;
+      rewards[n] = workerEnvironment.Sample(state, action, nextState);
+      state = nextState;
+      ++n;
+      ++episodeSteps;
+
+      terminal = workerEnvironment.IsTerminal(state);
+      episodeEnd = terminal || (stepLimit && episodeSteps >= stepLimit);
+
+      const size_t step = ++totalSteps;
+      workerPolicy.Anneal();
+      if (step % targetNetworkSyncInterval == 0)
+      {
+        #pragma omp critical(asyncTargetNetwork)
+        {
+          targetParameters = learningNetwork.Parameters();
+          ++targetVersion;
+        }
+      }
+    }
+
+    // Bootstrap the return of the last state from the target network, unless
+    // the last state is terminal.
+    double value = 0.0;
+    if (!terminal)
+    {
+      targetNetwork.Predict(state.Encode(), actionValue);
+      value = actionValue.max();
+    }
+
+    // The update target of each step is its n-step return.
+    network.Predict(states.cols(0, n - 1), target);
+    for (size_t i = n; i > 0; --i)
+    {
+      value = rewards[i - 1] + discount * value;
+      target(actions[i - 1], i - 1) = value;
+    }
+
+    // Compute the gradient of all the steps at once, and apply it to the
+    // shared parameters without locking.
+    network.ResetData(states.cols(0, n - 1), target);
+    network.Gradient(network.Parameters(), 0, gradient, n);
+    updatePolicy.Update(learningNetwork.Parameters(), stepSize / n, gradient);
+
+    if (episodeEnd)
+    {
+      state = workerEnvironment.InitialSample();
+      episodeSteps = 0;
+    }
+  }
+}
+
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+double AsyncNStepQLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  PolicyType
+>::Episode()
+{
+  StateType state = environment.InitialSample();
+  size_t steps = 0;
+  double totalReturn = 0.0;
+
+  arma::colvec actionValue;
+  while (!environment.IsTerminal(state))
+  {
+    if (stepLimit && steps >= stepLimit)
+      break;
+
+    learningNetwork.Predict(state.Encode(), actionValue);
+    const ActionType action = policy.Sample(actionValue, true);
+
+    StateType nextState;
+    totalReturn += environment.Sample(state, action, nextState);
+    state = nextState;
+    steps++;
+  }
+
+  return totalReturn;
+}
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
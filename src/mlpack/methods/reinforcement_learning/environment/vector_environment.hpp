@@ -0,0 +1,148 @@
+/**
+ * @file vector_environment.hpp
+ *
+ * This file is an implementation of a wrapper that steps several copies of an
+ * environment in lockstep.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ENVIRONMENT_VECTOR_ENVIRONMENT_HPP
+#define MLPACK_METHODS_RL_ENVIRONMENT_VECTOR_ENVIRONMENT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of a vectorized environment, which holds several copies of an
+ * environment and advances all of them by one step at a time.  The states of
+ * all copies can be encoded into the columns of one matrix, so that the action
+ * values of every copy are computed with a single forward pass of the network,
+ * and the copies are stepped in parallel with OpenMP.
+ *
+ * Copies whose state is terminal are not stepped anymore, until they are
+ * restarted with InitialSample().
+ *
+ * @tparam EnvironmentType The reinforcement learning task.
+ */
+template <typename EnvironmentType>
+class VectorEnvironment
+{
+ public:
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  /**
+   * Construct the vectorized environment with the given number of copies of
+   * the given environment.
+   *
+   * @param size Number of copies of the environment.
+   * @param environment The environment to copy.
+   */
+  VectorEnvironment(const size_t size,
+                    const EnvironmentType& environment = EnvironmentType()) :
+      environments(size, environment),
+      states(size),
+      terminal(size, true)
+  { /* Nothing to do here. */ }
+
+  /**
+   * Restart every copy of the environment from an initial state.
+   */
+  void InitialSample()
+  {
+    // The initial states are random, so they are sampled serially.
+    for (size_t i = 0; i < environments.size(); ++i)
+    {
+      states[i] = environments[i].InitialSample();
+      terminal[i] = environments[i].IsTerminal(states[i]);
+    }
+  }
+
+  /**
+   * Advance every copy of the environment that is not in a terminal state by
+   * one step, with the action of that copy.  The copies are stepped in
+   * parallel, and the previous states are returned so that the transitions can
+   * be stored.
+   *
+   * @param actions The action of each copy.
+   * @param previousStates The states of the copies before the step.
+   * @param rewards The reward of each copy (0 for the copies that were already
+   *     in a terminal state).
+   */
+  void Sample(const std::vector<ActionType>& actions,
+              std::vector<StateType>& previousStates,
+              arma::colvec& rewards)
+  {
+    previousStates = states;
+    rewards.zeros(environments.size());
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) environments.size(); ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < environments.size(); ++i)
+#endif
+    {
+      if (terminal[i])
+        continue;
+
+      rewards[i] = environments[i].Sample(previousStates[i], actions[i],
+          states[i]);
+      terminal[i] = environments[i].IsTerminal(states[i]);
+    }
+  }
+
+  /**
+   * Encode the current state of every copy into the columns of a matrix.
+   *
+   * @param encoded The encoded states.
+   */
+  void Encode(arma::mat& encoded) const
+  {
+    encoded.set_size(StateType::dimension, states.size());
+    for (size_t i = 0; i < states.size(); ++i)
+      encoded.col(i) = states[i].Encode();
+  }
+
+  //! Get the number of copies of the environment.
+  size_t Size() const { return environments.size(); }
+
+  //! Get the current state of the given copy.
+  const StateType& State(const size_t i) const { return states[i]; }
+
+  //! Get whether the given copy is in a terminal state.
+  bool IsTerminal(const size_t i) const { return terminal[i]; }
+
+  //! Get the number of copies in a terminal state.
+  size_t NumTerminal() const
+  {
+    return std::count(terminal.begin(), terminal.end(), (char) true);
+  }
+
+ private:
+  //! The copies of the environment.
+  std::vector<EnvironmentType> environments;
+
+  //! The current state of each copy.
+  std::vector<StateType> states;
+
+  //! Whether each copy is in a terminal state.
+  std::vector<char> terminal;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "environment/vector_environment.hpp"
 #include "replay/random_replay.hpp"
 
 namespace mlpack {
@@ -103,6 +104,19 @@ class QLearning
    */
   double Episode();
 
+  /**
+   * Execute one episode in each of the given number of copies of the
+   * environment, in lockstep.  At each step, the action values of all copies
+   * are computed with one forward pass of the network, the copies are advanced
+   * in parallel, and the network learns from the stored experience once.  So,
+   * many more environment steps are taken per unit of time than with
+   * Episode(), at the cost of fewer updates of the network per step.
+   *
+   * @param numEnvironments Number of copies of the environment.
+   * @return Return of the episode of each copy.
+   */
+  arma::colvec Episodes(const size_t numEnvironments);
+
   /**
    * @return Total steps from beginning.
    */
@@ -121,6 +135,11 @@ class QLearning
    */
   arma::Col<size_t> BestAction(const arma::mat& actionValues);
 
+  /**
+   * Train the learning network on a sample of the stored experience.
+   */
+  void Learn();
+
   //! Locally-stored learning network.
   NetworkType learningNetwork;
 
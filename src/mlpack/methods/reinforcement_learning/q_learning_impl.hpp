@@ -89,37 +89,14 @@ template <
   typename BehaviorPolicyType,
   typename ReplayType
 >
-double QLearning<
+void QLearning<
   EnvironmentType,
   NetworkType,
   OptimizerType,
   BehaviorPolicyType,
   ReplayType
->::Step()
+>::Learn()
 {
-  // Get the action value for each action at current state.
-  arma::colvec actionValue;
-  learningNetwork.Predict(state.Encode(), actionValue);
-
-  // Select an action according to the behavior policy.
-  ActionType action = policy.Sample(actionValue, deterministic);
-
-  // Interact with the environment to advance to next state.
-  StateType nextState;
-  double reward = environment.Sample(state, action, nextState);
-
-  // Store the transition for replay.
-  replayMethod.Store(state, action, reward,
-      nextState, environment.IsTerminal(nextState));
-
-  // Update current state.
-  state = nextState;
-
-  if (deterministic || totalSteps < explorationSteps)
-    return reward;
-
-  // Start experience replay.
-
   // Sample from previous experience.
   arma::mat sampledStates;
   arma::icolvec sampledActions;
@@ -149,14 +126,60 @@ double QLearning<
   // Compute the update target.
   arma::mat target;
   learningNetwork.Predict(sampledStates, target);
+  arma::colvec tdErrors(sampledNextStates.n_cols);
   for (size_t i = 0; i < sampledNextStates.n_cols; ++i)
   {
+    const double oldValue = target(sampledActions[i], i);
     target(sampledActions[i], i) = sampledRewards[i] +
         discount * (isTerminal[i] ? 0.0 : nextActionValues(bestActions[i], i));
+    tdErrors[i] = target(sampledActions[i], i) - oldValue;
   }
 
+  // Let the replay method know how surprising the sampled transitions were.
+  replayMethod.UpdatePriorities(tdErrors);
+
   // Learn form experience.
   learningNetwork.Train(sampledStates, target, optimizer);
+}
+
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename OptimizerType,
+  typename BehaviorPolicyType,
+  typename ReplayType
+>
+double QLearning<
+  EnvironmentType,
+  NetworkType,
+  OptimizerType,
+  BehaviorPolicyType,
+  ReplayType
+>::Step()
+{
+  // Get the action value for each action at current state.
+  arma::colvec actionValue;
+  learningNetwork.Predict(state.Encode(), actionValue);
+
+  // Select an action according to the behavior policy.
+  ActionType action = policy.Sample(actionValue, deterministic);
+
+  // Interact with the environment to advance to next state.
+  StateType nextState;
+  double reward = environment.Sample(state, action, nextState);
+
+  // Store the transition for replay.
+  replayMethod.Store(state, action, reward,
+      nextState, environment.IsTerminal(nextState));
+
+  // Update current state.
+  state = nextState;
+
+  if (deterministic || totalSteps < explorationSteps)
+    return reward;
+
+  // Start experience replay.
+  Learn();
 
   return reward;
 }
@@ -210,6 +233,90 @@ double QLearning<
   return totalReturn;
 }
 
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename OptimizerType,
+  typename BehaviorPolicyType,
+  typename ReplayType
+>
+arma::colvec QLearning<
+  EnvironmentType,
+  NetworkType,
+  OptimizerType,
+  BehaviorPolicyType,
+  ReplayType
+>::Episodes(const size_t numEnvironments)
+{
+  VectorEnvironment<EnvironmentType> environments(numEnvironments,
+      environment);
+  environments.InitialSample();
+
+  // Track the steps in these episodes, and the return of each episode.
+  size_t steps = 0;
+  arma::colvec totalReturns(numEnvironments, arma::fill::zeros);
+
+  arma::mat encodedStates, actionValues;
+  std::vector<ActionType> actions(numEnvironments);
+  std::vector<StateType> previousStates;
+  arma::colvec rewards;
+
+  // Running until every copy gets to the terminal state.
+  while (environments.NumTerminal() < numEnvironments)
+  {
+    if (stepLimit && steps >= stepLimit)
+      break;
+
+    // Get the action values of every copy with one forward pass, and select
+    // the action of each copy according to the behavior policy.
+    environments.Encode(encodedStates);
+    learningNetwork.Predict(encodedStates, actionValues);
+    for (size_t i = 0; i < numEnvironments; ++i)
+    {
+      if (!environments.IsTerminal(i))
+        actions[i] = policy.Sample(actionValues.col(i), deterministic);
+    }
+
+    // Advance the copies that are still running, in parallel.
+    environments.Sample(actions, previousStates, rewards);
+    totalReturns += rewards;
+    steps++;
+
+    if (deterministic)
+      continue;
+
+    // Store the transitions for replay.
+    size_t newSteps = 0;
+    for (size_t i = 0; i < numEnvironments; ++i)
+    {
+      if (environment.IsTerminal(previousStates[i]))
+        continue;
+
+      replayMethod.Store(previousStates[i], actions[i], rewards[i],
+          environments.State(i), environments.IsTerminal(i));
+      newSteps++;
+    }
+
+    // Learn from experience once for all the new transitions.
+    if (totalSteps >= explorationSteps)
+      Learn();
+
+    for (size_t i = 0; i < newSteps; ++i)
+    {
+      totalSteps++;
+
+      // Update target network
+      if (totalSteps % targetNetworkSyncInterval == 0)
+        targetNetwork = learningNetwork;
+
+      if (totalSteps > explorationSteps)
+        policy.Anneal();
+    }
+  }
+
+  return totalReturns;
+}
+
 } // namespace rl
 } // namespace mlpack
 
@@ -0,0 +1,306 @@
+/**
+ * @file prioritized_replay.hpp
+ *
+ * This file is an implementation of prioritized experience replay.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+#define MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mutex>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of proportional prioritized experience replay.
+ *
+ * Each transition is sampled with probability proportional to its priority,
+ * (|delta| + epsilon)^alpha, where delta is the temporal difference error of
+ * the transition the last time it was sampled; new transitions get the largest
+ * priority seen so far, so that every transition is sampled at least once with
+ * high probability.  The priorities are the leaves of a sum tree, so storing a
+ * transition, sampling a transition and updating a priority all take
+ * O(log capacity) time.
+ *
+ * The memory is a preallocated First-In-First-Out buffer, and Sample() writes
+ * into the given matrices without allocating memory if they already have the
+ * right size, so the same batch buffers can be reused at every step.  Store()
+ * and Sample() may be called from several threads at once.
+ *
+ * Note that the importance sampling weights of the paper are not applied,
+ * since the networks are trained without per-example weights.
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @article{schaul2015prioritized,
+ *  title   = {Prioritized Experience Replay},
+ *  author  = {Schaul, Tom and Quan, John and Antonoglou, Ioannis and
+ *             Silver, David},
+ *  journal = {arXiv preprint arXiv:1511.05952},
+ *  year    = {2015}
+ * }
+ * @endcode
+ *
+ * @tparam EnvironmentType Desired task.
+ */
+template <typename EnvironmentType>
+class PrioritizedReplay
+{
+ public:
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Construct an instance of prioritized experience replay class.
+   *
+   * @param batchSize Number of examples returned at each sample.
+   * @param capacity Total memory size in terms of number of examples.
+   * @param alpha How much the priorities are used (0 is uniform sampling).
+   * @param epsilon Small value added to the priorities, so that no transition
+   *        has probability zero.
+   * @param dimension The dimension of an encoded state.
+   */
+  PrioritizedReplay(const size_t batchSize,
+                    const size_t capacity,
+                    const double alpha = 0.6,
+                    const double epsilon = 1e-6,
+                    const size_t dimension = StateType::dimension) :
+      batchSize(batchSize),
+      capacity(capacity),
+      alpha(alpha),
+      epsilon(epsilon),
+      position(0),
+      full(false),
+      states(dimension, capacity),
+      actions(capacity),
+      rewards(capacity),
+      nextStates(dimension, capacity),
+      isTerminal(capacity),
+      leaves(1),
+      maxPriority(1.0),
+      sampledIndices(batchSize)
+  {
+    while (leaves < capacity)
+      leaves *= 2;
+    tree.zeros(2 * leaves);
+  }
+
+  //! Move constructor; the lock is not moved.
+  PrioritizedReplay(PrioritizedReplay&& other) :
+      batchSize(other.batchSize),
+      capacity(other.capacity),
+      alpha(other.alpha),
+      epsilon(other.epsilon),
+      position(other.position),
+      full(other.full),
+      states(std::move(other.states)),
+      actions(std::move(other.actions)),
+      rewards(std::move(other.rewards)),
+      nextStates(std::move(other.nextStates)),
+      isTerminal(std::move(other.isTerminal)),
+      leaves(other.leaves),
+      tree(std::move(other.tree)),
+      maxPriority(other.maxPriority),
+      sampledIndices(std::move(other.sampledIndices))
+  { /* Nothing to do here. */ }
+
+  /**
+   * Store the given experience, with the largest priority seen so far.
+   *
+   * @param state Given state.
+   * @param action Given action.
+   * @param reward Given reward.
+   * @param nextState Given next state.
+   * @param isEnd Whether next state is terminal state.
+   */
+  void Store(const StateType& state,
+             ActionType action,
+             double reward,
+             const StateType& nextState,
+             bool isEnd)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    states.col(position) = state.Encode();
+    actions(position) = action;
+    rewards(position) = reward;
+    nextStates.col(position) = nextState.Encode();
+    isTerminal(position) = isEnd;
+    SetPriority(position, maxPriority);
+
+    position++;
+    if (position == capacity)
+    {
+      full = true;
+      position = 0;
+    }
+  }
+
+  /**
+   * Sample some experiences, with probability proportional to their
+   * priorities.  The batch is stratified: the total priority is split into
+   * batchSize equal segments, and one transition is sampled in each segment.
+   *
+   * @param sampledStates Sampled encoded states.
+   * @param sampledActions Sampled actions.
+   * @param sampledRewards Sampled rewards.
+   * @param sampledNextStates Sampled encoded next states.
+   * @param isTerminal Indicate whether corresponding next state is terminal
+   *        state.
+   */
+  void Sample(arma::mat& sampledStates,
+              arma::icolvec& sampledActions,
+              arma::colvec& sampledRewards,
+              arma::mat& sampledNextStates,
+              arma::icolvec& isTerminal)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // set_size() does nothing if the buffers already have the right size.
+    sampledStates.set_size(states.n_rows, batchSize);
+    sampledActions.set_size(batchSize);
+    sampledRewards.set_size(batchSize);
+    sampledNextStates.set_size(nextStates.n_rows, batchSize);
+    isTerminal.set_size(batchSize);
+
+    const size_t upperBound = full ? capacity : position;
+    const double segment = tree[1] / batchSize;
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      size_t index = Find(segment * (i + math::Random()));
+      // Guard against rounding errors at the end of the tree.
+      if (index >= upperBound)
+        index = upperBound - 1;
+      sampledIndices[i] = index;
+
+      sampledStates.col(i) = states.col(index);
+      sampledActions[i] = actions[index];
+      sampledRewards[i] = rewards[index];
+      sampledNextStates.col(i) = nextStates.col(index);
+      isTerminal[i] = this->isTerminal[index];
+    }
+  }
+
+  /**
+   * Update the priorities of the transitions returned by the last call to
+   * Sample(), given their new temporal difference errors.
+   *
+   * @param tdErrors The temporal difference error of each sampled transition.
+   */
+  void UpdatePriorities(const arma::colvec& tdErrors)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (size_t i = 0; i < tdErrors.n_elem; ++i)
+    {
+      const double priority = std::pow(std::abs(tdErrors[i]) + epsilon, alpha);
+      maxPriority = std::max(maxPriority, priority);
+      SetPriority(sampledIndices[i], priority);
+    }
+  }
+
+  /**
+   * Get the number of transitions in the memory.
+   *
+   * @return Actual used memory size
+   */
+  size_t Size() const
+  {
+    return full ? capacity : position;
+  }
+
+ private:
+  //! Set the priority of the given transition, and update its ancestors.
+  void SetPriority(size_t index, const double priority)
+  {
+    index += leaves;
+    const double delta = priority - tree[index];
+    for (; index > 0; index /= 2)
+      tree[index] += delta;
+  }
+
+  //! Find the transition at which the cumulative priority reaches the given
+  //! value.
+  size_t Find(double value) const
+  {
+    size_t index = 1;
+    while (index < leaves)
+    {
+      if (value < tree[2 * index] || tree[2 * index + 1] == 0.0)
+      {
+        index = 2 * index;
+      }
+      else
+      {
+        value -= tree[2 * index];
+        index = 2 * index + 1;
+      }
+    }
+
+    return index - leaves;
+  }
+
+  //! Locally-stored number of examples of each sample.
+  size_t batchSize;
+
+  //! Locally-stored total memory limit.
+  size_t capacity;
+
+  //! How much the priorities are used.
+  double alpha;
+
+  //! Value added to the absolute temporal difference errors.
+  double epsilon;
+
+  //! Indicate the position to store new transition.
+  size_t position;
+
+  //! Locally-stored indicator that whether the memory is full or not
+  bool full;
+
+  //! Locally-stored encoded previous states.
+  arma::mat states;
+
+  //! Locally-stored previous actions.
+  arma::icolvec actions;
+
+  //! Locally-stored previous rewards.
+  arma::colvec rewards;
+
+  //! Locally-stored encoded previous next states.
+  arma::mat nextStates;
+
+  //! Locally-stored termination information of previous experience.
+  arma::icolvec isTerminal;
+
+  //! The number of leaves of the sum tree (a power of two).
+  size_t leaves;
+
+  //! The sum tree; node i has children 2i and 2i + 1, and the priority of
+  //! transition j is the leaf leaves + j.
+  arma::vec tree;
+
+  //! The largest priority seen so far.
+  double maxPriority;
+
+  //! The transitions returned by the last call to Sample().
+  arma::Col<size_t> sampledIndices;
+
+  //! The lock that protects the memory.
+  std::mutex mutex;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
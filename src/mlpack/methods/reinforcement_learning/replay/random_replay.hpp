@@ -114,17 +114,34 @@ class RandomReplay
               arma::mat& sampledNextStates,
               arma::icolvec& isTerminal)
   {
-    size_t upperBound = full ? capacity : position;
-    arma::uvec sampledIndices = arma::randi<arma::uvec>(
-        batchSize, arma::distr_param(0, upperBound - 1));
-
-    sampledStates = states.cols(sampledIndices);
-    sampledActions = actions.elem(sampledIndices);
-    sampledRewards = rewards.elem(sampledIndices);
-    sampledNextStates = nextStates.cols(sampledIndices);
-    isTerminal = this->isTerminal.elem(sampledIndices);
+    // set_size() does nothing if the buffers already have the right size, so
+    // no memory is allocated when the same buffers are passed at every step.
+    sampledStates.set_size(states.n_rows, batchSize);
+    sampledActions.set_size(batchSize);
+    sampledRewards.set_size(batchSize);
+    sampledNextStates.set_size(nextStates.n_rows, batchSize);
+    isTerminal.set_size(batchSize);
+
+    const size_t upperBound = full ? capacity : position;
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const size_t index = math::RandInt(upperBound);
+      sampledStates.col(i) = states.col(index);
+      sampledActions[i] = actions[index];
+      sampledRewards[i] = rewards[index];
+      sampledNextStates.col(i) = nextStates.col(index);
+      isTerminal[i] = this->isTerminal[index];
+    }
   }
 
+  /**
+   * Update the priorities of the last sampled transitions.  Every transition
+   * has the same probability, so this does nothing.
+   *
+   * @param tdErrors The temporal difference error of each sampled transition.
+   */
+  void UpdatePriorities(const arma::colvec& /* tdErrors */) { }
+
   /**
    * Get the number of transitions in the memory.
    *
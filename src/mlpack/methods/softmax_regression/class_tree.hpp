@@ -0,0 +1,134 @@
+/**
+ * @file class_tree.hpp
+ *
+ * A binary tree over the classes of a classification problem, for hierarchical
+ * softmax regression.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_CLASS_TREE_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_CLASS_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace regression {
+
+/**
+ * A full binary tree whose leaves are the classes.  The numClasses - 1
+ * internal nodes are numbered from 0 to numClasses - 2, and the leaf of class
+ * c is numbered numClasses - 1 + c, so a node is a leaf if its number is at
+ * least NumInternalNodes().  The path from the root to the leaf of each class
+ * is stored as the list of internal nodes on it, with a sign for each: +1 if
+ * the path goes to the first child of the node, and -1 if it goes to the
+ * second child.
+ *
+ * The tree can be built in two ways.  Splitting the centroids of the classes
+ * recursively with 2-means puts similar classes under the same nodes, so that
+ * each decision is easy to learn.  The Huffman tree of the class frequencies
+ * gives the frequent classes the shortest paths, which minimizes the expected
+ * path length of the training points, and so the cost of training.
+ */
+class ClassTree
+{
+ public:
+  //! Create an empty tree.
+  ClassTree();
+
+  /**
+   * Build the tree by splitting the centroids of the classes recursively with
+   * 2-means.  If 2-means puts all the centroids of a node in one cluster (for
+   * instance, because they are all the same), they are split in two halves.
+   *
+   * @param data Training points, one per column.
+   * @param labels Class of each training point.
+   * @param numClasses Number of classes.
+   * @tparam MatType Type of the data matrix (arma::mat or arma::sp_mat).
+   */
+  template<typename MatType>
+  ClassTree(const MatType& data,
+            const arma::Row<size_t>& labels,
+            const size_t numClasses);
+
+  /**
+   * Build the Huffman tree of the frequencies of the classes.
+   *
+   * @param labels Class of each training point.
+   * @param numClasses Number of classes.
+   */
+  ClassTree(const arma::Row<size_t>& labels, const size_t numClasses);
+
+  //! Get the number of classes.
+  size_t NumClasses() const { return numClasses; }
+  //! Get the number of internal nodes.
+  size_t NumInternalNodes() const { return children.n_cols; }
+
+  //! Get the root node.
+  size_t Root() const { return root; }
+  //! Get the given child (0 or 1) of the given internal node.
+  size_t Child(const size_t node, const size_t child) const
+  {
+    return children(child, node);
+  }
+  //! Return whether the given node is a leaf.
+  bool IsLeaf(const size_t node) const { return node >= children.n_cols; }
+  //! Get the class of the given leaf.
+  size_t Class(const size_t leaf) const { return leaf - children.n_cols; }
+
+  //! Get the number of internal nodes on the path to the given class.
+  size_t PathLength(const size_t label) const
+  {
+    return pathStarts[label + 1] - pathStarts[label];
+  }
+  //! Get the k'th internal node on the path to the given class.
+  size_t PathNode(const size_t label, const size_t k) const
+  {
+    return pathNodes[pathStarts[label] + k];
+  }
+  //! Get the sign of the k'th decision on the path to the given class.
+  double PathSign(const size_t label, const size_t k) const
+  {
+    return pathSigns[pathStarts[label] + k];
+  }
+
+  //! Serialize the tree.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(numClasses, "numClasses");
+    ar & data::CreateNVP(root, "root");
+    ar & data::CreateNVP(children, "children");
+    ar & data::CreateNVP(pathStarts, "pathStarts");
+    ar & data::CreateNVP(pathNodes, "pathNodes");
+    ar & data::CreateNVP(pathSigns, "pathSigns");
+  }
+
+ private:
+  //! The number of classes.
+  size_t numClasses;
+  //! The root node.
+  size_t root;
+  //! The two children of each internal node.
+  arma::Mat<size_t> children;
+  //! The index in pathNodes of the first node on the path to each class,
+  //! followed by the number of nodes on all the paths.
+  arma::Col<size_t> pathStarts;
+  //! The internal nodes on the path to each class, from the root.
+  arma::Col<size_t> pathNodes;
+  //! The sign of each decision on the paths.
+  arma::vec pathSigns;
+
+  //! Compute the paths from the children of the nodes.
+  void ComputePaths();
+};
+
+} // namespace regression
+} // namespace mlpack
+
+// Include implementation.
+#include "class_tree_impl.hpp"
+
+#endif
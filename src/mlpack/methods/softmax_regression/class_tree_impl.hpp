@@ -0,0 +1,211 @@
+/**
+ * @file class_tree_impl.hpp
+ *
+ * Implementation of the construction of class trees.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_CLASS_TREE_IMPL_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_CLASS_TREE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "class_tree.hpp"
+
+#include <mlpack/methods/kmeans/kmeans.hpp>
+
+#include <queue>
+#include <tuple>
+
+namespace mlpack {
+namespace regression {
+
+inline ClassTree::ClassTree() :
+    numClasses(0),
+    root(0),
+    children(2, 0),
+    pathStarts(1, arma::fill::zeros)
+{
+  // Nothing to do.
+}
+
+template<typename MatType>
+ClassTree::ClassTree(const MatType& data,
+                     const arma::Row<size_t>& labels,
+                     const size_t numClasses) :
+    numClasses(numClasses),
+    root(0),
+    children(2, (numClasses == 0) ? 0 : numClasses - 1)
+{
+  if (numClasses == 0)
+    throw std::invalid_argument("ClassTree: there must be at least one class");
+
+  // Compute the centroid of each class.
+  arma::mat centroids(data.n_rows, numClasses, arma::fill::zeros);
+  arma::Col<size_t> counts(numClasses, arma::fill::zeros);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+  {
+    if (labels[i] >= numClasses)
+    {
+      std::ostringstream oss;
+      oss << "ClassTree: label " << labels[i] << " of point " << i << " is not "
+          << "below the number of classes (" << numClasses << ")";
+      throw std::invalid_argument(oss.str());
+    }
+
+    centroids.col(labels[i]) += data.col(i);
+    ++counts[labels[i]];
+  }
+  for (size_t c = 0; c < numClasses; ++c)
+  {
+    if (counts[c] > 0)
+      centroids.col(c) /= counts[c];
+  }
+
+  // Split the classes from the root down.  Each entry of the stack holds the
+  // classes under a node, its parent and which child of the parent it is.
+  const size_t noParent = size_t(-1);
+  std::vector<std::tuple<arma::uvec, size_t, size_t>> stack;
+  stack.emplace_back(arma::regspace<arma::uvec>(0, numClasses - 1), noParent,
+      0);
+  size_t nextNode = 0;
+  kmeans::KMeans<> kmeans;
+  while (!stack.empty())
+  {
+    const arma::uvec classes = std::move(std::get<0>(stack.back()));
+    const size_t parent = std::get<1>(stack.back());
+    const size_t child = std::get<2>(stack.back());
+    stack.pop_back();
+
+    size_t node;
+    if (classes.n_elem == 1)
+    {
+      node = children.n_cols + classes[0];
+    }
+    else
+    {
+      node = nextNode++;
+
+      arma::Row<size_t> assignments(classes.n_elem, arma::fill::zeros);
+      if (classes.n_elem == 2)
+      {
+        assignments[1] = 1;
+      }
+      else
+      {
+        const arma::mat nodeCentroids = centroids.cols(classes);
+        kmeans.Cluster(nodeCentroids, 2, assignments);
+      }
+
+      arma::uvec firstClasses = classes(arma::find(assignments == 0));
+      arma::uvec secondClasses = classes(arma::find(assignments == 1));
+      if (firstClasses.n_elem == 0 || secondClasses.n_elem == 0)
+      {
+        firstClasses = classes.head(classes.n_elem / 2);
+        secondClasses = classes.tail(classes.n_elem - classes.n_elem / 2);
+      }
+
+      stack.emplace_back(std::move(firstClasses), node, 0);
+      stack.emplace_back(std::move(secondClasses), node, 1);
+    }
+
+    if (parent == noParent)
+      root = node;
+    else
+      children(child, parent) = node;
+  }
+
+  ComputePaths();
+}
+
+inline ClassTree::ClassTree(const arma::Row<size_t>& labels,
+                            const size_t numClasses) :
+    numClasses(numClasses),
+    root(0),
+    children(2, (numClasses == 0) ? 0 : numClasses - 1)
+{
+  if (numClasses == 0)
+    throw std::invalid_argument("ClassTree: there must be at least one class");
+
+  arma::Col<size_t> counts(numClasses, arma::fill::zeros);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+  {
+    if (labels[i] >= numClasses)
+    {
+      std::ostringstream oss;
+      oss << "ClassTree: label " << labels[i] << " of point " << i << " is not "
+          << "below the number of classes (" << numClasses << ")";
+      throw std::invalid_argument(oss.str());
+    }
+
+    ++counts[labels[i]];
+  }
+
+  // Repeatedly merge the two least frequent nodes; ties are broken by node
+  // number, so the tree is deterministic.
+  typedef std::pair<size_t, size_t> CountNode;
+  std::priority_queue<CountNode, std::vector<CountNode>,
+      std::greater<CountNode>> queue;
+  for (size_t c = 0; c < numClasses; ++c)
+    queue.push(CountNode(counts[c], children.n_cols + c));
+
+  for (size_t node = 0; node < children.n_cols; ++node)
+  {
+    const CountNode first = queue.top();
+    queue.pop();
+    const CountNode second = queue.top();
+    queue.pop();
+
+    children(0, node) = first.second;
+    children(1, node) = second.second;
+    queue.push(CountNode(first.first + second.first, node));
+  }
+  root = queue.top().second;
+
+  ComputePaths();
+}
+
+inline void ClassTree::ComputePaths()
+{
+  // Find the parent of each node, and which child of it the node is.
+  const size_t numNodes = children.n_cols + numClasses;
+  arma::Col<size_t> parents(numNodes);
+  arma::vec signs(numNodes);
+  for (size_t node = 0; node < children.n_cols; ++node)
+  {
+    parents[children(0, node)] = node;
+    signs[children(0, node)] = 1.0;
+    parents[children(1, node)] = node;
+    signs[children(1, node)] = -1.0;
+  }
+
+  // Get the length of each path, then walk up from each leaf.
+  pathStarts.zeros(numClasses + 1);
+  for (size_t c = 0; c < numClasses; ++c)
+  {
+    size_t length = 0;
+    for (size_t node = children.n_cols + c; node != root; node = parents[node])
+      ++length;
+    pathStarts[c + 1] = pathStarts[c] + length;
+  }
+
+  pathNodes.set_size(pathStarts[numClasses]);
+  pathSigns.set_size(pathStarts[numClasses]);
+  for (size_t c = 0; c < numClasses; ++c)
+  {
+    size_t k = pathStarts[c + 1];
+    for (size_t node = children.n_cols + c; node != root; node = parents[node])
+    {
+      --k;
+      pathNodes[k] = parents[node];
+      pathSigns[k] = signs[node];
+    }
+  }
+}
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
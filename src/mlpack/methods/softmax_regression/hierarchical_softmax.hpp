@@ -0,0 +1,222 @@
+/**
+ * @file hierarchical_softmax.hpp
+ *
+ * Hierarchical softmax regression, for classification with very many classes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_HIERARCHICAL_SOFTMAX_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_HIERARCHICAL_SOFTMAX_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+
+#include "class_tree.hpp"
+#include "hierarchical_softmax_function.hpp"
+
+namespace mlpack {
+namespace regression {
+
+/**
+ * Hierarchical softmax regression replaces the C-way softmax of
+ * SoftmaxRegression with a binary tree of logistic decisions over the classes
+ * (see ClassTree and HierarchicalSoftmaxFunction), so both training on a
+ * point and classifying a point cost O(d log C) instead of O(d C).  The tree
+ * is built either with 2-means on the class centroids or as the Huffman tree
+ * of the class frequencies.
+ *
+ * A point is classified with a beam search down the tree: the beamWidth most
+ * probable partial paths are kept at each level, and the most probable class
+ * that is reached is returned.  A beam width of 1 follows the most probable
+ * child at every node; wider beams find the most probable class more often.
+ *
+ * An example on how to use the interface is shown below.  With very many
+ * classes, SGD with sparse gradients only updates the nodes on the path of
+ * each point:
+ *
+ * @code
+ * arma::mat data; // Training data matrix.
+ * arma::Row<size_t> labels; // Labels associated with the data.
+ * const size_t numClasses = 100000; // Number of classes.
+ *
+ * // Train the model with L-BFGS, on a tree built with 2-means.
+ * HierarchicalSoftmaxRegression model1(data, labels, numClasses);
+ *
+ * // Train the model with SGD, on the Huffman tree of the class frequencies.
+ * ClassTree tree(labels, numClasses);
+ * HierarchicalSoftmaxFunction<> f(data, labels, tree);
+ * SGD<HierarchicalSoftmaxFunction<>> sgd(f, 0.01, 10 * data.n_cols);
+ * HierarchicalSoftmaxRegression model2;
+ * model2.Train(sgd);
+ *
+ * arma::mat testData; // Test data matrix.
+ * arma::Row<size_t> predictions; // Vector to store predictions in.
+ * model2.Classify(testData, predictions, 4); // Use a beam width of 4.
+ * @endcode
+ */
+class HierarchicalSoftmaxRegression
+{
+ public:
+  /**
+   * Create the model without training it.  Be sure to use Train() before
+   * calling Classify() or ComputeAccuracy().
+   */
+  HierarchicalSoftmaxRegression() : lambda(0.0001), fitIntercept(false) { }
+
+  /**
+   * Build the tree over the classes and train the model on the given data
+   * with L-BFGS.
+   *
+   * @param data Input training features, one column per point.
+   * @param labels Labels associated with the feature data.
+   * @param numClasses Number of classes for classification.
+   * @param lambda L2-regularization constant.
+   * @param fitIntercept Add intercept term or not.
+   * @param frequencyTree If true, use the Huffman tree of the class
+   *     frequencies; otherwise, split the class centroids with 2-means.
+   * @tparam MatType Type of the data matrix (arma::mat or arma::sp_mat).
+   */
+  template<typename MatType>
+  HierarchicalSoftmaxRegression(const MatType& data,
+                                const arma::Row<size_t>& labels,
+                                const size_t numClasses,
+                                const double lambda = 0.0001,
+                                const bool fitIntercept = false,
+                                const bool frequencyTree = false);
+
+  /**
+   * Train the model with the given optimizer, which should hold an
+   * instantiated HierarchicalSoftmaxFunction; the tree, the regularization and
+   * the intercept flag are taken from that function.
+   *
+   * @param optimizer Instantiated optimizer with instantiated error function.
+   * @return Objective value of the final point.
+   */
+  template<typename OptimizerType>
+  double Train(OptimizerType& optimizer);
+
+  /**
+   * Build the tree over the classes and train the model on the given data
+   * with L-BFGS.
+   *
+   * @param data Input training features, one column per point.
+   * @param labels Labels associated with the feature data.
+   * @param numClasses Number of classes for classification.
+   * @param frequencyTree If true, use the Huffman tree of the class
+   *     frequencies; otherwise, split the class centroids with 2-means.
+   * @return Objective value of the final point.
+   */
+  template<typename MatType>
+  double Train(const MatType& data,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const bool frequencyTree = false);
+
+  /**
+   * Classify the given point with a beam search down the class tree.
+   *
+   * @param point Point to be classified.
+   * @param beamWidth Number of partial paths kept at each level.
+   * @return Predicted class label of the point.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point, const size_t beamWidth = 1) const;
+
+  /**
+   * Classify the given points, in parallel, with a beam search down the class
+   * tree.
+   *
+   * @param dataset Set of points to classify.
+   * @param labels Predicted labels for each point.
+   * @param beamWidth Number of partial paths kept at each level.
+   */
+  template<typename MatType>
+  void Classify(const MatType& dataset,
+                arma::Row<size_t>& labels,
+                const size_t beamWidth = 1) const;
+
+  /**
+   * Return the probability of the given class for the given point, which is
+   * the product of the probabilities of the decisions on its path.
+   *
+   * @param point Point to evaluate.
+   * @param label Class to compute the probability of.
+   */
+  template<typename VecType>
+  double Probability(const VecType& point, const size_t label) const;
+
+  /**
+   * Computes accuracy of the learned model given the feature data and the
+   * labels associated with each data point.
+   *
+   * @param testData Matrix of data points using which predictions are made.
+   * @param labels Vector of labels associated with the data.
+   * @param beamWidth Number of partial paths kept at each level.
+   */
+  template<typename MatType>
+  double ComputeAccuracy(const MatType& testData,
+                         const arma::Row<size_t>& labels,
+                         const size_t beamWidth = 1) const;
+
+  //! Gets the number of classes.
+  size_t NumClasses() const { return tree.NumClasses(); }
+
+  //! Sets the regularization parameter.
+  double& Lambda() { return lambda; }
+  //! Gets the regularization parameter.
+  double Lambda() const { return lambda; }
+
+  //! Gets the intercept term flag.  We can't change this after training.
+  bool FitIntercept() const { return fitIntercept; }
+
+  //! Get the tree over the classes.
+  const ClassTree& Tree() const { return tree; }
+
+  //! Get the model parameters (one column per internal node of the tree).
+  arma::mat& Parameters() { return parameters; }
+  //! Get the model parameters (one column per internal node of the tree).
+  const arma::mat& Parameters() const { return parameters; }
+
+  //! Gets the features size of the training data.
+  size_t FeatureSize() const
+  { return fitIntercept ? parameters.n_rows - 1 : parameters.n_rows; }
+
+  /**
+   * Serialize the model.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    using mlpack::data::CreateNVP;
+
+    ar & CreateNVP(parameters, "parameters");
+    ar & CreateNVP(tree, "tree");
+    ar & CreateNVP(lambda, "lambda");
+    ar & CreateNVP(fitIntercept, "fitIntercept");
+  }
+
+ private:
+  //! Parameters after optimization.
+  arma::mat parameters;
+  //! The tree over the classes.
+  ClassTree tree;
+  //! L2-regularization constant.
+  double lambda;
+  //! Intercept term flag.
+  bool fitIntercept;
+
+  //! Compute the score of the given point for the given node.
+  template<typename VecType>
+  double Score(const VecType& point, const size_t node) const;
+};
+
+} // namespace regression
+} // namespace mlpack
+
+// Include implementation.
+#include "hierarchical_softmax_impl.hpp"
+
+#endif
@@ -0,0 +1,221 @@
+/**
+ * @file hierarchical_softmax_function.hpp
+ *
+ * The objective function of hierarchical softmax regression.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_HIERARCHICAL_SOFTMAX_FUNCTION_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_HIERARCHICAL_SOFTMAX_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "class_tree.hpp"
+
+namespace mlpack {
+namespace regression {
+
+/**
+ * The objective function of hierarchical softmax regression.  Each internal
+ * node of a ClassTree has a logistic regression model that decides between
+ * its two children, and the probability of a class is the product of the
+ * probabilities of the decisions on its path,
+ *
+ * \f[
+ * p(c | x) = \prod_{k} \sigma(s_k \theta_{n_k}^T x),
+ * \f]
+ *
+ * where n_k and s_k are the nodes and signs on the path to c (see
+ * ClassTree::PathNode() and ClassTree::PathSign()).  These probabilities sum
+ * to one over the classes, and the objective and gradient of a point only
+ * depend on the O(log C) nodes on the path to its class, instead of on all the
+ * C classes as in SoftmaxRegressionFunction.
+ *
+ * The parameters have one column per internal node (with the intercept in the
+ * first row, if it is fitted), so the parameters of a node are contiguous.
+ * The objective is the mean negative log-likelihood of the points plus the
+ * L2-regularization of the nodes that are on the path of at least one point.
+ *
+ * The objective is separable: NumFunctions() is the number of points, and the
+ * regularization of each node is divided among the points that go through
+ * it, so Evaluate(parameters, i) and Gradient(parameters, i, gradient) only
+ * touch the nodes on the path of point i.  The sparse Gradient() overload lets
+ * SGD update only those nodes (see HasSparseGradient), so an SGD step costs
+ * O(d log C) instead of O(d C).
+ *
+ * @tparam MatType Type of data matrix (arma::mat or arma::sp_mat).
+ */
+template<typename MatType = arma::mat>
+class HierarchicalSoftmaxFunction
+{
+ public:
+  /**
+   * Construct the objective function.
+   *
+   * @param data Input training data, each column associate with one sample.
+   * @param labels Labels associated with the feature data.
+   * @param tree Tree over the classes.
+   * @param lambda L2-regularization constant.
+   * @param fitIntercept Intercept term flag.
+   */
+  HierarchicalSoftmaxFunction(const MatType& data,
+                              const arma::Row<size_t>& labels,
+                              const ClassTree& tree,
+                              const double lambda = 0.0001,
+                              const bool fitIntercept = false);
+
+  /**
+   * Initialize the weights of the nodes to small random values.
+   *
+   * @param weights This will be filled with the initialized model weights.
+   * @param featureSize The number of features in the training set.
+   * @param numInternalNodes Number of internal nodes in the class tree.
+   * @param fitIntercept Intercept term flag.
+   */
+  static void InitializeWeights(arma::mat& weights,
+                                const size_t featureSize,
+                                const size_t numInternalNodes,
+                                const bool fitIntercept = false);
+
+  /**
+   * Evaluate the objective function on all the points.
+   *
+   * @param parameters Current values of the model parameters.
+   */
+  double Evaluate(const arma::mat& parameters) const;
+
+  /**
+   * Evaluate the gradient of the objective function on all the points.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
+
+  /**
+   * Evaluate the objective function and its gradient on all the points, in
+   * one pass.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the part of the objective function that belongs to one point.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of point to use for objective function evaluation.
+   */
+  double Evaluate(const arma::mat& parameters, const size_t i) const;
+
+  /**
+   * Evaluate the gradient of the part of the objective function that belongs
+   * to one point.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of point to use for objective function gradient evaluation.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient) const;
+
+  /**
+   * Evaluate the part of the objective function that belongs to one point, and
+   * its gradient.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of point to use for objective function evaluation.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function of the point.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t i,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the gradient of the part of the objective function that belongs
+   * to one point, as a sparse matrix whose only non-zero columns are the nodes
+   * on the path of the point.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of point to use for objective function gradient evaluation.
+   * @param gradient Sparse matrix to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::sp_mat& gradient) const;
+
+  //! Return the initial point for the optimization.
+  const arma::mat& GetInitialPoint() const { return initialPoint; }
+
+  //! Return the number of separable functions (the number of points).
+  size_t NumFunctions() const { return data.n_cols; }
+
+  //! Get the tree over the classes.
+  const ClassTree& Tree() const { return tree; }
+
+  //! Gets the number of classes.
+  size_t NumClasses() const { return tree.NumClasses(); }
+
+  //! Gets the features size of the training data.
+  size_t FeatureSize() const { return data.n_rows; }
+
+  //! Sets the regularization parameter.
+  double& Lambda() { return lambda; }
+  //! Gets the regularization parameter.
+  double Lambda() const { return lambda; }
+
+  //! Gets the intercept flag.
+  bool FitIntercept() const { return fitIntercept; }
+
+ private:
+  //! Training data matrix.
+  const MatType& data;
+  //! Labels of the training points.
+  arma::Row<size_t> labels;
+  //! The tree over the classes.
+  ClassTree tree;
+  //! The number of points whose path goes through each internal node.
+  arma::vec nodeCounts;
+  //! Initial parameter point.
+  arma::mat initialPoint;
+  //! L2-regularization constant.
+  double lambda;
+  //! Intercept term flag.
+  bool fitIntercept;
+
+  //! Compute the score of point i for the given node.
+  double Score(const arma::mat& parameters,
+               const size_t node,
+               const size_t i) const;
+
+  //! Add the given multiple of point i (with a 1 for the intercept, if it is
+  //! fitted) to the given column of the gradient.
+  void AddPoint(const size_t i,
+                const double scale,
+                arma::mat& gradient,
+                const size_t column) const;
+
+  /**
+   * Return the negative log-likelihood of point i, and store in coefficients
+   * its derivative with respect to the score of each node on the path.
+   */
+  double PathObjective(const arma::mat& parameters,
+                       const size_t i,
+                       arma::vec& coefficients) const;
+};
+
+} // namespace regression
+} // namespace mlpack
+
+// Include implementation.
+#include "hierarchical_softmax_function_impl.hpp"
+
+#endif
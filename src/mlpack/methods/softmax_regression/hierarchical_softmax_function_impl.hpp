@@ -0,0 +1,288 @@
+/**
+ * @file hierarchical_softmax_function_impl.hpp
+ *
+ * Implementation of the objective function of hierarchical softmax
+ * regression.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_HIERARCHICAL_SOFTMAX_FUNCTION_IMPL_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_HIERARCHICAL_SOFTMAX_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hierarchical_softmax_function.hpp"
+
+namespace mlpack {
+namespace regression {
+
+template<typename MatType>
+HierarchicalSoftmaxFunction<MatType>::HierarchicalSoftmaxFunction(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const ClassTree& tree,
+    const double lambda,
+    const bool fitIntercept) :
+    data(data),
+    labels(labels),
+    tree(tree),
+    lambda(lambda),
+    fitIntercept(fitIntercept)
+{
+  if (labels.n_elem != data.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "HierarchicalSoftmaxFunction: there are " << data.n_cols
+        << " points but " << labels.n_elem << " labels";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Count the points that go through each node.
+  nodeCounts.zeros(tree.NumInternalNodes());
+  for (size_t i = 0; i < labels.n_elem; ++i)
+  {
+    if (labels[i] >= tree.NumClasses())
+    {
+      std::ostringstream oss;
+      oss << "HierarchicalSoftmaxFunction: label " << labels[i] << " of point "
+          << i << " is not below the number of classes (" << tree.NumClasses()
+          << ")";
+      throw std::invalid_argument(oss.str());
+    }
+
+    for (size_t k = 0; k < tree.PathLength(labels[i]); ++k)
+      ++nodeCounts[tree.PathNode(labels[i], k)];
+  }
+
+  InitializeWeights(initialPoint, data.n_rows, tree.NumInternalNodes(),
+      fitIntercept);
+}
+
+template<typename MatType>
+void HierarchicalSoftmaxFunction<MatType>::InitializeWeights(
+    arma::mat& weights,
+    const size_t featureSize,
+    const size_t numInternalNodes,
+    const bool fitIntercept)
+{
+  // Initialize values to 0.005 * r, as for SoftmaxRegressionFunction.
+  weights.randn(fitIntercept ? featureSize + 1 : featureSize,
+      numInternalNodes);
+  weights *= 0.005;
+}
+
+template<typename MatType>
+double HierarchicalSoftmaxFunction<MatType>::Score(
+    const arma::mat& parameters,
+    const size_t node,
+    const size_t i) const
+{
+  if (fitIntercept)
+  {
+    return parameters(0, node) + arma::dot(data.col(i),
+        parameters.col(node).subvec(1, parameters.n_rows - 1));
+  }
+
+  return arma::dot(data.col(i), parameters.col(node));
+}
+
+template<typename MatType>
+void HierarchicalSoftmaxFunction<MatType>::AddPoint(
+    const size_t i,
+    const double scale,
+    arma::mat& gradient,
+    const size_t column) const
+{
+  if (fitIntercept)
+  {
+    gradient(0, column) += scale;
+    gradient.col(column).subvec(1, gradient.n_rows - 1) += scale * data.col(i);
+  }
+  else
+  {
+    gradient.col(column) += scale * data.col(i);
+  }
+}
+
+template<typename MatType>
+double HierarchicalSoftmaxFunction<MatType>::PathObjective(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::vec& coefficients) const
+{
+  const size_t label = labels[i];
+  coefficients.set_size(tree.PathLength(label));
+
+  double objective = 0.0;
+  for (size_t k = 0; k < coefficients.n_elem; ++k)
+  {
+    const double sign = tree.PathSign(label, k);
+    const double t = sign * Score(parameters, tree.PathNode(label, k), i);
+
+    // -log(sigmoid(t)), without overflow for large |t|, and its derivative
+    // with respect to the score.
+    objective += (t > 0) ? std::log1p(std::exp(-t)) :
+        -t + std::log1p(std::exp(t));
+    coefficients[k] = -sign / (1.0 + std::exp(t));
+  }
+
+  return objective;
+}
+
+template<typename MatType>
+double HierarchicalSoftmaxFunction<MatType>::Evaluate(
+    const arma::mat& parameters) const
+{
+  double negativeLogLikelihood = 0.0;
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static) reduction(+:negativeLogLikelihood)
+  for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static) reduction(+:negativeLogLikelihood)
+  for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+  {
+    arma::vec coefficients;
+    negativeLogLikelihood += PathObjective(parameters, i, coefficients);
+  }
+
+  double weightDecay = 0.0;
+  for (size_t node = 0; node < nodeCounts.n_elem; ++node)
+  {
+    if (nodeCounts[node] > 0)
+      weightDecay += arma::dot(parameters.col(node), parameters.col(node));
+  }
+
+  return negativeLogLikelihood / data.n_cols + 0.5 * lambda * weightDecay;
+}
+
+template<typename MatType>
+void HierarchicalSoftmaxFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  EvaluateWithGradient(parameters, gradient);
+}
+
+template<typename MatType>
+double HierarchicalSoftmaxFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  gradient.zeros(parameters.n_rows, parameters.n_cols);
+
+  double objective = 0.0;
+  arma::vec coefficients;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    objective += PathObjective(parameters, i, coefficients) / data.n_cols;
+    for (size_t k = 0; k < coefficients.n_elem; ++k)
+    {
+      AddPoint(i, coefficients[k] / data.n_cols, gradient,
+          tree.PathNode(labels[i], k));
+    }
+  }
+
+  for (size_t node = 0; node < nodeCounts.n_elem; ++node)
+  {
+    if (nodeCounts[node] > 0)
+    {
+      gradient.col(node) += lambda * parameters.col(node);
+      objective += 0.5 * lambda * arma::dot(parameters.col(node),
+          parameters.col(node));
+    }
+  }
+
+  return objective;
+}
+
+template<typename MatType>
+double HierarchicalSoftmaxFunction<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t i) const
+{
+  arma::vec coefficients;
+  double objective = PathObjective(parameters, i, coefficients) / data.n_cols;
+
+  // Each point pays its share of the regularization of the nodes on its path.
+  for (size_t k = 0; k < coefficients.n_elem; ++k)
+  {
+    const size_t node = tree.PathNode(labels[i], k);
+    objective += 0.5 * lambda * arma::dot(parameters.col(node),
+        parameters.col(node)) / nodeCounts[node];
+  }
+
+  return objective;
+}
+
+template<typename MatType>
+void HierarchicalSoftmaxFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::mat& gradient) const
+{
+  EvaluateWithGradient(parameters, i, gradient);
+}
+
+template<typename MatType>
+double HierarchicalSoftmaxFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::mat& gradient) const
+{
+  gradient.zeros(parameters.n_rows, parameters.n_cols);
+
+  arma::vec coefficients;
+  double objective = PathObjective(parameters, i, coefficients) / data.n_cols;
+  for (size_t k = 0; k < coefficients.n_elem; ++k)
+  {
+    const size_t node = tree.PathNode(labels[i], k);
+    objective += 0.5 * lambda * arma::dot(parameters.col(node),
+        parameters.col(node)) / nodeCounts[node];
+
+    gradient.col(node) += lambda * parameters.col(node) / nodeCounts[node];
+    AddPoint(i, coefficients[k] / data.n_cols, gradient, node);
+  }
+
+  return objective;
+}
+
+template<typename MatType>
+void HierarchicalSoftmaxFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::sp_mat& gradient) const
+{
+  arma::vec coefficients;
+  PathObjective(parameters, i, coefficients);
+
+  // Compute the dense gradient column of each node on the path.
+  const size_t numRows = parameters.n_rows;
+  arma::umat locations(2, numRows * coefficients.n_elem);
+  arma::mat values(numRows, coefficients.n_elem);
+  for (size_t k = 0; k < coefficients.n_elem; ++k)
+  {
+    const size_t node = tree.PathNode(labels[i], k);
+    values.col(k) = lambda * parameters.col(node) / nodeCounts[node];
+    AddPoint(i, coefficients[k] / data.n_cols, values, k);
+
+    for (size_t r = 0; r < numRows; ++r)
+    {
+      locations(0, k * numRows + r) = r;
+      locations(1, k * numRows + r) = node;
+    }
+  }
+
+  gradient = arma::sp_mat(locations, arma::vectorise(values),
+      parameters.n_rows, parameters.n_cols);
+}
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,227 @@
+/**
+ * @file hierarchical_softmax_impl.hpp
+ *
+ * Implementation of hierarchical softmax regression.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_HIERARCHICAL_SOFTMAX_IMPL_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_HIERARCHICAL_SOFTMAX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hierarchical_softmax.hpp"
+
+namespace mlpack {
+namespace regression {
+
+template<typename MatType>
+HierarchicalSoftmaxRegression::HierarchicalSoftmaxRegression(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const double lambda,
+    const bool fitIntercept,
+    const bool frequencyTree) :
+    lambda(lambda),
+    fitIntercept(fitIntercept)
+{
+  Train(data, labels, numClasses, frequencyTree);
+}
+
+template<typename OptimizerType>
+double HierarchicalSoftmaxRegression::Train(OptimizerType& optimizer)
+{
+  tree = optimizer.Function().Tree();
+  lambda = optimizer.Function().Lambda();
+  fitIntercept = optimizer.Function().FitIntercept();
+  parameters = optimizer.Function().GetInitialPoint();
+
+  // Train the model.
+  Timer::Start("hierarchical_softmax_regression_optimization");
+  const double out = optimizer.Optimize(parameters);
+  Timer::Stop("hierarchical_softmax_regression_optimization");
+
+  Log::Info << "HierarchicalSoftmaxRegression::Train(): final objective of "
+            << "trained model is " << out << "." << std::endl;
+
+  return out;
+}
+
+template<typename MatType>
+double HierarchicalSoftmaxRegression::Train(const MatType& data,
+                                            const arma::Row<size_t>& labels,
+                                            const size_t numClasses,
+                                            const bool frequencyTree)
+{
+  const ClassTree newTree = frequencyTree ? ClassTree(labels, numClasses) :
+      ClassTree(data, labels, numClasses);
+
+  HierarchicalSoftmaxFunction<MatType> regressor(data, labels, newTree,
+      lambda, fitIntercept);
+  optimization::L_BFGS<HierarchicalSoftmaxFunction<MatType>> optimizer(
+      regressor);
+
+  return Train(optimizer);
+}
+
+template<typename VecType>
+double HierarchicalSoftmaxRegression::Score(const VecType& point,
+                                            const size_t node) const
+{
+  if (fitIntercept)
+  {
+    return parameters(0, node) + arma::dot(point,
+        parameters.col(node).subvec(1, parameters.n_rows - 1));
+  }
+
+  return arma::dot(point, parameters.col(node));
+}
+
+template<typename VecType>
+size_t HierarchicalSoftmaxRegression::Classify(const VecType& point,
+                                               const size_t beamWidth) const
+{
+  if (point.n_elem != FeatureSize())
+  {
+    std::ostringstream oss;
+    oss << "HierarchicalSoftmaxRegression::Classify(): point has "
+        << point.n_elem << " dimensions, but model has " << FeatureSize()
+        << " dimensions";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (beamWidth == 0)
+  {
+    throw std::invalid_argument("HierarchicalSoftmaxRegression::Classify(): "
+        "beam width must be at least 1");
+  }
+
+  // Each entry of the beam holds the log-probability of reaching a node and
+  // the node.  Leaves are kept as they are, and internal nodes are replaced by
+  // their two children, until only leaves are left.
+  typedef std::pair<double, size_t> Candidate;
+  std::vector<Candidate> beam(1, Candidate(0.0, tree.Root()));
+  std::vector<Candidate> nextBeam;
+  bool expanded = true;
+  while (expanded)
+  {
+    expanded = false;
+    nextBeam.clear();
+    for (const Candidate& candidate : beam)
+    {
+      if (tree.IsLeaf(candidate.second))
+      {
+        nextBeam.push_back(candidate);
+        continue;
+      }
+
+      // log(sigmoid(z)) and log(sigmoid(-z)), without overflow for large |z|.
+      const double z = Score(point, candidate.second);
+      const double logFirst = (z > 0) ? -std::log1p(std::exp(-z)) :
+          z - std::log1p(std::exp(z));
+      nextBeam.push_back(Candidate(candidate.first + logFirst,
+          tree.Child(candidate.second, 0)));
+      nextBeam.push_back(Candidate(candidate.first + logFirst - z,
+          tree.Child(candidate.second, 1)));
+      expanded = true;
+    }
+
+    // Keep the most probable candidates.
+    const size_t width = std::min(beamWidth, nextBeam.size());
+    std::partial_sort(nextBeam.begin(), nextBeam.begin() + width,
+        nextBeam.end(), std::greater<Candidate>());
+    nextBeam.resize(width);
+    beam.swap(nextBeam);
+  }
+
+  return tree.Class(beam[0].second);
+}
+
+template<typename MatType>
+void HierarchicalSoftmaxRegression::Classify(const MatType& dataset,
+                                             arma::Row<size_t>& labels,
+                                             const size_t beamWidth) const
+{
+  if (dataset.n_rows != FeatureSize())
+  {
+    std::ostringstream oss;
+    oss << "HierarchicalSoftmaxRegression::Classify(): dataset has "
+        << dataset.n_rows << " dimensions, but model has " << FeatureSize()
+        << " dimensions";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (beamWidth == 0)
+  {
+    throw std::invalid_argument("HierarchicalSoftmaxRegression::Classify(): "
+        "beam width must be at least 1");
+  }
+
+  labels.set_size(dataset.n_cols);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables.
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
+  {
+    labels[i] = Classify(dataset.col(i), beamWidth);
+  }
+}
+
+template<typename VecType>
+double HierarchicalSoftmaxRegression::Probability(const VecType& point,
+                                                  const size_t label) const
+{
+  if (label >= NumClasses())
+  {
+    std::ostringstream oss;
+    oss << "HierarchicalSoftmaxRegression::Probability(): label " << label
+        << " is not below the number of classes (" << NumClasses() << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  double logProbability = 0.0;
+  for (size_t k = 0; k < tree.PathLength(label); ++k)
+  {
+    const double t = tree.PathSign(label, k) *
+        Score(point, tree.PathNode(label, k));
+    logProbability -= (t > 0) ? std::log1p(std::exp(-t)) :
+        -t + std::log1p(std::exp(t));
+  }
+
+  return std::exp(logProbability);
+}
+
+template<typename MatType>
+double HierarchicalSoftmaxRegression::ComputeAccuracy(
+    const MatType& testData,
+    const arma::Row<size_t>& labels,
+    const size_t beamWidth) const
+{
+  arma::Row<size_t> predictions;
+
+  // Get predictions for the provided data.
+  Classify(testData, predictions, beamWidth);
+
+  // Increment count for every correctly predicted label.
+  size_t count = 0;
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    if (predictions(i) == labels(i))
+      count++;
+
+  // Return percentage accuracy.
+  return (count * 100.0) / predictions.n_elem;
+}
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,194 @@
+/**
+ * @file sampled_softmax_function.hpp
+ *
+ * A sampled approximation of the softmax regression objective function, for
+ * training softmax regression with very many classes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_SAMPLED_SOFTMAX_FUNCTION_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_SAMPLED_SOFTMAX_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "softmax_regression_function.hpp"
+
+namespace mlpack {
+namespace regression {
+
+/**
+ * A sampled approximation of the objective function of softmax regression.
+ * For each point, the softmax is taken over the true class and numSampled
+ * classes drawn uniformly (with replacement) from the other classes, instead
+ * of over all the C classes.  The scores of the sampled classes are corrected
+ * by the log of their expected number of occurrences, log(numSampled /
+ * (C - 1)), so that the sampled normalizer is an unbiased estimate of the
+ * full one; with two classes the approximation is exact.
+ *
+ * The parameters have the layout of SoftmaxRegression (one row per class,
+ * with the intercept in the first column if it is fitted), so the trained
+ * parameters can be given to SoftmaxRegression::Parameters() and the model
+ * classifies with the full softmax.  The L2-regularization of each class is
+ * divided among the points of that class, so the objective of a point only
+ * touches the rows of its numSampled + 1 candidate classes; the sparse
+ * Gradient() overload lets SGD update only those rows (see HasSparseGradient),
+ * so an SGD step costs O(d numSampled) instead of O(d C).
+ *
+ * The function is only separable: each call to Evaluate() or Gradient() draws
+ * new samples, so it should be optimized with SGD or one of its variants.
+ *
+ * @code
+ * SampledSoftmaxFunction<> f(data, labels, numClasses, 20);
+ * SGD<SampledSoftmaxFunction<>> sgd(f, 0.01, 10 * data.n_cols);
+ * arma::mat parameters = f.GetInitialPoint();
+ * sgd.Optimize(parameters);
+ *
+ * SoftmaxRegression<> model(data.n_rows, numClasses);
+ * model.Parameters() = parameters;
+ * @endcode
+ *
+ * @tparam MatType Type of data matrix (arma::mat or arma::sp_mat).
+ */
+template<typename MatType = arma::mat>
+class SampledSoftmaxFunction
+{
+ public:
+  /**
+   * Construct the objective function.
+   *
+   * @param data Input training data, each column associate with one sample.
+   * @param labels Labels associated with the feature data.
+   * @param numClasses Number of classes for classification.
+   * @param numSampled Number of classes sampled for each point.
+   * @param lambda L2-regularization constant.
+   * @param fitIntercept Intercept term flag.
+   */
+  SampledSoftmaxFunction(const MatType& data,
+                         const arma::Row<size_t>& labels,
+                         const size_t numClasses,
+                         const size_t numSampled = 20,
+                         const double lambda = 0.0001,
+                         const bool fitIntercept = false);
+
+  /**
+   * Evaluate the sampled objective function of one point.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of point to use for objective function evaluation.
+   */
+  double Evaluate(const arma::mat& parameters, const size_t i) const;
+
+  /**
+   * Evaluate the gradient of the sampled objective function of one point.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of point to use for objective function gradient evaluation.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient) const;
+
+  /**
+   * Evaluate the sampled objective function of one point and its gradient,
+   * with the same samples.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of point to use for objective function evaluation.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The sampled objective function of the point.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t i,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the gradient of the sampled objective function of one point, as
+   * a sparse matrix whose only non-zero rows are the candidate classes.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of point to use for objective function gradient evaluation.
+   * @param gradient Sparse matrix to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::sp_mat& gradient) const;
+
+  //! Return the initial point for the optimization.
+  const arma::mat& GetInitialPoint() const { return initialPoint; }
+
+  //! Return the number of separable functions (the number of points).
+  size_t NumFunctions() const { return data.n_cols; }
+
+  //! Gets the number of classes.
+  size_t NumClasses() const { return numClasses; }
+
+  //! Get the number of classes sampled for each point.
+  size_t NumSampled() const { return numSampled; }
+  //! Modify the number of classes sampled for each point.
+  size_t& NumSampled() { return numSampled; }
+
+  //! Gets the features size of the training data.
+  size_t FeatureSize() const { return data.n_rows; }
+
+  //! Sets the regularization parameter.
+  double& Lambda() { return lambda; }
+  //! Gets the regularization parameter.
+  double Lambda() const { return lambda; }
+
+  //! Gets the intercept flag.
+  bool FitIntercept() const { return fitIntercept; }
+
+ private:
+  //! Training data matrix.
+  const MatType& data;
+  //! Labels of the training points.
+  arma::Row<size_t> labels;
+  //! The number of training points of each class.
+  arma::vec classCounts;
+  //! Initial parameter point.
+  arma::mat initialPoint;
+  //! Number of classes.
+  size_t numClasses;
+  //! Number of classes sampled for each point.
+  size_t numSampled;
+  //! L2-regularization constant.
+  double lambda;
+  //! Intercept term flag.
+  bool fitIntercept;
+
+  /**
+   * Draw the candidate classes of point i (the true class first), and return
+   * the sampled objective of the point, whose dense copy is given.  The
+   * derivative of the objective with respect to the score of each candidate
+   * is stored in coefficients.
+   */
+  double SampleObjective(const arma::mat& parameters,
+                         const size_t i,
+                         const arma::vec& point,
+                         arma::Col<size_t>& candidates,
+                         arma::vec& coefficients) const;
+
+  //! Compute the score of the given point for the given class.
+  double Score(const arma::mat& parameters,
+               const size_t label,
+               const arma::vec& point) const;
+
+  //! Add the given multiple of the point (with a 1 for the intercept, if it
+  //! is fitted) to the given row of the gradient.
+  void AddPoint(const arma::vec& point,
+                const double scale,
+                arma::mat& gradient,
+                const size_t row) const;
+};
+
+} // namespace regression
+} // namespace mlpack
+
+// Include implementation.
+#include "sampled_softmax_function_impl.hpp"
+
+#endif
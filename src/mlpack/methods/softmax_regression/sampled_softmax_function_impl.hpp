@@ -0,0 +1,215 @@
+/**
+ * @file sampled_softmax_function_impl.hpp
+ *
+ * Implementation of the sampled softmax regression objective function.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_SAMPLED_SOFTMAX_FUNCTION_IMPL_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_SAMPLED_SOFTMAX_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sampled_softmax_function.hpp"
+
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace regression {
+
+template<typename MatType>
+SampledSoftmaxFunction<MatType>::SampledSoftmaxFunction(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t numSampled,
+    const double lambda,
+    const bool fitIntercept) :
+    data(data),
+    labels(labels),
+    numClasses(numClasses),
+    numSampled(numSampled),
+    lambda(lambda),
+    fitIntercept(fitIntercept)
+{
+  if (labels.n_elem != data.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "SampledSoftmaxFunction: there are " << data.n_cols
+        << " points but " << labels.n_elem << " labels";
+    throw std::invalid_argument(oss.str());
+  }
+
+  classCounts.zeros(numClasses);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+  {
+    if (labels[i] >= numClasses)
+    {
+      std::ostringstream oss;
+      oss << "SampledSoftmaxFunction: label " << labels[i] << " of point " << i
+          << " is not below the number of classes (" << numClasses << ")";
+      throw std::invalid_argument(oss.str());
+    }
+
+    ++classCounts[labels[i]];
+  }
+
+  SoftmaxRegressionFunction<MatType>::InitializeWeights(initialPoint,
+      data.n_rows, numClasses, fitIntercept);
+}
+
+template<typename MatType>
+double SampledSoftmaxFunction<MatType>::Score(const arma::mat& parameters,
+                                              const size_t label,
+                                              const arma::vec& point) const
+{
+  if (fitIntercept)
+  {
+    return parameters(label, 0) + arma::dot(point,
+        parameters.row(label).cols(1, parameters.n_cols - 1));
+  }
+
+  return arma::dot(point, parameters.row(label));
+}
+
+template<typename MatType>
+void SampledSoftmaxFunction<MatType>::AddPoint(const arma::vec& point,
+                                               const double scale,
+                                               arma::mat& gradient,
+                                               const size_t row) const
+{
+  if (fitIntercept)
+  {
+    gradient(row, 0) += scale;
+    gradient.row(row).cols(1, gradient.n_cols - 1) += scale * point.t();
+  }
+  else
+  {
+    gradient.row(row) += scale * point.t();
+  }
+}
+
+template<typename MatType>
+double SampledSoftmaxFunction<MatType>::SampleObjective(
+    const arma::mat& parameters,
+    const size_t i,
+    const arma::vec& point,
+    arma::Col<size_t>& candidates,
+    arma::vec& coefficients) const
+{
+  // Draw the other classes uniformly; with one class there is nothing to draw.
+  const size_t label = labels[i];
+  const size_t numOthers = (numClasses > 1) ? numSampled : 0;
+  candidates.set_size(numOthers + 1);
+  candidates[0] = label;
+  for (size_t k = 1; k <= numOthers; ++k)
+  {
+    const size_t c = math::RandInt(numClasses - 1);
+    candidates[k] = (c >= label) ? c + 1 : c;
+  }
+
+  // Each other class is expected to be drawn numSampled / (C - 1) times.
+  const double logExpectedCount = (numOthers > 0) ?
+      std::log((double) numSampled / (numClasses - 1)) : 0.0;
+  coefficients.set_size(candidates.n_elem);
+  for (size_t k = 0; k < candidates.n_elem; ++k)
+  {
+    coefficients[k] = Score(parameters, candidates[k], point);
+    if (k > 0)
+      coefficients[k] -= logExpectedCount;
+  }
+
+  // Compute the softmax over the candidates, shifted by the largest score to
+  // avoid overflow.
+  const double maxScore = coefficients.max();
+  const double trueScore = coefficients[0];
+  coefficients = arma::exp(coefficients - maxScore);
+  const double normalizer = arma::accu(coefficients);
+  coefficients /= normalizer * data.n_cols;
+  coefficients[0] -= 1.0 / data.n_cols;
+
+  const double regularization = 0.5 * lambda * arma::dot(
+      parameters.row(label), parameters.row(label)) / classCounts[label];
+
+  return (maxScore + std::log(normalizer) - trueScore) / data.n_cols +
+      regularization;
+}
+
+template<typename MatType>
+double SampledSoftmaxFunction<MatType>::Evaluate(const arma::mat& parameters,
+                                                 const size_t i) const
+{
+  const arma::vec point(data.col(i));
+  arma::Col<size_t> candidates;
+  arma::vec coefficients;
+  return SampleObjective(parameters, i, point, candidates, coefficients);
+}
+
+template<typename MatType>
+void SampledSoftmaxFunction<MatType>::Gradient(const arma::mat& parameters,
+                                               const size_t i,
+                                               arma::mat& gradient) const
+{
+  EvaluateWithGradient(parameters, i, gradient);
+}
+
+template<typename MatType>
+double SampledSoftmaxFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::mat& gradient) const
+{
+  const arma::vec point(data.col(i));
+  arma::Col<size_t> candidates;
+  arma::vec coefficients;
+  const double objective = SampleObjective(parameters, i, point, candidates,
+      coefficients);
+
+  gradient.zeros(parameters.n_rows, parameters.n_cols);
+  for (size_t k = 0; k < candidates.n_elem; ++k)
+    AddPoint(point, coefficients[k], gradient, candidates[k]);
+
+  const size_t label = labels[i];
+  gradient.row(label) += lambda * parameters.row(label) / classCounts[label];
+
+  return objective;
+}
+
+template<typename MatType>
+void SampledSoftmaxFunction<MatType>::Gradient(const arma::mat& parameters,
+                                               const size_t i,
+                                               arma::sp_mat& gradient) const
+{
+  const arma::vec point(data.col(i));
+  arma::Col<size_t> candidates;
+  arma::vec coefficients;
+  SampleObjective(parameters, i, point, candidates, coefficients);
+
+  // Compute the dense gradient row of each candidate; a class that is drawn
+  // more than once gets the sum of its rows.
+  const size_t numCols = parameters.n_cols;
+  arma::umat locations(2, numCols * candidates.n_elem);
+  arma::mat values(candidates.n_elem, numCols, arma::fill::zeros);
+  for (size_t k = 0; k < candidates.n_elem; ++k)
+  {
+    AddPoint(point, coefficients[k], values, k);
+    for (size_t c = 0; c < numCols; ++c)
+    {
+      locations(0, k * numCols + c) = candidates[k];
+      locations(1, k * numCols + c) = c;
+    }
+  }
+
+  const size_t label = labels[i];
+  values.row(0) += lambda * parameters.row(label) / classCounts[label];
+
+  gradient = arma::sp_mat(true, locations, arma::vectorise(values.t()),
+      parameters.n_rows, parameters.n_cols);
+}
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
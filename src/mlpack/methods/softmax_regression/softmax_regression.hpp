@@ -32,6 +32,10 @@ namespace regression {
  *
  * http://ufldl.stanford.edu/wiki/index.php/Softmax_Regression
  *
+ * The training and test data may be dense (arma::mat) or sparse (arma::sp_mat);
+ * sparse data is never converted to a dense matrix, so high-dimensional sparse
+ * datasets can be used directly.
+ *
  * An example on how to use the interface is shown below:
  *
  * @code
@@ -47,8 +51,8 @@ namespace regression {
  * const size_t numIterations = 100; // Maximum number of iterations.
  *
  * // Use an instantiated optimizer for the training.
- * SoftmaxRegressionFunction srf(train_data, labels, inputSize, numClasses);
- * L_BFGS<SoftmaxRegressionFunction> optimizer(srf, numBasis, numIterations);
+ * SoftmaxRegressionFunction<> srf(train_data, labels, inputSize, numClasses);
+ * L_BFGS<SoftmaxRegressionFunction<>> optimizer(srf, numBasis, numIterations);
  * SoftmaxRegression<L_BFGS> regressor2(optimizer);
  *
  * arma::mat test_data; // Test data matrix.
@@ -90,8 +94,10 @@ class SoftmaxRegression
    * @param numClasses Number of classes for classification.
    * @param lambda L2-regularization constant.
    * @param fitIntercept add intercept term or not.
+   * @tparam MatType Type of the data matrix (arma::mat or arma::sp_mat).
    */
-  SoftmaxRegression(const arma::mat& data,
+  template<typename MatType>
+  SoftmaxRegression(const MatType& data,
                     const arma::Row<size_t>& labels,
                     const size_t numClasses,
                     const double lambda = 0.0001,
@@ -106,7 +112,9 @@ class SoftmaxRegression
    *
    * @param optimizer Instantiated optimizer with instantiated error function.
    */
-  SoftmaxRegression(OptimizerType<SoftmaxRegressionFunction>& optimizer);
+  template<typename MatType>
+  SoftmaxRegression(
+      OptimizerType<SoftmaxRegressionFunction<MatType>>& optimizer);
 
   /**
    * Predict the class labels for the provided feature points. The function
@@ -131,7 +139,8 @@ class SoftmaxRegression
    * @param dataset Set of points to classify.
    * @param labels Predicted labels for each point.
    */
-  void Classify(const arma::mat& dataset, arma::Row<size_t>& labels) const;
+  template<typename MatType>
+  void Classify(const MatType& dataset, arma::Row<size_t>& labels) const;
 
   /**
    * Classify the given point. The predicted class label is returned.
@@ -155,7 +164,8 @@ class SoftmaxRegression
    * @param labels Predicted labels for each point.
    * @param probabilities Class probabilities for each point.
    */
-  void Classify(const arma::mat& dataset,
+  template<typename MatType>
+  void Classify(const MatType& dataset,
                 arma::Row<size_t>& labels,
                 arma::mat& probabilites) const;
 
@@ -165,7 +175,8 @@ class SoftmaxRegression
    * @param dataset Matrix of data points to be classified.
    * @param probabilities Class probabilities for each point.
    */
-  void Classify(const arma::mat& dataset,
+  template<typename MatType>
+  void Classify(const MatType& dataset,
                 arma::mat& probabilities) const;
 
   /**
@@ -176,7 +187,8 @@ class SoftmaxRegression
    * @param testData Matrix of data points using which predictions are made.
    * @param labels Vector of labels associated with the data.
    */
-  double ComputeAccuracy(const arma::mat& testData,
+  template<typename MatType>
+  double ComputeAccuracy(const MatType& testData,
                          const arma::Row<size_t>& labels) const;
 
   /**
@@ -187,7 +199,8 @@ class SoftmaxRegression
    * @param optimizer Instantiated optimizer with instantiated error function.
    * @return Objective value of the final point.
    */
-  double Train(OptimizerType<SoftmaxRegressionFunction>& optimizer);
+  template<typename MatType>
+  double Train(OptimizerType<SoftmaxRegressionFunction<MatType>>& optimizer);
 
   /**
    * Train the softmax regression with the given training data.
@@ -196,7 +209,8 @@ class SoftmaxRegression
    * @param numClasses Number of classes for classification.
    * @return Objective value of the final point.
    */
-  double Train(const arma::mat& data,
+  template<typename MatType>
+  double Train(const MatType& data,
                const arma::Row<size_t>& labels,
                const size_t numClasses);
 
@@ -18,6 +18,16 @@
 namespace mlpack {
 namespace regression {
 
+/**
+ * The objective function of softmax regression.  The data may be dense or
+ * sparse; with sparse data (arma::sp_mat), the products with the data are
+ * sparse-dense products, so the cost of Evaluate() and Gradient() is
+ * proportional to the number of non-zero elements times the number of
+ * classes, and the data is never densified.
+ *
+ * @tparam MatType Type of data matrix.
+ */
+template<typename MatType = arma::mat>
 class SoftmaxRegressionFunction
 {
  public:
@@ -32,7 +42,7 @@ class SoftmaxRegressionFunction
    * @param lambda L2-regularization constant.
    * @param fitIntercept Intercept term flag.
    */
-  SoftmaxRegressionFunction(const arma::mat& data,
+  SoftmaxRegressionFunction(const MatType& data,
                             const arma::Row<size_t>& labels,
                             const size_t numClasses,
                             const double lambda = 0.0001,
@@ -111,6 +121,19 @@ class SoftmaxRegressionFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluates the objective function and its gradient given the current set of
+   * parameters.  The probabilities matrix, which is the costly part of both,
+   * is computed only once; this is used by L-BFGS (see
+   * HasEvaluateWithGradient).
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -133,8 +156,17 @@ class SoftmaxRegressionFunction
   bool FitIntercept() const { return fitIntercept; }
 
  private:
+  //! Compute the objective function from the probabilities matrix.
+  double ComputeObjective(const arma::mat& parameters,
+                          const arma::mat& probabilities) const;
+
+  //! Compute the gradient from the probabilities matrix.
+  void ComputeGradient(const arma::mat& parameters,
+                       const arma::mat& probabilities,
+                       arma::mat& gradient) const;
+
   //! Training data matrix.
-  const arma::mat& data;
+  const MatType& data;
   //! Label matrix for the provided data.
   arma::sp_mat groundTruth;
   //! Initial parameter point.
@@ -150,4 +182,7 @@ class SoftmaxRegressionFunction
 } // namespace regression
 } // namespace mlpack
 
+// Include implementation.
+#include "softmax_regression_function_impl.hpp"
+
 #endif
@@ -1,5 +1,5 @@
 /**
- * @file softmax_regression_function.cpp
+ * @file softmax_regression_function_impl.hpp
  * @author Siddharth Agrawal
  *
  * Implementation of function to be optimized for softmax regression.
@@ -9,13 +9,18 @@
  * 3-clause BSD license along with mlpack.  If not, see
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_SOFTMAX_REGRESSION_FUNCTION_IMPL_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_SOFTMAX_REGRESSION_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
 #include "softmax_regression_function.hpp"
 
-using namespace mlpack;
-using namespace mlpack::regression;
+namespace mlpack {
+namespace regression {
 
-SoftmaxRegressionFunction::SoftmaxRegressionFunction(
-    const arma::mat& data,
+template<typename MatType>
+SoftmaxRegressionFunction<MatType>::SoftmaxRegressionFunction(
+    const MatType& data,
     const arma::Row<size_t>& labels,
     const size_t numClasses,
     const double lambda,
@@ -37,12 +42,14 @@ SoftmaxRegressionFunction::SoftmaxRegressionFunction(
  * normal distribution. The weights cannot be initialized to zero, as that will
  * lead to each class output being the same.
  */
-const arma::mat SoftmaxRegressionFunction::InitializeWeights()
+template<typename MatType>
+const arma::mat SoftmaxRegressionFunction<MatType>::InitializeWeights()
 {
   return InitializeWeights(data.n_rows, numClasses, fitIntercept);
 }
 
-const arma::mat SoftmaxRegressionFunction::InitializeWeights(
+template<typename MatType>
+const arma::mat SoftmaxRegressionFunction<MatType>::InitializeWeights(
     const size_t featureSize,
     const size_t numClasses,
     const bool fitIntercept)
@@ -52,7 +59,8 @@ const arma::mat SoftmaxRegressionFunction::InitializeWeights(
     return parameters;
 }
 
-void SoftmaxRegressionFunction::InitializeWeights(
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::InitializeWeights(
     arma::mat &weights,
     const size_t featureSize,
     const size_t numClasses,
@@ -73,7 +81,8 @@ void SoftmaxRegressionFunction::InitializeWeights(
  * labels. The output is in the form of a matrix, which leads to simpler
  * calculations in the Evaluate() and Gradient() methods.
  */
-void SoftmaxRegressionFunction::GetGroundTruthMatrix(
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::GetGroundTruthMatrix(
     const arma::Row<size_t>& labels, arma::sp_mat& groundTruth)
 {
   // Calculate the ground truth matrix according to the labels passed. The
@@ -106,7 +115,8 @@ void SoftmaxRegressionFunction::GetGroundTruthMatrix(
  * Evaluate the probabilities matrix. If fitIntercept flag is true,
  * it should consider the parameters.cols(0) intercept term.
  */
-void SoftmaxRegressionFunction::GetProbabilitiesMatrix(
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::GetProbabilitiesMatrix(
     const arma::mat& parameters,
     arma::mat& probabilities) const
 {
@@ -135,7 +145,9 @@ void SoftmaxRegressionFunction::GetProbabilitiesMatrix(
 /**
  * Evaluates the objective function given the parameters.
  */
-double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
+template<typename MatType>
+double SoftmaxRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters) const
 {
   // The objective function is the negative log likelihood of the model
   // calculated over all the training examples. Mathematically it is as follows:
@@ -156,6 +168,53 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
   arma::mat probabilities;
   GetProbabilitiesMatrix(parameters, probabilities);
 
+  return ComputeObjective(parameters, probabilities);
+}
+
+/**
+ * Calculates and stores the gradient values given a set of parameters.
+ */
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  // Calculate the class probabilities for each training example. The
+  // probabilities for each of the classes are given by:
+  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
+  // The sum is calculated over all the classes.
+  // x_i is the input vector for a particular training example.
+  // theta_j is the parameter vector associated with a particular class.
+  arma::mat probabilities;
+  GetProbabilitiesMatrix(parameters, probabilities);
+
+  ComputeGradient(parameters, probabilities, gradient);
+}
+
+/**
+ * Evaluates the objective function and stores the gradient, computing the
+ * probabilities matrix only once.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  arma::mat probabilities;
+  GetProbabilitiesMatrix(parameters, probabilities);
+
+  ComputeGradient(parameters, probabilities, gradient);
+  return ComputeObjective(parameters, probabilities);
+}
+
+/**
+ * Computes the objective function from the probabilities matrix.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunction<MatType>::ComputeObjective(
+    const arma::mat& parameters,
+    const arma::mat& probabilities) const
+{
   // Calculate the log likelihood and regularization terms.
   double logLikelihood, weightDecay, cost;
 
@@ -171,20 +230,14 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
 }
 
 /**
- * Calculates and stores the gradient values given a set of parameters.
+ * Computes the gradient from the probabilities matrix.
  */
-void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
-                                         arma::mat& gradient) const
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::ComputeGradient(
+    const arma::mat& parameters,
+    const arma::mat& probabilities,
+    arma::mat& gradient) const
 {
-  // Calculate the class probabilities for each training example. The
-  // probabilities for each of the classes are given by:
-  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
-  // The sum is calculated over all the classes.
-  // x_i is the input vector for a particular training example.
-  // theta_j is the parameter vector associated with a particular class.
-  arma::mat probabilities;
-  GetProbabilitiesMatrix(parameters, probabilities);
-
   // Calculate the parameter gradients.
   gradient.set_size(parameters.n_rows, parameters.n_cols);
   if (fitIntercept)
@@ -205,3 +258,8 @@ void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
                lambda * parameters;
   }
 }
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
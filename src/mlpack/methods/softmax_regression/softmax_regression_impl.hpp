@@ -27,13 +27,14 @@ SoftmaxRegression(const size_t inputSize,
     lambda(0.0001),
     fitIntercept(fitIntercept)
 {
-  SoftmaxRegressionFunction::InitializeWeights(
+  SoftmaxRegressionFunction<>::InitializeWeights(
       parameters, inputSize, numClasses, fitIntercept);
 }
 
 template<template<typename> class OptimizerType>
+template<typename MatType>
 SoftmaxRegression<OptimizerType>::SoftmaxRegression(
-    const arma::mat& data,
+    const MatType& data,
     const arma::Row<size_t>& labels,
     const size_t numClasses,
     const double lambda,
@@ -42,17 +43,18 @@ SoftmaxRegression<OptimizerType>::SoftmaxRegression(
     lambda(lambda),
     fitIntercept(fitIntercept)
 {
-  SoftmaxRegressionFunction regressor(data, labels, numClasses,
-                                      lambda, fitIntercept);
-  OptimizerType<SoftmaxRegressionFunction> optimizer(regressor);
+  SoftmaxRegressionFunction<MatType> regressor(data, labels, numClasses,
+                                               lambda, fitIntercept);
+  OptimizerType<SoftmaxRegressionFunction<MatType>> optimizer(regressor);
 
   parameters = regressor.GetInitialPoint();
   Train(optimizer);
 }
 
 template<template<typename> class OptimizerType>
+template<typename MatType>
 SoftmaxRegression<OptimizerType>::SoftmaxRegression(
-    OptimizerType<SoftmaxRegressionFunction>& optimizer) :
+    OptimizerType<SoftmaxRegressionFunction<MatType>>& optimizer) :
     parameters(optimizer.Function().GetInitialPoint()),
     numClasses(optimizer.Function().NumClasses()),
     lambda(optimizer.Function().Lambda()),
@@ -70,7 +72,8 @@ void SoftmaxRegression<OptimizerType>::Predict(const arma::mat& testData,
 }
 
 template<template<typename> class OptimizerType>
-void SoftmaxRegression<OptimizerType>::Classify(const arma::mat& dataset,
+template<typename MatType>
+void SoftmaxRegression<OptimizerType>::Classify(const MatType& dataset,
                                                 arma::Row<size_t>& labels)
     const
 {
@@ -110,7 +113,8 @@ size_t SoftmaxRegression<OptimizerType>::Classify(const VecType& point) const
 }
 
 template<template<typename> class OptimizerType>
-void SoftmaxRegression<OptimizerType>::Classify(const arma::mat& dataset,
+template<typename MatType>
+void SoftmaxRegression<OptimizerType>::Classify(const MatType& dataset,
                                                 arma::Row<size_t>& labels,
                                                 arma::mat& probabilities)
     const
@@ -141,7 +145,8 @@ void SoftmaxRegression<OptimizerType>::Classify(const arma::mat& dataset,
 }
 
 template<template<typename> class OptimizerType>
-void SoftmaxRegression<OptimizerType>::Classify(const arma::mat& dataset,
+template<typename MatType>
+void SoftmaxRegression<OptimizerType>::Classify(const MatType& dataset,
                                                 arma::mat& probabilities)
     const
 {
@@ -177,8 +182,9 @@ void SoftmaxRegression<OptimizerType>::Classify(const arma::mat& dataset,
 }
 
 template<template<typename> class OptimizerType>
+template<typename MatType>
 double SoftmaxRegression<OptimizerType>::ComputeAccuracy(
-    const arma::mat& testData,
+    const MatType& testData,
     const arma::Row<size_t>& labels) const
 {
   arma::Row<size_t> predictions;
@@ -197,8 +203,9 @@ double SoftmaxRegression<OptimizerType>::ComputeAccuracy(
 }
 
 template<template<typename> class OptimizerType>
+template<typename MatType>
 double SoftmaxRegression<OptimizerType>::Train(
-    OptimizerType<SoftmaxRegressionFunction>& optimizer)
+    OptimizerType<SoftmaxRegressionFunction<MatType>>& optimizer)
 {
   // Train the model.
   Timer::Start("softmax_regression_optimization");
@@ -212,13 +219,14 @@ double SoftmaxRegression<OptimizerType>::Train(
 }
 
 template<template<typename> class OptimizerType>
-double SoftmaxRegression<OptimizerType>::Train(const arma::mat& data,
+template<typename MatType>
+double SoftmaxRegression<OptimizerType>::Train(const MatType& data,
                                                const arma::Row<size_t>& labels,
                                                const size_t numClasses)
 {
-  SoftmaxRegressionFunction regressor(data, labels, numClasses,
-                                      lambda, fitIntercept);
-  OptimizerType<SoftmaxRegressionFunction> optimizer(regressor);
+  SoftmaxRegressionFunction<MatType> regressor(data, labels, numClasses,
+                                               lambda, fitIntercept);
+  OptimizerType<SoftmaxRegressionFunction<MatType>> optimizer(regressor);
 
   return Train(optimizer);
 }
@@ -57,7 +57,18 @@ namespace nn {
  * @endcode
  *
  * This implementation allows the use of arbitrary mlpack optimizers via the
- * OptimizerType template parameter.
+ * OptimizerType template parameter.  SparseAutoencoderFunction is decomposable
+ * over the points, so stochastic optimizers can be used on large datasets:
+ *
+ * @code
+ * SparseAutoencoderFunction saf(data, vSize, hSize);
+ * MiniBatchSGD<SparseAutoencoderFunction> sgd(saf, 100, 50.0);
+ * SparseAutoencoder<MiniBatchSGD> encoder3(sgd);
+ * @endcode
+ *
+ * The objective of a mini-batch is weighted by the fraction of the dataset
+ * that it is, so the step size of these optimizers should grow with the number
+ * of points (see SparseAutoencoderFunction).
  *
  * @tparam OptimizerType The optimizer to use; by default this is L-BFGS.  Any
  *     mlpack optimizer can be used here.
@@ -120,6 +131,9 @@ class SparseAutoencoder
     output = (1.0 / (1 + arma::exp(-x)));
   }
 
+  //! Get the trained parameters.
+  const arma::mat& Parameters() const { return parameters; }
+
   //! Sets size of the visible layer.
   void VisibleSize(const size_t visible)
   {
@@ -26,7 +26,9 @@ SparseAutoencoderFunction::SparseAutoencoderFunction(const arma::mat& data,
     hiddenSize(hiddenSize),
     lambda(lambda),
     beta(beta),
-    rho(rho)
+    rho(rho),
+    cachedBegin(0),
+    cachedBatchSize(0)
 {
   // Initialize the parameters to suitable values.
   initialPoint = InitializeWeights();
@@ -71,17 +73,15 @@ const arma::mat SparseAutoencoderFunction::InitializeWeights()
   return parameters;
 }
 
-/** Evaluates the objective function given the parameters.
-  */
-double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
+void SparseAutoencoderFunction::ForwardPass(const arma::mat& parameters,
+                                            const size_t begin,
+                                            const size_t batchSize) const
 {
-  // The objective function is the average squared reconstruction error of the
-  // network. w1 and b1 are the weights and biases associated with the hidden
-  // layer, whereas w2 and b2 are associated with the output layer.
-  // f(w1,w2,b1,b2) = sum((data - sigmoid(w2*sigmoid(w1data + b1) + b2))^2) / 2m
-  // 'm' is the number of training examples.
-  // The cost also takes into account the regularization and KL divergence terms
-  // to control the parameter weights and sparsity of the model respectively.
+  if (batchSize == cachedBatchSize && begin == cachedBegin &&
+      arma::size(parameters) == arma::size(cachedParameters) &&
+      std::equal(parameters.begin(), parameters.end(),
+                 cachedParameters.begin()))
+    return;
 
   // Compute the limits for the parameters w1, w2, b1 and b2.
   const size_t l1 = hiddenSize;
@@ -96,92 +96,74 @@ double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
   // b1 <- parameters.submat(0, l2, l1-1, l2)
   // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
 
-  arma::mat hiddenLayer, outputLayer;
-
-  // Compute activations of the hidden and output layers.
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      hiddenLayer);
+  // The points of the batch are used without copying them.
+  const arma::mat batch(const_cast<double*>(data.colptr(begin)), data.n_rows,
+      batchSize, false, true);
 
-  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
-      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
-      outputLayer);
+  // Compute activations of the hidden and output layers.  The buffers keep
+  // their memory when the batch size does not change.
+  hiddenLayer = parameters.submat(0, 0, l1 - 1, l2 - 1) * batch;
+  hiddenLayer.each_col() += parameters.submat(0, l2, l1 - 1, l2);
+  Sigmoid(hiddenLayer, hiddenLayer);
 
-  arma::mat rhoCap, diff;
+  outputLayer = parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer;
+  outputLayer.each_col() += parameters.submat(l3, 0, l3, l2 - 1).t();
+  Sigmoid(outputLayer, outputLayer);
 
   // Average activations of the hidden layer.
-  rhoCap = arma::sum(hiddenLayer, 1) / data.n_cols;
+  rhoCap = arma::sum(hiddenLayer, 1) / batchSize;
   // Difference between the reconstructed data and the original data.
-  diff = outputLayer - data;
+  diff = outputLayer - batch;
 
-  double wL2SquaredNorm;
+  cachedParameters = parameters;
+  cachedBegin = begin;
+  cachedBatchSize = batchSize;
+}
 
-  // Calculate squared L2-norms of w1 and w2.
-  wL2SquaredNorm = arma::accu(parameters.submat(0, 0, l3 - 1, l2 - 1) %
-      parameters.submat(0, 0, l3 - 1, l2 - 1));
+double SparseAutoencoderFunction::ComputeObjective(
+    const arma::mat& parameters) const
+{
+  const size_t l2 = visibleSize;
+  const size_t l3 = 2 * hiddenSize;
 
-  double sumOfSquaresError, weightDecay, klDivergence, cost;
+  // Calculate squared L2-norms of w1 and w2.
+  const double wL2SquaredNorm = arma::accu(arma::square(
+      parameters.submat(0, 0, l3 - 1, l2 - 1)));
 
   // Calculate the reconstruction error, the regularization cost and the KL
-  // divergence cost terms. 'sumOfSquaresError' is the average squared l2-norm
-  // of the reconstructed data difference. 'weightDecay' is the squared l2-norm
-  // of the weights w1 and w2. 'klDivergence' is the cost of the hidden layer
-  // activations not being low. It is given by the following formula:
+  // divergence cost terms. 'sumOfSquaresError' is the squared l2-norm of the
+  // reconstructed data difference, averaged over the whole dataset.
+  // 'weightDecay' is the squared l2-norm of the weights w1 and w2.
+  // 'klDivergence' is the cost of the hidden layer activations not being low.
+  // It is given by the following formula:
   // KL = sum_over_hSize(rho*log(rho/rhoCaq) + (1-rho)*log((1-rho)/(1-rhoCap)))
-  sumOfSquaresError = 0.5 * arma::accu(diff % diff) / data.n_cols;
-  weightDecay = 0.5 * lambda * wL2SquaredNorm;
-  klDivergence = beta * arma::accu(rho * arma::log(rho / rhoCap) + (1 - rho) *
-      arma::log((1 - rho) / (1 - rhoCap)));
+  // The last two terms are weighted by the fraction of the dataset that the
+  // batch is, so that they sum to their full value over a partition.
+  const double sumOfSquaresError = 0.5 * arma::accu(arma::square(diff)) /
+      data.n_cols;
+  const double weightDecay = 0.5 * lambda * wL2SquaredNorm;
+  const double klDivergence = beta * arma::accu(rho * arma::log(rho / rhoCap) +
+      (1 - rho) * arma::log((1 - rho) / (1 - rhoCap)));
+  const double fraction = (double) cachedBatchSize / data.n_cols;
 
   // The cost is the sum of the terms calculated above.
-  cost = sumOfSquaresError + weightDecay + klDivergence;
-
-  return cost;
+  return sumOfSquaresError + fraction * (weightDecay + klDivergence);
 }
 
-/** Calculates and stores the gradient values given a set of parameters.
-  */
-void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
-                                         arma::mat& gradient) const
+void SparseAutoencoderFunction::ComputeGradient(const arma::mat& parameters,
+                                                arma::mat& gradient) const
 {
-  // Performs a feedforward pass of the neural network, and computes the
-  // activations of the output layer as in the Evaluate() method. It uses the
-  // Backpropagation algorithm to calculate the delta values at each layer,
-  // except for the input layer. The delta values are then used with input layer
-  // and hidden layer activations to get the parameter gradients.
+  // Uses the Backpropagation algorithm to calculate the delta values at each
+  // layer, except for the input layer. The delta values are then used with
+  // input layer and hidden layer activations to get the parameter gradients.
 
   // Compute the limits for the parameters w1, w2, b1 and b2.
   const size_t l1 = hiddenSize;
   const size_t l2 = visibleSize;
   const size_t l3 = 2 * hiddenSize;
 
-  // w1, w2, b1 and b2 are not extracted separately, 'parameters' is directly
-  // used in their place to avoid copying data. The following representations
-  // are used:
-  // w1 <- parameters.submat(0, 0, l1-1, l2-1)
-  // w2 <- parameters.submat(l1, 0, l3-1, l2-1).t()
-  // b1 <- parameters.submat(0, l2, l1-1, l2)
-  // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
-
-  arma::mat hiddenLayer, outputLayer;
-
-  // Compute activations of the hidden and output layers.
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      hiddenLayer);
-
-  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
-      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
-      outputLayer);
-
-  arma::mat rhoCap, diff;
-
-  // Average activations of the hidden layer.
-  rhoCap = arma::sum(hiddenLayer, 1) / data.n_cols;
-  // Difference between the reconstructed data and the original data.
-  diff = outputLayer - data;
-
-  arma::mat klDivGrad, delOut, delHid;
+  const arma::mat batch(const_cast<double*>(data.colptr(cachedBegin)),
+      data.n_rows, cachedBatchSize, false, true);
 
   // The delta vector for the output layer is given by diff * f'(z), where z is
   // the preactivation and f is the activation function. The derivative of the
@@ -189,22 +171,87 @@ void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
   // in the neural network which comes before the output layer, the delta values
   // are given del_n = w_n' * del_(n+1) * f'(z_n). Since our cost function also
   // includes the KL divergence term, we adjust for that in the formula below.
-  klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) / (1 - rhoCap));
+  const arma::vec klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) /
+      (1 - rhoCap));
   delOut = diff % outputLayer % (1 - outputLayer);
-  delHid = (parameters.submat(l1, 0, l3 - 1, l2 - 1) * delOut +
-      arma::repmat(klDivGrad, 1, data.n_cols)) % hiddenLayer %
-      (1 - hiddenLayer);
+  delHid = parameters.submat(l1, 0, l3 - 1, l2 - 1) * delOut;
+  delHid.each_col() += klDivGrad;
+  delHid %= hiddenLayer % (1 - hiddenLayer);
 
   gradient.zeros(2 * hiddenSize + 1, visibleSize + 1);
 
   // Compute the gradient values using the activations and the delta values. The
-  // formula also accounts for the regularization terms in the objective.
-  // function.
-  gradient.submat(0, 0, l1 - 1, l2 - 1) = delHid * data.t() / data.n_cols +
-      lambda * parameters.submat(0, 0, l1 - 1, l2 - 1);
+  // formula also accounts for the regularization terms in the objective
+  // function, which are weighted by the fraction of the dataset in the batch.
+  const double fraction = (double) cachedBatchSize / data.n_cols;
+  gradient.submat(0, 0, l1 - 1, l2 - 1) = delHid * batch.t() / data.n_cols +
+      fraction * lambda * parameters.submat(0, 0, l1 - 1, l2 - 1);
   gradient.submat(l1, 0, l3 - 1, l2 - 1) =
       (delOut * hiddenLayer.t() / data.n_cols +
-      lambda * parameters.submat(l1, 0, l3 - 1, l2 - 1).t()).t();
+      fraction * lambda * parameters.submat(l1, 0, l3 - 1, l2 - 1).t()).t();
   gradient.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1) / data.n_cols;
   gradient.submat(l3, 0, l3, l2 - 1) = (arma::sum(delOut, 1) / data.n_cols).t();
 }
+
+/** Evaluates the objective function given the parameters.
+  */
+double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
+{
+  // The objective function is the average squared reconstruction error of the
+  // network. w1 and b1 are the weights and biases associated with the hidden
+  // layer, whereas w2 and b2 are associated with the output layer.
+  // f(w1,w2,b1,b2) = sum((data - sigmoid(w2*sigmoid(w1data + b1) + b2))^2) / 2m
+  // 'm' is the number of training examples.
+  // The cost also takes into account the regularization and KL divergence terms
+  // to control the parameter weights and sparsity of the model respectively.
+  ForwardPass(parameters, 0, data.n_cols);
+  return ComputeObjective(parameters);
+}
+
+/** Calculates and stores the gradient values given a set of parameters.
+  */
+void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
+                                         arma::mat& gradient) const
+{
+  // Performs a feedforward pass of the neural network (unless Evaluate() was
+  // just called with the same parameters), and backpropagates the error.
+  ForwardPass(parameters, 0, data.n_cols);
+  ComputeGradient(parameters, gradient);
+}
+
+double SparseAutoencoderFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  ForwardPass(parameters, 0, data.n_cols);
+  ComputeGradient(parameters, gradient);
+  return ComputeObjective(parameters);
+}
+
+double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters,
+                                           const size_t begin,
+                                           const size_t batchSize) const
+{
+  ForwardPass(parameters, begin, batchSize);
+  return ComputeObjective(parameters);
+}
+
+void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
+                                         const size_t begin,
+                                         arma::mat& gradient,
+                                         const size_t batchSize) const
+{
+  ForwardPass(parameters, begin, batchSize);
+  ComputeGradient(parameters, gradient);
+}
+
+double SparseAutoencoderFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  ForwardPass(parameters, begin, batchSize);
+  ComputeGradient(parameters, gradient);
+  return ComputeObjective(parameters);
+}
@@ -22,6 +22,21 @@ namespace nn {
  * This is a class for the sparse autoencoder objective function. It can be used
  * to create learning models like self-taught learning, stacked autoencoders,
  * conditional random fields (CRFs), and so forth.
+ *
+ * The activations of the network are kept between calls, so Evaluate() and
+ * Gradient() at the same parameters (as during the line search of L-BFGS) only
+ * perform one feedforward pass; EvaluateWithGradient() computes both at once.
+ * Because of these buffers, an object must not be evaluated by several threads
+ * at the same time.
+ *
+ * The function is also decomposable over the points of the dataset, so that it
+ * can be optimized with SGD, Adam, or mini-batch SGD.  The objective of a batch
+ * of b of the n points is b / n times the objective of the batch on its own,
+ * where the sparsity of the hidden layer is estimated on the batch.  So the
+ * objectives of the batches of a partition of the dataset sum to the objective
+ * on the whole dataset, except that the KL divergence term is the average of
+ * the terms of the batches.  Since the sparsity estimate of a single point is
+ * poor, mini-batches should be preferred when beta is not zero.
  */
 class SparseAutoencoderFunction
 {
@@ -70,6 +85,88 @@ class SparseAutoencoderFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluates the objective function and its gradient given the current set of
+   * parameters, with one feedforward pass; this is used by L-BFGS (see
+   * HasEvaluateWithGradient).
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluates the objective function on the points [begin, begin + batchSize)
+   * of the dataset (see the class documentation).
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
+  /**
+   * Evaluates the gradient of the objective function on the points
+   * [begin, begin + batchSize) of the dataset.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points in the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize) const;
+
+  /**
+   * Evaluates the objective function and its gradient on the points
+   * [begin, begin + batchSize) of the dataset, with one feedforward pass.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points in the batch.
+   * @return The objective function of the batch.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize) const;
+
+  /**
+   * Evaluates the objective function on the i'th point of the dataset.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   */
+  double Evaluate(const arma::mat& parameters, const size_t i) const
+  {
+    return Evaluate(parameters, i, 1);
+  }
+
+  /**
+   * Evaluates the gradient of the objective function on the i'th point of the
+   * dataset.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient) const
+  {
+    Gradient(parameters, i, gradient, 1);
+  }
+
+  //! Return the number of separable functions (the number of points).
+  size_t NumFunctions() const { return data.n_cols; }
+
   /**
    * Returns the elementwise sigmoid of the passed matrix, where the sigmoid
    * function of a real number 'x' is [1 / (1 + exp(-x))].
@@ -88,6 +185,7 @@ class SparseAutoencoderFunction
   void VisibleSize(const size_t visible)
   {
     this->visibleSize = visible;
+    cachedBatchSize = 0;
   }
 
   //! Gets size of the visible layer.
@@ -100,6 +198,7 @@ class SparseAutoencoderFunction
   void HiddenSize(const size_t hidden)
   {
     this->hiddenSize = hidden;
+    cachedBatchSize = 0;
   }
 
   //! Gets the size of the hidden layer.
@@ -145,6 +244,21 @@ class SparseAutoencoderFunction
   }
 
  private:
+  /**
+   * Compute the activations of the hidden and output layers on the points
+   * [begin, begin + batchSize), unless they were already computed for the same
+   * parameters and points.
+   */
+  void ForwardPass(const arma::mat& parameters,
+                   const size_t begin,
+                   const size_t batchSize) const;
+
+  //! Compute the objective of the batch of the last feedforward pass.
+  double ComputeObjective(const arma::mat& parameters) const;
+
+  //! Compute the gradient of the batch of the last feedforward pass.
+  void ComputeGradient(const arma::mat& parameters, arma::mat& gradient) const;
+
   //! The matrix of data points.
   const arma::mat& data;
   //! Initial parameter vector.
@@ -159,6 +273,25 @@ class SparseAutoencoderFunction
   double beta;
   //! Sparsity parameter.
   double rho;
+
+  //! The parameters of the last feedforward pass.
+  mutable arma::mat cachedParameters;
+  //! The first point of the batch of the last feedforward pass.
+  mutable size_t cachedBegin;
+  //! The size of the batch of the last feedforward pass (0 if there was none).
+  mutable size_t cachedBatchSize;
+  //! Activations of the hidden layer.
+  mutable arma::mat hiddenLayer;
+  //! Activations of the output layer.
+  mutable arma::mat outputLayer;
+  //! Average activations of the hidden layer.
+  mutable arma::vec rhoCap;
+  //! Difference between the reconstructed data and the original data.
+  mutable arma::mat diff;
+  //! Delta values of the output layer.
+  mutable arma::mat delOut;
+  //! Delta values of the hidden layer.
+  mutable arma::mat delHid;
 };
 
 } // namespace nn
@@ -71,9 +71,9 @@ void SparseAutoencoder<OptimizerType>::GetNewFeatures(arma::mat& data,
   const size_t l1 = hiddenSize;
   const size_t l2 = visibleSize;
 
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      features);
+  features = parameters.submat(0, 0, l1 - 1, l2 - 1) * data;
+  features.each_col() += parameters.submat(0, l2, l1 - 1, l2);
+  Sigmoid(features, features);
 }
 
 } // namespace nn
@@ -37,16 +37,26 @@ SparseCoding::SparseCoding(
 void SparseCoding::Encode(const arma::mat& data, arma::mat& codes)
 {
   // When using the Cholesky version of LARS, this is correct even if
-  // lambda2 > 0.
-  arma::mat matGram = trans(dictionary) * dictionary;
+  // lambda2 > 0.  The Gram matrix is computed once and shared by all threads;
+  // LARS only reads it.
+  const arma::mat matGram = trans(dictionary) * dictionary;
 
+  Log::Debug << "Encoding " << data.n_cols << " points." << std::endl;
+
+  // Every point is an independent LARS problem, so the points are encoded in
+  // parallel, each with its own LARS object.
   codes.set_size(atoms, data.n_cols);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(dynamic, 16)
   for (size_t i = 0; i < data.n_cols; ++i)
+#endif
   {
-    // Report progress.
-    if ((i % 100) == 0)
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-
     bool useCholesky = true;
     regression::LARS lars(useCholesky, matGram, lambda1, lambda2);
 
@@ -96,6 +96,7 @@ using enable_if_t = typename enable_if<B, T>::type;
 // All code should have access to logging.
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/timers.hpp>
+#include <mlpack/core/util/memory_tracker.hpp>
 
 // On Visual Studio, disable C4519 (default arguments for function templates)
 // since it's by default an error, which doesn't even make any sense because
@@ -108,4 +109,7 @@ using enable_if_t = typename enable_if<B, T>::type;
 // We need to be able to mark functions deprecated.
 #include <mlpack/core/util/deprecated.hpp>
 
+// We need to be able to mark loops as safe to vectorize.
+#include <mlpack/core/util/simd.hpp>
+
 #endif
@@ -104,4 +104,55 @@ BOOST_AUTO_TEST_CASE(AdaGradLogisticRegressionTest)
   const double testAcc = lr.ComputeAccuracy(testData, testResponses);
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
 }
+/**
+ * Make sure the sparse AdaGrad update gives the same result as the dense one.
+ */
+BOOST_AUTO_TEST_CASE(AdaGradSparseUpdateTest)
+{
+  AdaGradUpdate update;
+  AdaGradUpdate::Policy<arma::mat> densePolicy(update, 10, 4);
+  AdaGradUpdate::Policy<arma::mat> sparsePolicy(update, 10, 4);
+
+  arma::mat denseIterate = arma::randu<arma::mat>(10, 4);
+  arma::mat sparseIterate = denseIterate;
+  for (size_t i = 0; i < 20; ++i)
+  {
+    arma::sp_mat gradient;
+    gradient.sprandn(10, 4, 0.2);
+
+    densePolicy.Update(denseIterate, 0.1, arma::mat(gradient));
+    sparsePolicy.Update(sparseIterate, 0.1, gradient);
+  }
+
+  CheckMatrices(denseIterate, sparseIterate);
+}
+
+/**
+ * Train logistic regression with AdaGrad on sparse data, which uses sparse
+ * gradients, and make sure the result is the same as with dense data.
+ */
+BOOST_AUTO_TEST_CASE(AdaGradSparseLogisticRegressionTest)
+{
+  arma::sp_mat dataset;
+  dataset.sprandu(10, 800, 0.3);
+  arma::mat denseDataset(dataset);
+  arma::Row<size_t> labels(800);
+  for (size_t i = 0; i < 800; ++i)
+    labels[i] = math::RandInt(0, 2);
+
+  LogisticRegression<> lr(10, 0.0);
+  LogisticRegressionFunction<> lrf(denseDataset, labels, 0.0);
+  AdaGrad<LogisticRegressionFunction<>> adagrad(lrf, 0.01, 1e-8, 10000, 1e-9,
+      false);
+  lr.Train(adagrad);
+
+  LogisticRegression<arma::sp_mat> lrSparse(10, 0.0);
+  LogisticRegressionFunction<arma::sp_mat> lrfSparse(dataset, labels, 0.0);
+  AdaGrad<LogisticRegressionFunction<arma::sp_mat>> adagradSparse(lrfSparse,
+      0.01, 1e-8, 10000, 1e-9, false);
+  lrSparse.Train(adagradSparse);
+
+  CheckMatrices(lr.Parameters(), lrSparse.Parameters());
+}
+
 BOOST_AUTO_TEST_SUITE_END();
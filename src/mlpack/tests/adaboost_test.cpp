@@ -882,4 +882,42 @@ BOOST_AUTO_TEST_CASE(DecisionStumpSerializationTest)
   }
 }
 
+/**
+ * Classify() works on blocks of points; make sure that it gives the same
+ * predictions as combining the predictions of each weak learner on the whole
+ * dataset.
+ */
+BOOST_AUTO_TEST_CASE(BlockedClassifyTest)
+{
+  // With 4 dimensions, the points are classified in blocks of 8192 points.
+  mat data = randu<mat>(4, 20000);
+  Row<size_t> labels(20000);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    labels[i] = (data(0, i) + data(1, i) > 1.0) ? 1 :
+        ((data(2, i) > 0.7) ? 2 : 0);
+
+  DecisionStump<> ds(data, labels, 3, 10);
+  AdaBoost<DecisionStump<>> a(data, labels, ds, 20, 1e-10);
+  BOOST_REQUIRE_GT(a.WeakLearners(), 1);
+
+  mat scores = zeros<mat>(3, data.n_cols);
+  for (size_t i = 0; i < a.WeakLearners(); ++i)
+  {
+    Row<size_t> weakPredictions;
+    a.WeakLearner(i).Classify(data, weakPredictions);
+    for (size_t j = 0; j < data.n_cols; ++j)
+      scores(weakPredictions[j], j) += a.Alpha(i);
+  }
+
+  Row<size_t> predictions;
+  a.Classify(data, predictions);
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, data.n_cols);
+  for (size_t j = 0; j < data.n_cols; ++j)
+  {
+    arma::uword maxIndex;
+    scores.unsafe_col(j).max(maxIndex);
+    BOOST_REQUIRE_EQUAL(predictions[j], maxIndex);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
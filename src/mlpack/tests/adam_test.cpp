@@ -188,4 +188,63 @@ BOOST_AUTO_TEST_CASE(AdaMaxLogisticRegressionTest)
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
 }
 
+/**
+ * Run Adam on logistic regression with sparse data, which uses the lazy sparse
+ * update, and make sure the results are acceptable.
+ */
+BOOST_AUTO_TEST_CASE(AdamSparseLogisticRegressionTest)
+{
+  // The labels are given by a hyperplane, so the problem is separable.
+  arma::sp_mat data;
+  data.sprandu(10, 1000, 0.3);
+  arma::Row<size_t> responses(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    responses[i] = (arma::accu(data.col(i)) > 1.5) ? 1 : 0;
+
+  LogisticRegression<arma::sp_mat> lr(data.n_rows, 0.0);
+  LogisticRegressionFunction<arma::sp_mat> lrf(data, responses, 0.0);
+  Adam<LogisticRegressionFunction<arma::sp_mat>> adam(lrf, 0.01);
+  lr.Train(adam);
+
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_GE(acc, 95.0);
+}
+
+/**
+ * Make sure the single-pass Adam and AdaMax steps match the reference
+ * expressions on a vector large enough to be updated in parallel chunks.
+ */
+BOOST_AUTO_TEST_CASE(AdamLargeIterateUpdateTest)
+{
+  const size_t n = 200003;
+  arma::mat iterate(n, 1, arma::fill::randn);
+  arma::mat maxIterate(iterate);
+  arma::mat m(n, 1, arma::fill::zeros), v(n, 1, arma::fill::zeros);
+  arma::mat u(n, 1, arma::fill::zeros);
+  arma::mat expected(iterate), maxExpected(iterate);
+
+  AdamUpdate adamUpdate(1e-8, 0.9, 0.999);
+  AdamUpdate::Policy<arma::mat> adam(adamUpdate, n, 1);
+  AdaMaxUpdate adaMaxUpdate(1e-8, 0.9, 0.999);
+  AdaMaxUpdate::Policy<arma::mat> adaMax(adaMaxUpdate, n, 1);
+  for (size_t t = 1; t <= 3; ++t)
+  {
+    const arma::mat gradient(n, 1, arma::fill::randn);
+    adam.Update(iterate, 0.01, gradient);
+    adaMax.Update(maxIterate, 0.01, gradient);
+
+    m = 0.9 * m + 0.1 * gradient;
+    v = 0.999 * v + 0.001 * (gradient % gradient);
+    u = arma::max(0.999 * u, arma::abs(gradient));
+    const double biasCorrection1 = 1.0 - std::pow(0.9, t);
+    const double biasCorrection2 = 1.0 - std::pow(0.999, t);
+    expected -= (0.01 * std::sqrt(biasCorrection2) / biasCorrection1) * m /
+        (arma::sqrt(v) + 1e-8);
+    maxExpected -= (0.01 / biasCorrection1) * m / (u + 1e-8);
+  }
+
+  CheckMatrices(iterate, expected, 1e-5);
+  CheckMatrices(maxIterate, maxExpected, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -17,6 +17,10 @@
 #include <mlpack/methods/ann/init_rules/nguyen_widrow_init.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
 #include <mlpack/methods/ann/rnn.hpp>
+#include <mlpack/methods/ann/visitor/alias_check_visitor.hpp>
+#include <mlpack/methods/ann/visitor/gradient_set_visitor.hpp>
+#include <mlpack/methods/ann/visitor/quantize_visitor.hpp>
+#include <mlpack/methods/ann/visitor/weight_set_visitor.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -251,7 +255,6 @@ BOOST_AUTO_TEST_CASE(GradientAddLayerTest)
 
     double Gradient(arma::mat& gradient) const
     {
-      arma::mat output;
       double error = model->Evaluate(model->Parameters(), 0);
       model->Gradient(model->Parameters(), 0, gradient);
       return error;
@@ -472,7 +475,6 @@ BOOST_AUTO_TEST_CASE(GradientLinearLayerTest)
 
     double Gradient(arma::mat& gradient) const
     {
-      arma::mat output;
       double error = model->Evaluate(model->Parameters(), 0);
       model->Gradient(model->Parameters(), 0, gradient);
       return error;
@@ -555,7 +557,95 @@ BOOST_AUTO_TEST_CASE(GradientLinearNoBiadLayerTest)
 
     double Gradient(arma::mat& gradient) const
     {
-      arma::mat output;
+      double error = model->Evaluate(model->Parameters(), 0);
+      model->Gradient(model->Parameters(), 0, gradient);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
+/**
+ * Make sure the SparseLinear module computes the same function as a Linear
+ * module with the same (sparse) weights.
+ */
+BOOST_AUTO_TEST_CASE(SimpleSparseLinearLayerTest)
+{
+  const arma::sp_mat sparseWeight = arma::sprandu(20, 30, 0.1);
+  const arma::mat weight(sparseWeight);
+
+  SparseLinear<> module(sparseWeight);
+  BOOST_REQUIRE_EQUAL(module.NonZeros(), sparseWeight.n_nonzero);
+  BOOST_REQUIRE_EQUAL(module.Parameters().n_elem,
+      sparseWeight.n_nonzero + 20);
+  module.Parameters().tail_rows(20).randu();
+  module.Reset();
+  const arma::mat bias = module.Parameters().tail_rows(20);
+  CheckMatrices(arma::mat(module.Weight()), weight);
+
+  // Test the Forward function.
+  arma::mat input = arma::randu(30, 4);
+  arma::mat output;
+  module.Forward(std::move(input), std::move(output));
+  arma::mat expected = weight * input;
+  expected.each_col() += bias;
+  CheckMatrices(output, expected, 1e-5);
+
+  // Test the Backward function.
+  arma::mat gy = arma::randu(20, 4);
+  arma::mat delta;
+  module.Backward(std::move(input), std::move(gy), std::move(delta));
+  CheckMatrices(delta, weight.t() * gy, 1e-5);
+
+  // Test the Gradient function; the weights are ordered by row.
+  arma::mat gradient(module.Parameters().n_elem, 1);
+  module.Gradient(std::move(input), std::move(gy), std::move(gradient));
+  const arma::mat denseGradient = gy * input.t();
+  for (size_t r = 0; r < 20; ++r)
+  {
+    for (size_t k = module.RowPointers()[r]; k < module.RowPointers()[r + 1];
+         ++k)
+    {
+      BOOST_REQUIRE_CLOSE(gradient[k], denseGradient(r, module.Columns()[k]),
+          1e-5);
+    }
+  }
+  CheckMatrices(gradient.tail_rows(20), arma::sum(gy, 1), 1e-5);
+}
+
+/**
+ * SparseLinear layer numerically gradient test.
+ */
+BOOST_AUTO_TEST_CASE(GradientSparseLinearLayerTest)
+{
+  // SparseLinear function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(10, 1);
+      target = arma::mat("1");
+
+      model = new FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>(
+          input, target);
+      model->Add<IdentityLayer<> >();
+      model->Add<SparseLinear<> >(arma::sp_mat(arma::sprandu(2, 10, 0.5)));
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
       double error = model->Evaluate(model->Parameters(), 0);
       model->Gradient(model->Parameters(), 0, gradient);
       return error;
@@ -778,6 +868,48 @@ BOOST_AUTO_TEST_CASE(GradientLSTMLayerTest)
   BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
 }
 
+/**
+ * FastLSTM layer numerically gradient test, using a batch of sequences.
+ */
+BOOST_AUTO_TEST_CASE(GradientFastLSTMLayerTest)
+{
+  // FastLSTM function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(5, 4);
+      target = arma::mat("1 2 3 1; 2 3 1 2; 3 1 2 3; 1 2 3 1; 2 3 1 2");
+      const size_t rho = 5;
+
+      model = new RNN<NegativeLogLikelihood<> >(input, target, rho);
+      model->Add<IdentityLayer<> >();
+      model->Add<Linear<> >(1, 10);
+      model->Add<FastLSTM<> >(10, 3, rho);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0, 4);
+      model->Gradient(model->Parameters(), 0, gradient, 4);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    RNN<NegativeLogLikelihood<> >* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
 /**
  * Simple concat module test.
  */
@@ -903,6 +1035,36 @@ BOOST_AUTO_TEST_CASE(SimpleLookupLayerTest)
   BOOST_REQUIRE_CLOSE(arma::accu(gradient), arma::accu(error), 1e-3);
 }
 
+/**
+ * Make sure the sparse gradient of the Lookup module matches its dense
+ * gradient, also when a token is used more than once.
+ */
+BOOST_AUTO_TEST_CASE(SparseLookupLayerGradientTest)
+{
+  Lookup<> module(10, 5);
+  module.Parameters().randu();
+
+  arma::mat input("7; 2; 7; 4");
+  arma::mat error = arma::randu(5, 4);
+
+  arma::mat gradient;
+  module.Gradient(std::move(input), std::move(error), std::move(gradient));
+
+  arma::uvec indices;
+  arma::mat block;
+  module.SparseGradient(std::move(input), std::move(error), indices, block);
+
+  BOOST_REQUIRE_EQUAL(indices.n_elem, 3);
+  BOOST_REQUIRE_EQUAL(indices[0], 1);
+  BOOST_REQUIRE_EQUAL(indices[1], 3);
+  BOOST_REQUIRE_EQUAL(indices[2], 6);
+  CheckMatrices(block.col(2), arma::mat(error.col(0) + error.col(2)));
+
+  arma::mat sparseGradient = arma::zeros(5, 10);
+  sparseGradient.cols(indices) = block;
+  CheckMatrices(gradient, sparseGradient);
+}
+
 /**
  * Simple LogSoftMax module test.
  */
@@ -923,4 +1085,411 @@ BOOST_AUTO_TEST_CASE(SimpleLogSoftmaxLayerTest)
   BOOST_REQUIRE_EQUAL(arma::accu(delta), 0);
 }
 
+/**
+ * Make sure the SoftMaxCrossEntropy layer gives the loss and the error of a
+ * LogSoftMax module followed by the NegativeLogLikelihood layer, and that it
+ * handles large logits.
+ */
+BOOST_AUTO_TEST_CASE(SoftMaxCrossEntropyLayerTest)
+{
+  arma::mat input = arma::randn(10, 8) * 3;
+  arma::mat target(1, 8);
+  for (size_t i = 0; i < target.n_elem; ++i)
+    target(i) = (i % 10) + 1;
+
+  LogSoftMax<> logSoftMax;
+  NegativeLogLikelihood<> nll;
+  arma::mat logProbabilities, nllError, error;
+  logSoftMax.Forward(std::move(input), std::move(logProbabilities));
+  const double loss = nll.Forward(std::move(logProbabilities),
+      std::move(target));
+  nll.Backward(std::move(logProbabilities), std::move(target),
+      std::move(nllError));
+  logSoftMax.Backward(std::move(logProbabilities), std::move(nllError),
+      std::move(error));
+
+  SoftMaxCrossEntropy<> module;
+  arma::mat fusedError;
+  BOOST_REQUIRE_CLOSE(module.Forward(std::move(input), std::move(target)),
+      loss, 1e-2);
+  module.Backward(std::move(input), std::move(target), std::move(fusedError));
+  BOOST_REQUIRE_SMALL(arma::abs(error - fusedError).max(), 1e-4);
+
+  // Shifting the logits doesn't change anything, even if exp() would
+  // overflow.
+  arma::mat shiftedInput = input + 1000;
+  arma::mat shiftedError;
+  BOOST_REQUIRE_CLOSE(module.Forward(std::move(shiftedInput),
+      std::move(target)), loss, 1e-2);
+  module.Backward(std::move(shiftedInput), std::move(target),
+      std::move(shiftedError));
+  CheckMatrices(fusedError, shiftedError, 1e-6);
+}
+
+//! The convolution layer with all rules lowered to matrix multiplications.
+typedef Convolution<Im2ColConvolution<ValidConvolution>,
+                    Im2ColConvolution<FullConvolution>,
+                    Im2ColConvolution<ValidConvolution> >
+    Im2ColConvolutionLayer;
+
+/**
+ * Make sure the im2col convolution layer gives the same results as the naive
+ * convolution layer.
+ */
+BOOST_AUTO_TEST_CASE(Im2ColConvolutionLayerTest)
+{
+  Convolution<> naive(3, 4, 3, 3, 1, 1, 0, 0, 7, 6);
+  Im2ColConvolutionLayer im2col(3, 4, 3, 3, 1, 1, 0, 0, 7, 6);
+  naive.Parameters().randu();
+  naive.Reset();
+  im2col.Parameters() = naive.Parameters();
+  im2col.Reset();
+
+  arma::mat input = arma::randu(7 * 6 * 3, 1);
+  arma::mat naiveOutput, im2colOutput;
+  naive.Forward(std::move(input), std::move(naiveOutput));
+  im2col.Forward(std::move(input), std::move(im2colOutput));
+  CheckMatrices(naiveOutput, im2colOutput);
+
+  arma::mat error = arma::randu(naiveOutput.n_rows, 1);
+  arma::mat naiveDelta, im2colDelta;
+  naive.Backward(std::move(input), std::move(error), std::move(naiveDelta));
+  im2col.Backward(std::move(input), std::move(error), std::move(im2colDelta));
+  CheckMatrices(naiveDelta, im2colDelta);
+
+  // The naive layer only computes the gradient of a single input map in the
+  // same layout, so compare the gradients with one input map.
+  Convolution<> naiveSingle(1, 4, 3, 3, 1, 1, 0, 0, 7, 6);
+  Im2ColConvolutionLayer im2colSingle(1, 4, 3, 3, 1, 1, 0, 0, 7, 6);
+  naiveSingle.Parameters().randu();
+  naiveSingle.Reset();
+  im2colSingle.Parameters() = naiveSingle.Parameters();
+  im2colSingle.Reset();
+
+  arma::mat singleInput = arma::randu(7 * 6, 1);
+  naiveSingle.Forward(std::move(singleInput), std::move(naiveOutput));
+  im2colSingle.Forward(std::move(singleInput), std::move(im2colOutput));
+  CheckMatrices(naiveOutput, im2colOutput);
+
+  arma::mat naiveGradient, im2colGradient;
+  naiveGradient.zeros(naiveSingle.Parameters().n_elem, 1);
+  im2colGradient.zeros(im2colSingle.Parameters().n_elem, 1);
+  naiveSingle.Gradient(std::move(singleInput), std::move(error),
+      std::move(naiveGradient));
+  im2colSingle.Gradient(std::move(singleInput), std::move(error),
+      std::move(im2colGradient));
+  CheckMatrices(naiveGradient, im2colGradient);
+}
+
+/**
+ * Make sure the int8 versions of the Linear and Convolution modules give the
+ * same results as the modules, up to the quantization error.
+ */
+BOOST_AUTO_TEST_CASE(QuantizedLayerTest)
+{
+  Linear<> linear(20, 7);
+  linear.Parameters().randn();
+  linear.Reset();
+
+  QuantizedLayer quantizedLinear;
+  LayerTypes<> linearModule(&linear);
+  BOOST_REQUIRE(boost::apply_visitor(QuantizeVisitor(quantizedLinear),
+      linearModule));
+  BOOST_REQUIRE(!quantizedLinear.IsConvolution());
+  BOOST_REQUIRE_EQUAL(quantizedLinear.Weights().size(), 20 * 7);
+
+  arma::mat input = arma::randn(20, 5);
+  arma::mat output, quantizedOutput;
+  linear.Forward(std::move(input), std::move(output));
+  quantizedLinear.Forward(input, quantizedOutput);
+  BOOST_REQUIRE_LT(arma::abs(output - quantizedOutput).max(),
+      0.05 * arma::abs(output).max());
+
+  // A convolution with padding and strides; the first forward pass sets the
+  // size of its input.
+  Convolution<> convolution(3, 4, 3, 3, 2, 1, 1, 1, 7, 6);
+  convolution.Parameters().randn();
+  convolution.Reset();
+
+  arma::mat maps = arma::randu(7 * 6 * 3, 1);
+  convolution.Forward(std::move(maps), std::move(output));
+
+  QuantizedLayer quantizedConvolution;
+  LayerTypes<> convolutionModule(&convolution);
+  BOOST_REQUIRE(boost::apply_visitor(QuantizeVisitor(quantizedConvolution),
+      convolutionModule));
+  BOOST_REQUIRE(quantizedConvolution.IsConvolution());
+  BOOST_REQUIRE_EQUAL(quantizedConvolution.OutputWidth(),
+      convolution.OutputWidth());
+  BOOST_REQUIRE_EQUAL(quantizedConvolution.OutputHeight(),
+      convolution.OutputHeight());
+
+  quantizedConvolution.Forward(maps, quantizedOutput);
+  BOOST_REQUIRE_EQUAL(quantizedOutput.n_rows, output.n_rows);
+  BOOST_REQUIRE_LT(arma::abs(output - quantizedOutput).max(),
+      0.05 * arma::abs(output).max());
+
+  // Other modules are not quantized.
+  LogSoftMax<> logSoftMax;
+  QuantizedLayer empty;
+  LayerTypes<> logSoftMaxModule(&logSoftMax);
+  BOOST_REQUIRE(!boost::apply_visitor(QuantizeVisitor(empty),
+      logSoftMaxModule));
+  BOOST_REQUIRE(empty.IsEmpty());
+}
+
+/**
+ * Jacobian im2col convolution module test, with padding and stride.
+ */
+BOOST_AUTO_TEST_CASE(JacobianIm2ColConvolutionLayerTest)
+{
+  arma::mat input;
+  input.set_size(6 * 5 * 2, 1);
+
+  Im2ColConvolutionLayer module(2, 3, 3, 3, 2, 2, 1, 1, 6, 5);
+  module.Parameters().randu();
+
+  double error = JacobianTest(module, input);
+  BOOST_REQUIRE_LE(error, 1e-5);
+}
+
+/**
+ * Im2col convolution layer numerically gradient test, with padding and stride.
+ */
+BOOST_AUTO_TEST_CASE(GradientIm2ColConvolutionLayerTest)
+{
+  // Convolution function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(6 * 5 * 2, 1);
+      target = arma::mat("1");
+
+      model = new FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>(
+          input, target);
+      model->Add<IdentityLayer<> >();
+      model->Add<Im2ColConvolutionLayer>(2, 3, 3, 3, 2, 2, 1, 1, 6, 5);
+      model->Add<Linear<> >(27, 2);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0);
+      model->Gradient(model->Parameters(), 0, gradient);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
+//! The convolution layer with all rules computed in the frequency domain.
+typedef Convolution<CachedFFTConvolution<ValidConvolution>,
+                    CachedFFTConvolution<FullConvolution>,
+                    CachedFFTConvolution<ValidConvolution> >
+    CachedFFTConvolutionLayer;
+
+/**
+ * Make sure the cached fft convolution layer gives the same results as the
+ * im2col convolution layer, with padding and stride, and that it notices when
+ * the parameters change.
+ */
+BOOST_AUTO_TEST_CASE(CachedFFTConvolutionLayerTest)
+{
+  Im2ColConvolutionLayer im2col(3, 4, 3, 2, 2, 1, 1, 2, 9, 8);
+  CachedFFTConvolutionLayer fft(3, 4, 3, 2, 2, 1, 1, 2, 9, 8);
+  im2col.Parameters().randu();
+  im2col.Reset();
+  fft.Parameters() = im2col.Parameters();
+  fft.Reset();
+
+  arma::mat input = arma::randu(9 * 8 * 3, 1);
+  arma::mat im2colOutput, fftOutput;
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    // The second time the filter spectra must be recomputed.
+    if (trial == 1)
+    {
+      im2col.Parameters().randu();
+      fft.Parameters() = im2col.Parameters();
+    }
+
+    im2col.Forward(std::move(input), std::move(im2colOutput));
+    fft.Forward(std::move(input), std::move(fftOutput));
+    CheckMatrices(im2colOutput, fftOutput);
+
+    arma::mat error = arma::randu(im2colOutput.n_rows, 1);
+    arma::mat im2colDelta, fftDelta;
+    im2col.Backward(std::move(input), std::move(error),
+        std::move(im2colDelta));
+    fft.Backward(std::move(input), std::move(error), std::move(fftDelta));
+    CheckMatrices(im2colDelta, fftDelta);
+
+    arma::mat im2colGradient, fftGradient;
+    im2colGradient.zeros(im2col.Parameters().n_elem, 1);
+    fftGradient.zeros(fft.Parameters().n_elem, 1);
+    im2col.Gradient(std::move(input), std::move(error),
+        std::move(im2colGradient));
+    fft.Gradient(std::move(input), std::move(error), std::move(fftGradient));
+    CheckMatrices(im2colGradient, fftGradient);
+  }
+}
+
+/**
+ * Jacobian cached fft convolution module test, with padding and stride.
+ */
+BOOST_AUTO_TEST_CASE(JacobianCachedFFTConvolutionLayerTest)
+{
+  arma::mat input;
+  input.set_size(6 * 5 * 2, 1);
+
+  CachedFFTConvolutionLayer module(2, 3, 3, 3, 2, 2, 1, 1, 6, 5);
+  module.Parameters().randu();
+
+  double error = JacobianTest(module, input);
+  BOOST_REQUIRE_LE(error, 1e-5);
+}
+
+/**
+ * Simple max pooling and mean pooling layer test, with a batch of two points.
+ */
+BOOST_AUTO_TEST_CASE(SimplePoolingLayerTest)
+{
+  // Each column holds a 4x4 input map.
+  arma::mat input(16, 2);
+  for (size_t i = 0; i < input.n_elem; ++i)
+    input(i) = (double) ((i * 7) % 16) + 16.0 * (i / 16);
+
+  MaxPooling<> maxPooling(2, 2, 2, 2);
+  maxPooling.InputWidth() = 4;
+  maxPooling.InputHeight() = 4;
+  MeanPooling<> meanPooling(2, 2, 2, 2);
+  meanPooling.InputWidth() = 4;
+  meanPooling.InputHeight() = 4;
+
+  arma::mat maxOutput, meanOutput;
+  maxPooling.Forward(std::move(input), std::move(maxOutput));
+  meanPooling.Forward(std::move(input), std::move(meanOutput));
+  BOOST_REQUIRE_EQUAL(maxOutput.n_elem, 8);
+  BOOST_REQUIRE_EQUAL(meanOutput.n_elem, 8);
+
+  const arma::cube inputCube(input.memptr(), 4, 4, 2, false, true);
+  for (size_t s = 0; s < 2; ++s)
+  {
+    for (size_t j = 0; j < 2; ++j)
+    {
+      for (size_t i = 0; i < 2; ++i)
+      {
+        const arma::mat window = inputCube.slice(s).submat(2 * i, 2 * j,
+            2 * i + 1, 2 * j + 1);
+        BOOST_REQUIRE_CLOSE(maxOutput(i + 2 * j + 4 * s), window.max(),
+            1e-5);
+        BOOST_REQUIRE_CLOSE(meanOutput(i + 2 * j + 4 * s),
+            arma::accu(window) / 4.0, 1e-5);
+      }
+    }
+  }
+
+  // The error of each output goes to the maximum of its window, or is spread
+  // evenly over the window.
+  arma::mat error = arma::ones(8, 1);
+  arma::mat maxDelta, meanDelta;
+  maxPooling.Backward(std::move(input), std::move(error), std::move(maxDelta));
+  meanPooling.Backward(std::move(input), std::move(error),
+      std::move(meanDelta));
+  BOOST_REQUIRE_CLOSE(arma::accu(maxDelta), 8.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(arma::accu(meanDelta), 8.0, 1e-5);
+  for (size_t i = 0; i < input.n_elem; ++i)
+  {
+    BOOST_REQUIRE_SMALL(meanDelta(i) - 0.25, 1e-5);
+    if (maxDelta(i) != 0.0)
+    {
+      BOOST_REQUIRE_CLOSE(maxDelta(i), 1.0, 1e-5);
+      BOOST_REQUIRE(arma::any(arma::vectorise(maxOutput) == input(i)));
+    }
+  }
+}
+
+/**
+ * Jacobian max pooling and mean pooling module test, with window sizes that
+ * are and are not unrolled.
+ */
+BOOST_AUTO_TEST_CASE(JacobianPoolingLayerTest)
+{
+  const size_t windows[3][4] = { { 2, 2, 2, 2 }, { 3, 3, 2, 1 },
+      { 2, 3, 1, 2 } };
+  for (size_t w = 0; w < 3; ++w)
+  {
+    arma::mat input;
+    input.set_size(7 * 6 * 2, 1);
+
+    MaxPooling<> maxPooling(windows[w][0], windows[w][1], windows[w][2],
+        windows[w][3]);
+    maxPooling.InputWidth() = 7;
+    maxPooling.InputHeight() = 6;
+    BOOST_REQUIRE_LE(JacobianTest(maxPooling, input), 1e-5);
+
+    MeanPooling<> meanPooling(windows[w][0], windows[w][1], windows[w][2],
+        windows[w][3]);
+    meanPooling.InputWidth() = 7;
+    meanPooling.InputHeight() = 6;
+    BOOST_REQUIRE_LE(JacobianTest(meanPooling, input), 1e-5);
+  }
+}
+
+/**
+ * Make sure that the Linear and Add layers write their gradient into the
+ * network gradient memory, for a batch of points.
+ */
+BOOST_AUTO_TEST_CASE(GradientAliasLayerTest)
+{
+  Linear<> linear(10, 5);
+  Add<> add(5);
+
+  arma::mat parameters(linear.Parameters().n_elem + add.Parameters().n_elem,
+      1, arma::fill::randu);
+  arma::mat gradient(parameters.n_elem, 1, arma::fill::zeros);
+
+  const size_t offset = WeightSetVisitor<>(std::move(parameters))(&linear);
+  WeightSetVisitor<>(std::move(parameters), offset)(&add);
+  GradientSetVisitor<>(std::move(gradient))(&linear);
+  GradientSetVisitor<>(std::move(gradient), offset)(&add);
+  linear.Reset();
+
+  arma::mat input = arma::randu(10, 4);
+  arma::mat error = arma::randu(5, 4);
+  linear.Gradient(std::move(input), std::move(error),
+      std::move(linear.Gradient()));
+  add.Gradient(std::move(input), std::move(error), std::move(add.Gradient()));
+
+  // The views must not have been reallocated.
+  BOOST_REQUIRE_EQUAL(AliasCheckVisitor<>(std::move(parameters),
+      std::move(gradient))(&linear), offset);
+  BOOST_REQUIRE_EQUAL(linear.Gradient().memptr(), gradient.memptr());
+  BOOST_REQUIRE_EQUAL(add.Gradient().memptr(), gradient.memptr() + offset);
+
+  const arma::mat weightGradient = arma::vectorise(error * input.t());
+  const arma::mat biasGradient = arma::sum(error, 1);
+  for (size_t i = 0; i < weightGradient.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(gradient[i], weightGradient[i], 1e-5);
+  for (size_t i = 0; i < biasGradient.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(gradient[weightGradient.n_elem + i], biasGradient[i],
+        1e-5);
+    BOOST_REQUIRE_CLOSE(gradient[offset + i], biasGradient[i], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -11,6 +11,7 @@
  */
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/data/batch_source.hpp>
 #include <mlpack/methods/block_krylov_svd/randomized_block_krylov_svd.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -109,4 +110,40 @@ BOOST_AUTO_TEST_CASE(RandomizedBlockKrylovSVDNoisyLowRankTest)
   BOOST_REQUIRE_SMALL(error, 1e-2);
 }
 
+/**
+ * The randomized block krylov SVD of data read from a batch source, one block
+ * at a time, should match the SVD of the data.
+ */
+BOOST_AUTO_TEST_CASE(StreamedRandomizedBlockKrylovSVDTest)
+{
+  arma::mat data;
+  CreateNoisyLowRankMatrix(data, 200, 2000, 5, 0.01);
+
+  arma::mat U1, V1;
+  arma::vec s1;
+  arma::svd_econ(U1, s1, V1, data);
+
+  // The shards and the blocks are not aligned.
+  arma::mat noResponses(0, data.n_cols);
+  data::MatrixBatchSource<> source(data, noResponses, 700);
+
+  arma::mat U2;
+  arma::vec s2;
+  svd::RandomizedBlockKrylovSVD rSVD(5, 10);
+  const size_t n = rSVD.Apply(source, U2, s2, 5, 256);
+
+  BOOST_REQUIRE_EQUAL(n, data.n_cols);
+  BOOST_REQUIRE_EQUAL(U2.n_rows, 200);
+  BOOST_REQUIRE_EQUAL(U2.n_cols, 5);
+  BOOST_REQUIRE_EQUAL(s2.n_elem, 5);
+
+  for (size_t i = 0; i < 5; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(s2[i], s1[i], 1e-3);
+
+    // The singular vectors are only known up to their sign.
+    BOOST_REQUIRE_CLOSE(std::abs(arma::dot(U1.col(i), U2.col(i))), 1.0, 1e-3);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
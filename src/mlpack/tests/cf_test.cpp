@@ -12,6 +12,7 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/cf/cf.hpp>
+#include <mlpack/methods/amf/termination_policies/max_iteration_termination.hpp>
 #include <iostream>
 
 #include <boost/test/unit_test.hpp>
@@ -22,6 +23,7 @@ BOOST_AUTO_TEST_SUITE(CFTest);
 
 using namespace mlpack;
 using namespace mlpack::cf;
+using namespace mlpack::amf;
 using namespace std;
 
 /**
@@ -543,5 +545,245 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
   }
 }
 
+/**
+ * With a neighborhood of one user, the recommendations of a user should be
+ * its best un-rated items, in order, according to W * H.
+ */
+BOOST_AUTO_TEST_CASE(CFRecommendationsOrderTest)
+{
+  arma::sp_mat data;
+  data.sprandu(100, 40, 0.3);
+  data *= 5.0;
+
+  CF c(data, NMFALSFactorizer(), 1, 5);
+
+  const size_t numRecs = 10;
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(numRecs, recommendations);
+
+  BOOST_REQUIRE_EQUAL(recommendations.n_rows, numRecs);
+  BOOST_REQUIRE_EQUAL(recommendations.n_cols, data.n_cols);
+
+  const arma::mat ratings = c.W() * c.H();
+  for (size_t user = 0; user < data.n_cols; ++user)
+  {
+    // Find the best un-rated items by brute force.
+    std::vector<std::pair<double, size_t>> candidates;
+    for (size_t item = 0; item < data.n_rows; ++item)
+      if (data(item, user) == 0.0)
+        candidates.push_back(std::make_pair(ratings(item, user), item));
+    std::sort(candidates.rbegin(), candidates.rend());
+
+    for (size_t p = 0; p < numRecs; ++p)
+      BOOST_REQUIRE_EQUAL(recommendations(p, user), candidates[p].second);
+  }
+}
+
+/**
+ * Recommendations found with the FastMKS item index should be the same as
+ * those found by estimating every rating, and the index should be saved with
+ * the model.
+ */
+BOOST_AUTO_TEST_CASE(CFItemIndexTest)
+{
+  arma::sp_mat data;
+  data.sprandu(100, 40, 0.3);
+  data *= 5.0;
+
+  CF c(data, NMFALSFactorizer(), 3, 5);
+  BOOST_REQUIRE(!c.HasItemIndex());
+
+  const size_t numRecs = 10;
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(numRecs, recommendations);
+
+  c.BuildItemIndex();
+  BOOST_REQUIRE(c.HasItemIndex());
+
+  arma::Mat<size_t> indexRecommendations;
+  c.GetRecommendations(numRecs, indexRecommendations);
+
+  CF cXml, cText, cBinary;
+  SerializeObjectAll(c, cXml, cText, cBinary);
+  BOOST_REQUIRE(cXml.HasItemIndex());
+  BOOST_REQUIRE(cText.HasItemIndex());
+  BOOST_REQUIRE(cBinary.HasItemIndex());
+
+  arma::Mat<size_t> xmlRecommendations, textRecommendations,
+      binaryRecommendations;
+  cXml.GetRecommendations(numRecs, xmlRecommendations);
+  cText.GetRecommendations(numRecs, textRecommendations);
+  cBinary.GetRecommendations(numRecs, binaryRecommendations);
+
+  CheckMatrices(recommendations, indexRecommendations);
+  CheckMatrices(recommendations, xmlRecommendations);
+  CheckMatrices(recommendations, textRecommendations);
+  CheckMatrices(recommendations, binaryRecommendations);
+
+  // Training again should discard the index.
+  c.Train(data, NMFALSFactorizer());
+  BOOST_REQUIRE(!c.HasItemIndex());
+}
+
+/**
+ * Test that ALS-WR fits the ratings of a low-rank matrix.
+ */
+BOOST_AUTO_TEST_CASE(ALSWRFitTest)
+{
+  // Sample 40% of the elements of a rank 3 matrix.
+  const arma::mat w = arma::randu<arma::mat>(50, 3);
+  const arma::mat h = arma::randu<arma::mat>(3, 60);
+  const arma::mat product = w * h;
+  arma::sp_mat data(50, 60);
+  for (size_t j = 0; j < 60; ++j)
+    for (size_t i = 0; i < 50; ++i)
+      if (math::Random() < 0.4)
+        data(i, j) = product(i, j);
+
+  AMF<MaxIterationTermination, RandomInitialization, ALSWRUpdate> amf(
+      MaxIterationTermination(20), RandomInitialization(), ALSWRUpdate(1e-3));
+
+  arma::mat W, H;
+  amf.Apply(data, 3, W, H);
+
+  // Compute the RMSE of the given ratings.
+  double error = 0.0;
+  for (arma::sp_mat::const_iterator it = data.begin(); it != data.end(); ++it)
+    error += std::pow((*it) - arma::dot(W.row(it.row()), H.col(it.col())), 2);
+  const double rmse = std::sqrt(error / data.n_nonzero);
+
+  BOOST_REQUIRE_LT(rmse, 0.05);
+}
+
+/**
+ * The blocked ALS-WR update gives the same factorization as ALS-WR, and each
+ * block only receives the factors of the ratings it holds.
+ */
+BOOST_AUTO_TEST_CASE(BlockALSWRTest)
+{
+  arma::sp_mat data;
+  data.sprandu(200, 300, 0.1);
+
+  AMF<MaxIterationTermination, RandomInitialization, ALSWRUpdate> amf(
+      MaxIterationTermination(5));
+  AMF<MaxIterationTermination, RandomInitialization, BlockALSWRUpdate>
+      blockAMF(MaxIterationTermination(5), RandomInitialization(),
+      BlockALSWRUpdate(0.05, 3));
+
+  arma::mat W, H, blockW, blockH;
+  math::RandomSeed(12);
+  amf.Apply(data, 4, W, H);
+  math::RandomSeed(12);
+  blockAMF.Apply(data, 4, blockW, blockH);
+
+  CheckMatrices(blockW, W);
+  CheckMatrices(blockH, H);
+
+  // With ratings in two diagonal blocks, each block only needs the factors of
+  // its own diagonal block.
+  arma::sp_mat diagonalBlock;
+  arma::sp_mat blockData(100, 120);
+  diagonalBlock.sprandu(50, 60, 0.3);
+  blockData.submat(0, 0, 49, 59) = diagonalBlock;
+  diagonalBlock.sprandu(50, 60, 0.3);
+  blockData.submat(50, 60, 99, 119) = diagonalBlock;
+  BlockALSWRUpdate update(0.05, 2);
+  update.Initialize(blockData, 4);
+  BOOST_REQUIRE_EQUAL(update.ExchangedFactors(), 220);
+}
+
+/**
+ * Ratings of new users and items added to a trained model are fit by the
+ * folded-in feature vectors, without changing the other feature vectors.
+ */
+BOOST_AUTO_TEST_CASE(CFAddRatingsTest)
+{
+  // Sample 50% of the elements of a rank 3 matrix.
+  const arma::mat w = arma::randu<arma::mat>(60, 3);
+  const arma::mat h = arma::randu<arma::mat>(3, 80);
+  const arma::mat product = w * h;
+  arma::sp_mat data(60, 80);
+  for (size_t j = 0; j < 80; ++j)
+    for (size_t i = 0; i < 60; ++i)
+      if (math::Random() < 0.5)
+        data(i, j) = product(i, j);
+
+  // Train on the first 50 items and 60 users only.
+  AMF<MaxIterationTermination, RandomInitialization, ALSWRUpdate> amf(
+      MaxIterationTermination(20), RandomInitialization(), ALSWRUpdate(1e-3));
+  CF c(arma::sp_mat(data.submat(0, 0, 49, 59)), amf, 3, 3);
+  c.BuildItemIndex();
+  const arma::mat oldW = c.W();
+  const arma::mat oldH = c.H();
+
+  // Add the ratings of the new users, and the ratings of the new items.
+  arma::sp_mat newRatings(data);
+  newRatings.submat(0, 0, 49, 59).zeros();
+  c.AddRatings(newRatings, 1e-6);
+
+  BOOST_REQUIRE_EQUAL(c.W().n_rows, 60);
+  BOOST_REQUIRE_EQUAL(c.H().n_cols, 80);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_nonzero, data.n_nonzero);
+  CheckMatrices(c.W().rows(0, 49), oldW);
+  CheckMatrices(c.H().cols(0, 59), oldH);
+
+  // The new ratings are fit about as well as the trained ratings.
+  double error = 0.0;
+  for (arma::sp_mat::const_iterator it = newRatings.begin();
+       it != newRatings.end(); ++it)
+  {
+    error += std::pow((*it) - arma::dot(c.W().row(it.row()),
+        c.H().col(it.col())), 2);
+  }
+  BOOST_REQUIRE_LT(std::sqrt(error / newRatings.n_nonzero), 0.1);
+
+  // The item index was rebuilt with the new items.
+  BOOST_REQUIRE(c.HasItemIndex());
+  arma::Mat<size_t> recommendations, indexRecommendations;
+  c.GetRecommendations(5, indexRecommendations);
+  c.ClearItemIndex();
+  c.GetRecommendations(5, recommendations);
+  BOOST_REQUIRE_EQUAL(recommendations.n_cols, 80);
+  CheckMatrices(recommendations, indexRecommendations);
+
+  // A new rating replaces an old one.
+  arma::sp_mat change(60, 80);
+  change(0, 0) = 10.0;
+  c.AddRatings(change);
+  BOOST_REQUIRE_CLOSE(c.CleanedData()(0, 0), 10.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_nonzero, data.n_nonzero +
+      ((data(0, 0) == 0.0) ? 1 : 0));
+
+  CF untrained;
+  BOOST_REQUIRE_THROW(untrained.AddRatings(change), std::invalid_argument);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * The least squares problems of ALS-WR are independent, so the factorization
+ * should not depend on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(ALSWRMultithreadedTest)
+{
+  arma::sp_mat data;
+  data.sprandu(200, 300, 0.1);
+
+  AMF<MaxIterationTermination, RandomInitialization, ALSWRUpdate> amf(
+      MaxIterationTermination(5));
+
+  const int numThreads = omp_get_max_threads();
+  arma::mat W1, H1, W4, H4;
+  math::RandomSeed(12);
+  omp_set_num_threads(1);
+  amf.Apply(data, 4, W1, H1);
+  math::RandomSeed(12);
+  omp_set_num_threads(4);
+  amf.Apply(data, 4, W4, H4);
+  omp_set_num_threads(numThreads);
+
+  CheckMatrices(W1, W4);
+  CheckMatrices(H1, H4);
+}
+#endif
 
 BOOST_AUTO_TEST_SUITE_END();
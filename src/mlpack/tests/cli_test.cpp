@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/server.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -1111,4 +1112,192 @@ BOOST_AUTO_TEST_CASE(RawDatasetInfoLoadParameter)
   remove("test.arff");
 }
 
+/**
+ * Test that ServerRequest parses options by name and alias, falls back to the
+ * command-line values, and rejects invalid requests.
+ */
+BOOST_AUTO_TEST_CASE(ServerRequestTest)
+{
+  AddRequiredCLIOptions();
+
+  CLI::Add<int>(3, "k", "Test int", 'k', false, true, false);
+  CLI::Add<string>("", "file", "Test string", 'f', false, true, false);
+  CLI::Add<string>("", "other", "Test string", 'o', false, true, false);
+  CLI::Add<bool>(false, "flag", "Test flag", 'F');
+
+  const char* argv[3];
+  argv[0] = "./test";
+  argv[1] = "-k";
+  argv[2] = "5";
+
+  int argc = 3;
+
+  CLI::ParseCommandLine(argc, const_cast<char**>(argv));
+
+  const vector<string> allowed = { "k", "file", "flag" };
+
+  ServerRequest request("--file a.csv -F", allowed);
+  BOOST_REQUIRE(request.HasParam("file"));
+  BOOST_REQUIRE(request.HasParam("flag"));
+  BOOST_REQUIRE(!request.HasParam("k"));
+  BOOST_REQUIRE_EQUAL(request.GetParam<string>("file"), string("a.csv"));
+  BOOST_REQUIRE_EQUAL(request.GetParam<int>("k"), 5);
+
+  ServerRequest request2("  -k 7   -f b.csv ", allowed);
+  BOOST_REQUIRE_EQUAL(request2.GetParam<int>("k"), 7);
+  BOOST_REQUIRE_EQUAL(request2.GetParam<string>("file"), string("b.csv"));
+  BOOST_REQUIRE(!request2.HasParam("flag"));
+
+  // Values of the wrong type are rejected.
+  ServerRequest request3("-k seven", allowed);
+  BOOST_REQUIRE_THROW(request3.GetParam<int>("k"), invalid_argument);
+
+  // Unknown, disallowed, duplicate and missing options are rejected.
+  BOOST_REQUIRE_THROW(ServerRequest("--unknown 1", allowed), invalid_argument);
+  BOOST_REQUIRE_THROW(ServerRequest("-o c.csv", allowed), invalid_argument);
+  BOOST_REQUIRE_THROW(ServerRequest("-k 1 --k 2", allowed), invalid_argument);
+  BOOST_REQUIRE_THROW(ServerRequest("-f", allowed), invalid_argument);
+}
+
+/**
+ * Test that ServeRequests() answers every request in order and stops at "quit".
+ */
+BOOST_AUTO_TEST_CASE(ServeRequestsTest)
+{
+  AddRequiredCLIOptions();
+
+  CLI::Add<int>(0, "k", "Test int", 'k', false, true, false);
+
+  const char* argv[1];
+  argv[0] = "./test";
+
+  int argc = 1;
+
+  CLI::ParseCommandLine(argc, const_cast<char**>(argv));
+
+  istringstream input("-k 1\n\n# comment\n-k 2\n--bad 1\n-k x\n quit \n"
+      "-k 3\n");
+  ostringstream output;
+  vector<int> seen;
+
+  Log::Warn.ignoreInput = true;
+  const size_t failures = ServeRequests(input, output, { "k" },
+      [&seen](const ServerRequest& request)
+  {
+    seen.push_back(request.GetParam<int>("k"));
+  });
+  Log::Warn.ignoreInput = false;
+
+  BOOST_REQUIRE_EQUAL(failures, 2);
+  BOOST_REQUIRE_EQUAL(seen.size(), 2);
+  BOOST_REQUIRE_EQUAL(seen[0], 1);
+  BOOST_REQUIRE_EQUAL(seen[1], 2);
+
+  istringstream responses(output.str());
+  string line;
+  vector<string> lines;
+  while (getline(responses, line))
+    lines.push_back(line);
+
+  BOOST_REQUIRE_EQUAL(lines.size(), 4);
+  BOOST_REQUIRE_EQUAL(lines[0], "ok");
+  BOOST_REQUIRE_EQUAL(lines[1], "ok");
+  BOOST_REQUIRE_EQUAL(lines[2].substr(0, 7), "error: ");
+  BOOST_REQUIRE_EQUAL(lines[3].substr(0, 7), "error: ");
+}
+
+/**
+ * Make sure NUMA placement moves a matrix without changing its contents, for
+ * both placement policies.
+ */
+BOOST_AUTO_TEST_CASE(ExecutionPlaceTest)
+{
+#ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+#endif
+
+  const arma::mat data = arma::randu<arma::mat>(100, 5000);
+  Execution::NUMAPolicy policies[] = { Execution::NUMA_FIRST_TOUCH,
+                                       Execution::NUMA_INTERLEAVE };
+  for (size_t i = 0; i < 2; ++i)
+  {
+    Execution::Configure(4, Execution::BIND_NONE, policies[i]);
+    BOOST_REQUIRE_EQUAL(Execution::NUMA(), policies[i]);
+
+    arma::mat placed(data);
+    Execution::Place(placed);
+    CheckMatrices(placed, data);
+
+    // Sparse matrices are left alone.
+    arma::sp_mat sparse;
+    sparse.sprandu(100, 100, 0.1);
+    const arma::mat dense(sparse);
+    Execution::Place(sparse);
+    CheckMatrices(arma::mat(sparse), dense);
+  }
+
+  Execution::Configure(0, Execution::BIND_NONE, Execution::NUMA_NONE);
+#ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+}
+
+//! An executor that runs the tasks on the calling thread, in reverse order.
+class ReverseExecutor : public Executor
+{
+ public:
+  ReverseExecutor() : batches(0) { }
+
+  size_t Concurrency() const { return 4; }
+
+  void Run(const size_t tasks, const std::function<void(size_t)>& task)
+  {
+    ++batches;
+    for (size_t i = tasks; i > 0; --i)
+      task(i - 1);
+  }
+
+  size_t batches;
+};
+
+/**
+ * Make sure ParallelFor() runs every iteration once, on the installed executor
+ * if there is one, serializes nested loops, and rethrows exceptions.
+ */
+BOOST_AUTO_TEST_CASE(ExecutionParallelForTest)
+{
+  std::vector<size_t> counts(1000, 0);
+  Execution::ParallelFor(counts.size(), [&](const size_t i) { ++counts[i]; },
+      16);
+  for (size_t i = 0; i < counts.size(); ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  ReverseExecutor executor;
+  Execution::SetExecutor(&executor);
+  BOOST_REQUIRE_EQUAL(Execution::GetExecutor(), &executor);
+
+  // The inner loops must not be given to the executor.
+  std::vector<size_t> order;
+  Execution::ParallelFor(10, [&](const size_t i)
+  {
+    Execution::ParallelFor(10, [&](const size_t j)
+    {
+      order.push_back(10 * i + j);
+    });
+  });
+  BOOST_REQUIRE_EQUAL(executor.batches, 1);
+  BOOST_REQUIRE_EQUAL(order.size(), 100);
+  for (size_t i = 0; i < 100; ++i)
+    BOOST_REQUIRE_EQUAL(order[i], 10 * (9 - i / 10) + i % 10);
+
+  BOOST_REQUIRE_THROW(Execution::ParallelFor(10, [](const size_t i)
+  {
+    if (i == 5)
+      throw std::runtime_error("error");
+  }), std::runtime_error);
+
+  Execution::SetExecutor(NULL);
+  BOOST_REQUIRE(Execution::GetExecutor() == NULL);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
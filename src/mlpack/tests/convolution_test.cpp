@@ -16,6 +16,8 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/cached_fft_convolution.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -149,6 +151,14 @@ BOOST_AUTO_TEST_CASE(ValidConvolution2DTest)
   // speeded up the computation.
   Convolution2DMethodTest<SVDConvolution<ValidConvolution> >(input, filter,
       output);
+
+  // Perform the convolution through im2col lowering.
+  Convolution2DMethodTest<Im2ColConvolution<ValidConvolution> >(input, filter,
+      output);
+
+  // Perform the convolution through fft with cached spectra.
+  Convolution2DMethodTest<CachedFFTConvolution<ValidConvolution> >(input,
+      filter, output);
 }
 
 /**
@@ -186,6 +196,14 @@ BOOST_AUTO_TEST_CASE(FullConvolution2DTest)
   // speeded up the computation.
   Convolution2DMethodTest<SVDConvolution<FullConvolution> >(input, filter,
       output);
+
+  // Perform the convolution through im2col lowering.
+  Convolution2DMethodTest<Im2ColConvolution<FullConvolution> >(input, filter,
+      output);
+
+  // Perform the convolution through fft with cached spectra.
+  Convolution2DMethodTest<CachedFFTConvolution<FullConvolution> >(input,
+      filter, output);
 }
 
 /**
@@ -231,6 +249,14 @@ BOOST_AUTO_TEST_CASE(ValidConvolution3DTest)
   // speeded up the computation.
   Convolution3DMethodTest<SVDConvolution<ValidConvolution> >(inputCube,
       filterCube, outputCube);
+
+  // Perform the convolution through im2col lowering.
+  Convolution3DMethodTest<Im2ColConvolution<ValidConvolution> >(inputCube,
+      filterCube, outputCube);
+
+  // Perform the convolution through fft with cached spectra.
+  Convolution3DMethodTest<CachedFFTConvolution<ValidConvolution> >(inputCube,
+      filterCube, outputCube);
 }
 
 /**
@@ -280,6 +306,14 @@ BOOST_AUTO_TEST_CASE(FullConvolution3DTest)
   // speeded up the computation.
   Convolution3DMethodTest<SVDConvolution<FullConvolution> >(inputCube,
       filterCube, outputCube);
+
+  // Perform the convolution through im2col lowering.
+  Convolution3DMethodTest<Im2ColConvolution<FullConvolution> >(inputCube,
+      filterCube, outputCube);
+
+  // Perform the convolution through fft with cached spectra.
+  Convolution3DMethodTest<CachedFFTConvolution<FullConvolution> >(inputCube,
+      filterCube, outputCube);
 }
 
 /**
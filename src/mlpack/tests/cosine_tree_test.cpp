@@ -222,4 +222,47 @@ BOOST_AUTO_TEST_CASE(CosineTreeModifiedGramSchmidt)
   }
 }
 
+/**
+ * Constructs a cosine tree on a wide matrix, large enough for the
+ * nodes near the root to be processed in parallel, and checks that the vectors
+ * of the final basis are orthonormal, and that the cosines of the root node
+ * are correct.
+ */
+BOOST_AUTO_TEST_CASE(CosineTreeWideBasisTest)
+{
+  // Make a random dataset.
+  const size_t numRows = 20;
+  const size_t numCols = 10000;
+  arma::mat data = arma::randu(numRows, numCols);
+
+  CosineTree ctree(data, 0.1, 0.1);
+  arma::mat basis;
+  ctree.GetFinalBasis(basis);
+
+  BOOST_REQUIRE_EQUAL(basis.n_rows, numRows);
+  BOOST_REQUIRE_GT(basis.n_cols, 1);
+
+  // Zero vectors come from centroids that were already spanned by the basis.
+  for (size_t i = 0; i < basis.n_cols; i++)
+  {
+    const double norm = arma::norm(basis.col(i), 2);
+    if (norm > 1e-5)
+      BOOST_REQUIRE_CLOSE(norm, 1.0, 1e-5);
+
+    for (size_t j = i + 1; j < basis.n_cols; j++)
+      BOOST_REQUIRE_SMALL(arma::dot(basis.col(i), basis.col(j)), 1e-5);
+  }
+
+  CosineTree root(data);
+  arma::vec cosines;
+  root.CalculateCosines(cosines);
+
+  BOOST_REQUIRE_EQUAL(cosines.n_elem, numCols);
+  for (size_t i = 0; i < numCols; i++)
+  {
+    BOOST_REQUIRE_CLOSE(cosines(i), std::abs(arma::norm_dot(
+        data.col(root.SplitPointIndex()), data.col(i))), 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -9,6 +9,8 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 
+#include <mlpack/core/cv/hyper_parameter_tuner.hpp>
+#include <mlpack/core/cv/k_fold_cv.hpp>
 #include <mlpack/core/cv/metrics/accuracy.hpp>
 #include <mlpack/core/cv/metrics/mse.hpp>
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
@@ -17,11 +19,13 @@
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/linear_regression/linear_regression.hpp>
 #include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+#include <mlpack/methods/naive_bayes/naive_bayes_classifier.hpp>
 
 #include <boost/test/unit_test.hpp>
 
 using namespace mlpack::ann;
 using namespace mlpack::cv;
+using namespace mlpack::naive_bayes;
 using namespace mlpack::optimization;
 using namespace mlpack::regression;
 
@@ -90,4 +94,139 @@ BOOST_AUTO_TEST_CASE(MSEMatResponsesTest)
   BOOST_REQUIRE_CLOSE(MSE::Evaluate(ffn, data, responses), expectedMSE, 1e-1);
 }
 
+/**
+ * Make sure that k-fold cross-validation of linear regression gives the same
+ * result as training a model on the complement of each fold by hand.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVLinearRegressionTest)
+{
+  const size_t n = 103;
+  const size_t k = 5;
+  arma::mat data = arma::randu<arma::mat>(3, n);
+  arma::rowvec responses = 2 * data.row(0) - data.row(2) + 0.5 +
+      0.1 * arma::randn<arma::rowvec>(n);
+
+  KFoldCV<LinearRegression, MSE, arma::mat, arma::rowvec> cv(k, data,
+      responses, false);
+
+  // Without shuffling, fold i holds the points [i n / k, (i + 1) n / k).
+  double expected = 0.0;
+  for (size_t i = 0; i < k; ++i)
+  {
+    const size_t begin = i * n / k;
+    const size_t end = (i + 1) * n / k;
+
+    arma::mat trainingData = data;
+    arma::rowvec trainingResponses = responses;
+    trainingData.shed_cols(begin, end - 1);
+    trainingResponses.shed_cols(begin, end - 1);
+
+    arma::mat foldData, cvTrainingData;
+    arma::rowvec foldResponses, cvTrainingResponses;
+    cv.Fold(i, foldData, foldResponses);
+    cv.TrainingSet(i, cvTrainingData, cvTrainingResponses);
+    BOOST_REQUIRE_EQUAL(foldData.n_cols, end - begin);
+    BOOST_REQUIRE_EQUAL(foldResponses.n_elem, end - begin);
+    BOOST_REQUIRE_EQUAL(cvTrainingData.n_cols, n - (end - begin));
+    BOOST_REQUIRE_EQUAL(cvTrainingResponses.n_elem, n - (end - begin));
+
+    const arma::mat testData = data.cols(begin, end - 1);
+    const arma::rowvec testResponses = responses.subvec(begin, end - 1);
+    LinearRegression lr(trainingData, trainingResponses, 0.1);
+    expected += MSE::Evaluate(lr, testData, testResponses);
+  }
+  expected /= k;
+
+  BOOST_REQUIRE_CLOSE(cv.Evaluate(0.1, true), expected, 1e-5);
+}
+
+/**
+ * Make sure that the shared statistics of the folds of naive Bayes give the
+ * same accuracy as models trained separately on the complement of each fold.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVNaiveBayesTest)
+{
+  const size_t n = 200;
+  const size_t k = 4;
+  arma::mat data = arma::randn<arma::mat>(2, n);
+  arma::Row<size_t> labels(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    labels[i] = i % 3;
+    data.col(i) += 1.5 * labels[i];
+  }
+
+  KFoldCV<NaiveBayesClassifier<>, Accuracy> cv(k, data, labels, false);
+
+  double expected = 0.0;
+  for (size_t i = 0; i < k; ++i)
+  {
+    const size_t begin = i * n / k;
+    const size_t end = (i + 1) * n / k;
+
+    arma::mat trainingData = data;
+    arma::Row<size_t> trainingLabels = labels;
+    trainingData.shed_cols(begin, end - 1);
+    trainingLabels.shed_cols(begin, end - 1);
+
+    const arma::mat testData = data.cols(begin, end - 1);
+    const arma::Row<size_t> testLabels = labels.subvec(begin, end - 1);
+    NaiveBayesClassifier<> nbc(trainingData, trainingLabels, 3);
+    expected += Accuracy::Evaluate(nbc, testData, testLabels);
+  }
+  expected /= k;
+
+  BOOST_REQUIRE_CLOSE(cv.Evaluate((size_t) 3), expected, 1e-5);
+}
+
+/**
+ * Make sure that invalid numbers of folds are rejected.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVInvalidKTest)
+{
+  arma::mat data = arma::randu<arma::mat>(2, 5);
+  arma::rowvec responses = arma::randu<arma::rowvec>(5);
+
+  typedef KFoldCV<LinearRegression, MSE, arma::mat, arma::rowvec> CVType;
+  BOOST_REQUIRE_THROW(CVType(1, data, responses), std::invalid_argument);
+  BOOST_REQUIRE_THROW(CVType(6, data, responses), std::invalid_argument);
+  BOOST_REQUIRE_THROW(CVType(2, data, responses.subvec(0, 3)),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that the hyper-parameter tuner finds the best point of a grid for
+ * linear regression on data with an offset.
+ */
+BOOST_AUTO_TEST_CASE(HyperParameterTunerTest)
+{
+  const size_t n = 100;
+  arma::mat data = arma::randu<arma::mat>(2, n);
+  arma::rowvec responses = 3 * data.row(0) + data.row(1) + 5 +
+      0.01 * arma::randn<arma::rowvec>(n);
+
+  HyperParameterTuner<LinearRegression, MSE, arma::mat, arma::rowvec>
+      tuner(5, data, responses, false);
+
+  double lambda;
+  bool intercept;
+  std::tie(lambda, intercept) = tuner.Optimize(
+      std::vector<double>({ 10.0, 0.0, 1.0 }),
+      std::vector<bool>({ false, true }));
+
+  BOOST_REQUIRE_EQUAL(lambda, 0.0);
+  BOOST_REQUIRE_EQUAL(intercept, true);
+
+  KFoldCV<LinearRegression, MSE, arma::mat, arma::rowvec> cv(5, data,
+      responses, false);
+  BOOST_REQUIRE_CLOSE(tuner.BestObjective(), cv.Evaluate(0.0, true), 1e-5);
+
+  // The best model is trained on the whole dataset.
+  BOOST_REQUIRE_EQUAL(tuner.BestModel().Intercept(), true);
+  BOOST_REQUIRE_CLOSE(tuner.BestModel().Parameters()[0], 5.0, 1.0);
+
+  BOOST_REQUIRE_THROW(tuner.Optimize(std::vector<double>(),
+      std::vector<bool>({ true })), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
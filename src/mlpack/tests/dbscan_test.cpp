@@ -11,6 +11,9 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/dbscan/dbscan.hpp>
+#include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/rectangle_tree.hpp>
+#include <queue>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -271,4 +274,202 @@ BOOST_AUTO_TEST_CASE(GaussiansSingleModeTest)
   }
 }
 
+/**
+ * Check the given core point clustering against the definition of DBSCAN,
+ * computed by brute force.
+ */
+void CheckCorePointClustering(const arma::mat& points,
+                              const double epsilon,
+                              const size_t minPoints,
+                              const arma::Row<size_t>& assignments,
+                              const size_t numClusters)
+{
+  const size_t n = points.n_cols;
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, n);
+
+  arma::Mat<size_t> neighbors(n, n, arma::fill::zeros);
+  arma::Col<size_t> counts(n, arma::fill::zeros);
+  for (size_t i = 0; i < n; ++i)
+  {
+    for (size_t j = 0; j < n; ++j)
+    {
+      if (arma::norm(points.col(i) - points.col(j)) <= epsilon)
+      {
+        neighbors(i, j) = 1;
+        ++counts[i];
+      }
+    }
+  }
+
+  // Find the clusters of core points with a breadth-first search.
+  arma::Col<size_t> components(n);
+  components.fill(SIZE_MAX);
+  size_t numComponents = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (counts[i] < minPoints || components[i] != SIZE_MAX)
+      continue;
+
+    std::queue<size_t> queue;
+    queue.push(i);
+    components[i] = numComponents;
+    while (!queue.empty())
+    {
+      const size_t p = queue.front();
+      queue.pop();
+      for (size_t j = 0; j < n; ++j)
+      {
+        if (neighbors(p, j) && counts[j] >= minPoints &&
+            components[j] == SIZE_MAX)
+        {
+          components[j] = numComponents;
+          queue.push(j);
+        }
+      }
+    }
+
+    ++numComponents;
+  }
+
+  BOOST_REQUIRE_EQUAL(numClusters, numComponents);
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (counts[i] >= minPoints)
+    {
+      // Core points are in the same cluster if and only if they are in the
+      // same component.
+      BOOST_REQUIRE_LT(assignments[i], numClusters);
+      for (size_t j = 0; j < n; ++j)
+      {
+        if (counts[j] >= minPoints)
+        {
+          BOOST_REQUIRE_EQUAL(assignments[i] == assignments[j],
+              components[i] == components[j]);
+        }
+      }
+    }
+    else
+    {
+      // Other points are in the cluster of a core neighbor, if there is one.
+      bool hasCoreNeighbor = false;
+      bool matchesCoreNeighbor = false;
+      for (size_t j = 0; j < n; ++j)
+      {
+        if (neighbors(i, j) && counts[j] >= minPoints)
+        {
+          hasCoreNeighbor = true;
+          if (assignments[j] == assignments[i])
+            matchesCoreNeighbor = true;
+        }
+      }
+
+      if (hasCoreNeighbor)
+        BOOST_REQUIRE(matchesCoreNeighbor);
+      else
+        BOOST_REQUIRE_EQUAL(assignments[i], SIZE_MAX);
+    }
+  }
+}
+
+/**
+ * Check that core point clustering follows the definition of DBSCAN, with
+ * naive, single-tree and dual-tree search and a few tree types.
+ */
+BOOST_AUTO_TEST_CASE(CorePointClusterTest)
+{
+  arma::mat points(2, 400, arma::fill::randu);
+  points.cols(200, 299) *= 0.2;
+  points.cols(300, 399) += 3.0;
+  points.col(7) = arma::vec("20.0 20.0");
+
+  const double epsilon = 0.08;
+  const size_t minPoints = 5;
+  arma::Row<size_t> assignments;
+
+  typedef range::RangeSearch<metric::EuclideanDistance, arma::mat,
+      tree::StandardCoverTree> CoverTreeRS;
+  typedef range::RangeSearch<metric::EuclideanDistance, arma::mat,
+      tree::RTree> RTreeRS;
+
+  DBSCAN<> naive(epsilon, minPoints, true, range::RangeSearch<>(true),
+      RandomPointSelection(), true);
+  size_t clusters = naive.Cluster(points, assignments);
+  CheckCorePointClustering(points, epsilon, minPoints, assignments, clusters);
+  BOOST_REQUIRE_EQUAL(assignments[7], SIZE_MAX);
+
+  DBSCAN<> single(epsilon, minPoints, true, range::RangeSearch<>(false, true),
+      RandomPointSelection(), true);
+  clusters = single.Cluster(points, assignments);
+  CheckCorePointClustering(points, epsilon, minPoints, assignments, clusters);
+
+  DBSCAN<> dual(epsilon, minPoints, true, range::RangeSearch<>(),
+      RandomPointSelection(), true);
+  clusters = dual.Cluster(points, assignments);
+  CheckCorePointClustering(points, epsilon, minPoints, assignments, clusters);
+
+  DBSCAN<CoverTreeRS> cover(epsilon, minPoints, true, CoverTreeRS(),
+      RandomPointSelection(), true);
+  clusters = cover.Cluster(points, assignments);
+  CheckCorePointClustering(points, epsilon, minPoints, assignments, clusters);
+
+  DBSCAN<RTreeRS> rTree(epsilon, minPoints, true, RTreeRS(),
+      RandomPointSelection(), true);
+  clusters = rTree.Cluster(points, assignments);
+  CheckCorePointClustering(points, epsilon, minPoints, assignments, clusters);
+}
+
+
+/**
+ * Make sure that DBSCAN on a shared tree finds the same clusters as DBSCAN on
+ * the points, in each search mode.
+ */
+BOOST_AUTO_TEST_CASE(SharedTreeClusterTest)
+{
+  arma::mat points(2, 400, arma::fill::randu);
+  points.cols(200, 299) *= 0.2;
+  points.cols(300, 399) += 3.0;
+  points.col(7) = arma::vec("20.0 20.0");
+
+  typedef range::RangeSearch<> RangeType;
+  tree::SharedTree<RangeType::Tree> tree(points);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    const bool singleMode = (mode == 1);
+    DBSCAN<> d(0.08, 5, true, RangeType(false, singleMode));
+    DBSCAN<> shared(0.08, 5, true, RangeType(false, singleMode));
+
+    arma::Row<size_t> assignments, sharedAssignments;
+    const size_t clusters = d.Cluster(points, assignments);
+    const size_t sharedClusters = shared.Cluster(tree, sharedAssignments);
+    BOOST_REQUIRE_EQUAL(tree.UseCount(), 2);
+
+    // The clusters may be numbered differently.
+    BOOST_REQUIRE_EQUAL(sharedClusters, clusters);
+    BOOST_REQUIRE_EQUAL(sharedAssignments.n_elem, points.n_cols);
+    BOOST_REQUIRE_EQUAL(sharedAssignments[7], SIZE_MAX);
+    std::vector<size_t> labels(clusters, SIZE_MAX);
+    for (size_t i = 0; i < points.n_cols; ++i)
+    {
+      if (assignments[i] == SIZE_MAX)
+      {
+        BOOST_REQUIRE_EQUAL(sharedAssignments[i], SIZE_MAX);
+        continue;
+      }
+
+      BOOST_REQUIRE_LT(sharedAssignments[i], clusters);
+      if (labels[assignments[i]] == SIZE_MAX)
+        labels[assignments[i]] = sharedAssignments[i];
+      BOOST_REQUIRE_EQUAL(sharedAssignments[i], labels[assignments[i]]);
+    }
+  }
+
+  // With the standard definition of core points.
+  DBSCAN<> core(0.08, 5, true, RangeType(), RandomPointSelection(), true);
+  arma::Row<size_t> assignments;
+  const size_t clusters = core.Cluster(tree, assignments);
+  CheckCorePointClustering(points, 0.08, 5, assignments, clusters);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -391,4 +391,43 @@ BOOST_AUTO_TEST_CASE(IntTest)
   BOOST_CHECK_EQUAL(predictedLabels(0, 7), 2);
 }
 
+/**
+ * Make sure that a stump trained from another stump on the same dataset, which
+ * uses the presorted dimensions of the other stump, is the same as one trained
+ * on a copy of the dataset and one trained directly.
+ */
+BOOST_AUTO_TEST_CASE(PresortedDimensionsTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 500);
+  arma::Row<size_t> labels(500);
+  for (size_t i = 0; i < 500; ++i)
+    labels[i] = (data(2, i) + 0.2 * data(4, i) > 0.6) ? 1 : 0;
+
+  // Some duplicate values, so that the sort must be stable.
+  data.row(3) = arma::floor(10 * data.row(3));
+
+  const arma::rowvec weights = arma::randu<arma::rowvec>(500);
+
+  DecisionStump<> ds(data, labels, 2, 10);
+  DecisionStump<> presorted(ds, data, labels, weights);
+
+  const arma::mat dataCopy(data);
+  DecisionStump<> sorted(ds, dataCopy, labels, weights);
+
+  DecisionStump<> direct;
+  direct.Train(data, labels, weights, 2, 10);
+
+  BOOST_REQUIRE_EQUAL(presorted.SplitDimension(), sorted.SplitDimension());
+  BOOST_REQUIRE_EQUAL(presorted.SplitDimension(), direct.SplitDimension());
+  BOOST_REQUIRE_EQUAL(presorted.Split().n_elem, sorted.Split().n_elem);
+  BOOST_REQUIRE_EQUAL(presorted.Split().n_elem, direct.Split().n_elem);
+  for (size_t i = 0; i < presorted.Split().n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(presorted.Split()[i], sorted.Split()[i]);
+    BOOST_REQUIRE_EQUAL(presorted.Split()[i], direct.Split()[i]);
+    BOOST_REQUIRE_EQUAL(presorted.BinLabels()[i], sorted.BinLabels()[i]);
+    BOOST_REQUIRE_EQUAL(presorted.BinLabels()[i], direct.BinLabels()[i]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -13,6 +13,7 @@
 #include <mlpack/methods/decision_tree/decision_tree.hpp>
 #include <mlpack/methods/decision_tree/information_gain.hpp>
 #include <mlpack/methods/decision_tree/gini_gain.hpp>
+#include <mlpack/methods/decision_tree/binned_binary_numeric_split.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -463,6 +464,106 @@ BOOST_AUTO_TEST_CASE(BestBinaryNumericSplitNoGainTest)
   BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 0);
 }
 
+/**
+ * Check that the BestBinaryNumericSplit finds the same split as a brute-force
+ * search that evaluates the gain of each child directly.
+ */
+BOOST_AUTO_TEST_CASE(BestBinaryNumericSplitBruteForceTest)
+{
+  // Use few distinct values, so that there are many ties.
+  arma::vec values = arma::floor(20 * arma::randu<arma::vec>(300));
+  arma::Row<size_t> labels(300);
+  arma::rowvec weights = arma::randu<arma::rowvec>(300);
+  for (size_t i = 0; i < 300; ++i)
+    labels[i] = (values[i] + 10 * math::Random() < 15) ? 0 :
+        math::RandInt(1, 3);
+
+  const arma::uvec order = arma::sort_index(values);
+  const arma::vec sortedValues = values(order);
+  const arma::Row<size_t> sortedLabels = labels.cols(order);
+  const arma::rowvec sortedWeights = weights.cols(order);
+
+  const double bestGain = GiniGain::Evaluate<false>(labels, 3, weights);
+  double bruteGain = bestGain;
+  double bruteWeightedGain = GiniGain::Evaluate<true>(labels, 3, weights);
+  const double weightedBestGain = bruteWeightedGain;
+  for (size_t i = 5; i <= 295; ++i)
+  {
+    if (sortedValues[i] == sortedValues[i - 1])
+      continue;
+
+    const double leftRatio = double(i) / 300.0;
+    const double gain = leftRatio * GiniGain::Evaluate<false>(
+        sortedLabels.subvec(0, i - 1), 3, weights) + (1.0 - leftRatio) *
+        GiniGain::Evaluate<false>(sortedLabels.subvec(i, 299), 3, weights);
+    bruteGain = std::max(bruteGain, gain);
+
+    const double leftWeight = arma::accu(sortedWeights.subvec(0, i - 1));
+    const double rightWeight = arma::accu(sortedWeights.subvec(i, 299));
+    const double weightedGain = (leftWeight * GiniGain::Evaluate<true>(
+        sortedLabels.subvec(0, i - 1), 3, sortedWeights.subvec(0, i - 1)) +
+        rightWeight * GiniGain::Evaluate<true>(sortedLabels.subvec(i, 299), 3,
+        sortedWeights.subvec(i, 299))) / (leftWeight + rightWeight);
+    bruteWeightedGain = std::max(bruteWeightedGain, weightedGain);
+  }
+
+  arma::vec classProbabilities;
+  BestBinaryNumericSplit<GiniGain>::template AuxiliarySplitInfo<double> aux;
+  const double gain = BestBinaryNumericSplit<GiniGain>::SplitIfBetter<false>(
+      bestGain, values, labels, 3, weights, 5, classProbabilities, aux);
+  const double weightedGain =
+      BestBinaryNumericSplit<GiniGain>::SplitIfBetter<true>(weightedBestGain,
+      values, labels, 3, weights, 5, classProbabilities, aux);
+
+  BOOST_REQUIRE_GT(bruteGain, bestGain);
+  BOOST_REQUIRE_CLOSE(gain, bruteGain, 1e-5);
+  BOOST_REQUIRE_CLOSE(weightedGain, bruteWeightedGain, 1e-5);
+}
+
+/**
+ * Check that the BinnedBinaryNumericSplit will split on an obviously splittable
+ * dimension, between the values of the two classes.
+ */
+BOOST_AUTO_TEST_CASE(BinnedBinaryNumericSplitSimpleSplitTest)
+{
+  arma::vec values("0.0 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9 1.0");
+  arma::Row<size_t> labels("0 0 0 0 0 1 1 1 1 1 1");
+  arma::rowvec weights(labels.n_elem);
+  weights.ones();
+
+  arma::vec classProbabilities;
+  HistogramBinaryNumericSplit<GiniGain>::template AuxiliarySplitInfo<double>
+      aux;
+
+  // Call the method to do the splitting.
+  const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+  const double gain = HistogramBinaryNumericSplit<GiniGain>::
+      SplitIfBetter<false>(bestGain, values, labels, 2, weights, 3,
+      classProbabilities, aux);
+  const double weightedGain = HistogramBinaryNumericSplit<GiniGain>::
+      SplitIfBetter<true>(bestGain, values, labels, 2, weights, 3,
+      classProbabilities, aux);
+
+  // The split is perfect, so we should be able to accomplish a gain of 0.
+  BOOST_REQUIRE_GT(gain, bestGain);
+  BOOST_REQUIRE_SMALL(gain, 1e-5);
+  BOOST_REQUIRE_SMALL(weightedGain, 1e-5);
+
+  // The split point should be between 0.4 and 0.5.
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 1);
+  BOOST_REQUIRE_GT(classProbabilities[0], 0.4);
+  BOOST_REQUIRE_LT(classProbabilities[0], 0.5);
+
+  // With only two bins, the only split is at the middle of the range.
+  const double twoBinGain = BinnedBinaryNumericSplit<GiniGain, 2>::
+      SplitIfBetter<false>(bestGain, values, labels, 2, weights, 3,
+      classProbabilities, aux);
+  BOOST_REQUIRE_GT(twoBinGain, bestGain);
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 1);
+  BOOST_REQUIRE_GT(classProbabilities[0], 0.4);
+  BOOST_REQUIRE_LT(classProbabilities[0], 0.6);
+}
+
 /**
  * Check that the AllCategoricalSplit will split when the split is obviously
  * better.
@@ -757,6 +858,78 @@ BOOST_AUTO_TEST_CASE(SimpleGeneralizationTest)
   BOOST_REQUIRE_GT(wdcorrect, 0.75);
 }
 
+/**
+ * Test that the decision tree generalizes reasonably with histogram splits.
+ */
+BOOST_AUTO_TEST_CASE(HistogramGeneralizationTest)
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  DecisionTree<GiniGain, HistogramBinaryNumericSplit> d(inputData, labels, 3,
+      10);
+
+  // Load testing data.
+  arma::mat testData;
+  if (!data::Load("vc2_test.csv", testData))
+    BOOST_FAIL("Cannot load test dataset vc2_test.csv!");
+
+  arma::Mat<size_t> trueTestLabels;
+  if (!data::Load("vc2_test_labels.txt", trueTestLabels))
+    BOOST_FAIL("Cannot load labels for vc2_test_labels.txt");
+
+  arma::Row<size_t> predictions;
+  d.Classify(testData, predictions);
+
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, testData.n_cols);
+
+  // Figure out the accuracy.
+  double correct = 0.0;
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    if (predictions[i] == trueTestLabels[i])
+      ++correct;
+  correct /= predictions.n_elem;
+
+  BOOST_REQUIRE_GT(correct, 0.70);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * The dimensions are searched in parallel, but the tree should not depend on
+ * the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(DecisionTreeMultithreadedTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 5000);
+  arma::Row<size_t> labels(5000);
+  for (size_t i = 0; i < 5000; ++i)
+    labels[i] = (dataset(2, i) + dataset(7, i) + 0.2 * math::Random() > 1.1) ?
+        1 : 0;
+
+  const int numThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  DecisionTree<> d1(dataset, labels, 2, 10);
+  omp_set_num_threads(4);
+  DecisionTree<> d4(dataset, labels, 2, 10);
+  omp_set_num_threads(numThreads);
+
+  arma::mat testData = arma::randu<arma::mat>(10, 1000);
+  arma::Row<size_t> predictions1, predictions4;
+  arma::mat probabilities1, probabilities4;
+  d1.Classify(testData, predictions1, probabilities1);
+  d4.Classify(testData, predictions4, probabilities4);
+
+  for (size_t i = 0; i < predictions1.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions1[i], predictions4[i]);
+  CheckMatrices(probabilities1, probabilities4);
+}
+#endif
+
 /**
  * Test that we can build a decision tree on a simple categorical dataset.
  */
@@ -1069,4 +1242,58 @@ BOOST_AUTO_TEST_CASE(CategoricalInformationGainWeightedBuildTest)
   BOOST_REQUIRE_GT(correctPct, 0.70);
 }
 
+/**
+ * Make sure that the flattened form of a decision tree classifies points the
+ * same way as the tree.
+ */
+template<typename TreeType>
+void CheckFrozenDecisionTree(const TreeType& tree, const arma::mat& data)
+{
+  FlatTree<> flat = tree.Freeze();
+
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::mat probabilities, flatProbabilities;
+  tree.Classify(data, predictions, probabilities);
+  flat.Classify(data, flatPredictions, flatProbabilities);
+
+  BOOST_REQUIRE_EQUAL(flatPredictions.n_elem, data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], flatPredictions[i]);
+  CheckMatrices(probabilities, flatProbabilities);
+}
+
+BOOST_AUTO_TEST_CASE(FrozenDecisionTreeTest)
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  arma::mat testData;
+  if (!data::Load("vc2_test.csv", testData))
+    BOOST_FAIL("Cannot load test dataset vc2_test.csv!");
+
+  DecisionTree<> d(inputData, labels, 3, 5);
+  CheckFrozenDecisionTree(d, testData);
+
+  DecisionTree<GiniGain, HistogramBinaryNumericSplit> h(inputData, labels, 3,
+      5);
+  CheckFrozenDecisionTree(h, testData);
+
+  // Also check a tree with categorical splits.
+  arma::mat c;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(c, l, di);
+  DecisionTree<> categoricalTree(c, di, l, 5, 10);
+  CheckFrozenDecisionTree(categoricalTree, c);
+
+  // A single leaf should work too.
+  DecisionTree<> leaf(inputData, labels, 3, inputData.n_cols);
+  CheckFrozenDecisionTree(leaf, testData);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -216,6 +216,54 @@ BOOST_AUTO_TEST_CASE(TestSparseSplitData)
   BOOST_REQUIRE_EQUAL(oTest[6], 7);
 }
 
+// Check that two trees have the same structure and splits.
+void CheckSameTree(const DTree<arma::mat>& a, const DTree<arma::mat>& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Start(), b.Start());
+  BOOST_REQUIRE_EQUAL(a.End(), b.End());
+  BOOST_REQUIRE_EQUAL(a.SubtreeLeaves(), b.SubtreeLeaves());
+  BOOST_REQUIRE_EQUAL(a.Left() == NULL, b.Left() == NULL);
+  if (a.Left() == NULL)
+    return;
+
+  BOOST_REQUIRE_EQUAL(a.SplitDim(), b.SplitDim());
+  BOOST_REQUIRE_EQUAL(a.SplitValue(), b.SplitValue());
+  CheckSameTree(*a.Left(), *b.Left());
+  CheckSameTree(*a.Right(), *b.Right());
+}
+
+/**
+ * Growing a tree from the presorted dimensions (in parallel, for a dataset
+ * large enough) must give the same tree as sorting the values at every node.
+ */
+BOOST_AUTO_TEST_CASE(TestPresortedGrow)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 20000);
+  // Add some duplicate values.
+  data.row(2) = arma::round(10 * data.row(2));
+  arma::mat unsortedData(data);
+
+  arma::Col<size_t> oldFromNew = arma::linspace<arma::Col<size_t>>(0,
+      data.n_cols - 1, data.n_cols);
+  arma::Col<size_t> unsortedOldFromNew(oldFromNew);
+
+  DTree<arma::mat> tree(data);
+  const double alpha = tree.Grow(data, oldFromNew, false, 10, 5);
+
+  // Grow the other tree without sorted values.
+  DTree<arma::mat> unsortedTree(unsortedData);
+  arma::mat sortedValues;
+  arma::Mat<size_t> sortedIds;
+  std::vector<char> goesLeft;
+  const double unsortedAlpha = unsortedTree.GrowNode(unsortedData,
+      unsortedOldFromNew, false, 10, 5, sortedValues, sortedIds, goesLeft);
+
+  BOOST_REQUIRE_CLOSE(alpha, unsortedAlpha, 1e-10);
+  CheckSameTree(tree, unsortedTree);
+  for (size_t i = 0; i < oldFromNew.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(oldFromNew[i], unsortedOldFromNew[i]);
+}
+
 #endif
 
 // Tests for the public functions.
@@ -453,6 +501,52 @@ BOOST_AUTO_TEST_CASE(TestSparseComputeValue)
   BOOST_REQUIRE_CLOSE(0.0, testDTree.ComputeValue(q4), 1e-10);
 }
 
+/**
+ * Make sure that the batched density estimates and leaf tags are the same as
+ * the ones computed one point at a time, including for points outside the
+ * range of the tree.
+ */
+BOOST_AUTO_TEST_CASE(TestComputeValues)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 1000);
+  arma::Col<size_t> oldFromNew = arma::linspace<arma::Col<size_t>>(0,
+      data.n_cols - 1, data.n_cols);
+
+  DTree<arma::mat> tree(data);
+  tree.Grow(data, oldFromNew, false, 10, 5);
+  tree.TagTree();
+
+  // Some of the query points are outside of the bounding box of the data.
+  arma::mat queries = 1.2 * arma::randu<arma::mat>(3, 500) - 0.1;
+
+  arma::rowvec densities;
+  tree.ComputeValues(queries, densities);
+
+  arma::rowvec taggedDensities;
+  arma::Row<int> tags;
+  tree.ComputeValues(queries, taggedDensities, tags);
+
+  BOOST_REQUIRE_EQUAL(densities.n_elem, queries.n_cols);
+  BOOST_REQUIRE_EQUAL(taggedDensities.n_elem, queries.n_cols);
+  BOOST_REQUIRE_EQUAL(tags.n_elem, queries.n_cols);
+  for (size_t i = 0; i < queries.n_cols; ++i)
+  {
+    const double density = tree.ComputeValue(queries.col(i));
+    if (density == 0.0)
+    {
+      BOOST_REQUIRE_SMALL(densities[i], 1e-10);
+      BOOST_REQUIRE_SMALL(taggedDensities[i], 1e-10);
+    }
+    else
+    {
+      BOOST_REQUIRE_CLOSE(densities[i], density, 1e-10);
+      BOOST_REQUIRE_CLOSE(taggedDensities[i], density, 1e-10);
+    }
+
+    BOOST_REQUIRE_EQUAL(tags[i], tree.FindBucket(queries.col(i)));
+  }
+}
+
 /**
  * These are not yet implemented.
  *
@@ -7,6 +7,8 @@
  *  * mlpack::distribution::DiscreteDistribution
  *  * mlpack::distribution::GaussianDistribution
  *  * mlpack::distribution::GammaDistribution
+ *  * mlpack::distribution::LaplaceDistribution
+ *  * mlpack::distribution::RegressionDistribution
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
  * terms of the 3-clause BSD license.  You should have received a copy of the
@@ -14,6 +16,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/core.hpp>
+#include <mlpack/core/dists/regression_distribution.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -167,6 +170,38 @@ BOOST_AUTO_TEST_CASE(MultiDiscreteDistributionTrainTest)
   BOOST_REQUIRE_CLOSE(d.Probability("2 1 0"), 0.05, 1e-5);
 }
 
+/**
+ * Make sure the batch Probability() and LogProbability() of a multidimensional
+ * discrete distribution match the ones of each observation.
+ */
+BOOST_AUTO_TEST_CASE(MultiDiscreteDistributionBatchProbabilityTest)
+{
+  std::vector<arma::vec> pro;
+  pro.push_back(arma::vec("0.1, 0.3, 0.6"));
+  pro.push_back(arma::vec("0.3, 0.3, 0.3"));
+  pro.push_back(arma::vec("0.25, 0.25, 0.5"));
+
+  DiscreteDistribution d(pro);
+
+  arma::mat observations(3, 50);
+  for (size_t i = 0; i < observations.n_elem; ++i)
+    observations[i] = RandInt(3);
+
+  arma::vec probabilities, logProbabilities;
+  d.Probability(observations, probabilities);
+  d.LogProbability(observations, logProbabilities);
+
+  BOOST_REQUIRE_EQUAL(probabilities.n_elem, observations.n_cols);
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, observations.n_cols);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    const arma::vec observation = observations.col(i);
+    BOOST_REQUIRE_CLOSE(probabilities[i], d.Probability(observation), 1e-5);
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], d.LogProbability(observation),
+        1e-5);
+  }
+}
+
 /**
  * Estimate multidimensional probability distribution from observations with
  * probabilities.
@@ -580,6 +615,71 @@ BOOST_AUTO_TEST_CASE(GaussianDistributionTrainWithTwoDistProbabilitiesTest)
   BOOST_REQUIRE_CLOSE(guDist.Covariance()[0], cov1[0], 5);
 }
 
+/**
+ * The log probabilities of a DiagonalGaussianDistribution are those of a
+ * GaussianDistribution with the diagonal covariance matrix.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianDistributionProbabilityTest)
+{
+  const arma::vec mean = arma::randn<arma::vec>(5);
+  const arma::vec variances = arma::randu<arma::vec>(5) + 0.5;
+  DiagonalGaussianDistribution diag(mean, variances);
+  GaussianDistribution full(mean, arma::diagmat(variances));
+
+  BOOST_REQUIRE_EQUAL(diag.Dimensionality(), 5);
+
+  const arma::mat points = 2.0 * arma::randn<arma::mat>(5, 100);
+  arma::vec logProbabilities, fullLogProbabilities;
+  diag.LogProbability(points, logProbabilities);
+  full.LogProbability(points, fullLogProbabilities);
+
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, 100);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], fullLogProbabilities[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(diag.LogProbability(points.col(i)),
+        fullLogProbabilities[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(diag.Probability(points.col(i)),
+        full.Probability(points.col(i)), 1e-5);
+  }
+}
+
+/**
+ * Training a DiagonalGaussianDistribution gives the diagonal of the covariance
+ * of a trained GaussianDistribution, with and without probabilities.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianDistributionTrainTest)
+{
+  arma::mat data = arma::randn<arma::mat>(4, 500);
+  data.row(1) *= 3.0;
+  data.row(2) += 2.0;
+  const arma::vec probabilities = arma::randu<arma::vec>(500);
+
+  DiagonalGaussianDistribution diag;
+  GaussianDistribution full;
+  diag.Train(data);
+  full.Train(data);
+  CheckMatrices(diag.Mean(), full.Mean(), 1e-5);
+  CheckMatrices(diag.Covariance(), arma::vec(full.Covariance().diag()), 1e-5);
+
+  diag.Train(data, probabilities);
+  full.Train(data, probabilities);
+  CheckMatrices(diag.Mean(), full.Mean(), 1e-5);
+  CheckMatrices(diag.Covariance(), arma::vec(full.Covariance().diag()), 1e-5);
+
+  // Random points follow the trained distribution.
+  arma::mat points(4, 20000);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    points.col(i) = diag.Random();
+  DiagonalGaussianDistribution estimate;
+  estimate.Train(points);
+  for (size_t d = 0; d < 4; ++d)
+  {
+    BOOST_REQUIRE_SMALL(estimate.Mean()[d] - diag.Mean()[d], 0.1);
+    BOOST_REQUIRE_CLOSE(estimate.Covariance()[d], diag.Covariance()[d], 5.0);
+  }
+}
+
 /******************************/
 /** Gamma Distribution Tests **/
 /******************************/
@@ -958,4 +1058,56 @@ BOOST_AUTO_TEST_CASE(GammaDistributionLogProbabilityTest)
   BOOST_REQUIRE_CLOSE(prob3(1), std::log(0.026165), 1e-3);
 }
 
+/*****************************************************/
+/** Laplace and Regression Distribution Batch Tests **/
+/*****************************************************/
+
+/**
+ * Make sure the batch LogProbability() of the Laplace distribution matches the
+ * one of each observation.
+ */
+BOOST_AUTO_TEST_CASE(LaplaceDistributionBatchProbabilityTest)
+{
+  LaplaceDistribution d(arma::vec("1.0 -2.0 0.5"), 1.5);
+  const arma::mat observations = arma::randn<arma::mat>(3, 50);
+
+  arma::vec probabilities, logProbabilities;
+  d.Probability(observations, probabilities);
+  d.LogProbability(observations, logProbabilities);
+
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    const arma::vec observation = observations.col(i);
+    BOOST_REQUIRE_CLOSE(probabilities[i], d.Probability(observation), 1e-5);
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], d.LogProbability(observation),
+        1e-5);
+  }
+}
+
+/**
+ * Make sure the batch Probability() and LogProbability() of the regression
+ * distribution match the ones of each observation.
+ */
+BOOST_AUTO_TEST_CASE(RegressionDistributionBatchProbabilityTest)
+{
+  const arma::mat predictors = arma::randn<arma::mat>(2, 100);
+  const arma::rowvec responses = 2.0 * predictors.row(0) - predictors.row(1) +
+      0.3 * arma::randn<arma::rowvec>(100);
+  RegressionDistribution d(predictors, responses);
+
+  // Each observation is the response followed by the predictors.
+  const arma::mat observations = arma::join_cols(responses, predictors);
+  arma::vec probabilities, logProbabilities;
+  d.Probability(observations, probabilities);
+  d.LogProbability(observations, logProbabilities);
+
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    const arma::vec observation = observations.col(i);
+    BOOST_REQUIRE_CLOSE(probabilities[i], d.Probability(observation), 1e-5);
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], d.LogProbability(observation),
+        1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
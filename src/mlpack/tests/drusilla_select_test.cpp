@@ -167,4 +167,28 @@ BOOST_AUTO_TEST_CASE(SparseTest)
   BOOST_REQUIRE_EQUAL(distances.n_rows, 3);
 }
 
+// Make sure that float tables give the exact result in the exhaustive case too,
+// on enough points and dimensions for the query blocks to use matrix products.
+BOOST_AUTO_TEST_CASE(DrusillaSelectFloatExhaustiveTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(20, 300);
+  arma::fmat floatDataset = arma::conv_to<arma::fmat>::from(dataset);
+
+  DrusillaSelect<arma::fmat> ds(floatDataset, 300, 1);
+
+  arma::mat distances, distancesTrue;
+  arma::Mat<size_t> neighbors, neighborsTrue;
+
+  ds.Search(floatDataset, 3, neighbors, distances);
+
+  AllkFN kfn(dataset);
+  kfn.Search(dataset, 3, neighborsTrue, distancesTrue);
+
+  BOOST_REQUIRE_EQUAL(distancesTrue.n_cols, distances.n_cols);
+  BOOST_REQUIRE_EQUAL(distancesTrue.n_rows, distances.n_rows);
+
+  for (size_t i = 0; i < distances.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(distances[i], distancesTrue[i], 1e-3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
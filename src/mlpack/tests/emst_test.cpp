@@ -278,4 +278,50 @@ BOOST_AUTO_TEST_CASE(BallTreeTest)
   }
 }
 
+#ifdef HAS_OPENMP
+/**
+ * The MST found with several threads must be the same as the one found
+ * naively, with both the dual-tree and the naive computation.
+ */
+BOOST_AUTO_TEST_CASE(MultithreadedTest)
+{
+  arma::mat inputData;
+  if (!data::Load("test_data_3_1000.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  const int numThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  DualTreeBoruvka<> serial(inputData, true);
+  arma::mat serialResults;
+  serial.ComputeMST(serialResults);
+
+  omp_set_num_threads(4);
+  DualTreeBoruvka<> naive(inputData, true);
+  DualTreeBoruvka<> dual(inputData);
+  DualTreeBoruvka<EuclideanDistance, arma::mat, BallTree> ball(inputData);
+  arma::mat naiveResults, dualResults, ballResults;
+  naive.ComputeMST(naiveResults);
+  dual.ComputeMST(dualResults);
+  ball.ComputeMST(ballResults);
+  omp_set_num_threads(numThreads);
+
+  BOOST_REQUIRE_EQUAL(naiveResults.n_cols, serialResults.n_cols);
+  BOOST_REQUIRE_EQUAL(dualResults.n_cols, serialResults.n_cols);
+  BOOST_REQUIRE_EQUAL(ballResults.n_cols, serialResults.n_cols);
+
+  for (size_t i = 0; i < serialResults.n_cols; i++)
+  {
+    BOOST_REQUIRE_EQUAL(naiveResults(0, i), serialResults(0, i));
+    BOOST_REQUIRE_EQUAL(naiveResults(1, i), serialResults(1, i));
+    BOOST_REQUIRE_CLOSE(naiveResults(2, i), serialResults(2, i), 1e-5);
+    BOOST_REQUIRE_EQUAL(dualResults(0, i), serialResults(0, i));
+    BOOST_REQUIRE_EQUAL(dualResults(1, i), serialResults(1, i));
+    BOOST_REQUIRE_CLOSE(dualResults(2, i), serialResults(2, i), 1e-5);
+    BOOST_REQUIRE_EQUAL(ballResults(0, i), serialResults(0, i));
+    BOOST_REQUIRE_EQUAL(ballResults(1, i), serialResults(1, i));
+    BOOST_REQUIRE_CLOSE(ballResults(2, i), serialResults(2, i), 1e-5);
+  }
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
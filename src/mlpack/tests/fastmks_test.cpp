@@ -225,6 +225,57 @@ BOOST_AUTO_TEST_CASE(EmptyConstructorTest)
       std::invalid_argument);
 }
 
+/**
+ * Make sure that dual-tree search gives the same results as naive search when
+ * the same query tree is used for several searches, and when the queries are
+ * answered in small batches against the same reference tree.
+ */
+BOOST_AUTO_TEST_CASE(RepeatedQueryBatchesTest)
+{
+  arma::mat referenceSet = arma::randn<arma::mat>(5, 1000);
+  arma::mat querySet = arma::randn<arma::mat>(5, 300);
+  LinearKernel lk;
+
+  FastMKS<LinearKernel> naive(referenceSet, lk, false, true);
+  arma::Mat<size_t> naiveIndices;
+  arma::mat naiveProducts;
+  naive.Search(querySet, 5, naiveIndices, naiveProducts);
+
+  FastMKS<LinearKernel> f(referenceSet, lk);
+  arma::Mat<size_t> indices;
+  arma::mat products;
+
+  // The second search starts with the bounds left in the tree by the first.
+  FastMKS<LinearKernel>::Tree queryTree(querySet);
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    f.Search(&queryTree, 5, indices, products);
+
+    for (size_t i = 0; i < products.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(indices[i], naiveIndices[i]);
+      BOOST_REQUIRE_CLOSE(products[i], naiveProducts[i], 1e-5);
+    }
+  }
+
+  for (size_t begin = 0; begin < querySet.n_cols; begin += 30)
+  {
+    const arma::mat batch = querySet.cols(begin, begin + 29);
+    f.Search(batch, 5, indices, products);
+
+    BOOST_REQUIRE_EQUAL(indices.n_cols, 30);
+    for (size_t q = 0; q < 30; ++q)
+    {
+      for (size_t j = 0; j < 5; ++j)
+      {
+        BOOST_REQUIRE_EQUAL(indices(j, q), naiveIndices(j, begin + q));
+        BOOST_REQUIRE_CLOSE(products(j, q), naiveProducts(j, begin + q),
+            1e-5);
+      }
+    }
+  }
+}
+
 // Make sure the simplest overload of Train() works.
 BOOST_AUTO_TEST_CASE(SimpleTrainTest)
 {
@@ -1082,4 +1133,54 @@ BOOST_AUTO_TEST_CASE(CopyAssignmentTest)
   }
 }
 
+/**
+ * Make sure that the self-kernels cached by the IPMetric while a cover tree is
+ * built give the same distances as the uncached metric, and that they are
+ * forgotten when the tree is destroyed.
+ */
+BOOST_AUTO_TEST_CASE(IPMetricSelfKernelCacheTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 300);
+
+  GaussianKernel kernel(0.8);
+  IPMetric<GaussianKernel> metric(kernel);
+  IPMetric<GaussianKernel> uncachedMetric(kernel);
+
+  {
+    CoverTree<IPMetric<GaussianKernel>, FastMKSStat> tree(dataset, metric);
+
+    BOOST_REQUIRE(metric.HasSelfKernels(dataset));
+    BOOST_REQUIRE_EQUAL(metric.SelfKernels().n_elem, dataset.n_cols);
+
+    for (size_t i = 0; i < dataset.n_cols; i += 7)
+    {
+      BOOST_REQUIRE_CLOSE(metric.SelfKernels()[i],
+          kernel.Evaluate(dataset.col(i), dataset.col(i)), 1e-5);
+
+      for (size_t j = 0; j < dataset.n_cols; j += 11)
+      {
+        const double cached = metric.Evaluate(dataset.col(i),
+            dataset.col(j));
+        const double uncached = uncachedMetric.Evaluate(dataset.col(i),
+            dataset.col(j));
+        if (std::abs(uncached) < 1e-8)
+          BOOST_REQUIRE_SMALL(cached, 1e-8);
+        else
+          BOOST_REQUIRE_CLOSE(cached, uncached, 1e-5);
+      }
+
+      // Points outside of the dataset must not be looked up in the cache.
+      const arma::vec point = dataset.col(i) + 0.5;
+      BOOST_REQUIRE_CLOSE(metric.Evaluate(point, dataset.col(i)),
+          uncachedMetric.Evaluate(point, dataset.col(i)), 1e-5);
+    }
+
+    // A copy of the metric does not take the cache.
+    IPMetric<GaussianKernel> copy(metric);
+    BOOST_REQUIRE(!copy.HasSelfKernels(dataset));
+  }
+
+  BOOST_REQUIRE(!metric.HasSelfKernels(dataset));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
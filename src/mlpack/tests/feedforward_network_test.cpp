@@ -12,9 +12,16 @@
  */
 #include <mlpack/core.hpp>
 
+#include <mlpack/core/optimizers/adam/adam.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/pruning.hpp>
+#include <mlpack/methods/ann/quantized_ffn.hpp>
+#include <mlpack/methods/ann/static_ffn.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -60,11 +67,13 @@ void BuildVanillaNetwork(MatType& trainData,
    * +-----+       +-----+
    */
 
-  FFN<NegativeLogLikelihood<> > model;
-  model.Add<Linear<> >(trainData.n_rows, hiddenLayerSize);
-  model.Add<SigmoidLayer<> >();
-  model.Add<Linear<> >(hiddenLayerSize, outputSize);
-  model.Add<LogSoftMax<> >();
+  FFN<NegativeLogLikelihood<MatType, MatType>, RandomInitialization, MatType>
+      model;
+  model.template Add<Linear<MatType, MatType> >(trainData.n_rows,
+      hiddenLayerSize);
+  model.template Add<SigmoidLayer<LogisticFunction, MatType, MatType> >();
+  model.template Add<Linear<MatType, MatType> >(hiddenLayerSize, outputSize);
+  model.template Add<LogSoftMax<MatType, MatType> >();
 
   RMSProp<decltype(model)> opt(model, 0.01, 0.88, 1e-8,
       maxEpochs * trainData.n_cols, -1);
@@ -152,6 +161,111 @@ BOOST_AUTO_TEST_CASE(VanillaNetworkTest)
       (dataset, labels, dataset, labels, 2, 10, 50, 0.2);
 }
 
+/**
+ * Train the vanilla network in single precision.
+ */
+BOOST_AUTO_TEST_CASE(FloatVanillaNetworkTest)
+{
+  // Load the dataset.
+  arma::fmat dataset;
+  data::Load("thyroid_train.csv", dataset, true);
+
+  arma::fmat trainData = dataset.submat(0, 0, dataset.n_rows - 4,
+      dataset.n_cols - 1);
+
+  arma::fmat trainLabelsTemp = dataset.submat(dataset.n_rows - 3, 0,
+      dataset.n_rows - 1, dataset.n_cols - 1);
+  arma::fmat trainLabels = arma::zeros<arma::fmat>(1, trainLabelsTemp.n_cols);
+  for (size_t i = 0; i < trainLabelsTemp.n_cols; ++i)
+  {
+    trainLabels(i) = arma::as_scalar(arma::find(
+        arma::max(trainLabelsTemp.col(i)) == trainLabelsTemp.col(i), 1)) + 1;
+  }
+
+  data::Load("thyroid_test.csv", dataset, true);
+
+  arma::fmat testData = dataset.submat(0, 0, dataset.n_rows - 4,
+      dataset.n_cols - 1);
+
+  arma::fmat testLabelsTemp = dataset.submat(dataset.n_rows - 3, 0,
+      dataset.n_rows - 1, dataset.n_cols - 1);
+
+  arma::fmat testLabels = arma::zeros<arma::fmat>(1, testLabelsTemp.n_cols);
+  for (size_t i = 0; i < testLabels.n_cols; ++i)
+  {
+    testLabels(i) = arma::as_scalar(arma::find(
+        arma::max(testLabelsTemp.col(i)) == testLabelsTemp.col(i), 1)) + 1;
+  }
+
+  BuildVanillaNetwork<arma::fmat>
+      (trainData, trainLabels, testData, testLabels, 3, 8, 70, 0.1);
+}
+
+/**
+ * Train a single precision network with the given optimizer on a problem that
+ * is separable along the first dimension, and return the classification error.
+ */
+template<typename ModelType, typename OptimizerType>
+double TrainFloatNetwork(ModelType& model,
+                         OptimizerType& optimizer,
+                         const arma::fmat& data,
+                         const arma::fmat& labels)
+{
+  model.Train(data, labels, optimizer);
+
+  arma::fmat predictions;
+  model.Predict(data, predictions);
+  BOOST_REQUIRE_EQUAL(predictions.n_cols, data.n_cols);
+
+  size_t errors = 0;
+  for (size_t i = 0; i < predictions.n_cols; ++i)
+  {
+    const size_t prediction = arma::as_scalar(arma::find(
+        arma::max(predictions.col(i)) == predictions.col(i), 1)) + 1;
+    if (prediction != (size_t) labels(i))
+      ++errors;
+  }
+
+  return double(errors) / data.n_cols;
+}
+
+/**
+ * Make sure single precision networks can be trained with SGD, RMSProp and
+ * Adam.
+ */
+BOOST_AUTO_TEST_CASE(FloatNetworkOptimizersTest)
+{
+  arma::fmat data = arma::randu<arma::fmat>(4, 200);
+  arma::fmat labels(1, 200);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    labels(i) = (data(0, i) > 0.5) ? 2 : 1;
+
+  typedef FFN<NegativeLogLikelihood<arma::fmat, arma::fmat>,
+      RandomInitialization, arma::fmat> FloatFFN;
+
+  FloatFFN sgdModel, rmspropModel, adamModel;
+  for (FloatFFN* model : { &sgdModel, &rmspropModel, &adamModel })
+  {
+    model->Add<Linear<arma::fmat, arma::fmat> >(4, 8);
+    model->Add<SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat> >();
+    model->Add<Linear<arma::fmat, arma::fmat> >(8, 2);
+    model->Add<LogSoftMax<arma::fmat, arma::fmat> >();
+  }
+
+  StandardSGD<FloatFFN> sgd(sgdModel, 0.1, 100 * data.n_cols, -1);
+  BOOST_REQUIRE_LE(TrainFloatNetwork(sgdModel, sgd, data, labels), 0.1);
+  BOOST_REQUIRE_EQUAL(sgdModel.Parameters().n_cols, 1);
+
+  RMSProp<FloatFFN> rmsprop(rmspropModel, 0.01, 0.88, 1e-8,
+      100 * data.n_cols, -1);
+  BOOST_REQUIRE_LE(TrainFloatNetwork(rmspropModel, rmsprop, data, labels),
+      0.1);
+
+  Adam<FloatFFN> adam(adamModel, 0.01, 0.9, 0.999, 1e-8, 100 * data.n_cols,
+      -1);
+  BOOST_REQUIRE_LE(TrainFloatNetwork(adamModel, adam, data, labels), 0.1);
+}
+
 /**
  * Train and evaluate a Dropout network with the specified structure.
  */
@@ -426,4 +540,442 @@ BOOST_AUTO_TEST_CASE(FFNMiscTest)
   movedModel = std::move(copiedModel);
 }
 
+/**
+ * Make sure that the batch overloads of Evaluate(), Gradient() and
+ * EvaluateWithGradient() give the sum of the objectives and gradients of the
+ * individual points.
+ */
+BOOST_AUTO_TEST_CASE(FFNBatchEvaluateGradientTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 20);
+  arma::mat labels = arma::zeros<arma::mat>(1, 20);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels(i) = (i % 3) + 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  double objective = 0;
+  arma::mat gradient, pointGradient;
+  for (size_t i = 4; i < 14; ++i)
+  {
+    objective += model.Evaluate(model.Parameters(), i);
+
+    model.Gradient(model.Parameters(), i, pointGradient);
+    if (gradient.is_empty())
+      gradient = pointGradient;
+    else
+      gradient += pointGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), 4, 10), objective,
+      1e-5);
+
+  arma::mat batchGradient;
+  model.Gradient(model.Parameters(), 4, batchGradient, 10);
+  CheckMatrices(gradient, batchGradient, 1e-5);
+
+  arma::mat fusedGradient;
+  BOOST_REQUIRE_CLOSE(model.EvaluateWithGradient(model.Parameters(), 4,
+      fusedGradient, 10), objective, 1e-5);
+  CheckMatrices(gradient, fusedGradient, 1e-5);
+}
+
+/**
+ * Make sure that a network with a final LogSoftMax module and the
+ * NegativeLogLikelihood output layer, whose loss and error are computed by the
+ * fused SoftMaxCrossEntropy layer, gives the same objective and gradient as a
+ * network that uses SoftMaxCrossEntropy as its output layer, and that it still
+ * predicts log-probabilities.
+ */
+BOOST_AUTO_TEST_CASE(FFNFusedLogSoftMaxTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 20);
+  arma::mat labels = arma::zeros<arma::mat>(1, 20);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels(i) = (i % 3) + 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  FFN<SoftMaxCrossEntropy<> > logitModel(data, labels);
+  logitModel.Add<Linear<> >(5, 8);
+  logitModel.Add<SigmoidLayer<> >();
+  logitModel.Add<Linear<> >(8, 3);
+  logitModel.ResetParameters();
+  logitModel.Parameters() = model.Parameters();
+
+  arma::mat gradient, logitGradient;
+  BOOST_REQUIRE_CLOSE(model.EvaluateWithGradient(model.Parameters(), 0,
+      gradient, 20), logitModel.EvaluateWithGradient(logitModel.Parameters(),
+      0, logitGradient, 20), 1e-5);
+  CheckMatrices(gradient, logitGradient, 1e-5);
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+  CheckMatrices(arma::sum(arma::exp(predictions)), arma::ones(1, 20), 1e-3);
+}
+
+/**
+ * Make sure that the quantized version of a network predicts about the same as
+ * the network, and that it can be saved and loaded.
+ */
+BOOST_AUTO_TEST_CASE(QuantizedFFNTest)
+{
+  arma::mat data = arma::randu<arma::mat>(10, 50);
+  arma::mat labels = arma::zeros<arma::mat>(1, 50);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels(i) = (i % 3) + 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(10, 20);
+  model.Add<SigmoidLayer<> >();
+  model.Add<LinearNoBias<> >(20, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+
+  QuantizedFFN<> quantized(model);
+  BOOST_REQUIRE_EQUAL(quantized.Layers().size(), 4);
+  BOOST_REQUIRE(!quantized.Layers()[0].IsEmpty());
+  BOOST_REQUIRE(quantized.Layers()[1].IsEmpty());
+  BOOST_REQUIRE(!quantized.Layers()[2].IsEmpty());
+  BOOST_REQUIRE(quantized.Layers()[3].IsEmpty());
+  BOOST_REQUIRE_EQUAL(quantized.Parameters().n_elem, 0);
+
+  arma::mat quantizedPredictions;
+  quantized.Predict(data, quantizedPredictions);
+  BOOST_REQUIRE_EQUAL(quantizedPredictions.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(quantizedPredictions.n_cols, 50);
+  BOOST_REQUIRE_LT(arma::abs(predictions - quantizedPredictions).max(), 0.05);
+
+  // Save the model, and load it into a network with the same modules.
+  BOOST_REQUIRE(data::Save("quantized_ffn_test.bin", "model", quantized));
+
+  QuantizedFFN<> loaded;
+  loaded.Add<Linear<> >(10, 20);
+  loaded.Add<SigmoidLayer<> >();
+  loaded.Add<LinearNoBias<> >(20, 3);
+  loaded.Add<LogSoftMax<> >();
+  BOOST_REQUIRE(data::Load("quantized_ffn_test.bin", "model", loaded));
+  remove("quantized_ffn_test.bin");
+
+  arma::mat loadedPredictions;
+  loaded.Predict(data, loadedPredictions, 7);
+  CheckMatrices(quantizedPredictions, loadedPredictions);
+}
+
+/**
+ * Make sure that pruning zeros the smallest weights of the Linear and
+ * LinearNoBias modules, that the sparse version of the pruned network predicts
+ * the same, and that training the sparse network keeps the pruned weights at
+ * zero.
+ */
+BOOST_AUTO_TEST_CASE(FFNPruningTest)
+{
+  arma::mat data = arma::randu<arma::mat>(10, 50);
+  arma::mat labels = arma::zeros<arma::mat>(1, 50);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels(i) = (data(0, i) > 0.5) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(10, 20);
+  model.Add<SigmoidLayer<> >();
+  model.Add<LinearNoBias<> >(20, 2);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+  const arma::mat parameters = model.Parameters();
+
+  BOOST_REQUIRE_EQUAL(PruneByMagnitude(model, 0.9), 180 + 36);
+
+  // The smallest weights of each module are zero, and the bias is unchanged.
+  const arma::mat weight(model.Parameters().memptr(), 20, 10);
+  const arma::mat originalWeight(parameters.memptr(), 20, 10);
+  BOOST_REQUIRE_EQUAL(arma::accu(weight == 0), 180);
+  const arma::uvec pruned = arma::find(weight == 0);
+  BOOST_REQUIRE_LE(arma::abs(originalWeight.elem(pruned)).max(),
+      arma::abs(weight.elem(arma::find(weight != 0))).min());
+  CheckMatrices(model.Parameters().rows(200, 219), parameters.rows(200, 219));
+  BOOST_REQUIRE_EQUAL(arma::accu(model.Parameters().rows(220, 259) == 0), 36);
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+
+  FFN<NegativeLogLikelihood<> > sparseModel(data, labels);
+  Sparsify(model, sparseModel);
+  BOOST_REQUIRE_EQUAL(sparseModel.Model().size(), 4);
+  BOOST_REQUIRE_EQUAL(sparseModel.Parameters().n_elem, 20 + 20 + 4);
+
+  arma::mat sparsePredictions;
+  sparseModel.Predict(data, sparsePredictions);
+  CheckMatrices(predictions, sparsePredictions, 1e-5);
+
+  // Fine-tune a sparse network; it starts from the pruned weights, and the
+  // pruned weights stay zero.
+  FFN<NegativeLogLikelihood<> > tunedModel(data, labels);
+  Sparsify(model, tunedModel);
+  RMSProp<decltype(tunedModel)> tinyOpt(tunedModel, 1e-10, 0.99, 1e-8, 10,
+      -1);
+  tunedModel.Train(data, labels, tinyOpt);
+  CheckMatrices(tunedModel.Parameters(), sparseModel.Parameters(), 1e-3);
+
+  RMSProp<decltype(tunedModel)> opt(tunedModel, 0.01, 0.99, 1e-8, 500, -1);
+  tunedModel.Train(data, labels, opt);
+  BOOST_REQUIRE_LT(tunedModel.Evaluate(tunedModel.Parameters(), 0, 50),
+      sparseModel.Evaluate(sparseModel.Parameters(), 0, 50));
+
+  const SparseLinear<>& layer =
+      *boost::get<SparseLinear<>*>(tunedModel.Model()[0]);
+  BOOST_REQUIRE_EQUAL(layer.NonZeros(), 20);
+  const arma::mat tunedWeight(layer.Weight());
+  BOOST_REQUIRE_EQUAL(arma::accu(tunedWeight.elem(pruned) != 0), 0);
+}
+
+/**
+ * Make sure that the sparse gradient of a network with a Lookup module is the
+ * same as the dense gradient, that it only holds the used embedding, and that
+ * training with it leaves the unused embeddings alone.
+ */
+BOOST_AUTO_TEST_CASE(FFNSparseLookupGradientTest)
+{
+  // Each point is one token out of 50; only the first 30 tokens are used.
+  arma::mat data(1, 100);
+  arma::mat labels(1, 100);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    data(i) = (i % 30) + 1;
+    labels(i) = (i % 30 < 15) ? 1 : 2;
+  }
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Lookup<> >(50, 4);
+  model.Add<Linear<> >(4, 2);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+  BOOST_REQUIRE(model.UseSparseGradient());
+
+  arma::mat gradient;
+  arma::sp_mat sparseGradient;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    model.Gradient(model.Parameters(), i, gradient);
+    model.Gradient(model.Parameters(), i, sparseGradient);
+
+    // One embedding and the parameters of the Linear module.
+    BOOST_REQUIRE_EQUAL(sparseGradient.n_nonzero, 4 + 4 * 2 + 2);
+    CheckMatrices(gradient, arma::mat(sparseGradient), 1e-5);
+  }
+
+  const arma::mat parameters = model.Parameters();
+  RMSProp<decltype(model)> opt(model, 0.01, 0.99, 1e-8, 500, -1);
+  model.Train(data, labels, opt);
+
+  // The embeddings of the unused tokens (the columns of the Lookup weights)
+  // didn't change.
+  const arma::mat embeddings(parameters.memptr(), 4, 50);
+  const arma::mat trainedEmbeddings(model.Parameters().memptr(), 4, 50);
+  CheckMatrices(embeddings.cols(30, 49), trainedEmbeddings.cols(30, 49));
+  BOOST_REQUIRE_GT(arma::accu(arma::abs(embeddings.cols(0, 29) -
+      trainedEmbeddings.cols(0, 29))), 0.0);
+}
+
+/**
+ * Make sure that batched predictions are the same as predictions of one point
+ * at a time, also when the last batch is smaller and when the results matrix
+ * is reused.
+ */
+BOOST_AUTO_TEST_CASE(FFNBatchPredictTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 50);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  arma::mat predictions;
+  model.Predict(data, predictions, 1);
+  BOOST_REQUIRE_EQUAL(predictions.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(predictions.n_cols, 50);
+
+  arma::mat batchPredictions;
+  model.Predict(data, batchPredictions, 7);
+  CheckMatrices(predictions, batchPredictions);
+
+  model.Predict(data, batchPredictions);
+  CheckMatrices(predictions, batchPredictions);
+
+  // Predict a subset of the points with the same results matrix.
+  arma::mat subset = data.cols(10, 19);
+  model.Predict(subset, batchPredictions, 4);
+  CheckMatrices(predictions.cols(10, 19), batchPredictions);
+}
+
+/**
+ * Make sure that synchronous data-parallel SGD gives the same model as
+ * mini-batch SGD with the same batches, and that asynchronous (Hogwild)
+ * training also learns the problem.
+ */
+BOOST_AUTO_TEST_CASE(FFNParallelSGDTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 200);
+  arma::mat labels(1, 200);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    labels(i) = (data(0, i) > 0.5) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(4, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+
+  // Initialize the parameters, so that all the copies start from the same
+  // point.
+  model.Evaluate(model.Parameters(), 0);
+  FFN<NegativeLogLikelihood<> > parallelModel(model);
+  FFN<NegativeLogLikelihood<> > hogwildModel(model);
+
+  // Mini-batch SGD processes one batch less than the maximum number of
+  // iterations.
+  MiniBatchSGD<decltype(model)> sgd(model, 20, 0.5, 501, -1, false);
+  model.Train(data, labels, sgd);
+
+  ParallelSGD<decltype(parallelModel)> parallelSGD(parallelModel, 20, 0.5,
+      500, -1, false, false, 4);
+  parallelModel.Train(data, labels, parallelSGD);
+  CheckMatrices(model.Parameters(), parallelModel.Parameters(), 1e-4);
+
+  ParallelSGD<decltype(hogwildModel)> hogwildSGD(hogwildModel, 20, 0.5, 2000,
+      -1, true, true, 4);
+  hogwildModel.Train(data, labels, hogwildSGD);
+
+  arma::mat predictions;
+  hogwildModel.Predict(data, predictions);
+  size_t errors = 0;
+  for (size_t i = 0; i < predictions.n_cols; ++i)
+  {
+    const size_t prediction = arma::as_scalar(arma::find(
+        arma::max(predictions.col(i)) == predictions.col(i), 1)) + 1;
+    if (prediction != (size_t) labels(i))
+      ++errors;
+  }
+
+  BOOST_REQUIRE_LE(double(errors) / data.n_cols, 0.1);
+}
+
+/**
+ * Make sure that training from a prefetcher gives the same model as training
+ * on the matrices with the same mini-batches.
+ */
+BOOST_AUTO_TEST_CASE(FFNBatchPrefetcherTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 200);
+  arma::mat labels(1, 200);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    labels(i) = (data(0, i) > 0.5) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(4, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+
+  // Initialize the parameters, so that both models start from the same point.
+  model.Evaluate(model.Parameters(), 0);
+  FFN<NegativeLogLikelihood<> > streamModel(model);
+
+  // Mini-batch SGD processes one batch less than the maximum number of
+  // iterations.
+  MiniBatchSGD<decltype(model)> sgd(model, 20, 0.5, 201, -1, false);
+  model.Train(data, labels, sgd);
+
+  // Shards of 100 points give the same mini-batches of 20 points.
+  data::MatrixBatchSource<> source(data, labels, 100);
+  data::BatchPrefetcher<data::MatrixBatchSource<>> batches(source, 20, false);
+  MiniBatchSGD<decltype(streamModel)> streamSGD(streamModel, 20, 0.5, 200, -1,
+      false);
+  streamModel.Train(batches, streamSGD);
+
+  CheckMatrices(model.Parameters(), streamModel.Parameters(), 1e-6);
+}
+
+/**
+ * Make sure that a StaticFFN gives the same objective, gradient and predictions
+ * as an FFN with the same layers and parameters, and that it can be trained.
+ */
+BOOST_AUTO_TEST_CASE(StaticFFNTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 200);
+  arma::mat labels(1, 200);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    labels(i) = (data(0, i) > 0.5) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(4, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  typedef StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > StaticModelType;
+  StaticModelType staticModel(Linear<>(4, 8), SigmoidLayer<>(),
+      Linear<>(8, 2), LogSoftMax<>());
+
+  // Train for no iterations, to set the data and initialize the parameters.
+  // The parameters have the same layout as those of the FFN.
+  StandardSGD<StaticModelType> sgd(staticModel, 0.01, 1);
+  staticModel.Train(data, labels, sgd);
+  BOOST_REQUIRE_EQUAL(staticModel.Parameters().n_elem,
+      model.Parameters().n_elem);
+  staticModel.Parameters() = model.Parameters();
+
+  BOOST_REQUIRE_CLOSE(staticModel.Evaluate(staticModel.Parameters(), 0, 50),
+      model.Evaluate(model.Parameters(), 0, 50), 1e-5);
+
+  arma::mat gradient, staticGradient;
+  model.Gradient(model.Parameters(), 10, gradient, 20);
+  staticModel.Gradient(staticModel.Parameters(), 10, staticGradient, 20);
+  CheckMatrices(gradient, staticGradient, 1e-5);
+
+  arma::mat predictions, staticPredictions;
+  model.Predict(data, predictions);
+  staticModel.Predict(data, staticPredictions, 64);
+  CheckMatrices(predictions, staticPredictions, 1e-5);
+
+  // A copy uses its own parameters.
+  StaticModelType copiedModel(staticModel);
+  copiedModel.Parameters().zeros();
+  staticModel.Predict(data, staticPredictions, 64);
+  CheckMatrices(predictions, staticPredictions, 1e-5);
+
+  RMSProp<StaticModelType> opt(copiedModel, 0.01, 0.88, 1e-8,
+      100 * data.n_cols, -1);
+  copiedModel.Train(data, labels, opt);
+  copiedModel.Predict(data, staticPredictions);
+
+  size_t errors = 0;
+  for (size_t i = 0; i < staticPredictions.n_cols; ++i)
+  {
+    const size_t prediction = arma::as_scalar(arma::find(
+        arma::max(staticPredictions.col(i)) == staticPredictions.col(i), 1)) +
+        1;
+    if (prediction != (size_t) labels(i))
+      ++errors;
+  }
+
+  BOOST_REQUIRE_LE(double(errors) / data.n_cols, 0.1);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -13,6 +13,8 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/methods/gmm/diagonal_gmm.hpp>
+#include <mlpack/methods/gmm/online_em_fit.hpp>
 
 #include <mlpack/methods/gmm/no_constraint.hpp>
 #include <mlpack/methods/gmm/positive_definite_constraint.hpp>
@@ -78,6 +80,59 @@ BOOST_AUTO_TEST_CASE(GMMProbabilityComponentTest)
   BOOST_REQUIRE_CLOSE(gmm.Probability("1.4 0", 1), 0.0067568972024, 1e-5);
 }
 
+/**
+ * Test the batched GMM::Probability() and GMM::LogProbability() against the
+ * probability of each observation, and make sure that the log probability of
+ * an observation far from every component does not underflow.
+ */
+BOOST_AUTO_TEST_CASE(GMMBatchProbabilityTest)
+{
+  // Create a GMM (same as the last test).
+  GMM gmm(2, 2);
+  gmm.Component(0) = distribution::GaussianDistribution("0 0", "1 0; 0 1");
+  gmm.Component(1) = distribution::GaussianDistribution("3 3", "2 1; 1 2");
+  gmm.Weights() = "0.3 0.7";
+
+  // Enough observations for several blocks.
+  arma::mat observations = 4 * arma::randn<arma::mat>(2, 3000);
+  observations.col(0) = arma::vec("200 -200");
+
+  arma::vec probabilities, logProbabilities;
+  gmm.Probability(observations, probabilities);
+  gmm.LogProbability(observations, logProbabilities);
+
+  BOOST_REQUIRE_EQUAL(probabilities.n_elem, observations.n_cols);
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, observations.n_cols);
+  for (size_t i = 1; i < observations.n_cols; ++i)
+  {
+    const double probability = gmm.Probability(observations.col(i));
+    BOOST_REQUIRE_CLOSE(probabilities[i], probability, 1e-5);
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], std::log(probability), 1e-5);
+  }
+
+  // The probability underflows, but not the log probability.  For the first
+  // component, the Mahalanobis term is 200^2 + 200^2; for the second, with
+  // x = (197, -203) and C^-1 = [2 -1; -1 2] / 3, it is x^T C^-1 x.
+  BOOST_REQUIRE_SMALL(probabilities[0], 1e-300);
+  const double logProb0 = std::log(0.3) - std::log(2 * M_PI) - 0.5 * 80000.0;
+  const double logProb1 = std::log(0.7) - std::log(2 * M_PI) -
+      0.5 * std::log(3.0) - 0.5 * (2 * 197.0 * 197.0 + 2 * 197.0 * 203.0 +
+      2 * 203.0 * 203.0) / 3.0;
+  BOOST_REQUIRE_CLOSE(logProbabilities[0], logProb0 +
+      std::log(1 + std::exp(logProb1 - logProb0)), 1e-5);
+
+  // Classify() should choose the most probable component.
+  arma::Row<size_t> labels;
+  gmm.Classify(observations, labels);
+  for (size_t i = 1; i < observations.n_cols; ++i)
+  {
+    const size_t label = (gmm.Probability(observations.col(i), 0) >
+        gmm.Probability(observations.col(i), 1)) ? 0 : 1;
+    BOOST_REQUIRE_EQUAL(labels[i], label);
+  }
+  BOOST_REQUIRE_EQUAL(labels[0], 0);
+}
+
 /**
  * Test training a model on only one Gaussian (randomly generated) in two
  * dimensions.  We will vary the dataset size from small to large.  The EM
@@ -760,5 +815,315 @@ BOOST_AUTO_TEST_CASE(UseExistingModelTest)
   }
 }
 
+/**
+ * Generate a dataset from two well-separated Gaussians in two dimensions, with
+ * weights 0.3 and 0.7.
+ */
+void GenerateOnlineEMData(arma::mat& data,
+                          std::vector<arma::vec>& means,
+                          std::vector<arma::mat>& covariances)
+{
+  data.set_size(2, 20000);
+  data.cols(0, 5999) = arma::randn<arma::mat>(2, 6000);
+  data.cols(6000, 19999) = 2.0 * arma::randn<arma::mat>(2, 14000);
+  data.submat(0, 6000, 0, 19999) += 20.0;
+  data.submat(1, 6000, 1, 19999) += 12.0;
+
+  means.resize(2);
+  covariances.resize(2);
+  means[0] = arma::mean(data.cols(0, 5999), 1);
+  means[1] = arma::mean(data.cols(6000, 19999), 1);
+  covariances[0] = ccov(data.cols(0, 5999), 1 /* biased */);
+  covariances[1] = ccov(data.cols(6000, 19999), 1 /* biased */);
+
+  data = arma::shuffle(data, 1);
+}
+
+/**
+ * Make sure the online EM fitter finds the Gaussians when used by
+ * GMM::Train().
+ */
+BOOST_AUTO_TEST_CASE(OnlineEMFitTrainTest)
+{
+  arma::mat data;
+  std::vector<arma::vec> means;
+  std::vector<arma::mat> covariances;
+  GenerateOnlineEMData(data, means, covariances);
+
+  GMM gmm(2, 2);
+  OnlineEMFit<> fitter(500, 5);
+  gmm.Train(data, 1, false, fitter);
+
+  arma::uvec sortTry = sort_index(gmm.Weights());
+  BOOST_REQUIRE_SMALL(gmm.Weights()[sortTry[0]] - 0.3, 0.02);
+  BOOST_REQUIRE_SMALL(gmm.Weights()[sortTry[1]] - 0.7, 0.02);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    for (size_t j = 0; j < 2; ++j)
+    {
+      BOOST_REQUIRE_SMALL(gmm.Component(sortTry[i]).Mean()[j] - means[i][j],
+          0.15);
+      for (size_t k = 0; k < 2; ++k)
+        BOOST_REQUIRE_SMALL(gmm.Component(sortTry[i]).Covariance()(j, k) -
+            covariances[i](j, k), 0.3 * (i + 1) * (i + 1));
+    }
+  }
+}
+
+/**
+ * Feed mini-batches to the online EM fitter one by one, with the diagonal
+ * constraint; the covariances must stay diagonal.
+ */
+BOOST_AUTO_TEST_CASE(OnlineEMFitStepTest)
+{
+  arma::mat data;
+  std::vector<arma::vec> means;
+  std::vector<arma::mat> covariances;
+  GenerateOnlineEMData(data, means, covariances);
+
+  OnlineEMFit<kmeans::KMeans<>, DiagonalConstraint> fitter;
+  std::vector<distribution::GaussianDistribution> dists(2,
+      distribution::GaussianDistribution(2));
+  arma::vec weights(2);
+  fitter.Initialize(data.cols(0, 999), dists, weights);
+  BOOST_REQUIRE_EQUAL(fitter.Steps(), 0);
+
+  for (size_t pass = 0; pass < 3; ++pass)
+    for (size_t begin = 0; begin < data.n_cols; begin += 1000)
+      fitter.Step(data.cols(begin, begin + 999), dists, weights);
+  BOOST_REQUIRE_EQUAL(fitter.Steps(), 60);
+
+  arma::uvec sortTry = sort_index(weights);
+  BOOST_REQUIRE_SMALL(weights[sortTry[0]] - 0.3, 0.02);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_SMALL(dists[sortTry[i]].Covariance()(0, 1), 1e-10);
+    BOOST_REQUIRE_SMALL(dists[sortTry[i]].Covariance()(1, 0), 1e-10);
+    for (size_t j = 0; j < 2; ++j)
+    {
+      BOOST_REQUIRE_SMALL(dists[sortTry[i]].Mean()[j] - means[i][j], 0.15);
+      BOOST_REQUIRE_SMALL(dists[sortTry[i]].Covariance()(j, j) -
+          covariances[i](j, j), 0.3 * (i + 1) * (i + 1));
+    }
+  }
+}
+
+/**
+ * Make sure invalid parameters are rejected.
+ */
+BOOST_AUTO_TEST_CASE(OnlineEMFitInvalidParametersTest)
+{
+  BOOST_REQUIRE_THROW(OnlineEMFit<>(0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(OnlineEMFit<>(100, 10, 1e-5, 0.5), std::invalid_argument);
+  BOOST_REQUIRE_THROW(OnlineEMFit<>(100, 10, 1e-5, 1.1), std::invalid_argument);
+  BOOST_REQUIRE_THROW(OnlineEMFit<>(100, 10, 1e-5, 0.6, -1.0),
+      std::invalid_argument);
+
+  OnlineEMFit<> fitter;
+  std::vector<distribution::GaussianDistribution> dists(2,
+      distribution::GaussianDistribution(3));
+  arma::vec weights("0.5 0.5");
+  BOOST_REQUIRE_THROW(fitter.Step(arma::randu<arma::mat>(2, 10), dists,
+      weights), std::invalid_argument);
+  BOOST_REQUIRE_THROW(fitter.Step(arma::randu<arma::mat>(3, 10),
+      arma::randu<arma::vec>(5), dists, weights), std::invalid_argument);
+}
+
+/**
+ * Fitting the diagonal components of a DiagonalGMM with EM gives the same model
+ * as fitting full components with the DiagonalConstraint.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalEMFitTest)
+{
+  arma::mat data(4, 2000);
+  data.cols(0, 999) = arma::randn<arma::mat>(4, 1000);
+  data.cols(1000, 1999) = 2.0 * arma::randn<arma::mat>(4, 1000) + 5.0;
+
+  std::vector<distribution::GaussianDistribution> dists(2,
+      distribution::GaussianDistribution(4));
+  std::vector<distribution::DiagonalGaussianDistribution> diagDists(2,
+      distribution::DiagonalGaussianDistribution(4));
+  for (size_t i = 0; i < 2; ++i)
+  {
+    dists[i].Mean().fill(4.0 * i + 0.5);
+    diagDists[i].Mean().fill(4.0 * i + 0.5);
+  }
+  arma::vec weights("0.5 0.5");
+  arma::vec diagWeights(weights);
+
+  EMFit<kmeans::KMeans<>, DiagonalConstraint> em(50, 1e-10);
+  em.Estimate(data, dists, weights, true);
+  DiagonalEMFit diagEM(50, 1e-10);
+  diagEM.Estimate(data, diagDists, diagWeights, true);
+
+  CheckMatrices(diagWeights, weights, 1e-5);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    CheckMatrices(diagDists[i].Mean(), dists[i].Mean(), 1e-5);
+    CheckMatrices(diagDists[i].Covariance(),
+        arma::vec(dists[i].Covariance().diag()), 1e-5);
+  }
+
+  // The probabilities of the models are the same too.
+  GMM gmm(dists, weights);
+  DiagonalGMM diagGMM(diagDists, diagWeights);
+  arma::vec logProbabilities, diagLogProbabilities;
+  gmm.LogProbability(data, logProbabilities);
+  diagGMM.LogProbability(data, diagLogProbabilities);
+  CheckMatrices(diagLogProbabilities, logProbabilities, 1e-5);
+
+  arma::Row<size_t> labels, diagLabels;
+  gmm.Classify(data, labels);
+  diagGMM.Classify(data, diagLabels);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(diagLabels[i], labels[i]);
+}
+
+/**
+ * A DiagonalGMM trained from scratch recovers the components of the data.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMTrainTest)
+{
+  arma::mat data(3, 4000);
+  data.cols(0, 1999) = arma::randn<arma::mat>(3, 2000);
+  data.cols(2000, 3999) = arma::diagmat(arma::vec("2.0 0.5 1.0")) *
+      arma::randn<arma::mat>(3, 2000) + 10.0;
+
+  DiagonalGMM gmm(2, 3);
+  gmm.Train(data, 3);
+
+  // Find which component is which.
+  const size_t first = (gmm.Component(0).Mean()[0] < 5.0) ? 0 : 1;
+  const size_t second = 1 - first;
+
+  for (size_t d = 0; d < 3; ++d)
+  {
+    BOOST_REQUIRE_SMALL(gmm.Component(first).Mean()[d], 0.15);
+    BOOST_REQUIRE_CLOSE(gmm.Component(second).Mean()[d], 10.0, 2.0);
+    BOOST_REQUIRE_CLOSE(gmm.Component(first).Covariance()[d], 1.0, 10.0);
+  }
+  BOOST_REQUIRE_CLOSE(gmm.Component(second).Covariance()[0], 4.0, 10.0);
+  BOOST_REQUIRE_CLOSE(gmm.Component(second).Covariance()[1], 0.25, 10.0);
+  BOOST_REQUIRE_CLOSE(gmm.Component(second).Covariance()[2], 1.0, 10.0);
+  BOOST_REQUIRE_CLOSE(gmm.Weights()[first], 0.5, 5.0);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Training with several threads must give the same model as training with one
+ * thread, with and without probabilities.  The dataset is large enough to be
+ * split into several blocks.
+ */
+BOOST_AUTO_TEST_CASE(EMFitMultithreadedTest)
+{
+  arma::mat data(3, 5000);
+  data.cols(0, 2499) = arma::randn<arma::mat>(3, 2500);
+  data.cols(2500, 4999) = arma::randn<arma::mat>(3, 2500) + 5.0;
+  arma::vec probabilities = arma::randu<arma::vec>(5000);
+
+  std::vector<distribution::GaussianDistribution> initialDists(2,
+      distribution::GaussianDistribution(3));
+  initialDists[0].Mean().fill(1.0);
+  initialDists[1].Mean().fill(4.0);
+  arma::vec initialWeights("0.5 0.5");
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    EMFit<> em(50, 1e-10);
+    std::vector<distribution::GaussianDistribution> serialDists(initialDists);
+    std::vector<distribution::GaussianDistribution> dists(initialDists);
+    arma::vec serialWeights(initialWeights);
+    arma::vec weights(initialWeights);
+
+    const int numThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    if (trial == 0)
+      em.Estimate(data, serialDists, serialWeights, true);
+    else
+      em.Estimate(data, probabilities, serialDists, serialWeights, true);
+    omp_set_num_threads(4);
+    if (trial == 0)
+      em.Estimate(data, dists, weights, true);
+    else
+      em.Estimate(data, probabilities, dists, weights, true);
+    omp_set_num_threads(numThreads);
+
+    CheckMatrices(weights, serialWeights, 1e-5);
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      CheckMatrices(dists[i].Mean(), serialDists[i].Mean(), 1e-5);
+      CheckMatrices(dists[i].Covariance(), serialDists[i].Covariance(), 1e-5);
+    }
+  }
+}
+
+/**
+ * Fitting a GMM to shards of the observations gives the same model as fitting
+ * it to all of the observations.
+ */
+BOOST_AUTO_TEST_CASE(EMFitShardedTest)
+{
+  arma::mat data(3, 3000);
+  data.cols(0, 1499) = arma::randn<arma::mat>(3, 1500);
+  data.cols(1500, 2999) = arma::randn<arma::mat>(3, 1500) + 5.0;
+  data = arma::shuffle(data, 1);
+
+  std::vector<arma::mat> shards;
+  shards.push_back(data.cols(0, 299));
+  shards.push_back(data.cols(300, 1999));
+  shards.push_back(data.cols(2000, 2999));
+
+  std::vector<distribution::GaussianDistribution> dists(2,
+      distribution::GaussianDistribution(3));
+  dists[0].Mean().fill(1.0);
+  dists[1].Mean().fill(4.0);
+  arma::vec weights("0.5 0.5");
+  std::vector<distribution::GaussianDistribution> shardedDists(dists);
+  arma::vec shardedWeights(weights);
+
+  EMFit<> em(50, 1e-10);
+  em.Estimate(data, dists, weights, true);
+  em.Estimate(shards, shardedDists, shardedWeights, true);
+
+  CheckMatrices(shardedWeights, weights, 1e-5);
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    CheckMatrices(shardedDists[i].Mean(), dists[i].Mean(), 1e-5);
+    CheckMatrices(shardedDists[i].Covariance(), dists[i].Covariance(), 1e-5);
+  }
+}
+
+/**
+ * The trials of GMM::Train() run in parallel; each one has its own random
+ * seed, so the selected model must not depend on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(GMMTrainTrialsMultithreadedTest)
+{
+  arma::mat data(2, 3000);
+  data.cols(0, 999) = arma::randn<arma::mat>(2, 1000);
+  data.cols(1000, 1999) = arma::randn<arma::mat>(2, 1000) + 4.0;
+  data.cols(2000, 2999) = arma::randn<arma::mat>(2, 1000) - 4.0;
+
+  const int numThreads = omp_get_max_threads();
+  GMM serialGMM(3, 2), gmm(3, 2);
+  math::RandomSeed(7);
+  omp_set_num_threads(1);
+  const double serialLikelihood = serialGMM.Train(data, 6);
+  math::RandomSeed(7);
+  omp_set_num_threads(4);
+  const double likelihood = gmm.Train(data, 6);
+  omp_set_num_threads(numThreads);
+
+  BOOST_REQUIRE_CLOSE(likelihood, serialLikelihood, 1e-5);
+  CheckMatrices(gmm.Weights(), serialGMM.Weights(), 1e-5);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    CheckMatrices(gmm.Component(i).Mean(), serialGMM.Component(i).Mean(),
+        1e-5);
+    CheckMatrices(gmm.Component(i).Covariance(),
+        serialGMM.Component(i).Covariance(), 1e-5);
+  }
+}
+#endif
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -25,6 +25,41 @@ using namespace mlpack::optimization::test;
 
 BOOST_AUTO_TEST_SUITE(GradientDescentTest);
 
+//! GDTestFunction with EvaluateWithGradient(), which counts the calls of each
+//! of its functions.
+class CountingGDTestFunction
+{
+ public:
+  CountingGDTestFunction() :
+      evaluations(0), gradients(0), evaluationsWithGradient(0) { }
+
+  arma::mat GetInitialPoint() const { return function.GetInitialPoint(); }
+
+  double Evaluate(const arma::mat& coordinates)
+  {
+    ++evaluations;
+    return function.Evaluate(coordinates);
+  }
+
+  void Gradient(const arma::mat& coordinates, arma::mat& gradient)
+  {
+    ++gradients;
+    function.Gradient(coordinates, gradient);
+  }
+
+  double EvaluateWithGradient(const arma::mat& coordinates, arma::mat& gradient)
+  {
+    ++evaluationsWithGradient;
+    function.Gradient(coordinates, gradient);
+    return function.Evaluate(coordinates);
+  }
+
+  GDTestFunction function;
+  size_t evaluations;
+  size_t gradients;
+  size_t evaluationsWithGradient;
+};
+
 BOOST_AUTO_TEST_CASE(SimpleGDTestFunction)
 {
   GDTestFunction f;
@@ -54,4 +89,30 @@ BOOST_AUTO_TEST_CASE(RosenbrockTest)
     BOOST_REQUIRE_CLOSE(coordinates[j], (double) 1.0, 1e-3);
 }
 
+/**
+ * Make sure EvaluateWithGradient() is used when the function has it, and that
+ * the result is the same as with Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(EvaluateWithGradientGDTest)
+{
+  GDTestFunction f;
+  GradientDescent<GDTestFunction> s(f, 0.01, 1000, 1e-9);
+  arma::mat coordinates = f.GetInitialPoint();
+  const double result = s.Optimize(coordinates);
+
+  CountingGDTestFunction cf;
+  GradientDescent<CountingGDTestFunction> cs(cf, 0.01, 1000, 1e-9);
+  arma::mat countingCoordinates = cf.GetInitialPoint();
+  const double countingResult = cs.Optimize(countingCoordinates);
+
+  BOOST_REQUIRE_CLOSE(countingResult, result, 1e-10);
+  CheckMatrices(countingCoordinates, coordinates);
+
+  BOOST_REQUIRE_EQUAL(cf.evaluations, 0);
+  BOOST_REQUIRE_EQUAL(cf.gradients, 0);
+  // One call for the initial point, and one for each step.
+  BOOST_REQUIRE_GT(cf.evaluationsWithGradient, 1);
+  BOOST_REQUIRE_LE(cf.evaluationsWithGradient, 1000);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
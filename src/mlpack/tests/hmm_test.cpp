@@ -10,6 +10,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/hmm/hmm.hpp>
+#include <mlpack/methods/hmm/streaming_viterbi.hpp>
 #include <mlpack/methods/gmm/gmm.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -1173,5 +1174,371 @@ BOOST_AUTO_TEST_CASE(DiscreteHMMLoadSaveTest)
           hmm2.Emission()[j].Probabilities()[i], 1e-3);
 }
 
+/**
+ * Make sure that scoring and decoding many sequences at once gives the same
+ * results as scoring and decoding them one at a time.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMBatchPredictTest)
+{
+  HMM<GaussianDistribution> hmm(3, GaussianDistribution(2));
+  hmm.Transition() = arma::mat("0.8 0.1 0.2;"
+                               "0.1 0.7 0.2;"
+                               "0.1 0.2 0.6");
+  hmm.Initial() = arma::vec("0.5 0.3 0.2");
+  hmm.Emission()[0] = GaussianDistribution("0.0 0.0", "1.0 0.2; 0.2 1.0");
+  hmm.Emission()[1] = GaussianDistribution("3.0 1.0", "0.5 0.0; 0.0 0.8");
+  hmm.Emission()[2] = GaussianDistribution("-2.0 4.0", "1.5 0.3; 0.3 1.0");
+
+  std::vector<arma::mat> sequences(50);
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    hmm.Generate(10 + 7 * i, sequences[i], states);
+  }
+
+  arma::vec logLikelihoods;
+  hmm.LogLikelihood(sequences, logLikelihoods);
+
+  std::vector<arma::Row<size_t>> stateSeqs;
+  arma::vec viterbiLogLikelihoods;
+  hmm.Predict(sequences, stateSeqs, viterbiLogLikelihoods);
+
+  BOOST_REQUIRE_EQUAL(logLikelihoods.n_elem, sequences.size());
+  BOOST_REQUIRE_EQUAL(stateSeqs.size(), sequences.size());
+  BOOST_REQUIRE_EQUAL(viterbiLogLikelihoods.n_elem, sequences.size());
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    BOOST_REQUIRE_CLOSE(logLikelihoods[i], hmm.LogLikelihood(sequences[i]),
+        1e-5);
+
+    arma::Row<size_t> stateSeq;
+    const double viterbiLogLikelihood = hmm.Predict(sequences[i], stateSeq);
+    BOOST_REQUIRE_CLOSE(viterbiLogLikelihoods[i], viterbiLogLikelihood, 1e-5);
+    BOOST_REQUIRE_EQUAL(stateSeqs[i].n_elem, stateSeq.n_elem);
+    for (size_t t = 0; t < stateSeq.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(stateSeqs[i][t], stateSeq[t]);
+  }
+}
+
+/**
+ * An HMM with a sparse transition matrix should give the same results as an
+ * HMM with the same dense transition matrix.
+ */
+BOOST_AUTO_TEST_CASE(SparseTransitionHMMTest)
+{
+  // A banded topology: each state may only stay, or move to one of its
+  // neighbors.
+  const size_t states = 8;
+  arma::mat transition(states, states, arma::fill::zeros);
+  for (size_t i = 0; i < states; ++i)
+    for (size_t j = (i == 0) ? 0 : i - 1; j <= std::min(i + 1, states - 1); ++j)
+      transition(j, i) = 1.0 + math::Random();
+  for (size_t i = 0; i < states; ++i)
+    transition.col(i) /= accu(transition.col(i));
+
+  std::vector<GaussianDistribution> emissions;
+  for (size_t i = 0; i < states; ++i)
+  {
+    arma::vec mean(2);
+    mean[0] = 2.0 * i;
+    mean[1] = (i % 2 == 0) ? 0.0 : 3.0;
+    emissions.push_back(GaussianDistribution(mean, arma::eye<arma::mat>(2, 2)));
+  }
+
+  const arma::vec initial = arma::ones<arma::vec>(states) / states;
+  HMM<GaussianDistribution> hmm(initial, transition, emissions);
+  HMM<GaussianDistribution, arma::sp_mat> sparseHMM(initial,
+      arma::sp_mat(transition), emissions);
+  BOOST_REQUIRE_EQUAL(sparseHMM.Transition().n_nonzero, 3 * states - 2);
+
+  std::vector<arma::mat> sequences(10);
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    arma::Row<size_t> stateSeq;
+    hmm.Generate(100, sequences[i], stateSeq);
+  }
+
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    BOOST_REQUIRE_CLOSE(sparseHMM.LogLikelihood(sequences[i]),
+        hmm.LogLikelihood(sequences[i]), 1e-5);
+
+    arma::Row<size_t> stateSeq, sparseStateSeq;
+    const double logLikelihood = hmm.Predict(sequences[i], stateSeq);
+    BOOST_REQUIRE_CLOSE(sparseHMM.Predict(sequences[i], sparseStateSeq),
+        logLikelihood, 1e-5);
+    for (size_t t = 0; t < stateSeq.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(sparseStateSeq[t], stateSeq[t]);
+  }
+
+  // A few iterations of Baum-Welch training should keep the topology and give
+  // the same transition matrix.
+  hmm.Tolerance() = 1e-3;
+  sparseHMM.Tolerance() = 1e-3;
+  hmm.Train(sequences);
+  sparseHMM.Train(sequences);
+
+  BOOST_REQUIRE_LE(sparseHMM.Transition().n_nonzero, 3 * states - 2);
+  CheckMatrices(arma::mat(sparseHMM.Transition()), hmm.Transition(), 1e-3);
+  for (size_t i = 0; i < states; ++i)
+    CheckMatrices(sparseHMM.Emission()[i].Mean(), hmm.Emission()[i].Mean(),
+        1e-3);
+}
+
+/**
+ * An HMM with DiagonalGaussianDistribution emissions gives the same results as
+ * an HMM with GaussianDistributions of the same diagonal covariances, and its
+ * emissions can be trained.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianHMMTest)
+{
+  HMM<DiagonalGaussianDistribution> hmm(2, DiagonalGaussianDistribution(3));
+  hmm.Transition() = arma::mat("0.9 0.2; 0.1 0.8");
+  hmm.Initial() = arma::vec("0.6 0.4");
+  hmm.Emission()[0] = DiagonalGaussianDistribution("0.0 1.0 -1.0",
+      "1.0 0.5 2.0");
+  hmm.Emission()[1] = DiagonalGaussianDistribution("4.0 -3.0 2.0",
+      "0.8 1.5 0.3");
+
+  HMM<GaussianDistribution> fullHMM(2, GaussianDistribution(3));
+  fullHMM.Transition() = hmm.Transition();
+  fullHMM.Initial() = hmm.Initial();
+  for (size_t i = 0; i < 2; ++i)
+  {
+    fullHMM.Emission()[i] = GaussianDistribution(hmm.Emission()[i].Mean(),
+        arma::diagmat(hmm.Emission()[i].Covariance()));
+  }
+
+  std::vector<arma::mat> sequences(30);
+  std::vector<arma::Row<size_t>> states(30);
+  for (size_t i = 0; i < sequences.size(); ++i)
+    hmm.Generate(200, sequences[i], states[i]);
+
+  for (size_t i = 0; i < 5; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(hmm.LogLikelihood(sequences[i]),
+        fullHMM.LogLikelihood(sequences[i]), 1e-5);
+
+    arma::Row<size_t> stateSeq, fullStateSeq;
+    hmm.Predict(sequences[i], stateSeq);
+    fullHMM.Predict(sequences[i], fullStateSeq);
+    for (size_t t = 0; t < stateSeq.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(stateSeq[t], fullStateSeq[t]);
+  }
+
+  // Supervised training recovers the emissions.
+  HMM<DiagonalGaussianDistribution> trained(2,
+      DiagonalGaussianDistribution(3));
+  trained.Train(sequences, states);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    for (size_t d = 0; d < 3; ++d)
+    {
+      BOOST_REQUIRE_SMALL(trained.Emission()[i].Mean()[d] -
+          hmm.Emission()[i].Mean()[d], 0.1);
+      BOOST_REQUIRE_CLOSE(trained.Emission()[i].Covariance()[d],
+          hmm.Emission()[i].Covariance()[d], 10.0);
+    }
+  }
+}
+
+/**
+ * When the lag is never reached, StreamingViterbi gives the same states as
+ * HMM::Predict(), however the observations are pushed, and its forward
+ * algorithm gives the log-likelihood and the filtered state probabilities of
+ * HMM::LogLikelihood() and HMM::Estimate().
+ */
+BOOST_AUTO_TEST_CASE(StreamingViterbiTest)
+{
+  HMM<GaussianDistribution> hmm(3, GaussianDistribution(2));
+  hmm.Transition() = arma::mat("0.8 0.1 0.2;"
+                               "0.1 0.7 0.2;"
+                               "0.1 0.2 0.6");
+  hmm.Initial() = arma::vec("0.5 0.3 0.2");
+  hmm.Emission()[0] = GaussianDistribution("0.0 0.0", "1.0 0.2; 0.2 1.0");
+  hmm.Emission()[1] = GaussianDistribution("3.0 1.0", "0.5 0.0; 0.0 0.8");
+  hmm.Emission()[2] = GaussianDistribution("-2.0 4.0", "1.5 0.3; 0.3 1.0");
+
+  arma::mat dataSeq;
+  arma::Row<size_t> trueStates;
+  hmm.Generate(500, dataSeq, trueStates);
+
+  arma::Row<size_t> stateSeq;
+  const double viterbiLogLikelihood = hmm.Predict(dataSeq, stateSeq);
+  arma::mat stateProb;
+  hmm.Estimate(dataSeq, stateProb);
+
+  for (size_t convergence = 0; convergence < 2; ++convergence)
+  {
+    // All at once.
+    StreamingViterbi<HMM<GaussianDistribution>> decoder(hmm, 1000,
+        convergence == 1);
+    decoder.Push(dataSeq);
+    arma::Row<size_t> states;
+    decoder.PopStates(states);
+    if (convergence == 0)
+      BOOST_REQUIRE_EQUAL(states.n_elem, 0);
+    const size_t finalizedEarly = states.n_elem;
+    BOOST_REQUIRE_EQUAL(decoder.NumFinalized(), finalizedEarly);
+    decoder.Flush();
+    arma::Row<size_t> rest;
+    decoder.PopStates(rest);
+    states = arma::join_rows(states, rest);
+
+    BOOST_REQUIRE_EQUAL(decoder.Observations(), dataSeq.n_cols);
+    BOOST_REQUIRE_EQUAL(states.n_elem, stateSeq.n_elem);
+    for (size_t t = 0; t < stateSeq.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(states[t], stateSeq[t]);
+
+    BOOST_REQUIRE_CLOSE(decoder.ViterbiLogLikelihood(), viterbiLogLikelihood,
+        1e-5);
+    BOOST_REQUIRE_CLOSE(decoder.LogLikelihood(), hmm.LogLikelihood(dataSeq),
+        1e-5);
+    CheckMatrices(decoder.Filtered(),
+        arma::vec(stateProb.col(dataSeq.n_cols - 1)), 1e-5);
+
+    // In chunks of different sizes, collecting the states as they come.
+    decoder.Reset();
+    arma::Row<size_t> chunkStates;
+    size_t begin = 0;
+    for (size_t size = 1; begin < dataSeq.n_cols; ++size)
+    {
+      const size_t end = std::min(begin + size, (size_t) dataSeq.n_cols);
+      decoder.Push(dataSeq.cols(begin, end - 1));
+      decoder.PopStates(rest);
+      chunkStates = arma::join_rows(chunkStates, rest);
+      begin = end;
+    }
+    decoder.Flush();
+    decoder.PopStates(rest);
+    chunkStates = arma::join_rows(chunkStates, rest);
+
+    BOOST_REQUIRE_EQUAL(chunkStates.n_elem, stateSeq.n_elem);
+    for (size_t t = 0; t < stateSeq.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(chunkStates[t], stateSeq[t]);
+    BOOST_REQUIRE_CLOSE(decoder.LogLikelihood(), hmm.LogLikelihood(dataSeq),
+        1e-5);
+  }
+}
+
+/**
+ * With a small lag, StreamingViterbi holds at most 'lag' pending observations,
+ * and, on well-separated emissions, still mostly agrees with HMM::Predict().
+ * With a sparse transition matrix, it gives the same states as with the dense
+ * one.
+ */
+BOOST_AUTO_TEST_CASE(StreamingViterbiLagTest)
+{
+  const size_t states = 6;
+  arma::mat transition(states, states, arma::fill::zeros);
+  for (size_t i = 0; i < states; ++i)
+  {
+    transition(i, i) = 0.8;
+    transition((i + 1) % states, i) = 0.2;
+  }
+
+  std::vector<GaussianDistribution> emissions;
+  for (size_t i = 0; i < states; ++i)
+  {
+    arma::vec mean(1);
+    mean[0] = 3.0 * i;
+    emissions.push_back(GaussianDistribution(mean, arma::eye<arma::mat>(1, 1)));
+  }
+
+  const arma::vec initial = arma::ones<arma::vec>(states) / states;
+  HMM<GaussianDistribution> hmm(initial, transition, emissions);
+  HMM<GaussianDistribution, arma::sp_mat> sparseHMM(initial,
+      arma::sp_mat(transition), emissions);
+
+  arma::mat dataSeq;
+  arma::Row<size_t> trueStates;
+  hmm.Generate(1000, dataSeq, trueStates);
+
+  arma::Row<size_t> stateSeq;
+  hmm.Predict(dataSeq, stateSeq);
+
+  const size_t lag = 5;
+  StreamingViterbi<HMM<GaussianDistribution>> decoder(hmm, lag);
+  StreamingViterbi<HMM<GaussianDistribution, arma::sp_mat>> sparseDecoder(
+      sparseHMM, lag);
+  arma::Row<size_t> laggedStates, sparseLaggedStates, newStates;
+  for (size_t t = 0; t < dataSeq.n_cols; ++t)
+  {
+    decoder.Push(dataSeq.col(t));
+    sparseDecoder.Push(dataSeq.col(t));
+    BOOST_REQUIRE_LE(decoder.NumPending(), lag);
+
+    decoder.PopStates(newStates);
+    laggedStates = arma::join_rows(laggedStates, newStates);
+    sparseDecoder.PopStates(newStates);
+    sparseLaggedStates = arma::join_rows(sparseLaggedStates, newStates);
+    BOOST_REQUIRE_EQUAL(laggedStates.n_elem, decoder.NumFinalized());
+  }
+  decoder.Flush();
+  decoder.PopStates(newStates);
+  laggedStates = arma::join_rows(laggedStates, newStates);
+  sparseDecoder.Flush();
+  sparseDecoder.PopStates(newStates);
+  sparseLaggedStates = arma::join_rows(sparseLaggedStates, newStates);
+
+  BOOST_REQUIRE_EQUAL(laggedStates.n_elem, dataSeq.n_cols);
+  BOOST_REQUIRE_EQUAL(sparseLaggedStates.n_elem, dataSeq.n_cols);
+  size_t agree = 0;
+  for (size_t t = 0; t < dataSeq.n_cols; ++t)
+  {
+    BOOST_REQUIRE_EQUAL(sparseLaggedStates[t], laggedStates[t]);
+    if (laggedStates[t] == stateSeq[t])
+      ++agree;
+  }
+  BOOST_REQUIRE_GT(agree, 900);
+
+  BOOST_REQUIRE_CLOSE(sparseDecoder.LogLikelihood(),
+      hmm.LogLikelihood(dataSeq), 1e-5);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Unlabeled training with several threads should give the same model as
+ * training with a single thread.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMMultithreadedTrainTest)
+{
+  HMM<GaussianDistribution> hmm(2, GaussianDistribution(2));
+  hmm.Transition() = arma::mat("0.9 0.2; 0.1 0.8");
+  hmm.Initial() = arma::vec("0.6 0.4");
+  hmm.Emission()[0] = GaussianDistribution("0.0 0.0", "1.0 0.0; 0.0 1.0");
+  hmm.Emission()[1] = GaussianDistribution("4.0 3.0", "1.0 0.3; 0.3 2.0");
+
+  std::vector<arma::mat> sequences(40);
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    hmm.Generate(50 + 5 * i, sequences[i], states);
+  }
+
+  // Start both models from the same poor guess.
+  HMM<GaussianDistribution> hmm1(2, GaussianDistribution(2));
+  hmm1.Emission()[0].Mean() = "0.5 -0.5";
+  hmm1.Emission()[1].Mean() = "3.0 2.0";
+  HMM<GaussianDistribution> hmm4(hmm1);
+
+  const int numThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  hmm1.Train(sequences);
+  omp_set_num_threads(4);
+  hmm4.Train(sequences);
+  omp_set_num_threads(numThreads);
+
+  CheckMatrices(hmm1.Initial(), hmm4.Initial(), 1e-3);
+  CheckMatrices(hmm1.Transition(), hmm4.Transition(), 1e-3);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    CheckMatrices(hmm1.Emission()[i].Mean(), hmm4.Emission()[i].Mean(), 1e-3);
+    CheckMatrices(hmm1.Emission()[i].Covariance(),
+        hmm4.Emission()[i].Covariance(), 1e-3);
+  }
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
 
@@ -0,0 +1,232 @@
+/**
+ * @file hnsw_test.cpp
+ *
+ * Test the HNSWSearch (graph-based approximate nearest neighbor) functionality.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+#include "serialization.hpp"
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/hnsw/hnsw_search.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+using namespace std;
+using namespace arma;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+BOOST_AUTO_TEST_SUITE(HNSWSearchTest);
+
+/**
+ * On a small low-dimensional dataset, the graph search should find nearly all
+ * of the true neighbors, and the returned distances should be exact.
+ */
+BOOST_AUTO_TEST_CASE(HNSWSearchRecallTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 2000);
+  arma::mat queries = arma::randu<arma::mat>(4, 200);
+
+  HNSWSearch<> hnsw(dataset, 12, 100, 100);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  hnsw.Search(queries, 10, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 10);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, 200);
+  BOOST_REQUIRE_EQUAL(distances.n_rows, 10);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, 200);
+
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      BOOST_REQUIRE_LT(neighbors(j, i), 2000);
+      if (j > 0)
+        BOOST_REQUIRE_LE(distances(j - 1, i), distances(j, i));
+
+      const double trueDistance = metric::EuclideanDistance::Evaluate(
+          queries.col(i), dataset.col(neighbors(j, i)));
+      BOOST_REQUIRE_CLOSE(distances(j, i), trueDistance, 1e-5);
+    }
+  }
+
+  KNN knn(dataset);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(queries, 10, trueNeighbors, trueDistances);
+
+  BOOST_REQUIRE_GE(KNN::Recall(neighbors, trueNeighbors), 0.95);
+}
+
+/**
+ * When the reference set is searched, a point must not be its own neighbor.
+ */
+BOOST_AUTO_TEST_CASE(HNSWSearchMonochromaticTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+
+  HNSWSearch<> hnsw(dataset, 8, 100, 100);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  hnsw.Search(5, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, 1000);
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+      BOOST_REQUIRE_NE(neighbors(j, i), i);
+
+  KNN knn(dataset);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(5, trueNeighbors, trueDistances);
+
+  BOOST_REQUIRE_GE(KNN::Recall(neighbors, trueNeighbors), 0.95);
+}
+
+/**
+ * Make sure that no node has more links than allowed, that no node links to
+ * itself, and that every node is reachable from the entry point on layer 0.
+ */
+BOOST_AUTO_TEST_CASE(HNSWSearchGraphTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1500);
+
+  HNSWSearch<> hnsw(dataset, 6, 50);
+
+  BOOST_REQUIRE_EQUAL(hnsw.Level(hnsw.EntryPoint()), hnsw.MaxLevel());
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_LE(hnsw.Level(i), hnsw.MaxLevel());
+    for (size_t l = 0; l <= hnsw.Level(i); ++l)
+    {
+      const std::vector<size_t>& links = hnsw.Links(i, l);
+      BOOST_REQUIRE_LE(links.size(), (l == 0) ? 12 : 6);
+      for (size_t j = 0; j < links.size(); ++j)
+      {
+        BOOST_REQUIRE_NE(links[j], i);
+        // The linked node must be on this layer too.
+        BOOST_REQUIRE_GE(hnsw.Level(links[j]), l);
+      }
+    }
+  }
+
+  std::vector<bool> reached(dataset.n_cols, false);
+  std::vector<size_t> stack(1, hnsw.EntryPoint());
+  reached[hnsw.EntryPoint()] = true;
+  size_t numReached = 1;
+  while (!stack.empty())
+  {
+    const size_t node = stack.back();
+    stack.pop_back();
+    const std::vector<size_t>& links = hnsw.Links(node, 0);
+    for (size_t j = 0; j < links.size(); ++j)
+    {
+      if (!reached[links[j]])
+      {
+        reached[links[j]] = true;
+        stack.push_back(links[j]);
+        ++numReached;
+      }
+    }
+  }
+
+  BOOST_REQUIRE_GE(numReached, 0.99 * dataset.n_cols);
+}
+
+/**
+ * Make sure invalid parameters are rejected.
+ */
+BOOST_AUTO_TEST_CASE(HNSWSearchInvalidParametersTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 100);
+
+  BOOST_REQUIRE_THROW(HNSWSearch<>(dataset, 1), std::invalid_argument);
+  BOOST_REQUIRE_THROW(HNSWSearch<>(dataset, 8, 0), std::invalid_argument);
+
+  HNSWSearch<> hnsw(dataset, 8, 50);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+
+  // Wrong dimensionality, and too many neighbors.
+  BOOST_REQUIRE_THROW(hnsw.Search(arma::randu<arma::mat>(3, 10), 1, neighbors,
+      distances), std::invalid_argument);
+  BOOST_REQUIRE_THROW(hnsw.Search(dataset, 101, neighbors, distances),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(hnsw.Search(100, neighbors, distances),
+      std::invalid_argument);
+}
+
+/**
+ * Test serialization of HNSWSearch.
+ */
+BOOST_AUTO_TEST_CASE(HNSWSearchSerializationTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(6, 500);
+  arma::mat queries = arma::randu<arma::mat>(6, 50);
+
+  HNSWSearch<> hnsw(dataset, 8, 60, 30);
+
+  arma::mat fakeDataset = arma::randu<arma::mat>(3, 100);
+  HNSWSearch<> hnswXml(fakeDataset, 4, 20);
+  HNSWSearch<> hnswText;
+  HNSWSearch<> hnswBinary(fakeDataset, 3, 10, 5);
+
+  SerializeObjectAll(hnsw, hnswXml, hnswText, hnswBinary);
+
+  BOOST_REQUIRE_EQUAL(hnswXml.MaxNeighbors(), hnsw.MaxNeighbors());
+  BOOST_REQUIRE_EQUAL(hnswText.EfConstruction(), hnsw.EfConstruction());
+  BOOST_REQUIRE_EQUAL(hnswBinary.Ef(), hnsw.Ef());
+  BOOST_REQUIRE_EQUAL(hnswXml.EntryPoint(), hnsw.EntryPoint());
+  BOOST_REQUIRE_EQUAL(hnswText.MaxLevel(), hnsw.MaxLevel());
+  CheckMatrices(hnsw.ReferenceSet(), hnswXml.ReferenceSet(),
+      hnswText.ReferenceSet(), hnswBinary.ReferenceSet());
+
+  arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat distances, xmlDistances, textDistances, binaryDistances;
+  hnsw.Search(queries, 5, neighbors, distances);
+  hnswXml.Search(queries, 5, xmlNeighbors, xmlDistances);
+  hnswText.Search(queries, 5, textNeighbors, textDistances);
+  hnswBinary.Search(queries, 5, binaryNeighbors, binaryDistances);
+
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * A graph built with several threads should be as good as one built with a
+ * single thread.
+ */
+BOOST_AUTO_TEST_CASE(HNSWSearchParallelBuildTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 2000);
+  arma::mat queries = arma::randu<arma::mat>(4, 100);
+
+  const int numThreads = omp_get_max_threads();
+  omp_set_num_threads(4);
+  HNSWSearch<> hnsw(dataset, 12, 100, 100);
+  omp_set_num_threads(numThreads);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  hnsw.Search(queries, 10, neighbors, distances);
+
+  KNN knn(dataset);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(queries, 10, trueNeighbors, trueDistances);
+
+  BOOST_REQUIRE_GE(KNN::Recall(neighbors, trueNeighbors), 0.95);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END();
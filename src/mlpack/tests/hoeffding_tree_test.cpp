@@ -1388,4 +1388,281 @@ BOOST_AUTO_TEST_CASE(HoeffdingTreeModelSerializationTest)
   }
 }
 
+/**
+ * Make sure that the flattened form of a Hoeffding tree classifies points the
+ * same way as the tree.
+ */
+template<typename TreeType>
+void CheckFrozenHoeffdingTree(const TreeType& tree, const arma::mat& data)
+{
+  FlatTree<> flat = tree.Freeze();
+
+  arma::Row<size_t> predictions;
+  arma::rowvec probabilities;
+  flat.Classify(data, predictions, probabilities);
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, data.n_cols);
+  BOOST_REQUIRE_EQUAL(probabilities.n_elem, data.n_cols);
+
+  arma::Row<size_t> flatPredictions;
+  flat.Classify(data, flatPredictions);
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    size_t prediction;
+    double probability;
+    tree.Classify(data.col(i), prediction, probability);
+
+    BOOST_REQUIRE_EQUAL(predictions[i], prediction);
+    BOOST_REQUIRE_EQUAL(flatPredictions[i], prediction);
+    BOOST_REQUIRE_CLOSE(probabilities[i], probability, 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FrozenHoeffdingTreeTest)
+{
+  // The label depends on a categorical dimension and two numeric dimensions.
+  arma::mat dataset(3, 4000);
+  arma::Row<size_t> labels(4000);
+  data::DatasetInfo info(3);
+  info.MapString<double>("cat0", 2);
+  info.MapString<double>("cat1", 2);
+  info.MapString<double>("cat2", 2);
+  for (size_t i = 0; i < 4000; ++i)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = mlpack::math::RandInt(3);
+    if (dataset(2, i) == 0.0)
+      labels[i] = (dataset(0, i) > 0.5) ? 1 : 0;
+    else if (dataset(2, i) == 1.0)
+      labels[i] = (dataset(1, i) > 0.3) ? 2 : 0;
+    else
+      labels[i] = (dataset(0, i) + dataset(1, i) > 1.0) ? 1 : 2;
+  }
+
+  HoeffdingTree<> tree(dataset, info, labels, 3, true, 0.95, 5000, 100, 100);
+  HoeffdingTree<GiniImpurity, BinaryDoubleNumericSplit> binaryTree(dataset,
+      info, labels, 3, true, 0.95, 5000, 100, 100);
+
+  arma::mat testData(3, 1000);
+  testData.rows(0, 1).randu();
+  for (size_t i = 0; i < 1000; ++i)
+    testData(2, i) = mlpack::math::RandInt(3);
+
+  CheckFrozenHoeffdingTree(tree, testData);
+  CheckFrozenHoeffdingTree(binaryTree, testData);
+}
+
+/**
+ * Make sure two trees have the same structure.
+ */
+template<typename TreeType>
+void CheckSameHoeffdingTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  BOOST_REQUIRE_EQUAL(a.SplitDimension(), b.SplitDimension());
+  BOOST_REQUIRE_EQUAL(a.MajorityClass(), b.MajorityClass());
+  BOOST_REQUIRE_CLOSE(a.MajorityProbability(), b.MajorityProbability(), 1e-10);
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameHoeffdingTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Streaming training on mini-batches (which trains the leaves in parallel)
+ * should give the same tree as training on the points one at a time.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingTreeMiniBatchTest)
+{
+  arma::mat dataset(3, 20000);
+  arma::Row<size_t> labels(20000);
+  data::DatasetInfo info(3);
+  info.MapString<double>("cat0", 2);
+  info.MapString<double>("cat1", 2);
+  info.MapString<double>("cat2", 2);
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = mlpack::math::RandInt(3);
+    if (dataset(2, i) == 0.0)
+      labels[i] = (dataset(0, i) > 0.5) ? 1 : 0;
+    else if (dataset(2, i) == 1.0)
+      labels[i] = (dataset(1, i) > 0.3) ? 2 : 0;
+    else
+      labels[i] = (dataset(0, i) + dataset(1, i) > 1.0) ? 1 : 2;
+  }
+
+  HoeffdingTree<> pointTree(info, 3, 0.95, 0, 100, 100);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    pointTree.Train(dataset.col(i), labels[i]);
+
+  HoeffdingTree<> batchTree(info, 3, 0.95, 0, 100, 100);
+  for (size_t start = 0; start < dataset.n_cols; start += 2500)
+  {
+    const arma::mat batch = dataset.cols(start, start + 2499);
+    const arma::Row<size_t> batchLabels = labels.subvec(start, start + 2499);
+    batchTree.Train(batch, batchLabels, false);
+  }
+
+  BOOST_REQUIRE_GT(pointTree.NumChildren(), 0);
+  CheckSameHoeffdingTree(pointTree, batchTree);
+}
+
+/**
+ * Merging two BinaryNumericSplits should give the same split as training one
+ * split on all the points.
+ */
+BOOST_AUTO_TEST_CASE(BinaryNumericSplitMergeTest)
+{
+  BinaryNumericSplit<GiniImpurity> full(3), first(3), second(3);
+  for (size_t i = 0; i < 600; ++i)
+  {
+    const double value = 3.0 * mlpack::math::Random();
+    const size_t label = (mlpack::math::Random() < 0.9) ? size_t(value) :
+        mlpack::math::RandInt(3);
+
+    full.Train(value, label);
+    if (i % 2 == 0)
+      first.Train(value, label);
+    else
+      second.Train(value, label);
+  }
+
+  first.Merge(second);
+  BOOST_REQUIRE_EQUAL(first.MajorityClass(), full.MajorityClass());
+  BOOST_REQUIRE_CLOSE(first.MajorityProbability(), full.MajorityProbability(),
+      1e-10);
+
+  double fullBest, fullSecond, mergedBest, mergedSecond;
+  full.EvaluateFitnessFunction(fullBest, fullSecond);
+  first.EvaluateFitnessFunction(mergedBest, mergedSecond);
+  BOOST_REQUIRE_CLOSE(mergedBest, fullBest, 1e-10);
+  BOOST_REQUIRE_CLOSE(mergedSecond, fullSecond, 1e-10);
+
+  arma::Col<size_t> fullMajorities, mergedMajorities;
+  BinaryNumericSplitInfo<> fullInfo, mergedInfo;
+  full.Split(fullMajorities, fullInfo);
+  first.Split(mergedMajorities, mergedInfo);
+  BOOST_REQUIRE_EQUAL(mergedMajorities[0], fullMajorities[0]);
+  BOOST_REQUIRE_EQUAL(mergedMajorities[1], fullMajorities[1]);
+  for (size_t i = 0; i < 100; ++i)
+  {
+    const double value = 3.0 * mlpack::math::Random();
+    BOOST_REQUIRE_EQUAL(mergedInfo.CalculateDirection(value),
+        fullInfo.CalculateDirection(value));
+  }
+
+  // An empty copy has seen nothing.
+  BinaryNumericSplit<GiniImpurity> empty = full.EmptyCopy();
+  empty.Merge(full);
+  empty.EvaluateFitnessFunction(mergedBest, mergedSecond);
+  BOOST_REQUIRE_CLOSE(mergedBest, fullBest, 1e-10);
+}
+
+/**
+ * Merging HoeffdingNumericSplits should be exact before binning, and when the
+ * bins are the same.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingNumericSplitMergeTest)
+{
+  HoeffdingNumericSplit<GiniImpurity> full(2, 10, 100);
+  HoeffdingNumericSplit<GiniImpurity> first(2, 10, 100);
+  HoeffdingNumericSplit<GiniImpurity> second(2, 10, 100);
+
+  // Neither split has binned its points yet.
+  arma::vec values = arma::randu<arma::vec>(80);
+  for (size_t i = 0; i < 80; ++i)
+  {
+    const size_t label = (values[i] > 0.4) ? 1 : 0;
+    full.Train(values[i], label);
+    if (i < 40)
+      first.Train(values[i], label);
+    else
+      second.Train(values[i], label);
+  }
+  first.Merge(second);
+
+  // Now both bin in the same way.
+  for (size_t i = 0; i < 300; ++i)
+  {
+    const double value = mlpack::math::Random();
+    const size_t label = (value > 0.4) ? 1 : 0;
+    full.Train(value, label);
+    first.Train(value, label);
+  }
+
+  double fullBest, fullSecond, mergedBest, mergedSecond;
+  full.EvaluateFitnessFunction(fullBest, fullSecond);
+  first.EvaluateFitnessFunction(mergedBest, mergedSecond);
+  BOOST_REQUIRE_GT(fullBest, 0.0);
+  BOOST_REQUIRE_CLOSE(mergedBest, fullBest, 1e-10);
+  BOOST_REQUIRE_EQUAL(first.MajorityClass(), full.MajorityClass());
+
+  // An empty copy keeps the bins, so merging it back is exact.
+  HoeffdingNumericSplit<GiniImpurity> copy(full);
+  HoeffdingNumericSplit<GiniImpurity> empty = full.EmptyCopy();
+  for (size_t i = 0; i < 200; ++i)
+  {
+    const double value = mlpack::math::Random();
+    const size_t label = (value > 0.7) ? 1 : 0;
+    copy.Train(value, label);
+    empty.Train(value, label);
+  }
+  full.Merge(empty);
+
+  copy.EvaluateFitnessFunction(fullBest, fullSecond);
+  full.EvaluateFitnessFunction(mergedBest, mergedSecond);
+  BOOST_REQUIRE_CLOSE(mergedBest, fullBest, 1e-10);
+  BOOST_REQUIRE_CLOSE(full.MajorityProbability(), copy.MajorityProbability(),
+      1e-10);
+}
+
+/**
+ * A tree trained with ParallelTrain() should be about as good as a tree trained
+ * on the points one at a time.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingTreeParallelTrainTest)
+{
+  arma::mat dataset(3, 20000);
+  arma::Row<size_t> labels(20000);
+  data::DatasetInfo info(3);
+  info.MapString<double>("cat0", 2);
+  info.MapString<double>("cat1", 2);
+  info.MapString<double>("cat2", 2);
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = mlpack::math::RandInt(3);
+    if (dataset(2, i) == 0.0)
+      labels[i] = (dataset(0, i) > 0.5) ? 1 : 0;
+    else if (dataset(2, i) == 1.0)
+      labels[i] = (dataset(1, i) > 0.3) ? 2 : 0;
+    else
+      labels[i] = (dataset(0, i) + dataset(1, i) > 1.0) ? 1 : 2;
+  }
+
+  HoeffdingTree<> pointTree(info, 3, 0.95, 0, 100, 100);
+  pointTree.Train(dataset, labels, false);
+
+  HoeffdingTree<> parallelTree(info, 3, 0.95, 0, 100, 100);
+  parallelTree.ParallelTrain(dataset, labels, 1000);
+  BOOST_REQUIRE_GT(parallelTree.NumChildren(), 0);
+
+  arma::Row<size_t> pointPredictions, parallelPredictions;
+  pointTree.Classify(dataset, pointPredictions);
+  parallelTree.Classify(dataset, parallelPredictions);
+  const double pointAccuracy = arma::accu(pointPredictions == labels) /
+      double(labels.n_elem);
+  const double parallelAccuracy = arma::accu(parallelPredictions == labels) /
+      double(labels.n_elem);
+  BOOST_REQUIRE_GT(parallelAccuracy, pointAccuracy - 0.05);
+
+  // The same works with the binary numeric split.
+  HoeffdingTree<GiniImpurity, BinaryDoubleNumericSplit> binaryTree(info, 3,
+      0.95, 0, 100, 100);
+  binaryTree.ParallelTrain(dataset, labels, 1000);
+  BOOST_REQUIRE_GT(binaryTree.NumChildren(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -266,4 +266,67 @@ BOOST_AUTO_TEST_CASE(ListwiseDeletionTest)
   BOOST_REQUIRE_CLOSE(rowWiseInput(1, 3), 8.0, 1e-5);
 }
 
+/**
+ * Make sure imputing several dimensions at once gives the same result as
+ * imputing them one by one.
+ */
+BOOST_AUTO_TEST_CASE(ImputerDimensionsTest)
+{
+  // Every dimension has missing values.
+  fstream f;
+  f.open("test_file.csv", fstream::out);
+  for (size_t i = 0; i < 200; ++i)
+  {
+    for (size_t d = 0; d < 10; ++d)
+    {
+      if (d > 0)
+        f << ", ";
+      if (i % 50 == d || math::Random() < 0.05)
+        f << "a";
+      else
+        f << math::Random(-10.0, 10.0);
+    }
+    f << endl;
+  }
+  f.close();
+
+  arma::mat input;
+  MissingPolicy policy({"a"});
+  DatasetMapper<MissingPolicy> info(policy);
+  BOOST_REQUIRE(data::Load("test_file.csv", input, info) == true);
+  remove("test_file.csv");
+
+  std::vector<size_t> dimensions;
+  for (size_t d = 0; d < input.n_rows; ++d)
+    dimensions.push_back(d);
+
+  Imputer<double,
+          DatasetMapper<MissingPolicy>,
+          MedianImputation<double>> imputer(info);
+
+  arma::mat serialInput(input);
+  for (size_t d = 0; d < serialInput.n_rows; ++d)
+    imputer.Impute(serialInput, "a", d);
+
+  arma::mat parallelInput(input);
+  imputer.Impute(parallelInput, "a", dimensions);
+
+  BOOST_REQUIRE_EQUAL(parallelInput.n_rows, serialInput.n_rows);
+  BOOST_REQUIRE_EQUAL(parallelInput.n_cols, serialInput.n_cols);
+  BOOST_REQUIRE(!parallelInput.has_nan());
+  for (size_t i = 0; i < serialInput.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(parallelInput[i], serialInput[i], 1e-5);
+
+  // Listwise deletion removes points, so its dimensions are handled in order.
+  Imputer<double,
+          DatasetMapper<MissingPolicy>,
+          ListwiseDeletion<double>> deletion(info);
+
+  arma::mat deletionInput(input);
+  deletion.Impute(deletionInput, "a", dimensions);
+  BOOST_REQUIRE_EQUAL(deletionInput.n_rows, input.n_rows);
+  BOOST_REQUIRE_GT(deletionInput.n_cols, 0);
+  BOOST_REQUIRE(!deletionInput.has_nan());
+}
+
 BOOST_AUTO_TEST_SUITE_END();
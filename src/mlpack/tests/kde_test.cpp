@@ -0,0 +1,353 @@
+/**
+ * @file kde_test.cpp
+ *
+ * Tests for kernel density estimation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/kde/kde.hpp>
+#include <mlpack/methods/kde/kde_model.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+#include "serialization.hpp"
+
+using namespace mlpack;
+using namespace mlpack::kde;
+using namespace mlpack::kernel;
+using namespace mlpack::metric;
+using namespace mlpack::tree;
+
+BOOST_AUTO_TEST_SUITE(KDETest);
+
+/**
+ * Compute the estimates of the given query points by hand.
+ */
+template<typename KernelType>
+arma::vec ExactEstimates(const arma::mat& reference,
+                         const arma::mat& query,
+                         const KernelType& kernel)
+{
+  arma::vec estimates(query.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    for (size_t j = 0; j < reference.n_cols; ++j)
+      estimates[i] += kernel.Evaluate(EuclideanDistance::Evaluate(
+          query.col(i), reference.col(j)));
+    estimates[i] /= reference.n_cols;
+  }
+
+  return estimates;
+}
+
+/**
+ * Make sure the naive estimates of a tiny dataset are right.
+ */
+BOOST_AUTO_TEST_CASE(KDENaiveSimpleTest)
+{
+  arma::mat reference("0.0 1.0 3.0;"
+                      "0.0 0.0 0.0");
+  arma::mat query("0.0 2.0;"
+                  "0.0 0.0");
+
+  KDE<TriangularKernel> kde(0.0, 0.0, TriangularKernel(2.0),
+      EuclideanDistance(), true);
+  kde.Train(reference);
+  arma::vec estimates;
+  kde.Evaluate(query, estimates);
+
+  // K(0) = 1, K(1) = 0.5, K(3) = 0 for the first query point, and K(2) = 0,
+  // K(1) = 0.5, K(1) = 0.5 for the second.
+  BOOST_REQUIRE_EQUAL(estimates.n_elem, 2);
+  BOOST_REQUIRE_CLOSE(estimates[0], 1.5 / 3.0, 1e-10);
+  BOOST_REQUIRE_CLOSE(estimates[1], 1.0 / 3.0, 1e-10);
+}
+
+/**
+ * Make sure the single-tree and dual-tree estimates are within the relative
+ * error tolerance of the exact estimates.
+ */
+BOOST_AUTO_TEST_CASE(KDETreeRelativeErrorTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(3, 2000);
+  arma::mat query = arma::randu<arma::mat>(3, 500);
+
+  const double relError = 0.02;
+  GaussianKernel kernel(0.3);
+  const arma::vec exact = ExactEstimates(reference, query, kernel);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    KDE<> kde(relError, 0.0, kernel, EuclideanDistance(), false, mode == 0);
+    kde.Train(reference);
+    arma::vec estimates;
+    kde.Evaluate(query, estimates);
+
+    BOOST_REQUIRE_EQUAL(estimates.n_elem, query.n_cols);
+    for (size_t i = 0; i < query.n_cols; ++i)
+      BOOST_REQUIRE_LE(std::abs(estimates[i] - exact[i]),
+          relError * exact[i] + 1e-12);
+  }
+}
+
+/**
+ * With no error tolerance, the estimates must be exact, for every tree type.
+ */
+BOOST_AUTO_TEST_CASE(KDEExactTreeTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(2, 1000);
+  arma::mat query = arma::randu<arma::mat>(2, 300);
+
+  EpanechnikovKernel kernel(0.2);
+  const arma::vec exact = ExactEstimates(reference, query, kernel);
+
+  KDE<EpanechnikovKernel, EuclideanDistance, arma::mat, KDTree> kd(0.0, 0.0,
+      kernel);
+  KDE<EpanechnikovKernel, EuclideanDistance, arma::mat, BallTree> ball(0.0,
+      0.0, kernel);
+  KDE<EpanechnikovKernel, EuclideanDistance, arma::mat, Octree> oct(0.0, 0.0,
+      kernel);
+  kd.Train(reference);
+  ball.Train(reference);
+  oct.Train(reference);
+
+  arma::vec kdEstimates, ballEstimates, octEstimates;
+  kd.Evaluate(query, kdEstimates);
+  ball.Evaluate(query, ballEstimates);
+  oct.Evaluate(query, octEstimates);
+
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    BOOST_REQUIRE_SMALL(kdEstimates[i] - exact[i], 1e-10);
+    BOOST_REQUIRE_SMALL(ballEstimates[i] - exact[i], 1e-10);
+    BOOST_REQUIRE_SMALL(octEstimates[i] - exact[i], 1e-10);
+  }
+
+  // Far-away reference nodes have a kernel of zero, so some must be pruned.
+  BOOST_REQUIRE_LT(kd.BaseCases(), reference.n_cols * query.n_cols);
+}
+
+/**
+ * Make sure the estimates of the reference points are right, in the original
+ * order of the points.
+ */
+BOOST_AUTO_TEST_CASE(KDEMonochromaticTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(3, 1000);
+
+  LaplacianKernel kernel(0.5);
+  const arma::vec exact = ExactEstimates(reference, reference, kernel);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    KDE<LaplacianKernel> kde(0.01, 0.0, kernel, EuclideanDistance(), mode == 0,
+        mode == 1);
+    kde.Train(reference);
+    arma::vec estimates;
+    kde.Evaluate(estimates);
+
+    BOOST_REQUIRE_EQUAL(estimates.n_elem, reference.n_cols);
+    for (size_t i = 0; i < reference.n_cols; ++i)
+      BOOST_REQUIRE_LE(std::abs(estimates[i] - exact[i]),
+          0.01 * exact[i] + 1e-12);
+  }
+}
+
+/**
+ * Make sure the absolute error tolerance is respected.
+ */
+BOOST_AUTO_TEST_CASE(KDEAbsoluteErrorTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(2, 2000);
+  arma::mat query = arma::randu<arma::mat>(2, 200);
+
+  const double absError = 1e-3;
+  GaussianKernel kernel(0.1);
+  const arma::vec exact = ExactEstimates(reference, query, kernel);
+
+  KDE<> kde(0.0, absError, kernel);
+  kde.Train(reference);
+  arma::vec estimates;
+  kde.Evaluate(query, estimates);
+
+  for (size_t i = 0; i < query.n_cols; ++i)
+    BOOST_REQUIRE_LE(std::abs(estimates[i] - exact[i]), absError + 1e-12);
+}
+
+/**
+ * The estimates must stay within the tolerance regardless of the number of
+ * threads.
+ */
+BOOST_AUTO_TEST_CASE(KDEMultithreadedTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(3, 5000);
+  arma::mat query = arma::randu<arma::mat>(3, 2000);
+
+  GaussianKernel kernel(0.2);
+  const arma::vec exact = ExactEstimates(reference, query, kernel);
+
+  KDE<> kde(0.01, 0.0, kernel);
+  kde.Train(reference);
+
+#ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  arma::vec estimates;
+  kde.Evaluate(query, estimates);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(4);
+#endif
+
+  arma::vec parallelEstimates;
+  kde.Evaluate(query, parallelEstimates);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    BOOST_REQUIRE_LE(std::abs(estimates[i] - exact[i]),
+        0.01 * exact[i] + 1e-12);
+    BOOST_REQUIRE_LE(std::abs(parallelEstimates[i] - exact[i]),
+        0.01 * exact[i] + 1e-12);
+  }
+}
+
+/**
+ * Make sure invalid parameters and inputs are rejected.
+ */
+BOOST_AUTO_TEST_CASE(KDEInvalidTest)
+{
+  BOOST_REQUIRE_THROW(KDE<>(-0.1), std::invalid_argument);
+  BOOST_REQUIRE_THROW(KDE<>(1.5), std::invalid_argument);
+  BOOST_REQUIRE_THROW(KDE<>(0.05, -1.0), std::invalid_argument);
+
+  KDE<> kde;
+  arma::vec estimates;
+  arma::mat query = arma::randu<arma::mat>(3, 10);
+  BOOST_REQUIRE_THROW(kde.Evaluate(query, estimates), std::runtime_error);
+
+  kde.Train(arma::randu<arma::mat>(4, 10));
+  BOOST_REQUIRE_THROW(kde.Evaluate(query, estimates), std::invalid_argument);
+}
+
+/**
+ * Make sure a KDE object can be serialized.
+ */
+BOOST_AUTO_TEST_CASE(KDESerializationTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(3, 500);
+  arma::mat query = arma::randu<arma::mat>(3, 100);
+
+  KDE<> kde(0.01, 0.0, GaussianKernel(0.25));
+  kde.Train(reference);
+
+  KDE<> xmlKde, textKde, binaryKde(0.2);
+  binaryKde.Train(arma::randu<arma::mat>(3, 10));
+
+  SerializeObjectAll(kde, xmlKde, textKde, binaryKde);
+
+  arma::vec estimates, xmlEstimates, textEstimates, binaryEstimates;
+  kde.Evaluate(query, estimates);
+  xmlKde.Evaluate(query, xmlEstimates);
+  textKde.Evaluate(query, textEstimates);
+  binaryKde.Evaluate(query, binaryEstimates);
+
+  CheckMatrices(estimates, xmlEstimates, textEstimates, binaryEstimates);
+}
+
+/**
+ * Make sure KDEModel normalizes the Gaussian estimates, survives
+ * serialization, and copies its KDE object.
+ */
+BOOST_AUTO_TEST_CASE(KDEModelTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(2, 500);
+  arma::mat query = arma::randu<arma::mat>(2, 100);
+
+  GaussianKernel kernel(0.3);
+  const arma::vec exact = ExactEstimates(reference, query, kernel) /
+      kernel.Normalizer(2);
+
+  KDEModel model(0.3, 0.0, 0.0, KDEModel::GAUSSIAN_KERNEL,
+      KDEModel::BALL_TREE);
+  model.BuildModel(arma::mat(reference));
+
+  arma::vec estimates;
+  model.Evaluate(query, estimates);
+  for (size_t i = 0; i < query.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(estimates[i], exact[i], 1e-5);
+
+  KDEModel copy(model);
+  arma::vec copyEstimates;
+  copy.Evaluate(query, copyEstimates);
+  CheckMatrices(estimates, copyEstimates);
+
+  KDEModel xmlModel, textModel, binaryModel(1.0, 0.05, 0.0,
+      KDEModel::TRIANGULAR_KERNEL, KDEModel::OCTREE);
+  binaryModel.BuildModel(arma::randu<arma::mat>(2, 10));
+
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+
+  BOOST_REQUIRE_EQUAL(binaryModel.KernelType(), KDEModel::GAUSSIAN_KERNEL);
+  BOOST_REQUIRE_EQUAL(binaryModel.TreeType(), KDEModel::BALL_TREE);
+
+  arma::vec xmlEstimates, textEstimates, binaryEstimates;
+  xmlModel.Evaluate(query, xmlEstimates);
+  textModel.Evaluate(query, textEstimates);
+  binaryModel.Evaluate(query, binaryEstimates);
+
+  CheckMatrices(estimates, xmlEstimates, textEstimates, binaryEstimates);
+}
+
+
+/**
+ * Make sure that KDE on the shared tree of a NeighborSearch model gives the
+ * right estimates, with the monochromatic estimates in the original order.
+ */
+BOOST_AUTO_TEST_CASE(KDESharedTreeTest)
+{
+  typedef neighbor::NeighborSearch<neighbor::NearestNeighborSort> KNNType;
+  typedef KDE<EpanechnikovKernel, EuclideanDistance, arma::mat, KDTree,
+      neighbor::NeighborSearchStat<neighbor::NearestNeighborSort>> KDEType;
+
+  arma::mat reference = arma::randu<arma::mat>(2, 1000);
+  arma::mat query = arma::randu<arma::mat>(2, 300);
+
+  EpanechnikovKernel kernel(0.2);
+  const arma::vec exact = ExactEstimates(reference, query, kernel);
+  const arma::vec exactReference = ExactEstimates(reference, reference,
+      kernel);
+
+  SharedTree<KNNType::Tree> tree(reference);
+  KNNType knn(tree);
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    KDEType kde(tree, 0.0, 0.0, kernel, EuclideanDistance(), mode == 1);
+    BOOST_REQUIRE_EQUAL(tree.UseCount(), 3);
+
+    arma::vec estimates;
+    kde.Evaluate(query, estimates);
+    for (size_t i = 0; i < query.n_cols; ++i)
+      BOOST_REQUIRE_SMALL(estimates[i] - exact[i], 1e-10);
+
+    kde.Evaluate(estimates);
+    for (size_t i = 0; i < reference.n_cols; ++i)
+      BOOST_REQUIRE_SMALL(estimates[i] - exactReference[i], 1e-10);
+
+    // Training the model stops sharing the tree.
+    kde.Train(reference);
+    BOOST_REQUIRE_EQUAL(tree.UseCount(), 2);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
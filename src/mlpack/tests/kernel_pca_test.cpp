@@ -12,6 +12,8 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/random_fourier_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/randomized_method.hpp>
 #include <mlpack/methods/kernel_pca/kernel_pca.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -150,4 +152,106 @@ BOOST_AUTO_TEST_CASE(CircleTransformationTestNystroem)
   BOOST_REQUIRE_EQUAL(ranges[1].Contains(ranges[2]), false);
 }
 
+/**
+ * The randomized kernel rule should find the same leading eigenvalues and
+ * projections as the naive kernel rule, which builds the whole kernel matrix.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedKernelRuleMatchesNaive)
+{
+  // Three well-separated clusters, so the leading eigenvalues of the centered
+  // kernel matrix are well-separated from the others.
+  arma::mat dataset(3, 300);
+  dataset.randn();
+  dataset *= 0.3;
+  dataset.cols(100, 199) += 3.0;
+  dataset.cols(200, 299) -= 3.0;
+  dataset.row(2).cols(200, 299) += 6.0;
+
+  GaussianKernel kernel(2.0);
+
+  arma::mat naiveData, naiveEigvec;
+  arma::vec naiveEigval;
+  KernelPCA<GaussianKernel> naive(kernel);
+  naive.Apply(dataset, naiveData, naiveEigval, naiveEigvec);
+
+  arma::mat randomizedData, randomizedEigvec;
+  arma::vec randomizedEigval;
+  KernelPCA<GaussianKernel, RandomizedKernelRule<GaussianKernel> >
+      randomized(kernel);
+  randomized.Apply(dataset, randomizedData, randomizedEigval,
+      randomizedEigvec, 2);
+
+  BOOST_REQUIRE_EQUAL(randomizedEigval.n_elem, 2);
+  BOOST_REQUIRE_EQUAL(randomizedEigvec.n_rows, 300);
+  BOOST_REQUIRE_EQUAL(randomizedEigvec.n_cols, 2);
+  BOOST_REQUIRE_EQUAL(randomizedData.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(randomizedData.n_cols, 300);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(randomizedEigval[i], naiveEigval[i], 1.0);
+
+    // The projections may differ in sign.
+    const arma::rowvec n = naiveData.row(i) / arma::norm(naiveData.row(i));
+    const arma::rowvec r = randomizedData.row(i) /
+        arma::norm(randomizedData.row(i));
+    BOOST_REQUIRE_GT(std::abs(arma::dot(n, r)), 0.99);
+    BOOST_REQUIRE_CLOSE(arma::norm(randomizedData.row(i)),
+        arma::norm(naiveData.row(i)), 1.0);
+  }
+}
+
+/**
+ * The random Fourier kernel rule should find leading eigenvalues and
+ * projections close to those of the naive kernel rule.
+ */
+BOOST_AUTO_TEST_CASE(RandomFourierKernelRuleMatchesNaive)
+{
+  // Three well-separated clusters, as above.
+  arma::mat dataset(3, 300);
+  dataset.randn();
+  dataset *= 0.3;
+  dataset.cols(100, 199) += 3.0;
+  dataset.cols(200, 299) -= 3.0;
+  dataset.row(2).cols(200, 299) += 6.0;
+
+  GaussianKernel kernel(2.0);
+
+  arma::mat naiveData, naiveEigvec;
+  arma::vec naiveEigval;
+  KernelPCA<GaussianKernel> naive(kernel);
+  naive.Apply(dataset, naiveData, naiveEigval, naiveEigvec);
+
+  // Use few points per block, so that several blocks are accumulated.
+  arma::mat fourierData, fourierEigvec;
+  arma::vec fourierEigval;
+  KernelPCA<GaussianKernel, RandomFourierKernelRule<GaussianKernel, 4096, 64> >
+      fourier(kernel);
+  fourier.Apply(dataset, fourierData, fourierEigval, fourierEigvec, 2);
+
+  BOOST_REQUIRE_EQUAL(fourierEigval.n_elem, 2);
+  BOOST_REQUIRE_EQUAL(fourierEigvec.n_rows, 4096);
+  BOOST_REQUIRE_EQUAL(fourierEigvec.n_cols, 2);
+  BOOST_REQUIRE_EQUAL(fourierData.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(fourierData.n_cols, 300);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(fourierEigval[i], naiveEigval[i], 5.0);
+
+    // The projections may differ in sign.
+    const arma::rowvec n = naiveData.row(i) / arma::norm(naiveData.row(i));
+    const arma::rowvec f = fourierData.row(i) / arma::norm(fourierData.row(i));
+    BOOST_REQUIRE_GT(std::abs(arma::dot(n, f)), 0.95);
+  }
+
+  // Transforming the dataset in place should give the same result.
+  mlpack::math::RandomSeed(5);
+  arma::mat data(dataset);
+  fourier.Apply(data, 2);
+  mlpack::math::RandomSeed(5);
+  fourier.Apply(dataset, fourierData, fourierEigval, fourierEigvec, 2);
+  CheckMatrices(data, fourierData);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -18,7 +18,10 @@
 #include <mlpack/core/kernels/linear_kernel.hpp>
 #include <mlpack/core/kernels/polynomial_kernel.hpp>
 #include <mlpack/core/kernels/spherical_kernel.hpp>
+#include <mlpack/core/kernels/triangular_kernel.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 #include <mlpack/core/kernels/pspectrum_string_kernel.hpp>
+#include <mlpack/core/kernels/random_fourier_features.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
 
@@ -208,6 +211,42 @@ BOOST_AUTO_TEST_CASE(MDFullCovarianceTest)
   BOOST_REQUIRE_CLOSE(md.Evaluate(b, a), 15.7, 1e-5);
 }
 
+/**
+ * Make sure that the Euclidean distance between points transformed with
+ * Transformation() is the Mahalanobis distance, for positive definite and
+ * positive semidefinite covariance matrices.
+ */
+BOOST_AUTO_TEST_CASE(MDTransformationTest)
+{
+  arma::mat a = arma::randn<arma::mat>(6, 6);
+  arma::vec v = arma::randn<arma::vec>(6);
+
+  // The second covariance matrix has rank 1, so it has no Cholesky factor.
+  const arma::mat covariances[] = { a * a.t() + arma::eye<arma::mat>(6, 6),
+                                    v * v.t() };
+
+  for (size_t c = 0; c < 2; ++c)
+  {
+    MahalanobisDistance<true> md(covariances[c]);
+    const arma::mat l = md.Transformation();
+    BOOST_REQUIRE_EQUAL(l.n_rows, 6);
+    BOOST_REQUIRE_EQUAL(l.n_cols, 6);
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+      const arma::vec x = arma::randn<arma::vec>(6);
+      const arma::vec y = arma::randn<arma::vec>(6);
+
+      const double distance = md.Evaluate(x, y);
+      const double transformed = arma::norm(l * x - l * y);
+      if (distance < 1e-5)
+        BOOST_REQUIRE_SMALL(transformed, 1e-5);
+      else
+        BOOST_REQUIRE_CLOSE(transformed, distance, 1e-5);
+    }
+  }
+}
+
 /**
  * Simple test case for the cosine distance.
  */
@@ -608,4 +647,185 @@ BOOST_AUTO_TEST_CASE(PSpectrumStringEvaluateTest)
   BOOST_REQUIRE_CLOSE(p.Evaluate(b, a), 11.0, 1e-5);
 }
 
+/**
+ * Make sure the p-spectrum kernel matches a count of the matching substrings
+ * by hand, for short substrings, which have exact IDs, and for long substrings,
+ * which are hashed.  Case must not matter.
+ */
+BOOST_AUTO_TEST_CASE(PSpectrumStringLongSubstringTest)
+{
+  std::vector<std::vector<std::string> > datasets(1);
+  for (size_t i = 0; i < 20; ++i)
+  {
+    std::string str;
+    for (size_t j = 0; j < 200; ++j)
+      str += "abAB"[math::RandInt(4)];
+    datasets[0].push_back(str);
+  }
+
+  for (size_t p = 3; p <= 15; p += 12)
+  {
+    PSpectrumStringKernel kernel(datasets, p);
+    for (size_t i = 0; i < datasets[0].size(); ++i)
+    {
+      for (size_t j = 0; j < datasets[0].size(); ++j)
+      {
+        std::string a = datasets[0][i];
+        std::string b = datasets[0][j];
+        std::transform(a.begin(), a.end(), a.begin(), ::tolower);
+        std::transform(b.begin(), b.end(), b.begin(), ::tolower);
+
+        double expected = 0.0;
+        for (size_t k = 0; k + p <= a.length(); ++k)
+          for (size_t l = 0; l + p <= b.length(); ++l)
+            if (a.compare(k, p, b, l, p) == 0)
+              expected += 1.0;
+
+        arma::vec aIndex("0 0"), bIndex("0 0");
+        aIndex[1] = i;
+        bIndex[1] = j;
+        BOOST_REQUIRE_CLOSE(kernel.Evaluate(aIndex, bIndex), expected, 1e-10);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that KernelMatrix() gives the same kernel values as evaluating the
+ * kernel on each pair of points.  The batched distances of a point to itself
+ * aren't exactly zero, so the tolerance is a little looser than usual.
+ */
+template<typename KernelType>
+void CheckKernelMatrix(KernelType& kernel)
+{
+  arma::mat a(4, 30, arma::fill::randu);
+  arma::mat b(4, 20, arma::fill::randu);
+
+  arma::mat result;
+  KernelMatrix(kernel, a, b, result);
+
+  BOOST_REQUIRE_EQUAL(result.n_rows, 30);
+  BOOST_REQUIRE_EQUAL(result.n_cols, 20);
+  for (size_t j = 0; j < b.n_cols; ++j)
+    for (size_t i = 0; i < a.n_cols; ++i)
+      BOOST_REQUIRE_CLOSE(result(i, j), kernel.Evaluate(a.col(i), b.col(j)),
+          1e-4);
+
+  KernelMatrix(kernel, a, result);
+
+  BOOST_REQUIRE_EQUAL(result.n_rows, 30);
+  BOOST_REQUIRE_EQUAL(result.n_cols, 30);
+  for (size_t j = 0; j < a.n_cols; ++j)
+    for (size_t i = 0; i < a.n_cols; ++i)
+      BOOST_REQUIRE_CLOSE(result(i, j), kernel.Evaluate(a.col(i), a.col(j)),
+          1e-4);
+}
+
+/**
+ * Test KernelMatrix() with kernels that can be evaluated in batches, and with
+ * kernels that can't.
+ */
+BOOST_AUTO_TEST_CASE(KernelMatrixTest)
+{
+  LinearKernel linear;
+  CheckKernelMatrix(linear);
+
+  PolynomialKernel polynomial(3.0, 0.5);
+  CheckKernelMatrix(polynomial);
+
+  GaussianKernel gaussian(0.7);
+  CheckKernelMatrix(gaussian);
+
+  LaplacianKernel laplacian(0.7);
+  CheckKernelMatrix(laplacian);
+
+  HyperbolicTangentKernel hyptan(0.5, 1.0);
+  CheckKernelMatrix(hyptan);
+
+  EpanechnikovKernel epanechnikov(0.9);
+  CheckKernelMatrix(epanechnikov);
+
+  TriangularKernel triangular(0.9);
+  CheckKernelMatrix(triangular);
+
+  CosineDistance cosine;
+  CheckKernelMatrix(cosine);
+
+  SphericalKernel spherical(0.6);
+  CheckKernelMatrix(spherical);
+}
+
+/**
+ * Make sure that the inner products of many random Fourier features are close
+ * to the kernel.
+ */
+template<typename KernelType>
+void CheckFourierFeatures(const KernelType& kernel)
+{
+  arma::mat points(3, 10);
+  points.randn();
+
+  RandomFourierFeatures<KernelType> features(3, 20000, kernel);
+  BOOST_REQUIRE_EQUAL(features.NumFeatures(), 20000);
+
+  arma::mat z;
+  features.Transform(points, z);
+  BOOST_REQUIRE_EQUAL(z.n_rows, 20000);
+  BOOST_REQUIRE_EQUAL(z.n_cols, 10);
+
+  const arma::mat approximation = z.t() * z;
+  for (size_t j = 0; j < points.n_cols; ++j)
+    for (size_t i = 0; i < points.n_cols; ++i)
+      BOOST_REQUIRE_SMALL(approximation(i, j) - kernel.Evaluate(points.col(i),
+          points.col(j)), 0.05);
+}
+
+/**
+ * Random Fourier features should approximate the Gaussian and Laplacian
+ * kernels.
+ */
+BOOST_AUTO_TEST_CASE(RandomFourierFeaturesTest)
+{
+  GaussianKernel gaussian(1.5);
+  CheckFourierFeatures(gaussian);
+
+  LaplacianKernel laplacian(1.5);
+  CheckFourierFeatures(laplacian);
+}
+
+/**
+ * Points of the wrong dimensionality should be rejected.
+ */
+BOOST_AUTO_TEST_CASE(RandomFourierFeaturesDimensionalityTest)
+{
+  RandomFourierFeatures<GaussianKernel> features(3, 10);
+
+  arma::mat points(4, 5, arma::fill::randu);
+  arma::mat z;
+  BOOST_REQUIRE_THROW(features.Transform(points, z), std::invalid_argument);
+}
+
+/**
+ * Serialized features should map points the same way.
+ */
+BOOST_AUTO_TEST_CASE(RandomFourierFeaturesSerializationTest)
+{
+  RandomFourierFeatures<LaplacianKernel> features(4, 50, LaplacianKernel(2.0));
+  RandomFourierFeatures<LaplacianKernel> xmlFeatures(2, 3), textFeatures,
+      binaryFeatures(5, 5);
+
+  SerializeObjectAll(features, xmlFeatures, textFeatures, binaryFeatures);
+
+  arma::mat points(4, 20, arma::fill::randu);
+  arma::mat z, xmlZ, textZ, binaryZ;
+  features.Transform(points, z);
+  xmlFeatures.Transform(points, xmlZ);
+  textFeatures.Transform(points, textZ);
+  binaryFeatures.Transform(points, binaryZ);
+
+  CheckMatrices(z, xmlZ);
+  CheckMatrices(z, textZ);
+  CheckMatrices(z, binaryZ);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -61,4 +61,34 @@ BOOST_AUTO_TEST_CASE(IsNormalizedTest)
       false);
 }
 
+BOOST_AUTO_TEST_CASE(HasBatchEvaluateTest)
+{
+  // See above for why the casts are needed.
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<int>::HasBatchEvaluate, false);
+
+  // Kernels that can be evaluated in batches.
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<CosineDistance>::HasBatchEvaluate,
+      true);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<EpanechnikovKernel>::HasBatchEvaluate, true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<GaussianKernel>::HasBatchEvaluate,
+      true);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<HyperbolicTangentKernel>::HasBatchEvaluate, true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<LaplacianKernel>::HasBatchEvaluate,
+      true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<LinearKernel>::HasBatchEvaluate,
+      true);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<PolynomialKernel>::HasBatchEvaluate, true);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<TriangularKernel>::HasBatchEvaluate, true);
+
+  // Kernels that can't.
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<SphericalKernel>::HasBatchEvaluate,
+      false);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<PSpectrumStringKernel>::HasBatchEvaluate, false);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -14,10 +14,15 @@
 #include <mlpack/methods/kmeans/refined_start.hpp>
 #include <mlpack/methods/kmeans/elkan_kmeans.hpp>
 #include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/yinyang_kmeans.hpp>
 #include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
 #include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
 #include <mlpack/methods/kmeans/sample_initialization.hpp>
 #include <mlpack/methods/kmeans/random_partition.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
+#include <mlpack/methods/kmeans/streaming_kmeans.hpp>
+#include <mlpack/methods/kmeans/sharded_kmeans.hpp>
+#include <mlpack/methods/kmeans/kmeans_parallel_initialization.hpp>
 
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
@@ -572,6 +577,72 @@ BOOST_AUTO_TEST_CASE(HamerlyTest)
   }
 }
 
+/**
+ * Make sure Yinyang k-means gives the same clusters as the naive algorithm,
+ * with enough clusters to have several groups.
+ */
+BOOST_AUTO_TEST_CASE(YinyangTest)
+{
+  const size_t trials = 4;
+
+  for (size_t t = 0; t < trials; ++t)
+  {
+    arma::mat dataset(10, 2000);
+    dataset.randu();
+
+    const size_t k = 15 * (t + 1);
+    arma::mat centroids(10, k);
+    centroids.randu();
+
+    arma::mat naiveCentroids(centroids);
+    KMeans<> km;
+    arma::Row<size_t> assignments;
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+        YinyangKMeans> yinyang;
+    arma::Row<size_t> yinyangAssignments;
+    arma::mat yinyangCentroids(centroids);
+    yinyang.Cluster(dataset, k, yinyangAssignments, yinyangCentroids, false,
+        true);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], yinyangAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], yinyangCentroids[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure YinyangKMeans makes about k / 10 groups, assigns every point, and
+ * prunes most of the distance calculations.
+ */
+BOOST_AUTO_TEST_CASE(YinyangGroupsTest)
+{
+  arma::mat dataset(5, 3000);
+  dataset.randu();
+
+  const size_t k = 100;
+  arma::mat centroids = dataset.cols(0, k - 1);
+  arma::mat newCentroids;
+  arma::Col<size_t> counts;
+
+  metric::EuclideanDistance metric;
+  YinyangKMeans<metric::EuclideanDistance, arma::mat> yinyang(dataset, metric);
+  for (size_t i = 0; i < 20; ++i)
+  {
+    yinyang.Iterate(centroids, newCentroids, counts);
+    centroids = newCentroids;
+  }
+
+  BOOST_REQUIRE_EQUAL(yinyang.NumGroups(), 10);
+  BOOST_REQUIRE_EQUAL(arma::accu(counts), dataset.n_cols);
+
+  // The naive algorithm would need k distances for every point and iteration.
+  BOOST_REQUIRE_LT(yinyang.DistanceCalculations(), 20 * k * dataset.n_cols / 2);
+}
+
 BOOST_AUTO_TEST_CASE(PellegMooreTest)
 {
   const size_t trials = 5;
@@ -670,6 +741,72 @@ BOOST_AUTO_TEST_CASE(DTNNCoverTreeTest)
   }
 }
 
+/**
+ * Make sure that the Pelleg-Moore and dual-tree algorithms give the same
+ * clusters as the naive method on a dataset large enough for them to run in
+ * parallel, regardless of the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(TreeKMeansMultithreadedTest)
+{
+  arma::mat dataset(5, 10000);
+  dataset.randu();
+
+  const size_t k = 10;
+  arma::mat centroids(5, k);
+  centroids.randu();
+
+  arma::mat naiveCentroids(centroids);
+  KMeans<> km;
+  arma::Row<size_t> assignments;
+  km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      PellegMooreKMeans> pellegMoore;
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      DefaultDualTreeKMeans> dtnn;
+
+#ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  arma::Row<size_t> pmAssignments, dtnnAssignments;
+  arma::mat pmCentroids(centroids), dtnnCentroids(centroids);
+  pellegMoore.Cluster(dataset, k, pmAssignments, pmCentroids, false, true);
+  dtnn.Cluster(dataset, k, dtnnAssignments, dtnnCentroids, false, true);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(4);
+#endif
+
+  arma::Row<size_t> parallelPMAssignments, parallelDTNNAssignments;
+  arma::mat parallelPMCentroids(centroids), parallelDTNNCentroids(centroids);
+  pellegMoore.Cluster(dataset, k, parallelPMAssignments, parallelPMCentroids,
+      false, true);
+  dtnn.Cluster(dataset, k, parallelDTNNAssignments, parallelDTNNCentroids,
+      false, true);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(assignments[i], pmAssignments[i]);
+    BOOST_REQUIRE_EQUAL(assignments[i], dtnnAssignments[i]);
+    BOOST_REQUIRE_EQUAL(pmAssignments[i], parallelPMAssignments[i]);
+    BOOST_REQUIRE_EQUAL(dtnnAssignments[i], parallelDTNNAssignments[i]);
+  }
+
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(naiveCentroids[i], pmCentroids[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(naiveCentroids[i], dtnnCentroids[i], 1e-5);
+    BOOST_REQUIRE_EQUAL(pmCentroids[i], parallelPMCentroids[i]);
+    BOOST_REQUIRE_EQUAL(dtnnCentroids[i], parallelDTNNCentroids[i]);
+  }
+}
+
 /**
  * Make sure that the sample initialization strategy successfully samples points
  * from the dataset.
@@ -704,4 +841,377 @@ BOOST_AUTO_TEST_CASE(SampleInitializationTest)
   }
 }
 
+/**
+ * Make sure that the k-means|| initialization picks one point of each of a few
+ * well-separated clusters, and that the result does not depend on the number of
+ * threads.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationTest)
+{
+  // Eight clusters around the corners of a cube.
+  const size_t k = 8;
+  arma::mat centers(3, k);
+  for (size_t c = 0; c < k; ++c)
+    for (size_t d = 0; d < 3; ++d)
+      centers(d, c) = ((c >> d) & 1) ? 10.0 : -10.0;
+
+  arma::mat dataset(3, 200 * k);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = centers.col(i % k) + 0.1 * arma::randn<arma::vec>(3);
+
+#ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  math::RandomSeed(7);
+  KMeansParallelInitialization init;
+  arma::mat centroids;
+  init.Cluster(dataset, k, centroids);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(4);
+#endif
+
+  math::RandomSeed(7);
+  arma::mat parallelCentroids;
+  init.Cluster(dataset, k, parallelCentroids);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+
+  BOOST_REQUIRE_EQUAL(centroids.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, k);
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(centroids[i], parallelCentroids[i]);
+
+  // Each cluster must have exactly one centroid.
+  arma::Col<size_t> counts(k, arma::fill::zeros);
+  for (size_t c = 0; c < k; ++c)
+  {
+    for (size_t j = 0; j < k; ++j)
+    {
+      if (metric::EuclideanDistance::Evaluate(centroids.col(c),
+          centers.col(j)) < 1.0)
+        ++counts[j];
+    }
+  }
+
+  for (size_t j = 0; j < k; ++j)
+    BOOST_REQUIRE_EQUAL(counts[j], 1);
+}
+
+/**
+ * Make sure that ClusterRestarts() keeps a good clustering, that the returned
+ * inertia matches it, and that the result does not depend on the number of
+ * threads.
+ */
+BOOST_AUTO_TEST_CASE(KMeansClusterRestartsTest)
+{
+  const arma::mat dataset = trans(kMeansData);
+  KMeans<EuclideanDistance, KMeansParallelInitialization> kmeans;
+
+#ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  math::RandomSeed(11);
+  arma::Row<size_t> assignments;
+  arma::mat centroids;
+  const double inertia = kmeans.ClusterRestarts(dataset, 3, 6, assignments,
+      centroids);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(4);
+#endif
+
+  math::RandomSeed(11);
+  arma::Row<size_t> parallelAssignments;
+  arma::mat parallelCentroids;
+  const double parallelInertia = kmeans.ClusterRestarts(dataset, 3, 6,
+      parallelAssignments, parallelCentroids);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+
+  BOOST_REQUIRE_CLOSE(inertia, parallelInertia, 1e-5);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], parallelAssignments[i]);
+
+  // The three classes must be found.
+  for (size_t i = 1; i < 13; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], assignments[0]);
+  for (size_t i = 14; i < 20; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], assignments[13]);
+  for (size_t i = 21; i < 30; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], assignments[20]);
+  BOOST_REQUIRE_NE(assignments[0], assignments[13]);
+  BOOST_REQUIRE_NE(assignments[0], assignments[20]);
+  BOOST_REQUIRE_NE(assignments[13], assignments[20]);
+
+  double expectedInertia = 0.0;
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    expectedInertia += std::pow(EuclideanDistance::Evaluate(dataset.col(i),
+        centroids.col(assignments[i])), 2.0);
+  BOOST_REQUIRE_CLOSE(inertia, expectedInertia, 1e-5);
+
+  BOOST_REQUIRE_THROW(kmeans.ClusterRestarts(dataset, 3, 0, assignments,
+      centroids), std::invalid_argument);
+}
+
+/**
+ * Make sure that the parallel Lloyd iterations of the naive, Elkan and Hamerly
+ * algorithms give the same clusters as a single thread, and that repeated runs
+ * with the same number of threads give exactly the same result.
+ */
+BOOST_AUTO_TEST_CASE(ParallelLloydStepTest)
+{
+  arma::mat dataset(10, 3000);
+  dataset.randu();
+
+  const size_t k = 12;
+  arma::mat centroids(10, k);
+  centroids.randu();
+
+#ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  arma::mat serialCentroids(centroids);
+  KMeans<> km;
+  arma::Row<size_t> serialAssignments;
+  km.Cluster(dataset, k, serialAssignments, serialCentroids, false, true);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(4);
+#endif
+
+  arma::mat naiveCentroids(centroids), naiveCentroids2(centroids);
+  arma::Row<size_t> naiveAssignments, naiveAssignments2;
+  km.Cluster(dataset, k, naiveAssignments, naiveCentroids, false, true);
+  km.Cluster(dataset, k, naiveAssignments2, naiveCentroids2, false, true);
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      ElkanKMeans> elkan;
+  arma::mat elkanCentroids(centroids), elkanCentroids2(centroids);
+  arma::Row<size_t> elkanAssignments, elkanAssignments2;
+  elkan.Cluster(dataset, k, elkanAssignments, elkanCentroids, false, true);
+  elkan.Cluster(dataset, k, elkanAssignments2, elkanCentroids2, false, true);
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      HamerlyKMeans> hamerly;
+  arma::mat hamerlyCentroids(centroids), hamerlyCentroids2(centroids);
+  arma::Row<size_t> hamerlyAssignments, hamerlyAssignments2;
+  hamerly.Cluster(dataset, k, hamerlyAssignments, hamerlyCentroids, false,
+      true);
+  hamerly.Cluster(dataset, k, hamerlyAssignments2, hamerlyCentroids2, false,
+      true);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(serialAssignments[i], naiveAssignments[i]);
+    BOOST_REQUIRE_EQUAL(serialAssignments[i], elkanAssignments[i]);
+    BOOST_REQUIRE_EQUAL(serialAssignments[i], hamerlyAssignments[i]);
+  }
+
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(serialCentroids[i], naiveCentroids[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(serialCentroids[i], elkanCentroids[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(serialCentroids[i], hamerlyCentroids[i], 1e-5);
+
+    // Runs with the same number of threads must match exactly.
+    BOOST_REQUIRE_EQUAL(naiveCentroids[i], naiveCentroids2[i]);
+    BOOST_REQUIRE_EQUAL(elkanCentroids[i], elkanCentroids2[i]);
+    BOOST_REQUIRE_EQUAL(hamerlyCentroids[i], hamerlyCentroids2[i]);
+  }
+}
+
+/**
+ * Make sure that the blocked Euclidean iteration of NaiveKMeans, which finds
+ * the closest centroids with matrix products, assigns every point to its
+ * closest centroid.
+ */
+BOOST_AUTO_TEST_CASE(NaiveKMeansBlockedIterateTest)
+{
+  // Use a number of points that isn't a multiple of the block size.
+  arma::mat dataset(10, 1000);
+  dataset.randu();
+  arma::mat centroids(10, 7);
+  centroids.randu();
+
+  EuclideanDistance metric;
+  NaiveKMeans<EuclideanDistance, arma::mat> naive(dataset, metric);
+  arma::mat newCentroids;
+  arma::Col<size_t> counts;
+  naive.Iterate(centroids, newCentroids, counts);
+
+  // Compute the new centroids directly.
+  arma::mat expectedCentroids(10, 7, arma::fill::zeros);
+  arma::Col<size_t> expectedCounts(7, arma::fill::zeros);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    size_t closestCluster = 0;
+    double minDistance = DBL_MAX;
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      const double distance = metric.Evaluate(dataset.col(i),
+          centroids.col(j));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    expectedCentroids.col(closestCluster) += dataset.col(i);
+    expectedCounts[closestCluster]++;
+  }
+
+  for (size_t j = 0; j < centroids.n_cols; ++j)
+  {
+    BOOST_REQUIRE_EQUAL(counts[j], expectedCounts[j]);
+    if (expectedCounts[j] > 0)
+      expectedCentroids.col(j) /= expectedCounts[j];
+  }
+
+  for (size_t i = 0; i < newCentroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(newCentroids[i], expectedCentroids[i], 1e-5);
+}
+
+/**
+ * Make sure that mini-batch k-means finds the three simple clusters.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansTest)
+{
+  const arma::mat data = trans(kMeansData);
+
+  // Start with one point of each class, so that the result is not at the mercy
+  // of the initialization.
+  arma::mat centroids(2, 3);
+  centroids.col(0) = data.col(0);
+  centroids.col(1) = data.col(13);
+  centroids.col(2) = data.col(20);
+
+  KMeans<EuclideanDistance, SampleInitialization, AllowEmptyClusters,
+      MiniBatchKMeans> kmeans(50);
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(data, 3, assignments, centroids, false, true);
+
+  for (size_t i = 0; i < 13; i++)
+    BOOST_REQUIRE_EQUAL(assignments(i), 0);
+  for (size_t i = 13; i < 20; i++)
+    BOOST_REQUIRE_EQUAL(assignments(i), 1);
+  for (size_t i = 20; i < 30; i++)
+    BOOST_REQUIRE_EQUAL(assignments(i), 2);
+}
+
+/**
+ * Make sure that streaming k-means finds the centers of the three simple
+ * clusters when the data is given in batches.
+ */
+BOOST_AUTO_TEST_CASE(StreamingKMeansTest)
+{
+  const arma::mat data = trans(kMeansData);
+
+  arma::mat centroids(2, 3);
+  centroids.col(0) = data.col(0);
+  centroids.col(1) = data.col(13);
+  centroids.col(2) = data.col(20);
+
+  // Give the dataset in batches of 10 points, over several passes.
+  size_t calls = 0;
+  auto source = [&](arma::mat& batch)
+  {
+    if (calls == 30)
+      return false;
+
+    const size_t start = 10 * (calls++ % 3);
+    batch = data.cols(start, start + 9);
+    return true;
+  };
+
+  StreamingKMeans<> kmeans(0, 0.0);
+  kmeans.Cluster(source, 3, centroids, true);
+
+  // The source was exhausted.
+  BOOST_REQUIRE_EQUAL(calls, 30);
+  BOOST_REQUIRE_EQUAL(arma::accu(kmeans.Counts()), 300);
+
+  const arma::vec mean1 = arma::mean(data.cols(0, 12), 1);
+  const arma::vec mean2 = arma::mean(data.cols(13, 19), 1);
+  const arma::vec mean3 = arma::mean(data.cols(20, 29), 1);
+  BOOST_REQUIRE_LT(arma::norm(centroids.col(0) - mean1), 0.5);
+  BOOST_REQUIRE_LT(arma::norm(centroids.col(1) - mean2), 0.5);
+  BOOST_REQUIRE_LT(arma::norm(centroids.col(2) - mean3), 0.5);
+}
+
+/**
+ * ShardedKMeans gives the same clustering as KMeans on all of the points, when
+ * both start from the same centroids.
+ */
+BOOST_AUTO_TEST_CASE(ShardedKMeansTest)
+{
+  arma::mat data(3, 3000);
+  data.cols(0, 999) = arma::randn<arma::mat>(3, 1000);
+  data.cols(1000, 1999) = arma::randn<arma::mat>(3, 1000) + 6.0;
+  data.cols(2000, 2999) = arma::randn<arma::mat>(3, 1000) - 6.0;
+  data = arma::shuffle(data, 1);
+
+  arma::mat initialCentroids(3, 3);
+  initialCentroids.col(0) = data.col(0);
+  initialCentroids.col(1) = data.col(1);
+  initialCentroids.col(2) = data.col(2);
+
+  // Split the points into uneven shards.
+  std::vector<arma::mat> shards;
+  shards.push_back(data.cols(0, 99));
+  shards.push_back(data.cols(100, 1799));
+  shards.push_back(data.cols(1800, 2999));
+
+  arma::mat centroids(initialCentroids);
+  KMeans<EuclideanDistance, SampleInitialization, AllowEmptyClusters> kmeans;
+  kmeans.Cluster(data, 3, centroids, true);
+
+  arma::mat shardedCentroids(initialCentroids);
+  ShardedKMeans<> shardedKMeans;
+  shardedKMeans.Cluster(shards, 3, shardedCentroids, true);
+
+  CheckMatrices(shardedCentroids, centroids, 1e-5);
+  BOOST_REQUIRE_EQUAL(arma::accu(shardedKMeans.Counts()), 3000);
+
+  // Without initial centroids, the three clusters are still found.
+  ShardedKMeans<> sampledKMeans;
+  arma::mat sampledCentroids;
+  sampledKMeans.Cluster(shards, 3, sampledCentroids);
+  BOOST_REQUIRE_EQUAL(sampledCentroids.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(sampledCentroids.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(arma::accu(sampledKMeans.Counts()), 3000);
+}
+
+/**
+ * ShardedKMeans rejects shards of different dimensionalities.
+ */
+BOOST_AUTO_TEST_CASE(ShardedKMeansInvalidShardsTest)
+{
+  std::vector<arma::mat> shards;
+  shards.push_back(arma::randu<arma::mat>(3, 10));
+  shards.push_back(arma::randu<arma::mat>(4, 10));
+
+  ShardedKMeans<> kmeans;
+  arma::mat centroids;
+  BOOST_REQUIRE_THROW(kmeans.Cluster(shards, 2, centroids),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(kmeans.Cluster(std::vector<arma::mat>(), 2, centroids),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
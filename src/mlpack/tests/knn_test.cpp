@@ -12,10 +12,16 @@
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/methods/neighbor_search/unmap.hpp>
 #include <mlpack/methods/neighbor_search/ns_model.hpp>
+#include <mlpack/methods/neighbor_search/dynamic_neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/inverted_index_search.hpp>
+#include <mlpack/methods/neighbor_search/sharded_neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/disk_neighbor_search.hpp>
+#include <mlpack/core/data/batch_source.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 using namespace mlpack;
 using namespace mlpack::neighbor;
@@ -719,6 +725,360 @@ BOOST_AUTO_TEST_CASE(DualTreeVsNaive2)
   }
 }
 
+/**
+ * Make sure that the dual-tree search gives the same results as naive search
+ * when the traversal is split across several threads, for both bichromatic and
+ * monochromatic search and for a tree that does not rearrange its dataset.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeVsNaive)
+{
+/**
+ * Searching with 32-bit neighbor indices gives the same results as with
+ * size_t, and an index type too small for the reference set is rejected.
+ */
+BOOST_AUTO_TEST_CASE(SmallIndexTypeTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 300);
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+
+  const NeighborSearchMode modes[] = { NAIVE_MODE, SINGLE_TREE_MODE,
+      DUAL_TREE_MODE };
+  for (const NeighborSearchMode mode : modes)
+  {
+    KNN knn(referenceData, mode);
+
+    arma::Mat<size_t> neighbors;
+    arma::Mat<uint32_t> smallNeighbors;
+    arma::mat distances, smallDistances;
+
+    knn.Search(queryData, 5, neighbors, distances);
+    knn.Search(queryData, 5, smallNeighbors, smallDistances);
+    CheckMatrices(neighbors,
+        arma::conv_to<arma::Mat<size_t>>::from(smallNeighbors));
+    CheckMatrices(distances, smallDistances);
+
+    knn.Search(5, neighbors, distances);
+    knn.Search(5, smallNeighbors, smallDistances);
+    CheckMatrices(neighbors,
+        arma::conv_to<arma::Mat<size_t>>::from(smallNeighbors));
+    CheckMatrices(distances, smallDistances);
+
+    // 300 points can't be indexed with 8 bits.
+    arma::Mat<uint8_t> tinyNeighbors;
+    BOOST_REQUIRE_THROW(knn.Search(queryData, 5, tinyNeighbors, distances),
+        std::invalid_argument);
+  }
+}
+
+/**
+ * A filtered search finds the k nearest eligible reference points of every
+ * query point, as a brute-force search over the eligible points does, in every
+ * mode and with a tree that rearranges the points or not.
+ */
+template<typename KNNType>
+void CheckFilteredSearch(const NeighborSearchMode mode)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 500);
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+
+  // Three groups with about a third of the points each, and one with only two
+  // eligible points.
+  std::vector<std::vector<bool>> eligible(4,
+      std::vector<bool>(referenceData.n_cols, false));
+  for (size_t i = 0; i < referenceData.n_cols; ++i)
+    for (size_t g = 0; g < 3; ++g)
+      eligible[g][i] = (math::RandInt(3) == 0);
+  eligible[3][17] = true;
+  eligible[3][302] = true;
+
+  arma::Row<size_t> queryGroups(queryData.n_cols);
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+    queryGroups[i] = math::RandInt(4);
+
+  const size_t k = 5;
+  KNNType knn(referenceData, mode);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(queryData, k, queryGroups, eligible, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, queryData.n_cols);
+  for (size_t q = 0; q < queryData.n_cols; ++q)
+  {
+    // The distances to the eligible points, sorted.
+    std::vector<std::pair<double, size_t>> candidates;
+    for (size_t r = 0; r < referenceData.n_cols; ++r)
+    {
+      if (eligible[queryGroups[q]][r])
+      {
+        candidates.push_back(std::make_pair(metric::EuclideanDistance::Evaluate(
+            queryData.col(q), referenceData.col(r)), r));
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (size_t j = 0; j < k; ++j)
+    {
+      if (j < candidates.size())
+      {
+        BOOST_REQUIRE_EQUAL(neighbors(j, q), candidates[j].second);
+        BOOST_REQUIRE_CLOSE(distances(j, q), candidates[j].first, 1e-5);
+      }
+      else
+      {
+        BOOST_REQUIRE_EQUAL(neighbors(j, q), size_t() - 1);
+        BOOST_REQUIRE_EQUAL(distances(j, q), DBL_MAX);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FilteredSearchTest)
+{
+  CheckFilteredSearch<KNN>(NAIVE_MODE);
+  CheckFilteredSearch<KNN>(SINGLE_TREE_MODE);
+  CheckFilteredSearch<KNN>(DUAL_TREE_MODE);
+  CheckFilteredSearch<KNN>(BEST_FIRST_SINGLE_TREE_MODE);
+  CheckFilteredSearch<NeighborSearch<NearestNeighborSort,
+      metric::EuclideanDistance, arma::mat, tree::StandardCoverTree>>(
+      SINGLE_TREE_MODE);
+}
+
+/**
+ * Traversing the query points along the Hilbert curve must not change the
+ * results of single-tree searches.
+ */
+BOOST_AUTO_TEST_CASE(ReorderQueriesTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 500);
+
+  // The order is a permutation of the query points.
+  std::vector<size_t> order;
+  tree::HilbertOrder(queryData, order);
+  BOOST_REQUIRE_EQUAL(order.size(), queryData.n_cols);
+  std::vector<size_t> sorted(order);
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); ++i)
+    BOOST_REQUIRE_EQUAL(sorted[i], i);
+
+  const NeighborSearchMode modes[] = { SINGLE_TREE_MODE,
+      GREEDY_SINGLE_TREE_MODE, BEST_FIRST_SINGLE_TREE_MODE };
+  for (const NeighborSearchMode mode : modes)
+  {
+    KNN knn(referenceData, mode);
+
+    arma::Mat<size_t> neighbors, reorderedNeighbors;
+    arma::mat distances, reorderedDistances;
+    knn.Search(queryData, 5, neighbors, distances);
+
+    knn.ReorderQueries() = true;
+    knn.Search(queryData, 5, reorderedNeighbors, reorderedDistances);
+
+    CheckMatrices(neighbors, reorderedNeighbors);
+    CheckMatrices(distances, reorderedDistances);
+  }
+}
+
+#ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(4);
+#endif
+
+  arma::mat referenceData = arma::randu<arma::mat>(3, 2000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 1500);
+
+  KNN naive(referenceData, NAIVE_MODE);
+  KNN knn(referenceData);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, RTree>
+      rTreeSearch(referenceData);
+
+  arma::Mat<size_t> neighborsNaive, neighborsTree;
+  arma::mat distancesNaive, distancesTree;
+
+  naive.Search(queryData, 5, neighborsNaive, distancesNaive);
+  knn.Search(queryData, 5, neighborsTree, distancesTree);
+  CheckMatrices(neighborsNaive, neighborsTree);
+  CheckMatrices(distancesNaive, distancesTree);
+
+  rTreeSearch.Search(queryData, 5, neighborsTree, distancesTree);
+  CheckMatrices(neighborsNaive, neighborsTree);
+  CheckMatrices(distancesNaive, distancesTree);
+
+  naive.Search(5, neighborsNaive, distancesNaive);
+  knn.Search(5, neighborsTree, distancesTree);
+  CheckMatrices(neighborsNaive, neighborsTree);
+  CheckMatrices(distancesNaive, distancesTree);
+
+  rTreeSearch.Search(5, neighborsTree, distancesTree);
+  CheckMatrices(neighborsNaive, neighborsTree);
+  CheckMatrices(distancesNaive, distancesTree);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+}
+
+/**
+ * Make sure that dual-tree and single-tree search with OctreeKNN, whose tree is
+ * built from the Morton order of the points, give the same results as naive
+ * search on a large low-dimensional dataset.
+ */
+BOOST_AUTO_TEST_CASE(OctreeKNNVsNaive)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 20000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 1000);
+
+  KNN naive(referenceData, NAIVE_MODE);
+  OctreeKNN octreeSearch(referenceData);
+
+  arma::Mat<size_t> neighborsNaive, neighborsTree;
+  arma::mat distancesNaive, distancesTree;
+
+  naive.Search(queryData, 5, neighborsNaive, distancesNaive);
+  octreeSearch.Search(queryData, 5, neighborsTree, distancesTree);
+  CheckMatrices(neighborsNaive, neighborsTree);
+  CheckMatrices(distancesNaive, distancesTree);
+
+  octreeSearch.SearchMode() = SINGLE_TREE_MODE;
+  octreeSearch.Search(queryData, 5, neighborsTree, distancesTree);
+  CheckMatrices(neighborsNaive, neighborsTree);
+  CheckMatrices(distancesNaive, distancesTree);
+}
+
+/**
+ * Make sure that dual-tree search on high-dimensional data, where the leaf base
+ * cases are computed with a matrix multiplication, gives the same results as
+ * naive search.
+ */
+BOOST_AUTO_TEST_CASE(HighDimensionalDualTreeVsNaive)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(80, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(80, 400);
+
+  KNN naive(referenceData, NAIVE_MODE);
+  KNN knn(referenceData);
+
+  arma::Mat<size_t> neighborsNaive, neighborsTree;
+  arma::mat distancesNaive, distancesTree;
+
+  naive.Search(queryData, 10, neighborsNaive, distancesNaive);
+  knn.Search(queryData, 10, neighborsTree, distancesTree);
+  CheckMatrices(neighborsNaive, neighborsTree);
+  CheckMatrices(distancesNaive, distancesTree);
+
+  naive.Search(10, neighborsNaive, distancesNaive);
+  knn.Search(10, neighborsTree, distancesTree);
+  CheckMatrices(neighborsNaive, neighborsTree);
+  CheckMatrices(distancesNaive, distancesTree);
+}
+
+/**
+ * Make sure that the tiled naive search, which spans several blocks of query
+ * and reference points here, finds the same neighbors as a plain brute-force
+ * loop, for both the bichromatic and the monochromatic search.
+ */
+BOOST_AUTO_TEST_CASE(NaiveTiledSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(40, 2500);
+  arma::mat queryData = arma::randu<arma::mat>(40, 150);
+  const size_t k = 7;
+
+  KNN naive(referenceData, NAIVE_MODE);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  naive.Search(queryData, k, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, queryData.n_cols);
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+  {
+    arma::vec allDistances(referenceData.n_cols);
+    for (size_t j = 0; j < referenceData.n_cols; ++j)
+    {
+      allDistances[j] = EuclideanDistance::Evaluate(queryData.col(i),
+          referenceData.col(j));
+    }
+
+    const arma::uvec order = arma::sort_index(allDistances);
+    for (size_t j = 0; j < k; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, i), order[j]);
+      BOOST_REQUIRE_CLOSE(distances(j, i), allDistances[order[j]], 1e-5);
+    }
+  }
+
+  naive.Search(k, neighbors, distances);
+  for (size_t i = 0; i < referenceData.n_cols; i += 97)
+  {
+    arma::vec allDistances(referenceData.n_cols);
+    for (size_t j = 0; j < referenceData.n_cols; ++j)
+    {
+      allDistances[j] = EuclideanDistance::Evaluate(referenceData.col(i),
+          referenceData.col(j));
+    }
+    allDistances[i] = DBL_MAX;
+
+    const arma::uvec order = arma::sort_index(allDistances);
+    for (size_t j = 0; j < k; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, i), order[j]);
+      BOOST_REQUIRE_CLOSE(distances(j, i), allDistances[order[j]], 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure the k-nearest-neighbor graph holds the results of monochromatic
+ * search, for the symmetric naive traversal and the dual-tree search, and that
+ * the symmetrized graph is the union of both directions.
+ */
+BOOST_AUTO_TEST_CASE(KNNGraphTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1100);
+  const size_t k = 5;
+
+  KNN naive(referenceData, NAIVE_MODE);
+  KNN dualTree(referenceData);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  dualTree.Search(k, neighbors, distances);
+
+  arma::sp_mat naiveGraph, dualTreeGraph;
+  naive.Search(k, naiveGraph);
+  dualTree.Search(k, dualTreeGraph);
+
+  BOOST_REQUIRE_EQUAL(naiveGraph.n_rows, referenceData.n_cols);
+  BOOST_REQUIRE_EQUAL(naiveGraph.n_cols, referenceData.n_cols);
+  BOOST_REQUIRE_EQUAL(naiveGraph.n_nonzero, k * referenceData.n_cols);
+  BOOST_REQUIRE_EQUAL(dualTreeGraph.n_nonzero, k * referenceData.n_cols);
+  for (size_t i = 0; i < referenceData.n_cols; ++i)
+  {
+    for (size_t j = 0; j < k; ++j)
+    {
+      BOOST_REQUIRE_CLOSE((double) naiveGraph(neighbors(j, i), i),
+          distances(j, i), 1e-5);
+      BOOST_REQUIRE_CLOSE((double) dualTreeGraph(neighbors(j, i), i),
+          distances(j, i), 1e-5);
+    }
+  }
+
+  arma::sp_mat symmetricGraph;
+  naive.Search(k, symmetricGraph, true);
+  BOOST_REQUIRE_EQUAL(arma::accu(arma::abs(symmetricGraph -
+      symmetricGraph.t())), 0.0);
+  BOOST_REQUIRE_GE(symmetricGraph.n_nonzero, naiveGraph.n_nonzero);
+  for (arma::sp_mat::const_iterator it = symmetricGraph.begin();
+       it != symmetricGraph.end(); ++it)
+  {
+    const double distance = std::max((double) naiveGraph(it.row(), it.col()),
+        (double) naiveGraph(it.col(), it.row()));
+    BOOST_REQUIRE_CLOSE(*it, distance, 1e-5);
+  }
+}
+
 /**
  * Test the single-tree nearest-neighbors method with the naive method.  This
  * uses only a reference dataset.
@@ -820,6 +1180,45 @@ BOOST_AUTO_TEST_CASE(DualCoverTreeTest)
   }
 }
 
+/**
+ * The cover tree traverser with flat reference sets must give the same results
+ * as the default dual-tree traverser, with the same number of base cases.
+ */
+BOOST_AUTO_TEST_CASE(FlatDualCoverTreeTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 2000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 500);
+
+  typedef StandardCoverTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> TreeType;
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> coverTreeSearch(referenceData);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree, TreeType::FlatDualTreeTraverser>
+      flatSearch(referenceData);
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    arma::Mat<size_t> neighbors, flatNeighbors;
+    arma::mat distances, flatDistances;
+    if (trial == 0)
+    {
+      coverTreeSearch.Search(queryData, 5, neighbors, distances);
+      flatSearch.Search(queryData, 5, flatNeighbors, flatDistances);
+    }
+    else
+    {
+      coverTreeSearch.Search(5, neighbors, distances);
+      flatSearch.Search(5, flatNeighbors, flatDistances);
+    }
+
+    BOOST_REQUIRE_EQUAL(flatSearch.BaseCases(), coverTreeSearch.BaseCases());
+    CheckMatrices(neighbors, flatNeighbors);
+    CheckMatrices(distances, flatDistances);
+  }
+}
+
 /**
  * Test the ball tree single-tree nearest-neighbors method against the naive
  * method.  This uses only a random reference dataset.
@@ -1225,6 +1624,612 @@ BOOST_AUTO_TEST_CASE(KNNModelMonochromaticTest)
   }
 }
 
+/**
+ * Make sure NSModel::SelectTree() chooses an exact tree type and one of the
+ * candidate leaf sizes, that the model built with it finds the right
+ * neighbors, and that the choice is saved with the model.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelSelectTreeTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(4, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(4, 1000);
+
+  KNN knn(referenceData, NAIVE_MODE);
+  arma::Mat<size_t> baselineNeighbors;
+  arma::mat baselineDistances;
+  knn.Search(queryData, 3, baselineNeighbors, baselineDistances);
+
+  KNNModel model;
+  model.SelectTree(referenceData, 3, DUAL_TREE_MODE, 0, 500, 100);
+  BOOST_REQUIRE(model.TreeType() != KNNModel::SPILL_TREE);
+  if (model.TreeType() != KNNModel::COVER_TREE)
+  {
+    BOOST_REQUIRE(model.LeafSize() == 10 || model.LeafSize() == 20 ||
+        model.LeafSize() == 40);
+  }
+
+  model.BuildModel(arma::mat(referenceData), model.LeafSize(),
+      DUAL_TREE_MODE);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  model.Search(arma::mat(queryData), 3, neighbors, distances);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], baselineNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], baselineDistances[i], 1e-5);
+  }
+
+  KNNModel xmlModel, textModel, binaryModel;
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+  BOOST_REQUIRE(xmlModel.TreeType() == model.TreeType());
+  BOOST_REQUIRE(textModel.TreeType() == model.TreeType());
+  BOOST_REQUIRE(binaryModel.TreeType() == model.TreeType());
+  BOOST_REQUIRE_EQUAL(xmlModel.LeafSize(), model.LeafSize());
+  BOOST_REQUIRE_EQUAL(textModel.LeafSize(), model.LeafSize());
+  BOOST_REQUIRE_EQUAL(binaryModel.LeafSize(), model.LeafSize());
+}
+
+/**
+ * Make sure that an NSModel holding a single-precision reference set gives the
+ * same distances as a double-precision naive search, for a few tree types.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelFloatTest)
+{
+  typedef NSModel<NearestNeighborSort, arma::fmat> FloatKNNModel;
+
+  arma::fmat referenceData = arma::randu<arma::fmat>(10, 200);
+  arma::fmat queryData = arma::randu<arma::fmat>(10, 50);
+
+  // Get a baseline with the data converted to double precision.
+  KNN knn(arma::conv_to<arma::mat>::from(referenceData));
+  arma::Mat<size_t> baselineNeighbors;
+  arma::mat baselineDistances;
+  knn.Search(arma::conv_to<arma::mat>::from(queryData), 3, baselineNeighbors,
+      baselineDistances);
+
+  const FloatKNNModel::TreeTypes treeTypes[] = {
+      FloatKNNModel::TreeTypes::KD_TREE,
+      FloatKNNModel::TreeTypes::COVER_TREE,
+      FloatKNNModel::TreeTypes::R_TREE,
+      FloatKNNModel::TreeTypes::R_STAR_TREE,
+      FloatKNNModel::TreeTypes::BALL_TREE,
+      FloatKNNModel::TreeTypes::VP_TREE,
+      FloatKNNModel::TreeTypes::SPILL_TREE,
+      FloatKNNModel::TreeTypes::OCTREE };
+
+  for (size_t i = 0; i < 8; ++i)
+  {
+    for (size_t j = 0; j < 2; ++j)
+    {
+      FloatKNNModel model(treeTypes[i], j == 0);
+
+      arma::fmat referenceCopy(referenceData);
+      arma::fmat queryCopy(queryData);
+      model.BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+
+      arma::Mat<size_t> neighbors;
+      arma::mat distances;
+      model.Search(std::move(queryCopy), 3, neighbors, distances);
+
+      BOOST_REQUIRE_EQUAL(neighbors.n_rows, baselineNeighbors.n_rows);
+      BOOST_REQUIRE_EQUAL(neighbors.n_cols, baselineNeighbors.n_cols);
+      BOOST_REQUIRE_EQUAL(distances.n_rows, baselineDistances.n_rows);
+      BOOST_REQUIRE_EQUAL(distances.n_cols, baselineDistances.n_cols);
+
+      // Distances are only computed in single precision, so neighbors may be
+      // reordered when they are (nearly) tied; compare the distances only.
+      for (size_t k = 0; k < distances.n_elem; ++k)
+        BOOST_REQUIRE_CLOSE(distances[k], baselineDistances[k], 1e-3);
+    }
+  }
+}
+
+/**
+ * Make sure that a KNNModel with the transformation of a Mahalanobis distance
+ * finds the same neighbors as brute-force search with that distance.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelTransformationTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat referenceData = arma::randu<arma::mat>(5, 200);
+  arma::mat queryData = arma::randu<arma::mat>(5, 20);
+
+  arma::mat a = arma::randn<arma::mat>(5, 5);
+  MahalanobisDistance<true> md(a * a.t() + 0.1 * arma::eye<arma::mat>(5, 5));
+
+  const KNNModel::TreeTypes treeTypes[] = { KNNModel::TreeTypes::KD_TREE,
+                                            KNNModel::TreeTypes::BALL_TREE };
+  for (size_t t = 0; t < 2; ++t)
+  {
+    KNNModel model(treeTypes[t]);
+    model.Transformation() = md.Transformation();
+
+    arma::mat referenceCopy(referenceData);
+    arma::mat queryCopy(queryData);
+    model.BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    model.Search(std::move(queryCopy), 3, neighbors, distances);
+
+    BOOST_REQUIRE_EQUAL(neighbors.n_rows, 3);
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, queryData.n_cols);
+
+    for (size_t i = 0; i < queryData.n_cols; ++i)
+    {
+      arma::vec trueDistances(referenceData.n_cols);
+      for (size_t j = 0; j < referenceData.n_cols; ++j)
+        trueDistances[j] = md.Evaluate(queryData.col(i), referenceData.col(j));
+      const arma::vec sorted = arma::sort(trueDistances);
+
+      for (size_t k = 0; k < 3; ++k)
+      {
+        BOOST_REQUIRE_CLOSE(distances(k, i), sorted[k], 1e-5);
+        BOOST_REQUIRE_CLOSE(trueDistances[neighbors(k, i)], sorted[k], 1e-5);
+      }
+    }
+  }
+
+  // A transformation of the wrong size is rejected.
+  KNNModel model;
+  model.Transformation() = arma::eye<arma::mat>(3, 3);
+  arma::mat referenceCopy(referenceData);
+  BOOST_REQUIRE_THROW(model.BuildModel(std::move(referenceCopy), 20,
+      DUAL_TREE_MODE), std::invalid_argument);
+}
+
+/**
+ * Make sure that searching with a SearchContext gives the same results as the
+ * regular Search(), when the context is reused for query sets of different
+ * sizes and in every search mode.
+ */
+BOOST_AUTO_TEST_CASE(SearchContextTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 500);
+  arma::mat queryData = arma::randu<arma::mat>(5, 200);
+
+  const NeighborSearchMode modes[] = { NAIVE_MODE, SINGLE_TREE_MODE,
+      DUAL_TREE_MODE, GREEDY_SINGLE_TREE_MODE, BEST_FIRST_SINGLE_TREE_MODE };
+  for (size_t m = 0; m < 5; ++m)
+  {
+    KNN knn(referenceData, modes[m]);
+    knn.MaxLeaves() = 3;
+    KNN::SearchContext context(10);
+
+    arma::Mat<size_t> neighbors, baselineNeighbors;
+    arma::mat distances, baselineDistances;
+
+    // Batches are smaller and larger than MaxSingleTreeBatch().
+    const size_t batchSizes[] = { 1, 10, 3, 50, 10 };
+    size_t begin = 0;
+    for (size_t b = 0; b < 5; ++b)
+    {
+      const arma::mat batch = queryData.cols(begin,
+          begin + batchSizes[b] - 1);
+      begin += batchSizes[b];
+
+      knn.Search(batch, 4, neighbors, distances, context);
+      knn.Search(batch, 4, baselineNeighbors, baselineDistances);
+
+      CheckMatrices(neighbors, baselineNeighbors);
+      CheckMatrices(distances, baselineDistances);
+    }
+  }
+}
+
+/**
+ * Without a budget, best-first search must be exact with any tree type.
+ */
+template<typename NSType>
+void CheckBestFirstSearch(const arma::mat& referenceData,
+                          const arma::mat& queryData)
+{
+  KNN naive(referenceData, NAIVE_MODE);
+  NSType bestFirst(referenceData, BEST_FIRST_SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+  naive.Search(queryData, 5, naiveNeighbors, naiveDistances);
+  bestFirst.Search(queryData, 5, neighbors, distances);
+
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  // Monochromatic search too.
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  bestFirst.Search(5, neighbors, distances);
+
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+BOOST_AUTO_TEST_CASE(BestFirstSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(4, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(4, 200);
+
+  CheckBestFirstSearch<KNN>(referenceData, queryData);
+  CheckBestFirstSearch<NeighborSearch<NearestNeighborSort, EuclideanDistance,
+      arma::mat, StandardCoverTree>>(referenceData, queryData);
+  CheckBestFirstSearch<NeighborSearch<NearestNeighborSort, EuclideanDistance,
+      arma::mat, RTree>>(referenceData, queryData);
+  CheckBestFirstSearch<NeighborSearch<NearestNeighborSort, EuclideanDistance,
+      arma::mat, Octree>>(referenceData, queryData);
+}
+
+/**
+ * Spill trees hold the points of the overlap of two children in both of them;
+ * best-first search must still be exact and return every neighbor only once.
+ */
+BOOST_AUTO_TEST_CASE(BestFirstSpillTreeSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(4, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(4, 200);
+
+  KNN naive(referenceData, NAIVE_MODE);
+  SpillKNN::Tree referenceTree(referenceData, 0.1 /* tau parameter */);
+  SpillKNN spillSearch(std::move(referenceTree), BEST_FIRST_SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+  naive.Search(queryData, 5, naiveNeighbors, naiveDistances);
+  spillSearch.Search(queryData, 5, neighbors, distances);
+
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+/**
+ * Best-first search only visits the leaves that depth-first search can't
+ * prune, so it never needs more base cases.
+ */
+BOOST_AUTO_TEST_CASE(BestFirstSearchBaseCasesTest)
+{
+  // Clustered data, where the order of the traversal matters most.
+  arma::mat referenceData(3, 4000);
+  for (size_t c = 0; c < 8; ++c)
+  {
+    referenceData.cols(500 * c, 500 * c + 499) = 0.05 *
+        arma::randn<arma::mat>(3, 500) + arma::repmat(
+        10 * arma::randu<arma::vec>(3), 1, 500);
+  }
+
+  KNN depthFirst(referenceData, SINGLE_TREE_MODE);
+  KNN bestFirst(referenceData, BEST_FIRST_SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighbors, depthFirstNeighbors;
+  arma::mat distances, depthFirstDistances;
+  depthFirst.Search(1, depthFirstNeighbors, depthFirstDistances);
+  bestFirst.Search(1, neighbors, distances);
+
+  CheckMatrices(neighbors, depthFirstNeighbors);
+  CheckMatrices(distances, depthFirstDistances);
+  BOOST_REQUIRE_LE(bestFirst.BaseCases(), depthFirst.BaseCases());
+}
+
+/**
+ * With a budget of leaves, best-first search must return true distances to the
+ * neighbors it finds, and a larger budget must never give worse neighbors.
+ */
+BOOST_AUTO_TEST_CASE(BestFirstSearchBudgetTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(6, 5000);
+  arma::mat queryData = arma::randu<arma::mat>(6, 100);
+
+  KNN knn(referenceData, BEST_FIRST_SINGLE_TREE_MODE);
+  arma::Mat<size_t> exactNeighbors;
+  arma::mat exactDistances;
+  knn.Search(queryData, 3, exactNeighbors, exactDistances);
+
+  arma::mat lastDistances = arma::mat(3, queryData.n_cols);
+  lastDistances.fill(DBL_MAX);
+  size_t lastBaseCases = 0;
+  const size_t budgets[] = { 1, 2, 8, 32 };
+  for (size_t b = 0; b < 4; ++b)
+  {
+    knn.MaxLeaves() = budgets[b];
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    knn.Search(queryData, 3, neighbors, distances);
+
+    BOOST_REQUIRE_GT(knn.BaseCases(), lastBaseCases);
+    lastBaseCases = knn.BaseCases();
+
+    for (size_t i = 0; i < queryData.n_cols; ++i)
+    {
+      for (size_t j = 0; j < 3; ++j)
+      {
+        BOOST_REQUIRE_CLOSE(distances(j, i), EuclideanDistance::Evaluate(
+            queryData.col(i), referenceData.col(neighbors(j, i))), 1e-5);
+        BOOST_REQUIRE_GE(distances(j, i), exactDistances(j, i) - 1e-10);
+      }
+
+      BOOST_REQUIRE_LE(distances(2, i), lastDistances(2, i));
+    }
+
+    lastDistances = distances;
+  }
+
+  // An exhausted time limit stops each query after its first leaf.
+  knn.MaxLeaves() = 0;
+  knn.TimeLimit() = 1e-12;
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(queryData, 3, neighbors, distances);
+  BOOST_REQUIRE_LT(knn.BaseCases(), lastBaseCases);
+}
+
+/**
+ * Check the results of a DynamicNeighborSearch against a naive search on the
+ * points that are in its reference set.
+ */
+template<typename DynamicType>
+void CheckDynamicSearch(DynamicType& dynamic,
+                        const arma::mat& points,
+                        const arma::mat& querySet,
+                        const size_t k)
+{
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < points.n_cols; ++i)
+    if (dynamic.Contains(i))
+      indices.push_back(i);
+  BOOST_REQUIRE_EQUAL(dynamic.NumPoints(), indices.size());
+
+  arma::mat livePoints(points.n_rows, indices.size());
+  for (size_t i = 0; i < indices.size(); ++i)
+    livePoints.col(i) = points.col(indices[i]);
+
+  KNN naive(livePoints, NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(querySet, k, naiveNeighbors, naiveDistances);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  dynamic.Search(querySet, k, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, querySet.n_cols);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], indices[naiveNeighbors[i]]);
+    BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure DynamicNeighborSearch gives the right results as points are
+ * inserted and deleted, and after it is compacted.
+ */
+BOOST_AUTO_TEST_CASE(DynamicNeighborSearchTest)
+{
+  // All the points that will ever be inserted; the first 300 are the initial
+  // reference set.
+  arma::mat points = arma::randu<arma::mat>(4, 600);
+  arma::mat querySet = arma::randu<arma::mat>(4, 40);
+
+  DynamicNeighborSearch<> dynamic(points.cols(0, 299), 16);
+  CheckDynamicSearch(dynamic, points, querySet, 5);
+
+  // Insert the other points.
+  for (size_t i = 300; i < 600; ++i)
+    BOOST_REQUIRE_EQUAL(dynamic.Insert(points.col(i)), i);
+  BOOST_REQUIRE_LT(dynamic.NumBufferedPoints(), 16);
+  BOOST_REQUIRE_GT(dynamic.NumTrees(), 1);
+  CheckDynamicSearch(dynamic, points, querySet, 5);
+
+  // Delete two thirds of the points, whether they are in trees or buffered.
+  for (size_t i = 0; i < 600; ++i)
+    if (i % 3 != 0)
+      dynamic.Delete(i);
+  BOOST_REQUIRE_EQUAL(dynamic.NumPoints(), 200);
+  BOOST_REQUIRE(!dynamic.Contains(1));
+  BOOST_REQUIRE_THROW(dynamic.Delete(1), std::invalid_argument);
+  CheckDynamicSearch(dynamic, points, querySet, 5);
+
+  dynamic.Compact();
+  BOOST_REQUIRE_EQUAL(dynamic.NumTrees(), 1);
+  BOOST_REQUIRE_EQUAL(dynamic.NumBufferedPoints(), 0);
+  CheckDynamicSearch(dynamic, points, querySet, 5);
+
+  // Too many neighbors.
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  BOOST_REQUIRE_THROW(dynamic.Search(querySet, 201, neighbors, distances),
+      std::invalid_argument);
+}
+
+/**
+ * DynamicNeighborSearch should also work with a tree that does not rearrange
+ * its points, starting from an empty reference set.
+ */
+BOOST_AUTO_TEST_CASE(DynamicNeighborSearchCoverTreeTest)
+{
+  arma::mat points = arma::randu<arma::mat>(3, 200);
+  arma::mat querySet = arma::randu<arma::mat>(3, 20);
+
+  DynamicNeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> dynamic(8);
+  for (size_t i = 0; i < 200; ++i)
+    dynamic.Insert(points.col(i));
+  for (size_t i = 0; i < 200; i += 2)
+    dynamic.Delete(i);
+
+  CheckDynamicSearch(dynamic, points, querySet, 3);
+}
+
+/**
+ * Check the results of a ShardedNeighborSearch against a naive search on the
+ * whole reference set.
+ */
+template<typename ShardedType, typename NaiveType>
+void CheckShardedSearch(ShardedType& sharded,
+                        const arma::mat& referenceSet,
+                        const arma::mat& querySet,
+                        const size_t k)
+{
+  NaiveType naive(referenceSet, NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(querySet, k, naiveNeighbors, naiveDistances);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  sharded.Search(querySet, k, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, querySet.n_cols);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], naiveNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure ShardedNeighborSearch gives the same results as a search on the
+ * whole reference set, for different numbers of shards and search modes.
+ */
+BOOST_AUTO_TEST_CASE(ShardedNeighborSearchTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(4, 500);
+  arma::mat querySet = arma::randu<arma::mat>(4, 50);
+
+  const NeighborSearchMode modes[] = { NAIVE_MODE, SINGLE_TREE_MODE,
+      DUAL_TREE_MODE };
+  const size_t numShards[] = { 1, 3, 7 };
+  for (const NeighborSearchMode mode : modes)
+  {
+    for (const size_t shards : numShards)
+    {
+      ShardedNeighborSearch<> sharded(referenceSet, shards, mode);
+      BOOST_REQUIRE_EQUAL(sharded.NumShards(), shards);
+      BOOST_REQUIRE_EQUAL(sharded.NumPoints(), 500);
+      CheckShardedSearch<ShardedNeighborSearch<>, KNN>(sharded, referenceSet,
+          querySet, 6);
+    }
+  }
+
+  // Furthest neighbors work too, with another tree type.
+  ShardedNeighborSearch<FurthestNeighborSort, EuclideanDistance, arma::mat,
+      tree::BallTree> furthest(referenceSet, 4);
+  CheckShardedSearch<decltype(furthest), KFN>(furthest, referenceSet,
+      querySet, 3);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  ShardedNeighborSearch<> sharded(referenceSet, 3);
+  BOOST_REQUIRE_THROW(sharded.Search(querySet, 501, neighbors, distances),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(ShardedNeighborSearch<>(referenceSet, 0),
+      std::invalid_argument);
+}
+
+/**
+ * When the shards are spatially coherent, most of the searches in remote
+ * shards should be pruned, and the results must stay exact.  The shards are
+ * given separately here, so the indices follow their order.
+ */
+BOOST_AUTO_TEST_CASE(ShardedNeighborSearchPruningTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(3, 800);
+  arma::mat querySet = arma::randu<arma::mat>(3, 100);
+
+  // Sort the points along the first dimension, and cut them into slabs.
+  const arma::uvec order = arma::sort_index(referenceSet.row(0));
+  referenceSet = referenceSet.cols(order);
+
+  std::vector<arma::mat> shards;
+  for (size_t s = 0; s < 8; ++s)
+    shards.push_back(referenceSet.cols(100 * s, 100 * s + 99));
+
+  ShardedNeighborSearch<> sharded(std::move(shards));
+  BOOST_REQUIRE_EQUAL(sharded.Offset(5), 500);
+  CheckShardedSearch<ShardedNeighborSearch<>, KNN>(sharded, referenceSet,
+      querySet, 4);
+
+  // Each query point has 7 remote shards; most of them are far away.
+  BOOST_REQUIRE_GT(sharded.PrunedShards(), 7 * querySet.n_cols / 2);
+}
+
+/**
+ * Make sure DiskNeighborSearch gives the same results as a search on the whole
+ * reference set, when the shards are written to and read from disk, including
+ * a last shard with fewer than k points.
+ */
+BOOST_AUTO_TEST_CASE(DiskNeighborSearchTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(3, 1000);
+  arma::mat querySet = arma::randu<arma::mat>(3, 100);
+
+  // Sort the points along the first dimension, so the shards are slabs that
+  // can be pruned.
+  const arma::uvec order = arma::sort_index(referenceSet.row(0));
+  referenceSet = referenceSet.cols(order);
+
+  const arma::mat responses(0, referenceSet.n_cols);
+  data::MatrixBatchSource<arma::mat> source(referenceSet, responses, 333);
+  const std::vector<std::string> files =
+      DiskNeighborSearch<>::BuildShards(source, "disk_knn_test");
+  BOOST_REQUIRE_EQUAL(files.size(), 4);
+
+  DiskNeighborSearch<> disk(files);
+  BOOST_REQUIRE_EQUAL(disk.NumPoints(), 0);
+  CheckShardedSearch<DiskNeighborSearch<>, KNN>(disk, referenceSet, querySet,
+      5);
+  BOOST_REQUIRE_EQUAL(disk.NumShards(), 4);
+  BOOST_REQUIRE_EQUAL(disk.NumPoints(), 1000);
+  BOOST_REQUIRE_EQUAL(disk.Offset(3), 999);
+  BOOST_REQUIRE_GT(disk.PrunedShards(), 0);
+
+  // Now k is checked before the shards are read.
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  BOOST_REQUIRE_THROW(disk.Search(querySet, 1001, neighbors, distances),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(disk.Search(arma::randu<arma::mat>(2, 10), 5, neighbors,
+      distances), std::invalid_argument);
+
+  for (size_t i = 0; i < files.size(); ++i)
+    remove(files[i].c_str());
+
+  // The files are gone.
+  BOOST_REQUIRE_THROW(disk.Search(querySet, 5, neighbors, distances),
+      std::runtime_error);
+}
+
+/**
+ * Make sure MergeResults() keeps the k best neighbors of both sets, handles
+ * missing neighbors, and breaks ties by index.
+ */
+BOOST_AUTO_TEST_CASE(ShardedNeighborSearchMergeTest)
+{
+  arma::Mat<size_t> neighbors(3, 1);
+  neighbors(0, 0) = 3;
+  neighbors(1, 0) = 7;
+  neighbors(2, 0) = SIZE_MAX;
+  arma::mat distances("1.0; 2.0; 0.0");
+  distances(2, 0) = DBL_MAX;
+
+  const arma::Mat<size_t> otherNeighbors("5; 2; 9");
+  const arma::mat otherDistances("0.5; 2.0; 4.0");
+
+  ShardedNeighborSearch<>::MergeResults(neighbors, distances, otherNeighbors,
+      otherDistances);
+
+  BOOST_REQUIRE_EQUAL(neighbors(0, 0), 5);
+  BOOST_REQUIRE_EQUAL(neighbors(1, 0), 3);
+  BOOST_REQUIRE_EQUAL(neighbors(2, 0), 2);
+  BOOST_REQUIRE_CLOSE(distances(0, 0), 0.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(distances(1, 0), 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(distances(2, 0), 2.0, 1e-5);
+}
+
 /**
  * If we search twice with the same reference tree, the bounds need to be reset
  * before the second search.  This test ensures that that happens, by making
@@ -1434,4 +2439,206 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   CheckMatrices(distances, distances2);
 }
 
+#ifdef HAS_OPENMP
+/**
+ * Make sure that single-tree and greedy (defeatist) spill tree searches give
+ * the same results with several threads as with one.
+ */
+BOOST_AUTO_TEST_CASE(MultithreadedSpillSingleTreeSearchTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 3000);
+  arma::mat querySet = arma::randu<arma::mat>(10, 500);
+
+  SpillKNN::Tree referenceTree(dataset, 0.2 /* tau parameter */);
+  SpillKNN spTreeSearch(std::move(referenceTree), SINGLE_TREE_MODE);
+
+  const int numThreads = omp_get_max_threads();
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    if (mode)
+      spTreeSearch.SearchMode() = GREEDY_SINGLE_TREE_MODE;
+
+    arma::Mat<size_t> serialNeighbors, neighbors;
+    arma::mat serialDistances, distances;
+    omp_set_num_threads(1);
+    spTreeSearch.Search(querySet, 5, serialNeighbors, serialDistances);
+    omp_set_num_threads(4);
+    spTreeSearch.Search(querySet, 5, neighbors, distances);
+    omp_set_num_threads(numThreads);
+
+    CheckMatrices(neighbors, serialNeighbors);
+    CheckMatrices(distances, serialDistances);
+  }
+}
+#endif
+
+/**
+ * Compute the k largest similarities of each query point with brute force, as
+ * InvertedIndexSearch should.
+ */
+void BruteForceSimilarities(const arma::sp_mat& referenceSet,
+                            const arma::sp_mat& querySet,
+                            const bool normalize,
+                            const size_t k,
+                            const bool monochromatic,
+                            arma::Mat<size_t>& neighbors,
+                            arma::mat& similarities)
+{
+  arma::mat references(referenceSet);
+  arma::mat queries(querySet);
+  if (normalize)
+  {
+    references = arma::normalise(references);
+    queries = arma::normalise(queries);
+  }
+
+  const arma::mat all = queries.t() * references;
+  neighbors.set_size(k, queries.n_cols);
+  similarities.set_size(k, queries.n_cols);
+  for (size_t q = 0; q < queries.n_cols; ++q)
+  {
+    arma::vec rowSimilarities = all.row(q).t();
+    if (monochromatic)
+      rowSimilarities[q] = -DBL_MAX;
+    const arma::uvec order = arma::sort_index(rowSimilarities, "descend");
+    for (size_t j = 0; j < k; ++j)
+    {
+      neighbors(j, q) = order[j];
+      similarities(j, q) = rowSimilarities[order[j]];
+    }
+  }
+}
+
+/**
+ * Make sure the inverted index finds the points with the largest cosine
+ * similarity, as brute force does.
+ */
+BOOST_AUTO_TEST_CASE(InvertedIndexCosineTest)
+{
+  arma::sp_mat referenceSet = arma::sprandu<arma::sp_mat>(40, 300, 0.3);
+  arma::sp_mat querySet = arma::sprandu<arma::sp_mat>(40, 50, 0.3);
+
+  InvertedIndexSearch search(referenceSet);
+  BOOST_REQUIRE_EQUAL(search.NumPoints(), 300);
+  BOOST_REQUIRE_EQUAL(search.Dimensionality(), 40);
+  BOOST_REQUIRE_EQUAL(search.PostingValues().n_elem, referenceSet.n_nonzero);
+
+  arma::Mat<size_t> neighbors, trueNeighbors;
+  arma::mat similarities, trueSimilarities;
+  search.Search(querySet, 5, neighbors, similarities);
+  BruteForceSimilarities(referenceSet, querySet, true, 5, false,
+      trueNeighbors, trueSimilarities);
+
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(similarities, trueSimilarities, 1e-5);
+
+  // Each point is scored at most once for each query point.
+  BOOST_REQUIRE_LE(search.Scored(), 300 * 50);
+}
+
+/**
+ * Make sure the inverted index finds the points with the largest inner
+ * product, also with negative values.
+ */
+BOOST_AUTO_TEST_CASE(InvertedIndexInnerProductTest)
+{
+  arma::sp_mat referenceSet = arma::sprandn<arma::sp_mat>(40, 300, 0.3);
+  arma::sp_mat querySet = arma::sprandn<arma::sp_mat>(40, 50, 0.3);
+
+  InvertedIndexSearch search(referenceSet, false);
+
+  arma::Mat<size_t> neighbors, trueNeighbors;
+  arma::mat similarities, trueSimilarities;
+  search.Search(querySet, 5, neighbors, similarities);
+  BruteForceSimilarities(referenceSet, querySet, false, 5, false,
+      trueNeighbors, trueSimilarities);
+
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(similarities, trueSimilarities, 1e-5);
+}
+
+/**
+ * Make sure the monochromatic search does not return the point itself.
+ */
+BOOST_AUTO_TEST_CASE(InvertedIndexMonochromaticTest)
+{
+  arma::sp_mat referenceSet = arma::sprandu<arma::sp_mat>(30, 200, 0.3);
+
+  InvertedIndexSearch search(referenceSet);
+
+  arma::Mat<size_t> neighbors, trueNeighbors;
+  arma::mat similarities, trueSimilarities;
+  search.Search(3, neighbors, similarities);
+  BruteForceSimilarities(referenceSet, referenceSet, true, 3, true,
+      trueNeighbors, trueSimilarities);
+
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(similarities, trueSimilarities, 1e-5);
+}
+
+/**
+ * A query point that shares no dimension with any reference point gets no
+ * neighbors, and a query of the wrong dimensionality is rejected.
+ */
+BOOST_AUTO_TEST_CASE(InvertedIndexNoOverlapTest)
+{
+  arma::sp_mat referenceSet(10, 4);
+  referenceSet(0, 0) = 1.0;
+  referenceSet(1, 1) = 2.0;
+  referenceSet(1, 2) = 1.0;
+  referenceSet(2, 3) = 3.0;
+  arma::sp_mat querySet(10, 2);
+  querySet(1, 0) = 1.0;
+  querySet(5, 1) = 1.0;
+
+  InvertedIndexSearch search(referenceSet, false);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat similarities;
+  search.Search(querySet, 3, neighbors, similarities);
+
+  BOOST_REQUIRE_EQUAL(neighbors(0, 0), 1);
+  BOOST_REQUIRE_CLOSE(similarities(0, 0), 2.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(neighbors(1, 0), 2);
+  BOOST_REQUIRE_CLOSE(similarities(1, 0), 1.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(neighbors(2, 0), 4);
+  BOOST_REQUIRE_EQUAL(similarities(2, 0), -DBL_MAX);
+  for (size_t j = 0; j < 3; ++j)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors(j, 1), 4);
+    BOOST_REQUIRE_EQUAL(similarities(j, 1), -DBL_MAX);
+  }
+
+  arma::sp_mat wrongQuerySet(9, 2);
+  BOOST_REQUIRE_THROW(search.Search(wrongQuerySet, 1, neighbors,
+      similarities), std::invalid_argument);
+}
+
+/**
+ * Make sure the inverted index gives the same results after serialization.
+ */
+BOOST_AUTO_TEST_CASE(InvertedIndexSerializationTest)
+{
+  arma::sp_mat referenceSet = arma::sprandu<arma::sp_mat>(30, 200, 0.3);
+  arma::sp_mat querySet = arma::sprandu<arma::sp_mat>(30, 20, 0.3);
+
+  InvertedIndexSearch search(referenceSet);
+  InvertedIndexSearch xmlSearch(false);
+  InvertedIndexSearch textSearch(querySet);
+  InvertedIndexSearch binarySearch(querySet, false);
+  SerializeObjectAll(search, xmlSearch, textSearch, binarySearch);
+
+  arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat similarities, xmlSimilarities, textSimilarities,
+      binarySimilarities;
+  search.Search(querySet, 3, neighbors, similarities);
+  xmlSearch.Search(querySet, 3, xmlNeighbors, xmlSimilarities);
+  textSearch.Search(querySet, 3, textNeighbors, textSimilarities);
+  binarySearch.Search(querySet, 3, binaryNeighbors, binarySimilarities);
+
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(similarities, xmlSimilarities, textSimilarities,
+      binarySimilarities);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -715,4 +715,74 @@ BOOST_AUTO_TEST_CASE(RAModelTest)
   }
 }
 
+#ifdef HAS_OPENMP
+/**
+ * Single-tree search with several threads must still satisfy the guarantee,
+ * and every distance it returns must be the distance to the returned neighbor.
+ */
+BOOST_AUTO_TEST_CASE(MultithreadedSingleTreeSearchTest)
+{
+  arma::mat refData;
+  arma::mat queryData;
+
+  data::Load("rann_test_r_3_900.csv", refData, true);
+  data::Load("rann_test_q_3_100.csv", queryData, true);
+
+  arma::Mat<size_t> qrRanks;
+  data::Load("rann_test_qr_ranks.csv", qrRanks, true, false); // No transpose.
+
+  const int numThreads = omp_get_max_threads();
+  omp_set_num_threads(4);
+
+  // Both the bichromatic and the monochromatic search use the same traversal.
+  RASearch<> tssRann(refData, false, true, 1.0, 0.95, false, false);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  tssRann.Search(2, neighbors, distances);
+  for (size_t i = 0; i < refData.n_cols; ++i)
+  {
+    BOOST_REQUIRE_NE(neighbors(0, i), i);
+    BOOST_REQUIRE_LE(distances(0, i), distances(1, i));
+    for (size_t j = 0; j < 2; ++j)
+      BOOST_REQUIRE_CLOSE(distances(j, i), metric::EuclideanDistance::Evaluate(
+          refData.col(i), refData.col(neighbors(j, i))), 1e-5);
+  }
+
+  size_t numRounds = 200;
+  arma::Col<size_t> numSuccessRounds(queryData.n_cols);
+  numSuccessRounds.fill(0);
+
+  // 1% of 900 is 9, so the rank is expected to be less than 10.
+  size_t expectedRankErrorUB = 10;
+
+  for (size_t rounds = 0; rounds < numRounds; rounds++)
+  {
+    tssRann.Search(queryData, 1, neighbors, distances);
+
+    for (size_t i = 0; i < queryData.n_cols; i++)
+    {
+      BOOST_REQUIRE_CLOSE(distances(0, i), metric::EuclideanDistance::Evaluate(
+          queryData.col(i), refData.col(neighbors(0, i))), 1e-5);
+      if (qrRanks(i, neighbors(0, i)) < expectedRankErrorUB)
+        numSuccessRounds[i]++;
+    }
+  }
+
+  omp_set_num_threads(numThreads);
+
+  size_t threshold = floor(numRounds *
+      (0.95 - (1.96 * sqrt(0.95 * 0.05 / numRounds))));
+  size_t numQueriesFail = 0;
+  for (size_t i = 0; i < queryData.n_cols; i++)
+    if (numSuccessRounds[i] < threshold)
+      numQueriesFail++;
+
+  // Assert that at most 5% of the queries fall out of this threshold.
+  size_t maxNumQueriesFail = 6;
+
+  BOOST_REQUIRE_LT(numQueriesFail, maxNumQueriesFail);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
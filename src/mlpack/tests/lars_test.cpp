@@ -55,7 +55,11 @@ void LARSVerifyCorrectness(arma::vec beta, arma::vec errCorr, double lambda)
   }
 }
 
-void LassoTest(size_t nPoints, size_t nDims, bool elasticNet, bool useCholesky)
+void LassoTest(size_t nPoints,
+               size_t nDims,
+               bool elasticNet,
+               bool useCholesky,
+               bool incrementalCorrelations = false)
 {
   arma::mat X;
   arma::rowvec y;
@@ -75,6 +79,7 @@ void LassoTest(size_t nPoints, size_t nDims, bool elasticNet, bool useCholesky)
 
 
     LARS lars(useCholesky, lambda1, lambda2);
+    lars.IncrementalCorrelations() = incrementalCorrelations;
     arma::vec betaOpt;
     lars.Train(X, y, betaOpt);
 
@@ -106,6 +111,59 @@ BOOST_AUTO_TEST_CASE(LARSTestElasticNetGram)
   LassoTest(100, 10, true, false);
 }
 
+BOOST_AUTO_TEST_CASE(LARSTestLassoCholeskyIncremental)
+{
+  LassoTest(100, 10, false, true, true);
+}
+
+BOOST_AUTO_TEST_CASE(LARSTestLassoGramIncremental)
+{
+  LassoTest(100, 10, false, false, true);
+}
+
+BOOST_AUTO_TEST_CASE(LARSTestElasticNetCholeskyIncremental)
+{
+  LassoTest(100, 10, true, true, true);
+}
+
+BOOST_AUTO_TEST_CASE(LARSTestElasticNetGramIncremental)
+{
+  LassoTest(100, 10, true, false, true);
+}
+
+// Make sure that updating the correlations from the Gram matrix gives the same
+// solution path as recomputing them from the data.
+BOOST_AUTO_TEST_CASE(IncrementalCorrelationsPathTest)
+{
+  arma::mat X;
+  arma::rowvec y;
+  GenerateProblem(X, y, 200, 20);
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    const bool useCholesky = (trial == 1);
+    LARS lars(useCholesky, 0.1, 0.05);
+    arma::vec beta;
+    lars.Train(X, y, beta);
+
+    LARS incrementalLars(useCholesky, 0.1, 0.05);
+    incrementalLars.IncrementalCorrelations() = true;
+    arma::vec incrementalBeta;
+    incrementalLars.Train(X, y, incrementalBeta);
+
+    BOOST_REQUIRE_EQUAL(lars.BetaPath().size(),
+        incrementalLars.BetaPath().size());
+    for (size_t i = 0; i < lars.LambdaPath().size(); ++i)
+    {
+      BOOST_REQUIRE_SMALL(lars.LambdaPath()[i] -
+          incrementalLars.LambdaPath()[i], 1e-6);
+    }
+
+    for (size_t i = 0; i < beta.n_elem; ++i)
+      BOOST_REQUIRE_SMALL(beta[i] - incrementalBeta[i], 1e-6);
+  }
+}
+
 // Ensure that LARS doesn't crash when the data has linearly dependent features
 // (meaning that there is a singularity).  This test uses the Cholesky
 // factorization.
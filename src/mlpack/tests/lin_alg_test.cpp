@@ -78,6 +78,88 @@ BOOST_AUTO_TEST_CASE(TestCenterB)
       BOOST_REQUIRE_CLOSE(tmp_out(row, col), (double) (col - 2.5) * row, 1e-5);
 }
 
+/**
+ * Make sure in-place centering gives the same result as centering into another
+ * matrix, also when the matrix is large enough to be split into blocks.
+ */
+BOOST_AUTO_TEST_CASE(TestCenterInPlace)
+{
+  mat tmp = randu<mat>(7, 3000);
+
+  mat tmp_out;
+  Center(tmp, tmp_out);
+  Center(tmp);
+
+  CheckMatrices(tmp, tmp_out);
+  for (size_t row = 0; row < tmp.n_rows; ++row)
+    BOOST_REQUIRE_SMALL(arma::mean(tmp.row(row)), 1e-12);
+}
+
+/**
+ * Make sure the blocked covariance matches ccov(), for centered and uncentered
+ * data, with biased and unbiased normalization.
+ */
+BOOST_AUTO_TEST_CASE(TestCovariance)
+{
+  mat tmp = randu<mat>(6, 5000);
+  tmp.row(2) *= 3.0;
+
+  mat cov;
+  Covariance(tmp, cov);
+  CheckMatrices(cov, ccov(tmp));
+
+  Covariance(tmp, cov, false, true);
+  CheckMatrices(cov, ccov(tmp, 1));
+
+  mat centered;
+  Center(tmp, centered);
+  Covariance(centered, cov, true);
+  CheckMatrices(cov, ccov(tmp));
+}
+
+/**
+ * Make sure TransformInPlace() computes the product, and rejects a
+ * transformation that is not square.
+ */
+BOOST_AUTO_TEST_CASE(TestTransformInPlace)
+{
+  mat tmp = randu<mat>(4, 1000);
+  const mat transformation = randu<mat>(4, 4);
+  const mat product = transformation * tmp;
+
+  TransformInPlace(transformation, tmp);
+  CheckMatrices(tmp, product);
+
+  BOOST_REQUIRE_THROW(TransformInPlace(randu<mat>(3, 4), tmp),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure in-place whitening gives the same result as whitening into another
+ * matrix, for both decompositions.
+ */
+BOOST_AUTO_TEST_CASE(TestWhitenInPlace)
+{
+  mat tmp = randu<mat>(5, 2000);
+  tmp.row(1) += 2.0 * tmp.row(0);
+
+  mat whitened, whiteningMatrix, inPlaceMatrix;
+  WhitenUsingEig(tmp, whitened, whiteningMatrix);
+  mat inPlace(tmp);
+  WhitenUsingEig(inPlace, inPlaceMatrix);
+  CheckMatrices(inPlaceMatrix, whiteningMatrix);
+  CheckMatrices(inPlace, whitened);
+
+  WhitenUsingSVD(tmp, whitened, whiteningMatrix);
+  inPlace = tmp;
+  WhitenUsingSVD(inPlace, inPlaceMatrix);
+  CheckMatrices(inPlaceMatrix, whiteningMatrix);
+  CheckMatrices(inPlace, whitened);
+
+  // The covariance of the whitened data must be the identity.
+  CheckMatrices(ccov(inPlace), eye<mat>(5, 5), 1e-5);
+}
+
 BOOST_AUTO_TEST_CASE(TestWhitenUsingEig)
 {
   // After whitening using eigendecomposition, the covariance of
@@ -199,4 +199,92 @@ BOOST_AUTO_TEST_CASE(LinearRegressionTrainTest)
     BOOST_REQUIRE_CLOSE(lr.Parameters()[i], lrTrain.Parameters()[i], 1e-5);
 }
 
+/**
+ * Make sure that a model trained incrementally with Update() on batches of a
+ * dataset is the same as a model trained with Train() on the whole dataset,
+ * with and without an intercept, regularization, and weights.
+ */
+BOOST_AUTO_TEST_CASE(LinearRegressionUpdateTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  arma::rowvec responses = arma::randu<arma::rowvec>(1000);
+  arma::rowvec weights = arma::randu<arma::rowvec>(1000);
+
+  for (size_t trial = 0; trial < 8; ++trial)
+  {
+    const double lambda = (trial % 2 == 0) ? 0.0 : 0.3;
+    const bool intercept = ((trial / 2) % 2 == 0);
+    const bool weighted = (trial >= 4);
+
+    LinearRegression lr;
+    lr.Lambda() = lambda;
+    if (weighted)
+      lr.Train(dataset, responses, weights, intercept);
+    else
+      lr.Train(dataset, responses, intercept);
+
+    LinearRegression lrUpdate;
+    lrUpdate.Lambda() = lambda;
+    lrUpdate.Intercept() = intercept;
+    for (size_t i = 0; i < 1000; i += 300)
+    {
+      const size_t end = std::min(i + 300, (size_t) 1000) - 1;
+      if (weighted)
+      {
+        lrUpdate.Update(dataset.cols(i, end), responses.subvec(i, end),
+            weights.subvec(i, end), false);
+      }
+      else
+      {
+        lrUpdate.Update(dataset.cols(i, end), responses.subvec(i, end),
+            false);
+      }
+    }
+    lrUpdate.Solve();
+
+    BOOST_REQUIRE_EQUAL(lrUpdate.NumPoints(), 1000);
+    BOOST_REQUIRE_EQUAL(lr.Parameters().n_elem, lrUpdate.Parameters().n_elem);
+    for (size_t i = 0; i < lr.Parameters().n_elem; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(lr.Parameters()[i], lrUpdate.Parameters()[i],
+          1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that merging models updated on different shards gives the same
+ * model as updating one model with all the shards.
+ */
+BOOST_AUTO_TEST_CASE(LinearRegressionMergeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 600);
+  arma::rowvec responses = arma::randu<arma::rowvec>(600);
+
+  LinearRegression lr;
+  lr.Lambda() = 0.1;
+  lr.Update(dataset, responses);
+
+  LinearRegression lr1, lr2, lr3;
+  lr1.Lambda() = 0.1;
+  lr1.Update(dataset.cols(0, 199), responses.subvec(0, 199), false);
+  lr2.Update(dataset.cols(200, 399), responses.subvec(200, 399), false);
+  lr3.Update(dataset.cols(400, 599), responses.subvec(400, 599), false);
+
+  lr1.Merge(lr2, false);
+  lr1.Merge(lr3);
+
+  BOOST_REQUIRE_EQUAL(lr1.NumPoints(), 600);
+  BOOST_REQUIRE_EQUAL(lr.Parameters().n_elem, lr1.Parameters().n_elem);
+  for (size_t i = 0; i < lr.Parameters().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(lr.Parameters()[i], lr1.Parameters()[i], 1e-5);
+
+  // The predictions of the models must match too.
+  arma::rowvec predictions, mergedPredictions;
+  lr.Predict(dataset, predictions);
+  lr1.Predict(dataset, mergedPredictions);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(predictions[i], mergedPredictions[i], 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -17,6 +17,10 @@
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#ifdef HAS_ZLIB
+  #include <zlib.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::data;
 using namespace std;
@@ -419,6 +423,48 @@ BOOST_AUTO_TEST_CASE(SaveNonTransposedCSVTest)
   remove("test_file.csv");
 }
 
+/**
+ * Make sure saved text holds the shortest exact form of each value, so that
+ * loading it gives back exactly the same matrix.
+ */
+BOOST_AUTO_TEST_CASE(SaveTextExactTest)
+{
+  arma::mat test = "1 0.1 -2.5;"
+                   "3 0 1e+300;";
+  BOOST_REQUIRE(data::Save("test_file.csv", test) == true);
+
+  std::ifstream f("test_file.csv");
+  std::stringstream contents;
+  contents << f.rdbuf();
+  f.close();
+  BOOST_REQUIRE_EQUAL(contents.str(), "1,3\n0.1,0\n-2.5,1e+300\n");
+
+  // Random values are loaded exactly, from CSV and from whitespace-separated
+  // text, and with several blocks of lines.
+  arma::mat random = arma::randn<arma::mat>(3, 50000);
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Save("test_file.csv", random) == true);
+  BOOST_REQUIRE(data::Load("test_file.csv", loaded) == true);
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, random.n_rows);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, random.n_cols);
+  BOOST_REQUIRE_EQUAL(arma::accu(loaded != random), 0);
+
+  BOOST_REQUIRE(data::Save("test_file.txt", random, true, false) == true);
+  BOOST_REQUIRE(data::Load("test_file.txt", loaded, true, false) == true);
+  BOOST_REQUIRE_EQUAL(arma::accu(loaded != random), 0);
+
+  // Indices are written as integers.
+  arma::Mat<size_t> indices = arma::randi<arma::Mat<size_t>>(4, 1000,
+      arma::distr_param(0, 1000000));
+  arma::Mat<size_t> loadedIndices;
+  BOOST_REQUIRE(data::Save("test_file.csv", indices) == true);
+  BOOST_REQUIRE(data::Load("test_file.csv", loadedIndices) == true);
+  CheckMatrices(indices, loadedIndices);
+
+  remove("test_file.csv");
+  remove("test_file.txt");
+}
+
 /**
  * Make sure arma_ascii is loaded correctly.
  */
@@ -572,6 +618,39 @@ BOOST_AUTO_TEST_CASE(SaveArmaBinaryTest)
   remove("test_file.bin");
 }
 
+/**
+ * Make sure that an Armadillo binary file large enough to be read in several
+ * blocks is loaded correctly, transposed or not, and that files of another
+ * element type are still converted.
+ */
+BOOST_AUTO_TEST_CASE(LoadLargeArmaBinaryTest)
+{
+  arma::mat test(300, 1000, arma::fill::randu);
+  BOOST_REQUIRE(data::Save("test_file.bin", test) == true);
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test_file.bin", loaded) == true);
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 300);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 1000);
+  BOOST_REQUIRE_EQUAL(arma::accu(loaded != test), 0);
+
+  BOOST_REQUIRE(data::Load("test_file.bin", loaded, false, false) == true);
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 1000);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 300);
+  BOOST_REQUIRE_EQUAL(arma::accu(loaded != test.t()), 0);
+
+  arma::fmat floatTest = arma::conv_to<arma::fmat>::from(test);
+  BOOST_REQUIRE(data::Save("test_file.bin", floatTest) == true);
+  BOOST_REQUIRE(data::Load("test_file.bin", loaded) == true);
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 300);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 1000);
+  for (size_t i = 0; i < loaded.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(loaded[i], (double) floatTest[i]);
+
+  // Remove the file.
+  remove("test_file.bin");
+}
+
 /**
  * Make sure raw_binary is loaded correctly.
  */
@@ -770,6 +849,53 @@ BOOST_AUTO_TEST_CASE(SaveHDF5Test)
   remove("test_file.hdf5");
   remove("test_file.he5");
 }
+
+/**
+ * Write a chunked HDF5 dataset block by block, and make sure it is read back
+ * correctly one shard at a time and by data::Load().
+ */
+BOOST_AUTO_TEST_CASE(ChunkedHDF5Test)
+{
+  arma::mat dataset = arma::randu<arma::mat>(7, 1000);
+
+  {
+    HDF5ChunkedWriter<double> writer("test_file.h5", 7, 64);
+    for (size_t begin = 0; begin < 1000; begin += 300)
+      writer.Write(dataset.cols(begin, std::min(begin + 299, (size_t) 999)));
+    BOOST_REQUIRE_EQUAL(writer.Points(), 1000);
+    writer.Close();
+  }
+
+  // The shards are rounded up to whole chunks.
+  HDF5BatchSource<double> source("test_file.h5");
+  BOOST_REQUIRE_EQUAL(source.NumPoints(), 1000);
+  BOOST_REQUIRE_EQUAL(source.Dimensionality(), 7);
+  BOOST_REQUIRE_EQUAL(source.ShardSize() % 64, 0);
+
+  HDF5BatchSource<double> smallSource("test_file.h5", "dataset", "", 128);
+  BOOST_REQUIRE_EQUAL(smallSource.NumShards(), 8);
+  arma::mat predictors, responses, readDataset;
+  for (size_t i = 0; i < smallSource.NumShards(); ++i)
+  {
+    smallSource.LoadShard(i, predictors, responses);
+    BOOST_REQUIRE_EQUAL(responses.n_rows, 0);
+    BOOST_REQUIRE_EQUAL(responses.n_cols, predictors.n_cols);
+    readDataset = arma::join_rows(readDataset, predictors);
+  }
+  CheckMatrices(dataset, readDataset);
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test_file.h5", loaded) == true);
+  CheckMatrices(dataset, loaded);
+
+  // A matrix with one point per row is saved block by block too.
+  BOOST_REQUIRE(data::Save("test_file.h5", arma::mat(dataset.t()), true,
+      false) == true);
+  BOOST_REQUIRE(data::Load("test_file.h5", loaded) == true);
+  CheckMatrices(dataset, loaded);
+
+  remove("test_file.h5");
+}
 #else
 /**
  * Ensure saving as HDF5 fails.
@@ -843,6 +969,40 @@ BOOST_AUTO_TEST_CASE(NormalizeLabelTest)
     BOOST_REQUIRE_EQUAL(randLabels[i], revertedLabels[i]);
 }
 
+/**
+ * Normalize a large label set with many classes, and make sure that the
+ * labels are numbered in the order of their first appearance.
+ */
+BOOST_AUTO_TEST_CASE(NormalizeManyLabelsTest)
+{
+  const size_t n = 300000;
+  arma::Row<size_t> randLabels(n);
+  for (size_t i = 0; i < n; ++i)
+    randLabels[i] = math::RandInt(0, 10000) * 3;
+
+  arma::Row<size_t> newLabels;
+  arma::Col<size_t> mappings;
+  data::NormalizeLabels(randLabels, newLabels, mappings);
+
+  // Compute the expected labels with a map.
+  std::map<size_t, size_t> expected;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (expected.count(randLabels[i]) == 0)
+    {
+      const size_t label = expected.size();
+      expected[randLabels[i]] = label;
+    }
+    BOOST_REQUIRE_EQUAL(newLabels[i], expected[randLabels[i]]);
+  }
+
+  BOOST_REQUIRE_EQUAL(mappings.n_elem, expected.size());
+  arma::Row<size_t> revertedLabels;
+  data::RevertLabels(newLabels, mappings, revertedLabels);
+  for (size_t i = 0; i < n; ++i)
+    BOOST_REQUIRE_EQUAL(randLabels[i], revertedLabels[i]);
+}
+
 // Test structures.
 class TestInner
 {
@@ -948,6 +1108,82 @@ BOOST_AUTO_TEST_CASE(LoadTextTest)
   BOOST_REQUIRE_EQUAL(y.inb.s, x.inb.s);
 }
 
+// A model with a large and a small matrix.
+class MatrixTest
+{
+ public:
+  MatrixTest() : inner('a', "") { }
+
+  MatrixTest(const size_t rows, const size_t cols) :
+      large(arma::randu<arma::mat>(rows, cols)),
+      small(arma::randu<arma::vec>(3)),
+      inner('c', "matrices")
+  { }
+
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(large, "large");
+    ar & data::CreateNVP(small, "small");
+    ar & data::CreateNVP(inner, "inner");
+  }
+
+  // Public members for testing.
+  arma::mat large;
+  arma::vec small;
+  TestInner inner;
+};
+
+/**
+ * Make sure we can load and save mlpack binary model files, and that the large
+ * matrices of a mapped model point at aligned blocks of the file.
+ */
+BOOST_AUTO_TEST_CASE(LoadBinaryModelTest)
+{
+  MatrixTest x(20, 100);
+
+  BOOST_REQUIRE_EQUAL(data::Save("test.mlmodel", "x", x, false), true);
+
+  MatrixTest y;
+  BOOST_REQUIRE_EQUAL(data::Load("test.mlmodel", "x", y, false), true);
+
+  CheckMatrices(y.large, x.large);
+  CheckMatrices(y.small, x.small);
+  BOOST_REQUIRE_EQUAL(y.inner.c, x.inner.c);
+  BOOST_REQUIRE_EQUAL(y.inner.s, x.inner.s);
+
+  {
+    data::MappedModel<MatrixTest> mapped;
+    BOOST_REQUIRE_EQUAL(data::Load("test.mlmodel", "x", mapped, false), true);
+
+    MatrixTest& z = mapped.Model();
+    CheckMatrices(z.large, x.large);
+    CheckMatrices(z.small, x.small);
+    BOOST_REQUIRE_EQUAL(z.inner.s, x.inner.s);
+
+#ifndef _WIN32
+    BOOST_REQUIRE(mapped.IsMapped());
+    BOOST_REQUIRE_EQUAL(z.large.mem_state, 1);
+    BOOST_REQUIRE_EQUAL((size_t) z.large.memptr() % 64, 0);
+#endif
+
+    // Modifying the mapped model does not change the file.
+    z.large.fill(3.0);
+  }
+
+  MatrixTest w;
+  BOOST_REQUIRE_EQUAL(data::Load("test.mlmodel", "x", w, false), true);
+  CheckMatrices(w.large, x.large);
+
+  // Other formats cannot be mapped.
+  BOOST_REQUIRE_EQUAL(data::Save("test.bin", "x", x, false), true);
+  data::MappedModel<MatrixTest> mappedBin;
+  BOOST_REQUIRE_EQUAL(data::Load("test.bin", "x", mappedBin, false), false);
+
+  remove("test.mlmodel");
+  remove("test.bin");
+}
+
 /**
  * Test DatasetInfo by making a map for a dimension.
  */
@@ -1840,6 +2076,73 @@ BOOST_AUTO_TEST_CASE(CaseTest)
   BOOST_CHECK_EQUAL(dataset.n_cols, 3);
 }
 
+/**
+ * Make sure nominal attributes are mapped in the order they are declared, and
+ * that sparse lines are loaded into dense and sparse matrices.
+ */
+BOOST_AUTO_TEST_CASE(NominalSparseARFFTest)
+{
+  fstream f;
+  f.open("test.arff", fstream::out);
+  f << "@relation test" << endl;
+  f << "@attribute a numeric" << endl;
+  f << "@attribute b numeric" << endl;
+  f << "@attribute class {yes, 'no way', maybe}" << endl;
+  f << "@data" << endl;
+  f << "1, 2, maybe" << endl;
+  f << "% comment" << endl;
+  f << endl;
+  f << "{1 3.5, 2 'no way'} % comment" << endl;
+  f << "{}" << endl;
+  f << "{0 -1}";
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.arff", dataset, info) == true);
+
+  BOOST_REQUIRE(info.Type(2) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(2), 3);
+
+  arma::mat expected = "1 0 0 -1;"
+                       "2 3.5 0 0;"
+                       "2 1 0 0;";
+  CheckMatrices(dataset, expected);
+
+  arma::sp_mat sparseDataset;
+  BOOST_REQUIRE(data::Load("test.arff", sparseDataset) == true);
+  BOOST_REQUIRE_EQUAL(sparseDataset.n_nonzero, 6);
+  CheckMatrices(arma::mat(sparseDataset), expected);
+
+  remove("test.arff");
+}
+
+/**
+ * Make sure malformed ARFF data lines fail to load.
+ */
+BOOST_AUTO_TEST_CASE(MalformedARFFTest)
+{
+  const char* lines[] = { "1, 2, 3", "1", "{2 1}", "{0 1", "1, \"2" };
+  for (size_t i = 0; i < 5; ++i)
+  {
+    fstream f;
+    f.open("test.arff", fstream::out);
+    f << "@attribute a numeric" << endl;
+    f << "@attribute b string" << endl;
+    f << "@data" << endl;
+    f << "3, x" << endl;
+    f << lines[i] << endl;
+    f.close();
+
+    arma::mat dataset;
+    DatasetInfo info;
+    BOOST_REQUIRE_THROW(data::LoadARFF("test.arff", dataset, info),
+        std::runtime_error);
+  }
+
+  remove("test.arff");
+}
+
 /**
  * Test that a CSV with the wrong number of columns fails.
  */
@@ -1992,4 +2295,422 @@ BOOST_AUTO_TEST_CASE(LoadCSVNoTransposeTXTTest)
   remove("test.txt");
 }
 
+/**
+ * Make sure mlpack binary files can be saved and loaded, without transposition
+ * and with conversion of the element type.
+ */
+BOOST_AUTO_TEST_CASE(SaveLoadMLBinaryTest)
+{
+  arma::mat test = arma::randu<arma::mat>(13, 27);
+
+  BOOST_REQUIRE(data::Save("test_file.mlbin", test) == true);
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test_file.mlbin", loaded) == true);
+
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, test.n_rows);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, test.n_cols);
+  for (size_t i = 0; i < test.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(loaded[i], test[i]);
+
+  // Load with conversion to float.
+  arma::fmat floatLoaded;
+  BOOST_REQUIRE(data::Load("test_file.mlbin", floatLoaded) == true);
+
+  BOOST_REQUIRE_EQUAL(floatLoaded.n_rows, test.n_rows);
+  BOOST_REQUIRE_EQUAL(floatLoaded.n_cols, test.n_cols);
+  for (size_t i = 0; i < test.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(floatLoaded[i], (float) test[i], 1e-5);
+
+  // Remove the file.
+  remove("test_file.mlbin");
+}
+
+/**
+ * Make sure an mlpack binary file and its DatasetInfo can be memory-mapped.
+ */
+BOOST_AUTO_TEST_CASE(MapMLBinaryTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  f << "1, 2, hello" << endl;
+  f << "3, 4, goodbye" << endl;
+  f << "5, 6, coffee" << endl;
+  f << "7, 8, confusion" << endl;
+  f.close();
+
+  arma::mat matrix;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.csv", matrix, info) == true);
+  remove("test.csv");
+
+  BOOST_REQUIRE(data::Save("test_file.mlbin", matrix, info) == true);
+
+  {
+    data::MappedMatrix<double> mapped;
+    BOOST_REQUIRE(data::Load("test_file.mlbin", mapped) == true);
+
+    const arma::mat& mappedMatrix = mapped.Matrix();
+    BOOST_REQUIRE_EQUAL(mappedMatrix.n_rows, matrix.n_rows);
+    BOOST_REQUIRE_EQUAL(mappedMatrix.n_cols, matrix.n_cols);
+    for (size_t i = 0; i < matrix.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(mappedMatrix[i], matrix[i]);
+
+#ifndef _WIN32
+    BOOST_REQUIRE(mapped.IsMapped());
+#endif
+
+    BOOST_REQUIRE_EQUAL(mapped.Info().Dimensionality(), 3);
+    BOOST_REQUIRE(mapped.Info().Type(0) == Datatype::numeric);
+    BOOST_REQUIRE(mapped.Info().Type(1) == Datatype::numeric);
+    BOOST_REQUIRE(mapped.Info().Type(2) == Datatype::categorical);
+    BOOST_REQUIRE_EQUAL(mapped.Info().NumMappings(2), 4);
+
+    // A mapped matrix cannot be converted to another element type.
+    data::MappedMatrix<float> floatMapped;
+    BOOST_REQUIRE(data::Load("test_file.mlbin", floatMapped) == false);
+  }
+
+  // Load into memory with the DatasetInfo.
+  arma::mat loaded;
+  DatasetInfo loadedInfo;
+  BOOST_REQUIRE(data::Load("test_file.mlbin", loaded, loadedInfo) == true);
+  BOOST_REQUIRE_EQUAL(loaded.n_elem, matrix.n_elem);
+  BOOST_REQUIRE(loadedInfo.Type(2) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(loadedInfo.UnmapString(0, 2), "hello");
+
+  remove("test_file.mlbin");
+}
+
+/**
+ * Make sure that the prefetcher returns every point once per epoch, in batches
+ * of at most the batch size, with and without shuffling.
+ */
+BOOST_AUTO_TEST_CASE(BatchPrefetcherTest)
+{
+  arma::mat predictors(3, 1000, arma::fill::randu);
+  arma::mat responses(1, 1000);
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+  {
+    predictors(0, i) = i;
+    responses(0, i) = 2 * i;
+  }
+
+  MatrixBatchSource<> source(predictors, responses, 128);
+  BOOST_REQUIRE_EQUAL(source.NumShards(), 8);
+
+  for (size_t shuffle = 0; shuffle < 2; ++shuffle)
+  {
+    BatchPrefetcher<MatrixBatchSource<>> batches(source, 50, shuffle == 1, 3);
+    for (size_t epoch = 0; epoch < 2; ++epoch)
+    {
+      batches.Reset();
+
+      arma::Col<size_t> seen(predictors.n_cols, arma::fill::zeros);
+      arma::mat batchPredictors, batchResponses;
+      size_t next = 0;
+      while (batches.Next(batchPredictors, batchResponses))
+      {
+        BOOST_REQUIRE_GT(batchPredictors.n_cols, 0);
+        BOOST_REQUIRE_LE(batchPredictors.n_cols, 50);
+        BOOST_REQUIRE_EQUAL(batchPredictors.n_rows, 3);
+        BOOST_REQUIRE_EQUAL(batchResponses.n_cols, batchPredictors.n_cols);
+
+        for (size_t j = 0; j < batchPredictors.n_cols; ++j)
+        {
+          const size_t point = (size_t) batchPredictors(0, j);
+          BOOST_REQUIRE_EQUAL(batchResponses(0, j), 2.0 * point);
+          BOOST_REQUIRE_EQUAL(batchPredictors(1, j), predictors(1, point));
+          ++seen[point];
+
+          // Without shuffling, the points come in order.
+          if (shuffle == 0)
+            BOOST_REQUIRE_EQUAL(point, next++);
+        }
+      }
+
+      for (size_t i = 0; i < seen.n_elem; ++i)
+        BOOST_REQUIRE_EQUAL(seen[i], 1);
+    }
+  }
+}
+
+/**
+ * Make sure that the prefetcher can read from memory-mapped files and CSV
+ * shards, and that errors of the source are reported.
+ */
+BOOST_AUTO_TEST_CASE(BatchPrefetcherFileSourcesTest)
+{
+  arma::mat predictors(2, 20, arma::fill::randu);
+  arma::mat responses(1, 20);
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    responses(0, i) = i;
+
+  BOOST_REQUIRE(data::Save("test_predictors.mlbin", predictors) == true);
+  BOOST_REQUIRE(data::Save("test_responses.mlbin", responses) == true);
+
+  {
+    MappedBatchSource<double> source("test_predictors.mlbin",
+        "test_responses.mlbin", 8);
+    BatchPrefetcher<MappedBatchSource<double>> batches(source, 3, false);
+    batches.Reset();
+
+    arma::mat batchPredictors, batchResponses, allPredictors, allResponses;
+    while (batches.Next(batchPredictors, batchResponses))
+    {
+      allPredictors = arma::join_rows(allPredictors, batchPredictors);
+      allResponses = arma::join_rows(allResponses, batchResponses);
+    }
+
+    BOOST_REQUIRE_EQUAL(allPredictors.n_cols, predictors.n_cols);
+    for (size_t i = 0; i < predictors.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(allPredictors[i], predictors[i]);
+    for (size_t i = 0; i < responses.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(allResponses[i], responses[i]);
+  }
+
+  remove("test_predictors.mlbin");
+  remove("test_responses.mlbin");
+
+  // Write two CSV shards, with the response as the last value of each line.
+  std::vector<std::string> files = { "test_shard_0.csv", "test_shard_1.csv" };
+  for (size_t s = 0; s < files.size(); ++s)
+  {
+    fstream f;
+    f.open(files[s], fstream::out);
+    for (size_t i = 10 * s; i < 10 * (s + 1); ++i)
+      f << i << ", " << (i + 100) << ", " << (2 * i) << endl;
+    f.close();
+  }
+
+  CSVShardBatchSource<> source(files, 1);
+  BatchPrefetcher<CSVShardBatchSource<>> batches(source, 4);
+  batches.Reset();
+
+  size_t points = 0;
+  arma::mat batchPredictors, batchResponses;
+  while (batches.Next(batchPredictors, batchResponses))
+  {
+    BOOST_REQUIRE_EQUAL(batchPredictors.n_rows, 2);
+    BOOST_REQUIRE_EQUAL(batchResponses.n_rows, 1);
+    for (size_t j = 0; j < batchPredictors.n_cols; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(batchPredictors(1, j), batchPredictors(0, j) + 100);
+      BOOST_REQUIRE_EQUAL(batchResponses(0, j), 2 * batchPredictors(0, j));
+    }
+    points += batchPredictors.n_cols;
+  }
+  BOOST_REQUIRE_EQUAL(points, 20);
+
+  // A missing shard is reported by Next().
+  remove(files[1].c_str());
+  batches.Reset();
+  bool thrown = false;
+  try
+  {
+    while (batches.Next(batchPredictors, batchResponses)) { }
+  }
+  catch (std::runtime_error&)
+  {
+    thrown = true;
+  }
+  BOOST_REQUIRE(thrown);
+
+  remove(files[0].c_str());
+}
+
+/**
+ * Make sure the fast numeric CSV parser gives the same results as Armadillo,
+ * both transposed and not transposed, and with and without a DatasetInfo.
+ */
+BOOST_AUTO_TEST_CASE(NumericCSVParseTest)
+{
+  // Use enough lines that the file is split into several chunks.
+  arma::mat test = arma::randn<arma::mat>(5, 1000);
+  test.col(3).fill(-1e-5);
+  BOOST_REQUIRE(test.save("test_file.csv", arma::csv_ascii) == true);
+
+  arma::mat armaMatrix;
+  BOOST_REQUIRE(armaMatrix.load("test_file.csv", arma::csv_ascii) == true);
+
+  arma::mat matrix;
+  BOOST_REQUIRE(data::Load("test_file.csv", matrix) == true);
+  BOOST_REQUIRE_EQUAL(matrix.n_rows, 1000);
+  BOOST_REQUIRE_EQUAL(matrix.n_cols, 5);
+  for (size_t i = 0; i < matrix.n_rows; ++i)
+    for (size_t j = 0; j < matrix.n_cols; ++j)
+      BOOST_REQUIRE_EQUAL(matrix(i, j), armaMatrix(j, i));
+
+  arma::mat infoMatrix;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test_file.csv", infoMatrix, info, false, false) ==
+      true);
+  BOOST_REQUIRE_EQUAL(info.Dimensionality(), 1000);
+  BOOST_REQUIRE(info.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE_EQUAL(infoMatrix.n_rows, 1000);
+  BOOST_REQUIRE_EQUAL(infoMatrix.n_cols, 5);
+  for (size_t i = 0; i < infoMatrix.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(infoMatrix[i], armaMatrix[i]);
+
+  remove("test_file.csv");
+
+  // Now make sure that a file with a non-numeric token still loads through the
+  // regular parser.
+  fstream f;
+  f.open("test_file.csv", fstream::out);
+  f << "1, 2, 3" << endl;
+  f << "4, 5, nan" << endl;
+  f << "7, 8, 9" << endl;
+  f.close();
+
+  arma::umat umatrix;
+  DatasetInfo uinfo;
+  BOOST_REQUIRE(data::Load("test_file.csv", umatrix, uinfo) == true);
+  BOOST_REQUIRE_EQUAL(umatrix.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(umatrix.n_cols, 3);
+  BOOST_REQUIRE(uinfo.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE(uinfo.Type(2) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(umatrix(0, 1), 4);
+
+  remove("test_file.csv");
+}
+
+/**
+ * Make sure the parallel categorical CSV parser maps tokens in the order of
+ * their first occurrence in the file, as the regular parser does, even when the
+ * file is split into several chunks.
+ */
+BOOST_AUTO_TEST_CASE(CategoricalCSVParseTest)
+{
+  // Dimension 0 is numeric, dimension 1 is made of strings, and dimension 2
+  // mixes numbers and strings (so its numbers are mapped as strings too).
+  vector<vector<string>> tokens(3);
+  fstream f;
+  f.open("test_file.csv", fstream::out);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    tokens[0].push_back(to_string(i));
+    tokens[1].push_back("c" + to_string((i * 7) % 13));
+    tokens[2].push_back((i % 3 == 0) ? "x" : to_string(i % 5));
+    f << tokens[0][i] << ", " << tokens[1][i] << "," << tokens[2][i] << endl;
+  }
+  f.close();
+
+  arma::mat matrix;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test_file.csv", matrix, info) == true);
+  remove("test_file.csv");
+
+  BOOST_REQUIRE_EQUAL(matrix.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(matrix.n_cols, 1000);
+  BOOST_REQUIRE(info.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE(info.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE(info.Type(2) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(0), 0);
+
+  for (size_t d = 1; d < 3; ++d)
+  {
+    map<string, size_t> ids;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+      if (ids.count(tokens[d][i]) == 0)
+      {
+        const size_t id = ids.size();
+        ids[tokens[d][i]] = id;
+      }
+      BOOST_REQUIRE_EQUAL((size_t) matrix(d, i), ids[tokens[d][i]]);
+    }
+
+    BOOST_REQUIRE_EQUAL(info.NumMappings(d), ids.size());
+    for (map<string, size_t>::const_iterator it = ids.begin(); it != ids.end();
+        ++it)
+      BOOST_REQUIRE_EQUAL(info.UnmapString(it->second, d), it->first);
+  }
+
+  for (size_t i = 0; i < 1000; ++i)
+    BOOST_REQUIRE_EQUAL(matrix(0, i), (double) i);
+}
+
+/**
+ * Make sure that sparse matrices load from coordinate list and Armadillo binary
+ * files, with one point per column.
+ */
+BOOST_AUTO_TEST_CASE(LoadSparseTest)
+{
+  fstream f;
+  f.open("test_file.coo", fstream::out);
+  f << "0 1 2.5" << endl;
+  f << "2 0 -1" << endl;
+  f << "3 4 3" << endl;
+  f.close();
+
+  arma::sp_mat matrix;
+  BOOST_REQUIRE(data::Load("test_file.coo", matrix) == true);
+  remove("test_file.coo");
+
+  // Each line of the file is a point, so the matrix is transposed.
+  BOOST_REQUIRE_EQUAL(matrix.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(matrix.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(matrix.n_nonzero, 3);
+  BOOST_REQUIRE_CLOSE((double) matrix(1, 0), 2.5, 1e-5);
+  BOOST_REQUIRE_CLOSE((double) matrix(0, 2), -1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE((double) matrix(4, 3), 3.0, 1e-5);
+
+  // Without transposition.
+  BOOST_REQUIRE(matrix.save("test_file.bin", arma::arma_binary));
+  arma::sp_mat binMatrix;
+  BOOST_REQUIRE(data::Load("test_file.bin", binMatrix, true, false) == true);
+  remove("test_file.bin");
+
+  BOOST_REQUIRE_EQUAL(binMatrix.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(binMatrix.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(binMatrix.n_nonzero, 3);
+  BOOST_REQUIRE_CLOSE((double) binMatrix(4, 3), 3.0, 1e-5);
+
+  // An unknown extension fails.
+  arma::sp_mat badMatrix;
+  BOOST_REQUIRE(data::Load("test_file.csv", badMatrix) == false);
+}
+
+
+#ifdef HAS_ZLIB
+/**
+ * Make sure a gzipped CSV is loaded like the uncompressed file, including when
+ * the last line has no newline and when the file spans several blocks.
+ */
+BOOST_AUTO_TEST_CASE(LoadGzipCSVTest)
+{
+  std::ostringstream oss;
+  for (size_t i = 0; i < 20000; ++i)
+    oss << i << ", " << (0.5 * i) << ", " << -double(i) << "\n";
+  oss << "1, 2, 3";
+  const std::string contents = oss.str();
+
+  fstream f;
+  f.open("test_file.csv", fstream::out);
+  f << contents;
+  f.close();
+
+  gzFile g = gzopen("test_file.csv.gz", "wb");
+  BOOST_REQUIRE(g != NULL);
+  BOOST_REQUIRE_EQUAL(gzwrite(g, contents.data(), contents.size()),
+      (int) contents.size());
+  gzclose(g);
+
+  arma::mat plain, compressed;
+  BOOST_REQUIRE(data::Load("test_file.csv", plain) == true);
+  BOOST_REQUIRE(data::Load("test_file.csv.gz", compressed) == true);
+  remove("test_file.csv");
+  remove("test_file.csv.gz");
+
+  BOOST_REQUIRE_EQUAL(compressed.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(compressed.n_cols, 20001);
+  CheckMatrices(plain, compressed);
+
+  // A gzipped file in a format that can't be streamed fails.
+  arma::mat bad;
+  BOOST_REQUIRE(data::Load("test_file.bin.gz", bad) == false);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
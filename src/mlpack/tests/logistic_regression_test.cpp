@@ -13,6 +13,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/logistic_regression/logistic_regression.hpp>
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -410,6 +411,63 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationGradient)
   }
 }
 
+/**
+ * Make sure EvaluateWithGradient() gives the same results as Evaluate() and
+ * Gradient(), for dense and sparse data.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionEvaluateWithGradient)
+{
+  arma::sp_mat sparseData;
+  sparseData.sprandu(10, 1000, 0.3);
+  const arma::mat data(sparseData);
+  arma::Row<size_t> responses(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    responses[i] = math::RandInt(0, 2);
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.4);
+  LogisticRegressionFunction<arma::sp_mat> sparseLrf(sparseData, responses,
+      0.4);
+
+  const arma::mat parameters = arma::randn<arma::mat>(11, 1);
+
+  arma::mat gradient, fusedGradient, sparseGradient;
+  lrf.Gradient(parameters, gradient);
+  const double objective = lrf.EvaluateWithGradient(parameters, fusedGradient);
+  const double sparseObjective = sparseLrf.EvaluateWithGradient(parameters,
+      sparseGradient);
+
+  BOOST_REQUIRE_CLOSE(objective, lrf.Evaluate(parameters), 1e-5);
+  BOOST_REQUIRE_CLOSE(sparseObjective, lrf.Evaluate(parameters), 1e-5);
+  CheckMatrices(gradient, fusedGradient);
+  CheckMatrices(gradient, sparseGradient);
+}
+
+/**
+ * Make sure the separable EvaluateWithGradient() gives the same results as the
+ * separable Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionSeparableEvaluateWithGradient)
+{
+  const arma::mat data = arma::randu<arma::mat>(10, 100);
+  arma::Row<size_t> responses(100);
+  for (size_t i = 0; i < 100; ++i)
+    responses[i] = math::RandInt(0, 2);
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.4);
+  const arma::mat parameters = arma::randn<arma::mat>(11, 1);
+
+  arma::mat gradient, fusedGradient;
+  for (size_t i = 0; i < 100; ++i)
+  {
+    lrf.Gradient(parameters, i, gradient);
+    const double objective = lrf.EvaluateWithGradient(parameters, i,
+        fusedGradient);
+
+    BOOST_REQUIRE_CLOSE(objective, lrf.Evaluate(parameters, i), 1e-5);
+    CheckMatrices(gradient, fusedGradient);
+  }
+}
+
 /**
  * Test separable Gradient() function when regularization is used.
  */
@@ -963,4 +1021,41 @@ BOOST_AUTO_TEST_CASE(ClassifyProbabilitiesTest)
   }
 }
 
+/**
+ * Make sure the sparse gradient of one point holds only the intercept and the
+ * non-zero features of the point, and that lock-free parallel SGD with sparse
+ * updates reduces the objective.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionParallelSGDTest)
+{
+  arma::sp_mat data;
+  data.sprandu(10, 500, 0.3);
+  arma::Row<size_t> responses(500);
+  for (size_t i = 0; i < 500; ++i)
+    responses[i] = (arma::accu(data.col(i)) > 0.75) ? 1 : 0;
+
+  LogisticRegressionFunction<arma::sp_mat> lrf(data, responses, 0.0);
+
+  arma::mat parameters = arma::randu(11, 1);
+  arma::mat denseGradient;
+  arma::sp_mat sparseGradient;
+  for (size_t i = 0; i < 20; ++i)
+  {
+    lrf.Gradient(parameters, i, denseGradient);
+    lrf.Gradient(parameters, i, sparseGradient);
+
+    BOOST_REQUIRE_LE(sparseGradient.n_nonzero, data.col(i).n_nonzero + 1);
+    CheckMatrices(denseGradient, arma::mat(sparseGradient));
+  }
+
+  arma::mat coordinates = lrf.GetInitialPoint();
+  const double initialObjective = lrf.Evaluate(coordinates);
+
+  ParallelSGD<LogisticRegressionFunction<arma::sp_mat>> optimizer(lrf, 1, 0.1,
+      20 * 500, -1, true, true, 4);
+  optimizer.Optimize(coordinates);
+
+  BOOST_REQUIRE_LT(lrf.Evaluate(coordinates), 0.5 * initialObjective);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -314,4 +314,80 @@ BOOST_AUTO_TEST_CASE(Keller4LovaszThetaSDP)
   }
 }*/
 
+/**
+ * Make sure that the augmented Lagrangian of a sparse SDP, which is computed
+ * without forming R R^T, matches the explicit formulas, both when the objective
+ * and the gradient are computed separately and together.
+ */
+BOOST_AUTO_TEST_CASE(SparseAugLagrangianEvaluateGradientTest)
+{
+  const size_t n = 30;
+  const size_t r = 4;
+  const size_t numSparse = 50;
+  const size_t numDense = 3;
+
+  SDP<arma::sp_mat> sdp(n, numSparse, numDense);
+
+  arma::sp_mat c = arma::sprandu<arma::sp_mat>(n, n, 0.1);
+  sdp.C() = c + c.t();
+  for (size_t i = 0; i < numSparse; ++i)
+  {
+    arma::sp_mat a = arma::sprandu<arma::sp_mat>(n, n, 0.05);
+    sdp.SparseA()[i] = a + a.t();
+  }
+  for (size_t i = 0; i < numDense; ++i)
+  {
+    arma::mat a = arma::randu<arma::mat>(n, n);
+    sdp.DenseA()[i] = a + a.t();
+  }
+  sdp.SparseB() = arma::randu<arma::vec>(numSparse);
+  sdp.DenseB() = arma::randu<arma::vec>(numDense);
+
+  const arma::mat coordinates = arma::randu<arma::mat>(n, r);
+  const arma::vec lambda = arma::randn<arma::vec>(numSparse + numDense);
+  const double sigma = 2.5;
+
+  LRSDPFunction<SDP<arma::sp_mat>> function(sdp, coordinates);
+  AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>> augLag(function,
+      lambda, sigma);
+
+  // Compute the objective and the gradient with R R^T.
+  const arma::mat rrt = coordinates * coordinates.t();
+  double objective = arma::accu(arma::mat(sdp.C()) % rrt);
+  arma::mat s(sdp.C());
+  for (size_t i = 0; i < numSparse + numDense; ++i)
+  {
+    const arma::mat a = (i < numSparse) ? arma::mat(sdp.SparseA()[i]) :
+        sdp.DenseA()[i - numSparse];
+    const double b = (i < numSparse) ? sdp.SparseB()[i] :
+        sdp.DenseB()[i - numSparse];
+    const double constraint = arma::accu(a % rrt) - b;
+
+    objective += -lambda[i] * constraint +
+        (sigma / 2.0) * constraint * constraint;
+    s -= (lambda[i] - sigma * constraint) * a;
+  }
+  const arma::mat expectedGradient = 2 * s * coordinates;
+
+  BOOST_REQUIRE_CLOSE(augLag.Evaluate(coordinates), objective, 1e-5);
+
+  arma::mat gradient;
+  augLag.Gradient(coordinates, gradient);
+  BOOST_REQUIRE_EQUAL(gradient.n_rows, n);
+  BOOST_REQUIRE_EQUAL(gradient.n_cols, r);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    if (std::abs(expectedGradient[i]) < 1e-8)
+      BOOST_REQUIRE_SMALL(gradient[i], 1e-8);
+    else
+      BOOST_REQUIRE_CLOSE(gradient[i], expectedGradient[i], 1e-5);
+  }
+
+  // The fused computation must give the same results.
+  arma::mat fusedGradient;
+  BOOST_REQUIRE_CLOSE(augLag.EvaluateWithGradient(coordinates, fusedGradient),
+      objective, 1e-5);
+  CheckMatrices(gradient, fusedGradient, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
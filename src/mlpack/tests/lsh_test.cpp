@@ -14,6 +14,7 @@
 #include "test_tools.hpp"
 
 #include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/lsh/simhash_search.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 using namespace std;
@@ -912,4 +913,276 @@ BOOST_AUTO_TEST_CASE(MoveOperatorTest)
   CheckMatrices(distances, distances2);
 }
 
+/**
+ * Test: the compact second hash table must hold every point once per table
+ * when the bucket size is unlimited.
+ */
+BOOST_AUTO_TEST_CASE(CompactHashTableTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 1000);
+  arma::cube projections = arma::randn<arma::cube>(4, 3, 6);
+
+  LSHSearch<> lsh(rdata, projections, 0.5, 99901, 0);
+
+  const arma::Col<size_t>& offsets = lsh.BucketOffsets();
+  const arma::Col<arma::u32>& contents = lsh.BucketContents();
+  BOOST_REQUIRE_GT(offsets.n_elem, 1);
+  BOOST_REQUIRE_EQUAL(offsets[0], 0);
+  BOOST_REQUIRE_EQUAL(offsets[offsets.n_elem - 1], contents.n_elem);
+  for (size_t i = 1; i < offsets.n_elem; ++i)
+    BOOST_REQUIRE_GT(offsets[i], offsets[i - 1]);
+
+  arma::Col<size_t> counts(rdata.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < contents.n_elem; ++i)
+    counts[contents[i]]++;
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 6);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Test: the tables are built in parallel, so make sure that they are the same
+ * as when they are built with one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTrainTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 1000);
+  arma::cube projections = arma::randn<arma::cube>(4, 3, 8);
+
+  math::RandomSeed(42);
+  LSHSearch<> lsh(rdata, projections, 0.5, 99901, 20);
+
+  size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  math::RandomSeed(42);
+  LSHSearch<> sequentialLsh(rdata, projections, 0.5, 99901, 20);
+  omp_set_num_threads(prevNumThreads);
+
+  CheckMatrices(lsh.BucketOffsets(), sequentialLsh.BucketOffsets());
+  CheckMatrices(arma::conv_to<arma::Mat<size_t>>::from(lsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(sequentialLsh.BucketContents()));
+}
+#endif
+
+/**
+ * Test: queries are processed in blocks, so make sure that searching a query
+ * set larger than a block gives the same results as searching each query
+ * separately.
+ */
+BOOST_AUTO_TEST_CASE(BlockedQueriesTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(3, 500);
+  arma::mat qdata = arma::randu<arma::mat>(3, 2100);
+
+  LSHSearch<> lsh(rdata, 3, 4);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(qdata, 3, neighbors, distances, 0, 2);
+
+  for (size_t i = 0; i < qdata.n_cols; i += 97)
+  {
+    arma::Mat<size_t> singleNeighbors;
+    arma::mat singleDistances;
+    lsh.Search(qdata.col(i), 3, singleNeighbors, singleDistances, 0, 2);
+
+    for (size_t j = 0; j < 3; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(singleNeighbors(j, 0), neighbors(j, i));
+      BOOST_REQUIRE_CLOSE(singleDistances(j, 0), distances(j, i), 1e-5);
+    }
+  }
+}
+
+/**
+ * Test: inserting points into a trained index gives the same results as
+ * training on all of the points with the same hash functions, before and after
+ * compaction.
+ */
+BOOST_AUTO_TEST_CASE(LSHInsertTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 1000);
+  arma::mat qdata = arma::randu<arma::mat>(4, 100);
+  arma::cube projections = arma::randn<arma::cube>(4, 3, 6);
+
+  math::RandomSeed(7);
+  LSHSearch<> lsh(rdata, projections, 0.5, 99901, 0);
+  math::RandomSeed(7);
+  LSHSearch<> partialLsh(rdata.cols(0, 599), projections, 0.5, 99901, 0);
+  partialLsh.Insert(rdata.cols(600, 799));
+  partialLsh.Insert(rdata.cols(800, 999));
+  BOOST_REQUIRE_EQUAL(partialLsh.ReferenceSet().n_cols, 1000);
+
+  arma::Mat<size_t> neighbors, partialNeighbors;
+  arma::mat distances, partialDistances;
+  lsh.Search(qdata, 5, neighbors, distances, 0, 3);
+  partialLsh.Search(qdata, 5, partialNeighbors, partialDistances, 0, 3);
+  CheckMatrices(partialNeighbors, neighbors);
+  CheckMatrices(partialDistances, distances);
+
+  partialLsh.Compact();
+  BOOST_REQUIRE_EQUAL(partialLsh.BucketContents().n_elem,
+      lsh.BucketContents().n_elem);
+  partialLsh.Search(qdata, 5, partialNeighbors, partialDistances, 0, 3);
+  CheckMatrices(partialNeighbors, neighbors);
+  CheckMatrices(partialDistances, distances);
+
+  // Points of the wrong dimensionality are rejected.
+  BOOST_REQUIRE_THROW(partialLsh.Insert(arma::randu<arma::mat>(3, 10)),
+      std::invalid_argument);
+}
+
+/**
+ * Test: deleted points are never returned, and compaction removes them from
+ * the buckets.
+ */
+BOOST_AUTO_TEST_CASE(LSHDeleteTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 1000);
+  arma::mat qdata = arma::randu<arma::mat>(4, 100);
+
+  LSHSearch<> lsh(rdata, 3, 6, 0.5, 99901, 0);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(qdata, 5, neighbors, distances);
+
+  // Delete the first neighbor of each query.
+  for (size_t i = 0; i < qdata.n_cols; ++i)
+    if (neighbors(0, i) != SIZE_MAX)
+      lsh.Delete(neighbors(0, i));
+  const size_t numDeleted = lsh.NumDeleted();
+  BOOST_REQUIRE_GT(numDeleted, 0);
+  BOOST_REQUIRE(!lsh.Delete(neighbors(0, 0)));
+  BOOST_REQUIRE(!lsh.Delete(rdata.n_cols));
+
+  arma::Mat<size_t> newNeighbors;
+  arma::mat newDistances;
+  lsh.Search(qdata, 5, newNeighbors, newDistances);
+  for (size_t i = 0; i < newNeighbors.n_elem; ++i)
+    if (newNeighbors[i] != SIZE_MAX)
+      BOOST_REQUIRE(!lsh.IsDeleted(newNeighbors[i]));
+
+  // Compaction drops each deleted point from its bucket in each table.
+  const size_t numElements = lsh.BucketContents().n_elem;
+  lsh.Compact();
+  BOOST_REQUIRE_EQUAL(lsh.BucketContents().n_elem, numElements - 6 *
+      numDeleted);
+  BOOST_REQUIRE_EQUAL(lsh.NumDeleted(), numDeleted);
+
+  arma::Mat<size_t> compactNeighbors;
+  arma::mat compactDistances;
+  lsh.Search(qdata, 5, compactNeighbors, compactDistances);
+  CheckMatrices(compactNeighbors, newNeighbors);
+  CheckMatrices(compactDistances, newDistances);
+}
+
+/**
+ * Test: the Hamming distance of SimHash codes is the number of differing bits.
+ */
+BOOST_AUTO_TEST_CASE(SimHashHammingDistanceTest)
+{
+  BOOST_REQUIRE_EQUAL(SimHashSearch<>::HammingDistance(0, 0), 0);
+  BOOST_REQUIRE_EQUAL(SimHashSearch<>::HammingDistance(5, 6), 2);
+  BOOST_REQUIRE_EQUAL(SimHashSearch<>::HammingDistance(0, ~uint64_t(0)), 64);
+  BOOST_REQUIRE_EQUAL(SimHashSearch<>::HammingDistance(uint64_t(1) << 63, 1),
+      2);
+}
+
+/**
+ * Test: a scaled copy of a reference point has the same codes, so it is found
+ * with distance 0 without probing other buckets.
+ */
+BOOST_AUTO_TEST_CASE(SimHashScaledQueryTest)
+{
+  arma::mat rdata = arma::randn<arma::mat>(10, 500);
+  SimHashSearch<> simhash(rdata, 24, 4);
+  BOOST_REQUIRE_EQUAL(simhash.NumPoints(), 500);
+  BOOST_REQUIRE_EQUAL(simhash.Projections().n_cols, 96);
+
+  arma::mat qdata = 3.0 * rdata.cols(0, 49);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  simhash.Search(qdata, 1, neighbors, distances);
+
+  std::vector<uint64_t> queryCodes;
+  for (size_t i = 0; i < qdata.n_cols; ++i)
+  {
+    simhash.Hash(qdata.col(i), queryCodes);
+    for (size_t t = 0; t < simhash.NumTables(); ++t)
+      BOOST_REQUIRE_EQUAL(queryCodes[t], simhash.Code(i, t));
+
+    BOOST_REQUIRE_EQUAL(neighbors(0, i), i);
+    BOOST_REQUIRE_SMALL(distances(0, i), 1e-10);
+  }
+}
+
+/**
+ * Test: when the Hamming ball covers every code, the search is exact and
+ * matches a brute-force search with the cosine distance; prefiltering to all
+ * of the points changes nothing.
+ */
+BOOST_AUTO_TEST_CASE(SimHashFullBallTest)
+{
+  arma::mat rdata = arma::randn<arma::mat>(5, 300);
+  arma::mat qdata = arma::randn<arma::mat>(5, 20);
+  SimHashSearch<> simhash(rdata, 6, 2);
+
+  arma::Mat<size_t> neighbors, prefilteredNeighbors;
+  arma::mat distances, prefilteredDistances;
+  simhash.Search(qdata, 4, neighbors, distances, 6);
+  simhash.Search(qdata, 4, prefilteredNeighbors, prefilteredDistances, 6,
+      300);
+  CheckMatrices(neighbors, prefilteredNeighbors);
+  CheckMatrices(distances, prefilteredDistances);
+
+  for (size_t i = 0; i < qdata.n_cols; ++i)
+  {
+    arma::vec trueDistances(rdata.n_cols);
+    for (size_t j = 0; j < rdata.n_cols; ++j)
+      trueDistances[j] = 1.0 - arma::norm_dot(qdata.col(i), rdata.col(j));
+    const arma::uvec order = arma::sort_index(trueDistances);
+
+    for (size_t j = 0; j < 4; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, i), order[j]);
+      BOOST_REQUIRE_CLOSE(distances(j, i), trueDistances[order[j]], 1e-5);
+    }
+  }
+
+  // The ball may not be larger than the codes.
+  BOOST_REQUIRE_THROW(simhash.Search(qdata, 4, neighbors, distances, 7),
+      std::invalid_argument);
+}
+
+/**
+ * Test: prefiltering by Hamming distance only ranks the requested number of
+ * candidates, so every result is one of the candidates with the smallest total
+ * Hamming distance.
+ */
+BOOST_AUTO_TEST_CASE(SimHashPrefilterTest)
+{
+  arma::mat rdata = arma::randn<arma::mat>(5, 300);
+  arma::mat qdata = arma::randn<arma::mat>(5, 10);
+  SimHashSearch<> simhash(rdata, 6, 3);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  simhash.Search(qdata, 3, neighbors, distances, 6, 3);
+
+  std::vector<uint64_t> queryCodes;
+  for (size_t i = 0; i < qdata.n_cols; ++i)
+  {
+    simhash.Hash(qdata.col(i), queryCodes);
+    arma::Col<size_t> hamming(rdata.n_cols, arma::fill::zeros);
+    for (size_t j = 0; j < rdata.n_cols; ++j)
+      for (size_t t = 0; t < simhash.NumTables(); ++t)
+        hamming[j] += SimHashSearch<>::HammingDistance(queryCodes[t],
+            simhash.Code(j, t));
+    const size_t third = arma::sort(hamming)[2];
+
+    for (size_t j = 0; j < 3; ++j)
+      BOOST_REQUIRE_LE(hamming[neighbors(j, i)], third);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
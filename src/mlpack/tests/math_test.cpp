@@ -583,4 +583,71 @@ BOOST_AUTO_TEST_CASE(RangeContainsRange)
   BOOST_REQUIRE_EQUAL(b.Contains(a), true);
 }
 
+/**
+ * Make sure that RandomSeed() makes the random numbers reproducible.
+ */
+BOOST_AUTO_TEST_CASE(RandomSeedReproducibleTest)
+{
+  RandomSeed(42);
+  arma::vec first(100);
+  for (size_t i = 0; i < first.n_elem; ++i)
+    first[i] = (i % 2 == 0) ? Random() : RandNormal();
+
+  RandomSeed(42);
+  arma::vec second(100);
+  for (size_t i = 0; i < second.n_elem; ++i)
+    second[i] = (i % 2 == 0) ? Random() : RandNormal();
+
+  for (size_t i = 0; i < first.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(first[i], second[i]);
+}
+
+/**
+ * Check the moments of the uniform, normal and Bernoulli fill functions.
+ */
+BOOST_AUTO_TEST_CASE(RandomFillMomentsTest)
+{
+  RandomSeed(7);
+
+  arma::mat uniform(100, 1000);
+  RandomFill(uniform);
+  BOOST_REQUIRE_GE(uniform.min(), 0.0);
+  BOOST_REQUIRE_LT(uniform.max(), 1.0);
+  BOOST_REQUIRE_CLOSE(arma::mean(arma::vectorise(uniform)), 0.5, 1.0);
+
+  arma::mat normal(100, 1001);
+  RandNormalFill(normal);
+  BOOST_REQUIRE_SMALL(arma::mean(arma::vectorise(normal)), 0.01);
+  BOOST_REQUIRE_CLOSE(arma::var(arma::vectorise(normal)), 1.0, 2.0);
+
+  arma::fmat bernoulli(100, 1000);
+  RandBernoulliFill(bernoulli, 0.3);
+  BOOST_REQUIRE_EQUAL(arma::accu(bernoulli == 0) + arma::accu(bernoulli == 1),
+      bernoulli.n_elem);
+  BOOST_REQUIRE_CLOSE((double) arma::accu(bernoulli) / bernoulli.n_elem, 0.3,
+      2.0);
+
+  // The edge probabilities give constant masks.
+  RandBernoulliFill(bernoulli, 0.0);
+  BOOST_REQUIRE_EQUAL((double) arma::accu(bernoulli), 0.0);
+  RandBernoulliFill(bernoulli, 1.0);
+  BOOST_REQUIRE_EQUAL((size_t) arma::accu(bernoulli), bernoulli.n_elem);
+}
+
+/**
+ * Make sure that jumped generators give different streams.
+ */
+BOOST_AUTO_TEST_CASE(Xoshiro256JumpTest)
+{
+  Xoshiro256 a(12), b(12);
+  BOOST_REQUIRE_EQUAL(a(), b());
+
+  b.Jump();
+  size_t equal = 0;
+  for (size_t i = 0; i < 1000; ++i)
+    equal += (a() == b()) ? 1 : 0;
+
+  BOOST_REQUIRE_EQUAL(equal, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -144,4 +144,41 @@ BOOST_AUTO_TEST_CASE(GaussianClustering)
       BOOST_REQUIRE_NE(minIndices[i], minIndices[j]);
 }
 
+/**
+ * Make sure that many modes are found and merged correctly in low dimensions,
+ * where the duplicate centroids are found with the cells of the centroids.
+ */
+BOOST_AUTO_TEST_CASE(ManyModesTest)
+{
+  // A 5x5 grid of tight clusters.
+  arma::mat dataset(2, 2500);
+  for (size_t i = 0; i < 25; ++i)
+  {
+    arma::vec center(2);
+    center[0] = 10.0 * (i % 5);
+    center[1] = 10.0 * (i / 5);
+    for (size_t j = 0; j < 100; ++j)
+      dataset.col(100 * i + j) = center + 0.3 * arma::randn<arma::vec>(2);
+  }
+
+  MeanShift<> meanShift(2.0);
+
+  arma::Col<size_t> assignments;
+  arma::mat centroids;
+  meanShift.Cluster(dataset, assignments, centroids, false);
+
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 25);
+
+  // Each cluster has all of its points in one cluster, close to its center.
+  for (size_t i = 0; i < 25; ++i)
+  {
+    const size_t cluster = assignments[100 * i];
+    for (size_t j = 1; j < 100; ++j)
+      BOOST_REQUIRE_EQUAL(assignments[100 * i + j], cluster);
+
+    BOOST_REQUIRE_SMALL(centroids(0, cluster) - 10.0 * (i % 5), 0.5);
+    BOOST_REQUIRE_SMALL(centroids(1, cluster) - 10.0 * (i / 5), 0.5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
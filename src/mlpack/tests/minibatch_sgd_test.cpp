@@ -31,6 +31,56 @@ using namespace mlpack::regression;
 
 BOOST_AUTO_TEST_SUITE(MiniBatchSGDTest);
 
+//! SGDTestFunction with a batch EvaluateWithGradient(), which counts the calls
+//! of each of its functions.
+class BatchCountingSGDTestFunction
+{
+ public:
+  BatchCountingSGDTestFunction() : gradients(0), evaluationsWithGradient(0) { }
+
+  size_t NumFunctions() const { return function.NumFunctions(); }
+  arma::mat GetInitialPoint() const { return function.GetInitialPoint(); }
+
+  double Evaluate(const arma::mat& coordinates, const size_t i)
+  {
+    return function.Evaluate(coordinates, i);
+  }
+
+  void Gradient(const arma::mat& coordinates,
+                const size_t i,
+                arma::mat& gradient)
+  {
+    ++gradients;
+    function.Gradient(coordinates, i, gradient);
+  }
+
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize)
+  {
+    ++evaluationsWithGradient;
+    double objective = 0;
+    arma::mat pointGradient;
+    for (size_t i = begin; i < begin + batchSize; ++i)
+    {
+      function.Gradient(coordinates, i, pointGradient);
+      if (i == begin)
+        gradient = pointGradient;
+      else
+        gradient += pointGradient;
+
+      objective += function.Evaluate(coordinates, i);
+    }
+
+    return objective;
+  }
+
+  SGDTestFunction function;
+  size_t gradients;
+  size_t evaluationsWithGradient;
+};
+
 /**
  * If the batch size is 1, and we aren't shuffling, we should get the exact same
  * results as regular SGD.
@@ -136,6 +186,30 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionTest)
   }
 }
 
+/**
+ * Make sure the batch EvaluateWithGradient() is used when the function has it,
+ * and that the result is the same as with Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(EvaluateWithGradientMiniBatchSGDTest)
+{
+  SGDTestFunction f;
+  MiniBatchSGD<SGDTestFunction> s(f, 2, 0.0003, 10000, 1e-9, false);
+  arma::mat coordinates = f.GetInitialPoint();
+  const double result = s.Optimize(coordinates);
+
+  BatchCountingSGDTestFunction cf;
+  MiniBatchSGD<BatchCountingSGDTestFunction> cs(cf, 2, 0.0003, 10000, 1e-9,
+      false);
+  arma::mat countingCoordinates = cf.GetInitialPoint();
+  const double countingResult = cs.Optimize(countingCoordinates);
+
+  BOOST_REQUIRE_CLOSE(countingResult, result, 1e-10);
+  CheckMatrices(countingCoordinates, coordinates);
+
+  BOOST_REQUIRE_EQUAL(cf.gradients, 0);
+  BOOST_REQUIRE_GT(cf.evaluationsWithGradient, 0);
+}
+
 /**
  * Run mini-batch SGD on a simple test function and make sure the last batch
  * size is handled correctly.
@@ -314,4 +314,112 @@ BOOST_AUTO_TEST_CASE(SeparateTrainIndividualIncrementalTest)
   }
 }
 
+/**
+ * Check that merging models trained on two halves of a dataset, or training
+ * incrementally on the second half after the first, gives the model trained on
+ * the whole dataset.
+ */
+BOOST_AUTO_TEST_CASE(MergeTest)
+{
+  arma::mat trainData;
+  data::Load("trainSet.csv", trainData, true);
+
+  arma::Row<size_t> labels(trainData.n_cols);
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+    labels[i] = trainData(trainData.n_rows - 1, i);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  const size_t half = trainData.n_cols / 2;
+  const arma::mat first = trainData.cols(0, half - 1);
+  const arma::mat second = trainData.cols(half, trainData.n_cols - 1);
+  const arma::Row<size_t> firstLabels = labels.subvec(0, half - 1);
+  const arma::Row<size_t> secondLabels = labels.subvec(half,
+      labels.n_elem - 1);
+
+  NaiveBayesClassifier<> nbc(trainData, labels, 2, false);
+
+  NaiveBayesClassifier<> merged(first, firstLabels, 2, true);
+  NaiveBayesClassifier<> other(second, secondLabels, 2, true);
+  merged.Merge(other);
+
+  NaiveBayesClassifier<> incremental(first, firstLabels, 2, true);
+  incremental.Train(second, secondLabels, true);
+
+  for (size_t i = 0; i < nbc.Means().n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(merged.Means()[i], nbc.Means()[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(merged.Variances()[i], nbc.Variances()[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(incremental.Means()[i], nbc.Means()[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(incremental.Variances()[i], nbc.Variances()[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < nbc.Probabilities().n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(merged.Probabilities()[i], nbc.Probabilities()[i],
+        1e-5);
+    BOOST_REQUIRE_CLOSE(incremental.Probabilities()[i],
+        nbc.Probabilities()[i], 1e-5);
+  }
+
+  // Models of different sizes can't be merged.
+  NaiveBayesClassifier<> wrong(trainData.n_rows, 3);
+  BOOST_REQUIRE_THROW(merged.Merge(wrong), std::invalid_argument);
+}
+
+/**
+ * Make sure that classifying a set of points, dense or sparse, gives the same
+ * results as classifying the points one at a time.
+ */
+BOOST_AUTO_TEST_CASE(BatchClassifyTest)
+{
+  // Enough points for several blocks, and many dimensions, so that the
+  // probabilities are tiny.
+  arma::mat data = arma::randu<arma::mat>(200, 2000);
+  arma::Row<size_t> labels(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    labels[i] = i % 3;
+    data.col(i) += 0.1 * labels[i];
+  }
+
+  NaiveBayesClassifier<> nbc(data, labels, 3);
+
+  // Make the test points sparse.
+  arma::mat test = arma::randu<arma::mat>(200, 1000);
+  test.elem(arma::find(test < 0.8)).zeros();
+  const arma::sp_mat sparseTest(test);
+
+  arma::Row<size_t> predictions, sparsePredictions, probPredictions;
+  arma::mat probabilities, sparseProbabilities;
+  nbc.Classify(test, predictions);
+  nbc.Classify(test, probPredictions, probabilities);
+  nbc.Classify(sparseTest, sparsePredictions, sparseProbabilities);
+
+  for (size_t i = 0; i < test.n_cols; ++i)
+  {
+    size_t prediction;
+    arma::vec pointProbabilities;
+    nbc.Classify(test.col(i), prediction, pointProbabilities);
+
+    BOOST_REQUIRE_EQUAL(predictions[i], prediction);
+    BOOST_REQUIRE_EQUAL(probPredictions[i], prediction);
+    BOOST_REQUIRE_EQUAL(sparsePredictions[i], prediction);
+    BOOST_REQUIRE_CLOSE(arma::accu(probabilities.col(i)), 1.0, 1e-5);
+    for (size_t j = 0; j < pointProbabilities.n_elem; ++j)
+    {
+      if (pointProbabilities[j] < 1e-10)
+      {
+        BOOST_REQUIRE_SMALL(probabilities(j, i), 1e-10);
+        BOOST_REQUIRE_SMALL(sparseProbabilities(j, i), 1e-10);
+      }
+      else
+      {
+        BOOST_REQUIRE_CLOSE(probabilities(j, i), pointProbabilities[j], 1e-5);
+        BOOST_REQUIRE_CLOSE(sparseProbabilities(j, i), pointProbabilities[j],
+            1e-5);
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -249,6 +249,116 @@ BOOST_AUTO_TEST_CASE(SoftmaxSeparableGradient)
   BOOST_REQUIRE_CLOSE(gradient(1, 1), -2.0 * -0.1435886, 0.01);
 }
 
+/**
+ * Make sure both forms of EvaluateWithGradient() give the same results as
+ * Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxEvaluateWithGradient)
+{
+  arma::mat data           = "-0.1 -0.1 -0.1  0.1  0.1  0.1;"
+                             " 1.0  0.0 -1.0  1.0  0.0 -1.0 ";
+  arma::Row<size_t> labels = " 0    0    0    1    1    1   ";
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+
+  arma::mat coordinates = arma::randu<arma::mat>(2, 2);
+  arma::mat gradient, fusedGradient;
+
+  sef.Gradient(coordinates, gradient);
+  double objective = sef.EvaluateWithGradient(coordinates, fusedGradient);
+  BOOST_REQUIRE_CLOSE(objective, sef.Evaluate(coordinates), 1e-5);
+  CheckMatrices(gradient, fusedGradient);
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    sef.Gradient(coordinates, i, gradient);
+    objective = sef.EvaluateWithGradient(coordinates, i, fusedGradient);
+    BOOST_REQUIRE_CLOSE(objective, sef.Evaluate(coordinates, i), 1e-5);
+    CheckMatrices(gradient, fusedGradient);
+  }
+}
+
+/**
+ * When the sums are truncated to all the other points, the objective and the
+ * gradient must be the same as without truncation.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxTruncatedAllNeighbors)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 50);
+  arma::Row<size_t> labels(50);
+  for (size_t i = 0; i < 50; ++i)
+    labels[i] = (data(0, i) > 0.5) ? 1 : 0;
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+  SoftmaxErrorFunction<SquaredEuclideanDistance> truncatedSef(data, labels);
+  truncatedSef.NumNeighbors() = 49;
+
+  arma::mat coordinates = 2.0 * arma::eye<arma::mat>(3, 3);
+  coordinates(0, 1) = 0.5;
+
+  BOOST_REQUIRE_CLOSE(sef.Evaluate(coordinates),
+      truncatedSef.Evaluate(coordinates), 1e-5);
+
+  arma::mat gradient, truncatedGradient;
+  sef.Gradient(coordinates, gradient);
+  truncatedSef.Gradient(coordinates, truncatedGradient);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    if (std::abs(gradient[i]) < 1e-8)
+      BOOST_REQUIRE_SMALL(truncatedGradient[i], 1e-8);
+    else
+      BOOST_REQUIRE_CLOSE(gradient[i], truncatedGradient[i], 1e-5);
+  }
+
+  // Check the separable functions too.
+  for (size_t i = 0; i < 50; i += 7)
+  {
+    BOOST_REQUIRE_CLOSE(sef.Evaluate(coordinates, i),
+        truncatedSef.Evaluate(coordinates, i), 1e-5);
+
+    sef.Gradient(coordinates, i, gradient);
+    truncatedSef.Gradient(coordinates, i, truncatedGradient);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+    {
+      if (std::abs(gradient[j]) < 1e-8)
+        BOOST_REQUIRE_SMALL(truncatedGradient[j], 1e-8);
+      else
+        BOOST_REQUIRE_CLOSE(gradient[j], truncatedGradient[j], 1e-5);
+    }
+  }
+}
+
+/**
+ * On two well-separated clusters, the terms of the points of the other cluster
+ * are negligible, so truncating the sums to the points of each cluster gives
+ * nearly the same gradient.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxTruncatedSeparatedClusters)
+{
+  arma::mat data = arma::randu<arma::mat>(2, 40);
+  data.cols(20, 39) += 50.0;
+  arma::Row<size_t> labels(40);
+  for (size_t i = 0; i < 40; ++i)
+    labels[i] = (i < 20) ? 0 : 1;
+  // Mislabel a few points, so that the gradient isn't zero.
+  labels[3] = 1;
+  labels[25] = 0;
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+  SoftmaxErrorFunction<SquaredEuclideanDistance> truncatedSef(data, labels);
+  truncatedSef.NumNeighbors() = 19;
+
+  const arma::mat coordinates = arma::eye<arma::mat>(2, 2);
+  BOOST_REQUIRE_CLOSE(sef.Evaluate(coordinates),
+      truncatedSef.Evaluate(coordinates), 1e-5);
+
+  arma::mat gradient, truncatedGradient;
+  sef.Gradient(coordinates, gradient);
+  truncatedSef.Gradient(coordinates, truncatedGradient);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(gradient[i] - truncatedGradient[i], 1e-5);
+}
+
 //
 // Tests for the NCA algorithm.
 //
@@ -322,4 +432,32 @@ BOOST_AUTO_TEST_CASE(NCALBFGSSimpleDataset)
   BOOST_REQUIRE_LT(arma::norm(finalGradient, 2), 1e-6);
 }
 
+/**
+ * Make sure that NCA with truncated sums still separates our simple dataset.
+ */
+BOOST_AUTO_TEST_CASE(NCALBFGSTruncatedSimpleDataset)
+{
+  // Useful but simple dataset with six points and two classes.
+  arma::mat data           = "-0.1 -0.1 -0.1  0.1  0.1  0.1;"
+                             " 1.0  0.0 -1.0  1.0  0.0 -1.0 ";
+  arma::Row<size_t> labels = " 0    0    0    1    1    1   ";
+
+  NCA<SquaredEuclideanDistance, L_BFGS> nca(data, labels);
+  nca.Optimizer().NumBasis() = 5;
+  nca.Optimizer().Function().NumNeighbors() = 3;
+  nca.Optimizer().Function().RefreshInterval() = 2;
+
+  arma::mat outputMatrix;
+  nca.LearnDistance(outputMatrix);
+
+  // Evaluate the exact objective.
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+
+  double initObj = sef.Evaluate(arma::eye<arma::mat>(2, 2));
+  double finalObj = sef.Evaluate(outputMatrix);
+
+  BOOST_REQUIRE_LT(finalObj, initObj);
+  BOOST_REQUIRE_LT(finalObj, -5.5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -220,4 +220,57 @@ BOOST_AUTO_TEST_CASE(SparseNMFALSTest)
       1e-5);
 }
 
+/**
+ * Make sure the sparse divergence update rules, which only compute WH at the
+ * nonzero entries of V, give the same W and H as the dense rules.
+ */
+BOOST_AUTO_TEST_CASE(SparseNMFMultiplicativeDivergenceUpdateTest)
+{
+  sp_mat v;
+  v.sprandu(30, 40, 0.1);
+  mat dv(v); // Make a dense copy.
+
+  mat w = randu<mat>(30, 5);
+  mat h = randu<mat>(5, 40);
+  mat dw(w), dh(h);
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    NMFMultiplicativeDivergenceUpdate::WUpdate(v, w, h);
+    NMFMultiplicativeDivergenceUpdate::WUpdate(dv, dw, dh);
+    CheckMatrices(w, dw, 1e-5);
+
+    NMFMultiplicativeDivergenceUpdate::HUpdate(v, w, h);
+    NMFMultiplicativeDivergenceUpdate::HUpdate(dv, dw, dh);
+    CheckMatrices(h, dh, 1e-5);
+  }
+}
+
+/**
+ * Make sure the residue of SimpleResidueTermination is the relative change of
+ * the sum of the norms of the columns of WH.
+ */
+BOOST_AUTO_TEST_CASE(SimpleResidueTerminationTest)
+{
+  mat v = randu<mat>(30, 40);
+  SimpleResidueTermination srt(1e-5, 100);
+  srt.Initialize(v);
+
+  mat w1 = randu<mat>(30, 5);
+  mat h1 = randu<mat>(5, 40);
+  mat w2 = randu<mat>(30, 5);
+  mat h2 = randu<mat>(5, 40);
+
+  double norm1 = 0.0, norm2 = 0.0;
+  for (size_t j = 0; j < v.n_cols; ++j)
+  {
+    norm1 += arma::norm(w1 * h1.col(j), 2);
+    norm2 += arma::norm(w2 * h2.col(j), 2);
+  }
+
+  BOOST_REQUIRE(!srt.IsConverged(w1, h1));
+  BOOST_REQUIRE(!srt.IsConverged(w2, h2));
+  BOOST_REQUIRE_CLOSE(srt.Index(), std::abs(norm1 - norm2) / norm1, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -179,6 +179,71 @@ BOOST_AUTO_TEST_CASE(OverlapTest)
   CheckOverlap(t2);
 }
 
+/**
+ * Make sure that the points of every node are split between its children, and
+ * that the leaves hold no more than maxLeafSize points.
+ */
+template<typename TreeType>
+void CheckDescendants(TreeType& node, const size_t maxLeafSize)
+{
+  if (node.NumChildren() == 0)
+  {
+    BOOST_REQUIRE_LE(node.NumPoints(), maxLeafSize);
+    return;
+  }
+
+  size_t descendants = 0;
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_GT(node.Child(i).NumDescendants(), 0);
+    BOOST_REQUIRE_EQUAL(node.Child(i).Descendant(0),
+        node.Descendant(descendants));
+    descendants += node.Child(i).NumDescendants();
+    CheckDescendants(node.Child(i), maxLeafSize);
+  }
+
+  BOOST_REQUIRE_EQUAL(descendants, node.NumDescendants());
+}
+
+/**
+ * Build octrees on large low-dimensional datasets, which are sorted by their
+ * Morton codes, and on a dataset with too many dimensions for Morton codes, and
+ * make sure that the trees and the mappings are valid.
+ */
+BOOST_AUTO_TEST_CASE(MortonOrderTest)
+{
+  for (size_t d = 1; d < 4; ++d)
+  {
+    arma::mat dataset(d, 100000, arma::fill::randu);
+    std::vector<size_t> oldFromNew, newFromOld;
+    Octree<> t(dataset, oldFromNew, newFromOld, 10);
+
+    BOOST_REQUIRE_EQUAL(t.NumDescendants(), dataset.n_cols);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(arma::norm(dataset.col(oldFromNew[i]) -
+          t.Dataset().col(i)), 0.0);
+      BOOST_REQUIRE_EQUAL(newFromOld[oldFromNew[i]], i);
+    }
+
+    CheckDescendants(t, 10);
+    CheckOverlap(t);
+  }
+
+  arma::mat dataset(17, 300, arma::fill::randu);
+  std::vector<size_t> oldFromNew;
+  Octree<> t(dataset, oldFromNew, 10);
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(arma::norm(dataset.col(oldFromNew[i]) -
+        t.Dataset().col(i)), 0.0);
+  }
+
+  CheckDescendants(t, 10);
+  CheckOverlap(t);
+}
+
 /**
  * Make sure no points are further than the furthest point distance, and that no
  * descendants are further than the furthest descendant distance.
@@ -322,6 +387,28 @@ BOOST_AUTO_TEST_CASE(MoveConstructorTest)
   CheckSameNode(tcopy, t2);
 }
 
+#ifdef HAS_OPENMP
+/**
+ * Make sure that an octree built with several threads is the same as one built
+ * with one thread.
+ */
+BOOST_AUTO_TEST_CASE(MultithreadedOctreeTest)
+{
+  arma::mat dataset(3, 100000, arma::fill::randu);
+  std::vector<size_t> serialOldFromNew, oldFromNew;
+
+  const int numThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  Octree<> serialTree(dataset, serialOldFromNew);
+  omp_set_num_threads(4);
+  Octree<> tree(dataset, oldFromNew);
+  omp_set_num_threads(numThreads);
+
+  BOOST_REQUIRE(serialOldFromNew == oldFromNew);
+  CheckSameNode(serialTree, tree);
+}
+#endif
+
 /**
  * Test serialization.
  */
@@ -11,6 +11,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/core.hpp>
+#include <mlpack/core/data/batch_source.hpp>
 #include <mlpack/methods/pca/pca.hpp>
 #include <mlpack/methods/pca/decomposition_policies/exact_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/quic_svd_method.hpp>
@@ -191,6 +192,79 @@ BOOST_AUTO_TEST_CASE(ArmaComparisonRandomizedPCATest)
   ArmaComparisonPCA<RandomizedSVDPolicy>();
 }
 
+/**
+ * Compare the output of the randomized-SVD PCA of data read from a batch source
+ * with Armadillo's.
+ */
+BOOST_AUTO_TEST_CASE(ArmaComparisonStreamedRandomizedPCATest)
+{
+  arma::mat coeff, coeff1, score;
+  arma::vec eigVal, eigVal1, mean;
+
+  arma::mat data = arma::randu<arma::mat>(3, 1000);
+  arma::mat noResponses(0, data.n_cols);
+  data::MatrixBatchSource<> source(data, noResponses, 300);
+
+  PCAType<RandomizedSVDPolicy> pcaType;
+  pcaType.Apply(source, eigVal1, coeff1, mean, 3);
+
+  princomp(coeff, score, eigVal, trans(data));
+
+  CheckMatrices(mean, arma::mean(data, 1));
+  for (size_t i = 0; i < eigVal.n_elem; i++)
+  {
+    BOOST_REQUIRE_CLOSE(eigVal[i], eigVal1[i], 0.0001);
+
+    // The principal components are only known up to their sign.
+    BOOST_REQUIRE_CLOSE(std::abs(arma::dot(coeff.col(i), coeff1.col(i))), 1.0,
+        0.0001);
+  }
+}
+
+/**
+ * Compare the output of the PCA of sparse data, which is centered implicitly,
+ * with Armadillo's on the dense copy of the data.
+ */
+template<typename DecompositionPolicy>
+void SparsePCA()
+{
+  arma::mat coeff, coeff1, score, score1;
+  arma::vec eigVal, eigVal1;
+
+  arma::sp_mat data = arma::sprandu<arma::sp_mat>(5, 1000, 0.3);
+
+  PCAType<DecompositionPolicy> pcaType;
+  pcaType.Apply(data, score1, eigVal1, coeff1, 5);
+
+  princomp(coeff, score, eigVal, trans(arma::mat(data)));
+
+  for (size_t i = 0; i < eigVal.n_elem; i++)
+  {
+    BOOST_REQUIRE_CLOSE(eigVal[i], eigVal1[i], 0.0001);
+
+    // The principal components are only known up to their sign.
+    const double sign = arma::dot(coeff.col(i), coeff1.col(i)) > 0 ? 1 : -1;
+    for (size_t j = 0; j < data.n_cols; j++)
+      BOOST_REQUIRE_SMALL(score(j, i) - sign * score1(i, j), 1e-5);
+  }
+}
+
+/**
+ * Compare the randomized-SVD PCA of sparse data with Armadillo's.
+ */
+BOOST_AUTO_TEST_CASE(SparseRandomizedPCATest)
+{
+  SparsePCA<RandomizedSVDPolicy>();
+}
+
+/**
+ * Compare the randomized block krylov PCA of sparse data with Armadillo's.
+ */
+BOOST_AUTO_TEST_CASE(SparseRandomizedBlockKrylovPCATest)
+{
+  SparsePCA<RandomizedBlockKrylovSVDPolicy>();
+}
+
 /**
  * Test that dimensionality reduction with exact-svd PCA works the same way
  * MATLAB does (which should be correct!).
@@ -255,4 +255,39 @@ BOOST_AUTO_TEST_CASE(SecondaryConstructor)
   Perceptron<> p2(p1);
 }
 
+/**
+ * Train a mini-batch perceptron on a linearly separable dataset and make sure
+ * that it classifies every training point correctly; also make sure that a
+ * batch size of one gives the same weights as the default.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchTest)
+{
+  // Two well-separated clusters.
+  mat trainData = randn<mat>(3, 400);
+  Row<size_t> labels(400);
+  for (size_t i = 0; i < 400; ++i)
+  {
+    labels[i] = i % 2;
+    trainData(0, i) += (labels[i] == 0) ? -10.0 : 10.0;
+  }
+
+  Perceptron<> p(trainData, labels, 2, 1000, 32);
+  BOOST_REQUIRE_EQUAL(p.BatchSize(), 32);
+
+  Row<size_t> predictedLabels;
+  p.Classify(trainData, predictedLabels);
+  BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, 400);
+  for (size_t i = 0; i < 400; ++i)
+    BOOST_REQUIRE_EQUAL(predictedLabels[i], labels[i]);
+
+  Perceptron<> p1(trainData, labels, 2, 1000, 1);
+  Perceptron<> p2(trainData, labels, 2, 1000);
+  CheckMatrices(p1.Weights(), p2.Weights());
+  CheckMatrices(p1.Biases(), p2.Biases());
+
+  // A batch size of zero is invalid.
+  Perceptron<> p3(2, 3, 1000, 0);
+  BOOST_REQUIRE_THROW(p3.Train(trainData, labels), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,190 @@
+/**
+ * @file pq_test.cpp
+ *
+ * Test the PQSearch (IVF-PQ approximate nearest neighbor) functionality.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+#include "serialization.hpp"
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/pq/pq_search.hpp>
+#include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+using namespace std;
+using namespace arma;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+BOOST_AUTO_TEST_SUITE(PQSearchTest);
+
+/**
+ * Make sure that every point is stored in exactly one list, with one code per
+ * subvector.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchIndexTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 500);
+
+  PQSearch<> pq(dataset, 7, 4, 32);
+
+  BOOST_REQUIRE_EQUAL(pq.NumPoints(), 500);
+  BOOST_REQUIRE_EQUAL(pq.Centroids().n_rows, 10);
+  BOOST_REQUIRE_EQUAL(pq.Centroids().n_cols, 7);
+  BOOST_REQUIRE_EQUAL(pq.Codes().n_rows, 500);
+  BOOST_REQUIRE_EQUAL(pq.Codes().n_cols, 4);
+
+  // The subvectors must cover all of the dimensions.
+  BOOST_REQUIRE_EQUAL(pq.SubvectorStarts().n_elem, 5);
+  BOOST_REQUIRE_EQUAL(pq.SubvectorStarts()[0], 0);
+  BOOST_REQUIRE_EQUAL(pq.SubvectorStarts()[4], 10);
+  for (size_t j = 0; j < 4; ++j)
+  {
+    BOOST_REQUIRE_EQUAL(pq.Codebook(j).n_rows, pq.SubvectorStarts()[j + 1] -
+        pq.SubvectorStarts()[j]);
+    BOOST_REQUIRE_EQUAL(pq.Codebook(j).n_cols, 32);
+  }
+
+  BOOST_REQUIRE_EQUAL(pq.ListOffsets().n_elem, 8);
+  BOOST_REQUIRE_EQUAL(pq.ListOffsets()[0], 0);
+  BOOST_REQUIRE_EQUAL(pq.ListOffsets()[7], 500);
+
+  arma::Col<size_t> counts(500, arma::fill::zeros);
+  for (size_t i = 0; i < pq.ListIndices().n_elem; ++i)
+    counts[pq.ListIndices()[i]]++;
+  for (size_t i = 0; i < 500; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  for (size_t i = 0; i < pq.Codes().n_elem; ++i)
+    BOOST_REQUIRE_LT(pq.Codes()[i], 32);
+}
+
+/**
+ * With enough codes for each dimension, the approximate distances should be
+ * close to the true distances of the returned neighbors, and most of the true
+ * neighbors should be found when all lists are scanned.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchRecallTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+  arma::mat queries = arma::randu<arma::mat>(3, 200);
+
+  PQSearch<> pq(dataset, 8, 3, 64);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  pq.Search(queries, 5, neighbors, distances, 0);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, 200);
+  BOOST_REQUIRE_EQUAL(distances.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, 200);
+
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      BOOST_REQUIRE_LT(neighbors(j, i), 1000);
+      if (j > 0)
+        BOOST_REQUIRE_LE(distances(j - 1, i), distances(j, i));
+
+      const double trueDistance = metric::EuclideanDistance::Evaluate(
+          queries.col(i), dataset.col(neighbors(j, i)));
+      BOOST_REQUIRE_SMALL(distances(j, i) - trueDistance, 0.1);
+    }
+  }
+
+  KNN knn(dataset);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(queries, 5, trueNeighbors, trueDistances);
+
+  BOOST_REQUIRE_GE(LSHSearch<>::ComputeRecall(neighbors, trueNeighbors), 0.5);
+}
+
+/**
+ * Scanning more lists can only find better candidates.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchProbesTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(6, 800);
+  arma::mat queries = arma::randu<arma::mat>(6, 100);
+
+  PQSearch<> pq(dataset, 16, 3, 64);
+
+  arma::Mat<size_t> neighbors, allNeighbors;
+  arma::mat distances, allDistances;
+  pq.Search(queries, 3, neighbors, distances, 2);
+  pq.Search(queries, 3, allNeighbors, allDistances, 0);
+
+  for (size_t i = 0; i < distances.n_elem; ++i)
+    BOOST_REQUIRE_LE(allDistances[i], distances[i] + 1e-5);
+}
+
+/**
+ * Make sure invalid parameters are rejected.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchInvalidParametersTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 100);
+
+  // Too many codes, subvectors or lists.
+  BOOST_REQUIRE_THROW(PQSearch<>(dataset, 4, 2, 257), std::invalid_argument);
+  BOOST_REQUIRE_THROW(PQSearch<>(dataset, 4, 5, 16), std::invalid_argument);
+  BOOST_REQUIRE_THROW(PQSearch<>(dataset, 101, 2, 16), std::invalid_argument);
+
+  PQSearch<> pq(dataset, 4, 2, 16);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+
+  // Wrong dimensionality, and too many neighbors.
+  BOOST_REQUIRE_THROW(pq.Search(arma::randu<arma::mat>(3, 10), 1, neighbors,
+      distances), std::invalid_argument);
+  BOOST_REQUIRE_THROW(pq.Search(dataset, 101, neighbors, distances),
+      std::invalid_argument);
+}
+
+/**
+ * Test serialization of PQSearch.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchSerializationTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(8, 400);
+  arma::mat queries = arma::randu<arma::mat>(8, 50);
+
+  PQSearch<> pq(dataset, 5, 4, 32);
+
+  arma::mat fakeDataset = arma::randu<arma::mat>(3, 100);
+  PQSearch<> pqXml(fakeDataset, 2, 3, 8);
+  PQSearch<> pqText;
+  PQSearch<> pqBinary(fakeDataset, 3, 1, 4);
+
+  SerializeObjectAll(pq, pqXml, pqText, pqBinary);
+
+  BOOST_REQUIRE_EQUAL(pqXml.NumPoints(), pq.NumPoints());
+  BOOST_REQUIRE_EQUAL(pqText.NumPoints(), pq.NumPoints());
+  BOOST_REQUIRE_EQUAL(pqBinary.NumPoints(), pq.NumPoints());
+
+  CheckMatrices(pq.Centroids(), pqXml.Centroids(), pqText.Centroids(),
+      pqBinary.Centroids());
+  CheckMatrices(pq.ListOffsets(), pqXml.ListOffsets(), pqText.ListOffsets(),
+      pqBinary.ListOffsets());
+
+  arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat distances, xmlDistances, textDistances, binaryDistances;
+  pq.Search(queries, 3, neighbors, distances, 2);
+  pqXml.Search(queries, 3, xmlNeighbors, xmlDistances, 2);
+  pqText.Search(queries, 3, textNeighbors, textDistances, 2);
+  pqBinary.Search(queries, 3, binaryNeighbors, binaryDistances, 2);
+
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
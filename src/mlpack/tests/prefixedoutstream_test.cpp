@@ -11,6 +11,7 @@
  */
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 #include <mlpack/core.hpp>
 
@@ -239,4 +240,63 @@ BOOST_AUTO_TEST_CASE(TestArmaCustomPrecision)
       BASH_GREEN "[INFO ] " BASH_CLEAR "   4.0000   4.5000   5.0000\n");
 }
 
+/**
+ * Test that lines written from several threads at once are not interleaved.
+ */
+BOOST_AUTO_TEST_CASE(TestPrefixedOutStreamThreads)
+{
+  std::stringstream ss;
+  PrefixedOutStream pss(ss, BASH_GREEN "[INFO ] " BASH_CLEAR);
+
+  // Each line is written in several pieces.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t)
+  {
+    threads.push_back(std::thread([&pss, t]()
+    {
+      for (size_t i = 0; i < 500; ++i)
+      {
+        pss << "thread " << t;
+        pss << " line " << i << "." << std::endl;
+      }
+    }));
+  }
+  for (size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+
+  std::vector<size_t> counts(4, 0);
+  std::string line;
+  while (std::getline(ss, line))
+  {
+    std::istringstream tokens(line);
+    std::string prefix, status, threadWord, lineWord, number;
+    size_t t;
+    tokens >> prefix >> status >> threadWord >> t >> lineWord >> number;
+
+    BOOST_REQUIRE_EQUAL(threadWord, BASH_CLEAR "thread");
+    BOOST_REQUIRE_EQUAL(lineWord, "line");
+    BOOST_REQUIRE_LT(t, 4);
+    BOOST_REQUIRE_EQUAL(number, std::to_string(counts[t]) + ".");
+    ++counts[t];
+  }
+
+  for (size_t t = 0; t < 4; ++t)
+    BOOST_REQUIRE_EQUAL(counts[t], 500);
+}
+
+/**
+ * Test that nothing is written by an ignored stream, from any thread.
+ */
+BOOST_AUTO_TEST_CASE(TestIgnoredPrefixedOutStreamThreads)
+{
+  std::stringstream ss;
+  PrefixedOutStream pss(ss, BASH_GREEN "[INFO ] " BASH_CLEAR, true);
+
+  pss << "Nothing" << std::endl;
+  std::thread thread([&pss]() { pss << "at all." << std::endl; });
+  thread.join();
+
+  BOOST_REQUIRE_EQUAL(ss.str(), "");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -13,13 +13,16 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/core/optimizers/gradient_descent/gradient_descent.hpp>
+#include <mlpack/core/optimizers/rmsprop/rmsprop_update.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
 #include <mlpack/methods/ann/init_rules/gaussian_init.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/reinforcement_learning/q_learning.hpp>
+#include <mlpack/methods/reinforcement_learning/async_n_step_q_learning.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/mountain_car.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/cart_pole.hpp>
 #include <mlpack/methods/reinforcement_learning/policy/greedy_policy.hpp>
+#include <mlpack/methods/reinforcement_learning/replay/prioritized_replay.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -156,4 +159,188 @@ BOOST_AUTO_TEST_CASE(CartPoleWithDoubleDQN)
   BOOST_REQUIRE(converged);
 }
 
+//! Make sure the vectorized environment steps each copy like the environment.
+BOOST_AUTO_TEST_CASE(VectorEnvironmentTest)
+{
+  CartPole task;
+  VectorEnvironment<CartPole> environments(8, task);
+  environments.InitialSample();
+
+  std::vector<CartPole::State> states(8);
+  for (size_t i = 0; i < 8; ++i)
+    states[i] = environments.State(i);
+
+  std::vector<CartPole::Action> actions(8);
+  std::vector<CartPole::State> previousStates;
+  arma::colvec rewards;
+  for (size_t step = 0; step < 50; ++step)
+  {
+    for (size_t i = 0; i < 8; ++i)
+      actions[i] = (CartPole::Action) math::RandInt(CartPole::Action::size);
+
+    environments.Sample(actions, previousStates, rewards);
+
+    size_t numTerminal = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+      CheckMatrices(previousStates[i].Encode(), states[i].Encode());
+      if (task.IsTerminal(states[i]))
+      {
+        // Terminal copies are not stepped anymore.
+        BOOST_REQUIRE_EQUAL(rewards[i], 0.0);
+        CheckMatrices(environments.State(i).Encode(), states[i].Encode());
+      }
+      else
+      {
+        CartPole::State nextState;
+        const double reward = task.Sample(states[i], actions[i], nextState);
+        BOOST_REQUIRE_EQUAL(rewards[i], reward);
+        CheckMatrices(environments.State(i).Encode(), nextState.Encode());
+        states[i] = nextState;
+      }
+
+      BOOST_REQUIRE_EQUAL(environments.IsTerminal(i),
+          task.IsTerminal(states[i]));
+      if (task.IsTerminal(states[i]))
+        ++numTerminal;
+    }
+
+    BOOST_REQUIRE_EQUAL(environments.NumTerminal(), numTerminal);
+  }
+}
+
+//! Make sure batched episodes count every step of every copy.
+BOOST_AUTO_TEST_CASE(CartPoleBatchEpisodes)
+{
+  FFN<MeanSquaredError<>, GaussianInitialization> model;
+  model.Add<Linear<>>(4, 32);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(32, 2);
+
+  StandardSGD<decltype(model)> opt(model, 0.0001, 2);
+
+  GreedyPolicy<CartPole> policy(1.0, 1000, 0.1);
+  RandomReplay<CartPole> replayMethod(10, 10000);
+
+  QLearning<CartPole, decltype(model), decltype(opt), decltype(policy)>
+      agent(std::move(model), std::move(opt), 0.9, std::move(policy),
+          std::move(replayMethod), 100, 100, false, 200);
+
+  size_t steps = 0;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    arma::colvec returns = agent.Episodes(16);
+    BOOST_REQUIRE_EQUAL(returns.n_elem, 16);
+
+    // The reward of each step of Cart Pole is 1.
+    for (size_t j = 0; j < returns.n_elem; ++j)
+    {
+      BOOST_REQUIRE_GE(returns[j], 1.0);
+      BOOST_REQUIRE_LE(returns[j], 200.0);
+    }
+
+    steps += (size_t) arma::accu(returns);
+    BOOST_REQUIRE_EQUAL(agent.TotalSteps(), steps);
+  }
+}
+
+//! Make sure prioritized replay samples in proportion to the priorities, and
+//! reuses the given buffers.
+BOOST_AUTO_TEST_CASE(PrioritizedReplayTest)
+{
+  PrioritizedReplay<CartPole> replay(100, 1000, 1.0, 0.0);
+
+  // Store the transitions from several threads at once.
+  #pragma omp parallel for
+  for (int i = 0; i < 10; ++i)
+  {
+    CartPole::State state(arma::colvec(4).fill(i));
+    replay.Store(state, CartPole::Action::forward, i, state, false);
+  }
+  BOOST_REQUIRE_EQUAL(replay.Size(), 10);
+
+  arma::mat states, nextStates;
+  arma::icolvec actions, isTerminal;
+  arma::colvec rewards;
+  replay.Sample(states, actions, rewards, nextStates, isTerminal);
+  BOOST_REQUIRE_EQUAL(states.n_cols, 100);
+  const double* memory = states.memptr();
+
+  // Give every transition priority 0, except the one with reward 3.
+  arma::colvec tdErrors(100);
+  for (size_t i = 0; i < 100; ++i)
+    tdErrors[i] = (rewards[i] == 3.0) ? 1.0 : 0.0;
+  replay.UpdatePriorities(tdErrors);
+
+  replay.Sample(states, actions, rewards, nextStates, isTerminal);
+  BOOST_REQUIRE_EQUAL(states.memptr(), memory);
+  for (size_t i = 0; i < 100; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(rewards[i], 3.0);
+    BOOST_REQUIRE_EQUAL(states(0, i), 3.0);
+    BOOST_REQUIRE_EQUAL(nextStates(0, i), 3.0);
+    BOOST_REQUIRE_EQUAL(actions[i], CartPole::Action::forward);
+  }
+
+  // A new transition gets the largest priority seen so far, so it is sampled
+  // as often as the transition with reward 3.
+  tdErrors.fill(1.0);
+  replay.UpdatePriorities(tdErrors);
+  replay.Store(CartPole::State(arma::colvec(4).fill(5)),
+      CartPole::Action::backward, 5.0, CartPole::State(), true);
+
+  size_t count = 0;
+  for (size_t trial = 0; trial < 100; ++trial)
+  {
+    replay.Sample(states, actions, rewards, nextStates, isTerminal);
+    for (size_t i = 0; i < 100; ++i)
+    {
+      BOOST_REQUIRE(rewards[i] == 3.0 || rewards[i] == 5.0);
+      if (rewards[i] == 5.0)
+        ++count;
+    }
+  }
+  BOOST_REQUIRE_CLOSE(count / 10000.0, 0.5, 5);
+}
+
+//! Test asynchronous n-step Q-Learning in Cart Pole task.
+BOOST_AUTO_TEST_CASE(CartPoleWithAsyncNStepQLearning)
+{
+  FFN<MeanSquaredError<>, GaussianInitialization> model;
+  model.Add<Linear<>>(4, 128);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(128, 128);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(128, 2);
+
+  GreedyPolicy<CartPole> policy(1.0, 1000, 0.1);
+
+  AsyncNStepQLearning<CartPole, decltype(model), RMSPropUpdate,
+      decltype(policy)> agent(std::move(model), RMSPropUpdate(), 0.0001, 0.9,
+      std::move(policy), 5, 100, 200);
+
+  bool converged = false;
+  for (size_t trial = 0; trial < 100; ++trial)
+  {
+    agent.Train(1000);
+
+    arma::running_stat<double> testReturn;
+    for (size_t i = 0; i < 10; ++i)
+      testReturn(agent.Episode());
+
+    Log::Debug << "Steps: " << agent.TotalSteps() << " average return in "
+        << "deterministic test: " << testReturn.mean() << std::endl;
+
+    // Reaching average return 35 is enough to show it works.
+    if (testReturn.mean() > 35)
+    {
+      converged = true;
+      break;
+    }
+  }
+
+  BOOST_REQUIRE(converged);
+  BOOST_REQUIRE_GE(agent.TotalSteps(), 1000);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -208,4 +208,34 @@ BOOST_AUTO_TEST_CASE(SparseTest)
   BOOST_REQUIRE_EQUAL(distances.n_cols, 1000);
 }
 
+// Make sure QDAFN works with float tables: with one reference point, that is
+// the one that is returned.
+BOOST_AUTO_TEST_CASE(QDAFNFloatTest)
+{
+  arma::fmat refSet(5, 1);
+  refSet.randu();
+
+  QDAFN<arma::fmat> qdafn(refSet, 5, 1);
+
+  arma::fmat querySet(5, 100);
+  querySet.randu();
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  qdafn.Search(querySet, 1, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 1);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, 100);
+  BOOST_REQUIRE_EQUAL(distances.n_rows, 1);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, 100);
+
+  for (size_t i = 0; i < 100; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], 0);
+    const double dist = metric::EuclideanDistance::Evaluate(querySet.col(i),
+        refSet.col(0));
+    BOOST_REQUIRE_CLOSE(distances[i], dist, 1e-3);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -57,4 +57,35 @@ BOOST_AUTO_TEST_CASE(Radical_Test_Radical3D)
   BOOST_REQUIRE_CLOSE(valBest, valEst, 0.25);
 }
 
+#ifdef HAS_OPENMP
+/**
+ * Make sure that RADICAL gives the same result with one and with several
+ * threads, on enough dimensions for several pairs to be searched at once.
+ */
+BOOST_AUTO_TEST_CASE(RadicalMultithreadedTest)
+{
+  mat matS = randu<mat>(6, 300);
+  mat matX = randu<mat>(6, 6) * matS;
+
+  Radical rad(0.175, 5, 40, 2);
+
+  const int numThreads = omp_get_max_threads();
+  mat serialY, serialW, matY, matW;
+
+  math::RandomSeed(17);
+  omp_set_num_threads(1);
+  rad.DoRadical(matX, serialY, serialW);
+
+  math::RandomSeed(17);
+  omp_set_num_threads(4);
+  rad.DoRadical(matX, matY, matW);
+  omp_set_num_threads(numThreads);
+
+  BOOST_REQUIRE_EQUAL(matY.n_rows, serialY.n_rows);
+  BOOST_REQUIRE_EQUAL(matY.n_cols, serialY.n_cols);
+  for (uword i = 0; i < matY.n_elem; i++)
+    BOOST_REQUIRE_EQUAL(matY[i], serialY[i]);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,256 @@
+/**
+ * @file random_forest_test.cpp
+ *
+ * Tests for the RandomForest class and MultipleRandomDimensionSelect.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/random_forest/random_forest.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+#include "serialization.hpp"
+
+using namespace mlpack;
+using namespace mlpack::tree;
+
+BOOST_AUTO_TEST_SUITE(RandomForestTest);
+
+/**
+ * Make sure MultipleRandomDimensionSelect selects the right number of distinct
+ * dimensions, in increasing order.
+ */
+BOOST_AUTO_TEST_CASE(MultipleRandomDimensionSelectTest)
+{
+  for (size_t trial = 0; trial < 20; ++trial)
+  {
+    MultipleRandomDimensionSelect<> select(30);
+    arma::uvec selected(30, arma::fill::zeros);
+    size_t count = 0;
+    size_t last = 0;
+    for (size_t d = select.Begin(); d != select.End(); d = select.Next())
+    {
+      BOOST_REQUIRE_LT(d, 30);
+      if (count > 0)
+        BOOST_REQUIRE_GT(d, last);
+      last = d;
+      ++count;
+    }
+
+    // The square root of 30, rounded up.
+    BOOST_REQUIRE_EQUAL(count, 6);
+  }
+
+  // Asking for more dimensions than there are gives all of them.
+  MultipleRandomDimensionSelect<10> select(4);
+  size_t expected = 0;
+  for (size_t d = select.Begin(); d != select.End(); d = select.Next())
+    BOOST_REQUIRE_EQUAL(d, expected++);
+  BOOST_REQUIRE_EQUAL(expected, 4);
+}
+
+/**
+ * Make sure the same seed selects the same dimensions.
+ */
+BOOST_AUTO_TEST_CASE(MultipleRandomDimensionSelectSeedTest)
+{
+  MultipleRandomDimensionSelect<>::Seed(42);
+  MultipleRandomDimensionSelect<> select1(100);
+  MultipleRandomDimensionSelect<>::Seed(42);
+  MultipleRandomDimensionSelect<> select2(100);
+
+  size_t d2 = select2.Begin();
+  for (size_t d1 = select1.Begin(); d1 != select1.End(); d1 = select1.Next())
+  {
+    BOOST_REQUIRE_EQUAL(d1, d2);
+    d2 = select2.Next();
+  }
+  BOOST_REQUIRE_EQUAL(d2, select2.End());
+}
+
+/**
+ * Test that the random forest generalizes reasonably.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestGeneralizationTest)
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  RandomForest<> rf(inputData, labels, 3, 20, 1);
+  BOOST_REQUIRE_EQUAL(rf.NumTrees(), 20);
+  BOOST_REQUIRE_EQUAL(rf.NumClasses(), 3);
+
+  // Load testing data.
+  arma::mat testData;
+  if (!data::Load("vc2_test.csv", testData))
+    BOOST_FAIL("Cannot load test dataset vc2_test.csv!");
+
+  arma::Mat<size_t> trueTestLabels;
+  if (!data::Load("vc2_test_labels.txt", trueTestLabels))
+    BOOST_FAIL("Cannot load labels for vc2_test_labels.txt");
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  rf.Classify(testData, predictions, probabilities);
+
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, testData.n_cols);
+  BOOST_REQUIRE_EQUAL(probabilities.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(probabilities.n_cols, testData.n_cols);
+
+  double correct = 0.0;
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+  {
+    if (predictions[i] == trueTestLabels[i])
+      ++correct;
+
+    // The probabilities should sum to one, and agree with single point
+    // classification.
+    BOOST_REQUIRE_CLOSE(arma::accu(probabilities.col(i)), 1.0, 1e-5);
+
+    size_t prediction;
+    arma::vec pointProbabilities;
+    rf.Classify(testData.col(i), prediction, pointProbabilities);
+    BOOST_REQUIRE_EQUAL(prediction, predictions[i]);
+    for (size_t c = 0; c < 3; ++c)
+      BOOST_REQUIRE_CLOSE(pointProbabilities[c] + 1.0,
+          probabilities(c, i) + 1.0, 1e-5);
+  }
+  correct /= predictions.n_elem;
+
+  BOOST_REQUIRE_GT(correct, 0.75);
+}
+
+/**
+ * Test that the forest is the same after serialization.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestSerializationTest)
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  RandomForest<> rf(inputData, labels, 3, 10, 5);
+
+  // Give the other forests different models, to be overwritten.
+  arma::mat randomData = arma::randu<arma::mat>(inputData.n_rows, 100);
+  arma::Row<size_t> randomLabels(100, arma::fill::zeros);
+  RandomForest<> xmlRf;
+  RandomForest<> textRf(randomData, randomLabels, 2, 3);
+  RandomForest<> binaryRf(randomData, randomLabels, 2, 3);
+
+  SerializeObjectAll(rf, xmlRf, textRf, binaryRf);
+
+  BOOST_REQUIRE_EQUAL(xmlRf.NumTrees(), rf.NumTrees());
+  BOOST_REQUIRE_EQUAL(textRf.NumTrees(), rf.NumTrees());
+  BOOST_REQUIRE_EQUAL(binaryRf.NumTrees(), rf.NumTrees());
+
+  arma::Row<size_t> predictions, xmlPredictions, textPredictions,
+      binaryPredictions;
+  arma::mat probabilities, xmlProbabilities, textProbabilities,
+      binaryProbabilities;
+  rf.Classify(inputData, predictions, probabilities);
+  xmlRf.Classify(inputData, xmlPredictions, xmlProbabilities);
+  textRf.Classify(inputData, textPredictions, textProbabilities);
+  binaryRf.Classify(inputData, binaryPredictions, binaryProbabilities);
+
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], xmlPredictions[i]);
+    BOOST_REQUIRE_EQUAL(predictions[i], textPredictions[i]);
+    BOOST_REQUIRE_EQUAL(predictions[i], binaryPredictions[i]);
+  }
+
+  CheckMatrices(probabilities, xmlProbabilities, textProbabilities,
+      binaryProbabilities);
+}
+
+/**
+ * Test that a copied forest gives the same predictions.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestCopyTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  arma::Row<size_t> labels(500);
+  for (size_t i = 0; i < 500; ++i)
+    labels[i] = (dataset(1, i) > 0.5) ? 1 : 0;
+
+  RandomForest<>* rf = new RandomForest<>(dataset, labels, 2, 10);
+  arma::Row<size_t> predictions;
+  rf->Classify(dataset, predictions);
+
+  RandomForest<> copy(*rf);
+  RandomForest<> assigned;
+  assigned = *rf;
+  delete rf;
+
+  arma::Row<size_t> copyPredictions, assignedPredictions;
+  copy.Classify(dataset, copyPredictions);
+  assigned.Classify(dataset, assignedPredictions);
+
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], copyPredictions[i]);
+    BOOST_REQUIRE_EQUAL(predictions[i], assignedPredictions[i]);
+  }
+}
+
+/**
+ * Make sure mismatched labels are rejected.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestWrongLabelsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 100);
+  arma::Row<size_t> labels(99, arma::fill::zeros);
+
+  RandomForest<> rf;
+  BOOST_REQUIRE_THROW(rf.Train(dataset, labels, 2), std::invalid_argument);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * The trees are trained in parallel, but the forest should not depend on the
+ * number of threads.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestMultithreadedTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 2000);
+  arma::Row<size_t> labels(2000);
+  for (size_t i = 0; i < 2000; ++i)
+    labels[i] = (dataset(2, i) + dataset(7, i) + 0.2 * math::Random() > 1.1) ?
+        1 : 0;
+
+  const int numThreads = omp_get_max_threads();
+  math::RandomSeed(10);
+  omp_set_num_threads(1);
+  RandomForest<> rf1(dataset, labels, 2, 10, 5);
+  math::RandomSeed(10);
+  omp_set_num_threads(4);
+  RandomForest<> rf4(dataset, labels, 2, 10, 5);
+  omp_set_num_threads(numThreads);
+
+  arma::mat testData = arma::randu<arma::mat>(10, 500);
+  arma::Row<size_t> predictions1, predictions4;
+  arma::mat probabilities1, probabilities4;
+  rf1.Classify(testData, predictions1, probabilities1);
+  rf4.Classify(testData, predictions4, probabilities4);
+
+  for (size_t i = 0; i < predictions1.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions1[i], predictions4[i]);
+  CheckMatrices(probabilities1, probabilities4);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -11,6 +11,7 @@
  */
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/data/batch_source.hpp>
 #include <mlpack/methods/randomized_svd/randomized_svd.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -64,4 +65,46 @@ BOOST_AUTO_TEST_CASE(RandomizedSVDReconstructionError)
   BOOST_REQUIRE_SMALL(error, 1e-5);
 }
 
+/**
+ * The randomized SVD of data read from a batch source, one block at a time,
+ * should match the SVD of the centered data.
+ */
+BOOST_AUTO_TEST_CASE(StreamedRandomizedSVDTest)
+{
+  // Low-rank data with a little noise.
+  arma::mat data = arma::randn<arma::mat>(20, 4) *
+      arma::randn<arma::mat>(4, 3000) + 5.0;
+  data += 1e-3 * arma::randn<arma::mat>(20, 3000);
+
+  arma::mat centeredData;
+  math::Center(data, centeredData);
+
+  arma::mat U1, V1;
+  arma::vec s1;
+  arma::svd_econ(U1, s1, V1, centeredData);
+
+  // The shards and the blocks are not aligned.
+  arma::mat noResponses(0, data.n_cols);
+  data::MatrixBatchSource<> source(data, noResponses, 700);
+
+  arma::mat U2;
+  arma::vec s2, mean;
+  svd::RandomizedSVD rSVD(0, 2);
+  const size_t n = rSVD.Apply(source, U2, s2, mean, 4, 256);
+
+  BOOST_REQUIRE_EQUAL(n, data.n_cols);
+  BOOST_REQUIRE_EQUAL(U2.n_rows, 20);
+  BOOST_REQUIRE_EQUAL(U2.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(s2.n_elem, 4);
+  CheckMatrices(mean, arma::mean(data, 1));
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(s2[i], s1[i], 1e-3);
+
+    // The singular vectors are only known up to their sign.
+    BOOST_REQUIRE_CLOSE(std::abs(arma::dot(U1.col(i), U2.col(i))), 1.0, 1e-3);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
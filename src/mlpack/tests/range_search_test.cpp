@@ -13,6 +13,7 @@
 #include <mlpack/methods/range_search/range_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/methods/range_search/rs_model.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -547,6 +548,46 @@ BOOST_AUTO_TEST_CASE(DualTreeVsNaive2)
   }
 }
 
+/**
+ * Test the dual-tree range search method with the naive method on
+ * high-dimensional data, where the leaf base cases are computed with a matrix
+ * multiplication.
+ *
+ * Errors are produced if the results are not identical.
+ */
+BOOST_AUTO_TEST_CASE(HighDimensionalDualTreeVsNaive)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(64, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(64, 300);
+
+  RangeSearch<> rs(referenceData);
+  RangeSearch<> naive(referenceData, true);
+
+  vector<vector<size_t>> neighborsTree;
+  vector<vector<double>> distancesTree;
+  rs.Search(queryData, Range(2.9, 3.2), neighborsTree, distancesTree);
+  vector<vector<pair<double, size_t>>> sortedTree;
+  SortResults(neighborsTree, distancesTree, sortedTree);
+
+  vector<vector<size_t>> neighborsNaive;
+  vector<vector<double>> distancesNaive;
+  naive.Search(queryData, Range(2.9, 3.2), neighborsNaive, distancesNaive);
+  vector<vector<pair<double, size_t>>> sortedNaive;
+  SortResults(neighborsNaive, distancesNaive, sortedNaive);
+
+  for (size_t i = 0; i < sortedTree.size(); i++)
+  {
+    BOOST_REQUIRE(sortedTree[i].size() == sortedNaive[i].size());
+
+    for (size_t j = 0; j < sortedTree[i].size(); j++)
+    {
+      BOOST_REQUIRE(sortedTree[i][j].second == sortedNaive[i][j].second);
+      BOOST_REQUIRE_CLOSE(sortedTree[i][j].first, sortedNaive[i][j].first,
+          1e-5);
+    }
+  }
+}
+
 /**
  * Test the single-tree range search method with the naive method.  This
  * uses only a reference dataset.
@@ -1696,4 +1737,334 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   }
 }
 
+/**
+ * Make sure that the compressed sparse row results hold the same results as
+ * the vectors of results, and that counting gives the number of results, in
+ * every search mode.
+ */
+BOOST_AUTO_TEST_CASE(FlatResultsAndCountTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 300);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+  const math::Range r(0.1, 0.35);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(referenceData, mode == 0, mode == 1);
+
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    arma::Col<size_t> offsets, flatNeighbors, counts;
+    arma::vec flatDistances;
+
+    // Check the bichromatic search and then the monochromatic search.
+    for (size_t mono = 0; mono < 2; ++mono)
+    {
+      if (mono)
+      {
+        rs.Search(r, neighbors, distances);
+        rs.Search(r, offsets, flatNeighbors, flatDistances);
+        rs.Count(r, counts);
+      }
+      else
+      {
+        rs.Search(queryData, r, neighbors, distances);
+        rs.Search(queryData, r, offsets, flatNeighbors, flatDistances);
+        rs.Count(queryData, r, counts);
+      }
+
+      BOOST_REQUIRE_EQUAL(offsets.n_elem, neighbors.size() + 1);
+      BOOST_REQUIRE_EQUAL(counts.n_elem, neighbors.size());
+      BOOST_REQUIRE_EQUAL(offsets[0], 0);
+      BOOST_REQUIRE_EQUAL(flatNeighbors.n_elem, offsets[neighbors.size()]);
+      BOOST_REQUIRE_EQUAL(flatDistances.n_elem, offsets[neighbors.size()]);
+
+      for (size_t i = 0; i < neighbors.size(); ++i)
+      {
+        BOOST_REQUIRE_EQUAL(counts[i], neighbors[i].size());
+        BOOST_REQUIRE_EQUAL(offsets[i + 1] - offsets[i], neighbors[i].size());
+
+        // The search is deterministic, so the results are in the same order.
+        for (size_t j = 0; j < neighbors[i].size(); ++j)
+        {
+          BOOST_REQUIRE_EQUAL(flatNeighbors[offsets[i] + j], neighbors[i][j]);
+          BOOST_REQUIRE_CLOSE(flatDistances[offsets[i] + j], distances[i][j],
+              1e-5);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Counting with the cover tree, which computes base cases in Score(), must not
+ * count any point twice.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeCountTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 500);
+  const math::Range r(0.0, 0.3);
+
+  RangeSearch<> naive(data, true);
+  RangeSearch<EuclideanDistance, arma::mat, StandardCoverTree> rs(data);
+
+  arma::Col<size_t> naiveCounts, counts;
+  naive.Count(r, naiveCounts);
+  rs.Count(r, counts);
+
+  BOOST_REQUIRE_EQUAL(counts.n_elem, naiveCounts.n_elem);
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], naiveCounts[i]);
+
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+  naive.Count(queryData, r, naiveCounts);
+  rs.Count(queryData, r, counts);
+
+  BOOST_REQUIRE_EQUAL(counts.n_elem, naiveCounts.n_elem);
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], naiveCounts[i]);
+}
+
+/**
+ * Traversing the query points along the Hilbert curve must not change the
+ * results of single-tree range search.
+ */
+BOOST_AUTO_TEST_CASE(ReorderQueriesRangeSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 300);
+  const Range r(0.0, 0.2);
+
+  RangeSearch<> rs(referenceData, false, true);
+
+  std::vector<std::vector<size_t>> neighbors, reorderedNeighbors;
+  std::vector<std::vector<double>> distances, reorderedDistances;
+  rs.Search(queryData, r, neighbors, distances);
+
+  rs.ReorderQueries() = true;
+  rs.Search(queryData, r, reorderedNeighbors, reorderedDistances);
+
+  BOOST_REQUIRE_EQUAL(reorderedNeighbors.size(), neighbors.size());
+  for (size_t i = 0; i < neighbors.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(reorderedNeighbors[i].size(), neighbors[i].size());
+    for (size_t j = 0; j < neighbors[i].size(); ++j)
+    {
+      BOOST_REQUIRE_EQUAL(reorderedNeighbors[i][j], neighbors[i][j]);
+      BOOST_REQUIRE_EQUAL(reorderedDistances[i][j], distances[i][j]);
+    }
+  }
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Search with several threads must give the same results as the serial
+ * search, in single-tree and dual-tree mode, with the kd-tree (which is split
+ * into subtrees) and the cover tree (whose single-tree search stays serial).
+ */
+template<typename RSType>
+void CheckMultithreadedSearch(const arma::mat& referenceData,
+                              const arma::mat& queryData,
+                              const bool singleMode)
+{
+  const math::Range r(0.05, 0.25);
+  const int numThreads = omp_get_max_threads();
+
+  vector<vector<size_t>> serialNeighbors, neighbors;
+  vector<vector<double>> serialDistances, distances;
+  arma::Col<size_t> serialCounts, counts;
+
+  omp_set_num_threads(1);
+  RSType serial(referenceData, false, singleMode);
+  serial.Search(queryData, r, serialNeighbors, serialDistances);
+  serial.Count(r, serialCounts);
+
+  omp_set_num_threads(4);
+  RSType rs(referenceData, false, singleMode);
+  rs.Search(queryData, r, neighbors, distances);
+  rs.Count(r, counts);
+  omp_set_num_threads(numThreads);
+
+  vector<vector<pair<double, size_t>>> serialSorted, sorted;
+  SortResults(serialNeighbors, serialDistances, serialSorted);
+  SortResults(neighbors, distances, sorted);
+
+  BOOST_REQUIRE_EQUAL(sorted.size(), serialSorted.size());
+  for (size_t i = 0; i < sorted.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(sorted[i].size(), serialSorted[i].size());
+    for (size_t j = 0; j < sorted[i].size(); ++j)
+    {
+      BOOST_REQUIRE_EQUAL(sorted[i][j].second, serialSorted[i][j].second);
+      BOOST_REQUIRE_CLOSE(sorted[i][j].first, serialSorted[i][j].first, 1e-5);
+    }
+  }
+
+  BOOST_REQUIRE_EQUAL(counts.n_elem, serialCounts.n_elem);
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], serialCounts[i]);
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 500);
+
+  typedef RangeSearch<EuclideanDistance, arma::mat, StandardCoverTree>
+      CoverTreeRS;
+
+  CheckMultithreadedSearch<RangeSearch<>>(referenceData, queryData, false);
+  CheckMultithreadedSearch<RangeSearch<>>(referenceData, queryData, true);
+  CheckMultithreadedSearch<CoverTreeRS>(referenceData, queryData, false);
+  CheckMultithreadedSearch<CoverTreeRS>(referenceData, queryData, true);
+}
+#endif
+
+// Compare the sorted results of two range searches.
+void CheckRangeResults(const vector<vector<size_t>>& neighbors,
+                       const vector<vector<double>>& distances,
+                       const vector<vector<size_t>>& expectedNeighbors,
+                       const vector<vector<double>>& expectedDistances)
+{
+  vector<vector<pair<double, size_t>>> sorted, expected;
+  SortResults(neighbors, distances, sorted);
+  SortResults(expectedNeighbors, expectedDistances, expected);
+
+  BOOST_REQUIRE_EQUAL(sorted.size(), expected.size());
+  for (size_t i = 0; i < sorted.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(sorted[i].size(), expected[i].size());
+    for (size_t j = 0; j < sorted[i].size(); ++j)
+    {
+      BOOST_REQUIRE_EQUAL(sorted[i][j].second, expected[i][j].second);
+      BOOST_REQUIRE_CLOSE(sorted[i][j].first, expected[i][j].first, 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that NeighborSearch and RangeSearch models that share one tree
+ * give the same results as models that build their own trees.
+ */
+BOOST_AUTO_TEST_CASE(SharedTreeSearchTest)
+{
+  typedef neighbor::NeighborSearch<neighbor::NearestNeighborSort> KNNType;
+  typedef RangeSearch<EuclideanDistance, arma::mat, KDTree,
+      neighbor::NeighborSearchStat<neighbor::NearestNeighborSort>> RangeType;
+
+  arma::mat referenceData = arma::randu<arma::mat>(3, 500);
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+
+  SharedTree<KNNType::Tree> tree(referenceData);
+  BOOST_REQUIRE_EQUAL(tree.UseCount(), 1);
+  BOOST_REQUIRE_EQUAL(tree.OldFromNew().size(), referenceData.n_cols);
+
+  KNNType knn(tree);
+  KNNType singleKnn(tree, neighbor::SINGLE_TREE_MODE);
+  RangeType range(tree);
+  RangeType singleRange(tree, true);
+  BOOST_REQUIRE_EQUAL(tree.UseCount(), 5);
+  BOOST_REQUIRE_EQUAL(&knn.ReferenceSet(), &tree.Dataset());
+  BOOST_REQUIRE_EQUAL(&range.ReferenceSet(), &tree.Dataset());
+
+  // Bichromatic and monochromatic nearest neighbor search.
+  KNNType exactKnn(referenceData);
+  arma::Mat<size_t> neighbors, expectedNeighbors;
+  arma::mat distances, expectedDistances;
+  exactKnn.Search(queryData, 5, expectedNeighbors, expectedDistances);
+  for (KNNType* model : { &knn, &singleKnn })
+  {
+    model->Search(queryData, 5, neighbors, distances);
+    tree.MapNeighbors(neighbors);
+    CheckMatrices(neighbors, expectedNeighbors);
+    CheckMatrices(distances, expectedDistances);
+  }
+
+  exactKnn.Search(5, expectedNeighbors, expectedDistances);
+  for (KNNType* model : { &knn, &singleKnn })
+  {
+    model->Search(5, neighbors, distances);
+    tree.MapMonochromatic(neighbors, distances);
+    CheckMatrices(neighbors, expectedNeighbors);
+    CheckMatrices(distances, expectedDistances);
+  }
+
+  // Bichromatic and monochromatic range search.
+  RangeSearch<> exactRange(referenceData);
+  vector<vector<size_t>> rangeNeighbors, expectedRangeNeighbors;
+  vector<vector<double>> rangeDistances, expectedRangeDistances;
+  exactRange.Search(queryData, Range(0.05, 0.2), expectedRangeNeighbors,
+      expectedRangeDistances);
+  for (RangeType* model : { &range, &singleRange })
+  {
+    model->Search(queryData, Range(0.05, 0.2), rangeNeighbors,
+        rangeDistances);
+    tree.MapNeighbors(rangeNeighbors);
+    CheckRangeResults(rangeNeighbors, rangeDistances, expectedRangeNeighbors,
+        expectedRangeDistances);
+  }
+
+  exactRange.Search(Range(0.05, 0.2), expectedRangeNeighbors,
+      expectedRangeDistances);
+  for (RangeType* model : { &range, &singleRange })
+  {
+    model->Search(Range(0.05, 0.2), rangeNeighbors, rangeDistances);
+    tree.MapMonochromatic(rangeNeighbors, rangeDistances);
+    CheckRangeResults(rangeNeighbors, rangeDistances, expectedRangeNeighbors,
+        expectedRangeDistances);
+  }
+}
+
+/**
+ * Make sure that copies of models that share a tree share it too, that
+ * training a model stops sharing, and that the tree outlives its handle.
+ */
+BOOST_AUTO_TEST_CASE(SharedTreeOwnershipTest)
+{
+  typedef RangeSearch<EuclideanDistance, arma::mat, KDTree> RangeType;
+
+  arma::mat referenceData = arma::randu<arma::mat>(3, 300);
+  arma::mat queryData = arma::randu<arma::mat>(3, 50);
+
+  RangeType* model;
+  vector<vector<size_t>> neighbors;
+  vector<vector<double>> distances;
+  {
+    SharedTree<RangeType::Tree> tree(referenceData);
+    model = new RangeType(tree);
+
+    RangeType copy(*model);
+    BOOST_REQUIRE_EQUAL(tree.UseCount(), 3);
+    BOOST_REQUIRE_EQUAL(&copy.ReferenceSet(), &tree.Dataset());
+
+    RangeType moved(std::move(copy));
+    BOOST_REQUIRE_EQUAL(tree.UseCount(), 3);
+
+    moved.Train(referenceData);
+    BOOST_REQUIRE_EQUAL(tree.UseCount(), 2);
+    BOOST_REQUIRE_NE(&moved.ReferenceSet(), &tree.Dataset());
+  }
+
+  // The model still holds the tree.  The reference indices are in the order
+  // of the tree, so only the distances are compared.
+  model->Search(queryData, Range(0.0, 0.3), neighbors, distances);
+  delete model;
+
+  RangeType exact(referenceData);
+  vector<vector<size_t>> expectedNeighbors;
+  vector<vector<double>> expectedDistances;
+  exact.Search(queryData, Range(0.0, 0.3), expectedNeighbors,
+      expectedDistances);
+
+  BOOST_REQUIRE_EQUAL(distances.size(), expectedDistances.size());
+  for (size_t i = 0; i < distances.size(); ++i)
+  {
+    sort(distances[i].begin(), distances[i].end());
+    sort(expectedDistances[i].begin(), expectedDistances[i].end());
+    BOOST_REQUIRE_EQUAL(distances[i].size(), expectedDistances[i].size());
+    for (size_t j = 0; j < distances[i].size(); ++j)
+      BOOST_REQUIRE_CLOSE(distances[i][j], expectedDistances[i][j], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
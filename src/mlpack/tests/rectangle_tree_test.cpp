@@ -15,6 +15,11 @@
 #include <mlpack/core/tree/tree_traits.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/unmap.hpp>
+#include <mlpack/methods/range_search/range_search.hpp>
+#include <mlpack/core/tree/snapshot_search.hpp>
+
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -23,6 +28,7 @@ using namespace mlpack;
 using namespace mlpack::neighbor;
 using namespace mlpack::tree;
 using namespace mlpack::metric;
+using namespace mlpack::range;
 
 BOOST_AUTO_TEST_SUITE(RectangleTreeTest);
 
@@ -1384,4 +1390,306 @@ BOOST_AUTO_TEST_CASE(RectangleTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+/**
+ * Check a bulk-loaded tree: it must be a valid, balanced tree that holds each
+ * point once, and the search results must be the same as with a naive search.
+ */
+template<template<typename, typename, typename> class TreeType>
+void CheckBulkLoadedTree(const arma::mat& dataset,
+                         const size_t maxLeafSize,
+                         const size_t minLeafSize,
+                         const size_t maxNumChildren,
+                         const size_t minNumChildren)
+{
+  typedef TreeType<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> Tree;
+  Tree tree(dataset, BulkLoad(), maxLeafSize, minLeafSize, maxNumChildren,
+      minNumChildren);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), dataset.n_cols);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  CheckFills(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+  BOOST_REQUIRE_EQUAL(tree.TreeDepth(), GetMinLevel(tree));
+
+  arma::Col<size_t> counts(dataset.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < tree.NumDescendants(); ++i)
+    counts[tree.Descendant(i)]++;
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  arma::Mat<size_t> neighbors1, neighbors2;
+  arma::mat distances1, distances2;
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, arma::mat,
+      TreeType> knn1(std::move(tree));
+  knn1.Search(5, neighbors1, distances1);
+
+  KNN knn2(dataset, NAIVE_MODE);
+  knn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+}
+
+// Make sure that bulk-loaded R trees, R* trees and X trees are valid.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 2000);
+
+  CheckBulkLoadedTree<RTree>(dataset, 20, 6, 5, 2);
+  CheckBulkLoadedTree<RStarTree>(dataset, 10, 4, 4, 2);
+  CheckBulkLoadedTree<XTree>(dataset, 20, 6, 5, 2);
+}
+
+// A bulk-loaded tree uses as few leaves as possible.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadFillTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 1000);
+
+  typedef RTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(dataset, BulkLoad(), 20, 8, 5, 2);
+
+  // 1000 points fill exactly 50 leaves; 50 leaves fill 10 nodes of the level
+  // above, which fill 2 nodes below the root.
+  BOOST_REQUIRE_EQUAL(tree.TreeDepth(), 4);
+  BOOST_REQUIRE_EQUAL(tree.NumChildren(), 2);
+  for (size_t i = 0; i < tree.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(tree.Child(i).NumChildren(), 5);
+    for (size_t j = 0; j < tree.Child(i).NumChildren(); ++j)
+    {
+      const TreeType& node = tree.Child(i).Child(j);
+      BOOST_REQUIRE_EQUAL(node.NumChildren(), 5);
+      for (size_t k = 0; k < node.NumChildren(); ++k)
+        BOOST_REQUIRE_EQUAL(node.Child(k).Count(), 20);
+    }
+  }
+
+  // A small dataset fits in the root.
+  arma::mat smallDataset = arma::randu<arma::mat>(3, 15);
+  TreeType smallTree(smallDataset, BulkLoad(), 20, 8, 5, 2);
+  BOOST_REQUIRE(smallTree.IsLeaf());
+  BOOST_REQUIRE_EQUAL(smallTree.Count(), 15);
+}
+
+// Points can be inserted and deleted after bulk loading.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadDynamicTest)
+{
+  const int numIter = 50;
+  arma::mat dataset;
+  dataset.randu(4, 1000);
+
+  typedef RTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  TreeType tree(dataset, BulkLoad(), 20, 6, 5, 2);
+
+  tree.Dataset().reshape(4, 1000 + numIter);
+  dataset.reshape(4, 1000 + numIter);
+  arma::mat tmpData;
+  tmpData.randu(4, numIter);
+  for (int i = 0; i < numIter; i++)
+  {
+    tree.Dataset().col(1000 + i) = tmpData.col(i);
+    dataset.col(1000 + i) = tmpData.col(i);
+    tree.InsertPoint(1000 + i);
+  }
+
+  for (int i = 0; i < numIter; i++)
+    BOOST_REQUIRE(tree.DeletePoint(2 * i));
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1000);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+}
+
+/**
+ * Make sure that a reordered R tree stores its points in the order of its
+ * leaves, and that search results on it can be mapped back to the original
+ * order.
+ */
+BOOST_AUTO_TEST_CASE(RectangleTreeReorderDatasetTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+  typedef RTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  TreeType tree(dataset, 20, 6, 5, 2, 0);
+
+  std::vector<size_t> oldFromNew;
+  tree.ReorderDataset(oldFromNew);
+
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(arma::norm(tree.Dataset().col(i) -
+        dataset.col(oldFromNew[i])), 0.0);
+    BOOST_REQUIRE_EQUAL(tree.Descendant(i), i);
+  }
+
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+
+  // The results are in the order of the tree, so they must be unmapped.
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, arma::mat,
+      RTree> knn1(std::move(tree));
+  arma::Mat<size_t> neighbors1, neighbors2, unmappedNeighbors;
+  arma::mat distances1, distances2, unmappedDistances;
+  knn1.Search(5, neighbors1, distances1);
+  Unmap(neighbors1, distances1, oldFromNew, oldFromNew, unmappedNeighbors,
+      unmappedDistances);
+
+  KNN knn2(dataset, NAIVE_MODE);
+  knn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors2.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(unmappedNeighbors[i], neighbors2[i]);
+    BOOST_REQUIRE_CLOSE(unmappedDistances[i], distances2[i], 1e-5);
+  }
+}
+
+/**
+ * Readers of a SnapshotSearch see the tree as it was published, and a new
+ * reader sees the inserted points but not the deleted ones.
+ */
+BOOST_AUTO_TEST_CASE(SnapshotSearchPublishTest)
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      RStarTree> KNNType;
+  const arma::mat data = arma::randu<arma::mat>(3, 500);
+  const arma::mat newPoints = arma::randu<arma::mat>(3, 100);
+  const arma::mat queries = arma::randu<arma::mat>(3, 50);
+
+  SnapshotSearch<KNNType> index(data);
+  SnapshotSearch<KNNType>::Reader oldReader = index.Read();
+
+  for (size_t i = 0; i < newPoints.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(index.Insert(newPoints.col(i)), 500 + i);
+  for (size_t i = 0; i < 100; i += 2)
+    BOOST_REQUIRE(index.Delete(i));
+  BOOST_REQUIRE(!index.Delete(1000));
+  BOOST_REQUIRE_EQUAL(index.NumPoints(), 550);
+
+  // Nothing is seen before the writes are published.
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+  BOOST_REQUIRE_EQUAL(index.Read().Version(), 0);
+  oldReader.Search().Search(queries, 5, neighbors, distances);
+  KNNType naive(data, NAIVE_MODE);
+  naive.Search(queries, 5, naiveNeighbors, naiveDistances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  index.Publish();
+  BOOST_REQUIRE_EQUAL(index.Version(), 1);
+
+  // The old reader still sees the old tree.
+  oldReader.Search().Search(queries, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+
+  // A new reader sees the points that are left.
+  arma::uvec live(550);
+  for (size_t i = 0; i < 50; ++i)
+    live[i] = 2 * i + 1;
+  for (size_t i = 50; i < 550; ++i)
+    live[i] = i + 50;
+  const arma::mat allData = arma::join_rows(data, newPoints);
+  KNNType liveNaive(allData.cols(live), NAIVE_MODE);
+  liveNaive.Search(queries, 5, naiveNeighbors, naiveDistances);
+
+  SnapshotSearch<KNNType>::Reader reader = index.Read();
+  BOOST_REQUIRE_EQUAL(reader.Version(), 1);
+  reader.Search().Search(queries, 5, neighbors, distances);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], live[naiveNeighbors[i]]);
+    BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-5);
+  }
+
+  // Range search works the same way.
+  typedef RangeSearch<EuclideanDistance, arma::mat, RTree> RSType;
+  SnapshotSearch<RSType> rangeIndex(data);
+  std::vector<std::vector<size_t>> rangeNeighbors, naiveRangeNeighbors;
+  std::vector<std::vector<double>> rangeDistances, naiveRangeDistances;
+  rangeIndex.Read().Search().Search(queries, math::Range(0.0, 0.2),
+      rangeNeighbors, rangeDistances);
+  RSType naiveRange(data, true);
+  naiveRange.Search(queries, math::Range(0.0, 0.2), naiveRangeNeighbors,
+      naiveRangeDistances);
+  for (size_t i = 0; i < queries.n_cols; ++i)
+  {
+    std::sort(rangeNeighbors[i].begin(), rangeNeighbors[i].end());
+    std::sort(naiveRangeNeighbors[i].begin(), naiveRangeNeighbors[i].end());
+    BOOST_REQUIRE(rangeNeighbors[i] == naiveRangeNeighbors[i]);
+  }
+}
+
+/**
+ * Readers can search a SnapshotSearch while a writer inserts points into it
+ * and publishes them.
+ */
+BOOST_AUTO_TEST_CASE(SnapshotSearchConcurrentTest)
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      RStarTree> KNNType;
+  const arma::mat newPoints = arma::randu<arma::mat>(3, 200);
+  const arma::mat queries = arma::randu<arma::mat>(3, 20);
+  SnapshotSearch<KNNType> index(arma::randu<arma::mat>(3, 300));
+
+  std::thread writer([&]()
+  {
+    for (size_t i = 0; i < newPoints.n_cols; ++i)
+    {
+      index.Insert(newPoints.col(i));
+      if (i % 20 == 19)
+        index.Publish();
+    }
+  });
+
+  // Each reader checks that its snapshot is consistent with itself.
+  std::vector<size_t> failures(4, 0);
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < 4; ++t)
+  {
+    readers.push_back(std::thread([&, t]()
+    {
+      size_t lastVersion = 0;
+      for (size_t r = 0; r < 30; ++r)
+      {
+        SnapshotSearch<KNNType>::Reader reader = index.Read();
+        arma::Mat<size_t> neighbors;
+        arma::mat distances;
+        reader.Search().Search(queries, 3, neighbors, distances);
+
+        const size_t numPoints = reader.Search().ReferenceSet().n_cols;
+        if (reader.Version() < lastVersion ||
+            numPoints != 300 + 20 * reader.Version() ||
+            arma::any(arma::vectorise(neighbors) >= numPoints))
+          ++failures[t];
+        lastVersion = reader.Version();
+      }
+    }));
+  }
+
+  writer.join();
+  for (size_t t = 0; t < readers.size(); ++t)
+    readers[t].join();
+
+  for (size_t t = 0; t < failures.size(); ++t)
+    BOOST_REQUIRE_EQUAL(failures[t], 0);
+  BOOST_REQUIRE_EQUAL(index.Read().Version(), 10);
+  BOOST_REQUIRE_EQUAL(index.NumPoints(), 500);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -152,6 +152,115 @@ BOOST_AUTO_TEST_CASE(SequenceClassificationTest)
   BOOST_REQUIRE_GE(successes, 1);
 }
 
+/**
+ * Make sure that the gradient of a batch of sequences passed through a FastLSTM
+ * network at once is the sum of the gradients of each sequence.
+ */
+BOOST_AUTO_TEST_CASE(FastLSTMBatchGradientTest)
+{
+  const size_t rho = 10;
+
+  arma::mat input, labelsTemp;
+  GenerateNoisySines(input, labelsTemp, rho, 3);
+
+  arma::mat labels = arma::zeros<arma::mat>(rho, labelsTemp.n_cols);
+  for (size_t i = 0; i < labelsTemp.n_cols; ++i)
+  {
+    const int value = arma::as_scalar(arma::find(
+        arma::max(labelsTemp.col(i)) == labelsTemp.col(i), 1)) + 1;
+    labels.col(i).fill(value);
+  }
+
+  RNN<> model(input, labels, rho);
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(1, 4);
+  model.Add<FastLSTM<> >(4, 5, rho);
+  model.Add<Linear<> >(5, 2);
+  model.Add<LogSoftMax<> >();
+
+  arma::mat batchGradient;
+  const double batchObjective = model.Evaluate(model.Parameters(), 0,
+      input.n_cols);
+  model.Gradient(model.Parameters(), 0, batchGradient, input.n_cols);
+
+  double objective = 0;
+  arma::mat gradient, sequenceGradient;
+  for (size_t i = 0; i < input.n_cols; ++i)
+  {
+    objective += model.Evaluate(model.Parameters(), i);
+    model.Gradient(model.Parameters(), i, sequenceGradient);
+    if (i == 0)
+      gradient = sequenceGradient;
+    else
+      gradient += sequenceGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(batchObjective, objective, 1e-5);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    if (std::abs(gradient[i]) < 1e-8)
+      BOOST_REQUIRE_SMALL(batchGradient[i], 1e-8);
+    else
+      BOOST_REQUIRE_CLOSE(batchGradient[i], gradient[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that computing the outputs of the modules again during the
+ * backward pass gives the same gradient as storing them, and that a network
+ * with a module that can't be recomputed falls back to storing them.
+ */
+BOOST_AUTO_TEST_CASE(RecomputeOutputsGradientTest)
+{
+  const size_t rho = 10;
+
+  arma::mat input, labelsTemp;
+  GenerateNoisySines(input, labelsTemp, rho, 3);
+
+  arma::mat labels = arma::zeros<arma::mat>(rho, labelsTemp.n_cols);
+  for (size_t i = 0; i < labelsTemp.n_cols; ++i)
+  {
+    const int value = arma::as_scalar(arma::find(
+        arma::max(labelsTemp.col(i)) == labelsTemp.col(i), 1)) + 1;
+    labels.col(i).fill(value);
+  }
+
+  RNN<> model(input, labels, rho);
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(1, 4);
+  model.Add<FastLSTM<> >(4, 5, rho);
+  model.Add<Linear<> >(5, 2);
+  model.Add<LogSoftMax<> >();
+
+  RNN<> lstmModel(input, labels, rho);
+  lstmModel.Add<IdentityLayer<> >();
+  lstmModel.Add<Linear<> >(1, 4);
+  lstmModel.Add<LSTM<> >(4, 5, rho);
+  lstmModel.Add<Linear<> >(5, 2);
+  lstmModel.Add<LogSoftMax<> >();
+
+  for (RNN<>* network : { &model, &lstmModel })
+  {
+    arma::mat storedGradient, recomputedGradient;
+    for (size_t i = 0; i < 2; ++i)
+    {
+      network->RecomputeOutputs() = false;
+      network->Gradient(network->Parameters(), i, storedGradient);
+      network->RecomputeOutputs() = true;
+      network->Gradient(network->Parameters(), i, recomputedGradient);
+      CheckMatrices(storedGradient, recomputedGradient, 1e-5);
+    }
+
+    // A batch of sequences, computed again after a single sequence.
+    network->RecomputeOutputs() = false;
+    network->Gradient(network->Parameters(), 0, storedGradient, input.n_cols);
+    network->RecomputeOutputs() = true;
+    network->Gradient(network->Parameters(), 0, recomputedGradient,
+        input.n_cols);
+    CheckMatrices(storedGradient, recomputedGradient, 1e-5);
+  }
+}
+
 /**
  * Generate a random Reber grammar.
  *
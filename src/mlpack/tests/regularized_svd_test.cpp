@@ -11,6 +11,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/regularized_svd/regularized_svd.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -249,4 +250,137 @@ BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionOptimize)
   BOOST_REQUIRE_SMALL(relativeError, 1e-2);
 }
 
+/**
+ * Make sure the dense and sparse gradients of one rating agree, and that they
+ * sum to the gradient of the whole objective.
+ */
+BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionSparseGradient)
+{
+  const size_t numUsers = 20;
+  const size_t numItems = 20;
+  const size_t numRatings = 100;
+  const size_t rank = 5;
+  const double lambda = 0.5;
+
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+
+  RegularizedSVDFunction rSVDFunc(data, rank, lambda);
+  arma::mat parameters = arma::randu(rank, numUsers + numItems);
+
+  arma::mat gradient, denseGradient;
+  arma::sp_mat sparseGradient;
+  arma::mat sum(rank, numUsers + numItems, arma::fill::zeros);
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    rSVDFunc.Gradient(parameters, i, denseGradient);
+    rSVDFunc.Gradient(parameters, i, sparseGradient);
+
+    // Only the user and item columns are touched.
+    BOOST_REQUIRE_LE(sparseGradient.n_nonzero, 2 * rank);
+    CheckMatrices(denseGradient, arma::mat(sparseGradient));
+
+    sum += denseGradient;
+  }
+
+  rSVDFunc.Gradient(parameters, gradient);
+  CheckMatrices(gradient, sum);
+}
+
+/**
+ * Make sure lock-free parallel SGD with sparse updates fits the ratings.
+ */
+BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionParallelSGD)
+{
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t iterations = 30;
+  const size_t rank = 10;
+  const double lambda = 0.01;
+
+  arma::mat parameters = arma::randu(rank, numUsers + numItems);
+
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    data(2, i) = arma::dot(parameters.col(data(0, i)),
+                           parameters.col(numUsers + data(1, i)));
+  }
+
+  // The per-point gradient includes the factor 2 which StandardSGD's
+  // Optimize() test implicitly folds into its step size of 0.01.
+  RegularizedSVDFunction rSVDFunc(data, rank, lambda);
+  mlpack::optimization::ParallelSGD<RegularizedSVDFunction> optimizer(rSVDFunc,
+      1, 0.005, iterations * numRatings, -1, true, true, 4);
+
+  arma::mat optParameters = arma::randu(rank, numUsers + numItems);
+  optimizer.Optimize(optParameters);
+
+  arma::mat predictedData(1, numRatings);
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    predictedData(0, i) = arma::dot(optParameters.col(data(0, i)),
+                                    optParameters.col(numUsers + data(1, i)));
+  }
+
+  const double relativeError = arma::norm(data.row(2) - predictedData, "frob") /
+                               arma::norm(data, "frob");
+
+  BOOST_REQUIRE_SMALL(relativeError, 1e-2);
+}
+
+/**
+ * Make sure that RegularizedSVD::Apply() with lock-free parallel optimization
+ * also converges.
+ */
+BOOST_AUTO_TEST_CASE(RegularizedSVDParallelApply)
+{
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t iterations = 30;
+  const size_t rank = 10;
+  const double lambda = 0.01;
+  const double alpha = 0.01;
+
+  arma::mat parameters = arma::randu(rank, numUsers + numItems);
+
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    data(2, i) = arma::dot(parameters.col(data(0, i)),
+                           parameters.col(numUsers + data(1, i)));
+  }
+
+  arma::mat u, v;
+  RegularizedSVD<> rSVD(iterations, alpha, lambda, true);
+  rSVD.Apply(data, rank, u, v);
+
+  arma::mat predictedData(1, numRatings);
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    predictedData(0, i) = arma::dot(v.col(data(0, i)),
+                                    u.row(data(1, i)).t());
+  }
+
+  const double relativeError = arma::norm(data.row(2) - predictedData, "frob") /
+                               arma::norm(data, "frob");
+
+  BOOST_REQUIRE_SMALL(relativeError, 1e-2);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -106,4 +106,26 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionTest)
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
 }
 
+/**
+ * Run RMSProp on logistic regression with sparse data, which uses the lazy
+ * sparse update, and make sure the results are acceptable.
+ */
+BOOST_AUTO_TEST_CASE(RMSPropSparseLogisticRegressionTest)
+{
+  // The labels are given by a hyperplane, so the problem is separable.
+  arma::sp_mat data;
+  data.sprandu(10, 1000, 0.3);
+  arma::Row<size_t> responses(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    responses[i] = (arma::accu(data.col(i)) > 1.5) ? 1 : 0;
+
+  LogisticRegression<arma::sp_mat> lr(data.n_rows, 0.0);
+  LogisticRegressionFunction<arma::sp_mat> lrf(data, responses, 0.0);
+  RMSProp<LogisticRegressionFunction<arma::sp_mat> > rmsprop(lrf, 0.01);
+  lr.Train(rmsprop);
+
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_GE(acc, 95.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/optimizers/sa/sa.hpp>
 #include <mlpack/core/optimizers/sa/exponential_schedule.hpp>
+#include <mlpack/core/optimizers/sa/parallel_tempering.hpp>
 #include <mlpack/core/optimizers/lbfgs/test_functions.hpp>
 
 #include <mlpack/core/metrics/ip_metric.hpp>
@@ -132,4 +133,96 @@ BOOST_AUTO_TEST_CASE(RastrigrinFunctionTest)
   BOOST_REQUIRE_GE(successes, 1);
 }
 
+/**
+ * Parallel tempering should escape the local minima of the Rastrigrin function
+ * too.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTemperingRastrigrinFunctionTest)
+{
+  size_t successes = 0;
+
+  for (size_t trial = 0; trial < 4; ++trial)
+  {
+    RastrigrinFunction f;
+    ParallelTempering<RastrigrinFunction> pt(f, 10, 1e-5, 50, 10, 20000, 10,
+        1e-12, 2000, 2, 0.1, 0.1);
+    arma::mat coordinates = f.GetInitialPoint();
+
+    const double result = pt.Optimize(coordinates);
+
+    if ((std::abs(result) < 1e-3) &&
+        (std::abs(coordinates[0]) < 1e-3) &&
+        (std::abs(coordinates[1]) < 1e-3))
+    {
+      ++successes;
+      break; // No need to continue.
+    }
+  }
+
+  BOOST_REQUIRE_GE(successes, 1);
+}
+
+/**
+ * A separable quadratic whose single-coordinate moves can be scored in O(1).
+ * It counts the full evaluations, to make sure that the optimizers use
+ * EvaluateDelta().
+ */
+class SeparableQuadraticFunction
+{
+ public:
+  SeparableQuadraticFunction(const size_t dim) : dim(dim), evaluations(0) { }
+
+  double Evaluate(const arma::mat& coordinates)
+  {
+    ++evaluations;
+    return arma::accu(arma::square(coordinates - 1));
+  }
+
+  double EvaluateDelta(const arma::mat& coordinates,
+                       const size_t index,
+                       const double value) const
+  {
+    return std::pow(value - 1, 2.0) - std::pow(coordinates[index] - 1, 2.0);
+  }
+
+  arma::mat GetInitialPoint() const { return arma::zeros<arma::mat>(dim, 1); }
+
+  size_t Evaluations() const { return evaluations; }
+
+ private:
+  size_t dim;
+  size_t evaluations;
+};
+
+BOOST_AUTO_TEST_CASE(EvaluateDeltaTest)
+{
+  BOOST_REQUIRE(HasEvaluateDelta<SeparableQuadraticFunction>::value);
+  BOOST_REQUIRE(!HasEvaluateDelta<RastrigrinFunction>::value);
+
+  SeparableQuadraticFunction f(20);
+  ExponentialSchedule schedule(1e-5);
+  SA<SeparableQuadraticFunction> sa(f, schedule, 1000000, 10., 1000, 100,
+      1e-12, 3, 20, 0.3, 0.3);
+  arma::mat coordinates = f.GetInitialPoint();
+  const double result = sa.Optimize(coordinates);
+
+  // Only the starting point is evaluated in full; the energy that is tracked
+  // by the deltas must match the objective of the final point.
+  BOOST_REQUIRE_EQUAL(f.Evaluations(), 1);
+  BOOST_REQUIRE_SMALL(result - arma::accu(arma::square(coordinates - 1)),
+      1e-8);
+  BOOST_REQUIRE_SMALL(result, 1e-3);
+
+  SeparableQuadraticFunction g(20);
+  ParallelTempering<SeparableQuadraticFunction> pt(g, 4, 1e-4, 1.0);
+  coordinates = g.GetInitialPoint();
+  const double ptResult = pt.Optimize(coordinates);
+
+  BOOST_REQUIRE_EQUAL(g.Evaluations(), 1);
+  BOOST_REQUIRE_SMALL(ptResult - arma::accu(arma::square(coordinates - 1)),
+      1e-8);
+  BOOST_REQUIRE_SMALL(ptResult, 1e-2);
+  BOOST_REQUIRE_EQUAL(pt.ExchangeRates().n_elem, 3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
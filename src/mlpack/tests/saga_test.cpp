@@ -0,0 +1,139 @@
+/**
+ * @file saga_test.cpp
+ *
+ * Test file for the SAGA optimizer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/saga/saga.hpp>
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace std;
+using namespace arma;
+using namespace mlpack;
+using namespace mlpack::optimization;
+
+using namespace mlpack::distribution;
+using namespace mlpack::regression;
+
+BOOST_AUTO_TEST_SUITE(SAGATest);
+
+//! LogisticRegressionFunction without the linear model members, so SAGA has
+//! to store a whole gradient per point.
+class DenseLogisticRegressionFunction
+{
+ public:
+  DenseLogisticRegressionFunction(const arma::mat& data,
+                                  const arma::Row<size_t>& responses,
+                                  const double lambda) :
+      function(data, responses, lambda) { }
+
+  size_t NumFunctions() const { return function.NumFunctions(); }
+
+  double Evaluate(const arma::mat& coordinates, const size_t i) const
+  {
+    return function.Evaluate(coordinates, i);
+  }
+
+  void Gradient(const arma::mat& coordinates,
+                const size_t i,
+                arma::mat& gradient) const
+  {
+    function.Gradient(coordinates, i, gradient);
+  }
+
+ private:
+  LogisticRegressionFunction<> function;
+};
+
+/**
+ * Create two overlapping Gaussians, so that the regularized logistic regression
+ * objective has a unique, finite minimum.
+ */
+void CreateSAGAData(arma::mat& data, arma::Row<size_t>& responses)
+{
+  GaussianDistribution g1(arma::vec("-1.0 -1.0 -1.0"),
+      arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("1.0 1.0 1.0"),
+      arma::eye<arma::mat>(3, 3));
+
+  data.set_size(3, 500);
+  responses.set_size(500);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = (i % 2 == 0) ? g1.Random() : g2.Random();
+    responses[i] = i % 2;
+  }
+}
+
+/**
+ * SAGA should find the same minimum of the logistic regression objective as
+ * L-BFGS, both with the table of coefficients that is used for linear models
+ * and with a table of whole gradients.
+ */
+BOOST_AUTO_TEST_CASE(SAGALogisticRegressionTest)
+{
+  arma::mat data;
+  arma::Row<size_t> responses;
+  CreateSAGAData(data, responses);
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+  BOOST_REQUIRE_EQUAL(HasLinearGradient<LogisticRegressionFunction<>>::value,
+      true);
+
+  L_BFGS<LogisticRegressionFunction<>> lbfgs(lrf);
+  arma::mat lbfgsCoordinates = lrf.GetInitialPoint();
+  const double lbfgsObjective = lbfgs.Optimize(lbfgsCoordinates);
+
+  SAGA<LogisticRegressionFunction<>> saga(lrf, 0.1, 100, 1e-9);
+  arma::mat coordinates = lrf.GetInitialPoint();
+  const double objective = saga.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(objective, lbfgsObjective, 1e-3);
+  BOOST_REQUIRE_SMALL(arma::norm(coordinates - lbfgsCoordinates), 1e-3);
+
+  DenseLogisticRegressionFunction dlrf(data, responses, 0.5);
+  BOOST_REQUIRE_EQUAL(
+      HasLinearGradient<DenseLogisticRegressionFunction>::value, false);
+
+  SAGA<DenseLogisticRegressionFunction> denseSaga(dlrf, 0.1, 100, 1e-9);
+  arma::mat denseCoordinates = lrf.GetInitialPoint();
+  const double denseObjective = denseSaga.Optimize(denseCoordinates);
+
+  BOOST_REQUIRE_CLOSE(denseObjective, lbfgsObjective, 1e-3);
+  BOOST_REQUIRE_SMALL(arma::norm(denseCoordinates - lbfgsCoordinates), 1e-3);
+}
+
+/**
+ * The logistic regression model trained with SAGA should classify the data.
+ */
+BOOST_AUTO_TEST_CASE(SAGALogisticRegressionTrainTest)
+{
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 500);
+  arma::Row<size_t> responses(500);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = (i < 250) ? g1.Random() : g2.Random();
+    responses[i] = (i < 250) ? 0 : 1;
+  }
+
+  LogisticRegression<> lr(data.n_rows, 0.5);
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+  SAGA<LogisticRegressionFunction<>> saga(lrf, 0.001);
+  lr.Train(saga);
+
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -255,6 +255,60 @@ static void SolveMaxCutPositiveSDP(const SDP<arma::sp_mat>& sdp)
   CheckKKT(sdp, X, ysparse, ydense, Z);
 }
 
+/**
+ * Make sure that the Lyapunov equations ZG + GZ = XA + AX of the Schur
+ * complement, which are solved with the eigendecomposition of Z and the rows
+ * of the non-zeros of sparse constraints, match a general Sylvester solver.
+ */
+BOOST_AUTO_TEST_CASE(ConstraintLyapunovTest)
+{
+  const size_t n = 25;
+
+  arma::mat z = arma::randu<arma::mat>(n, n);
+  z = z * z.t() + n * arma::eye<arma::mat>(n, n);
+  arma::mat x = arma::randu<arma::mat>(n, n);
+  x = x * x.t() + arma::eye<arma::mat>(n, n);
+
+  arma::vec lambda;
+  arma::mat q;
+  BOOST_REQUIRE(arma::eig_sym(lambda, q, z));
+  const arma::mat lambdaSums = arma::repmat(lambda, 1, n) +
+      arma::repmat(lambda.t(), n, 1);
+  const arma::mat w = q.t() * x * q;
+
+  // A sparse constraint like the ones of MVU, and a dense one.
+  arma::sp_mat sparseA(n, n);
+  sparseA(3, 3) = 1;
+  sparseA(3, 17) = -1;
+  sparseA(17, 3) = -1;
+  sparseA(17, 17) = 1;
+  arma::mat denseA = arma::randu<arma::mat>(n, n);
+  denseA += denseA.t();
+
+  for (size_t t = 0; t < 2; ++t)
+  {
+    const arma::mat a = (t == 0) ? arma::mat(sparseA) : denseA;
+    arma::mat g;
+    if (t == 0)
+      ConstraintLyapunov(g, sparseA, q, lambdaSums, w);
+    else
+      ConstraintLyapunov(g, denseA, q, lambdaSums, w);
+
+    arma::mat expected;
+    arma::syl(expected, z, z, -(x * a + a * x));
+
+    BOOST_REQUIRE_EQUAL(g.n_rows, n);
+    BOOST_REQUIRE_EQUAL(g.n_cols, n);
+    for (size_t i = 0; i < g.n_elem; ++i)
+    {
+      if (std::abs(expected[i]) < 1e-8)
+        BOOST_REQUIRE_SMALL(g[i], 1e-8);
+      else
+        BOOST_REQUIRE_CLOSE(g[i], expected[i], 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(SmallMaxCutSdp)
 {
   auto sdp = ConstructMaxCutSDPFromLaplacian("r10.txt");
@@ -32,6 +32,7 @@
 #include <mlpack/methods/naive_bayes/naive_bayes_classifier.hpp>
 #include <mlpack/methods/rann/ra_search.hpp>
 #include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/lsh/simhash_search.hpp>
 #include <mlpack/methods/decision_stump/decision_stump.hpp>
 #include <mlpack/methods/lars/lars.hpp>
 
@@ -538,6 +539,38 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeOverwriteTest)
   CheckTrees(tree, xmlTree, textTree, binaryTree);
 }
 
+/**
+ * Make sure that binary space trees are loaded in the compact layout, and that
+ * compacted trees with ball bounds survive serialization.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeCompactTest)
+{
+  arma::mat data;
+  data.randu(4, 500);
+  typedef BallTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(data, 5);
+  tree.Compact();
+
+  TreeType* xmlTree;
+  TreeType* textTree;
+  TreeType* binaryTree;
+
+  SerializePointerObjectAll(&tree, xmlTree, textTree, binaryTree);
+
+  BOOST_REQUIRE(xmlTree->IsCompact());
+  BOOST_REQUIRE(textTree->IsCompact());
+  BOOST_REQUIRE(binaryTree->IsCompact());
+
+  // In the compact layout, the left child directly follows its parent.
+  BOOST_REQUIRE_EQUAL(binaryTree->Left()->Left(), binaryTree->Left() + 1);
+
+  CheckTrees(tree, *xmlTree, *textTree, *binaryTree);
+
+  delete xmlTree;
+  delete textTree;
+  delete binaryTree;
+}
+
 BOOST_AUTO_TEST_CASE(CoverTreeTest)
 {
   arma::mat data;
@@ -769,7 +802,7 @@ BOOST_AUTO_TEST_CASE(PerceptronTest)
       labels[i] = 1;
   }
 
-  Perceptron<> p(data, labels, 2, 15);
+  Perceptron<> p(data, labels, 2, 15, 8);
 
   Perceptron<> pXml(2, 3), pText(2, 3), pBinary(2, 3);
   SerializeObjectAll(p, pXml, pText, pBinary);
@@ -782,6 +815,9 @@ BOOST_AUTO_TEST_CASE(PerceptronTest)
   BOOST_REQUIRE_EQUAL(p.MaxIterations(), pXml.MaxIterations());
   BOOST_REQUIRE_EQUAL(p.MaxIterations(), pText.MaxIterations());
   BOOST_REQUIRE_EQUAL(p.MaxIterations(), pBinary.MaxIterations());
+  BOOST_REQUIRE_EQUAL(p.BatchSize(), pXml.BatchSize());
+  BOOST_REQUIRE_EQUAL(p.BatchSize(), pText.BatchSize());
+  BOOST_REQUIRE_EQUAL(p.BatchSize(), pBinary.BatchSize());
 }
 
 BOOST_AUTO_TEST_CASE(LogisticRegressionTest)
@@ -833,6 +869,52 @@ BOOST_AUTO_TEST_CASE(KNNTest)
   CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
 }
 
+/**
+ * Make sure a kNN model can be searched after it is loaded from a
+ * memory-mapped mlpack binary model file.
+ */
+BOOST_AUTO_TEST_CASE(KNNMappedModelTest)
+{
+  using neighbor::KNN;
+  arma::mat dataset = arma::randu<arma::mat>(5, 2000);
+
+  KNN knn(dataset, DUAL_TREE_MODE);
+  BOOST_REQUIRE(data::Save("knn.mlmodel", "knn", knn) == true);
+
+  arma::mat querySet = arma::randu<arma::mat>(5, 1000);
+  arma::mat distances, loadedDistances, mappedDistances;
+  arma::Mat<size_t> neighbors, loadedNeighbors, mappedNeighbors;
+  knn.Search(querySet, 5, neighbors, distances);
+
+  // Load the file the usual way.
+  KNN loaded;
+  BOOST_REQUIRE(data::Load("knn.mlmodel", "knn", loaded) == true);
+  loaded.Search(querySet, 5, loadedNeighbors, loadedDistances);
+
+  {
+    data::MappedModel<KNN> mapped;
+    BOOST_REQUIRE(data::Load("knn.mlmodel", "knn", mapped) == true);
+
+#ifndef _WIN32
+    BOOST_REQUIRE(mapped.IsMapped());
+
+    // The dataset was not copied out of the file.
+    const arma::mat& referenceSet = mapped.Model().ReferenceSet();
+    BOOST_REQUIRE_EQUAL(referenceSet.mem_state, 1);
+    BOOST_REQUIRE_EQUAL((size_t) referenceSet.memptr() % 64, 0);
+#endif
+
+    mapped.Model().Search(querySet, 5, mappedNeighbors, mappedDistances);
+  }
+
+  CheckMatrices(distances, loadedDistances);
+  CheckMatrices(distances, mappedDistances);
+  CheckMatrices(neighbors, loadedNeighbors);
+  CheckMatrices(neighbors, mappedNeighbors);
+
+  remove("knn.mlmodel");
+}
+
 BOOST_AUTO_TEST_CASE(SoftmaxRegressionTest)
 {
   using regression::SoftmaxRegression;
@@ -1232,16 +1314,72 @@ BOOST_AUTO_TEST_CASE(LSHTest)
   BOOST_REQUIRE_EQUAL(lsh.BucketSize(), textLsh.BucketSize());
   BOOST_REQUIRE_EQUAL(lsh.BucketSize(), binaryLsh.BucketSize());
 
-  BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
-      xmlLsh.SecondHashTable().size());
-  BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
-      textLsh.SecondHashTable().size());
-  BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
-      binaryLsh.SecondHashTable().size());
+  CheckMatrices(lsh.BucketOffsets(), xmlLsh.BucketOffsets(),
+      textLsh.BucketOffsets(), binaryLsh.BucketOffsets());
+  CheckMatrices(arma::conv_to<arma::Mat<size_t>>::from(lsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(xmlLsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(textLsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(binaryLsh.BucketContents()));
+}
+
+/**
+ * Test that an LSH model with inserted and deleted points can be serialized.
+ */
+BOOST_AUTO_TEST_CASE(LSHInsertDeleteTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(10, 100);
+  arma::mat queryData = arma::randu<arma::mat>(10, 20);
+
+  LSHSearch<> lsh(referenceData, 5, 10);
+  lsh.Insert(arma::randu<arma::mat>(10, 50));
+  lsh.Delete(3);
+  lsh.Delete(120);
+
+  LSHSearch<> xmlLsh;
+  LSHSearch<> textLsh(referenceData, 4, 5);
+  LSHSearch<> binaryLsh(referenceData, 15, 2);
+  SerializeObjectAll(lsh, xmlLsh, textLsh, binaryLsh);
+
+  BOOST_REQUIRE_EQUAL(xmlLsh.NumDeleted(), 2);
+  BOOST_REQUIRE_EQUAL(textLsh.NumDeleted(), 2);
+  BOOST_REQUIRE_EQUAL(binaryLsh.NumDeleted(), 2);
+  BOOST_REQUIRE(xmlLsh.IsDeleted(120));
+  BOOST_REQUIRE(textLsh.IsDeleted(3));
 
-  for (size_t i = 0; i < lsh.SecondHashTable().size(); ++i)
-  CheckMatrices(lsh.SecondHashTable()[i], xmlLsh.SecondHashTable()[i],
-      textLsh.SecondHashTable()[i], binaryLsh.SecondHashTable()[i]);
+  arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat distances, xmlDistances, textDistances, binaryDistances;
+  lsh.Search(queryData, 3, neighbors, distances);
+  xmlLsh.Search(queryData, 3, xmlNeighbors, xmlDistances);
+  textLsh.Search(queryData, 3, textNeighbors, textDistances);
+  binaryLsh.Search(queryData, 3, binaryNeighbors, binaryDistances);
+
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+}
+
+/**
+ * Test that SimHashSearch can be serialized.
+ */
+BOOST_AUTO_TEST_CASE(SimHashSearchTest)
+{
+  arma::mat referenceData = arma::randn<arma::mat>(10, 100);
+  arma::mat queryData = arma::randn<arma::mat>(10, 20);
+
+  SimHashSearch<> simhash(referenceData, 12, 4);
+  SimHashSearch<> xmlSimhash;
+  SimHashSearch<> textSimhash(referenceData, 8, 2);
+  SimHashSearch<> binarySimhash(referenceData, 20, 1);
+  SerializeObjectAll(simhash, xmlSimhash, textSimhash, binarySimhash);
+
+  arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat distances, xmlDistances, textDistances, binaryDistances;
+  simhash.Search(queryData, 3, neighbors, distances, 1);
+  xmlSimhash.Search(queryData, 3, xmlNeighbors, xmlDistances, 1);
+  textSimhash.Search(queryData, 3, textNeighbors, textDistances, 1);
+  binarySimhash.Search(queryData, 3, binaryNeighbors, binaryDistances, 1);
+
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
 }
 
 // Make sure serialization works for the decision stump.
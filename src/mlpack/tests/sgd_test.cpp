@@ -25,6 +25,43 @@ using namespace mlpack::optimization::test;
 
 BOOST_AUTO_TEST_SUITE(SGDTest);
 
+//! SGDTestFunction with a separable EvaluateWithGradient(), which counts the
+//! calls of each of its functions.
+class CountingSGDTestFunction
+{
+ public:
+  CountingSGDTestFunction() : gradients(0), evaluationsWithGradient(0) { }
+
+  size_t NumFunctions() const { return function.NumFunctions(); }
+  arma::mat GetInitialPoint() const { return function.GetInitialPoint(); }
+
+  double Evaluate(const arma::mat& coordinates, const size_t i)
+  {
+    return function.Evaluate(coordinates, i);
+  }
+
+  void Gradient(const arma::mat& coordinates,
+                const size_t i,
+                arma::mat& gradient)
+  {
+    ++gradients;
+    function.Gradient(coordinates, i, gradient);
+  }
+
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              const size_t i,
+                              arma::mat& gradient)
+  {
+    ++evaluationsWithGradient;
+    function.Gradient(coordinates, i, gradient);
+    return function.Evaluate(coordinates, i);
+  }
+
+  SGDTestFunction function;
+  size_t gradients;
+  size_t evaluationsWithGradient;
+};
+
 BOOST_AUTO_TEST_CASE(SimpleSGDTestFunction)
 {
   SGDTestFunction f;
@@ -58,4 +95,27 @@ BOOST_AUTO_TEST_CASE(GeneralizedRosenbrockTest)
   }
 }
 
+/**
+ * Make sure the separable EvaluateWithGradient() is used when the function has
+ * it, and that the result is the same as with Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(EvaluateWithGradientSGDTest)
+{
+  SGDTestFunction f;
+  StandardSGD<SGDTestFunction> s(f, 0.0003, 10000, 1e-9, false);
+  arma::mat coordinates = f.GetInitialPoint();
+  const double result = s.Optimize(coordinates);
+
+  CountingSGDTestFunction cf;
+  StandardSGD<CountingSGDTestFunction> cs(cf, 0.0003, 10000, 1e-9, false);
+  arma::mat countingCoordinates = cf.GetInitialPoint();
+  const double countingResult = cs.Optimize(countingCoordinates);
+
+  BOOST_REQUIRE_CLOSE(countingResult, result, 1e-10);
+  CheckMatrices(countingCoordinates, coordinates);
+
+  BOOST_REQUIRE_EQUAL(cf.gradients, 0);
+  BOOST_REQUIRE_GT(cf.evaluationsWithGradient, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -132,4 +132,49 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionTest)
   }
 }
 
+/**
+ * Make sure that the snapshots written to files and the running average of the
+ * snapshots match the snapshots kept in memory.
+ */
+BOOST_AUTO_TEST_CASE(SnapshotEnsemblesStorageTest)
+{
+  SnapshotEnsembles memory(5, 2.0, 0.5, 10, 1000, 1000, 3);
+  SnapshotEnsembles disk(memory);
+  disk.SnapshotPrefix() = "snapshot_ensembles_test_";
+  SnapshotEnsembles average(memory);
+  average.RunningAverage() = true;
+
+  double stepSize = 0.5;
+  arma::mat iterate(20, 3);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    iterate.randu();
+    memory.Update(iterate, stepSize, iterate);
+    disk.Update(iterate, stepSize, iterate);
+    average.Update(iterate, stepSize, iterate);
+  }
+  disk.Wait();
+
+  BOOST_REQUIRE_EQUAL(memory.Snapshots().size(), 3);
+  BOOST_REQUIRE_EQUAL(disk.Snapshots().size(), 0);
+  BOOST_REQUIRE_EQUAL(disk.SnapshotFiles().size(), 3);
+  BOOST_REQUIRE_EQUAL(disk.NumSnapshots(), 3);
+  BOOST_REQUIRE_EQUAL(average.Snapshots().size(), 0);
+  BOOST_REQUIRE_EQUAL(average.NumSnapshots(), 3);
+
+  arma::mat mean(20, 3, arma::fill::zeros);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    data::MappedMatrix<double> snapshot;
+    snapshot.Map(disk.SnapshotFiles()[i]);
+    CheckMatrices(snapshot.Matrix(), memory.Snapshots()[i]);
+    snapshot.Unmap();
+    remove(disk.SnapshotFiles()[i].c_str());
+
+    mean += memory.Snapshots()[i] / 3;
+  }
+
+  CheckMatrices(average.Average(), mean);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
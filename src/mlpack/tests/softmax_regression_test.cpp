@@ -11,9 +11,13 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/softmax_regression/softmax_regression.hpp>
+#include <mlpack/methods/softmax_regression/hierarchical_softmax.hpp>
+#include <mlpack/methods/softmax_regression/sampled_softmax_function.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 using namespace mlpack;
 using namespace mlpack::regression;
@@ -39,7 +43,7 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionEvaluate)
     labels(i) = math::RandInt(0, numClasses);
 
   // Create a SoftmaxRegressionFunction. Regularization term ignored.
-  SoftmaxRegressionFunction srf(data, labels, numClasses, 0);
+  SoftmaxRegressionFunction<> srf(data, labels, numClasses, 0);
 
   // Run a number of trials.
   for (size_t i = 0; i < trials; i++)
@@ -84,9 +88,9 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionRegularizationEvaluate)
     labels(i) = math::RandInt(0, numClasses);
 
   // 3 objects for comparing regularization costs.
-  SoftmaxRegressionFunction srfNoReg(data, labels, numClasses, 0);
-  SoftmaxRegressionFunction srfSmallReg(data, labels, numClasses, 1);
-  SoftmaxRegressionFunction srfBigReg(data, labels, numClasses, 20);
+  SoftmaxRegressionFunction<> srfNoReg(data, labels, numClasses, 0);
+  SoftmaxRegressionFunction<> srfSmallReg(data, labels, numClasses, 1);
+  SoftmaxRegressionFunction<> srfBigReg(data, labels, numClasses, 20);
 
   // Run a number of trials.
   for (size_t i = 0; i < trials; i++)
@@ -126,8 +130,8 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionGradient)
 
   // 2 objects for 2 terms in the cost function. Each term contributes towards
   // the gradient and thus need to be checked independently.
-  SoftmaxRegressionFunction srf1(data, labels, numClasses, 0);
-  SoftmaxRegressionFunction srf2(data, labels, numClasses, 20);
+  SoftmaxRegressionFunction<> srf1(data, labels, numClasses, 0);
+  SoftmaxRegressionFunction<> srf2(data, labels, numClasses, 20);
 
   // Create a random set of parameters.
   arma::mat parameters;
@@ -172,6 +176,41 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionGradient)
   }
 }
 
+/**
+ * Make sure EvaluateWithGradient() gives the same results as Evaluate() and
+ * Gradient(), with and without the intercept.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionEvaluateWithGradient)
+{
+  const size_t points = 1000;
+  const size_t inputSize = 10;
+  const size_t numClasses = 5;
+
+  arma::mat data;
+  data.randu(inputSize, points);
+
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  for (size_t intercept = 0; intercept < 2; ++intercept)
+  {
+    SoftmaxRegressionFunction<> srf(data, labels, numClasses, 0.5,
+        intercept == 1);
+
+    arma::mat parameters;
+    parameters.randu(numClasses, inputSize + intercept);
+
+    arma::mat gradient, fusedGradient;
+    srf.Gradient(parameters, gradient);
+    const double objective = srf.EvaluateWithGradient(parameters,
+        fusedGradient);
+
+    BOOST_REQUIRE_CLOSE(objective, srf.Evaluate(parameters), 1e-5);
+    CheckMatrices(gradient, fusedGradient);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(SoftmaxRegressionTwoClasses)
 {
   const size_t points = 1000;
@@ -362,8 +401,8 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionTrainTest)
 
   // This should be the same as the default parameters given by
   // SoftmaxRegression.
-  SoftmaxRegressionFunction srf(dataset, labels, 2, 0.0001, false);
-  L_BFGS<SoftmaxRegressionFunction> lbfgs(srf);
+  SoftmaxRegressionFunction<> srf(dataset, labels, 2, 0.0001, false);
+  L_BFGS<SoftmaxRegressionFunction<>> lbfgs(srf);
   SoftmaxRegression<> sr(lbfgs);
 
   SoftmaxRegression<> sr2(dataset.n_rows, 2);
@@ -392,12 +431,12 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionOptimizerTrainTest)
   for (size_t i = 500; i < 1000; ++i)
     labels[i] = size_t(1.0);
 
-  SoftmaxRegressionFunction srf(dataset, labels, 2, 0.01, true);
-  L_BFGS<SoftmaxRegressionFunction> lbfgs(srf);
+  SoftmaxRegressionFunction<> srf(dataset, labels, 2, 0.01, true);
+  L_BFGS<SoftmaxRegressionFunction<>> lbfgs(srf);
   SoftmaxRegression<> sr(lbfgs);
 
   SoftmaxRegression<> sr2(dataset.n_rows, 2, true);
-  L_BFGS<SoftmaxRegressionFunction> lbfgs2(srf);
+  L_BFGS<SoftmaxRegressionFunction<>> lbfgs2(srf);
   sr2.Parameters() = srf.GetInitialPoint();
   sr2.Train(lbfgs2);
 
@@ -413,6 +452,65 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionOptimizerTrainTest)
   }
 }
 
+/**
+ * Make sure that a model trained on sparse data is the same as a model trained
+ * on the same data held in a dense matrix.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionSparseTest)
+{
+  arma::sp_mat sparseDataset = arma::sprandu<arma::sp_mat>(20, 500, 0.1);
+  arma::mat dataset(sparseDataset);
+  arma::Row<size_t> labels(500);
+  for (size_t i = 0; i < 500; ++i)
+    labels[i] = (arma::accu(dataset.col(i).rows(0, 9)) >
+        arma::accu(dataset.col(i).rows(10, 19))) ? 0 : 1;
+
+  // The objective and gradient must be the same.
+  SoftmaxRegressionFunction<> srf(dataset, labels, 2, 0.01, true);
+  SoftmaxRegressionFunction<arma::sp_mat> sparseSrf(sparseDataset, labels, 2,
+      0.01, true);
+  const arma::mat parameters = srf.GetInitialPoint();
+
+  BOOST_REQUIRE_CLOSE(srf.Evaluate(parameters),
+      sparseSrf.Evaluate(parameters), 1e-5);
+
+  arma::mat gradient, sparseGradient;
+  srf.Gradient(parameters, gradient);
+  sparseSrf.Gradient(parameters, sparseGradient);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    if (std::abs(gradient[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(sparseGradient[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(gradient[i], sparseGradient[i], 1e-5);
+  }
+
+  // Now train both models from the same starting point.
+  SoftmaxRegression<> sr(dataset.n_rows, 2, true);
+  sr.Parameters() = parameters;
+  sr.Train(dataset, labels, 2);
+
+  SoftmaxRegression<> sparseSr(dataset.n_rows, 2, true);
+  sparseSr.Parameters() = parameters;
+  sparseSr.Train(sparseDataset, labels, 2);
+
+  BOOST_REQUIRE_EQUAL(sr.Parameters().n_elem, sparseSr.Parameters().n_elem);
+  for (size_t i = 0; i < sr.Parameters().n_elem; ++i)
+  {
+    if (std::abs(sr.Parameters()[i]) < 1e-4)
+      BOOST_REQUIRE_SMALL(sparseSr.Parameters()[i], 1e-4);
+    else
+      BOOST_REQUIRE_CLOSE(sr.Parameters()[i], sparseSr.Parameters()[i], 1e-4);
+  }
+
+  // The predictions must also be the same.
+  arma::Row<size_t> predictions, sparsePredictions;
+  sr.Classify(dataset, predictions);
+  sparseSr.Classify(sparseDataset, sparsePredictions);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], sparsePredictions[i]);
+}
+
 BOOST_AUTO_TEST_CASE(SoftmaxRegressionClassifySinglePointTest)
 {
   const size_t points = 5000;
@@ -671,4 +769,294 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionComputeProbabilitiesAndLabelsTest)
   }
 }
 
+/**
+ * Create a dataset of well-separated Gaussian clusters, one per class.
+ */
+void CreateClassClusterData(const size_t numClasses,
+                            const size_t pointsPerClass,
+                            const size_t dimensionality,
+                            arma::mat& data,
+                            arma::Row<size_t>& labels)
+{
+  const arma::mat centers = 10.0 * arma::randn<arma::mat>(dimensionality,
+      numClasses);
+
+  data.set_size(dimensionality, numClasses * pointsPerClass);
+  labels.set_size(numClasses * pointsPerClass);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    labels[i] = i % numClasses;
+    data.col(i) = centers.col(labels[i]) +
+        0.5 * arma::randn<arma::vec>(dimensionality);
+  }
+}
+
+/**
+ * Make sure the path to each class in a ClassTree leads from the root to the
+ * leaf of that class, for both ways of building the tree.
+ */
+BOOST_AUTO_TEST_CASE(ClassTreePathsTest)
+{
+  const size_t numClasses = 13;
+  arma::mat data;
+  arma::Row<size_t> labels;
+  CreateClassClusterData(numClasses, 10, 3, data, labels);
+
+  std::vector<ClassTree> trees;
+  trees.push_back(ClassTree(data, labels, numClasses));
+  trees.push_back(ClassTree(labels, numClasses));
+
+  for (const ClassTree& tree : trees)
+  {
+    BOOST_REQUIRE_EQUAL(tree.NumClasses(), numClasses);
+    BOOST_REQUIRE_EQUAL(tree.NumInternalNodes(), numClasses - 1);
+
+    for (size_t c = 0; c < numClasses; ++c)
+    {
+      size_t node = tree.Root();
+      for (size_t k = 0; k < tree.PathLength(c); ++k)
+      {
+        BOOST_REQUIRE(!tree.IsLeaf(node));
+        BOOST_REQUIRE_EQUAL(tree.PathNode(c, k), node);
+        node = tree.Child(node, (tree.PathSign(c, k) > 0) ? 0 : 1);
+      }
+
+      BOOST_REQUIRE(tree.IsLeaf(node));
+      BOOST_REQUIRE_EQUAL(tree.Class(node), c);
+    }
+  }
+}
+
+/**
+ * Make sure the Huffman tree gives a frequent class a shorter path than the
+ * rare classes.
+ */
+BOOST_AUTO_TEST_CASE(ClassTreeHuffmanTest)
+{
+  const size_t numClasses = 8;
+  arma::Row<size_t> labels(100 + numClasses - 1);
+  labels.subvec(0, 99).fill(3);
+  for (size_t c = 0, i = 100; c < numClasses; ++c)
+    if (c != 3)
+      labels[i++] = c;
+
+  ClassTree tree(labels, numClasses);
+  BOOST_REQUIRE_EQUAL(tree.PathLength(3), 1);
+  for (size_t c = 0; c < numClasses; ++c)
+    BOOST_REQUIRE_GE(tree.PathLength(c), tree.PathLength(3));
+
+  // Labels must be below the number of classes.
+  BOOST_REQUIRE_THROW(ClassTree(labels, 3), std::invalid_argument);
+}
+
+/**
+ * Make sure the separable objective and gradients of the hierarchical softmax
+ * function add up to the full ones, and that the sparse gradient matches the
+ * dense one, with and without the intercept.
+ */
+BOOST_AUTO_TEST_CASE(HierarchicalSoftmaxFunctionSeparableTest)
+{
+  const size_t numClasses = 9;
+  arma::mat data;
+  arma::Row<size_t> labels;
+  CreateClassClusterData(numClasses, 10, 4, data, labels);
+  const ClassTree tree(data, labels, numClasses);
+
+  for (size_t intercept = 0; intercept < 2; ++intercept)
+  {
+    HierarchicalSoftmaxFunction<> f(data, labels, tree, 0.3, intercept == 1);
+    const arma::mat parameters = arma::randn<arma::mat>(
+        f.GetInitialPoint().n_rows, f.GetInitialPoint().n_cols);
+
+    arma::mat gradient;
+    const double objective = f.EvaluateWithGradient(parameters, gradient);
+    BOOST_REQUIRE_CLOSE(objective, f.Evaluate(parameters), 1e-5);
+
+    double sum = 0.0;
+    arma::mat gradientSum(arma::size(parameters), arma::fill::zeros);
+    arma::mat pointGradient;
+    arma::sp_mat sparseGradient;
+    for (size_t i = 0; i < f.NumFunctions(); ++i)
+    {
+      sum += f.EvaluateWithGradient(parameters, i, pointGradient);
+      gradientSum += pointGradient;
+
+      f.Gradient(parameters, i, sparseGradient);
+      CheckMatrices(arma::mat(sparseGradient), pointGradient);
+    }
+
+    BOOST_REQUIRE_CLOSE(sum, objective, 1e-5);
+    CheckMatrices(gradientSum, gradient);
+  }
+}
+
+/**
+ * Compare the gradient of the hierarchical softmax function with a numerical
+ * gradient.
+ */
+BOOST_AUTO_TEST_CASE(HierarchicalSoftmaxFunctionGradientTest)
+{
+  const size_t numClasses = 6;
+  arma::mat data;
+  arma::Row<size_t> labels;
+  CreateClassClusterData(numClasses, 20, 3, data, labels);
+  data /= 10.0;
+
+  HierarchicalSoftmaxFunction<> f(data, labels, ClassTree(labels, numClasses),
+      0.1, true);
+  arma::mat parameters = arma::randn<arma::mat>(f.GetInitialPoint().n_rows,
+      f.GetInitialPoint().n_cols);
+
+  arma::mat gradient;
+  f.Gradient(parameters, gradient);
+
+  const double epsilon = 0.0001;
+  for (size_t j = 0; j < parameters.n_elem; ++j)
+  {
+    parameters[j] += epsilon;
+    const double costPlus = f.Evaluate(parameters);
+    parameters[j] -= 2 * epsilon;
+    const double costMinus = f.Evaluate(parameters);
+    parameters[j] += epsilon;
+
+    BOOST_REQUIRE_CLOSE((costPlus - costMinus) / (2 * epsilon) + 1.0,
+        gradient[j] + 1.0, 1e-3);
+  }
+}
+
+/**
+ * Train hierarchical softmax regression with L-BFGS and SGD on well-separated
+ * clusters, and make sure it classifies them well, and that the probabilities
+ * of the classes sum to one.
+ */
+BOOST_AUTO_TEST_CASE(HierarchicalSoftmaxRegressionTrainTest)
+{
+  const size_t numClasses = 20;
+  arma::mat data, testData;
+  arma::Row<size_t> labels, testLabels;
+  math::RandomSeed(42);
+  CreateClassClusterData(numClasses, 30, 5, data, labels);
+  math::RandomSeed(42);
+  CreateClassClusterData(numClasses, 10, 5, testData, testLabels);
+
+  HierarchicalSoftmaxRegression model(data, labels, numClasses, 0.0001, true);
+  BOOST_REQUIRE_EQUAL(model.NumClasses(), numClasses);
+  BOOST_REQUIRE_GT(model.ComputeAccuracy(testData, testLabels), 90.0);
+  BOOST_REQUIRE_GT(model.ComputeAccuracy(testData, testLabels, 4), 90.0);
+
+  for (size_t i = 0; i < 10; ++i)
+  {
+    double sum = 0.0;
+    for (size_t c = 0; c < numClasses; ++c)
+      sum += model.Probability(testData.col(i), c);
+    BOOST_REQUIRE_CLOSE(sum, 1.0, 1e-5);
+  }
+
+  // Train with SGD on the Huffman tree, which uses the sparse gradients.
+  HierarchicalSoftmaxFunction<> f(data, labels, ClassTree(labels, numClasses),
+      0.0001, true);
+  SGD<HierarchicalSoftmaxFunction<>> sgd(f, 0.5, 50 * data.n_cols, 1e-10);
+  HierarchicalSoftmaxRegression sgdModel;
+  sgdModel.Train(sgd);
+  BOOST_REQUIRE_GT(sgdModel.ComputeAccuracy(testData, testLabels), 90.0);
+
+  BOOST_REQUIRE_THROW(model.Classify(testData.col(0), 0),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure a hierarchical softmax regression model can be serialized.
+ */
+BOOST_AUTO_TEST_CASE(HierarchicalSoftmaxRegressionSerializationTest)
+{
+  const size_t numClasses = 7;
+  arma::mat data;
+  arma::Row<size_t> labels;
+  CreateClassClusterData(numClasses, 20, 3, data, labels);
+
+  HierarchicalSoftmaxRegression model(data, labels, numClasses, 0.01, true,
+      true);
+  HierarchicalSoftmaxRegression xmlModel, textModel, binaryModel;
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+
+  CheckMatrices(model.Parameters(), xmlModel.Parameters(),
+      textModel.Parameters(), binaryModel.Parameters());
+
+  arma::Row<size_t> predictions, xmlPredictions, textPredictions,
+      binaryPredictions;
+  model.Classify(data, predictions, 3);
+  xmlModel.Classify(data, xmlPredictions, 3);
+  textModel.Classify(data, textPredictions, 3);
+  binaryModel.Classify(data, binaryPredictions, 3);
+  CheckMatrices(predictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+  BOOST_REQUIRE_EQUAL(xmlModel.FitIntercept(), true);
+  BOOST_REQUIRE_CLOSE(binaryModel.Lambda(), 0.01, 1e-5);
+}
+
+/**
+ * With two classes, the sampled softmax function is exact, so its separable
+ * objective and gradients must add up to those of SoftmaxRegressionFunction.
+ */
+BOOST_AUTO_TEST_CASE(SampledSoftmaxFunctionTwoClassesTest)
+{
+  arma::mat data;
+  arma::Row<size_t> labels;
+  CreateClassClusterData(2, 50, 4, data, labels);
+  data /= 10.0;
+
+  for (size_t intercept = 0; intercept < 2; ++intercept)
+  {
+    SampledSoftmaxFunction<> f(data, labels, 2, 5, 0.5, intercept == 1);
+    SoftmaxRegressionFunction<> full(data, labels, 2, 0.5, intercept == 1);
+    const arma::mat parameters = arma::randn<arma::mat>(
+        f.GetInitialPoint().n_rows, f.GetInitialPoint().n_cols);
+
+    arma::mat gradient;
+    const double objective = full.EvaluateWithGradient(parameters, gradient);
+
+    double sum = 0.0;
+    arma::mat gradientSum(arma::size(parameters), arma::fill::zeros);
+    arma::mat pointGradient;
+    arma::sp_mat sparseGradient;
+    arma::mat sparseGradientSum(arma::size(parameters), arma::fill::zeros);
+    for (size_t i = 0; i < f.NumFunctions(); ++i)
+    {
+      sum += f.EvaluateWithGradient(parameters, i, pointGradient);
+      gradientSum += pointGradient;
+
+      f.Gradient(parameters, i, sparseGradient);
+      sparseGradientSum += sparseGradient;
+    }
+
+    BOOST_REQUIRE_CLOSE(sum, objective, 1e-5);
+    CheckMatrices(gradientSum, gradient);
+    CheckMatrices(sparseGradientSum, gradient);
+  }
+}
+
+/**
+ * Train softmax regression with the sampled softmax function and SGD, and
+ * make sure the full model classifies well-separated clusters well.
+ */
+BOOST_AUTO_TEST_CASE(SampledSoftmaxFunctionSGDTest)
+{
+  const size_t numClasses = 20;
+  arma::mat data, testData;
+  arma::Row<size_t> labels, testLabels;
+  math::RandomSeed(42);
+  CreateClassClusterData(numClasses, 30, 5, data, labels);
+  math::RandomSeed(42);
+  CreateClassClusterData(numClasses, 10, 5, testData, testLabels);
+
+  SampledSoftmaxFunction<> f(data, labels, numClasses, 5, 0.0001, true);
+  SGD<SampledSoftmaxFunction<>> sgd(f, 0.5, 50 * data.n_cols, 1e-10);
+  arma::mat parameters = f.GetInitialPoint();
+  sgd.Optimize(parameters);
+
+  SoftmaxRegression<> model(data.n_rows, numClasses, true);
+  model.Parameters() = parameters;
+  BOOST_REQUIRE_GT(model.ComputeAccuracy(testData, testLabels), 90.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
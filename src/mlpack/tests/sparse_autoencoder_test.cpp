@@ -11,12 +11,14 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/sparse_autoencoder/sparse_autoencoder.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
 using namespace mlpack;
 using namespace mlpack::nn;
+using namespace mlpack::optimization;
 
 BOOST_AUTO_TEST_SUITE(SparseAutoencoderTest);
 
@@ -268,4 +270,189 @@ BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionGradient)
   }
 }
 
+/**
+ * Make sure EvaluateWithGradient(), and Evaluate() followed by Gradient() at
+ * the same parameters, give the same results as a function object that has
+ * never been evaluated.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionEvaluateWithGradient)
+{
+  const size_t vSize = 20;
+  const size_t hSize = 10;
+
+  arma::mat data;
+  data.randu(vSize, 500);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, 0.01, 3, 0.1);
+
+  for (size_t trial = 0; trial < 5; ++trial)
+  {
+    arma::mat parameters;
+    parameters.randu(2 * hSize + 1, vSize + 1);
+
+    SparseAutoencoderFunction fresh(data, vSize, hSize, 0.01, 3, 0.1);
+    arma::mat freshGradient;
+    fresh.Gradient(parameters, freshGradient);
+    const double freshObjective = SparseAutoencoderFunction(data, vSize,
+        hSize, 0.01, 3, 0.1).Evaluate(parameters);
+
+    arma::mat gradient, fusedGradient;
+    const double objective = saf.Evaluate(parameters);
+    saf.Gradient(parameters, gradient);
+    const double fusedObjective = saf.EvaluateWithGradient(parameters,
+        fusedGradient);
+
+    BOOST_REQUIRE_CLOSE(objective, freshObjective, 1e-10);
+    BOOST_REQUIRE_CLOSE(fusedObjective, freshObjective, 1e-10);
+    CheckMatrices(gradient, freshGradient);
+    CheckMatrices(fusedGradient, freshGradient);
+  }
+}
+
+/**
+ * Make sure the objectives and gradients of the batches of a partition of the
+ * dataset sum to the objective and gradient on the whole dataset when there is
+ * no KL divergence term, and that a batch of the whole dataset is the same as
+ * the dataset.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionBatches)
+{
+  const size_t points = 1000;
+  const size_t vSize = 20;
+  const size_t hSize = 10;
+
+  arma::mat data;
+  data.randu(vSize, points);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, 0.01, 0);
+  BOOST_REQUIRE_EQUAL(saf.NumFunctions(), points);
+
+  arma::mat parameters;
+  parameters.randu(2 * hSize + 1, vSize + 1);
+
+  const double objective = saf.Evaluate(parameters);
+  arma::mat gradient;
+  saf.Gradient(parameters, gradient);
+
+  // Use batches of different sizes, and single points.
+  double batchObjective = 0.0;
+  arma::mat batchGradient(arma::size(gradient), arma::fill::zeros);
+  arma::mat partialGradient;
+  size_t begin = 0;
+  for (size_t batchSize = 1; begin < points; ++batchSize)
+  {
+    const size_t size = std::min(batchSize, points - begin);
+    if (size == 1)
+    {
+      batchObjective += saf.Evaluate(parameters, begin);
+      saf.Gradient(parameters, begin, partialGradient);
+    }
+    else
+    {
+      batchObjective += saf.Evaluate(parameters, begin, size);
+      saf.Gradient(parameters, begin, partialGradient, size);
+    }
+
+    batchGradient += partialGradient;
+    begin += size;
+  }
+
+  BOOST_REQUIRE_CLOSE(batchObjective, objective, 1e-8);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    if (std::abs(gradient[i]) < 1e-10)
+      BOOST_REQUIRE_SMALL(batchGradient[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(batchGradient[i], gradient[i], 1e-8);
+  }
+
+  // With the KL divergence term, only the whole dataset gives the same result.
+  SparseAutoencoderFunction klSaf(data, vSize, hSize, 0.01, 3);
+  arma::mat klGradient, klBatchGradient;
+  klSaf.Gradient(parameters, klGradient);
+  const double klObjective = klSaf.Evaluate(parameters);
+  klSaf.Gradient(parameters, 0, klBatchGradient, points);
+
+  BOOST_REQUIRE_CLOSE(klSaf.Evaluate(parameters, 0, points), klObjective,
+      1e-10);
+  CheckMatrices(klBatchGradient, klGradient);
+}
+
+/**
+ * Make sure the gradient of a batch matches the numerical gradient of the
+ * objective of the batch, and that EvaluateWithGradient() matches both.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionBatchGradient)
+{
+  const size_t vSize = 10;
+  const size_t hSize = 5;
+
+  arma::mat data;
+  data.randu(vSize, 300);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, 20, 20);
+
+  arma::mat parameters;
+  parameters.randu(2 * hSize + 1, vSize + 1);
+
+  const size_t begin = 50;
+  const size_t batchSize = 40;
+  arma::mat gradient;
+  saf.Gradient(parameters, begin, gradient, batchSize);
+
+  const double epsilon = 0.0001;
+  for (size_t i = 0; i <= 2 * hSize; i++)
+  {
+    for (size_t j = 0; j <= vSize; j++)
+    {
+      parameters(i, j) += epsilon;
+      const double costPlus = saf.Evaluate(parameters, begin, batchSize);
+      parameters(i, j) -= 2 * epsilon;
+      const double costMinus = saf.Evaluate(parameters, begin, batchSize);
+      parameters(i, j) += epsilon;
+
+      const double numGradient = (costPlus - costMinus) / (2 * epsilon);
+      if (std::abs(gradient(i, j)) < 1e-8)
+        BOOST_REQUIRE_SMALL(numGradient, 1e-6);
+      else
+        BOOST_REQUIRE_CLOSE(numGradient, gradient(i, j), 1e-2);
+    }
+  }
+
+  // The fused computation of the batch must give the same results.
+  arma::mat fusedGradient;
+  BOOST_REQUIRE_CLOSE(saf.EvaluateWithGradient(parameters, begin,
+      fusedGradient, batchSize), saf.Evaluate(parameters, begin, batchSize),
+      1e-10);
+  CheckMatrices(fusedGradient, gradient);
+}
+
+/**
+ * Make sure a sparse autoencoder can be trained with mini-batch SGD.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderMiniBatchSGDTest)
+{
+  const size_t points = 500;
+  const size_t vSize = 10;
+  const size_t hSize = 5;
+
+  arma::mat data;
+  data.randu(vSize, points);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize);
+  const double initialObjective = saf.Evaluate(saf.GetInitialPoint());
+
+  // The step size is 0.5 on the average objective of a batch.
+  MiniBatchSGD<SparseAutoencoderFunction> sgd(saf, 25, 0.5 * points, 5000,
+      1e-8);
+  SparseAutoencoder<MiniBatchSGD> encoder(sgd);
+
+  BOOST_REQUIRE_LT(saf.Evaluate(encoder.Parameters()), 0.5 * initialObjective);
+
+  arma::mat features;
+  encoder.GetNewFeatures(data, features);
+  BOOST_REQUIRE_EQUAL(features.n_rows, hSize);
+  BOOST_REQUIRE_EQUAL(features.n_cols, points);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -109,6 +109,51 @@ BOOST_AUTO_TEST_CASE(SparseCodingTestCodingStepElasticNet)
   }
 }
 
+/**
+ * Make sure that encoding the points in parallel gives the same codes as
+ * encoding them on one thread.
+ */
+BOOST_AUTO_TEST_CASE(SparseCodingParallelEncodeTest)
+{
+  double lambda1 = 0.1;
+  double lambda2 = 0.2;
+  uword nAtoms = 25;
+
+  mat X;
+  X.load("mnist_first250_training_4s_and_9s.arm");
+
+  // Normalize each point since these are images.
+  for (uword i = 0; i < X.n_cols; ++i)
+    X.col(i) /= norm(X.col(i), 2);
+
+  SparseCoding sc(nAtoms, lambda1, lambda2);
+  DataDependentRandomInitializer::Initialize(X, 25, sc.Dictionary());
+
+#ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  mat serialZ;
+  sc.Encode(X, serialZ);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(4);
+#endif
+
+  mat Z;
+  sc.Encode(X, Z);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+
+  BOOST_REQUIRE_EQUAL(Z.n_rows, serialZ.n_rows);
+  BOOST_REQUIRE_EQUAL(Z.n_cols, serialZ.n_cols);
+  for (uword i = 0; i < Z.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(Z[i], serialZ[i]);
+}
+
 BOOST_AUTO_TEST_CASE(SparseCodingTestDictionaryStep)
 {
   const double tol = 1e-6;
@@ -308,4 +308,67 @@ BOOST_AUTO_TEST_CASE(SpillTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+/**
+ * Make sure that the descendants of every node of a large tree (built in
+ * parallel) are the points of the leaves below it, in depth-first order, and
+ * that a copy of the tree has the same descendants.
+ */
+BOOST_AUTO_TEST_CASE(SpillTreeDescendantsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 10000);
+  typedef SPTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  TreeType* tree = new TreeType(dataset, 0.05);
+  TreeType copy(*tree);
+
+  std::vector<size_t> descendants;
+  for (size_t i = 0; i < tree->NumDescendants(); ++i)
+    descendants.push_back(tree->Descendant(i));
+  delete tree;
+
+  std::stack<TreeType*> nodes;
+  nodes.push(&copy);
+  while (!nodes.empty())
+  {
+    TreeType* node = nodes.top();
+    nodes.pop();
+
+    // Collect the points of the leaves below the node, from left to right.
+    std::vector<size_t> points;
+    std::stack<TreeType*> subtree;
+    subtree.push(node);
+    while (!subtree.empty())
+    {
+      TreeType* child = subtree.top();
+      subtree.pop();
+
+      for (size_t i = 0; i < child->NumPoints(); ++i)
+        points.push_back(child->Point(i));
+      if (child->Right())
+        subtree.push(child->Right());
+      if (child->Left())
+        subtree.push(child->Left());
+    }
+
+    BOOST_REQUIRE_EQUAL(node->NumDescendants(), points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+      BOOST_REQUIRE_LT(points[i], dataset.n_cols);
+      BOOST_REQUIRE_EQUAL(node->Descendant(i), points[i]);
+    }
+
+    if (node == &copy)
+    {
+      BOOST_REQUIRE_EQUAL(descendants.size(), points.size());
+      for (size_t i = 0; i < points.size(); ++i)
+        BOOST_REQUIRE_EQUAL(descendants[i], points[i]);
+    }
+
+    if (node->Left())
+      nodes.push(node->Left());
+    if (node->Right())
+      nodes.push(node->Right());
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
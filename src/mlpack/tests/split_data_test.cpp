@@ -170,4 +170,119 @@ BOOST_AUTO_TEST_CASE(SplitLabeledDataLargerTest)
   CheckDuplication(std::get<2>(value), std::get<3>(value));
 }
 
+/**
+ * Make sure SplitInPlace() shuffles the columns and labels together, and that
+ * the outputs are aliases of the input.  The matrix is large enough for the
+ * blocked shuffle to use several buckets.
+ */
+BOOST_AUTO_TEST_CASE(SplitInPlaceTest)
+{
+  mat original(100, 2000);
+  original.randu();
+  mat input(original);
+
+  Row<size_t> labels = arma::linspace<Row<size_t>>(0, input.n_cols - 1,
+      input.n_cols);
+
+  mat trainData, testData;
+  Row<size_t> trainLabels, testLabels;
+  SplitInPlace(input, labels, trainData, testData, trainLabels, testLabels,
+      0.3);
+
+  BOOST_REQUIRE_EQUAL(trainData.n_cols, 2000 - size_t(0.3 * 2000));
+  BOOST_REQUIRE_EQUAL(testData.n_cols, size_t(0.3 * 2000));
+  BOOST_REQUIRE_EQUAL(trainData.memptr(), input.memptr());
+  BOOST_REQUIRE_EQUAL(testData.memptr(), input.colptr(trainData.n_cols));
+  BOOST_REQUIRE_EQUAL(testLabels.memptr(), labels.memptr() + trainData.n_cols);
+
+  CompareData(original, trainData, trainLabels);
+  CompareData(original, testData, testLabels);
+  CheckDuplication(trainLabels, testLabels);
+
+  // The points should have been reordered.
+  BOOST_REQUIRE_GT(arma::accu(labels != arma::linspace<Row<size_t>>(0,
+      input.n_cols - 1, input.n_cols)), 0);
+}
+
+/**
+ * Make sure StratifiedSplitInPlace() keeps the proportions of the classes.
+ */
+BOOST_AUTO_TEST_CASE(StratifiedSplitInPlaceTest)
+{
+  mat input(3, 1000);
+  input.randu();
+  input.row(0) = arma::linspace<rowvec>(0, 999, 1000);
+
+  // One point in ten is of class 1.
+  Row<size_t> labels(1000);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels[i] = (i % 10 == 0) ? 1 : 0;
+
+  mat trainData, testData;
+  Row<size_t> trainLabels, testLabels;
+  StratifiedSplitInPlace(input, labels, trainData, testData, trainLabels,
+      testLabels, 0.25);
+
+  BOOST_REQUIRE_EQUAL(testData.n_cols, 250);
+  BOOST_REQUIRE_EQUAL(testLabels.n_elem, 250);
+  BOOST_REQUIRE_EQUAL(arma::accu(testLabels), 25);
+  BOOST_REQUIRE_EQUAL(arma::accu(trainLabels), 75);
+
+  // Each point should still have its label.
+  for (size_t i = 0; i < input.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(labels[i], (size_t(input(0, i)) % 10 == 0) ? 1 : 0);
+}
+
+/**
+ * Split a CSV file line by line, with and without stratification.
+ */
+BOOST_AUTO_TEST_CASE(SplitFileTest)
+{
+  mat input(2, 200);
+  input.row(0) = arma::linspace<rowvec>(0, 199, 200);
+  input.row(1) = 2 * input.row(0);
+  data::Save("split_file_test.csv", input);
+
+  const size_t testSize = SplitFile("split_file_test.csv",
+      "split_file_train.csv", "split_file_test_out.csv", 0.2);
+  BOOST_REQUIRE_EQUAL(testSize, 40);
+
+  mat trainData, testData;
+  data::Load("split_file_train.csv", trainData, true);
+  data::Load("split_file_test_out.csv", testData, true);
+  BOOST_REQUIRE_EQUAL(trainData.n_cols, 160);
+  BOOST_REQUIRE_EQUAL(testData.n_cols, 40);
+
+  // The points keep their order.
+  mat concat = arma::join_rows(trainData, testData);
+  CheckMatEqual(input, concat);
+  for (size_t i = 1; i < testData.n_cols; ++i)
+    BOOST_REQUIRE_GT(testData(0, i), testData(0, i - 1));
+
+  Row<size_t> labels(200);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels[i] = (i % 4 == 0) ? 1 : 0;
+
+  Row<size_t> trainLabels, testLabels;
+  SplitFile("split_file_test.csv", labels, "split_file_train.csv",
+      "split_file_test_out.csv", trainLabels, testLabels, 0.2, true);
+  BOOST_REQUIRE_EQUAL(testLabels.n_elem, 40);
+  BOOST_REQUIRE_EQUAL(arma::accu(testLabels), 10);
+
+  data::Load("split_file_test_out.csv", testData, true);
+  for (size_t i = 0; i < testData.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(testLabels[i],
+        (size_t(testData(0, i)) % 4 == 0) ? 1 : 0);
+
+  // The wrong number of labels is an error.
+  labels.resize(150);
+  BOOST_REQUIRE_THROW(SplitFile("split_file_test.csv", labels,
+      "split_file_train.csv", "split_file_test_out.csv", trainLabels,
+      testLabels, 0.2), std::runtime_error);
+
+  remove("split_file_test.csv");
+  remove("split_file_train.csv");
+  remove("split_file_test_out.csv");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -186,4 +186,35 @@ BOOST_AUTO_TEST_CASE(SVDBatchNegativeElementTest)
   BOOST_REQUIRE_CLOSE(arma::norm(test, "fro"), arma::norm(result, "fro"), 5.0);
 }
 
+/**
+ * The residue of SimpleToleranceTermination on a sparse matrix, which is only
+ * computed on the nonzero entries, must be the same as the residue on a dense
+ * copy of the matrix.
+ */
+BOOST_AUTO_TEST_CASE(SimpleToleranceTerminationSparseTest)
+{
+  sp_mat data;
+  data.sprandu(100, 80, 0.1);
+  const mat denseData(data);
+
+  SimpleToleranceTermination<sp_mat> sparseTermination;
+  SimpleToleranceTermination<mat> denseTermination;
+  sparseTermination.Initialize(data);
+  denseTermination.Initialize(denseData);
+
+  // Compute the expected residue by hand.
+  mat w = randu<mat>(100, 4);
+  mat h = randu<mat>(4, 80);
+  const mat wh = w * h;
+  double sum = 0.0;
+  for (sp_mat::const_iterator it = data.begin(); it != data.end(); ++it)
+    sum += std::pow((*it) - wh(it.row(), it.col()), 2.0);
+  const double residue = std::sqrt(sum / data.n_nonzero);
+
+  sparseTermination.IsConverged(w, h);
+  denseTermination.IsConverged(w, h);
+  BOOST_REQUIRE_CLOSE(sparseTermination.Index(), residue, 1e-8);
+  BOOST_REQUIRE_CLOSE(denseTermination.Index(), residue, 1e-8);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
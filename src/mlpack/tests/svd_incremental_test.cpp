@@ -2,9 +2,11 @@
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/amf/update_rules/svd_incomplete_incremental_learning.hpp>
 #include <mlpack/methods/amf/update_rules/svd_complete_incremental_learning.hpp>
+#include <mlpack/methods/amf/update_rules/parallel_svd_incremental_learning.hpp>
 #include <mlpack/methods/amf/init_rules/random_init.hpp>
 #include <mlpack/methods/amf/termination_policies/incomplete_incremental_termination.hpp>
 #include <mlpack/methods/amf/termination_policies/complete_incremental_termination.hpp>
+#include <mlpack/methods/amf/termination_policies/max_iteration_termination.hpp>
 #include <mlpack/methods/amf/termination_policies/simple_tolerance_termination.hpp>
 #include <mlpack/methods/amf/termination_policies/validation_RMSE_termination.hpp>
 
@@ -139,4 +141,36 @@ BOOST_AUTO_TEST_CASE(SVDIncompleteIncrementalRegularizationTest)
   BOOST_REQUIRE_LT(regularizedRMSE, regularRMSE + 0.075);
 }
 
+/**
+ * Test that the lock-free parallel incremental learning fits the ratings of a
+ * low-rank matrix.
+ */
+BOOST_AUTO_TEST_CASE(ParallelSVDIncrementalFitTest)
+{
+  // Sample 40% of the elements of a rank 3 matrix.
+  const arma::mat w = arma::randu<arma::mat>(50, 3);
+  const arma::mat h = arma::randu<arma::mat>(3, 60);
+  const arma::mat product = w * h;
+  arma::sp_mat data(50, 60);
+  for (size_t j = 0; j < 60; ++j)
+    for (size_t i = 0; i < 50; ++i)
+      if (math::Random() < 0.4)
+        data(i, j) = product(i, j);
+
+  AMF<MaxIterationTermination, RandomInitialization,
+      ParallelSVDIncrementalLearning> amf(MaxIterationTermination(500),
+      RandomInitialization(), ParallelSVDIncrementalLearning(0.01));
+
+  mat W, H;
+  amf.Apply(data, 3, W, H);
+
+  // Compute the RMSE of the given ratings.
+  double error = 0.0;
+  for (arma::sp_mat::const_iterator it = data.begin(); it != data.end(); ++it)
+    error += std::pow((*it) - arma::dot(W.row(it.row()), H.col(it.col())), 2);
+  const double rmse = std::sqrt(error / data.n_nonzero);
+
+  BOOST_REQUIRE_LT(rmse, 0.1);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
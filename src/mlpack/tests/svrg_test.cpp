@@ -0,0 +1,118 @@
+/**
+ * @file svrg_test.cpp
+ *
+ * Test file for the SVRG optimizer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/svrg/svrg.hpp>
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace std;
+using namespace arma;
+using namespace mlpack;
+using namespace mlpack::optimization;
+
+using namespace mlpack::distribution;
+using namespace mlpack::regression;
+
+BOOST_AUTO_TEST_SUITE(SVRGTest);
+
+/**
+ * Create two overlapping Gaussians, so that the regularized logistic regression
+ * objective has a unique, finite minimum.
+ */
+void CreateSVRGData(arma::mat& data, arma::Row<size_t>& responses)
+{
+  GaussianDistribution g1(arma::vec("-1.0 -1.0 -1.0"),
+      arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("1.0 1.0 1.0"),
+      arma::eye<arma::mat>(3, 3));
+
+  data.set_size(3, 500);
+  responses.set_size(500);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = (i % 2 == 0) ? g1.Random() : g2.Random();
+    responses[i] = i % 2;
+  }
+}
+
+/**
+ * SVRG should find the same minimum of the logistic regression objective as
+ * L-BFGS, with a constant step size.
+ */
+BOOST_AUTO_TEST_CASE(SVRGLogisticRegressionTest)
+{
+  arma::mat data;
+  arma::Row<size_t> responses;
+  CreateSVRGData(data, responses);
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+
+  L_BFGS<LogisticRegressionFunction<>> lbfgs(lrf);
+  arma::mat lbfgsCoordinates = lrf.GetInitialPoint();
+  const double lbfgsObjective = lbfgs.Optimize(lbfgsCoordinates);
+
+  // Try a couple of batch sizes, including one that doesn't divide the number
+  // of points.
+  for (size_t batchSize = 1; batchSize <= 16; batchSize *= 4)
+  {
+    SVRG<LogisticRegressionFunction<>> svrg(lrf, 0.1, batchSize, 100, 0,
+        1e-9);
+    arma::mat coordinates = lrf.GetInitialPoint();
+    const double objective = svrg.Optimize(coordinates);
+
+    BOOST_REQUIRE_CLOSE(objective, lbfgsObjective, 1e-3);
+    BOOST_REQUIRE_SMALL(arma::norm(coordinates - lbfgsCoordinates), 1e-3);
+  }
+}
+
+/**
+ * The logistic regression model trained with SVRG should classify the data.
+ */
+BOOST_AUTO_TEST_CASE(SVRGLogisticRegressionTrainTest)
+{
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 500);
+  arma::Row<size_t> responses(500);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = (i < 250) ? g1.Random() : g2.Random();
+    responses[i] = (i < 250) ? 0 : 1;
+  }
+
+  LogisticRegression<> lr(data.n_rows, 0.5);
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+  SVRG<LogisticRegressionFunction<>> svrg(lrf, 0.001, 10);
+  lr.Train(svrg);
+
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+}
+
+/**
+ * A batch size of zero should be rejected.
+ */
+BOOST_AUTO_TEST_CASE(SVRGZeroBatchSizeTest)
+{
+  arma::mat data;
+  arma::Row<size_t> responses;
+  CreateSVRGData(data, responses);
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+
+  SVRG<LogisticRegressionFunction<>> svrg(lrf, 0.1, 0);
+  arma::mat coordinates = lrf.GetInitialPoint();
+  BOOST_REQUIRE_THROW(svrg.Optimize(coordinates), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
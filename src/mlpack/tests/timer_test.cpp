@@ -19,6 +19,7 @@
 #endif
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/tree/binary_space_tree.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -90,4 +91,191 @@ BOOST_AUTO_TEST_CASE(TwiceStartTimerTest)
   BOOST_REQUIRE_THROW(Timer::Start("test_timer"), std::runtime_error);
 }
 
+/**
+ * Make sure that nested scoped timers are named after their enclosing scopes,
+ * and that their calls are counted.
+ */
+BOOST_AUTO_TEST_CASE(NestedScopedTimerTest)
+{
+  for (size_t i = 0; i < 3; ++i)
+  {
+    ScopedTimer outer("scoped_outer");
+    for (size_t j = 0; j < 2; ++j)
+    {
+      ScopedTimer inner("inner");
+
+      #ifdef _WIN32
+      Sleep(5);
+      #else
+      usleep(5000);
+      #endif
+    }
+  }
+
+  BOOST_REQUIRE_EQUAL(Timer::GetCalls("scoped_outer"), 3);
+  BOOST_REQUIRE_EQUAL(Timer::GetCalls("scoped_outer/inner"), 6);
+  BOOST_REQUIRE_EQUAL(Timer::GetCalls("inner"), 0);
+  BOOST_REQUIRE_GE(Timer::Get("scoped_outer/inner").count(), 30000);
+  BOOST_REQUIRE_GE(Timer::Get("scoped_outer").count(),
+      Timer::Get("scoped_outer/inner").count());
+}
+
+/**
+ * Make sure that scoped timers used on several threads at once are summed.
+ */
+BOOST_AUTO_TEST_CASE(ParallelScopedTimerTest)
+{
+  const size_t calls = Timer::GetCalls("scoped_parallel");
+
+  #pragma omp parallel for
+  for (int i = 0; i < 100; ++i)
+  {
+    ScopedTimer t("scoped_parallel");
+    ScopedTimer t2("inner");
+  }
+
+  BOOST_REQUIRE_EQUAL(Timer::GetCalls("scoped_parallel"), calls + 100);
+  BOOST_REQUIRE_EQUAL(Timer::GetCalls("scoped_parallel/inner"), 100);
+}
+
+/**
+ * Make sure the JSON output contains the timers.
+ */
+BOOST_AUTO_TEST_CASE(TimersJSONTest)
+{
+  Timers timers;
+  timers.StartTimer("json_timer");
+  timers.StopTimer("json_timer");
+
+  std::ostringstream oss;
+  timers.PrintJSON(oss);
+
+  const std::string json = oss.str();
+  BOOST_REQUIRE_EQUAL(json[0], '{');
+  BOOST_REQUIRE_NE(json.find("\"json_timer\": { \"microseconds\": "),
+      std::string::npos);
+  BOOST_REQUIRE_NE(json.find("\"calls\": 1 }"), std::string::npos);
+}
+
+/**
+ * Make sure the memory tracker records the peak and the change of each phase.
+ */
+BOOST_AUTO_TEST_CASE(MemoryTrackerPhaseTest)
+{
+  MemoryTracker::Reset();
+  MemoryTracker::Allocate(100);
+
+  MemoryTracker::StartPhase("memory_outer");
+  MemoryTracker::Allocate(1000);
+  MemoryTracker::StartPhase("memory_inner");
+  MemoryTracker::Allocate(500);
+  MemoryTracker::Free(1500);
+  MemoryTracker::StopPhase("memory_inner");
+  MemoryTracker::Allocate(50);
+
+  BOOST_REQUIRE_EQUAL(MemoryTracker::Current(), 150);
+  BOOST_REQUIRE_EQUAL(MemoryTracker::Peak(), 1600);
+  BOOST_REQUIRE_EQUAL(MemoryTracker::PhasePeak("memory_inner"), 1600);
+  BOOST_REQUIRE_EQUAL(MemoryTracker::PhaseChange("memory_inner"), -1000);
+  // The outer phase is still running, so its change includes the last
+  // allocation.
+  BOOST_REQUIRE_EQUAL(MemoryTracker::PhasePeak("memory_outer"), 1600);
+  BOOST_REQUIRE_EQUAL(MemoryTracker::PhaseChange("memory_outer"), 50);
+  MemoryTracker::StopPhase("memory_outer");
+
+  // A phase that runs again adds to its change, and keeps its highest peak.
+  MemoryTracker::StartPhase("memory_inner");
+  MemoryTracker::Allocate(200);
+  MemoryTracker::StopPhase("memory_inner");
+  BOOST_REQUIRE_EQUAL(MemoryTracker::PhasePeak("memory_inner"), 1600);
+  BOOST_REQUIRE_EQUAL(MemoryTracker::PhaseChange("memory_inner"), -800);
+
+  // Allocations outside of a phase are not recorded in it.
+  MemoryTracker::Allocate(10000);
+  BOOST_REQUIRE_EQUAL(MemoryTracker::PhasePeak("memory_outer"), 1600);
+  BOOST_REQUIRE_EQUAL(MemoryTracker::PhasePeak("memory_unknown"), 0);
+
+  // Freeing more than is tracked does not wrap around.
+  MemoryTracker::Free(100000);
+  BOOST_REQUIRE_EQUAL(MemoryTracker::Current(), 0);
+
+  MemoryTracker::Reset();
+}
+
+/**
+ * Make sure the nodes of a tree are tracked when memory tracking is compiled
+ * in, and that they are all freed with the tree.
+ */
+BOOST_AUTO_TEST_CASE(MemoryTrackerTreeTest)
+{
+  MemoryTracker::Reset();
+  {
+    typedef tree::KDTree<metric::EuclideanDistance, tree::EmptyStatistic,
+        arma::mat> TreeType;
+    arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+    TreeType tree(dataset);
+
+#ifdef MLPACK_MEMORY_TRACKING
+    size_t nodes = 0;
+    std::vector<const TreeType*> stack(1, &tree);
+    while (!stack.empty())
+    {
+      const TreeType* node = stack.back();
+      stack.pop_back();
+      ++nodes;
+      for (size_t i = 0; i < node->NumChildren(); ++i)
+        stack.push_back(&node->Child(i));
+    }
+
+    BOOST_REQUIRE_EQUAL(MemoryTracker::Current(), nodes * sizeof(TreeType));
+#else
+    BOOST_REQUIRE_EQUAL(MemoryTracker::Current(), 0);
+#endif
+  }
+
+  BOOST_REQUIRE_EQUAL(MemoryTracker::Current(), 0);
+  MemoryTracker::Reset();
+}
+
+/**
+ * Make sure the trace records the timers and the spans, only while tracing is
+ * enabled, and is written in the Chrome trace event format.
+ */
+BOOST_AUTO_TEST_CASE(TraceTest)
+{
+  Timer::EnableTracing();
+  BOOST_REQUIRE(Timer::Tracing());
+  {
+    ScopedTimer t("trace_scoped");
+  }
+  {
+    TraceSpan span("trace_span", 5);
+    span.Next();
+  }
+  Timer::Start("trace_timer");
+  Timer::Stop("trace_timer");
+
+  Timer::EnableTracing(false);
+  {
+    TraceSpan span("trace_disabled");
+    ScopedTimer t("trace_disabled_scoped");
+  }
+
+  std::ostringstream oss;
+  Timers().PrintTrace(oss);
+
+  const std::string trace = oss.str();
+  BOOST_REQUIRE_EQUAL(trace.find("{ \"traceEvents\": ["), 0);
+  BOOST_REQUIRE_NE(trace.find("{ \"name\": \"trace_scoped\", \"ph\": \"X\", "
+      "\"ts\": "), std::string::npos);
+  BOOST_REQUIRE_NE(trace.find("\"trace_timer\""), std::string::npos);
+  BOOST_REQUIRE_NE(trace.find("\"args\": { \"iteration\": 5 }"),
+      std::string::npos);
+  BOOST_REQUIRE_NE(trace.find("\"args\": { \"iteration\": 6 }"),
+      std::string::npos);
+  BOOST_REQUIRE_EQUAL(trace.find("trace_disabled"), std::string::npos);
+  BOOST_REQUIRE_NE(trace.find("\"displayTimeUnit\": \"ms\" }"),
+      std::string::npos);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
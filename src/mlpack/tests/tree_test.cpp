@@ -14,6 +14,7 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
+#include <mlpack/core/tree/traversal_info.hpp>
 
 #include <queue>
 #include <stack>
@@ -490,6 +491,97 @@ BOOST_AUTO_TEST_CASE(HRectBoundRangeDistancePoint)
   }
 }
 
+/**
+ * Compare the distances computed by HRectBound with the given metric against a
+ * direct computation, for bounds and points of the given element type.
+ */
+template<typename MetricType, typename ElemType>
+void CheckHRectBoundDistances()
+{
+  typedef arma::Col<ElemType> VecType;
+
+  for (int i = 0; i < 20; i++)
+  {
+    const size_t dim = math::RandInt(1, 40);
+
+    HRectBound<MetricType, ElemType> a(dim), b(dim);
+    VecType loA(dim), loB(dim), widthA(dim), widthB(dim), point(dim);
+    loA.randu();
+    loB.randu();
+    widthA.randu();
+    widthB.randu();
+    point.randu();
+    for (size_t j = 0; j < dim; j++)
+    {
+      a[j] = math::RangeType<ElemType>(loA[j], loA[j] + widthA[j]);
+      b[j] = math::RangeType<ElemType>(loB[j], loB[j] + widthB[j]);
+    }
+
+    // Find, in each dimension, the closest and furthest coordinates of the
+    // second bound and of the point from the first bound.
+    VecType minBound(dim), maxBound(dim), minPoint(dim), maxPoint(dim);
+    for (size_t j = 0; j < dim; j++)
+    {
+      minBound[j] = std::max(std::max(b[j].Lo() - a[j].Hi(),
+          a[j].Lo() - b[j].Hi()), (ElemType) 0);
+      maxBound[j] = std::max(b[j].Hi() - a[j].Lo(), a[j].Hi() - b[j].Lo());
+      minPoint[j] = std::max(std::max(point[j] - a[j].Hi(),
+          a[j].Lo() - point[j]), (ElemType) 0);
+      maxPoint[j] = std::max(point[j] - a[j].Lo(), a[j].Hi() - point[j]);
+    }
+
+    const VecType zero(dim, arma::fill::zeros);
+    const ElemType minBoundDist = MetricType::Evaluate(minBound, zero);
+    const ElemType maxBoundDist = MetricType::Evaluate(maxBound, zero);
+    const ElemType minPointDist = MetricType::Evaluate(minPoint, zero);
+    const ElemType maxPointDist = MetricType::Evaluate(maxPoint, zero);
+
+    const math::RangeType<ElemType> r1 = a.RangeDistance(b);
+    const math::RangeType<ElemType> r2 = a.RangeDistance(point);
+
+    if (minBoundDist == 0)
+    {
+      BOOST_REQUIRE_SMALL(a.MinDistance(b), (ElemType) 1e-5);
+      BOOST_REQUIRE_SMALL(r1.Lo(), (ElemType) 1e-5);
+    }
+    else
+    {
+      BOOST_REQUIRE_CLOSE(a.MinDistance(b), minBoundDist, 1e-3);
+      BOOST_REQUIRE_CLOSE(r1.Lo(), minBoundDist, 1e-3);
+    }
+    BOOST_REQUIRE_CLOSE(a.MaxDistance(b), maxBoundDist, 1e-3);
+    BOOST_REQUIRE_CLOSE(r1.Hi(), maxBoundDist, 1e-3);
+
+    if (minPointDist == 0)
+    {
+      BOOST_REQUIRE_SMALL(a.MinDistance(point), (ElemType) 1e-5);
+      BOOST_REQUIRE_SMALL(r2.Lo(), (ElemType) 1e-5);
+    }
+    else
+    {
+      BOOST_REQUIRE_CLOSE(a.MinDistance(point), minPointDist, 1e-3);
+      BOOST_REQUIRE_CLOSE(r2.Lo(), minPointDist, 1e-3);
+    }
+    BOOST_REQUIRE_CLOSE(a.MaxDistance(point), maxPointDist, 1e-3);
+    BOOST_REQUIRE_CLOSE(r2.Hi(), maxPointDist, 1e-3);
+  }
+}
+
+/**
+ * Make sure the HRectBound distance calculations are correct for different
+ * metrics and element types.
+ */
+BOOST_AUTO_TEST_CASE(HRectBoundDistanceMetricsTest)
+{
+  CheckHRectBoundDistances<ManhattanDistance, double>();
+  CheckHRectBoundDistances<EuclideanDistance, double>();
+  CheckHRectBoundDistances<SquaredEuclideanDistance, double>();
+  CheckHRectBoundDistances<LMetric<3, true>, double>();
+  CheckHRectBoundDistances<ManhattanDistance, float>();
+  CheckHRectBoundDistances<EuclideanDistance, float>();
+  CheckHRectBoundDistances<SquaredEuclideanDistance, float>();
+}
+
 /**
  * Test that we can expand the bound to include a new point.
  */
@@ -1359,6 +1451,96 @@ BOOST_AUTO_TEST_CASE(KdTreeTest)
   TreeType root(dataset);
 }
 
+/**
+ * Make sure that the bound of each node of a kd-tree is the tight bound of its
+ * points, and that the points of the children are separated in some dimension.
+ */
+template<typename TreeType>
+void CheckSeparatedChildren(const TreeType& node)
+{
+  HRectBound<EuclideanDistance> bound(node.Dataset().n_rows);
+  bound |= node.Dataset().cols(node.Begin(), node.Begin() + node.Count() - 1);
+  for (size_t d = 0; d < bound.Dim(); ++d)
+  {
+    BOOST_REQUIRE_EQUAL(node.Bound()[d].Lo(), bound[d].Lo());
+    BOOST_REQUIRE_EQUAL(node.Bound()[d].Hi(), bound[d].Hi());
+  }
+
+  if (node.IsLeaf())
+    return;
+
+  bool separated = false;
+  for (size_t d = 0; d < bound.Dim(); ++d)
+    if (node.Left()->Bound()[d].Hi() <= node.Right()->Bound()[d].Lo())
+      separated = true;
+  BOOST_REQUIRE(separated);
+
+  CheckSeparatedChildren(*node.Left());
+  CheckSeparatedChildren(*node.Right());
+}
+
+/**
+ * The top levels of large kd-trees are partitioned and bounded in blocks; make
+ * sure that the tree is still valid.
+ */
+BOOST_AUTO_TEST_CASE(LargeKdTreeTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset = arma::randu<arma::mat>(3, 300000);
+
+  std::vector<size_t> oldFromNew;
+  TreeType root(dataset, oldFromNew, 100);
+  const arma::mat& treeset = root.Dataset();
+
+  BOOST_REQUIRE_EQUAL(root.Count(), dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    for (size_t j = 0; j < dataset.n_rows; ++j)
+      BOOST_REQUIRE_EQUAL(treeset(j, i), dataset(j, oldFromNew[i]));
+
+  CheckSeparatedChildren(root);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Make sure that two binary space trees are identical.
+ */
+template<typename TreeType>
+void CheckSameBinarySpaceTree(const TreeType& tree, const TreeType& other)
+{
+  BOOST_REQUIRE_EQUAL(tree.Begin(), other.Begin());
+  BOOST_REQUIRE_EQUAL(tree.Count(), other.Count());
+  BOOST_REQUIRE_EQUAL(tree.NumChildren(), other.NumChildren());
+  BOOST_REQUIRE_EQUAL(tree.ParentDistance(), other.ParentDistance());
+
+  for (size_t i = 0; i < tree.NumChildren(); ++i)
+    CheckSameBinarySpaceTree(tree.Child(i), other.Child(i));
+}
+
+/**
+ * The children of large nodes are built in parallel; the tree must be the same
+ * as the one built with a single thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelKdTreeConstructionTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset = arma::randu<arma::mat>(3, 300000);
+
+  std::vector<size_t> serialOldFromNew, parallelOldFromNew;
+  const int numThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  TreeType serialTree(dataset, serialOldFromNew);
+  omp_set_num_threads(4);
+  TreeType parallelTree(dataset, parallelOldFromNew);
+  omp_set_num_threads(numThreads);
+
+  CheckSameBinarySpaceTree(serialTree, parallelTree);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(serialOldFromNew[i], parallelOldFromNew[i]);
+}
+#endif
+
 BOOST_AUTO_TEST_CASE(MaxRPTreeTest)
 {
   typedef MaxRPTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
@@ -1778,6 +1960,185 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeMoveConstructorTest)
   BOOST_REQUIRE_EQUAL(tree2.NumChildren(), 2);
 }
 
+template<typename TreeType>
+void CheckCompactTree(const TreeType& node, const TreeType& other)
+{
+  BOOST_REQUIRE_EQUAL(node.Begin(), other.Begin());
+  BOOST_REQUIRE_EQUAL(node.Count(), other.Count());
+  BOOST_REQUIRE_EQUAL(node.NumChildren(), other.NumChildren());
+  for (size_t d = 0; d < node.Bound().Dim(); ++d)
+  {
+    BOOST_REQUIRE_EQUAL(node.Bound()[d].Lo(), other.Bound()[d].Lo());
+    BOOST_REQUIRE_EQUAL(node.Bound()[d].Hi(), other.Bound()[d].Hi());
+  }
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(node.Child(i).Parent(), &node);
+    CheckCompactTree(node.Child(i), other.Child(i));
+  }
+
+  // The left child of each non-root node must be stored right after it.
+  if (node.Parent() != NULL && node.NumChildren() > 0)
+    BOOST_REQUIRE_EQUAL(node.Left(), &node + 1);
+}
+
+/**
+ * Make sure that compacting a binary space tree does not change it.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeCompactTest)
+{
+  arma::mat dataset(5, 1000);
+  dataset.randu();
+
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(dataset);
+  TreeType copy(tree);
+
+  tree.Compact();
+  BOOST_REQUIRE(tree.IsCompact());
+  BOOST_REQUIRE(!copy.IsCompact());
+  CheckCompactTree(tree, copy);
+
+  // Compacting again must give the same tree.
+  tree.Compact();
+  CheckCompactTree(tree, copy);
+
+  // The arena must follow the tree when it is moved.
+  TreeType moved(std::move(tree));
+  BOOST_REQUIRE(moved.IsCompact());
+  BOOST_REQUIRE(!tree.IsCompact());
+  CheckCompactTree(moved, copy);
+
+  // A copy of a compacted tree is a normal tree.
+  TreeType copy2(moved);
+  BOOST_REQUIRE(!copy2.IsCompact());
+  CheckCompactTree(moved, copy2);
+}
+
+/**
+ * Simple rules that look for the reference points within a given distance of
+ * each query point, pruning with the bounds of the nodes.
+ */
+class RangeCheckRules
+{
+ public:
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  typedef tree::TraversalInfo<TreeType> TraversalInfoType;
+
+  RangeCheckRules(const arma::mat& dataset, const double range) :
+      dataset(dataset), range(range), baseCases(0) { }
+
+  double BaseCase(const size_t queryIndex, const size_t referenceIndex)
+  {
+    ++baseCases;
+    return EuclideanDistance::Evaluate(dataset.col(queryIndex),
+        dataset.col(referenceIndex));
+  }
+
+  double Score(const size_t queryIndex, TreeType& referenceNode)
+  {
+    const double distance = referenceNode.MinDistance(
+        dataset.col(queryIndex));
+    return (distance > range) ? DBL_MAX : distance;
+  }
+
+  double Score(TreeType& queryNode, TreeType& referenceNode)
+  {
+    const double distance = queryNode.MinDistance(referenceNode);
+    return (distance > range) ? DBL_MAX : distance;
+  }
+
+  double Rescore(const size_t, TreeType&, const double oldScore)
+  {
+    return oldScore;
+  }
+
+  double Rescore(TreeType&, TreeType&, const double oldScore)
+  {
+    return oldScore;
+  }
+
+  TraversalInfoType& TraversalInfo() { return traversalInfo; }
+
+  size_t BaseCases() const { return baseCases; }
+
+ private:
+  const arma::mat& dataset;
+  double range;
+  size_t baseCases;
+  TraversalInfoType traversalInfo;
+};
+
+//! RangeCheckRules that make the traversers keep TraversalCounters.
+class CountingRangeCheckRules : public RangeCheckRules
+{
+ public:
+  typedef TraversalCounters TraversalCountersType;
+
+  using RangeCheckRules::RangeCheckRules;
+};
+
+/**
+ * Make sure that the traversal counters of the binary space tree traversers
+ * agree with the counts the traversers already keep, and that they are only
+ * kept when the rules ask for them.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeTraversalCountersTest)
+{
+  typedef RangeCheckRules::TreeType TreeType;
+
+  arma::mat dataset(3, 1000);
+  dataset.randu();
+  TreeType tree(dataset);
+
+  // Rules without the typedef keep no counters.
+  BOOST_REQUIRE((std::is_same<
+      TreeType::DualTreeTraverser<RangeCheckRules>::CountersType,
+      NoTraversalCounters>::value));
+  BOOST_REQUIRE((std::is_same<
+      TreeType::SingleTreeTraverser<RangeCheckRules>::CountersType,
+      NoTraversalCounters>::value));
+
+  // Dual-tree traversal.
+  CountingRangeCheckRules dualRules(tree.Dataset(), 0.1);
+  TreeType::DualTreeTraverser<CountingRangeCheckRules> dualTraverser(
+      dualRules);
+  dualTraverser.Traverse(tree, tree);
+
+  const TraversalCounters& dualCounters = dualTraverser.Counters();
+  BOOST_REQUIRE_EQUAL(dualCounters.NumScores(), dualTraverser.NumScores());
+  BOOST_REQUIRE_EQUAL(dualCounters.NumBaseCases(),
+      dualTraverser.NumBaseCases());
+  BOOST_REQUIRE_EQUAL(dualCounters.NumBaseCases(), dualRules.BaseCases());
+  BOOST_REQUIRE_EQUAL(dualCounters.NumPrunes(), dualTraverser.NumPrunes());
+  BOOST_REQUIRE_GT(dualCounters.NumPrunes(), 0);
+  BOOST_REQUIRE_EQUAL(dualCounters.NumPrunes(0), 0);
+  BOOST_REQUIRE_EQUAL(dualCounters.NumRescorePrunes(), 0);
+
+  size_t totalPrunes = 0;
+  for (size_t d = 0; d < dualCounters.MaxPruneDepth(); ++d)
+    totalPrunes += dualCounters.NumPrunes(d);
+  BOOST_REQUIRE_EQUAL(totalPrunes, dualCounters.NumPrunes());
+
+  // Single-tree traversal; the counts add up over all query points.
+  CountingRangeCheckRules singleRules(tree.Dataset(), 0.1);
+  TreeType::SingleTreeTraverser<CountingRangeCheckRules> singleTraverser(
+      singleRules);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    singleTraverser.Traverse(i, tree);
+
+  const TraversalCounters& singleCounters = singleTraverser.Counters();
+  BOOST_REQUIRE_EQUAL(singleCounters.NumBaseCases(), singleRules.BaseCases());
+  BOOST_REQUIRE_EQUAL(singleCounters.NumPrunes(), singleTraverser.NumPrunes());
+  BOOST_REQUIRE_GT(singleCounters.NumScores(), 0);
+  BOOST_REQUIRE_EQUAL(singleCounters.NumPrunes(0), 0);
+
+  singleTraverser.Counters().Reset();
+  BOOST_REQUIRE_EQUAL(singleTraverser.Counters().NumScores(), 0);
+  BOOST_REQUIRE_EQUAL(singleTraverser.Counters().NumPrunes(), 0);
+}
+
 template<typename TreeType>
 void RecurseTreeCountLeaves(const TreeType& node, arma::vec& counts)
 {
@@ -1926,6 +2287,55 @@ BOOST_AUTO_TEST_CASE(CoverTreeConstructionTest)
   // implementation.
 }
 
+#ifdef HAS_OPENMP
+/**
+ * Make sure that two cover trees are identical.
+ */
+template<typename TreeType>
+void CheckSameCoverTree(const TreeType& tree, const TreeType& other)
+{
+  BOOST_REQUIRE_EQUAL(tree.Point(), other.Point());
+  BOOST_REQUIRE_EQUAL(tree.Scale(), other.Scale());
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), other.NumDescendants());
+  BOOST_REQUIRE_EQUAL(tree.NumChildren(), other.NumChildren());
+  BOOST_REQUIRE_CLOSE(tree.FurthestDescendantDistance(),
+      other.FurthestDescendantDistance(), 1e-5);
+
+  for (size_t i = 0; i < tree.NumChildren(); ++i)
+    CheckSameCoverTree(tree.Child(i), other.Child(i));
+}
+
+/**
+ * The distances of large point sets are computed in parallel; the tree must be
+ * the same as the one built with a single thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelCoverTreeConstructionTest)
+{
+  arma::mat dataset;
+  dataset.randu(20, 10000);
+
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+
+  const int numThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  TreeType serialTree(dataset);
+  omp_set_num_threads(4);
+  TreeType parallelTree(dataset);
+  omp_set_num_threads(numThreads);
+
+  CheckSameCoverTree(serialTree, parallelTree);
+
+  arma::vec counts;
+  counts.zeros(10000);
+  RecurseTreeCountLeaves(parallelTree, counts);
+  for (size_t i = 0; i < 10000; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  CheckCovering<TreeType, LMetric<2, true> >(parallelTree);
+}
+#endif
+
 /**
  * Create a cover tree on sparse data and make sure it's accurate.
  */
@@ -2252,4 +2662,39 @@ BOOST_AUTO_TEST_CASE(CoverTreeDescendantTest)
   CheckDescendants(&tree);
 }
 
+/**
+ * Make sure that a reordered cover tree stores its points in depth-first order
+ * and is still a valid cover tree.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeReorderDatasetTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 1000);
+
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+  TreeType tree(dataset);
+
+  std::vector<size_t> oldFromNew;
+  tree.ReorderDataset(oldFromNew);
+
+  // The dataset was not owned by the tree, so it must have been copied.
+  BOOST_REQUIRE_NE(&tree.Dataset(), &dataset);
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(arma::norm(tree.Dataset().col(i) -
+        dataset.col(oldFromNew[i])), 0.0);
+    BOOST_REQUIRE_EQUAL(tree.Descendant(i), i);
+  }
+
+  CheckDescendants(&tree);
+  CheckSelfChild<TreeType>(tree);
+  CheckCovering<TreeType, LMetric<2, true>>(tree);
+
+  // Only the root can be reordered.
+  BOOST_REQUIRE_THROW(tree.Child(0).ReorderDataset(oldFromNew),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/methods/emst/union_find.hpp>
+#include <mlpack/methods/emst/lock_free_union_find.hpp>
 
 #include <mlpack/core.hpp>
 #include <boost/test/unit_test.hpp>
@@ -51,4 +52,54 @@ BOOST_AUTO_TEST_CASE(TestUnion)
   BOOST_REQUIRE(testUnionFind.Find(6) == testUnionFind.Find(3));
 }
 
+BOOST_AUTO_TEST_CASE(TestLockFreeUnion)
+{
+  static const size_t testSize = 10;
+  LockFreeUnionFind testUnionFind(testSize);
+
+  for (size_t i = 0; i < testSize; i++)
+    BOOST_REQUIRE(testUnionFind.Find(i) == i);
+
+  BOOST_REQUIRE(testUnionFind.Union(0, 1));
+  BOOST_REQUIRE(testUnionFind.Union(2, 3));
+  BOOST_REQUIRE(testUnionFind.Union(0, 2));
+  BOOST_REQUIRE(testUnionFind.Union(5, 0));
+  BOOST_REQUIRE(testUnionFind.Union(0, 6));
+  BOOST_REQUIRE(!testUnionFind.Union(3, 6));
+
+  // The index of a component is its least index.
+  BOOST_REQUIRE(testUnionFind.Find(1) == 0);
+  BOOST_REQUIRE(testUnionFind.Find(3) == 0);
+  BOOST_REQUIRE(testUnionFind.Find(5) == 0);
+  BOOST_REQUIRE(testUnionFind.Find(6) == 0);
+  BOOST_REQUIRE(testUnionFind.Find(4) == 4);
+}
+
+/**
+ * Unite the points of a chain from several threads at once; exactly one union
+ * per link of the chain may succeed, and all points must end up in the same
+ * component.
+ */
+BOOST_AUTO_TEST_CASE(TestLockFreeParallelUnion)
+{
+  static const size_t testSize = 10000;
+  LockFreeUnionFind testUnionFind(testSize);
+
+  // Each link is tried twice, in both directions.
+  size_t successes = 0;
+  #pragma omp parallel for reduction(+:successes)
+  for (int i = 0; i < (int) (2 * (testSize - 1)); i++)
+  {
+    const size_t link = (size_t) i % (testSize - 1);
+    if ((size_t) i < testSize - 1)
+      successes += testUnionFind.Union(link, link + 1) ? 1 : 0;
+    else
+      successes += testUnionFind.Union(link + 1, link) ? 1 : 0;
+  }
+
+  BOOST_REQUIRE_EQUAL(successes, testSize - 1);
+  for (size_t i = 0; i < testSize; i++)
+    BOOST_REQUIRE_EQUAL(testUnionFind.Find(i), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();